@@ -0,0 +1,30 @@
+#ifndef _CACHESTATISTICS_I
+#define _CACHESTATISTICS_I
+
+%module CacheStatistics
+
+!proxy_imports(carto::CacheStatistics)
+
+%{
+#include "components/CacheStatistics.h"
+#include <memory>
+%}
+
+%include <std_shared_ptr.i>
+%include <std_string.i>
+%include <cartoswig.i>
+
+!shared_ptr(carto::CacheStatistics, components.CacheStatistics)
+
+%attribute(carto::CacheStatistics, std::size_t, Size, getSize)
+%attribute(carto::CacheStatistics, std::size_t, Capacity, getCapacity)
+%attribute(carto::CacheStatistics, long long, HitCount, getHitCount)
+%attribute(carto::CacheStatistics, long long, MissCount, getMissCount)
+%attribute(carto::CacheStatistics, float, HitRate, getHitRate)
+%ignore carto::CacheStatistics::CacheStatistics;
+!standard_equals(carto::CacheStatistics);
+!custom_tostring(carto::CacheStatistics);
+
+%include "components/CacheStatistics.h"
+
+#endif
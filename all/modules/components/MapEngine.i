@@ -0,0 +1,24 @@
+#ifndef _MAPENGINE_I
+#define _MAPENGINE_I
+
+%module MapEngine
+
+!proxy_imports(carto::MapEngine)
+
+%{
+#include "components/MapEngine.h"
+#include <memory>
+%}
+
+%include <std_shared_ptr.i>
+%include <cartoswig.i>
+
+!shared_ptr(carto::MapEngine, components.MapEngine)
+
+%ignore carto::MapEngine::getEnvelopeThreadPool;
+%ignore carto::MapEngine::getTileThreadPool;
+%ignore carto::MapEngine::getTileDecodeThreadPool;
+
+%include "components/MapEngine.h"
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef _MEMORYACCOUNTING_I
+#define _MEMORYACCOUNTING_I
+
+%module MemoryAccounting
+
+!proxy_imports(carto::MemoryAccounting, components.MemoryCategory)
+
+%{
+#include "components/MemoryAccounting.h"
+#include <memory>
+%}
+
+%include <cartoswig.i>
+
+%import "components/MemoryCategory.i"
+
+%ignore carto::MemoryAccounting::Allocate;
+%ignore carto::MemoryAccounting::Release;
+
+%include "components/MemoryAccounting.h"
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef _MEMORYCATEGORY_I
+#define _MEMORYCATEGORY_I
+
+%module MemoryCategory
+
+%{
+#include "components/MemoryCategory.h"
+#include <memory>
+%}
+
+%include <cartoswig.i>
+
+%include "components/MemoryCategory.h"
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef _MEMORYPRESSURELEVEL_I
+#define _MEMORYPRESSURELEVEL_I
+
+%module MemoryPressureLevel
+
+%{
+#include "components/MemoryPressureLevel.h"
+#include <memory>
+%}
+
+%include <cartoswig.i>
+
+%include "components/MemoryPressureLevel.h"
+
+#endif
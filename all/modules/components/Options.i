@@ -15,6 +15,7 @@
 %}
 
 %include <std_shared_ptr.i>
+%include <std_string.i>
 %include <cartoswig.i>
 
 !shared_ptr(carto::Options, components.Options)
@@ -29,9 +30,14 @@
 
 %attribute(carto::Options, int, FieldOfViewY, getFieldOfViewY, setFieldOfViewY)
 %attribute(carto::Options, bool, KineticZoom, isKineticZoom, setKineticZoom)
+%attribute(carto::Options, bool, TouchPrediction, isTouchPrediction, setTouchPrediction)
 %attribute(carto::Options, bool, Rotatable, isRotatable, setRotatable)
 %attribute(carto::Options, bool, UserInput, isUserInput, setUserInput)
 %attribute(carto::Options, bool, ClickTypeDetection, isClickTypeDetection, setClickTypeDetection)
+%attribute(carto::Options, bool, GPUPicking, isGPUPicking, setGPUPicking)
+%attribute(carto::Options, int, MaxFPS, getMaxFPS, setMaxFPS)
+%attribute(carto::Options, bool, StaticLayerCaching, isStaticLayerCaching, setStaticLayerCaching)
+%attributestring(carto::Options, std::string, ShaderCachePath, getShaderCachePath, setShaderCachePath)
 %attribute(carto::Options, bool, KineticPan, isKineticPan, setKineticPan)
 %attribute(carto::Options, bool, KineticRotation, isKineticRotation, setKineticRotation)
 %attribute(carto::Options, bool, SeamlessPanning, isSeamlessPanning, setSeamlessPanning)
@@ -54,6 +60,7 @@
 %attributestring(carto::Options, std::shared_ptr<carto::Bitmap>, BackgroundBitmap, getBackgroundBitmap, setBackgroundBitmap)
 %attribute(carto::Options, int, EnvelopeThreadPoolSize, getEnvelopeThreadPoolSize, setEnvelopeThreadPoolSize)
 %attribute(carto::Options, int, TileThreadPoolSize, getTileThreadPoolSize, setTileThreadPoolSize)
+%attribute(carto::Options, int, TileDecodeThreadPoolSize, getTileDecodeThreadPoolSize, setTileDecodeThreadPoolSize)
 %attribute(carto::Options, int, TileDrawSize, getTileDrawSize, setTileDrawSize)
 %attribute(carto::Options, float, DPI, getDPI, setDPI)
 %attribute(carto::Options, float, DrawDistance, getDrawDistance, setDrawDistance)
@@ -72,6 +79,8 @@
 %ignore carto::Options::getSkyBitmap;
 %ignore carto::Options::getAdjustedInternalPanBounds;
 %ignore carto::Options::OnChangeListener;
+%ignore carto::Options::Snapshot;
+%ignore carto::Options::getSnapshot;
 %ignore carto::Options::registerOnChangeListener;
 %ignore carto::Options::unregisterOnChangeListener;
 %ignore carto::Options::GetDefaultBackgroundBitmap;
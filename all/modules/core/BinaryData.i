@@ -21,6 +21,7 @@
 %include <cartoswig.i>
 
 !shared_ptr(carto::BinaryData, core.BinaryData)
+!value_type(std::vector<std::shared_ptr<carto::BinaryData> >, core.BinaryDataVector)
 
 #ifdef SWIGCSHARP
 %rename(GetData) carto::BinaryData::data;
@@ -84,4 +85,6 @@
 
 %include "core/BinaryData.h"
 
+!value_template(std::vector<std::shared_ptr<carto::BinaryData> >, core.BinaryDataVector)
+
 #endif
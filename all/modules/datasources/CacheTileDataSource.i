@@ -3,10 +3,11 @@
 
 %module(directors="1") CacheTileDataSource
 
-!proxy_imports(carto::CacheTileDataSource, core.MapTile, core.MapBounds, core.StringMap, datasources.TileDataSource, datasources.components.TileData)
+!proxy_imports(carto::CacheTileDataSource, components.CacheStatistics, core.MapTile, core.MapBounds, core.StringMap, datasources.TileDataSource, datasources.components.TileData)
 
 %{
 #include "datasources/CacheTileDataSource.h"
+#include "components/CacheStatistics.h"
 #include "components/Exceptions.h"
 #include <memory>
 %}
@@ -14,12 +15,14 @@
 %include <std_shared_ptr.i>
 %include <cartoswig.i>
 
+%import "components/CacheStatistics.i"
 %import "datasources/TileDataSource.i"
 
 !polymorphic_shared_ptr(carto::CacheTileDataSource, datasources.CacheTileDataSource)
 
 !attributestring_polymorphic(carto::CacheTileDataSource, datasources.TileDataSource, DataSource, getDataSource)
 %attribute(carto::CacheTileDataSource, std::size_t, Capacity, getCapacity, setCapacity)
+%attribute(carto::CacheTileDataSource, bool, StaleWhileRevalidate, isStaleWhileRevalidate, setStaleWhileRevalidate)
 %std_exceptions(carto::CacheTileDataSource::CacheTileDataSource)
 
 %feature("director") carto::CacheTileDataSource;
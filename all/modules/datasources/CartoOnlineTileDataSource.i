@@ -3,10 +3,11 @@
 
 %module(directors="1") CartoOnlineTileDataSource
 
-!proxy_imports(carto::CartoOnlineTileDataSource, core.MapTile, core.MapBounds, core.StringMap, datasources.TileDataSource, datasources.components.TileData)
+!proxy_imports(carto::CartoOnlineTileDataSource, core.MapTile, core.MapBounds, core.StringMap, datasources.TileDataSource, datasources.components.TileData, datasources.components.NetworkStatistics)
 
 %{
 #include "datasources/CartoOnlineTileDataSource.h"
+#include "datasources/components/NetworkStatistics.h"
 #include "components/Exceptions.h"
 #include <memory>
 %}
@@ -16,6 +17,7 @@
 %include <cartoswig.i>
 
 %import "datasources/TileDataSource.i"
+%import "datasources/components/NetworkStatistics.i"
 
 !polymorphic_shared_ptr(carto::CartoOnlineTileDataSource, datasources.CartoOnlineTileDataSource)
 
@@ -25,6 +27,8 @@
 %ignore carto::CartoOnlineTileDataSource::buildTileURL;
 %ignore carto::CartoOnlineTileDataSource::loadConfiguration;
 %ignore carto::CartoOnlineTileDataSource::loadOnlineTile;
+%ignore carto::CartoOnlineTileDataSource::reloadTile;
+%attributestring(carto::CartoOnlineTileDataSource, std::shared_ptr<carto::NetworkStatistics>, NetworkStatistics, getNetworkStatistics)
 
 %feature("director") carto::CartoOnlineTileDataSource;
 
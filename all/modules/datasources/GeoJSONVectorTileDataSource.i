@@ -3,7 +3,7 @@
 
 %module(directors="1") GeoJSONVectorTileDataSource
 
-!proxy_imports(carto::GeoJSONVectorTileDataSource, core.MapTile, core.MapBounds, core.Variant, datasources.TileDataSource, datasources.components.TileData, geometry.FeatureCollection, projections.Projection)
+!proxy_imports(carto::GeoJSONVectorTileDataSource, core.MapTile, core.MapBounds, core.Variant, datasources.TileDataSource, datasources.components.TileData, geometry.Feature, geometry.FeatureCollection, projections.Projection)
 
 %{
 #include "datasources/GeoJSONVectorTileDataSource.h"
@@ -17,6 +17,7 @@
 
 %import "core/MapTile.i"
 %import "core/Variant.i"
+%import "geometry/Feature.i"
 %import "geometry/FeatureCollection.i"
 %import "datasources/TileDataSource.i"
 %import "datasources/components/TileData.i"
@@ -27,6 +28,9 @@
 %std_io_exceptions(carto::GeoJSONVectorTileDataSource::createLayer)
 %std_io_exceptions(carto::GeoJSONVectorTileDataSource::setLayerGeoJSON)
 %std_io_exceptions(carto::GeoJSONVectorTileDataSource::setLayerFeatureCollection)
+%std_io_exceptions(carto::GeoJSONVectorTileDataSource::addLayerFeature)
+%std_io_exceptions(carto::GeoJSONVectorTileDataSource::updateLayerFeature)
+%std_io_exceptions(carto::GeoJSONVectorTileDataSource::removeLayerFeature)
 
 %feature("director") carto::GeoJSONVectorTileDataSource;
 
@@ -3,10 +3,11 @@
 
 %module(directors="1") HTTPTileDataSource
 
-!proxy_imports(carto::HTTPTileDataSource, core.MapTile, core.MapBounds, core.StringVector, core.StringMap, datasources.TileDataSource, datasources.components.TileData)
+!proxy_imports(carto::HTTPTileDataSource, core.MapTile, core.MapBounds, core.StringVector, core.StringMap, datasources.TileDataSource, datasources.components.TileData, datasources.components.NetworkStatistics)
 
 %{
 #include "datasources/HTTPTileDataSource.h"
+#include "datasources/components/NetworkStatistics.h"
 #include <memory>
 %}
 
@@ -17,6 +18,7 @@
 %include <cartoswig.i>
 
 %import "datasources/TileDataSource.i"
+%import "datasources/components/NetworkStatistics.i"
 %import "core/StringVector.i"
 %import "core/StringMap.i"
 
@@ -28,6 +30,9 @@
 %attribute(carto::HTTPTileDataSource, bool, MaxAgeHeaderCheck, isMaxAgeHeaderCheck, setMaxAgeHeaderCheck)
 %attributeval(carto::HTTPTileDataSource, %arg(std::map<std::string, std::string>), HTTPHeaders, getHTTPHeaders, setHTTPHeaders)
 
+%ignore carto::HTTPTileDataSource::reloadTile;
+%attributestring(carto::HTTPTileDataSource, std::shared_ptr<carto::NetworkStatistics>, NetworkStatistics, getNetworkStatistics)
+
 %feature("director") carto::HTTPTileDataSource;
 
 %include "datasources/HTTPTileDataSource.h"
@@ -25,6 +25,8 @@
 !polymorphic_shared_ptr(carto::MBTilesTileDataSource, datasources.MBTilesTileDataSource)
 
 %std_io_exceptions(carto::MBTilesTileDataSource::MBTilesTileDataSource)
+%ignore carto::MBTilesTileDataSource::isBatchLoadingSupported;
+%ignore carto::MBTilesTileDataSource::loadTiles;
 
 %feature("director") carto::MBTilesTileDataSource;
 
@@ -3,10 +3,11 @@
 
 %module(directors="1") MapTilerOnlineTileDataSource
 
-!proxy_imports(carto::MapTilerOnlineTileDataSource, core.MapTile, core.MapBounds, core.StringMap, datasources.TileDataSource, datasources.components.TileData)
+!proxy_imports(carto::MapTilerOnlineTileDataSource, core.MapTile, core.MapBounds, core.StringMap, datasources.TileDataSource, datasources.components.TileData, datasources.components.NetworkStatistics)
 
 %{
 #include "datasources/MapTilerOnlineTileDataSource.h"
+#include "datasources/components/NetworkStatistics.h"
 #include "components/Exceptions.h"
 #include <memory>
 %}
@@ -16,6 +17,7 @@
 %include <cartoswig.i>
 
 %import "datasources/TileDataSource.i"
+%import "datasources/components/NetworkStatistics.i"
 
 !polymorphic_shared_ptr(carto::MapTilerOnlineTileDataSource, datasources.MapTilerOnlineTileDataSource)
 
@@ -25,6 +27,7 @@
 %ignore carto::MapTilerOnlineTileDataSource::buildTileURL;
 %ignore carto::MapTilerOnlineTileDataSource::loadConfiguration;
 %ignore carto::MapTilerOnlineTileDataSource::loadOnlineTile;
+%attributestring(carto::MapTilerOnlineTileDataSource, std::shared_ptr<carto::NetworkStatistics>, NetworkStatistics, getNetworkStatistics)
 
 %feature("director") carto::MapTilerOnlineTileDataSource;
 
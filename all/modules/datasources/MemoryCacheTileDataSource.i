@@ -19,6 +19,7 @@
 
 !polymorphic_shared_ptr(carto::MemoryCacheTileDataSource, datasources.MemoryCacheTileDataSource)
 
+%attribute(carto::MemoryCacheTileDataSource, bool, CompressionEnabled, isCompressionEnabled, setCompressionEnabled)
 %std_exceptions(carto::MemoryCacheTileDataSource::MemoryCacheTileDataSource)
 
 %feature("director") carto::MemoryCacheTileDataSource;
@@ -19,6 +19,7 @@
 
 !polymorphic_shared_ptr(carto::OrderedTileDataSource, datasources.OrderedTileDataSource)
 
+%attribute(carto::OrderedTileDataSource, bool, ParallelLoading, isParallelLoading, setParallelLoading)
 %std_exceptions(carto::OrderedTileDataSource::OrderedTileDataSource)
 
 %feature("director") carto::OrderedTileDataSource;
@@ -0,0 +1,26 @@
+#ifndef _PACKEDASSETTILEDATASOURCE_I
+#define _PACKEDASSETTILEDATASOURCE_I
+
+%module PackedAssetTileDataSource
+
+!proxy_imports(carto::PackedAssetTileDataSource, core.MapTile, core.MapBounds, core.StringMap, datasources.TileDataSource, datasources.components.TileData)
+
+%{
+#include "datasources/PackedAssetTileDataSource.h"
+#include "components/Exceptions.h"
+#include <memory>
+%}
+
+%include <std_shared_ptr.i>
+%include <std_string.i>
+%include <cartoswig.i>
+
+%import "datasources/TileDataSource.i"
+
+!polymorphic_shared_ptr(carto::PackedAssetTileDataSource, datasources.PackedAssetTileDataSource)
+
+%std_io_exceptions(carto::PackedAssetTileDataSource::PackedAssetTileDataSource)
+
+%include "datasources/PackedAssetTileDataSource.h"
+
+#endif
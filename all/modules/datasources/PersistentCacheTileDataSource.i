@@ -3,7 +3,7 @@
 
 %module(directors="1") PersistentCacheTileDataSource
 
-!proxy_imports(carto::PersistentCacheTileDataSource, core.MapBounds, core.MapTile, core.MapBounds, core.StringMap, datasources.CacheTileDataSource, datasources.TileDownloadListener, datasources.components.TileData)
+!proxy_imports(carto::PersistentCacheTileDataSource, core.MapBounds, core.MapPos, core.MapPosVector, core.MapTile, core.MapBounds, core.StringMap, datasources.CacheTileDataSource, datasources.TileDownloadListener, datasources.components.TileData)
 
 %{
 #include "datasources/PersistentCacheTileDataSource.h"
@@ -15,15 +15,18 @@
 %include <std_string.i>
 %include <cartoswig.i>
 
+%import "core/MapPos.i"
 %import "datasources/CacheTileDataSource.i"
 %import "datasources/TileDownloadListener.i"
 
 !polymorphic_shared_ptr(carto::PersistentCacheTileDataSource, datasources.PersistentCacheTileDataSource)
 
 %attribute(carto::PersistentCacheTileDataSource, bool, CacheOnlyMode, isCacheOnlyMode, setCacheOnlyMode)
+%attribute(carto::PersistentCacheTileDataSource, bool, CompressionEnabled, isCompressionEnabled, setCompressionEnabled)
 %attribute(carto::PersistentCacheTileDataSource, bool, Open, isOpen)
 %std_exceptions(carto::PersistentCacheTileDataSource::PersistentCacheTileDataSource)
 %std_exceptions(carto::PersistentCacheTileDataSource::startDownloadArea)
+%std_exceptions(carto::PersistentCacheTileDataSource::startDownloadRoute)
 
 %feature("director") carto::PersistentCacheTileDataSource;
 
@@ -34,6 +34,11 @@
 %ignore carto::TileDataSource::OnChangeListener;
 %ignore carto::TileDataSource::registerOnChangeListener;
 %ignore carto::TileDataSource::unregisterOnChangeListener;
+%ignore carto::TileDataSource::loadTileCoalesced;
+%ignore carto::TileDataSource::reloadTile;
+%ignore carto::TileDataSource::isBatchLoadingSupported;
+%ignore carto::TileDataSource::loadTiles;
+%ignore carto::TileDataSource::notifyTilesChanged(const std::vector<carto::MapTile>&, bool);
 
 %feature("director") carto::TileDataSource;
 %feature("nodirector") carto::TileDataSource::buildTagValues;
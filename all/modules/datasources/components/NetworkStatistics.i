@@ -0,0 +1,25 @@
+#ifndef _NETWORKSTATISTICS_I
+#define _NETWORKSTATISTICS_I
+
+%module NetworkStatistics
+
+%{
+#include "datasources/components/NetworkStatistics.h"
+#include <memory>
+%}
+
+%include <std_shared_ptr.i>
+%include <cartoswig.i>
+
+!shared_ptr(carto::NetworkStatistics, datasources.components.NetworkStatistics)
+
+%attribute(carto::NetworkStatistics, long long, RequestCount, getRequestCount)
+%attribute(carto::NetworkStatistics, long long, FailedRequestCount, getFailedRequestCount)
+%attribute(carto::NetworkStatistics, long long, TransferredBytes, getTransferredBytes)
+%attribute(carto::NetworkStatistics, long long, DecodedBytes, getDecodedBytes)
+%ignore carto::NetworkStatistics::NetworkStatistics;
+!standard_equals(carto::NetworkStatistics);
+
+%include "datasources/components/NetworkStatistics.h"
+
+#endif
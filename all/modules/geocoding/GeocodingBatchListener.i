@@ -0,0 +1,28 @@
+#ifndef _GEOCODINGBATCHLISTENER_I
+#define _GEOCODINGBATCHLISTENER_I
+
+%module(directors="1") GeocodingBatchListener
+
+#ifdef _CARTO_GEOCODING_SUPPORT
+
+!proxy_imports(carto::GeocodingBatchListener, geocoding.GeocodingResult, geocoding.GeocodingResultVector)
+
+%{
+#include "geocoding/GeocodingBatchListener.h"
+#include <memory>
+%}
+
+%include <std_shared_ptr.i>
+%include <cartoswig.i>
+
+%import "geocoding/GeocodingResult.i"
+
+!polymorphic_shared_ptr(carto::GeocodingBatchListener, geocoding.GeocodingBatchListener)
+
+%feature("director") carto::GeocodingBatchListener;
+
+%include "geocoding/GeocodingBatchListener.h"
+
+#endif
+
+#endif
@@ -8,7 +8,7 @@
 
 #if defined(_CARTO_GEOCODING_SUPPORT) && defined(_CARTO_OFFLINE_SUPPORT)
 
-!proxy_imports(carto::OSMOfflineGeocodingService, geocoding.GeocodingService, geocoding.GeocodingRequest, geocoding.GeocodingResult, projections.Projection)
+!proxy_imports(carto::OSMOfflineGeocodingService, geocoding.GeocodingService, geocoding.GeocodingRequest, geocoding.GeocodingRequestVector, geocoding.GeocodingResult, geocoding.GeocodingBatchListener, projections.Projection)
 
 %{
 #include "geocoding/OSMOfflineGeocodingService.h"
@@ -20,6 +20,7 @@
 %include <cartoswig.i>
 
 %import "geocoding/GeocodingService.i"
+%import "geocoding/GeocodingBatchListener.i"
 %import "geocoding/GeocodingRequest.i"
 %import "geocoding/GeocodingResult.i"
 
@@ -29,6 +30,7 @@
 %attributestring(carto::OSMOfflineGeocodingService, std::string, Language, getLanguage, setLanguage)
 %std_io_exceptions(carto::OSMOfflineGeocodingService::OSMOfflineGeocodingService)
 %std_io_exceptions(carto::OSMOfflineGeocodingService::calculateAddresses)
+%std_io_exceptions(carto::OSMOfflineGeocodingService::calculateAddressesBatch)
 
 %feature("director") carto::OSMOfflineGeocodingService;
 
@@ -8,7 +8,7 @@
 
 #if defined(_CARTO_GEOCODING_SUPPORT) && defined(_CARTO_PACKAGEMANAGER_SUPPORT)
 
-!proxy_imports(carto::PackageManagerGeocodingService, geocoding.GeocodingService, geocoding.GeocodingRequest, geocoding.GeocodingResult, packagemanager.PackageManager, projections.Projection)
+!proxy_imports(carto::PackageManagerGeocodingService, geocoding.GeocodingService, geocoding.GeocodingRequest, geocoding.GeocodingRequestVector, geocoding.GeocodingResult, geocoding.GeocodingBatchListener, packagemanager.PackageManager, projections.Projection)
 
 %{
 #include "geocoding/PackageManagerGeocodingService.h"
@@ -20,14 +20,17 @@
 %include <cartoswig.i>
 
 %import "geocoding/GeocodingService.i"
+%import "geocoding/GeocodingBatchListener.i"
 %import "packagemanager/PackageManager.i"
 
 !polymorphic_shared_ptr(carto::PackageManagerGeocodingService, geocoding.PackageManagerGeocodingService)
 
 %attribute(carto::PackageManagerGeocodingService, bool, Autocomplete, isAutocomplete, setAutocomplete)
 %attributestring(carto::PackageManagerGeocodingService, std::string, Language, getLanguage, setLanguage)
+%ignore carto::PackageManagerGeocodingService::getGeocoders;
 %std_exceptions(carto::PackageManagerGeocodingService::PackageManagerGeocodingService)
 %std_io_exceptions(carto::PackageManagerGeocodingService::calculateAddresses)
+%std_io_exceptions(carto::PackageManagerGeocodingService::calculateAddressesBatch)
 
 %feature("director") carto::PackageManagerGeocodingService;
 
@@ -0,0 +1,30 @@
+#ifndef _COLUMNARFEATURECOLLECTION_I
+#define _COLUMNARFEATURECOLLECTION_I
+
+%module ColumnarFeatureCollection
+
+!proxy_imports(carto::ColumnarFeatureCollection, core.Variant, core.StringVector, geometry.Feature, geometry.FeatureVector, geometry.FeatureCollection)
+
+%{
+#include "geometry/ColumnarFeatureCollection.h"
+#include "components/Exceptions.h"
+#include <memory>
+%}
+
+%include <std_shared_ptr.i>
+%include <std_string.i>
+%include <cartoswig.i>
+
+%import "core/Variant.i"
+%import "core/StringVector.i"
+%import "geometry/FeatureCollection.i"
+
+!polymorphic_shared_ptr(carto::ColumnarFeatureCollection, geometry.ColumnarFeatureCollection)
+
+%std_exceptions(carto::ColumnarFeatureCollection::ColumnarFeatureCollection)
+%std_exceptions(carto::ColumnarFeatureCollection::getFeatureProperty)
+%ignore carto::ColumnarFeatureCollection::createFeature;
+
+%include "geometry/ColumnarFeatureCollection.h"
+
+#endif
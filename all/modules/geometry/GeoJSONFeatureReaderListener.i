@@ -0,0 +1,24 @@
+#ifndef _GEOJSONFEATUREREADERLISTENER_I
+#define _GEOJSONFEATUREREADERLISTENER_I
+
+%module(directors="1") GeoJSONFeatureReaderListener
+
+!proxy_imports(carto::GeoJSONFeatureReaderListener, geometry.Feature)
+
+%{
+#include "geometry/GeoJSONFeatureReaderListener.h"
+#include <memory>
+%}
+
+%include <std_shared_ptr.i>
+%include <cartoswig.i>
+
+%import "geometry/Feature.i"
+
+!polymorphic_shared_ptr(carto::GeoJSONFeatureReaderListener, geometry.GeoJSONFeatureReaderListener)
+
+%feature("director") carto::GeoJSONFeatureReaderListener;
+
+%include "geometry/GeoJSONFeatureReaderListener.h"
+
+#endif
@@ -3,7 +3,7 @@
 
 %module GeoJSONGeometryReader
 
-!proxy_imports(carto::GeoJSONGeometryReader, geometry.Feature, geometry.FeatureCollection, geometry.Geometry, projections.Projection)
+!proxy_imports(carto::GeoJSONGeometryReader, geometry.Feature, geometry.FeatureCollection, geometry.GeoJSONFeatureReaderListener, geometry.Geometry, projections.Projection)
 
 %{
 #include "geometry/GeoJSONGeometryReader.h"
@@ -17,13 +17,17 @@
 
 %import "geometry/Feature.i"
 %import "geometry/FeatureCollection.i"
+%import "geometry/GeoJSONFeatureReaderListener.i"
 %import "geometry/Geometry.i"
 %import "projections/Projection.i"
 
 !attributestring_polymorphic(carto::GeoJSONGeometryReader, projections.Projection, TargetProjection, getTargetProjection, setTargetProjection)
+%attribute(carto::GeoJSONGeometryReader, double, CompactCoordinateResolution, getCompactCoordinateResolution, setCompactCoordinateResolution)
 %std_exceptions(carto::GeoJSONGeometryReader::readGeometry)
 %std_exceptions(carto::GeoJSONGeometryReader::readFeature)
 %std_exceptions(carto::GeoJSONGeometryReader::readFeatureCollection)
+%std_io_exceptions(carto::GeoJSONGeometryReader::readFeatureCollectionFile)
+%ignore carto::GeoJSONGeometryReader::readFeatureCollectionBlocks;
 
 %include "geometry/GeoJSONGeometryReader.h"
 
@@ -21,6 +21,8 @@
 !value_type(std::vector<std::shared_ptr<carto::LineGeometry> >, geometry.LineGeometryVector)
 
 %attributeval(carto::LineGeometry, std::vector<carto::MapPos>, Poses, getPoses)
+%ignore carto::LineGeometry::LineGeometry(const std::shared_ptr<const carto::CompactMapPosList>&);
+%ignore carto::LineGeometry::getCompactPoses;
 
 %include "geometry/LineGeometry.h"
 
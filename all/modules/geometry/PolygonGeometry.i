@@ -23,6 +23,8 @@
 %attributeval(carto::PolygonGeometry, std::vector<carto::MapPos>, Poses, getPoses)
 %attributeval(carto::PolygonGeometry, std::vector<std::vector<carto::MapPos> >, Holes, getHoles)
 %attributeval(carto::PolygonGeometry, std::vector<std::vector<carto::MapPos> >, Rings, getRings)
+%ignore carto::PolygonGeometry::PolygonGeometry(std::vector<std::shared_ptr<const carto::CompactMapPosList> >);
+%ignore carto::PolygonGeometry::getCompactRings;
 
 %include "geometry/PolygonGeometry.h"
 
@@ -0,0 +1,25 @@
+#ifndef _VISVALINGAMGEOMETRYSIMPLIFIER_I
+#define _VISVALINGAMGEOMETRYSIMPLIFIER_I
+
+%module VisvalingamGeometrySimplifier
+
+!proxy_imports(carto::VisvalingamGeometrySimplifier, geometry.Geometry, geometry.GeometrySimplifier, projections.Projection)
+
+%{
+#include "geometry/VisvalingamGeometrySimplifier.h"
+#include <memory>
+%}
+
+%include <std_shared_ptr.i>
+%include <cartoswig.i>
+
+%import "core/MapPos.i"
+%import "geometry/GeometrySimplifier.i"
+
+!polymorphic_shared_ptr(carto::VisvalingamGeometrySimplifier, geometry.VisvalingamGeometrySimplifier)
+
+%ignore carto::VisvalingamGeometrySimplifier::simplify;
+
+%include "geometry/VisvalingamGeometrySimplifier.h"
+
+#endif
@@ -5,7 +5,7 @@
 
 #ifdef _CARTO_WKBT_SUPPORT
 
-!proxy_imports(carto::WKBGeometryReader, core.BinaryData, geometry.Geometry)
+!proxy_imports(carto::WKBGeometryReader, core.BinaryData, core.BinaryDataVector, geometry.Geometry, geometry.GeometryVector)
 
 %{
 #include "geometry/WKBGeometryReader.h"
@@ -19,7 +19,9 @@
 %import "core/BinaryData.i"
 %import "geometry/Geometry.i"
 
+%attribute(carto::WKBGeometryReader, double, CompactCoordinateResolution, getCompactCoordinateResolution, setCompactCoordinateResolution)
 %std_exceptions(carto::WKBGeometryReader::readGeometry)
+%std_exceptions(carto::WKBGeometryReader::readGeometries)
 
 %include "geometry/WKBGeometryReader.h"
 
@@ -0,0 +1,32 @@
+#ifndef _BITMAPOVERLAYLAYER_I
+#define _BITMAPOVERLAYLAYER_I
+
+%module BitmapOverlayLayer
+
+!proxy_imports(carto::BitmapOverlayLayer, core.MapPos, core.MapPosVector, core.MapBounds, core.ScreenPos, core.ScreenPosVector, projections.Projection, graphics.Bitmap, layers.Layer)
+
+%{
+#include "layers/BitmapOverlayLayer.h"
+#include "components/Exceptions.h"
+#include <memory>
+%}
+
+%include <std_shared_ptr.i>
+%include <cartoswig.i>
+
+%import "core/MapPos.i"
+%import "core/MapBounds.i"
+%import "core/ScreenPos.i"
+%import "layers/Layer.i"
+%import "projections/Projection.i"
+%import "graphics/Bitmap.i"
+
+!polymorphic_shared_ptr(carto::BitmapOverlayLayer, layers.BitmapOverlayLayer)
+
+%attributestring(carto::BitmapOverlayLayer, std::shared_ptr<carto::Bitmap>, Bitmap, getBitmap)
+%attributeval(carto::BitmapOverlayLayer, carto::MapBounds, DataExtent, getDataExtent)
+%std_exceptions(carto::BitmapOverlayLayer::BitmapOverlayLayer)
+
+%include "layers/BitmapOverlayLayer.h"
+
+#endif
@@ -3,7 +3,7 @@
 
 %module CartoVectorTileLayer
 
-!proxy_imports(carto::CartoVectorTileLayer, datasources.TileDataSource, layers.VectorTileLayer, utils.AssetPackage, vectortiles.VectorTileDecoder)
+!proxy_imports(carto::CartoVectorTileLayer, components.Layers, datasources.TileDataSource, layers.VectorTileLayer, utils.AssetPackage, vectortiles.VectorTileDecoder)
 
 %{
 #include "layers/CartoVectorTileLayer.h"
@@ -14,6 +14,7 @@
 %include <std_shared_ptr.i>
 %include <cartoswig.i>
 
+%import "components/Layers.i"
 %import "layers/VectorTileLayer.i"
 %import "datasources/TileDataSource.i"
 %import "utils/AssetPackage.i"
@@ -25,6 +26,7 @@
 %attributestring(carto::CartoVectorTileLayer, std::string, FallbackLanguage, getFallbackLanguage, setFallbackLanguage)
 %std_exceptions(carto::CartoVectorTileLayer::CartoVectorTileLayer(const std::shared_ptr<TileDataSource>&, const std::shared_ptr<AssetPackage>&))
 %std_exceptions(carto::CartoVectorTileLayer::CreateTileDecoder(const std::shared_ptr<AssetPackage>&))
+%std_exceptions(carto::CartoVectorTileLayer::CreateAsync)
 !objc_rename(createTileDecoderFromAssetPackage) carto::CartoVectorTileLayer::CreateTileDecoder(const std::shared_ptr<AssetPackage>&);
 
 %ignore carto::CartoVectorTileLayer::CreateStyleAssetPackage;
@@ -32,6 +34,7 @@
 %ignore carto::CartoVectorTileLayer::GetStyleSource;
 
 !objc_rename(createTileDecoderFromStyle) carto::CartoVectorTileLayer::CreateTileDecoder(CartoBaseMapStyle::CartoBaseMapStyle style);
+!objc_rename(createAsyncFromAssetPackage) carto::CartoVectorTileLayer::CreateAsync(const std::shared_ptr<TileDataSource>&, const std::shared_ptr<AssetPackage>&, const std::string&, const std::shared_ptr<Layers>&);
 
 %include "layers/CartoVectorTileLayer.h"
 
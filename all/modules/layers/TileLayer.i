@@ -5,10 +5,11 @@
 
 %module TileLayer
 
-!proxy_imports(carto::TileLayer, core.MapPos, core.MapTile, core.MapBounds, datasources.TileDataSource, layers.TileLoadListener, layers.UTFGridEventListener, layers.Layer)
+!proxy_imports(carto::TileLayer, components.CacheStatistics, core.MapPos, core.MapTile, core.MapBounds, datasources.TileDataSource, layers.TileLoadListener, layers.UTFGridEventListener, layers.Layer)
 
 %{
 #include "layers/TileLayer.h"
+#include "components/CacheStatistics.h"
 #include "components/Exceptions.h"
 #include <memory>
 %}
@@ -16,6 +17,7 @@
 %include <std_shared_ptr.i>
 %include <cartoswig.i>
 
+%import "components/CacheStatistics.i"
 %import "datasources/TileDataSource.i"
 %import "layers/Layer.i"
 %import "layers/TileLoadListener.i"
@@ -25,11 +27,14 @@
 
 %attribute(carto::TileLayer, int, FrameNr, getFrameNr, setFrameNr)
 %attribute(carto::TileLayer, bool, Preloading, isPreloading, setPreloading)
+%attribute(carto::TileLayer, bool, PredictivePreloading, isPredictivePreloading, setPredictivePreloading)
 %attribute(carto::TileLayer, bool, SynchronizedRefresh, isSynchronizedRefresh, setSynchronizedRefresh)
 %attribute(carto::TileLayer, carto::TileSubstitutionPolicy::TileSubstitutionPolicy, TileSubstitutionPolicy, getTileSubstitutionPolicy, setTileSubstitutionPolicy)
 %attribute(carto::TileLayer, float, ZoomLevelBias, getZoomLevelBias, setZoomLevelBias)
 %attribute(carto::TileLayer, int, MaxOverzoomLevel, getMaxOverzoomLevel, setMaxOverzoomLevel)
 %attribute(carto::TileLayer, int, MaxUnderzoomLevel, getMaxUnderzoomLevel, setMaxUnderzoomLevel)
+%attribute(carto::TileLayer, std::size_t, RetainedTileDataCacheCapacity, getRetainedTileDataCacheCapacity, setRetainedTileDataCacheCapacity)
+%attribute(carto::TileLayer, int, MaxTileLoadConcurrency, getMaxTileLoadConcurrency, setMaxTileLoadConcurrency)
 !attributestring_polymorphic(carto::TileLayer, datasources.TileDataSource, DataSource, getDataSource)
 !attributestring_polymorphic(carto::TileLayer, datasources.TileDataSource, UTFGridDataSource, getUTFGridDataSource, setUTFGridDataSource)
 !attributestring_polymorphic(carto::TileLayer, layers.TileLoadListener, TileLoadListener, getTileLoadListener, setTileLoadListener)
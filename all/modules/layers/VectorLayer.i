@@ -23,6 +23,7 @@
 !attributestring_polymorphic(carto::VectorLayer, datasources.VectorDataSource, DataSource, getDataSource)
 !attributestring_polymorphic(carto::VectorLayer, layers.VectorElementEventListener, VectorElementEventListener, getVectorElementEventListener, setVectorElementEventListener)
 %attribute(carto::VectorLayer, bool, ZBuffering, isZBuffering, setZBuffering)
+%attribute(carto::VectorLayer, float, PointDecimationCellSize, getPointDecimationCellSize, setPointDecimationCellSize)
 %std_exceptions(carto::VectorLayer::VectorLayer)
 
 %include "layers/VectorLayer.h"
@@ -22,11 +22,15 @@
 !polymorphic_shared_ptr(carto::VectorTileLayer, layers.VectorTileLayer)
 
 %attribute(carto::VectorTileLayer, std::size_t, TileCacheCapacity, getTileCacheCapacity, setTileCacheCapacity)
+%attribute(carto::VectorTileLayer, std::size_t, DecodedTileCacheCapacity, getDecodedTileCacheCapacity, setDecodedTileCacheCapacity)
 %attribute(carto::VectorTileLayer, VectorTileRenderOrder::VectorTileRenderOrder, LabelRenderOrder, getLabelRenderOrder, setLabelRenderOrder)
 %attribute(carto::VectorTileLayer, VectorTileRenderOrder::VectorTileRenderOrder, BuildingRenderOrder, getBuildingRenderOrder, setBuildingRenderOrder)
+%attribute(carto::VectorTileLayer, bool, ProgressiveRendering, isProgressiveRendering, setProgressiveRendering)
 !attributestring_polymorphic(carto::VectorTileLayer, vectortiles.VectorTileDecoder, TileDecoder, getTileDecoder)
 !attributestring_polymorphic(carto::VectorTileLayer, layers.VectorTileEventListener, VectorTileEventListener, getVectorTileEventListener, setVectorTileEventListener)
+!attributestring_polymorphic(carto::VectorTileLayer, layers.VectorTileLayer, SharedRendererLayer, getSharedRendererLayer, setSharedRendererLayer)
 %std_exceptions(carto::VectorTileLayer::VectorTileLayer)
+%std_exceptions(carto::VectorTileLayer::setSharedRendererLayer)
 %ignore carto::VectorTileLayer::FetchTask;
 %ignore carto::VectorTileLayer::getMinZoom;
 %ignore carto::VectorTileLayer::getMaxZoom;
@@ -3,10 +3,11 @@
 
 %module MapRenderer
 
-!proxy_imports(carto::MapRenderer, core.MapPos, core.MapBounds, core.ScreenPos, graphics.ViewState, renderers.MapRendererListener, renderers.RendererCaptureListener, renderers.RedrawRequestListener)
+!proxy_imports(carto::MapRenderer, core.MapPos, core.MapBounds, core.ScreenPos, graphics.ViewState, renderers.MapRendererListener, renderers.RendererCaptureListener, renderers.RedrawRequestListener, renderers.components.FrameStatistics)
 
 %{
 #include "renderers/MapRenderer.h"
+#include "renderers/components/FrameStatistics.h"
 #include "components/Exceptions.h"
 #include <memory>
 %}
@@ -21,10 +22,13 @@
 %import "renderers/MapRendererListener.i"
 %import "renderers/RendererCaptureListener.i"
 %import "renderers/RedrawRequestListener.i"
+%import "renderers/components/FrameStatistics.i"
 
 !shared_ptr(carto::MapRenderer, renderers.MapRenderer)
 
 %attributestring(carto::MapRenderer, std::shared_ptr<carto::MapRendererListener>, MapRendererListener, getMapRendererListener, setMapRendererListener)
+%attribute(carto::MapRenderer, bool, FrameStatisticsEnabled, isFrameStatisticsEnabled, setFrameStatisticsEnabled)
+%attribute(carto::MapRenderer, float, TimeToFirstFrame, getTimeToFirstFrame)
 %std_exceptions(carto::MapRenderer::captureRendering)
 %ignore carto::MapRenderer::MapRenderer;
 %ignore carto::MapRenderer::init;
@@ -36,6 +40,9 @@
 %ignore carto::MapRenderer::getRedrawRequestListener;
 %ignore carto::MapRenderer::setRedrawRequestListener;
 %ignore carto::MapRenderer::calculateCameraEvent;
+%ignore carto::MapRenderer::calculatePredictedViewState;
+%ignore carto::MapRenderer::getViewStateSnapshot;
+%ignore carto::MapRenderer::getCurrentViewStateSnapshot;
 %ignore carto::MapRenderer::moveToFitBounds;
 %ignore carto::MapRenderer::screenToWorld;
 %ignore carto::MapRenderer::worldToScreen;
@@ -54,6 +61,7 @@
 %ignore carto::MapRenderer::registerOnChangeListener;
 %ignore carto::MapRenderer::unregisterOnChangeListener;
 %ignore carto::MapRenderer::addRenderThreadCallback;
+%ignore carto::MapRenderer::clearStyleTextureCache;
 
 !standard_equals(carto::MapRenderer);
 
@@ -3,7 +3,7 @@
 
 %module CullState
 
-!proxy_imports(carto::CullState, core.MapEnvelope, core.MapPos, graphics.ViewState, projections.Projection)
+!proxy_imports(carto::CullState, core.MapBounds, core.MapEnvelope, core.MapPos, graphics.ViewState, projections.Projection)
 
 %{
 #include "components/Exceptions.h"
@@ -14,6 +14,7 @@
 %include <std_shared_ptr.i>
 %include <cartoswig.i>
 
+%import "core/MapBounds.i"
 %import "core/MapEnvelope.i"
 %import "core/MapPos.i"
 %import "graphics/ViewState.i"
@@ -23,7 +24,12 @@
 
 %attributeval(carto::CullState, carto::ViewState, ViewState, getViewState)
 %std_exceptions(carto::CullState::getProjectionEnvelope)
+%std_exceptions(carto::CullState::getProjectionBounds)
 %ignore carto::CullState::getEnvelope;
+%ignore carto::CullState::getPredictedViewState;
+%ignore carto::CullState::getViewStateSnapshot;
+%ignore carto::CullState::CullState(const carto::MapEnvelope&, const carto::ViewState&, const std::shared_ptr<carto::ViewState>&);
+%ignore carto::CullState::CullState(const carto::MapEnvelope&, const std::shared_ptr<const carto::ViewState>&, const std::shared_ptr<carto::ViewState>&);
 !standard_equals(carto::CullState);
 
 %include "renderers/components/CullState.h"
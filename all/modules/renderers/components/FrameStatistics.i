@@ -0,0 +1,40 @@
+#ifndef _FRAMESTATISTICS_I
+#define _FRAMESTATISTICS_I
+
+%module FrameStatistics
+
+!proxy_imports(carto::FrameStatistics, layers.Layer)
+
+%{
+#include "components/Exceptions.h"
+#include "renderers/components/FrameStatistics.h"
+#include <memory>
+%}
+
+%include <std_shared_ptr.i>
+%include <cartoswig.i>
+
+%import "layers/Layer.i"
+
+!shared_ptr(carto::FrameStatistics, renderers.components.FrameStatistics)
+
+%attribute(carto::FrameStatistics, float, CPUTime, getCPUTime)
+%attribute(carto::FrameStatistics, float, GPUTime, getGPUTime)
+%attribute(carto::FrameStatistics, std::size_t, DrawCallCount, getDrawCallCount)
+%attribute(carto::FrameStatistics, std::size_t, VertexCount, getVertexCount)
+%attribute(carto::FrameStatistics, std::size_t, TextureUploadCount, getTextureUploadCount)
+%attribute(carto::FrameStatistics, std::size_t, TextureUploadSize, getTextureUploadSize)
+%attribute(carto::FrameStatistics, int, LayerCount, getLayerCount)
+%std_exceptions(carto::FrameStatistics::getLayer)
+%std_exceptions(carto::FrameStatistics::getLayerCPUTime)
+%std_exceptions(carto::FrameStatistics::getLayerGPUTime)
+%std_exceptions(carto::FrameStatistics::getLayerDrawCallCount)
+%std_exceptions(carto::FrameStatistics::getLayerVertexCount)
+%std_exceptions(carto::FrameStatistics::getLayerTextureUploadCount)
+%ignore carto::FrameStatistics::FrameStatistics;
+%ignore carto::FrameStatistics::LayerStatistics;
+%ignore carto::FrameStatistics::getLayerStatistics;
+
+%include "renderers/components/FrameStatistics.h"
+
+#endif
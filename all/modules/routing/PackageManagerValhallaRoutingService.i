@@ -5,7 +5,7 @@
 
 #if defined(_CARTO_ROUTING_SUPPORT) && defined(_CARTO_VALHALLA_ROUTING_SUPPORT) && defined(_CARTO_PACKAGEMANAGER_SUPPORT)
 
-!proxy_imports(carto::PackageManagerValhallaRoutingService, packagemanager.PackageManager, routing.RoutingService, routing.RoutingRequest, routing.RoutingResult, routing.RouteMatchingRequest, routing.RouteMatchingResult)
+!proxy_imports(carto::PackageManagerValhallaRoutingService, packagemanager.PackageManager, routing.RoutingService, routing.RoutingRequest, routing.RoutingResult, routing.RouteMatchingRequest, routing.RouteMatchingResult, routing.RoutingMatrixRequest, routing.RoutingMatrixResult)
 
 %{
 #include "routing/PackageManagerValhallaRoutingService.h"
@@ -22,14 +22,18 @@
 %import "routing/RoutingResult.i"
 %import "routing/RouteMatchingRequest.i"
 %import "routing/RouteMatchingResult.i"
+%import "routing/RoutingMatrixRequest.i"
+%import "routing/RoutingMatrixResult.i"
 %import "packagemanager/PackageManager.i"
 
 !polymorphic_shared_ptr(carto::PackageManagerValhallaRoutingService, routing.PackageManagerValhallaRoutingService)
 
 %attributestring(carto::PackageManagerValhallaRoutingService, std::string, Profile, getProfile, setProfile)
+%attribute(carto::PackageManagerValhallaRoutingService, std::size_t, TileCacheCapacity, getTileCacheCapacity, setTileCacheCapacity)
 %std_exceptions(carto::PackageManagerValhallaRoutingService::PackageManagerValhallaRoutingService)
 %std_io_exceptions(carto::PackageManagerValhallaRoutingService::matchRoute)
 %std_io_exceptions(carto::PackageManagerValhallaRoutingService::calculateRoute)
+%std_io_exceptions(carto::PackageManagerValhallaRoutingService::calculateMatrix)
 
 %feature("director") carto::PackageManagerValhallaRoutingService;
 
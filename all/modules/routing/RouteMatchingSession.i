@@ -0,0 +1,34 @@
+#ifndef _ROUTEMATCHINGSESSION_I
+#define _ROUTEMATCHINGSESSION_I
+
+%module RouteMatchingSession
+
+#if defined(_CARTO_ROUTING_SUPPORT) && defined(_CARTO_VALHALLA_ROUTING_SUPPORT)
+
+!proxy_imports(carto::RouteMatchingSession, core.MapPos, projections.Projection)
+
+%{
+#include "routing/RouteMatchingSession.h"
+#include "components/Exceptions.h"
+#include <memory>
+%}
+
+%include <std_shared_ptr.i>
+%include <cartoswig.i>
+
+%import "core/MapPos.i"
+%import "projections/Projection.i"
+
+!shared_ptr(carto::RouteMatchingSession, routing.RouteMatchingSession)
+
+%attributestring(carto::RouteMatchingSession, std::shared_ptr<carto::Projection>, Projection, getProjection)
+%attribute(carto::RouteMatchingSession, float, Accuracy, getAccuracy)
+%ignore carto::RouteMatchingSession::RouteMatchingSession;
+%std_io_exceptions(carto::RouteMatchingSession::addPoint)
+!standard_equals(carto::RouteMatchingSession);
+
+%include "routing/RouteMatchingSession.h"
+
+#endif
+
+#endif
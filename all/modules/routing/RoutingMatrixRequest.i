@@ -0,0 +1,37 @@
+#ifndef _ROUTINGMATRIXREQUEST_I
+#define _ROUTINGMATRIXREQUEST_I
+
+#pragma SWIG nowarn=325
+
+%module RoutingMatrixRequest
+
+#ifdef _CARTO_ROUTING_SUPPORT
+
+!proxy_imports(carto::RoutingMatrixRequest, core.MapPos, core.MapPosVector, projections.Projection)
+
+%{
+#include "routing/RoutingMatrixRequest.h"
+#include "components/Exceptions.h"
+#include <memory>
+%}
+
+%include <std_shared_ptr.i>
+%include <cartoswig.i>
+
+%import "core/MapPos.i"
+%import "projections/Projection.i"
+
+!shared_ptr(carto::RoutingMatrixRequest, routing.RoutingMatrixRequest)
+
+%attributestring(carto::RoutingMatrixRequest, std::shared_ptr<carto::Projection>, Projection, getProjection)
+%attributeval(carto::RoutingMatrixRequest, std::vector<carto::MapPos>, Sources, getSources)
+%attributeval(carto::RoutingMatrixRequest, std::vector<carto::MapPos>, Targets, getTargets)
+%std_exceptions(carto::RoutingMatrixRequest::RoutingMatrixRequest)
+!standard_equals(carto::RoutingMatrixRequest);
+!custom_tostring(carto::RoutingMatrixRequest);
+
+%include "routing/RoutingMatrixRequest.h"
+
+#endif
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef _ROUTINGMATRIXRESULT_I
+#define _ROUTINGMATRIXRESULT_I
+
+#pragma SWIG nowarn=325
+
+%module RoutingMatrixResult
+
+#ifdef _CARTO_ROUTING_SUPPORT
+
+!proxy_imports(carto::RoutingMatrixResult)
+
+%{
+#include "routing/RoutingMatrixResult.h"
+#include "components/Exceptions.h"
+#include <memory>
+%}
+
+%include <std_shared_ptr.i>
+%include <cartoswig.i>
+
+!shared_ptr(carto::RoutingMatrixResult, routing.RoutingMatrixResult)
+
+%attribute(carto::RoutingMatrixResult, int, SourceCount, getSourceCount)
+%attribute(carto::RoutingMatrixResult, int, TargetCount, getTargetCount)
+%ignore carto::RoutingMatrixResult::RoutingMatrixResult;
+%std_exceptions(carto::RoutingMatrixResult::getDuration)
+%std_exceptions(carto::RoutingMatrixResult::getDistance)
+!standard_equals(carto::RoutingMatrixResult);
+!custom_tostring(carto::RoutingMatrixResult);
+
+%include "routing/RoutingMatrixResult.h"
+
+#endif
+
+#endif
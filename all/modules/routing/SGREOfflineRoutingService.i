@@ -26,7 +26,9 @@
 
 %attributestring(carto::SGREOfflineRoutingService, std::string, Profile, getProfile, setProfile)
 %std_io_exceptions(carto::SGREOfflineRoutingService::SGREOfflineRoutingService)
+%std_exceptions(carto::SGREOfflineRoutingService::prepare)
 %std_io_exceptions(carto::SGREOfflineRoutingService::calculateRoute)
+%ignore carto::SGREOfflineRoutingService::getRouteFinderPool;
 
 %feature("director") carto::SGREOfflineRoutingService;
 
@@ -5,7 +5,7 @@
 
 #if defined(_CARTO_ROUTING_SUPPORT) && defined(_CARTO_VALHALLA_ROUTING_SUPPORT) && defined(_CARTO_OFFLINE_SUPPORT)
 
-!proxy_imports(carto::ValhallaOfflineRoutingService, routing.RoutingService, routing.RoutingRequest, routing.RoutingResult, routing.RouteMatchingRequest, routing.RouteMatchingResult)
+!proxy_imports(carto::ValhallaOfflineRoutingService, routing.RoutingService, routing.RoutingRequest, routing.RoutingResult, routing.RouteMatchingRequest, routing.RouteMatchingResult, routing.RouteMatchingSession, projections.Projection, routing.RoutingMatrixRequest, routing.RoutingMatrixResult)
 
 %{
 #include "routing/ValhallaOfflineRoutingService.h"
@@ -22,13 +22,20 @@
 %import "routing/RoutingResult.i"
 %import "routing/RouteMatchingRequest.i"
 %import "routing/RouteMatchingResult.i"
+%import "routing/RouteMatchingSession.i"
+%import "projections/Projection.i"
+%import "routing/RoutingMatrixRequest.i"
+%import "routing/RoutingMatrixResult.i"
 
 !polymorphic_shared_ptr(carto::ValhallaOfflineRoutingService, routing.ValhallaOfflineRoutingService)
 
 %attributestring(carto::ValhallaOfflineRoutingService, std::string, Profile, getProfile, setProfile)
+%attribute(carto::ValhallaOfflineRoutingService, std::size_t, TileCacheCapacity, getTileCacheCapacity, setTileCacheCapacity)
 %std_io_exceptions(carto::ValhallaOfflineRoutingService::ValhallaOfflineRoutingService)
 %std_io_exceptions(carto::ValhallaOfflineRoutingService::matchRoute)
+%std_exceptions(carto::ValhallaOfflineRoutingService::createMatchingSession)
 %std_io_exceptions(carto::ValhallaOfflineRoutingService::calculateRoute)
+%std_io_exceptions(carto::ValhallaOfflineRoutingService::calculateMatrix)
 
 %feature("director") carto::ValhallaOfflineRoutingService;
 
@@ -27,8 +27,10 @@
 
 %attributestring(carto::FeatureCollectionSearchService, std::shared_ptr<carto::Projection>, Projection, getProjection)
 %attributestring(carto::FeatureCollectionSearchService, std::shared_ptr<carto::FeatureCollection>, FeatureCollection, getFeatureCollection)
+%attribute(carto::FeatureCollectionSearchService, bool, SpatialIndexEnabled, isSpatialIndexEnabled, setSpatialIndexEnabled)
 %std_exceptions(carto::FeatureCollectionSearchService::FeatureCollectionSearchService)
 %std_exceptions(carto::FeatureCollectionSearchService::findFeatures)
+%ignore carto::FeatureCollectionSearchService::getSpatialIndex;
 
 %feature("director") carto::FeatureCollectionSearchService;
 
@@ -0,0 +1,28 @@
+#ifndef _VECTORTILESEARCHLISTENER_I
+#define _VECTORTILESEARCHLISTENER_I
+
+%module(directors="1") VectorTileSearchListener
+
+#ifdef _CARTO_SEARCH_SUPPORT
+
+!proxy_imports(carto::VectorTileSearchListener, geometry.VectorTileFeature)
+
+%{
+#include "search/VectorTileSearchListener.h"
+#include <memory>
+%}
+
+%include <std_shared_ptr.i>
+%include <cartoswig.i>
+
+%import "geometry/VectorTileFeature.i"
+
+!polymorphic_shared_ptr(carto::VectorTileSearchListener, search.VectorTileSearchListener)
+
+%feature("director") carto::VectorTileSearchListener;
+
+%include "search/VectorTileSearchListener.h"
+
+#endif
+
+#endif
@@ -8,7 +8,7 @@
 
 #ifdef _CARTO_SEARCH_SUPPORT
 
-!proxy_imports(carto::VectorTileSearchService, search.SearchRequest, datasources.TileDataSource, geometry.VectorTileFeatureCollection, vectortiles.VectorTileDecoder, projections.Projection)
+!proxy_imports(carto::VectorTileSearchService, search.SearchRequest, datasources.TileDataSource, geometry.VectorTileFeatureCollection, search.VectorTileSearchListener, vectortiles.VectorTileDecoder, projections.Projection)
 
 %{
 #include "search/VectorTileSearchService.h"
@@ -21,6 +21,7 @@
 
 %import "geometry/VectorTileFeatureCollection.i"
 %import "search/SearchRequest.i"
+%import "search/VectorTileSearchListener.i"
 %import "datasources/TileDataSource.i"
 %import "vectortiles/VectorTileDecoder.i"
 %import "projections/Projection.i"
@@ -31,6 +32,8 @@
 %attributestring(carto::VectorTileSearchService, std::shared_ptr<carto::VectorTileDecoder>, TileDecoder, getTileDecoder)
 %attribute(carto::VectorTileSearchService, int, MinZoom, getMinZoom, setMinZoom)
 %attribute(carto::VectorTileSearchService, int, MaxZoom, getMaxZoom, setMaxZoom)
+%attribute(carto::VectorTileSearchService, int, MaxResults, getMaxResults, setMaxResults)
+%attribute(carto::VectorTileSearchService, bool, MostDetailedZoomOnly, isMostDetailedZoomOnly, setMostDetailedZoomOnly)
 %std_exceptions(carto::VectorTileSearchService::VectorTileSearchService)
 %std_exceptions(carto::VectorTileSearchService::findFeatures)
 
@@ -7,7 +7,7 @@
 
 #ifdef _CARTO_SERVICES_SUPPORT
 
-!proxy_imports(carto::CartoSQLService, core.Variant, geometry.FeatureCollection, projections.Projection)
+!proxy_imports(carto::CartoSQLService, core.Variant, datasources.LocalVectorDataSource, geometry.FeatureCollection, geometry.GeoJSONFeatureReaderListener, projections.Projection, styles.Style)
 
 %{
 #include "services/CartoSQLService.h"
@@ -21,8 +21,11 @@
 %include <cartoswig.i>
 
 %import "core/Variant.i"
+%import "datasources/LocalVectorDataSource.i"
 %import "geometry/FeatureCollection.i"
+%import "geometry/GeoJSONFeatureReaderListener.i"
 %import "projections/Projection.i"
+%import "styles/Style.i"
 
 !shared_ptr(carto::CartoSQLService, services.CartoSQLService)
 
@@ -31,6 +34,7 @@
 %attributestring(carto::CartoSQLService, std::string, APITemplate, getAPITemplate, setAPITemplate)
 %std_io_exceptions(carto::CartoSQLService::queryData)
 %std_io_exceptions(carto::CartoSQLService::queryFeatures)
+%std_io_exceptions(carto::CartoSQLService::queryFeaturesMBVT)
 !standard_equals(carto::CartoSQLService);
 
 %include "services/CartoSQLService.h"
@@ -3,7 +3,7 @@
 
 %module BaseMapView
 
-!proxy_imports(carto::BaseMapView, core.MapPos, core.MapVec, core.MapBounds, core.ScreenPos, core.ScreenBounds, components.Options, components.Layers, components.LicenseManagerListener, renderers.MapRenderer, renderers.RedrawRequestListener, ui.MapEventListener)
+!proxy_imports(carto::BaseMapView, core.MapPos, core.MapVec, core.MapBounds, core.ScreenPos, core.ScreenBounds, components.MapEngine, components.Options, components.Layers, components.LicenseManagerListener, components.MemoryPressureLevel, renderers.MapRenderer, renderers.RedrawRequestListener, ui.MapEventListener)
 
 %{
 #include "ui/BaseMapView.h"
@@ -18,9 +18,11 @@
 %import "core/ScreenPos.i"
 %import "core/ScreenBounds.i"
 %import "core/MapVec.i"
+%import "components/MapEngine.i"
 %import "components/Options.i"
 %import "components/Layers.i"
 %import "components/LicenseManagerListener.i"
+%import "components/MemoryPressureLevel.i"
 %import "renderers/MapRenderer.i"
 %import "renderers/RedrawRequestListener.i"
 %import "ui/MapEventListener.i"
@@ -0,0 +1,30 @@
+#ifndef _CAMERAPATHBENCHMARK_I
+#define _CAMERAPATHBENCHMARK_I
+
+%module CameraPathBenchmark
+
+!proxy_imports(carto::CameraPathBenchmark, core.MapPos, ui.OffscreenMapRenderer)
+
+%{
+#include "ui/CameraPathBenchmark.h"
+#include "components/Exceptions.h"
+#include <memory>
+%}
+
+%include <std_shared_ptr.i>
+%include <cartoswig.i>
+
+%import "core/MapPos.i"
+%import "ui/OffscreenMapRenderer.i"
+
+!shared_ptr(carto::CameraPathBenchmark, ui.CameraPathBenchmark)
+
+%attribute(carto::CameraPathBenchmark, int, FrameCount, getFrameCount)
+%attribute(carto::CameraPathBenchmark, float, AverageViewCompleteTime, getAverageViewCompleteTime)
+%attribute(carto::CameraPathBenchmark, float, MaxViewCompleteTime, getMaxViewCompleteTime)
+%attribute(carto::CameraPathBenchmark, float, TotalTime, getTotalTime)
+%std_exceptions(carto::CameraPathBenchmark::CameraPathBenchmark)
+
+%include "ui/CameraPathBenchmark.h"
+
+#endif
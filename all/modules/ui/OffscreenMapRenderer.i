@@ -0,0 +1,32 @@
+#ifndef _OFFSCREENMAPRENDERER_I
+#define _OFFSCREENMAPRENDERER_I
+
+%module OffscreenMapRenderer
+
+!proxy_imports(carto::OffscreenMapRenderer, core.MapPos, components.Options, components.Layers, graphics.Bitmap)
+
+%{
+#include "ui/OffscreenMapRenderer.h"
+#include "components/Exceptions.h"
+#include <memory>
+%}
+
+%include <std_shared_ptr.i>
+%include <cartoswig.i>
+
+%import "core/MapPos.i"
+%import "components/Options.i"
+%import "components/Layers.i"
+%import "graphics/Bitmap.i"
+
+!shared_ptr(carto::OffscreenMapRenderer, ui.OffscreenMapRenderer)
+
+%attribute(carto::OffscreenMapRenderer, int, Width, getWidth)
+%attribute(carto::OffscreenMapRenderer, int, Height, getHeight)
+%std_exceptions(carto::OffscreenMapRenderer::OffscreenMapRenderer)
+%ignore carto::OffscreenMapRenderer::RedrawListener;
+%ignore carto::OffscreenMapRenderer::CaptureListener;
+
+%include "ui/OffscreenMapRenderer.h"
+
+#endif
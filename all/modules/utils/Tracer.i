@@ -0,0 +1,20 @@
+#ifndef _TRACER_I
+#define _TRACER_I
+
+%module Tracer
+
+!proxy_imports(carto::Tracer)
+
+%{
+#include "utils/Tracer.h"
+#include "components/Exceptions.h"
+%}
+
+%include <std_string.i>
+%include <cartoswig.i>
+
+%std_io_exceptions(carto::Tracer::Start)
+
+%include "utils/Tracer.h"
+
+#endif
@@ -31,6 +31,7 @@
 %std_exceptions(carto::Billboard::Billboard)
 %std_exceptions(carto::Billboard::setBaseBillboard)
 %std_exceptions(carto::Billboard::setGeometry)
+%std_exceptions(carto::Billboard::setTrajectory)
 %ignore carto::Billboard::getDrawData;
 %ignore carto::Billboard::setDrawData;
 
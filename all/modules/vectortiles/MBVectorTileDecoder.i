@@ -25,6 +25,7 @@
 %attributeval(carto::MBVectorTileDecoder, std::vector<std::string>, StyleParameters, getStyleParameters)
 %attributestring(carto::MBVectorTileDecoder, std::shared_ptr<carto::CompiledStyleSet>, CompiledStyle, getCompiledStyleSet, setCompiledStyleSet)
 %attributestring(carto::MBVectorTileDecoder, std::shared_ptr<carto::CartoCSSStyleSet>, CartoCSSStyle, getCartoCSSStyleSet, setCartoCSSStyleSet)
+%attribute(carto::MBVectorTileDecoder, int, DecoderThreadCount, getDecoderThreadCount, setDecoderThreadCount)
 %std_exceptions(carto::MBVectorTileDecoder::MBVectorTileDecoder)
 %std_exceptions(carto::MBVectorTileDecoder::setCompiledStyleSet)
 %std_exceptions(carto::MBVectorTileDecoder::setCartoCSSStyleSet)
@@ -39,6 +40,8 @@
 %ignore carto::MBVectorTileDecoder::decodeFeature;
 %ignore carto::MBVectorTileDecoder::decodeFeatures;
 %ignore carto::MBVectorTileDecoder::decodeTile;
+%ignore carto::MBVectorTileDecoder::decodeTilePart;
+%ignore carto::MBVectorTileDecoder::isProgressiveDecodingSupported;
 %ignore carto::MBVectorTileDecoder::getMapSettings;
 %ignore carto::MBVectorTileDecoder::loadMapnikMap;
 %ignore carto::MBVectorTileDecoder::loadCartoCSSMap;
@@ -27,7 +27,10 @@
 %ignore carto::VectorTileDecoder::decodeFeature;
 %ignore carto::VectorTileDecoder::decodeFeatures;
 %ignore carto::VectorTileDecoder::decodeTile;
+%ignore carto::VectorTileDecoder::decodeTilePart;
+%ignore carto::VectorTileDecoder::isProgressiveDecodingSupported;
 %ignore carto::VectorTileDecoder::getMapSettings;
+%ignore carto::VectorTileDecoder::getStateKey;
 %ignore carto::VectorTileDecoder::OnChangeListener;
 %ignore carto::VectorTileDecoder::registerOnChangeListener;
 %ignore carto::VectorTileDecoder::unregisterOnChangeListener;
@@ -0,0 +1,48 @@
+#include "CacheStatistics.h"
+
+#include <sstream>
+
+namespace carto {
+
+    CacheStatistics::CacheStatistics(std::size_t size, std::size_t capacity, long long hitCount, long long missCount) :
+        _size(size),
+        _capacity(capacity),
+        _hitCount(hitCount),
+        _missCount(missCount)
+    {
+    }
+
+    CacheStatistics::~CacheStatistics() {
+    }
+
+    std::size_t CacheStatistics::getSize() const {
+        return _size;
+    }
+
+    std::size_t CacheStatistics::getCapacity() const {
+        return _capacity;
+    }
+
+    long long CacheStatistics::getHitCount() const {
+        return _hitCount;
+    }
+
+    long long CacheStatistics::getMissCount() const {
+        return _missCount;
+    }
+
+    float CacheStatistics::getHitRate() const {
+        long long lookupCount = _hitCount + _missCount;
+        if (lookupCount <= 0) {
+            return 0;
+        }
+        return static_cast<float>(static_cast<double>(_hitCount) / lookupCount);
+    }
+
+    std::string CacheStatistics::toString() const {
+        std::stringstream ss;
+        ss << "CacheStatistics [size=" << _size << ", capacity=" << _capacity << ", hitCount=" << _hitCount << ", missCount=" << _missCount << ", hitRate=" << getHitRate() << "]";
+        return ss.str();
+    }
+
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_CACHESTATISTICS_H_
+#define _CARTO_CACHESTATISTICS_H_
+
+#include <cstddef>
+#include <string>
+
+namespace carto {
+
+    /**
+     * Snapshot of the usage statistics of a cache. The hit and miss counts are accumulated
+     * since the cache was created or its statistics were reset.
+     */
+    class CacheStatistics {
+    public:
+        /**
+         * Constructs a new CacheStatistics instance.
+         * @param size The current size of the cache in bytes.
+         * @param capacity The capacity of the cache in bytes.
+         * @param hitCount The number of lookups that were served from the cache.
+         * @param missCount The number of lookups that were not served from the cache.
+         */
+        CacheStatistics(std::size_t size, std::size_t capacity, long long hitCount, long long missCount);
+        virtual ~CacheStatistics();
+
+        /**
+         * Returns the current size of the cache.
+         * @return The size of the cache in bytes.
+         */
+        std::size_t getSize() const;
+        /**
+         * Returns the capacity of the cache.
+         * @return The capacity of the cache in bytes.
+         */
+        std::size_t getCapacity() const;
+        /**
+         * Returns the number of lookups that were served from the cache.
+         * @return The number of cache hits.
+         */
+        long long getHitCount() const;
+        /**
+         * Returns the number of lookups that were not served from the cache.
+         * @return The number of cache misses.
+         */
+        long long getMissCount() const;
+        /**
+         * Returns the ratio of cache hits to all lookups.
+         * @return The hit rate between 0 and 1, or 0 if there were no lookups.
+         */
+        float getHitRate() const;
+
+        /**
+         * Creates a string representation of this statistics object, useful for logging.
+         * @return The string representation of this statistics object.
+         */
+        std::string toString() const;
+
+    private:
+        std::size_t _size;
+        std::size_t _capacity;
+        long long _hitCount;
+        long long _missCount;
+    };
+
+}
+
+#endif
@@ -1,106 +1,197 @@
 #include "CancelableThreadPool.h"
 #include "utils/Log.h"
 #include "utils/ThreadUtils.h"
+#include "utils/Tracer.h"
 
-#include "core/MapPos.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
 
 namespace carto {
 
     CancelableThreadPool::CancelableThreadPool() :
         _poolSize(0),
         _taskCount(0),
+        _nextQueueIndex(0),
+        _pendingTaskCount(0),
+        _idleWorkerCount(0),
+        _executedTaskCount(0),
+        _executedTaskTime(0),
+        _qosClass(ThreadQoSClass::UTILITY),
         _stop(false),
-        _taskRecords(),
+        _sharedQueue(std::make_shared<TaskQueue>()),
+        _taskQueues(std::make_shared<TaskQueueList>()),
+        _taskGroupStates(),
         _workers(),
         _threads(),
         _mutex()
     {
     }
-    
+
     CancelableThreadPool::~CancelableThreadPool() {
     }
-        
+
     void CancelableThreadPool::deinit() {
         {
             std::lock_guard<std::mutex> lock(_mutex);
             _stop = true;
         }
-        
+
         cancelAll();
-        
+
         {
             std::lock_guard<std::mutex> lock(_mutex);
+            _taskGroupStates.clear();
             _condition.notify_all();
         }
-        
+
         for (const std::shared_ptr<std::thread>& thread : _threads) {
             thread->detach();
         }
-        
+
         _workers.clear();
         _threads.clear();
     }
-    
+
     int CancelableThreadPool::getPoolSize() const {
         std::lock_guard<std::mutex> lock(_mutex);
         return _poolSize;
     }
-    
+
     void CancelableThreadPool::setPoolSize(int poolSize) {
         std::lock_guard<std::mutex> lock(_mutex);
-        
+
         if (_stop) {
             return;
         }
-    
-        // Add threads
-        for (int i = _poolSize; i < poolSize; i++) {
+
+        // Add threads. Surplus threads will terminate themselves once they notice the pool size change
+        for (int i = static_cast<int>(_workers.size()); i < poolSize; i++) {
             _workers.push_back(std::make_shared<TaskWorker>(shared_from_this()));
             _threads.push_back(std::make_shared<std::thread>(&TaskWorker::operator(), _workers.back()));
         }
-    
+        updateTaskQueues();
+
+        if (poolSize < _poolSize) {
+            _condition.notify_all();
+        }
         _poolSize = poolSize;
     }
-    
+
+    ThreadQoSClass::ThreadQoSClass CancelableThreadPool::getQoSClass() const {
+        return static_cast<ThreadQoSClass::ThreadQoSClass>(_qosClass.load());
+    }
+
+    void CancelableThreadPool::setQoSClass(ThreadQoSClass::ThreadQoSClass qosClass) {
+        _qosClass = qosClass;
+    }
+
     void CancelableThreadPool::execute(std::shared_ptr<CancelableTask> task) {
         execute(task, DEFAULT_PRIORITY);
     }
-    
+
     void CancelableThreadPool::execute(std::shared_ptr<CancelableTask> task, int priority) {
+        execute(task, priority, std::shared_ptr<TaskGroup>());
+    }
+
+    void CancelableThreadPool::execute(std::shared_ptr<CancelableTask> task, int priority, const std::shared_ptr<TaskGroup>& taskGroup) {
         if (!task->isCanceled()) {
-            std::lock_guard<std::mutex> lock(_mutex);
-            
             if (_stop) {
                 return;
             }
-    
-            // Push task to queue, increase global task count
-            _taskRecords.push(TaskRecord(task, priority, _taskCount));
-            _taskCount++;
-    
+
+            // Push task to one of the worker queues, increase global task count
+            _pendingTaskCount++;
+            pushTaskRecord(TaskRecord(task, priority, _taskCount++, taskGroup));
+
             // If there are any waiting threads, notify one of them
-            _condition.notify_one();
+            if (_idleWorkerCount > 0) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _condition.notify_one();
+            }
         }
     }
-    
+
     void CancelableThreadPool::cancelAll() {
         std::lock_guard<std::mutex> lock(_mutex);
-        
-        std::size_t taskRecordsSize = _taskRecords.size();
-        for (std::size_t i = 0; i < taskRecordsSize; i++) {
-            const std::shared_ptr<CancelableTask>& task = _taskRecords.top()._task;
-            task->cancel();
-            _taskRecords.pop();
+
+        std::size_t canceledCount = _sharedQueue->cancelAll();
+        std::shared_ptr<const TaskQueueList> taskQueues = std::atomic_load(&_taskQueues);
+        for (const std::shared_ptr<TaskQueue>& taskQueue : *taskQueues) {
+            canceledCount += taskQueue->cancelAll();
+        }
+        _pendingTaskCount -= static_cast<int>(canceledCount);
+
+        // Postponed tasks are not counted as pending tasks
+        for (auto it = _taskGroupStates.begin(); it != _taskGroupStates.end(); ) {
+            TaskRecordQueue& parkedTaskRecords = it->second._parkedTaskRecords;
+            while (!parkedTaskRecords.empty()) {
+                parkedTaskRecords.top()._task->cancel();
+                parkedTaskRecords.pop();
+            }
+            if (it->second._runningCount == 0) {
+                it = _taskGroupStates.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void CancelableThreadPool::removeCanceled() {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        std::size_t removedCount = _sharedQueue->removeCanceled();
+        std::shared_ptr<const TaskQueueList> taskQueues = std::atomic_load(&_taskQueues);
+        for (const std::shared_ptr<TaskQueue>& taskQueue : *taskQueues) {
+            removedCount += taskQueue->removeCanceled();
+        }
+        _pendingTaskCount -= static_cast<int>(removedCount);
+
+        for (auto& taskGroupState : _taskGroupStates) {
+            std::vector<TaskRecord> taskRecords;
+            TaskRecordQueue& parkedTaskRecords = taskGroupState.second._parkedTaskRecords;
+            while (!parkedTaskRecords.empty()) {
+                if (!parkedTaskRecords.top()._task->isCanceled()) {
+                    taskRecords.push_back(parkedTaskRecords.top());
+                }
+                parkedTaskRecords.pop();
+            }
+            parkedTaskRecords = TaskRecordQueue(taskRecords.begin(), taskRecords.end());
         }
     }
-    
-    CancelableThreadPool::TaskRecord::TaskRecord(std::shared_ptr<CancelableTask> task, int priority, long long sequence) :
+
+    int CancelableThreadPool::getQueuedTaskCount() const {
+        return std::max(0, _pendingTaskCount.load());
+    }
+
+    long long CancelableThreadPool::getExecutedTaskCount() const {
+        return _executedTaskCount;
+    }
+
+    float CancelableThreadPool::getAverageTaskTime() const {
+        long long executedTaskCount = _executedTaskCount;
+        if (executedTaskCount == 0) {
+            return 0;
+        }
+        return static_cast<float>(_executedTaskTime * 1.0e-6 / executedTaskCount);
+    }
+
+    CancelableThreadPool::TaskRecord::TaskRecord() :
+        _task(),
+        _priority(0),
+        _sequence(0),
+        _taskGroup()
+    {
+    }
+
+    CancelableThreadPool::TaskRecord::TaskRecord(std::shared_ptr<CancelableTask> task, int priority, long long sequence, std::shared_ptr<TaskGroup> taskGroup) :
         _task(task),
         _priority(priority),
-        _sequence(sequence)
+        _sequence(sequence),
+        _taskGroup(taskGroup)
     {
     }
-    
+
     bool CancelableThreadPool::TaskRecord::operator <(const TaskRecord& taskRecord) const {
         // Tasks are sorted according to their priority and then their sequence
         if (_priority != taskRecord._priority) {
@@ -108,11 +199,106 @@ namespace carto {
         }
         return _sequence > taskRecord._sequence;
     }
-    
+
+    CancelableThreadPool::TaskGroupState::TaskGroupState() :
+        _runningCount(0),
+        _parkedTaskRecords()
+    {
+    }
+
+    CancelableThreadPool::TaskQueue::TaskQueue() :
+        _taskRecords(),
+        _closed(false),
+        _topPriority(EMPTY_PRIORITY),
+        _mutex()
+    {
+    }
+
+    bool CancelableThreadPool::TaskQueue::push(const TaskRecord& taskRecord) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_closed) {
+            return false;
+        }
+        _taskRecords.push(taskRecord);
+        _topPriority = _taskRecords.top()._priority;
+        return true;
+    }
+
+    bool CancelableThreadPool::TaskQueue::pop(TaskRecord& taskRecord) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_taskRecords.empty()) {
+            return false;
+        }
+        taskRecord = _taskRecords.top();
+        _taskRecords.pop();
+        _topPriority = _taskRecords.empty() ? EMPTY_PRIORITY : _taskRecords.top()._priority;
+        return true;
+    }
+
+    std::vector<CancelableThreadPool::TaskRecord> CancelableThreadPool::TaskQueue::close() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<TaskRecord> taskRecords;
+        while (!_taskRecords.empty()) {
+            taskRecords.push_back(_taskRecords.top());
+            _taskRecords.pop();
+        }
+        _closed = true;
+        _topPriority = EMPTY_PRIORITY;
+        return taskRecords;
+    }
+
+    std::size_t CancelableThreadPool::TaskQueue::cancelAll() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::size_t taskRecordsSize = _taskRecords.size();
+        for (std::size_t i = 0; i < taskRecordsSize; i++) {
+            const std::shared_ptr<CancelableTask>& task = _taskRecords.top()._task;
+            task->cancel();
+            _taskRecords.pop();
+        }
+        _topPriority = EMPTY_PRIORITY;
+        return taskRecordsSize;
+    }
+
+    std::size_t CancelableThreadPool::TaskQueue::removeCanceled() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<TaskRecord> taskRecords;
+        taskRecords.reserve(_taskRecords.size());
+        std::size_t removedCount = 0;
+        while (!_taskRecords.empty()) {
+            if (_taskRecords.top()._task->isCanceled()) {
+                removedCount++;
+            } else {
+                taskRecords.push_back(_taskRecords.top());
+            }
+            _taskRecords.pop();
+        }
+        _taskRecords = TaskRecordQueue(taskRecords.begin(), taskRecords.end());
+        _topPriority = _taskRecords.empty() ? EMPTY_PRIORITY : _taskRecords.top()._priority;
+        return removedCount;
+    }
+
+    const int CancelableThreadPool::TaskQueue::EMPTY_PRIORITY = std::numeric_limits<int>::min();
+
+    CancelableThreadPool::TaskGroup::TaskGroup(int maxConcurrency) :
+        _maxConcurrency(maxConcurrency)
+    {
+    }
+
+    int CancelableThreadPool::TaskGroup::getMaxConcurrency() const {
+        return _maxConcurrency;
+    }
+
+    void CancelableThreadPool::TaskGroup::setMaxConcurrency(int maxConcurrency) {
+        _maxConcurrency = maxConcurrency;
+    }
+
     CancelableThreadPool::TaskWorker::TaskWorker(const std::shared_ptr<CancelableThreadPool>& threadPool) :
-        _threadPool(threadPool) {
+        _threadPool(threadPool),
+        _taskQueue(std::make_shared<TaskQueue>()),
+        _qosClass(-1)
+    {
     }
-        
+
     void CancelableThreadPool::TaskWorker::operator ()() {
         ThreadUtils::SetThreadPriority(ThreadPriority::MINIMUM);
         while (true) {
@@ -121,84 +307,203 @@ namespace carto {
                 return;
             }
 
-            // If there are no tasks, wait until notified or exit thread if interrupted
-            {
-                std::unique_lock<std::mutex> lock(threadPool->_mutex);
-                if (threadPool->_stop) {
-                    return;
+            if (threadPool->_stop) {
+                return;
+            }
+
+            // Request another task, execute it if it's not null. Tasks of groups at their concurrency limit are postponed
+            TaskRecord taskRecord;
+            if (threadPool->getNextTask(*this, taskRecord)) {
+                if (taskRecord._taskGroup && !threadPool->startGroupTask(taskRecord)) {
+                    continue;
                 }
-                
-                if (threadPool->_taskRecords.size() == 0) {
-                    threadPool->_condition.wait(lock);
+
+                const std::shared_ptr<CancelableTask>& task = taskRecord._task;
+
+                int qosClass = threadPool->_qosClass;
+                if (_qosClass != qosClass) {
+                    ThreadUtils::SetThreadQoSClass(static_cast<ThreadQoSClass::ThreadQoSClass>(qosClass));
+                    _qosClass = qosClass;
                 }
-            }
-    
-            // Request another task, execute it if it's not null
-            while (true) {
+
+                auto taskStartTime = std::chrono::steady_clock::now();
                 {
-                    std::lock_guard<std::mutex> lock(threadPool->_mutex);
-                    if (threadPool->_stop) {
-                        return;
-                    }
-                }
-                
-                std::shared_ptr<CancelableTask> task = threadPool->getNextTask();
-                if (task) {
+                    Tracer::Span span("CancelableThreadPool::task");
                     task->operator ()();
-                } else {
-                    break;
                 }
-    
+                threadPool->_executedTaskTime += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - taskStartTime).count();
+                threadPool->_executedTaskCount++;
+                if (taskRecord._taskGroup) {
+                    threadPool->finishGroupTask(taskRecord._taskGroup);
+                }
+
                 if (threadPool->shouldTerminateWorker(*this)) {
                     return;
                 }
-    
+
                 // Check for interruption
                 std::this_thread::yield();
+                continue;
+            }
+
+            // If there are no tasks, wait until notified or exit thread if interrupted
+            if (!threadPool->waitForTasks()) {
+                return;
+            }
+
+            if (threadPool->shouldTerminateWorker(*this)) {
+                return;
+            }
+        }
+    }
+
+    void CancelableThreadPool::pushTaskRecord(const TaskRecord& taskRecord) {
+        // Distribute tasks between worker queues in round-robin order. If the selected queue
+        // was closed by a terminating worker or there are no workers, use the shared queue.
+        std::shared_ptr<const TaskQueueList> taskQueues = std::atomic_load(&_taskQueues);
+        if (!taskQueues->empty()) {
+            unsigned int index = _nextQueueIndex++ % static_cast<unsigned int>(taskQueues->size());
+            if ((*taskQueues)[index]->push(taskRecord)) {
+                return;
+            }
+        }
+        _sharedQueue->push(taskRecord);
+    }
+
+    void CancelableThreadPool::updateTaskQueues() {
+        // Must be called while holding the pool mutex
+        auto taskQueues = std::make_shared<TaskQueueList>();
+        for (const std::shared_ptr<TaskWorker>& worker : _workers) {
+            taskQueues->push_back(worker->_taskQueue);
+        }
+        std::atomic_store(&_taskQueues, std::shared_ptr<const TaskQueueList>(taskQueues));
+    }
+
+    bool CancelableThreadPool::getNextTask(const TaskWorker& worker, TaskRecord& taskRecord) {
+        std::shared_ptr<const TaskQueueList> taskQueues = std::atomic_load(&_taskQueues);
+
+        while (true) {
+            // Find the queue with the highest priority task. Prefer own queue, then the shared queue, then steal from others.
+            std::shared_ptr<TaskQueue> bestTaskQueue = worker._taskQueue;
+            int bestPriority = bestTaskQueue->_topPriority;
+            if (_sharedQueue->_topPriority > bestPriority) {
+                bestTaskQueue = _sharedQueue;
+                bestPriority = _sharedQueue->_topPriority;
+            }
+            for (const std::shared_ptr<TaskQueue>& taskQueue : *taskQueues) {
+                int priority = taskQueue->_topPriority;
+                if (priority > bestPriority) {
+                    bestTaskQueue = taskQueue;
+                    bestPriority = priority;
+                }
+            }
+            if (bestPriority == TaskQueue::EMPTY_PRIORITY) {
+                return false;
+            }
+
+            // Try to pop the task. This may fail if another worker was faster, in that case retry
+            if (bestTaskQueue->pop(taskRecord)) {
+                _pendingTaskCount--;
+                return true;
             }
         }
     }
-    
-    std::shared_ptr<CancelableTask> CancelableThreadPool::getNextTask() {
+
+    bool CancelableThreadPool::startGroupTask(const TaskRecord& taskRecord) {
         std::lock_guard<std::mutex> lock(_mutex);
-    
-        // Return the next highest priority task from the task queue
-        std::shared_ptr<CancelableTask> task;
-        if (_taskRecords.size() > 0) {
-            task = _taskRecords.top()._task;
-            _taskRecords.pop();
+
+        // If the group is at its limit, postpone the task until a running task of the group finishes
+        TaskGroupState& taskGroupState = _taskGroupStates[taskRecord._taskGroup];
+        int maxConcurrency = taskRecord._taskGroup->getMaxConcurrency();
+        if (maxConcurrency > 0 && taskGroupState._runningCount >= maxConcurrency) {
+            taskGroupState._parkedTaskRecords.push(taskRecord);
+            return false;
+        }
+        taskGroupState._runningCount++;
+        return true;
+    }
+
+    void CancelableThreadPool::finishGroupTask(const std::shared_ptr<TaskGroup>& taskGroup) {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        auto it = _taskGroupStates.find(taskGroup);
+        if (it == _taskGroupStates.end()) {
+            return;
         }
-        return task;
+        TaskGroupState& taskGroupState = it->second;
+        taskGroupState._runningCount--;
+
+        // Resume the postponed tasks that fit into the limit. If the limit was removed, resume all of them
+        int maxConcurrency = taskGroup->getMaxConcurrency();
+        int resumedCount = 0;
+        while (!taskGroupState._parkedTaskRecords.empty() && (maxConcurrency <= 0 || taskGroupState._runningCount + resumedCount < maxConcurrency)) {
+            _pendingTaskCount++;
+            pushTaskRecord(taskGroupState._parkedTaskRecords.top());
+            taskGroupState._parkedTaskRecords.pop();
+            resumedCount++;
+        }
+        if (resumedCount > 0 && _idleWorkerCount > 0) {
+            _condition.notify_all();
+        }
+
+        if (taskGroupState._runningCount <= 0 && taskGroupState._parkedTaskRecords.empty()) {
+            _taskGroupStates.erase(it);
+        }
+    }
+
+    bool CancelableThreadPool::waitForTasks() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_stop) {
+            return false;
+        }
+
+        // The idle counter must be increased before checking the pending task count, otherwise notifications could be lost
+        _idleWorkerCount++;
+        if (_pendingTaskCount <= 0) {
+            _condition.wait(lock);
+        }
+        _idleWorkerCount--;
+        return !_stop;
     }
-    
+
     bool CancelableThreadPool::shouldTerminateWorker(TaskWorker& worker) {
         std::lock_guard<std::mutex> lock(_mutex);
-        
+
         if (_stop) {
             return true;
         }
-    
+
         // If there are too many threads, remove this worker and it's thread
         if (static_cast<int>(_threads.size()) > _poolSize) {
-    
+
             // Find the index of the finished worker, it's thread will have the same index in _threads vector
             int index = 0;
             WorkerList::iterator it;
             for (it = _workers.begin(); it != _workers.end(); ++it) {
                 const std::shared_ptr<TaskWorker>& listWorker = *it;
                 if (listWorker.get() == &worker) {
-                    // Remove thread and worker
+                    // Remove thread and worker. The thread must be detached as it is still running.
+                    _threads[index]->detach();
                     _workers.erase(it);
                     _threads.erase(_threads.begin() + index);
                     break;
                 }
                 index++;
             }
-    
+            updateTaskQueues();
+
+            // Move the remaining tasks of the worker to other queues
+            for (const TaskRecord& taskRecord : worker._taskQueue->close()) {
+                pushTaskRecord(taskRecord);
+            }
+            if (_idleWorkerCount > 0) {
+                _condition.notify_all();
+            }
+
             return true;
         }
-    
+
         return false;
     }
-    
+
 }
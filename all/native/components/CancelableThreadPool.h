@@ -9,70 +9,154 @@
 
 #include "components/CancelableTask.h"
 #include "components/ThreadWorker.h"
+#include "utils/ThreadUtils.h"
 
+#include <atomic>
 #include <condition_variable>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <queue>
 #include <thread>
+#include <vector>
 
 namespace carto {
 
+    /**
+     * Work-stealing thread pool for cancelable tasks.
+     * Each worker owns a separate priority queue, new tasks are distributed between the queues
+     * and idle workers steal the highest priority tasks from other queues. Thus the pool does not
+     * have a single lock that all workers and producers must contend for.
+     */
     class CancelableThreadPool : public std::enable_shared_from_this<CancelableThreadPool> {
     public:
+        class TaskGroup;
+
         CancelableThreadPool();
         virtual ~CancelableThreadPool();
         void deinit();
-    
+
         int getPoolSize() const;
         void setPoolSize(int threadCount);
-    
+
+        ThreadQoSClass::ThreadQoSClass getQoSClass() const;
+        void setQoSClass(ThreadQoSClass::ThreadQoSClass qosClass); // applied by the workers before their next task
+
         void execute(std::shared_ptr<CancelableTask>);
         void execute(std::shared_ptr<CancelableTask>, int priority);
-    
+        void execute(std::shared_ptr<CancelableTask>, int priority, const std::shared_ptr<TaskGroup>& taskGroup);
+
         void cancelAll();
-        
+        void removeCanceled();
+
+        int getQueuedTaskCount() const;
+        long long getExecutedTaskCount() const;
+        float getAverageTaskTime() const; // in seconds
+
     private:
         struct TaskRecord {
-            TaskRecord(std::shared_ptr<CancelableTask> task, int priority, long long sequence);
-    
+            TaskRecord();
+            TaskRecord(std::shared_ptr<CancelableTask> task, int priority, long long sequence, std::shared_ptr<TaskGroup> taskGroup);
+
             bool operator <(const TaskRecord& taskRecord) const;
-    
+
             std::shared_ptr<CancelableTask> _task;
             int _priority;
             long long _sequence;
+            std::shared_ptr<TaskGroup> _taskGroup;
         };
-    
+
+        typedef std::priority_queue<TaskRecord> TaskRecordQueue;
+
+        struct TaskGroupState {
+            TaskGroupState();
+
+            int _runningCount;
+            TaskRecordQueue _parkedTaskRecords; // tasks postponed because the group was at its concurrency limit
+        };
+
+        struct TaskQueue {
+            TaskQueue();
+
+            bool push(const TaskRecord& taskRecord);
+            bool pop(TaskRecord& taskRecord);
+            std::vector<TaskRecord> close();
+            std::size_t cancelAll();
+            std::size_t removeCanceled();
+
+            TaskRecordQueue _taskRecords;
+            bool _closed;
+            std::atomic<int> _topPriority;
+            mutable std::mutex _mutex;
+
+            static const int EMPTY_PRIORITY;
+        };
+
         struct TaskWorker : public ThreadWorker {
             TaskWorker(const std::shared_ptr<CancelableThreadPool>& threadPool);
-    
+
             void operator()();
-    
+
             std::weak_ptr<CancelableThreadPool> _threadPool;
+            std::shared_ptr<TaskQueue> _taskQueue;
+            int _qosClass; // the QoS class applied to the worker thread, -1 if not applied yet
         };
-    
-        typedef std::priority_queue<TaskRecord> TaskRecordQueue;
+
         typedef std::vector<std::shared_ptr<TaskWorker> > WorkerList;
         typedef std::vector<std::shared_ptr<std::thread> > ThreadList;
-    
-        std::shared_ptr<CancelableTask> getNextTask();
-    
+        typedef std::vector<std::shared_ptr<TaskQueue> > TaskQueueList;
+
+        void pushTaskRecord(const TaskRecord& taskRecord);
+        void updateTaskQueues();
+
+        bool getNextTask(const TaskWorker& worker, TaskRecord& taskRecord);
+
+        bool startGroupTask(const TaskRecord& taskRecord);
+        void finishGroupTask(const std::shared_ptr<TaskGroup>& taskGroup);
+
+        bool waitForTasks();
+
         bool shouldTerminateWorker(TaskWorker& worker);
-    
+
         static const int DEFAULT_PRIORITY = 0;
-    
+
         int _poolSize;
-        long long _taskCount;
-        
-        bool _stop;
-    
-        TaskRecordQueue _taskRecords;
+        std::atomic<long long> _taskCount;
+        std::atomic<unsigned int> _nextQueueIndex;
+        std::atomic<int> _pendingTaskCount;
+        std::atomic<int> _idleWorkerCount;
+        std::atomic<long long> _executedTaskCount;
+        std::atomic<long long> _executedTaskTime; // in microseconds
+
+        std::atomic<int> _qosClass;
+        std::atomic<bool> _stop;
+
+        std::shared_ptr<TaskQueue> _sharedQueue;
+        std::shared_ptr<const TaskQueueList> _taskQueues;
+        std::map<std::shared_ptr<TaskGroup>, TaskGroupState> _taskGroupStates;
         WorkerList _workers;
         ThreadList _threads;
-    
+
         mutable std::mutex _mutex;
         std::condition_variable _condition;
     };
-    
+
+    /**
+     * A class of tasks with bounded concurrency within a thread pool.
+     * Tasks of the group beyond the limit are postponed until a running task of the same group finishes,
+     * so a group of slow tasks can not occupy all threads of the pool and the threads remain available for other tasks.
+     */
+    class CancelableThreadPool::TaskGroup {
+    public:
+        explicit TaskGroup(int maxConcurrency);
+
+        int getMaxConcurrency() const;
+        void setMaxConcurrency(int maxConcurrency); // 0 means no limit
+
+    private:
+        std::atomic<int> _maxConcurrency;
+    };
+
 }
 
 #endif
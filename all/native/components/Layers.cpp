@@ -8,10 +8,12 @@ namespace carto {
 
     Layers::Layers(const std::shared_ptr<CancelableThreadPool>& envelopeThreadPool,
                    const std::shared_ptr<CancelableThreadPool>& tileThreadPool,
+                   const std::shared_ptr<CancelableThreadPool>& tileDecodeThreadPool,
                    const std::weak_ptr<Options>& options) :
         _layers(),
         _envelopeThreadPool(envelopeThreadPool),
         _tileThreadPool(tileThreadPool),
+        _tileDecodeThreadPool(tileDecodeThreadPool),
         _options(options),
         _mapRenderer(),
         _touchHandler(),
@@ -58,11 +60,11 @@ namespace carto {
 
             std::shared_ptr<Layer> oldLayer = _layers[index];
             if (std::find(_layers.begin(), _layers.end(), layer) == _layers.end()) {
-                layer->setComponents(_envelopeThreadPool, _tileThreadPool, _options, _mapRenderer, _touchHandler);
+                layer->setComponents(_envelopeThreadPool, _tileThreadPool, _tileDecodeThreadPool, _options, _mapRenderer, _touchHandler);
             }
             _layers[index] = layer;
             if (std::find(_layers.begin(), _layers.end(), oldLayer) == _layers.end()) {
-                oldLayer->setComponents(std::shared_ptr<CancelableThreadPool>(), std::shared_ptr<CancelableThreadPool>(), std::shared_ptr<Options>(), std::weak_ptr<MapRenderer>(), std::weak_ptr<TouchHandler>());
+                oldLayer->setComponents(std::shared_ptr<CancelableThreadPool>(), std::shared_ptr<CancelableThreadPool>(), std::shared_ptr<CancelableThreadPool>(), std::shared_ptr<Options>(), std::weak_ptr<MapRenderer>(), std::weak_ptr<TouchHandler>());
             }
         
             mapRenderer = _mapRenderer.lock();
@@ -86,13 +88,13 @@ namespace carto {
             std::vector<std::shared_ptr<Layer> > oldLayers = _layers;
             for (const std::shared_ptr<Layer>& layer : layers) {
                 if (std::find(_layers.begin(), _layers.end(), layer) == _layers.end()) {
-                    layer->setComponents(_envelopeThreadPool, _tileThreadPool, _options, _mapRenderer, _touchHandler);
+                    layer->setComponents(_envelopeThreadPool, _tileThreadPool, _tileDecodeThreadPool, _options, _mapRenderer, _touchHandler);
                 }
             }
             _layers = layers;
             for (const std::shared_ptr<Layer>& oldLayer : oldLayers) {
                 if (std::find(_layers.begin(), _layers.end(), oldLayer) == _layers.end()) {
-                    oldLayer->setComponents(std::shared_ptr<CancelableThreadPool>(), std::shared_ptr<CancelableThreadPool>(), std::shared_ptr<Options>(), std::weak_ptr<MapRenderer>(), std::weak_ptr<TouchHandler>());
+                    oldLayer->setComponents(std::shared_ptr<CancelableThreadPool>(), std::shared_ptr<CancelableThreadPool>(), std::shared_ptr<CancelableThreadPool>(), std::shared_ptr<Options>(), std::weak_ptr<MapRenderer>(), std::weak_ptr<TouchHandler>());
                 }
             }
 
@@ -119,7 +121,7 @@ namespace carto {
             }
 
             if (std::find(_layers.begin(), _layers.end(), layer) == _layers.end()) {
-                layer->setComponents(_envelopeThreadPool, _tileThreadPool, _options, _mapRenderer, _touchHandler);
+                layer->setComponents(_envelopeThreadPool, _tileThreadPool, _tileDecodeThreadPool, _options, _mapRenderer, _touchHandler);
             }
             _layers.insert(_layers.begin() + index, layer);
 
@@ -149,7 +151,7 @@ namespace carto {
             std::lock_guard<std::mutex> lock(_mutex);
             for (const std::shared_ptr<Layer>& layer : layers) {
                 if (std::find(_layers.begin(), _layers.end(), layer) == _layers.end()) {
-                    layer->setComponents(_envelopeThreadPool, _tileThreadPool, _options, _mapRenderer, _touchHandler);
+                    layer->setComponents(_envelopeThreadPool, _tileThreadPool, _tileDecodeThreadPool, _options, _mapRenderer, _touchHandler);
                 }
                 _layers.push_back(layer);
             }
@@ -189,7 +191,7 @@ namespace carto {
                 }
                 _layers.erase(it, _layers.end());
                 if (std::find(_layers.begin(), _layers.end(), layer) == _layers.end()) {
-                    layer->setComponents(std::shared_ptr<CancelableThreadPool>(), std::shared_ptr<CancelableThreadPool>(), std::shared_ptr<Options>(), std::weak_ptr<MapRenderer>(), std::weak_ptr<TouchHandler>());
+                    layer->setComponents(std::shared_ptr<CancelableThreadPool>(), std::shared_ptr<CancelableThreadPool>(), std::shared_ptr<CancelableThreadPool>(), std::shared_ptr<Options>(), std::weak_ptr<MapRenderer>(), std::weak_ptr<TouchHandler>());
                 }
             }
 
@@ -31,6 +31,7 @@ namespace carto {
     public:
         Layers(const std::shared_ptr<CancelableThreadPool>& envelopeThreadPool,
                const std::shared_ptr<CancelableThreadPool>& tileThreadPool,
+               const std::shared_ptr<CancelableThreadPool>& tileDecodeThreadPool,
                const std::weak_ptr<Options>& options);
         virtual ~Layers();
         
@@ -114,6 +115,7 @@ namespace carto {
     
         std::shared_ptr<CancelableThreadPool> _envelopeThreadPool;
         std::shared_ptr<CancelableThreadPool> _tileThreadPool;
+        std::shared_ptr<CancelableThreadPool> _tileDecodeThreadPool;
         std::weak_ptr<Options> _options;
         
         std::weak_ptr<MapRenderer> _mapRenderer;
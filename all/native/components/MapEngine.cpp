@@ -0,0 +1,38 @@
+#include "MapEngine.h"
+#include "components/CancelableThreadPool.h"
+#include "utils/ThreadUtils.h"
+
+namespace carto {
+
+    MapEngine::MapEngine() :
+        _envelopeThreadPool(std::make_shared<CancelableThreadPool>()),
+        _tileThreadPool(std::make_shared<CancelableThreadPool>()),
+        _tileDecodeThreadPool(std::make_shared<CancelableThreadPool>())
+    {
+        // Envelope calculations and tile decoding are needed for the next frames, tile loading is mostly waiting for IO
+        _envelopeThreadPool->setQoSClass(ThreadQoSClass::USER_INITIATED);
+        _tileThreadPool->setQoSClass(ThreadQoSClass::UTILITY);
+        _tileDecodeThreadPool->setQoSClass(ThreadQoSClass::USER_INITIATED);
+    }
+
+    MapEngine::~MapEngine() {
+        // Set stop flag and detach every thread, once the thread quits
+        // all objects they hold will be released
+        _envelopeThreadPool->deinit();
+        _tileThreadPool->deinit();
+        _tileDecodeThreadPool->deinit();
+    }
+
+    const std::shared_ptr<CancelableThreadPool>& MapEngine::getEnvelopeThreadPool() const {
+        return _envelopeThreadPool;
+    }
+
+    const std::shared_ptr<CancelableThreadPool>& MapEngine::getTileThreadPool() const {
+        return _tileThreadPool;
+    }
+
+    const std::shared_ptr<CancelableThreadPool>& MapEngine::getTileDecodeThreadPool() const {
+        return _tileDecodeThreadPool;
+    }
+
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_MAPENGINE_H_
+#define _CARTO_MAPENGINE_H_
+
+#include <memory>
+
+namespace carto {
+    class CancelableThreadPool;
+
+    /**
+     * A shared context for map views that are shown at the same time.
+     * Map views attached to the same engine share the envelope, tile loading and tile decoding worker pools,
+     * while each view keeps its own renderer. Data sources, decoders and memory caches like MemoryCacheTileDataSource
+     * can be used by layers of all attached views, so identical tiles are fetched and cached only once.
+     * Note: thread pool size options of the attached views apply to the shared pools.
+     */
+    class MapEngine {
+    public:
+        /**
+         * Constructs a new map engine with its own worker pools.
+         */
+        MapEngine();
+        virtual ~MapEngine();
+
+        /**
+         * Returns the shared envelope calculation thread pool.
+         * @return The shared envelope calculation thread pool.
+         */
+        const std::shared_ptr<CancelableThreadPool>& getEnvelopeThreadPool() const;
+        /**
+         * Returns the shared tile loading thread pool.
+         * @return The shared tile loading thread pool.
+         */
+        const std::shared_ptr<CancelableThreadPool>& getTileThreadPool() const;
+        /**
+         * Returns the shared tile decoding thread pool.
+         * @return The shared tile decoding thread pool.
+         */
+        const std::shared_ptr<CancelableThreadPool>& getTileDecodeThreadPool() const;
+
+    private:
+        std::shared_ptr<CancelableThreadPool> _envelopeThreadPool;
+        std::shared_ptr<CancelableThreadPool> _tileThreadPool;
+        std::shared_ptr<CancelableThreadPool> _tileDecodeThreadPool;
+    };
+
+}
+
+#endif
@@ -0,0 +1,45 @@
+#include "MemoryAccounting.h"
+#include "components/TileCacheManager.h"
+
+namespace carto {
+
+    std::size_t MemoryAccounting::GetSize(MemoryCategory::MemoryCategory category) {
+        if (category < 0 || category >= CATEGORY_COUNT) {
+            return 0;
+        }
+
+        // Tile caches are already tracked by the tile cache manager. Their sizes are queried instead of counted
+        if (category == MemoryCategory::MEMORY_CATEGORY_TILE_CACHES) {
+            return TileCacheManager::GetInstance().getTotalSize();
+        }
+
+        long long size = _Sizes[category].load(std::memory_order_relaxed);
+        return size > 0 ? static_cast<std::size_t>(size) : 0;
+    }
+
+    std::size_t MemoryAccounting::GetTotalSize() {
+        std::size_t totalSize = 0;
+        for (int i = 0; i < CATEGORY_COUNT; i++) {
+            totalSize += GetSize(static_cast<MemoryCategory::MemoryCategory>(i));
+        }
+        return totalSize;
+    }
+
+    void MemoryAccounting::Allocate(MemoryCategory::MemoryCategory category, std::size_t size) {
+        if (category >= 0 && category < CATEGORY_COUNT) {
+            _Sizes[category].fetch_add(static_cast<long long>(size), std::memory_order_relaxed);
+        }
+    }
+
+    void MemoryAccounting::Release(MemoryCategory::MemoryCategory category, std::size_t size) {
+        if (category >= 0 && category < CATEGORY_COUNT) {
+            _Sizes[category].fetch_sub(static_cast<long long>(size), std::memory_order_relaxed);
+        }
+    }
+
+    MemoryAccounting::MemoryAccounting() {
+    }
+
+    std::atomic<long long> MemoryAccounting::_Sizes[MemoryAccounting::CATEGORY_COUNT];
+
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_MEMORYACCOUNTING_H_
+#define _CARTO_MEMORYACCOUNTING_H_
+
+#include "components/MemoryCategory.h"
+
+#include <atomic>
+#include <cstddef>
+
+namespace carto {
+
+    /**
+     * Process-wide accounting of the memory used by the SDK, per category.
+     * The sizes are estimates based on the sizes of the cached objects, not on the actual allocations.
+     */
+    class MemoryAccounting {
+    public:
+        /**
+         * Returns the current memory usage of the given category.
+         * @param category The memory category.
+         * @return The memory usage in bytes.
+         */
+        static std::size_t GetSize(MemoryCategory::MemoryCategory category);
+        /**
+         * Returns the total memory usage of all categories.
+         * @return The memory usage in bytes.
+         */
+        static std::size_t GetTotalSize();
+
+        /**
+         * Adds an allocation to the given category. Used internally by the SDK.
+         * @param category The memory category.
+         * @param size The allocated size in bytes.
+         */
+        static void Allocate(MemoryCategory::MemoryCategory category, std::size_t size);
+        /**
+         * Removes an allocation from the given category. Used internally by the SDK.
+         * @param category The memory category.
+         * @param size The released size in bytes.
+         */
+        static void Release(MemoryCategory::MemoryCategory category, std::size_t size);
+
+    private:
+        MemoryAccounting();
+
+        static const int CATEGORY_COUNT = MemoryCategory::MEMORY_CATEGORY_TEXTURES + 1;
+
+        static std::atomic<long long> _Sizes[CATEGORY_COUNT];
+    };
+
+}
+
+#endif
@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_MEMORYCATEGORY_H_
+#define _CARTO_MEMORYCATEGORY_H_
+
+namespace carto {
+
+    namespace MemoryCategory {
+        /**
+         * Categories of memory tracked by the SDK.
+         */
+        enum MemoryCategory {
+            /**
+             * Decoded tiles in the visible and preloading caches of tile layers.
+             */
+            MEMORY_CATEGORY_TILE_CACHES,
+            /**
+             * Textures uploaded to the graphics memory.
+             */
+            MEMORY_CATEGORY_TEXTURES
+        };
+    }
+
+}
+
+#endif
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_MEMORYPRESSURELEVEL_H_
+#define _CARTO_MEMORYPRESSURELEVEL_H_
+
+namespace carto {
+
+    namespace MemoryPressureLevel {
+        /**
+         * Memory pressure levels. Each level releases everything released by the lower levels.
+         */
+        enum MemoryPressureLevel {
+            /**
+             * Release preloading tile caches.
+             */
+            MEMORY_PRESSURE_LEVEL_LOW,
+            /**
+             * Release style textures that are not currently used.
+             */
+            MEMORY_PRESSURE_LEVEL_MODERATE,
+            /**
+             * Release cached meshes and textures of 3D model layers.
+             */
+            MEMORY_PRESSURE_LEVEL_HIGH,
+            /**
+             * Release in-memory tile data source caches.
+             */
+            MEMORY_PRESSURE_LEVEL_SEVERE,
+            /**
+             * Release visible tile caches. Visible tiles stay on screen until the map is redrawn with new tiles.
+             */
+            MEMORY_PRESSURE_LEVEL_CRITICAL
+        };
+    }
+
+}
+
+#endif
@@ -19,12 +19,16 @@
 
 namespace carto {
 
-    Options::Options(const std::shared_ptr<CancelableThreadPool>& envelopeThreadPool, const std::shared_ptr<CancelableThreadPool>& tileThreadPool) :
+    Options::Options(const std::shared_ptr<CancelableThreadPool>& envelopeThreadPool, const std::shared_ptr<CancelableThreadPool>& tileThreadPool, const std::shared_ptr<CancelableThreadPool>& tileDecodeThreadPool) :
         _ambientLightColor(DEFAULT_AMBIENT_LIGHT_COLOR),
         _mainLightColor(DEFAULT_MAIN_LIGHT_COLOR),
         _mainLightDir(DEFAULT_MAIN_LIGHT_DIR),
         _renderProjectionMode(RenderProjectionMode::RENDER_PROJECTION_MODE_PLANAR),
         _clickTypeDetection(true),
+        _gpuPicking(false),
+        _maxFPS(0),
+        _staticLayerCaching(false),
+        _shaderCachePath(),
         _tileDrawSize(256),
         _dpi(160.0f),
         _drawDistance(16),
@@ -49,6 +53,7 @@ namespace carto {
         _kineticPan(true),
         _kineticRotation(true),
         _kineticZoom(true),
+        _touchPrediction(false),
         _rotatable(true),
         _tiltRange(Const::MIN_SUPPORTED_TILT_ANGLE, 90.0f),
         _zoomRange(0.0, Const::MAX_SUPPORTED_ZOOM_LEVEL),
@@ -58,10 +63,20 @@ namespace carto {
         _projectionSurface(std::make_shared<PlanarProjectionSurface>()),
         _envelopeThreadPool(envelopeThreadPool),
         _tileThreadPool(tileThreadPool),
-        _mutex()
+        _tileDecodeThreadPool(tileDecodeThreadPool),
+        _mutex(),
+        _snapshot(),
+        _updateDepth(0),
+        _pendingOptionNames(),
+        _onChangeListeners(),
+        _onChangeListenersMutex()
     {
-        setEnvelopeThreadPoolSize(1);
-        setTileThreadPoolSize(1);
+        updateSnapshot();
+
+        // Pools shared with other map views keep their current sizes
+        setEnvelopeThreadPoolSize(std::max(1, envelopeThreadPool->getPoolSize()));
+        setTileThreadPoolSize(std::max(1, tileThreadPool->getPoolSize()));
+        setTileDecodeThreadPoolSize(std::max(1, tileDecodeThreadPool->getPoolSize()));
     }
     
     Options::~Options() {
@@ -157,6 +172,70 @@ namespace carto {
         }
         notifyOptionChanged("ClickTypeDetection");
     }
+
+    bool Options::isGPUPicking() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _gpuPicking;
+    }
+
+    void Options::setGPUPicking(bool enabled) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_gpuPicking == enabled) {
+                return;
+            }
+            _gpuPicking = enabled;
+        }
+        notifyOptionChanged("GPUPicking");
+    }
+
+    int Options::getMaxFPS() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _maxFPS;
+    }
+
+    void Options::setMaxFPS(int maxFPS) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_maxFPS == maxFPS) {
+                return;
+            }
+            _maxFPS = maxFPS;
+        }
+        notifyOptionChanged("MaxFPS");
+    }
+
+    bool Options::isStaticLayerCaching() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _staticLayerCaching;
+    }
+
+    void Options::setStaticLayerCaching(bool enabled) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_staticLayerCaching == enabled) {
+                return;
+            }
+            _staticLayerCaching = enabled;
+        }
+        notifyOptionChanged("StaticLayerCaching");
+    }
+
+    std::string Options::getShaderCachePath() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _shaderCachePath;
+    }
+
+    void Options::setShaderCachePath(const std::string& path) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_shaderCachePath == path) {
+                return;
+            }
+            _shaderCachePath = path;
+        }
+        notifyOptionChanged("ShaderCachePath");
+    }
     
     int Options::getTileDrawSize() const {
         std::lock_guard<std::mutex> lock(_mutex);
@@ -350,6 +429,22 @@ namespace carto {
         notifyOptionChanged("TileThreadPoolSize");
     }
     
+    int Options::getTileDecodeThreadPoolSize() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _tileDecodeThreadPool->getPoolSize();
+    }
+    
+    void Options::setTileDecodeThreadPoolSize(int poolSize) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_tileDecodeThreadPool->getPoolSize() == poolSize) {
+                return;
+            }
+            _tileDecodeThreadPool->setPoolSize(poolSize);
+        }
+        notifyOptionChanged("TileDecodeThreadPoolSize");
+    }
+    
     Color Options::getClearColor() const {
         std::lock_guard<std::mutex> lock(_mutex);
         return _clearColor;
@@ -556,6 +651,22 @@ namespace carto {
         }
         notifyOptionChanged("KineticZoom");
     }
+
+    bool Options::isTouchPrediction() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _touchPrediction;
+    }
+
+    void Options::setTouchPrediction(bool enabled) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_touchPrediction == enabled) {
+                return;
+            }
+            _touchPrediction = enabled;
+        }
+        notifyOptionChanged("TouchPrediction");
+    }
     
     bool Options::isRotatable() const {
         std::lock_guard<std::mutex> lock(_mutex);
@@ -720,6 +831,37 @@ namespace carto {
         return _projectionSurface;
     }
     
+    std::shared_ptr<const Options::Snapshot> Options::getSnapshot() const {
+        return std::atomic_load(&_snapshot);
+    }
+
+    void Options::beginUpdate() {
+        std::lock_guard<std::mutex> lock(_onChangeListenersMutex);
+        _updateDepth++;
+    }
+
+    void Options::endUpdate() {
+        std::vector<std::string> optionNames;
+        std::vector<std::shared_ptr<OnChangeListener> > onChangeListeners;
+        {
+            std::lock_guard<std::mutex> lock(_onChangeListenersMutex);
+            if (_updateDepth <= 0) {
+                Log::Error("Options::endUpdate: No matching beginUpdate call");
+                return;
+            }
+            if (--_updateDepth > 0) {
+                return;
+            }
+            std::swap(optionNames, _pendingOptionNames);
+            onChangeListeners = _onChangeListeners;
+        }
+        for (const std::string& optionName : optionNames) {
+            for (const std::shared_ptr<OnChangeListener>& listener : onChangeListeners) {
+                listener->onOptionChanged(optionName);
+            }
+        }
+    }
+
     void Options::registerOnChangeListener(const std::shared_ptr<OnChangeListener>& listener) {
         std::lock_guard<std::mutex> lock(_onChangeListenersMutex);
         _onChangeListeners.push_back(listener);
@@ -763,9 +905,18 @@ namespace carto {
     }
         
     void Options::notifyOptionChanged(const std::string& optionName) {
+        // Publish the new values before the listeners are called, so that they see the change in the snapshot
+        updateSnapshot();
+
         std::vector<std::shared_ptr<OnChangeListener> > onChangeListeners;
         {
             std::lock_guard<std::mutex> lock(_onChangeListenersMutex);
+            if (_updateDepth > 0) {
+                if (std::find(_pendingOptionNames.begin(), _pendingOptionNames.end(), optionName) == _pendingOptionNames.end()) {
+                    _pendingOptionNames.push_back(optionName);
+                }
+                return;
+            }
             onChangeListeners = _onChangeListeners;
         }
         for (const std::shared_ptr<OnChangeListener>& listener : onChangeListeners) {
@@ -773,6 +924,24 @@ namespace carto {
         }
     }
 
+    void Options::updateSnapshot() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto snapshot = std::make_shared<Snapshot>();
+        std::shared_ptr<const Snapshot> prevSnapshot = std::atomic_load(&_snapshot);
+        snapshot->version = (prevSnapshot ? prevSnapshot->version + 1 : 0);
+        snapshot->renderProjectionMode = _renderProjectionMode;
+        snapshot->seamlessPanning = _seamlessPanning;
+        snapshot->restrictedPanning = _restrictedPanning;
+        snapshot->tileDrawSize = _tileDrawSize;
+        snapshot->dpi = _dpi;
+        snapshot->drawDistance = _drawDistance;
+        snapshot->fovY = _fovY;
+        snapshot->zoomRange = _zoomRange;
+        snapshot->focusPointOffset = _focusPointOffset;
+        snapshot->projectionSurface = _projectionSurface;
+        std::atomic_store(&_snapshot, std::shared_ptr<const Snapshot>(snapshot));
+    }
+
     const Color Options::DEFAULT_CLEAR_COLOR = Color(0, 0, 0, 255);
     const Color Options::DEFAULT_SKY_COLOR = Color(149, 196, 255, 255);
     const Color Options::DEFAULT_BACKGROUND_COLOR = Color(226, 226, 226, 255);
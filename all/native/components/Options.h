@@ -14,6 +14,7 @@
 
 #include <memory>
 #include <mutex>
+#include <string>
 #include <vector>
 
 namespace carto {
@@ -99,12 +100,32 @@ namespace carto {
             virtual void onOptionChanged(const std::string& optionName) = 0;
         };
 
+        /**
+         * Immutable copy of the options that are read on every frame by the view and tile calculations.
+         * A new snapshot with an increased version is published whenever any option changes, so the
+         * snapshot values are always mutually consistent and can be read without locking.
+         */
+        struct Snapshot {
+            unsigned int version;
+            RenderProjectionMode::RenderProjectionMode renderProjectionMode;
+            bool seamlessPanning;
+            bool restrictedPanning;
+            int tileDrawSize;
+            float dpi;
+            float drawDistance;
+            int fovY;
+            MapRange zoomRange;
+            ScreenPos focusPointOffset;
+            std::shared_ptr<ProjectionSurface> projectionSurface;
+        };
+
         /**
          * Constructs an Options object with all parameters set to defaults.
          * @param envelopeThreadPool The thread pool used for envelope tasks.
          * @param tileThreadPool The thread pool used for tile tasks.
+         * @param tileDecodeThreadPool The thread pool used for tile decoding tasks.
          */
-        Options(const std::shared_ptr<CancelableThreadPool>& envelopeThreadPool, const std::shared_ptr<CancelableThreadPool>& tileThreadPool);
+        Options(const std::shared_ptr<CancelableThreadPool>& envelopeThreadPool, const std::shared_ptr<CancelableThreadPool>& tileThreadPool, const std::shared_ptr<CancelableThreadPool>& tileDecodeThreadPool);
         virtual ~Options();
         
         /**
@@ -167,6 +188,59 @@ namespace carto {
          * @param enabled The new state of the click type detection flag.
          */
         void setClickTypeDetection(bool enabled);
+
+        /**
+         * Returns the GPU picking state.
+         * @return True if GPU picking is enabled.
+         */
+        bool isGPUPicking() const;
+        /**
+         * Sets the state of the GPU picking flag. If set to true, the lines, polygons and 3D polygons hit by a click are
+         * additionally rendered into a small offscreen ID buffer around the click position and only the elements visible at the click position are reported.
+         * This resolves occlusion between overlapping elements but requires a redraw for each click. The default is false.
+         * @param enabled The new state of the GPU picking flag.
+         */
+        void setGPUPicking(bool enabled);
+
+        /**
+         * Returns the maximum frame rate of the map rendering.
+         * @return The maximum number of frames per second. 0 if the frame rate is not limited.
+         */
+        int getMaxFPS() const;
+        /**
+         * Sets the maximum frame rate of the map rendering. Redraw requests arriving sooner than the frame interval after the previous frame
+         * are delayed and merged into a single frame, which reduces power consumption during animations. The default is 0 (not limited).
+         * @param maxFPS The new maximum number of frames per second, or 0 to disable the limit.
+         */
+        void setMaxFPS(int maxFPS);
+
+        /**
+         * Returns the state of the static layer caching flag.
+         * @return True if static layer caching is enabled.
+         */
+        bool isStaticLayerCaching() const;
+        /**
+         * Sets the state of the static layer caching flag. If set to true, the bottom tile layers of the layer stack are rendered
+         * into an offscreen buffer while the view and these layers are not changing, and the buffer is reused in the frames where only the layers
+         * above them change, for example when markers are moved. This reduces the rendering cost on high resolution screens,
+         * but requires an additional full screen buffer. The default is false.
+         * @param enabled The new state of the static layer caching flag.
+         */
+        void setStaticLayerCaching(bool enabled);
+
+        /**
+         * Returns the directory used for caching compiled shader programs.
+         * @return The shader cache directory. Empty if shader caching is disabled.
+         */
+        std::string getShaderCachePath() const;
+        /**
+         * Sets the directory used for caching compiled shader programs. If set and the graphics driver supports program binaries,
+         * the linked shader programs are stored in this directory and reused when the rendering surface is created again,
+         * instead of compiling the shaders. The cache is keyed by the driver and the shader sources, so driver updates invalidate it.
+         * The change takes effect when the rendering surface is created. The default is empty (disabled).
+         * @param path The existing writable directory for the shader cache, or an empty string to disable the cache.
+         */
+        void setShaderCachePath(const std::string& path);
     
         /**
          * Returns the tile size used for drawing map tiles.
@@ -310,6 +384,19 @@ namespace carto {
          */
         void setTileThreadPoolSize(int poolSize);
     
+        /**
+         * Returns the number of threads used by the tile decoding task pool.
+         * @return The tile decoding task thread pool size.
+         */
+        int getTileDecodeThreadPoolSize() const;
+        /**
+         * Sets the number of threads used by the tile decoding task pool. Tile task pool threads only load the tile data
+         * (from network, database, etc) and the data is decoded by the tile decoding threads. As decoding is CPU bound,
+         * the size of this pool should not exceed the number of CPU cores. Default is 1.
+         * @param poolSize The new tile decoding task thread pool size.
+         */
+        void setTileDecodeThreadPoolSize(int poolSize);
+    
         /**
          * Returns the clear color used by the renderer before drawing anything else.
          * By default, this is white. It should be set to (0, 0, 0, 0) if transparent MapView is needed.
@@ -462,6 +549,19 @@ namespace carto {
          * @param enabled The new state of the kinetic zooming flag.
          */
         void setKineticZoom(bool enabled);
+
+        /**
+         * Returns the state of the touch prediction flag.
+         * @return True if touch prediction is enabled.
+         */
+        bool isTouchPrediction() const;
+        /**
+         * Sets the state of the touch prediction flag. When enabled, map panning extrapolates the latest
+         * touch positions slightly ahead in time, reducing the perceived lag between the finger and the map.
+         * Default is false.
+         * @param enabled The new state of the touch prediction flag.
+         */
+        void setTouchPrediction(bool enabled);
     
         /**
          * Returns the state of the map rotatability flag.
@@ -554,6 +654,23 @@ namespace carto {
          * @return The projection surface.
          */
         std::shared_ptr<ProjectionSurface> getProjectionSurface() const;
+
+        /**
+         * Returns the current snapshot of the frequently read options. The snapshot is not locked and is not modified later.
+         * @return The current options snapshot.
+         */
+        std::shared_ptr<const Snapshot> getSnapshot() const;
+
+        /**
+         * Starts a batch of option changes. The change events of the options modified during the batch are
+         * delayed until the matching endUpdate call, and each modified option is reported only once.
+         * Batches can be nested, the events are sent when the outermost batch ends.
+         */
+        void beginUpdate();
+        /**
+         * Ends a batch of option changes started with beginUpdate and sends the delayed change events.
+         */
+        void endUpdate();
         
         /**
          * Registers listener for options change events.
@@ -582,6 +699,7 @@ namespace carto {
         static const MapVec DEFAULT_MAIN_LIGHT_DIR;
         
         void notifyOptionChanged(const std::string& optionName);
+        void updateSnapshot();
         
         Color _ambientLightColor;
         Color _mainLightColor;
@@ -590,6 +708,12 @@ namespace carto {
         RenderProjectionMode::RenderProjectionMode _renderProjectionMode;
     
         bool _clickTypeDetection;
+        bool _gpuPicking;
+
+        int _maxFPS;
+        bool _staticLayerCaching;
+
+        std::string _shaderCachePath;
     
         int _tileDrawSize;
     
@@ -629,6 +753,8 @@ namespace carto {
         bool _kineticPan;
         bool _kineticRotation;
         bool _kineticZoom;
+
+        bool _touchPrediction;
     
         bool _rotatable;
         MapRange _tiltRange;
@@ -644,9 +770,14 @@ namespace carto {
     
         std::shared_ptr<CancelableThreadPool> _envelopeThreadPool;
         std::shared_ptr<CancelableThreadPool> _tileThreadPool;
+        std::shared_ptr<CancelableThreadPool> _tileDecodeThreadPool;
     
         mutable std::mutex _mutex;
 
+        std::shared_ptr<const Snapshot> _snapshot; // accessed only with atomic_load/atomic_store
+
+        int _updateDepth;
+        std::vector<std::string> _pendingOptionNames;
         std::vector<std::shared_ptr<OnChangeListener> > _onChangeListeners;
         mutable std::mutex _onChangeListenersMutex;
 
@@ -0,0 +1,117 @@
+#include "TileCacheManager.h"
+#include "layers/TileLayer.h"
+
+#include <algorithm>
+
+namespace carto {
+
+    TileCacheManager::~TileCacheManager() {
+    }
+
+    std::size_t TileCacheManager::getCapacity() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _capacity;
+    }
+
+    void TileCacheManager::setCapacity(std::size_t capacityInBytes) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _capacity = capacityInBytes;
+        }
+        trimCaches();
+    }
+
+    std::size_t TileCacheManager::getTotalSize() const {
+        std::size_t totalSize = 0;
+        for (const std::shared_ptr<TileLayer>& layer : getLayers()) {
+            totalSize += layer->getTileCacheSize(true) + layer->getTileCacheSize(false);
+        }
+        return totalSize;
+    }
+
+    void TileCacheManager::registerLayer(const std::shared_ptr<TileLayer>& layer) {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // Remove released layers and check if the layer is already registered
+        bool registered = false;
+        for (auto it = _layers.begin(); it != _layers.end(); ) {
+            std::shared_ptr<TileLayer> listLayer = it->lock();
+            if (!listLayer) {
+                it = _layers.erase(it);
+                continue;
+            }
+            if (listLayer == layer) {
+                registered = true;
+            }
+            it++;
+        }
+        if (!registered) {
+            _layers.push_back(layer);
+        }
+    }
+
+    void TileCacheManager::trimCaches() {
+        // Take a snapshot of the layers, layer methods must not be called while holding the manager lock
+        std::size_t capacity = getCapacity();
+        if (capacity == 0) {
+            return;
+        }
+        std::vector<std::shared_ptr<TileLayer> > layers = getLayers();
+
+        std::vector<std::size_t> preloadingSizes;
+        std::vector<std::size_t> visibleSizes;
+        std::size_t totalPreloadingSize = 0;
+        std::size_t totalVisibleSize = 0;
+        for (const std::shared_ptr<TileLayer>& layer : layers) {
+            preloadingSizes.push_back(layer->getTileCacheSize(true));
+            visibleSizes.push_back(layer->getTileCacheSize(false));
+            totalPreloadingSize += preloadingSizes.back();
+            totalVisibleSize += visibleSizes.back();
+        }
+        if (totalPreloadingSize + totalVisibleSize <= capacity) {
+            return;
+        }
+        std::size_t excessSize = totalPreloadingSize + totalVisibleSize - capacity;
+
+        // Trim preloading caches first, proportionally to their sizes
+        if (totalPreloadingSize > 0) {
+            double scale = 1.0 - std::min(1.0, static_cast<double>(excessSize) / totalPreloadingSize);
+            for (std::size_t i = 0; i < layers.size(); i++) {
+                layers[i]->trimTileCache(true, static_cast<std::size_t>(preloadingSizes[i] * scale));
+            }
+            excessSize -= std::min(excessSize, totalPreloadingSize);
+        }
+
+        // If that was not enough, trim visible caches
+        if (excessSize > 0 && totalVisibleSize > 0) {
+            double scale = 1.0 - std::min(1.0, static_cast<double>(excessSize) / totalVisibleSize);
+            for (std::size_t i = 0; i < layers.size(); i++) {
+                layers[i]->trimTileCache(false, static_cast<std::size_t>(visibleSizes[i] * scale));
+            }
+        }
+    }
+
+    std::vector<std::shared_ptr<TileLayer> > TileCacheManager::getLayers() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<std::shared_ptr<TileLayer> > layers;
+        for (const std::weak_ptr<TileLayer>& layer : _layers) {
+            if (std::shared_ptr<TileLayer> listLayer = layer.lock()) {
+                layers.push_back(listLayer);
+            }
+        }
+        return layers;
+    }
+
+    TileCacheManager& TileCacheManager::GetInstance() {
+        static TileCacheManager instance;
+        return instance;
+    }
+
+    TileCacheManager::TileCacheManager() :
+        _capacity(0),
+        _layers(),
+        _mutex()
+    {
+    }
+
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_TILECACHEMANAGER_H_
+#define _CARTO_TILECACHEMANAGER_H_
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace carto {
+    class TileLayer;
+
+    /**
+     * An internal class for enforcing a single byte budget for tile caches of all tile layers in the process.
+     * When the budget is exceeded, preloading caches are trimmed first. Visible caches are trimmed only
+     * when all preloading caches are empty. Caches are trimmed proportionally to their sizes.
+     */
+    class TileCacheManager {
+    public:
+        virtual ~TileCacheManager();
+
+        /**
+         * Returns the total capacity of all tile caches.
+         * @return The total capacity of all tile caches in bytes. Zero means that the size is not limited.
+         */
+        std::size_t getCapacity() const;
+        /**
+         * Sets the total capacity of all tile caches.
+         * @param capacityInBytes The new total capacity in bytes. Zero means that the size is not limited.
+         */
+        void setCapacity(std::size_t capacityInBytes);
+
+        /**
+         * Returns the total size of the visible and preloading tile caches of all registered layers.
+         * Must not be called while holding the lock of any tile layer.
+         * @return The total size of all tile caches in bytes.
+         */
+        std::size_t getTotalSize() const;
+
+        /**
+         * Registers a tile layer whose caches should be accounted against the budget.
+         * Registering the same layer multiple times has no effect.
+         * @param layer The layer to register.
+         */
+        void registerLayer(const std::shared_ptr<TileLayer>& layer);
+
+        /**
+         * Trims the tile caches of the registered layers, if the total size exceeds the capacity.
+         * Must not be called while holding the lock of any tile layer.
+         */
+        void trimCaches();
+
+        /**
+         * Returns the singleton instance of the class.
+         * @return The singleton instance of the class.
+         */
+        static TileCacheManager& GetInstance();
+
+    private:
+        TileCacheManager();
+
+        std::vector<std::shared_ptr<TileLayer> > getLayers() const;
+
+        std::size_t _capacity;
+        std::vector<std::weak_ptr<TileLayer> > _layers;
+
+        mutable std::mutex _mutex;
+    };
+
+}
+
+#endif
@@ -2,134 +2,171 @@
 #include "components/Exceptions.h"
 #include "utils/Log.h"
 
+#include <cstring>
+#include <functional>
+
 namespace carto {
 
     Variant::Variant() :
-        _value()
+        _type(VariantType::VARIANT_TYPE_NULL),
+        _value(),
+        _data(),
+        _picoJSON()
     {
     }
 
     Variant::Variant(bool boolVal) :
-        _value(boolVal)
+        _type(VariantType::VARIANT_TYPE_BOOL),
+        _value(),
+        _data(),
+        _picoJSON()
     {
+        _value.boolVal = boolVal;
     }
 
     Variant::Variant(long long longVal) :
-        _value(static_cast<std::int64_t>(longVal))
+        _type(VariantType::VARIANT_TYPE_INTEGER),
+        _value(),
+        _data(),
+        _picoJSON()
     {
+        _value.longVal = longVal;
     }
 
     Variant::Variant(double doubleVal) :
-        _value(doubleVal)
+        _type(VariantType::VARIANT_TYPE_DOUBLE),
+        _value(),
+        _data(),
+        _picoJSON()
     {
+        _value.doubleVal = doubleVal;
     }
 
     Variant::Variant(const char* str) :
-        _value(std::string(str))
+        Variant(std::string(str))
     {
     }
 
     Variant::Variant(const std::string& string) :
-        _value(string)
+        _type(VariantType::VARIANT_TYPE_STRING),
+        _value(),
+        _data(),
+        _picoJSON()
     {
+        if (string.size() <= SMALL_STRING_CAPACITY) {
+            _value.smallString.size = static_cast<unsigned char>(string.size());
+            std::memcpy(_value.smallString.chars, string.data(), string.size());
+        } else {
+            _data = std::make_shared<const std::string>(string);
+        }
     }
 
     Variant::Variant(const std::vector<Variant>& array) :
-        _value()
+        _type(VariantType::VARIANT_TYPE_ARRAY),
+        _value(),
+        _data(std::make_shared<const ArrayData>(array)),
+        _picoJSON()
     {
-        picojson::value::array valArr;
-        for (auto it = array.begin(); it != array.end(); it++) {
-            valArr.push_back(it->toPicoJSON());
-        }
-        _value = picojson::value(valArr);
     }
 
     Variant::Variant(const std::map<std::string, Variant>& object) :
-        _value()
+        _type(VariantType::VARIANT_TYPE_OBJECT),
+        _value(),
+        _data(std::make_shared<const ObjectData>(object)),
+        _picoJSON()
+    {
+    }
+
+    Variant::Variant(const Variant& var) :
+        _type(var._type),
+        _value(var._value),
+        _data(var._data),
+        _picoJSON(std::atomic_load(&var._picoJSON))
     {
-        picojson::value::object valObj;
-        for (auto it = object.begin(); it != object.end(); it++) {
-            valObj[it->first] = it->second.toPicoJSON();
+    }
+
+    Variant& Variant::operator =(const Variant& var) {
+        if (this != &var) {
+            _type = var._type;
+            _value = var._value;
+            _data = var._data;
+            _picoJSON = std::atomic_load(&var._picoJSON);
         }
-        _value = picojson::value(valObj);
+        return *this;
     }
 
     VariantType::VariantType Variant::getType() const {
-        const picojson::value& val = toPicoJSON();
-        if (val.is<std::string>()) {
-            return VariantType::VARIANT_TYPE_STRING;
-        }
-        if (val.is<bool>()) {
-            return VariantType::VARIANT_TYPE_BOOL;
-        }
-        if (val.is<std::int64_t>()) {
-            return VariantType::VARIANT_TYPE_INTEGER;
-        }
-        if (val.is<double>()) {
-            return VariantType::VARIANT_TYPE_DOUBLE;
-        }
-        if (val.is<picojson::value::array>()) {
-            return VariantType::VARIANT_TYPE_ARRAY;
-        }
-        if (val.is<picojson::value::object>()) {
-            return VariantType::VARIANT_TYPE_OBJECT;
-        }
-        return VariantType::VARIANT_TYPE_NULL;
+        return _type;
     }
 
     std::string Variant::getString() const {
-        return toPicoJSON().to_str();
+        switch (_type) {
+        case VariantType::VARIANT_TYPE_STRING:
+            if (const std::string* str = getLongString()) {
+                return *str;
+            }
+            return std::string(_value.smallString.chars, _value.smallString.size);
+        case VariantType::VARIANT_TYPE_BOOL:
+            return _value.boolVal ? "true" : "false";
+        case VariantType::VARIANT_TYPE_INTEGER:
+            return std::to_string(_value.longVal);
+        case VariantType::VARIANT_TYPE_DOUBLE:
+            // Use the same formatting as for JSON numbers
+            return createPicoJSON().to_str();
+        case VariantType::VARIANT_TYPE_ARRAY:
+            return "array";
+        case VariantType::VARIANT_TYPE_OBJECT:
+            return "object";
+        default:
+            return "null";
+        }
     }
 
     bool Variant::getBool() const {
-        const picojson::value& val = toPicoJSON();
-        if (val.is<bool>()) {
-            return val.get<bool>();
+        if (_type == VariantType::VARIANT_TYPE_BOOL) {
+            return _value.boolVal;
         }
         return false;
     }
 
     long long Variant::getLong() const {
-        const picojson::value& val = toPicoJSON();
-        if (val.is<std::int64_t>()) {
-            return val.get<std::int64_t>();
+        if (_type == VariantType::VARIANT_TYPE_INTEGER) {
+            return _value.longVal;
         }
         return 0;
     }
 
     double Variant::getDouble() const {
-        const picojson::value& val = toPicoJSON();
-        if (val.is<double>()) {
-            return val.get<double>();
+        if (_type == VariantType::VARIANT_TYPE_DOUBLE) {
+            return _value.doubleVal;
+        }
+        if (_type == VariantType::VARIANT_TYPE_INTEGER) {
+            return static_cast<double>(_value.longVal);
         }
         return 0.0;
     }
 
     int Variant::getArraySize() const {
-        const picojson::value& val = toPicoJSON();
-        if (val.is<picojson::value::array>()) {
-            return static_cast<int>(val.get<picojson::value::array>().size());
+        if (const ArrayData* array = getArrayData()) {
+            return static_cast<int>(array->size());
         }
         return 0;
     }
 
     Variant Variant::getArrayElement(int idx) const {
-        const picojson::value& val = toPicoJSON();
-        if (val.is<picojson::value::array>()) {
-            const picojson::array& valArr = val.get<picojson::value::array>();
-            if (idx >= 0 && idx < static_cast<int>(valArr.size())) {
-                return FromPicoJSON(valArr[idx]);
+        if (const ArrayData* array = getArrayData()) {
+            if (idx >= 0 && idx < static_cast<int>(array->size())) {
+                return (*array)[idx];
             }
         }
         return Variant();
     }
     
     std::vector<std::string> Variant::getObjectKeys() const {
-        const picojson::value& val = toPicoJSON();
         std::vector<std::string> keys;
-        if (val.is<picojson::value::object>()) {
-            const picojson::object& valObj = val.get<picojson::value::object>();
-            for (auto it = valObj.begin(); it != valObj.end(); it++) {
+        if (const ObjectData* object = getObjectData()) {
+            keys.reserve(object->size());
+            for (auto it = object->begin(); it != object->end(); it++) {
                 keys.push_back(it->first);
             }
         }
@@ -137,28 +174,50 @@ namespace carto {
     }
 
     bool Variant::containsObjectKey(const std::string& key) const {
-        const picojson::value& val = toPicoJSON();
-        if (val.is<picojson::value::object>()) {
-            return val.contains(key);
+        if (const ObjectData* object = getObjectData()) {
+            return object->find(key) != object->end();
         }
         return false;
     }
     
     Variant Variant::getObjectElement(const std::string& key) const {
-        const picojson::value& val = toPicoJSON();
-        std::vector<std::string> keys;
-        if (val.is<picojson::value::object>()) {
-            const picojson::object& valObj = val.get<picojson::value::object>();
-            auto it = valObj.find(key);
-            if (it != valObj.end()) {
-                return FromPicoJSON(it->second);
+        if (const ObjectData* object = getObjectData()) {
+            auto it = object->find(key);
+            if (it != object->end()) {
+                return it->second;
             }
         }
         return Variant();
     }
 
     bool Variant::operator ==(const Variant& var) const {
-        return toPicoJSON() == var.toPicoJSON();
+        bool numeric1 = _type == VariantType::VARIANT_TYPE_INTEGER || _type == VariantType::VARIANT_TYPE_DOUBLE;
+        bool numeric2 = var._type == VariantType::VARIANT_TYPE_INTEGER || var._type == VariantType::VARIANT_TYPE_DOUBLE;
+        if (numeric1 && numeric2) {
+            // Integers and floating point values are comparable, like JSON numbers
+            if (_type == VariantType::VARIANT_TYPE_INTEGER && var._type == VariantType::VARIANT_TYPE_INTEGER) {
+                return _value.longVal == var._value.longVal;
+            }
+            return getDouble() == var.getDouble();
+        }
+        if (_type != var._type) {
+            return false;
+        }
+
+        switch (_type) {
+        case VariantType::VARIANT_TYPE_NULL:
+            return true;
+        case VariantType::VARIANT_TYPE_BOOL:
+            return _value.boolVal == var._value.boolVal;
+        case VariantType::VARIANT_TYPE_STRING:
+            return getString() == var.getString();
+        case VariantType::VARIANT_TYPE_ARRAY:
+            return _data == var._data || *getArrayData() == *var.getArrayData();
+        case VariantType::VARIANT_TYPE_OBJECT:
+            return _data == var._data || *getObjectData() == *var.getObjectData();
+        default:
+            return false;
+        }
     }
 
     bool Variant::operator !=(const Variant& var) const {
@@ -166,15 +225,50 @@ namespace carto {
     }
 
     int Variant::hash() const {
-        return static_cast<int>(std::hash<std::string>()(toString()));
+        std::size_t hash = static_cast<std::size_t>(_type);
+        switch (_type) {
+        case VariantType::VARIANT_TYPE_BOOL:
+            hash = std::hash<bool>()(_value.boolVal);
+            break;
+        case VariantType::VARIANT_TYPE_INTEGER:
+        case VariantType::VARIANT_TYPE_DOUBLE:
+            // Equal integers and floating point values must have equal hashes
+            hash = std::hash<double>()(getDouble());
+            break;
+        case VariantType::VARIANT_TYPE_STRING:
+            hash = std::hash<std::string>()(getString());
+            break;
+        case VariantType::VARIANT_TYPE_ARRAY:
+            for (const Variant& element : *getArrayData()) {
+                hash = hash * 31 + static_cast<std::size_t>(element.hash());
+            }
+            break;
+        case VariantType::VARIANT_TYPE_OBJECT:
+            for (auto it = getObjectData()->begin(); it != getObjectData()->end(); it++) {
+                hash = hash * 31 + std::hash<std::string>()(it->first);
+                hash = hash * 31 + static_cast<std::size_t>(it->second.hash());
+            }
+            break;
+        default:
+            break;
+        }
+        return static_cast<int>(hash);
     }
 
     std::string Variant::toString() const {
-        return toPicoJSON().serialize();
+        return createPicoJSON().serialize();
     }
 
     const picojson::value& Variant::toPicoJSON() const {
-        return _value;
+        std::shared_ptr<const picojson::value> picoJSON = std::atomic_load(&_picoJSON);
+        if (!picoJSON) {
+            // Create the value once, if other thread was faster use its value so that the returned reference stays valid
+            std::shared_ptr<const picojson::value> newPicoJSON = std::make_shared<const picojson::value>(createPicoJSON());
+            if (std::atomic_compare_exchange_strong(&_picoJSON, &picoJSON, newPicoJSON)) {
+                picoJSON = newPicoJSON;
+            }
+        }
+        return *picoJSON;
     }
 
     Variant Variant::FromString(const std::string& str) {
@@ -183,15 +277,93 @@ namespace carto {
         if (!err.empty()) {
             throw ParseException(std::string("Variant parsing failed: ") + err, str);
         }
-        Variant var;
-        var._value = std::move(val);
-        return var;
+        return FromPicoJSON(std::move(val));
     }
 
     Variant Variant::FromPicoJSON(picojson::value val) {
-        Variant var;
-        var._value = std::move(val);
-        return var;
+        if (val.is<bool>()) {
+            return Variant(val.get<bool>());
+        }
+        if (val.is<std::int64_t>()) {
+            return Variant(static_cast<long long>(val.get<std::int64_t>()));
+        }
+        if (val.is<double>()) {
+            return Variant(val.get<double>());
+        }
+        if (val.is<std::string>()) {
+            return Variant(val.get<std::string>());
+        }
+        if (val.is<picojson::value::array>()) {
+            const picojson::value::array& valArr = val.get<picojson::value::array>();
+            ArrayData array;
+            array.reserve(valArr.size());
+            for (auto it = valArr.begin(); it != valArr.end(); it++) {
+                array.push_back(FromPicoJSON(*it));
+            }
+            return Variant(array);
+        }
+        if (val.is<picojson::value::object>()) {
+            const picojson::value::object& valObj = val.get<picojson::value::object>();
+            ObjectData object;
+            for (auto it = valObj.begin(); it != valObj.end(); it++) {
+                object.emplace_hint(object.end(), it->first, FromPicoJSON(it->second));
+            }
+            return Variant(object);
+        }
+        return Variant();
+    }
+
+    const std::string* Variant::getLongString() const {
+        if (_type != VariantType::VARIANT_TYPE_STRING) {
+            return nullptr;
+        }
+        return static_cast<const std::string*>(_data.get());
+    }
+
+    const Variant::ArrayData* Variant::getArrayData() const {
+        if (_type != VariantType::VARIANT_TYPE_ARRAY) {
+            return nullptr;
+        }
+        return static_cast<const ArrayData*>(_data.get());
     }
 
+    const Variant::ObjectData* Variant::getObjectData() const {
+        if (_type != VariantType::VARIANT_TYPE_OBJECT) {
+            return nullptr;
+        }
+        return static_cast<const ObjectData*>(_data.get());
+    }
+
+    picojson::value Variant::createPicoJSON() const {
+        switch (_type) {
+        case VariantType::VARIANT_TYPE_BOOL:
+            return picojson::value(_value.boolVal);
+        case VariantType::VARIANT_TYPE_INTEGER:
+            return picojson::value(static_cast<std::int64_t>(_value.longVal));
+        case VariantType::VARIANT_TYPE_DOUBLE:
+            return picojson::value(_value.doubleVal);
+        case VariantType::VARIANT_TYPE_STRING:
+            return picojson::value(getString());
+        case VariantType::VARIANT_TYPE_ARRAY: {
+                picojson::value::array valArr;
+                valArr.reserve(getArrayData()->size());
+                for (const Variant& element : *getArrayData()) {
+                    valArr.push_back(element.createPicoJSON());
+                }
+                return picojson::value(valArr);
+            }
+        case VariantType::VARIANT_TYPE_OBJECT: {
+                picojson::value::object valObj;
+                for (auto it = getObjectData()->begin(); it != getObjectData()->end(); it++) {
+                    valObj[it->first] = it->second.createPicoJSON();
+                }
+                return picojson::value(valObj);
+            }
+        default:
+            return picojson::value();
+        }
+    }
+
+    const std::size_t Variant::SMALL_STRING_CAPACITY;
+
 }
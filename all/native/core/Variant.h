@@ -55,6 +55,7 @@ namespace carto {
     
     /**
      * JSON value. Can contain JSON-style structured data, including objects and arrays.
+     * Variants are immutable, copying a variant is cheap as arrays, objects and long strings are shared between copies.
      */
     class Variant {
     public:
@@ -97,6 +98,18 @@ namespace carto {
          * @param object The map of JSON values.
          */
         explicit Variant(const std::map<std::string, Variant>& object);
+        /**
+         * Constructs a copy of another Variant object.
+         * @param var The variant to copy.
+         */
+        Variant(const Variant& var);
+
+        /**
+         * Assigns the value of another Variant object.
+         * @param var The variant to copy.
+         * @return This variant.
+         */
+        Variant& operator =(const Variant& var);
 
         /**
          * Returns the type of this variant.
@@ -202,7 +215,33 @@ namespace carto {
         static Variant FromPicoJSON(picojson::value val);
 
     private:
-        picojson::value _value;
+        static const std::size_t SMALL_STRING_CAPACITY = 15;
+
+        struct SmallString {
+            unsigned char size;
+            char chars[SMALL_STRING_CAPACITY];
+        };
+
+        union Value {
+            bool boolVal;
+            long long longVal;
+            double doubleVal;
+            SmallString smallString;
+        };
+
+        typedef std::vector<Variant> ArrayData;
+        typedef std::map<std::string, Variant> ObjectData;
+
+        const std::string* getLongString() const;
+        const ArrayData* getArrayData() const;
+        const ObjectData* getObjectData() const;
+
+        picojson::value createPicoJSON() const;
+
+        VariantType::VariantType _type;
+        Value _value;
+        std::shared_ptr<const void> _data; // long string, array or object data
+        mutable std::shared_ptr<const picojson::value> _picoJSON; // created on demand by toPicoJSON
     };
 
 }
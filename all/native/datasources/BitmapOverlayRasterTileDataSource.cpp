@@ -4,10 +4,9 @@
 #include "projections/EPSG3857.h"
 #include "graphics/Bitmap.h"
 #include "graphics/utils/BitmapFilterTable.h"
+#include "utils/GeomUtils.h"
 #include "utils/Log.h"
 
-#include <array>
-
 #include <cglib/mat.h>
 
 namespace {
@@ -50,72 +49,19 @@ namespace carto {
             throw InvalidArgumentException("Size mismatch between position arrays");
         }
 
-        cglib::vec<double, 8> uvs = cglib::vec<double, 8>::zero();
-        std::array<cglib::vec2<double>, 4> xys;
+        std::vector<cglib::vec2<double> > xys;
+        std::vector<cglib::vec2<double> > uvs;
         for (std::size_t i = 0; i < mapPoses.size(); i++) {
-            uvs(i * 2 + 0) = bitmapPoses[i].getX();
-            uvs(i * 2 + 1) = bitmapPoses[i].getY();
             MapPos pos = mapPoses[i];
             if (!std::dynamic_pointer_cast<EPSG3857>(projection)) {
                 pos = _projection->fromWgs84(projection->toWgs84(pos));
             }
-            xys[i] = cglib::vec2<double>(pos.getX(), pos.getY());
-            _origin += xys[i] * (1.0 / mapPoses.size());
+            xys.emplace_back(pos.getX(), pos.getY());
+            uvs.emplace_back(bitmapPoses[i].getX(), bitmapPoses[i].getY());
         }
-
-        cglib::mat<double, 8> posTransform = cglib::mat<double, 8>::zero();
-        if (mapPoses.size() == 4) {
-            // General case, perspective mapping. Must find 8 unknowns
-            for (int i = 0; i < 8; i++) {
-                int j = (i % 2) * 3;
-                cglib::vec2<double> xy = xys[i / 2] - _origin;
-                posTransform(i, j + 0) = xy(0);
-                posTransform(i, j + 1) = xy(1);
-                posTransform(i, j + 2) = 1;
-                posTransform(i, 6) = -uvs(i) * xy(0);
-                posTransform(i, 7) = -uvs(i) * xy(1);
-            }
-        } else if (mapPoses.size() == 3) {
-            // Affine mapping. Must find 6 unknowns
-            for (int i = 0; i < 6; i++) {
-                int j = (i % 2) * 3;
-                cglib::vec2<double> xy = xys[i / 2] - _origin;
-                posTransform(i, j + 0) = xy(0);
-                posTransform(i, j + 1) = xy(1);
-                posTransform(i, j + 2) = 1;
-            }
-            posTransform(6, 6) = posTransform(7, 7) = 1;
-        } else {
-            // Conformal mapping. Must find 4 unknowns (rot + scale + transform)
-            for (int n = 0; n < 2; n++) {
-                int i = n * 2;
-                cglib::vec2<double> xy = xys[n] - _origin;
-                posTransform(i + 0, 0) = xy(0);
-                posTransform(i + 0, 1) = -xy(1);
-                posTransform(i + 0, 2) = 1;
-                posTransform(i + 1, 0) = xy(1);
-                posTransform(i + 1, 1) = xy(0);
-                posTransform(i + 1, 3) = 1;
-            }
-            posTransform(4, 4) = posTransform(5, 5) = posTransform(6, 6) = posTransform(7, 7) = 1;
-        }
-        if (cglib::determinant(posTransform) == 0) {
+        if (!GeomUtils::CalculateControlPointTransform(xys, uvs, _origin, _invTransform)) {
             throw InvalidArgumentException("Map positions are collinear");
         }
-
-        cglib::vec<double, 8> coeffs = cglib::transform(uvs, cglib::inverse(posTransform));
-        if (mapPoses.size() == 2) {
-            _invTransform(0, 0) = coeffs(0);
-            _invTransform(0, 1) = -coeffs(1);
-            _invTransform(1, 0) = coeffs(1);
-            _invTransform(1, 1) = coeffs(0);
-            _invTransform(0, 2) = coeffs(2);
-            _invTransform(1, 2) = coeffs(3);
-        } else {
-            for (int i = 0; i < 8; i++) {
-                _invTransform(i / 3, i % 3) = coeffs(i);
-            }
-        }
         _transform = cglib::inverse(_invTransform);
 
         _bitmap = bitmap;
@@ -170,27 +116,8 @@ namespace carto {
         BitmapFilterTable filterTable(0, 0, _bitmap->getWidth(), _bitmap->getHeight());
         filterTable.calculateFilterTable(ProjectiveTransform(invTransform), _tileSize, _tileSize, FILTER_SCALE, MAX_FILTER_WIDTH);
         
-        std::size_t sampleIndex = 0;
         std::vector<unsigned char> data(_tileSize * _tileSize * 4);
-        const std::vector<BitmapFilterTable::Sample>& samples = filterTable.getSamples();
-        for (int i = 0; i < _tileSize * _tileSize; i++) {
-            int count = filterTable.getSampleCounts()[i];
-            if (count == 0) {
-                continue;
-            }
-
-            float color[4] = { 0.5f, 0.5f, 0.5f, 0.5f };
-            for (int j = 0; j < count; j++) {
-                const BitmapFilterTable::Sample& sample = samples[sampleIndex++];
-                const unsigned char* sampleData = &_bitmap->getPixelData()[(sample.v * _bitmap->getWidth() + sample.u) * 4];
-                for (int c = 0; c < 4; c++) {
-                    color[c] += sampleData[c] * sample.weight;
-                }
-            }
-            for (int c = 0; c < 4; c++) {
-                data[i * 4 + c] = static_cast<unsigned char>(color[c]);
-            }
-        }
+        filterTable.filterPixels(_bitmap->getPixelData().data(), data.data(), 0, filterTable.getPixelCount());
 
         // Build bitmap, "compress" (serialize) to internal format
         Bitmap bitmap(data.data(), _tileSize, _tileSize, ColorFormat::COLOR_FORMAT_RGBA, 4 * _tileSize);
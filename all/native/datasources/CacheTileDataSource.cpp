@@ -1,6 +1,10 @@
 #include "CacheTileDataSource.h"
+#include "core/BinaryData.h"
 #include "core/MapTile.h"
+#include "components/CacheStatistics.h"
+#include "components/CancelableThreadPool.h"
 #include "components/Exceptions.h"
+#include "datasources/components/TileData.h"
 #include "utils/Log.h"
 
 #include <memory>
@@ -9,7 +13,14 @@ namespace carto {
     
     CacheTileDataSource::CacheTileDataSource(const std::shared_ptr<TileDataSource>& dataSource) :
         TileDataSource(),
-        _dataSource(dataSource)
+        _dataSource(dataSource),
+        _dataSourceListener(),
+        _staleWhileRevalidate(false),
+        _cacheHitCount(0),
+        _cacheMissCount(0),
+        _revalidateThreadPool(),
+        _revalidatingTileIds(),
+        _revalidateMutex()
     {
         if (!dataSource) {
             throw NullArgumentException("Null dataSource");
@@ -20,6 +31,9 @@ namespace carto {
     }
     
     CacheTileDataSource::~CacheTileDataSource() {
+        if (_revalidateThreadPool) {
+            _revalidateThreadPool->deinit();
+        }
         _dataSource->unregisterOnChangeListener(_dataSourceListener);
         _dataSourceListener.reset();
     }
@@ -41,9 +55,61 @@ namespace carto {
         TileDataSource::notifyTilesChanged(removeTiles);
     }
 
+    void CacheTileDataSource::notifyTilesChanged(const std::vector<MapTile>& tiles, bool removeTiles) {
+        clear();
+        TileDataSource::notifyTilesChanged(tiles, removeTiles);
+    }
+
     std::shared_ptr<TileDataSource> CacheTileDataSource::getDataSource() const {
         return _dataSource.get();
     }
+
+    bool CacheTileDataSource::isStaleWhileRevalidate() const {
+        return _staleWhileRevalidate;
+    }
+
+    void CacheTileDataSource::setStaleWhileRevalidate(bool enabled) {
+        _staleWhileRevalidate = enabled;
+    }
+
+    std::shared_ptr<CacheStatistics> CacheTileDataSource::getCacheStatistics() const {
+        return std::make_shared<CacheStatistics>(getCacheSize(), getCapacity(), _cacheHitCount.load(), _cacheMissCount.load());
+    }
+
+    std::shared_ptr<TileData> CacheTileDataSource::revalidateTile(const MapTile& mapTile, const std::shared_ptr<TileData>& tileData) {
+        {
+            std::lock_guard<std::mutex> lock(_revalidateMutex);
+            if (_revalidatingTileIds.insert(mapTile.getTileId()).second) {
+                if (!_revalidateThreadPool) {
+                    _revalidateThreadPool = std::make_shared<CancelableThreadPool>();
+                    _revalidateThreadPool->setQoSClass(ThreadQoSClass::BACKGROUND);
+                    _revalidateThreadPool->setPoolSize(1);
+                }
+                auto task = std::make_shared<RevalidateTask>(std::static_pointer_cast<CacheTileDataSource>(shared_from_this()), mapTile, tileData);
+                _revalidateThreadPool->execute(task, REVALIDATE_TASK_PRIORITY);
+            }
+        }
+
+        // Serve the stale data with a short max age, so that the layers pick up the refreshed tile soon
+        auto staleTileData = std::make_shared<TileData>(tileData->getData());
+        staleTileData->setMaxAge(STALE_TILE_MAX_AGE);
+        return staleTileData;
+    }
+
+    void CacheTileDataSource::storeRevalidatedTile(const MapTile& mapTile, const std::shared_ptr<TileData>& tileData, bool changed) {
+    }
+
+    std::size_t CacheTileDataSource::getCacheSize() const {
+        return 0;
+    }
+
+    void CacheTileDataSource::countCacheLookup(bool hit) {
+        if (hit) {
+            _cacheHitCount++;
+        } else {
+            _cacheMissCount++;
+        }
+    }
     
     CacheTileDataSource::DataSourceListener::DataSourceListener(CacheTileDataSource& cacheDataSource) :
         _cacheDataSource(cacheDataSource)
@@ -54,4 +120,50 @@ namespace carto {
         _cacheDataSource.notifyTilesChanged(removeTiles);
     }
 
+    void CacheTileDataSource::DataSourceListener::onTilesChanged(const std::vector<MapTile>& tiles, bool removeTiles) {
+        _cacheDataSource.notifyTilesChanged(tiles, removeTiles);
+    }
+
+    CacheTileDataSource::RevalidateTask::RevalidateTask(const std::shared_ptr<CacheTileDataSource>& dataSource, const MapTile& mapTile, const std::shared_ptr<TileData>& staleTileData) :
+        _dataSource(dataSource),
+        _mapTile(mapTile),
+        _staleTileData(staleTileData)
+    {
+    }
+
+    void CacheTileDataSource::RevalidateTask::run() {
+        std::shared_ptr<CacheTileDataSource> dataSource = _dataSource.lock();
+        if (!dataSource) {
+            return;
+        }
+
+        std::shared_ptr<TileData> tileData;
+        try {
+            tileData = dataSource->_dataSource->reloadTile(_mapTile, _staleTileData);
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("CacheTileDataSource::RevalidateTask: Exception while loading tile: %s", ex.what());
+        }
+
+        if (tileData && tileData->getMaxAge() != 0 && tileData->getData() && !tileData->isReplaceWithParent()) {
+            // Keep the stale data blob if the content is the same, so that only the expiration time is updated
+            const std::shared_ptr<BinaryData>& staleData = _staleTileData->getData();
+            bool changed = !staleData || (tileData->getData() != staleData && *tileData->getData() != *staleData);
+            if (!changed && tileData->getData() != staleData) {
+                auto revalidatedTileData = std::make_shared<TileData>(staleData);
+                revalidatedTileData->setMaxAge(tileData->getMaxAge());
+                revalidatedTileData->setETag(tileData->getETag());
+                revalidatedTileData->setLastModified(tileData->getLastModified());
+                tileData = revalidatedTileData;
+            }
+            Log::Infof("CacheTileDataSource::RevalidateTask: Revalidated %s, content %s", _mapTile.toString().c_str(), changed ? "changed" : "not changed");
+            dataSource->storeRevalidatedTile(_mapTile, tileData, changed);
+        } else {
+            Log::Infof("CacheTileDataSource::RevalidateTask: Failed to revalidate %s", _mapTile.toString().c_str());
+        }
+
+        std::lock_guard<std::mutex> lock(dataSource->_revalidateMutex);
+        dataSource->_revalidatingTileIds.erase(_mapTile.getTileId());
+    }
+
 }
@@ -8,9 +8,16 @@
 #define _CARTO_CACHETILEDATASOURCE_H_
 
 #include "datasources/TileDataSource.h"
+#include "components/CancelableTask.h"
 #include "components/DirectorPtr.h"
 
+#include <atomic>
+#include <mutex>
+#include <unordered_set>
+
 namespace carto {
+    class CacheStatistics;
+    class CancelableThreadPool;
     
     /**
      * A tile data source that loads tiles from another tile data source and caches them.
@@ -25,6 +32,7 @@ namespace carto {
         virtual MapBounds getDataExtent() const;
 
         virtual void notifyTilesChanged(bool removeTiles);
+        virtual void notifyTilesChanged(const std::vector<MapTile>& tiles, bool removeTiles);
 
         /**
          * Returns the original data source that the cache uses.
@@ -48,23 +56,92 @@ namespace carto {
          */
         virtual void setCapacity(std::size_t capacityInBytes) = 0;
 
+        /**
+         * Returns the state of stale-while-revalidate mode.
+         * @return True when stale-while-revalidate mode is enabled, false otherwise.
+         */
+        bool isStaleWhileRevalidate() const;
+        /**
+         * Enables or disables stale-while-revalidate mode.
+         * If enabled, expired tiles are returned from the cache immediately and refreshed from
+         * the original data source in the background. The cached tile is replaced only if the content has changed.
+         * By default, the mode is off and expired tiles are reloaded before returning.
+         * @param enabled True when the mode should be enabled, false otherwise.
+         */
+        void setStaleWhileRevalidate(bool enabled);
+
+        /**
+         * Returns the usage statistics of the cache, accumulated since the data source was created.
+         * @return The statistics of the cache.
+         */
+        std::shared_ptr<CacheStatistics> getCacheStatistics() const;
+
     protected:
         class DataSourceListener : public TileDataSource::OnChangeListener {
         public:
             explicit DataSourceListener(CacheTileDataSource& cacheDataSource);
             
             virtual void onTilesChanged(bool removeTiles);
+            virtual void onTilesChanged(const std::vector<MapTile>& tiles, bool removeTiles);
             
         private:
             CacheTileDataSource& _cacheDataSource;
         };
         
+        class RevalidateTask : public CancelableTask {
+        public:
+            RevalidateTask(const std::shared_ptr<CacheTileDataSource>& dataSource, const MapTile& mapTile, const std::shared_ptr<TileData>& staleTileData);
+
+            virtual void run();
+
+        private:
+            std::weak_ptr<CacheTileDataSource> _dataSource;
+            MapTile _mapTile;
+            std::shared_ptr<TileData> _staleTileData;
+        };
+
         CacheTileDataSource(const std::shared_ptr<TileDataSource>& dataSource);
 
+        /**
+         * Schedules a background refresh of an expired tile and returns the stale tile data to use in the meantime.
+         * @param mapTile The expired tile.
+         * @param tileData The expired tile data.
+         * @return The tile data to return instead of the expired tile data.
+         */
+        std::shared_ptr<TileData> revalidateTile(const MapTile& mapTile, const std::shared_ptr<TileData>& tileData);
+        /**
+         * Stores a tile refreshed in the background. The default implementation does nothing.
+         * @param mapTile The refreshed tile.
+         * @param tileData The refreshed tile data. If the content did not change, the data blob is the stale one.
+         * @param changed True if the tile content changed.
+         */
+        virtual void storeRevalidatedTile(const MapTile& mapTile, const std::shared_ptr<TileData>& tileData, bool changed);
+
+        /**
+         * Returns the current size of the cache. The default implementation returns 0.
+         * @return The size of the cache in bytes.
+         */
+        virtual std::size_t getCacheSize() const;
+        /**
+         * Counts a tile lookup for the cache statistics.
+         * @param hit True if the tile was served from the cache.
+         */
+        void countCacheLookup(bool hit);
+
+        static const int STALE_TILE_MAX_AGE = 5000; // in milliseconds
+        static const int REVALIDATE_TASK_PRIORITY = -1;
+
         const DirectorPtr<TileDataSource> _dataSource;
         
     private:
         std::shared_ptr<DataSourceListener> _dataSourceListener;
+
+        std::atomic<bool> _staleWhileRevalidate;
+        std::atomic<long long> _cacheHitCount;
+        std::atomic<long long> _cacheMissCount;
+        std::shared_ptr<CancelableThreadPool> _revalidateThreadPool;
+        std::unordered_set<long long> _revalidatingTileIds;
+        mutable std::mutex _revalidateMutex;
     };
     
 }
@@ -1,6 +1,8 @@
 #include "CartoOnlineTileDataSource.h"
 #include "core/BinaryData.h"
 #include "core/MapTile.h"
+#include "datasources/components/NetworkStatistics.h"
+#include "network/NetworkStatisticsCollector.h"
 #include "components/LicenseManager.h"
 #include "packagemanager/PackageTileMask.h"
 #include "utils/Log.h"
@@ -18,6 +20,7 @@ namespace carto {
         TileDataSource(),
         _source(source),
         _cache(MAX_CACHED_TILES),
+        _networkStatisticsCollector(std::make_shared<NetworkStatisticsCollector>()),
         _httpClient(Log::IsShowDebug()),
         _schema(),
         _tmsScheme(false),
@@ -27,6 +30,11 @@ namespace carto {
         _mutex()
     {
         _maxZoom = DEFAULT_MAX_ZOOM;
+        _httpClient.setAdaptiveConcurrency(true);
+        std::shared_ptr<NetworkStatisticsCollector> networkStatisticsCollector = _networkStatisticsCollector;
+        _httpClient.setStatisticsHandler([networkStatisticsCollector](const HTTPClient::RequestStatistics& statistics) {
+            networkStatisticsCollector->addRequest(statistics);
+        });
     }
     
     CartoOnlineTileDataSource::~CartoOnlineTileDataSource() {
@@ -42,16 +50,36 @@ namespace carto {
         return _schema;
     }
 
+    std::shared_ptr<NetworkStatistics> CartoOnlineTileDataSource::getNetworkStatistics() const {
+        return _networkStatisticsCollector->getStatistics();
+    }
+
+    void CartoOnlineTileDataSource::resetNetworkStatistics() {
+        _networkStatisticsCollector->reset();
+    }
+
     std::shared_ptr<TileData> CartoOnlineTileDataSource::loadTile(const MapTile& mapTile) {
+        return loadTile(mapTile, std::shared_ptr<TileData>());
+    }
+
+    std::shared_ptr<TileData> CartoOnlineTileDataSource::reloadTile(const MapTile& mapTile, const std::shared_ptr<TileData>& cachedTileData) {
+        return loadTile(mapTile, cachedTileData);
+    }
+
+    std::shared_ptr<TileData> CartoOnlineTileDataSource::loadTile(const MapTile& mapTile, const std::shared_ptr<TileData>& cachedTileData) {
         std::unique_lock<std::recursive_mutex> lock(_mutex);
 
         // Check if the tile is in cache
         std::shared_ptr<TileData> tileData;
+        std::shared_ptr<TileData> expiredTileData = cachedTileData;
         if (_cache.read(mapTile.getTileId(), tileData)) {
             if (tileData->getMaxAge() != 0) {
                 return tileData;
             }
             _cache.remove(mapTile.getTileId());
+            if (!expiredTileData) {
+                expiredTileData = tileData;
+            }
         }
 
         // Reload tile service URLs, if needed
@@ -76,7 +104,7 @@ namespace carto {
 
         // Fetch online tile, allow parallel tile fetching
         lock.unlock();
-        tileData = loadOnlineTile(tileURL, mapTile);
+        tileData = loadOnlineTile(tileURL, mapTile, expiredTileData);
         lock.lock();
 
         // Store the tile in local cache
@@ -193,7 +221,7 @@ namespace carto {
         return !_tileURLs.empty();
     }
     
-    std::shared_ptr<TileData> CartoOnlineTileDataSource::loadOnlineTile(const std::string& tileURL, const MapTile& mapTile) {
+    std::shared_ptr<TileData> CartoOnlineTileDataSource::loadOnlineTile(const std::string& tileURL, const MapTile& mapTile, const std::shared_ptr<TileData>& cachedTileData) {
         Log::Infof("CartoOnlineTileDataSource::loadOnlineTile: Loading tile %d/%d/%d", mapTile.getZoom(), mapTile.getX(), mapTile.getY());
 
         std::string url = buildTileURL(tileURL, mapTile);
@@ -203,12 +231,17 @@ namespace carto {
 
         Log::Debugf("CartoOnlineTileDataSource::loadOnlineTile: Loading %s", url.c_str());
         std::map<std::string, std::string> requestHeaders = NetworkUtils::CreateAppRefererHeader();
-#if defined(__APPLE__)
-        // Temporary hack to get gzipped tile on iOS. This works because our tile decoder can detect gzip encoding.
-        if (_source == "carto.streets") {
-            requestHeaders["Accept-Encoding"] = "gzip";
+        // Make a conditional request if the validators of the cached tile are known
+        if (cachedTileData && cachedTileData->getData()) {
+            std::string etag = cachedTileData->getETag();
+            if (!etag.empty()) {
+                requestHeaders["If-None-Match"] = etag;
+            }
+            std::string lastModified = cachedTileData->getLastModified();
+            if (!lastModified.empty()) {
+                requestHeaders["If-Modified-Since"] = lastModified;
+            }
         }
-#endif
         std::map<std::string, std::string> responseHeaders;
         std::shared_ptr<BinaryData> responseData;
         int statusCode = -1;
@@ -216,6 +249,9 @@ namespace carto {
             if (_httpClient.get(url, requestHeaders, responseHeaders, responseData, &statusCode) != 0) {
                 if (statusCode == 404) {
                     responseData = std::make_shared<BinaryData>(std::vector<unsigned char>());
+                } else if (statusCode == 304 && cachedTileData && cachedTileData->getData()) {
+                    Log::Infof("CartoOnlineTileDataSource::loadOnlineTile: Tile %d/%d/%d not modified, reusing cached data", mapTile.getZoom(), mapTile.getX(), mapTile.getY());
+                    responseData = cachedTileData->getData();
                 } else {
                     Log::Errorf("CartoOnlineTileDataSource::loadOnlineTile: Failed to load tile %d/%d/%d: status code %d", mapTile.getZoom(), mapTile.getX(), mapTile.getY(), statusCode);
                     return std::shared_ptr<TileData>();
@@ -228,6 +264,17 @@ namespace carto {
         }
         int maxAge = NetworkUtils::GetMaxAgeHTTPHeader(responseHeaders);
         auto tileData = std::make_shared<TileData>(responseData);
+        tileData->setETag(NetworkUtils::GetHTTPHeader(responseHeaders, "ETag"));
+        tileData->setLastModified(NetworkUtils::GetHTTPHeader(responseHeaders, "Last-Modified"));
+        if (statusCode == 304) {
+            // The validators are not necessarily repeated in 304 responses
+            if (tileData->getETag().empty()) {
+                tileData->setETag(cachedTileData->getETag());
+            }
+            if (tileData->getLastModified().empty()) {
+                tileData->setLastModified(cachedTileData->getLastModified());
+            }
+        }
         if (maxAge > 0) {
             Log::Infof("CartoOnlineTileDataSource::loadOnlineTile: Setting tile %d/%d/%d maxage=%d", mapTile.getZoom(), mapTile.getX(), mapTile.getY(), maxAge);
             tileData->setMaxAge(maxAge * 1000);
@@ -17,6 +17,8 @@
 
 namespace carto {
     class BinaryData;
+    class NetworkStatistics;
+    class NetworkStatisticsCollector;
     class PackageTileMask;
     
     /**
@@ -39,7 +41,19 @@ namespace carto {
          */
         std::string getSchema();
 
+        /**
+         * Returns the aggregated statistics of the network requests made by this data source.
+         * @return The network request statistics.
+         */
+        std::shared_ptr<NetworkStatistics> getNetworkStatistics() const;
+        /**
+         * Clears the collected network request statistics.
+         */
+        void resetNetworkStatistics();
+
         virtual std::shared_ptr<TileData> loadTile(const MapTile& mapTile);
+
+        virtual std::shared_ptr<TileData> reloadTile(const MapTile& mapTile, const std::shared_ptr<TileData>& cachedTileData);
         
     protected:
         struct TileMask {
@@ -52,7 +66,9 @@ namespace carto {
 
         bool loadConfiguration();
 
-        std::shared_ptr<TileData> loadOnlineTile(const std::string& url, const MapTile& mapTile);
+        std::shared_ptr<TileData> loadTile(const MapTile& mapTile, const std::shared_ptr<TileData>& cachedTileData);
+
+        std::shared_ptr<TileData> loadOnlineTile(const std::string& url, const MapTile& mapTile, const std::shared_ptr<TileData>& cachedTileData);
 
         static const int DEFAULT_MAX_ZOOM = 14;
         static const int MAX_CACHED_TILES = 8;
@@ -60,6 +76,7 @@ namespace carto {
 
         const std::string _source;
         mutable cache::timed_lru_cache<long long, std::shared_ptr<TileData> > _cache;
+        std::shared_ptr<NetworkStatisticsCollector> _networkStatisticsCollector;
         HTTPClient _httpClient;
 
         std::string _schema;
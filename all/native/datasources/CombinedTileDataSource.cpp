@@ -60,5 +60,9 @@ namespace carto {
     void CombinedTileDataSource::DataSourceListener::onTilesChanged(bool removeTiles) {
         _combinedDataSource.notifyTilesChanged(removeTiles);
     }
+
+    void CombinedTileDataSource::DataSourceListener::onTilesChanged(const std::vector<MapTile>& tiles, bool removeTiles) {
+        _combinedDataSource.notifyTilesChanged(tiles, removeTiles);
+    }
     
 }
@@ -19,6 +19,8 @@
 #include "assets/gdal/projop_wparm_csv.h"
 #include "assets/gdal/unit_of_measure_csv.h"
 
+#include <algorithm>
+
 #include <boost/lexical_cast.hpp>
 
 #include <gdal_priv.h>
@@ -90,6 +92,7 @@ namespace carto {
 
     GDALRasterTileDataSource::GDALRasterTileDataSource(int minZoom, int maxZoom, const std::string& fileName) :
         TileDataSource(minZoom, maxZoom),
+        _fileName(fileName),
         _width(0),
         _height(0),
         _tileSize(256),
@@ -97,28 +100,35 @@ namespace carto {
         _transform(cglib::mat3x3<double>::identity()),
         _invTransform(cglib::mat3x3<double>::identity()),
         _projection(std::make_shared<EPSG3857>()),
-        _mutex()
+        _blockCache(DEFAULT_BLOCK_CACHE_SIZE),
+        _idleDatasets(),
+        _mutex(),
+        _datasetsMutex()
     {
-        _poDataset = (GDALDataset*)GDALOpen(fileName.c_str(), GA_ReadOnly);
-        if (!_poDataset) {
+        GDALDataset* poDataset = (GDALDataset*)GDALOpen(fileName.c_str(), GA_ReadOnly);
+        if (!poDataset) {
             throw FileException("Failed to open file", fileName);
         }
 
-        _width = _poDataset->GetRasterXSize();
-        _height = _poDataset->GetRasterYSize();
+        _width = poDataset->GetRasterXSize();
+        _height = poDataset->GetRasterYSize();
         Log::Infof("GDALRasterTileDataSource: Width %d, height %d", _width, _height);
         
         std::shared_ptr<OGRSpatialReference> poDatasetSpatialRef = std::make_shared<OGRSpatialReference>();
-        char* pWktDataset = const_cast<char*>(_poDataset->GetProjectionRef());
+        char* pWktDataset = const_cast<char*>(poDataset->GetProjectionRef());
         if (poDatasetSpatialRef->importFromWkt(&pWktDataset) != OGRERR_NONE) {
             Log::Error("GDALRasterTileDataSource: Failed to read data set projection info");
         }
 
-        initializeTransform(poDatasetSpatialRef);
+        initializeTransform(poDataset, poDatasetSpatialRef);
+
+        // Keep the handle for reading the tiles
+        _idleDatasets.push_back(poDataset);
     }
     
     GDALRasterTileDataSource::GDALRasterTileDataSource(int minZoom, int maxZoom, const std::string& fileName, const std::string& srs) :
         TileDataSource(minZoom, maxZoom),
+        _fileName(fileName),
         _width(0),
         _height(0),
         _tileSize(256),
@@ -126,15 +136,18 @@ namespace carto {
         _transform(cglib::mat3x3<double>::identity()),
         _invTransform(cglib::mat3x3<double>::identity()),
         _projection(std::make_shared<EPSG3857>()),
-        _mutex()
+        _blockCache(DEFAULT_BLOCK_CACHE_SIZE),
+        _idleDatasets(),
+        _mutex(),
+        _datasetsMutex()
     {
-        _poDataset = (GDALDataset*)GDALOpen(fileName.c_str(), GA_ReadOnly);
-        if (!_poDataset) {
+        GDALDataset* poDataset = (GDALDataset*)GDALOpen(fileName.c_str(), GA_ReadOnly);
+        if (!poDataset) {
             throw FileException("Failed to open file", fileName);
         }
         
-        _width = _poDataset->GetRasterXSize();
-        _height = _poDataset->GetRasterYSize();
+        _width = poDataset->GetRasterXSize();
+        _height = poDataset->GetRasterYSize();
         Log::Infof("GDALRasterTileDataSource: Width %d, height %d", _width, _height);
         
         std::shared_ptr<OGRSpatialReference> poDatasetSpatialRef = std::make_shared<OGRSpatialReference>();
@@ -155,20 +168,19 @@ namespace carto {
             }
         }
         
-        initializeTransform(poDatasetSpatialRef);
+        initializeTransform(poDataset, poDatasetSpatialRef);
+
+        // Keep the handle for reading the tiles
+        _idleDatasets.push_back(poDataset);
     }
     
     GDALRasterTileDataSource::~GDALRasterTileDataSource() {
-        if (_poDataset) {
-            delete _poDataset;
+        for (GDALDataset* poDataset : _idleDatasets) {
+            delete poDataset;
         }
     }
 
     std::shared_ptr<TileData> GDALRasterTileDataSource::loadTile(const MapTile& mapTile) {
-        if (!_poDataset) {
-            return std::shared_ptr<TileData>();
-        }
-
         // Calculate tile bounds
         MapBounds projBounds = _projection->getBounds();
         double scaleX =  projBounds.getDelta().getX() / (1 << mapTile.getZoom());
@@ -188,13 +200,13 @@ namespace carto {
 
         // Adjust downsampling factors. Downsampling allows to keep memory usage in control while degrading quality
         int downsampleU = 0;
-        for (; downsampleU < 32; downsampleU++) {
+        for (; downsampleU < MAX_DOWNSAMPLE_LEVEL; downsampleU++) {
             if ((maxU - minU) < _tileSize * (MAX_DOWNSAMPLE_FACTOR << downsampleU)) {
                 break;
             }
         }
         int downsampleV = 0;
-        for (; downsampleV < 32; downsampleV++) {
+        for (; downsampleV < MAX_DOWNSAMPLE_LEVEL; downsampleV++) {
             if ((maxV - minV) < _tileSize * (MAX_DOWNSAMPLE_FACTOR << downsampleV)) {
                 break;
             }
@@ -219,13 +231,81 @@ namespace carto {
         BitmapFilterTable filterTable(minUds, minVds, maxUds, maxVds);
         filterTable.calculateFilterTable(AffineTransform(invTransformDS), _tileSize, _tileSize, FILTER_SCALE, MAX_FILTER_WIDTH);
 
-        // Read tile data by band
-        std::lock_guard<std::mutex> lock(_mutex);
+        // Collect the downsampled source area from the cached blocks, read the missing blocks.
+        // The blocks are read using a separate dataset handle per thread, so that the tiles can be generated in parallel.
+        int sourceWidth = maxUds - minUds;
+        int sourceHeight = maxVds - minVds;
+        std::vector<unsigned char> sourceData(sourceWidth * sourceHeight * 4);
+        std::shared_ptr<GDALDataset> poDataset;
+        int widthDS = ((_width - 1) >> downsampleU) + 1;
+        int heightDS = ((_height - 1) >> downsampleV) + 1;
+        for (int blockV = minVds / BLOCK_SIZE; blockV <= (maxVds - 1) / BLOCK_SIZE; blockV++) {
+            for (int blockU = minUds / BLOCK_SIZE; blockU <= (maxUds - 1) / BLOCK_SIZE; blockU++) {
+                long long blockKey = (((static_cast<long long>(downsampleU * MAX_DOWNSAMPLE_LEVEL + downsampleV) << 24) | blockV) << 24) | blockU;
+                std::shared_ptr<std::vector<unsigned char> > blockData;
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _blockCache.read(blockKey, blockData);
+                }
+                if (!blockData) {
+                    if (!poDataset) {
+                        poDataset = acquireDataset();
+                        if (!poDataset) {
+                            return std::shared_ptr<TileData>();
+                        }
+                    }
+                    blockData = readBlock(poDataset.get(), downsampleU, downsampleV, blockU, blockV);
 
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _blockCache.put(blockKey, blockData, blockData->size());
+                }
+
+                int blockU0 = blockU * BLOCK_SIZE;
+                int blockV0 = blockV * BLOCK_SIZE;
+                int blockWidth = std::min(widthDS, blockU0 + BLOCK_SIZE) - blockU0;
+                int blockHeight = std::min(heightDS, blockV0 + BLOCK_SIZE) - blockV0;
+                int u0 = std::max(minUds, blockU0);
+                int u1 = std::min(maxUds, blockU0 + blockWidth);
+                for (int v = std::max(minVds, blockV0); v < std::min(maxVds, blockV0 + blockHeight); v++) {
+                    const unsigned char* blockRow = &(*blockData)[((v - blockV0) * blockWidth + (u0 - blockU0)) * 4];
+                    std::copy(blockRow, blockRow + (u1 - u0) * 4, &sourceData[((v - minVds) * sourceWidth + (u0 - minUds)) * 4]);
+                }
+            }
+        }
+        poDataset.reset();
+
+        // Filter all the channels in a single pass
         std::vector<unsigned char> data(_tileSize * _tileSize * 4);
-        std::vector<unsigned char> bandData((maxUds - minUds) * (maxVds - minVds));
-        for (int n = 1; n <= _poDataset->GetRasterCount(); n++) {
-            GDALRasterBand* poRasterBand = _poDataset->GetRasterBand(n);
+        filterTable.filterPixels(sourceData.data(), data.data(), 0, filterTable.getPixelCount());
+
+        // Build bitmap, "compress" (serialize) to internal format
+        Bitmap bitmap(data.data(), _tileSize, _tileSize, ColorFormat::COLOR_FORMAT_RGBA, 4 * _tileSize);
+        return std::make_shared<TileData>(bitmap.compressToInternal());
+    }
+
+    std::shared_ptr<std::vector<unsigned char> > GDALRasterTileDataSource::readBlock(GDALDataset* poDataset, int downsampleU, int downsampleV, int blockU, int blockV) const {
+        // Calculate the block area in the downsampled raster and in the full resolution raster
+        int widthDS = ((_width - 1) >> downsampleU) + 1;
+        int heightDS = ((_height - 1) >> downsampleV) + 1;
+        int u0 = blockU * BLOCK_SIZE;
+        int v0 = blockV * BLOCK_SIZE;
+        int u1 = std::min(widthDS, u0 + BLOCK_SIZE);
+        int v1 = std::min(heightDS, v0 + BLOCK_SIZE);
+        int srcU0 = u0 << downsampleU;
+        int srcV0 = v0 << downsampleV;
+        int srcU1 = std::min(_width, u1 << downsampleU);
+        int srcV1 = std::min(_height, v1 << downsampleV);
+
+        auto blockData = std::make_shared<std::vector<unsigned char> >((u1 - u0) * (v1 - v0) * 4, 0);
+        if (!_hasAlpha) {
+            for (std::size_t i = 3; i < blockData->size(); i += 4) {
+                (*blockData)[i] = 255;
+            }
+        }
+
+        std::vector<unsigned char> bandData((u1 - u0) * (v1 - v0));
+        for (int n = 1; n <= poDataset->GetRasterCount(); n++) {
+            GDALRasterBand* poRasterBand = poDataset->GetRasterBand(n);
             if (!poRasterBand) {
                 Log::Warnf("GDALRasterTileDataSource: Failed to read band %d", n);
                 continue;
@@ -257,49 +337,72 @@ namespace carto {
                 continue;
             }
 
-            poRasterBand->RasterIO(GF_Read, minU, minV, maxU - minU, maxV - minV, (void *)&bandData[0], maxUds - minUds, maxVds - minVds, GDT_Byte, 0, 0);
-
-            std::size_t sampleIndex = 0;
-            const std::vector<BitmapFilterTable::Sample>& samples = filterTable.getSamples();
-            for (int i = 0; i < _tileSize * _tileSize; i++) {
-                int count = filterTable.getSampleCounts()[i];
-                if (count == 0) {
+            // Use the smallest overview that still has at least the downsampled resolution, so that full resolution pixels are not read for low zoom levels
+            GDALRasterBand* poReadBand = poRasterBand;
+            for (int k = 0; k < poRasterBand->GetOverviewCount(); k++) {
+                GDALRasterBand* poOverviewBand = poRasterBand->GetOverview(k);
+                if (!poOverviewBand) {
                     continue;
                 }
-
-                float filteredValue = 0.5f;
-                for (int j = 0; j < count; j++) {
-                    const BitmapFilterTable::Sample& sample = samples[sampleIndex++];
-                    filteredValue += bandData[sample.v * (maxUds - minUds) + sample.u] * sample.weight;
+                if (poOverviewBand->GetXSize() >= widthDS && poOverviewBand->GetYSize() >= heightDS && poOverviewBand->GetXSize() < poReadBand->GetXSize()) {
+                    poReadBand = poOverviewBand;
                 }
+            }
+            int readWidth = poReadBand->GetXSize();
+            int readHeight = poReadBand->GetYSize();
+            int readU0 = static_cast<int>(static_cast<long long>(srcU0) * readWidth / _width);
+            int readV0 = static_cast<int>(static_cast<long long>(srcV0) * readHeight / _height);
+            int readU1 = std::max(readU0 + 1, std::min(readWidth, static_cast<int>((static_cast<long long>(srcU1) * readWidth + _width - 1) / _width)));
+            int readV1 = std::max(readV0 + 1, std::min(readHeight, static_cast<int>((static_cast<long long>(srcV1) * readHeight + _height - 1) / _height)));
+
+            CPLErr err = poReadBand->RasterIO(GF_Read, readU0, readV0, readU1 - readU0, readV1 - readV0, (void *)&bandData[0], u1 - u0, v1 - v0, GDT_Byte, 0, 0);
+            if (err != CE_None) {
+                Log::Warnf("GDALRasterTileDataSource: Failed to read band %d data, error code %d", n, (int)err);
+                continue;
+            }
+
+            for (std::size_t i = 0; i < bandData.size(); i++) {
                 for (int j = 0; mask >= (1 << j); j++) {
                     if (mask & (1 << j)) {
-                        data[i * 4 + j] = static_cast<unsigned char>(filteredValue);
+                        (*blockData)[i * 4 + j] = bandData[i];
                     }
                 }
             }
         }
-        if (!_hasAlpha) {
-            std::size_t sampleIndex = 0;
-            const std::vector<BitmapFilterTable::Sample>& samples = filterTable.getSamples();
-            for (int i = 0; i < _tileSize * _tileSize; i++) {
-                int count = filterTable.getSampleCounts()[i];
-                if (count == 0) {
-                    continue;
-                }
-                
-                float filteredValue = 0.5f;
-                for (int j = 0; j < count; j++) {
-                    const BitmapFilterTable::Sample& sample = samples[sampleIndex++];
-                    filteredValue += 255 * sample.weight;
-                }
-                data[i * 4 + 3] = static_cast<unsigned char>(filteredValue);
+        return blockData;
+    }
+
+    std::shared_ptr<GDALDataset> GDALRasterTileDataSource::acquireDataset() const {
+        GDALDataset* poDataset = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(_datasetsMutex);
+            if (!_idleDatasets.empty()) {
+                poDataset = _idleDatasets.back();
+                _idleDatasets.pop_back();
             }
         }
+        if (!poDataset) {
+            // Open the file outside the lock, other threads may keep using the idle handles meanwhile
+            poDataset = (GDALDataset*)GDALOpen(_fileName.c_str(), GA_ReadOnly);
+            if (!poDataset) {
+                Log::Errorf("GDALRasterTileDataSource::acquireDataset: Failed to open file %s", _fileName.c_str());
+                return std::shared_ptr<GDALDataset>();
+            }
+        }
+        return std::shared_ptr<GDALDataset>(poDataset, [this](GDALDataset* poDS) {
+            releaseDataset(poDS);
+        });
+    }
 
-        // Build bitmap, "compress" (serialize) to internal format
-        Bitmap bitmap(data.data(), _tileSize, _tileSize, ColorFormat::COLOR_FORMAT_RGBA, 4 * _tileSize);
-        return std::make_shared<TileData>(bitmap.compressToInternal());
+    void GDALRasterTileDataSource::releaseDataset(GDALDataset* poDataset) const {
+        {
+            std::lock_guard<std::mutex> lock(_datasetsMutex);
+            if (_idleDatasets.size() < MAX_IDLE_DATASETS) {
+                _idleDatasets.push_back(poDataset);
+                return;
+            }
+        }
+        delete poDataset;
     }
 
     MapBounds GDALRasterTileDataSource::getDataExtent() const {
@@ -315,7 +418,7 @@ namespace carto {
         return bounds;
     }
 
-    void GDALRasterTileDataSource::initializeTransform(const std::shared_ptr<OGRSpatialReference>& poDatasetSpatialRef) {
+    void GDALRasterTileDataSource::initializeTransform(GDALDataset* poDataset, const std::shared_ptr<OGRSpatialReference>& poDatasetSpatialRef) {
         std::shared_ptr<OGRSpatialReference> poEPSG3857SpatialRef = std::make_shared<OGRSpatialReference>();
         if (poEPSG3857SpatialRef->importFromEPSG(3857) != OGRERR_NONE) {
             Log::Error("GDALRasterTileDataSource: Failed to import EPSG3857");
@@ -324,7 +427,7 @@ namespace carto {
         std::shared_ptr<OGRCoordinateTransformation> poCoordinateTransform(OGRCreateCoordinateTransformation(poDatasetSpatialRef.get(), poEPSG3857SpatialRef.get()), OGRCoordinateTransformation::DestroyCT);
 
         double adfGeoTransform[6];
-        if (_poDataset->GetGeoTransform(adfGeoTransform) == CE_None) {
+        if (poDataset->GetGeoTransform(adfGeoTransform) == CE_None) {
             cglib::mat3x3<double> transform = cglib::mat3x3<double>::identity();
             transform(0, 0) = adfGeoTransform[1];
             transform(0, 1) = adfGeoTransform[2];
@@ -358,10 +461,10 @@ namespace carto {
             Log::Error("GDALRasterTileDataSource: Failed to read dataset transform.");
         }
         
-        int rasterCount = _poDataset->GetRasterCount();
+        int rasterCount = poDataset->GetRasterCount();
         Log::Infof("GDALRasterTileDataSource: Number of raster bands: %d", rasterCount);
         for (int n = 1; n <= rasterCount; n++) {
-            GDALRasterBand* poRasterBand = _poDataset->GetRasterBand(n);
+            GDALRasterBand* poRasterBand = poDataset->GetRasterBand(n);
             if (!poRasterBand) {
                 Log::Errorf("GDALRasterTileDataSource: Failed to read band %d", n);
                 continue;
@@ -378,6 +481,10 @@ namespace carto {
     const float GDALRasterTileDataSource::FILTER_SCALE = 1.5f;
     const int GDALRasterTileDataSource::MAX_FILTER_WIDTH = 16;
     const int GDALRasterTileDataSource::MAX_DOWNSAMPLE_FACTOR = 8;
+    const int GDALRasterTileDataSource::MAX_DOWNSAMPLE_LEVEL = 24;
+    const int GDALRasterTileDataSource::BLOCK_SIZE = 256;
+    const std::size_t GDALRasterTileDataSource::DEFAULT_BLOCK_CACHE_SIZE = 16 * 1024 * 1024;
+    const std::size_t GDALRasterTileDataSource::MAX_IDLE_DATASETS = 4;
 }
 
 #endif
@@ -11,6 +11,12 @@
 
 #include "datasources/TileDataSource.h"
 
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <stdext/timed_lru_cache.h>
+
 #include <cglib/vec.h>
 #include <cglib/mat.h>
 
@@ -50,9 +56,14 @@ namespace carto {
         virtual std::shared_ptr<TileData> loadTile(const MapTile& mapTile);
         
     private:
-        void initializeTransform(const std::shared_ptr<OGRSpatialReference>& poDatasetSpatialRef);
+        void initializeTransform(GDALDataset* poDataset, const std::shared_ptr<OGRSpatialReference>& poDatasetSpatialRef);
+
+        std::shared_ptr<GDALDataset> acquireDataset() const;
+        void releaseDataset(GDALDataset* poDataset) const;
 
-        GDALDataset* _poDataset;
+        std::shared_ptr<std::vector<unsigned char> > readBlock(GDALDataset* poDataset, int downsampleU, int downsampleV, int blockU, int blockV) const;
+
+        std::string _fileName;
         int _width;
         int _height;
         int _tileSize;
@@ -61,11 +72,20 @@ namespace carto {
         cglib::mat3x3<double> _invTransform;
         std::shared_ptr<Projection> _projection;
 
+        cache::timed_lru_cache<long long, std::shared_ptr<std::vector<unsigned char> > > _blockCache;
+
+        mutable std::vector<GDALDataset*> _idleDatasets; // GDAL datasets can not be used concurrently, each reading thread takes its own handle
+
         mutable std::mutex _mutex;
+        mutable std::mutex _datasetsMutex;
 
         static const float FILTER_SCALE;
         static const int MAX_FILTER_WIDTH;
         static const int MAX_DOWNSAMPLE_FACTOR;
+        static const int MAX_DOWNSAMPLE_LEVEL;
+        static const int BLOCK_SIZE;
+        static const std::size_t DEFAULT_BLOCK_CACHE_SIZE;
+        static const std::size_t MAX_IDLE_DATASETS;
     };
 }
 
@@ -2,12 +2,18 @@
 #include "core/BinaryData.h"
 #include "core/MapTile.h"
 #include "components/Exceptions.h"
+#include "geometry/Feature.h"
 #include "geometry/FeatureCollection.h"
 #include "geometry/GeoJSONGeometryWriter.h"
 #include "projections/Projection.h"
 #include "utils/Const.h"
+#include "utils/TileUtils.h"
 #include "utils/Log.h"
 
+#include <algorithm>
+#include <functional>
+#include <unordered_set>
+
 #include <mbvtbuilder/MBVTTileBuilder.h>
 
 #include <mapnikvt/mbvtpackage/MBVTPackage.pb.h>
@@ -16,33 +22,28 @@ namespace carto {
 
     GeoJSONVectorTileDataSource::GeoJSONVectorTileDataSource(int minZoom, int maxZoom) :
         TileDataSource(minZoom, maxZoom),
-        _tileBuilder(new mbvtbuilder::MBVTTileBuilder(minZoom, maxZoom)),
+        _layers(),
+        _tileIndex(),
+        _tileCache(DEFAULT_TILE_CACHE_SIZE),
         _mutex()
     {
+        _tileIndex = std::make_shared<GeoJSONTileIndex>(std::vector<std::shared_ptr<const GeoJSONTileIndex::Feature> >(), _projection, TILE_BUFFER);
     }
-    
+
     GeoJSONVectorTileDataSource::~GeoJSONVectorTileDataSource() {
     }
 
     int GeoJSONVectorTileDataSource::createLayer(const std::string& name) {
-        int layerIndex = -1;
-        try {
-            std::lock_guard<std::mutex> lock(_mutex);
-            layerIndex = _tileBuilder->createLayer(name);
-        }
-        catch (const std::exception& ex) {
-            Log::Errorf("GeoJSONVectorTileDataSource::createLayer: Failed to create layer: %s", ex.what());
-            throw GenericException("Failed to create layer", ex.what());
-        }
-        notifyTilesChanged(false);
+        std::lock_guard<std::mutex> lock(_mutex);
+        int layerIndex = _layers.empty() ? 0 : _layers.rbegin()->first + 1;
+        _layers[layerIndex].name = name;
+        // NOTE: the layer is empty, no need to update the tiles
         return layerIndex;
     }
 
     void GeoJSONVectorTileDataSource::setLayerGeoJSON(int layerIndex, const Variant& geoJSON) {
         try {
-            std::lock_guard<std::mutex> lock(_mutex);
-            _tileBuilder->clearLayer(layerIndex);
-            _tileBuilder->importGeoJSONFeatureCollection(layerIndex, geoJSON.toPicoJSON());
+            setLayerFeatures(layerIndex, geoJSON.toPicoJSON());
         }
         catch (const std::exception& ex) {
             Log::Errorf("GeoJSONVectorTileDataSource::setLayerGeoJSON: Failed to update layer: %s", ex.what());
@@ -50,7 +51,7 @@ namespace carto {
         }
         notifyTilesChanged(false);
     }
-    
+
     void GeoJSONVectorTileDataSource::setLayerFeatureCollection(int layerIndex, const std::shared_ptr<Projection>& projection, const std::shared_ptr<FeatureCollection>& featureCollection) {
         if (!featureCollection) {
             throw NullArgumentException("Null featureCollection");
@@ -66,53 +67,301 @@ namespace carto {
                 throw GenericException("Error while serializing feature data", err);
             }
 
-            std::lock_guard<std::mutex> lock(_mutex);
-            _tileBuilder->clearLayer(layerIndex);
-            _tileBuilder->importGeoJSONFeatureCollection(layerIndex, geoJSON);
+            setLayerFeatures(layerIndex, geoJSON);
         }
         catch (const std::exception& ex) {
-            Log::Errorf("GeoJSONVectorTileDataSource::setLayerGeoJSON: Failed to update layer: %s", ex.what());
+            Log::Errorf("GeoJSONVectorTileDataSource::setLayerFeatureCollection: Failed to update layer: %s", ex.what());
             throw GenericException("Failed to set layer contents", ex.what());
         }
         notifyTilesChanged(false);
     }
-    
-    void GeoJSONVectorTileDataSource::deleteLayer(int layerIndex) {
+
+    long long GeoJSONVectorTileDataSource::addLayerFeature(int layerIndex, const std::shared_ptr<Projection>& projection, const std::shared_ptr<Feature>& feature) {
+        if (!feature) {
+            throw NullArgumentException("Null feature");
+        }
+
+        long long featureId = 0;
+        bool tilesInvalidated = false;
+        std::vector<MapTile> changedTiles;
         try {
+            picojson::value featureGeoJSON = serializeFeature(projection, feature);
+            auto indexFeature = std::make_shared<GeoJSONTileIndex::Feature>(layerIndex, featureGeoJSON, calculateFeatureBounds(featureGeoJSON));
+
             std::lock_guard<std::mutex> lock(_mutex);
-            _tileBuilder->deleteLayer(layerIndex);
+            std::map<long long, std::shared_ptr<const GeoJSONTileIndex::Feature> >& layerFeatures = _layers[layerIndex].features;
+            featureId = layerFeatures.empty() ? 0 : layerFeatures.rbegin()->first + 1;
+            layerFeatures[featureId] = indexFeature;
+            updateTileIndex();
+            tilesInvalidated = invalidateTiles(std::vector<MapBounds> { indexFeature->getBounds() }, changedTiles);
         }
         catch (const std::exception& ex) {
-            Log::Errorf("GeoJSONVectorTileDataSource::deleteLayer: Failed to delete layer: %s", ex.what());
+            Log::Errorf("GeoJSONVectorTileDataSource::addLayerFeature: Failed to update layer: %s", ex.what());
+            throw GenericException("Failed to add layer feature", ex.what());
+        }
+        if (tilesInvalidated) {
+            notifyTilesChanged(changedTiles, false);
+        } else {
+            notifyTilesChanged(false);
+        }
+        return featureId;
+    }
+
+    bool GeoJSONVectorTileDataSource::updateLayerFeature(int layerIndex, long long featureId, const std::shared_ptr<Projection>& projection, const std::shared_ptr<Feature>& feature) {
+        if (!feature) {
+            throw NullArgumentException("Null feature");
+        }
+
+        bool tilesInvalidated = false;
+        std::vector<MapTile> changedTiles;
+        try {
+            picojson::value featureGeoJSON = serializeFeature(projection, feature);
+            auto indexFeature = std::make_shared<GeoJSONTileIndex::Feature>(layerIndex, featureGeoJSON, calculateFeatureBounds(featureGeoJSON));
+
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto layerIt = _layers.find(layerIndex);
+            if (layerIt == _layers.end()) {
+                return false;
+            }
+            auto featureIt = layerIt->second.features.find(featureId);
+            if (featureIt == layerIt->second.features.end()) {
+                return false;
+            }
+            MapBounds oldFeatureBounds = featureIt->second->getBounds();
+            featureIt->second = indexFeature;
+            updateTileIndex();
+            tilesInvalidated = invalidateTiles(std::vector<MapBounds> { oldFeatureBounds, indexFeature->getBounds() }, changedTiles);
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("GeoJSONVectorTileDataSource::updateLayerFeature: Failed to update layer: %s", ex.what());
+            throw GenericException("Failed to update layer feature", ex.what());
+        }
+        if (tilesInvalidated) {
+            notifyTilesChanged(changedTiles, false);
+        } else {
+            notifyTilesChanged(false);
+        }
+        return true;
+    }
+
+    bool GeoJSONVectorTileDataSource::removeLayerFeature(int layerIndex, long long featureId) {
+        bool tilesInvalidated = false;
+        std::vector<MapTile> changedTiles;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto layerIt = _layers.find(layerIndex);
+            if (layerIt == _layers.end()) {
+                return false;
+            }
+            auto featureIt = layerIt->second.features.find(featureId);
+            if (featureIt == layerIt->second.features.end()) {
+                return false;
+            }
+            MapBounds oldFeatureBounds = featureIt->second->getBounds();
+            layerIt->second.features.erase(featureIt);
+            updateTileIndex();
+            tilesInvalidated = invalidateTiles(std::vector<MapBounds> { oldFeatureBounds }, changedTiles);
+        }
+        if (tilesInvalidated) {
+            notifyTilesChanged(changedTiles, false);
+        } else {
+            notifyTilesChanged(false);
+        }
+        return true;
+    }
+
+    void GeoJSONVectorTileDataSource::deleteLayer(int layerIndex) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_layers.erase(layerIndex) == 0) {
+                return;
+            }
+            updateTileIndex();
+            _tileCache.clear();
         }
         notifyTilesChanged(false);
     }
 
     MapBounds GeoJSONVectorTileDataSource::getDataExtent() const {
         std::lock_guard<std::mutex> lock(_mutex);
-        MapBounds mapBounds;
-        for (int layerIndex : _tileBuilder->getLayerIndices()) {
-            // NOTE: layerBounds are flipped
-            auto layerBounds = _tileBuilder->getLayerBounds(layerIndex);
-            mapBounds.expandToContain(MapPos(layerBounds.min(0), -layerBounds.max(1)));
-            mapBounds.expandToContain(MapPos(layerBounds.max(0), -layerBounds.min(1)));
-        }
-        return mapBounds;
+        return _tileIndex->getBounds();
     }
-    
+
     std::shared_ptr<TileData> GeoJSONVectorTileDataSource::loadTile(const MapTile& mapTile) {
-        std::lock_guard<std::mutex> lock(_mutex);
         Log::Infof("GeoJSONVectorTileDataSource::loadTile: Loading %s", mapTile.toString().c_str());
+
+        // Take a snapshot of the current state, the tile itself is built without holding the lock
+        std::shared_ptr<const GeoJSONTileIndex> tileIndex;
+        std::vector<std::pair<int, std::string> > layerNames;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            std::shared_ptr<TileData> tileData;
+            if (_tileCache.read(mapTile.getTileId(), tileData)) {
+                return tileData;
+            }
+            tileIndex = _tileIndex;
+            for (auto it = _layers.begin(); it != _layers.end(); it++) {
+                layerNames.emplace_back(it->first, it->second.name);
+            }
+        }
+
         try {
+            std::vector<std::shared_ptr<const GeoJSONTileIndex::Feature> > tileFeatures = tileIndex->getTileFeatures(mapTile);
+
+            // Build the tile from the features overlapping the tile only
+            mbvtbuilder::MBVTTileBuilder tileBuilder(mapTile.getZoom(), mapTile.getZoom());
+            for (const std::pair<int, std::string>& layerName : layerNames) {
+                picojson::array featuresGeoJSON;
+                for (const std::shared_ptr<const GeoJSONTileIndex::Feature>& feature : tileFeatures) {
+                    if (feature->getLayerIndex() == layerName.first) {
+                        featuresGeoJSON.push_back(feature->getGeoJSON());
+                    }
+                }
+                int builderLayerIndex = tileBuilder.createLayer(layerName.second);
+                if (!featuresGeoJSON.empty()) {
+                    picojson::object featureCollectionGeoJSON;
+                    featureCollectionGeoJSON["type"] = picojson::value("FeatureCollection");
+                    featureCollectionGeoJSON["features"] = picojson::value(featuresGeoJSON);
+                    tileBuilder.importGeoJSONFeatureCollection(builderLayerIndex, picojson::value(featureCollectionGeoJSON));
+                }
+            }
+
             protobuf::encoded_message encodedTile;
-            _tileBuilder->buildTile(mapTile.getZoom(), mapTile.getX(), mapTile.getY(), encodedTile);
+            tileBuilder.buildTile(mapTile.getZoom(), mapTile.getX(), mapTile.getY(), encodedTile);
             auto data = std::make_shared<BinaryData>(reinterpret_cast<const unsigned char*>(encodedTile.data().data()), encodedTile.data().size());
-            return std::make_shared<TileData>(data);
+            auto tileData = std::make_shared<TileData>(data);
+
+            // Cache the tile, unless the features were changed meanwhile
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_tileIndex == tileIndex) {
+                _tileCache.put(mapTile.getTileId(), tileData, data->size() + 16);
+            }
+            return tileData;
         }
         catch (const std::exception& ex) {
             Log::Errorf("GeoJSONVectorTileDataSource::loadTile: Failed to build tile: %s", ex.what());
             return std::shared_ptr<TileData>();
         }
     }
-    
+
+    picojson::value GeoJSONVectorTileDataSource::serializeFeature(const std::shared_ptr<Projection>& projection, const std::shared_ptr<Feature>& feature) const {
+        GeoJSONGeometryWriter geometryWriter;
+        geometryWriter.setSourceProjection(projection);
+        geometryWriter.setZ(false);
+        picojson::value featureGeoJSON;
+        std::string err = picojson::parse(featureGeoJSON, geometryWriter.writeFeature(feature));
+        if (!err.empty()) {
+            throw GenericException("Error while serializing feature data", err);
+        }
+        return featureGeoJSON;
+    }
+
+    MapBounds GeoJSONVectorTileDataSource::calculateFeatureBounds(const picojson::value& featureGeoJSON) const {
+        MapBounds wgs84Bounds;
+        std::function<void(const picojson::value&)> expandCoordinates = [&](const picojson::value& coordsGeoJSON) {
+            if (!coordsGeoJSON.is<picojson::array>()) {
+                return;
+            }
+            const picojson::array& coords = coordsGeoJSON.get<picojson::array>();
+            if (coords.size() >= 2 && coords[0].is<double>() && coords[1].is<double>()) {
+                wgs84Bounds.expandToContain(MapPos(coords[0].get<double>(), coords[1].get<double>()));
+                return;
+            }
+            for (const picojson::value& subCoordsGeoJSON : coords) {
+                expandCoordinates(subCoordsGeoJSON);
+            }
+        };
+        std::function<void(const picojson::value&)> expandGeometry = [&](const picojson::value& geometryGeoJSON) {
+            if (!geometryGeoJSON.is<picojson::object>()) {
+                return;
+            }
+            expandCoordinates(geometryGeoJSON.get("coordinates"));
+            const picojson::value& geometriesGeoJSON = geometryGeoJSON.get("geometries");
+            if (geometriesGeoJSON.is<picojson::array>()) {
+                for (const picojson::value& subGeometryGeoJSON : geometriesGeoJSON.get<picojson::array>()) {
+                    expandGeometry(subGeometryGeoJSON);
+                }
+            }
+        };
+        if (featureGeoJSON.is<picojson::object>()) {
+            expandGeometry(featureGeoJSON.get("geometry"));
+        }
+
+        // Empty geometries do not cover any tiles
+        if (wgs84Bounds.getMin().getX() > wgs84Bounds.getMax().getX()) {
+            return MapBounds();
+        }
+        return MapBounds(_projection->fromWgs84(wgs84Bounds.getMin()), _projection->fromWgs84(wgs84Bounds.getMax()));
+    }
+
+    void GeoJSONVectorTileDataSource::setLayerFeatures(int layerIndex, const picojson::value& featureCollectionGeoJSON) {
+        const picojson::value& featuresGeoJSON = featureCollectionGeoJSON.get("features");
+        if (!featuresGeoJSON.is<picojson::array>()) {
+            throw GenericException("Expected FeatureCollection element");
+        }
+
+        std::map<long long, std::shared_ptr<const GeoJSONTileIndex::Feature> > layerFeatures;
+        for (const picojson::value& featureGeoJSON : featuresGeoJSON.get<picojson::array>()) {
+            long long featureId = static_cast<long long>(layerFeatures.size());
+            layerFeatures[featureId] = std::make_shared<GeoJSONTileIndex::Feature>(layerIndex, featureGeoJSON, calculateFeatureBounds(featureGeoJSON));
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _layers[layerIndex].features = std::move(layerFeatures);
+        updateTileIndex();
+        _tileCache.clear();
+    }
+
+    void GeoJSONVectorTileDataSource::updateTileIndex() {
+        // NOTE: the index is immutable and shared with the tile loading threads, so it is replaced instead of being modified.
+        // The nodes of the new index are split lazily again, but only the changed tiles are requested as the rest are cached.
+        std::vector<std::shared_ptr<const GeoJSONTileIndex::Feature> > features;
+        for (auto layerIt = _layers.begin(); layerIt != _layers.end(); layerIt++) {
+            for (auto featureIt = layerIt->second.features.begin(); featureIt != layerIt->second.features.end(); featureIt++) {
+                features.push_back(featureIt->second);
+            }
+        }
+        _tileIndex = std::make_shared<GeoJSONTileIndex>(features, _projection, TILE_BUFFER);
+    }
+
+    bool GeoJSONVectorTileDataSource::invalidateTiles(const std::vector<MapBounds>& boundsList, std::vector<MapTile>& changedTiles) {
+        std::unordered_set<long long> changedTileIds;
+        for (int zoom = getMinZoom(); zoom <= getMaxZoom(); zoom++) {
+            double tileSize = _projection->getBounds().getDelta().getX() / (1 << zoom);
+            MapVec margin(tileSize * TILE_BUFFER, tileSize * TILE_BUFFER);
+            for (const MapBounds& bounds : boundsList) {
+                if (bounds.getMin().getX() > bounds.getMax().getX()) {
+                    continue;
+                }
+
+                // Include the neighbouring tiles if the feature is close to the tile border, as the tiles are built with a buffer
+                MapTile mapTile1 = TileUtils::CalculateMapTile(bounds.getMin() - margin, zoom, _projection);
+                MapTile mapTile2 = TileUtils::CalculateMapTile(bounds.getMax() + margin, zoom, _projection);
+                int maxTileIndex = (1 << zoom) - 1;
+                for (int y = std::max(0, mapTile1.getY()); y <= std::min(maxTileIndex, mapTile2.getY()); y++) {
+                    for (int x = std::max(0, mapTile1.getX()); x <= std::min(maxTileIndex, mapTile2.getX()); x++) {
+                        MapTile changedTile = MapTile(x, y, zoom, 0).getFlipped();
+                        if (changedTileIds.insert(changedTile.getTileId()).second) {
+                            changedTiles.push_back(changedTile);
+                        }
+                        if (static_cast<int>(changedTiles.size()) > MAX_CHANGED_TILES) {
+                            // Too many tiles to track individually, invalidate everything
+                            changedTiles.clear();
+                            _tileCache.clear();
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+
+        for (const MapTile& changedTile : changedTiles) {
+            _tileCache.remove(changedTile.getTileId());
+        }
+        return true;
+    }
+
+    const int GeoJSONVectorTileDataSource::MAX_CHANGED_TILES = 1024;
+    const double GeoJSONVectorTileDataSource::TILE_BUFFER = 0.125;
+
 }
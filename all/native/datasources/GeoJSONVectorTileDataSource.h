@@ -9,21 +9,24 @@
 
 #include "core/Variant.h"
 #include "datasources/TileDataSource.h"
+#include "datasources/components/GeoJSONTileIndex.h"
 
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
-namespace carto {
-    namespace mbvtbuilder {
-        class MBVTTileBuilder;
-    }
+#include <stdext/timed_lru_cache.h>
 
+namespace carto {
     class Projection;
+    class Feature;
     class FeatureCollection;
     
     /**
      * A tile data source that builds vector tiles from GeoJSON inputs.
+     * The features are kept in a hierarchical tile index, tiles are built on demand in parallel and cached.
      */
     class GeoJSONVectorTileDataSource : public TileDataSource {
     public:
@@ -46,6 +49,7 @@ namespace carto {
 
         /**
          * Sets the features of the specified layer.
+         * The features get ids equal to their indices in the collection, these ids can be used for updating individual features later.
          * @param layerIndex The index of the layer. A layer with empty name will be created if it does not exist yet.
          * @param geoJSON A geojson type variant that MUST contain single FeatureColletion element.
          * @throws std::runtime_error If an error occured during updating the layer.
@@ -54,6 +58,7 @@ namespace carto {
 
         /**
          * Sets the feature collection of the specified layer.
+         * The features get ids equal to their indices in the collection, these ids can be used for updating individual features later.
          * @param layerIndex The index of the layer. A layer with empty name will be created if it does not exist yet.
          * @param projection Projection for the features in featureCollection. Can be null if the coordinates are based on WGS84.
          * @param featureCollection The feature collection for the specified layer.
@@ -61,6 +66,34 @@ namespace carto {
          */
         void setLayerFeatureCollection(int layerIndex, const std::shared_ptr<Projection>& projection, const std::shared_ptr<FeatureCollection>& featureCollection);
 
+        /**
+         * Adds a feature to the specified layer. Unlike setting the whole layer, only the tiles covered by the feature are reloaded.
+         * @param layerIndex The index of the layer. A layer with empty name will be created if it does not exist yet.
+         * @param projection Projection for the feature. Can be null if the coordinates are based on WGS84.
+         * @param feature The feature to add.
+         * @return The id of the added feature.
+         * @throws std::runtime_error If an error occured during updating the layer.
+         */
+        long long addLayerFeature(int layerIndex, const std::shared_ptr<Projection>& projection, const std::shared_ptr<Feature>& feature);
+        /**
+         * Replaces an existing feature of the specified layer. Only the tiles covered by the old or new feature are reloaded.
+         * @param layerIndex The index of the layer.
+         * @param featureId The id of the feature to replace.
+         * @param projection Projection for the feature. Can be null if the coordinates are based on WGS84.
+         * @param feature The new feature.
+         * @return True if the feature was found and replaced, false otherwise.
+         * @throws std::runtime_error If an error occured during updating the layer.
+         */
+        bool updateLayerFeature(int layerIndex, long long featureId, const std::shared_ptr<Projection>& projection, const std::shared_ptr<Feature>& feature);
+        /**
+         * Removes an existing feature from the specified layer. Only the tiles covered by the feature are reloaded.
+         * @param layerIndex The index of the layer.
+         * @param featureId The id of the feature to remove.
+         * @return True if the feature was found and removed, false otherwise.
+         * @throws std::runtime_error If an error occured during updating the layer.
+         */
+        bool removeLayerFeature(int layerIndex, long long featureId);
+
         /**
          * Deletes an existing layer.
          * @param layerIndex The index of layer to delete.
@@ -72,7 +105,24 @@ namespace carto {
         virtual std::shared_ptr<TileData> loadTile(const MapTile& mapTile);
     
     private:
-        std::unique_ptr<mbvtbuilder::MBVTTileBuilder> _tileBuilder;
+        struct Layer {
+            std::string name;
+            std::map<long long, std::shared_ptr<const GeoJSONTileIndex::Feature> > features;
+        };
+
+        static const int MAX_CHANGED_TILES;
+        static const double TILE_BUFFER;
+        static const int DEFAULT_TILE_CACHE_SIZE = 8 * 1024 * 1024;
+
+        picojson::value serializeFeature(const std::shared_ptr<Projection>& projection, const std::shared_ptr<Feature>& feature) const;
+        MapBounds calculateFeatureBounds(const picojson::value& featureGeoJSON) const;
+        void setLayerFeatures(int layerIndex, const picojson::value& featureCollectionGeoJSON);
+        void updateTileIndex();
+        bool invalidateTiles(const std::vector<MapBounds>& boundsList, std::vector<MapTile>& changedTiles);
+
+        std::map<int, Layer> _layers;
+        std::shared_ptr<const GeoJSONTileIndex> _tileIndex;
+        cache::timed_lru_cache<long long, std::shared_ptr<TileData> > _tileCache;
         mutable std::mutex _mutex;
     };
     
@@ -1,5 +1,8 @@
 #include "HTTPTileDataSource.h"
+#include "core/BinaryData.h"
 #include "core/MapTile.h"
+#include "datasources/components/NetworkStatistics.h"
+#include "network/NetworkStatisticsCollector.h"
 #include "utils/Log.h"
 #include "utils/NetworkUtils.h"
 #include "utils/GeneralUtils.h"
@@ -13,10 +16,16 @@ namespace carto {
         _tmsScheme(false),
         _maxAgeHeaderCheck(false),
         _headers(),
+        _networkStatisticsCollector(std::make_shared<NetworkStatisticsCollector>()),
         _httpClient(true),
         _randomGenerator(),
         _mutex()
     {
+        _httpClient.setAdaptiveConcurrency(true);
+        std::shared_ptr<NetworkStatisticsCollector> networkStatisticsCollector = _networkStatisticsCollector;
+        _httpClient.setStatisticsHandler([networkStatisticsCollector](const HTTPClient::RequestStatistics& statistics) {
+            networkStatisticsCollector->addRequest(statistics);
+        });
     }
     
     HTTPTileDataSource::~HTTPTileDataSource() {
@@ -87,7 +96,23 @@ namespace carto {
         notifyTilesChanged(false);
     }
     
+    std::shared_ptr<NetworkStatistics> HTTPTileDataSource::getNetworkStatistics() const {
+        return _networkStatisticsCollector->getStatistics();
+    }
+
+    void HTTPTileDataSource::resetNetworkStatistics() {
+        _networkStatisticsCollector->reset();
+    }
+
     std::shared_ptr<TileData> HTTPTileDataSource::loadTile(const MapTile& mapTile) {
+        return loadHTTPTile(mapTile, std::shared_ptr<TileData>());
+    }
+
+    std::shared_ptr<TileData> HTTPTileDataSource::reloadTile(const MapTile& mapTile, const std::shared_ptr<TileData>& cachedTileData) {
+        return loadHTTPTile(mapTile, cachedTileData);
+    }
+
+    std::shared_ptr<TileData> HTTPTileDataSource::loadHTTPTile(const MapTile& mapTile, const std::shared_ptr<TileData>& cachedTileData) {
         std::string baseURL;
         std::map<std::string, std::string> headers;
         bool maxAgeHeaderCheck;
@@ -103,13 +128,31 @@ namespace carto {
             return std::shared_ptr<TileData>();
         }
 
+        // Make a conditional request if the validators of the cached tile are known
+        if (cachedTileData && cachedTileData->getData()) {
+            std::string etag = cachedTileData->getETag();
+            if (!etag.empty()) {
+                headers["If-None-Match"] = etag;
+            }
+            std::string lastModified = cachedTileData->getLastModified();
+            if (!lastModified.empty()) {
+                headers["If-Modified-Since"] = lastModified;
+            }
+        }
+
         Log::Infof("HTTPTileDataSource::loadTile: Loading %s", url.c_str());
         std::map<std::string, std::string> responseHeaders;
         std::shared_ptr<BinaryData> responseData;
+        int statusCode = -1;
         try {
-            if (_httpClient.get(url, headers, responseHeaders, responseData) != 0) {
-                Log::Errorf("HTTPTileDataSource::loadTile: Failed to load %s", url.c_str());
-                return std::shared_ptr<TileData>();
+            if (_httpClient.get(url, headers, responseHeaders, responseData, &statusCode) != 0) {
+                if (statusCode == 304 && cachedTileData && cachedTileData->getData()) {
+                    Log::Infof("HTTPTileDataSource::loadTile: Tile not modified, reusing cached data of %s", url.c_str());
+                    responseData = cachedTileData->getData();
+                } else {
+                    Log::Errorf("HTTPTileDataSource::loadTile: Failed to load %s", url.c_str());
+                    return std::shared_ptr<TileData>();
+                }
             }
         }
         catch (const std::exception& ex) {
@@ -117,6 +160,17 @@ namespace carto {
             return std::shared_ptr<TileData>();
         }
         auto tileData = std::make_shared<TileData>(responseData);
+        tileData->setETag(NetworkUtils::GetHTTPHeader(responseHeaders, "ETag"));
+        tileData->setLastModified(NetworkUtils::GetHTTPHeader(responseHeaders, "Last-Modified"));
+        if (statusCode == 304) {
+            // The validators are not necessarily repeated in 304 responses
+            if (tileData->getETag().empty()) {
+                tileData->setETag(cachedTileData->getETag());
+            }
+            if (tileData->getLastModified().empty()) {
+                tileData->setLastModified(cachedTileData->getLastModified());
+            }
+        }
         if (maxAgeHeaderCheck) {
             int maxAge = NetworkUtils::GetMaxAgeHTTPHeader(responseHeaders);
             if (maxAge >= 0) {
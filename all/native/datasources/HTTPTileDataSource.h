@@ -17,6 +17,8 @@
 #include <mutex>
 
 namespace carto {
+    class NetworkStatistics;
+    class NetworkStatisticsCollector;
 
     /**
      * A tile data source that loads tiles using a HTTP connection.
@@ -95,16 +97,31 @@ namespace carto {
          */
         void setHTTPHeaders(const std::map<std::string, std::string>& headers);
     
+        /**
+         * Returns the aggregated statistics of the network requests made by this data source.
+         * @return The network request statistics.
+         */
+        std::shared_ptr<NetworkStatistics> getNetworkStatistics() const;
+        /**
+         * Clears the collected network request statistics.
+         */
+        void resetNetworkStatistics();
+
         virtual std::shared_ptr<TileData> loadTile(const MapTile& mapTile);
+
+        virtual std::shared_ptr<TileData> reloadTile(const MapTile& mapTile, const std::shared_ptr<TileData>& cachedTileData);
     
     protected:
         virtual std::string buildTileURL(const std::string& baseURL, const MapTile& tile) const;
+
+        std::shared_ptr<TileData> loadHTTPTile(const MapTile& mapTile, const std::shared_ptr<TileData>& cachedTileData);
     
         std::string _baseURL;
         std::vector<std::string> _subdomains;
         bool _tmsScheme;
         bool _maxAgeHeaderCheck;
         std::map<std::string, std::string> _headers;
+        std::shared_ptr<NetworkStatisticsCollector> _networkStatisticsCollector;
         HTTPClient _httpClient;
         mutable std::default_random_engine _randomGenerator;
         mutable std::mutex _mutex;
@@ -10,6 +10,7 @@
 #include "geometry/GeometrySimplifier.h"
 #include "geometry/utils/KDTreeSpatialIndex.h"
 #include "geometry/utils/NullSpatialIndex.h"
+#include "geometry/utils/RTreeSpatialIndex.h"
 #include "projections/Projection.h"
 #include "projections/PlanarProjectionSurface.h"
 #include "styles/PointStyle.h"
@@ -34,7 +35,9 @@
 #include "utils/Log.h"
 
 #include <algorithm>
+#include <cmath>
 #include <iterator>
+#include <thread>
 #include <unordered_set>
 
 namespace carto {
@@ -44,7 +47,11 @@ namespace carto {
         _geometrySimplifier(),
         _spatialIndex(std::make_shared<NullSpatialIndex<std::shared_ptr<VectorElement> > >()),
         _spatialIndexType(LocalSpatialIndexType::LOCAL_SPATIAL_INDEX_TYPE_NULL),
+        _projectionSurface(),
+        _simplifiedElementCache(),
         _elementId(0),
+        _updateDepth(0),
+        _changedElements(),
         _mutex()
     {
     }
@@ -54,7 +61,11 @@ namespace carto {
         _geometrySimplifier(),
         _spatialIndex(std::make_shared<NullSpatialIndex<std::shared_ptr<VectorElement> > >()),
         _spatialIndexType(spatialIndexType),
+        _projectionSurface(),
+        _simplifiedElementCache(),
         _elementId(0),
+        _updateDepth(0),
+        _changedElements(),
         _mutex()
     {
     }
@@ -68,6 +79,8 @@ namespace carto {
             std::lock_guard<std::mutex> lock(_mutex);
             removedElements = _spatialIndex->getAll();
             _spatialIndex->clear();
+            _simplifiedElementCache.clear();
+            _changedElements.clear();
         }
         if (!removedElements.empty()) {
             notifyElementsRemoved(removedElements);
@@ -97,11 +110,8 @@ namespace carto {
             std::vector<std::shared_ptr<VectorElement> > oldElements = _spatialIndex->getAll();
             std::unordered_set<std::shared_ptr<VectorElement> > oldElementSet(oldElements.begin(), oldElements.end());
             
-            // Rebuild spatial index, create list of added and removed elements
-            _spatialIndex->clear();
-            _spatialIndex->reserve(elements.size());
+            // Create list of added and removed elements
             for (const std::shared_ptr<VectorElement>& element : elements) {
-                cglib::bbox3<double> bounds = calculateElementBounds(element);
                 auto it = oldElementSet.find(element);
                 if (it != oldElementSet.end()) {
                     oldElementSet.erase(it);
@@ -110,9 +120,17 @@ namespace carto {
                     elementsAdded.push_back(element);
                     _elementId++;
                 }
-                _spatialIndex->insert(bounds, element);
             }
             std::copy(oldElementSet.begin(), oldElementSet.end(), std::back_inserter(elementsRemoved));
+            for (const std::shared_ptr<VectorElement>& element : elementsRemoved) {
+                _simplifiedElementCache.erase(element);
+            }
+
+            // Rebuild spatial index in a single pass
+            std::vector<cglib::bbox3<double> > elementBounds = calculateElementBounds(elements);
+            _spatialIndex->clear();
+            _spatialIndex->reserve(elements.size());
+            _spatialIndex->insertAll(elementBounds, elements);
         }
         if (!elementsAdded.empty()) {
             notifyElementsAdded(elementsAdded);
@@ -152,13 +170,13 @@ namespace carto {
 
         {
             std::lock_guard<std::mutex> lock(_mutex);
-            _spatialIndex->reserve(_spatialIndex->size() + elements.size());
             for (const std::shared_ptr<VectorElement>& element : elements) {
                 element->setId(_elementId);
-                cglib::bbox3<double> bounds = calculateElementBounds(element);
-                _spatialIndex->insert(bounds, element);
                 _elementId++;
             }
+            std::vector<cglib::bbox3<double> > elementBounds = calculateElementBounds(elements);
+            _spatialIndex->reserve(_spatialIndex->size() + elements.size());
+            _spatialIndex->insertAll(elementBounds, elements);
         }
         if (!elements.empty()) {
             notifyElementsAdded(elements);
@@ -178,8 +196,13 @@ namespace carto {
         bool removed = false;
         {
             std::lock_guard<std::mutex> lock(_mutex);
-            cglib::bbox3<double> bounds = calculateElementBounds(element);
-            removed = _spatialIndex->remove(bounds, element);
+            if (_changedElements.erase(element) > 0) {
+                removed = _spatialIndex->remove(element); // the indexed bounds are outdated
+            } else {
+                cglib::bbox3<double> bounds = calculateElementBounds(element);
+                removed = _spatialIndex->remove(bounds, element);
+            }
+            _simplifiedElementCache.erase(element);
         }
         if (removed) {
             notifyElementRemoved(element);
@@ -203,10 +226,17 @@ namespace carto {
         {
             std::lock_guard<std::mutex> lock(_mutex);
             for (const std::shared_ptr<VectorElement>& element : elements) {
-                cglib::bbox3<double> bounds = calculateElementBounds(element);
-                if (_spatialIndex->remove(bounds, element)) {
+                bool removed = false;
+                if (_changedElements.erase(element) > 0) {
+                    removed = _spatialIndex->remove(element); // the indexed bounds are outdated
+                } else {
+                    cglib::bbox3<double> bounds = calculateElementBounds(element);
+                    removed = _spatialIndex->remove(bounds, element);
+                }
+                if (removed) {
                     removedElements.push_back(element);
                 }
+                _simplifiedElementCache.erase(element);
             }
         }
         if (!removedElements.empty()) {
@@ -215,6 +245,51 @@ namespace carto {
         return removedElements.size() == elements.size();
     }
     
+    void LocalVectorDataSource::beginUpdate() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _updateDepth++;
+    }
+
+    void LocalVectorDataSource::endUpdate() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_updateDepth <= 0) {
+                Log::Error("LocalVectorDataSource::endUpdate: No matching beginUpdate call");
+                return;
+            }
+            if (--_updateDepth > 0) {
+                return;
+            }
+            if (_changedElements.empty()) {
+                return;
+            }
+
+            std::vector<std::shared_ptr<VectorElement> > changedElements(_changedElements.begin(), _changedElements.end());
+            _changedElements.clear();
+            for (const std::shared_ptr<VectorElement>& element : changedElements) {
+                _simplifiedElementCache.erase(element);
+            }
+
+            if (!(std::dynamic_pointer_cast<NullSpatialIndex<std::shared_ptr<VectorElement>>>(_spatialIndex))) {
+                if (changedElements.size() * 4 >= _spatialIndex->size()) {
+                    // Large part of the elements changed, rebuild spatial index in a single pass
+                    std::vector<std::shared_ptr<VectorElement> > elements = _spatialIndex->getAll();
+                    std::vector<cglib::bbox3<double> > elementBounds = calculateElementBounds(elements);
+                    _spatialIndex->clear();
+                    _spatialIndex->reserve(elements.size());
+                    _spatialIndex->insertAll(elementBounds, elements);
+                } else {
+                    // Update the elements in place. Elements removed during the batch are not in the index and are skipped
+                    std::vector<cglib::bbox3<double> > elementBounds = calculateElementBounds(changedElements);
+                    for (std::size_t i = 0; i < changedElements.size(); i++) {
+                        _spatialIndex->update(elementBounds[i], changedElements[i]);
+                    }
+                }
+            }
+        }
+        notifyElementsChanged();
+    }
+    
     std::shared_ptr<GeometrySimplifier> LocalVectorDataSource::getGeometrySimplifier() const {
         std::lock_guard<std::mutex> lock(_mutex);
         return _geometrySimplifier;
@@ -224,6 +299,7 @@ namespace carto {
         {
             std::lock_guard<std::mutex> lock(_mutex);
             _geometrySimplifier = simplifier;
+            _simplifiedElementCache.clear();
         }
         notifyElementsChanged();
     }
@@ -283,31 +359,61 @@ namespace carto {
 
         // Check if we need to rebuild the underlying spatial index
         std::shared_ptr<ProjectionSurface> projectionSurface = cullState->getViewState().getProjectionSurface();
-        if (_spatialIndexType == LocalSpatialIndexType::LOCAL_SPATIAL_INDEX_TYPE_KDTREE) {
+        if (_spatialIndexType == LocalSpatialIndexType::LOCAL_SPATIAL_INDEX_TYPE_KDTREE || _spatialIndexType == LocalSpatialIndexType::LOCAL_SPATIAL_INDEX_TYPE_RTREE) {
             if (projectionSurface != _projectionSurface) {
                 std::vector<std::shared_ptr<VectorElement> > elements = _spatialIndex->getAll();
                 _projectionSurface = projectionSurface;
-                _spatialIndex = std::make_shared<KDTreeSpatialIndex<std::shared_ptr<VectorElement> > >();
-                for (const std::shared_ptr<VectorElement>& element : elements) {
-                    cglib::bbox3<double> bounds = calculateElementBounds(element);
-                    _spatialIndex->insert(bounds, element);
+                _simplifiedElementCache.clear();
+                if (_spatialIndexType == LocalSpatialIndexType::LOCAL_SPATIAL_INDEX_TYPE_RTREE) {
+                    _spatialIndex = std::make_shared<RTreeSpatialIndex<std::shared_ptr<VectorElement> > >();
+                } else {
+                    _spatialIndex = std::make_shared<KDTreeSpatialIndex<std::shared_ptr<VectorElement> > >();
                 }
+                _spatialIndex->reserve(elements.size());
+                _spatialIndex->insertAll(calculateElementBounds(elements), elements);
             }
         } else {
+            if (projectionSurface != _projectionSurface) {
+                _simplifiedElementCache.clear();
+            }
             _projectionSurface = projectionSurface;
         }
 
         // Query the spatial index
         std::vector<std::shared_ptr<VectorElement> > elements = _spatialIndex->query(cullState->getViewState().getFrustum());
         
-        // If geometry simplifier is specified, create new vector elements with simplified geometry
+        // If geometry simplifier is specified, create new vector elements with simplified geometry.
+        // The scale is quantized into levels and simplified elements are cached per level, so that each level is simplified only once
         if (_geometrySimplifier) {
             float simplifierScale = cullState->getViewState().estimateWorldPixelMeasure();
+            bool useCache = simplifierScale > 0 && std::isfinite(simplifierScale);
+            int level = 0;
+            if (useCache) {
+                level = static_cast<int>(std::floor(std::log2(simplifierScale) * SIMPLIFIER_LEVELS_PER_ZOOM));
+                simplifierScale = std::pow(2.0f, static_cast<float>(level) / SIMPLIFIER_LEVELS_PER_ZOOM);
+            }
 
             std::vector<std::shared_ptr<VectorElement> > simplifiedElements;
             simplifiedElements.reserve(elements.size());
             for (const std::shared_ptr<VectorElement>& element : elements) {
-                std::shared_ptr<VectorElement> simplifiedElement = simplifyElement(element, simplifierScale);
+                std::shared_ptr<VectorElement> simplifiedElement;
+                bool cached = false;
+                if (useCache) {
+                    auto it = _simplifiedElementCache.find(element);
+                    if (it != _simplifiedElementCache.end()) {
+                        auto levelIt = it->second.find(level);
+                        if (levelIt != it->second.end()) {
+                            simplifiedElement = levelIt->second;
+                            cached = true;
+                        }
+                    }
+                }
+                if (!cached) {
+                    simplifiedElement = simplifyElement(element, simplifierScale);
+                    if (useCache && simplifiedElement != element) {
+                        _simplifiedElementCache[element][level] = simplifiedElement;
+                    }
+                }
                 if (simplifiedElement) {
                     simplifiedElements.emplace_back(std::move(simplifiedElement));
                 }
@@ -321,10 +427,14 @@ namespace carto {
     void LocalVectorDataSource::notifyElementChanged(const std::shared_ptr<VectorElement>& element) {
         {
             std::lock_guard<std::mutex> lock(_mutex);
+            if (_updateDepth > 0) {
+                _changedElements.insert(element);
+                return;
+            }
+            _simplifiedElementCache.erase(element);
             if (!(std::dynamic_pointer_cast<NullSpatialIndex<std::shared_ptr<VectorElement>>>(_spatialIndex))) {
-                _spatialIndex->remove(element);
                 cglib::bbox3<double> bounds = calculateElementBounds(element);
-                _spatialIndex->insert(bounds, element);
+                _spatialIndex->update(bounds, element);
             }
         }
         VectorDataSource::notifyElementChanged(element);
@@ -449,4 +559,34 @@ namespace carto {
         return bounds;
     }
 
+    std::vector<cglib::bbox3<double> > LocalVectorDataSource::calculateElementBounds(const std::vector<std::shared_ptr<VectorElement> >& elements) const {
+        std::vector<cglib::bbox3<double> > elementBounds(elements.size());
+        auto calculateRange = [this, &elements, &elementBounds](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                elementBounds[i] = calculateElementBounds(elements[i]);
+            }
+        };
+
+        // For large element counts, split the work between all available cores
+        std::size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+        if (elements.size() < PARALLEL_BOUNDS_MIN_COUNT || threadCount < 2) {
+            calculateRange(0, elements.size());
+            return elementBounds;
+        }
+
+        std::size_t rangeSize = (elements.size() + threadCount - 1) / threadCount;
+        std::vector<std::thread> threads;
+        for (std::size_t begin = rangeSize; begin < elements.size(); begin += rangeSize) {
+            threads.emplace_back(calculateRange, begin, std::min(begin + rangeSize, elements.size()));
+        }
+        calculateRange(0, std::min(rangeSize, elements.size()));
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        return elementBounds;
+    }
+
+    const std::size_t LocalVectorDataSource::PARALLEL_BOUNDS_MIN_COUNT = 8192;
+    const int LocalVectorDataSource::SIMPLIFIER_LEVELS_PER_ZOOM = 2;
+
 }
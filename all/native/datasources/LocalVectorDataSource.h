@@ -10,7 +10,11 @@
 #include "datasources/VectorDataSource.h"
 #include "geometry/utils/SpatialIndex.h"
 
+#include <map>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace carto {
 
@@ -27,7 +31,12 @@ namespace carto {
             /**
              * K-d tree index, element culling is exact and fast.
              */
-            LOCAL_SPATIAL_INDEX_TYPE_KDTREE
+            LOCAL_SPATIAL_INDEX_TYPE_KDTREE,
+
+            /**
+             * Packed R-tree index, element culling is exact. Faster and more compact than k-d tree for large element counts.
+             */
+            LOCAL_SPATIAL_INDEX_TYPE_RTREE
         };
     }
 
@@ -105,6 +114,18 @@ namespace carto {
          */
         bool removeAll(const std::vector<std::shared_ptr<VectorElement> >& elements);
         
+        /**
+         * Starts a batch of element updates. The change events of the elements modified during the batch are
+         * delayed until the matching endUpdate call, where the spatial index is updated and a single change event
+         * is sent for all the modified elements. Batches can be nested, the event is sent when the outermost batch ends.
+         * Adding and removing elements is not affected by the batch.
+         */
+        void beginUpdate();
+        /**
+         * Ends a batch of element updates started with beginUpdate and sends the delayed change event.
+         */
+        void endUpdate();
+
         /**
          * Returns the active geometry simplifier of the data source.
          * @return The current geometry simplifier (can be null)
@@ -139,14 +160,22 @@ namespace carto {
         std::shared_ptr<VectorElement> createElement(const std::shared_ptr<Geometry>& geometry, const std::shared_ptr<Style>& style) const;
         std::shared_ptr<VectorElement> simplifyElement(const std::shared_ptr<VectorElement>& element, float scale) const;
         cglib::bbox3<double> calculateElementBounds(const std::shared_ptr<VectorElement>& element) const;
+        std::vector<cglib::bbox3<double> > calculateElementBounds(const std::vector<std::shared_ptr<VectorElement> >& elements) const;
+
+        static const std::size_t PARALLEL_BOUNDS_MIN_COUNT;
+        static const int SIMPLIFIER_LEVELS_PER_ZOOM;
 
         std::shared_ptr<GeometrySimplifier> _geometrySimplifier;
         std::shared_ptr<SpatialIndex<std::shared_ptr<VectorElement> > > _spatialIndex;
         LocalSpatialIndexType::LocalSpatialIndexType _spatialIndexType;
         std::shared_ptr<ProjectionSurface> _projectionSurface;
+        std::unordered_map<std::shared_ptr<VectorElement>, std::map<int, std::shared_ptr<VectorElement> > > _simplifiedElementCache; // simplified elements per element and simplification level
         
         unsigned int _elementId;
 
+        int _updateDepth;
+        std::unordered_set<std::shared_ptr<VectorElement> > _changedElements;
+
         mutable std::mutex _mutex;
     };
     
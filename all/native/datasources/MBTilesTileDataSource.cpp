@@ -8,6 +8,9 @@
 #include "utils/Const.h"
 #include "utils/Log.h"
 
+#include <algorithm>
+#include <unordered_map>
+
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
 
@@ -15,12 +18,22 @@
 
 namespace carto {
 
+    struct MBTilesTileDataSource::ReadConnection {
+        sqlite3pp::database db;
+        std::unique_ptr<sqlite3pp::query> tileQuery;
+    };
+
     MBTilesTileDataSource::MBTilesTileDataSource(const std::string& path) :
         TileDataSource(),
         _scheme(MBTilesScheme::MBTILES_SCHEME_TMS),
+        _path(path),
         _db(new sqlite3pp::database()),
         _cachedDataExtent(),
-        _mutex()
+        _tileIndex(),
+        _tileIndexBuilt(false),
+        _mutex(),
+        _readConnections(),
+        _readConnectionsMutex()
     {
         if (_db->connect_v2(path.c_str(), SQLITE_OPEN_READONLY) != SQLITE_OK) {
             throw FileException("Failed to open database file", path);
@@ -71,9 +84,14 @@ namespace carto {
     MBTilesTileDataSource::MBTilesTileDataSource(int minZoom, int maxZoom, const std::string& path) :
         TileDataSource(minZoom, maxZoom),
         _scheme(MBTilesScheme::MBTILES_SCHEME_TMS),
+        _path(path),
         _db(new sqlite3pp::database()),
         _cachedDataExtent(),
-        _mutex()
+        _tileIndex(),
+        _tileIndexBuilt(false),
+        _mutex(),
+        _readConnections(),
+        _readConnectionsMutex()
     {
         if (_db->connect_v2(path.c_str(), SQLITE_OPEN_READONLY) != SQLITE_OK) {
             throw FileException("Failed to open database file", path);
@@ -83,9 +101,14 @@ namespace carto {
     MBTilesTileDataSource::MBTilesTileDataSource(int minZoom, int maxZoom, const std::string& path, MBTilesScheme::MBTilesScheme scheme) :
         TileDataSource(minZoom, maxZoom),
         _scheme(scheme),
+        _path(path),
         _db(new sqlite3pp::database()),
         _cachedDataExtent(),
-        _mutex()
+        _tileIndex(),
+        _tileIndexBuilt(false),
+        _mutex(),
+        _readConnections(),
+        _readConnectionsMutex()
     {
         if (_db->connect_v2(path.c_str(), SQLITE_OPEN_READONLY) != SQLITE_OK) {
             throw FileException("Failed to open database file", path);
@@ -93,6 +116,7 @@ namespace carto {
     }
         
     MBTilesTileDataSource::~MBTilesTileDataSource() {
+        _readConnections.clear();
         if (_db) {
             try {
                 if (_db->disconnect() != SQLITE_OK) {
@@ -206,44 +230,230 @@ namespace carto {
     }
     
     std::shared_ptr<TileData> MBTilesTileDataSource::loadTile(const MapTile& mapTile) {
-        std::lock_guard<std::mutex> lock(_mutex);
         Log::Infof("MBTilesTileDataSource::loadTile: Loading %s", mapTile.toString().c_str());
-        if (!_db) {
+
+        // Resolve missing tiles without querying the database, this is important for sparse databases where parent redirection is common
+        if (!tileExists(mapTile)) {
+            return createMissingTileData(mapTile);
+        }
+
+        // Use a pooled connection, so that concurrent tile loads do not serialize on a single connection
+        std::unique_ptr<ReadConnection> connection = acquireReadConnection();
+        if (!connection) {
             Log::Errorf("MBTilesTileDataSource::loadTile: Failed to load %s: Couldn't connect to the database", mapTile.toString().c_str());
             return std::shared_ptr<TileData>();
         }
         
+        std::shared_ptr<BinaryData> data;
         try {
-            // Make the query and check for database error
-            sqlite3pp::query query(*_db, "SELECT tile_data FROM tiles WHERE zoom_level=:zoom AND tile_column=:x AND tile_row=:y");
+            // Make the query using the cached statement and check for database error
+            sqlite3pp::query& query = *connection->tileQuery;
             query.bind(":zoom", mapTile.getZoom());
             query.bind(":x", mapTile.getX());
             query.bind(":y", _scheme == MBTilesScheme::MBTILES_SCHEME_XYZ ? mapTile.getY() : (1 << (mapTile.getZoom())) - 1 - mapTile.getY());
             
             auto it = query.begin();
-            if (it == query.end()) {
-                std::shared_ptr<TileData> tileData = std::make_shared<TileData>(std::shared_ptr<BinaryData>());
-                if (mapTile.getZoom() > getMinZoom()) {
-                    Log::Infof("MBTilesTileDataSource::loadTile: Tile data doesn't exist in the database, redirecting to parent");
-                    tileData->setReplaceWithParent(true);
-                } else {
-                    Log::Infof("MBTilesTileDataSource::loadTile: Tile data doesn't exist in the database");
-                    return std::shared_ptr<TileData>();
-                }
-                return tileData;
+            if (it != query.end()) {
+                std::size_t dataSize = (*it).column_bytes(0);
+                const unsigned char* dataPtr = static_cast<const unsigned char*>((*it).get<const void*>(0));
+                data = std::make_shared<BinaryData>(dataPtr, dataSize);
             }
-            
-            std::size_t dataSize = (*it).column_bytes(0);
-            const unsigned char* dataPtr = static_cast<const unsigned char*>((*it).get<const void*>(0));
-            auto data = std::make_shared<BinaryData>(dataPtr, dataSize);
-            query.finish();
-    
-            return std::make_shared<TileData>(data);
+            query.reset();
         }
         catch (const std::exception& ex) {
             Log::Errorf("MBTilesTileDataSource::loadTile: Failed to query tile data from the database: %s", ex.what());
             return std::shared_ptr<TileData>();
         }
+        releaseReadConnection(std::move(connection));
+
+        if (!data) {
+            return createMissingTileData(mapTile);
+        }
+        return std::make_shared<TileData>(data);
+    }
+
+    bool MBTilesTileDataSource::isBatchLoadingSupported() const {
+        return true;
+    }
+
+    std::vector<std::shared_ptr<TileData> > MBTilesTileDataSource::loadTiles(const std::vector<MapTile>& mapTiles) {
+        Log::Infof("MBTilesTileDataSource::loadTiles: Loading %d tiles", static_cast<int>(mapTiles.size()));
+
+        // Group the tiles by zoom level and calculate the tile ranges in database coordinates
+        struct TileRange {
+            int minX, maxX, minY, maxY;
+        };
+        std::map<int, TileRange> zoomTileRanges;
+        std::unordered_map<MapTile, std::shared_ptr<BinaryData> > tileDataMap;
+        for (const MapTile& mapTile : mapTiles) {
+            tileDataMap[MapTile(mapTile.getX(), mapTile.getY(), mapTile.getZoom(), 0)] = std::shared_ptr<BinaryData>();
+            if (!tileExists(mapTile)) {
+                continue;
+            }
+
+            int y = (_scheme == MBTilesScheme::MBTILES_SCHEME_XYZ ? mapTile.getY() : (1 << (mapTile.getZoom())) - 1 - mapTile.getY());
+            auto it = zoomTileRanges.find(mapTile.getZoom());
+            if (it == zoomTileRanges.end()) {
+                zoomTileRanges[mapTile.getZoom()] = TileRange { mapTile.getX(), mapTile.getX(), y, y };
+            } else {
+                TileRange& range = it->second;
+                range.minX = std::min(range.minX, mapTile.getX());
+                range.maxX = std::max(range.maxX, mapTile.getX());
+                range.minY = std::min(range.minY, y);
+                range.maxY = std::max(range.maxY, y);
+            }
+        }
+
+        std::unique_ptr<ReadConnection> connection = zoomTileRanges.empty() ? std::unique_ptr<ReadConnection>() : acquireReadConnection();
+        if (!connection && !zoomTileRanges.empty()) {
+            Log::Error("MBTilesTileDataSource::loadTiles: Failed to load tiles: Couldn't connect to the database");
+            return std::vector<std::shared_ptr<TileData> >(mapTiles.size());
+        }
+
+        // Load all the tiles of a zoom level using a single range query. Rows that were not requested are skipped without reading the data.
+        try {
+            for (auto it = zoomTileRanges.begin(); it != zoomTileRanges.end(); it++) {
+                int zoom = it->first;
+                const TileRange& range = it->second;
+                sqlite3pp::query query(connection->db, "SELECT tile_column, tile_row, tile_data FROM tiles WHERE zoom_level=:zoom AND tile_column BETWEEN :minX AND :maxX AND tile_row BETWEEN :minY AND :maxY");
+                query.bind(":zoom", zoom);
+                query.bind(":minX", range.minX);
+                query.bind(":maxX", range.maxX);
+                query.bind(":minY", range.minY);
+                query.bind(":maxY", range.maxY);
+
+                for (auto qit = query.begin(); qit != query.end(); qit++) {
+                    int x = (*qit).get<int>(0);
+                    int y = (*qit).get<int>(1);
+                    MapTile mapTile(x, _scheme == MBTilesScheme::MBTILES_SCHEME_XYZ ? y : (1 << zoom) - 1 - y, zoom, 0);
+                    auto dataIt = tileDataMap.find(mapTile);
+                    if (dataIt == tileDataMap.end()) {
+                        continue;
+                    }
+                    std::size_t dataSize = (*qit).column_bytes(2);
+                    const unsigned char* dataPtr = static_cast<const unsigned char*>((*qit).get<const void*>(2));
+                    dataIt->second = std::make_shared<BinaryData>(dataPtr, dataSize);
+                }
+                query.finish();
+            }
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("MBTilesTileDataSource::loadTiles: Failed to query tile data from the database: %s", ex.what());
+            return std::vector<std::shared_ptr<TileData> >(mapTiles.size());
+        }
+        if (connection) {
+            releaseReadConnection(std::move(connection));
+        }
+
+        std::vector<std::shared_ptr<TileData> > tileDatas;
+        tileDatas.reserve(mapTiles.size());
+        for (const MapTile& mapTile : mapTiles) {
+            auto it = tileDataMap.find(MapTile(mapTile.getX(), mapTile.getY(), mapTile.getZoom(), 0));
+            if (it->second) {
+                tileDatas.push_back(std::make_shared<TileData>(it->second));
+            } else {
+                tileDatas.push_back(createMissingTileData(mapTile));
+            }
+        }
+        return tileDatas;
+    }
+
+    std::unique_ptr<MBTilesTileDataSource::ReadConnection> MBTilesTileDataSource::acquireReadConnection() {
+        {
+            std::lock_guard<std::mutex> lock(_readConnectionsMutex);
+            if (!_readConnections.empty()) {
+                std::unique_ptr<ReadConnection> connection = std::move(_readConnections.back());
+                _readConnections.pop_back();
+                return connection;
+            }
+        }
+
+        // No idle connections, open a new one. Connections are never used by multiple threads at the same time, so SQLite mutexes are not needed.
+        std::unique_ptr<ReadConnection> connection(new ReadConnection());
+        try {
+            if (connection->db.connect_v2(_path.c_str(), SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX) != SQLITE_OK) {
+                Log::Errorf("MBTilesTileDataSource::acquireReadConnection: Failed to open database %s", _path.c_str());
+                return std::unique_ptr<ReadConnection>();
+            }
+            connection->tileQuery.reset(new sqlite3pp::query(connection->db, "SELECT tile_data FROM tiles WHERE zoom_level=:zoom AND tile_column=:x AND tile_row=:y"));
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("MBTilesTileDataSource::acquireReadConnection: Failed to prepare tile query: %s", ex.what());
+            return std::unique_ptr<ReadConnection>();
+        }
+        return connection;
+    }
+
+    void MBTilesTileDataSource::releaseReadConnection(std::unique_ptr<ReadConnection> connection) {
+        std::lock_guard<std::mutex> lock(_readConnectionsMutex);
+        if (_readConnections.size() < MAX_IDLE_READ_CONNECTIONS) {
+            _readConnections.push_back(std::move(connection));
+        }
+    }
+
+    std::shared_ptr<TileData> MBTilesTileDataSource::createMissingTileData(const MapTile& mapTile) const {
+        if (mapTile.getZoom() > getMinZoom()) {
+            Log::Infof("MBTilesTileDataSource: Tile data for %s doesn't exist in the database, redirecting to parent", mapTile.toString().c_str());
+            std::shared_ptr<TileData> tileData = std::make_shared<TileData>(std::shared_ptr<BinaryData>());
+            tileData->setReplaceWithParent(true);
+            return tileData;
+        }
+        Log::Infof("MBTilesTileDataSource: Tile data for %s doesn't exist in the database", mapTile.toString().c_str());
+        return std::shared_ptr<TileData>();
+    }
+
+    bool MBTilesTileDataSource::tileExists(const MapTile& mapTile) const {
+        std::shared_ptr<std::vector<long long> > tileIndex;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_tileIndexBuilt) {
+                _tileIndex = buildTileIndex();
+                _tileIndexBuilt = true;
+            }
+            tileIndex = _tileIndex;
+        }
+
+        // If the index is not available, assume that the tile exists and let the query decide
+        if (!tileIndex) {
+            return true;
+        }
+        long long tileId = MapTile(mapTile.getX(), mapTile.getY(), mapTile.getZoom(), 0).getTileId();
+        return std::binary_search(tileIndex->begin(), tileIndex->end(), tileId);
+    }
+
+    std::shared_ptr<std::vector<long long> > MBTilesTileDataSource::buildTileIndex() const {
+        if (!_db) {
+            return std::shared_ptr<std::vector<long long> >();
+        }
+
+        // Scan the tile coordinates only, this uses the tile index of the database and does not read the tile data.
+        // Large databases are not indexed, as the binary search index would take too much memory.
+        auto tileIndex = std::make_shared<std::vector<long long> >();
+        try {
+            sqlite3pp::query query(*_db, "SELECT zoom_level, tile_column, tile_row FROM tiles LIMIT :limit");
+            query.bind(":limit", static_cast<int>(MAX_INDEXED_TILES + 1));
+            for (auto it = query.begin(); it != query.end(); it++) {
+                if (tileIndex->size() >= MAX_INDEXED_TILES) {
+                    Log::Info("MBTilesTileDataSource::buildTileIndex: Database contains too many tiles, not indexing");
+                    return std::shared_ptr<std::vector<long long> >();
+                }
+                int zoom = (*it).get<int>(0);
+                int x = (*it).get<int>(1);
+                int y = (*it).get<int>(2);
+                if (zoom < 0 || zoom > Const::MAX_SUPPORTED_ZOOM_LEVEL) {
+                    continue;
+                }
+                tileIndex->push_back(MapTile(x, _scheme == MBTilesScheme::MBTILES_SCHEME_XYZ ? y : (1 << zoom) - 1 - y, zoom, 0).getTileId());
+            }
+            query.finish();
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("MBTilesTileDataSource::buildTileIndex: Failed to query tile coordinates from the database: %s", ex.what());
+            return std::shared_ptr<std::vector<long long> >();
+        }
+        std::sort(tileIndex->begin(), tileIndex->end());
+        tileIndex->shrink_to_fit();
+        return tileIndex;
     }
     
 }
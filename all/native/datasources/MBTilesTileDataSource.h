@@ -12,9 +12,13 @@
 #include "datasources/TileDataSource.h"
 
 #include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace sqlite3pp {
     class database;
+    class query;
 }
     
 namespace carto {
@@ -83,12 +87,34 @@ namespace carto {
         virtual MapBounds getDataExtent() const;
 
         virtual std::shared_ptr<TileData> loadTile(const MapTile& mapTile);
+
+        virtual bool isBatchLoadingSupported() const;
+        virtual std::vector<std::shared_ptr<TileData> > loadTiles(const std::vector<MapTile>& mapTiles);
     
     private:
+        struct ReadConnection;
+
+        std::unique_ptr<ReadConnection> acquireReadConnection();
+        void releaseReadConnection(std::unique_ptr<ReadConnection> connection);
+
+        std::shared_ptr<TileData> createMissingTileData(const MapTile& mapTile) const;
+
+        bool tileExists(const MapTile& mapTile) const;
+        std::shared_ptr<std::vector<long long> > buildTileIndex() const;
+
+        static const std::size_t MAX_IDLE_READ_CONNECTIONS = 8;
+        static const std::size_t MAX_INDEXED_TILES = 256 * 1024;
+
         MBTilesScheme::MBTilesScheme _scheme;
+        std::string _path;
         std::unique_ptr<sqlite3pp::database> _db;
         mutable std::unique_ptr<MapBounds> _cachedDataExtent;
+        mutable std::shared_ptr<std::vector<long long> > _tileIndex; // sorted ids of existing tiles, null if the database is too large to index
+        mutable bool _tileIndexBuilt;
         mutable std::mutex _mutex;
+
+        std::vector<std::unique_ptr<ReadConnection> > _readConnections;
+        std::mutex _readConnectionsMutex;
     };
     
 }
@@ -1,6 +1,8 @@
 #include "MapTilerOnlineTileDataSource.h"
 #include "core/BinaryData.h"
 #include "core/MapTile.h"
+#include "datasources/components/NetworkStatistics.h"
+#include "network/NetworkStatisticsCollector.h"
 #include "utils/Log.h"
 #include "utils/GeneralUtils.h"
 #include "utils/NetworkUtils.h"
@@ -13,6 +15,7 @@ namespace carto {
     MapTilerOnlineTileDataSource::MapTilerOnlineTileDataSource(const std::string& key) :
         TileDataSource(),
         _key(key),
+        _networkStatisticsCollector(std::make_shared<NetworkStatisticsCollector>()),
         _httpClient(Log::IsShowDebug()),
         _serviceURL(),
         _tmsScheme(false),
@@ -21,6 +24,11 @@ namespace carto {
         _mutex()
     {
         _maxZoom = DEFAULT_MAX_ZOOM;
+        _httpClient.setAdaptiveConcurrency(true);
+        std::shared_ptr<NetworkStatisticsCollector> networkStatisticsCollector = _networkStatisticsCollector;
+        _httpClient.setStatisticsHandler([networkStatisticsCollector](const HTTPClient::RequestStatistics& statistics) {
+            networkStatisticsCollector->addRequest(statistics);
+        });
     }
     
     MapTilerOnlineTileDataSource::~MapTilerOnlineTileDataSource() {
@@ -36,6 +44,14 @@ namespace carto {
         _serviceURL = serviceURL;
     }
 
+    std::shared_ptr<NetworkStatistics> MapTilerOnlineTileDataSource::getNetworkStatistics() const {
+        return _networkStatisticsCollector->getStatistics();
+    }
+
+    void MapTilerOnlineTileDataSource::resetNetworkStatistics() {
+        _networkStatisticsCollector->reset();
+    }
+
     std::shared_ptr<TileData> MapTilerOnlineTileDataSource::loadTile(const MapTile& mapTile) {
         std::unique_lock<std::recursive_mutex> lock(_mutex);
 
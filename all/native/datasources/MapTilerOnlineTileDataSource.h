@@ -14,6 +14,8 @@
 #include <vector>
 
 namespace carto {
+    class NetworkStatistics;
+    class NetworkStatisticsCollector;
     
     /**
      * An online tile data source that connects to MapTiler Cloud tile server.
@@ -44,6 +46,16 @@ namespace carto {
          */
         void setCustomServiceURL(const std::string& serviceURL);
 
+        /**
+         * Returns the aggregated statistics of the network requests made by this data source.
+         * @return The network request statistics.
+         */
+        std::shared_ptr<NetworkStatistics> getNetworkStatistics() const;
+        /**
+         * Clears the collected network request statistics.
+         */
+        void resetNetworkStatistics();
+
         virtual std::shared_ptr<TileData> loadTile(const MapTile& mapTile);
         
     protected:
@@ -57,6 +69,7 @@ namespace carto {
         static const std::string MAPTILER_SERVICE_URL;
 
         const std::string _key;
+        std::shared_ptr<NetworkStatisticsCollector> _networkStatisticsCollector;
         HTTPClient _httpClient;
         std::string _serviceURL;
 
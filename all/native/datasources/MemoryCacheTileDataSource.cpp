@@ -1,6 +1,7 @@
 #include "MemoryCacheTileDataSource.h"
 #include "core/BinaryData.h"
 #include "core/MapTile.h"
+#include "utils/CompressionUtils.h"
 #include "utils/Log.h"
 
 #include <memory>
@@ -9,6 +10,7 @@ namespace carto {
     
     MemoryCacheTileDataSource::MemoryCacheTileDataSource(const std::shared_ptr<TileDataSource>& dataSource) :
         CacheTileDataSource(dataSource),
+        _compressionEnabled(false),
         _cache(DEFAULT_CAPACITY),
         _mutex()
     {
@@ -23,20 +25,33 @@ namespace carto {
         Log::Infof("MemoryCacheTileDataSource::loadTile: Loading %s", mapTile.toString().c_str());
         
         std::shared_ptr<TileData> tileData;
-        if (_cache.read(mapTile.getTileId(), tileData)) {
-            if (tileData->getMaxAge() != 0) {
-                return tileData;
+        std::shared_ptr<TileData> expiredTileData;
+        CacheEntry cacheEntry;
+        if (_cache.read(mapTile.getTileId(), cacheEntry)) {
+            if (cacheEntry.tileData->getMaxAge() != 0 || isStaleWhileRevalidate()) {
+                countCacheLookup(true);
+                lock.unlock();
+                tileData = readCacheEntry(cacheEntry);
+                return tileData->getMaxAge() != 0 ? tileData : revalidateTile(mapTile, tileData);
             }
             _cache.remove(mapTile.getTileId());
+            expiredTileData = cacheEntry.tileData;
         }
+        countCacheLookup(false);
         
         lock.unlock();
-        tileData = _dataSource->loadTile(mapTile);
-        lock.lock();
+        if (expiredTileData) {
+            expiredTileData = readCacheEntry(cacheEntry);
+            tileData = _dataSource->reloadTile(mapTile, expiredTileData);
+        } else {
+            tileData = _dataSource->loadTileCoalesced(mapTile);
+        }
 
         if (tileData) {
             if (tileData->getMaxAge() != 0 && tileData->getData() && !tileData->isReplaceWithParent()) {
-                _cache.put(mapTile.getTileId(), tileData, tileData->getData()->size() + 16);
+                CacheEntry newCacheEntry = createCacheEntry(tileData);
+                lock.lock();
+                _cache.put(mapTile.getTileId(), newCacheEntry, newCacheEntry.tileData->getData()->size() + 16);
             }
         } else {
             Log::Infof("MemoryCacheTileDataSource::loadTile: Failed to load %s.", mapTile.toString().c_str());
@@ -45,6 +60,17 @@ namespace carto {
         return tileData;
     }
     
+    void MemoryCacheTileDataSource::storeRevalidatedTile(const MapTile& mapTile, const std::shared_ptr<TileData>& tileData, bool changed) {
+        CacheEntry cacheEntry = createCacheEntry(tileData);
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        _cache.put(mapTile.getTileId(), cacheEntry, cacheEntry.tileData->getData()->size() + 16);
+    }
+
+    std::size_t MemoryCacheTileDataSource::getCacheSize() const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        return _cache.size();
+    }
+
     void MemoryCacheTileDataSource::clear() {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
         _cache.clear();
@@ -59,5 +85,58 @@ namespace carto {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
         _cache.resize(capacityInBytes);
     }
+
+    bool MemoryCacheTileDataSource::isCompressionEnabled() const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        return _compressionEnabled;
+    }
+
+    void MemoryCacheTileDataSource::setCompressionEnabled(bool enabled) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        if (enabled != _compressionEnabled) {
+            _compressionEnabled = enabled;
+            _cache.clear();
+        }
+    }
+
+    MemoryCacheTileDataSource::CacheEntry MemoryCacheTileDataSource::createCacheEntry(const std::shared_ptr<TileData>& tileData) const {
+        CacheEntry cacheEntry;
+        cacheEntry.tileData = tileData;
+        const BinaryData& data = *tileData->getData();
+        if (!isCompressionEnabled() || CompressionUtils::IsCompressedData(data.data(), data.size())) {
+            return cacheEntry;
+        }
+
+        std::vector<unsigned char> compressedData;
+        if (!CompressionUtils::DeflateData(data.data(), data.size(), compressedData) || compressedData.size() >= data.size()) {
+            return cacheEntry;
+        }
+
+        auto compressedTileData = std::make_shared<TileData>(std::make_shared<BinaryData>(std::move(compressedData)));
+        compressedTileData->setMaxAge(tileData->getMaxAge());
+        compressedTileData->setETag(tileData->getETag());
+        compressedTileData->setLastModified(tileData->getLastModified());
+        cacheEntry.tileData = compressedTileData;
+        cacheEntry.uncompressedSize = data.size();
+        return cacheEntry;
+    }
+
+    std::shared_ptr<TileData> MemoryCacheTileDataSource::readCacheEntry(const CacheEntry& cacheEntry) const {
+        if (cacheEntry.uncompressedSize == 0) {
+            return cacheEntry.tileData;
+        }
+
+        const BinaryData& compressedData = *cacheEntry.tileData->getData();
+        std::vector<unsigned char> data;
+        if (!CompressionUtils::InflateData(compressedData.data(), compressedData.size(), cacheEntry.uncompressedSize, data)) {
+            Log::Error("MemoryCacheTileDataSource::readCacheEntry: Failed to decompress tile data");
+        }
+
+        auto tileData = std::make_shared<TileData>(std::make_shared<BinaryData>(std::move(data)));
+        tileData->setMaxAge(cacheEntry.tileData->getMaxAge());
+        tileData->setETag(cacheEntry.tileData->getETag());
+        tileData->setLastModified(cacheEntry.tileData->getLastModified());
+        return tileData;
+    }
         
 }
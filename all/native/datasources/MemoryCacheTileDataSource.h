@@ -34,11 +34,39 @@ namespace carto {
         virtual std::size_t getCapacity() const;
         
         virtual void setCapacity(std::size_t capacityInBytes);
+
+        /**
+         * Returns the state of compressed caching mode.
+         * @return True when cached tiles are stored in compressed form, false otherwise.
+         */
+        bool isCompressionEnabled() const;
+        /**
+         * Enables or disables compressed caching mode.
+         * If enabled, tiles are stored deflate-compressed and decompressed on each cache hit. Tiles that are already
+         * in a compressed format (gzip, zlib, PNG, JPEG, WebP) are stored as they are. This allows more tiles to fit into the same capacity
+         * at the cost of extra CPU time. By default, the mode is off. Changing the mode clears the cache.
+         * @param enabled True when the mode should be enabled, false otherwise.
+         */
+        void setCompressionEnabled(bool enabled);
     
     protected:
+        virtual void storeRevalidatedTile(const MapTile& mapTile, const std::shared_ptr<TileData>& tileData, bool changed);
+        virtual std::size_t getCacheSize() const;
+
+        struct CacheEntry {
+            std::shared_ptr<TileData> tileData;
+            std::size_t uncompressedSize; // 0 if the data is stored as it is
+
+            CacheEntry() : tileData(), uncompressedSize(0) { }
+        };
+
+        CacheEntry createCacheEntry(const std::shared_ptr<TileData>& tileData) const;
+        std::shared_ptr<TileData> readCacheEntry(const CacheEntry& cacheEntry) const;
+
         static const int DEFAULT_CAPACITY = 6 * 1024 * 1024;
 
-        cache::timed_lru_cache<long long, std::shared_ptr<TileData> > _cache;
+        bool _compressionEnabled;
+        cache::timed_lru_cache<long long, CacheEntry> _cache;
         mutable std::recursive_mutex _mutex;
     };
     
@@ -13,7 +13,10 @@ namespace carto {
     MergedMBVTTileDataSource::MergedMBVTTileDataSource(const std::shared_ptr<TileDataSource>& dataSource1, const std::shared_ptr<TileDataSource>& dataSource2) :
         TileDataSource(),
         _dataSource1(dataSource1),
-        _dataSource2(dataSource2)
+        _dataSource2(dataSource2),
+        _dataSourceListener(),
+        _mergedTileCache(MERGED_TILE_CACHE_SIZE),
+        _mutex()
     {
         if (!dataSource1) {
             throw NullArgumentException("Null dataSource1");
@@ -48,6 +51,17 @@ namespace carto {
     }
     
     std::shared_ptr<TileData> MergedMBVTTileDataSource::loadTile(const MapTile& mapTile) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            std::shared_ptr<TileData> tileData;
+            if (_mergedTileCache.read(mapTile.getTileId(), tileData)) {
+                if (tileData->getMaxAge() != 0) {
+                    return tileData;
+                }
+                _mergedTileCache.remove(mapTile.getTileId());
+            }
+        }
+
         int zoom = mapTile.getZoom();
         std::shared_ptr<TileData> result1;
         std::shared_ptr<TileData> result2;
@@ -72,14 +86,10 @@ namespace carto {
             std::shared_ptr<std::vector<unsigned char>> data1 = result1->getData()->getDataPtr();
             std::shared_ptr<std::vector<unsigned char>> data2 = result2->getData()->getDataPtr();
 
+            // Decompress the first tile directly into the merged buffer, to avoid an extra copy
             std::vector<unsigned char> mergedData;
-            mergedData.reserve(data1->size() + data2->size());
-
-            std::vector<unsigned char> uncompressedData1;
-            if (zlib::inflate_gzip(data1->data(), data1->size(), uncompressedData1)) {
-                mergedData.insert(mergedData.end(), uncompressedData1.begin(), uncompressedData1.end());
-            } else {
-                mergedData.insert(mergedData.end(), data1->begin(), data1->end());
+            if (!zlib::inflate_gzip(data1->data(), data1->size(), mergedData)) {
+                mergedData.assign(data1->begin(), data1->end());
             }
             std::vector<unsigned char> uncompressedData2;
             if (zlib::inflate_gzip(data2->data(), data2->size(), uncompressedData2)) {
@@ -88,8 +98,19 @@ namespace carto {
                 mergedData.insert(mergedData.end(), data2->begin(), data2->end());
             }
 
-            auto mergedBinaryData = std::make_shared<BinaryData>(std::move(mergedData));
-            return std::make_shared<TileData>(mergedBinaryData);
+            // The merged tile expires when either of the source tiles expires
+            long long maxAge1 = result1->getMaxAge();
+            long long maxAge2 = result2->getMaxAge();
+            long long maxAge = (maxAge1 < 0 ? maxAge2 : (maxAge2 < 0 ? maxAge1 : std::min(maxAge1, maxAge2)));
+
+            std::size_t mergedSize = mergedData.size();
+            auto mergedTileData = std::make_shared<TileData>(std::make_shared<BinaryData>(std::move(mergedData)));
+            mergedTileData->setMaxAge(maxAge);
+            if (maxAge != 0) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _mergedTileCache.put(mapTile.getTileId(), mergedTileData, mergedSize + 16);
+            }
+            return mergedTileData;
         }
 
         // Return either result that is not null.
@@ -102,7 +123,21 @@ namespace carto {
     }
     
     void MergedMBVTTileDataSource::DataSourceListener::onTilesChanged(bool removeTiles) {
+        {
+            std::lock_guard<std::mutex> lock(_combinedDataSource._mutex);
+            _combinedDataSource._mergedTileCache.clear();
+        }
         _combinedDataSource.notifyTilesChanged(removeTiles);
     }
+
+    void MergedMBVTTileDataSource::DataSourceListener::onTilesChanged(const std::vector<MapTile>& tiles, bool removeTiles) {
+        {
+            std::lock_guard<std::mutex> lock(_combinedDataSource._mutex);
+            for (const MapTile& tile : tiles) {
+                _combinedDataSource._mergedTileCache.remove(tile.getTileId());
+            }
+        }
+        _combinedDataSource.notifyTilesChanged(tiles, removeTiles);
+    }
     
 }
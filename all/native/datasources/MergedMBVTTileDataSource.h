@@ -10,11 +10,17 @@
 #include "datasources/TileDataSource.h"
 #include "components/DirectorPtr.h"
 
+#include <mutex>
+
+#include <stdext/timed_lru_cache.h>
+
 namespace carto {
     
     /**
      * A tile data source that merges two MBVT/protobuf data sources into one.
      * It is assumed that the layer ids from the two sources are distinct.
+     * A small cache of the merged tiles is kept, so that reloading a tile does not
+     * require loading and merging the source tiles again.
      */
     class MergedMBVTTileDataSource : public TileDataSource {
     public:
@@ -39,6 +45,7 @@ namespace carto {
             explicit DataSourceListener(MergedMBVTTileDataSource& combinedDataSource);
             
             virtual void onTilesChanged(bool removeTiles);
+            virtual void onTilesChanged(const std::vector<MapTile>& tiles, bool removeTiles);
             
         private:
             MergedMBVTTileDataSource& _combinedDataSource;
@@ -48,7 +55,12 @@ namespace carto {
         const DirectorPtr<TileDataSource> _dataSource2;
         
     private:
+        static const std::size_t MERGED_TILE_CACHE_SIZE = 4 * 1024 * 1024;
+
         std::shared_ptr<DataSourceListener> _dataSourceListener;
+
+        cache::timed_lru_cache<long long, std::shared_ptr<TileData> > _mergedTileCache;
+        mutable std::mutex _mutex;
     };
     
 }
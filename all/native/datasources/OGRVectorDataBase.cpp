@@ -21,9 +21,13 @@ namespace {
 namespace carto {
     
     OGRVectorDataBase::OGRVectorDataBase(const std::string& fileName, bool writable) :
+        _fileName(fileName),
+        _writable(writable),
         _poDS(nullptr),
         _poLayers(),
-        _mutex()
+        _mutex(),
+        _idleReaders(),
+        _readersMutex()
     {
         OGRSFDriver* poDriver = nullptr;
         _poDS = OGRSFDriverRegistrar::Open(fileName.c_str(), writable, &poDriver);
@@ -38,6 +42,9 @@ namespace carto {
     }
     
     OGRVectorDataBase::~OGRVectorDataBase() {
+        for (OGRDataSource* poReaderDS : _idleReaders) {
+            poReaderDS->Release();
+        }
         if (_poDS) {
             _poDS->Release();
         }
@@ -134,6 +141,44 @@ namespace carto {
         return _poDS->TestCapability(capability.c_str()) != 0;
     }
 
+    std::shared_ptr<OGRDataSource> OGRVectorDataBase::acquireReader() const {
+        if (_writable) {
+            return std::shared_ptr<OGRDataSource>();
+        }
+
+        OGRDataSource* poReaderDS = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(_readersMutex);
+            if (!_idleReaders.empty()) {
+                poReaderDS = _idleReaders.back();
+                _idleReaders.pop_back();
+            }
+        }
+        if (!poReaderDS) {
+            // Open the file outside the lock, other threads may keep using the idle handles meanwhile
+            OGRSFDriver* poDriver = nullptr;
+            poReaderDS = OGRSFDriverRegistrar::Open(_fileName.c_str(), FALSE, &poDriver);
+            if (!poReaderDS) {
+                Log::Warnf("OGRVectorDataBase::acquireReader: Failed to open file %s", _fileName.c_str());
+                return std::shared_ptr<OGRDataSource>();
+            }
+        }
+        return std::shared_ptr<OGRDataSource>(poReaderDS, [this](OGRDataSource* poDS) {
+            releaseReader(poDS);
+        });
+    }
+
+    void OGRVectorDataBase::releaseReader(OGRDataSource* poDS) const {
+        {
+            std::lock_guard<std::mutex> lock(_readersMutex);
+            if (_idleReaders.size() < MAX_IDLE_READERS) {
+                _idleReaders.push_back(poDS);
+                return;
+            }
+        }
+        poDS->Release();
+    }
+
     void OGRVectorDataBase::SetConfigOption(const std::string& name, const std::string& value) {
         CPLSetConfigOption(name.c_str(), value.c_str());
     }
@@ -125,12 +125,31 @@ namespace carto {
         
     protected:
         friend class OGRVectorDataSource;
+
+        /**
+         * Returns a separate read-only handle of the database for exclusive use by the calling thread.
+         * The handle is returned to the pool once the returned pointer (and all its copies) are released,
+         * the database instance must outlive the handle.
+         * Writable databases do not use separate handles, as these would not see uncommitted changes.
+         * @return The database handle or null if separate handles can not be used.
+         */
+        std::shared_ptr<OGRDataSource> acquireReader() const;
         
     private:
+        void releaseReader(OGRDataSource* poDS) const;
+
+        static const std::size_t MAX_IDLE_READERS = 4;
+
+        const std::string _fileName;
+        const bool _writable;
+
         OGRDataSource* _poDS;
         std::vector<OGRLayer*> _poLayers;
         
         mutable std::mutex _mutex;
+
+        mutable std::vector<OGRDataSource*> _idleReaders;
+        mutable std::mutex _readersMutex;
     };
 }
 
@@ -25,6 +25,7 @@
 #include "styles/StyleSelector.h"
 #include "styles/StyleSelectorContext.h"
 #include "utils/Log.h"
+#include "utils/TileUtils.h"
 #include "styles/PointStyle.h"
 #include "styles/LineStyle.h"
 #include "styles/PolygonStyle.h"
@@ -35,6 +36,10 @@
 #include "styles/GeometryCollectionStyleBuilder.h"
 #include "projections/EPSG3857.h"
 
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+
 #include <ogrsf_frmts.h>
 #include <cpl_port.h>
 #include <cpl_config.h>
@@ -42,7 +47,7 @@
 namespace carto {
 
     struct OGRVectorDataSource::LayerSpatialReference {
-        LayerSpatialReference(OGRLayer* poLayer, const std::shared_ptr<Projection>& proj) : _poSpatialRef(nullptr), _poCoordinateTransform(nullptr), _poInverseCoordinateTransform(nullptr)
+        LayerSpatialReference(OGRLayer* poLayer, const std::shared_ptr<Projection>& proj) : _poSpatialRef(nullptr), _poCoordinateTransform(nullptr), _poInverseCoordinateTransform(nullptr), _mutex()
         {
             _poSpatialRef = new OGRSpatialReference();
             if (std::dynamic_pointer_cast<EPSG3857>(proj)) {
@@ -69,17 +74,39 @@ namespace carto {
      
         MapPos transform(double x, double y, double z) const {
             if (_poCoordinateTransform) {
+                std::lock_guard<std::mutex> lock(_mutex);
                 _poCoordinateTransform->Transform(1, &x, &y, &z);
             }
             return MapPos(x, y, z);
         }
 
+        std::vector<MapPos> transform(const OGRLineString* poLineString) const {
+            // Transform all the points of the line with a single call, instead of point by point
+            int count = poLineString->getNumPoints();
+            std::vector<double> xs(count), ys(count), zs(count);
+            for (int i = 0; i < count; i++) {
+                xs[i] = poLineString->getX(i);
+                ys[i] = poLineString->getY(i);
+                zs[i] = poLineString->getZ(i);
+            }
+            if (_poCoordinateTransform && count > 0) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _poCoordinateTransform->Transform(count, xs.data(), ys.data(), zs.data());
+            }
+            std::vector<MapPos> mapPoses(count);
+            for (int i = 0; i < count; i++) {
+                mapPoses[i] = MapPos(xs[i], ys[i], zs[i]);
+            }
+            return mapPoses;
+        }
+
         MapPos transform(const MapPos& mapPos) const {
             return transform(mapPos.getX(), mapPos.getY(), mapPos.getZ());
         }
 
         MapPos inverseTransform(double x, double y, double z) const {
             if (_poInverseCoordinateTransform) {
+                std::lock_guard<std::mutex> lock(_mutex);
                 _poInverseCoordinateTransform->Transform(1, &x, &y, &z);
             }
             return MapPos(x, y, z);
@@ -93,6 +120,7 @@ namespace carto {
         OGRSpatialReference* _poSpatialRef;
         OGRCoordinateTransformation* _poCoordinateTransform;
         OGRCoordinateTransformation* _poInverseCoordinateTransform;
+        mutable std::mutex _mutex; // coordinate transformations are not thread-safe, features may be read concurrently
     };
 
     OGRVectorDataSource::OGRVectorDataSource(const std::shared_ptr<Projection>& projection, const std::shared_ptr<StyleSelector>& styleSelector, const std::string& fileName) :
@@ -103,8 +131,11 @@ namespace carto {
         _localElementId(-1),
         _localElements(),
         _dataBase(std::make_shared<OGRVectorDataBase>(fileName, false)),
+        _layerIndex(0),
         _poLayer(),
-        _poLayerSpatialRef()
+        _poLayerSpatialRef(),
+        _elementCache(DEFAULT_ELEMENT_CACHE_SIZE),
+        _elementCacheGeneration(0)
     {
         if (!styleSelector) {
             throw NullArgumentException("Null styleSelector");
@@ -127,8 +158,11 @@ namespace carto {
         _localElementId(-1),
         _localElements(),
         _dataBase(dataBase),
+        _layerIndex(layerIndex),
         _poLayer(),
-        _poLayerSpatialRef()
+        _poLayerSpatialRef(),
+        _elementCache(DEFAULT_ELEMENT_CACHE_SIZE),
+        _elementCacheGeneration(0)
     {
         if (!styleSelector) {
             throw NullArgumentException("Null styleSelector");
@@ -158,6 +192,7 @@ namespace carto {
         {
             std::lock_guard<std::mutex> lock(_dataBase->_mutex);
             _codePage = codePage;
+            clearElementCache();
         }
         notifyElementsChanged();
     }
@@ -171,6 +206,7 @@ namespace carto {
         {
             std::lock_guard<std::mutex> lock(_dataBase->_mutex);
             _geometrySimplifier = simplifier;
+            clearElementCache();
         }
         notifyElementsChanged();
     }
@@ -340,6 +376,7 @@ namespace carto {
             if (err != OGRERR_NONE) {
                 Log::Errorf("OGRVectorDataSource::commit: SyncToDisk failed, error code: %d", (int)err);
             }
+            clearElementCache();
         }
         notifyElementsChanged();
         return committedElements;
@@ -484,77 +521,179 @@ namespace carto {
     }
     
     std::shared_ptr<VectorData> OGRVectorDataSource::loadElements(const std::shared_ptr<CullState>& cullState) {
-        std::lock_guard<std::mutex> lock(_dataBase->_mutex);
-        
-        if (!_poLayer) {
-            return std::shared_ptr<VectorData>();
+        const ViewState& viewState = cullState->getViewState();
+        float simplifierScale = viewState.estimateWorldPixelMeasure();
+
+        // The elements are cached per tile and integer zoom level, as the styles and simplification depend on the zoom level.
+        // Use a coarser tile grid if the view covers too many tiles of the current zoom level.
+        int zoomBand = std::max(0, static_cast<int>(std::floor(viewState.getZoom())));
+        MapBounds envelopeBounds = cullState->getProjectionBounds(_projection);
+        std::vector<MapTile> mapTiles;
+        for (int zoom = zoomBand; zoom >= 0; zoom--) {
+            int maxTile = (1 << std::min(zoom, 30)) - 1;
+            MapTile mapTile1 = TileUtils::CalculateMapTile(envelopeBounds.getMin(), zoom, _projection);
+            MapTile mapTile2 = TileUtils::CalculateMapTile(envelopeBounds.getMax(), zoom, _projection);
+            int x0 = std::max(0, mapTile1.getX()), x1 = std::min(maxTile, mapTile2.getX());
+            int y0 = std::max(0, mapTile1.getY()), y1 = std::min(maxTile, mapTile2.getY());
+            if (zoom > 0 && static_cast<long long>(x1 - x0 + 1) * (y1 - y0 + 1) > MAX_QUERY_TILES) {
+                continue;
+            }
+            mapTiles.clear();
+            for (int y = y0; y <= y1; y++) {
+                for (int x = x0; x <= x1; x++) {
+                    mapTiles.emplace_back(x, y, zoom, zoomBand);
+                }
+            }
+            break;
         }
 
-        float simplifierScale = cullState->getViewState().estimateWorldPixelMeasure();
+        // Take a snapshot of the state shared with the other methods, so that the features can be read without holding the database lock
+        std::string codePage;
+        std::shared_ptr<GeometrySimplifier> geometrySimplifier;
+        std::map<long long, std::shared_ptr<VectorElement> > localElements;
+        long long cacheGeneration = 0;
+        std::vector<std::shared_ptr<const std::vector<std::shared_ptr<VectorElement> > > > tileElements(mapTiles.size());
+        std::vector<std::pair<std::size_t, MapBounds> > missingTiles;
+        {
+            std::lock_guard<std::mutex> lock(_dataBase->_mutex);
+
+            if (!_poLayer) {
+                return std::shared_ptr<VectorData>();
+            }
 
-        MapBounds bounds;
-        for (const MapPos& mapPos : cullState->getProjectionEnvelope(_projection).getConvexHull()) {
-            bounds.expandToContain(_poLayerSpatialRef->inverseTransform(mapPos.getX(), mapPos.getY(), mapPos.getZ()));
+            codePage = _codePage;
+            geometrySimplifier = _geometrySimplifier;
+            localElements = _localElements;
+            cacheGeneration = _elementCacheGeneration;
+            for (std::size_t i = 0; i < mapTiles.size(); i++) {
+                if (_elementCache.read(mapTiles[i].getTileId(), tileElements[i])) {
+                    continue;
+                }
+                MapBounds tileBounds = TileUtils::CalculateMapTileBounds(mapTiles[i], _projection);
+                MapBounds bounds;
+                bounds.expandToContain(_poLayerSpatialRef->inverseTransform(tileBounds.getMin().getX(), tileBounds.getMin().getY(), 0));
+                bounds.expandToContain(_poLayerSpatialRef->inverseTransform(tileBounds.getMax().getX(), tileBounds.getMin().getY(), 0));
+                bounds.expandToContain(_poLayerSpatialRef->inverseTransform(tileBounds.getMax().getX(), tileBounds.getMax().getY(), 0));
+                bounds.expandToContain(_poLayerSpatialRef->inverseTransform(tileBounds.getMin().getX(), tileBounds.getMax().getY(), 0));
+                missingTiles.emplace_back(i, bounds);
+            }
+        }
+
+        // Query only the tiles not found in the cache
+        if (!missingTiles.empty()) {
+            // Use a separate handle of the database if possible, so that the layers of the same database can be read in parallel.
+            // Otherwise fall back to the shared handle and keep the database locked while reading.
+            std::shared_ptr<OGRDataSource> poReaderDS = _dataBase->acquireReader();
+            OGRLayer* poLayer = (poReaderDS && _layerIndex < poReaderDS->GetLayerCount() ? poReaderDS->GetLayer(_layerIndex) : nullptr);
+            std::unique_lock<std::mutex> lock(_dataBase->_mutex, std::defer_lock);
+            if (!poLayer) {
+                lock.lock();
+                poLayer = _poLayer;
+            }
+
+            for (const std::pair<std::size_t, MapBounds>& missingTile : missingTiles) {
+                auto elements = std::make_shared<std::vector<std::shared_ptr<VectorElement> > >();
+                queryElements(poLayer, missingTile.second, viewState, simplifierScale, codePage, geometrySimplifier, *elements);
+                tileElements[missingTile.first] = elements;
+            }
+            if (lock.owns_lock()) {
+                lock.unlock();
+            }
+
+            // Store the results only if the cached state has not been changed meanwhile
+            std::lock_guard<std::mutex> cacheLock(_dataBase->_mutex);
+            if (_elementCacheGeneration == cacheGeneration) {
+                for (const std::pair<std::size_t, MapBounds>& missingTile : missingTiles) {
+                    const std::shared_ptr<const std::vector<std::shared_ptr<VectorElement> > >& elements = tileElements[missingTile.first];
+                    _elementCache.put(mapTiles[missingTile.first].getTileId(), elements, std::max(std::size_t(1), elements->size()));
+                }
+            }
         }
-        _poLayer->SetSpatialFilterRect(bounds.getMin().getX(), bounds.getMin().getY(), bounds.getMax().getX(), bounds.getMax().getY());
 
-        std::vector<std::shared_ptr<VectorElement>> elements;
-        _poLayer->ResetReading();
-        while (auto poFeature = std::shared_ptr<OGRFeature>(_poLayer->GetNextFeature(), OGRFeature::DestroyFeature)) {
-            auto elementIt = _localElements.find(poFeature->GetFID());
-            if (elementIt != _localElements.end()) {
-                if (elementIt->second) {
-                    elements.push_back(elementIt->second);
+        // Combine the tiles, features crossing the tile borders are included only once. Apply the local modifications
+        std::vector<std::shared_ptr<VectorElement> > elements;
+        std::unordered_set<long long> elementIds;
+        for (const std::shared_ptr<const std::vector<std::shared_ptr<VectorElement> > >& elements1 : tileElements) {
+            for (const std::shared_ptr<VectorElement>& element : *elements1) {
+                if (!elementIds.insert(element->getId()).second) {
+                    continue;
                 }
-                continue;
+                auto elementIt = localElements.find(element->getId());
+                if (elementIt != localElements.end()) {
+                    if (elementIt->second) {
+                        elements.push_back(elementIt->second);
+                    }
+                    continue;
+                }
+                elements.push_back(element);
+            }
+        }
+        
+        for (auto elementIt = localElements.begin(); elementIt != localElements.end(); elementIt++) {
+            if (elementIt->first < 0 && elementIt->second) {
+                elements.push_back(elementIt->second);
             }
+        }
 
+        return std::make_shared<VectorData>(elements);
+    }
+
+    void OGRVectorDataSource::queryElements(OGRLayer* poLayer, const MapBounds& bounds, const ViewState& viewState, float simplifierScale, const std::string& codePage, const std::shared_ptr<GeometrySimplifier>& geometrySimplifier, std::vector<std::shared_ptr<VectorElement> >& elements) {
+        poLayer->SetSpatialFilterRect(bounds.getMin().getX(), bounds.getMin().getY(), bounds.getMax().getX(), bounds.getMax().getY());
+
+        // Resolve the field definitions once for all the features
+        std::vector<std::pair<std::string, ::OGRFieldType> > fields;
+        if (OGRFeatureDefn* poFDefn = poLayer->GetLayerDefn()) {
+            for (int i = 0; i < poFDefn->GetFieldCount(); i++) {
+                OGRFieldDefn* poFieldDefn = poFDefn->GetFieldDefn(i);
+                fields.emplace_back(poFieldDefn->GetNameRef(), poFieldDefn->GetType());
+            }
+        }
+
+        poLayer->ResetReading();
+        while (auto poFeature = std::shared_ptr<OGRFeature>(poLayer->GetNextFeature(), OGRFeature::DestroyFeature)) {
             OGRGeometry* poGeometry = poFeature->GetGeometryRef();
             if (!poGeometry) {
                 continue;
             }
 
             std::map<std::string, Variant> metaData;
-            OGRFeatureDefn *poFDefn = _poLayer->GetLayerDefn();
-            if (poFDefn) {
-                for (int i = 0; i < poFDefn->GetFieldCount(); i++) {
-                    OGRFieldDefn* poFieldDefn = poFeature->GetFieldDefnRef(i);
-                    Variant value;
-                    switch (poFieldDefn->GetType()) {
-                    case OFTInteger:
-                        value = Variant(static_cast<long long>(poFeature->GetFieldAsInteger(i)));
-                        break;
-                    case OFTReal:
-                        value = Variant(poFeature->GetFieldAsDouble(i));
-                        break;
-                    default:
-                        {
-                            const char* strValue = poFeature->GetFieldAsString(i);
-                            if (!strValue) {
-                                continue;
-                            }
-                            char* utf8Value = CPLRecode(strValue, _codePage.c_str(), "UTF-8");
-                            if (utf8Value) {
-                                value = Variant(utf8Value);
-                                CPLFree(utf8Value);
-                            } else {
-                                value = Variant(strValue);
-                            }
+            for (int i = 0; i < static_cast<int>(fields.size()) && i < poFeature->GetFieldCount(); i++) {
+                Variant value;
+                switch (fields[i].second) {
+                case OFTInteger:
+                    value = Variant(static_cast<long long>(poFeature->GetFieldAsInteger(i)));
+                    break;
+                case OFTReal:
+                    value = Variant(poFeature->GetFieldAsDouble(i));
+                    break;
+                default:
+                    {
+                        const char* strValue = poFeature->GetFieldAsString(i);
+                        if (!strValue) {
+                            continue;
+                        }
+                        char* utf8Value = CPLRecode(strValue, codePage.c_str(), "UTF-8");
+                        if (utf8Value) {
+                            value = Variant(utf8Value);
+                            CPLFree(utf8Value);
+                        } else {
+                            value = Variant(strValue);
                         }
-                        break;
                     }
-                    metaData[poFDefn->GetFieldDefn(i)->GetNameRef()] = value;
+                    break;
                 }
+                metaData[fields[i].first] = value;
             }
                 
             std::shared_ptr<Geometry> geometry = createGeometry(poGeometry);
-            if (_geometrySimplifier) {
+            if (geometrySimplifier) {
                 if (geometry) {
-                    geometry = _geometrySimplifier->simplify(geometry, _projection, cullState->getViewState().getProjectionSurface(), simplifierScale);
+                    geometry = geometrySimplifier->simplify(geometry, _projection, viewState.getProjectionSurface(), simplifierScale);
                 }
             }
             if (geometry) {
-                std::shared_ptr<VectorElement> vectorElement = createVectorElement(cullState->getViewState(), geometry, metaData);
+                std::shared_ptr<VectorElement> vectorElement = createVectorElement(viewState, geometry, metaData);
                 if (vectorElement) {
                     vectorElement->setId(poFeature->GetFID());
                     vectorElement->setMetaData(metaData);
@@ -563,14 +702,11 @@ namespace carto {
                 }
             }
         }
-        
-        for (auto elementIt = _localElements.begin(); elementIt != _localElements.end(); elementIt++) {
-            if (elementIt->first < 0 && elementIt->second) {
-                elements.push_back(elementIt->second);
-            }
-        }
+    }
 
-        return std::make_shared<VectorData>(elements);
+    void OGRVectorDataSource::clearElementCache() {
+        _elementCache.clear();
+        _elementCacheGeneration++;
     }
 
     void OGRVectorDataSource::notifyElementChanged(const std::shared_ptr<VectorElement>& element) {
@@ -598,28 +734,17 @@ namespace carto {
         case wkbLineString:
             {
                 OGRLineString* poLineString = (OGRLineString*) poGeometry;
-                std::vector<MapPos> mapPoses(poLineString->getNumPoints());
-                for (int i = 0; i < poLineString->getNumPoints(); i++) {
-                    mapPoses[i] = _poLayerSpatialRef->transform(poLineString->getX(i), poLineString->getY(i), poLineString->getZ(i));
-                }
+                std::vector<MapPos> mapPoses = _poLayerSpatialRef->transform(poLineString);
                 geometry = std::make_shared<LineGeometry>(mapPoses);
             }
             break;
         case wkbPolygon:
             {
                 OGRPolygon* poPolygon = (OGRPolygon*) poGeometry;
-                OGRLineString* poLineString = poPolygon->getExteriorRing();
-                std::vector<MapPos> mapPoses(poLineString->getNumPoints());
-                for (int i = 0; i < poLineString->getNumPoints(); i++) {
-                    mapPoses[i] = _poLayerSpatialRef->transform(poLineString->getX(i), poLineString->getY(i), poLineString->getZ(i));
-                }
+                std::vector<MapPos> mapPoses = _poLayerSpatialRef->transform(poPolygon->getExteriorRing());
                 std::vector<std::vector<MapPos>> interiorMapPoses(poPolygon->getNumInteriorRings());
                 for (int n = 0; n < poPolygon->getNumInteriorRings(); n++) {
-                    poLineString = poPolygon->getInteriorRing(n);
-                    interiorMapPoses[n].resize(poLineString->getNumPoints());
-                    for (int i = 0; i < poLineString->getNumPoints(); i++) {
-                        interiorMapPoses[n][i] = _poLayerSpatialRef->transform(poLineString->getX(i), poLineString->getY(i),   poLineString->getZ(i));
-                    }
+                    interiorMapPoses[n] = _poLayerSpatialRef->transform(poPolygon->getInteriorRing(n));
                 }
                 geometry = std::make_shared<PolygonGeometry>(mapPoses, interiorMapPoses);
             }
@@ -16,6 +16,8 @@
 #include <map>
 #include <vector>
 
+#include <stdext/timed_lru_cache.h>
+
 class OGRGeometry;
 class OGRFeature;
 class OGRLayer;
@@ -68,6 +70,7 @@ namespace carto {
     /**
      * High-level vector element data source that supports various OGR data formats.
      * Shapefiles, GeoJSON, KML files can be used using this data source.
+     * The converted elements are cached per tile and integer zoom level, so that only newly exposed areas are queried and styled.
      */
     class OGRVectorDataSource : public VectorDataSource {
     public:
@@ -206,6 +209,13 @@ namespace carto {
         
     private:
         struct LayerSpatialReference;
+
+        static const int MAX_QUERY_TILES = 64;
+        static const int DEFAULT_ELEMENT_CACHE_SIZE = 65536;
+
+        void queryElements(OGRLayer* poLayer, const MapBounds& bounds, const ViewState& viewState, float simplifierScale, const std::string& codePage, const std::shared_ptr<GeometrySimplifier>& geometrySimplifier, std::vector<std::shared_ptr<VectorElement> >& elements);
+
+        void clearElementCache();
         
         std::shared_ptr<Geometry> createGeometry(const OGRGeometry* poGeometry) const;
         
@@ -223,8 +233,12 @@ namespace carto {
         std::map<long long, std::shared_ptr<VectorElement> > _localElements;
 
         std::shared_ptr<OGRVectorDataBase> _dataBase;
+        int _layerIndex;
         OGRLayer* _poLayer;
         std::shared_ptr<LayerSpatialReference> _poLayerSpatialRef;
+
+        cache::timed_lru_cache<long long, std::shared_ptr<const std::vector<std::shared_ptr<VectorElement> > > > _elementCache;
+        long long _elementCacheGeneration;
     };
 }
 
@@ -8,6 +8,8 @@
 #include "projections/EPSG3857.h"
 #include "utils/Log.h"
 
+#include <vector>
+
 #include <cglib/bbox.h>
 #include <cglib/frustum3.h>
 
@@ -62,7 +64,7 @@ namespace carto {
             return std::vector<MapTile>();
         }
     
-        MapBounds bounds = cullState->getProjectionEnvelope(_projection).getBounds();
+        MapBounds bounds = cullState->getProjectionBounds(_projection);
         
         sqlite3pp::query query(*_db, "SELECT id, modellodtree_id, mappos_x, mappos_y, groundheight, mapbounds_x0, mapbounds_y0, mapbounds_x1, mapbounds_y1 FROM MapTiles WHERE ((mapbounds_x1>=:x0 AND mapbounds_x0<=:x1) OR (mapbounds_x1>=:x0 + :width AND mapbounds_x0<=:x1 + :width) OR (mapbounds_x1>=:x0 - :width AND mapbounds_x0<=:x1 - :width)) AND (mapbounds_y1>=:y0 AND mapbounds_y0<=:y1)");
         query.bind(":x0", bounds.getMin().getX());
@@ -188,44 +190,52 @@ namespace carto {
     }
     
     std::shared_ptr<nml::Mesh> OfflineNMLModelLODTreeDataSource::loadMesh(long long meshId) {
-        std::lock_guard<std::mutex> lock(_mutex);
-    
-        if (!_db) {
-            Log::Error("OfflineNMLModelLODTreeDataSource::loadMesh: Failed to load mesh, could not connect to database");
-            return std::shared_ptr<nml::Mesh>();
-        }
-    
-        sqlite3pp::query query(*_db, "SELECT nmlmesh FROM Meshes WHERE id=:source_id");
-        query.bind(":source_id", static_cast<std::uint64_t>(meshId));
-        for (auto qit = query.begin(); qit != query.end(); qit++) {
-            std::size_t nmlMeshSize = (*qit).column_bytes(0);
-            const void* nmlMeshData = (*qit).get<const void*>(0);
-            std::shared_ptr<nml::Mesh> mesh = std::make_shared<nml::Mesh>(protobuf::message(nmlMeshData, nmlMeshSize));
-            return mesh;
+        // Copy the data while holding the lock, the mesh is decoded after releasing it so that other requests are not blocked meanwhile
+        std::vector<unsigned char> nmlMeshData;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+        
+            if (!_db) {
+                Log::Error("OfflineNMLModelLODTreeDataSource::loadMesh: Failed to load mesh, could not connect to database");
+                return std::shared_ptr<nml::Mesh>();
+            }
+        
+            sqlite3pp::query query(*_db, "SELECT nmlmesh FROM Meshes WHERE id=:source_id");
+            query.bind(":source_id", static_cast<std::uint64_t>(meshId));
+            auto qit = query.begin();
+            if (qit == query.end()) {
+                return std::shared_ptr<nml::Mesh>();
+            }
+            const unsigned char* data = static_cast<const unsigned char*>((*qit).get<const void*>(0));
+            nmlMeshData.assign(data, data + (*qit).column_bytes(0));
+            query.finish();
         }
-        query.finish();
-        return std::shared_ptr<nml::Mesh>();
+        return std::make_shared<nml::Mesh>(protobuf::message(nmlMeshData.data(), nmlMeshData.size()));
     }
     
     std::shared_ptr<nml::Texture> OfflineNMLModelLODTreeDataSource::loadTexture(long long textureId, int level) {
-        std::lock_guard<std::mutex> lock(_mutex);
-    
-        if (!_db) {
-            Log::Error("OfflineNMLModelLODTreeDataSource::loadTexture: Failed to load texture, could not connect to database");
-            return std::shared_ptr<nml::Texture>();
-        }
-    
-        sqlite3pp::query query(*_db, "SELECT nmltexture FROM Textures WHERE id=:source_id AND textures.level=:level ORDER BY textures.level ASC");
-        query.bind(":source_id", static_cast<std::uint64_t>(textureId));
-        query.bind(":level", level);
-        for (auto qit = query.begin(); qit != query.end(); qit++) {
-            std::size_t nmlTextureSize = (*qit).column_bytes(0);
-            const void* nmlTextureData = (*qit).get<const void*>(0);
-            std::shared_ptr<nml::Texture> texture = std::make_shared<nml::Texture>(protobuf::message(nmlTextureData, nmlTextureSize));
-            return texture;
+        // Copy the data while holding the lock, the texture is decoded after releasing it so that other requests are not blocked meanwhile
+        std::vector<unsigned char> nmlTextureData;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+        
+            if (!_db) {
+                Log::Error("OfflineNMLModelLODTreeDataSource::loadTexture: Failed to load texture, could not connect to database");
+                return std::shared_ptr<nml::Texture>();
+            }
+        
+            sqlite3pp::query query(*_db, "SELECT nmltexture FROM Textures WHERE id=:source_id AND textures.level=:level ORDER BY textures.level ASC");
+            query.bind(":source_id", static_cast<std::uint64_t>(textureId));
+            query.bind(":level", level);
+            auto qit = query.begin();
+            if (qit == query.end()) {
+                return std::shared_ptr<nml::Texture>();
+            }
+            const unsigned char* data = static_cast<const unsigned char*>((*qit).get<const void*>(0));
+            nmlTextureData.assign(data, data + (*qit).column_bytes(0));
+            query.finish();
         }
-        query.finish();
-        return std::shared_ptr<nml::Texture>();
+        return std::make_shared<nml::Texture>(protobuf::message(nmlTextureData.data(), nmlTextureData.size()));
     }
 
     const float OfflineNMLModelLODTreeDataSource::MIN_HEIGHT = 0.0f;
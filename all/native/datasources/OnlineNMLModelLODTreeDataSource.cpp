@@ -26,7 +26,7 @@ namespace carto {
     }
     
     std::vector<NMLModelLODTreeDataSource::MapTile> OnlineNMLModelLODTreeDataSource::loadMapTiles(const std::shared_ptr<CullState>& cullState) {
-        MapBounds bounds = cullState->getProjectionEnvelope(_projection).getBounds();
+        MapBounds bounds = cullState->getProjectionBounds(_projection);
     
         std::map<std::string, std::string> urlParams;
         urlParams["q"] = "MapTiles";
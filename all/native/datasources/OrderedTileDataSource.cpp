@@ -1,5 +1,6 @@
 #include "OrderedTileDataSource.h"
 #include "core/MapTile.h"
+#include "components/CancelableThreadPool.h"
 #include "components/Exceptions.h"
 #include "utils/Log.h"
 
@@ -11,7 +12,11 @@ namespace carto {
     OrderedTileDataSource::OrderedTileDataSource(const std::shared_ptr<TileDataSource>& dataSource1, const std::shared_ptr<TileDataSource>& dataSource2) :
         TileDataSource(),
         _dataSource1(dataSource1),
-        _dataSource2(dataSource2)
+        _dataSource2(dataSource2),
+        _dataSourceListener(),
+        _parallelLoading(false),
+        _loadThreadPool(),
+        _loadMutex()
     {
         if (!dataSource1) {
             throw NullArgumentException("Null dataSource1");
@@ -26,6 +31,9 @@ namespace carto {
     }
     
     OrderedTileDataSource::~OrderedTileDataSource() {
+        if (_loadThreadPool) {
+            _loadThreadPool->deinit();
+        }
         _dataSource2->unregisterOnChangeListener(_dataSourceListener);
         _dataSource1->unregisterOnChangeListener(_dataSourceListener);
         _dataSourceListener.reset();
@@ -45,13 +53,37 @@ namespace carto {
         return bounds;
     }
     
+    bool OrderedTileDataSource::isParallelLoading() const {
+        return _parallelLoading;
+    }
+
+    void OrderedTileDataSource::setParallelLoading(bool enabled) {
+        _parallelLoading = enabled;
+    }
+    
     std::shared_ptr<TileData> OrderedTileDataSource::loadTile(const MapTile& mapTile) {
         std::shared_ptr<TileData> result1, result2;
         int zoom = mapTile.getZoom();
+
+        // In parallel mode start loading the fallback tile before the primary tile is loaded
+        std::shared_ptr<LoadTask> task2;
+        if (_parallelLoading && zoom >= _dataSource1->getMinZoom() && zoom <= _dataSource1->getMaxZoom() && zoom >= _dataSource2->getMinZoom() && zoom <= _dataSource2->getMaxZoom()) {
+            std::lock_guard<std::mutex> lock(_loadMutex);
+            if (!_loadThreadPool) {
+                _loadThreadPool = std::make_shared<CancelableThreadPool>();
+                _loadThreadPool->setPoolSize(LOAD_POOL_SIZE);
+            }
+            task2 = std::make_shared<LoadTask>(_dataSource2.get(), mapTile);
+            _loadThreadPool->execute(task2);
+        }
+
         if (zoom >= _dataSource1->getMinZoom()) {
             if (zoom <= _dataSource1->getMaxZoom()) {
                 result1 = _dataSource1->loadTile(mapTile);
                 if (result1 && !result1->isReplaceWithParent()) {
+                    if (task2) {
+                        task2->cancel();
+                    }
                     return result1;
                 }
             } else {
@@ -61,7 +93,7 @@ namespace carto {
         }
         if (zoom >= _dataSource2->getMinZoom()) {
             if (zoom <= _dataSource2->getMaxZoom()) {
-                result2 = _dataSource2->loadTile(mapTile);
+                result2 = task2 ? task2->getResult() : _dataSource2->loadTile(mapTile);
                 if (result2 && !result2->isReplaceWithParent()) {
                     return result2;
                 }
@@ -81,5 +113,63 @@ namespace carto {
     void OrderedTileDataSource::DataSourceListener::onTilesChanged(bool removeTiles) {
         _combinedDataSource.notifyTilesChanged(removeTiles);
     }
+
+    void OrderedTileDataSource::DataSourceListener::onTilesChanged(const std::vector<MapTile>& tiles, bool removeTiles) {
+        _combinedDataSource.notifyTilesChanged(tiles, removeTiles);
+    }
+
+    OrderedTileDataSource::LoadTask::LoadTask(const std::shared_ptr<TileDataSource>& dataSource, const MapTile& mapTile) :
+        _dataSource(dataSource),
+        _mapTile(mapTile),
+        _result(),
+        _started(false),
+        _finished(false),
+        _condition()
+    {
+    }
+
+    std::shared_ptr<TileData> OrderedTileDataSource::LoadTask::getResult() {
+        // If the task has not been started by the thread pool yet, load the tile in the calling thread instead of waiting
+        if (start()) {
+            load();
+        }
+
+        std::unique_lock<std::mutex> lock(_mutex);
+        _condition.wait(lock, [this]() { return _finished; });
+        return _result;
+    }
+
+    void OrderedTileDataSource::LoadTask::run() {
+        if (isCanceled()) {
+            return;
+        }
+        if (start()) {
+            load();
+        }
+    }
+
+    bool OrderedTileDataSource::LoadTask::start() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_started) {
+            return false;
+        }
+        _started = true;
+        return true;
+    }
+
+    void OrderedTileDataSource::LoadTask::load() {
+        std::shared_ptr<TileData> result;
+        try {
+            result = _dataSource->loadTile(_mapTile);
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("OrderedTileDataSource::LoadTask: Exception while loading tile: %s", ex.what());
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _result = result;
+        _finished = true;
+        _condition.notify_all();
+    }
     
 }
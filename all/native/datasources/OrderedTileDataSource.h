@@ -8,9 +8,15 @@
 #define _CARTO_ORDEREDTILEDATASOURCE_H_
 
 #include "datasources/TileDataSource.h"
+#include "components/CancelableTask.h"
 #include "components/DirectorPtr.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
 namespace carto {
+    class CancelableThreadPool;
     
     /**
      * A tile data source that combines two data sources (usually offline and online).
@@ -30,6 +36,21 @@ namespace carto {
         virtual int getMaxZoom() const;
 
         virtual MapBounds getDataExtent() const;
+
+        /**
+         * Returns the state of parallel loading mode.
+         * @return True when parallel loading mode is enabled, false otherwise.
+         */
+        bool isParallelLoading() const;
+        /**
+         * Enables or disables parallel loading mode. In this mode tiles are requested from the second data source
+         * at the same time as from the first data source, so that a miss in the first data source does not delay the fallback.
+         * The result of the first data source is still preferred, the second request is canceled if it has not started yet.
+         * This is useful when the first data source is slow to report missing tiles, at the cost of extra requests
+         * to the second data source. The default is false.
+         * @param enabled True when parallel loading mode should be enabled, false otherwise.
+         */
+        void setParallelLoading(bool enabled);
         
         virtual std::shared_ptr<TileData> loadTile(const MapTile& tile);
         
@@ -39,6 +60,7 @@ namespace carto {
             explicit DataSourceListener(OrderedTileDataSource& combinedDataSource);
             
             virtual void onTilesChanged(bool removeTiles);
+            virtual void onTilesChanged(const std::vector<MapTile>& tiles, bool removeTiles);
             
         private:
             OrderedTileDataSource& _combinedDataSource;
@@ -48,7 +70,33 @@ namespace carto {
         const DirectorPtr<TileDataSource> _dataSource2;
         
     private:
+        class LoadTask : public CancelableTask {
+        public:
+            LoadTask(const std::shared_ptr<TileDataSource>& dataSource, const MapTile& mapTile);
+
+            std::shared_ptr<TileData> getResult();
+
+            virtual void run();
+
+        private:
+            bool start();
+            void load();
+
+            std::shared_ptr<TileDataSource> _dataSource;
+            MapTile _mapTile;
+            std::shared_ptr<TileData> _result;
+            bool _started;
+            bool _finished;
+            std::condition_variable _condition;
+        };
+
+        static const int LOAD_POOL_SIZE = 4;
+
         std::shared_ptr<DataSourceListener> _dataSourceListener;
+
+        std::atomic<bool> _parallelLoading;
+        std::shared_ptr<CancelableThreadPool> _loadThreadPool;
+        std::mutex _loadMutex;
     };
     
 }
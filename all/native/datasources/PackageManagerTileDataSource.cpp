@@ -3,10 +3,12 @@
 #include "PackageManagerTileDataSource.h"
 #include "core/MapTile.h"
 #include "components/Exceptions.h"
+#include "packagemanager/PackageTileIndex.h"
 #include "packagemanager/handlers/MapPackageHandler.h"
 #include "utils/Log.h"
 #include "utils/Const.h"
 
+#include <algorithm>
 #include <memory>
 
 namespace carto {
@@ -15,6 +17,9 @@ namespace carto {
         TileDataSource(0, Const::MAX_SUPPORTED_ZOOM_LEVEL),
         _packageManager(packageManager),
         _cachedOpenPackageHandlers(),
+        _packageTileIndex(),
+        _indexedPackages(),
+        _unindexedPackages(),
         _mutex()
     {
         if (!packageManager) {
@@ -43,37 +48,39 @@ namespace carto {
             _packageManager->accessLocalPackages([this, mapTileFlipped, &data](const std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<PackageHandler> >& packageHandlerMap) {
                 std::lock_guard<std::mutex> lock(_mutex);
 
+                if (!_packageTileIndex) {
+                    buildPackageTileIndex(packageHandlerMap);
+                }
+                std::vector<std::shared_ptr<PackageInfo> > candidates = findPackageCandidates(mapTileFlipped);
+
                 // Fast path: try already open packages
                 for (auto it = _cachedOpenPackageHandlers.begin(); it != _cachedOpenPackageHandlers.end(); it++) {
                     const std::shared_ptr<PackageInfo>& packageInfo = it->first;
-                    std::shared_ptr<PackageTileMask> tileMask = packageInfo->getTileMask();
-                    if (tileMask) {
-                        if (tileMask->getTileStatus(mapTileFlipped) == PackageTileStatus::PACKAGE_TILE_STATUS_MISSING) {
-                            continue;
-                        }
+                    if (std::find(candidates.begin(), candidates.end(), packageInfo) == candidates.end()) {
+                        continue;
                     }
 
                     data = it->second->loadTile(mapTileFlipped);
-                    if (data || tileMask) {
+                    if (data || packageInfo->getTileMask()) {
                         std::rotate(_cachedOpenPackageHandlers.begin(), it, it + 1);
                         return;
                     }
                 }
 
-                // Slow path: try other packages
-                for (auto it = packageHandlerMap.begin(); it != packageHandlerMap.end(); it++) {
-                    if (auto mapHandler = std::dynamic_pointer_cast<MapPackageHandler>(it->second)) {
-                        const std::shared_ptr<PackageInfo>& packageInfo = it->first;
-                        std::shared_ptr<PackageTileMask> tileMask = packageInfo->getTileMask();
-                        if (tileMask) {
-                            if (tileMask->getTileStatus(mapTileFlipped) == PackageTileStatus::PACKAGE_TILE_STATUS_MISSING) {
-                                continue;
-                            }
-                        }
+                // Slow path: try other candidate packages
+                for (const std::shared_ptr<PackageInfo>& packageInfo : candidates) {
+                    if (std::find_if(_cachedOpenPackageHandlers.begin(), _cachedOpenPackageHandlers.end(), [&packageInfo](const std::pair<std::shared_ptr<PackageInfo>, std::shared_ptr<MapPackageHandler> >& cachedHandler) { return cachedHandler.first == packageInfo; }) != _cachedOpenPackageHandlers.end()) {
+                        continue;
+                    }
 
+                    auto handlerIt = packageHandlerMap.find(packageInfo);
+                    if (handlerIt == packageHandlerMap.end()) {
+                        continue;
+                    }
+                    if (auto mapHandler = std::dynamic_pointer_cast<MapPackageHandler>(handlerIt->second)) {
                         mapHandler->openDatabase();
                         data = mapHandler->loadTile(mapTileFlipped);
-                        if (data || tileMask) {
+                        if (data || packageInfo->getTileMask()) {
                             _cachedOpenPackageHandlers.insert(_cachedOpenPackageHandlers.begin(), std::make_pair(packageInfo, mapHandler));
                             if (_cachedOpenPackageHandlers.size() > MAX_OPEN_PACKAGES) {
                                 _cachedOpenPackageHandlers.back().second->closeDatabase();
@@ -102,6 +109,34 @@ namespace carto {
         }
         return std::shared_ptr<TileData>();
     }
+
+    void PackageManagerTileDataSource::buildPackageTileIndex(const std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<PackageHandler> >& packageHandlerMap) const {
+        std::vector<std::shared_ptr<PackageTileMask> > tileMasks;
+        _indexedPackages.clear();
+        _unindexedPackages.clear();
+        for (auto it = packageHandlerMap.begin(); it != packageHandlerMap.end(); it++) {
+            if (!std::dynamic_pointer_cast<MapPackageHandler>(it->second)) {
+                continue;
+            }
+            if (std::shared_ptr<PackageTileMask> tileMask = it->first->getTileMask()) {
+                tileMasks.push_back(tileMask);
+                _indexedPackages.push_back(it->first);
+            } else {
+                _unindexedPackages.push_back(it->first);
+            }
+        }
+        _packageTileIndex = std::make_shared<PackageTileIndex>(tileMasks);
+    }
+
+    std::vector<std::shared_ptr<PackageInfo> > PackageManagerTileDataSource::findPackageCandidates(const MapTile& mapTile) const {
+        // Packages with tile masks are found from the index, packages without masks must always be checked
+        std::vector<std::shared_ptr<PackageInfo> > candidates;
+        for (int maskIndex : _packageTileIndex->findTileMasks(mapTile)) {
+            candidates.push_back(_indexedPackages[maskIndex]);
+        }
+        candidates.insert(candidates.end(), _unindexedPackages.begin(), _unindexedPackages.end());
+        return candidates;
+    }
         
     PackageManagerTileDataSource::PackageManagerListener::PackageManagerListener(PackageManagerTileDataSource& dataSource) :
         _dataSource(dataSource)
@@ -115,6 +150,7 @@ namespace carto {
                 it->second->closeDatabase();
             }
             _dataSource._cachedOpenPackageHandlers.clear();
+            _dataSource._packageTileIndex.reset(); // rebuilt lazily on next tile request
         }
         _dataSource.notifyTilesChanged(_dataSource._packageManager->getLocalPackages().empty()); // we need to remove all tiles only if there are no more packages left
     }
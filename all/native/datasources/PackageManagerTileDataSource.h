@@ -19,6 +19,7 @@
 
 namespace carto {
     class MapPackageHandler;
+    class PackageTileIndex;
 
     /**
      * A tile data source that loads tiles from package manager.
@@ -54,10 +55,17 @@ namespace carto {
 
         static const int MAX_OPEN_PACKAGES = 4;
 
+        void buildPackageTileIndex(const std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<PackageHandler> >& packageHandlerMap) const;
+        std::vector<std::shared_ptr<PackageInfo> > findPackageCandidates(const MapTile& mapTile) const;
+
         const std::shared_ptr<PackageManager> _packageManager;
 
         mutable std::vector<std::pair<std::shared_ptr<PackageInfo>, std::shared_ptr<MapPackageHandler> > > _cachedOpenPackageHandlers;
 
+        mutable std::shared_ptr<PackageTileIndex> _packageTileIndex;
+        mutable std::vector<std::shared_ptr<PackageInfo> > _indexedPackages;
+        mutable std::vector<std::shared_ptr<PackageInfo> > _unindexedPackages;
+
         mutable std::mutex _mutex;
 
     private:
@@ -0,0 +1,122 @@
+#include "PackedAssetTileDataSource.h"
+#include "core/BinaryData.h"
+#include "core/MapTile.h"
+#include "components/Exceptions.h"
+#include "utils/Const.h"
+#include "utils/Log.h"
+
+#include <algorithm>
+
+namespace carto {
+
+    PackedAssetTileDataSource::PackedAssetTileDataSource(const std::string& path) :
+        TileDataSource(),
+        _path(path),
+        _assetFile(),
+        _tileEntries()
+    {
+        readIndex(true);
+    }
+
+    PackedAssetTileDataSource::PackedAssetTileDataSource(int minZoom, int maxZoom, const std::string& path) :
+        TileDataSource(minZoom, maxZoom),
+        _path(path),
+        _assetFile(),
+        _tileEntries()
+    {
+        readIndex(false);
+    }
+        
+    PackedAssetTileDataSource::~PackedAssetTileDataSource() {
+    }
+    
+    std::shared_ptr<TileData> PackedAssetTileDataSource::loadTile(const MapTile& mapTile) {
+        Log::Infof("PackedAssetTileDataSource::loadTile: Loading %s", mapTile.toString().c_str());
+
+        long long tileId = MapTile(mapTile.getX(), mapTile.getY(), mapTile.getZoom(), 0).getTileId();
+        auto it = std::lower_bound(_tileEntries.begin(), _tileEntries.end(), tileId, [](const TileEntry& entry, long long id) {
+            return entry.tileId < id;
+        });
+        if (it == _tileEntries.end() || it->tileId != tileId) {
+            return createMissingTileData(mapTile);
+        }
+
+        std::shared_ptr<BinaryData> data = AssetUtils::ReadAsset(_assetFile, it->offset, it->size);
+        if (!data) {
+            Log::Errorf("PackedAssetTileDataSource::loadTile: Failed to read %s from %s", mapTile.toString().c_str(), _path.c_str());
+            return std::shared_ptr<TileData>();
+        }
+        return std::make_shared<TileData>(data);
+    }
+
+    void PackedAssetTileDataSource::readIndex(bool detectZoomRange) {
+        _assetFile = AssetUtils::OpenAsset(_path);
+        if (!_assetFile) {
+            throw FileException("Failed to open archive", _path);
+        }
+
+        // Read and check the header
+        std::shared_ptr<BinaryData> headerData = AssetUtils::ReadAsset(_assetFile, 0, HEADER_SIZE);
+        if (!headerData || std::string(reinterpret_cast<const char*>(headerData->data()), 4) != "CTPA") {
+            throw FileException("Invalid archive header", _path);
+        }
+        if (ReadUInt32(headerData->data() + 4) != ARCHIVE_VERSION) {
+            throw FileException("Unsupported archive version", _path);
+        }
+        std::size_t tileCount = ReadUInt32(headerData->data() + 8);
+
+        // Read the whole index with a single read
+        std::shared_ptr<BinaryData> indexData = AssetUtils::ReadAsset(_assetFile, HEADER_SIZE, tileCount * INDEX_ENTRY_SIZE);
+        if (!indexData) {
+            throw FileException("Failed to read archive index", _path);
+        }
+        _tileEntries.reserve(tileCount);
+        int minZoom = Const::MAX_SUPPORTED_ZOOM_LEVEL;
+        int maxZoom = 0;
+        for (std::size_t i = 0; i < tileCount; i++) {
+            const unsigned char* entryPtr = indexData->data() + i * INDEX_ENTRY_SIZE;
+            int zoom = static_cast<int>(ReadUInt32(entryPtr + 0));
+            int x = static_cast<int>(ReadUInt32(entryPtr + 4));
+            int y = static_cast<int>(ReadUInt32(entryPtr + 8));
+            if (zoom < 0 || zoom > Const::MAX_SUPPORTED_ZOOM_LEVEL) {
+                throw FileException("Invalid tile in archive index", _path);
+            }
+            minZoom = std::min(minZoom, zoom);
+            maxZoom = std::max(maxZoom, zoom);
+
+            TileEntry entry;
+            entry.tileId = MapTile(x, y, zoom, 0).getTileId();
+            entry.size = ReadUInt32(entryPtr + 12);
+            entry.offset = ReadUInt64(entryPtr + 16);
+            _tileEntries.push_back(entry);
+        }
+        std::sort(_tileEntries.begin(), _tileEntries.end(), [](const TileEntry& entry1, const TileEntry& entry2) {
+            return entry1.tileId < entry2.tileId;
+        });
+
+        if (detectZoomRange && !_tileEntries.empty()) {
+            _minZoom = minZoom;
+            _maxZoom = maxZoom;
+        }
+    }
+
+    std::shared_ptr<TileData> PackedAssetTileDataSource::createMissingTileData(const MapTile& mapTile) const {
+        if (mapTile.getZoom() > getMinZoom()) {
+            Log::Infof("PackedAssetTileDataSource: Tile data for %s doesn't exist in the archive, redirecting to parent", mapTile.toString().c_str());
+            std::shared_ptr<TileData> tileData = std::make_shared<TileData>(std::shared_ptr<BinaryData>());
+            tileData->setReplaceWithParent(true);
+            return tileData;
+        }
+        Log::Infof("PackedAssetTileDataSource: Tile data for %s doesn't exist in the archive", mapTile.toString().c_str());
+        return std::shared_ptr<TileData>();
+    }
+
+    std::uint32_t PackedAssetTileDataSource::ReadUInt32(const unsigned char* ptr) {
+        return static_cast<std::uint32_t>(ptr[0]) | (static_cast<std::uint32_t>(ptr[1]) << 8) | (static_cast<std::uint32_t>(ptr[2]) << 16) | (static_cast<std::uint32_t>(ptr[3]) << 24);
+    }
+
+    std::uint64_t PackedAssetTileDataSource::ReadUInt64(const unsigned char* ptr) {
+        return static_cast<std::uint64_t>(ReadUInt32(ptr)) | (static_cast<std::uint64_t>(ReadUInt32(ptr + 4)) << 32);
+    }
+    
+}
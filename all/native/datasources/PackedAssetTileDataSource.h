@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_PACKEDASSETTILEDATASOURCE_H_
+#define _CARTO_PACKEDASSETTILEDATASOURCE_H_
+
+#include "datasources/TileDataSource.h"
+#include "utils/AssetUtils.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace carto {
+    class BinaryData;
+    
+    /**
+     * A tile data source where all map tiles are stored in a single archive file bundled with the application.
+     * The archive is opened once and tiles are read directly from their offsets in the archive, which is
+     * much faster than loading each tile from a separate asset.
+     *
+     * The archive starts with a header: 4-byte magic "CTPA", 32-bit format version (1) and 32-bit tile count,
+     * followed by the tile index. Each index entry consists of 32-bit zoom, x, y (XYZ scheme) and data size values
+     * and 64-bit offset of the tile data from the start of the archive. All values are stored in little endian byte order.
+     */
+    class PackedAssetTileDataSource : public TileDataSource {
+    public:
+        /**
+         * Constructs a PackedAssetTileDataSource object. The zoom range is detected from the tile index.
+         * @param path The path of the archive asset.
+         * @throws std::ios_base::failure If the asset can not be opened or the archive is invalid.
+         */
+        explicit PackedAssetTileDataSource(const std::string& path);
+        /**
+         * Constructs a PackedAssetTileDataSource object.
+         * @param minZoom The minimum zoom level supported by this data source.
+         * @param maxZoom The maximum zoom level supported by this data source.
+         * @param path The path of the archive asset.
+         * @throws std::ios_base::failure If the asset can not be opened or the archive is invalid.
+         */
+        PackedAssetTileDataSource(int minZoom, int maxZoom, const std::string& path);
+        virtual ~PackedAssetTileDataSource();
+    
+        virtual std::shared_ptr<TileData> loadTile(const MapTile& mapTile);
+    
+    private:
+        struct TileEntry {
+            long long tileId;
+            std::uint64_t offset;
+            std::uint32_t size;
+        };
+
+        void readIndex(bool detectZoomRange);
+
+        std::shared_ptr<TileData> createMissingTileData(const MapTile& mapTile) const;
+
+        static std::uint32_t ReadUInt32(const unsigned char* ptr);
+        static std::uint64_t ReadUInt64(const unsigned char* ptr);
+
+        static const std::uint32_t ARCHIVE_VERSION = 1;
+        static const std::size_t HEADER_SIZE = 12;
+        static const std::size_t INDEX_ENTRY_SIZE = 24;
+
+        std::string _path;
+        std::shared_ptr<AssetUtils::AssetFile> _assetFile;
+        std::vector<TileEntry> _tileEntries; // sorted by tile id
+    };
+    
+}
+
+#endif
@@ -1,10 +1,18 @@
 #include "PersistentCacheTileDataSource.h"
 #include "core/BinaryData.h"
 #include "datasources/TileDownloadListener.h"
+#include "projections/Projection.h"
+#include "utils/CompressionUtils.h"
+#include "utils/Const.h"
 #include "utils/Log.h"
 #include "utils/TileUtils.h"
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include <sqlite3pp.h>
 
@@ -14,16 +22,31 @@ namespace carto {
         CacheTileDataSource(dataSource),
         _database(),
         _cacheOnlyMode(false),
+        _compressionEnabled(false),
         _downloadThreadPool(std::make_shared<CancelableThreadPool>()),
         _cache(DEFAULT_CAPACITY),
+        _tileInfoLoaded(false),
+        _tileInfoRemovedTileIds(),
+        _pendingWrites(),
+        _backgroundThread(),
+        _backgroundThreadStopped(false),
+        _pendingWritesCondition(),
         _mutex()
     {
+        _downloadThreadPool->setQoSClass(ThreadQoSClass::BACKGROUND);
         _downloadThreadPool->setPoolSize(1);
         openDatabase(databasePath);
+        _backgroundThread = std::make_shared<std::thread>(std::bind(&PersistentCacheTileDataSource::backgroundLoop, this));
     }
     
     PersistentCacheTileDataSource::~PersistentCacheTileDataSource() {
         stopAllDownloads();
+        {
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            _backgroundThreadStopped = true;
+            _pendingWritesCondition.notify_all();
+        }
+        _backgroundThread->join();
         closeDatabase();
         _downloadThreadPool->deinit();
     }
@@ -38,11 +61,26 @@ namespace carto {
         _cacheOnlyMode = enabled;
     }
 
+    bool PersistentCacheTileDataSource::isCompressionEnabled() const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        return _compressionEnabled;
+    }
+
+    void PersistentCacheTileDataSource::setCompressionEnabled(bool enabled) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        _compressionEnabled = enabled;
+    }
+
     void PersistentCacheTileDataSource::startDownloadArea(const MapBounds& mapBounds, int minZoom, int maxZoom, const std::shared_ptr<TileDownloadListener>& tileDownloadListener) {
         auto task = std::make_shared<DownloadTask>(std::static_pointer_cast<PersistentCacheTileDataSource>(shared_from_this()), mapBounds, minZoom, maxZoom, tileDownloadListener);
         _downloadThreadPool->execute(task, 0);
     }
 
+    void PersistentCacheTileDataSource::startDownloadRoute(const std::vector<MapPos>& routePoints, float bufferDistance, int minZoom, int maxZoom, const std::shared_ptr<TileDownloadListener>& tileDownloadListener) {
+        auto task = std::make_shared<RouteDownloadTask>(std::static_pointer_cast<PersistentCacheTileDataSource>(shared_from_this()), routePoints, bufferDistance, minZoom, maxZoom, tileDownloadListener);
+        _downloadThreadPool->execute(task, 0);
+    }
+
     void PersistentCacheTileDataSource::stopAllDownloads() {
         _downloadThreadPool->cancelAll();
     }
@@ -56,26 +94,35 @@ namespace carto {
             Log::Error("PersistentCacheTileDataSource::loadTile: Could not connect to the database, loading tile without caching");
         }
 
-        if (_cache.empty()) {
-            loadTileInfo();
-        }
-        
         std::shared_ptr<TileData> tileData;
 
+        // While the tile info is being loaded in the background, tiles missing from the cache are checked from the database
         std::shared_ptr<long long> tileIdPtr;
-        if (_cache.read(mapTile.getTileId(), tileIdPtr)) {
+        bool cached = _cache.read(mapTile.getTileId(), tileIdPtr);
+        if (cached || !_tileInfoLoaded) {
             tileData = get(mapTile.getTileId());
             if (tileData) {
-                if (tileData->getMaxAge() != 0) {
-                    return tileData;
+                if (tileData->getMaxAge() != 0 || (isStaleWhileRevalidate() && !_cacheOnlyMode)) {
+                    if (!cached) {
+                        _cache.put(mapTile.getTileId(), createTileId(mapTile.getTileId()), tileData->getData()->size());
+                    }
+                    countCacheLookup(true);
+                    return tileData->getMaxAge() != 0 ? tileData : revalidateTile(mapTile, tileData);
                 }
             }
             _cache.remove(mapTile.getTileId());
         }
+        countCacheLookup(false);
         
         if (!_cacheOnlyMode) {
+            // If an expired copy exists, let the data source revalidate it instead of loading it from scratch
+            std::shared_ptr<TileData> expiredTileData = tileData;
             lock.unlock();
-            tileData = _dataSource->loadTile(mapTile);
+            if (expiredTileData) {
+                tileData = _dataSource->reloadTile(mapTile, expiredTileData);
+            } else {
+                tileData = _dataSource->loadTileCoalesced(mapTile);
+            }
             lock.lock();
         }
     
@@ -93,6 +140,14 @@ namespace carto {
         return tileData;
     }
 
+    void PersistentCacheTileDataSource::storeRevalidatedTile(const MapTile& mapTile, const std::shared_ptr<TileData>& tileData, bool changed) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        _cache.put(mapTile.getTileId(), createTileId(mapTile.getTileId()), tileData->getData()->size());
+        if (_cache.exists(mapTile.getTileId())) { // make sure the tile was added
+            store(mapTile.getTileId(), tileData); // the expiration time must be updated even if the content did not change
+        }
+    }
+
     bool PersistentCacheTileDataSource::isOpen() const {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
         return (bool) _database;
@@ -103,10 +158,24 @@ namespace carto {
         closeDatabase();
     }
         
+    std::size_t PersistentCacheTileDataSource::getCacheSize() const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        return _cache.size();
+    }
+
     void PersistentCacheTileDataSource::clear() {
         try {
             std::lock_guard<std::recursive_mutex> lock(_mutex);
             _cache.clear(); // forces all elements to be removed, but can be slow
+            flushPendingWrites();
+
+            // If the tile info is not fully loaded yet, the cache does not contain all the tiles of the database
+            if (!_tileInfoLoaded && _database) {
+                sqlite3pp::command command(*_database, "DELETE FROM persistent_cache");
+                command.execute();
+                command.finish();
+                _tileInfoLoaded = true;
+            }
         }
         catch (const std::exception& ex) {
             Log::Errorf("PersistentCacheTileDataSource::clear: Failed to clear cache: %s", ex.what());
@@ -142,6 +211,20 @@ namespace carto {
             command2.execute();
             command2.finish();
 
+            try {
+                // Use WAL journal, so that batched writes do not block readers and need fewer syncs
+                sqlite3pp::query query(*_database, "PRAGMA journal_mode=WAL");
+                for (auto it = query.begin(); it != query.end(); ++it);
+                query.finish();
+
+                sqlite3pp::command command(*_database, "PRAGMA synchronous=NORMAL");
+                command.execute();
+                command.finish();
+            }
+            catch (const std::exception& ex) {
+                Log::Warnf("PersistentCacheTileDataSource::openDatabase: Failed to switch to WAL journal mode: %s", ex.what());
+            }
+
             try {
                 sqlite3pp::query query1(*_database, "SELECT name FROM sqlite_master WHERE type='table' AND name='persistent_cache'");
                 for (auto it1 = query1.begin(); it1 != query1.end(); ++it1) {
@@ -158,9 +241,38 @@ namespace carto {
                 command.finish();
             }
 
-            sqlite3pp::command command3(*_database, "CREATE TABLE IF NOT EXISTS persistent_cache(tileId INTEGER NOT NULL PRIMARY KEY, compressed BLOB, time INTEGER, expirationTime INTEGER)");
+            sqlite3pp::command command3(*_database, "CREATE TABLE IF NOT EXISTS persistent_cache(tileId INTEGER NOT NULL PRIMARY KEY, compressed BLOB, time INTEGER, expirationTime INTEGER, etag TEXT, lastModified TEXT, uncompressedSize INTEGER)");
             command3.execute();
             command3.finish();
+
+            // Add HTTP validator columns to databases created by older versions
+            try {
+                sqlite3pp::query query(*_database, "SELECT etag, lastModified FROM persistent_cache LIMIT 1");
+                for (auto it = query.begin(); it != query.end(); ++it);
+                query.finish();
+            }
+            catch (const std::exception&) {
+                Log::Info("PersistentCacheTileDataSource::openDatabase: Adding validator columns to database");
+                sqlite3pp::command command4(*_database, "ALTER TABLE persistent_cache ADD COLUMN etag TEXT");
+                command4.execute();
+                command4.finish();
+                sqlite3pp::command command5(*_database, "ALTER TABLE persistent_cache ADD COLUMN lastModified TEXT");
+                command5.execute();
+                command5.finish();
+            }
+
+            // Add compression column to databases created by older versions. Existing tiles are stored as they are
+            try {
+                sqlite3pp::query query(*_database, "SELECT uncompressedSize FROM persistent_cache LIMIT 1");
+                for (auto it = query.begin(); it != query.end(); ++it);
+                query.finish();
+            }
+            catch (const std::exception&) {
+                Log::Info("PersistentCacheTileDataSource::openDatabase: Adding compression column to database");
+                sqlite3pp::command command6(*_database, "ALTER TABLE persistent_cache ADD COLUMN uncompressedSize INTEGER");
+                command6.execute();
+                command6.finish();
+            }
         }
         catch (const std::exception& ex) {
             Log::Errorf("PersistentCacheTileDataSource::openDatabase: Failed to initialize database: %s", ex.what());
@@ -174,6 +286,8 @@ namespace carto {
             return;
         }
 
+        flushPendingWrites();
+
         try {
             if (_database->disconnect() != SQLITE_OK) {
                 Log::Error("PersistentCacheTileDataSource::closeDatabase: Failed to close database");
@@ -186,26 +300,68 @@ namespace carto {
         }
 
         _cache.clear(); // NOTE: as the database is closed at this point, elements are not removed
+        _tileInfoLoaded = true;
     }
     
     void PersistentCacheTileDataSource::loadTileInfo() {
-        if (!_database) {
-            return;
-        }
+        struct TileInfo {
+            long long tileId;
+            std::size_t size;
+            long long time;
+        };
 
-        // Get tile ids and sizes ordered by the timestamp from the database
+        // Read tile ids, sizes and timestamps in tile id order. Each chunk is a cheap primary key range query,
+        // the lock is released between chunks so that tiles can be loaded at the same time.
+        std::vector<TileInfo> tileInfos;
         try {
-            sqlite3pp::query query(*_database, "SELECT tileId, LENGTH(compressed) FROM persistent_cache ORDER BY time ASC");
-            for (auto it = query.begin(); it != query.end(); ++it) {
-                long long tileId = (*it).get<std::uint64_t>(0);
-                std::size_t tileSize = static_cast<std::size_t>((*it).get<std::uint64_t>(1));
-                _cache.put(tileId, createTileId(tileId), tileSize);
+            long long lastTileId = -1;
+            while (true) {
+                std::lock_guard<std::recursive_mutex> lock(_mutex);
+                if (!_database || _tileInfoLoaded || _backgroundThreadStopped) {
+                    return;
+                }
+
+                int count = 0;
+                sqlite3pp::query query(*_database, "SELECT tileId, LENGTH(compressed), time FROM persistent_cache WHERE tileId>:lastTileId ORDER BY tileId ASC LIMIT :limit");
+                query.bind(":lastTileId", lastTileId);
+                query.bind(":limit", TILE_INFO_CHUNK_SIZE);
+                for (auto it = query.begin(); it != query.end(); ++it) {
+                    TileInfo tileInfo;
+                    tileInfo.tileId = (*it).get<std::uint64_t>(0);
+                    tileInfo.size = static_cast<std::size_t>((*it).get<std::uint64_t>(1));
+                    tileInfo.time = (*it).get<std::uint64_t>(2);
+                    tileInfos.push_back(tileInfo);
+                    lastTileId = tileInfo.tileId;
+                    count++;
+                }
+                query.finish();
+
+                if (count < TILE_INFO_CHUNK_SIZE) {
+                    break;
+                }
             }
-            query.finish();
         }
         catch (const std::exception& ex) {
             Log::Errorf("PersistentCacheTileDataSource::loadTileInfo: Failed to query tile set from the database: %s", ex.what());
         }
+
+        std::sort(tileInfos.begin(), tileInfos.end(), [](const TileInfo& tileInfo1, const TileInfo& tileInfo2) {
+            return tileInfo1.time < tileInfo2.time;
+        });
+
+        // Add the tiles to the cache in timestamp order. Skip tiles that were added or removed in the meantime
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        if (!_database || _tileInfoLoaded) {
+            return;
+        }
+        for (const TileInfo& tileInfo : tileInfos) {
+            if (_cache.exists(tileInfo.tileId) || _tileInfoRemovedTileIds.find(tileInfo.tileId) != _tileInfoRemovedTileIds.end()) {
+                continue;
+            }
+            _cache.put(tileInfo.tileId, createTileId(tileInfo.tileId), tileInfo.size);
+        }
+        _tileInfoLoaded = true;
+        _tileInfoRemovedTileIds.clear();
     }
     
     std::shared_ptr<TileData> PersistentCacheTileDataSource::get(long long tileId) {
@@ -214,24 +370,63 @@ namespace carto {
         }
     
         try {
-            // Get the tile from the database
-            sqlite3pp::query query(*_database, "SELECT compressed, expirationTime FROM persistent_cache WHERE tileId=:tileId");
-            query.bind(":tileId", static_cast<std::uint64_t>(tileId));
-            auto qit = query.begin();
-            if (qit == query.end()) {
-                // No data exists for this tile in the database
-                Log::Error("PersistentCacheTileDataSource::get: Inconsistency, tile data does not exist in the database");
-                return std::shared_ptr<TileData>();
+            std::shared_ptr<BinaryData> data;
+            long long expirationTime = 0;
+            std::string etag;
+            std::string lastModified;
+            std::size_t uncompressedSize = 0;
+
+            auto it = _pendingWrites.find(tileId);
+            if (it != _pendingWrites.end()) {
+                // Queued writes are not yet in the database, use the queued state
+                if (!it->second.data) {
+                    return std::shared_ptr<TileData>();
+                }
+                data = it->second.data;
+                expirationTime = it->second.expirationTime;
+                etag = it->second.etag;
+                lastModified = it->second.lastModified;
+                uncompressedSize = it->second.uncompressedSize;
+            } else {
+                // Get the tile from the database
+                sqlite3pp::query query(*_database, "SELECT compressed, expirationTime, etag, lastModified, uncompressedSize FROM persistent_cache WHERE tileId=:tileId");
+                query.bind(":tileId", static_cast<std::uint64_t>(tileId));
+                auto qit = query.begin();
+                if (qit == query.end()) {
+                    // No data exists for this tile in the database. This is expected only while the tile info is being loaded
+                    if (_tileInfoLoaded) {
+                        Log::Error("PersistentCacheTileDataSource::get: Inconsistency, tile data does not exist in the database");
+                    }
+                    return std::shared_ptr<TileData>();
+                }
+                
+                // Construct TileData from the blob returned from the database
+                std::size_t dataSize = (*qit).column_bytes(0);
+                const unsigned char* dataPtr = static_cast<const unsigned char*>((*qit).get<const void*>(0));
+                expirationTime = (*qit).get<std::uint64_t>(1);
+                if (const char* etagPtr = (*qit).get<const char*>(2)) {
+                    etag = etagPtr;
+                }
+                if (const char* lastModifiedPtr = (*qit).get<const char*>(3)) {
+                    lastModified = lastModifiedPtr;
+                }
+                uncompressedSize = static_cast<std::size_t>((*qit).get<std::uint64_t>(4));
+                data = std::make_shared<BinaryData>(dataPtr, dataSize);
+                query.finish();
+            }
+
+            if (uncompressedSize != 0) {
+                std::vector<unsigned char> uncompressedData;
+                if (!CompressionUtils::InflateData(data->data(), data->size(), uncompressedSize, uncompressedData)) {
+                    Log::Error("PersistentCacheTileDataSource::get: Failed to decompress tile data");
+                    return std::shared_ptr<TileData>();
+                }
+                data = std::make_shared<BinaryData>(std::move(uncompressedData));
             }
-            
-            // Construct TileData from the blob returned from the database
-            std::size_t dataSize = (*qit).column_bytes(0);
-            const unsigned char* dataPtr = static_cast<const unsigned char*>((*qit).get<const void*>(0));
-            long long expirationTime = (*qit).get<std::uint64_t>(1);
-            auto data = std::make_shared<BinaryData>(dataPtr, dataSize);
-            query.finish();
             
             auto tileData = std::make_shared<TileData>(data);
+            tileData->setETag(etag);
+            tileData->setLastModified(lastModified);
             if (expirationTime != 0) {
                 long long maxAge = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::time_point(std::chrono::milliseconds(expirationTime)) - std::chrono::system_clock::now()).count();
                 tileData->setMaxAge(maxAge > 0 ? maxAge : 0);
@@ -255,19 +450,24 @@ namespace carto {
             expirationTime = std::chrono::duration_cast<std::chrono::milliseconds>((std::chrono::system_clock::now() + std::chrono::milliseconds(tileData->getMaxAge())).time_since_epoch()).count();
         }
 
-        // Add tile to the database
-        try {
-            sqlite3pp::command command(*_database, "INSERT OR REPLACE INTO persistent_cache(tileId, compressed, time, expirationTime) VALUES (:tileId, :compressed, :time, :expirationTime)");
-            command.bind(":tileId", static_cast<std::uint64_t>(tileId));
-            command.bind(":compressed", tileData->getData()->data(), static_cast<unsigned int>(tileData->getData()->size()));
-            command.bind(":time", static_cast<std::uint64_t>(time));
-            command.bind(":expirationTime", static_cast<std::uint64_t>(expirationTime));
-            command.execute();
-            command.finish();
-        }
-        catch (const std::exception& ex) {
-            Log::Errorf("PersistentCacheTileDataSource::store: Failed to store tile data in the database: %s", ex.what());
+        // Queue the tile for adding to the database
+        PendingWrite pendingWrite;
+        pendingWrite.data = tileData->getData();
+        pendingWrite.time = time;
+        pendingWrite.expirationTime = expirationTime;
+        pendingWrite.etag = tileData->getETag();
+        pendingWrite.lastModified = tileData->getLastModified();
+        pendingWrite.uncompressedSize = 0;
+
+        const BinaryData& data = *tileData->getData();
+        if (_compressionEnabled && !CompressionUtils::IsCompressedData(data.data(), data.size())) {
+            std::vector<unsigned char> compressedData;
+            if (CompressionUtils::DeflateData(data.data(), data.size(), compressedData) && compressedData.size() < data.size()) {
+                pendingWrite.data = std::make_shared<BinaryData>(std::move(compressedData));
+                pendingWrite.uncompressedSize = data.size();
+            }
         }
+        addPendingWrite(tileId, pendingWrite);
     }
 
     void PersistentCacheTileDataSource::remove(long long tileId) {
@@ -275,15 +475,85 @@ namespace carto {
             return;
         }
         
+        if (!_tileInfoLoaded) {
+            _tileInfoRemovedTileIds.insert(tileId);
+        }
+
+        // Queue the tile for removal from the database
+        PendingWrite pendingWrite;
+        pendingWrite.time = 0;
+        pendingWrite.expirationTime = 0;
+        pendingWrite.uncompressedSize = 0;
+        addPendingWrite(tileId, pendingWrite);
+    }
+
+    void PersistentCacheTileDataSource::addPendingWrite(long long tileId, const PendingWrite& pendingWrite) {
+        if (_pendingWrites.empty()) {
+            _pendingWritesCondition.notify_all(); // start the flush interval
+        }
+        _pendingWrites[tileId] = pendingWrite;
+
+        if (static_cast<int>(_pendingWrites.size()) >= MAX_PENDING_WRITES) {
+            flushPendingWrites();
+        }
+    }
+
+    void PersistentCacheTileDataSource::backgroundLoop() {
+        loadTileInfo();
+
+        std::unique_lock<std::recursive_mutex> lock(_mutex);
+        while (!_backgroundThreadStopped) {
+            if (_pendingWrites.empty()) {
+                _pendingWritesCondition.wait(lock);
+                continue;
+            }
+            _pendingWritesCondition.wait_for(lock, std::chrono::milliseconds(WRITE_FLUSH_INTERVAL));
+            flushPendingWrites();
+        }
+    }
+
+    void PersistentCacheTileDataSource::flushPendingWrites() {
+        if (_pendingWrites.empty()) {
+            return;
+        }
+        if (!_database) {
+            _pendingWrites.clear();
+            return;
+        }
+
+        // Commit all the queued writes in a single transaction
         try {
-            sqlite3pp::command command(*_database, "DELETE FROM persistent_cache WHERE tileId=:tileId");
-            command.bind(":tileId", static_cast<std::uint64_t>(tileId));
-            command.execute();
-            command.finish();
+            sqlite3pp::transaction xct(*_database);
+            {
+                sqlite3pp::command insertCommand(*_database, "INSERT OR REPLACE INTO persistent_cache(tileId, compressed, time, expirationTime, etag, lastModified, uncompressedSize) VALUES (:tileId, :compressed, :time, :expirationTime, :etag, :lastModified, :uncompressedSize)");
+                sqlite3pp::command deleteCommand(*_database, "DELETE FROM persistent_cache WHERE tileId=:tileId");
+                for (auto it = _pendingWrites.begin(); it != _pendingWrites.end(); it++) {
+                    const PendingWrite& pendingWrite = it->second;
+                    if (pendingWrite.data) {
+                        insertCommand.bind(":tileId", static_cast<std::uint64_t>(it->first));
+                        insertCommand.bind(":compressed", pendingWrite.data->data(), static_cast<unsigned int>(pendingWrite.data->size()));
+                        insertCommand.bind(":time", static_cast<std::uint64_t>(pendingWrite.time));
+                        insertCommand.bind(":expirationTime", static_cast<std::uint64_t>(pendingWrite.expirationTime));
+                        insertCommand.bind(":etag", pendingWrite.etag.c_str());
+                        insertCommand.bind(":lastModified", pendingWrite.lastModified.c_str());
+                        insertCommand.bind(":uncompressedSize", static_cast<std::uint64_t>(pendingWrite.uncompressedSize));
+                        insertCommand.execute();
+                        insertCommand.reset();
+                    } else {
+                        deleteCommand.bind(":tileId", static_cast<std::uint64_t>(it->first));
+                        deleteCommand.execute();
+                        deleteCommand.reset();
+                    }
+                }
+                insertCommand.finish();
+                deleteCommand.finish();
+            }
+            xct.commit();
         }
         catch (const std::exception& ex) {
-            Log::Errorf("PersistentCacheTileDataSource::remove: Failed to remove tile from the database: %s", ex.what());
+            Log::Errorf("PersistentCacheTileDataSource::flushPendingWrites: Failed to update the database: %s", ex.what());
         }
+        _pendingWrites.clear();
     }
     
     std::shared_ptr<long long> PersistentCacheTileDataSource::createTileId(long long tileId) {
@@ -298,6 +568,91 @@ namespace carto {
         return std::shared_ptr<long long>(new long long(tileId), tileIdDeleter);
     }
 
+    std::vector<MapTile> PersistentCacheTileDataSource::CalculateRouteTiles(const std::vector<MapPos>& routePoints, double bufferDistance, int minZoom, int maxZoom, const std::shared_ptr<Projection>& projection) {
+        // Convert the buffer distance to projection units at each route point using the local scale of the projection,
+        // and calculate the distance along the route to each point
+        std::vector<double> pointBuffers;
+        std::vector<double> pointDistances;
+        double routeDistance = 0;
+        for (std::size_t i = 0; i < routePoints.size(); i++) {
+            MapPos wgsPos = projection->toWgs84(routePoints[i]);
+            double deltaLat = bufferDistance / Const::EARTH_CIRCUMFERENCE * 360.0;
+            MapPos offsetPos = projection->fromWgs84(MapPos(wgsPos.getX(), wgsPos.getY() + (wgsPos.getY() > 0 ? -deltaLat : deltaLat)));
+            pointBuffers.push_back((offsetPos - routePoints[i]).length());
+            if (i > 0) {
+                routeDistance += (routePoints[i] - routePoints[i - 1]).length();
+            }
+            pointDistances.push_back(routeDistance);
+        }
+
+        // Find the tiles near each route segment, keep the shortest route distance for each tile
+        std::unordered_map<MapTile, double> tileDistances;
+        for (int zoom = minZoom; zoom <= maxZoom; zoom++) {
+            int tileCount = 1 << zoom;
+            double tileSize = projection->getBounds().getDelta().getX() / tileCount;
+            double tileRadius = tileSize * std::sqrt(0.5);
+            for (std::size_t i = 0; i < routePoints.size(); i++) {
+                const MapPos& pos0 = routePoints[i];
+                const MapPos& pos1 = routePoints[i + 1 < routePoints.size() ? i + 1 : i];
+                // The corridor always includes the tiles the route passes through
+                double buffer = std::max(std::max(pointBuffers[i], pointBuffers[i + 1 < routePoints.size() ? i + 1 : i]), tileSize * 0.5);
+
+                MapBounds segmentBounds;
+                segmentBounds.expandToContain(pos0);
+                segmentBounds.expandToContain(pos1);
+                MapTile mapTile1 = TileUtils::CalculateMapTile(segmentBounds.getMin() - MapVec(buffer, buffer), zoom, projection);
+                MapTile mapTile2 = TileUtils::CalculateMapTile(segmentBounds.getMax() + MapVec(buffer, buffer), zoom, projection);
+                MapVec segmentVec = pos1 - pos0;
+                double segmentLengthSqr = segmentVec.lengthSqr();
+                for (int y = std::max(0, mapTile1.getY()); y <= std::min(tileCount - 1, mapTile2.getY()); y++) {
+                    for (int x = std::max(0, mapTile1.getX()); x <= std::min(tileCount - 1, mapTile2.getX()); x++) {
+                        MapTile mapTile(x, y, zoom, 0);
+                        MapPos tileCenter = TileUtils::CalculateMapTileBounds(mapTile, projection).getCenter();
+                        double t = 0;
+                        if (segmentLengthSqr > 0) {
+                            t = std::max(0.0, std::min(1.0, (tileCenter - pos0).dotProduct(segmentVec) / segmentLengthSqr));
+                        }
+                        MapPos nearestPos = pos0 + segmentVec * t;
+                        if ((tileCenter - nearestPos).length() > buffer + tileRadius) {
+                            continue;
+                        }
+
+                        double distance = pointDistances[i] + std::sqrt(segmentLengthSqr) * t;
+                        auto it = tileDistances.find(mapTile);
+                        if (it == tileDistances.end()) {
+                            tileDistances[mapTile] = distance;
+                        } else {
+                            it->second = std::min(it->second, distance);
+                        }
+                    }
+                }
+            }
+        }
+
+        // Order by the distance along the route, then by zoom level
+        std::vector<std::pair<double, MapTile> > orderedTiles;
+        orderedTiles.reserve(tileDistances.size());
+        for (auto it = tileDistances.begin(); it != tileDistances.end(); it++) {
+            orderedTiles.emplace_back(it->second, it->first);
+        }
+        std::sort(orderedTiles.begin(), orderedTiles.end(), [](const std::pair<double, MapTile>& tile1, const std::pair<double, MapTile>& tile2) {
+            if (tile1.first != tile2.first) {
+                return tile1.first < tile2.first;
+            }
+            if (tile1.second.getZoom() != tile2.second.getZoom()) {
+                return tile1.second.getZoom() < tile2.second.getZoom();
+            }
+            return tile1.second.getTileId() < tile2.second.getTileId();
+        });
+
+        std::vector<MapTile> mapTiles;
+        mapTiles.reserve(orderedTiles.size());
+        for (const std::pair<double, MapTile>& orderedTile : orderedTiles) {
+            mapTiles.push_back(orderedTile.second);
+        }
+        return mapTiles;
+    }
+
     PersistentCacheTileDataSource::DownloadTask::DownloadTask(const std::shared_ptr<PersistentCacheTileDataSource>& dataSource, const MapBounds& mapBounds, int minZoom, int maxZoom, const std::shared_ptr<TileDownloadListener>& listener) :
         _dataSource(dataSource),
         _mapBounds(mapBounds),
@@ -359,7 +714,7 @@ namespace carto {
                     MapTile mapTile(x, y, zoom, 0);
                     std::shared_ptr<TileData> tileData;
                     if (auto dataSource = _dataSource.lock()) {
-                        tileData = dataSource->loadTile(mapTile.getFlipped());
+                        tileData = dataSource->loadTileCoalesced(mapTile.getFlipped());
                     } else {
                         return;
                     }
@@ -380,4 +735,72 @@ namespace carto {
         Log::Info("PersistentCacheTileDataSource:: DownloadTask: Finished downloading");
     }
 
+    PersistentCacheTileDataSource::RouteDownloadTask::RouteDownloadTask(const std::shared_ptr<PersistentCacheTileDataSource>& dataSource, const std::vector<MapPos>& routePoints, float bufferDistance, int minZoom, int maxZoom, const std::shared_ptr<TileDownloadListener>& listener) :
+        _dataSource(dataSource),
+        _routePoints(routePoints),
+        _bufferDistance(bufferDistance),
+        _minZoom(minZoom),
+        _maxZoom(maxZoom),
+        _downloadListener(listener)
+    {
+    }
+
+    void PersistentCacheTileDataSource::RouteDownloadTask::run() {
+        std::shared_ptr<Projection> projection;
+        int minZoom = _minZoom;
+        int maxZoom = _maxZoom;
+        if (auto dataSource = _dataSource.lock()) {
+            if (!dataSource->isOpen()) {
+                Log::Warn("PersistentCacheTileDataSource:: RouteDownloadTask: Database is not open, skipping download");
+                return;
+            }
+            projection = dataSource->getProjection();
+            minZoom = std::max(minZoom, dataSource->getMinZoom());
+            maxZoom = std::min(maxZoom, dataSource->getMaxZoom());
+        } else {
+            return;
+        }
+
+        std::vector<MapTile> mapTiles;
+        if (!_routePoints.empty()) {
+            mapTiles = CalculateRouteTiles(_routePoints, _bufferDistance, minZoom, maxZoom, projection);
+        }
+
+        Log::Infof("PersistentCacheTileDataSource:: RouteDownloadTask: Starting to download %d tiles", static_cast<int>(mapTiles.size()));
+
+        if (_downloadListener) {
+            _downloadListener->onDownloadStarting(static_cast<int>(mapTiles.size()));
+        }
+
+        std::size_t tileIndex = 0;
+        for (const MapTile& mapTile : mapTiles) {
+            if (isCanceled()) {
+                break;
+            }
+
+            if (_downloadListener) {
+                _downloadListener->onDownloadProgress(static_cast<float>(100.0 * tileIndex / mapTiles.size()));
+            }
+
+            std::shared_ptr<TileData> tileData;
+            if (auto dataSource = _dataSource.lock()) {
+                tileData = dataSource->loadTileCoalesced(mapTile.getFlipped());
+            } else {
+                return;
+            }
+            tileIndex++;
+
+            if (!tileData && _downloadListener) {
+                _downloadListener->onDownloadFailed(mapTile);
+            }
+        }
+
+        if (tileIndex == mapTiles.size() && _downloadListener) {
+            _downloadListener->onDownloadProgress(100.0f);
+            _downloadListener->onDownloadCompleted();
+        }
+
+        Log::Info("PersistentCacheTileDataSource:: RouteDownloadTask: Finished downloading");
+    }
+
 }
@@ -8,11 +8,18 @@
 #define _CARTO_PERSISTENTCACHETILEDATASOURCE_H_
 
 #include "core/MapBounds.h"
+#include "core/MapPos.h"
+#include "core/MapTile.h"
 #include "components/CancelableThreadPool.h"
 #include "components/DirectorPtr.h"
 #include "datasources/CacheTileDataSource.h"
 
+#include <condition_variable>
+#include <map>
 #include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
 
 #include <stdext/timed_lru_cache.h>
 
@@ -29,8 +36,13 @@ namespace carto {
      * even after the application is closed.
      * The database contains table "persistent_cache" with the following fields:
      * "tileId" (tile id), "compressed" (compressed tile image),
-     * "time" (the time the tile was cached in milliseconds from epoch).
+     * "time" (the time the tile was cached in milliseconds from epoch),
+     * "expirationTime" (the expiration time of the tile in milliseconds from epoch, or 0),
+     * "etag" and "lastModified" (HTTP validators of the tile used for conditional revalidation).
      * Default cache capacity is 50MB.
+     * Writes to the database are queued and committed in batches, either periodically
+     * or when enough writes have been accumulated. The cache index is loaded in the background
+     * after opening the database, tiles can be loaded from the cache immediately.
      */
     class PersistentCacheTileDataSource : public CacheTileDataSource {
     public:
@@ -57,6 +69,20 @@ namespace carto {
          */
         void setCacheOnlyMode(bool enabled);
 
+        /**
+         * Returns the state of compressed storage mode.
+         * @return True when new tiles are stored in compressed form, false otherwise.
+         */
+        bool isCompressionEnabled() const;
+        /**
+         * Enables or disables compressed storage mode.
+         * If enabled, tiles are stored deflate-compressed in the database and decompressed when loaded. Tiles that are already
+         * in a compressed format (gzip, zlib, PNG, JPEG, WebP) are stored as they are. The compression is recorded per tile,
+         * so tiles stored in either mode can be read regardless of the current mode. By default, the mode is off.
+         * @param enabled True when the mode should be enabled, false otherwise.
+         */
+        void setCompressionEnabled(bool enabled);
+
         /**
          * Starts downloading the specified area. The area will be stored in the cache.
          * Note that is the area is too big or cache is already filled, subsequent downloaded tiles
@@ -67,6 +93,18 @@ namespace carto {
          * @param tileDownloadListener The tile download listener to use that will receive download related callbacks.
          */
         void startDownloadArea(const MapBounds& mapBounds, int minZoom, int maxZoom, const std::shared_ptr<TileDownloadListener>& tileDownloadListener);
+        /**
+         * Starts downloading a corridor along the specified route. The corridor will be stored in the cache.
+         * Only the tiles within the buffer distance from the route are downloaded. At each zoom level the corridor
+         * includes at least the tiles the route passes through. Tiles are downloaded in the order the route reaches them,
+         * so that the tiles needed first are available first.
+         * @param routePoints The points of the route polyline, for example the points of a routing result. The coordinate system of the points must be the same as specified in the data source projection.
+         * @param bufferDistance The half-width of the corridor in meters.
+         * @param minZoom The minimum zoom of the tiles to load.
+         * @param maxZoom The maximum zoom of the tiles to load.
+         * @param tileDownloadListener The tile download listener to use that will receive download related callbacks.
+         */
+        void startDownloadRoute(const std::vector<MapPos>& routePoints, float bufferDistance, int minZoom, int maxZoom, const std::shared_ptr<TileDownloadListener>& tileDownloadListener);
         /**
          * Stops all background downloader processes.
          */
@@ -107,13 +145,49 @@ namespace carto {
             DirectorPtr<TileDownloadListener> _downloadListener;
         };
 
+        class RouteDownloadTask : public CancelableTask {
+        public:
+            RouteDownloadTask(const std::shared_ptr<PersistentCacheTileDataSource>& dataSource, const std::vector<MapPos>& routePoints, float bufferDistance, int minZoom, int maxZoom, const std::shared_ptr<TileDownloadListener>& listener);
+            
+            virtual void run();
+    
+        private:
+            std::weak_ptr<PersistentCacheTileDataSource> _dataSource;
+            std::vector<MapPos> _routePoints;
+            float _bufferDistance;
+            int _minZoom;
+            int _maxZoom;
+            DirectorPtr<TileDownloadListener> _downloadListener;
+        };
+
+        struct PendingWrite {
+            std::shared_ptr<BinaryData> data; // null if the tile should be removed
+            long long time;
+            long long expirationTime;
+            std::string etag;
+            std::string lastModified;
+            std::size_t uncompressedSize; // 0 if the data is stored as it is
+        };
+
+        virtual void storeRevalidatedTile(const MapTile& mapTile, const std::shared_ptr<TileData>& tileData, bool changed);
+        virtual std::size_t getCacheSize() const;
+
         static const int DEFAULT_CAPACITY = 50 * 1024 * 1024;
+        static const int MAX_PENDING_WRITES = 64;
+        static const int TILE_INFO_CHUNK_SIZE = 4096;
+        static const int WRITE_FLUSH_INTERVAL = 1000; // in milliseconds
 
         void openDatabase(const std::string& databasePath);
         void closeDatabase();
         void loadTileInfo();
 
+        void addPendingWrite(long long tileId, const PendingWrite& pendingWrite);
+        void backgroundLoop();
+        void flushPendingWrites();
+
         void downloadArea(const MapBounds& mapBounds, int minZoom, int maxZoom, const std::shared_ptr<TileDownloadListener>& listener);
+
+        static std::vector<MapTile> CalculateRouteTiles(const std::vector<MapPos>& routePoints, double bufferDistance, int minZoom, int maxZoom, const std::shared_ptr<Projection>& projection);
         
         std::shared_ptr<TileData> get(long long tileId);
         void store(long long tileId, const std::shared_ptr<TileData>& tileData);
@@ -124,10 +198,19 @@ namespace carto {
         std::unique_ptr<sqlite3pp::database> _database;
         
         bool _cacheOnlyMode;
+        bool _compressionEnabled;
 
         std::shared_ptr<CancelableThreadPool> _downloadThreadPool;
         
         cache::timed_lru_cache<long long, std::shared_ptr<long long> > _cache;
+        bool _tileInfoLoaded;
+        std::unordered_set<long long> _tileInfoRemovedTileIds; // tiles removed while loading the tile info
+
+        std::map<long long, PendingWrite> _pendingWrites; // ordered by tile id for better locality of database updates
+        std::shared_ptr<std::thread> _backgroundThread;
+        bool _backgroundThreadStopped;
+        std::condition_variable_any _pendingWritesCondition;
+
         mutable std::recursive_mutex _mutex;
     };
 
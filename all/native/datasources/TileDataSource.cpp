@@ -29,6 +29,60 @@ namespace carto {
         return _projection;
     }
     
+    std::shared_ptr<TileData> TileDataSource::loadTileCoalesced(const MapTile& tile) {
+        std::promise<std::shared_ptr<TileData> > promise;
+        std::shared_future<std::shared_ptr<TileData> > future;
+        bool loading = false;
+        {
+            std::lock_guard<std::mutex> lock(_loadingTilesMutex);
+            auto it = _loadingTiles.find(tile.getTileId());
+            if (it != _loadingTiles.end()) {
+                future = it->second;
+                loading = true;
+            } else {
+                _loadingTiles[tile.getTileId()] = promise.get_future().share();
+            }
+        }
+
+        // If the tile is already being loaded by another thread, simply wait for the result
+        if (loading) {
+            return future.get();
+        }
+
+        std::shared_ptr<TileData> tileData;
+        try {
+            tileData = loadTile(tile);
+            promise.set_value(tileData);
+        }
+        catch (...) {
+            promise.set_exception(std::current_exception());
+            std::lock_guard<std::mutex> lock(_loadingTilesMutex);
+            _loadingTiles.erase(tile.getTileId());
+            throw;
+        }
+
+        std::lock_guard<std::mutex> lock(_loadingTilesMutex);
+        _loadingTiles.erase(tile.getTileId());
+        return tileData;
+    }
+    
+    std::shared_ptr<TileData> TileDataSource::reloadTile(const MapTile& tile, const std::shared_ptr<TileData>& cachedTileData) {
+        return loadTile(tile);
+    }
+
+    bool TileDataSource::isBatchLoadingSupported() const {
+        return false;
+    }
+
+    std::vector<std::shared_ptr<TileData> > TileDataSource::loadTiles(const std::vector<MapTile>& tiles) {
+        std::vector<std::shared_ptr<TileData> > tileDatas;
+        tileDatas.reserve(tiles.size());
+        for (const MapTile& tile : tiles) {
+            tileDatas.push_back(loadTile(tile));
+        }
+        return tileDatas;
+    }
+    
     void TileDataSource::notifyTilesChanged(bool removeTiles) {
         std::vector<std::shared_ptr<OnChangeListener> > onChangeListeners;
         {
@@ -39,6 +93,17 @@ namespace carto {
             listener->onTilesChanged(removeTiles);
         }
     }
+
+    void TileDataSource::notifyTilesChanged(const std::vector<MapTile>& tiles, bool removeTiles) {
+        std::vector<std::shared_ptr<OnChangeListener> > onChangeListeners;
+        {
+            std::lock_guard<std::mutex> lock(_onChangeListenersMutex);
+            onChangeListeners = _onChangeListeners;
+        }
+        for (const std::shared_ptr<OnChangeListener>& listener : onChangeListeners) {
+            listener->onTilesChanged(tiles, removeTiles);
+        }
+    }
         
     void TileDataSource::registerOnChangeListener(const std::shared_ptr<OnChangeListener>& listener) {
         std::lock_guard<std::mutex> lock(_onChangeListenersMutex);
@@ -12,10 +12,12 @@
 #include "datasources/components/TileData.h"
 
 #include <atomic>
+#include <future>
 #include <mutex>
 #include <memory>
 #include <vector>
 #include <map>
+#include <unordered_map>
 
 namespace carto {
     class Projection;
@@ -38,6 +40,15 @@ namespace carto {
              * @param removeTiles The remove tiles flag.
              */
             virtual void onTilesChanged(bool removeTiles) = 0;
+
+            /**
+             * Listener method that gets called when only the specified tiles have changed and need to be updated.
+             * The default implementation treats the change as a change of all tiles.
+             * Note: the tile coordinate system used here is vertically flipped relative to layer tile coordinate system.
+             * @param tiles The changed tiles.
+             * @param removeTiles The remove tiles flag.
+             */
+            virtual void onTilesChanged(const std::vector<MapTile>& tiles, bool removeTiles) { onTilesChanged(removeTiles); }
         };
         
         virtual ~TileDataSource();
@@ -73,6 +84,40 @@ namespace carto {
          * @return The tile data. If the tile is not available, null may be returned.
          */
         virtual std::shared_ptr<TileData> loadTile(const MapTile& tile) = 0;
+
+        /**
+         * Loads the specified tile, sharing the result between concurrent requests.
+         * If the same tile is already being loaded by another thread, this call waits for that request
+         * to finish instead of issuing a new one. Otherwise equivalent to loadTile.
+         * @param tile The tile to load.
+         * @return The tile data. If the tile is not available, null may be returned.
+         */
+        std::shared_ptr<TileData> loadTileCoalesced(const MapTile& tile);
+
+        /**
+         * Reloads a tile that was loaded earlier, for example when the cached copy has expired.
+         * Data sources supporting conditional requests can use the validators of the cached tile data
+         * and return the cached data blob with a new max age if the tile has not been modified.
+         * The default implementation simply loads the tile using loadTile.
+         * @param tile The tile to reload.
+         * @param cachedTileData The earlier tile data of the tile.
+         * @return The tile data. If the tile is not available, null may be returned.
+         */
+        virtual std::shared_ptr<TileData> reloadTile(const MapTile& tile, const std::shared_ptr<TileData>& cachedTileData);
+
+        /**
+         * Returns true if the data source can load multiple tiles more efficiently than one by one.
+         * Tile layers use loadTiles only for data sources that support batch loading.
+         * @return True if batch loading is supported. The default implementation returns false.
+         */
+        virtual bool isBatchLoadingSupported() const;
+        /**
+         * Loads the specified tiles. The default implementation loads the tiles one by one using loadTile.
+         * Note: the tile coordinate system used here is vertically flipped relative to layer tile coordinate system.
+         * @param tiles The tiles to load.
+         * @return The tile data of the tiles, in the same order as the tiles. Unavailable tiles are represented by nulls.
+         */
+        virtual std::vector<std::shared_ptr<TileData> > loadTiles(const std::vector<MapTile>& tiles);
     
         /**
          * Notifies listeners that the tiles have changed. Action taken depends on the implementation of the
@@ -81,6 +126,14 @@ namespace carto {
          * @param removeTiles The remove tiles flag.
          */
         virtual void notifyTilesChanged(bool removeTiles);
+        /**
+         * Notifies listeners that the specified tiles have changed. Listeners may reload just the given tiles
+         * and all cached tiles derived from them, leaving the rest of the cached tiles intact.
+         * Note: the tile coordinate system used here is vertically flipped relative to layer tile coordinate system.
+         * @param tiles The changed tiles.
+         * @param removeTiles The remove tiles flag.
+         */
+        virtual void notifyTilesChanged(const std::vector<MapTile>& tiles, bool removeTiles);
     
         /**
          * Registers listener for data source change events.
@@ -120,6 +173,9 @@ namespace carto {
         const std::shared_ptr<Projection> _projection;
     
     private:
+        std::unordered_map<long long, std::shared_future<std::shared_ptr<TileData> > > _loadingTiles;
+        mutable std::mutex _loadingTilesMutex;
+
         std::vector<std::shared_ptr<OnChangeListener> > _onChangeListeners;
         mutable std::mutex _onChangeListenersMutex;
     };
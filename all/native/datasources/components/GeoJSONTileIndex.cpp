@@ -0,0 +1,111 @@
+#include "GeoJSONTileIndex.h"
+#include "projections/Projection.h"
+#include "utils/TileUtils.h"
+
+namespace carto {
+
+    GeoJSONTileIndex::Feature::Feature(int layerIndex, const picojson::value& geoJSON, const MapBounds& bounds) :
+        _layerIndex(layerIndex),
+        _geoJSON(geoJSON),
+        _bounds(bounds)
+    {
+    }
+
+    int GeoJSONTileIndex::Feature::getLayerIndex() const {
+        return _layerIndex;
+    }
+
+    const picojson::value& GeoJSONTileIndex::Feature::getGeoJSON() const {
+        return _geoJSON;
+    }
+
+    const MapBounds& GeoJSONTileIndex::Feature::getBounds() const {
+        return _bounds;
+    }
+
+    GeoJSONTileIndex::GeoJSONTileIndex(const std::vector<std::shared_ptr<const Feature> >& features, const std::shared_ptr<Projection>& projection, double tileBuffer) :
+        _projection(projection),
+        _tileBuffer(tileBuffer),
+        _bounds(),
+        _rootNode(std::make_shared<Node>())
+    {
+        for (const std::shared_ptr<const Feature>& feature : features) {
+            // Features without geometry do not overlap any tiles
+            if (feature->getBounds().getMin().getX() > feature->getBounds().getMax().getX()) {
+                continue;
+            }
+            _bounds.expandToContain(feature->getBounds());
+            _rootNode->features.push_back(feature);
+        }
+    }
+
+    GeoJSONTileIndex::~GeoJSONTileIndex() {
+    }
+
+    const MapBounds& GeoJSONTileIndex::getBounds() const {
+        return _bounds;
+    }
+
+    std::vector<std::shared_ptr<const GeoJSONTileIndex::Feature> > GeoJSONTileIndex::getTileFeatures(const MapTile& mapTile) const {
+        MapTile indexTile = mapTile.getFlipped();
+
+        // Descend towards the tile, splitting the nodes on the way if needed
+        std::shared_ptr<Node> node = _rootNode;
+        int zoom = 0;
+        while (zoom < indexTile.getZoom() && node->features.size() > MAX_LEAF_FEATURES) {
+            zoom++;
+            int shift = indexTile.getZoom() - zoom;
+            MapTile subTile(indexTile.getX() >> shift, indexTile.getY() >> shift, zoom, 0);
+            int childIndex = (subTile.getX() & 1) + (subTile.getY() & 1) * 2;
+
+            std::shared_ptr<Node> childNode;
+            {
+                std::lock_guard<std::mutex> lock(node->mutex);
+                childNode = node->children[childIndex];
+            }
+            if (!childNode) {
+                // Split outside of the lock, the parent features are never modified. If another thread was faster, use its node
+                std::shared_ptr<Node> newNode = createNode(*node, subTile);
+                std::lock_guard<std::mutex> lock(node->mutex);
+                if (!node->children[childIndex]) {
+                    node->children[childIndex] = newNode;
+                }
+                childNode = node->children[childIndex];
+            }
+            node = childNode;
+        }
+
+        if (zoom == indexTile.getZoom()) {
+            return node->features;
+        }
+
+        // The node is a small leaf covering a larger area, filter its features for the tile
+        std::vector<std::shared_ptr<const Feature> > features;
+        MapBounds tileBounds = TileUtils::CalculateMapTileBounds(indexTile, _projection);
+        MapVec margin = tileBounds.getDelta() * _tileBuffer;
+        tileBounds = MapBounds(tileBounds.getMin() - margin, tileBounds.getMax() + margin);
+        for (const std::shared_ptr<const Feature>& feature : node->features) {
+            if (feature->getBounds().intersects(tileBounds)) {
+                features.push_back(feature);
+            }
+        }
+        return features;
+    }
+
+    std::shared_ptr<GeoJSONTileIndex::Node> GeoJSONTileIndex::createNode(const Node& parentNode, const MapTile& mapTile) const {
+        MapBounds tileBounds = TileUtils::CalculateMapTileBounds(mapTile, _projection);
+        MapVec margin = tileBounds.getDelta() * _tileBuffer;
+        tileBounds = MapBounds(tileBounds.getMin() - margin, tileBounds.getMax() + margin);
+
+        auto node = std::make_shared<Node>();
+        for (const std::shared_ptr<const Feature>& feature : parentNode.features) {
+            if (feature->getBounds().intersects(tileBounds)) {
+                node->features.push_back(feature);
+            }
+        }
+        return node;
+    }
+
+    const std::size_t GeoJSONTileIndex::MAX_LEAF_FEATURES = 16;
+
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_GEOJSONTILEINDEX_H_
+#define _CARTO_GEOJSONTILEINDEX_H_
+
+#include "core/MapBounds.h"
+#include "core/MapTile.h"
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <picojson/picojson.h>
+
+namespace carto {
+    class Projection;
+
+    /**
+     * An immutable hierarchical index of GeoJSON features for tile generation.
+     * The index is a quadtree over the tile pyramid: each node keeps the features overlapping its tile (including the tile buffer),
+     * and the child nodes are split lazily from the features of the parent node when the tiles are first requested.
+     * The index can be queried concurrently from multiple threads.
+     */
+    class GeoJSONTileIndex {
+    public:
+        /**
+         * A single indexed feature.
+         */
+        class Feature {
+        public:
+            Feature(int layerIndex, const picojson::value& geoJSON, const MapBounds& bounds);
+
+            int getLayerIndex() const;
+            const picojson::value& getGeoJSON() const;
+            const MapBounds& getBounds() const;
+
+        private:
+            int _layerIndex;
+            picojson::value _geoJSON;
+            MapBounds _bounds; // in the index projection
+        };
+
+        /**
+         * Constructs a new index.
+         * @param features The features to index. The order of the features is kept in tile queries.
+         * @param projection The projection of the feature bounds and tile grid.
+         * @param tileBuffer The tile buffer relative to the tile size.
+         */
+        GeoJSONTileIndex(const std::vector<std::shared_ptr<const Feature> >& features, const std::shared_ptr<Projection>& projection, double tileBuffer);
+        virtual ~GeoJSONTileIndex();
+
+        /**
+         * Returns the bounds of all indexed features.
+         * @return The bounds of all indexed features.
+         */
+        const MapBounds& getBounds() const;
+
+        /**
+         * Returns the features that may overlap the specified tile.
+         * If a quadtree node has only a few features, the node is not split further and its features are returned for all its subtiles.
+         * @param mapTile The tile to query. Note: the tile coordinate system used here is vertically flipped relative to layer tile coordinate system.
+         * @return The features that may overlap the tile, in the original order.
+         */
+        std::vector<std::shared_ptr<const Feature> > getTileFeatures(const MapTile& mapTile) const;
+
+    private:
+        struct Node {
+            std::vector<std::shared_ptr<const Feature> > features;
+            std::array<std::shared_ptr<Node>, 4> children;
+            std::mutex mutex;
+        };
+
+        static const std::size_t MAX_LEAF_FEATURES;
+
+        std::shared_ptr<Node> createNode(const Node& parentNode, const MapTile& mapTile) const;
+
+        const std::shared_ptr<Projection> _projection;
+        const double _tileBuffer;
+        MapBounds _bounds;
+        std::shared_ptr<Node> _rootNode;
+    };
+
+}
+
+#endif
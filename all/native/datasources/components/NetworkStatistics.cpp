@@ -0,0 +1,66 @@
+#include "NetworkStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace carto {
+    
+    NetworkStatistics::NetworkStatistics(long long requestCount, long long failedRequestCount, long long transferredBytes, long long decodedBytes, std::map<int, long long> statusCodeCounts, std::vector<float> timeToFirstByteSamples, std::vector<float> transferTimeSamples) :
+        _requestCount(requestCount),
+        _failedRequestCount(failedRequestCount),
+        _transferredBytes(transferredBytes),
+        _decodedBytes(decodedBytes),
+        _statusCodeCounts(std::move(statusCodeCounts)),
+        _timeToFirstByteSamples(std::move(timeToFirstByteSamples)),
+        _transferTimeSamples(std::move(transferTimeSamples))
+    {
+        std::sort(_timeToFirstByteSamples.begin(), _timeToFirstByteSamples.end());
+        std::sort(_transferTimeSamples.begin(), _transferTimeSamples.end());
+    }
+
+    NetworkStatistics::~NetworkStatistics() {
+    }
+
+    long long NetworkStatistics::getRequestCount() const {
+        return _requestCount;
+    }
+
+    long long NetworkStatistics::getFailedRequestCount() const {
+        return _failedRequestCount;
+    }
+
+    long long NetworkStatistics::getStatusCodeCount(int statusCode) const {
+        auto it = _statusCodeCounts.find(statusCode);
+        if (it == _statusCodeCounts.end()) {
+            return 0;
+        }
+        return it->second;
+    }
+
+    long long NetworkStatistics::getTransferredBytes() const {
+        return _transferredBytes;
+    }
+
+    long long NetworkStatistics::getDecodedBytes() const {
+        return _decodedBytes;
+    }
+
+    float NetworkStatistics::getTimeToFirstBytePercentile(float percentile) const {
+        return CalculatePercentile(_timeToFirstByteSamples, percentile);
+    }
+
+    float NetworkStatistics::getTransferTimePercentile(float percentile) const {
+        return CalculatePercentile(_transferTimeSamples, percentile);
+    }
+
+    float NetworkStatistics::CalculatePercentile(const std::vector<float>& sortedSamples, float percentile) {
+        if (sortedSamples.empty()) {
+            return 0;
+        }
+        // Nearest-rank method
+        float rank = std::ceil(std::max(0.0f, std::min(100.0f, percentile)) / 100.0f * sortedSamples.size());
+        std::size_t index = static_cast<std::size_t>(std::max(1.0f, rank)) - 1;
+        return sortedSamples[std::min(index, sortedSamples.size() - 1)];
+    }
+
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_NETWORKSTATISTICS_H_
+#define _CARTO_NETWORKSTATISTICS_H_
+
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace carto {
+    
+    /**
+     * A snapshot of aggregated network request statistics of a data source.
+     * Totals cover all requests since the statistics were last reset,
+     * percentiles are calculated from the most recent requests.
+     */
+    class NetworkStatistics {
+    public:
+        /**
+         * Constructs a NetworkStatistics object.
+         * @param requestCount The total number of requests.
+         * @param failedRequestCount The number of requests that failed without a response.
+         * @param transferredBytes The total number of response bytes transferred over the network.
+         * @param decodedBytes The total number of response bytes after content decoding.
+         * @param statusCodeCounts The number of responses for each HTTP status code.
+         * @param timeToFirstByteSamples The time to first byte samples in milliseconds.
+         * @param transferTimeSamples The response transfer time samples in milliseconds.
+         */
+        NetworkStatistics(long long requestCount, long long failedRequestCount, long long transferredBytes, long long decodedBytes, std::map<int, long long> statusCodeCounts, std::vector<float> timeToFirstByteSamples, std::vector<float> transferTimeSamples);
+        virtual ~NetworkStatistics();
+
+        /**
+         * Returns the total number of requests.
+         * @return The total number of requests.
+         */
+        long long getRequestCount() const;
+        /**
+         * Returns the number of requests that failed without receiving a response (connection errors, timeouts).
+         * @return The number of failed requests.
+         */
+        long long getFailedRequestCount() const;
+        /**
+         * Returns the number of responses with the given HTTP status code.
+         * @param statusCode The HTTP status code (for example, 200 or 304).
+         * @return The number of responses with the given status code.
+         */
+        long long getStatusCodeCount(int statusCode) const;
+
+        /**
+         * Returns the total number of response bytes transferred over the network, before content decoding.
+         * @return The total number of transferred bytes.
+         */
+        long long getTransferredBytes() const;
+        /**
+         * Returns the total number of response bytes after content decoding.
+         * @return The total number of decoded bytes.
+         */
+        long long getDecodedBytes() const;
+
+        /**
+         * Returns the time to first byte at the given percentile of recent requests.
+         * The time includes name resolution, connection setup and server processing time.
+         * @param percentile The percentile in range 0..100 (for example, 50 for median).
+         * @return The time to first byte in milliseconds, or 0 if no samples are available.
+         */
+        float getTimeToFirstBytePercentile(float percentile) const;
+        /**
+         * Returns the response transfer time at the given percentile of recent requests.
+         * @param percentile The percentile in range 0..100 (for example, 50 for median).
+         * @return The transfer time in milliseconds, or 0 if no samples are available.
+         */
+        float getTransferTimePercentile(float percentile) const;
+        
+    private:
+        static float CalculatePercentile(const std::vector<float>& sortedSamples, float percentile);
+
+        const long long _requestCount;
+        const long long _failedRequestCount;
+        const long long _transferredBytes;
+        const long long _decodedBytes;
+        const std::map<int, long long> _statusCodeCounts;
+        std::vector<float> _timeToFirstByteSamples;
+        std::vector<float> _transferTimeSamples;
+    };
+
+}
+
+#endif
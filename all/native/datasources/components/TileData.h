@@ -10,6 +10,7 @@
 #include <chrono>
 #include <memory>
 #include <mutex>
+#include <string>
 #include <vector>
 
 namespace carto {
@@ -48,6 +49,28 @@ namespace carto {
          * @param flag True when the tile should be replaced with the parent, false otherwise.
          */
         void setReplaceWithParent(bool flag);
+
+        /**
+         * Returns the HTTP entity tag of the tile data, used for conditional revalidation.
+         * @return The entity tag of the tile data. Empty if not available.
+         */
+        std::string getETag() const;
+        /**
+         * Sets the HTTP entity tag of the tile data.
+         * @param etag The entity tag of the tile data.
+         */
+        void setETag(const std::string& etag);
+
+        /**
+         * Returns the HTTP last modification time of the tile data, used for conditional revalidation.
+         * @return The last modification time of the tile data in HTTP date format. Empty if not available.
+         */
+        std::string getLastModified() const;
+        /**
+         * Sets the HTTP last modification time of the tile data.
+         * @param lastModified The last modification time of the tile data in HTTP date format.
+         */
+        void setLastModified(const std::string& lastModified);
         
         /**
          * Returns tile data as binary data.
@@ -59,6 +82,8 @@ namespace carto {
         const std::shared_ptr<BinaryData> _data;
         std::shared_ptr<std::chrono::steady_clock::time_point> _expirationTime;
         bool _replaceWithParent;
+        std::string _etag;
+        std::string _lastModified;
         mutable std::mutex _mutex;
     };
 
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_GEOCODINGBATCHLISTENER_H_
+#define _CARTO_GEOCODINGBATCHLISTENER_H_
+
+#ifdef _CARTO_GEOCODING_SUPPORT
+
+#include <memory>
+#include <vector>
+
+namespace carto {
+    class GeocodingResult;
+
+    /**
+     * Listener for results of batch geocoding requests.
+     */
+    class GeocodingBatchListener {
+    public:
+        virtual ~GeocodingBatchListener() { }
+
+        /**
+         * Listener method that gets called for each request of the batch, as soon as its results are calculated.
+         * The requests are processed in parallel, so the results are not necessarily reported in the order of requests.
+         * This method is called from geocoding worker threads, but never concurrently.
+         * @param requestIndex The index of the request in the batch.
+         * @param results The list of matching geocoding results, sorted by descending ranks.
+         * @return True if the batch should continue, false if the rest of the batch should be canceled.
+         */
+        virtual bool onAddressesCalculated(int requestIndex, const std::vector<std::shared_ptr<GeocodingResult> >& results) = 0;
+    };
+    
+}
+
+#endif
+
+#endif
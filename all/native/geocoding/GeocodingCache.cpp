@@ -0,0 +1,35 @@
+#ifdef _CARTO_GEOCODING_SUPPORT
+
+#include "GeocodingCache.h"
+
+#include <geocoding/Geocoder.h>
+
+namespace carto {
+
+    GeocodingCache::GeocodingCache() :
+        _cache(MAX_CACHED_QUERIES),
+        _mutex()
+    {
+    }
+
+    GeocodingCache::~GeocodingCache() {
+    }
+
+    bool GeocodingCache::read(const std::string& key, std::shared_ptr<const AddressList>& addrs) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _cache.read(key, addrs);
+    }
+
+    void GeocodingCache::put(const std::string& key, const std::shared_ptr<const AddressList>& addrs) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _cache.put(key, addrs, 1);
+    }
+
+    void GeocodingCache::clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _cache.clear();
+    }
+
+}
+
+#endif
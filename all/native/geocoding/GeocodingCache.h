@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_GEOCODINGCACHE_H_
+#define _CARTO_GEOCODINGCACHE_H_
+
+#ifdef _CARTO_GEOCODING_SUPPORT
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <stdext/timed_lru_cache.h>
+
+namespace carto {
+    namespace geocoding {
+        struct Address;
+    }
+
+    /**
+     * Cache of recent geocoding query results, keyed by the query string and search options.
+     * Used to answer repeated autocomplete queries (for example after deleting characters) without running the geocoder again.
+     * The cache must be cleared when the geocoder or its settings change.
+     */
+    class GeocodingCache {
+    public:
+        typedef std::vector<std::pair<geocoding::Address, float> > AddressList;
+
+        GeocodingCache();
+        virtual ~GeocodingCache();
+
+        bool read(const std::string& key, std::shared_ptr<const AddressList>& addrs) const;
+        void put(const std::string& key, const std::shared_ptr<const AddressList>& addrs);
+
+        void clear();
+
+    private:
+        static const int MAX_CACHED_QUERIES = 64;
+
+        mutable cache::timed_lru_cache<std::string, std::shared_ptr<const AddressList> > _cache;
+
+        mutable std::mutex _mutex;
+    };
+    
+}
+
+#endif
+
+#endif
@@ -9,6 +9,9 @@
 #include "geometry/LineGeometry.h"
 #include "geometry/PolygonGeometry.h"
 #include "geometry/MultiGeometry.h"
+#include "geocoding/GeocodingBatchListener.h"
+#include "geocoding/GeocodingCache.h"
+#include "geocoding/ReverseGeocodingCache.h"
 #include "projections/Projection.h"
 #include "projections/EPSG3857.h"
 #include "utils/Const.h"
@@ -16,8 +19,15 @@
 #include <geocoding/Geocoder.h>
 #include <geocoding/RevGeocoder.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <exception>
 #include <functional>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
 
 namespace {
 
@@ -30,11 +40,66 @@ namespace {
 
 namespace carto {
 
-    std::vector<std::shared_ptr<GeocodingResult> > GeocodingProxy::CalculateAddresses(const std::shared_ptr<geocoding::Geocoder>& geocoder, const std::shared_ptr<GeocodingRequest>& request) {
+    std::vector<std::shared_ptr<GeocodingResult> > GeocodingProxy::CalculateAddresses(const std::shared_ptr<geocoding::Geocoder>& geocoder, const std::shared_ptr<GeocodingCache>& cache, const std::shared_ptr<GeocodingRequest>& request) {
+        return CalculateAddresses(std::vector<std::shared_ptr<geocoding::Geocoder> > { geocoder }, cache, request);
+    }
+
+    std::vector<std::shared_ptr<GeocodingResult> > GeocodingProxy::CalculateAddresses(const std::vector<std::shared_ptr<geocoding::Geocoder> >& geocoders, const std::shared_ptr<GeocodingCache>& cache, const std::shared_ptr<GeocodingRequest>& request) {
+        return CalculateAddresses(geocoders, cache, request, MAX_WORKER_THREADS);
+    }
+
+    void GeocodingProxy::CalculateAddressesBatch(const std::vector<std::shared_ptr<geocoding::Geocoder> >& geocoders, const std::shared_ptr<GeocodingCache>& cache, const std::vector<std::shared_ptr<GeocodingRequest> >& requests, const std::shared_ptr<GeocodingBatchListener>& listener) {
+        // Process the requests in parallel. Each request queries the geocoders sequentially, as the workers are already busy with other requests
+        std::atomic<std::size_t> nextRequestIndex(0);
+        std::atomic<bool> finished(false);
+        std::exception_ptr workerException;
+        std::mutex listenerMutex;
+
+        auto calculateAddresses = [&]() {
+            try {
+                for (std::size_t index = nextRequestIndex++; index < requests.size() && !finished; index = nextRequestIndex++) {
+                    std::vector<std::shared_ptr<GeocodingResult> > results = CalculateAddresses(geocoders, cache, requests[index], 1);
+
+                    std::lock_guard<std::mutex> lock(listenerMutex);
+                    if (finished) {
+                        break;
+                    }
+                    if (!listener->onAddressesCalculated(static_cast<int>(index), results)) {
+                        finished = true;
+                    }
+                }
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lock(listenerMutex);
+                if (!workerException) {
+                    workerException = std::current_exception();
+                }
+                finished = true;
+            }
+        };
+
+        std::size_t workerCount = std::min(requests.size(), static_cast<std::size_t>(std::max(1, std::min(static_cast<int>(std::thread::hardware_concurrency()), MAX_WORKER_THREADS))));
+        std::vector<std::thread> workers;
+        for (std::size_t i = 1; i < workerCount; i++) {
+            workers.emplace_back(calculateAddresses);
+        }
+        calculateAddresses();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        if (workerException) {
+            std::rethrow_exception(workerException);
+        }
+    }
+
+    std::vector<std::shared_ptr<GeocodingResult> > GeocodingProxy::CalculateAddresses(const std::vector<std::shared_ptr<geocoding::Geocoder> >& geocoders, const std::shared_ptr<GeocodingCache>& cache, const std::shared_ptr<GeocodingRequest>& request, int maxWorkerCount) {
+        std::stringstream keyStream;
+        keyStream << std::setiosflags(std::ios::fixed) << std::setprecision(5) << request->getQuery();
         geocoding::Geocoder::Options options;
         if (request->isLocationDefined()) {
             MapPos wgs84Center = request->getProjection()->toWgs84(request->getLocation());
             options.location = cglib::vec2<double>(wgs84Center.getX(), wgs84Center.getY());
+            keyStream << "|" << wgs84Center.getX() << "," << wgs84Center.getY();
         }
         if (request->getLocationRadius() > 0) {
             EPSG3857 epsg3857;
@@ -47,19 +112,83 @@ namespace carto {
             MapPos wgs84Pos0 = epsg3857.toWgs84(mercPos0);
             MapPos wgs84Pos1 = epsg3857.toWgs84(mercPos1);
             options.bounds = cglib::bbox2<double>(cglib::vec2<double>(wgs84Pos0.getX(), wgs84Pos0.getY()), cglib::vec2<double>(wgs84Pos1.getX(), wgs84Pos1.getY()));
+            keyStream << "|" << request->getLocationRadius();
+        }
+
+        // Autocomplete queries are often repeated while editing the query, so check the cache first
+        std::shared_ptr<const GeocodingCache::AddressList> addrs;
+        if (!cache || !cache->read(keyStream.str(), addrs)) {
+            // Query the geocoders in parallel. Each worker takes the next unprocessed geocoder, results are collected in the original order
+            std::vector<GeocodingCache::AddressList> geocoderAddrs(geocoders.size());
+            std::atomic<std::size_t> nextGeocoderIndex(0);
+            std::exception_ptr workerException;
+            std::mutex exceptionMutex;
+
+            auto findAddresses = [&]() {
+                try {
+                    for (std::size_t index = nextGeocoderIndex++; index < geocoders.size(); index = nextGeocoderIndex++) {
+                        geocoderAddrs[index] = geocoders[index]->findAddresses(request->getQuery(), options);
+                    }
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(exceptionMutex);
+                    if (!workerException) {
+                        workerException = std::current_exception();
+                    }
+                    nextGeocoderIndex = geocoders.size();
+                }
+            };
+
+            std::size_t workerCount = std::min(geocoders.size(), static_cast<std::size_t>(std::max(1, std::min(static_cast<int>(std::thread::hardware_concurrency()), maxWorkerCount))));
+            std::vector<std::thread> workers;
+            for (std::size_t i = 1; i < workerCount; i++) {
+                workers.emplace_back(findAddresses);
+            }
+            findAddresses();
+            for (std::thread& worker : workers) {
+                worker.join();
+            }
+            if (workerException) {
+                std::rethrow_exception(workerException);
+            }
+
+            // Merge the results by rank. Keep the result count within the limit of a single geocoder
+            auto mergedAddrs = std::make_shared<GeocodingCache::AddressList>();
+            std::size_t maxResults = 0;
+            for (const GeocodingCache::AddressList& addrs1 : geocoderAddrs) {
+                mergedAddrs->insert(mergedAddrs->end(), addrs1.begin(), addrs1.end());
+                maxResults = std::max(maxResults, addrs1.size());
+            }
+            if (geocoderAddrs.size() > 1) {
+                std::stable_sort(mergedAddrs->begin(), mergedAddrs->end(), [](const std::pair<geocoding::Address, float>& addr1, const std::pair<geocoding::Address, float>& addr2) {
+                    return addr1.second > addr2.second;
+                });
+                if (mergedAddrs->size() > maxResults) {
+                    mergedAddrs->erase(mergedAddrs->begin() + maxResults, mergedAddrs->end());
+                }
+            }
+            addrs = mergedAddrs;
+            if (cache) {
+                cache->put(keyStream.str(), addrs);
+            }
         }
-        std::vector<std::pair<geocoding::Address, float> > addrs = geocoder->findAddresses(request->getQuery(), options);
 
         std::vector<std::shared_ptr<GeocodingResult> > results;
-        for (const std::pair<geocoding::Address, float>& addr : addrs) {
+        results.reserve(addrs->size());
+        for (const std::pair<geocoding::Address, float>& addr : *addrs) {
             results.push_back(TranslateAddress(request->getProjection(), addr.first, addr.second));
         }
         return results;
     }
 
-    std::vector<std::shared_ptr<GeocodingResult> > GeocodingProxy::CalculateAddresses(const std::shared_ptr<geocoding::RevGeocoder>& revGeocoder, const std::shared_ptr<ReverseGeocodingRequest>& request) {
+    std::vector<std::shared_ptr<GeocodingResult> > GeocodingProxy::CalculateAddresses(const std::shared_ptr<geocoding::RevGeocoder>& revGeocoder, const std::shared_ptr<ReverseGeocodingCache>& cache, const std::shared_ptr<ReverseGeocodingRequest>& request) {
         MapPos posWgs84 = request->getProjection()->toWgs84(request->getLocation());
-        std::vector<std::pair<geocoding::Address, float> > addrs = revGeocoder->findAddresses(posWgs84.getX(), posWgs84.getY(), request->getSearchRadius());
+        std::vector<std::pair<geocoding::Address, float> > addrs;
+        if (cache) {
+            addrs = cache->findAddresses(*revGeocoder, posWgs84.getX(), posWgs84.getY(), request->getSearchRadius());
+        } else {
+            addrs = revGeocoder->findAddresses(posWgs84.getX(), posWgs84.getY(), request->getSearchRadius());
+        }
 
         std::vector<std::shared_ptr<GeocodingResult> > results;
         for (const std::pair<geocoding::Address, float>& addr : addrs) {
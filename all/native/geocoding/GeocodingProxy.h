@@ -27,21 +27,32 @@ namespace carto {
     class Geometry;
     class Feature;
     class FeatureCollection;
+    class GeocodingBatchListener;
+    class GeocodingCache;
+    class ReverseGeocodingCache;
     
     class GeocodingProxy {
     public:
-        static std::vector<std::shared_ptr<GeocodingResult> > CalculateAddresses(const std::shared_ptr<geocoding::Geocoder>& geocoder, const std::shared_ptr<GeocodingRequest>& request);
+        static std::vector<std::shared_ptr<GeocodingResult> > CalculateAddresses(const std::shared_ptr<geocoding::Geocoder>& geocoder, const std::shared_ptr<GeocodingCache>& cache, const std::shared_ptr<GeocodingRequest>& request);
 
-        static std::vector<std::shared_ptr<GeocodingResult> > CalculateAddresses(const std::shared_ptr<geocoding::RevGeocoder>& revGeocoder, const std::shared_ptr<ReverseGeocodingRequest>& request);
+        static std::vector<std::shared_ptr<GeocodingResult> > CalculateAddresses(const std::vector<std::shared_ptr<geocoding::Geocoder> >& geocoders, const std::shared_ptr<GeocodingCache>& cache, const std::shared_ptr<GeocodingRequest>& request);
+
+        static void CalculateAddressesBatch(const std::vector<std::shared_ptr<geocoding::Geocoder> >& geocoders, const std::shared_ptr<GeocodingCache>& cache, const std::vector<std::shared_ptr<GeocodingRequest> >& requests, const std::shared_ptr<GeocodingBatchListener>& listener);
+
+        static std::vector<std::shared_ptr<GeocodingResult> > CalculateAddresses(const std::shared_ptr<geocoding::RevGeocoder>& revGeocoder, const std::shared_ptr<ReverseGeocodingCache>& cache, const std::shared_ptr<ReverseGeocodingRequest>& request);
 
     private:
         GeocodingProxy();
 
+        static std::vector<std::shared_ptr<GeocodingResult> > CalculateAddresses(const std::vector<std::shared_ptr<geocoding::Geocoder> >& geocoders, const std::shared_ptr<GeocodingCache>& cache, const std::shared_ptr<GeocodingRequest>& request, int maxWorkerCount);
+
         static std::shared_ptr<GeocodingResult> TranslateAddress(const std::shared_ptr<Projection>& proj, const geocoding::Address& addr, float rank);
 
         static std::shared_ptr<Feature> TranslateFeature(const std::shared_ptr<Projection>& proj, const geocoding::Feature& feature);
 
         static std::shared_ptr<Geometry> TranslateGeometry(const std::shared_ptr<Projection>& proj, const std::shared_ptr<geocoding::Geometry>& geom);
+
+        static const int MAX_WORKER_THREADS = 4;
     };
     
 }
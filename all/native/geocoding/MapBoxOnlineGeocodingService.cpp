@@ -1,9 +1,9 @@
 #if defined(_CARTO_GEOCODING_SUPPORT)
 
 #include "MapBoxOnlineGeocodingService.h"
-#include "core/BinaryData.h"
 #include "components/Exceptions.h"
 #include "geocoding/MapBoxGeocodingProxy.h"
+#include "geocoding/OnlineGeocodingRequestManager.h"
 #include "projections/Projection.h"
 #include "projections/EPSG3857.h"
 #include "utils/Const.h"
@@ -22,6 +22,7 @@ namespace carto {
         _autocomplete(false),
         _language(),
         _serviceURL(),
+        _requestManager(std::make_shared<OnlineGeocodingRequestManager>()),
         _mutex()
     {
     }
@@ -64,18 +65,22 @@ namespace carto {
             throw NullArgumentException("Null request");
         }
 
-        if (request->getQuery().empty()) {
+        std::string query = OnlineGeocodingRequestManager::NormalizeQuery(request->getQuery());
+        if (query.empty()) {
             return std::vector<std::shared_ptr<GeocodingResult> >();
         }
 
         std::string baseURL;
+        bool autocomplete = false;
 
         std::map<std::string, std::string> params;
         {
             std::lock_guard<std::mutex> lock(_mutex);
 
+            autocomplete = _autocomplete;
+
             std::map<std::string, std::string> tagMap;
-            tagMap["query"] = NetworkUtils::URLEncode(request->getQuery());
+            tagMap["query"] = NetworkUtils::URLEncode(query);
             tagMap["access_token"] = NetworkUtils::URLEncode(_accessToken);
 
             baseURL = GeneralUtils::ReplaceTags(_serviceURL.empty() ? MAPBOX_SERVICE_URL : _serviceURL, tagMap);
@@ -88,7 +93,7 @@ namespace carto {
 
         if (request->isLocationDefined()) {
             MapPos wgs84Center = request->getProjection()->toWgs84(request->getLocation());
-            params["proximity"] = boost::lexical_cast<std::string>(wgs84Center.getX()) + "," + boost::lexical_cast<std::string>(wgs84Center.getY());
+            params["proximity"] = boost::lexical_cast<std::string>(OnlineGeocodingRequestManager::QuantizeCoordinate(wgs84Center.getX())) + "," + boost::lexical_cast<std::string>(OnlineGeocodingRequestManager::QuantizeCoordinate(wgs84Center.getY()));
         }
         if (request->getLocationRadius() > 0) {
             EPSG3857 epsg3857;
@@ -106,19 +111,10 @@ namespace carto {
         std::string url = NetworkUtils::BuildURLFromParameters(baseURL, params);
         Log::Debugf("MapBoxOnlineGeocodingService::calculateAddresses: Loading %s", url.c_str());
 
-        std::shared_ptr<BinaryData> responseData;
-        if (!NetworkUtils::GetHTTP(url, responseData, Log::IsShowDebug())) {
-            throw NetworkException("Failed to fetch response");
-        }
-
-        std::string responseString;
-        if (responseData) {
-            responseString = std::string(reinterpret_cast<const char*>(responseData->data()), responseData->size());
-        } else {
-            throw GenericException("Empty response");
-        }
-
-        return MapBoxGeocodingProxy::ReadResponse(responseString, request->getProjection());
+        std::shared_ptr<Projection> projection = request->getProjection();
+        return _requestManager->calculateAddresses(url, autocomplete, [&projection](const std::string& responseString) {
+            return MapBoxGeocodingProxy::ReadResponse(responseString, projection);
+        });
     }
 
     const std::string MapBoxOnlineGeocodingService::MAPBOX_SERVICE_URL = "https://api.mapbox.com/geocoding/v5/mapbox.places-permanent/{query}.json?access_token={access_token}";
@@ -12,6 +12,7 @@
 #include "geocoding/GeocodingService.h"
 
 namespace carto {
+    class OnlineGeocodingRequestManager;
 
     /**
      * An online geocoding service that uses MapBox geocoder.
@@ -37,7 +38,8 @@ namespace carto {
         bool isAutocomplete() const;
         /**
          * Sets the autocomplete flag of the service.
-         * By default this flag is off.
+         * By default this flag is off. In autocomplete mode, concurrent requests are debounced
+         * and a request superseded by a newer one returns an empty result list.
          * @param autocomplete The new value for autocomplete flag.
          */
         void setAutocomplete(bool autocomplete);
@@ -78,6 +80,8 @@ namespace carto {
 
         std::string _serviceURL;
 
+        std::shared_ptr<OnlineGeocodingRequestManager> _requestManager;
+
         mutable std::mutex _mutex;
     };
     
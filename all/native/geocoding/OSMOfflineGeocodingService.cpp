@@ -2,16 +2,20 @@
 
 #include "OSMOfflineGeocodingService.h"
 #include "components/Exceptions.h"
+#include "geocoding/GeocodingCache.h"
 #include "geocoding/GeocodingProxy.h"
 
 #include <geocoding/Geocoder.h>
 
+#include <algorithm>
+
 #include <sqlite3pp.h>
 
 namespace carto {
 
     OSMOfflineGeocodingService::OSMOfflineGeocodingService(const std::string& path) :
-        _geocoder()
+        _geocoder(),
+        _queryCache(std::make_shared<GeocodingCache>())
     {
         auto database = std::make_shared<sqlite3pp::database>();
         if (database->connect_v2(path.c_str(), SQLITE_OPEN_READONLY) != SQLITE_OK) {
@@ -32,6 +36,7 @@ namespace carto {
 
     void OSMOfflineGeocodingService::setAutocomplete(bool autocomplete) {
         _geocoder->setAutocomplete(autocomplete);
+        _queryCache->clear();
     }
 
     std::string OSMOfflineGeocodingService::getLanguage() const {
@@ -40,6 +45,7 @@ namespace carto {
 
     void OSMOfflineGeocodingService::setLanguage(const std::string& lang) {
         _geocoder->setLanguage(lang);
+        _queryCache->clear();
     }
 
     std::vector<std::shared_ptr<GeocodingResult> > OSMOfflineGeocodingService::calculateAddresses(const std::shared_ptr<GeocodingRequest>& request) const {
@@ -47,7 +53,18 @@ namespace carto {
             throw NullArgumentException("Null request");
         }
 
-        return GeocodingProxy::CalculateAddresses(_geocoder, request);
+        return GeocodingProxy::CalculateAddresses(_geocoder, _queryCache, request);
+    }
+
+    void OSMOfflineGeocodingService::calculateAddressesBatch(const std::vector<std::shared_ptr<GeocodingRequest> >& requests, const std::shared_ptr<GeocodingBatchListener>& listener) const {
+        if (std::find(requests.begin(), requests.end(), std::shared_ptr<GeocodingRequest>()) != requests.end()) {
+            throw NullArgumentException("Null request");
+        }
+        if (!listener) {
+            throw NullArgumentException("Null listener");
+        }
+
+        GeocodingProxy::CalculateAddressesBatch(std::vector<std::shared_ptr<geocoding::Geocoder> > { _geocoder }, _queryCache, requests, listener);
     }
     
 }
@@ -16,6 +16,9 @@ namespace carto {
         class Geocoder;
     }
 
+    class GeocodingBatchListener;
+    class GeocodingCache;
+
     /**
      * A geocoding service that uses custom geocoding database files.
      * Note: this class is experimental and may change or even be removed in future SDK versions.
@@ -55,8 +58,19 @@ namespace carto {
 
         virtual std::vector<std::shared_ptr<GeocodingResult> > calculateAddresses(const std::shared_ptr<GeocodingRequest>& request) const;
 
+        /**
+         * Calculates matching addresses for a batch of geocoding requests.
+         * The requests are processed in parallel and the results of each request are reported to the listener as soon as they are available.
+         * This is more efficient than calling calculateAddresses for each request separately.
+         * @param requests The list of geocoding requests to use.
+         * @param listener The listener to call with the results of each request.
+         * @throws std::runtime_error If IO error occured during the calculation.
+         */
+        void calculateAddressesBatch(const std::vector<std::shared_ptr<GeocodingRequest> >& requests, const std::shared_ptr<GeocodingBatchListener>& listener) const;
+
     protected:
         std::shared_ptr<geocoding::Geocoder> _geocoder;
+        std::shared_ptr<GeocodingCache> _queryCache;
     };
     
 }
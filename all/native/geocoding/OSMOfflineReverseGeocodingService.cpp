@@ -3,6 +3,7 @@
 #include "OSMOfflineReverseGeocodingService.h"
 #include "components/Exceptions.h"
 #include "geocoding/GeocodingProxy.h"
+#include "geocoding/ReverseGeocodingCache.h"
 
 #include <geocoding/RevGeocoder.h>
 
@@ -11,7 +12,8 @@
 namespace carto {
 
     OSMOfflineReverseGeocodingService::OSMOfflineReverseGeocodingService(const std::string& path) :
-        _revGeocoder()
+        _revGeocoder(),
+        _addressCache(std::make_shared<ReverseGeocodingCache>())
     {
         auto database = std::make_shared<sqlite3pp::database>();
         if (database->connect_v2(path.c_str(), SQLITE_OPEN_READONLY) != SQLITE_OK) {
@@ -32,6 +34,7 @@ namespace carto {
 
     void OSMOfflineReverseGeocodingService::setLanguage(const std::string& lang) {
         _revGeocoder->setLanguage(lang);
+        _addressCache->clear();
     }
 
     std::vector<std::shared_ptr<GeocodingResult> > OSMOfflineReverseGeocodingService::calculateAddresses(const std::shared_ptr<ReverseGeocodingRequest>& request) const {
@@ -39,7 +42,7 @@ namespace carto {
             throw NullArgumentException("Null request");
         }
 
-        return GeocodingProxy::CalculateAddresses(_revGeocoder, request);
+        return GeocodingProxy::CalculateAddresses(_revGeocoder, _addressCache, request);
     }
     
 }
@@ -16,6 +16,8 @@ namespace carto {
         class RevGeocoder;
     }
 
+    class ReverseGeocodingCache;
+
     /**
      * A reverse geocoding service that uses custom geocoding database files.
      * Note: this class is experimental and may change or even be removed in future SDK versions.
@@ -45,6 +47,7 @@ namespace carto {
 
     protected:
         std::shared_ptr<geocoding::RevGeocoder> _revGeocoder;
+        std::shared_ptr<ReverseGeocodingCache> _addressCache;
     };
     
 }
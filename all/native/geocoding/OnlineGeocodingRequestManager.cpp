@@ -0,0 +1,183 @@
+#ifdef _CARTO_GEOCODING_SUPPORT
+
+#include "OnlineGeocodingRequestManager.h"
+#include "components/Exceptions.h"
+#include "geocoding/GeocodingResult.h"
+#include "utils/NetworkUtils.h"
+#include "utils/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cmath>
+
+namespace carto {
+
+    OnlineGeocodingRequestManager::OnlineGeocodingRequestManager() :
+        _cache(MAX_CACHED_RESPONSES),
+        _pendingRequests(),
+        _autocompleteGeneration(0),
+        _mutex(),
+        _condition()
+    {
+    }
+
+    OnlineGeocodingRequestManager::~OnlineGeocodingRequestManager() {
+    }
+
+    OnlineGeocodingRequestManager::ResultList OnlineGeocodingRequestManager::calculateAddresses(const std::string& url, bool autocomplete, const ResponseParser& parser) {
+        std::shared_ptr<Request> request;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+
+            std::shared_ptr<const ResultList> results;
+            if (_cache.exists(url) && _cache.valid(url) && _cache.read(url, results)) {
+                return *results;
+            }
+
+            // Wait until typing pauses. If a newer autocomplete request arrives meanwhile, this request is dropped without sending it
+            unsigned int generation = 0;
+            if (autocomplete) {
+                generation = ++_autocompleteGeneration;
+                _condition.notify_all();
+                if (_condition.wait_for(lock, std::chrono::milliseconds(AUTOCOMPLETE_DEBOUNCE_TIME), [this, generation]() { return isSuperseded(generation); })) {
+                    return ResultList();
+                }
+            }
+
+            // Attach to an identical request in progress instead of sending a new one
+            while (true) {
+                if (_cache.exists(url) && _cache.valid(url) && _cache.read(url, results)) {
+                    return *results;
+                }
+
+                auto it = _pendingRequests.find(url);
+                if (it == _pendingRequests.end() || it->second->canceled) {
+                    break;
+                }
+                std::shared_ptr<Request> pendingRequest = it->second;
+                if (autocomplete) {
+                    pendingRequest->generation = std::max(pendingRequest->generation, generation);
+                } else {
+                    pendingRequest->cancelable = false;
+                }
+                _condition.wait(lock, [&pendingRequest]() { return pendingRequest->finished; });
+
+                // The request can be canceled only if all the attached requests were superseded
+                if (pendingRequest->canceled) {
+                    return ResultList();
+                }
+                if (pendingRequest->exception) {
+                    std::rethrow_exception(pendingRequest->exception);
+                }
+                return *pendingRequest->results;
+            }
+
+            request = std::make_shared<Request>();
+            request->cancelable = autocomplete;
+            request->generation = generation;
+            request->finished = false;
+            request->canceled = false;
+            _pendingRequests[url] = request;
+        }
+
+        // Download the response, abort the download if the request gets superseded
+        std::string responseString;
+        std::map<std::string, std::string> requestHeaders;
+        std::map<std::string, std::string> responseHeaders;
+        int code = NetworkUtils::StreamHTTPResponse("GET", url, requestHeaders, responseHeaders, [this, &request, &responseString](std::uint64_t offset, std::uint64_t length, const unsigned char* buf, std::size_t size) -> bool {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (request->cancelable && isSuperseded(request->generation)) {
+                    request->canceled = true;
+                    return false;
+                }
+            }
+            if (responseString.size() != offset) {
+                responseString.resize(static_cast<std::size_t>(offset));
+            }
+            responseString.append(reinterpret_cast<const char*>(buf), size);
+            return true;
+        }, 0, Log::IsShowDebug());
+
+        bool canceled = false;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            canceled = request->canceled;
+        }
+
+        // Parse the response outside of the lock, stale responses are not parsed at all
+        std::shared_ptr<const ResultList> results;
+        std::exception_ptr exception;
+        if (!canceled) {
+            try {
+                if (code != 0) {
+                    throw NetworkException("Failed to fetch response");
+                }
+                results = std::make_shared<ResultList>(parser(responseString));
+            }
+            catch (...) {
+                exception = std::current_exception();
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            request->finished = true;
+            request->results = results;
+            request->exception = exception;
+
+            auto it = _pendingRequests.find(url);
+            if (it != _pendingRequests.end() && it->second == request) {
+                _pendingRequests.erase(it);
+            }
+
+            if (results) {
+                _cache.put(url, results, 1);
+                _cache.invalidate(url, std::chrono::steady_clock::now() + std::chrono::seconds(RESPONSE_CACHE_TIME));
+            }
+            _condition.notify_all();
+        }
+
+        if (canceled) {
+            return ResultList();
+        }
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+        return *results;
+    }
+
+    std::string OnlineGeocodingRequestManager::NormalizeQuery(const std::string& query) {
+        // Trim the query and collapse whitespace, so that trivially different queries share the cached responses
+        std::string normalizedQuery;
+        normalizedQuery.reserve(query.size());
+        bool space = false;
+        for (char c : query) {
+            if (std::isspace(static_cast<unsigned char>(c))) {
+                space = !normalizedQuery.empty();
+                continue;
+            }
+            if (space) {
+                normalizedQuery += ' ';
+                space = false;
+            }
+            normalizedQuery += c;
+        }
+        return normalizedQuery;
+    }
+
+    double OnlineGeocodingRequestManager::QuantizeCoordinate(double coord) {
+        return std::round(coord / COORDINATE_PRECISION) * COORDINATE_PRECISION;
+    }
+
+    bool OnlineGeocodingRequestManager::isSuperseded(unsigned int generation) const {
+        return generation < _autocompleteGeneration;
+    }
+
+    const double OnlineGeocodingRequestManager::COORDINATE_PRECISION = 1.0e-4;
+    
+}
+
+#endif
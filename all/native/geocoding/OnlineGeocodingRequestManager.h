@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_ONLINEGEOCODINGREQUESTMANAGER_H_
+#define _CARTO_ONLINEGEOCODINGREQUESTMANAGER_H_
+
+#ifdef _CARTO_GEOCODING_SUPPORT
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <stdext/timed_lru_cache.h>
+
+namespace carto {
+    class GeocodingResult;
+
+    /**
+     * Request front end shared by the online geocoding services.
+     * Parsed responses are cached by the request URL, which contains the normalized query and the quantized focus point.
+     * Concurrent identical requests are coalesced into a single network request. Autocomplete requests are debounced
+     * and requests superseded by newer autocomplete requests are canceled, including the downloads already in progress.
+     */
+    class OnlineGeocodingRequestManager {
+    public:
+        typedef std::vector<std::shared_ptr<GeocodingResult> > ResultList;
+        typedef std::function<ResultList(const std::string&)> ResponseParser;
+
+        OnlineGeocodingRequestManager();
+        virtual ~OnlineGeocodingRequestManager();
+
+        ResultList calculateAddresses(const std::string& url, bool autocomplete, const ResponseParser& parser);
+
+        static std::string NormalizeQuery(const std::string& query);
+        static double QuantizeCoordinate(double coord);
+
+    private:
+        struct Request {
+            bool cancelable; // false if any of the waiting requests is not an autocomplete request
+            unsigned int generation; // the latest autocomplete generation waiting for the result
+            bool finished;
+            bool canceled;
+            std::shared_ptr<const ResultList> results;
+            std::exception_ptr exception;
+        };
+
+        bool isSuperseded(unsigned int generation) const;
+
+        static const int MAX_CACHED_RESPONSES = 64;
+        static const int RESPONSE_CACHE_TIME = 600; // in seconds
+        static const int AUTOCOMPLETE_DEBOUNCE_TIME = 150; // in milliseconds
+        static const double COORDINATE_PRECISION; // in degrees
+
+        cache::timed_lru_cache<std::string, std::shared_ptr<const ResultList> > _cache;
+        std::map<std::string, std::shared_ptr<Request> > _pendingRequests;
+        unsigned int _autocompleteGeneration;
+
+        mutable std::mutex _mutex;
+        std::condition_variable _condition;
+    };
+
+}
+
+#endif
+
+#endif
@@ -2,12 +2,15 @@
 
 #include "PackageManagerGeocodingService.h"
 #include "components/Exceptions.h"
+#include "geocoding/GeocodingCache.h"
 #include "geocoding/GeocodingProxy.h"
 #include "packagemanager/PackageInfo.h"
 #include "packagemanager/handlers/GeocodingPackageHandler.h"
 
 #include <geocoding/Geocoder.h>
 
+#include <algorithm>
+
 #include <sqlite3pp.h>
 
 namespace carto {
@@ -16,21 +19,17 @@ namespace carto {
         _packageManager(packageManager),
         _autocomplete(false),
         _language(),
-        _cachedPackageDatabaseMap(),
-        _cachedGeocoder(),
+        _cachedPackageVersionMap(),
+        _cachedGeocoderMap(),
+        _queryCache(std::make_shared<GeocodingCache>()),
         _mutex()
     {
         if (!packageManager) {
             throw NullArgumentException("Null packageManager");
         }
-
-        _packageManagerListener = std::make_shared<PackageManagerListener>(*this);
-        _packageManager->registerOnChangeListener(_packageManagerListener);
     }
 
     PackageManagerGeocodingService::~PackageManagerGeocodingService() {
-        _packageManager->unregisterOnChangeListener(_packageManagerListener);
-        _packageManagerListener.reset();
     }
 
     bool PackageManagerGeocodingService::isAutocomplete() const {
@@ -42,7 +41,10 @@ namespace carto {
         std::lock_guard<std::mutex> lock(_mutex);
         if (autocomplete != _autocomplete) {
             _autocomplete = autocomplete;
-            _cachedGeocoder.reset();
+            for (auto it = _cachedGeocoderMap.begin(); it != _cachedGeocoderMap.end(); it++) {
+                it->second->setAutocomplete(autocomplete);
+            }
+            _queryCache->clear();
         }
     }
 
@@ -55,7 +57,10 @@ namespace carto {
         std::lock_guard<std::mutex> lock(_mutex);
         if (lang != _language) {
             _language = lang;
-            _cachedGeocoder.reset();
+            for (auto it = _cachedGeocoderMap.begin(); it != _cachedGeocoderMap.end(); it++) {
+                it->second->setLanguage(lang);
+            }
+            _queryCache->clear();
         }
     }
 
@@ -64,55 +69,77 @@ namespace carto {
             throw NullArgumentException("Null request");
         }
 
-        // Do routing via package manager, so that all packages are locked during routing
-        std::vector<std::shared_ptr<GeocodingResult> > results;
-        _packageManager->accessLocalPackages([this, &results, &request](const std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<PackageHandler> >& packageHandlerMap) {
-            // Build map of geocoding databases
-            std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<sqlite3pp::database> > packageDatabaseMap;
+        return GeocodingProxy::CalculateAddresses(getGeocoders(), _queryCache, request);
+    }
+
+    void PackageManagerGeocodingService::calculateAddressesBatch(const std::vector<std::shared_ptr<GeocodingRequest> >& requests, const std::shared_ptr<GeocodingBatchListener>& listener) const {
+        if (std::find(requests.begin(), requests.end(), std::shared_ptr<GeocodingRequest>()) != requests.end()) {
+            throw NullArgumentException("Null request");
+        }
+        if (!listener) {
+            throw NullArgumentException("Null listener");
+        }
+
+        // The geocoders are updated once for the whole batch
+        GeocodingProxy::CalculateAddressesBatch(getGeocoders(), _queryCache, requests, listener);
+    }
+
+    std::vector<std::shared_ptr<geocoding::Geocoder> > PackageManagerGeocodingService::getGeocoders() const {
+        // Update the geocoders via package manager, so that all packages are locked during the update.
+        // The geocoders keep their databases open, so the query itself does not need the package manager lock
+        std::vector<std::shared_ptr<geocoding::Geocoder> > geocoders;
+        _packageManager->accessLocalPackages([this, &geocoders](const std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<PackageHandler> >& packageHandlerMap) {
+            // Build map of geocoding packages and their versions. Package handlers are recreated after any package change, so databases are not compared directly
+            std::map<std::string, int> packageVersionMap;
+            std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<GeocodingPackageHandler> > geocodingHandlerMap;
             for (auto it = packageHandlerMap.begin(); it != packageHandlerMap.end(); it++) {
                 if (auto geocodingHandler = std::dynamic_pointer_cast<GeocodingPackageHandler>(it->second)) {
-                    packageDatabaseMap[it->first] = geocodingHandler->getGeocodingDatabase();
+                    packageVersionMap[it->first->getPackageId()] = it->first->getVersion();
+                    geocodingHandlerMap[it->first] = geocodingHandler;
                 }
             }
 
-            // Now check if we have to reinitialize the geocoder
+            // Now check if we have to update the geocoders. Each package has its own geocoder, so only the new or updated packages are imported
             std::lock_guard<std::mutex> lock(_mutex);
-            if (!_cachedGeocoder || packageDatabaseMap != _cachedPackageDatabaseMap) {
-                auto geocoder = std::make_shared<geocoding::Geocoder>();
-                geocoder->setAutocomplete(_autocomplete);
-                geocoder->setLanguage(_language);
-                for (auto it = packageDatabaseMap.begin(); it != packageDatabaseMap.end(); it++) {
+            if (packageVersionMap != _cachedPackageVersionMap) {
+                for (auto it = _cachedPackageVersionMap.begin(); it != _cachedPackageVersionMap.end(); ) {
+                    auto it2 = packageVersionMap.find(it->first);
+                    if (it2 == packageVersionMap.end() || it2->second != it->second) {
+                        _cachedGeocoderMap.erase(it->first);
+                        it = _cachedPackageVersionMap.erase(it);
+                    } else {
+                        it++;
+                    }
+                }
+                _queryCache->clear();
+
+                for (auto it = geocodingHandlerMap.begin(); it != geocodingHandlerMap.end(); it++) {
+                    const std::string& packageId = it->first->getPackageId();
+                    if (_cachedPackageVersionMap.find(packageId) != _cachedPackageVersionMap.end()) {
+                        continue;
+                    }
                     try {
-                        if (!geocoder->import(it->second)) {
-                            throw FileException("Failed to import geocoding database " + it->first->getPackageId(), "");
+                        auto geocoder = std::make_shared<geocoding::Geocoder>();
+                        geocoder->setAutocomplete(_autocomplete);
+                        geocoder->setLanguage(_language);
+                        if (!geocoder->import(it->second->getGeocodingDatabase())) {
+                            throw FileException("Failed to import geocoding database " + packageId, "");
                         }
+                        _cachedGeocoderMap[packageId] = geocoder;
+                        _cachedPackageVersionMap[packageId] = it->first->getVersion();
                     }
                     catch (const std::exception& ex) {
-                        throw GenericException("Exception while importing geocoding database " + it->first->getPackageId(), ex.what());
+                        throw GenericException("Exception while importing geocoding database " + packageId, ex.what());
                     }
                 }
-                _cachedPackageDatabaseMap = packageDatabaseMap;
-                _cachedGeocoder = geocoder;
             }
 
-            results = GeocodingProxy::CalculateAddresses(_cachedGeocoder, request);
+            geocoders.reserve(_cachedGeocoderMap.size());
+            for (auto it = _cachedGeocoderMap.begin(); it != _cachedGeocoderMap.end(); it++) {
+                geocoders.push_back(it->second);
+            }
         });
-        return results;
-    }
-    
-    PackageManagerGeocodingService::PackageManagerListener::PackageManagerListener(PackageManagerGeocodingService& service) :
-        _service(service)
-    {
-    }
-        
-    void PackageManagerGeocodingService::PackageManagerListener::onPackagesChanged() {
-        std::lock_guard<std::mutex> lock(_service._mutex);
-        _service._cachedPackageDatabaseMap.clear();
-        _service._cachedGeocoder.reset();
-    }
-
-    void PackageManagerGeocodingService::PackageManagerListener::onStylesChanged() {
-        // Impossible
+        return geocoders;
     }
 
 }
@@ -21,8 +21,13 @@ namespace carto {
         class Geocoder;
     }
 
+    class GeocodingBatchListener;
+    class GeocodingCache;
+
     /**
      * A geocoding service that uses geocoding packages from package manager.
+     * Each package is imported into a separate geocoder, queries are run over the packages in parallel
+     * and the results are merged by rank. The service can be queried concurrently from multiple threads.
      */
     class PackageManagerGeocodingService : public GeocodingService {
     public:
@@ -58,29 +63,28 @@ namespace carto {
 
         virtual std::vector<std::shared_ptr<GeocodingResult> > calculateAddresses(const std::shared_ptr<GeocodingRequest>& request) const;
 
-    protected:
-        class PackageManagerListener : public PackageManager::OnChangeListener {
-        public:
-            explicit PackageManagerListener(PackageManagerGeocodingService& service);
-
-            virtual void onPackagesChanged();
-            virtual void onStylesChanged();
+        /**
+         * Calculates matching addresses for a batch of geocoding requests.
+         * The requests are processed in parallel and the results of each request are reported to the listener as soon as they are available.
+         * This is more efficient than calling calculateAddresses for each request separately.
+         * @param requests The list of geocoding requests to use.
+         * @param listener The listener to call with the results of each request.
+         * @throws std::runtime_error If IO error occured during the calculation.
+         */
+        void calculateAddressesBatch(const std::vector<std::shared_ptr<GeocodingRequest> >& requests, const std::shared_ptr<GeocodingBatchListener>& listener) const;
 
-        private:
-            PackageManagerGeocodingService& _service;
-        };
+    protected:
+        std::vector<std::shared_ptr<geocoding::Geocoder> > getGeocoders() const;
 
         const std::shared_ptr<PackageManager> _packageManager;
         bool _autocomplete;
         std::string _language;
 
-        mutable std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<sqlite3pp::database> > _cachedPackageDatabaseMap;
-        mutable std::shared_ptr<geocoding::Geocoder> _cachedGeocoder;
+        mutable std::map<std::string, int> _cachedPackageVersionMap;
+        mutable std::map<std::string, std::shared_ptr<geocoding::Geocoder> > _cachedGeocoderMap;
+        mutable std::shared_ptr<GeocodingCache> _queryCache;
 
         mutable std::mutex _mutex;
-
-    private:
-        std::shared_ptr<PackageManagerListener> _packageManagerListener;
     };
     
 }
@@ -3,11 +3,14 @@
 #include "PackageManagerReverseGeocodingService.h"
 #include "components/Exceptions.h"
 #include "geocoding/GeocodingProxy.h"
+#include "geocoding/ReverseGeocodingCache.h"
 #include "packagemanager/PackageInfo.h"
 #include "packagemanager/handlers/GeocodingPackageHandler.h"
 
 #include <geocoding/RevGeocoder.h>
 
+#include <algorithm>
+
 #include <sqlite3pp.h>
 
 namespace carto {
@@ -15,21 +18,17 @@ namespace carto {
     PackageManagerReverseGeocodingService::PackageManagerReverseGeocodingService(const std::shared_ptr<PackageManager>& packageManager) :
         _packageManager(packageManager),
         _language(),
-        _cachedPackageDatabaseMap(),
+        _cachedPackageVersionMap(),
         _cachedRevGeocoder(),
+        _addressCache(std::make_shared<ReverseGeocodingCache>()),
         _mutex()
     {
         if (!packageManager) {
             throw NullArgumentException("Null packageManager");
         }
-
-        _packageManagerListener = std::make_shared<PackageManagerListener>(*this);
-        _packageManager->registerOnChangeListener(_packageManagerListener);
     }
 
     PackageManagerReverseGeocodingService::~PackageManagerReverseGeocodingService() {
-        _packageManager->unregisterOnChangeListener(_packageManagerListener);
-        _packageManagerListener.reset();
     }
 
     std::string PackageManagerReverseGeocodingService::getLanguage() const {
@@ -53,52 +52,55 @@ namespace carto {
         // Do routing via package manager, so that all packages are locked during routing
         std::vector<std::shared_ptr<GeocodingResult> > results;
         _packageManager->accessLocalPackages([this, &results, &request](const std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<PackageHandler> >& packageHandlerMap) {
-            // Build map of geocoding databases
-            std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<sqlite3pp::database> > packageDatabaseMap;
+            // Build map of geocoding packages and their versions. Package handlers are recreated after any package change, so databases are not compared directly
+            std::map<std::string, int> packageVersionMap;
+            std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<GeocodingPackageHandler> > geocodingHandlerMap;
             for (auto it = packageHandlerMap.begin(); it != packageHandlerMap.end(); it++) {
                 if (auto geocodingHandler = std::dynamic_pointer_cast<GeocodingPackageHandler>(it->second)) {
-                    packageDatabaseMap[it->first] = geocodingHandler->getGeocodingDatabase();
+                    packageVersionMap[it->first->getPackageId()] = it->first->getVersion();
+                    geocodingHandlerMap[it->first] = geocodingHandler;
                 }
             }
 
-            // Now check if we have to reinitialize the geocoder
+            // Now check if we have to update the geocoder. If packages were only added, import just the new databases.
             std::lock_guard<std::mutex> lock(_mutex);
-            if (!_cachedRevGeocoder || packageDatabaseMap != _cachedPackageDatabaseMap) {
-                auto revGeocoder = std::make_shared<geocoding::RevGeocoder>();
-                revGeocoder->setLanguage(_language);
-                for (auto it = packageDatabaseMap.begin(); it != packageDatabaseMap.end(); it++) {
+            if (!_cachedRevGeocoder || packageVersionMap != _cachedPackageVersionMap) {
+                bool packagesAdded = std::all_of(_cachedPackageVersionMap.begin(), _cachedPackageVersionMap.end(), [&packageVersionMap](const std::pair<const std::string, int>& cachedPackage) {
+                    auto it = packageVersionMap.find(cachedPackage.first);
+                    return it != packageVersionMap.end() && it->second == cachedPackage.second;
+                });
+                std::shared_ptr<geocoding::RevGeocoder> revGeocoder = _cachedRevGeocoder;
+                if (!revGeocoder || !packagesAdded) {
+                    revGeocoder = std::make_shared<geocoding::RevGeocoder>();
+                    revGeocoder->setLanguage(_language);
+                    _cachedPackageVersionMap.clear();
+                }
+
+                // Invalidate the cached instance until all databases are imported, a partially updated instance can not be reused
+                _cachedRevGeocoder.reset();
+                for (auto it = geocodingHandlerMap.begin(); it != geocodingHandlerMap.end(); it++) {
+                    if (_cachedPackageVersionMap.find(it->first->getPackageId()) != _cachedPackageVersionMap.end()) {
+                        continue;
+                    }
                     try {
-                        if (!revGeocoder->import(it->second)) {
+                        if (!revGeocoder->import(it->second->getGeocodingDatabase())) {
                             throw FileException("Failed to import geocoding database " + it->first->getPackageId(), "");
                         }
                     }
                     catch (const std::exception& ex) {
+                        _cachedPackageVersionMap.clear();
                         throw GenericException("Exception while importing geocoding database " + it->first->getPackageId(), ex.what());
                     }
                 }
-                _cachedPackageDatabaseMap = packageDatabaseMap;
+                _cachedPackageVersionMap = packageVersionMap;
                 _cachedRevGeocoder = revGeocoder;
+                _addressCache->clear();
             }
 
-            results = GeocodingProxy::CalculateAddresses(_cachedRevGeocoder, request);
+            results = GeocodingProxy::CalculateAddresses(_cachedRevGeocoder, _addressCache, request);
         });
         return results;
     }
-    
-    PackageManagerReverseGeocodingService::PackageManagerListener::PackageManagerListener(PackageManagerReverseGeocodingService& service) :
-        _service(service)
-    {
-    }
-        
-    void PackageManagerReverseGeocodingService::PackageManagerListener::onPackagesChanged() {
-        std::lock_guard<std::mutex> lock(_service._mutex);
-        _service._cachedPackageDatabaseMap.clear();
-        _service._cachedRevGeocoder.reset();
-    }
-
-    void PackageManagerReverseGeocodingService::PackageManagerListener::onStylesChanged() {
-        // Impossible
-    }
 
 }
 
@@ -21,6 +21,8 @@ namespace carto {
         class RevGeocoder;
     }
 
+    class ReverseGeocodingCache;
+
     /**
      * A reverse geocoding service that uses geocoding packages from package manager.
      */
@@ -47,27 +49,14 @@ namespace carto {
         virtual std::vector<std::shared_ptr<GeocodingResult> > calculateAddresses(const std::shared_ptr<ReverseGeocodingRequest>& request) const;
 
     protected:
-        class PackageManagerListener : public PackageManager::OnChangeListener {
-        public:
-            explicit PackageManagerListener(PackageManagerReverseGeocodingService& service);
-                
-            virtual void onPackagesChanged();
-            virtual void onStylesChanged();
-
-        private:
-            PackageManagerReverseGeocodingService& _service;
-        };
-
         const std::shared_ptr<PackageManager> _packageManager;
         std::string _language;
 
-        mutable std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<sqlite3pp::database> > _cachedPackageDatabaseMap;
+        mutable std::map<std::string, int> _cachedPackageVersionMap;
         mutable std::shared_ptr<geocoding::RevGeocoder> _cachedRevGeocoder;
+        mutable std::shared_ptr<ReverseGeocodingCache> _addressCache;
 
         mutable std::mutex _mutex;
-
-    private:
-        std::shared_ptr<PackageManagerListener> _packageManagerListener;
     };
     
 }
@@ -1,9 +1,9 @@
 #if defined(_CARTO_GEOCODING_SUPPORT)
 
 #include "PeliasOnlineGeocodingService.h"
-#include "core/BinaryData.h"
 #include "components/Exceptions.h"
 #include "geocoding/PeliasGeocodingProxy.h"
+#include "geocoding/OnlineGeocodingRequestManager.h"
 #include "projections/Projection.h"
 #include "utils/GeneralUtils.h"
 #include "utils/NetworkUtils.h"
@@ -18,6 +18,7 @@ namespace carto {
         _autocomplete(false),
         _language(),
         _serviceURL(),
+        _requestManager(std::make_shared<OnlineGeocodingRequestManager>()),
         _mutex()
     {
     }
@@ -60,28 +61,32 @@ namespace carto {
             throw NullArgumentException("Null request");
         }
 
-        if (request->getQuery().empty()) {
+        std::string query = OnlineGeocodingRequestManager::NormalizeQuery(request->getQuery());
+        if (query.empty()) {
             return std::vector<std::shared_ptr<GeocodingResult> >();
         }
 
         std::string baseURL;
+        bool autocomplete = false;
 
         std::map<std::string, std::string> params;
         {
             std::lock_guard<std::mutex> lock(_mutex);
 
+            autocomplete = _autocomplete;
+
             std::map<std::string, std::string> tagMap;
             tagMap["api_key"] = NetworkUtils::URLEncode(_apiKey);
             tagMap["mode"] = _autocomplete ? "autocomplete": "search";
 
             baseURL = GeneralUtils::ReplaceTags(_serviceURL.empty() ? MAPZEN_SERVICE_URL : _serviceURL, tagMap);
 
-            params["text"] = request->getQuery();
+            params["text"] = query;
 
             if (request->isLocationDefined()) {
                 MapPos wgs84Center = request->getProjection()->toWgs84(request->getLocation());
-                params["focus.point.lat"] = boost::lexical_cast<std::string>(wgs84Center.getY());
-                params["focus.point.lon"] = boost::lexical_cast<std::string>(wgs84Center.getX());
+                params["focus.point.lat"] = boost::lexical_cast<std::string>(OnlineGeocodingRequestManager::QuantizeCoordinate(wgs84Center.getY()));
+                params["focus.point.lon"] = boost::lexical_cast<std::string>(OnlineGeocodingRequestManager::QuantizeCoordinate(wgs84Center.getX()));
             }
             if (request->getLocationRadius() > 0 && !_autocomplete) {
                 MapPos wgs84Center = request->getProjection()->toWgs84(request->getLocation());
@@ -99,19 +104,10 @@ namespace carto {
         std::string url = NetworkUtils::BuildURLFromParameters(baseURL, params);
         Log::Debugf("PeliasOnlineGeocodingService::calculateAddresses: Loading %s", url.c_str());
 
-        std::shared_ptr<BinaryData> responseData;
-        if (!NetworkUtils::GetHTTP(url, responseData, Log::IsShowDebug())) {
-            throw NetworkException("Failed to fetch response");
-        }
-
-        std::string responseString;
-        if (responseData) {
-            responseString = std::string(reinterpret_cast<const char*>(responseData->data()), responseData->size());
-        } else {
-            throw GenericException("Empty response");
-        }
-
-        return PeliasGeocodingProxy::ReadResponse(responseString, request->getProjection());
+        std::shared_ptr<Projection> projection = request->getProjection();
+        return _requestManager->calculateAddresses(url, autocomplete, [&projection](const std::string& responseString) {
+            return PeliasGeocodingProxy::ReadResponse(responseString, projection);
+        });
     }
 
     const std::string PeliasOnlineGeocodingService::MAPZEN_SERVICE_URL = "https://search.mapzen.com/v1/{mode}?api_key={api_key}";
@@ -0,0 +1,134 @@
+#ifdef _CARTO_GEOCODING_SUPPORT
+
+#include "ReverseGeocodingCache.h"
+#include "core/MapPos.h"
+#include "utils/Const.h"
+#include "utils/GeomUtils.h"
+
+#include <geocoding/RevGeocoder.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+namespace carto {
+
+    ReverseGeocodingCache::ReverseGeocodingCache() :
+        _cache(MAX_CACHED_CELLS),
+        _mutex()
+    {
+    }
+
+    ReverseGeocodingCache::~ReverseGeocodingCache() {
+    }
+
+    std::vector<std::pair<geocoding::Address, float> > ReverseGeocodingCache::findAddresses(const geocoding::RevGeocoder& revGeocoder, double lng, double lat, float radius) {
+        if (!(radius > 0 && radius <= MAX_CACHED_RADIUS) || std::abs(lat) > 85.0) {
+            return revGeocoder.findAddresses(lng, lat, radius);
+        }
+
+        // Find the cell of the location. The cached candidates must cover the search circle from any point of the cell
+        long long cellX = static_cast<long long>(std::floor(lng / CELL_SIZE));
+        long long cellY = static_cast<long long>(std::floor(lat / CELL_SIZE));
+        long long cellId = (cellY << 32) ^ (cellX & 0xffffffffLL);
+        double cellLng = (cellX + 0.5) * CELL_SIZE;
+        double cellLat = (cellY + 0.5) * CELL_SIZE;
+        double metersPerDegree = Const::EARTH_RADIUS * Const::DEG_TO_RAD;
+        double cosLat = std::cos(std::max(0.0, std::abs(cellLat) - CELL_SIZE * 0.5) * Const::DEG_TO_RAD);
+        float cellRadius = static_cast<float>(std::sqrt(1.0 + cosLat * cosLat) * CELL_SIZE * 0.5 * metersPerDegree);
+
+        std::shared_ptr<const Candidates> candidates;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_cache.read(cellId, candidates) || candidates->radius < radius + cellRadius) {
+                auto newCandidates = std::make_shared<Candidates>();
+                newCandidates->radius = MAX_CACHED_RADIUS + cellRadius;
+                for (const std::pair<geocoding::Address, float>& addr : revGeocoder.findAddresses(cellLng, cellLat, newCandidates->radius)) {
+                    newCandidates->addresses.push_back(addr.first);
+                }
+                candidates = newCandidates;
+                _cache.put(cellId, candidates, 1);
+            }
+        }
+
+        // Rank the candidates relative to the actual location and search radius
+        std::vector<std::pair<geocoding::Address, float> > addrs;
+        for (const geocoding::Address& address : candidates->addresses) {
+            double dist = std::numeric_limits<double>::infinity();
+            for (const geocoding::Feature& feature : address.features) {
+                if (feature.getGeometry()) {
+                    dist = std::min(dist, CalculateDistance(*feature.getGeometry(), lng, lat));
+                }
+            }
+            if (dist <= radius) {
+                addrs.emplace_back(address, 1.0f - static_cast<float>(dist / radius));
+            }
+        }
+        std::stable_sort(addrs.begin(), addrs.end(), [](const std::pair<geocoding::Address, float>& addr1, const std::pair<geocoding::Address, float>& addr2) {
+            return addr1.second > addr2.second;
+        });
+        return addrs;
+    }
+
+    void ReverseGeocodingCache::clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _cache.clear();
+    }
+
+    double ReverseGeocodingCache::CalculateDistance(const geocoding::Geometry& geom, double lng, double lat) {
+        // Use local equirectangular approximation around the location, the distances are small
+        double metersPerDegree = Const::EARTH_RADIUS * Const::DEG_TO_RAD;
+        double cosLat = std::cos(lat * Const::DEG_TO_RAD);
+        auto toLocal = [lng, lat, cosLat, metersPerDegree](const cglib::vec2<double>& point) {
+            return MapPos((point(0) - lng) * cosLat * metersPerDegree, (point(1) - lat) * metersPerDegree);
+        };
+        auto ringDistance = [&toLocal](const std::vector<cglib::vec2<double> >& points, bool closed) {
+            double dist = std::numeric_limits<double>::infinity();
+            for (std::size_t i = 0; i < points.size(); i++) {
+                if (i + 1 < points.size() || (closed && points.size() > 1)) {
+                    dist = std::min(dist, GeomUtils::DistanceFromLineSegment(MapPos(0, 0), toLocal(points[i]), toLocal(points[(i + 1) % points.size()])));
+                } else if (points.size() == 1) {
+                    dist = std::min(dist, GeomUtils::DistanceFromPoint(MapPos(0, 0), toLocal(points[i])));
+                }
+            }
+            return dist;
+        };
+        auto insideRing = [&toLocal](const std::vector<cglib::vec2<double> >& points) {
+            std::vector<MapPos> poses;
+            poses.reserve(points.size());
+            std::transform(points.begin(), points.end(), std::back_inserter(poses), toLocal);
+            return GeomUtils::PointInsidePolygon(poses, MapPos(0, 0));
+        };
+
+        if (auto pointGeom = dynamic_cast<const geocoding::PointGeometry*>(&geom)) {
+            return GeomUtils::DistanceFromPoint(MapPos(0, 0), toLocal(pointGeom->getPoint()));
+        } else if (auto lineGeom = dynamic_cast<const geocoding::LineGeometry*>(&geom)) {
+            return ringDistance(lineGeom->getPoints(), false);
+        } else if (auto polygonGeom = dynamic_cast<const geocoding::PolygonGeometry*>(&geom)) {
+            double dist = ringDistance(polygonGeom->getPoints(), true);
+            bool inside = insideRing(polygonGeom->getPoints());
+            for (const std::vector<cglib::vec2<double> >& hole : polygonGeom->getHoles()) {
+                dist = std::min(dist, ringDistance(hole, true));
+                inside = inside && !insideRing(hole);
+            }
+            return inside ? 0.0 : dist;
+        } else if (auto multiGeom = dynamic_cast<const geocoding::MultiGeometry*>(&geom)) {
+            double dist = std::numeric_limits<double>::infinity();
+            for (const std::shared_ptr<geocoding::Geometry>& subGeom : multiGeom->getGeometries()) {
+                if (subGeom) {
+                    dist = std::min(dist, CalculateDistance(*subGeom, lng, lat));
+                }
+            }
+            return dist;
+        }
+        return std::numeric_limits<double>::infinity();
+    }
+
+    const double ReverseGeocodingCache::CELL_SIZE = 0.002;
+
+    const float ReverseGeocodingCache::MAX_CACHED_RADIUS = 250.0f;
+
+}
+
+#endif
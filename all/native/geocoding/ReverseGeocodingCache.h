@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_REVERSEGEOCODINGCACHE_H_
+#define _CARTO_REVERSEGEOCODINGCACHE_H_
+
+#ifdef _CARTO_GEOCODING_SUPPORT
+
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <stdext/timed_lru_cache.h>
+
+namespace carto {
+    namespace geocoding {
+        struct Address;
+        class Geometry;
+        class RevGeocoder;
+    }
+
+    /**
+     * Cache of reverse geocoding candidates, keyed by grid cells of roughly 200x200 meters.
+     * Candidates of a cell are queried once using a radius that covers the whole cell, consecutive nearby
+     * requests are then answered by filtering and ranking the cached candidates by their distance from the request location.
+     * The cache must be cleared when the geocoder or its settings change.
+     */
+    class ReverseGeocodingCache {
+    public:
+        ReverseGeocodingCache();
+        virtual ~ReverseGeocodingCache();
+
+        std::vector<std::pair<geocoding::Address, float> > findAddresses(const geocoding::RevGeocoder& revGeocoder, double lng, double lat, float radius);
+
+        void clear();
+
+    private:
+        struct Candidates {
+            std::vector<geocoding::Address> addresses;
+            float radius;
+        };
+
+        static double CalculateDistance(const geocoding::Geometry& geom, double lng, double lat);
+
+        static const double CELL_SIZE; // in degrees
+        static const float MAX_CACHED_RADIUS; // in meters
+        static const int MAX_CACHED_CELLS = 16;
+
+        cache::timed_lru_cache<long long, std::shared_ptr<const Candidates> > _cache;
+
+        mutable std::mutex _mutex;
+    };
+    
+}
+
+#endif
+
+#endif
@@ -1,9 +1,9 @@
 #if defined(_CARTO_GEOCODING_SUPPORT)
 
 #include "TomTomOnlineGeocodingService.h"
-#include "core/BinaryData.h"
 #include "components/Exceptions.h"
 #include "geocoding/TomTomGeocodingProxy.h"
+#include "geocoding/OnlineGeocodingRequestManager.h"
 #include "projections/Projection.h"
 #include "utils/GeneralUtils.h"
 #include "utils/NetworkUtils.h"
@@ -18,6 +18,7 @@ namespace carto {
         _autocomplete(false),
         _language(),
         _serviceURL(),
+        _requestManager(std::make_shared<OnlineGeocodingRequestManager>()),
         _mutex()
     {
     }
@@ -60,18 +61,22 @@ namespace carto {
             throw NullArgumentException("Null request");
         }
 
-        if (request->getQuery().empty()) {
+        std::string query = OnlineGeocodingRequestManager::NormalizeQuery(request->getQuery());
+        if (query.empty()) {
             return std::vector<std::shared_ptr<GeocodingResult> >();
         }
 
         std::string baseURL;
+        bool autocomplete = false;
 
         std::map<std::string, std::string> params;
         {
             std::lock_guard<std::mutex> lock(_mutex);
 
+            autocomplete = _autocomplete;
+
             std::map<std::string, std::string> tagMap;
-            tagMap["query"] = NetworkUtils::URLEncode(request->getQuery());
+            tagMap["query"] = NetworkUtils::URLEncode(query);
             tagMap["api_key"] = NetworkUtils::URLEncode(_apiKey);
 
             baseURL = GeneralUtils::ReplaceTags(_serviceURL.empty() ? TOMTOM_SERVICE_URL : _serviceURL, tagMap);
@@ -80,8 +85,8 @@ namespace carto {
 
             if (request->isLocationDefined()) {
                 MapPos wgs84Center = request->getProjection()->toWgs84(request->getLocation());
-                params["lat"] = boost::lexical_cast<std::string>(wgs84Center.getY());
-                params["lon"] = boost::lexical_cast<std::string>(wgs84Center.getX());
+                params["lat"] = boost::lexical_cast<std::string>(OnlineGeocodingRequestManager::QuantizeCoordinate(wgs84Center.getY()));
+                params["lon"] = boost::lexical_cast<std::string>(OnlineGeocodingRequestManager::QuantizeCoordinate(wgs84Center.getX()));
             }
             if (request->getLocationRadius() > 0) {
                 double radius = request->getLocationRadius();
@@ -96,19 +101,10 @@ namespace carto {
         std::string url = NetworkUtils::BuildURLFromParameters(baseURL, params);
         Log::Debugf("TomTomOnlineGeocodingService::calculateAddresses: Loading %s", url.c_str());
 
-        std::shared_ptr<BinaryData> responseData;
-        if (!NetworkUtils::GetHTTP(url, responseData, Log::IsShowDebug())) {
-            throw NetworkException("Failed to fetch response");
-        }
-
-        std::string responseString;
-        if (responseData) {
-            responseString = std::string(reinterpret_cast<const char*>(responseData->data()), responseData->size());
-        } else {
-            throw GenericException("Empty response");
-        }
-
-        return TomTomGeocodingProxy::ReadResponse(responseString, request->getProjection());
+        std::shared_ptr<Projection> projection = request->getProjection();
+        return _requestManager->calculateAddresses(url, autocomplete, [&projection](const std::string& responseString) {
+            return TomTomGeocodingProxy::ReadResponse(responseString, projection);
+        });
     }
 
     const std::string TomTomOnlineGeocodingService::TOMTOM_SERVICE_URL = "https://api.tomtom.com/search/2/geocode/{query}.json?key={api_key}";
@@ -0,0 +1,51 @@
+#include "ColumnarFeatureCollection.h"
+#include "components/Exceptions.h"
+#include "geometry/Geometry.h"
+
+namespace carto {
+
+    ColumnarFeatureCollection::ColumnarFeatureCollection(const std::vector<std::shared_ptr<Feature> >& features) :
+        FeatureCollection(std::vector<std::shared_ptr<Feature> >()),
+        _geometries(),
+        _attributeTable()
+    {
+        std::vector<Variant> properties;
+        _geometries.reserve(features.size());
+        properties.reserve(features.size());
+        for (const std::shared_ptr<Feature>& feature : features) {
+            if (!feature) {
+                throw NullArgumentException("Null feature");
+            }
+            _geometries.push_back(feature->getGeometry());
+            properties.push_back(feature->getProperties());
+        }
+        _attributeTable = FeatureAttributeTable(properties);
+    }
+
+    ColumnarFeatureCollection::~ColumnarFeatureCollection() {
+    }
+
+    int ColumnarFeatureCollection::getFeatureCount() const {
+        return static_cast<int>(_geometries.size());
+    }
+
+    std::vector<std::string> ColumnarFeatureCollection::getPropertyNames() const {
+        return _attributeTable.getColumnNames();
+    }
+
+    Variant ColumnarFeatureCollection::getFeatureProperty(int index, const std::string& name) const {
+        if (index < 0 || index >= getFeatureCount()) {
+            throw OutOfRangeException("Feature index out of range");
+        }
+        Variant value;
+        if (!_attributeTable.getValue(index, name, value)) {
+            return Variant();
+        }
+        return value;
+    }
+
+    std::shared_ptr<Feature> ColumnarFeatureCollection::createFeature(int index) const {
+        return std::make_shared<Feature>(_geometries[index], _attributeTable.getRow(index));
+    }
+
+}
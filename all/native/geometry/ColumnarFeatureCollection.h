@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_COLUMNARFEATURECOLLECTION_H_
+#define _CARTO_COLUMNARFEATURECOLLECTION_H_
+
+#include "geometry/FeatureCollection.h"
+#include "geometry/utils/FeatureAttributeTable.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace carto {
+
+    /**
+     * A compact collection of features, storing feature properties in typed per-attribute columns.
+     * String values are shared between features. Feature objects are created on demand,
+     * so large collections use considerably less memory than a regular feature collection.
+     */
+    class ColumnarFeatureCollection : public FeatureCollection {
+    public:
+        /**
+         * Constructs a ColumnarFeatureCollection from a vector of features.
+         * @param features The features for the collection.
+         */
+        explicit ColumnarFeatureCollection(const std::vector<std::shared_ptr<Feature> >& features);
+        virtual ~ColumnarFeatureCollection();
+
+        virtual int getFeatureCount() const;
+
+        /**
+         * Returns the names of all the properties used by the features of the collection.
+         * @return The list of property names.
+         */
+        std::vector<std::string> getPropertyNames() const;
+
+        /**
+         * Returns the specified property of the feature without creating the feature object.
+         * @param index The index of the feature.
+         * @param name The name of the property.
+         * @return The property value. If the feature does not have the property, null variant is returned.
+         * @throws std::out_of_range If the index is out of range.
+         */
+        Variant getFeatureProperty(int index, const std::string& name) const;
+
+    protected:
+        virtual std::shared_ptr<Feature> createFeature(int index) const;
+
+    private:
+        std::vector<std::shared_ptr<Geometry> > _geometries;
+        FeatureAttributeTable _attributeTable;
+    };
+
+}
+
+#endif
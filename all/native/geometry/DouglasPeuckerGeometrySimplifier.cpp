@@ -4,6 +4,7 @@
 #include "geometry/Geometry.h"
 #include "geometry/LineGeometry.h"
 #include "geometry/PolygonGeometry.h"
+#include "geometry/utils/CompactMapPosList.h"
 #include "geometry/MultiGeometry.h"
 #include "geometry/MultiLineGeometry.h"
 #include "geometry/MultiPolygonGeometry.h"
@@ -11,7 +12,6 @@
 #include "projections/ProjectionSurface.h"
 #include "utils/Const.h"
 
-#include <stack>
 #include <utility>
 #include <algorithm>
 
@@ -19,76 +19,75 @@ namespace carto {
 
     class DouglasPeuckerGeometrySimplifier::Helper {
     public:
-        Helper(const std::shared_ptr<Projection>& projection, const std::shared_ptr<ProjectionSurface>& projectionSurface) : _projection(projection), _projectionSurface(projectionSurface) {
+        explicit Helper(std::size_t pointCount) : _xs(), _ys(), _zs(), _distSqrs(), _stack() {
+            _xs.reserve(pointCount);
+            _ys.reserve(pointCount);
+            _zs.reserve(pointCount);
         }
 
-        void approximate(const MapPos* points, std::size_t pointCount, double minDist, unsigned char* keys) const {
-            std::stack<SubPoly> stack;
-            stack.push(SubPoly(0, pointCount - 1));
-            while (!stack.empty()) {
-                SubPoly subPoly = stack.top();
-                stack.pop();
-                KeyInfo keyInfo = findKey(points, subPoly.first, subPoly.last);
-                if (keyInfo.index && minDist < keyInfo.dist) {
-                    keys[keyInfo.index] = 1;
-                    stack.push(SubPoly(keyInfo.index, subPoly.last));
-                    stack.push(SubPoly(subPoly.first, keyInfo.index));
+        void addPoint(const cglib::vec3<double>& pos) {
+            _xs.push_back(pos(0));
+            _ys.push_back(pos(1));
+            _zs.push_back(pos(2));
+        }
+
+        void approximate(double minDist, unsigned char* keys) {
+            std::size_t pointCount = _xs.size();
+            _distSqrs.resize(pointCount);
+            _stack.clear();
+            _stack.emplace_back(0, pointCount - 1);
+            while (!_stack.empty()) {
+                std::pair<std::size_t, std::size_t> subPoly = _stack.back();
+                _stack.pop_back();
+                double maxDistSqr = 0;
+                std::size_t index = findKey(subPoly.first, subPoly.second, maxDistSqr);
+                if (index && minDist * minDist < maxDistSqr) {
+                    keys[index] = 1;
+                    _stack.emplace_back(index, subPoly.second);
+                    _stack.emplace_back(subPoly.first, index);
                 }
             }
         }
 
     private:
-        struct SubPoly {
-            SubPoly(std::size_t first = 0, std::size_t last = 0) : first(first), last(last) { }
-
-            std::size_t first;
-            std::size_t last;
-        };
-
-        struct KeyInfo {
-            KeyInfo(std::size_t index = 0, double dist = 0) : index(index), dist(dist) { }
-
-            std::size_t index;
-            double dist;
-        };
-
-        static double FindSegmentDistance(const cglib::vec3<double>& s1, const cglib::vec3<double>& s2, const cglib::vec3<double>& p) {
-            // NOTE: not really correct on spherical surface but, but should still give reasonable results
-            cglib::vec3<double> v = (s2 - s1);
-            cglib::vec3<double> w = (p - s1);
-            double cw = cglib::dot_product(v, w);
-            if (cw <= 0) {
-                return cglib::length(p - s1);
-            }
-            double cv = cglib::norm(v);
-            if (cv <= cw) {
-                return cglib::length(p - s2);
+        std::size_t findKey(std::size_t first, std::size_t last, double& maxDistSqr) {
+            if (last <= first + 1) {
+                return 0;
             }
 
-            double fraction = cv == 0 ? 0 : cw / cv;
-            cglib::vec3<double> pProj = s1 + (s2 - s1) * fraction;
-            return cglib::length(pProj - p);
-        }
-
-        KeyInfo findKey(const MapPos* points, std::size_t first, std::size_t last) const {
-            KeyInfo keyInfo;
-
-            cglib::vec3<double> s1 = _projectionSurface->calculatePosition(_projection->toInternal(points[first]));
-            cglib::vec3<double> s2 = _projectionSurface->calculatePosition(_projection->toInternal(points[last]));
-            for (std::size_t current = first + 1; current < last; current++) {
-                cglib::vec3<double> p = _projectionSurface->calculatePosition(_projection->toInternal(points[current]));
-                double dist = FindSegmentDistance(s1, s2, p);
-                if (dist < keyInfo.dist) {
-                    continue;
+            // Calculate squared distances from the segment in a branchless loop over coordinate arrays, so that the compiler can vectorize it.
+            // NOTE: not really correct on spherical surface but, but should still give reasonable results
+            const double* xs = _xs.data();
+            const double* ys = _ys.data();
+            const double* zs = _zs.data();
+            double* distSqrs = _distSqrs.data();
+            double x1 = xs[first], y1 = ys[first], z1 = zs[first];
+            double vx = xs[last] - x1, vy = ys[last] - y1, vz = zs[last] - z1;
+            double cv = vx * vx + vy * vy + vz * vz;
+            double invCv = cv > 0 ? 1.0 / cv : 0.0;
+            for (std::size_t i = first + 1; i < last; i++) {
+                double wx = xs[i] - x1, wy = ys[i] - y1, wz = zs[i] - z1;
+                double t = std::min(std::max((vx * wx + vy * wy + vz * wz) * invCv, 0.0), 1.0);
+                double dx = wx - vx * t, dy = wy - vy * t, dz = wz - vz * t;
+                distSqrs[i] = dx * dx + dy * dy + dz * dz;
+            }
+
+            std::size_t index = 0;
+            maxDistSqr = 0;
+            for (std::size_t i = first + 1; i < last; i++) {
+                if (distSqrs[i] >= maxDistSqr) {
+                    index = i;
+                    maxDistSqr = distSqrs[i];
                 }
-                keyInfo.index = current;
-                keyInfo.dist = dist;
             }
-            return keyInfo;
+            return index;
         }
 
-        std::shared_ptr<Projection> _projection;
-        std::shared_ptr<ProjectionSurface> _projectionSurface;
+        std::vector<double> _xs;
+        std::vector<double> _ys;
+        std::vector<double> _zs;
+        std::vector<double> _distSqrs;
+        std::vector<std::pair<std::size_t, std::size_t> > _stack;
     };
 
     DouglasPeuckerGeometrySimplifier::DouglasPeuckerGeometrySimplifier(float tolerance) :
@@ -99,28 +98,45 @@ namespace carto {
 
     std::shared_ptr<Geometry> DouglasPeuckerGeometrySimplifier::simplify(const std::shared_ptr<Geometry>& geometry, const std::shared_ptr<Projection>& projection, const std::shared_ptr<ProjectionSurface>& projectionSurface, float scale) const {
         if (auto lineGeometry = std::dynamic_pointer_cast<LineGeometry>(geometry)) {
-            std::vector<MapPos> mapPoses = simplifyRing(lineGeometry->getPoses(), projection, projectionSurface, scale);
+            // Compact geometries are decoded only temporarily, the simplified geometry is a temporary object anyway
+            std::vector<MapPos> decodedPoses;
+            if (std::shared_ptr<const CompactMapPosList> compactPoses = lineGeometry->getCompactPoses()) {
+                decodedPoses = compactPoses->getPoses();
+            }
+            const std::vector<MapPos>& poses = lineGeometry->getCompactPoses() ? decodedPoses : lineGeometry->getPoses();
+            std::vector<MapPos> mapPoses = simplifyRing(poses, projection, projectionSurface, scale);
             if (mapPoses.size() < 2) {
                 return std::shared_ptr<Geometry>();
             }
-            bool simplified = mapPoses.size() < lineGeometry->getPoses().size();
+            bool simplified = mapPoses.size() < poses.size();
             if (simplified) {
                 return std::make_shared<LineGeometry>(mapPoses);
             }
         } else if (auto polygonGeometry = std::dynamic_pointer_cast<PolygonGeometry>(geometry)) {
-            std::vector<MapPos> mapPoses = simplifyRing(polygonGeometry->getPoses(), projection, projectionSurface, scale);
+            std::vector<std::vector<MapPos> > decodedRings;
+            for (const std::shared_ptr<const CompactMapPosList>& compactRing : polygonGeometry->getCompactRings()) {
+                decodedRings.push_back(compactRing->getPoses());
+            }
+            const std::vector<std::vector<MapPos> >& rings = polygonGeometry->getCompactRings().empty() ? polygonGeometry->getRings() : decodedRings;
+            if (rings.empty()) {
+                return std::shared_ptr<Geometry>();
+            }
+            std::vector<MapPos> mapPoses = simplifyRing(rings.front(), projection, projectionSurface, scale);
             if (mapPoses.size() < 3) {
                 return std::shared_ptr<Geometry>();
             }
-            bool simplified = mapPoses.size() < polygonGeometry->getPoses().size();
+            bool simplified = mapPoses.size() < rings.front().size();
             std::vector<std::vector<MapPos> > holes;
-            for (const std::vector<MapPos>& holeRing : polygonGeometry->getHoles()) {
+            for (auto it = rings.begin() + 1; it != rings.end(); it++) {
+                const std::vector<MapPos>& holeRing = *it;
                 std::vector<MapPos> holeMapPoses = simplifyRing(holeRing, projection, projectionSurface, scale);
                 if (holeMapPoses.size() < holeRing.size()) {
                     simplified = true;
                 }
-                if (holes.size() >= 3) {
+                if (holeMapPoses.size() >= 3) {
                     holes.push_back(std::move(holeMapPoses));
+                } else {
+                    simplified = true;
                 }
             }
             if (simplified) {
@@ -180,34 +196,39 @@ namespace carto {
             return ring;
         }
 
-        std::vector<MapPos> simplifiedRing1;
-        simplifiedRing1.reserve(ring.size());
-        simplifiedRing1.push_back(ring.front());
-        cglib::vec3<double> pos0 = projectionSurface->calculatePosition(projection->toInternal(simplifiedRing1.back()));
+        // First pass, radial distance rejection. Each point is projected only once, Douglas-Peucker pass uses the projected coordinates
+        Helper helper(ring.size());
+        std::vector<std::size_t> indices;
+        indices.reserve(ring.size());
+        indices.push_back(0);
+        cglib::vec3<double> pos0 = projectionSurface->calculatePosition(projection->toInternal(ring.front()));
+        helper.addPoint(pos0);
+        double minDistSqr = static_cast<double>(scale * _tolerance) * (scale * _tolerance);
         for (std::size_t i = 1; i + 1 < ring.size(); i++) {
             cglib::vec3<double> pos1 = projectionSurface->calculatePosition(projection->toInternal(ring[i]));
-            double dist = cglib::length(pos1 - pos0); // NOTE: not really correct on spherical surface but, but should still give reasonable results
-            if (dist > scale * _tolerance) {
-                simplifiedRing1.push_back(ring[i]);
+            if (cglib::norm(pos1 - pos0) > minDistSqr) { // NOTE: not really correct on spherical surface but, but should still give reasonable results
+                indices.push_back(i);
+                helper.addPoint(pos1);
                 pos0 = pos1;
             }
         }
-        simplifiedRing1.push_back(ring.back());
+        indices.push_back(ring.size() - 1);
+        helper.addPoint(projectionSurface->calculatePosition(projection->toInternal(ring.back())));
 
-        std::vector<unsigned char> keys(simplifiedRing1.size(), 0);
+        // Second pass, Douglas-Peucker
+        std::vector<unsigned char> keys(indices.size(), 0);
         keys.front() = 1;
         keys.back() = 1;
-        Helper helper(projection, projectionSurface);
-        helper.approximate(simplifiedRing1.data(), simplifiedRing1.size(), scale * _tolerance, &keys[0]);
-        std::vector<MapPos> simplifiedRing2;
-        simplifiedRing2.reserve(std::count(keys.begin(), keys.end(), 1));
-        for (std::size_t i = 0; i < simplifiedRing1.size(); i++) {
+        helper.approximate(scale * _tolerance, &keys[0]);
+        std::vector<MapPos> simplifiedRing;
+        simplifiedRing.reserve(std::count(keys.begin(), keys.end(), 1));
+        for (std::size_t i = 0; i < indices.size(); i++) {
             if (keys[i] == 1) {
-                simplifiedRing2.push_back(simplifiedRing1[i]);
+                simplifiedRing.push_back(ring[indices[i]]);
             }
         }
 
-        return simplifiedRing2;
+        return simplifiedRing;
     }
 
 }
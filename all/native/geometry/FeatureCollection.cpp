@@ -16,9 +16,13 @@ namespace carto {
     }
     
     std::shared_ptr<Feature> FeatureCollection::getFeature(int index) const {
-        if (index < 0 || index >= static_cast<int>(_features.size())) {
+        if (index < 0 || index >= getFeatureCount()) {
             throw OutOfRangeException("Feature index out of range");
         }
+        return createFeature(index);
+    }
+
+    std::shared_ptr<Feature> FeatureCollection::createFeature(int index) const {
         return _features[index];
     }
 
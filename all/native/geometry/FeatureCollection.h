@@ -30,7 +30,7 @@ namespace carto {
          * Returns the number of features in this container.
          * @return The number of features.
          */
-        int getFeatureCount() const;
+        virtual int getFeatureCount() const;
 
         /**
          * Returns the feature at the specified index. Index must be between 0 and getFeatureCount (exclusive).
@@ -41,6 +41,8 @@ namespace carto {
         std::shared_ptr<Feature> getFeature(int index) const;
 
     protected:
+        virtual std::shared_ptr<Feature> createFeature(int index) const;
+
         template <typename It>
         FeatureCollection(It begin, It end) : _features(begin, end) {
         }
@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_GEOJSONFEATUREREADERLISTENER_H_
+#define _CARTO_GEOJSONFEATUREREADERLISTENER_H_
+
+#include <memory>
+
+namespace carto {
+    class Feature;
+
+    /**
+     * Listener for features read by streaming GeoJSON reader.
+     */
+    class GeoJSONFeatureReaderListener {
+    public:
+        virtual ~GeoJSONFeatureReaderListener() { }
+
+        /**
+         * Listener method that gets called for each feature of the feature collection, as soon as the feature is read.
+         * @param feature The feature read.
+         * @return True if reading should continue, false if reading should be stopped.
+         */
+        virtual bool onFeatureRead(const std::shared_ptr<Feature>& feature) = 0;
+    };
+    
+}
+
+#endif
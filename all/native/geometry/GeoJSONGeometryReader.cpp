@@ -2,6 +2,7 @@
 #include "components/Exceptions.h"
 #include "geometry/Feature.h"
 #include "geometry/FeatureCollection.h"
+#include "geometry/GeoJSONFeatureReaderListener.h"
 #include "geometry/Geometry.h"
 #include "geometry/PointGeometry.h"
 #include "geometry/LineGeometry.h"
@@ -10,17 +11,73 @@
 #include "geometry/MultiPointGeometry.h"
 #include "geometry/MultiLineGeometry.h"
 #include "geometry/MultiPolygonGeometry.h"
+#include "geometry/utils/CompactMapPosList.h"
 #include "projections/Projection.h"
 #include "utils/Log.h"
 
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <map>
 #include <stdexcept>
 
 #include <rapidjson/rapidjson.h>
 #include <rapidjson/document.h>
+#include <rapidjson/reader.h>
+#include <rapidjson/filereadstream.h>
 #include <rapidjson/error/en.h>
 
+#include <stdext/utf8_filesystem.h>
+
 namespace {
 
+    class FunctionReadStream {
+    public:
+        typedef char Ch;
+
+        FunctionReadStream(const std::function<std::size_t(char*, std::size_t)>& readFn, char* buffer, std::size_t bufferSize) :
+            _readFn(readFn), _buffer(buffer), _bufferSize(bufferSize), _bufferLast(buffer), _current(buffer), _readCount(0), _count(0), _eof(false)
+        {
+            read();
+        }
+
+        Ch Peek() const { return *_current; }
+        Ch Take() { Ch c = *_current; read(); return c; }
+        std::size_t Tell() const { return _count + static_cast<std::size_t>(_current - _buffer); }
+
+        void Put(Ch) { }
+        void Flush() { }
+        Ch* PutBegin() { return 0; }
+        std::size_t PutEnd(Ch*) { return 0; }
+
+    private:
+        void read() {
+            if (_current < _bufferLast) {
+                ++_current;
+            } else if (!_eof) {
+                _count += _readCount;
+                _readCount = _readFn(_buffer, _bufferSize);
+                _bufferLast = _buffer + _readCount - 1;
+                _current = _buffer;
+
+                if (_readCount == 0) {
+                    _buffer[_readCount] = '\0';
+                    ++_bufferLast;
+                    _eof = true;
+                }
+            }
+        }
+
+        const std::function<std::size_t(char*, std::size_t)>& _readFn;
+        char* _buffer;
+        std::size_t _bufferSize;
+        char* _bufferLast;
+        char* _current;
+        std::size_t _readCount;
+        std::size_t _count;
+        bool _eof;
+    };
+
     picojson::value convertRapidJSON(const rapidjson::Value& value) {
         if (value.IsObject()) {
             picojson::value object(picojson::object_type, true);
@@ -49,12 +106,137 @@ namespace {
         return picojson::value();
     }
 
+    class FeatureCollectionStreamHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, FeatureCollectionStreamHandler> {
+    public:
+        typedef std::function<bool(const carto::Variant&)> FeatureCallback;
+
+        explicit FeatureCollectionStreamHandler(const FeatureCallback& callback) : _callback(callback), _depth(0), _featuresDepth(-1), _key(), _type(), _frames(), _stopped(false), _error() { }
+
+        bool isStopped() const { return _stopped; }
+        const std::string& getType() const { return _type; }
+        const std::string& getError() const { return _error; }
+
+        bool Null() { return addValue(carto::Variant()); }
+        bool Bool(bool val) { return addValue(carto::Variant(val)); }
+        bool Int(int val) { return addValue(carto::Variant(static_cast<long long>(val))); }
+        bool Uint(unsigned int val) { return addValue(carto::Variant(static_cast<long long>(val))); }
+        bool Int64(std::int64_t val) { return addValue(carto::Variant(static_cast<long long>(val))); }
+        bool Uint64(std::uint64_t val) { return addValue(carto::Variant(static_cast<long long>(val))); }
+        bool Double(double val) { return addValue(carto::Variant(val)); }
+
+        bool String(const char* str, rapidjson::SizeType length, bool copy) {
+            if (_frames.empty() && _depth == 1 && _key == "type") {
+                _type = std::string(str, length);
+                if (_type != "FeatureCollection") {
+                    _error = "Illegal type for the feature collection";
+                    return false;
+                }
+                return true;
+            }
+            return addValue(carto::Variant(std::string(str, length)));
+        }
+
+        bool Key(const char* str, rapidjson::SizeType length, bool copy) {
+            if (_frames.empty()) {
+                if (_depth == 1) {
+                    _key.assign(str, length);
+                }
+            } else {
+                _frames.back().key.assign(str, length);
+            }
+            return true;
+        }
+
+        bool StartObject() {
+            _depth++;
+            if (!_frames.empty() || (_featuresDepth >= 0 && _depth == _featuresDepth + 1)) {
+                _frames.emplace_back(true);
+            } else if (_depth == 1) {
+                _key.clear();
+            }
+            return true;
+        }
+
+        bool EndObject(rapidjson::SizeType memberCount) {
+            _depth--;
+            if (_frames.empty()) {
+                return true;
+            }
+            carto::Variant value(_frames.back().members);
+            _frames.pop_back();
+            return addValue(std::move(value));
+        }
+
+        bool StartArray() {
+            _depth++;
+            if (!_frames.empty() || (_featuresDepth >= 0 && _depth == _featuresDepth + 1)) {
+                _frames.emplace_back(false);
+            } else if (_depth == 2 && _key == "features") {
+                _featuresDepth = _depth;
+            }
+            return true;
+        }
+
+        bool EndArray(rapidjson::SizeType elementCount) {
+            if (_depth == _featuresDepth && _frames.empty()) {
+                _featuresDepth = -1;
+            }
+            _depth--;
+            if (_frames.empty()) {
+                return true;
+            }
+            carto::Variant value(_frames.back().elements);
+            _frames.pop_back();
+            return addValue(std::move(value));
+        }
+
+    private:
+        struct Frame {
+            bool object;
+            std::string key;
+            std::map<std::string, carto::Variant> members;
+            std::vector<carto::Variant> elements;
+
+            explicit Frame(bool object) : object(object), key(), members(), elements() { }
+        };
+
+        bool addValue(carto::Variant value) {
+            if (_frames.empty()) {
+                // Either a completed feature or a top-level value that is not needed
+                if (_featuresDepth >= 0 && _depth == _featuresDepth) {
+                    if (!_callback(value)) {
+                        _stopped = true;
+                        return false;
+                    }
+                }
+                return true;
+            }
+            Frame& frame = _frames.back();
+            if (frame.object) {
+                frame.members[frame.key] = std::move(value);
+            } else {
+                frame.elements.push_back(std::move(value));
+            }
+            return true;
+        }
+
+        const FeatureCallback& _callback;
+        int _depth;
+        int _featuresDepth;
+        std::string _key;
+        std::string _type;
+        std::vector<Frame> _frames;
+        bool _stopped;
+        std::string _error;
+    };
+
 }
 
 namespace carto {
 
     GeoJSONGeometryReader::GeoJSONGeometryReader() :
         _targetProjection(),
+        _compactCoordinateResolution(0),
         _mutex()
     {
     }
@@ -69,6 +251,16 @@ namespace carto {
         _targetProjection = proj;
     }
 
+    double GeoJSONGeometryReader::getCompactCoordinateResolution() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _compactCoordinateResolution;
+    }
+
+    void GeoJSONGeometryReader::setCompactCoordinateResolution(double resolution) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _compactCoordinateResolution = resolution;
+    }
+
     std::shared_ptr<Geometry> GeoJSONGeometryReader::readGeometry(const std::string& geoJSON) const {
         std::lock_guard<std::mutex> lock(_mutex);
 
@@ -105,6 +297,71 @@ namespace carto {
         return readFeatureCollection(featureCollectionDoc);
     }
 
+    void GeoJSONGeometryReader::readFeatureCollection(const std::string& geoJSON, const std::shared_ptr<GeoJSONFeatureReaderListener>& listener) const {
+        if (!listener) {
+            throw NullArgumentException("Null listener");
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        rapidjson::StringStream stream(geoJSON.c_str());
+        readFeatureCollectionStream(stream, listener, geoJSON);
+    }
+
+    void GeoJSONGeometryReader::readFeatureCollectionFile(const std::string& fileName, const std::shared_ptr<GeoJSONFeatureReaderListener>& listener) const {
+        if (!listener) {
+            throw NullArgumentException("Null listener");
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        FILE* fpRaw = utf8_filesystem::fopen(fileName.c_str(), "rb");
+        if (!fpRaw) {
+            throw FileException("Failed to open file", fileName);
+        }
+        std::shared_ptr<FILE> fp(fpRaw, fclose);
+
+        std::vector<char> buffer(STREAM_BUFFER_SIZE);
+        rapidjson::FileReadStream stream(fp.get(), buffer.data(), buffer.size());
+        readFeatureCollectionStream(stream, listener, std::string());
+    }
+
+    void GeoJSONGeometryReader::readFeatureCollectionBlocks(const std::function<std::size_t(char*, std::size_t)>& readFn, const std::shared_ptr<GeoJSONFeatureReaderListener>& listener) const {
+        if (!listener) {
+            throw NullArgumentException("Null listener");
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        std::vector<char> buffer(STREAM_BUFFER_SIZE);
+        FunctionReadStream stream(readFn, buffer.data(), buffer.size());
+        readFeatureCollectionStream(stream, listener, std::string());
+    }
+
+    template <typename Stream>
+    void GeoJSONGeometryReader::readFeatureCollectionStream(Stream& stream, const std::shared_ptr<GeoJSONFeatureReaderListener>& listener, const std::string& source) const {
+        FeatureCollectionStreamHandler::FeatureCallback callback = [this, &listener](const Variant& featureValue) {
+            return listener->onFeatureRead(readFeature(featureValue));
+        };
+        FeatureCollectionStreamHandler handler(callback);
+
+        rapidjson::Reader reader;
+        rapidjson::ParseResult result = reader.Parse<rapidjson::kParseDefaultFlags>(stream, handler);
+        if (handler.isStopped()) {
+            return;
+        }
+        if (!handler.getError().empty()) {
+            throw ParseException(handler.getError());
+        }
+        if (result.IsError()) {
+            std::string err = rapidjson::GetParseError_En(result.Code());
+            throw ParseException(err, source, static_cast<int>(result.Offset()));
+        }
+        if (handler.getType().empty()) {
+            throw ParseException("Missing type information from feature collection");
+        }
+    }
+
     std::shared_ptr<FeatureCollection> GeoJSONGeometryReader::readFeatureCollection(const rapidjson::Value& value) const {
         if (!value.IsObject()) {
             throw ParseException("Wrong JSON type for feature collection");
@@ -161,9 +418,9 @@ namespace carto {
         if (type == "Point") {
             return std::make_shared<PointGeometry>(readPoint(value["coordinates"]));
         } else if (type == "LineString") {
-            return std::make_shared<LineGeometry>(readRing(value["coordinates"]));
+            return createLineGeometry(readRing(value["coordinates"]));
         } else if (type == "Polygon") {
-            return std::make_shared<PolygonGeometry>(readRings(value["coordinates"]));
+            return createPolygonGeometry(readRings(value["coordinates"]));
         } else if (type == "MultiPoint") {
             const rapidjson::Value& coordinates = value["coordinates"];
             if (!coordinates.IsArray()) {
@@ -183,7 +440,7 @@ namespace carto {
             std::vector<std::shared_ptr<LineGeometry> > lines;
             lines.reserve(coordinates.Size());
             for (rapidjson::SizeType i = 0; i < coordinates.Size(); i++) {
-                lines.push_back(std::make_shared<LineGeometry>(readRing(coordinates[i])));
+                lines.push_back(createLineGeometry(readRing(coordinates[i])));
             }
             return std::make_shared<MultiLineGeometry>(lines);
         } else if (type == "MultiPolygon") {
@@ -194,7 +451,7 @@ namespace carto {
             std::vector<std::shared_ptr<PolygonGeometry> > polygons;
             polygons.reserve(coordinates.Size());
             for (rapidjson::SizeType i = 0; i < coordinates.Size(); i++) {
-                polygons.push_back(std::make_shared<PolygonGeometry>(readRings(coordinates[i])));
+                polygons.push_back(createPolygonGeometry(readRings(coordinates[i])));
             }
             return std::make_shared<MultiPolygonGeometry>(polygons);
         } else if (type == "GeometryCollection") {
@@ -213,6 +470,126 @@ namespace carto {
         }
     }
 
+    std::shared_ptr<Feature> GeoJSONGeometryReader::readFeature(const Variant& value) const {
+        if (value.getType() != VariantType::VARIANT_TYPE_OBJECT) {
+            throw ParseException("Wrong JSON type for feature");
+        }
+
+        if (!value.containsObjectKey("type")) {
+            throw ParseException("Missing type information from feature");
+        }
+        std::string type = value.getObjectElement("type").getString();
+        if (type != "Feature") {
+             throw ParseException("Illegal type for the feature");
+        }
+
+        std::shared_ptr<Geometry> geometry = readGeometry(value.getObjectElement("geometry"));
+        Variant properties = value.getObjectElement("properties");
+        return std::make_shared<Feature>(std::move(geometry), std::move(properties));
+    }
+
+    std::shared_ptr<Geometry> GeoJSONGeometryReader::readGeometry(const Variant& value) const {
+        if (value.getType() != VariantType::VARIANT_TYPE_OBJECT) {
+            throw ParseException("Wrong JSON type for geometry");
+        }
+
+        if (!value.containsObjectKey("type")) {
+            throw ParseException("Missing type information from geometry");
+        }
+        std::string type = value.getObjectElement("type").getString();
+        if (type == "Point") {
+            return std::make_shared<PointGeometry>(readPoint(value.getObjectElement("coordinates")));
+        } else if (type == "LineString") {
+            return createLineGeometry(readRing(value.getObjectElement("coordinates")));
+        } else if (type == "Polygon") {
+            return createPolygonGeometry(readRings(value.getObjectElement("coordinates")));
+        } else if (type == "MultiPoint") {
+            Variant coordinates = value.getObjectElement("coordinates");
+            if (coordinates.getType() != VariantType::VARIANT_TYPE_ARRAY) {
+                throw ParseException("Wrong JSON type for coordinates");
+            }
+            std::vector<std::shared_ptr<PointGeometry> > points;
+            points.reserve(coordinates.getArraySize());
+            for (int i = 0; i < coordinates.getArraySize(); i++) {
+                points.push_back(std::make_shared<PointGeometry>(readPoint(coordinates.getArrayElement(i))));
+            }
+            return std::make_shared<MultiPointGeometry>(points);
+        } else if (type == "MultiLineString") {
+            Variant coordinates = value.getObjectElement("coordinates");
+            if (coordinates.getType() != VariantType::VARIANT_TYPE_ARRAY) {
+                throw ParseException("Wrong JSON type for coordinates");
+            }
+            std::vector<std::shared_ptr<LineGeometry> > lines;
+            lines.reserve(coordinates.getArraySize());
+            for (int i = 0; i < coordinates.getArraySize(); i++) {
+                lines.push_back(createLineGeometry(readRing(coordinates.getArrayElement(i))));
+            }
+            return std::make_shared<MultiLineGeometry>(lines);
+        } else if (type == "MultiPolygon") {
+            Variant coordinates = value.getObjectElement("coordinates");
+            if (coordinates.getType() != VariantType::VARIANT_TYPE_ARRAY) {
+                throw ParseException("Wrong JSON type for coordinates");
+            }
+            std::vector<std::shared_ptr<PolygonGeometry> > polygons;
+            polygons.reserve(coordinates.getArraySize());
+            for (int i = 0; i < coordinates.getArraySize(); i++) {
+                polygons.push_back(createPolygonGeometry(readRings(coordinates.getArrayElement(i))));
+            }
+            return std::make_shared<MultiPolygonGeometry>(polygons);
+        } else if (type == "GeometryCollection") {
+            Variant geometries = value.getObjectElement("geometries");
+            if (geometries.getType() != VariantType::VARIANT_TYPE_ARRAY) {
+                throw ParseException("Wrong JSON type for geometries");
+            }
+            std::vector<std::shared_ptr<Geometry> > geometryList;
+            geometryList.reserve(geometries.getArraySize());
+            for (int i = 0; i < geometries.getArraySize(); i++) {
+                geometryList.push_back(readGeometry(geometries.getArrayElement(i)));
+            }
+            return std::make_shared<MultiGeometry>(geometryList);
+        } else {
+            throw ParseException("Unsupported geometry type: " + type);
+        }
+    }
+
+    MapPos GeoJSONGeometryReader::readPoint(const Variant& value) const {
+        if (value.getType() != VariantType::VARIANT_TYPE_ARRAY) {
+            throw ParseException("Wrong JSON type for coordinates");
+        }
+        if (value.getArraySize() < 2) {
+            throw ParseException("Too few components in coordinates");
+        }
+        MapPos mapPos(value.getArrayElement(0).getDouble(), value.getArrayElement(1).getDouble(), value.getArraySize() > 2 ? value.getArrayElement(2).getDouble() : 0);
+        if (_targetProjection) {
+            mapPos = _targetProjection->fromWgs84(mapPos);
+        }
+        return mapPos;
+    }
+
+    std::vector<MapPos> GeoJSONGeometryReader::readRing(const Variant& value) const {
+        if (value.getType() != VariantType::VARIANT_TYPE_ARRAY) {
+            throw ParseException("Wrong JSON type for coordinates");
+        }
+        std::vector<MapPos> ring;
+        ring.reserve(value.getArraySize());
+        for (int i = 0; i < value.getArraySize(); i++) {
+            ring.push_back(readPoint(value.getArrayElement(i)));
+        }
+        return ring;
+    }
+
+    std::vector<std::vector<MapPos> > GeoJSONGeometryReader::readRings(const Variant& value) const {
+        if (value.getType() != VariantType::VARIANT_TYPE_ARRAY) {
+            throw ParseException("Wrong JSON type for coordinates");
+        }
+        std::vector<std::vector<MapPos> > rings;
+        rings.reserve(value.getArraySize());
+        for (int i = 0; i < value.getArraySize(); i++) {
+            rings.push_back(readRing(value.getArrayElement(i)));
+        }
+        return rings;
+    }
+
     Variant GeoJSONGeometryReader::readProperties(const rapidjson::Value& value) const {
         return Variant::FromPicoJSON(convertRapidJSON(value));
     }
@@ -255,4 +632,25 @@ namespace carto {
         return rings;
     }
 
+    std::shared_ptr<LineGeometry> GeoJSONGeometryReader::createLineGeometry(std::vector<MapPos> poses) const {
+        if (_compactCoordinateResolution > 0 && CompactMapPosList::IsRepresentable(poses, _compactCoordinateResolution)) {
+            return std::make_shared<LineGeometry>(std::make_shared<CompactMapPosList>(poses, _compactCoordinateResolution));
+        }
+        return std::make_shared<LineGeometry>(std::move(poses));
+    }
+
+    std::shared_ptr<PolygonGeometry> GeoJSONGeometryReader::createPolygonGeometry(std::vector<std::vector<MapPos> > rings) const {
+        if (_compactCoordinateResolution > 0 && std::all_of(rings.begin(), rings.end(), [this](const std::vector<MapPos>& ring) { return CompactMapPosList::IsRepresentable(ring, _compactCoordinateResolution); })) {
+            std::vector<std::shared_ptr<const CompactMapPosList> > compactRings;
+            compactRings.reserve(rings.size());
+            for (const std::vector<MapPos>& ring : rings) {
+                compactRings.push_back(std::make_shared<CompactMapPosList>(ring, _compactCoordinateResolution));
+            }
+            return std::make_shared<PolygonGeometry>(std::move(compactRings));
+        }
+        return std::make_shared<PolygonGeometry>(std::move(rings));
+    }
+
+    const std::size_t GeoJSONGeometryReader::STREAM_BUFFER_SIZE = 65536;
+
 }
@@ -10,6 +10,7 @@
 #include "core/MapPos.h"
 #include "core/Variant.h"
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -26,7 +27,10 @@ namespace rapidjson {
 namespace carto {
     class Feature;
     class FeatureCollection;
+    class GeoJSONFeatureReaderListener;
     class Geometry;
+    class LineGeometry;
+    class PolygonGeometry;
     class Projection;
 
     /**
@@ -54,6 +58,21 @@ namespace carto {
          */
         void setTargetProjection(const std::shared_ptr<Projection>& proj);
 
+        /**
+         * Returns the resolution used for compact storage of line and polygon coordinates.
+         * @return The resolution in target projection units. Zero if compact storage is disabled.
+         */
+        double getCompactCoordinateResolution() const;
+
+        /**
+         * Sets the resolution used for compact storage of line and polygon coordinates.
+         * If positive, 2D coordinates of lines and polygons are quantized to this resolution and stored in compact form,
+         * using a third of the memory of the full coordinates. Geometries with Z coordinates are always stored in full form.
+         * The default is zero, which disables compact storage.
+         * @param resolution The new resolution in target projection units.
+         */
+        void setCompactCoordinateResolution(double resolution);
+
         /**
          * Reads geometry from the specified GeoJSON string.
          * @param geoJSON The GeoJSON string to read.
@@ -78,7 +97,40 @@ namespace carto {
          */
         std::shared_ptr<FeatureCollection> readFeatureCollection(const std::string& geoJSON) const;
 
+        /**
+         * Reads feature collection from the specified GeoJSON string in streaming mode.
+         * Features are passed to the listener one at a time, without building the whole collection in memory.
+         * @param geoJSON The GeoJSON string to read.
+         * @param listener The listener to receive the features.
+         * @throws std::runtime_error If string could not be parsed.
+         */
+        void readFeatureCollection(const std::string& geoJSON, const std::shared_ptr<GeoJSONFeatureReaderListener>& listener) const;
+
+        /**
+         * Reads feature collection from the specified GeoJSON file in streaming mode.
+         * The file is read in small blocks and features are passed to the listener one at a time,
+         * so the memory usage does not depend on the size of the file.
+         * @param fileName The name of the GeoJSON file to read.
+         * @param listener The listener to receive the features.
+         * @throws std::ios_base::failure If the file could not be opened.
+         * @throws std::runtime_error If the file could not be parsed.
+         */
+        void readFeatureCollectionFile(const std::string& fileName, const std::shared_ptr<GeoJSONFeatureReaderListener>& listener) const;
+
+        /**
+         * Reads feature collection in streaming mode from blocks supplied by the given function.
+         * The function is called with a buffer and its size and must return the number of bytes written to the buffer,
+         * returning 0 signals the end of the input. Features are passed to the listener as soon as they are parsed.
+         * @param readFn The function supplying the input blocks.
+         * @param listener The listener to receive the features.
+         * @throws std::runtime_error If the input could not be parsed.
+         */
+        void readFeatureCollectionBlocks(const std::function<std::size_t(char*, std::size_t)>& readFn, const std::shared_ptr<GeoJSONFeatureReaderListener>& listener) const;
+
     private:
+        template <typename Stream>
+        void readFeatureCollectionStream(Stream& stream, const std::shared_ptr<GeoJSONFeatureReaderListener>& listener, const std::string& source) const;
+
         std::shared_ptr<FeatureCollection> readFeatureCollection(const rapidjson::Value& value) const;
         std::shared_ptr<Feature> readFeature(const rapidjson::Value& value) const;
         std::shared_ptr<Geometry> readGeometry(const rapidjson::Value& value) const;
@@ -87,7 +139,19 @@ namespace carto {
         std::vector<MapPos> readRing(const rapidjson::Value& value) const;
         std::vector<std::vector<MapPos> > readRings(const rapidjson::Value& value) const;
 
+        std::shared_ptr<Feature> readFeature(const Variant& value) const;
+        std::shared_ptr<Geometry> readGeometry(const Variant& value) const;
+        MapPos readPoint(const Variant& value) const;
+        std::vector<MapPos> readRing(const Variant& value) const;
+        std::vector<std::vector<MapPos> > readRings(const Variant& value) const;
+
+        std::shared_ptr<LineGeometry> createLineGeometry(std::vector<MapPos> poses) const;
+        std::shared_ptr<PolygonGeometry> createPolygonGeometry(std::vector<std::vector<MapPos> > rings) const;
+
+        static const std::size_t STREAM_BUFFER_SIZE;
+
         std::shared_ptr<Projection> _targetProjection;
+        double _compactCoordinateResolution;
         mutable std::mutex _mutex;
     };
 
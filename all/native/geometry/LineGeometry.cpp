@@ -1,5 +1,7 @@
 #include "LineGeometry.h"
 #include "core/MapPos.h"
+#include "components/Exceptions.h"
+#include "geometry/utils/CompactMapPosList.h"
 #include "utils/GeomUtils.h"
 #include "utils/Log.h"
 
@@ -7,7 +9,9 @@ namespace carto {
 
     LineGeometry::LineGeometry(std::vector<MapPos> poses) :
         Geometry(),
-        _poses(std::move(poses))
+        _poses(std::move(poses)),
+        _compactPoses(),
+        _expandedPoses()
     {
         if (_poses.size() < 2) {
             Log::Error("LineGeometry::LineGeometry: Line requires at least 2 vertices");
@@ -17,16 +21,52 @@ namespace carto {
             _bounds.expandToContain(pos);
         }
     }
+
+    LineGeometry::LineGeometry(const std::shared_ptr<const CompactMapPosList>& compactPoses) :
+        Geometry(),
+        _poses(),
+        _compactPoses(compactPoses),
+        _expandedPoses()
+    {
+        if (!compactPoses) {
+            throw NullArgumentException("Null compactPoses");
+        }
+
+        if (_compactPoses->size() < 2) {
+            Log::Error("LineGeometry::LineGeometry: Line requires at least 2 vertices");
+        }
+
+        _bounds = _compactPoses->calculateBounds();
+    }
     
     LineGeometry::~LineGeometry() {
     }
         
     MapPos LineGeometry::getCenterPos() const {
+        if (_compactPoses) {
+            return GeomUtils::CalculatePointOnLine(_compactPoses->getPoses());
+        }
         return GeomUtils::CalculatePointOnLine(_poses);
     }
     
     const std::vector<MapPos>& LineGeometry::getPoses() const {
-        return _poses;
+        if (!_compactPoses) {
+            return _poses;
+        }
+
+        // Expand the compact list once. If multiple threads race here, the first stored list is used by all of them
+        std::shared_ptr<const std::vector<MapPos> > expandedPoses = std::atomic_load(&_expandedPoses);
+        if (!expandedPoses) {
+            std::shared_ptr<const std::vector<MapPos> > newExpandedPoses = std::make_shared<std::vector<MapPos> >(_compactPoses->getPoses());
+            if (std::atomic_compare_exchange_strong(&_expandedPoses, &expandedPoses, newExpandedPoses)) {
+                expandedPoses = newExpandedPoses;
+            }
+        }
+        return *expandedPoses;
+    }
+
+    std::shared_ptr<const CompactMapPosList> LineGeometry::getCompactPoses() const {
+        return _compactPoses;
     }
     
 }
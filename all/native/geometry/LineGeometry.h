@@ -9,9 +9,11 @@
 
 #include "geometry/Geometry.h"
 
+#include <memory>
 #include <vector>
 
 namespace carto {
+    class CompactMapPosList;
 
     /**
      * Line geometry defined by a list of map positions.
@@ -23,18 +25,32 @@ namespace carto {
          * @param poses The map position list.
          */
         explicit LineGeometry(std::vector<MapPos> poses);
+        /**
+         * Constructs a new LineGeometry object from a compact 2D map position list.
+         * @param compactPoses The compact map position list.
+         */
+        explicit LineGeometry(const std::shared_ptr<const CompactMapPosList>& compactPoses);
         virtual ~LineGeometry();
         
         virtual MapPos getCenterPos() const;
     
         /**
          * Returns the list of of map positions defining the line.
+         * Note: for compact geometries the full list is created on first call and kept in memory.
          * @return The list of of map positions defining the line.
          */
         const std::vector<MapPos>& getPoses() const;
+
+        /**
+         * Returns the compact map position list of the line.
+         * @return The compact map position list of the line or null if the line is not stored in compact form.
+         */
+        std::shared_ptr<const CompactMapPosList> getCompactPoses() const;
     
     private:
         std::vector<MapPos> _poses;
+        std::shared_ptr<const CompactMapPosList> _compactPoses;
+        mutable std::shared_ptr<const std::vector<MapPos> > _expandedPoses;
     };
     
 }
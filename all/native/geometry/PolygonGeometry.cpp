@@ -1,5 +1,7 @@
 #include "PolygonGeometry.h"
 #include "core/MapPos.h"
+#include "components/Exceptions.h"
+#include "geometry/utils/CompactMapPosList.h"
 #include "utils/GeomUtils.h"
 #include "utils/Log.h"
 
@@ -7,7 +9,10 @@ namespace carto {
 
     PolygonGeometry::PolygonGeometry(std::vector<MapPos> poses) :
         Geometry(),
-        _rings()
+        _rings(),
+        _compactRings(),
+        _expandedRings(),
+        _triangulation()
     {
         if (poses.size() < 3) {
             Log::Error("PolygonGeometry::PolygonGeometry: Polygon requires at least 3 vertices");
@@ -23,7 +28,10 @@ namespace carto {
     
     PolygonGeometry::PolygonGeometry(std::vector<MapPos> poses, std::vector<std::vector<MapPos> > holes) :
         Geometry(),
-        _rings()
+        _rings(),
+        _compactRings(),
+        _expandedRings(),
+        _triangulation()
     {
         if (poses.size() < 3) {
             Log::Error("PolygonGeometry::PolygonGeometry: Polygon requires at least 3 vertices");
@@ -47,7 +55,10 @@ namespace carto {
     
     PolygonGeometry::PolygonGeometry(std::vector<std::vector<MapPos> > rings) :
         Geometry(),
-        _rings(std::move(rings))
+        _rings(std::move(rings)),
+        _compactRings(),
+        _expandedRings(),
+        _triangulation()
     {
         for (const std::vector<MapPos>& ring : _rings) {
             if (ring.size() < 3) {
@@ -63,30 +74,82 @@ namespace carto {
         }
     }
 
+    PolygonGeometry::PolygonGeometry(std::vector<std::shared_ptr<const CompactMapPosList> > compactRings) :
+        Geometry(),
+        _rings(),
+        _compactRings(std::move(compactRings)),
+        _expandedRings(),
+        _triangulation()
+    {
+        for (const std::shared_ptr<const CompactMapPosList>& compactRing : _compactRings) {
+            if (!compactRing) {
+                throw NullArgumentException("Null compactRing");
+            }
+            if (compactRing->size() < 3) {
+                Log::Error("PolygonGeometry::PolygonGeometry: All polygon rings require at least 3 vertices");
+            }
+        }
+
+        // Calculate bounding box
+        for (const std::shared_ptr<const CompactMapPosList>& compactRing : _compactRings) {
+            _bounds.expandToContain(compactRing->calculateBounds());
+        }
+    }
+
     PolygonGeometry::~PolygonGeometry() {
     }
         
     MapPos PolygonGeometry::getCenterPos() const {
+        if (!_compactRings.empty()) {
+            std::vector<std::vector<MapPos> > holes;
+            for (std::size_t i = 1; i < _compactRings.size(); i++) {
+                holes.push_back(_compactRings[i]->getPoses());
+            }
+            return GeomUtils::CalculatePointInsidePolygon(_compactRings.front()->getPoses(), holes);
+        }
         return GeomUtils::CalculatePointInsidePolygon(getPoses(), getHoles());
     }
     
     const std::vector<MapPos>& PolygonGeometry::getPoses() const {
         static const std::vector<MapPos> EmptyRing;
-        if (_rings.empty()) {
+        const std::vector<std::vector<MapPos> >& rings = getRings();
+        if (rings.empty()) {
             return EmptyRing;
         }
-        return _rings[0];
+        return rings[0];
     }
     
     std::vector<std::vector<MapPos> > PolygonGeometry::getHoles() const {
-        if (_rings.empty()) {
+        const std::vector<std::vector<MapPos> >& rings = getRings();
+        if (rings.empty()) {
             return std::vector<std::vector<MapPos> >();
         }
-        return std::vector<std::vector<MapPos> >(_rings.begin() + 1, _rings.end());
+        return std::vector<std::vector<MapPos> >(rings.begin() + 1, rings.end());
     }
     
     const std::vector<std::vector<MapPos> >& PolygonGeometry::getRings() const {
-        return _rings;
+        if (_compactRings.empty()) {
+            return _rings;
+        }
+
+        // Expand the compact rings once. If multiple threads race here, the first stored list is used by all of them
+        std::shared_ptr<const std::vector<std::vector<MapPos> > > expandedRings = std::atomic_load(&_expandedRings);
+        if (!expandedRings) {
+            auto rings = std::make_shared<std::vector<std::vector<MapPos> > >();
+            rings->reserve(_compactRings.size());
+            for (const std::shared_ptr<const CompactMapPosList>& compactRing : _compactRings) {
+                rings->push_back(compactRing->getPoses());
+            }
+            std::shared_ptr<const std::vector<std::vector<MapPos> > > newExpandedRings = rings;
+            if (std::atomic_compare_exchange_strong(&_expandedRings, &expandedRings, newExpandedRings)) {
+                expandedRings = newExpandedRings;
+            }
+        }
+        return *expandedRings;
+    }
+
+    const std::vector<std::shared_ptr<const CompactMapPosList> >& PolygonGeometry::getCompactRings() const {
+        return _compactRings;
     }
 
 }
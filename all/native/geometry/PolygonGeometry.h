@@ -9,9 +9,12 @@
 
 #include "geometry/Geometry.h"
 
+#include <memory>
+#include <string>
 #include <vector>
 
 namespace carto {
+    class CompactMapPosList;
 
     /**
      * Polygon geometry defined by an outer ring and optional multiple inner rings (holes).
@@ -35,12 +38,19 @@ namespace carto {
          * @param rings The list of map position lists defining the rings
          */
         explicit PolygonGeometry(std::vector<std::vector<MapPos> > rings);
+        /**
+         * Constructs a PolygonGeometry objects from a list of compact 2D rings.
+         * It is assumed the the first ring is outer ring and all other rings are inner rings.
+         * @param compactRings The list of compact map position lists defining the rings
+         */
+        explicit PolygonGeometry(std::vector<std::shared_ptr<const CompactMapPosList> > compactRings);
         virtual ~PolygonGeometry();
         
         virtual MapPos getCenterPos() const;
     
         /**
          * Returns the list of map positions defining the outer ring of the polygon.
+         * Note: for compact geometries the full rings are created on first call and kept in memory.
          * @returns The list of map positions defining the outer ring of the polygon.
          */
         const std::vector<MapPos>& getPoses() const;
@@ -57,8 +67,26 @@ namespace carto {
          */
         const std::vector<std::vector<MapPos> >& getRings() const;
 
+        /**
+         * Returns the list of compact map position lists defining the rings of the polygon.
+         * @returns The list of compact map position lists defining the rings of the polygon. Empty if the polygon is not stored in compact form.
+         */
+        const std::vector<std::shared_ptr<const CompactMapPosList> >& getCompactRings() const;
+
     private:
+        friend class PolygonDrawData;
+
+        // Triangulation of the rings in internal coordinates of a projection
+        struct Triangulation {
+            std::string projectionName;
+            std::vector<MapPos> poses; // triangle vertices, empty if the indices refer to the vertices of the rings
+            std::vector<unsigned int> indices;
+        };
+
         std::vector<std::vector<MapPos> > _rings;
+        std::vector<std::shared_ptr<const CompactMapPosList> > _compactRings;
+        mutable std::shared_ptr<const std::vector<std::vector<MapPos> > > _expandedRings;
+        mutable std::shared_ptr<const Triangulation> _triangulation; // cached by the draw datas of unclipped polygons
     };
     
 }
@@ -0,0 +1,194 @@
+#include "VisvalingamGeometrySimplifier.h"
+#include "core/MapPos.h"
+#include "geometry/Geometry.h"
+#include "geometry/LineGeometry.h"
+#include "geometry/PolygonGeometry.h"
+#include "geometry/utils/CompactMapPosList.h"
+#include "geometry/MultiGeometry.h"
+#include "geometry/MultiLineGeometry.h"
+#include "geometry/MultiPolygonGeometry.h"
+#include "projections/Projection.h"
+#include "projections/ProjectionSurface.h"
+
+#include <queue>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+namespace carto {
+
+    VisvalingamGeometrySimplifier::VisvalingamGeometrySimplifier(float tolerance) :
+        GeometrySimplifier(),
+        _tolerance(tolerance)
+    {
+    }
+
+    std::shared_ptr<Geometry> VisvalingamGeometrySimplifier::simplify(const std::shared_ptr<Geometry>& geometry, const std::shared_ptr<Projection>& projection, const std::shared_ptr<ProjectionSurface>& projectionSurface, float scale) const {
+        if (auto lineGeometry = std::dynamic_pointer_cast<LineGeometry>(geometry)) {
+            std::vector<MapPos> decodedPoses;
+            if (std::shared_ptr<const CompactMapPosList> compactPoses = lineGeometry->getCompactPoses()) {
+                decodedPoses = compactPoses->getPoses();
+            }
+            const std::vector<MapPos>& poses = lineGeometry->getCompactPoses() ? decodedPoses : lineGeometry->getPoses();
+            std::vector<MapPos> mapPoses = simplifyRing(poses, projection, projectionSurface, scale);
+            if (mapPoses.size() < 2) {
+                return std::shared_ptr<Geometry>();
+            }
+            bool simplified = mapPoses.size() < poses.size();
+            if (simplified) {
+                return std::make_shared<LineGeometry>(mapPoses);
+            }
+        } else if (auto polygonGeometry = std::dynamic_pointer_cast<PolygonGeometry>(geometry)) {
+            std::vector<std::vector<MapPos> > decodedRings;
+            for (const std::shared_ptr<const CompactMapPosList>& compactRing : polygonGeometry->getCompactRings()) {
+                decodedRings.push_back(compactRing->getPoses());
+            }
+            const std::vector<std::vector<MapPos> >& rings = polygonGeometry->getCompactRings().empty() ? polygonGeometry->getRings() : decodedRings;
+            if (rings.empty()) {
+                return std::shared_ptr<Geometry>();
+            }
+            std::vector<MapPos> mapPoses = simplifyRing(rings.front(), projection, projectionSurface, scale);
+            if (mapPoses.size() < 3) {
+                return std::shared_ptr<Geometry>();
+            }
+            bool simplified = mapPoses.size() < rings.front().size();
+            std::vector<std::vector<MapPos> > holes;
+            for (auto it = rings.begin() + 1; it != rings.end(); it++) {
+                const std::vector<MapPos>& holeRing = *it;
+                std::vector<MapPos> holeMapPoses = simplifyRing(holeRing, projection, projectionSurface, scale);
+                if (holeMapPoses.size() < holeRing.size()) {
+                    simplified = true;
+                }
+                if (holeMapPoses.size() >= 3) {
+                    holes.push_back(std::move(holeMapPoses));
+                } else {
+                    simplified = true;
+                }
+            }
+            if (simplified) {
+                return std::make_shared<PolygonGeometry>(mapPoses, holes);
+            }
+        } else if (auto multiLineGeometry = std::dynamic_pointer_cast<MultiLineGeometry>(geometry)) {
+            std::vector<std::shared_ptr<LineGeometry> > lines;
+            bool simplified = false;
+            for (int i = 0; i < multiLineGeometry->getGeometryCount(); i++) {
+                std::shared_ptr<Geometry> geom = simplify(multiLineGeometry->getGeometry(i), projection, projectionSurface, scale);
+                if (geom != multiLineGeometry->getGeometry(i)) {
+                    simplified = true;
+                }
+                if (auto line = std::dynamic_pointer_cast<LineGeometry>(geom)) {
+                    lines.push_back(line);
+                }
+            }
+            if (simplified) {
+                return std::make_shared<MultiLineGeometry>(lines);
+            }
+        } else if (auto multiPolygonGeometry = std::dynamic_pointer_cast<MultiPolygonGeometry>(geometry)) {
+            std::vector<std::shared_ptr<PolygonGeometry> > polygons;
+            bool simplified = false;
+            for (int i = 0; i < multiPolygonGeometry->getGeometryCount(); i++) {
+                std::shared_ptr<Geometry> geom = simplify(multiPolygonGeometry->getGeometry(i), projection, projectionSurface, scale);
+                if (geom != multiPolygonGeometry->getGeometry(i)) {
+                    simplified = true;
+                }
+                if (auto polygon = std::dynamic_pointer_cast<PolygonGeometry>(geom)) {
+                    polygons.push_back(polygon);
+                }
+            }
+            if (simplified) {
+                return std::make_shared<MultiPolygonGeometry>(polygons);
+            }
+        } else if (auto multiGeometry = std::dynamic_pointer_cast<MultiGeometry>(geometry)) {
+            std::vector<std::shared_ptr<Geometry> > geoms;
+            bool simplified = false;
+            for (int i = 0; i < multiGeometry->getGeometryCount(); i++) {
+                std::shared_ptr<Geometry> geom = simplify(multiGeometry->getGeometry(i), projection, projectionSurface, scale);
+                if (geom != multiGeometry->getGeometry(i)) {
+                    simplified = true;
+                }
+                if (geom) {
+                    geoms.push_back(geom);
+                }
+            }
+            if (simplified) {
+                return std::make_shared<MultiGeometry>(geoms);
+            }
+        }
+        return geometry;
+    }
+
+    std::vector<MapPos> VisvalingamGeometrySimplifier::simplifyRing(const std::vector<MapPos>& ring, const std::shared_ptr<Projection>& projection, const std::shared_ptr<ProjectionSurface>& projectionSurface, float scale) const {
+        if (ring.size() <= 2) {
+            return ring;
+        }
+
+        std::size_t pointCount = ring.size();
+        std::vector<cglib::vec3<double> > poses;
+        poses.reserve(pointCount);
+        for (const MapPos& mapPos : ring) {
+            poses.push_back(projectionSurface->calculatePosition(projection->toInternal(mapPos)));
+        }
+
+        // Compute doubled triangle areas, this avoids unneeded multiplications
+        auto calculateArea = [&poses](std::size_t i0, std::size_t i1, std::size_t i2) {
+            return cglib::length(cglib::vector_product(poses[i1] - poses[i0], poses[i2] - poses[i0])); // NOTE: not really correct on spherical surface but, but should still give reasonable results
+        };
+
+        // Doubly linked list of remaining points and a min-heap of their areas. Outdated heap entries are skipped when popped
+        std::vector<std::size_t> prevIndices(pointCount), nextIndices(pointCount);
+        std::vector<double> areas(pointCount, std::numeric_limits<double>::infinity());
+        typedef std::pair<double, std::size_t> HeapEntry;
+        std::vector<HeapEntry> heapEntries;
+        heapEntries.reserve(pointCount);
+        for (std::size_t i = 0; i < pointCount; i++) {
+            prevIndices[i] = (i > 0 ? i - 1 : 0);
+            nextIndices[i] = (i + 1 < pointCount ? i + 1 : i);
+            if (i > 0 && i + 1 < pointCount) {
+                areas[i] = calculateArea(i - 1, i, i + 1);
+                heapEntries.emplace_back(areas[i], i);
+            }
+        }
+        std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry> > heap(std::greater<HeapEntry>(), std::move(heapEntries));
+
+        double tolerance = static_cast<double>(scale) * _tolerance;
+        double maxArea = 2 * tolerance * tolerance;
+        std::vector<unsigned char> keys(pointCount, 1);
+        while (!heap.empty()) {
+            HeapEntry entry = heap.top();
+            if (entry.first > maxArea) {
+                break;
+            }
+            heap.pop();
+            std::size_t index = entry.second;
+            if (!keys[index] || entry.first != areas[index]) {
+                continue;
+            }
+
+            // Remove the point and update the areas of the neighbours. Areas never decrease, so that the removal order stays consistent
+            keys[index] = 0;
+            std::size_t prevIndex = prevIndices[index];
+            std::size_t nextIndex = nextIndices[index];
+            nextIndices[prevIndex] = nextIndex;
+            prevIndices[nextIndex] = prevIndex;
+            if (prevIndex > 0) {
+                areas[prevIndex] = std::max(calculateArea(prevIndices[prevIndex], prevIndex, nextIndex), entry.first);
+                heap.emplace(areas[prevIndex], prevIndex);
+            }
+            if (nextIndex + 1 < pointCount) {
+                areas[nextIndex] = std::max(calculateArea(prevIndex, nextIndex, nextIndices[nextIndex]), entry.first);
+                heap.emplace(areas[nextIndex], nextIndex);
+            }
+        }
+
+        std::vector<MapPos> simplifiedRing;
+        simplifiedRing.reserve(std::count(keys.begin(), keys.end(), 1));
+        for (std::size_t i = 0; i < pointCount; i++) {
+            if (keys[i]) {
+                simplifiedRing.push_back(ring[i]);
+            }
+        }
+        return simplifiedRing;
+    }
+
+}
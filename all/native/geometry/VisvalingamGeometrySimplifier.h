@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_VISVALINGAMGEOMETRYSIMPLIFIER_H_
+#define _CARTO_VISVALINGAMGEOMETRYSIMPLIFIER_H_
+
+#include "geometry/GeometrySimplifier.h"
+
+#include <vector>
+
+namespace carto {
+    class MapPos;
+
+    /**
+     * An implementation of Visvalingam-Whyatt algorithm for geometry simplification.
+     * Simplifier works on lines and polygons.
+     * Vertices are removed in the order of their effective area (the area of the triangle formed with their neighbours),
+     * until all remaining vertices have effective area above the tolerance. The complexity is O(n log n).
+     */
+    class VisvalingamGeometrySimplifier : public GeometrySimplifier {
+    public:
+        /**
+         * Constructs a new simplifier, given tolerance.
+         * @param tolerance The tolerance for simplification, in pixels. Vertices with effective area below the square of the tolerance are removed.
+         */
+        explicit VisvalingamGeometrySimplifier(float tolerance);
+
+        virtual std::shared_ptr<Geometry> simplify(const std::shared_ptr<Geometry>& geometry, const std::shared_ptr<Projection>& projection, const std::shared_ptr<ProjectionSurface>& projectionSurface, float scale) const;
+
+    private:
+        std::vector<MapPos> simplifyRing(const std::vector<MapPos>& ring, const std::shared_ptr<Projection>& projection, const std::shared_ptr<ProjectionSurface>& projectionSurface, float scale) const;
+
+        const float _tolerance;
+    };
+}
+
+#endif
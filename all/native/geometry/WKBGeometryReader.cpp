@@ -12,19 +12,37 @@
 #include "geometry/MultiLineGeometry.h"
 #include "geometry/MultiPolygonGeometry.h"
 #include "geometry/WKBGeometryEnums.h"
+#include "geometry/utils/CompactMapPosList.h"
 #include "utils/Log.h"
 
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
 
 namespace carto {
 
+    WKBGeometryReader::Stream::Stream() :
+        _data(nullptr),
+        _offset(0),
+        _bigEndian(),
+        _buffer()
+    {
+    }
+
     WKBGeometryReader::Stream::Stream(const std::vector<unsigned char>& data) :
-        _data(data),
+        _data(&data),
         _offset(0),
-        _bigEndian()
+        _bigEndian(),
+        _buffer()
     {
     }
 
+    void WKBGeometryReader::Stream::reset(const std::vector<unsigned char>& data) {
+        _data = &data;
+        _offset = 0;
+        _bigEndian = std::stack<bool>();
+    }
+
     void WKBGeometryReader::Stream::pushBigEndian(bool little) {
         _bigEndian.push(little);
     }
@@ -34,51 +52,80 @@ namespace carto {
     }
 
     unsigned char WKBGeometryReader::Stream::readByte() {
-        if (_offset + 1 > _data.size()) {
+        if (_offset + 1 > _data->size()) {
             throw ParseException("Stream array too short, can not read byte");
         }
-        return _data[_offset++];
+        return (*_data)[_offset++];
     }
 
     std::uint32_t WKBGeometryReader::Stream::readUInt32() {
-        if (_offset + 4 > _data.size()) {
+        if (_offset + 4 > _data->size()) {
             throw ParseException("Stream array too short, can not read 32-bit word");
         }
+        const unsigned char* data = _data->data() + _offset;
         std::uint32_t val = 0;
         if (_bigEndian.top()) {
-            val = _data[_offset + 0];
-            val = (val << 8) | _data[_offset + 1];
-            val = (val << 8) | _data[_offset + 2];
-            val = (val << 8) | _data[_offset + 3];
+            val = data[0];
+            val = (val << 8) | data[1];
+            val = (val << 8) | data[2];
+            val = (val << 8) | data[3];
         } else {
-            val = _data[_offset + 3];
-            val = (val << 8) | _data[_offset + 2];
-            val = (val << 8) | _data[_offset + 1];
-            val = (val << 8) | _data[_offset + 0];
+            val = data[3];
+            val = (val << 8) | data[2];
+            val = (val << 8) | data[1];
+            val = (val << 8) | data[0];
         }
         _offset += 4;
         return val;
     }
 
     double WKBGeometryReader::Stream::readDouble() {
-        if (_offset + 8 > _data.size()) {
+        double val = 0;
+        readDoubles(&val, 1);
+        return val;
+    }
+
+    void WKBGeometryReader::Stream::readDoubles(double* values, std::size_t count) {
+        if (count > (_data->size() - _offset) / sizeof(double)) {
             throw ParseException("Stream array too short, can not read double float");
         }
-        std::uint64_t val = 0;
-        if (_bigEndian.top()) {
-            for (int i = 0; i < 8; i++) {
-                val = (val << 8) | _data[_offset + i];
-            }
-        } else {
-            for (int i = 7; i >= 0; i--) {
-                val = (val << 8) | _data[_offset + i];
+
+        // Copy the values in a single block. If the byte order differs from the host byte order, swap the bytes in place
+        std::memcpy(values, _data->data() + _offset, count * sizeof(double));
+        if (_bigEndian.top() != IsHostBigEndian()) {
+            for (std::size_t i = 0; i < count; i++) {
+                std::uint64_t val = 0;
+                std::memcpy(&val, &values[i], sizeof(double));
+                val = ((val & 0x00000000000000FFULL) << 56) | ((val & 0x000000000000FF00ULL) << 40) | ((val & 0x0000000000FF0000ULL) << 24) | ((val & 0x00000000FF000000ULL) << 8) |
+                      ((val & 0x000000FF00000000ULL) >> 8) | ((val & 0x0000FF0000000000ULL) >> 24) | ((val & 0x00FF000000000000ULL) >> 40) | ((val & 0xFF00000000000000ULL) >> 56);
+                std::memcpy(&values[i], &val, sizeof(double));
             }
         }
-        _offset += 8;
-        return *reinterpret_cast<double*>(&val);
+        _offset += count * sizeof(double);
+    }
+
+    std::vector<double>& WKBGeometryReader::Stream::getBuffer() {
+        return _buffer;
     }
 
-    WKBGeometryReader::WKBGeometryReader() {
+    bool WKBGeometryReader::Stream::IsHostBigEndian() {
+        const std::uint16_t val = 1;
+        unsigned char firstByte = 0;
+        std::memcpy(&firstByte, &val, 1);
+        return firstByte == 0;
+    }
+
+    WKBGeometryReader::WKBGeometryReader() :
+        _compactCoordinateResolution(0)
+    {
+    }
+
+    double WKBGeometryReader::getCompactCoordinateResolution() const {
+        return _compactCoordinateResolution;
+    }
+
+    void WKBGeometryReader::setCompactCoordinateResolution(double resolution) {
+        _compactCoordinateResolution = resolution;
     }
 
     std::shared_ptr<Geometry> WKBGeometryReader::readGeometry(const std::shared_ptr<BinaryData>& wkbData) const {
@@ -90,6 +137,26 @@ namespace carto {
         return readGeometry(stream);
     }
 
+    std::vector<std::shared_ptr<Geometry> > WKBGeometryReader::readGeometries(const std::vector<std::shared_ptr<BinaryData> >& wkbDataList) const {
+        std::vector<std::shared_ptr<Geometry> > geometries;
+        geometries.reserve(wkbDataList.size());
+        Stream stream;
+        for (const std::shared_ptr<BinaryData>& wkbData : wkbDataList) {
+            std::shared_ptr<Geometry> geometry;
+            if (wkbData) {
+                try {
+                    stream.reset(*wkbData->getDataPtr());
+                    geometry = readGeometry(stream);
+                }
+                catch (const std::exception& ex) {
+                    Log::Errorf("WKBGeometryReader::readGeometries: Failed to read geometry: %s", ex.what());
+                }
+            }
+            geometries.push_back(geometry);
+        }
+        return geometries;
+    }
+
     std::shared_ptr<Geometry> WKBGeometryReader::readGeometry(Stream& stream) const {
         unsigned char bigEndian = stream.readByte();
         stream.pushBigEndian(bigEndian == WKB_XDR);
@@ -101,10 +168,10 @@ namespace carto {
             geometry = std::make_shared<PointGeometry>(readPoint(stream, type));
             break;
         case WKB_LINESTRING:
-            geometry = std::make_shared<LineGeometry>(readRing(stream, type));
+            geometry = createLineGeometry(readRing(stream, type));
             break;
         case WKB_POLYGON:
-            geometry = std::make_shared<PolygonGeometry>(readRings(stream, type));
+            geometry = createPolygonGeometry(readRings(stream, type));
             break;
         case WKB_MULTIPOINT:
             {
@@ -173,24 +240,29 @@ namespace carto {
     }
 
     MapPos WKBGeometryReader::readPoint(Stream& stream, std::uint32_t type) const {
-        double x = stream.readDouble();
-        double y = stream.readDouble();
-        double z = 0;
-        if (type & WKB_ZMASK) {
-            z = stream.readDouble();
-        }
-        if (type & WKB_MMASK) {
-            stream.readDouble();
-        }
-        return MapPos(x, y, z);
+        double coords[4] = { 0, 0, 0, 0 };
+        stream.readDoubles(coords, GetDimensions(type));
+        return MapPos(coords[0], coords[1], (type & WKB_ZMASK) ? coords[2] : 0);
     }
 
     std::vector<MapPos> WKBGeometryReader::readRing(Stream& stream, std::uint32_t type) const {
         std::uint32_t pointCount = stream.readUInt32();
+        std::size_t dims = GetDimensions(type);
+
+        // Read all coordinates of the ring in a single block, then build the positions from the buffer
+        std::vector<double>& coords = stream.getBuffer();
+        coords.resize(static_cast<std::size_t>(pointCount) * dims);
+        stream.readDoubles(coords.data(), coords.size());
         std::vector<MapPos> ring;
         ring.reserve(pointCount);
-        while (pointCount-- > 0) {
-            ring.push_back(readPoint(stream, type));
+        if (type & WKB_ZMASK) {
+            for (std::size_t i = 0; i < coords.size(); i += dims) {
+                ring.emplace_back(coords[i + 0], coords[i + 1], coords[i + 2]);
+            }
+        } else {
+            for (std::size_t i = 0; i < coords.size(); i += dims) {
+                ring.emplace_back(coords[i + 0], coords[i + 1]);
+            }
         }
         return ring;
     }
@@ -205,6 +277,29 @@ namespace carto {
         return rings;
     }
 
+    std::shared_ptr<LineGeometry> WKBGeometryReader::createLineGeometry(std::vector<MapPos> poses) const {
+        if (_compactCoordinateResolution > 0 && CompactMapPosList::IsRepresentable(poses, _compactCoordinateResolution)) {
+            return std::make_shared<LineGeometry>(std::make_shared<CompactMapPosList>(poses, _compactCoordinateResolution));
+        }
+        return std::make_shared<LineGeometry>(std::move(poses));
+    }
+
+    std::shared_ptr<PolygonGeometry> WKBGeometryReader::createPolygonGeometry(std::vector<std::vector<MapPos> > rings) const {
+        if (_compactCoordinateResolution > 0 && std::all_of(rings.begin(), rings.end(), [this](const std::vector<MapPos>& ring) { return CompactMapPosList::IsRepresentable(ring, _compactCoordinateResolution); })) {
+            std::vector<std::shared_ptr<const CompactMapPosList> > compactRings;
+            compactRings.reserve(rings.size());
+            for (const std::vector<MapPos>& ring : rings) {
+                compactRings.push_back(std::make_shared<CompactMapPosList>(ring, _compactCoordinateResolution));
+            }
+            return std::make_shared<PolygonGeometry>(std::move(compactRings));
+        }
+        return std::make_shared<PolygonGeometry>(std::move(rings));
+    }
+
+    std::size_t WKBGeometryReader::GetDimensions(std::uint32_t type) {
+        return 2 + ((type & WKB_ZMASK) ? 1 : 0) + ((type & WKB_MMASK) ? 1 : 0);
+    }
+
 }
 
 #endif
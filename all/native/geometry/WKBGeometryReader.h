@@ -19,6 +19,8 @@
 namespace carto {
     class BinaryData;
     class Geometry;
+    class LineGeometry;
+    class PolygonGeometry;
 
     /**
      * A WKB reader. Reads binary version of the Well Known Text representation of the geometry.
@@ -30,6 +32,20 @@ namespace carto {
          */
         WKBGeometryReader();
 
+        /**
+         * Returns the resolution used for compact storage of line and polygon coordinates.
+         * @return The resolution in geometry coordinate units. Zero if compact storage is disabled.
+         */
+        double getCompactCoordinateResolution() const;
+
+        /**
+         * Sets the resolution used for compact storage of line and polygon coordinates.
+         * If positive, 2D coordinates of lines and polygons are quantized to this resolution and stored in compact form.
+         * Geometries with Z coordinates are always stored in full form. The default is zero, which disables compact storage.
+         * @param resolution The new resolution in geometry coordinate units.
+         */
+        void setCompactCoordinateResolution(double resolution);
+
         /**
          * Reads geometry from the specified WKB data.
          * @param wkbData The WKB data to read.
@@ -38,9 +54,20 @@ namespace carto {
          */
         std::shared_ptr<Geometry> readGeometry(const std::shared_ptr<BinaryData>& wkbData) const;
 
+        /**
+         * Reads geometries from the specified list of WKB data blobs.
+         * This is faster than reading the blobs one by one, as the decoding buffers are shared between the blobs.
+         * @param wkbDataList The list of WKB data blobs to read.
+         * @return The list of geometries read, in the same order as the input blobs. Geometries of blobs that could not be read are null.
+         */
+        std::vector<std::shared_ptr<Geometry> > readGeometries(const std::vector<std::shared_ptr<BinaryData> >& wkbDataList) const;
+
     private:
         struct Stream {
-            Stream(const std::vector<unsigned char>& data);
+            Stream();
+            explicit Stream(const std::vector<unsigned char>& data);
+
+            void reset(const std::vector<unsigned char>& data);
 
             void pushBigEndian(bool little);
             void popBigEndian();
@@ -48,17 +75,30 @@ namespace carto {
             unsigned char readByte();
             std::uint32_t readUInt32();
             double readDouble();
+            void readDoubles(double* values, std::size_t count);
+
+            std::vector<double>& getBuffer();
         
         private:
-            const std::vector<unsigned char>& _data;
+            static bool IsHostBigEndian();
+
+            const std::vector<unsigned char>* _data;
             std::size_t _offset;
             std::stack<bool> _bigEndian;
+            std::vector<double> _buffer;
         };
 
         std::shared_ptr<Geometry> readGeometry(Stream& stream) const;
         MapPos readPoint(Stream& stream, std::uint32_t type) const;
         std::vector<MapPos> readRing(Stream& stream, std::uint32_t type) const;
         std::vector<std::vector<MapPos> > readRings(Stream& stream, std::uint32_t type) const;
+
+        std::shared_ptr<LineGeometry> createLineGeometry(std::vector<MapPos> poses) const;
+        std::shared_ptr<PolygonGeometry> createPolygonGeometry(std::vector<std::vector<MapPos> > rings) const;
+
+        static std::size_t GetDimensions(std::uint32_t type);
+
+        double _compactCoordinateResolution;
     };
 
 }
@@ -0,0 +1,90 @@
+#include "CompactMapPosList.h"
+#include "components/Exceptions.h"
+
+#include <cmath>
+#include <limits>
+
+namespace carto {
+
+    CompactMapPosList::CompactMapPosList(const std::vector<MapPos>& poses, double resolution) :
+        _origin(CalculateOrigin(poses)),
+        _resolution(resolution),
+        _coords()
+    {
+        if (!IsRepresentable(poses, resolution)) {
+            throw InvalidArgumentException("Positions can not be represented in compact form");
+        }
+
+        _coords.reserve(poses.size() * 2);
+        for (const MapPos& pos : poses) {
+            _coords.push_back(static_cast<std::int32_t>(std::llround((pos.getX() - _origin.getX()) / resolution)));
+            _coords.push_back(static_cast<std::int32_t>(std::llround((pos.getY() - _origin.getY()) / resolution)));
+        }
+    }
+
+    std::size_t CompactMapPosList::size() const {
+        return _coords.size() / 2;
+    }
+
+    bool CompactMapPosList::empty() const {
+        return _coords.empty();
+    }
+
+    double CompactMapPosList::getResolution() const {
+        return _resolution;
+    }
+
+    MapPos CompactMapPosList::getPos(std::size_t index) const {
+        return MapPos(_origin.getX() + _coords[index * 2 + 0] * _resolution, _origin.getY() + _coords[index * 2 + 1] * _resolution);
+    }
+
+    std::vector<MapPos> CompactMapPosList::getPoses() const {
+        std::vector<MapPos> poses;
+        poses.reserve(size());
+        for (std::size_t i = 0; i < _coords.size(); i += 2) {
+            poses.emplace_back(_origin.getX() + _coords[i + 0] * _resolution, _origin.getY() + _coords[i + 1] * _resolution);
+        }
+        return poses;
+    }
+
+    MapBounds CompactMapPosList::calculateBounds() const {
+        MapBounds bounds;
+        for (std::size_t i = 0; i < size(); i++) {
+            bounds.expandToContain(getPos(i));
+        }
+        return bounds;
+    }
+
+    bool CompactMapPosList::IsRepresentable(const std::vector<MapPos>& poses, double resolution) {
+        if (!(resolution > 0)) {
+            return false;
+        }
+
+        // All positions must be 2D and within the 32-bit range around the origin
+        MapPos origin = CalculateOrigin(poses);
+        double maxOffset = std::numeric_limits<std::int32_t>::max() * resolution;
+        for (const MapPos& pos : poses) {
+            if (pos.getZ() != 0) {
+                return false;
+            }
+            if (!(std::abs(pos.getX() - origin.getX()) < maxOffset && std::abs(pos.getY() - origin.getY()) < maxOffset)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    MapPos CompactMapPosList::CalculateOrigin(const std::vector<MapPos>& poses) {
+        if (poses.empty()) {
+            return MapPos(0, 0);
+        }
+
+        // Use bounds center, so that the full integer range is available in all directions
+        MapBounds bounds;
+        for (const MapPos& pos : poses) {
+            bounds.expandToContain(pos);
+        }
+        return MapPos(bounds.getCenter().getX(), bounds.getCenter().getY());
+    }
+
+}
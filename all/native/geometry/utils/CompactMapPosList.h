@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_COMPACTMAPPOSLIST_H_
+#define _CARTO_COMPACTMAPPOSLIST_H_
+
+#include "core/MapPos.h"
+#include "core/MapBounds.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace carto {
+
+    /**
+     * Immutable compact storage for 2D map positions.
+     * Coordinates are quantized to the given resolution and stored as 32-bit integers relative to an origin,
+     * so each position takes 8 bytes instead of 24 bytes of MapPos. Z coordinates are not stored, they are always zero.
+     */
+    class CompactMapPosList {
+    public:
+        CompactMapPosList(const std::vector<MapPos>& poses, double resolution);
+
+        std::size_t size() const;
+        bool empty() const;
+
+        double getResolution() const;
+
+        MapPos getPos(std::size_t index) const;
+        std::vector<MapPos> getPoses() const;
+
+        MapBounds calculateBounds() const;
+
+        static bool IsRepresentable(const std::vector<MapPos>& poses, double resolution);
+
+    private:
+        static MapPos CalculateOrigin(const std::vector<MapPos>& poses);
+
+        MapPos _origin;
+        double _resolution;
+        std::vector<std::int32_t> _coords; // interleaved x and y offsets from the origin, in resolution units
+    };
+
+}
+
+#endif
@@ -0,0 +1,160 @@
+#include "FeatureAttributeTable.h"
+#include "components/Exceptions.h"
+
+#include <map>
+
+namespace carto {
+
+    FeatureAttributeTable::FeatureAttributeTable() :
+        _rowCount(0),
+        _columnNames(),
+        _columnIndexMap(),
+        _columns(),
+        _rowVariantIndices(),
+        _strings(),
+        _variants()
+    {
+    }
+
+    FeatureAttributeTable::FeatureAttributeTable(const std::vector<Variant>& rows) :
+        _rowCount(rows.size()),
+        _columnNames(),
+        _columnIndexMap(),
+        _columns(),
+        _rowVariantIndices(rows.size(), NO_ROW_VARIANT),
+        _strings(),
+        _variants()
+    {
+        std::unordered_map<std::string, std::uint32_t> stringIndexMap;
+        for (std::size_t row = 0; row < rows.size(); row++) {
+            const Variant& var = rows[row];
+            if (var.getType() != VariantType::VARIANT_TYPE_OBJECT) {
+                _rowVariantIndices[row] = static_cast<std::uint32_t>(_variants.size());
+                _variants.push_back(var);
+                continue;
+            }
+
+            for (const std::string& key : var.getObjectKeys()) {
+                auto it = _columnIndexMap.find(key);
+                if (it == _columnIndexMap.end()) {
+                    it = _columnIndexMap.emplace(key, static_cast<int>(_columns.size())).first;
+                    _columnNames.push_back(key);
+                    _columns.emplace_back();
+                    _columns.back().types.resize(rows.size(), CELL_TYPE_NONE);
+                    _columns.back().cells.resize(rows.size());
+                }
+                Column& column = _columns[it->second];
+
+                Variant value = var.getObjectElement(key);
+                Cell& cell = column.cells[row];
+                switch (value.getType()) {
+                case VariantType::VARIANT_TYPE_NULL:
+                    column.types[row] = CELL_TYPE_NULL;
+                    break;
+                case VariantType::VARIANT_TYPE_BOOL:
+                    column.types[row] = CELL_TYPE_BOOL;
+                    cell.boolVal = value.getBool();
+                    break;
+                case VariantType::VARIANT_TYPE_INTEGER:
+                    column.types[row] = CELL_TYPE_INTEGER;
+                    cell.longVal = value.getLong();
+                    break;
+                case VariantType::VARIANT_TYPE_DOUBLE:
+                    column.types[row] = CELL_TYPE_DOUBLE;
+                    cell.doubleVal = value.getDouble();
+                    break;
+                case VariantType::VARIANT_TYPE_STRING: {
+                        std::string str = value.getString();
+                        auto strIt = stringIndexMap.find(str);
+                        if (strIt == stringIndexMap.end()) {
+                            strIt = stringIndexMap.emplace(str, static_cast<std::uint32_t>(_strings.size())).first;
+                            _strings.push_back(str);
+                        }
+                        column.types[row] = CELL_TYPE_STRING;
+                        cell.index = strIt->second;
+                    }
+                    break;
+                default:
+                    column.types[row] = CELL_TYPE_VARIANT;
+                    cell.index = static_cast<std::uint32_t>(_variants.size());
+                    _variants.push_back(value);
+                    break;
+                }
+            }
+        }
+    }
+
+    std::size_t FeatureAttributeTable::getRowCount() const {
+        return _rowCount;
+    }
+
+    const std::vector<std::string>& FeatureAttributeTable::getColumnNames() const {
+        return _columnNames;
+    }
+
+    int FeatureAttributeTable::getColumnIndex(const std::string& name) const {
+        auto it = _columnIndexMap.find(name);
+        if (it == _columnIndexMap.end()) {
+            return -1;
+        }
+        return it->second;
+    }
+
+    bool FeatureAttributeTable::getValue(std::size_t row, int column, Variant& value) const {
+        if (row >= _rowCount) {
+            throw OutOfRangeException("Row index out of range");
+        }
+        if (column < 0 || column >= static_cast<int>(_columns.size())) {
+            return false;
+        }
+
+        const Cell& cell = _columns[column].cells[row];
+        switch (_columns[column].types[row]) {
+        case CELL_TYPE_NULL:
+            value = Variant();
+            return true;
+        case CELL_TYPE_BOOL:
+            value = Variant(cell.boolVal);
+            return true;
+        case CELL_TYPE_INTEGER:
+            value = Variant(cell.longVal);
+            return true;
+        case CELL_TYPE_DOUBLE:
+            value = Variant(cell.doubleVal);
+            return true;
+        case CELL_TYPE_STRING:
+            value = Variant(_strings[cell.index]);
+            return true;
+        case CELL_TYPE_VARIANT:
+            value = _variants[cell.index];
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    bool FeatureAttributeTable::getValue(std::size_t row, const std::string& name, Variant& value) const {
+        return getValue(row, getColumnIndex(name), value);
+    }
+
+    Variant FeatureAttributeTable::getRow(std::size_t row) const {
+        if (row >= _rowCount) {
+            throw OutOfRangeException("Row index out of range");
+        }
+        if (_rowVariantIndices[row] != NO_ROW_VARIANT) {
+            return _variants[_rowVariantIndices[row]];
+        }
+
+        std::map<std::string, Variant> object;
+        for (std::size_t column = 0; column < _columns.size(); column++) {
+            Variant value;
+            if (getValue(row, static_cast<int>(column), value)) {
+                object[_columnNames[column]] = value;
+            }
+        }
+        return Variant(object);
+    }
+
+    const std::uint32_t FeatureAttributeTable::NO_ROW_VARIANT = static_cast<std::uint32_t>(-1);
+
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_FEATUREATTRIBUTETABLE_H_
+#define _CARTO_FEATUREATTRIBUTETABLE_H_
+
+#include "core/Variant.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace carto {
+
+    /**
+     * Immutable columnar storage for feature properties.
+     * Each property key gets its own column with a type tag and an 8-byte value per row.
+     * Strings are dictionary-encoded over the whole table and arrays/objects are kept as Variants.
+     * Rows with non-object properties are stored as Variants as a whole.
+     */
+    class FeatureAttributeTable {
+    public:
+        FeatureAttributeTable();
+        explicit FeatureAttributeTable(const std::vector<Variant>& rows);
+
+        std::size_t getRowCount() const;
+
+        const std::vector<std::string>& getColumnNames() const;
+        int getColumnIndex(const std::string& name) const;
+
+        bool getValue(std::size_t row, int column, Variant& value) const;
+        bool getValue(std::size_t row, const std::string& name, Variant& value) const;
+
+        Variant getRow(std::size_t row) const;
+
+    private:
+        enum CellType {
+            CELL_TYPE_NONE,
+            CELL_TYPE_NULL,
+            CELL_TYPE_BOOL,
+            CELL_TYPE_INTEGER,
+            CELL_TYPE_DOUBLE,
+            CELL_TYPE_STRING,
+            CELL_TYPE_VARIANT
+        };
+
+        union Cell {
+            bool boolVal;
+            long long longVal;
+            double doubleVal;
+            std::uint32_t index;
+        };
+
+        struct Column {
+            std::vector<std::uint8_t> types;
+            std::vector<Cell> cells;
+        };
+
+        static const std::uint32_t NO_ROW_VARIANT;
+
+        std::size_t _rowCount;
+        std::vector<std::string> _columnNames;
+        std::unordered_map<std::string, int> _columnIndexMap;
+        std::vector<Column> _columns;
+        std::vector<std::uint32_t> _rowVariantIndices;
+        std::vector<std::string> _strings;
+        std::vector<Variant> _variants;
+    };
+
+}
+
+#endif
@@ -10,6 +10,8 @@
 #include "geometry/utils/SpatialIndex.h"
 
 #include <list>
+#include <map>
+#include <memory>
 
 namespace carto {
 
@@ -26,6 +28,7 @@ namespace carto {
         virtual void insert(const cglib::bbox3<double>& bounds, const T& object);
         virtual bool remove(const cglib::bbox3<double>& bounds, const T& object);
         virtual bool remove(const T& object);
+        virtual bool update(const cglib::bbox3<double>& bounds, const T& object);
         
         virtual std::vector<T> query(const cglib::frustum3<double>& frustum) const;
         virtual std::vector<T> query(const cglib::bbox3<double>& bounds) const;
@@ -42,39 +45,49 @@ namespace carto {
         
         class Node {
         public:
-            Node(const cglib::bbox3<double>& bounds);
+            Node(const cglib::bbox3<double>& bounds, Node* parent);
             
             cglib::bbox3<double> bounds;
             std::list<Record> records;
             std::vector<std::shared_ptr<Node> > children; // <, >= half-planes
+            Node* parent;
             int axis; // splitting axis (0 is x, 1 is y, 2 is z)
             double distance; // only defined if children != null, once defined, becomes immutable
         };
+
+        struct Handle {
+            Node* node;
+            typename std::list<Record>::iterator recordIt;
+        };
+
+        typedef std::multimap<T, Handle> HandleMap;
         
         static const int MAX_DEPTH = 20;
         static const std::size_t MIN_SPLIT_COUNT = 2;
         
         void insertToNode(const std::shared_ptr<Node>& node, const cglib::bbox3<double>& bounds, const T& object, int depth);
-        std::shared_ptr<Node> removeFromNode(const std::shared_ptr<Node>& node, const cglib::bbox3<double>* bounds, const T& object);
+        void removeRecord(const Handle& handle);
+
+        static bool ContainsBounds(const cglib::bbox3<double>& outerBounds, const cglib::bbox3<double>& innerBounds);
         
         void queryNode(const std::shared_ptr<Node>& node, const cglib::frustum3<double>& frustum, std::vector<T>& results) const;
         void queryNode(const std::shared_ptr<Node>& node, const cglib::bbox3<double>& bounds, std::vector<T>& results) const;
         void getAllFromNode(const std::shared_ptr<Node>& node, std::vector<T>& results) const;
         
         std::shared_ptr<Node> _root;
-        std::size_t _count;
+        HandleMap _handles; // the node and record of each indexed object, so that objects can be removed without searching the tree
     };
     
     template<typename T>
     KDTreeSpatialIndex<T>::KDTreeSpatialIndex() :
         _root(),
-        _count(0)
+        _handles()
     {
     }
     
     template<typename T>
     std::size_t KDTreeSpatialIndex<T>::size() const {
-        return _count;
+        return _handles.size();
     }
     
     template<typename T>
@@ -84,29 +97,55 @@ namespace carto {
     template<typename T>
     void KDTreeSpatialIndex<T>::clear() {
         _root.reset();
-        _count = 0;
+        _handles.clear();
     }
     
     template<typename T>
     void KDTreeSpatialIndex<T>::insert(const cglib::bbox3<double>& bounds, const T& object) {
         if (!_root) {
-            _root = std::make_shared<Node>(bounds);
+            _root = std::make_shared<Node>(bounds, nullptr);
         }
         insertToNode(_root, bounds, object, 0);
     }
     
     template<typename T>
     bool KDTreeSpatialIndex<T>::remove(const cglib::bbox3<double>& bounds, const T& object) {
-        std::size_t count = _count;
-        _root = removeFromNode(_root, &bounds, object);
-        return count != _count;
+        // The handles locate the records directly, the bounds are not needed
+        return remove(object);
     }
     
     template<typename T>
     bool KDTreeSpatialIndex<T>::remove(const T& object) {
-        std::size_t count = _count;
-        _root = removeFromNode(_root, nullptr, object);
-        return count != _count;
+        auto range = _handles.equal_range(object);
+        if (range.first == range.second) {
+            return false;
+        }
+        for (auto it = range.first; it != range.second; ++it) {
+            removeRecord(it->second);
+        }
+        _handles.erase(range.first, range.second);
+        return true;
+    }
+    
+    template<typename T>
+    bool KDTreeSpatialIndex<T>::update(const cglib::bbox3<double>& bounds, const T& object) {
+        auto it = _handles.find(object);
+        if (it == _handles.end()) {
+            return false;
+        }
+
+        // If the object stays within its leaf node, update the record in place
+        if (_handles.count(object) == 1) {
+            Handle& handle = it->second;
+            if (handle.node->children.empty() && ContainsBounds(handle.node->bounds, bounds)) {
+                handle.recordIt->bounds = bounds;
+                return true;
+            }
+        }
+
+        remove(object);
+        insert(bounds, object);
+        return true;
     }
     
     template<typename T>
@@ -138,10 +177,11 @@ namespace carto {
     }
     
     template<typename T>
-    KDTreeSpatialIndex<T>::Node::Node(const cglib::bbox3<double>& bounds) :
+    KDTreeSpatialIndex<T>::Node::Node(const cglib::bbox3<double>& bounds, Node* parent) :
         bounds(bounds),
         records(),
         children(),
+        parent(parent),
         axis(0),
         distance(-1)
     {
@@ -155,14 +195,14 @@ namespace carto {
         // If depth limit has been exceeded, add to current node
         if (depth >= MAX_DEPTH) {
             node->records.emplace_back(bounds, object);
-            _count++;
+            _handles.insert(std::make_pair(object, Handle { node.get(), std::prev(node->records.end()) }));
             return;
         }
         
         // Add to node records if this is leaf node
         if (node->children.empty()) {
             node->records.emplace_back(bounds, object);
-            _count++;
+            _handles.insert(std::make_pair(object, Handle { node.get(), std::prev(node->records.end()) }));
             
             // Create children and redistribute node records among children if enough records have been added
             if (node->records.size() > MIN_SPLIT_COUNT) {
@@ -179,15 +219,25 @@ namespace carto {
                 for (const Record& record : node->records) {
                     int index = record.bounds.center()(axis) >= distance ? 1 : 0;
                     if (!children[index]) {
-                        children[index] = std::make_shared<Node>(record.bounds);
+                        children[index] = std::make_shared<Node>(record.bounds, node.get());
                     } else {
                         children[index]->bounds.add(record.bounds);
                     }
-                    children[index]->records.push_back(record);
                 }
                 
-                // Check that split succeeded
+                // Check that split succeeded, move the records and update their handles
                 if (children[0] && children[1]) {
+                    for (const Record& record : node->records) {
+                        std::shared_ptr<Node>& child = children[record.bounds.center()(axis) >= distance ? 1 : 0];
+                        child->records.push_back(record);
+                        auto range = _handles.equal_range(record.object);
+                        for (auto it = range.first; it != range.second; ++it) {
+                            if (it->second.node == node.get() && &*it->second.recordIt == &record) {
+                                it->second = Handle { child.get(), std::prev(child->records.end()) };
+                                break;
+                            }
+                        }
+                    }
                     node->children = std::move(children);
                     node->axis = axis;
                     node->distance = distance;
@@ -198,44 +248,48 @@ namespace carto {
         }
         
         // Recurse to children
-        int index = (node->bounds.center()(node->axis) >= node->distance ? 1 : 0);
+        int index = (bounds.center()(node->axis) >= node->distance ? 1 : 0);
         if (!node->children[index]) {
-            node->children[index] = std::make_shared<Node>(bounds);
+            node->children[index] = std::make_shared<Node>(bounds, node.get());
         }
         insertToNode(node->children[index], bounds, object, depth + 1);
     }
     
     template<typename T>
-    std::shared_ptr<typename KDTreeSpatialIndex<T>::Node> KDTreeSpatialIndex<T>::removeFromNode(const std::shared_ptr<Node>& node, const cglib::bbox3<double>* bounds, const T& object) {
-        // Check if we need to proceed
-        if (!node) {
-            return node;
-        }
-        if (bounds && !node->bounds.inside(*bounds)) {
-            return node;
-        }
+    void KDTreeSpatialIndex<T>::removeRecord(const Handle& handle) {
+        Node* node = handle.node;
+        node->records.erase(handle.recordIt);
         
-        // Remove object from current node
-        for (auto it = node->records.begin(); it != node->records.end(); ++it) {
-            const Record& record = *it;
-            if (record.object == object) {
-                it = node->records.erase(it);
-                _count--;
+        // Prune the empty nodes up to the root
+        while (node->records.empty() && node->children.empty()) {
+            Node* parent = node->parent;
+            if (!parent) {
+                _root.reset();
+                return;
             }
-        }
-        
-        // Recurse and prune
-        bool empty = true;
-        for (std::size_t i = 0; i < node->children.size(); i++) {
-            node->children[i] = removeFromNode(node->children[i], bounds, object);
-            if (node->children[i]) {
-                empty = false;
+            bool empty = true;
+            for (std::shared_ptr<Node>& child : parent->children) {
+                if (child.get() == node) {
+                    child.reset();
+                } else if (child) {
+                    empty = false;
+                }
+            }
+            if (empty) {
+                parent->children.clear();
             }
+            node = parent;
         }
-        if (empty) {
-            node->children.clear();
+    }
+    
+    template<typename T>
+    bool KDTreeSpatialIndex<T>::ContainsBounds(const cglib::bbox3<double>& outerBounds, const cglib::bbox3<double>& innerBounds) {
+        for (int i = 0; i < 3; i++) {
+            if (innerBounds.min(i) < outerBounds.min(i) || innerBounds.max(i) > outerBounds.max(i)) {
+                return false;
+            }
         }
-        return node->records.empty() && node->children.empty() ? std::shared_ptr<Node>() : node;
+        return true;
     }
     
     template<typename T>
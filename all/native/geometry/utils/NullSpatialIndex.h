@@ -24,6 +24,7 @@ namespace carto {
         
         virtual void clear();
         virtual void insert(const cglib::bbox3<double>& bounds, const T& object);
+        virtual void insertAll(const std::vector<cglib::bbox3<double> >& bounds, const std::vector<T>& objects);
         virtual bool remove(const cglib::bbox3<double>& bounds, const T& object);
         virtual bool remove(const T& object);
         
@@ -61,6 +62,11 @@ namespace carto {
         _objects.push_back(object);
     }
     
+    template<typename T>
+    void NullSpatialIndex<T>::insertAll(const std::vector<cglib::bbox3<double> >& bounds, const std::vector<T>& objects) {
+        _objects.insert(_objects.end(), objects.begin(), objects.end());
+    }
+    
     template<typename T>
     bool NullSpatialIndex<T>::remove(const cglib::bbox3<double>& bounds, const T& object) {
         return remove(object);
@@ -0,0 +1,668 @@
+#include "PolygonTriangulator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace carto {
+
+    bool PolygonTriangulator::Triangulate(const std::vector<std::vector<MapPos> >& rings, std::vector<unsigned int>& indices) {
+        indices.clear();
+        if (rings.empty() || rings.front().size() < 3) {
+            return false;
+        }
+
+        PolygonTriangulator triangulator(indices);
+        triangulator.triangulate(rings);
+
+        // Verify the result, the triangles must cover exactly the area of the outer ring minus the holes
+        std::vector<const MapPos*> poses;
+        poses.reserve(triangulator._vertexCount);
+        double totalArea = 0;
+        double polygonArea = 0;
+        for (std::size_t i = 0; i < rings.size(); i++) {
+            for (const MapPos& pos : rings[i]) {
+                poses.push_back(&pos);
+            }
+            double ringArea = std::abs(CalculateRingArea(rings[i]));
+            totalArea += ringArea;
+            polygonArea += (i == 0 ? ringArea : -ringArea);
+        }
+        double triangleArea = 0;
+        for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+            const MapPos& p0 = *poses[indices[i + 0]];
+            const MapPos& p1 = *poses[indices[i + 1]];
+            const MapPos& p2 = *poses[indices[i + 2]];
+            triangleArea += std::abs((p1.getX() - p0.getX()) * (p2.getY() - p0.getY()) - (p2.getX() - p0.getX()) * (p1.getY() - p0.getY())) * 0.5;
+        }
+        if (indices.empty() || std::abs(triangleArea - polygonArea) > totalArea * AREA_TOLERANCE) {
+            indices.clear();
+            return false;
+        }
+        return true;
+    }
+
+    PolygonTriangulator::PolygonTriangulator(std::vector<unsigned int>& indices) :
+        _indices(indices),
+        _nodes(),
+        _vertexCount(0),
+        _hashing(false),
+        _minX(0),
+        _minY(0),
+        _invSize(0)
+    {
+    }
+
+    void PolygonTriangulator::triangulate(const std::vector<std::vector<MapPos> >& rings) {
+        std::size_t count = 0;
+        for (const std::vector<MapPos>& ring : rings) {
+            count += ring.size();
+        }
+        _indices.reserve(count * 3);
+
+        Node* outerNode = linkedList(rings.front(), true);
+        if (!outerNode || outerNode->prev == outerNode->next) {
+            return;
+        }
+        if (rings.size() > 1) {
+            outerNode = eliminateHoles(rings, outerNode);
+        }
+
+        // Use z-order curve hashing only for bigger polygons, the overhead is not worth it for small ones
+        _hashing = (count > HASHING_THRESHOLD);
+        if (_hashing) {
+            Node* p = outerNode->next;
+            double minX = p->x, minY = p->y, maxX = p->x, maxY = p->y;
+            do {
+                minX = std::min(minX, p->x);
+                minY = std::min(minY, p->y);
+                maxX = std::max(maxX, p->x);
+                maxY = std::max(maxY, p->y);
+                p = p->next;
+            } while (p != outerNode);
+
+            double size = std::max(maxX - minX, maxY - minY);
+            _minX = minX;
+            _minY = minY;
+            _invSize = (size != 0 ? 32767 / size : 0);
+        }
+
+        earcutLinked(outerNode);
+    }
+
+    PolygonTriangulator::Node* PolygonTriangulator::linkedList(const std::vector<MapPos>& ring, bool clockwise) {
+        // Create a circular doubly linked list from the ring vertices in the specified winding order
+        double sum = 0;
+        std::size_t len = ring.size();
+        for (std::size_t i = 0, j = (len > 0 ? len - 1 : 0); i < len; j = i++) {
+            sum += (ring[j].getX() - ring[i].getX()) * (ring[i].getY() + ring[j].getY());
+        }
+
+        Node* last = nullptr;
+        if (clockwise == (sum > 0)) {
+            for (std::size_t i = 0; i < len; i++) {
+                last = insertNode(_vertexCount + static_cast<unsigned int>(i), ring[i], last);
+            }
+        } else {
+            for (std::size_t i = len; i-- > 0; ) {
+                last = insertNode(_vertexCount + static_cast<unsigned int>(i), ring[i], last);
+            }
+        }
+
+        if (last && Equals(last, last->next)) {
+            RemoveNode(last);
+            last = last->next;
+        }
+
+        _vertexCount += static_cast<unsigned int>(len);
+        return last;
+    }
+
+    PolygonTriangulator::Node* PolygonTriangulator::filterPoints(Node* start, Node* end) {
+        // Eliminate colinear or duplicate points
+        if (!end) {
+            end = start;
+        }
+
+        Node* p = start;
+        bool again = false;
+        do {
+            again = false;
+            if (!p->steiner && (Equals(p, p->next) || Area(p->prev, p, p->next) == 0)) {
+                RemoveNode(p);
+                p = end = p->prev;
+                if (p == p->next) {
+                    break;
+                }
+                again = true;
+            } else {
+                p = p->next;
+            }
+        } while (again || p != end);
+
+        return end;
+    }
+
+    void PolygonTriangulator::earcutLinked(Node* ear, int pass) {
+        if (!ear) {
+            return;
+        }
+
+        // Interlink polygon nodes in z-order
+        if (pass == 0 && _hashing) {
+            indexCurve(ear);
+        }
+
+        // Iterate through ears, slicing them one by one
+        Node* stop = ear;
+        while (ear->prev != ear->next) {
+            Node* prev = ear->prev;
+            Node* next = ear->next;
+
+            if (_hashing ? isEarHashed(ear) : isEar(ear)) {
+                addTriangle(prev, ear, next);
+                RemoveNode(ear);
+
+                // Skipping the next vertex leads to less sliver triangles
+                ear = next->next;
+                stop = next->next;
+                continue;
+            }
+
+            ear = next;
+
+            // If we looped through the whole remaining polygon and can't find any more ears, try to recover
+            if (ear == stop) {
+                if (pass == 0) {
+                    earcutLinked(filterPoints(ear), 1);
+                } else if (pass == 1) {
+                    ear = cureLocalIntersections(filterPoints(ear));
+                    earcutLinked(ear, 2);
+                } else if (pass == 2) {
+                    splitEarcut(ear);
+                }
+                break;
+            }
+        }
+    }
+
+    bool PolygonTriangulator::isEar(Node* ear) const {
+        const Node* a = ear->prev;
+        const Node* b = ear;
+        const Node* c = ear->next;
+
+        // Reflex, can't be an ear
+        if (Area(a, b, c) >= 0) {
+            return false;
+        }
+
+        // Now make sure we don't have other points inside the potential ear
+        Node* p = ear->next->next;
+        while (p != ear->prev) {
+            if (PointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) && Area(p->prev, p, p->next) >= 0) {
+                return false;
+            }
+            p = p->next;
+        }
+        return true;
+    }
+
+    bool PolygonTriangulator::isEarHashed(Node* ear) const {
+        const Node* a = ear->prev;
+        const Node* b = ear;
+        const Node* c = ear->next;
+
+        if (Area(a, b, c) >= 0) {
+            return false;
+        }
+
+        // Triangle bounds and z-order range of the points that may be inside the triangle
+        double minTX = std::min(a->x, std::min(b->x, c->x));
+        double minTY = std::min(a->y, std::min(b->y, c->y));
+        double maxTX = std::max(a->x, std::max(b->x, c->x));
+        double maxTY = std::max(a->y, std::max(b->y, c->y));
+        std::int32_t minZ = zOrder(minTX, minTY);
+        std::int32_t maxZ = zOrder(maxTX, maxTY);
+
+        auto isInside = [a, b, c, ear](const Node* p) {
+            return p != ear->prev && p != ear->next && PointInTriangle(a->x, a->y, b->x, b->y, c->x, c->y, p->x, p->y) && Area(p->prev, p, p->next) >= 0;
+        };
+
+        // Look for points inside the triangle in both directions
+        const Node* p = ear->prevZ;
+        const Node* n = ear->nextZ;
+        while (p && p->z >= minZ && n && n->z <= maxZ) {
+            if (isInside(p)) {
+                return false;
+            }
+            p = p->prevZ;
+            if (isInside(n)) {
+                return false;
+            }
+            n = n->nextZ;
+        }
+
+        // Look for remaining points in decreasing z-order
+        while (p && p->z >= minZ) {
+            if (isInside(p)) {
+                return false;
+            }
+            p = p->prevZ;
+        }
+
+        // Look for remaining points in increasing z-order
+        while (n && n->z <= maxZ) {
+            if (isInside(n)) {
+                return false;
+            }
+            n = n->nextZ;
+        }
+        return true;
+    }
+
+    PolygonTriangulator::Node* PolygonTriangulator::cureLocalIntersections(Node* start) {
+        // Go through all polygon nodes and cure small local self-intersections
+        Node* p = start;
+        do {
+            Node* a = p->prev;
+            Node* b = p->next->next;
+            if (!Equals(a, b) && Intersects(a, p, p->next, b) && LocallyInside(a, b) && LocallyInside(b, a)) {
+                addTriangle(a, p, b);
+
+                // Remove two nodes involved
+                RemoveNode(p);
+                RemoveNode(p->next);
+
+                p = start = b;
+            }
+            p = p->next;
+        } while (p != start);
+
+        return filterPoints(p);
+    }
+
+    void PolygonTriangulator::splitEarcut(Node* start) {
+        // Look for a valid diagonal that divides the polygon into two
+        Node* a = start;
+        do {
+            Node* b = a->next->next;
+            while (b != a->prev) {
+                if (a->i != b->i && IsValidDiagonal(a, b)) {
+                    // Split the polygon in two by the diagonal and run earcut on both halves
+                    Node* c = splitPolygon(a, b);
+                    a = filterPoints(a, a->next);
+                    c = filterPoints(c, c->next);
+                    earcutLinked(a);
+                    earcutLinked(c);
+                    return;
+                }
+                b = b->next;
+            }
+            a = a->next;
+        } while (a != start);
+    }
+
+    PolygonTriangulator::Node* PolygonTriangulator::eliminateHoles(const std::vector<std::vector<MapPos> >& rings, Node* outerNode) {
+        // Link every hole into the outer loop, producing a single-ring polygon without holes
+        std::vector<Node*> queue;
+        for (std::size_t i = 1; i < rings.size(); i++) {
+            Node* list = linkedList(rings[i], false);
+            if (list) {
+                if (list == list->next) {
+                    list->steiner = true;
+                }
+                queue.push_back(GetLeftmost(list));
+            }
+        }
+        std::sort(queue.begin(), queue.end(), [](const Node* a, const Node* b) {
+            return a->x < b->x;
+        });
+
+        // Process holes from left to right
+        for (Node* hole : queue) {
+            outerNode = eliminateHole(hole, outerNode);
+        }
+        return outerNode;
+    }
+
+    PolygonTriangulator::Node* PolygonTriangulator::eliminateHole(Node* hole, Node* outerNode) {
+        Node* bridge = findHoleBridge(hole, outerNode);
+        if (!bridge) {
+            return outerNode;
+        }
+
+        Node* bridgeReverse = splitPolygon(bridge, hole);
+
+        // Filter collinear points around the cuts, the input node may be removed by this
+        filterPoints(bridgeReverse, bridgeReverse->next);
+        return filterPoints(bridge, bridge->next);
+    }
+
+    PolygonTriangulator::Node* PolygonTriangulator::findHoleBridge(Node* hole, Node* outerNode) const {
+        // Find a segment intersected by a ray from the hole's leftmost point to the left.
+        // The segment's endpoint with lesser x will be the potential connection point
+        Node* p = outerNode;
+        double hx = hole->x;
+        double hy = hole->y;
+        double qx = -std::numeric_limits<double>::infinity();
+        Node* m = nullptr;
+        do {
+            if (hy <= p->y && hy >= p->next->y && p->next->y != p->y) {
+                double x = p->x + (hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
+                if (x <= hx && x > qx) {
+                    qx = x;
+                    m = (p->x < p->next->x ? p : p->next);
+                    if (x == hx) {
+                        // Hole touches the outer segment, pick the leftmost endpoint
+                        return m;
+                    }
+                }
+            }
+            p = p->next;
+        } while (p != outerNode);
+
+        if (!m) {
+            return nullptr;
+        }
+
+        // Look for points inside the triangle of the hole point, segment intersection and endpoint.
+        // If there are no points found, we have a valid connection, otherwise choose the point of the minimum angle with the ray as connection point
+        const Node* stop = m;
+        double mx = m->x;
+        double my = m->y;
+        double tanMin = std::numeric_limits<double>::infinity();
+        p = m;
+        do {
+            if (hx >= p->x && p->x >= mx && hx != p->x && PointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->x, p->y)) {
+                double tanCur = std::abs(hy - p->y) / (hx - p->x);
+                if (LocallyInside(p, hole) && (tanCur < tanMin || (tanCur == tanMin && (p->x > m->x || SectorContainsSector(m, p))))) {
+                    m = p;
+                    tanMin = tanCur;
+                }
+            }
+            p = p->next;
+        } while (p != stop);
+
+        return m;
+    }
+
+    void PolygonTriangulator::indexCurve(Node* start) const {
+        // Interlink polygon nodes in z-order
+        Node* p = start;
+        do {
+            p->z = (p->z ? p->z : zOrder(p->x, p->y));
+            p->prevZ = p->prev;
+            p->nextZ = p->next;
+            p = p->next;
+        } while (p != start);
+
+        p->prevZ->nextZ = nullptr;
+        p->prevZ = nullptr;
+
+        SortLinked(p);
+    }
+
+    std::int32_t PolygonTriangulator::zOrder(double x, double y) const {
+        // Z-order of a point given coords and size of the data bounding box, coords are transformed into non-negative 15-bit integer range
+        std::int32_t ix = static_cast<std::int32_t>((x - _minX) * _invSize);
+        std::int32_t iy = static_cast<std::int32_t>((y - _minY) * _invSize);
+
+        ix = (ix | (ix << 8)) & 0x00FF00FF;
+        ix = (ix | (ix << 4)) & 0x0F0F0F0F;
+        ix = (ix | (ix << 2)) & 0x33333333;
+        ix = (ix | (ix << 1)) & 0x55555555;
+
+        iy = (iy | (iy << 8)) & 0x00FF00FF;
+        iy = (iy | (iy << 4)) & 0x0F0F0F0F;
+        iy = (iy | (iy << 2)) & 0x33333333;
+        iy = (iy | (iy << 1)) & 0x55555555;
+
+        return ix | (iy << 1);
+    }
+
+    PolygonTriangulator::Node* PolygonTriangulator::splitPolygon(Node* a, Node* b) {
+        // Link two polygon vertices with a bridge. If the vertices belong to the same ring, it splits polygon into two.
+        // If one belongs to the outer ring and another to a hole, it merges it into a single ring
+        Node* a2 = createNode(a->i, a->x, a->y);
+        Node* b2 = createNode(b->i, b->x, b->y);
+        Node* an = a->next;
+        Node* bp = b->prev;
+
+        a->next = b;
+        b->prev = a;
+
+        a2->next = an;
+        an->prev = a2;
+
+        b2->next = a2;
+        a2->prev = b2;
+
+        bp->next = b2;
+        b2->prev = bp;
+
+        return b2;
+    }
+
+    PolygonTriangulator::Node* PolygonTriangulator::insertNode(unsigned int i, const MapPos& pos, Node* last) {
+        // Create a node and optionally link it with the previous one (in a circular doubly linked list)
+        Node* p = createNode(i, pos.getX(), pos.getY());
+        if (!last) {
+            p->prev = p;
+            p->next = p;
+        } else {
+            p->next = last->next;
+            p->prev = last;
+            last->next->prev = p;
+            last->next = p;
+        }
+        return p;
+    }
+
+    PolygonTriangulator::Node* PolygonTriangulator::createNode(unsigned int i, double x, double y) {
+        // Deque keeps the addresses of the existing nodes valid
+        _nodes.emplace_back(i, x, y);
+        return &_nodes.back();
+    }
+
+    void PolygonTriangulator::addTriangle(const Node* a, const Node* b, const Node* c) {
+        _indices.push_back(a->i);
+        _indices.push_back(b->i);
+        _indices.push_back(c->i);
+    }
+
+    PolygonTriangulator::Node* PolygonTriangulator::SortLinked(Node* list) {
+        // Simon Tatham's linked list merge sort algorithm
+        int inSize = 1;
+        while (true) {
+            Node* p = list;
+            Node* tail = nullptr;
+            list = nullptr;
+            int numMerges = 0;
+
+            while (p) {
+                numMerges++;
+                Node* q = p;
+                int pSize = 0;
+                for (int i = 0; i < inSize; i++) {
+                    pSize++;
+                    q = q->nextZ;
+                    if (!q) {
+                        break;
+                    }
+                }
+
+                int qSize = inSize;
+                while (pSize > 0 || (qSize > 0 && q)) {
+                    Node* e = nullptr;
+                    if (pSize == 0) {
+                        e = q;
+                        q = q->nextZ;
+                        qSize--;
+                    } else if (qSize == 0 || !q) {
+                        e = p;
+                        p = p->nextZ;
+                        pSize--;
+                    } else if (p->z <= q->z) {
+                        e = p;
+                        p = p->nextZ;
+                        pSize--;
+                    } else {
+                        e = q;
+                        q = q->nextZ;
+                        qSize--;
+                    }
+
+                    if (tail) {
+                        tail->nextZ = e;
+                    } else {
+                        list = e;
+                    }
+                    e->prevZ = tail;
+                    tail = e;
+                }
+
+                p = q;
+            }
+
+            tail->nextZ = nullptr;
+            if (numMerges <= 1) {
+                return list;
+            }
+            inSize *= 2;
+        }
+    }
+
+    PolygonTriangulator::Node* PolygonTriangulator::GetLeftmost(Node* start) {
+        // Find the leftmost node of a polygon ring
+        Node* p = start;
+        Node* leftmost = start;
+        do {
+            if (p->x < leftmost->x || (p->x == leftmost->x && p->y < leftmost->y)) {
+                leftmost = p;
+            }
+            p = p->next;
+        } while (p != start);
+        return leftmost;
+    }
+
+    bool PolygonTriangulator::SectorContainsSector(const Node* m, const Node* p) {
+        // Whether sector in vertex m contains sector in vertex p in the same coordinates
+        return Area(m->prev, m, p->prev) < 0 && Area(p->next, m, m->next) < 0;
+    }
+
+    bool PolygonTriangulator::IsValidDiagonal(Node* a, Node* b) {
+        // Check if a diagonal between two polygon nodes is valid (lies in polygon interior)
+        return a->next->i != b->i && a->prev->i != b->i && !IntersectsPolygon(a, b) &&
+            ((LocallyInside(a, b) && LocallyInside(b, a) && MiddleInside(a, b) && (Area(a->prev, a, b->prev) != 0 || Area(a, b->prev, b) != 0)) ||
+             (Equals(a, b) && Area(a->prev, a, a->next) > 0 && Area(b->prev, b, b->next) > 0));
+    }
+
+    bool PolygonTriangulator::PointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py) {
+        return (cx - px) * (ay - py) >= (ax - px) * (cy - py) &&
+               (ax - px) * (by - py) >= (bx - px) * (ay - py) &&
+               (bx - px) * (cy - py) >= (cx - px) * (by - py);
+    }
+
+    double PolygonTriangulator::Area(const Node* p, const Node* q, const Node* r) {
+        // Signed area of a triangle
+        return (q->y - p->y) * (r->x - q->x) - (q->x - p->x) * (r->y - q->y);
+    }
+
+    bool PolygonTriangulator::Equals(const Node* p1, const Node* p2) {
+        return p1->x == p2->x && p1->y == p2->y;
+    }
+
+    bool PolygonTriangulator::Intersects(const Node* p1, const Node* q1, const Node* p2, const Node* q2) {
+        // Check if two segments intersect
+        int o1 = Sign(Area(p1, q1, p2));
+        int o2 = Sign(Area(p1, q1, q2));
+        int o3 = Sign(Area(p2, q2, p1));
+        int o4 = Sign(Area(p2, q2, q1));
+
+        if (o1 != o2 && o3 != o4) {
+            return true;
+        }
+
+        // Collinear cases
+        if (o1 == 0 && OnSegment(p1, p2, q1)) {
+            return true;
+        }
+        if (o2 == 0 && OnSegment(p1, q2, q1)) {
+            return true;
+        }
+        if (o3 == 0 && OnSegment(p2, p1, q2)) {
+            return true;
+        }
+        if (o4 == 0 && OnSegment(p2, q1, q2)) {
+            return true;
+        }
+        return false;
+    }
+
+    bool PolygonTriangulator::OnSegment(const Node* p, const Node* q, const Node* r) {
+        // For collinear points p, q, r, check if point q lies on segment pr
+        return q->x <= std::max(p->x, r->x) && q->x >= std::min(p->x, r->x) && q->y <= std::max(p->y, r->y) && q->y >= std::min(p->y, r->y);
+    }
+
+    int PolygonTriangulator::Sign(double val) {
+        return (0.0 < val) - (val < 0.0);
+    }
+
+    bool PolygonTriangulator::IntersectsPolygon(const Node* a, const Node* b) {
+        // Check if a polygon diagonal intersects any polygon segments
+        const Node* p = a;
+        do {
+            if (p->i != a->i && p->next->i != a->i && p->i != b->i && p->next->i != b->i && Intersects(p, p->next, a, b)) {
+                return true;
+            }
+            p = p->next;
+        } while (p != a);
+        return false;
+    }
+
+    bool PolygonTriangulator::LocallyInside(const Node* a, const Node* b) {
+        // Check if a polygon diagonal is locally inside the polygon
+        if (Area(a->prev, a, a->next) < 0) {
+            return Area(a, b, a->next) >= 0 && Area(a, a->prev, b) >= 0;
+        }
+        return Area(a, b, a->prev) < 0 || Area(a, a->next, b) < 0;
+    }
+
+    bool PolygonTriangulator::MiddleInside(const Node* a, const Node* b) {
+        // Check if the middle point of a polygon diagonal is inside the polygon
+        const Node* p = a;
+        bool inside = false;
+        double px = (a->x + b->x) / 2;
+        double py = (a->y + b->y) / 2;
+        do {
+            if (((p->y > py) != (p->next->y > py)) && p->next->y != p->y && (px < (p->next->x - p->x) * (py - p->y) / (p->next->y - p->y) + p->x)) {
+                inside = !inside;
+            }
+            p = p->next;
+        } while (p != a);
+        return inside;
+    }
+
+    void PolygonTriangulator::RemoveNode(Node* p) {
+        p->next->prev = p->prev;
+        p->prev->next = p->next;
+
+        if (p->prevZ) {
+            p->prevZ->nextZ = p->nextZ;
+        }
+        if (p->nextZ) {
+            p->nextZ->prevZ = p->prevZ;
+        }
+    }
+
+    double PolygonTriangulator::CalculateRingArea(const std::vector<MapPos>& ring) {
+        double area = 0;
+        for (std::size_t i = 0, j = (ring.empty() ? 0 : ring.size() - 1); i < ring.size(); j = i++) {
+            area += (ring[j].getX() - ring[i].getX()) * (ring[i].getY() + ring[j].getY());
+        }
+        return area * 0.5;
+    }
+
+    const double PolygonTriangulator::AREA_TOLERANCE = 1.0e-6;
+
+}
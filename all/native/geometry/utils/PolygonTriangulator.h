@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_POLYGONTRIANGULATOR_H_
+#define _CARTO_POLYGONTRIANGULATOR_H_
+
+#include "core/MapPos.h"
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace carto {
+
+    /**
+     * Fast ear clipping triangulator for polygons with holes, based on the earcut algorithm.
+     * Vertices are indexed by z-order curve for bigger polygons, so that the ear tests only visit the nearby vertices.
+     * The result is verified by comparing the area of the triangles to the area of the polygon, the triangulation fails
+     * for polygons it can not handle correctly (self-intersections, overlapping holes), so that a robust tesselator can be used instead.
+     */
+    class PolygonTriangulator {
+    public:
+        /**
+         * Triangulates a polygon. Only X and Y coordinates of the vertices are used.
+         * @param rings The outer ring of the polygon followed by the holes.
+         * @param indices The resulting triangle indices to the vertices of the concatenated rings.
+         * @return True if the triangulation succeeded. If false is returned, indices is empty.
+         */
+        static bool Triangulate(const std::vector<std::vector<MapPos> >& rings, std::vector<unsigned int>& indices);
+
+    private:
+        struct Node {
+            unsigned int i;
+            double x;
+            double y;
+            Node* prev;
+            Node* next;
+            std::int32_t z;
+            Node* prevZ;
+            Node* nextZ;
+            bool steiner;
+
+            Node(unsigned int i, double x, double y) : i(i), x(x), y(y), prev(nullptr), next(nullptr), z(0), prevZ(nullptr), nextZ(nullptr), steiner(false) { }
+        };
+
+        explicit PolygonTriangulator(std::vector<unsigned int>& indices);
+
+        void triangulate(const std::vector<std::vector<MapPos> >& rings);
+
+        Node* linkedList(const std::vector<MapPos>& ring, bool clockwise);
+        Node* filterPoints(Node* start, Node* end = nullptr);
+        void earcutLinked(Node* ear, int pass = 0);
+        bool isEar(Node* ear) const;
+        bool isEarHashed(Node* ear) const;
+        Node* cureLocalIntersections(Node* start);
+        void splitEarcut(Node* start);
+        Node* eliminateHoles(const std::vector<std::vector<MapPos> >& rings, Node* outerNode);
+        Node* eliminateHole(Node* hole, Node* outerNode);
+        Node* findHoleBridge(Node* hole, Node* outerNode) const;
+        void indexCurve(Node* start) const;
+        std::int32_t zOrder(double x, double y) const;
+        Node* splitPolygon(Node* a, Node* b);
+        Node* insertNode(unsigned int i, const MapPos& pos, Node* last);
+        Node* createNode(unsigned int i, double x, double y);
+        void addTriangle(const Node* a, const Node* b, const Node* c);
+
+        static Node* SortLinked(Node* list);
+        static Node* GetLeftmost(Node* start);
+        static bool SectorContainsSector(const Node* m, const Node* p);
+        static bool IsValidDiagonal(Node* a, Node* b);
+        static bool PointInTriangle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py);
+        static double Area(const Node* p, const Node* q, const Node* r);
+        static bool Equals(const Node* p1, const Node* p2);
+        static bool Intersects(const Node* p1, const Node* q1, const Node* p2, const Node* q2);
+        static bool OnSegment(const Node* p, const Node* q, const Node* r);
+        static int Sign(double val);
+        static bool IntersectsPolygon(const Node* a, const Node* b);
+        static bool LocallyInside(const Node* a, const Node* b);
+        static bool MiddleInside(const Node* a, const Node* b);
+        static void RemoveNode(Node* p);
+
+        static double CalculateRingArea(const std::vector<MapPos>& ring);
+
+        static const int HASHING_THRESHOLD = 80;
+        static const double AREA_TOLERANCE;
+
+        std::vector<unsigned int>& _indices;
+        std::deque<Node> _nodes;
+        unsigned int _vertexCount;
+        bool _hashing;
+        double _minX;
+        double _minY;
+        double _invSize;
+    };
+
+}
+
+#endif
@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_RTREESPATIALINDEX_H_
+#define _CARTO_RTREESPATIALINDEX_H_
+
+#include "geometry/utils/SpatialIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace carto {
+
+    /**
+     * Bulk-loaded R-tree, packed using the Sort-Tile-Recursive algorithm. Records and nodes are stored in contiguous arrays.
+     * Inserted records are kept in a pending list and the tree is repacked lazily when the list grows, during the next query.
+     * As queries may modify the index, all access must be synchronized by the caller.
+     */
+    template <typename T>
+    class RTreeSpatialIndex : public SpatialIndex<T> {
+    public:
+        RTreeSpatialIndex();
+        virtual ~RTreeSpatialIndex() { }
+
+        virtual std::size_t size() const;
+        virtual void reserve(std::size_t size);
+
+        virtual void clear();
+        virtual void insert(const cglib::bbox3<double>& bounds, const T& object);
+        virtual void insertAll(const std::vector<cglib::bbox3<double> >& bounds, const std::vector<T>& objects);
+        virtual bool remove(const cglib::bbox3<double>& bounds, const T& object);
+        virtual bool remove(const T& object);
+
+        virtual std::vector<T> query(const cglib::frustum3<double>& frustum) const;
+        virtual std::vector<T> query(const cglib::bbox3<double>& bounds) const;
+        virtual std::vector<T> getAll() const;
+
+    private:
+        struct Record {
+            cglib::bbox3<double> bounds;
+            T object;
+            bool valid;
+
+            Record(const cglib::bbox3<double>& bounds, const T& object) : bounds(bounds), object(object), valid(true) { }
+        };
+
+        struct Node {
+            cglib::bbox3<double> bounds;
+            std::size_t begin; // index of the first record (leaf) or child node (internal node)
+            std::size_t end;
+            bool leaf;
+
+            Node(const cglib::bbox3<double>& bounds, std::size_t begin, std::size_t end, bool leaf) : bounds(bounds), begin(begin), end(end), leaf(leaf) { }
+        };
+
+        static const std::size_t NODE_CAPACITY = 16;
+        static const std::size_t MAX_PENDING_COUNT = 64;
+
+        void rebuild() const;
+        void packRecords(std::size_t begin, std::size_t end, const int* axes, int dims, int depth) const;
+        bool removeFromTree(const cglib::bbox3<double>* bounds, const T& object);
+
+        template <typename Test>
+        void queryTree(const Test& test, std::vector<T>& results) const;
+
+        mutable std::vector<Record> _records; // in tree order, removed records are marked invalid until the next rebuild
+        mutable std::vector<Node> _nodes; // leaf nodes first, root node last
+        mutable std::vector<Record> _pendingRecords;
+        mutable std::size_t _removedCount;
+    };
+
+    template<typename T>
+    RTreeSpatialIndex<T>::RTreeSpatialIndex() :
+        _records(),
+        _nodes(),
+        _pendingRecords(),
+        _removedCount(0)
+    {
+    }
+
+    template<typename T>
+    std::size_t RTreeSpatialIndex<T>::size() const {
+        return _records.size() - _removedCount + _pendingRecords.size();
+    }
+
+    template<typename T>
+    void RTreeSpatialIndex<T>::reserve(std::size_t size) {
+        _records.reserve(size);
+    }
+
+    template<typename T>
+    void RTreeSpatialIndex<T>::clear() {
+        _records.clear();
+        _nodes.clear();
+        _pendingRecords.clear();
+        _removedCount = 0;
+    }
+
+    template<typename T>
+    void RTreeSpatialIndex<T>::insert(const cglib::bbox3<double>& bounds, const T& object) {
+        _pendingRecords.emplace_back(bounds, object);
+    }
+
+    template<typename T>
+    void RTreeSpatialIndex<T>::insertAll(const std::vector<cglib::bbox3<double> >& bounds, const std::vector<T>& objects) {
+        // Pack the tree immediately, a single rebuild is cheaper than growing the pending list
+        _pendingRecords.reserve(_pendingRecords.size() + objects.size());
+        for (std::size_t i = 0; i < objects.size(); i++) {
+            _pendingRecords.emplace_back(bounds[i], objects[i]);
+        }
+        if (_pendingRecords.size() > MAX_PENDING_COUNT) {
+            rebuild();
+        }
+    }
+
+    template<typename T>
+    bool RTreeSpatialIndex<T>::remove(const cglib::bbox3<double>& bounds, const T& object) {
+        std::size_t count = size();
+        _pendingRecords.erase(std::remove_if(_pendingRecords.begin(), _pendingRecords.end(), [&object](const Record& record) { return record.object == object; }), _pendingRecords.end());
+        removeFromTree(&bounds, object);
+        return count != size();
+    }
+
+    template<typename T>
+    bool RTreeSpatialIndex<T>::remove(const T& object) {
+        std::size_t count = size();
+        _pendingRecords.erase(std::remove_if(_pendingRecords.begin(), _pendingRecords.end(), [&object](const Record& record) { return record.object == object; }), _pendingRecords.end());
+        removeFromTree(nullptr, object);
+        return count != size();
+    }
+
+    template<typename T>
+    std::vector<T> RTreeSpatialIndex<T>::query(const cglib::frustum3<double>& frustum) const {
+        std::vector<T> results;
+        queryTree([&frustum](const cglib::bbox3<double>& bounds) { return frustum.inside(bounds); }, results);
+        return results;
+    }
+
+    template<typename T>
+    std::vector<T> RTreeSpatialIndex<T>::query(const cglib::bbox3<double>& bounds) const {
+        std::vector<T> results;
+        queryTree([&bounds](const cglib::bbox3<double>& nodeBounds) { return bounds.inside(nodeBounds); }, results);
+        return results;
+    }
+
+    template<typename T>
+    std::vector<T> RTreeSpatialIndex<T>::getAll() const {
+        std::vector<T> results;
+        results.reserve(size());
+        for (const Record& record : _records) {
+            if (record.valid) {
+                results.push_back(record.object);
+            }
+        }
+        for (const Record& record : _pendingRecords) {
+            results.push_back(record.object);
+        }
+        return results;
+    }
+
+    template<typename T>
+    void RTreeSpatialIndex<T>::rebuild() const {
+        // Collect all valid records, including pending ones
+        std::vector<Record> records;
+        records.reserve(size());
+        for (Record& record : _records) {
+            if (record.valid) {
+                records.push_back(std::move(record));
+            }
+        }
+        for (Record& record : _pendingRecords) {
+            records.push_back(std::move(record));
+        }
+        std::swap(_records, records);
+        _pendingRecords.clear();
+        _nodes.clear();
+        _removedCount = 0;
+        if (_records.empty()) {
+            return;
+        }
+
+        // Sort the records by the axes with the largest extents. Use only 2 axes if the records are (nearly) planar
+        cglib::bbox3<double> recordBounds = cglib::bbox3<double>::smallest();
+        for (const Record& record : _records) {
+            recordBounds.add(record.bounds);
+        }
+        cglib::vec3<double> boundsDelta = recordBounds.size();
+        int axes[3] = { 0, 1, 2 };
+        std::sort(axes, axes + 3, [&boundsDelta](int axis1, int axis2) { return boundsDelta(axis1) > boundsDelta(axis2); });
+        int dims = (boundsDelta(axes[2]) > boundsDelta(axes[0]) * 1.0e-6 ? 3 : 2);
+        packRecords(0, _records.size(), axes, dims, 0);
+
+        // Create leaf nodes from consecutive records
+        for (std::size_t i = 0; i < _records.size(); i += NODE_CAPACITY) {
+            std::size_t end = std::min(i + NODE_CAPACITY, _records.size());
+            cglib::bbox3<double> bounds = _records[i].bounds;
+            for (std::size_t j = i + 1; j < end; j++) {
+                bounds.add(_records[j].bounds);
+            }
+            _nodes.emplace_back(bounds, i, end, true);
+        }
+
+        // Create internal node levels from consecutive nodes of the previous level, until a single root node remains
+        std::size_t levelBegin = 0;
+        std::size_t levelEnd = _nodes.size();
+        while (levelEnd - levelBegin > 1) {
+            for (std::size_t i = levelBegin; i < levelEnd; i += NODE_CAPACITY) {
+                std::size_t end = std::min(i + NODE_CAPACITY, levelEnd);
+                cglib::bbox3<double> bounds = _nodes[i].bounds;
+                for (std::size_t j = i + 1; j < end; j++) {
+                    bounds.add(_nodes[j].bounds);
+                }
+                _nodes.emplace_back(bounds, i, end, false);
+            }
+            levelBegin = levelEnd;
+            levelEnd = _nodes.size();
+        }
+    }
+
+    template<typename T>
+    void RTreeSpatialIndex<T>::packRecords(std::size_t begin, std::size_t end, const int* axes, int dims, int depth) const {
+        int axis = axes[depth];
+        std::sort(_records.begin() + begin, _records.begin() + end, [axis](const Record& record1, const Record& record2) {
+            return record1.bounds.center()(axis) < record2.bounds.center()(axis);
+        });
+        if (depth + 1 >= dims) {
+            return;
+        }
+
+        // Split into slices along the current axis, each slice containing whole leaf nodes. Sort each slice along the next axis
+        std::size_t leafCount = (end - begin + NODE_CAPACITY - 1) / NODE_CAPACITY;
+        std::size_t sliceCount = static_cast<std::size_t>(std::ceil(std::pow(static_cast<double>(leafCount), 1.0 / (dims - depth))));
+        std::size_t sliceSize = std::max(static_cast<std::size_t>(1), (leafCount + sliceCount - 1) / sliceCount) * NODE_CAPACITY;
+        for (std::size_t i = begin; i < end; i += sliceSize) {
+            packRecords(i, std::min(i + sliceSize, end), axes, dims, depth + 1);
+        }
+    }
+
+    template<typename T>
+    bool RTreeSpatialIndex<T>::removeFromTree(const cglib::bbox3<double>* bounds, const T& object) {
+        std::size_t removedCount = _removedCount;
+        if (!bounds) {
+            for (Record& record : _records) {
+                if (record.valid && record.object == object) {
+                    record.valid = false;
+                    record.object = T();
+                    _removedCount++;
+                }
+            }
+        } else if (!_nodes.empty()) {
+            std::vector<std::size_t> nodeStack(1, _nodes.size() - 1);
+            while (!nodeStack.empty()) {
+                const Node& node = _nodes[nodeStack.back()];
+                nodeStack.pop_back();
+                if (!node.bounds.inside(*bounds)) {
+                    continue;
+                }
+                for (std::size_t i = node.begin; i < node.end; i++) {
+                    if (node.leaf) {
+                        Record& record = _records[i];
+                        if (record.valid && record.object == object) {
+                            record.valid = false;
+                            record.object = T();
+                            _removedCount++;
+                        }
+                    } else {
+                        nodeStack.push_back(i);
+                    }
+                }
+            }
+        }
+
+        // Repack the tree if most of the records are removed
+        if (_removedCount > _records.size() / 2) {
+            rebuild();
+        }
+        return removedCount != _removedCount;
+    }
+
+    template<typename T>
+    template<typename Test>
+    void RTreeSpatialIndex<T>::queryTree(const Test& test, std::vector<T>& results) const {
+        if (_pendingRecords.size() > MAX_PENDING_COUNT) {
+            rebuild();
+        }
+
+        // Traverse the tree, starting from the root node
+        if (!_nodes.empty()) {
+            std::vector<std::size_t> nodeStack(1, _nodes.size() - 1);
+            while (!nodeStack.empty()) {
+                const Node& node = _nodes[nodeStack.back()];
+                nodeStack.pop_back();
+                if (!test(node.bounds)) {
+                    continue;
+                }
+                for (std::size_t i = node.begin; i < node.end; i++) {
+                    if (node.leaf) {
+                        const Record& record = _records[i];
+                        if (record.valid && test(record.bounds)) {
+                            results.push_back(record.object);
+                        }
+                    } else {
+                        nodeStack.push_back(i);
+                    }
+                }
+            }
+        }
+
+        // Test the records inserted after the last rebuild
+        for (const Record& record : _pendingRecords) {
+            if (test(record.bounds)) {
+                results.push_back(record.object);
+            }
+        }
+    }
+
+}
+
+#endif
@@ -25,8 +25,20 @@ namespace carto {
         
         virtual void clear() = 0;
         virtual void insert(const cglib::bbox3<double>& bounds, const T& object) = 0;
+        virtual void insertAll(const std::vector<cglib::bbox3<double> >& bounds, const std::vector<T>& objects) {
+            for (std::size_t i = 0; i < objects.size(); i++) {
+                insert(bounds[i], objects[i]);
+            }
+        }
         virtual bool remove(const cglib::bbox3<double>& bounds, const T& object) = 0;
         virtual bool remove(const T& object) = 0;
+        virtual bool update(const cglib::bbox3<double>& bounds, const T& object) {
+            if (!remove(object)) {
+                return false;
+            }
+            insert(bounds, object);
+            return true;
+        }
         
         virtual std::vector<T> query(const cglib::frustum3<double>& frustum) const = 0;
         virtual std::vector<T> query(const cglib::bbox3<double>& bounds) const = 0;
@@ -24,19 +24,14 @@ namespace {
     
     void readPngCallback(png_structp pngPtr, png_bytep data, png_size_t length) {
         LibPNGIOContainer* ioContainer = static_cast<LibPNGIOContainer*>(png_get_io_ptr(pngPtr));
-        for (std::size_t i = 0; i < length; i++) {
-            data[i] = ioContainer->_compressedDataPtr[i];
-        }
+        std::copy(ioContainer->_compressedDataPtr, ioContainer->_compressedDataPtr + length, data);
     
         ioContainer->_compressedDataPtr += length;
     }
     
     void writePngCallback(png_structp pngPtr, png_bytep data, png_size_t length) {
         std::vector<unsigned char>* compressedData = static_cast<std::vector<unsigned char>* >(png_get_io_ptr(pngPtr));
-        compressedData->reserve(compressedData->size() + length);
-        for (std::size_t i = 0; i < length; i++) {
-            compressedData->push_back(data[i]);
-        }
+        compressedData->insert(compressedData->end(), data, data + length);
     }
     
     struct JPEGErrorManager {
@@ -50,6 +45,111 @@ namespace {
         longjmp(myErr->setjmp_buffer, 1);
     }
     
+    template <int N>
+    void resizePixelData(const unsigned char* srcData, unsigned int srcWidth, unsigned int srcHeight, unsigned char* destData, unsigned int width, unsigned int height) {
+        bool bUpsampleX = (srcWidth < width);
+        bool bUpsampleY = (srcHeight < height);
+
+        // If too many input pixels map to one output pixel, our 32-bit accumulation values
+        // could overflow - so, if we have huge mappings like that, cut down the weights:
+        //    256 max color value
+        //   *256 weight_x
+        //   *256 weight_y
+        //   *256 (16*16) maximum # of input pixels (x,y) - unless we cut the weights down...
+        int weight_shift = 0;
+        float source_texels_per_out_pixel = ((srcWidth / static_cast<float>(width + 1))
+                * (srcHeight / static_cast<float>(height + 1)));
+        float weight_per_pixel = source_texels_per_out_pixel * 256 * 256; //weight_x * weight_y
+        float accum_per_pixel = weight_per_pixel * 256; //color value is 0-255
+        float weight_div = accum_per_pixel / 4294967000.0f;
+        if (weight_div > 1) {
+            weight_shift = static_cast<int>(ceilf(logf(weight_div) / logf(2)));
+        }
+        weight_shift = std::min(15, weight_shift); // this could go to 15 and still be ok.
+
+        float fh = 256 * srcHeight / static_cast<float>(height);
+        float fw = 256 * srcWidth / static_cast<float>(width);
+        // Cache x1a, x1b for all the columns
+
+        std::vector<int> g_px1ab(width * 2 * 2);
+
+        for (std::size_t x2 = 0; x2 < width; x2++) {
+            // Find the x-range of input pixels that will contribute:
+            int x1a = static_cast<int>((x2) * fw);
+            int x1b = static_cast<int>((x2 + 1) * fw);
+            if (bUpsampleX) {
+                // Map to same pixel -> we want to interpolate between two pixels!
+                x1b = x1a + 256;
+            }
+            x1b = std::min(x1b, static_cast<int>(256 * srcWidth - 1));
+            g_px1ab[x2 * 2 + 0] = x1a;
+            g_px1ab[x2 * 2 + 1] = x1b;
+        }
+
+        // For every output pixel
+        for (std::size_t y2 = 0; y2 < height; y2++) {
+            // Find the y-range of input pixels that will contribute:
+            int y1a = static_cast<int>((y2) * fh);
+            int y1b = static_cast<int>((y2 + 1) * fh);
+            if (bUpsampleY) {
+                // Map to same pixel -> we want to interpolate between two pixels!
+                y1b = y1a + 256;
+            }
+            y1b = std::min(y1b, static_cast<int>(256 * srcHeight - 1));
+            int y1c = y1a >> 8;
+            int y1d = y1b >> 8;
+
+            for (std::size_t x2 = 0; x2 < width; x2++) {
+                // Find the x-range of input pixels that will contribute
+                int x1a = g_px1ab[x2 * 2 + 0];
+                int x1b = g_px1ab[x2 * 2 + 1];
+                int x1c = x1a >> 8;
+                int x1d = x1b >> 8;
+
+                // Add ip all input pixels contributing to this output pixel
+                unsigned int accum[N] = { 0 };
+                unsigned int wa = 0;
+                for (int y = y1c; y <= y1d; y++) {
+                    unsigned int weight_y = 256;
+                    if (y1c != y1d) {
+                        if (y == y1c) {
+                            weight_y = 256 - (y1a & 0xFF);
+                        } else if (y == y1d) {
+                            weight_y = (y1b & 0xFF);
+                        }
+                    }
+
+                    const unsigned char* src2 = &srcData[(y * srcWidth + x1c) * N];
+                    for (int x = x1c; x <= x1d; x++) {
+                        unsigned int weight_x = 256;
+                        if (x1c != x1d) {
+                            if (x == x1c) {
+                                weight_x = 256 - (x1a & 0xFF);
+                            } else if (x == x1d) {
+                                weight_x = (x1b & 0xFF);
+                            }
+                        }
+
+                        unsigned int w = (weight_x * weight_y) >> weight_shift;
+
+                        for (int c = 0; c < N; c++) {
+                            accum[c] += *src2++ * w;
+                        }
+                        wa += w;
+                    }
+                }
+                if (wa <= 0) {
+                    wa = std::numeric_limits<int>::max();
+                }
+
+                // Write results
+                for (int c = 0; c < N; c++) {
+                    *destData++ = static_cast<unsigned char>(accum[c] / wa);
+                }
+            }
+        }
+    }
+
     template <typename T>
     void encodeInt(T data, unsigned char* buffer, std::size_t size) {
         for (std::size_t i = 0; i < size; i++) {
@@ -242,131 +342,27 @@ namespace carto {
         }
 
         // This will only scale the actual image part, the padding that was previously added to make the image
-        // dimensions power of 2 will be ignored
-        const unsigned char* dsrc = _pixelData.data();
+        // dimensions power of 2 will be ignored. The pixel size is a template parameter, so that the inner loops can be unrolled
         std::vector<unsigned char> pixelData(width * height * _bytesPerPixel);
-        unsigned char* ddest = pixelData.data();
-    
-        bool bUpsampleX = (_width < width);
-        bool bUpsampleY = (_height < height);
-    
-        // If too many input pixels map to one output pixel, our 32-bit accumulation values
-        // could overflow - so, if we have huge mappings like that, cut down the weights:
-        //    256 max color value
-        //   *256 weight_x
-        //   *256 weight_y
-        //   *256 (16*16) maximum # of input pixels (x,y) - unless we cut the weights down...
-        int weight_shift = 0;
-        float source_texels_per_out_pixel = ((_width / static_cast<float>(width + 1))
-                * (_height / static_cast<float>(height + 1)));
-        float weight_per_pixel = source_texels_per_out_pixel * 256 * 256; //weight_x * weight_y
-        float accum_per_pixel = weight_per_pixel * 256; //color value is 0-255
-        float weight_div = accum_per_pixel / 4294967000.0f;
-        if (weight_div > 1) {
-            weight_shift = static_cast<int>(ceilf(logf(weight_div) / logf(2)));
-        }
-        weight_shift = std::min(15, weight_shift); // this could go to 15 and still be ok.
-    
-        float fh = 256 * _height / static_cast<float>(height);
-        float fw = 256 * _width / static_cast<float>(width);
-        // Cache x1a, x1b for all the columns
-    
-        std::vector<int> g_px1ab(width * 2 * 2);
-    
-        for (std::size_t x2 = 0; x2 < width; x2++) {
-            // Find the x-range of input pixels that will contribute:
-            int x1a = static_cast<int>((x2) * fw);
-            int x1b = static_cast<int>((x2 + 1) * fw);
-            if (bUpsampleX) {
-                // Map to same pixel -> we want to interpolate between two pixels!
-                x1b = x1a + 256;
-            }
-            x1b = std::min(x1b, static_cast<int>(256 * _width - 1));
-            g_px1ab[x2 * 2 + 0] = x1a;
-            g_px1ab[x2 * 2 + 1] = x1b;
-        }
-    
-        // For every output pixel
-        for (std::size_t y2 = 0; y2 < height; y2++) {
-            // Find the y-range of input pixels that will contribute:
-            int y1a = static_cast<int>((y2) * fh);
-            int y1b = static_cast<int>((y2 + 1) * fh);
-            if (bUpsampleY) {
-                // Map to same pixel -> we want to interpolate between two pixels!
-                y1b = y1a + 256;
-            }
-            y1b = std::min(y1b, static_cast<int>(256 * _height - 1));
-            int y1c = y1a >> 8;
-            int y1d = y1b >> 8;
-    
-            for (std::size_t x2 = 0; x2 < width; x2++) {
-                // Find the x-range of input pixels that will contribute
-                int x1a = g_px1ab[x2 * 2 + 0];
-                int x1b = g_px1ab[x2 * 2 + 1];
-                int x1c = x1a >> 8;
-                int x1d = x1b >> 8;
-    
-                // Add ip all input pixels contributing to this output pixel
-                unsigned int r = 0, g = 0, b = 0, a = 0, wa = 0;
-                for (int y = y1c; y <= y1d; y++) {
-                    unsigned int weight_y = 256;
-                    if (y1c != y1d) {
-                        if (y == y1c) {
-                            weight_y = 256 - (y1a & 0xFF);
-                        } else if (y == y1d) {
-                            weight_y = (y1b & 0xFF);
-                        }
-                    }
-    
-                    const unsigned char* dsrc2 = &dsrc[y * _width * _bytesPerPixel + x1c * _bytesPerPixel];
-                    for (int x = x1c; x <= x1d; x++) {
-                        unsigned int weight_x = 256;
-                        if (x1c != x1d) {
-                            if (x == x1c) {
-                                weight_x = 256 - (x1a & 0xFF);
-                            } else if (x == x1d) {
-                                weight_x = (x1b & 0xFF);
-                            }
-                        }
-    
-                        unsigned int w = (weight_x * weight_y) >> weight_shift;
-
-                        unsigned char r_src = *dsrc2++;
-                        r += r_src * w;
-                        if (_bytesPerPixel > 1) {
-                            unsigned char g_src = *dsrc2++;
-                            g += g_src * w;
-                        }
-                        if (_bytesPerPixel > 2) {
-                            unsigned char b_src = *dsrc2++;
-                            b += b_src * w;
-                        }
-                        if (_bytesPerPixel > 3) {
-                            unsigned char a_src = *dsrc2++;
-                            a += a_src * w;
-                        }
-                        wa += w;
-                    }
-                }
-                if (wa <= 0) {
-                    wa = std::numeric_limits<int>::max();
-                }
-    
-                // Write results
-                *ddest++ = r / wa;
-                if (_bytesPerPixel > 1) {
-                    *ddest++ = g / wa;
-                }
-                if (_bytesPerPixel > 2) {
-                    *ddest++ = b / wa;
-                }
-                if (_bytesPerPixel > 3) {
-                    *ddest++ = a / wa;
-                }
-            }
+        switch (_bytesPerPixel) {
+        case 1:
+            resizePixelData<1>(_pixelData.data(), _width, _height, pixelData.data(), width, height);
+            break;
+        case 2:
+            resizePixelData<2>(_pixelData.data(), _width, _height, pixelData.data(), width, height);
+            break;
+        case 3:
+            resizePixelData<3>(_pixelData.data(), _width, _height, pixelData.data(), width, height);
+            break;
+        case 4:
+            resizePixelData<4>(_pixelData.data(), _width, _height, pixelData.data(), width, height);
+            break;
+        default:
+            Log::Error("Bitmap::getResizedBitmap: Unsupported pixel size");
+            return std::shared_ptr<Bitmap>();
         }
         
-        return std::make_shared<Bitmap>(pixelData.data(), width, height, _colorFormat, -static_cast<int>(width * _bytesPerPixel));
+        return CreateFromPixelData(std::move(pixelData), width, height, _colorFormat, _bytesPerPixel);
     }
     
     std::shared_ptr<Bitmap> Bitmap::getSubBitmap(int xOffset, int yOffset, int width, int height) const {
@@ -374,12 +370,13 @@ namespace carto {
             return std::shared_ptr<Bitmap>();
         }
     
+        // Rows are stored bottom-up, so the sub-bitmap is a contiguous range of rows
         std::vector<unsigned char> pixelData(width * height * _bytesPerPixel);
         for (int y = 0; y < height; y++) {
-            const unsigned char* row = &_pixelData[((_height - 1 - y - yOffset) * _width + xOffset) * _bytesPerPixel];
+            const unsigned char* row = &_pixelData[((_height - height - yOffset + y) * _width + xOffset) * _bytesPerPixel];
             std::copy(row, row + width * _bytesPerPixel, &pixelData[y * width * _bytesPerPixel]);
         }
-        return std::make_shared<Bitmap>(pixelData.data(), width, height, _colorFormat, static_cast<int>(width * _bytesPerPixel));
+        return CreateFromPixelData(std::move(pixelData), width, height, _colorFormat, _bytesPerPixel);
     }
     
     std::shared_ptr<Bitmap> Bitmap::getPaddedBitmap(int xPadding, int yPadding) const {
@@ -389,87 +386,48 @@ namespace carto {
         unsigned int newHeight = _height + std::abs(yPadding);
         std::vector<unsigned char> newPixelData(newWidth * newHeight * _bytesPerPixel, 0);
         for (unsigned int y = 0; y < _height; y++) {
-            const unsigned char* row = &_pixelData[((_height - 1 - y) * _width) * _bytesPerPixel];
-            std::copy(row, row + _width * _bytesPerPixel, &newPixelData[(x0 + (y + y0) * newWidth) * _bytesPerPixel]);
+            const unsigned char* row = &_pixelData[(y * _width) * _bytesPerPixel];
+            std::copy(row, row + _width * _bytesPerPixel, &newPixelData[(x0 + (newHeight - _height - y0 + y) * newWidth) * _bytesPerPixel]);
         }
-        return std::make_shared<Bitmap>(newPixelData.data(), newWidth, newHeight, _colorFormat, static_cast<int>(newWidth * _bytesPerPixel));
+        return CreateFromPixelData(std::move(newPixelData), newWidth, newHeight, _colorFormat, _bytesPerPixel);
     }
     
     std::shared_ptr<Bitmap> Bitmap::getRGBABitmap() const {
-        std::vector<unsigned char> pixelData(_width * _height * 4, 255);
-        for (unsigned int i = 0; i < _height; i++) {
-            for (unsigned int j = 0; j < _width; j++) {
-                unsigned int destIndex = (i * _width + j) * 4;
-                unsigned int srcIndex = (i * _width + j) * _bytesPerPixel;
-                switch (_colorFormat) {
-                case ColorFormat::COLOR_FORMAT_GRAYSCALE:
-                    pixelData[destIndex + 0] = _pixelData[srcIndex];
-                    pixelData[destIndex + 1] = _pixelData[srcIndex];
-                    pixelData[destIndex + 2] = _pixelData[srcIndex];
-                    break;
-                case ColorFormat::COLOR_FORMAT_GRAYSCALE_ALPHA:
-                    pixelData[destIndex + 0] = _pixelData[srcIndex];
-                    pixelData[destIndex + 1] = _pixelData[srcIndex];
-                    pixelData[destIndex + 2] = _pixelData[srcIndex];
-                    pixelData[destIndex + 3] = _pixelData[srcIndex + 1];
-                    break;
-                case ColorFormat::COLOR_FORMAT_RGB:
-                    pixelData[destIndex + 0] = _pixelData[srcIndex + 0];
-                    pixelData[destIndex + 1] = _pixelData[srcIndex + 1];
-                    pixelData[destIndex + 2] = _pixelData[srcIndex + 2];
-                    break;
-                case ColorFormat::COLOR_FORMAT_RGBA:
-                    pixelData[destIndex + 0] = _pixelData[srcIndex + 0];
-                    pixelData[destIndex + 1] = _pixelData[srcIndex + 1];
-                    pixelData[destIndex + 2] = _pixelData[srcIndex + 2];
-                    pixelData[destIndex + 3] = _pixelData[srcIndex + 3];
-                    break;
-                case ColorFormat::COLOR_FORMAT_BGRA:
-                    pixelData[destIndex + 0] = _pixelData[srcIndex + 2];
-                    pixelData[destIndex + 1] = _pixelData[srcIndex + 1];
-                    pixelData[destIndex + 2] = _pixelData[srcIndex + 0];
-                    pixelData[destIndex + 3] = _pixelData[srcIndex + 3];
-                    break;
-                case ColorFormat::COLOR_FORMAT_RGBA_4444:
-                    {
-                        unsigned short color = *reinterpret_cast<const unsigned short*>(&_pixelData[srcIndex]);
-                        unsigned char r = (color & 0xF000) >> 8;
-                        r = r | (r >> 4);
-                        unsigned char g = (color & 0xF00) >> 4;
-                        g = g | (g >> 4);
-                        unsigned char b = (color & 0xF0);
-                        b = b | (b >> 4);
-                        unsigned char a = (color & 0xF) << 4;
-                        a = a | (a >> 4);
-                        pixelData[destIndex + 0] = r;
-                        pixelData[destIndex + 1] = g;
-                        pixelData[destIndex + 2] = b;
-                        pixelData[destIndex + 3] = a;
-                    }
-                    break;
-                case ColorFormat::COLOR_FORMAT_RGB_565:
-                    {
-                        unsigned short color = *reinterpret_cast<const unsigned short*>(&_pixelData[srcIndex]);
-                        unsigned char r = (color & 0xF800) >> 8;
-                        r = r | (r >> 5);
-                        unsigned char g = (color & 0x7E0) >> 3;
-                        g = g | (g >> 6);
-                        unsigned char b = (color & 0x1F) << 3;
-                        b = b | (b >> 5);
-                        pixelData[destIndex + 0] = r;
-                        pixelData[destIndex + 1] = g;
-                        pixelData[destIndex + 2] = b;
-                    }
-                    break;
-                default:
-                    Log::Error("Bitmap::getRGBABitmap: Failed to convert bitmap due to unsupported color format");
-                    break;
-                }
+        // Source bitmaps are always in one of the uncompressed formats, so only these need to be converted.
+        // The format is resolved once, outside the pixel loops
+        std::size_t pixelCount = static_cast<std::size_t>(_width) * _height;
+        std::vector<unsigned char> pixelData(pixelCount * 4, 255);
+        const unsigned char* src = _pixelData.data();
+        unsigned char* dest = pixelData.data();
+        switch (_colorFormat) {
+        case ColorFormat::COLOR_FORMAT_GRAYSCALE:
+            for (std::size_t i = 0; i < pixelCount; i++, src += 1, dest += 4) {
+                dest[0] = dest[1] = dest[2] = src[0];
             }
+            break;
+        case ColorFormat::COLOR_FORMAT_GRAYSCALE_ALPHA:
+            for (std::size_t i = 0; i < pixelCount; i++, src += 2, dest += 4) {
+                dest[0] = dest[1] = dest[2] = src[0];
+                dest[3] = src[1];
+            }
+            break;
+        case ColorFormat::COLOR_FORMAT_RGB:
+            for (std::size_t i = 0; i < pixelCount; i++, src += 3, dest += 4) {
+                dest[0] = src[0];
+                dest[1] = src[1];
+                dest[2] = src[2];
+            }
+            break;
+        case ColorFormat::COLOR_FORMAT_RGBA:
+            std::copy(_pixelData.begin(), _pixelData.end(), pixelData.begin());
+            break;
+        default:
+            Log::Error("Bitmap::getRGBABitmap: Failed to convert bitmap due to unsupported color format");
+            break;
         }
         
         // Create new bitmap
-        return std::make_shared<Bitmap>(pixelData.data(), _width, _height, ColorFormat::COLOR_FORMAT_RGBA, -static_cast<int>(_width * 4));
+        return CreateFromPixelData(std::move(pixelData), _width, _height, ColorFormat::COLOR_FORMAT_RGBA, 4);
     }
     
     std::shared_ptr<Bitmap> Bitmap::CreateFromCompressed(const std::shared_ptr<BinaryData>& compressedData) {
@@ -499,6 +457,16 @@ namespace carto {
     {
     }
 
+    std::shared_ptr<Bitmap> Bitmap::CreateFromPixelData(std::vector<unsigned char> pixelData, unsigned int width, unsigned int height, ColorFormat::ColorFormat colorFormat, unsigned int bytesPerPixel) {
+        std::shared_ptr<Bitmap> bitmap(new Bitmap);
+        bitmap->_width = width;
+        bitmap->_height = height;
+        bitmap->_bytesPerPixel = bytesPerPixel;
+        bitmap->_colorFormat = colorFormat;
+        bitmap->_pixelData = std::move(pixelData);
+        return bitmap;
+    }
+
     bool Bitmap::loadFromCompressedBytes(const unsigned char* compressedData, std::size_t dataSize) {
         if (IsJPEG(compressedData, dataSize)) {
             return loadJPEG(compressedData, dataSize);
@@ -631,10 +599,8 @@ namespace carto {
             // Normal copy
             for (unsigned int i = 0; i < _height; i++) {
                 unsigned int flippedI = _height - 1 - i;
-                unsigned int srcIndex = (bytesPerRow < 0 ? flippedI : i) * std::abs(bytesPerRow);
-                for (unsigned int j = 0; j < newActualBytesPerRow; j++) {
-                    _pixelData[flippedI * newBytesPerRow + j] = pixelData[srcIndex + j];
-                }
+                const unsigned char* row = &pixelData[(bytesPerRow < 0 ? flippedI : i) * std::abs(bytesPerRow)];
+                std::copy(row, row + newActualBytesPerRow, &_pixelData[flippedI * newBytesPerRow]);
             }
         }
         
@@ -835,10 +801,16 @@ namespace carto {
         png_read_image(pngPtr, rowPointers.data());
     
         if (premultiply) {
-            // Premultiply alpha
-            for (std::size_t i = 0; i < _pixelData.size(); i += _bytesPerPixel) {
+            // Premultiply alpha. Uses exact integer division by 255 without the actual division
+            unsigned char* pixelPtr = _pixelData.data();
+            for (std::size_t i = 0; i < _pixelData.size(); i += _bytesPerPixel, pixelPtr += _bytesPerPixel) {
+                unsigned int alpha = pixelPtr[_bytesPerPixel - 1];
+                if (alpha == 255) {
+                    continue;
+                }
                 for (std::size_t j = 0; j < _bytesPerPixel - 1; j++) {
-                    _pixelData[i + j] = (_pixelData[i + j] * _pixelData[i + _bytesPerPixel - 1]) / 255;
+                    unsigned int value = pixelPtr[j] * alpha;
+                    pixelPtr[j] = static_cast<unsigned char>((value + 1 + (value >> 8)) >> 8);
                 }
             }
         }
@@ -869,13 +841,16 @@ namespace carto {
             _colorFormat = ColorFormat::COLOR_FORMAT_RGB;
             decodedData = WebPDecodeRGB(compressedData, dataSize, NULL, NULL);
         }
+        if (!decodedData) {
+            Log::Error("Bitmap::loadWEBP: Failed to decode WEBP");
+            return false;
+        }
         
         unsigned int bytesPerRow = _width * _bytesPerPixel;
         _pixelData.resize(_height * bytesPerRow);
         for (unsigned int i = 0; i < _height; i++) {
-            for (unsigned int j = 0; j < bytesPerRow; j++) {
-                _pixelData[(_height - i - 1) * bytesPerRow + j] = decodedData[i * bytesPerRow + j];
-            }
+            const unsigned char* row = &decodedData[i * bytesPerRow];
+            std::copy(row, row + bytesPerRow, &_pixelData[(_height - i - 1) * bytesPerRow]);
         }
         
         WebPFree(decodedData);
@@ -191,6 +191,8 @@ namespace carto {
         
     protected:
         Bitmap();
+
+        static std::shared_ptr<Bitmap> CreateFromPixelData(std::vector<unsigned char> pixelData, unsigned int width, unsigned int height, ColorFormat::ColorFormat colorFormat, unsigned int bytesPerPixel);
         
         bool loadFromCompressedBytes(const unsigned char* compressedData, std::size_t dataSize);
         bool loadFromUncompressedBytes(const unsigned char* pixelData, unsigned int width, unsigned int height,
@@ -4,8 +4,14 @@
 #include "graphics/utils/GLContext.h"
 #include "utils/Log.h"
 
+#include <cstdint>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
 #include <vector>
 
+#include <stdext/utf8_filesystem.h>
+
 namespace carto {
 
     Shader::~Shader() {
@@ -17,7 +23,7 @@ namespace carto {
             return 0;
         }
 
-        load();
+        load(_shaderManager->getProgramCachePath());
         return _progId;
     }
     
@@ -50,11 +56,24 @@ namespace carto {
     {
     }
 
-    void Shader::load() const {
+    void Shader::load(const std::string& programCachePath) const {
         if (_progId == 0) {
-            _vertShaderId = loadShader(*_shaderSource.getVertSource(), GL_VERTEX_SHADER);
-            _fragShaderId = loadShader(*_shaderSource.getFragSource(), GL_FRAGMENT_SHADER);
-            _progId = loadProg(_vertShaderId, _fragShaderId);
+            // Try the cached program binary first, compiling and linking the shaders is slow on many drivers
+            std::string progBinaryFileName;
+            if (GLContext::PROGRAM_BINARY && !programCachePath.empty()) {
+                progBinaryFileName = getProgBinaryFileName(programCachePath);
+                _progId = loadProgBinary(progBinaryFileName);
+            }
+
+            if (_progId == 0) {
+                _vertShaderId = loadShader(*_shaderSource.getVertSource(), GL_VERTEX_SHADER);
+                _fragShaderId = loadShader(*_shaderSource.getFragSource(), GL_FRAGMENT_SHADER);
+                _progId = loadProg(_vertShaderId, _fragShaderId);
+
+                if (_progId != 0 && !progBinaryFileName.empty()) {
+                    saveProgBinary(_progId, progBinaryFileName);
+                }
+            }
 
             registerVars(_progId);
         }
@@ -114,6 +133,107 @@ namespace carto {
         GLContext::CheckGLError("Shader::registerVars");
     }
 
+    std::string Shader::getProgBinaryFileName(const std::string& programCachePath) const {
+        // The binaries are valid only for the same driver, so the driver strings are part of the key together with the sources
+        std::vector<std::string> keyParts;
+        for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+            const char* value = reinterpret_cast<const char*>(glGetString(name));
+            keyParts.push_back(value ? value : "");
+        }
+        keyParts.push_back(*_shaderSource.getVertSource());
+        keyParts.push_back(*_shaderSource.getFragSource());
+
+        // 64-bit FNV-1a hash, stable across runs and platforms
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (const std::string& keyPart : keyParts) {
+            for (std::size_t i = 0; i <= keyPart.size(); i++) {
+                hash ^= static_cast<unsigned char>(i < keyPart.size() ? keyPart[i] : 0);
+                hash *= 1099511628211ULL;
+            }
+        }
+
+        std::stringstream ss;
+        ss << programCachePath << "/" << std::hex << std::setw(16) << std::setfill('0') << hash << ".glprog";
+        return ss.str();
+    }
+
+    GLuint Shader::loadProgBinary(const std::string& fileName) const {
+        FILE* fpRaw = utf8_filesystem::fopen(fileName.c_str(), "rb");
+        if (!fpRaw) {
+            return 0;
+        }
+        std::shared_ptr<FILE> fp(fpRaw, fclose);
+
+        // The file contains the binary format and size, followed by the binary itself
+        std::uint32_t header[2] = { 0, 0 };
+        if (fread(header, sizeof(header), 1, fp.get()) != 1 || header[1] == 0 || header[1] > MAX_PROGRAM_BINARY_SIZE) {
+            Log::Warnf("Shader::loadProgBinary: Invalid program binary file for '%s' shader", _shaderSource.getName().c_str());
+            return 0;
+        }
+        std::vector<unsigned char> binary(header[1]);
+        if (fread(binary.data(), 1, binary.size(), fp.get()) != binary.size()) {
+            Log::Warnf("Shader::loadProgBinary: Truncated program binary file for '%s' shader", _shaderSource.getName().c_str());
+            return 0;
+        }
+
+        GLuint progId = glCreateProgram();
+        if (progId == 0) {
+            return 0;
+        }
+
+        GLContext::ProgramBinary(progId, static_cast<GLenum>(header[0]), binary.data(), static_cast<GLint>(binary.size()));
+        GLint linked = GL_FALSE;
+        glGetProgramiv(progId, GL_LINK_STATUS, &linked);
+        if (linked == GL_FALSE) {
+            // Drivers may reject their older binaries, the program is then compiled and the cache entry replaced.
+            // The resulting GL errors are expected, so they are consumed here.
+            Log::Infof("Shader::loadProgBinary: Program binary rejected for '%s' shader", _shaderSource.getName().c_str());
+            glDeleteProgram(progId);
+            while (glGetError() != GL_NO_ERROR) {
+            }
+            return 0;
+        }
+
+        GLContext::CheckGLError("Shader::loadProgBinary");
+
+        return progId;
+    }
+
+    void Shader::saveProgBinary(GLuint progId, const std::string& fileName) const {
+        GLint length = 0;
+#ifdef GL_PROGRAM_BINARY_LENGTH_OES
+        glGetProgramiv(progId, GL_PROGRAM_BINARY_LENGTH_OES, &length);
+#endif
+        if (length <= 0 || static_cast<std::size_t>(length) > MAX_PROGRAM_BINARY_SIZE) {
+            return;
+        }
+        std::vector<unsigned char> binary(length);
+        GLsizei binaryLength = 0;
+        GLenum binaryFormat = 0;
+        GLContext::GetProgramBinary(progId, length, &binaryLength, &binaryFormat, binary.data());
+        GLContext::CheckGLError("Shader::saveProgBinary");
+        if (binaryLength <= 0) {
+            return;
+        }
+
+        // Write to a temporary file first, so that a partially written file is never used
+        std::string tempFileName = fileName + ".tmp";
+        FILE* fpRaw = utf8_filesystem::fopen(tempFileName.c_str(), "wb");
+        if (!fpRaw) {
+            Log::Warnf("Shader::saveProgBinary: Failed to create program binary file for '%s' shader", _shaderSource.getName().c_str());
+            return;
+        }
+        std::shared_ptr<FILE> fp(fpRaw, fclose);
+
+        std::uint32_t header[2] = { static_cast<std::uint32_t>(binaryFormat), static_cast<std::uint32_t>(binaryLength) };
+        bool written = fwrite(header, sizeof(header), 1, fp.get()) == 1 && fwrite(binary.data(), 1, binaryLength, fp.get()) == static_cast<std::size_t>(binaryLength);
+        fp.reset();
+        if (!written || utf8_filesystem::rename(tempFileName.c_str(), fileName.c_str()) != 0) {
+            Log::Warnf("Shader::saveProgBinary: Failed to write program binary file for '%s' shader", _shaderSource.getName().c_str());
+            utf8_filesystem::unlink(tempFileName.c_str());
+        }
+    }
+
     GLuint Shader::loadProg(GLuint vertShaderId, GLuint fragShaderId) const {
         GLuint progId = glCreateProgram();
         if (progId == 0) {
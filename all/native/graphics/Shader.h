@@ -30,15 +30,21 @@ namespace carto {
         
         Shader(const std::shared_ptr<ShaderManager>& shaderManager, const ShaderSource& source);
 
-        void load() const;
+        void load(const std::string& programCachePath) const;
         void unload() const;
 
     private:
         void registerVars(GLuint progId) const;
 
+        std::string getProgBinaryFileName(const std::string& programCachePath) const;
+        GLuint loadProgBinary(const std::string& fileName) const;
+        void saveProgBinary(GLuint progId, const std::string& fileName) const;
+
         GLuint loadProg(GLuint vertShaderId, GLuint fragShaderId) const;
         GLuint loadShader(const std::string& source, GLenum shaderType) const;
 
+        static const std::size_t MAX_PROGRAM_BINARY_SIZE = 16 * 1024 * 1024;
+
         ShaderSource _shaderSource;
         
         mutable GLuint _progId;
@@ -8,6 +8,7 @@ namespace carto {
 
     ShaderManager::ShaderManager() :
         _glThreadId(),
+        _programCachePath(),
         _shaderMap(),
         _createQueue(),
         _deleteProgIdQueue(),
@@ -31,6 +32,18 @@ namespace carto {
         _glThreadId = id;
     }
 
+    std::string ShaderManager::getProgramCachePath() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        return _programCachePath;
+    }
+
+    void ShaderManager::setProgramCachePath(const std::string& path) {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        _programCachePath = path;
+    }
+
     std::shared_ptr<Shader> ShaderManager::createShader(const ShaderSource& source) {
         std::lock_guard<std::mutex> lock(_mutex);
 
@@ -74,7 +87,7 @@ namespace carto {
 
             for (const std::weak_ptr<Shader>& shaderWeak : _createQueue) {
                 if (auto shader = shaderWeak.lock()) {
-                    shader->load();
+                    shader->load(_programCachePath);
                 }
             }
             std::swap(createQueue, _createQueue); // release the shaders only after lock is released
@@ -27,6 +27,9 @@ namespace carto {
         std::thread::id getGLThreadId() const;
         void setGLThreadId(std::thread::id id);
 
+        std::string getProgramCachePath() const;
+        void setProgramCachePath(const std::string& path);
+
         std::shared_ptr<Shader> createShader(const ShaderSource& source);
 
         void processShaders();
@@ -35,6 +38,7 @@ namespace carto {
         void deleteShader(Shader* texture);
 
         std::thread::id _glThreadId;
+        std::string _programCachePath;
         std::unordered_map<const ShaderSource*, std::weak_ptr<Shader> > _shaderMap;
         std::vector<std::weak_ptr<Shader> > _createQueue;
         std::vector<GLuint> _deleteProgIdQueue;
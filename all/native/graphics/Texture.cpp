@@ -1,4 +1,6 @@
 #include "Texture.h"
+#include "core/BinaryData.h"
+#include "components/MemoryAccounting.h"
 #include "graphics/TextureManager.h"
 #include "graphics/Bitmap.h"
 #include "graphics/utils/GLContext.h"
@@ -19,6 +21,10 @@ namespace carto {
     bool Texture::isRepeat() const {
         return _repeat;
     }
+
+    bool Texture::isCompressed() const {
+        return _compressedData.get() != nullptr;
+    }
         
     std::size_t Texture::getSize() const {
         return _sizeInBytes;
@@ -38,8 +44,41 @@ namespace carto {
         return _texId;
     }
 
+    void Texture::updateSubBitmap(int x, int y, const Bitmap& bitmap) const {
+        if (std::this_thread::get_id() != _textureManager->getGLThreadId()) {
+            Log::Warn("Texture::updateSubBitmap: Method called from wrong thread!");
+            return;
+        }
+        if (!_bitmap) {
+            Log::Error("Texture::updateSubBitmap: Compressed textures can not be updated");
+            return;
+        }
+        if (bitmap.getColorFormat() != _bitmap->getColorFormat()) {
+            Log::Error("Texture::updateSubBitmap: Color format mismatch");
+            return;
+        }
+
+        load();
+
+        GLint oldTexId = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &oldTexId);
+
+        glBindTexture(GL_TEXTURE_2D, _texId);
+        const std::vector<unsigned char>& pixelData = bitmap.getPixelData();
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, bitmap.getWidth(), bitmap.getHeight(), bitmap.getColorFormat(), GL_UNSIGNED_BYTE, pixelData.data());
+        GLContext::CountTextureUpload(pixelData.size());
+
+        glBindTexture(GL_TEXTURE_2D, oldTexId);
+
+        GLContext::CheckGLError("Texture::updateSubBitmap");
+    }
+
     Texture::Texture(const std::shared_ptr<TextureManager>& textureManager, const std::shared_ptr<Bitmap>& bitmap, bool genMipmaps, bool repeat) :
         _bitmap(bitmap),
+        _compressedFormat(0),
+        _compressedWidth(0),
+        _compressedHeight(0),
+        _compressedData(),
         _mipmaps(genMipmaps),
         _repeat(repeat),
         _sizeInBytes(0),
@@ -64,9 +103,37 @@ namespace carto {
         _sizeInBytes = static_cast<std::size_t>((_mipmaps ? MIPMAP_SIZE_MULTIPLIER : 1.0) * _bitmap->getWidth() * _bitmap->getHeight() * _bitmap->getBytesPerPixel());
     }
 
+    Texture::Texture(const std::shared_ptr<TextureManager>& textureManager, GLenum compressedFormat, int width, int height, const std::shared_ptr<BinaryData>& compressedData, bool repeat) :
+        _bitmap(),
+        _compressedFormat(compressedFormat),
+        _compressedWidth(width),
+        _compressedHeight(height),
+        _compressedData(compressedData),
+        _mipmaps(false),
+        _repeat(repeat),
+        _sizeInBytes(compressedData->size()),
+        _texCoordScale(1.0f, 1.0f),
+        _texId(0),
+        _textureManager(textureManager)
+    {
+        bool npot = !GeneralUtils::IsPow2(width) || !GeneralUtils::IsPow2(height);
+        if (npot && repeat && !GLContext::TEXTURE_NPOT_REPEAT) {
+            // Compressed data can not be resized, fall back to clamping
+            Log::Warn("Texture: Repeating NPOT compressed textures are not supported, using clamping instead");
+            _repeat = false;
+        }
+    }
+
     void Texture::load() const {
         if (_texId == 0) {
-            _texId = loadFromBitmap(*_bitmap, _mipmaps, _repeat);
+            if (_compressedData) {
+                _texId = loadFromCompressedData(_compressedFormat, _compressedWidth, _compressedHeight, *_compressedData, _repeat);
+            } else {
+                _texId = loadFromBitmap(*_bitmap, _mipmaps, _repeat);
+            }
+            if (_texId != 0) {
+                MemoryAccounting::Allocate(MemoryCategory::MEMORY_CATEGORY_TEXTURES, _sizeInBytes);
+            }
         }
     }
 
@@ -74,6 +141,7 @@ namespace carto {
         if (_texId != 0) {
             glDeleteTextures(1, &_texId);
             _texId = 0;
+            MemoryAccounting::Release(MemoryCategory::MEMORY_CATEGORY_TEXTURES, _sizeInBytes);
 
             GLContext::CheckGLError("Texture::unload");
         }
@@ -95,7 +163,47 @@ namespace carto {
         const std::vector<unsigned char>& pixelData = bitmap.getPixelData();
         glTexImage2D(GL_TEXTURE_2D, 0, bitmap.getColorFormat(), bitmap.getWidth(), bitmap.getHeight(),
                 0, bitmap.getColorFormat(), GL_UNSIGNED_BYTE, pixelData.data());
-        
+        GLContext::CountTextureUpload(pixelData.size());
+
+        SetTextureParameters(genMipmaps, repeat);
+    
+        if (genMipmaps) {
+            glGenerateMipmap(GL_TEXTURE_2D);
+        }
+
+        glBindTexture(GL_TEXTURE_2D, oldTexId);
+    
+        GLContext::CheckGLError("Texture::loadFromBitmap");
+    
+        return texId;
+    }
+
+    GLuint Texture::loadFromCompressedData(GLenum format, int width, int height, const BinaryData& data, bool repeat) const {
+        if (!GLContext::IsCompressedTextureFormatSupported(format)) {
+            Log::Errorf("Texture::loadFromCompressedData: Failed to create texture, unsupported compressed format 0x%x", format);
+            return 0;
+        }
+
+        GLint oldTexId = 0;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &oldTexId);
+
+        GLuint texId = 0;
+        glGenTextures(1, &texId);
+        glBindTexture(GL_TEXTURE_2D, texId);
+
+        glCompressedTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, static_cast<GLsizei>(data.size()), data.data());
+        GLContext::CountTextureUpload(data.size());
+
+        SetTextureParameters(false, repeat);
+
+        glBindTexture(GL_TEXTURE_2D, oldTexId);
+
+        GLContext::CheckGLError("Texture::loadFromCompressedData");
+
+        return texId;
+    }
+
+    void Texture::SetTextureParameters(bool genMipmaps, bool repeat) {
         if (repeat) {
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
             glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -118,15 +226,7 @@ namespace carto {
                     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, std::min(MAX_ANISOTROPY, deviceMaxAnisotropy));
                 }
             }
-    
-            glGenerateMipmap(GL_TEXTURE_2D);
         }
-
-        glBindTexture(GL_TEXTURE_2D, oldTexId);
-    
-        GLContext::CheckGLError("Texture::loadFromBitmap");
-    
-        return texId;
     }
         
     const int Texture::MAX_ANISOTROPY = 8;
@@ -14,6 +14,7 @@
 #include <cglib/vec.h>
 
 namespace carto {
+    class BinaryData;
     class Bitmap;
     class TextureManager;
     
@@ -24,6 +25,8 @@ namespace carto {
         bool isMipmaps() const;
         
         bool isRepeat() const;
+
+        bool isCompressed() const;
         
         std::size_t getSize() const;
         
@@ -31,10 +34,20 @@ namespace carto {
         
         GLuint getTexId() const;
 
+        /**
+         * Updates a rectangular region of the texture contents. Must be called from the GL thread.
+         * @param x The left offset of the region in texels.
+         * @param y The bottom offset of the region in texels.
+         * @param bitmap The new contents of the region. Must have the same color format as the texture bitmap.
+         *               Compressed textures can not be updated.
+         */
+        void updateSubBitmap(int x, int y, const Bitmap& bitmap) const;
+
     protected:
         friend class TextureManager;
 
         Texture(const std::shared_ptr<TextureManager>& textureManager, const std::shared_ptr<Bitmap>& bitmap, bool genMipmaps, bool repeat);
+        Texture(const std::shared_ptr<TextureManager>& textureManager, GLenum compressedFormat, int width, int height, const std::shared_ptr<BinaryData>& compressedData, bool repeat);
 
         void load() const;
         void unload() const;
@@ -45,8 +58,15 @@ namespace carto {
         static const double MIPMAP_SIZE_MULTIPLIER;
     
         GLuint loadFromBitmap(const Bitmap& bitmap, bool genMipmaps, bool repeat) const;
+        GLuint loadFromCompressedData(GLenum format, int width, int height, const BinaryData& data, bool repeat) const;
+
+        static void SetTextureParameters(bool genMipmaps, bool repeat);
         
         std::shared_ptr<Bitmap> _bitmap;
+        GLenum _compressedFormat;
+        int _compressedWidth;
+        int _compressedHeight;
+        std::shared_ptr<BinaryData> _compressedData;
         bool _mipmaps;
         bool _repeat;
         
@@ -1,4 +1,5 @@
 #include "TextureManager.h"
+#include "components/MemoryAccounting.h"
 #include "graphics/Texture.h"
 #include "utils/Log.h"
 
@@ -40,8 +41,21 @@ namespace carto {
         return texture;
     }
 
+    std::shared_ptr<Texture> TextureManager::createCompressedTexture(GLenum format, int width, int height, const std::shared_ptr<BinaryData>& data, bool repeat) {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        std::shared_ptr<Texture> texture(
+            new Texture(shared_from_this(), format, width, height, data, repeat), [this](Texture* texture) {
+                deleteTexture(texture);
+            }
+        );
+
+        _createQueue.push_back(texture);
+        return texture;
+    }
+
     void TextureManager::processTextures() {
-        std::vector<std::weak_ptr<Texture> > createQueue;
+        std::vector<std::shared_ptr<Texture> > processedTextures;
         {
             std::lock_guard<std::mutex> lock(_mutex);
 
@@ -55,17 +69,32 @@ namespace carto {
                 _deleteTexIdQueue.clear();
             }
 
-            for (const std::weak_ptr<Texture>& textureWeak : _createQueue) {
-                if (auto texture = textureWeak.lock()) {
+            // Upload textures in creation order until the budget is exhausted. At least one texture is uploaded per call to guarantee progress.
+            // Textures already loaded on demand by the renderers are simply dropped from the queue
+            std::size_t uploadedSize = 0;
+            while (!_createQueue.empty()) {
+                std::shared_ptr<Texture> texture = _createQueue.front().lock();
+                if (texture && texture->_texId == 0) {
+                    if (uploadedSize > 0 && uploadedSize + texture->getSize() > UPLOAD_BUDGET_PER_FRAME) {
+                        break;
+                    }
                     texture->load();
+                    uploadedSize += texture->getSize();
                 }
+                _createQueue.pop_front();
+                processedTextures.push_back(std::move(texture)); // release the textures only after lock is released
             }
-            std::swap(createQueue, _createQueue); // release the textures only after lock is released
         }
 
         GLContext::CheckGLError("TextureManager::processTextures");
     }
 
+    bool TextureManager::hasPendingTextures() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        return !_createQueue.empty();
+    }
+
     void TextureManager::deleteTexture(Texture* texture) {
         std::lock_guard<std::mutex> lock(_mutex);
 
@@ -75,10 +104,13 @@ namespace carto {
             } else {
                 if (texture->_texId != 0) {
                     _deleteTexIdQueue.push_back(texture->_texId);
+                    MemoryAccounting::Release(MemoryCategory::MEMORY_CATEGORY_TEXTURES, texture->_sizeInBytes);
                 }
             }
             delete texture;
         }
     }
 
+    const std::size_t TextureManager::UPLOAD_BUDGET_PER_FRAME = 4 * 1024 * 1024;
+
 }
@@ -9,12 +9,14 @@
 
 #include "graphics/Texture.h"
 
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <thread>
 #include <vector>
 
 namespace carto {
+    class BinaryData;
 
     class TextureManager : public std::enable_shared_from_this<TextureManager> {
     public:
@@ -25,14 +27,37 @@ namespace carto {
         void setGLThreadId(std::thread::id id);
     
         std::shared_ptr<Texture> createTexture(const std::shared_ptr<Bitmap>& bitmap, bool genMipmaps, bool repeat);
+        /**
+         * Creates a texture from a GPU compressed payload (for example ETC2, ASTC or PVRTC). Mipmaps are not generated.
+         * The format should be checked using GLContext::IsCompressedTextureFormatSupported before creating the texture.
+         * @param format The GL compressed internal format of the data.
+         * @param width The width of the texture in pixels.
+         * @param height The height of the texture in pixels.
+         * @param data The compressed data of the first mipmap level.
+         * @param repeat True if the texture should be repeated.
+         * @return The new texture. The texture is uploaded asynchronously.
+         */
+        std::shared_ptr<Texture> createCompressedTexture(GLenum format, int width, int height, const std::shared_ptr<BinaryData>& data, bool repeat);
 
+        /**
+         * Uploads pending textures, limited by the per-frame upload budget. Textures that do not fit into the budget
+         * are uploaded during the following frames, or immediately when they are first used for drawing.
+         */
         void processTextures();
+
+        /**
+         * Returns true if there are textures waiting to be uploaded.
+         * @return True if there are textures waiting to be uploaded.
+         */
+        bool hasPendingTextures() const;
     
     private:
+        static const std::size_t UPLOAD_BUDGET_PER_FRAME; // Maximum number of bytes uploaded by processTextures
+
         void deleteTexture(Texture* texture);
 
         std::thread::id _glThreadId;
-        std::vector<std::weak_ptr<Texture> > _createQueue;
+        std::deque<std::weak_ptr<Texture> > _createQueue;
         std::vector<GLuint> _deleteTexIdQueue;
         mutable std::mutex _mutex;
     };
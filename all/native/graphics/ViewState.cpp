@@ -428,12 +428,13 @@ namespace carto {
     
     void ViewState::calculateViewState(const Options& options) {
         // If FOV or tile draw size changed, recalculate zoom0Distance
-        std::shared_ptr<ProjectionSurface> projectionSurface = options.getProjectionSurface();
-        int FOVY = options.getFieldOfViewY();
-        int tileDrawSize = options.getTileDrawSize();
-        float dpi = options.getDPI();
-        MapRange zoomRange = options.getZoomRange();
-        bool restrictedPanning = options.isRestrictedPanning();
+        std::shared_ptr<const Options::Snapshot> snapshot = options.getSnapshot();
+        std::shared_ptr<ProjectionSurface> projectionSurface = snapshot->projectionSurface;
+        int FOVY = snapshot->fovY;
+        int tileDrawSize = snapshot->tileDrawSize;
+        float dpi = snapshot->dpi;
+        MapRange zoomRange = snapshot->zoomRange;
+        bool restrictedPanning = snapshot->restrictedPanning;
         if (projectionSurface != _projectionSurface || FOVY != _fovY || tileDrawSize != _tileDrawSize || dpi != _dpi || zoomRange != _zoomRange || restrictedPanning != _restrictedPanning || _screenSizeChanged) {
             _fovY = FOVY;
             _tileDrawSize = tileDrawSize;
@@ -525,7 +526,7 @@ namespace carto {
             _rteModelviewProjectionMat = cglib::mat4x4<float>::convert(_projectionMat) * _rteModelviewMat;
 
             // Calculate Rte sky matrix
-            float skyFar = _zoom0Distance * options.getDrawDistance();
+            float skyFar = _zoom0Distance * snapshot->drawDistance;
             cglib::mat4x4<double> skyProjectionMat = calculatePerspMat(_halfFOVY, _near, skyFar, options);
             _rteSkyProjectionMat = cglib::mat4x4<float>::convert(skyProjectionMat) * _rteModelviewMat;
         }
@@ -621,7 +622,10 @@ namespace carto {
     }
 
     void ViewState::calculateViewDistances(const Options& options, float& near, float& far, bool& skyVisible) const {
-        float halfFOVY = options.getFieldOfViewY() * 0.5f;
+        // Use a single snapshot, the projection surface is queried for each sample ray below
+        std::shared_ptr<const Options::Snapshot> snapshot = options.getSnapshot();
+        const std::shared_ptr<ProjectionSurface>& projectionSurface = snapshot->projectionSurface;
+        float halfFOVY = snapshot->fovY * 0.5f;
         float tanHalfFOVY = std::tan(static_cast<float>(halfFOVY * Const::DEG_TO_RAD));
         float zoom0Distance = _height * Const::HALF_WORLD_SIZE / (_tileDrawSize * tanHalfFOVY * (_dpi / Const::UNSCALED_DPI));
         float initialZ = std::pow(2.0f, -_zoom) * zoom0Distance / 64.0f;
@@ -634,7 +638,7 @@ namespace carto {
         double heightMin = Const::MIN_HEIGHT;
         double heightMax = Const::MAX_HEIGHT;
 
-        near = static_cast<float>(cglib::dot_product(options.getProjectionSurface()->calculateNearestPoint(_cameraPos, heightMax) - _cameraPos, zProjVector));
+        near = static_cast<float>(cglib::dot_product(projectionSurface->calculateNearestPoint(_cameraPos, heightMax) - _cameraPos, zProjVector));
         far  = near;
         skyVisible = false;
         for (double xx : { -1, 0, 1 }) {
@@ -647,7 +651,7 @@ namespace carto {
                     cglib::ray3<double> ray(worldPos0, worldPos1 - worldPos0);
 
                     double t = -1;
-                    if (options.getProjectionSurface()->calculateHitPoint(ray, heightMin, t) && t > 0) {
+                    if (projectionSurface->calculateHitPoint(ray, heightMin, t) && t > 0) {
                         float z = static_cast<float>(cglib::dot_product(ray(t) - worldPos0, zProjVector));
                         near = std::min(near, z);
                         far  = std::max(far,  z);
@@ -666,7 +670,7 @@ namespace carto {
             }
         }
 
-        double maxDist = std::pow(2.0f, -_zoom) * zoom0Distance * options.getDrawDistance();
+        double maxDist = std::pow(2.0f, -_zoom) * zoom0Distance * snapshot->drawDistance;
         if (far > maxDist) {
             far = maxDist;
             skyVisible = true;
@@ -747,8 +751,9 @@ namespace carto {
         double left = bottom * _aspectRatio;
         double right = top * _aspectRatio;
 
-        double dx =  2 * near * tanHalfFOVY * options.getFocusPointOffset().getX() / _height;
-        double dy = -2 * near * tanHalfFOVY * options.getFocusPointOffset().getY() / _height;
+        ScreenPos focusPointOffset = options.getSnapshot()->focusPointOffset;
+        double dx =  2 * near * tanHalfFOVY * focusPointOffset.getX() / _height;
+        double dy = -2 * near * tanHalfFOVY * focusPointOffset.getY() / _height;
         
         top += dy;
         bottom += dy;
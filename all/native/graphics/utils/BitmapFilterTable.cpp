@@ -1,7 +1,67 @@
 #include "BitmapFilterTable.h"
 
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CARTO_BITMAPFILTERTABLE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define CARTO_BITMAPFILTERTABLE_NEON
+#endif
+
 namespace carto {
 
+    void BitmapFilterTable::filterPixels(const unsigned char* sourceData, unsigned char* data, int pixelBegin, int pixelEnd) const {
+        // All 4 channels of a pixel are accumulated in a single vector register. The rounding matches the scalar version
+        for (int i = pixelBegin; i < pixelEnd; i++) {
+            std::size_t sampleBegin = _pixelSampleIndices[i];
+            std::size_t sampleEnd = _pixelSampleIndices[i + 1];
+            if (sampleBegin == sampleEnd) {
+                continue;
+            }
+
+#if defined(CARTO_BITMAPFILTERTABLE_SSE2)
+            __m128i zero = _mm_setzero_si128();
+            __m128 color = _mm_set1_ps(0.5f);
+            for (std::size_t j = sampleBegin; j < sampleEnd; j++) {
+                int packedValue;
+                std::memcpy(&packedValue, &sourceData[_sampleOffsets[j] * 4], 4);
+                __m128i value = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packedValue), zero), zero);
+                color = _mm_add_ps(color, _mm_mul_ps(_mm_cvtepi32_ps(value), _mm_set1_ps(_sampleWeights[j])));
+            }
+            __m128i result = _mm_cvttps_epi32(color);
+            result = _mm_packs_epi32(result, result);
+            result = _mm_packus_epi16(result, result);
+            int packedResult = _mm_cvtsi128_si32(result);
+            std::memcpy(&data[i * 4], &packedResult, 4);
+#elif defined(CARTO_BITMAPFILTERTABLE_NEON)
+            float32x4_t color = vdupq_n_f32(0.5f);
+            for (std::size_t j = sampleBegin; j < sampleEnd; j++) {
+                uint32_t packedValue;
+                std::memcpy(&packedValue, &sourceData[_sampleOffsets[j] * 4], 4);
+                uint32x4_t value = vmovl_u16(vget_low_u16(vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(packedValue)))));
+                color = vmlaq_n_f32(color, vcvtq_f32_u32(value), _sampleWeights[j]);
+            }
+            uint16x4_t result = vmovn_u32(vcvtq_u32_f32(color));
+            uint32_t packedResult = vget_lane_u32(vreinterpret_u32_u8(vmovn_u16(vcombine_u16(result, result))), 0);
+            std::memcpy(&data[i * 4], &packedResult, 4);
+#else
+            float color[4] = { 0.5f, 0.5f, 0.5f, 0.5f };
+            for (std::size_t j = sampleBegin; j < sampleEnd; j++) {
+                const unsigned char* value = &sourceData[_sampleOffsets[j] * 4];
+                float weight = _sampleWeights[j];
+                for (int c = 0; c < 4; c++) {
+                    color[c] += value[c] * weight;
+                }
+            }
+            for (int c = 0; c < 4; c++) {
+                data[i * 4 + c] = static_cast<unsigned char>(color[c]);
+            }
+#endif
+        }
+    }
+
     const int BitmapFilterTable::_GaussTableSize = 64;
 
     const float BitmapFilterTable::_GaussTable[] = {
@@ -10,6 +10,7 @@
 #include "graphics/Bitmap.h"
 #include "utils/Log.h"
 
+#include <cstddef>
 #include <vector>
 
 #include <cglib/bbox.h>
@@ -18,19 +19,24 @@ namespace carto {
 
     /**
      * Filter table using Elliptic Weighted Average filtering.
+     * The samples are stored as separate offset and weight arrays, the offsets are pixel indices
+     * into the RGBA source area given by the constructor bounds.
      */
     class BitmapFilterTable {
     public:
-        struct Sample {
-            short u;
-            short v;
-            float weight;
-        };
-
-        BitmapFilterTable(int minU, int minV, int maxU, int maxV) : _minU(minU), _minV(minV), _maxU(maxU), _maxV(maxV), _sampleCounts(), _samples() { }
-
-        const std::vector<int>& getSampleCounts() const { return _sampleCounts; }
-        const std::vector<Sample>& getSamples() const { return _samples; }
+        BitmapFilterTable(int minU, int minV, int maxU, int maxV) : _minU(minU), _minV(minV), _maxU(maxU), _maxV(maxV), _pixelSampleIndices(), _sampleOffsets(), _sampleWeights() { }
+
+        int getPixelCount() const { return _pixelSampleIndices.empty() ? 0 : static_cast<int>(_pixelSampleIndices.size() - 1); }
+
+        /**
+         * Filters the given range of destination pixels. Pixels without samples are not written.
+         * The method does not modify the table, so disjoint pixel ranges can be filtered in parallel.
+         * @param sourceData The RGBA source area corresponding to the table bounds.
+         * @param data The RGBA destination buffer for all the destination pixels.
+         * @param pixelBegin The first destination pixel to filter.
+         * @param pixelEnd The destination pixel after the last pixel to filter.
+         */
+        void filterPixels(const unsigned char* sourceData, unsigned char* data, int pixelBegin, int pixelEnd) const;
         
         template <typename Transform>
         void calculateFilterTable(const Transform& transform, int sizeX, int sizeY, float filterScale, int maxFilterWidth);
@@ -40,7 +46,7 @@ namespace carto {
 
     private:
         void calculatePixelSamples(int ui, int vi, float uf, float vf, int du, int dv, float a, float b, float c) {
-            std::size_t sampleIndex = _samples.size();
+            std::size_t sampleIndex = _sampleWeights.size();
             float samplesWeight = 0;
 
             // Filter using EWA
@@ -73,26 +79,24 @@ namespace carto {
                 addSample(ui + 1, vi + 1, uf * vf);
             } else {
                 float invSamplesWeight = 1.0f / samplesWeight;
-                while (sampleIndex < _samples.size()) {
-                    _samples[sampleIndex++].weight *= invSamplesWeight;
+                while (sampleIndex < _sampleWeights.size()) {
+                    _sampleWeights[sampleIndex++] *= invSamplesWeight;
                 }
             }
         }
 
         void addSample(int u, int v, float weight) {
             if (u >= _minU && v >= _minV && u < _maxU && v < _maxV) {
-                _samples.emplace_back(Sample());
-                Sample& sample = _samples.back();
-                sample.u = static_cast<short>(u - _minU);
-                sample.v = static_cast<short>(v - _minV);
-                sample.weight = weight;
+                _sampleOffsets.push_back((v - _minV) * (_maxU - _minU) + (u - _minU));
+                _sampleWeights.push_back(weight);
             }
         }
 
         int _minU, _minV;
         int _maxU, _maxV;
-        std::vector<int> _sampleCounts;
-        std::vector<Sample> _samples;
+        std::vector<std::size_t> _pixelSampleIndices; // first sample of each destination pixel, plus the end of the samples
+        std::vector<int> _sampleOffsets;
+        std::vector<float> _sampleWeights;
 
         static const int _GaussTableSize;
         static const float _GaussTable[];
@@ -127,13 +131,15 @@ namespace carto {
         int dv = std::min(maxFilterWidth, static_cast<int>(std::abs(vx) + std::abs(vy) + 1));
 
         // Reserve memory for samples
-        _sampleCounts.reserve(sizeX * sizeY);
-        _samples.reserve(sizeX * sizeY * std::min(du * dv * 4, 16));
+        std::size_t sampleCapacity = static_cast<std::size_t>(sizeX) * sizeY * std::min(du * dv * 4, 16);
+        _pixelSampleIndices.reserve(sizeX * sizeY + 1);
+        _sampleOffsets.reserve(sampleCapacity);
+        _sampleWeights.reserve(sampleCapacity);
 
         // Calculate all samples
         for (int y = 0; y < sizeY; y++) {
             for (int x = 0; x < sizeX; x++) {
-                std::size_t sampleIndex = _samples.size();
+                _pixelSampleIndices.push_back(_sampleWeights.size());
 
                 // Calculate samples
                 cglib::vec2<double> uv = transform(x, y);
@@ -144,11 +150,9 @@ namespace carto {
                 if (ui + du >= _minU && vi + dv >= _minV && ui - du < _maxU && vi - dv < _maxV) {
                     calculatePixelSamples(ui, vi, uf, vf, du, dv, a, b, c);
                 }
-
-                // Add sample count
-                _sampleCounts.push_back(static_cast<int>(_samples.size() - sampleIndex));
             }
         }
+        _pixelSampleIndices.push_back(_sampleWeights.size());
     }
 
     template <typename Transform>
@@ -0,0 +1,35 @@
+#include "CanvasBitmapCache.h"
+#include "graphics/Bitmap.h"
+
+namespace carto {
+
+    std::shared_ptr<Bitmap> CanvasBitmapCache::Get(const std::string& key) {
+        std::lock_guard<std::mutex> lock(_Mutex);
+
+        std::shared_ptr<Entry> entry;
+        if (_Cache.read(key, entry)) {
+            return entry->bitmap;
+        }
+        return std::shared_ptr<Bitmap>();
+    }
+
+    void CanvasBitmapCache::Put(const std::string& key, const std::shared_ptr<Bitmap>& bitmap, const std::vector<std::shared_ptr<Bitmap> >& sourceBitmaps) {
+        if (!bitmap) {
+            return;
+        }
+
+        auto entry = std::make_shared<Entry>();
+        entry->bitmap = bitmap;
+        entry->sourceBitmaps = sourceBitmaps;
+        std::size_t size = bitmap->getPixelData().size() + key.size();
+
+        std::lock_guard<std::mutex> lock(_Mutex);
+        _Cache.put(key, entry, size);
+    }
+
+    const std::size_t CanvasBitmapCache::CACHE_SIZE = 4 * 1024 * 1024;
+
+    cache::timed_lru_cache<std::string, std::shared_ptr<CanvasBitmapCache::Entry> > CanvasBitmapCache::_Cache(CanvasBitmapCache::CACHE_SIZE);
+    std::mutex CanvasBitmapCache::_Mutex;
+
+}
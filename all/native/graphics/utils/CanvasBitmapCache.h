@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_CANVASBITMAPCACHE_H_
+#define _CARTO_CANVASBITMAPCACHE_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <stdext/timed_lru_cache.h>
+
+namespace carto {
+    class Bitmap;
+
+    /**
+     * Process-wide cache of the bitmaps rendered with BitmapCanvas by the vector elements.
+     * The bitmaps are keyed by a description of everything that affects the rendering (the content,
+     * the style values and the scale), so elements with identical content and style share a single bitmap.
+     * The cached bitmaps are immutable.
+     */
+    class CanvasBitmapCache {
+    public:
+        /**
+         * Returns the cached bitmap for the key.
+         * @param key The key describing the rendered bitmap.
+         * @return The cached bitmap or null if the bitmap is not cached.
+         */
+        static std::shared_ptr<Bitmap> Get(const std::string& key);
+
+        /**
+         * Stores the bitmap in the cache. The least recently used bitmaps are released if the cache is full.
+         * @param key The key describing the rendered bitmap.
+         * @param bitmap The bitmap to store.
+         * @param sourceBitmaps The bitmaps drawn into the stored bitmap and referenced by their addresses in the key.
+         *                      These are kept with the entry, so that the addresses can not be reused while the entry exists.
+         */
+        static void Put(const std::string& key, const std::shared_ptr<Bitmap>& bitmap, const std::vector<std::shared_ptr<Bitmap> >& sourceBitmaps);
+
+    private:
+        struct Entry {
+            std::shared_ptr<Bitmap> bitmap;
+            std::vector<std::shared_ptr<Bitmap> > sourceBitmaps;
+        };
+
+        CanvasBitmapCache();
+
+        static const std::size_t CACHE_SIZE;
+
+        static cache::timed_lru_cache<std::string, std::shared_ptr<Entry> > _Cache;
+        static std::mutex _Mutex;
+    };
+
+}
+
+#endif
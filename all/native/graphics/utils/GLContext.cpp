@@ -8,6 +8,11 @@
 
 namespace carto {
 
+    std::size_t GLContext::GetMaxVertexBufferSize() {
+        // 32-bit indices allow much larger batches. Otherwise, the buffers must fit into 16-bit indices
+        return ELEMENT_INDEX_UINT ? MAX_UINT_VERTEXBUFFER_SIZE : MAX_VERTEXBUFFER_SIZE;
+    }
+
     bool GLContext::HasGLExtension(const char* extension) {
         std::lock_guard<std::recursive_mutex> lock(_Mutex);
     
@@ -18,6 +23,12 @@ namespace carto {
         return false;
     }
     
+    bool GLContext::IsCompressedTextureFormatSupported(GLenum format) {
+        std::lock_guard<std::recursive_mutex> lock(_Mutex);
+
+        return _CompressedTextureFormatCache.find(format) != _CompressedTextureFormatCache.end();
+    }
+    
     void GLContext::LoadExtensions() {
         std::lock_guard<std::recursive_mutex> lock(_Mutex);
 
@@ -39,11 +50,72 @@ namespace carto {
 
         PACKED_DEPTH_STENCIL = HasGLExtension("GL_OES_packed_depth_stencil");
 
+        ELEMENT_INDEX_UINT = HasGLExtension("GL_OES_element_index_uint");
+
+        // Compressed formats (ETC1/ETC2/ASTC/PVRTC) are reported by the driver, regardless of the extension that introduced them
+        GLint compressedFormatCount = 0;
+        glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &compressedFormatCount);
+        if (compressedFormatCount > 0) {
+            std::vector<GLint> compressedFormats(compressedFormatCount);
+            glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, compressedFormats.data());
+            _CompressedTextureFormatCache.insert(compressedFormats.begin(), compressedFormats.end());
+        }
+
 #if !defined(__APPLE__) && defined(GL_EXT_discard_framebuffer)
         if (DISCARD_FRAMEBUFFER) {
             _DiscardFramebufferEXT = reinterpret_cast<PFNGLDISCARDFRAMEBUFFEREXTPROC>(eglGetProcAddress("glDiscardFramebufferEXT"));
         }
 #endif
+
+#ifdef __APPLE__
+        INSTANCED_ARRAYS = HasGLExtension("GL_EXT_instanced_arrays");
+#elif defined(GL_ANGLE_instanced_arrays)
+        // Instancing is core in GLES 3.0, otherwise use EXT or ANGLE extensions. All variants have identical signatures.
+        const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+        const char* suffix = nullptr;
+        if (version && std::string(version).find("OpenGL ES 3.") == 0) {
+            suffix = "";
+        } else if (HasGLExtension("GL_EXT_instanced_arrays") && HasGLExtension("GL_EXT_draw_instanced")) {
+            suffix = "EXT";
+        } else if (HasGLExtension("GL_ANGLE_instanced_arrays")) {
+            suffix = "ANGLE";
+        }
+        if (suffix) {
+            _VertexAttribDivisor = reinterpret_cast<PFNGLVERTEXATTRIBDIVISORANGLEPROC>(eglGetProcAddress((std::string("glVertexAttribDivisor") + suffix).c_str()));
+            _DrawElementsInstanced = reinterpret_cast<PFNGLDRAWELEMENTSINSTANCEDANGLEPROC>(eglGetProcAddress((std::string("glDrawElementsInstanced") + suffix).c_str()));
+        }
+        INSTANCED_ARRAYS = _VertexAttribDivisor && _DrawElementsInstanced;
+#endif
+
+#if !defined(__APPLE__) && defined(GL_EXT_disjoint_timer_query)
+        if (HasGLExtension("GL_EXT_disjoint_timer_query")) {
+            _GenQueriesEXT = reinterpret_cast<PFNGLGENQUERIESEXTPROC>(eglGetProcAddress("glGenQueriesEXT"));
+            _DeleteQueriesEXT = reinterpret_cast<PFNGLDELETEQUERIESEXTPROC>(eglGetProcAddress("glDeleteQueriesEXT"));
+            _BeginQueryEXT = reinterpret_cast<PFNGLBEGINQUERYEXTPROC>(eglGetProcAddress("glBeginQueryEXT"));
+            _EndQueryEXT = reinterpret_cast<PFNGLENDQUERYEXTPROC>(eglGetProcAddress("glEndQueryEXT"));
+            _GetQueryObjectuivEXT = reinterpret_cast<PFNGLGETQUERYOBJECTUIVEXTPROC>(eglGetProcAddress("glGetQueryObjectuivEXT"));
+            _GetQueryObjectui64vEXT = reinterpret_cast<PFNGLGETQUERYOBJECTUI64VEXTPROC>(eglGetProcAddress("glGetQueryObjectui64vEXT"));
+        }
+        TIMER_QUERY = _GenQueriesEXT && _DeleteQueriesEXT && _BeginQueryEXT && _EndQueryEXT && _GetQueryObjectuivEXT && _GetQueryObjectui64vEXT;
+#endif
+
+#if !defined(__APPLE__) && defined(GL_OES_get_program_binary)
+        // Program binaries are core in GLES 3.0, otherwise use the OES extension. Some drivers expose the extension without any binary formats.
+        const char* programBinaryVersion = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+        const char* programBinarySuffix = nullptr;
+        if (programBinaryVersion && std::string(programBinaryVersion).find("OpenGL ES 3.") == 0) {
+            programBinarySuffix = "";
+        } else if (HasGLExtension("GL_OES_get_program_binary")) {
+            programBinarySuffix = "OES";
+        }
+        if (programBinarySuffix) {
+            _GetProgramBinary = reinterpret_cast<PFNGLGETPROGRAMBINARYOESPROC>(eglGetProcAddress((std::string("glGetProgramBinary") + programBinarySuffix).c_str()));
+            _ProgramBinary = reinterpret_cast<PFNGLPROGRAMBINARYOESPROC>(eglGetProcAddress((std::string("glProgramBinary") + programBinarySuffix).c_str()));
+        }
+        GLint programBinaryFormatCount = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &programBinaryFormatCount);
+        PROGRAM_BINARY = _GetProgramBinary && _ProgramBinary && programBinaryFormatCount > 0;
+#endif
     }
         
     void GLContext::CheckGLError(const char* place) {
@@ -64,6 +136,111 @@ namespace carto {
 #endif
     }
     
+    void GLContext::VertexAttribDivisor(GLuint index, GLuint divisor) {
+#ifdef __APPLE__
+        ::glVertexAttribDivisorEXT(index, divisor);
+#elif defined(GL_ANGLE_instanced_arrays)
+        if (_VertexAttribDivisor) {
+            _VertexAttribDivisor(index, divisor);
+        }
+#endif
+    }
+
+    void GLContext::DrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount) {
+#ifdef __APPLE__
+        ::glDrawElementsInstancedEXT(mode, count, type, indices, instanceCount);
+#elif defined(GL_ANGLE_instanced_arrays)
+        if (_DrawElementsInstanced) {
+            _DrawElementsInstanced(mode, count, type, indices, instanceCount);
+        }
+#endif
+    }
+    
+    void GLContext::GenQueriesEXT(GLsizei n, GLuint* ids) {
+#if !defined(__APPLE__) && defined(GL_EXT_disjoint_timer_query)
+        if (_GenQueriesEXT) {
+            _GenQueriesEXT(n, ids);
+        }
+#endif
+    }
+
+    void GLContext::DeleteQueriesEXT(GLsizei n, const GLuint* ids) {
+#if !defined(__APPLE__) && defined(GL_EXT_disjoint_timer_query)
+        if (_DeleteQueriesEXT) {
+            _DeleteQueriesEXT(n, ids);
+        }
+#endif
+    }
+
+    void GLContext::BeginQueryEXT(GLenum target, GLuint id) {
+#if !defined(__APPLE__) && defined(GL_EXT_disjoint_timer_query)
+        if (_BeginQueryEXT) {
+            _BeginQueryEXT(target, id);
+        }
+#endif
+    }
+
+    void GLContext::EndQueryEXT(GLenum target) {
+#if !defined(__APPLE__) && defined(GL_EXT_disjoint_timer_query)
+        if (_EndQueryEXT) {
+            _EndQueryEXT(target);
+        }
+#endif
+    }
+
+    void GLContext::GetQueryObjectuivEXT(GLuint id, GLenum pname, GLuint* params) {
+#if !defined(__APPLE__) && defined(GL_EXT_disjoint_timer_query)
+        if (_GetQueryObjectuivEXT) {
+            _GetQueryObjectuivEXT(id, pname, params);
+        }
+#endif
+    }
+
+    void GLContext::GetQueryObjectui64vEXT(GLuint id, GLenum pname, std::uint64_t* params) {
+#if !defined(__APPLE__) && defined(GL_EXT_disjoint_timer_query)
+        if (_GetQueryObjectui64vEXT) {
+            GLuint64 value = 0;
+            _GetQueryObjectui64vEXT(id, pname, &value);
+            *params = static_cast<std::uint64_t>(value);
+        }
+#endif
+    }
+
+    void GLContext::GetProgramBinary(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary) {
+#if !defined(__APPLE__) && defined(GL_OES_get_program_binary)
+        if (_GetProgramBinary) {
+            _GetProgramBinary(program, bufSize, length, binaryFormat, binary);
+        }
+#endif
+    }
+
+    void GLContext::ProgramBinary(GLuint program, GLenum binaryFormat, const void* binary, GLint length) {
+#if !defined(__APPLE__) && defined(GL_OES_get_program_binary)
+        if (_ProgramBinary) {
+            _ProgramBinary(program, binaryFormat, binary, length);
+        }
+#endif
+    }
+
+    void GLContext::CountDrawCall(std::size_t vertexCount) {
+        _DrawCallCount.fetch_add(1, std::memory_order_relaxed);
+        _VertexCount.fetch_add(vertexCount, std::memory_order_relaxed);
+    }
+
+    void GLContext::CountTextureUpload(std::size_t sizeInBytes) {
+        _TextureUploadCount.fetch_add(1, std::memory_order_relaxed);
+        _TextureUploadBytes.fetch_add(sizeInBytes, std::memory_order_relaxed);
+    }
+
+    GLContext::DrawCounters GLContext::GetDrawCounters() {
+        DrawCounters counters;
+        counters.drawCalls = _DrawCallCount.load(std::memory_order_relaxed);
+        counters.vertices = _VertexCount.load(std::memory_order_relaxed);
+        counters.textureUploads = _TextureUploadCount.load(std::memory_order_relaxed);
+        counters.textureUploadBytes = _TextureUploadBytes.load(std::memory_order_relaxed);
+        return counters;
+    }
+    
     GLContext::GLContext() {
     }
     
@@ -74,14 +251,45 @@ namespace carto {
     bool GLContext::DISCARD_FRAMEBUFFER = false;
 
     bool GLContext::PACKED_DEPTH_STENCIL = false;
+
+    bool GLContext::ELEMENT_INDEX_UINT = false;
+
+    bool GLContext::INSTANCED_ARRAYS = false;
+
+    bool GLContext::TIMER_QUERY = false;
+
+    bool GLContext::PROGRAM_BINARY = false;
     
     std::size_t GLContext::MAX_VERTEXBUFFER_SIZE = 65535; // Should NOT exceed 64k!
+    std::size_t GLContext::MAX_UINT_VERTEXBUFFER_SIZE = 1024 * 1024; // Used only with GL_OES_element_index_uint
 
 #if !defined(__APPLE__) && defined(GL_EXT_discard_framebuffer)
     PFNGLDISCARDFRAMEBUFFEREXTPROC GLContext::_DiscardFramebufferEXT = nullptr;
 #endif
+#if !defined(__APPLE__) && defined(GL_ANGLE_instanced_arrays)
+    PFNGLVERTEXATTRIBDIVISORANGLEPROC GLContext::_VertexAttribDivisor = nullptr;
+    PFNGLDRAWELEMENTSINSTANCEDANGLEPROC GLContext::_DrawElementsInstanced = nullptr;
+#endif
+#if !defined(__APPLE__) && defined(GL_EXT_disjoint_timer_query)
+    PFNGLGENQUERIESEXTPROC GLContext::_GenQueriesEXT = nullptr;
+    PFNGLDELETEQUERIESEXTPROC GLContext::_DeleteQueriesEXT = nullptr;
+    PFNGLBEGINQUERYEXTPROC GLContext::_BeginQueryEXT = nullptr;
+    PFNGLENDQUERYEXTPROC GLContext::_EndQueryEXT = nullptr;
+    PFNGLGETQUERYOBJECTUIVEXTPROC GLContext::_GetQueryObjectuivEXT = nullptr;
+    PFNGLGETQUERYOBJECTUI64VEXTPROC GLContext::_GetQueryObjectui64vEXT = nullptr;
+#endif
+#if !defined(__APPLE__) && defined(GL_OES_get_program_binary)
+    PFNGLGETPROGRAMBINARYOESPROC GLContext::_GetProgramBinary = nullptr;
+    PFNGLPROGRAMBINARYOESPROC GLContext::_ProgramBinary = nullptr;
+#endif
+
+    std::atomic<std::size_t> GLContext::_DrawCallCount(0);
+    std::atomic<std::size_t> GLContext::_VertexCount(0);
+    std::atomic<std::size_t> GLContext::_TextureUploadCount(0);
+    std::atomic<std::size_t> GLContext::_TextureUploadBytes(0);
 
     std::unordered_set<std::string> GLContext::_ExtensionCache;
+    std::unordered_set<GLenum> GLContext::_CompressedTextureFormatCache;
         
     std::recursive_mutex GLContext::_Mutex;
     
@@ -15,6 +15,7 @@
 #include <GLES2/gl2ext.h>
 #endif
 
+#include <cstdint>
 #include <mutex>
 #include <string>
 #include <unordered_set>
@@ -32,15 +33,52 @@ namespace carto {
 
         static bool PACKED_DEPTH_STENCIL;
 
+        static bool ELEMENT_INDEX_UINT;
+
+        static bool INSTANCED_ARRAYS;
+
+        static bool TIMER_QUERY;
+
+        static bool PROGRAM_BINARY;
+
         static std::size_t MAX_VERTEXBUFFER_SIZE;
+        static std::size_t MAX_UINT_VERTEXBUFFER_SIZE;
+
+        static std::size_t GetMaxVertexBufferSize();
     
         static bool HasGLExtension(const char* extension);
+
+        static bool IsCompressedTextureFormatSupported(GLenum format);
     
         static void LoadExtensions();
         
         static void CheckGLError(const char* place);
 
         static void DiscardFramebufferEXT(GLenum target, GLsizei numAttachments, const GLenum* attachments);
+
+        static void VertexAttribDivisor(GLuint index, GLuint divisor);
+        static void DrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instanceCount);
+
+        static void GenQueriesEXT(GLsizei n, GLuint* ids);
+        static void DeleteQueriesEXT(GLsizei n, const GLuint* ids);
+        static void BeginQueryEXT(GLenum target, GLuint id);
+        static void EndQueryEXT(GLenum target);
+        static void GetQueryObjectuivEXT(GLuint id, GLenum pname, GLuint* params);
+        static void GetQueryObjectui64vEXT(GLuint id, GLenum pname, std::uint64_t* params);
+
+        static void GetProgramBinary(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+        static void ProgramBinary(GLuint program, GLenum binaryFormat, const void* binary, GLint length);
+
+        struct DrawCounters {
+            std::size_t drawCalls;
+            std::size_t vertices;
+            std::size_t textureUploads;
+            std::size_t textureUploadBytes;
+        };
+
+        static void CountDrawCall(std::size_t vertexCount);
+        static void CountTextureUpload(std::size_t sizeInBytes);
+        static DrawCounters GetDrawCounters();
     
     private:
         GLContext();
@@ -48,8 +86,30 @@ namespace carto {
 #if !defined(__APPLE__) && defined(GL_EXT_discard_framebuffer)
         static PFNGLDISCARDFRAMEBUFFEREXTPROC _DiscardFramebufferEXT;
 #endif
+#if !defined(__APPLE__) && defined(GL_ANGLE_instanced_arrays)
+        static PFNGLVERTEXATTRIBDIVISORANGLEPROC _VertexAttribDivisor;
+        static PFNGLDRAWELEMENTSINSTANCEDANGLEPROC _DrawElementsInstanced;
+#endif
+#if !defined(__APPLE__) && defined(GL_EXT_disjoint_timer_query)
+        static PFNGLGENQUERIESEXTPROC _GenQueriesEXT;
+        static PFNGLDELETEQUERIESEXTPROC _DeleteQueriesEXT;
+        static PFNGLBEGINQUERYEXTPROC _BeginQueryEXT;
+        static PFNGLENDQUERYEXTPROC _EndQueryEXT;
+        static PFNGLGETQUERYOBJECTUIVEXTPROC _GetQueryObjectuivEXT;
+        static PFNGLGETQUERYOBJECTUI64VEXTPROC _GetQueryObjectui64vEXT;
+#endif
+#if !defined(__APPLE__) && defined(GL_OES_get_program_binary)
+        static PFNGLGETPROGRAMBINARYOESPROC _GetProgramBinary;
+        static PFNGLPROGRAMBINARYOESPROC _ProgramBinary;
+#endif
+
+        static std::atomic<std::size_t> _DrawCallCount;
+        static std::atomic<std::size_t> _VertexCount;
+        static std::atomic<std::size_t> _TextureUploadCount;
+        static std::atomic<std::size_t> _TextureUploadBytes;
 
         static std::unordered_set<std::string> _ExtensionCache;
+        static std::unordered_set<GLenum> _CompressedTextureFormatCache;
     
         static std::recursive_mutex _Mutex;
     };
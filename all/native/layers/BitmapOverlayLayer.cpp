@@ -0,0 +1,130 @@
+#include "BitmapOverlayLayer.h"
+#include "components/Exceptions.h"
+#include "graphics/Bitmap.h"
+#include "graphics/ViewState.h"
+#include "projections/Projection.h"
+#include "projections/EPSG3857.h"
+#include "renderers/BitmapOverlayRenderer.h"
+#include "utils/GeomUtils.h"
+#include "utils/Log.h"
+
+#include <cglib/mat.h>
+
+namespace carto {
+
+    BitmapOverlayLayer::BitmapOverlayLayer(const std::shared_ptr<Bitmap>& bitmap, const std::shared_ptr<Projection>& projection, const std::vector<MapPos>& mapPoses, const std::vector<ScreenPos>& bitmapPoses) :
+        Layer(),
+        _bitmap(bitmap),
+        _projection(projection),
+        _corners(),
+        _bitmapOverlayRenderer(std::make_shared<BitmapOverlayRenderer>())
+    {
+        if (!bitmap) {
+            throw NullArgumentException("Null bitmap");
+        }
+        if (!projection) {
+            throw NullArgumentException("Null projection");
+        }
+
+        if (mapPoses.size() != 2 && mapPoses.size() != 3 && mapPoses.size() != 4) {
+            throw InvalidArgumentException("Position arrays must contain 2, 3 or 4 elements");
+        }
+        if (mapPoses.size() != bitmapPoses.size()) {
+            throw InvalidArgumentException("Size mismatch between position arrays");
+        }
+
+        // The transformation is calculated in EPSG3857 coordinates, like in BitmapOverlayRasterTileDataSource
+        auto epsg3857 = std::make_shared<EPSG3857>();
+        std::vector<cglib::vec2<double> > xys;
+        std::vector<cglib::vec2<double> > uvs;
+        for (std::size_t i = 0; i < mapPoses.size(); i++) {
+            MapPos pos = mapPoses[i];
+            if (!std::dynamic_pointer_cast<EPSG3857>(projection)) {
+                pos = epsg3857->fromWgs84(projection->toWgs84(pos));
+            }
+            xys.emplace_back(pos.getX(), pos.getY());
+            uvs.emplace_back(bitmapPoses[i].getX(), bitmapPoses[i].getY());
+        }
+        cglib::vec2<double> origin = cglib::vec2<double>::zero();
+        cglib::mat3x3<double> invTransform = cglib::mat3x3<double>::identity();
+        if (!GeomUtils::CalculateControlPointTransform(xys, uvs, origin, invTransform)) {
+            throw InvalidArgumentException("Map positions are collinear");
+        }
+        cglib::mat3x3<double> transform = cglib::inverse(invTransform);
+
+        // Calculate map positions of 4 bitmap corners: top-left, top-right, bottom-left, bottom-right
+        for (int y = 0; y <= 1; y++) {
+            for (int x = 0; x <= 1; x++) {
+                cglib::vec2<double> p = origin + cglib::transform_point(cglib::vec2<double>(x * bitmap->getWidth(), y * bitmap->getHeight()), transform);
+                _corners.emplace_back(p(0), p(1));
+            }
+        }
+
+        _bitmapOverlayRenderer->setOverlay(bitmap, epsg3857, _corners, origin, invTransform);
+    }
+
+    BitmapOverlayLayer::~BitmapOverlayLayer() {
+    }
+
+    std::shared_ptr<Bitmap> BitmapOverlayLayer::getBitmap() const {
+        return _bitmap;
+    }
+
+    MapBounds BitmapOverlayLayer::getDataExtent() const {
+        EPSG3857 epsg3857;
+        MapBounds bounds;
+        for (const MapPos& corner : _corners) {
+            MapPos pos = corner;
+            if (!std::dynamic_pointer_cast<EPSG3857>(_projection)) {
+                pos = _projection->fromWgs84(epsg3857.toWgs84(pos));
+            }
+            bounds.expandToContain(pos);
+        }
+        return bounds;
+    }
+
+    bool BitmapOverlayLayer::isUpdateInProgress() const {
+        return false;
+    }
+
+    void BitmapOverlayLayer::loadData(const std::shared_ptr<CullState>& cullState) {
+    }
+
+    void BitmapOverlayLayer::offsetLayerHorizontally(double offset) {
+        _bitmapOverlayRenderer->offsetLayerHorizontally(offset);
+    }
+
+    void BitmapOverlayLayer::onSurfaceCreated(const std::shared_ptr<ShaderManager>& shaderManager, const std::shared_ptr<TextureManager>& textureManager) {
+        Layer::onSurfaceCreated(shaderManager, textureManager);
+        _bitmapOverlayRenderer->onSurfaceCreated(shaderManager, textureManager);
+    }
+
+    bool BitmapOverlayLayer::onDrawFrame(float deltaSeconds, BillboardSorter& billboardSorter, StyleTextureCache& styleCache, const ViewState& viewState) {
+        if (!isVisible() || !getVisibleZoomRange().inRange(viewState.getZoom()) || getOpacity() <= 0) {
+            return false;
+        }
+
+        _bitmapOverlayRenderer->setColor(Color(255, 255, 255, static_cast<unsigned char>(255 * getOpacity())));
+        _bitmapOverlayRenderer->onDrawFrame(viewState);
+        return false;
+    }
+
+    void BitmapOverlayLayer::onSurfaceDestroyed() {
+        _bitmapOverlayRenderer->onSurfaceDestroyed();
+        Layer::onSurfaceDestroyed();
+    }
+
+    void BitmapOverlayLayer::calculateRayIntersectedElements(const cglib::ray3<double>& ray, const ViewState& viewState, std::vector<RayIntersectedElement>& results) const {
+    }
+
+    bool BitmapOverlayLayer::processClick(ClickType::ClickType clickType, const RayIntersectedElement& intersectedElement, const ViewState& viewState) const {
+        return false;
+    }
+
+    void BitmapOverlayLayer::registerDataSourceListener() {
+    }
+
+    void BitmapOverlayLayer::unregisterDataSourceListener() {
+    }
+
+}
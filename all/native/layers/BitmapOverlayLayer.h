@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_BITMAPOVERLAYLAYER_H_
+#define _CARTO_BITMAPOVERLAYLAYER_H_
+
+#include "core/MapBounds.h"
+#include "core/MapPos.h"
+#include "core/ScreenPos.h"
+#include "layers/Layer.h"
+
+#include <memory>
+#include <vector>
+
+namespace carto {
+    class Bitmap;
+    class Projection;
+    class BitmapOverlayRenderer;
+
+    /**
+     * A layer that displays a georeferenced bitmap, defined by two, three or four control points.
+     * Unlike BitmapOverlayRasterTileDataSource, the bitmap is uploaded to the GPU once (including mipmap levels)
+     * and warped to the map while drawing, so no tiles are resampled on the CPU.
+     * Note: if two points are given, conformal transformation is calculated. If three points are given, affine transformation is calculated. In case of four points, perspective transformation is used.
+     */
+    class BitmapOverlayLayer : public Layer {
+    public:
+        /**
+         * Constructs a new bitmap overlay layer.
+         * @param bitmap The bitmap to use as an overlay.
+         * @param projection The projection definining coordinate system of the control points.
+         * @param mapPoses The geographical control points. The list must contain either 2, 3 or 4 points.
+         * @param bitmapPoses The pixel coordinates in the bitmap corresponding to geographical control points. The number of coordinates must be equal to the number of control points in mapPoses list.
+         * @throws std::invalid_argument If the transformation can not be calculated.
+         */
+        BitmapOverlayLayer(const std::shared_ptr<Bitmap>& bitmap, const std::shared_ptr<Projection>& projection, const std::vector<MapPos>& mapPoses, const std::vector<ScreenPos>& bitmapPoses);
+        virtual ~BitmapOverlayLayer();
+
+        /**
+         * Returns the bitmap of this layer.
+         * @return The bitmap of this layer.
+         */
+        std::shared_ptr<Bitmap> getBitmap() const;
+
+        /**
+         * Returns the extent of the overlay.
+         * @return The extent of the overlay in the coordinate system of the projection given in the constructor.
+         */
+        MapBounds getDataExtent() const;
+
+        virtual bool isUpdateInProgress() const;
+
+    protected:
+        virtual void loadData(const std::shared_ptr<CullState>& cullState);
+
+        virtual void offsetLayerHorizontally(double offset);
+
+        virtual void onSurfaceCreated(const std::shared_ptr<ShaderManager>& shaderManager, const std::shared_ptr<TextureManager>& textureManager);
+        virtual bool onDrawFrame(float deltaSeconds, BillboardSorter& billboardSorter, StyleTextureCache& styleCache, const ViewState& viewState);
+        virtual void onSurfaceDestroyed();
+
+        virtual void calculateRayIntersectedElements(const cglib::ray3<double>& ray, const ViewState& viewState, std::vector<RayIntersectedElement>& results) const;
+        virtual bool processClick(ClickType::ClickType clickType, const RayIntersectedElement& intersectedElement, const ViewState& viewState) const;
+
+        virtual void registerDataSourceListener();
+        virtual void unregisterDataSourceListener();
+
+    private:
+        std::shared_ptr<Bitmap> _bitmap;
+        std::shared_ptr<Projection> _projection;
+        std::vector<MapPos> _corners; // bitmap corners in EPSG3857 coordinates
+        std::shared_ptr<BitmapOverlayRenderer> _bitmapOverlayRenderer;
+    };
+
+}
+
+#endif
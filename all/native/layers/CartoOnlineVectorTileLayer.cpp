@@ -44,11 +44,12 @@ namespace carto {
 
     void CartoOnlineVectorTileLayer::setComponents(const std::shared_ptr<CancelableThreadPool>& envelopeThreadPool,
         const std::shared_ptr<CancelableThreadPool>& tileThreadPool,
+        const std::shared_ptr<CancelableThreadPool>& tileDecodeThreadPool,
         const std::weak_ptr<Options>& options,
         const std::weak_ptr<MapRenderer>& mapRenderer,
         const std::weak_ptr<TouchHandler>& touchHandler)
     {
-        CartoVectorTileLayer::setComponents(envelopeThreadPool, tileThreadPool, options, mapRenderer, touchHandler);
+        CartoVectorTileLayer::setComponents(envelopeThreadPool, tileThreadPool, tileDecodeThreadPool, options, mapRenderer, touchHandler);
         if (envelopeThreadPool && tileThreadPool && _styleUpdateThreadPool) {
             _styleUpdateThreadPool->execute(std::make_shared<StyleUpdateTask>(std::static_pointer_cast<CartoOnlineVectorTileLayer>(shared_from_this()), _style));
         }
@@ -52,6 +52,7 @@ namespace carto {
     protected:
         virtual void setComponents(const std::shared_ptr<CancelableThreadPool>& envelopeThreadPool,
             const std::shared_ptr<CancelableThreadPool>& tileThreadPool,
+            const std::shared_ptr<CancelableThreadPool>& tileDecodeThreadPool,
             const std::weak_ptr<Options>& options,
             const std::weak_ptr<MapRenderer>& mapRenderer,
             const std::weak_ptr<TouchHandler>& touchHandler);
@@ -2,12 +2,17 @@
 #include "assets/CartoStylesV1ZIP.h"
 #include "core/BinaryData.h"
 #include "components/Exceptions.h"
+#include "components/Layers.h"
 #include "styles/CompiledStyleSet.h"
 #include "vectortiles/MBVectorTileDecoder.h"
 #include "utils/AssetPackage.h"
 #include "utils/ZippedAssetPackage.h"
+#include "utils/ThreadUtils.h"
 #include "utils/Log.h"
 
+#include <algorithm>
+#include <thread>
+
 namespace carto {
     
     CartoVectorTileLayer::CartoVectorTileLayer(const std::shared_ptr<TileDataSource>& dataSource, CartoBaseMapStyle::CartoBaseMapStyle style) :
@@ -25,6 +30,11 @@ namespace carto {
     {
     }
     
+    CartoVectorTileLayer::CartoVectorTileLayer(const std::shared_ptr<TileDataSource>& dataSource, const std::shared_ptr<VectorTileDecoder>& tileDecoder) :
+        VectorTileLayer(dataSource, tileDecoder)
+    {
+    }
+
     CartoVectorTileLayer::~CartoVectorTileLayer() {
     }
 
@@ -72,9 +82,55 @@ namespace carto {
         return std::make_shared<MBVectorTileDecoder>(std::make_shared<CompiledStyleSet>(styleAssetPackage, styleName));
     }
 
+    void CartoVectorTileLayer::CreateAsync(const std::shared_ptr<TileDataSource>& dataSource, CartoBaseMapStyle::CartoBaseMapStyle style, const std::shared_ptr<Layers>& layers) {
+        if (!dataSource) {
+            throw NullArgumentException("Null dataSource");
+        }
+        if (!layers) {
+            throw NullArgumentException("Null layers");
+        }
+        AddLayerAsync(dataSource, [style]() {
+            return CreateTileDecoder(style);
+        }, layers);
+    }
+
+    void CartoVectorTileLayer::CreateAsync(const std::shared_ptr<TileDataSource>& dataSource, const std::shared_ptr<AssetPackage>& styleAssetPackage, const std::string& styleName, const std::shared_ptr<Layers>& layers) {
+        if (!dataSource) {
+            throw NullArgumentException("Null dataSource");
+        }
+        if (!styleAssetPackage) {
+            throw NullArgumentException("Null styleAssetPackage");
+        }
+        if (!layers) {
+            throw NullArgumentException("Null layers");
+        }
+        AddLayerAsync(dataSource, [styleAssetPackage, styleName]() {
+            return styleName.empty() ? CreateTileDecoder(styleAssetPackage) : CreateTileDecoder(styleAssetPackage, styleName);
+        }, layers);
+    }
+
+    void CartoVectorTileLayer::PreloadStyleAsync(CartoBaseMapStyle::CartoBaseMapStyle style) {
+        std::thread loaderThread([style]() {
+            ThreadUtils::SetThreadPriority(ThreadPriority::LOW);
+            ThreadUtils::SetThreadQoSClass(ThreadQoSClass::UTILITY);
+
+            try {
+                CreateTileDecoder(style);
+            }
+            catch (const std::exception& ex) {
+                Log::Errorf("CartoVectorTileLayer::PreloadStyleAsync: Failed to load style: %s", ex.what());
+            }
+        });
+        loaderThread.detach();
+    }
+
     std::shared_ptr<AssetPackage> CartoVectorTileLayer::CreateStyleAssetPackage() {
-        auto styleAsset = std::make_shared<BinaryData>(cartostyles_v1_zip, cartostyles_v1_zip_len);
-        return std::make_shared<ZippedAssetPackage>(styleAsset);
+        std::lock_guard<std::mutex> lock(_StyleAssetPackageMutex);
+        if (!_StyleAssetPackage) {
+            auto styleAsset = std::make_shared<BinaryData>(cartostyles_v1_zip, cartostyles_v1_zip_len);
+            _StyleAssetPackage = std::make_shared<ZippedAssetPackage>(styleAsset);
+        }
+        return _StyleAssetPackage;
     }
 
     std::string CartoVectorTileLayer::GetStyleName(CartoBaseMapStyle::CartoBaseMapStyle style) {
@@ -101,4 +157,33 @@ namespace carto {
         }
     }
 
+    void CartoVectorTileLayer::AddLayerAsync(const std::shared_ptr<TileDataSource>& dataSource, const std::function<std::shared_ptr<VectorTileDecoder>()>& createTileDecoder, const std::shared_ptr<Layers>& layers) {
+        // Reserve the current top position, the layer stack is not kept alive by the loader thread
+        int index = layers->count();
+        std::weak_ptr<Layers> layersWeak(layers);
+
+        std::thread loaderThread([dataSource, createTileDecoder, layersWeak, index]() {
+            ThreadUtils::SetThreadPriority(ThreadPriority::LOW);
+            ThreadUtils::SetThreadQoSClass(ThreadQoSClass::UTILITY);
+
+            std::shared_ptr<CartoVectorTileLayer> layer;
+            try {
+                layer = std::shared_ptr<CartoVectorTileLayer>(new CartoVectorTileLayer(dataSource, createTileDecoder()));
+            }
+            catch (const std::exception& ex) {
+                Log::Errorf("CartoVectorTileLayer::AddLayerAsync: Failed to create layer: %s", ex.what());
+                return;
+            }
+
+            if (std::shared_ptr<Layers> layers = layersWeak.lock()) {
+                // Layers may have been removed meanwhile, keep the position within the stack
+                layers->insert(std::min(index, layers->count()), layer);
+            }
+        });
+        loaderThread.detach();
+    }
+
+    std::shared_ptr<AssetPackage> CartoVectorTileLayer::_StyleAssetPackage;
+    std::mutex CartoVectorTileLayer::_StyleAssetPackageMutex;
+
 }
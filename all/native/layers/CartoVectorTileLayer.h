@@ -9,11 +9,14 @@
 
 #include "layers/VectorTileLayer.h"
 
+#include <functional>
 #include <string>
 #include <memory>
+#include <mutex>
 
 namespace carto {
     class AssetPackage;
+    class Layers;
 
     namespace CartoBaseMapStyle {
         /**
@@ -105,11 +108,47 @@ namespace carto {
          */
         static std::shared_ptr<VectorTileDecoder> CreateTileDecoder(const std::shared_ptr<AssetPackage>& styleAssetPackage, const std::string& styleName);
 
+        /**
+         * Creates a new layer from the specified base map style in a background thread and adds it to the layer stack once the style is loaded.
+         * The layer is inserted at the current top position of the layer stack, so the layers added later stay on top of it.
+         * Until the layer is ready, the map background is shown in its place.
+         * @param dataSource The data source from which the layer loads data.
+         * @param style The style to use for the layer.
+         * @param layers The layer stack to add the layer to.
+         */
+        static void CreateAsync(const std::shared_ptr<TileDataSource>& dataSource, CartoBaseMapStyle::CartoBaseMapStyle style, const std::shared_ptr<Layers>& layers);
+        /**
+         * Creates a new layer from the specified style asset package in a background thread and adds it to the layer stack once the style is loaded.
+         * The layer is inserted at the current top position of the layer stack, so the layers added later stay on top of it.
+         * Until the layer is ready, the map background is shown in its place.
+         * @param dataSource The data source from which the layer loads data.
+         * @param styleAssetPackage The style asset package (usually a zipped file or an asset)
+         * @param styleName The name of the style to use. If empty, the default style of the package is used.
+         * @param layers The layer stack to add the layer to.
+         */
+        static void CreateAsync(const std::shared_ptr<TileDataSource>& dataSource, const std::shared_ptr<AssetPackage>& styleAssetPackage, const std::string& styleName, const std::shared_ptr<Layers>& layers);
+
+        /**
+         * Starts loading the specified base map style in a background thread, without creating a layer.
+         * The loaded style is kept in memory, so layers created later with the same style are created quicker.
+         * This can be called at application startup, so that the style is loaded in parallel with the map view creation.
+         * @param style The style to preload.
+         */
+        static void PreloadStyleAsync(CartoBaseMapStyle::CartoBaseMapStyle style);
+
         static std::shared_ptr<AssetPackage> CreateStyleAssetPackage();
 
         static std::string GetStyleName(CartoBaseMapStyle::CartoBaseMapStyle style);
     
         static std::string GetStyleSource(CartoBaseMapStyle::CartoBaseMapStyle style);
+
+    private:
+        CartoVectorTileLayer(const std::shared_ptr<TileDataSource>& dataSource, const std::shared_ptr<VectorTileDecoder>& tileDecoder);
+
+        static void AddLayerAsync(const std::shared_ptr<TileDataSource>& dataSource, const std::function<std::shared_ptr<VectorTileDecoder>()>& createTileDecoder, const std::shared_ptr<Layers>& layers);
+
+        static std::shared_ptr<AssetPackage> _StyleAssetPackage; // shared by all layers, so that the parsed styles can be reused
+        static std::mutex _StyleAssetPackageMutex;
     };
     
 }
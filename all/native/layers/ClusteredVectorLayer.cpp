@@ -1,6 +1,7 @@
 #include "layers/ClusteredVectorLayer.h"
 #include "core/MapPos.h"
 #include "components/Exceptions.h"
+#include "components/CancelableThreadPool.h"
 #include "geometry/Geometry.h"
 #include "geometry/PointGeometry.h"
 #include "datasources/VectorDataSource.h"
@@ -20,10 +21,12 @@
 
 #include <unordered_map>
 #include <vector>
-#include <list>
 #include <stack>
 #include <memory>
 #include <utility>
+#include <limits>
+#include <algorithm>
+#include <cmath>
 #include <numeric>
 
 #include <cglib/vec.h>
@@ -154,10 +157,16 @@ namespace carto {
     }
 
     ClusteredVectorLayer::ClusterFetchTask::ClusterFetchTask(const std::weak_ptr<ClusteredVectorLayer>& layer) :
-        FetchTask(layer)
+        FetchTask(layer),
+        _buildCanceled(std::make_shared<std::atomic<bool> >(false))
     {
     }
 
+    void ClusteredVectorLayer::ClusterFetchTask::cancel() {
+        FetchTask::cancel();
+        *_buildCanceled = true;
+    }
+
     bool ClusteredVectorLayer::ClusterFetchTask::loadElements(const std::shared_ptr<CullState>& cullState) {
         std::shared_ptr<ClusteredVectorLayer> layer = std::static_pointer_cast<ClusteredVectorLayer>(_layer.lock());
 
@@ -177,18 +186,35 @@ namespace carto {
             layer->_refreshRootCluster = false;
         }
         if (refresh) {
-            layer->rebuildClusters(vectorElements);
+            if (!layer->rebuildClusters(vectorElements, _buildCanceled)) {
+                // The build was aborted as a newer task is queued, let it redo the build
+                std::lock_guard<std::mutex> lock(layer->_clusterMutex);
+                layer->_refreshRootCluster = true;
+            }
         }
         return false;
     }
 
-    void ClusteredVectorLayer::rebuildClusters(const std::vector<std::shared_ptr<VectorElement> >& vectorElements) {
+    ClusteredVectorLayer::ClusterBuildTask::ClusterBuildTask(const std::weak_ptr<const ClusteredVectorLayer>& layer, const std::shared_ptr<ParallelBuildState>& state) :
+        CancelableTask(),
+        _layer(layer),
+        _state(state)
+    {
+    }
+
+    void ClusteredVectorLayer::ClusterBuildTask::run() {
+        if (std::shared_ptr<const ClusteredVectorLayer> layer = _layer.lock()) {
+            layer->processPartitions(*_state);
+        }
+    }
+
+    bool ClusteredVectorLayer::rebuildClusters(const std::vector<std::shared_ptr<VectorElement> >& vectorElements, const std::shared_ptr<std::atomic<bool> >& canceled) {
         std::shared_ptr<ProjectionSurface> projectionSurface;
         if (auto mapRenderer = _mapRenderer.lock()) {
             projectionSurface = mapRenderer->getProjectionSurface();
         }
         if (!projectionSurface) {
-            return;
+            return true;
         }
 
         auto clusters = std::make_shared<std::vector<Cluster> >();
@@ -226,13 +252,22 @@ namespace carto {
                         for (Cluster& cluster : *_clusters) {
                             cluster.clusterElement.reset();
                         }
-                        return;
+                        return true;
                     }
                 }
             }
 
-            // Rebuild clusters, by doing bottom-up merging into a single cluster
-            rootClusterIdx = mergeClusters(clusterIdxs.begin(), clusterIdxs.end(), *clusters, *projectionSurface, 1).front();
+            // Rebuild clusters, by doing bottom-up merging into a single cluster. Stale builds can be aborted if there are existing clusters to show
+            std::shared_ptr<std::atomic<bool> > buildCanceled = canceled;
+            {
+                std::lock_guard<std::mutex> lock(_clusterMutex);
+                if (!_clusters) {
+                    buildCanceled = std::make_shared<std::atomic<bool> >(false);
+                }
+            }
+            if (!buildClusterHierarchy(clusterIdxs, *clusters, projectionSurface, buildCanceled, rootClusterIdx)) {
+                return false;
+            }
         }
 
         // Synchronize cluster data
@@ -242,6 +277,7 @@ namespace carto {
         std::swap(singletonClusterCount, _singletonClusterCount);
         std::swap(rootClusterIdx, _rootClusterIdx);
         _renderClusterIdxs.clear();
+        return true;
     }
 
     int ClusteredVectorLayer::createSingletonCluster(const std::shared_ptr<VectorElement>& element, std::vector<Cluster>& clusters, const ProjectionSurface& projectionSurface) const {
@@ -293,154 +329,201 @@ namespace carto {
         return clusterIdx;
     }
 
-    std::vector<int> ClusteredVectorLayer::mergeClusters(std::vector<int>::iterator clustersBegin, std::vector<int>::iterator clustersEnd, std::vector<Cluster>& clusters, const ProjectionSurface& projectionSurface, std::size_t maxClusters) const {
-        struct ClusterInfo {
-            int clusterIdx;
-            double closestClusterDistance;
-            std::list<ClusterInfo>::iterator closestClusterInfoIt;
-        };
-        
-        std::size_t initialClusters = clustersEnd - clustersBegin;
-
-        // Find axis of bigger variance, use this axis for sorting
-        double meanFactor = 1.0 / initialClusters;
-        cglib::vec2<double> mean = std::accumulate(clustersBegin, clustersEnd, cglib::vec2<double>::zero(), [meanFactor, &clusters](const cglib::vec2<double>& result, int clusterIdx) {
+    bool ClusteredVectorLayer::buildClusterHierarchy(std::vector<int>& clusterIdxs, std::vector<Cluster>& clusters, const std::shared_ptr<ProjectionSurface>& projectionSurface, const std::shared_ptr<std::atomic<bool> >& canceled, int& rootClusterIdx) const {
+        // Calculate the extent of the clusters, this is the cell size of the coarsest grid level
+        double minX = std::numeric_limits<double>::infinity(), minY = minX;
+        double maxX = -std::numeric_limits<double>::infinity(), maxY = maxX;
+        for (int clusterIdx : clusterIdxs) {
             const MapPos& pos = clusters[clusterIdx].staticPos;
-            return result + cglib::vec2<double>(pos.getX(), pos.getY()) * meanFactor;
-        });
-        cglib::vec2<double> variance = std::accumulate(clustersBegin, clustersEnd, cglib::vec2<double>::zero(), [mean, &clusters](const cglib::vec2<double>& result, int clusterIdx) {
-            const MapPos& pos = clusters[clusterIdx].staticPos;
-            cglib::vec2<double> delta = cglib::vec2<double>(pos.getX(), pos.getY()) - mean;
-            return result + cglib::vec2<double>(delta(0) * delta(0), delta(1) * delta(1));
-        });
-
-        int axis = (variance(0) > variance(1) ? 0 : 1);
-        auto clusterComparator = [axis, &clusters](int clusterIdx1, int clusterIdx2) {
-            return clusters[clusterIdx1].staticPos[axis] < clusters[clusterIdx2].staticPos[axis];
-        };
-
-        // Use hierarchical clustering, if size above threshold
-        std::list<ClusterInfo> clusterInfos;
-        if (initialClusters > 2 * THRESHOLD) {
-            std::vector<int> childClusterIdxs1;
-            childClusterIdxs1.reserve(initialClusters);
-            std::vector<int> childClusterIdxs2;
-            childClusterIdxs2.reserve(initialClusters);
-            for (auto it = clustersBegin; it != clustersEnd; it++) {
-                const Cluster& cluster = clusters[*it];
-                if (cluster.staticPos[axis] < mean(axis)) {
-                    childClusterIdxs1.push_back(*it);
-                } else {
-                    childClusterIdxs2.push_back(*it);
+            minX = std::min(minX, pos.getX());
+            minY = std::min(minY, pos.getY());
+            maxX = std::max(maxX, pos.getX());
+            maxY = std::max(maxY, pos.getY());
+        }
+        GridExtent gridExtent;
+        gridExtent.minX = minX;
+        gridExtent.minY = minY;
+        gridExtent.size = std::max(maxX - minX, maxY - minY);
+        if (!(gridExtent.size > 0)) {
+            gridExtent.size = 1;
+        }
+
+        // Clusters in different cells of a coarse grid level are independent at all finer levels. For large element counts,
+        // build the finer levels of each such cell in parallel and continue with the remaining clusters
+        int maxLevel = GRID_LEVEL_COUNT;
+        std::shared_ptr<CancelableThreadPool> threadPool;
+        {
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            threadPool = _tileThreadPool;
+        }
+        if (threadPool && clusterIdxs.size() >= PARALLEL_BUILD_MIN_COUNT) {
+            auto state = std::make_shared<ParallelBuildState>();
+            state->gridExtent = gridExtent;
+            state->projectionSurface = projectionSurface;
+            state->canceled = canceled;
+
+            double cellSize = std::ldexp(gridExtent.size, -PARALLEL_PARTITION_LEVEL);
+            std::unordered_map<long long, std::size_t> cellIndexMap;
+            for (int clusterIdx : clusterIdxs) {
+                const MapPos& pos = clusters[clusterIdx].staticPos;
+                long long x = static_cast<long long>((pos.getX() - gridExtent.minX) / cellSize);
+                long long y = static_cast<long long>((pos.getY() - gridExtent.minY) / cellSize);
+                auto it = cellIndexMap.emplace((x << 32) | y, state->partitions.size()).first;
+                if (it->second == state->partitions.size()) {
+                    state->partitions.emplace_back();
                 }
+                PartitionBuild& partition = state->partitions[it->second];
+                partition.clusterIdxs.push_back(clusterIdx);
+                partition.clusters.push_back(clusters[clusterIdx]);
             }
-            if (!childClusterIdxs1.empty() && !childClusterIdxs2.empty()) {
-                childClusterIdxs1 = mergeClusters(childClusterIdxs1.begin(), childClusterIdxs1.end(), clusters, projectionSurface, THRESHOLD);
-                childClusterIdxs2 = mergeClusters(childClusterIdxs2.begin(), childClusterIdxs2.end(), clusters, projectionSurface, THRESHOLD);
-                std::sort(childClusterIdxs1.begin(), childClusterIdxs1.end(), clusterComparator);
-                std::sort(childClusterIdxs2.begin(), childClusterIdxs2.end(), clusterComparator);
-                for (int clusterIdx : childClusterIdxs1) {
-                    ClusterInfo clusterInfo;
-                    clusterInfo.clusterIdx = clusterIdx;
-                    clusterInfos.push_back(clusterInfo);
-                }
-                for (int clusterIdx : childClusterIdxs2) {
-                    ClusterInfo clusterInfo;
-                    clusterInfo.clusterIdx = clusterIdx;
-                    clusterInfos.push_back(clusterInfo);
-                }
+
+            // Use the calling thread and the thread pool. The calling thread never waits for partitions that are not started
+            std::size_t taskCount = std::min(state->partitions.size() - 1, static_cast<std::size_t>(std::max(0, threadPool->getPoolSize())));
+            for (std::size_t i = 0; i < taskCount; i++) {
+                threadPool->execute(std::make_shared<ClusterBuildTask>(std::static_pointer_cast<const ClusteredVectorLayer>(shared_from_this()), state), getUpdatePriority());
             }
-        }
-        
-        // If hierarchical clustering was not needed/did not succeed, use normal sorting/create full clustering
-        if (clusterInfos.empty()) {
-            std::sort(clustersBegin, clustersEnd, clusterComparator);
-            for (auto it = clustersBegin; it != clustersEnd; it++) {
-                ClusterInfo clusterInfo;
-                clusterInfo.clusterIdx = *it;
-                clusterInfos.push_back(clusterInfo);
-            }
-        }
-
-        // Find closest clusters. n*sqrt(n) steps avg, n^2 worst
-        for (auto it = clusterInfos.begin(); it != clusterInfos.end(); it++) {
-            it->closestClusterDistance = std::numeric_limits<double>::infinity();
-            it->closestClusterInfoIt = clusterInfos.end();
-            for (auto testIt = it; ++testIt != clusterInfos.end(); ) {
-                if (clusters[testIt->clusterIdx].staticPos[axis] - clusters[it->clusterIdx].staticPos[axis] >= it->closestClusterDistance) {
-                    break;
+            if (!buildPartitionsParallel(state)) {
+                return false;
+            }
+
+            // Append merged clusters of all partitions, remapping local cluster indices
+            clusterIdxs.clear();
+            for (PartitionBuild& partition : state->partitions) {
+                std::size_t partitionSize = partition.clusterIdxs.size();
+                int offset = static_cast<int>(clusters.size()) - static_cast<int>(partitionSize);
+                auto remapIdx = [&partition, partitionSize, offset](int localIdx) {
+                    if (localIdx < 0) {
+                        return localIdx;
+                    }
+                    return static_cast<std::size_t>(localIdx) < partitionSize ? partition.clusterIdxs[localIdx] : localIdx + offset;
+                };
+                for (std::size_t i = 0; i < partition.clusters.size(); i++) {
+                    Cluster& cluster = partition.clusters[i];
+                    if (i < partitionSize) {
+                        clusters[partition.clusterIdxs[i]].parentClusterIdx = remapIdx(cluster.parentClusterIdx);
+                        continue;
+                    }
+                    cluster.parentClusterIdx = remapIdx(cluster.parentClusterIdx);
+                    cluster.childClusterIdx[0] = remapIdx(cluster.childClusterIdx[0]);
+                    cluster.childClusterIdx[1] = remapIdx(cluster.childClusterIdx[1]);
+                    clusters.push_back(std::move(cluster));
                 }
-                double distanceSqr = MapVec(clusters[testIt->clusterIdx].staticPos - clusters[it->clusterIdx].staticPos).lengthSqr();
-                if (distanceSqr < it->closestClusterDistance * it->closestClusterDistance) {
-                    it->closestClusterDistance = std::sqrt(distanceSqr);
-                    it->closestClusterInfoIt = testIt;
+                for (int localIdx : partition.rootClusterIdxs) {
+                    clusterIdxs.push_back(remapIdx(localIdx));
                 }
             }
+            maxLevel = PARALLEL_PARTITION_LEVEL;
         }
 
-        // Merge clusters one-by-one (n steps)
-        while (clusterInfos.size() > maxClusters) {
-            // Find closest pair. n steps
-            std::list<ClusterInfo>::iterator it1 = clusterInfos.begin();
-            for (auto it = clusterInfos.begin(); ++it != clusterInfos.end(); ) {
-                if (it->closestClusterDistance < it1->closestClusterDistance) {
-                    it1 = it;
-                }
+        if (!mergeGridLevels(clusterIdxs, clusters, *projectionSurface, gridExtent, maxLevel, 0, *canceled)) {
+            return false;
+        }
+        rootClusterIdx = mergeCellClusters(clusterIdxs, clusters, *projectionSurface);
+        return true;
+    }
+
+    bool ClusteredVectorLayer::buildPartitionsParallel(const std::shared_ptr<ParallelBuildState>& state) const {
+        processPartitions(*state);
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->condition.wait(lock, [&state]() { return state->completedPartitions >= state->partitions.size(); });
+        return !*state->canceled;
+    }
+
+    void ClusteredVectorLayer::processPartitions(ParallelBuildState& state) const {
+        while (true) {
+            std::size_t index = state.nextPartition++;
+            if (index >= state.partitions.size()) {
+                break;
             }
-            std::list<ClusterInfo>::iterator it2 = it1->closestClusterInfoIt;
 
-            // Merge cluster pair
-            ClusterInfo mergedClusterInfo;
-            mergedClusterInfo.clusterIdx = createMergedCluster(it1->clusterIdx, it2->clusterIdx, clusters, projectionSurface);
-            mergedClusterInfo.closestClusterDistance = std::numeric_limits<double>::infinity();
-            mergedClusterInfo.closestClusterInfoIt = it2; // to force recalculation
+            PartitionBuild& partition = state.partitions[index];
+            partition.clusters.reserve(partition.clusters.size() * 2);
+            partition.rootClusterIdxs.resize(partition.clusters.size());
+            std::iota(partition.rootClusterIdxs.begin(), partition.rootClusterIdxs.end(), 0);
+            mergeGridLevels(partition.rootClusterIdxs, partition.clusters, *state.projectionSurface, state.gridExtent, GRID_LEVEL_COUNT, PARALLEL_PARTITION_LEVEL + 1, *state.canceled);
 
-            // Insert cluster to sorted cluster info list. 1 steps avg, n steps worst
-            std::list<ClusterInfo>::iterator lastIt = clusterInfos.erase(it2);
-            std::list<ClusterInfo>::iterator firstIt = clusterInfos.erase(it1);
-            std::list<ClusterInfo>::iterator mergeIt;
-            for (mergeIt = firstIt; mergeIt != lastIt; mergeIt++) {
-                if (clusters[mergedClusterInfo.clusterIdx].staticPos[axis] > clusters[mergeIt->clusterIdx].staticPos[axis]) {
-                    break;
-                }
+            std::lock_guard<std::mutex> lock(state.mutex);
+            if (++state.completedPartitions >= state.partitions.size()) {
+                state.condition.notify_all();
+            }
+        }
+    }
+
+    bool ClusteredVectorLayer::mergeGridLevels(std::vector<int>& clusterIdxs, std::vector<Cluster>& clusters, const ProjectionSurface& projectionSurface, const GridExtent& gridExtent, int maxLevel, int minLevel, const std::atomic<bool>& canceled) const {
+        // Merge clusters level by level, starting from the finest grid. Clusters sharing a grid cell are merged into a single cluster.
+        // Each level takes linear time, so the whole hierarchy is built in O(n log n) time
+        std::unordered_map<long long, std::size_t> cellIndexMap;
+        std::vector<std::vector<int> > cellClusterIdxs;
+        for (int level = maxLevel; level >= minLevel && clusterIdxs.size() > 1; level--) {
+            if (canceled) {
+                return false;
             }
-            mergeIt = clusterInfos.insert(mergeIt, mergedClusterInfo);
 
-            // For all clusters, if closest cluster is one of the merged clusters, recalculate closest cluster. n/2 steps avg
-            for (auto it = clusterInfos.begin(); it != lastIt; it++) {
-                if (it->closestClusterInfoIt == it1 || it->closestClusterInfoIt == it2) {
-                    it->closestClusterDistance = std::numeric_limits<double>::infinity();
-                    it->closestClusterInfoIt = clusterInfos.end();
-                    for (auto testIt = it; ++testIt != clusterInfos.end(); ) {
-                        if (clusters[testIt->clusterIdx].staticPos[axis] - clusters[it->clusterIdx].staticPos[axis] >= it->closestClusterDistance) {
-                            break;
-                        }
-                        double distanceSqr = MapVec(clusters[testIt->clusterIdx].staticPos - clusters[it->clusterIdx].staticPos).lengthSqr();
-                        if (distanceSqr < it->closestClusterDistance * it->closestClusterDistance) {
-                            it->closestClusterDistance = std::sqrt(distanceSqr);
-                            it->closestClusterInfoIt = testIt;
-                        }
+            double cellSize = std::ldexp(gridExtent.size, -level);
+            cellIndexMap.clear();
+            std::size_t cellCount = 0;
+            for (int clusterIdx : clusterIdxs) {
+                const MapPos& pos = clusters[clusterIdx].staticPos;
+                long long x = static_cast<long long>((pos.getX() - gridExtent.minX) / cellSize);
+                long long y = static_cast<long long>((pos.getY() - gridExtent.minY) / cellSize);
+                auto it = cellIndexMap.emplace((x << 32) | y, cellCount).first;
+                if (it->second == cellCount) {
+                    if (cellClusterIdxs.size() <= cellCount) {
+                        cellClusterIdxs.emplace_back();
                     }
+                    cellClusterIdxs[cellCount++].clear();
                 }
+                cellClusterIdxs[it->second].push_back(clusterIdx);
+            }
+            if (cellCount == clusterIdxs.size()) {
+                continue;
             }
 
-            // Update clusters, check if merged cluster is closer than previously closest cluster. n/2 steps avg
-            for (auto it = clusterInfos.begin(); it != mergeIt; it++) {
-                double distanceSqr = MapVec(clusters[mergeIt->clusterIdx].staticPos - clusters[it->clusterIdx].staticPos).lengthSqr();
-                if (distanceSqr < it->closestClusterDistance * it->closestClusterDistance) {
-                    it->closestClusterDistance = std::sqrt(distanceSqr);
-                    it->closestClusterInfoIt = mergeIt;
-                }
+            clusterIdxs.clear();
+            for (std::size_t i = 0; i < cellCount; i++) {
+                clusterIdxs.push_back(mergeCellClusters(cellClusterIdxs[i], clusters, projectionSurface));
             }
         }
+        return true;
+    }
 
-        // Return the remaining clusters
-        std::vector<int> clusterIdxs;
-        clusterIdxs.reserve(maxClusters);
-        for (const ClusterInfo& clusterInfo : clusterInfos) {
-            clusterIdxs.push_back(clusterInfo.clusterIdx);
+    int ClusteredVectorLayer::mergeCellClusters(std::vector<int>& clusterIdxs, std::vector<Cluster>& clusters, const ProjectionSurface& projectionSurface) const {
+        while (clusterIdxs.size() > MAX_PAIRWISE_MERGE_COUNT) {
+            // Too many clusters for pairwise merging (usually many elements at the same location). Sort and merge neighbours
+            std::sort(clusterIdxs.begin(), clusterIdxs.end(), [&clusters](int clusterIdx1, int clusterIdx2) {
+                const MapPos& pos1 = clusters[clusterIdx1].staticPos;
+                const MapPos& pos2 = clusters[clusterIdx2].staticPos;
+                return pos1.getX() < pos2.getX() || (pos1.getX() == pos2.getX() && pos1.getY() < pos2.getY());
+            });
+            std::size_t count = 0;
+            for (std::size_t i = 0; i + 1 < clusterIdxs.size(); i += 2) {
+                clusterIdxs[count++] = createMergedCluster(clusterIdxs[i], clusterIdxs[i + 1], clusters, projectionSurface);
+            }
+            if (clusterIdxs.size() % 2 != 0) {
+                clusterIdxs[count++] = clusterIdxs.back();
+            }
+            clusterIdxs.resize(count);
+        }
+
+        // Merge the closest pair of clusters until a single cluster remains
+        while (clusterIdxs.size() > 1) {
+            std::size_t bestIndex1 = 0, bestIndex2 = 1;
+            double bestDistanceSqr = std::numeric_limits<double>::infinity();
+            for (std::size_t i = 0; i < clusterIdxs.size(); i++) {
+                for (std::size_t j = i + 1; j < clusterIdxs.size(); j++) {
+                    double distanceSqr = MapVec(clusters[clusterIdxs[j]].staticPos - clusters[clusterIdxs[i]].staticPos).lengthSqr();
+                    if (distanceSqr < bestDistanceSqr) {
+                        bestDistanceSqr = distanceSqr;
+                        bestIndex1 = i;
+                        bestIndex2 = j;
+                    }
+                }
+            }
+            clusterIdxs[bestIndex1] = createMergedCluster(clusterIdxs[bestIndex1], clusterIdxs[bestIndex2], clusters, projectionSurface);
+            clusterIdxs.erase(clusterIdxs.begin() + bestIndex2);
         }
-        return clusterIdxs;
+        return clusterIdxs.empty() ? -1 : clusterIdxs.front();
     }
 
     bool ClusteredVectorLayer::renderClusters(const ViewState& viewState, float deltaSeconds) {
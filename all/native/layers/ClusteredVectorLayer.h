@@ -13,6 +13,8 @@
 #include "layers/VectorLayer.h"
 #include "layers/ClusterElementBuilder.h"
 
+#include <atomic>
+#include <condition_variable>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -30,7 +32,7 @@ namespace carto {
 
     /**
      * A vector layer that supports clustering point-type features.
-     * A Pairwise centroid hierarchical clustering algorithm is used internally.
+     * A hierarchical grid clustering algorithm is used internally, clusters are merged bottom-up in grids of increasing cell size.
      */
     class ClusteredVectorLayer : public VectorLayer {
     public:
@@ -118,15 +120,58 @@ namespace carto {
             std::unordered_map<int, std::vector<int> > visibleChildIdxMap;
         };
 
+        struct GridExtent {
+            double minX;
+            double minY;
+            double size;
+        };
+
+        struct PartitionBuild {
+            std::vector<int> clusterIdxs; // original indices of the partition clusters, in local order
+            std::vector<Cluster> clusters; // local copies of the partition clusters, followed by merged clusters
+            std::vector<int> rootClusterIdxs; // local indices of the remaining clusters
+        };
+
+        struct ParallelBuildState {
+            std::vector<PartitionBuild> partitions;
+            GridExtent gridExtent;
+            std::shared_ptr<ProjectionSurface> projectionSurface;
+            std::shared_ptr<std::atomic<bool> > canceled;
+            std::atomic<std::size_t> nextPartition;
+            std::size_t completedPartitions;
+            std::mutex mutex;
+            std::condition_variable condition;
+
+            ParallelBuildState() : partitions(), gridExtent(), projectionSurface(), canceled(), nextPartition(0), completedPartitions(0), mutex(), condition() { }
+        };
+
         class ClusterFetchTask : public VectorLayer::FetchTask {
         public:
             ClusterFetchTask(const std::weak_ptr<ClusteredVectorLayer>& layer);
 
+            virtual void cancel();
+
         protected:
             virtual bool loadElements(const std::shared_ptr<CullState>& cullState);
+
+            std::shared_ptr<std::atomic<bool> > _buildCanceled;
+        };
+
+        class ClusterBuildTask : public CancelableTask {
+        public:
+            ClusterBuildTask(const std::weak_ptr<const ClusteredVectorLayer>& layer, const std::shared_ptr<ParallelBuildState>& state);
+
+            virtual void run();
+
+        private:
+            std::weak_ptr<const ClusteredVectorLayer> _layer;
+            std::shared_ptr<ParallelBuildState> _state;
         };
 
-        static const std::size_t THRESHOLD = 100;
+        static const int GRID_LEVEL_COUNT = 30;
+        static const int PARALLEL_PARTITION_LEVEL = 3;
+        static const std::size_t PARALLEL_BUILD_MIN_COUNT = 10000;
+        static const std::size_t MAX_PAIRWISE_MERGE_COUNT = 8;
 
         const DirectorPtr<ClusterElementBuilder> _clusterElementBuilder;
         ClusterBuilderMode::ClusterBuilderMode _clusterBuilderMode;
@@ -149,10 +194,14 @@ namespace carto {
 
         virtual std::shared_ptr<CancelableTask> createFetchTask(const std::shared_ptr<CullState>& cullState);
 
-        void rebuildClusters(const std::vector<std::shared_ptr<VectorElement> >& vectorElements);
+        bool rebuildClusters(const std::vector<std::shared_ptr<VectorElement> >& vectorElements, const std::shared_ptr<std::atomic<bool> >& canceled);
         int createSingletonCluster(const std::shared_ptr<VectorElement>& element, std::vector<Cluster>& clusters, const ProjectionSurface& projectionSurface) const;
         int createMergedCluster(int clusterIdx1, int clusterIdx2, std::vector<Cluster>& clusters, const ProjectionSurface& projectionSurface) const;
-        std::vector<int> mergeClusters(std::vector<int>::iterator clustersBegin, std::vector<int>::iterator clustersEnd, std::vector<Cluster>& clusters, const ProjectionSurface& projectionSurface, std::size_t maxClusters) const;
+        bool buildClusterHierarchy(std::vector<int>& clusterIdxs, std::vector<Cluster>& clusters, const std::shared_ptr<ProjectionSurface>& projectionSurface, const std::shared_ptr<std::atomic<bool> >& canceled, int& rootClusterIdx) const;
+        bool buildPartitionsParallel(const std::shared_ptr<ParallelBuildState>& state) const;
+        void processPartitions(ParallelBuildState& state) const;
+        bool mergeGridLevels(std::vector<int>& clusterIdxs, std::vector<Cluster>& clusters, const ProjectionSurface& projectionSurface, const GridExtent& gridExtent, int maxLevel, int minLevel, const std::atomic<bool>& canceled) const;
+        int mergeCellClusters(std::vector<int>& clusterIdxs, std::vector<Cluster>& clusters, const ProjectionSurface& projectionSurface) const;
 
         bool renderClusters(const ViewState& viewState, float deltaSeconds);
         bool renderCluster(int clusterIdx, const ViewState& viewState, RenderState& renderState, float deltaSeconds);
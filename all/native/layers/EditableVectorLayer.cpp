@@ -51,6 +51,7 @@ namespace carto {
         _overlayStyleVirtual(),
         _overlayStyleSelected(),
         _overlayPoints(),
+        _overlayProjectionSurface(),
         _overlayDragPoint(),
         _overlayDragGeometry(),
         _overlayDragGeometryPos(),
@@ -123,11 +124,12 @@ namespace carto {
 
     void EditableVectorLayer::setComponents(const std::shared_ptr<CancelableThreadPool>& envelopeThreadPool,
         const std::shared_ptr<CancelableThreadPool>& tileThreadPool,
+        const std::shared_ptr<CancelableThreadPool>& tileDecodeThreadPool,
         const std::weak_ptr<Options>& options,
         const std::weak_ptr<MapRenderer>& mapRenderer,
         const std::weak_ptr<TouchHandler>& touchHandler)
     {
-        VectorLayer::setComponents(envelopeThreadPool, tileThreadPool, options, mapRenderer, touchHandler);
+        VectorLayer::setComponents(envelopeThreadPool, tileThreadPool, tileDecodeThreadPool, options, mapRenderer, touchHandler);
 
         if (touchHandler.lock()) {
             registerTouchHandlerListener();
@@ -740,6 +742,18 @@ namespace carto {
     void EditableVectorLayer::syncElementOverlayPoints(const std::shared_ptr<VectorElement>& element) {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
 
+        // Overlay points keep their draw datas between the updates, unless the projection surface changes
+        std::shared_ptr<ProjectionSurface> projectionSurface;
+        if (auto mapRenderer = _mapRenderer.lock()) {
+            projectionSurface = mapRenderer->getProjectionSurface();
+        }
+        if (projectionSurface != _overlayProjectionSurface) {
+            for (const std::shared_ptr<Point>& overlayPoint : _overlayPoints) {
+                overlayPoint->setDrawData(std::shared_ptr<PointDrawData>());
+            }
+            _overlayProjectionSurface = projectionSurface;
+        }
+
         std::vector<std::shared_ptr<Point> > overlayPoints;
         if (element && element->isVisible()) {
             int index = 0;
@@ -804,8 +818,13 @@ namespace carto {
         std::shared_ptr<Point> overlayPoint;
         if (index >= 0 && index < static_cast<int>(_overlayPoints.size())) {
             overlayPoint = _overlayPoints[index];
+            std::shared_ptr<PointStyle> style = (overlayPoint == _overlayDragPoint ? _overlayStyleSelected : (virtualPoint ? _overlayStyleVirtual : _overlayStyleNormal));
+            // While dragging, only the points around the edited vertex change, keep the draw datas of the other points
+            if (overlayPoint->getDrawData() && overlayPoint->getStyle() == style && overlayPoint->getPos() == mapPos) {
+                return overlayPoint;
+            }
             overlayPoint->setPos(mapPos);
-            overlayPoint->setStyle(overlayPoint == _overlayDragPoint ? _overlayStyleSelected : (virtualPoint ? _overlayStyleVirtual : _overlayStyleNormal));
+            overlayPoint->setStyle(style);
         } else {
             overlayPoint = std::make_shared<Point>(mapPos, virtualPoint ? _overlayStyleVirtual : _overlayStyleNormal);
         }
@@ -22,6 +22,7 @@ namespace carto {
     class Geometry;
     class VectorElement;
     class PointStyle;
+    class ProjectionSurface;
     class VectorEditEventListener;
 
     /**
@@ -62,6 +63,7 @@ namespace carto {
     protected:
         virtual void setComponents(const std::shared_ptr<CancelableThreadPool>& envelopeThreadPool,
             const std::shared_ptr<CancelableThreadPool>& tileThreadPool,
+            const std::shared_ptr<CancelableThreadPool>& tileDecodeThreadPool,
             const std::weak_ptr<Options>& options,
             const std::weak_ptr<MapRenderer>& mapRenderer,
             const std::weak_ptr<TouchHandler>& touchHandler);
@@ -136,6 +138,7 @@ namespace carto {
         std::shared_ptr<PointStyle> _overlayStyleVirtual;
         std::shared_ptr<PointStyle> _overlayStyleSelected;
         std::vector<std::shared_ptr<Point> > _overlayPoints;
+        std::shared_ptr<ProjectionSurface> _overlayProjectionSurface;
         std::shared_ptr<Point> _overlayDragPoint;
         std::shared_ptr<Geometry> _overlayDragGeometry;
         MapPos _overlayDragGeometryPos;
@@ -38,6 +38,7 @@ namespace carto {
     
     void Layer::setOpacity(float opacity) {
         _opacity = std::max(0.0f, std::min(1.0f, opacity));
+        _redrawStamp++;
         refresh();
     }
     
@@ -47,6 +48,7 @@ namespace carto {
     
     void Layer::setVisible(bool visible) {
         _visible = visible;
+        _redrawStamp++;
         refresh();
     }
     
@@ -60,6 +62,7 @@ namespace carto {
             std::lock_guard<std::recursive_mutex> lock(_mutex);
             _visibleZoomRange = range;
         }
+        _redrawStamp++;
         refresh();
     }
         
@@ -117,6 +120,7 @@ namespace carto {
     Layer::Layer() :
         _envelopeThreadPool(),
         _tileThreadPool(),
+        _tileDecodeThreadPool(),
         _options(),
         _mapRenderer(),
         _lastCullState(),
@@ -126,12 +130,14 @@ namespace carto {
         _visible(true),
         _visibleZoomRange(0, std::numeric_limits<float>::infinity()),
         _mutex(),
-        _surfaceCreated(false)
+        _surfaceCreated(false),
+        _redrawStamp(0)
     {
     }
     
     void Layer::setComponents(const std::shared_ptr<CancelableThreadPool>& envelopeThreadPool,
                               const std::shared_ptr<CancelableThreadPool>& tileThreadPool,
+                              const std::shared_ptr<CancelableThreadPool>& tileDecodeThreadPool,
                               const std::weak_ptr<Options>& options,
                               const std::weak_ptr<MapRenderer>& mapRenderer,
                               const std::weak_ptr<TouchHandler>& touchHandler)
@@ -147,6 +153,7 @@ namespace carto {
         // access to these threadpools is thread safe
         _envelopeThreadPool = envelopeThreadPool;
         _tileThreadPool = tileThreadPool;
+        _tileDecodeThreadPool = tileDecodeThreadPool;
         _mapRenderer = mapRenderer;
         _touchHandler = touchHandler;
         _options = options;
@@ -166,6 +173,8 @@ namespace carto {
     }
 
     void Layer::redraw() const {
+        _redrawStamp++;
+
         std::shared_ptr<MapRenderer> mapRenderer;
         {
             std::lock_guard<std::recursive_mutex> lock(_mutex);
@@ -176,6 +185,10 @@ namespace carto {
             mapRenderer->requestRedraw();
         }
     }
+
+    unsigned int Layer::getRedrawStamp() const {
+        return _redrawStamp;
+    }
     
     bool Layer::isSurfaceCreated() const {
         return _surfaceCreated;
@@ -201,4 +214,7 @@ namespace carto {
         return std::shared_ptr<Bitmap>();
     }
 
+    void Layer::releaseMemory(MemoryPressureLevel::MemoryPressureLevel level) {
+    }
+
 }
@@ -9,6 +9,7 @@
 
 #include "core/ScreenPos.h"
 #include "core/MapRange.h"
+#include "components/MemoryPressureLevel.h"
 #include "renderers/components/StyleTextureCache.h"
 #include "renderers/components/CullState.h"
 #include "ui/ClickType.h"
@@ -133,11 +134,13 @@ namespace carto {
         friend class MapRenderer;
         friend class BackgroundRenderer;
         friend class TouchHandler;
+        friend class BaseMapView;
     
         Layer();
         
         virtual void setComponents(const std::shared_ptr<CancelableThreadPool>& envelopeThreadPool,
                                    const std::shared_ptr<CancelableThreadPool>& tileThreadPool,
+                                   const std::shared_ptr<CancelableThreadPool>& tileDecodeThreadPool,
                                    const std::weak_ptr<Options>& options,
                                    const std::weak_ptr<MapRenderer>& mapRenderer,
                                    const std::weak_ptr<TouchHandler>& touchHandler);
@@ -145,6 +148,8 @@ namespace carto {
         std::shared_ptr<CullState> getLastCullState() const;
 
         void redraw() const;
+
+        unsigned int getRedrawStamp() const;
     
         virtual void loadData(const std::shared_ptr<CullState>& cullState) = 0;
         
@@ -158,6 +163,8 @@ namespace carto {
         
         virtual std::shared_ptr<Bitmap> getBackgroundBitmap() const;
         virtual std::shared_ptr<Bitmap> getSkyBitmap() const;
+
+        virtual void releaseMemory(MemoryPressureLevel::MemoryPressureLevel level);
         
         virtual void calculateRayIntersectedElements(const cglib::ray3<double>& ray, const ViewState& viewState, std::vector<RayIntersectedElement>& results) const = 0;
         virtual bool processClick(ClickType::ClickType clickType, const RayIntersectedElement& intersectedElement, const ViewState& viewState) const = 0;
@@ -167,6 +174,7 @@ namespace carto {
     
         std::shared_ptr<CancelableThreadPool> _envelopeThreadPool;
         std::shared_ptr<CancelableThreadPool> _tileThreadPool;
+        std::shared_ptr<CancelableThreadPool> _tileDecodeThreadPool;
         std::weak_ptr<Options> _options;
         std::weak_ptr<MapRenderer> _mapRenderer;
         std::weak_ptr<TouchHandler> _touchHandler;
@@ -189,6 +197,8 @@ namespace carto {
         static const int DEFAULT_CULL_DELAY = 400;
 
         bool _surfaceCreated;
+
+        mutable std::atomic<unsigned int> _redrawStamp; // incremented each time the rendered content of the layer may have changed
     };
     
 }
@@ -13,6 +13,8 @@
 #include "ui/NMLModelLODTreeClickInfo.h"
 #include "utils/Log.h"
 
+#include <cmath>
+
 #include <nml/GLModel.h>
 #include <nml/GLMesh.h>
 #include <nml/GLTexture.h>
@@ -46,6 +48,32 @@ namespace {
         cglib::vec3<double> projSize = projBounds.size();
         return (float) std::max(projSize(0), projSize(1));
     }
+
+    long long calculateTextureKey(long long textureId, int level) {
+        return (textureId << 4) | (level & 15);
+    }
+
+    int calculateLoadingPriority(const carto::nml::Bounds3& bounds, const cglib::mat4x4<double>& frustumMVP, int priorityRange) {
+        static const double NEAR_DISTANCE = 0.5;
+
+        // Nodes with larger projected size (larger screen space error until refined) and nodes closer to the view center are loaded first
+        float screenSize = calculateProjectedScreenSize(bounds, frustumMVP);
+        cglib::vec4<double> center((bounds.min().x() + bounds.max().x()) * 0.5, (bounds.min().y() + bounds.max().y()) * 0.5, (bounds.min().z() + bounds.max().z()) * 0.5, 1);
+        cglib::vec4<double> projCenter = cglib::transform(center, frustumMVP);
+        projCenter(3) = std::max(projCenter(3), NEAR_DISTANCE);
+        double centerDist = cglib::length(cglib::vec2<double>(projCenter(0) / projCenter(3), projCenter(1) / projCenter(3)));
+        float weight = std::max(screenSize / static_cast<float>(1 + centerDist), 1.0e-6f);
+        int priority = priorityRange / 2 + static_cast<int>(std::floor(std::log2(weight) * 2));
+        return std::max(0, std::min(priorityRange, priority));
+    }
+
+    int calculateLoadingPriority(const cglib::vec3<double>& pos, const carto::ViewState& viewState, int priorityRange) {
+        // Trees closer to the camera are loaded first, relative to the distance of the focus point
+        double focusDist = std::max(cglib::length(viewState.getFocusPos() - viewState.getCameraPos()), 1.0e-6);
+        double dist = std::max(cglib::length(pos - viewState.getCameraPos()), 1.0e-6);
+        int priority = priorityRange / 2 - static_cast<int>(std::floor(std::log2(dist / focusDist) * 2));
+        return std::max(0, std::min(priorityRange, priority));
+    }
     
 }
     
@@ -77,7 +105,7 @@ namespace carto {
             throw NullArgumentException("Null dataSource");
         }
 
-        _fetchThreadPool->setPoolSize(1);
+        _fetchThreadPool->setPoolSize(FETCH_THREAD_COUNT);
     }
     
     NMLModelLODTreeLayer::~NMLModelLODTreeLayer() {
@@ -205,11 +233,12 @@ namespace carto {
 
     void NMLModelLODTreeLayer::setComponents(const std::shared_ptr<CancelableThreadPool>& envelopeThreadPool,
                                     const std::shared_ptr<CancelableThreadPool>& tileThreadPool,
+                                    const std::shared_ptr<CancelableThreadPool>& tileDecodeThreadPool,
                                     const std::weak_ptr<Options>& options,
                                     const std::weak_ptr<MapRenderer>& mapRenderer,
                                     const std::weak_ptr<TouchHandler>& touchHandler)
     {
-        Layer::setComponents(envelopeThreadPool, tileThreadPool, options, mapRenderer, touchHandler);
+        Layer::setComponents(envelopeThreadPool, tileThreadPool, tileDecodeThreadPool, options, mapRenderer, touchHandler);
     }
     
     void NMLModelLODTreeLayer::loadData(const std::shared_ptr<CullState>& cullState) {
@@ -234,11 +263,22 @@ namespace carto {
         }
     }
     
+    void NMLModelLODTreeLayer::releaseMemory(MemoryPressureLevel::MemoryPressureLevel level) {
+        if (level >= MemoryPressureLevel::MEMORY_PRESSURE_LEVEL_HIGH) {
+            // Meshes and textures that are currently drawn are kept alive by the renderer
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            _meshCache.clear();
+            _textureCache.clear();
+        }
+    }
+    
     bool NMLModelLODTreeLayer::isDataAvailable(const NMLModelLODTree* modelLODTree, int nodeId) {
-        return loadMeshes(modelLODTree, nodeId, true) && loadTextures(modelLODTree, nodeId, true);
+        // Textures are not required, the node is drawn with its embedded textures (or other levels of the textures) until the textures are streamed in
+        return loadMeshes(modelLODTree, nodeId, 0, true);
     }    
     
-    bool NMLModelLODTreeLayer::loadModelLODTrees(const MapTileList& mapTileList, bool checkOnly) {
+    bool NMLModelLODTreeLayer::loadModelLODTrees(const MapTileList& mapTileList, const ViewState& viewState, bool checkOnly) {
+        std::shared_ptr<ProjectionSurface> projectionSurface = viewState.getProjectionSurface();
         for (auto it = mapTileList.begin(); it != mapTileList.end(); it++) {
             const NMLModelLODTreeDataSource::MapTile& mapTile = *it;
     
@@ -251,9 +291,15 @@ namespace carto {
                     if (checkOnly) {
                         return false;
                     }
-                    if (!_fetchingModelLODTrees.exists(mapTile.modelLODTreeId)) {
+                    int priority = getUpdatePriority() + MODELLODTREE_LOADING_PRIORITY_OFFSET;
+                    if (projectionSurface) {
+                        cglib::vec3<double> pos = projectionSurface->calculatePosition(_dataSource->getProjection()->toInternal(mapTile.mapPos));
+                        priority += calculateLoadingPriority(pos, viewState, LOADING_PRIORITY_RANGE);
+                    }
+                    if (!_fetchingModelLODTrees.request(mapTile.modelLODTreeId, priority)) {
                         auto task = std::make_shared<ModelLODTreeFetchTask>(std::static_pointer_cast<NMLModelLODTreeLayer>(shared_from_this()), mapTile);
-                        _fetchThreadPool->execute(task, getUpdatePriority() + MODELLODTREE_LOADING_PRIORITY_OFFSET);
+                        _fetchingModelLODTrees.add(mapTile.modelLODTreeId, task, priority);
+                        _fetchThreadPool->execute(task, priority);
                     }
                 }
             }
@@ -261,7 +307,7 @@ namespace carto {
         return true;
     }
     
-    bool NMLModelLODTreeLayer::loadMeshes(const NMLModelLODTree* modelLODTree, int nodeId, bool checkOnly) {
+    bool NMLModelLODTreeLayer::loadMeshes(const NMLModelLODTree* modelLODTree, int nodeId, int priority, bool checkOnly) {
         auto mapIt = modelLODTree->getMeshBindingsMap().find(nodeId);
         if (mapIt == modelLODTree->getMeshBindingsMap().end()) {
             return false;
@@ -279,9 +325,11 @@ namespace carto {
                     if (checkOnly) {
                         return false;
                     }
-                    if (!_fetchingMeshes.exists(binding.meshId)) {
+                    int taskPriority = getUpdatePriority() + MESH_LOADING_PRIORITY_OFFSET + priority;
+                    if (!_fetchingMeshes.request(binding.meshId, taskPriority)) {
                         auto task = std::make_shared<MeshFetchTask>(std::static_pointer_cast<NMLModelLODTreeLayer>(shared_from_this()), binding);
-                        _fetchThreadPool->execute(task, getUpdatePriority() + MESH_LOADING_PRIORITY_OFFSET);
+                        _fetchingMeshes.add(binding.meshId, task, taskPriority);
+                        _fetchThreadPool->execute(task, taskPriority);
                     }
                 }
             }
@@ -289,7 +337,7 @@ namespace carto {
         return true;
     }
     
-    bool NMLModelLODTreeLayer::loadTextures(const NMLModelLODTree* modelLODTree, int nodeId, bool checkOnly) {
+    bool NMLModelLODTreeLayer::loadTextures(const NMLModelLODTree* modelLODTree, int nodeId, int priority, bool checkOnly) {
         auto mapIt = modelLODTree->getTextureBindingsMap().find(nodeId);
         if (mapIt == modelLODTree->getTextureBindingsMap().end()) {
             return false;
@@ -297,19 +345,22 @@ namespace carto {
     
         for (auto listIt = mapIt->second.begin(); listIt != mapIt->second.end(); listIt++) {
             const NMLModelLODTree::TextureBinding& binding = *listIt;
+            long long textureKey = calculateTextureKey(binding.textureId, binding.level);
     
-            auto textureIt = _textureMap.find(binding.textureId);
+            auto textureIt = _textureMap.find(textureKey);
             if (textureIt == _textureMap.end()) {
                 std::shared_ptr<nml::GLTexture> glTexture;
-                if (_textureCache.read(binding.textureId, glTexture)) {
-                    _textureMap[binding.textureId] = glTexture;
+                if (_textureCache.read(textureKey, glTexture)) {
+                    _textureMap[textureKey] = glTexture;
                 } else {
                     if (checkOnly) {
                         return false;
                     }
-                    if (!_fetchingTextures.exists(binding.textureId)) {
+                    int taskPriority = getUpdatePriority() + TEXTURE_LOADING_PRIORITY_OFFSET + priority;
+                    if (!_fetchingTextures.request(textureKey, taskPriority)) {
                         auto task = std::make_shared<TextureFetchTask>(std::static_pointer_cast<NMLModelLODTreeLayer>(shared_from_this()), binding);
-                        _fetchThreadPool->execute(task, getUpdatePriority() + TEXTURE_LOADING_PRIORITY_OFFSET);
+                        _fetchingTextures.add(textureKey, task, taskPriority);
+                        _fetchThreadPool->execute(task, taskPriority);
                     }
                 }
             }
@@ -366,15 +417,28 @@ namespace carto {
         for (auto listIt = mapIt->second.begin(); listIt != mapIt->second.end(); listIt++) {
             const NMLModelLODTree::TextureBinding& binding = *listIt;
     
+            // If the requested level is not loaded yet, use the closest loaded level of the same texture (for example, the level used by the parent node)
             std::shared_ptr<nml::GLTexture> glTexture;
-            if (!_textureCache.read(binding.textureId, glTexture)) {
-                auto textureIt = _textureMap.find(binding.textureId);
-                if (textureIt == _textureMap.end()) {
-                    continue;
+            for (int delta = 0; delta < MAX_TEXTURE_LEVELS && !glTexture; delta++) {
+                for (int level : { binding.level - delta, binding.level + delta }) {
+                    if (level < 0 || level >= MAX_TEXTURE_LEVELS) {
+                        continue;
+                    }
+                    long long textureKey = calculateTextureKey(binding.textureId, level);
+                    if (!_textureCache.read(textureKey, glTexture)) {
+                        auto textureIt = _textureMap.find(textureKey);
+                        if (textureIt == _textureMap.end()) {
+                            continue;
+                        }
+                        glTexture = textureIt->second;
+                    }
+                    textureMap[textureKey] = glTexture;
+                    break;
                 }
-                glTexture = textureIt->second;
             }
-            textureMap[binding.textureId] = glTexture;
+            if (!glTexture) {
+                continue;
+            }
     
             if (glModel) {
                 glModel->replaceTexture(binding.localId, glTexture);
@@ -497,9 +561,10 @@ namespace carto {
                 continue;
             }
     
-            // Schedule data loading and remove this node from draw list
-            loadMeshes(modelLODTree, nodeId, false);
-            loadTextures(modelLODTree, nodeId, false);
+            // Schedule data loading, ranked by the projected size of the node. Remove this node from draw list
+            int priority = calculateLoadingPriority(modelLODTree->getSourceNode(nodeId)->bounds(), mvpMatrix * CalculateLocalMat(viewState, modelLODTree), LOADING_PRIORITY_RANGE);
+            loadMeshes(modelLODTree, nodeId, priority, false);
+            loadTextures(modelLODTree, nodeId, priority, false);
             
             // Find closest parent that has data available. Ignore size constraints
             bool parentFound = false;
@@ -584,6 +649,10 @@ namespace carto {
                 nodeDrawData = std::make_shared<NMLModelLODTreeDrawData>(std::static_pointer_cast<NMLModelLODTree>(const_cast<NMLModelLODTree*>(modelLODTree)->shared_from_this()), modelLODTree->getGlobalNodeId(nodeId), globalParentIds, glModel, *projectionSurface);
             }
     
+            // Stream in the textures of the drawn nodes
+            int priority = calculateLoadingPriority(modelLODTree->getSourceNode(nodeId)->bounds(), mvpMatrix * CalculateLocalMat(viewState, modelLODTree), LOADING_PRIORITY_RANGE);
+            loadTextures(modelLODTree, nodeId, priority, false);
+
             updateMeshes(modelLODTree, nodeId, nodeDrawData->getGLModel(), meshMap);
             updateTextures(modelLODTree, nodeId, nodeDrawData->getGLModel(), textureMap);
     
@@ -627,10 +696,8 @@ namespace carto {
     
         std::unique_lock<std::recursive_mutex> lock(layer->_mutex);
         
-        // If view has changed, cancel all previous task and fetch new list of map tiles
+        // If view has changed, fetch new list of map tiles
         if (layer->_mapTileListViewState.getModelviewProjectionMat() != _cullState->getViewState().getModelviewProjectionMat()) {
-            layer->_fetchThreadPool->cancelAll();
-
             std::shared_ptr<CullState> cullState = _cullState;
             
             lock.unlock();
@@ -651,8 +718,13 @@ namespace carto {
             layer->_mapTileListViewState = cullState->getViewState();
         }
     
+        // Rerank the queued requests for the current view. The requests that are not needed anymore are cancelled at the end
+        layer->_fetchingModelLODTrees.resetRequests();
+        layer->_fetchingMeshes.resetRequests();
+        layer->_fetchingTextures.resetRequests();
+
         // Load new model LOD trees
-        layer->loadModelLODTrees(layer->_mapTileList, false);
+        layer->loadModelLODTrees(layer->_mapTileList, _cullState->getViewState(), false);
         ModelLODTreeMap modelLODTreeMap;
         layer->updateModelLODTrees(layer->_mapTileList, modelLODTreeMap);
         std::swap(layer->_modelLODTreeMap, modelLODTreeMap);
@@ -665,13 +737,16 @@ namespace carto {
         std::swap(layer->_meshMap, meshMap);
         std::swap(layer->_textureMap, textureMap);
         std::swap(layer->_nodeDrawDataMap, nodeDrawDataMap);
+
+        layer->_fetchingModelLODTrees.cancelUnrequested();
+        layer->_fetchingMeshes.cancelUnrequested();
+        layer->_fetchingTextures.cancelUnrequested();
     }
     
     NMLModelLODTreeLayer::ModelLODTreeFetchTask::ModelLODTreeFetchTask(const std::shared_ptr<NMLModelLODTreeLayer>& layer, const NMLModelLODTreeDataSource::MapTile& mapTile) :
         _layer(layer),
         _mapTile(mapTile)
     {
-        layer->_fetchingModelLODTrees.add(_mapTile.modelLODTreeId);
     }
     
     void NMLModelLODTreeLayer::ModelLODTreeFetchTask::cancel() {
@@ -681,7 +756,7 @@ namespace carto {
         if (!layer) {
             return;
         }
-        layer->_fetchingModelLODTrees.remove(_mapTile.modelLODTreeId);
+        layer->_fetchingModelLODTrees.remove(_mapTile.modelLODTreeId, this);
     }
     
     void NMLModelLODTreeLayer::ModelLODTreeFetchTask::run() {
@@ -711,14 +786,13 @@ namespace carto {
                 mapRenderer->layerChanged(layer->shared_from_this(), false);
             }
         }
-        layer->_fetchingModelLODTrees.remove(_mapTile.modelLODTreeId);
+        layer->_fetchingModelLODTrees.remove(_mapTile.modelLODTreeId, this);
     }
     
     NMLModelLODTreeLayer::MeshFetchTask::MeshFetchTask(const std::shared_ptr<NMLModelLODTreeLayer>& layer, const NMLModelLODTree::MeshBinding& binding) :
         _layer(layer),
         _binding(binding)
     {
-        layer->_fetchingMeshes.add(_binding.meshId);
     }
     
     void NMLModelLODTreeLayer::MeshFetchTask::cancel() {
@@ -728,7 +802,7 @@ namespace carto {
         if (!layer) {
             return;
         }
-        layer->_fetchingMeshes.remove(_binding.meshId);
+        layer->_fetchingMeshes.remove(_binding.meshId, this);
     }
     
     void NMLModelLODTreeLayer::MeshFetchTask::run() {
@@ -761,14 +835,13 @@ namespace carto {
                 mapRenderer->layerChanged(layer->shared_from_this(), false);
             }
         }
-        layer->_fetchingMeshes.remove(_binding.meshId);
+        layer->_fetchingMeshes.remove(_binding.meshId, this);
     }
     
     NMLModelLODTreeLayer::TextureFetchTask::TextureFetchTask(const std::shared_ptr<NMLModelLODTreeLayer>& layer, const NMLModelLODTree::TextureBinding& binding) :
         _layer(layer),
         _binding(binding)
     {
-        layer->_fetchingTextures.add(_binding.textureId);
     }
     
     void NMLModelLODTreeLayer::TextureFetchTask::cancel() {
@@ -778,7 +851,7 @@ namespace carto {
         if (!layer) {
             return;
         }
-        layer->_fetchingTextures.remove(_binding.textureId);
+        layer->_fetchingTextures.remove(calculateTextureKey(_binding.textureId, _binding.level), this);
     }
     
     void NMLModelLODTreeLayer::TextureFetchTask::run() {
@@ -806,14 +879,14 @@ namespace carto {
             auto glTexture = std::make_shared<nml::GLTexture>(texture);
     
             std::unique_lock<std::recursive_mutex> lock(layer->_mutex);
-            layer->_textureMap[_binding.textureId] = glTexture;
-            layer->_textureCache.put(_binding.textureId, glTexture, glTexture->getTextureSize());
+            layer->_textureMap[calculateTextureKey(_binding.textureId, _binding.level)] = glTexture;
+            layer->_textureCache.put(calculateTextureKey(_binding.textureId, _binding.level), glTexture, glTexture->getTextureSize());
     
             if (std::shared_ptr<MapRenderer> mapRenderer = layer->_mapRenderer.lock()) {
                 mapRenderer->layerChanged(layer->shared_from_this(), false);
             }
         }
-        layer->_fetchingTextures.remove(_binding.textureId);
+        layer->_fetchingTextures.remove(calculateTextureKey(_binding.textureId, _binding.level), this);
     }
     
 }
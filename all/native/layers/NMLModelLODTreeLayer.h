@@ -19,6 +19,7 @@
 #include <string>
 #include <memory>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 #include <stdext/timed_lru_cache.h>
@@ -109,11 +110,14 @@ namespace carto {
     
         virtual void setComponents(const std::shared_ptr<CancelableThreadPool>& envelopeThreadPool,
                                    const std::shared_ptr<CancelableThreadPool>& tileThreadPool,
+                                   const std::shared_ptr<CancelableThreadPool>& tileDecodeThreadPool,
                                    const std::weak_ptr<Options>& options,
                                    const std::weak_ptr<MapRenderer>& mapRenderer,
                                    const std::weak_ptr<TouchHandler>& touchHandler);
 
         virtual void loadData(const std::shared_ptr<CullState>& cullState);
+
+        virtual void releaseMemory(MemoryPressureLevel::MemoryPressureLevel level);
     
     private:
         typedef std::vector<NMLModelLODTreeDataSource::MapTile> MapTileList;
@@ -121,7 +125,7 @@ namespace carto {
         typedef cache::timed_lru_cache<long long, std::shared_ptr<NMLModelLODTree> > ModelLODTreeCache;
         typedef std::map<long long, std::shared_ptr<nml::GLMesh> > MeshMap;
         typedef cache::timed_lru_cache<long long, std::shared_ptr<nml::GLMesh> > MeshCache;
-        typedef std::map<long long, std::shared_ptr<nml::GLTexture> > TextureMap;
+        typedef std::map<long long, std::shared_ptr<nml::GLTexture> > TextureMap; // keyed by texture id and level
         typedef cache::timed_lru_cache<long long, std::shared_ptr<nml::GLTexture> > TextureCache;
         typedef std::map<long long, std::shared_ptr<NMLModelLODTreeDrawData> > NodeDrawDataMap;
     
@@ -134,22 +138,73 @@ namespace carto {
                 return static_cast<int>(_fetchingTasks.size());
             }
             
-            void add(long long taskId) {
+            void add(long long taskId, const std::shared_ptr<CancelableTask>& task, int priority) {
                 std::lock_guard<std::mutex> lock(_mutex);
-                _fetchingTasks.insert(taskId);
+                _fetchingTasks[taskId] = TaskRecord { task, priority, true };
             }
             
-            bool exists(long long taskId) {
-                std::lock_guard<std::mutex> lock(_mutex);
-                return _fetchingTasks.find(taskId) != _fetchingTasks.end();
+            bool request(long long taskId, int priority) {
+                // Keep the task if it is already queued with the same priority (or requested with higher priority during this update),
+                // otherwise cancel it so that it can be requeued
+                std::shared_ptr<CancelableTask> task;
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    auto it = _fetchingTasks.find(taskId);
+                    if (it == _fetchingTasks.end()) {
+                        return false;
+                    }
+                    if (it->second.priority == priority || (it->second.requested && it->second.priority > priority)) {
+                        it->second.requested = true;
+                        return true;
+                    }
+                    task = it->second.task;
+                    _fetchingTasks.erase(it);
+                }
+                task->cancel();
+                return false;
             }
             
-            void remove(long long taskId) {
+            void remove(long long taskId, const CancelableTask* task) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                auto it = _fetchingTasks.find(taskId);
+                if (it != _fetchingTasks.end() && it->second.task.get() == task) {
+                    _fetchingTasks.erase(it);
+                }
+            }
+
+            void resetRequests() {
                 std::lock_guard<std::mutex> lock(_mutex);
-                _fetchingTasks.erase(taskId);
+                for (auto it = _fetchingTasks.begin(); it != _fetchingTasks.end(); it++) {
+                    it->second.requested = false;
+                }
             }
+
+            void cancelUnrequested() {
+                std::vector<std::shared_ptr<CancelableTask> > tasks;
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    for (auto it = _fetchingTasks.begin(); it != _fetchingTasks.end(); ) {
+                        if (!it->second.requested) {
+                            tasks.push_back(it->second.task);
+                            it = _fetchingTasks.erase(it);
+                        } else {
+                            it++;
+                        }
+                    }
+                }
+                for (const std::shared_ptr<CancelableTask>& task : tasks) {
+                    task->cancel();
+                }
+            }
+
         private:
-            std::unordered_set<long long> _fetchingTasks;
+            struct TaskRecord {
+                std::shared_ptr<CancelableTask> task;
+                int priority;
+                bool requested;
+            };
+
+            std::unordered_map<long long, TaskRecord> _fetchingTasks;
             mutable std::mutex _mutex;
         };
     
@@ -197,9 +252,9 @@ namespace carto {
         };
     
         bool isDataAvailable(const NMLModelLODTree* modelLODTree, int nodeId);
-        bool loadModelLODTrees(const MapTileList& mapTileList, bool checkOnly);
-        bool loadMeshes(const NMLModelLODTree* modelLODTree, int nodeId, bool checkOnly);
-        bool loadTextures(const NMLModelLODTree* modelLODTree, int nodeId, bool checkOnly);
+        bool loadModelLODTrees(const MapTileList& mapTileList, const ViewState& viewState, bool checkOnly);
+        bool loadMeshes(const NMLModelLODTree* modelLODTree, int nodeId, int priority, bool checkOnly);
+        bool loadTextures(const NMLModelLODTree* modelLODTree, int nodeId, int priority, bool checkOnly);
         void updateModelLODTrees(const MapTileList& mapTileList, ModelLODTreeMap& modelLODTreeMap);
         void updateMeshes(const NMLModelLODTree* modelLODTree, int nodeId, std::shared_ptr<nml::GLModel> glModel, MeshMap& meshMap);
         void updateTextures(const NMLModelLODTree* modelLODTree, int nodeId, std::shared_ptr<nml::GLModel> glModel, TextureMap& textureMap);
@@ -207,10 +262,15 @@ namespace carto {
 
         static cglib::mat4x4<double> CalculateLocalMat(const ViewState& viewState, const NMLModelLODTree* modelLODTree);
     
-        static const int MODELLODTREE_LOADING_PRIORITY_OFFSET = 1;
+        static const int FETCH_THREAD_COUNT = 2;
+
+        static const int LOADING_PRIORITY_RANGE = 64;
+        static const int MODELLODTREE_LOADING_PRIORITY_OFFSET = LOADING_PRIORITY_RANGE + 1;
         static const int MESH_LOADING_PRIORITY_OFFSET = 0;
         static const int TEXTURE_LOADING_PRIORITY_OFFSET = 0;
 
+        static const int MAX_TEXTURE_LEVELS = 16;
+
         static const int DEFAULT_MODELLODTREE_CACHE_SIZE = 64;
         static const int DEFAULT_MAX_MEMORY_SIZE = 80 * 1024 * 1024;
         static const int DEFAULT_MESH_CACHE_SIZE = 80 * 1024 * 1024;
@@ -1,4 +1,5 @@
 #include "RasterTileLayer.h"
+#include "core/BinaryData.h"
 #include "components/Exceptions.h"
 #include "components/CancelableThreadPool.h"
 #include "datasources/TileDataSource.h"
@@ -78,7 +79,8 @@ namespace carto {
         _visibleTileIds(),
         _tempDrawDatas(),
         _visibleCache(128 * 1024 * 1024), // limit should be never reached during normal use cases
-        _preloadingCache(DEFAULT_PRELOADING_CACHE_SIZE)
+        _preloadingCache(DEFAULT_PRELOADING_CACHE_SIZE),
+        _sharedTiles()
     {
         setCullDelay(DEFAULT_CULL_DELAY);
     }
@@ -157,7 +159,7 @@ namespace carto {
             tileThreadPool = _tileThreadPool;
         }
         if (tileThreadPool) {
-            tileThreadPool->execute(task, preloadingTile ? getUpdatePriority() + PRELOADING_PRIORITY_OFFSET : getUpdatePriority());
+            tileThreadPool->execute(task, preloadingTile ? getUpdatePriority() + PRELOADING_PRIORITY_OFFSET : getUpdatePriority(), _tileLoadTaskGroup);
         }
     }
     
@@ -181,14 +183,37 @@ namespace carto {
             std::lock_guard<std::recursive_mutex> lock(_mutex);
             _visibleCache.clear();
             _preloadingCache.clear();
+            _sharedTiles.clear();
         } else {
             std::lock_guard<std::recursive_mutex> lock(_mutex);
             _visibleCache.invalidate_all(std::chrono::steady_clock::now());
             _preloadingCache.clear();
+            _sharedTiles.clear();
         }
         refresh();
     }
 
+    std::size_t RasterTileLayer::getTileCacheSize(bool preloadingCache) const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        return preloadingCache ? _preloadingCache.size() : _visibleCache.size();
+    }
+
+    std::size_t RasterTileLayer::getTileCacheCapacity(bool preloadingCache) const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        return preloadingCache ? _preloadingCache.capacity() : _visibleCache.capacity();
+    }
+
+    void RasterTileLayer::trimTileCache(bool preloadingCache, std::size_t size) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        auto& cache = preloadingCache ? _preloadingCache : _visibleCache;
+        std::size_t capacity = cache.capacity();
+        if (size < capacity) {
+            // Shrinking the capacity drops the least recently used tiles
+            cache.resize(size);
+            cache.resize(capacity);
+        }
+    }
+
     void RasterTileLayer::calculateDrawData(const MapTile& visTile, const MapTile& closestTile, bool preloadingTile) {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
 
@@ -351,6 +376,7 @@ namespace carto {
             std::lock_guard<std::recursive_mutex> lock(_mutex);
             _preloadingCache.clear();
             _visibleCache.clear();
+            _sharedTiles.clear();
         }
     
         // Create new rendererer, simply drop old one (if exists)
@@ -403,11 +429,46 @@ namespace carto {
             std::lock_guard<std::recursive_mutex> lock(_mutex);
             _preloadingCache.clear();
             _visibleCache.clear();
+            _sharedTiles.clear();
         }
     
         Layer::onSurfaceDestroyed();
     }
     
+    std::shared_ptr<const vt::Tile> RasterTileLayer::findSharedTile(const MapTile& dataSourceTile, const std::shared_ptr<BinaryData>& data, const std::shared_ptr<vt::TileTransformer>& tileTransformer) const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+        auto it = _sharedTiles.find(dataSourceTile.getTileId());
+        if (it == _sharedTiles.end()) {
+            return std::shared_ptr<const vt::Tile>();
+        }
+
+        // The tile can be reused only if it was built from the same data with the current transformer
+        const SharedTile& sharedTile = it->second;
+        if (sharedTile.data.lock() != data || sharedTile.tileTransformer.lock() != tileTransformer) {
+            return std::shared_ptr<const vt::Tile>();
+        }
+        return sharedTile.vtTile.lock();
+    }
+
+    void RasterTileLayer::addSharedTile(const MapTile& dataSourceTile, const std::shared_ptr<BinaryData>& data, const std::shared_ptr<vt::TileTransformer>& tileTransformer, const std::shared_ptr<const vt::Tile>& vtTile) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+        // Drop entries whose tiles are no longer referenced by the caches
+        for (auto it = _sharedTiles.begin(); it != _sharedTiles.end(); ) {
+            if (it->second.vtTile.expired()) {
+                it = _sharedTiles.erase(it);
+            } else {
+                it++;
+            }
+        }
+
+        SharedTile& sharedTile = _sharedTiles[dataSourceTile.getTileId()];
+        sharedTile.data = data;
+        sharedTile.tileTransformer = tileTransformer;
+        sharedTile.vtTile = vtTile;
+    }
+
     void RasterTileLayer::registerDataSourceListener() {
         _dataSourceListener = std::make_shared<DataSourceListener>(std::static_pointer_cast<RasterTileLayer>(shared_from_this()));
         _dataSource->registerOnChangeListener(_dataSourceListener);
@@ -423,72 +484,54 @@ namespace carto {
     {
     }
     
-    bool RasterTileLayer::FetchTask::loadTile(const std::shared_ptr<TileLayer>& tileLayer) {
+    bool RasterTileLayer::FetchTask::decodeTile(const std::shared_ptr<TileLayer>& tileLayer, const MapTile& dataSourceTile, const std::shared_ptr<TileData>& tileData) {
         auto layer = std::static_pointer_cast<RasterTileLayer>(tileLayer);
     
         bool refresh = false;
-        for (const MapTile& dataSourceTile : _dataSourceTiles) {
-            std::shared_ptr<TileData> tileData = layer->_dataSource->loadTile(dataSourceTile);
-            if (!tileData) {
-                break;
-            }
-            if (tileData->isReplaceWithParent()) {
-                continue;
-            }
-            if (!tileData->getData()) {
-                break;
-            }
-    
-            // Save tile to texture cache, unless invalidated
-            vt::TileId vtTile(_tile.getZoom(), _tile.getX(), _tile.getY());
-            vt::TileId vtDataSourceTile(dataSourceTile.getZoom(), dataSourceTile.getX(), dataSourceTile.getY());
-            std::shared_ptr<Bitmap> bitmap = Bitmap::CreateFromCompressed(tileData->getData());
-            if (bitmap) {
-                // Check if we received the requested tile or extract/scale the corresponding part
+
+        // If we received a parent tile instead of the requested one, the renderer draws the corresponding part of the parent tile.
+        // The parent tile (and its texture) is shared between all the tiles substituted by it, instead of extracting and scaling the subtiles.
+        std::shared_ptr<vt::TileTransformer> tileTransformer = layer->getTileTransformer();
+        std::shared_ptr<const vt::Tile> vtTile;
+        std::size_t tileSize = EXTRA_TILE_FOOTPRINT;
+        if (dataSourceTile != _tile) {
+            vtTile = layer->findSharedTile(dataSourceTile, tileData->getData(), tileTransformer);
+        }
+        if (!vtTile) {
+            if (std::shared_ptr<Bitmap> bitmap = Bitmap::CreateFromCompressed(tileData->getData())) {
+                vtTile = CreateVectorTile(dataSourceTile, bitmap, tileTransformer);
+                tileSize += vtTile->getResidentSize();
                 if (dataSourceTile != _tile) {
-                    bitmap = ExtractSubTile(_tile, dataSourceTile, bitmap);
+                    layer->addSharedTile(dataSourceTile, tileData->getData(), tileTransformer, vtTile);
                 }
-                std::shared_ptr<vt::TileTransformer> tileTransformer = layer->getTileTransformer();
-                std::shared_ptr<vt::Tile> vtTile = CreateVectorTile(_tile, bitmap, tileTransformer);
-                std::size_t tileSize = EXTRA_TILE_FOOTPRINT + vtTile->getResidentSize();
-
-                if (!isInvalidated()) {
-                    // Build the bitmap object
-                    std::lock_guard<std::recursive_mutex> lock(layer->_mutex);
-                    if (layer->getTileTransformer() == tileTransformer) { // extra check that the tile is created with correct transformer. Otherwise simply drop it.
-                        if (isPreloading()) {
-                            layer->_preloadingCache.put(_tile.getTileId(), vtTile, tileSize);
-                            if (tileData->getMaxAge() >= 0) {
-                                layer->_preloadingCache.invalidate(_tile.getTileId(), std::chrono::steady_clock::now() + std::chrono::milliseconds(tileData->getMaxAge()));
-                            }
-                        } else {
-                            layer->_visibleCache.put(_tile.getTileId(), vtTile, tileSize);
-                            if (tileData->getMaxAge() >= 0) {
-                                layer->_visibleCache.invalidate(_tile.getTileId(), std::chrono::steady_clock::now() + std::chrono::milliseconds(tileData->getMaxAge()));
-                            }
+            }
+        }
+        if (vtTile) {
+            // Save tile to texture cache, unless invalidated
+            if (!isInvalidated()) {
+                std::lock_guard<std::recursive_mutex> lock(layer->_mutex);
+                if (layer->getTileTransformer() == tileTransformer) { // extra check that the tile is created with correct transformer. Otherwise simply drop it.
+                    if (isPreloading()) {
+                        layer->_preloadingCache.put(_tile.getTileId(), vtTile, tileSize);
+                        if (tileData->getMaxAge() >= 0) {
+                            layer->_preloadingCache.invalidate(_tile.getTileId(), std::chrono::steady_clock::now() + std::chrono::milliseconds(tileData->getMaxAge()));
+                        }
+                    } else {
+                        layer->_visibleCache.put(_tile.getTileId(), vtTile, tileSize);
+                        if (tileData->getMaxAge() >= 0) {
+                            layer->_visibleCache.invalidate(_tile.getTileId(), std::chrono::steady_clock::now() + std::chrono::milliseconds(tileData->getMaxAge()));
                         }
                     }
                 }
-                refresh = true; // NOTE: need to refresh even when invalidated
-            } else {
-                Log::Error("RasterTileLayer::FetchTask: Failed to decode tile");
             }
-            break;
+            refresh = true; // NOTE: need to refresh even when invalidated
+        } else {
+            Log::Error("RasterTileLayer::FetchTask: Failed to decode tile");
         }
         
         return refresh;
     }
     
-    std::shared_ptr<Bitmap> RasterTileLayer::FetchTask::ExtractSubTile(const MapTile& subTile, const MapTile& tile, const std::shared_ptr<Bitmap>& bitmap) {
-        int deltaZoom = subTile.getZoom() - tile.getZoom();
-        int x = (bitmap->getWidth()  * (subTile.getX() & ((1 << deltaZoom) - 1))) >> deltaZoom;
-        int y = (bitmap->getHeight() * (subTile.getY() & ((1 << deltaZoom) - 1))) >> deltaZoom;
-        int w = bitmap->getWidth()  >> deltaZoom;
-        int h = bitmap->getHeight() >> deltaZoom;
-        std::shared_ptr<Bitmap> subBitmap = bitmap->getSubBitmap(x, y, std::max(w, 1), std::max(h, 1));
-        return subBitmap->getResizedBitmap(bitmap->getWidth(), bitmap->getHeight());
-    }
-
     std::shared_ptr<vt::Tile> RasterTileLayer::FetchTask::CreateVectorTile(const MapTile& tile, const std::shared_ptr<Bitmap>& bitmap, const std::shared_ptr<vt::TileTransformer>& tileTransformer) {
         std::shared_ptr<vt::TileBitmap> tileBitmap;
         switch (bitmap->getColorFormat()) {
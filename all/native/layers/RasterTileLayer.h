@@ -16,14 +16,17 @@
 #include <atomic>
 #include <memory>
 #include <map>
+#include <unordered_map>
 
 #include <stdext/timed_lru_cache.h>
 
 namespace carto {
+    class BinaryData;
     class TileDrawData;
     class RasterTileEventListener;
     namespace vt {
         class Tile;
+        class TileTransformer;
     }
     
     /**
@@ -74,10 +77,9 @@ namespace carto {
             FetchTask(const std::shared_ptr<RasterTileLayer>& layer, const MapTile& tile, bool preloadingTile);
     
         protected:
-            bool loadTile(const std::shared_ptr<TileLayer>& tileLayer);
+            virtual bool decodeTile(const std::shared_ptr<TileLayer>& tileLayer, const MapTile& dataSourceTile, const std::shared_ptr<TileData>& tileData);
             
         private:
-            static std::shared_ptr<Bitmap> ExtractSubTile(const MapTile& subTile, const MapTile& tile, const std::shared_ptr<Bitmap>& bitmap);
             static std::shared_ptr<vt::Tile> CreateVectorTile(const MapTile& tile, const std::shared_ptr<Bitmap>& bitmap, const std::shared_ptr<vt::TileTransformer>& tileTransformer);
         };
     
@@ -87,6 +89,10 @@ namespace carto {
         virtual void clearTiles(bool preloadingTiles);
         virtual void tilesChanged(bool removeTiles);
 
+        virtual std::size_t getTileCacheSize(bool preloadingCache) const;
+        virtual std::size_t getTileCacheCapacity(bool preloadingCache) const;
+        virtual void trimTileCache(bool preloadingCache, std::size_t size);
+
         virtual void calculateDrawData(const MapTile& visTile, const MapTile& closestTile, bool preloadingTile);
         virtual void refreshDrawData(const std::shared_ptr<CullState>& cullState);
         
@@ -108,8 +114,16 @@ namespace carto {
         virtual void unregisterDataSourceListener();
 
     private:    
+        struct SharedTile {
+            std::weak_ptr<BinaryData> data;
+            std::weak_ptr<vt::TileTransformer> tileTransformer;
+            std::weak_ptr<const vt::Tile> vtTile;
+        };
+
+        std::shared_ptr<const vt::Tile> findSharedTile(const MapTile& dataSourceTile, const std::shared_ptr<BinaryData>& data, const std::shared_ptr<vt::TileTransformer>& tileTransformer) const;
+        void addSharedTile(const MapTile& dataSourceTile, const std::shared_ptr<BinaryData>& data, const std::shared_ptr<vt::TileTransformer>& tileTransformer, const std::shared_ptr<const vt::Tile>& vtTile);
+
         static const int DEFAULT_CULL_DELAY = 200;
-        static const int PRELOADING_PRIORITY_OFFSET = -2;
         static const int EXTRA_TILE_FOOTPRINT = 4096;
         static const int DEFAULT_PRELOADING_CACHE_SIZE = 10 * 1024 * 1024;
         
@@ -120,6 +134,8 @@ namespace carto {
         
         cache::timed_lru_cache<long long, std::shared_ptr<const vt::Tile> > _visibleCache;
         cache::timed_lru_cache<long long, std::shared_ptr<const vt::Tile> > _preloadingCache;
+
+        std::unordered_map<long long, SharedTile> _sharedTiles; // data source tiles shared by overzoomed/substituted tiles, keyed by data source tile id
     };
     
 }
@@ -74,11 +74,12 @@ namespace carto {
 
     void SolidLayer::setComponents(const std::shared_ptr<CancelableThreadPool>& envelopeThreadPool,
                                     const std::shared_ptr<CancelableThreadPool>& tileThreadPool,
+                                    const std::shared_ptr<CancelableThreadPool>& tileDecodeThreadPool,
                                     const std::weak_ptr<Options>& options,
                                     const std::weak_ptr<MapRenderer>& mapRenderer,
                                     const std::weak_ptr<TouchHandler>& touchHandler)
     {
-        Layer::setComponents(envelopeThreadPool, tileThreadPool, options, mapRenderer, touchHandler);
+        Layer::setComponents(envelopeThreadPool, tileThreadPool, tileDecodeThreadPool, options, mapRenderer, touchHandler);
     }
     
     void SolidLayer::loadData(const std::shared_ptr<CullState>& cullState) {
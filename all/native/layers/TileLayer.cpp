@@ -2,6 +2,10 @@
 #include "core/BinaryData.h"
 #include "components/Exceptions.h"
 #include "components/CancelableTask.h"
+#include "components/CacheStatistics.h"
+#include "components/CancelableThreadPool.h"
+#include "components/TileCacheManager.h"
+#include "datasources/MemoryCacheTileDataSource.h"
 #include "datasources/components/TileData.h"
 #include "layers/TileLoadListener.h"
 #include "layers/UTFGridEventListener.h"
@@ -18,6 +22,9 @@
 #include "utils/Const.h"
 #include "utils/TileUtils.h"
 #include "utils/Log.h"
+#include "utils/Tracer.h"
+
+#include <algorithm>
 
 #include <vt/TileTransformer.h>
 
@@ -65,6 +72,19 @@ namespace carto {
         refresh();
     }
     
+    bool TileLayer::isPredictivePreloading() const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        return _predictivePreloading;
+    }
+    
+    void TileLayer::setPredictivePreloading(bool predictivePreloading) {
+        {
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            _predictivePreloading = predictivePreloading;
+        }
+        refresh();
+    }
+    
     bool TileLayer::isSynchronizedRefresh() const {
         return _synchronizedRefresh;
     }
@@ -141,9 +161,36 @@ namespace carto {
         clearTiles(true);
         if (all) {
             clearTiles(false);
+
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            _retainedTileDataCache.clear();
         }
     }
 
+    std::shared_ptr<CacheStatistics> TileLayer::getTileCacheStatistics() const {
+        std::size_t size = getTileCacheSize(false) + getTileCacheSize(true);
+        std::size_t capacity = getTileCacheCapacity(false) + getTileCacheCapacity(true);
+        return std::make_shared<CacheStatistics>(size, capacity, _tileCacheHitCount.load(), _tileCacheMissCount.load());
+    }
+
+    std::size_t TileLayer::getRetainedTileDataCacheCapacity() const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        return _retainedTileDataCache.capacity();
+    }
+
+    void TileLayer::setRetainedTileDataCacheCapacity(std::size_t capacityInBytes) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        _retainedTileDataCache.resize(capacityInBytes);
+    }
+
+    int TileLayer::getMaxTileLoadConcurrency() const {
+        return _tileLoadTaskGroup->getMaxConcurrency();
+    }
+
+    void TileLayer::setMaxTileLoadConcurrency(int maxConcurrency) {
+        _tileLoadTaskGroup->setMaxConcurrency(std::max(0, maxConcurrency));
+    }
+
     std::shared_ptr<TileLoadListener> TileLayer::getTileLoadListener() const {
         return _tileLoadListener.get();
     }
@@ -171,11 +218,29 @@ namespace carto {
         
     void TileLayer::DataSourceListener::onTilesChanged(bool removeTiles) {
         if (std::shared_ptr<TileLayer> layer = _layer.lock()) {
+            {
+                std::lock_guard<std::recursive_mutex> lock(layer->_mutex);
+                layer->_retainedTileDataCache.clear();
+            }
             layer->tilesChanged(removeTiles);
         } else {
             Log::Error("TileLayer::DataSourceListener: Lost connection to layer");
         }
     }
+
+    void TileLayer::DataSourceListener::onTilesChanged(const std::vector<MapTile>& tiles, bool removeTiles) {
+        if (std::shared_ptr<TileLayer> layer = _layer.lock()) {
+            {
+                std::lock_guard<std::recursive_mutex> lock(layer->_mutex);
+                for (const MapTile& tile : tiles) {
+                    layer->_retainedTileDataCache.remove(tile.getTileId());
+                }
+            }
+            layer->tilesChanged(tiles, removeTiles);
+        } else {
+            Log::Error("TileLayer::DataSourceListener: Lost connection to layer");
+        }
+    }
         
     TileLayer::TileLayer(const std::shared_ptr<TileDataSource>& dataSource) :
         Layer(),
@@ -188,18 +253,31 @@ namespace carto {
         _tileLoadListener(),
         _utfGridEventListener(),
         _fetchingTiles(),
+        _tileLoadTaskGroup(std::make_shared<CancelableThreadPool::TaskGroup>(0)),
         _frameNr(0),
         _lastFrameNr(-1),
         _preloading(false),
+        _predictivePreloading(true),
         _substitutionPolicy(TileSubstitutionPolicy::TILE_SUBSTITUTION_POLICY_ALL),
         _zoomLevelBias(0.0f),
         _maxOverzoomLevel(MAX_PARENT_SEARCH_DEPTH),
         _maxUnderzoomLevel(MAX_CHILD_SEARCH_DEPTH),
         _visibleTiles(),
         _preloadingTiles(),
+        _predictedTiles(),
+        _predictedTileZoom(-1),
+        _batchLoadTasks(),
+        _tileBoundsMap(),
+        _lastTileBoundsMap(),
+        _lastTileBoundsZoom(-1),
+        _lastTileBoundsDataExtent(),
+        _lastTileBoundsTransformer(),
         _utfGridTiles(),
         _tileRenderer(),
-        _tileTransformer()
+        _tileTransformer(),
+        _retainedTileDataCache(DEFAULT_RETAINED_TILE_DATA_CACHE_CAPACITY),
+        _tileCacheHitCount(0),
+        _tileCacheMissCount(0)
     {
         if (!dataSource) {
             throw NullArgumentException("Null dataSource");
@@ -214,11 +292,14 @@ namespace carto {
     
     void TileLayer::setComponents(const std::shared_ptr<CancelableThreadPool>& envelopeThreadPool,
                                   const std::shared_ptr<CancelableThreadPool>& tileThreadPool,
+                                  const std::shared_ptr<CancelableThreadPool>& tileDecodeThreadPool,
                                   const std::weak_ptr<Options>& options,
                                   const std::weak_ptr<MapRenderer>& mapRenderer,
                                   const std::weak_ptr<TouchHandler>& touchHandler)
     {
-        Layer::setComponents(envelopeThreadPool, tileThreadPool, options, mapRenderer, touchHandler);
+        Layer::setComponents(envelopeThreadPool, tileThreadPool, tileDecodeThreadPool, options, mapRenderer, touchHandler);
+
+        TileCacheManager::GetInstance().registerLayer(std::static_pointer_cast<TileLayer>(shared_from_this()));
 
         std::lock_guard<std::recursive_mutex> lock(_mutex);
         if (_tileRenderer) {
@@ -242,11 +323,22 @@ namespace carto {
             }
         }
     
-        // Cancel old tasks
-        for (const std::shared_ptr<FetchTaskBase>& task : _fetchingTiles.getTasks()) {
+        // Cancel old tasks. Tasks that are still needed will be resubmitted by findTiles in the order of the new view
+        std::vector<std::shared_ptr<FetchTaskBase> > oldTasks = _fetchingTiles.getTasks();
+        for (const std::shared_ptr<FetchTaskBase>& task : oldTasks) {
             task->cancel();
         }
-        
+
+        for (const std::shared_ptr<BatchLoadTask>& batchLoadTask : _batchLoadTasks) {
+            batchLoadTask->cancel();
+        }
+        _batchLoadTasks.clear();
+
+        // Drop the canceled tasks from the queue immediately, so that the workers do not have to skip them one by one
+        if (!oldTasks.empty() && _tileThreadPool) {
+            _tileThreadPool->removeCanceled();
+        }
+
         // Check if layer should be drawn
         if (!isVisible() || !getVisibleZoomRange().inRange(cullState->getViewState().getZoom()) || getOpacity() <= 0) {
             _calculatingTiles = false;
@@ -255,13 +347,25 @@ namespace carto {
             return;
         }
         
-        if (!_lastCullState || _frameNr != _lastFrameNr || cullState->getViewState().getModelviewProjectionMat() != _lastCullState->getViewState().getModelviewProjectionMat()) {
+        if (!_lastCullState || cullState->getViewState().getModelviewProjectionMat() != _lastCullState->getViewState().getModelviewProjectionMat()) {
             // If the view has changed calculate new visible tiles, otherwise use the old ones
             calculateVisibleTiles(cullState);
+        } else if (_frameNr != _lastFrameNr) {
+            // If only the frame has changed, the visible tiles stay the same. Simply switch the frame of the tiles
+            for (std::vector<MapTile>* tiles : { &_visibleTiles, &_preloadingTiles, &_predictedTiles }) {
+                for (MapTile& tile : *tiles) {
+                    if (tile.getFrameNr() != _frameNr) {
+                        tile = MapTile(tile.getX(), tile.getY(), tile.getZoom(), _frameNr);
+                    }
+                }
+            }
         }
     
         // Find replacements for visible tiles
         findTiles(_visibleTiles, false);
+
+        // Fetch the tiles visible at the predicted camera target, even if preloading is disabled
+        findTiles(_predictedTiles, true);
     
         if (_preloading) {
             // Find replacements for preloading tiles
@@ -285,6 +389,27 @@ namespace carto {
         refreshDrawData(cullState);
     }
 
+    void TileLayer::releaseMemory(MemoryPressureLevel::MemoryPressureLevel level) {
+        clearTiles(true);
+        if (level >= MemoryPressureLevel::MEMORY_PRESSURE_LEVEL_SEVERE) {
+            {
+                std::lock_guard<std::recursive_mutex> lock(_mutex);
+                _retainedTileDataCache.clear();
+            }
+            if (auto memoryCacheDataSource = std::dynamic_pointer_cast<MemoryCacheTileDataSource>(_dataSource.get())) {
+                memoryCacheDataSource->clear();
+            }
+        }
+        if (level >= MemoryPressureLevel::MEMORY_PRESSURE_LEVEL_CRITICAL) {
+            clearTiles(false);
+        }
+    }
+
+    void TileLayer::tilesChanged(const std::vector<MapTile>& dataSourceTiles, bool removeTiles) {
+        // By default any change reloads all the tiles
+        tilesChanged(removeTiles);
+    }
+
     void TileLayer::updateTileLoadListener() {
         bool calculatingTiles = _calculatingTiles;
     
@@ -383,24 +508,86 @@ namespace carto {
         // Remove last visible and preloading tiles
         _visibleTiles.clear();
         _preloadingTiles.clear();
+        _predictedTiles.clear();
+        _predictedTileZoom = -1;
+
+        // Tile bounds of the previous pass can be reused while panning. If the zoom level, data extent
+        // or tile transformer has changed, do a full pass instead.
+        MapBounds dataExtent = _dataSource->getDataExtent();
+        int zoom = static_cast<int>(cullState->getViewState().getZoom());
+        if (zoom != _lastTileBoundsZoom || dataExtent != _lastTileBoundsDataExtent || _tileTransformer != _lastTileBoundsTransformer) {
+            _lastTileBoundsMap.clear();
+            _lastTileBoundsZoom = zoom;
+            _lastTileBoundsDataExtent = dataExtent;
+            _lastTileBoundsTransformer = _tileTransformer;
+        }
+
+        // Capture the layer parameters once per pass, the getters lock the layer and some of them are virtual
+        CullParameters cullParams;
+        cullParams.dataExtent = dataExtent;
+        cullParams.minZoom = getMinZoom();
+        float zoomLevelBias = getZoomLevelBias();
+        cullParams.targetTileZoom = std::min(getMaxZoom(), static_cast<int>(cullState->getViewState().getZoom() + zoomLevelBias + DISCRETE_ZOOM_LEVEL_BIAS));
+        for (int i = 0; i <= Const::MAX_SUPPORTED_ZOOM_LEVEL; i++) {
+            cullParams.zoomDistanceScales[i] = std::pow(2.0f, i - zoomLevelBias);
+        }
 
         // Recursively calculate visible tiles
-        calculateVisibleTilesRecursive(cullState, MapTile(0, 0, 0, _frameNr), _dataSource->getDataExtent());
+        calculateVisibleTilesRecursive(cullState, MapTile(0, 0, 0, _frameNr), cullParams);
         if (auto options = _options.lock()) {
-            if (options->getRenderProjectionMode() == RenderProjectionMode::RENDER_PROJECTION_MODE_PLANAR && options->isSeamlessPanning()) {
+            std::shared_ptr<const Options::Snapshot> snapshot = options->getSnapshot();
+            if (snapshot->renderProjectionMode == RenderProjectionMode::RENDER_PROJECTION_MODE_PLANAR && snapshot->seamlessPanning) {
                 // Additional visibility testing has to be done if seamless panning is enabled
                 for (int i = 1; i <= 5; i++) {
-                    calculateVisibleTilesRecursive(cullState, MapTile(-i, 0, 0, _frameNr), _dataSource->getDataExtent());
-                    calculateVisibleTilesRecursive(cullState, MapTile( i, 0, 0, _frameNr), _dataSource->getDataExtent());
+                    calculateVisibleTilesRecursive(cullState, MapTile(-i, 0, 0, _frameNr), cullParams);
+                    calculateVisibleTilesRecursive(cullState, MapTile( i, 0, 0, _frameNr), cullParams);
                 }
             }
         }
+
+        // Keep only the bounds of the tiles visited in this pass, so the maps stay proportional to the visible area
+        std::swap(_lastTileBoundsMap, _tileBoundsMap);
+        _tileBoundsMap.clear();
+        
+        // Find the tiles visible at the end of the camera animation or kinetic movement, that are not already visible or preloaded.
+        // When panning, the prediction is approximate, so only the tiles closest to the predicted camera position are kept.
+        // When the tile zoom level changes, all the tiles of the target view are fetched, as the intermediate zoom levels are skipped
+        if (_predictivePreloading && cullState->getPredictedViewState()) {
+            const ViewState& predictedViewState = *cullState->getPredictedViewState();
+            auto predictedCullState = std::make_shared<CullState>(cullState->getEnvelope(), predictedViewState);
+            CullParameters predictedCullParams = cullParams;
+            predictedCullParams.targetTileZoom = std::min(getMaxZoom(), static_cast<int>(predictedViewState.getZoom() + zoomLevelBias + DISCRETE_ZOOM_LEVEL_BIAS));
+
+            std::vector<MapTile> visibleTiles;
+            std::vector<MapTile> preloadingTiles;
+            std::swap(_visibleTiles, visibleTiles);
+            std::swap(_preloadingTiles, preloadingTiles);
+            calculateVisibleTilesRecursive(predictedCullState, MapTile(0, 0, 0, _frameNr), predictedCullParams);
+            std::swap(_visibleTiles, visibleTiles);
+            std::swap(_preloadingTiles, preloadingTiles);
+
+            std::unordered_set<MapTile> existingTiles(_visibleTiles.begin(), _visibleTiles.end());
+            if (_preloading) {
+                existingTiles.insert(_preloadingTiles.begin(), _preloadingTiles.end());
+            }
+            for (const MapTile& tile : visibleTiles) {
+                if (existingTiles.find(tile) == existingTiles.end()) {
+                    _predictedTiles.push_back(tile);
+                }
+            }
+            sortTiles(_predictedTiles, predictedViewState, true);
+            if (predictedCullParams.targetTileZoom != cullParams.targetTileZoom) {
+                _predictedTileZoom = predictedCullParams.targetTileZoom;
+            } else if (_predictedTiles.size() > static_cast<std::size_t>(PREDICTIVE_PRELOADING_TILE_BUDGET)) {
+                _predictedTiles.resize(PREDICTIVE_PRELOADING_TILE_BUDGET);
+            }
+        }
         
         sortTiles(_visibleTiles, cullState->getViewState(), false);
         sortTiles(_preloadingTiles, cullState->getViewState(), true);
     }
 
-    void TileLayer::calculateVisibleTilesRecursive(const std::shared_ptr<CullState>& cullState, const MapTile& tile, const MapBounds& dataExtent) {
+    void TileLayer::calculateVisibleTilesRecursive(const std::shared_ptr<CullState>& cullState, const MapTile& tile, const CullParameters& cullParams) {
         const ViewState& viewState = cullState->getViewState();
         const cglib::frustum3<double>& visibleFrustum = viewState.getFrustum();
         
@@ -408,17 +595,30 @@ namespace carto {
             return;
         }
 
-        int tileMask = (1 << tile.getZoom()) - 1;
-        MapTile flippedTile(tile.getX() & tileMask, tileMask - (tile.getY() & tileMask), tile.getZoom(), 0);
-        if (!calculateMapTileBounds(flippedTile).intersects(dataExtent)) {
+        // Reuse the tile bounds from the last pass if possible, otherwise calculate them
+        std::tuple<int, int, int> tileKey(tile.getZoom(), tile.getX(), tile.getY());
+        TileBounds bounds;
+        auto it = _lastTileBoundsMap.find(tileKey);
+        if (it != _lastTileBoundsMap.end()) {
+            bounds = it->second;
+        } else {
+            int tileMask = (1 << tile.getZoom()) - 1;
+            MapTile flippedTile(tile.getX() & tileMask, tileMask - (tile.getY() & tileMask), tile.getZoom(), 0);
+            bounds.inDataExtent = calculateMapTileBounds(flippedTile).intersects(cullParams.dataExtent);
+            if (bounds.inDataExtent) {
+                bounds.tileBounds = _tileTransformer->calculateTileBBox(vt::TileId(tile.getZoom(), tile.getX(), tile.getY()));
+                cglib::vec3<double> tileCenter = bounds.tileBounds.center();
+                bounds.preloadingBounds = cglib::bbox3<double>(tileCenter + (bounds.tileBounds.min - tileCenter) * PRELOADING_TILE_SCALE, tileCenter + (bounds.tileBounds.max - tileCenter) * PRELOADING_TILE_SCALE);
+            }
+        }
+        _tileBoundsMap[tileKey] = bounds;
+        if (!bounds.inDataExtent) {
             return;
         }
-        
-        cglib::bbox3<double> tileBounds = _tileTransformer->calculateTileBBox(vt::TileId(tile.getZoom(), tile.getX(), tile.getY()));
+        const cglib::bbox3<double>& tileBounds = bounds.tileBounds;
         cglib::vec3<double> tileCenter = tileBounds.center();
-        cglib::bbox3<double> preloadingBounds(tileCenter + (tileBounds.min - tileCenter) * PRELOADING_TILE_SCALE, tileCenter + (tileBounds.max - tileCenter) * PRELOADING_TILE_SCALE);
 
-        bool inPreloadingFrustum = visibleFrustum.inside(preloadingBounds);
+        bool inPreloadingFrustum = visibleFrustum.inside(bounds.preloadingBounds);
         if (!inPreloadingFrustum) {
             return;
         }
@@ -427,19 +627,18 @@ namespace carto {
         // Map tile is visible, calculate distance using camera plane
         const cglib::mat4x4<double>& mvpMat = viewState.getModelviewProjectionMat();
         double tileW = tileCenter(0) * mvpMat(3, 0) + tileCenter(1) * mvpMat(3, 1) + tileCenter(2) * mvpMat(3, 2) + mvpMat(3, 3);
-        double zoomDistance = tileW * std::pow(2.0f, tile.getZoom() - getZoomLevelBias());
+        double zoomDistance = tileW * cullParams.zoomDistanceScales[tile.getZoom()];
         bool subDivide = zoomDistance < SUBDIVISION_THRESHOLD * Const::SQRT_2;
-        int targetTileZoom = std::min(getMaxZoom(), static_cast<int>(viewState.getZoom() + getZoomLevelBias() + DISCRETE_ZOOM_LEVEL_BIAS));
-        if (getMinZoom() > tile.getZoom()) {
+        if (cullParams.minZoom > tile.getZoom()) {
             subDivide = true;
-        } else if (targetTileZoom <= tile.getZoom()) {
+        } else if (cullParams.targetTileZoom <= tile.getZoom()) {
             subDivide = false;
         }
         
         if (subDivide) {
             // The tile is too coarse, keep subdividing
             for (int n = 0; n < 4; n++) {
-                calculateVisibleTilesRecursive(cullState, tile.getChild(n), dataExtent);
+                calculateVisibleTilesRecursive(cullState, tile.getChild(n), cullParams);
             }
         } else {
             // Add the tile to visible tiles, sort by the distnace to the camera
@@ -490,12 +689,16 @@ namespace carto {
     }
     
     void TileLayer::findTiles(const std::vector<MapTile>& visTiles, bool preloadingTiles) {
+        std::vector<std::shared_ptr<FetchTaskBase> > existingTasks = _fetchingTiles.getTasks();
+        std::unordered_set<std::shared_ptr<FetchTaskBase> > existingTaskSet(existingTasks.begin(), existingTasks.end());
+
         for (const MapTile& visTile : visTiles) {
             int tileMask = (1 << visTile.getZoom()) - 1;
             MapTile tile(visTile.getX() & tileMask, visTile.getY() & tileMask, visTile.getZoom(), visTile.getFrameNr());
 
             // Check caches
             if (tileExists(tile, preloadingTiles) || tileExists(tile, !preloadingTiles)) {
+                _tileCacheHitCount++;
                 calculateDrawData(visTile, tile, preloadingTiles);
 
                 // Re-fetch invalid tile
@@ -504,6 +707,7 @@ namespace carto {
                 }
                 continue;
             }
+            _tileCacheMissCount++;
             
             // Build list of caches to use (based on tile substitution policy)
             std::vector<bool> preloadingCaches;
@@ -521,6 +725,7 @@ namespace carto {
             default:
                 break;
             }
+            bool substituted = false;
             for (bool preloadingCache : preloadingCaches) {
                 // Check for a tile with the last frame nr
                 MapTile prevFrameTile(tile.getX(), tile.getY(), tile.getZoom(), _lastFrameNr);
@@ -539,15 +744,83 @@ namespace carto {
                     }
                 }
                 if (foundSubstitute) {
+                    substituted = true;
                     break;
                 }
             }
+
+            // While zooming towards the predicted zoom level, the substituted intermediate zoom tiles are not fetched.
+            // They would be replaced soon, the tiles of the target zoom level are fetched instead
+            if (substituted && !preloadingTiles && _predictedTileZoom >= 0 && tile.getZoom() != _predictedTileZoom) {
+                continue;
+            }
     
             // Finally fetch the tile from source
             fetchTile(tile, preloadingTiles, false);
         }
+
+        // If the data source supports it, load the tiles of the new tasks with a single batch request.
+        // The batch task has higher priority than the fetch tasks, which will pick up the loaded data.
+        if (_tileThreadPool && _dataSource->isBatchLoadingSupported()) {
+            std::vector<std::shared_ptr<FetchTaskBase> > batchTasks;
+            std::vector<MapTile> batchTiles;
+            for (const std::shared_ptr<FetchTaskBase>& task : _fetchingTiles.getTasks()) {
+                if (existingTaskSet.find(task) != existingTaskSet.end() || task->getDataSourceTiles().empty()) {
+                    continue;
+                }
+                const MapTile& dataSourceTile = task->getDataSourceTiles().front();
+                if (hasRetainedTileData(dataSourceTile)) {
+                    continue;
+                }
+                if (std::find(batchTiles.begin(), batchTiles.end(), dataSourceTile) == batchTiles.end()) {
+                    batchTiles.push_back(dataSourceTile);
+                }
+                batchTasks.push_back(task);
+            }
+
+            if (static_cast<int>(batchTiles.size()) >= MIN_BATCH_LOAD_TILE_COUNT) {
+                auto batchLoadTask = std::make_shared<BatchLoadTask>(std::static_pointer_cast<TileLayer>(shared_from_this()), batchTiles);
+                for (const std::shared_ptr<FetchTaskBase>& task : batchTasks) {
+                    task->setBatchLoadTask(batchLoadTask);
+                }
+                _batchLoadTasks.push_back(batchLoadTask);
+                _tileThreadPool->execute(batchLoadTask, (preloadingTiles ? getUpdatePriority() + PRELOADING_PRIORITY_OFFSET : getUpdatePriority()) + 1, _tileLoadTaskGroup);
+            }
+        }
     }
     
+    bool TileLayer::hasRetainedTileData(const MapTile& dataSourceTile) const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        long long tileId = dataSourceTile.getTileId();
+        return _retainedTileDataCache.exists(tileId) && _retainedTileDataCache.valid(tileId);
+    }
+
+    bool TileLayer::readRetainedTileData(const MapTile& dataSourceTile, std::shared_ptr<TileData>& tileData) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        long long tileId = dataSourceTile.getTileId();
+        if (!_retainedTileDataCache.exists(tileId) || !_retainedTileDataCache.valid(tileId)) {
+            return false;
+        }
+        return _retainedTileDataCache.read(tileId, tileData);
+    }
+
+    void TileLayer::retainTileData(const MapTile& dataSourceTile, const std::shared_ptr<TileData>& tileData) {
+        // Only the tiles with actual unexpired data are retained
+        if (!tileData->getData() || tileData->isReplaceWithParent() || tileData->getMaxAge() == 0) {
+            return;
+        }
+
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        if (_retainedTileDataCache.capacity() == 0) {
+            return;
+        }
+        long long tileId = dataSourceTile.getTileId();
+        _retainedTileDataCache.put(tileId, tileData, tileData->getData()->size());
+        if (tileData->getMaxAge() > 0) {
+            _retainedTileDataCache.invalidate(tileId, std::chrono::steady_clock::now() + std::chrono::milliseconds(tileData->getMaxAge()));
+        }
+    }
+
     bool TileLayer::findParentTile(const MapTile& visTile, const MapTile& tile, int depth, bool preloadingCache, bool preloadingTile) {
         if (tile.getZoom() <= 0 || depth <= 0) {
             return false;
@@ -620,10 +893,84 @@ namespace carto {
         }
     }
 
+    TileLayer::BatchLoadTask::BatchLoadTask(const std::shared_ptr<TileLayer>& layer, const std::vector<MapTile>& dataSourceTiles) :
+        _layer(layer),
+        _dataSourceTiles(dataSourceTiles),
+        _skippedTiles(),
+        _tileDataMap(),
+        _started(false),
+        _finished(false),
+        _finishedCondition()
+    {
+    }
+
+    bool TileLayer::BatchLoadTask::getTileData(const MapTile& dataSourceTile, std::shared_ptr<TileData>& tileData) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (std::find(_dataSourceTiles.begin(), _dataSourceTiles.end(), dataSourceTile) == _dataSourceTiles.end()) {
+            return false;
+        }
+
+        // If the batch has not started yet, the caller loads the tile itself. Never wait for a task that may still be queued.
+        if (!_started) {
+            _skippedTiles.insert(dataSourceTile);
+            return false;
+        }
+
+        _finishedCondition.wait(lock, [this]() { return _finished; });
+
+        auto it = _tileDataMap.find(dataSourceTile);
+        if (it == _tileDataMap.end()) {
+            return false;
+        }
+        tileData = it->second;
+        return true;
+    }
+
+    void TileLayer::BatchLoadTask::run() {
+        std::shared_ptr<TileLayer> layer = _layer.lock();
+        if (!layer) {
+            return;
+        }
+
+        std::vector<MapTile> dataSourceTiles;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_canceled) {
+                return;
+            }
+            _started = true;
+
+            for (const MapTile& dataSourceTile : _dataSourceTiles) {
+                if (_skippedTiles.find(dataSourceTile) == _skippedTiles.end()) {
+                    dataSourceTiles.push_back(dataSourceTile);
+                }
+            }
+        }
+
+        std::unordered_map<MapTile, std::shared_ptr<TileData> > tileDataMap;
+        try {
+            std::vector<std::shared_ptr<TileData> > tileDatas = layer->_dataSource->loadTiles(dataSourceTiles);
+            for (std::size_t i = 0; i < std::min(dataSourceTiles.size(), tileDatas.size()); i++) {
+                tileDataMap[dataSourceTiles[i]] = tileDatas[i];
+            }
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("TileLayer::BatchLoadTask: Exception while loading tiles: %s", ex.what());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _tileDataMap = std::move(tileDataMap);
+            _finished = true;
+        }
+        _finishedCondition.notify_all();
+    }
+
     TileLayer::FetchTaskBase::FetchTaskBase(const std::shared_ptr<TileLayer>& layer, const MapTile& tile, bool preloadingTile) :
         _layer(layer),
         _tile(tile),
         _dataSourceTiles(),
+        _batchLoadTask(),
         _preloadingTile(preloadingTile),
         _started(false),
         _invalidated(false)
@@ -653,6 +1000,15 @@ namespace carto {
         std::lock_guard<std::mutex> lock(_mutex);
         _invalidated = true;
     }
+
+    const std::vector<MapTile>& TileLayer::FetchTaskBase::getDataSourceTiles() const {
+        return _dataSourceTiles;
+    }
+
+    void TileLayer::FetchTaskBase::setBatchLoadTask(const std::shared_ptr<BatchLoadTask>& batchLoadTask) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _batchLoadTask = batchLoadTask;
+    }
         
     void TileLayer::FetchTaskBase::cancel() {
         std::lock_guard<std::mutex> lock(_mutex);
@@ -670,38 +1026,73 @@ namespace carto {
         if (!layer) {
             return;
         }
+
+        Tracer::Span span("TileLayer::FetchTask::load");
+        span.setArg("tile", "%d/%d/%d", _tile.getZoom(), _tile.getX(), _tile.getY());
+        span.setArg("layer", "%p", static_cast<const void*>(layer.get()));
             
+        std::shared_ptr<BatchLoadTask> batchLoadTask;
         {
             std::lock_guard<std::mutex> lock(_mutex);
             if (_canceled) {
                 return;
             }
             _started = true;
+            batchLoadTask = _batchLoadTask;
         }
         
-        bool refresh = false;
+        // Load the tile data. This is the I/O bound stage of the task. Use the data from the batch request, if available
+        MapTile dataSourceTile;
+        std::shared_ptr<TileData> tileData;
         try {
-            refresh = loadTile(layer) && !_preloadingTile;
-            if (refresh) {
+            for (const MapTile& tile : _dataSourceTiles) {
+                // Tiles rebuilt after the surface was recreated are usually still retained, they are not fetched again
+                std::shared_ptr<TileData> data;
+                if (!layer->readRetainedTileData(tile, data)) {
+                    if (!batchLoadTask || !batchLoadTask->getTileData(tile, data)) {
+                        data = layer->_dataSource->loadTileCoalesced(tile);
+                    }
+                    if (data && !_preloadingTile) {
+                        layer->retainTileData(tile, data);
+                    }
+                }
+                if (!data) {
+                    break;
+                }
+                if (data->isReplaceWithParent()) {
+                    continue;
+                }
+                if (data->getData()) {
+                    dataSourceTile = tile;
+                    tileData = data;
+                }
+                break;
+            }
+
+            if (tileData && !_preloadingTile) {
                 loadUTFGridTile(layer);
             }
         }
         catch (const std::exception& ex) {
             Log::Errorf("TileLayer::FetchTaskBase: Exception while loading tile: %s", ex.what());
         }
-    
-        layer->_fetchingTiles.remove(_tile.getTileId());
 
-        if (refresh) {
-            std::shared_ptr<MapRenderer> mapRenderer;
-            {
-                std::lock_guard<std::recursive_mutex> lock(layer->_mutex);
-                mapRenderer = layer->_mapRenderer.lock();
-            }
-            if (mapRenderer) {
-                mapRenderer->layerChanged(layer->shared_from_this(), false);
-                mapRenderer->requestRedraw();
-            }
+        if (!tileData) {
+            finish(layer, false);
+            return;
+        }
+
+        // Decode the tile in the decoding thread pool, if available. Otherwise decode it in this thread
+        std::shared_ptr<CancelableThreadPool> tileDecodeThreadPool;
+        {
+            std::lock_guard<std::recursive_mutex> lock(layer->_mutex);
+            tileDecodeThreadPool = layer->_tileDecodeThreadPool;
+        }
+        if (tileDecodeThreadPool) {
+            auto task = std::make_shared<DecodeTask>(std::static_pointer_cast<FetchTaskBase>(shared_from_this()), dataSourceTile, tileData);
+            tileDecodeThreadPool->execute(task, _preloadingTile ? layer->getUpdatePriority() + PRELOADING_PRIORITY_OFFSET : layer->getUpdatePriority());
+        } else {
+            decode(layer, dataSourceTile, tileData);
         }
     }
     
@@ -724,7 +1115,7 @@ namespace carto {
 
         bool refresh = false;
         for (const MapTile& dataSourceTile : dataSourceTiles) {
-            std::shared_ptr<TileData> tileData = dataSource->loadTile(dataSourceTile);
+            std::shared_ptr<TileData> tileData = dataSource->loadTileCoalesced(dataSourceTile);
             if (!tileData) {
                 break;
             }
@@ -745,9 +1136,82 @@ namespace carto {
         return refresh;
     }
 
+    void TileLayer::FetchTaskBase::decode(const std::shared_ptr<TileLayer>& layer, const MapTile& dataSourceTile, const std::shared_ptr<TileData>& tileData) {
+        bool refresh = false;
+        try {
+            Tracer::Span span("TileLayer::FetchTask::decode");
+            span.setArg("tile", "%d/%d/%d", dataSourceTile.getZoom(), dataSourceTile.getX(), dataSourceTile.getY());
+            span.setArg("layer", "%p", static_cast<const void*>(layer.get()));
+            refresh = decodeTile(layer, dataSourceTile, tileData) && !_preloadingTile;
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("TileLayer::FetchTaskBase: Exception while decoding tile: %s", ex.what());
+        }
+
+        // Keep the tile caches of all layers within the global budget
+        TileCacheManager::GetInstance().trimCaches();
+
+        finish(layer, refresh);
+    }
+
+    void TileLayer::FetchTaskBase::finish(const std::shared_ptr<TileLayer>& layer, bool refresh) {
+        layer->_fetchingTiles.remove(_tile.getTileId());
+
+        if (refresh) {
+            std::shared_ptr<MapRenderer> mapRenderer;
+            {
+                std::lock_guard<std::recursive_mutex> lock(layer->_mutex);
+                mapRenderer = layer->_mapRenderer.lock();
+            }
+            if (mapRenderer) {
+                mapRenderer->layerChanged(layer->shared_from_this(), false);
+                mapRenderer->requestRedraw();
+            }
+        }
+    }
+
+    TileLayer::FetchTaskBase::DecodeTask::DecodeTask(const std::shared_ptr<FetchTaskBase>& fetchTask, const MapTile& dataSourceTile, const std::shared_ptr<TileData>& tileData) :
+        _fetchTask(fetchTask),
+        _dataSourceTile(dataSourceTile),
+        _tileData(tileData),
+        _started(false)
+    {
+    }
+
+    void TileLayer::FetchTaskBase::DecodeTask::cancel() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_started) {
+            _canceled = true;
+
+            // The fetch task is already started and can not be canceled, so mark it as finished
+            if (std::shared_ptr<TileLayer> layer = _fetchTask->_layer.lock()) {
+                layer->_fetchingTiles.remove(_fetchTask->_tile.getTileId());
+            }
+        }
+    }
+
+    void TileLayer::FetchTaskBase::DecodeTask::run() {
+        std::shared_ptr<TileLayer> layer = _fetchTask->_layer.lock();
+        if (!layer) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_canceled) {
+                return;
+            }
+            _started = true;
+        }
+
+        _fetchTask->decode(layer, _dataSourceTile, _tileData);
+    }
+
     const float TileLayer::DISCRETE_ZOOM_LEVEL_BIAS = 0.001f;
 
     const double TileLayer::PRELOADING_TILE_SCALE = 1.5;
     const float TileLayer::SUBDIVISION_THRESHOLD = Const::WORLD_SIZE;
+
+    const std::size_t TileLayer::DEFAULT_RETAINED_TILE_DATA_CACHE_CAPACITY = 4 * 1024 * 1024;
     
 }
@@ -11,15 +11,25 @@
 #include "core/MapBounds.h"
 #include "core/MapTile.h"
 #include "components/CancelableTask.h"
+#include "components/CancelableThreadPool.h"
 #include "components/DirectorPtr.h"
 #include "datasources/TileDataSource.h"
 #include "layers/Layer.h"
 #include "layers/components/FetchingTileTasks.h"
+#include "utils/Const.h"
 
+#include <array>
 #include <atomic>
+#include <condition_variable>
+#include <map>
+#include <tuple>
 #include <unordered_map>
+#include <unordered_set>
+
+#include <stdext/timed_lru_cache.h>
 
 namespace carto {
+    class CacheStatistics;
     class CancelableTask;
     class CullState;
     class TileRenderer;
@@ -102,6 +112,22 @@ namespace carto {
          * @param preloading The new preloading state of the layer.
          */
         void setPreloading(bool preloading);
+
+        /**
+         * Returns the state of the predictive preloading flag of this layer.
+         * @return True if predictive preloading is enabled.
+         */
+        bool isPredictivePreloading() const;
+        /**
+         * Sets the state of predictive preloading for this layer. If enabled, the tiles visible at the end of
+         * the current camera animation or kinetic pan/zoom are downloaded in advance, so that fewer tiles are missing when the camera stops.
+         * The number of preloaded tiles is limited when panning. When zooming to another tile zoom level, all the tiles of the target view are loaded
+         * first and tiles of the intermediate zoom levels are only loaded if no parent or child tile can be shown instead.
+         * This option works independently of the preloading option.
+         * The default is true.
+         * @param predictivePreloading The new predictive preloading state of the layer.
+         */
+        void setPredictivePreloading(bool predictivePreloading);
         
         /**
          * Returns the state of the synchronized refresh flag.
@@ -194,6 +220,39 @@ namespace carto {
          */
         void clearTileCaches(bool all);
 
+        /**
+         * Returns the usage statistics of the layer tile caches. The sizes and capacities include both visible
+         * and preloading caches. The lookups are counted when the visible tiles of the layer are updated.
+         * @return The statistics of the tile caches.
+         */
+        std::shared_ptr<CacheStatistics> getTileCacheStatistics() const;
+
+        /**
+         * Returns the capacity of the retained tile data cache.
+         * @return The capacity of the retained tile data cache in bytes.
+         */
+        std::size_t getRetainedTileDataCacheCapacity() const;
+        /**
+         * Sets the capacity of the retained tile data cache. The layer keeps the raw data of the recently loaded visible tiles
+         * in this cache, so that after the rendering surface is lost and recreated (for example, when the application is resumed)
+         * the tiles are rebuilt from memory instead of fetching them from the data source again. The default is 4MB.
+         * @param capacityInBytes The new capacity in bytes. 0 disables the cache.
+         */
+        void setRetainedTileDataCacheCapacity(std::size_t capacityInBytes);
+
+        /**
+         * Returns the maximum number of concurrent tile loading tasks of this layer.
+         * @return The maximum number of concurrent tile loading tasks. 0 means no limit.
+         */
+        int getMaxTileLoadConcurrency() const;
+        /**
+         * Sets the maximum number of concurrent tile loading tasks of this layer. The tile loading threads are shared by all layers,
+         * limiting slow layers (like large GDAL rasters or NML models) keeps threads available for the other layers.
+         * The default is 0 (no limit).
+         * @param maxConcurrency The new maximum number of concurrent tile loading tasks. 0 means no limit.
+         */
+        void setMaxTileLoadConcurrency(int maxConcurrency);
+
         /**
          * Returns the tile load listener.
          * @return The tile load listener.
@@ -224,11 +283,29 @@ namespace carto {
             explicit DataSourceListener(const std::shared_ptr<TileLayer>& layer);
             
             virtual void onTilesChanged(bool removeTiles);
+            virtual void onTilesChanged(const std::vector<MapTile>& tiles, bool removeTiles);
             
         private:
             std::weak_ptr<TileLayer> _layer;
         };
         
+        class BatchLoadTask : public CancelableTask {
+        public:
+            BatchLoadTask(const std::shared_ptr<TileLayer>& layer, const std::vector<MapTile>& dataSourceTiles);
+
+            bool getTileData(const MapTile& dataSourceTile, std::shared_ptr<TileData>& tileData);
+            virtual void run();
+
+        private:
+            std::weak_ptr<TileLayer> _layer;
+            std::vector<MapTile> _dataSourceTiles;
+            std::unordered_set<MapTile> _skippedTiles;
+            std::unordered_map<MapTile, std::shared_ptr<TileData> > _tileDataMap;
+            bool _started;
+            bool _finished;
+            std::condition_variable _finishedCondition;
+        };
+
         class FetchTaskBase : public CancelableTask {
         public:
             FetchTaskBase(const std::shared_ptr<TileLayer>& layer, const MapTile& tile, bool preloadingTile);
@@ -236,19 +313,38 @@ namespace carto {
             bool isPreloading() const;
             bool isInvalidated() const;
             void invalidate();
+            const std::vector<MapTile>& getDataSourceTiles() const;
+            void setBatchLoadTask(const std::shared_ptr<BatchLoadTask>& batchLoadTask);
             virtual void cancel();
             virtual void run();
             
         protected:
-            virtual bool loadTile(const std::shared_ptr<TileLayer>& layer) = 0;
+            virtual bool decodeTile(const std::shared_ptr<TileLayer>& layer, const MapTile& dataSourceTile, const std::shared_ptr<TileData>& tileData) = 0;
             
             std::weak_ptr<TileLayer> _layer;
             MapTile _tile; // original tile
             std::vector<MapTile> _dataSourceTiles; // tiles in valid datasource range, ordered to top
 
         private:
+            class DecodeTask : public CancelableTask {
+            public:
+                DecodeTask(const std::shared_ptr<FetchTaskBase>& fetchTask, const MapTile& dataSourceTile, const std::shared_ptr<TileData>& tileData);
+
+                virtual void cancel();
+                virtual void run();
+
+            private:
+                std::shared_ptr<FetchTaskBase> _fetchTask;
+                MapTile _dataSourceTile;
+                std::shared_ptr<TileData> _tileData;
+                bool _started;
+            };
+
             bool loadUTFGridTile(const std::shared_ptr<TileLayer>& layer);
+            void decode(const std::shared_ptr<TileLayer>& layer, const MapTile& dataSourceTile, const std::shared_ptr<TileData>& tileData);
+            void finish(const std::shared_ptr<TileLayer>& layer, bool refresh);
 
+            std::shared_ptr<BatchLoadTask> _batchLoadTask;
             bool _preloadingTile;
             bool _started;
             bool _invalidated;
@@ -258,6 +354,7 @@ namespace carto {
 
         virtual void setComponents(const std::shared_ptr<CancelableThreadPool>& envelopeThreadPool,
                                    const std::shared_ptr<CancelableThreadPool>& tileThreadPool,
+                                   const std::shared_ptr<CancelableThreadPool>& tileDecodeThreadPool,
                                    const std::weak_ptr<Options>& options,
                                    const std::weak_ptr<MapRenderer>& mapRenderer,
                                    const std::weak_ptr<TouchHandler>& touchHandler);
@@ -266,11 +363,18 @@ namespace carto {
 
         virtual void updateTileLoadListener();
 
+        virtual void releaseMemory(MemoryPressureLevel::MemoryPressureLevel level);
+
         virtual bool tileExists(const MapTile& tile, bool preloadingCache) const = 0;
         virtual bool tileValid(const MapTile& tile, bool preloadingCache) const = 0;
         virtual void fetchTile(const MapTile& tile, bool preloadingTile, bool invalidated) = 0;
         virtual void clearTiles(bool preloadingTiles) = 0;
         virtual void tilesChanged(bool removeTiles) = 0;
+        virtual void tilesChanged(const std::vector<MapTile>& dataSourceTiles, bool removeTiles);
+
+        virtual std::size_t getTileCacheSize(bool preloadingCache) const = 0;
+        virtual std::size_t getTileCacheCapacity(bool preloadingCache) const = 0;
+        virtual void trimTileCache(bool preloadingCache, std::size_t size) = 0;
 
         virtual void calculateDrawData(const MapTile& visTile, const MapTile& closestTile, bool preloadingTile) = 0;
         virtual void refreshDrawData(const std::shared_ptr<CullState>& cullState) = 0;
@@ -291,6 +395,7 @@ namespace carto {
         void setTileRenderer(const std::shared_ptr<TileRenderer>& renderer);
 
         static const float DISCRETE_ZOOM_LEVEL_BIAS;
+        static const int PRELOADING_PRIORITY_OFFSET = -2;
 
         std::atomic<bool> _synchronizedRefresh;
 
@@ -307,11 +412,13 @@ namespace carto {
         ThreadSafeDirectorPtr<UTFGridEventListener> _utfGridEventListener;
 
         FetchingTileTasks<FetchTaskBase> _fetchingTiles;
+        const std::shared_ptr<CancelableThreadPool::TaskGroup> _tileLoadTaskGroup;
         
         int _frameNr;
         int _lastFrameNr;
     
         bool _preloading;
+        bool _predictivePreloading;
         
         TileSubstitutionPolicy::TileSubstitutionPolicy _substitutionPolicy;
     
@@ -320,25 +427,62 @@ namespace carto {
         int _maxUnderzoomLevel;
     
     private:
+        friend class TileCacheManager;
+
+        struct TileBounds {
+            bool inDataExtent;
+            cglib::bbox3<double> tileBounds;
+            cglib::bbox3<double> preloadingBounds;
+        };
+
+        struct CullParameters {
+            MapBounds dataExtent;
+            int minZoom;
+            int targetTileZoom;
+            std::array<float, Const::MAX_SUPPORTED_ZOOM_LEVEL + 1> zoomDistanceScales; // 2^(zoom - zoomLevelBias) for each tile zoom level
+        };
+
+        typedef std::map<std::tuple<int, int, int>, TileBounds> TileBoundsMap;
+
         void calculateVisibleTiles(const std::shared_ptr<CullState>& cullState);
-        void calculateVisibleTilesRecursive(const std::shared_ptr<CullState>& cullState, const MapTile& mapTile, const MapBounds& dataExtent);
+        void calculateVisibleTilesRecursive(const std::shared_ptr<CullState>& cullState, const MapTile& mapTile, const CullParameters& cullParams);
+
+        bool hasRetainedTileData(const MapTile& dataSourceTile) const;
+        bool readRetainedTileData(const MapTile& dataSourceTile, std::shared_ptr<TileData>& tileData);
+        void retainTileData(const MapTile& dataSourceTile, const std::shared_ptr<TileData>& tileData);
 
         void sortTiles(std::vector<MapTile>& tiles, const ViewState& viewState, bool preloadingTiles);
         void findTiles(const std::vector<MapTile>& visTiles, bool preloadingTiles);
         bool findParentTile(const MapTile& visTile, const MapTile& tile, int depth, bool preloadingCache, bool preloadingTile);
         int findChildTiles(const MapTile& visTile, const MapTile& tile, int depth, bool preloadingCache, bool preloadingTile);
     
+        static const int MIN_BATCH_LOAD_TILE_COUNT = 2;
         static const int MAX_PARENT_SEARCH_DEPTH = 6;
         static const int MAX_CHILD_SEARCH_DEPTH = 3;
+        static const int PREDICTIVE_PRELOADING_TILE_BUDGET = 16;
         
         static const double PRELOADING_TILE_SCALE;
         static const float SUBDIVISION_THRESHOLD;
+
+        static const std::size_t DEFAULT_RETAINED_TILE_DATA_CACHE_CAPACITY;
         
         std::vector<MapTile> _visibleTiles;
         std::vector<MapTile> _preloadingTiles;
+        std::vector<MapTile> _predictedTiles;
+        int _predictedTileZoom; // target tile zoom level of the current zoom transition, -1 if the tile zoom level is not changing
+        std::vector<std::shared_ptr<BatchLoadTask> > _batchLoadTasks;
+        TileBoundsMap _tileBoundsMap;
+        TileBoundsMap _lastTileBoundsMap;
+        int _lastTileBoundsZoom;
+        MapBounds _lastTileBoundsDataExtent;
+        std::shared_ptr<vt::TileTransformer> _lastTileBoundsTransformer;
         std::unordered_map<MapTile, std::shared_ptr<UTFGridTile> > _utfGridTiles;
         std::shared_ptr<TileRenderer> _tileRenderer;
         std::shared_ptr<vt::TileTransformer> _tileTransformer;
+        cache::timed_lru_cache<long long, std::shared_ptr<TileData> > _retainedTileDataCache;
+
+        std::atomic<long long> _tileCacheHitCount;
+        std::atomic<long long> _tileCacheMissCount;
     };
     
 }
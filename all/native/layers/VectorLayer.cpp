@@ -35,8 +35,12 @@
 #include "vectorelements/Polygon.h"
 #include "vectorelements/Popup.h"
 #include "ui/VectorElementClickInfo.h"
+#include "utils/Const.h"
 #include "utils/Log.h"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <vector>
 
 namespace carto {
@@ -46,6 +50,7 @@ namespace carto {
         _dataSource(dataSource),
         _dataSourceListener(),
         _zBuffering(false),
+        _pointDecimationCellSize(0),
         _vectorElementEventListener(),
         _billboardRenderer(std::make_shared<BillboardRenderer>()),
         _geometryCollectionRenderer(std::make_shared<GeometryCollectionRenderer>()),
@@ -84,6 +89,15 @@ namespace carto {
         _zBuffering = enabled;
         refresh();
     }
+
+    float VectorLayer::getPointDecimationCellSize() const {
+        return _pointDecimationCellSize;
+    }
+
+    void VectorLayer::setPointDecimationCellSize(float px) {
+        _pointDecimationCellSize = std::max(0.0f, px);
+        refresh();
+    }
     
     bool VectorLayer::isUpdateInProgress() const {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
@@ -92,11 +106,12 @@ namespace carto {
     
     void VectorLayer::setComponents(const std::shared_ptr<CancelableThreadPool>& envelopeThreadPool,
                                     const std::shared_ptr<CancelableThreadPool>& tileThreadPool,
+                                    const std::shared_ptr<CancelableThreadPool>& tileDecodeThreadPool,
                                     const std::weak_ptr<Options>& options,
                                     const std::weak_ptr<MapRenderer>& mapRenderer,
                                     const std::weak_ptr<TouchHandler>& touchHandler)
     {
-        Layer::setComponents(envelopeThreadPool, tileThreadPool, options, mapRenderer, touchHandler);
+        Layer::setComponents(envelopeThreadPool, tileThreadPool, tileDecodeThreadPool, options, mapRenderer, touchHandler);
         _billboardRenderer->setLayer(std::static_pointer_cast<VectorLayer>(shared_from_this()));
         _polygon3DRenderer->setOptions(options);
         _nmlModelRenderer->setOptions(options);
@@ -314,8 +329,8 @@ namespace carto {
             }
             _billboardRenderer->addElement(label);
         } else if (const std::shared_ptr<Line>& line = std::dynamic_pointer_cast<Line>(element)) {
-            if (!line->getDrawData() || line->getDrawData()->isOffset()) {
-                line->setDrawData(std::make_shared<LineDrawData>(*line->getGeometry(), *line->getStyle(), *_dataSource->getProjection(), *projectionSurface));
+            if (!line->getDrawData() || line->getDrawData()->isOffset() || !isClipBoundsValid(line->getDrawData()->getClipBounds())) {
+                line->setDrawData(std::make_shared<LineDrawData>(*line->getGeometry(), *line->getStyle(), *_dataSource->getProjection(), *projectionSurface, calculateClipBounds()));
             }
             _lineRenderer->addElement(line);
         } else if (const std::shared_ptr<Marker>& marker = std::dynamic_pointer_cast<Marker>(element)) {
@@ -329,8 +344,8 @@ namespace carto {
             }
             _pointRenderer->addElement(point);
         } else if (const std::shared_ptr<Polygon>& polygon = std::dynamic_pointer_cast<Polygon>(element)) {
-            if (!polygon->getDrawData() || polygon->getDrawData()->isOffset()) {
-                polygon->setDrawData(std::make_shared<PolygonDrawData>(*polygon->getGeometry(), *polygon->getStyle(), *_dataSource->getProjection(), *projectionSurface));
+            if (!polygon->getDrawData() || polygon->getDrawData()->isOffset() || !isClipBoundsValid(polygon->getDrawData()->getClipBounds())) {
+                polygon->setDrawData(std::make_shared<PolygonDrawData>(*polygon->getGeometry(), *polygon->getStyle(), *_dataSource->getProjection(), *projectionSurface, calculateClipBounds()));
             }
             _polygonRenderer->addElement(polygon);
         } else if (const std::shared_ptr<GeometryCollection>& geomCollection = std::dynamic_pointer_cast<GeometryCollection>(element)) {
@@ -361,17 +376,14 @@ namespace carto {
     }
     
     bool VectorLayer::refreshRendererElements() {
-        bool billboardsChanged = _billboardRenderer->getElementCount() > 0; // if there are any billboards currently, assume they have changed (or removed)
-        _billboardRenderer->refreshElements();
+        // Only the changes of the visible billboard set require new placement, unchanged elements keep their draw datas and buffers
+        bool billboardsChanged = _billboardRenderer->refreshElements();
         _geometryCollectionRenderer->refreshElements();
         _lineRenderer->refreshElements();
         _pointRenderer->refreshElements();
         _polygonRenderer->refreshElements();
         _polygon3DRenderer->refreshElements();
         _nmlModelRenderer->refreshElements();
-        if (_billboardRenderer->getElementCount() > 0) {
-            billboardsChanged = true;
-        }
         return billboardsChanged;
     }
     
@@ -401,14 +413,20 @@ namespace carto {
             billboardsChanged = true;
         } else if (const std::shared_ptr<Line>& line = std::dynamic_pointer_cast<Line>(element)) {
             if (visible && !remove) {
-                line->setDrawData(std::make_shared<LineDrawData>(*line->getGeometry(), *line->getStyle(), *_dataSource->getProjection(), *projectionSurface));
+                line->setDrawData(std::make_shared<LineDrawData>(*line->getGeometry(), *line->getStyle(), *_dataSource->getProjection(), *projectionSurface, calculateClipBounds()));
                 _lineRenderer->updateElement(line);
             } else {
                 _lineRenderer->removeElement(line);
             }
         } else if (const std::shared_ptr<Marker>& marker = std::dynamic_pointer_cast<Marker>(element)) {
             if (visible && !remove) {
-                marker->setDrawData(std::make_shared<MarkerDrawData>(*marker, *marker->getStyle(), *_dataSource->getProjection(), *projectionSurface));
+                // If the style is unchanged (typically when the marker is moved or rotated), reuse the style dependent data
+                std::shared_ptr<MarkerDrawData> drawData = std::dynamic_pointer_cast<MarkerDrawData>(marker->getDrawData());
+                if (drawData && drawData->getStyle() && drawData->getStyle() == marker->getStyle()) {
+                    marker->setDrawData(std::make_shared<MarkerDrawData>(*drawData, *marker, *_dataSource->getProjection(), *projectionSurface));
+                } else {
+                    marker->setDrawData(std::make_shared<MarkerDrawData>(*marker, *marker->getStyle(), *_dataSource->getProjection(), *projectionSurface));
+                }
                 _billboardRenderer->updateElement(marker);
             } else {
                 _billboardRenderer->removeElement(marker);
@@ -423,7 +441,7 @@ namespace carto {
             }
         } else if (const std::shared_ptr<Polygon>& polygon = std::dynamic_pointer_cast<Polygon>(element)) {
             if (visible && !remove) {
-                polygon->setDrawData(std::make_shared<PolygonDrawData>(*polygon->getGeometry(), *polygon->getStyle(), *_dataSource->getProjection(), *projectionSurface));
+                polygon->setDrawData(std::make_shared<PolygonDrawData>(*polygon->getGeometry(), *polygon->getStyle(), *_dataSource->getProjection(), *projectionSurface, calculateClipBounds()));
                 _polygonRenderer->updateElement(polygon);
             } else {
                 _polygonRenderer->removeElement(polygon);
@@ -477,6 +495,47 @@ namespace carto {
     std::shared_ptr<CancelableTask> VectorLayer::createFetchTask(const std::shared_ptr<CullState>& cullState) {
         return std::make_shared<FetchTask>(std::static_pointer_cast<VectorLayer>(shared_from_this()));
     }
+
+    MapBounds VectorLayer::calculateClipBounds() const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        if (!_lastCullState) {
+            return VectorElementDrawData::GetInfiniteClipBounds();
+        }
+
+        // Do not clip if the view wraps around the world edge, as horizontally offset copies of the elements may be visible
+        const MapBounds& viewBounds = _lastCullState->getEnvelope().getBounds();
+        if (viewBounds.getMin().getX() < -Const::HALF_WORLD_SIZE || viewBounds.getMax().getX() > Const::HALF_WORLD_SIZE) {
+            return VectorElementDrawData::GetInfiniteClipBounds();
+        }
+
+        // Expand the view bounds, so that the tesselation can be reused while panning
+        MapVec expansion = viewBounds.getDelta() * CLIP_BOUNDS_EXPANSION;
+        double inf = std::numeric_limits<double>::infinity();
+        return MapBounds(MapPos(viewBounds.getMin().getX() - expansion.getX(), viewBounds.getMin().getY() - expansion.getY(), -inf),
+                         MapPos(viewBounds.getMax().getX() + expansion.getX(), viewBounds.getMax().getY() + expansion.getY(), inf));
+    }
+
+    bool VectorLayer::isClipBoundsValid(const MapBounds& clipBounds) const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        MapVec clipDelta = clipBounds.getDelta();
+        if (std::isinf(clipDelta.getX()) || std::isinf(clipDelta.getY())) {
+            return true;
+        }
+        if (!_lastCullState) {
+            return false;
+        }
+
+        // The tesselation must cover the whole view. Also the covered area should not be much larger than the view,
+        // otherwise the tesselation would stay as complex as before zooming in
+        const MapBounds& viewBounds = _lastCullState->getEnvelope().getBounds();
+        if (viewBounds.getMin().getX() < clipBounds.getMin().getX() || viewBounds.getMax().getX() > clipBounds.getMax().getX() ||
+            viewBounds.getMin().getY() < clipBounds.getMin().getY() || viewBounds.getMax().getY() > clipBounds.getMax().getY())
+        {
+            return false;
+        }
+        MapVec viewDelta = viewBounds.getDelta();
+        return clipDelta.getX() * clipDelta.getY() <= viewDelta.getX() * viewDelta.getY() * MAX_CLIP_AREA_RATIO;
+    }
     
     VectorLayer::DataSourceListener::DataSourceListener(const std::shared_ptr<VectorLayer>& layer) :
         _layer(layer)
@@ -619,6 +678,13 @@ namespace carto {
             return false;
         }
 
+        // Decimate points before creating draw datas, if requested
+        float cellSize = layer->_pointDecimationCellSize;
+        if (cellSize > 0) {
+            std::vector<std::shared_ptr<VectorElement> > elements = DecimatePoints(vectorData->getElements(), cullState->getViewState(), *layer->_dataSource->getProjection(), cellSize * cullState->getViewState().getDPToPX());
+            vectorData = std::make_shared<VectorData>(elements);
+        }
+
         std::lock_guard<std::recursive_mutex> lock(layer->_mutex);
         for (const std::shared_ptr<VectorElement>& element : vectorData->getElements()) {
             layer->addRendererElement(element);
@@ -626,4 +692,49 @@ namespace carto {
         return layer->refreshRendererElements();
     }
 
+    std::vector<std::shared_ptr<VectorElement> > VectorLayer::FetchTask::DecimatePoints(const std::vector<std::shared_ptr<VectorElement> >& elements, const ViewState& viewState, const Projection& projection, float cellSize) {
+        std::shared_ptr<ProjectionSurface> projectionSurface = viewState.getProjectionSurface();
+        if (!projectionSurface || viewState.getWidth() <= 0 || viewState.getHeight() <= 0) {
+            return elements;
+        }
+        const cglib::mat4x4<double>& mvpMat = viewState.getModelviewProjectionMat();
+        float halfWidth = viewState.getWidth() * 0.5f;
+        float halfHeight = viewState.getHeight() * 0.5f;
+
+        // Find the last (topmost) point of each screen cell. Other elements are always kept
+        std::vector<bool> keepElements(elements.size(), true);
+        std::unordered_map<long long, std::size_t> cellElementMap;
+        for (std::size_t i = 0; i < elements.size(); i++) {
+            auto point = std::dynamic_pointer_cast<Point>(elements[i]);
+            if (!point) {
+                continue;
+            }
+
+            cglib::vec3<double> screenPos = cglib::transform_point(projectionSurface->calculatePosition(projection.toInternal(point->getPos())), mvpMat);
+            double x = std::floor((screenPos(0) + 1) * halfWidth / cellSize);
+            double y = std::floor((1 - screenPos(1)) * halfHeight / cellSize);
+            if (!(std::abs(x) < (1 << 30) && std::abs(y) < (1 << 30))) {
+                continue;
+            }
+            long long cellKey = static_cast<long long>(x) * (1LL << 32) + static_cast<long long>(y);
+            auto it = cellElementMap.emplace(cellKey, i).first;
+            if (it->second != i) {
+                keepElements[it->second] = false;
+                it->second = i;
+            }
+        }
+
+        std::vector<std::shared_ptr<VectorElement> > decimatedElements;
+        decimatedElements.reserve(elements.size());
+        for (std::size_t i = 0; i < elements.size(); i++) {
+            if (keepElements[i]) {
+                decimatedElements.push_back(elements[i]);
+            }
+        }
+        return decimatedElements;
+    }
+
+    const double VectorLayer::CLIP_BOUNDS_EXPANSION = 1.0;
+    const double VectorLayer::MAX_CLIP_AREA_RATIO = 64.0;
+
 }
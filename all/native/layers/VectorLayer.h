@@ -18,6 +18,7 @@
 
 namespace carto {
     class CullState;
+    class Projection;
     class ViewState;
 
     class Billboard;
@@ -81,6 +82,19 @@ namespace carto {
          * @param enabled True if Z-buffering should be enabled.
          */
         void setZBuffering(bool enabled);
+
+        /**
+         * Returns the screen cell size used for point decimation (in device-independent pixels).
+         * @return The decimation cell size. 0 if decimation is disabled.
+         */
+        float getPointDecimationCellSize() const;
+        /**
+         * Sets the screen cell size used for point decimation (in device-independent pixels).
+         * If positive, the screen is divided into cells of given size and only the topmost point element of each cell is displayed.
+         * This bounds the number of displayed points by the screen resolution, which is useful for very dense point layers. By default decimation is disabled.
+         * @param px The decimation cell size. Use 0 to disable decimation.
+         */
+        void setPointDecimationCellSize(float px);
     
         virtual bool isUpdateInProgress() const;
         
@@ -112,10 +126,13 @@ namespace carto {
             bool _started;
             
             virtual bool loadElements(const std::shared_ptr<CullState>& cullState);
+
+            static std::vector<std::shared_ptr<VectorElement> > DecimatePoints(const std::vector<std::shared_ptr<VectorElement> >& elements, const ViewState& viewState, const Projection& projection, float cellSize);
         };
         
         virtual void setComponents(const std::shared_ptr<CancelableThreadPool>& envelopeThreadPool,
                                    const std::shared_ptr<CancelableThreadPool>& tileThreadPool,
+                                   const std::shared_ptr<CancelableThreadPool>& tileDecodeThreadPool,
                                    const std::weak_ptr<Options>& options,
                                    const std::weak_ptr<MapRenderer>& mapRenderer,
                                    const std::weak_ptr<TouchHandler>& touchHandler);
@@ -142,12 +159,19 @@ namespace carto {
 
         virtual std::shared_ptr<CancelableTask> createFetchTask(const std::shared_ptr<CullState>& cullState);
 
+        MapBounds calculateClipBounds() const;
+        bool isClipBoundsValid(const MapBounds& clipBounds) const;
+
         const DirectorPtr<VectorDataSource> _dataSource;
         std::shared_ptr<VectorDataSource::OnChangeListener> _dataSourceListener;
         
         std::atomic<bool> _zBuffering;
+        std::atomic<float> _pointDecimationCellSize;
 
     private:
+        static const double CLIP_BOUNDS_EXPANSION;
+        static const double MAX_CLIP_AREA_RATIO;
+
         ThreadSafeDirectorPtr<VectorElementEventListener> _vectorElementEventListener;
 
         std::shared_ptr<BillboardRenderer> _billboardRenderer;
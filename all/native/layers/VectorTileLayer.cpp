@@ -22,6 +22,10 @@
 #include <vt/Tile.h>
 #include <vt/TileTransformer.h>
 
+#include <zlib.h>
+
+#include <boost/lexical_cast.hpp>
+
 namespace carto {
 
     VectorTileLayer::VectorTileLayer(const std::shared_ptr<TileDataSource>& dataSource, const std::shared_ptr<VectorTileDecoder>& decoder) :
@@ -30,6 +34,9 @@ namespace carto {
         _vectorTileEventListener(),
         _labelRenderOrder(VectorTileRenderOrder::VECTOR_TILE_RENDER_ORDER_LAYER),
         _buildingRenderOrder(VectorTileRenderOrder::VECTOR_TILE_RENDER_ORDER_LAST),
+        _progressiveRendering(false),
+        _sharedRendererLayer(),
+        _sharedRendererClients(),
         _tileDecoder(decoder),
         _tileDecoderListener(),
         _backgroundColor(0, 0, 0, 0),
@@ -39,21 +46,32 @@ namespace carto {
         _skyBitmap(),
         _poleTiles(),
         _labelCullThreadPool(std::make_shared<CancelableThreadPool>()),
+        _labelCullRenderer(),
+        _labelCullViewState(),
+        _labelCullActive(false),
+        _labelCullModelviewProjectionMat(cglib::mat4x4<double>::identity()),
+        _labelCullTime(),
         _visibleTileIds(),
         _tempDrawDatas(),
         _visibleCache(DEFAULT_VISIBLE_CACHE_SIZE),
-        _preloadingCache(DEFAULT_PRELOADING_CACHE_SIZE)
+        _preloadingCache(DEFAULT_PRELOADING_CACHE_SIZE),
+        _decodedCache(DEFAULT_DECODED_CACHE_SIZE)
     {
         if (!decoder) {
             throw NullArgumentException("Null decoder");
         }
 
+        _labelCullThreadPool->setQoSClass(ThreadQoSClass::USER_INITIATED);
         _labelCullThreadPool->setPoolSize(1);
 
         setCullDelay(DEFAULT_CULL_DELAY);
     }
     
     VectorTileLayer::~VectorTileLayer() {
+        if (_sharedRendererLayer) {
+            _sharedRendererLayer->removeSharedRendererClient(this);
+        }
+
         _labelCullThreadPool->cancelAll();
         _labelCullThreadPool->deinit();
     }
@@ -72,6 +90,16 @@ namespace carto {
         _preloadingCache.resize(capacityInBytes);
     }
     
+    std::size_t VectorTileLayer::getDecodedTileCacheCapacity() const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        return _decodedCache.capacity();
+    }
+    
+    void VectorTileLayer::setDecodedTileCacheCapacity(std::size_t capacityInBytes) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        _decodedCache.resize(capacityInBytes);
+    }
+    
     VectorTileRenderOrder::VectorTileRenderOrder VectorTileLayer::getLabelRenderOrder() const {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
         return _labelRenderOrder;
@@ -98,6 +126,16 @@ namespace carto {
         redraw();
     }
     
+    bool VectorTileLayer::isProgressiveRendering() const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        return _progressiveRendering;
+    }
+
+    void VectorTileLayer::setProgressiveRendering(bool enabled) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        _progressiveRendering = enabled;
+    }
+    
     std::shared_ptr<VectorTileEventListener> VectorTileLayer::getVectorTileEventListener() const {
         return _vectorTileEventListener.get();
     }
@@ -106,6 +144,46 @@ namespace carto {
         _vectorTileEventListener.set(eventListener);
         tilesChanged(false); // we must reload the tiles, we do not keep full element information if this is not required
     }
+
+    std::shared_ptr<VectorTileLayer> VectorTileLayer::getSharedRendererLayer() const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        return _sharedRendererLayer;
+    }
+
+    void VectorTileLayer::setSharedRendererLayer(const std::shared_ptr<VectorTileLayer>& layer) {
+        if (layer) {
+            if (layer.get() == this) {
+                throw InvalidArgumentException("Layer can not share its own renderer");
+            }
+            if (layer->getSharedRendererLayer()) {
+                throw InvalidArgumentException("Layer is already drawn with a shared renderer");
+            }
+            if (hasSharedRendererClients()) {
+                throw InvalidArgumentException("Layer is used as a shared renderer layer");
+            }
+        }
+
+        std::shared_ptr<VectorTileLayer> oldLayer;
+        {
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            if (_sharedRendererLayer == layer) {
+                return;
+            }
+            oldLayer = _sharedRendererLayer;
+            _sharedRendererLayer = layer;
+        }
+
+        if (oldLayer) {
+            oldLayer->removeSharedRendererClient(this);
+        }
+        if (layer) {
+            layer->addSharedRendererClient(std::static_pointer_cast<VectorTileLayer>(shared_from_this()));
+        }
+
+        // Republish the tiles to the renderer now used for drawing this layer
+        refresh();
+        redraw();
+    }
     
     bool VectorTileLayer::tileExists(const MapTile& tile, bool preloadingCache) const {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
@@ -159,7 +237,7 @@ namespace carto {
             tileThreadPool = _tileThreadPool;
         }
         if (tileThreadPool) {
-            tileThreadPool->execute(task, preloadingTile ? getUpdatePriority() + PRELOADING_PRIORITY_OFFSET : getUpdatePriority());
+            tileThreadPool->execute(task, preloadingTile ? getUpdatePriority() + PRELOADING_PRIORITY_OFFSET : getUpdatePriority(), _tileLoadTaskGroup);
         }
     }
 
@@ -167,6 +245,7 @@ namespace carto {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
         if (preloadingTiles) {
             _preloadingCache.clear();
+            _decodedCache.clear();
         } else {
             _visibleCache.clear();
         }
@@ -191,6 +270,63 @@ namespace carto {
         refresh();
     }
 
+    void VectorTileLayer::tilesChanged(const std::vector<MapTile>& dataSourceTiles, bool removeTiles) {
+        std::unordered_set<long long> changedTileIds;
+        for (const MapTile& dataSourceTile : dataSourceTiles) {
+            changedTileIds.insert(MapTile(dataSourceTile.getX(), dataSourceTile.getY(), dataSourceTile.getZoom(), 0).getTileId());
+        }
+
+        // Invalidate current tasks that depend on the changed tiles
+        for (const std::shared_ptr<FetchTaskBase>& task : _fetchingTiles.getTasks()) {
+            for (const MapTile& dataSourceTile : task->getDataSourceTiles()) {
+                if (changedTileIds.find(dataSourceTile.getTileId()) != changedTileIds.end()) {
+                    task->invalidate();
+                    break;
+                }
+            }
+        }
+
+        // Flush or invalidate the cached tiles built from the changed tiles, keep the rest
+        {
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            auto now = std::chrono::steady_clock::now();
+            for (auto* cache : { &_visibleCache, &_preloadingCache }) {
+                for (long long tileId : cache->keys()) {
+                    TileInfo tileInfo;
+                    if (cache->peek(tileId, tileInfo) && changedTileIds.find(tileInfo.getDataSourceTileId()) != changedTileIds.end()) {
+                        if (removeTiles || cache == &_preloadingCache) {
+                            cache->remove(tileId);
+                        } else {
+                            cache->invalidate(tileId, now);
+                        }
+                    }
+                }
+            }
+        }
+        refresh();
+    }
+
+    std::size_t VectorTileLayer::getTileCacheSize(bool preloadingCache) const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        return preloadingCache ? _preloadingCache.size() : _visibleCache.size();
+    }
+
+    std::size_t VectorTileLayer::getTileCacheCapacity(bool preloadingCache) const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        return preloadingCache ? _preloadingCache.capacity() : _visibleCache.capacity();
+    }
+
+    void VectorTileLayer::trimTileCache(bool preloadingCache, std::size_t size) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        auto& cache = preloadingCache ? _preloadingCache : _visibleCache;
+        std::size_t capacity = cache.capacity();
+        if (size < capacity) {
+            // Shrinking the capacity drops the least recently used tiles
+            cache.resize(size);
+            cache.resize(capacity);
+        }
+    }
+
     long long VectorTileLayer::getTileId(const MapTile& mapTile) const {
         if (_useTileMapMode) {
             return MapTile(mapTile.getX(), mapTile.getY(), mapTile.getZoom(), 0).getTileId();
@@ -277,7 +413,9 @@ namespace carto {
         // Update renderer if needed, run culler
         bool refresh = false;
         bool cull = false;
-        if (std::shared_ptr<TileRenderer> tileRenderer = getTileRenderer()) {
+        int source = 0;
+        std::shared_ptr<TileRenderer> tileRenderer = getDrawTileRenderer(source);
+        if (tileRenderer) {
             if (!(_synchronizedRefresh && _fetchingTiles.getVisibleCount() > 0)) {
                 std::vector<std::shared_ptr<TileDrawData>> drawDatas = _tempDrawDatas;
 
@@ -295,21 +433,20 @@ namespace carto {
                     }
                 }
                 
-                if (tileRenderer->refreshTiles(drawDatas)) {
+                if (tileRenderer->refreshTiles(source, drawDatas)) {
                     refresh = true;
                     cull = true;
                 }
             }
         }
     
-        if (!_lastCullState || cullState->getViewState().getModelviewProjectionMat() != _lastCullState->getViewState().getModelviewProjectionMat()) {
+        // View changes are culled by the renderer owner, layers sharing the renderer only cull when their tiles change
+        if (source == 0 && (!_lastCullState || cullState->getViewState().getModelviewProjectionMat() != _lastCullState->getViewState().getModelviewProjectionMat())) {
             cull = true;
         }
     
-        if (cull) {
-            _labelCullThreadPool->cancelAll();
-            std::shared_ptr<CancelableTask> task = std::make_shared<LabelCullTask>(std::static_pointer_cast<VectorTileLayer>(shared_from_this()), getTileRenderer(), cullState->getViewState());
-            _labelCullThreadPool->execute(task);
+        if (cull && tileRenderer) {
+            requestLabelCull(tileRenderer, cullState->getViewStateSnapshot());
         }
     
         if (refresh) {
@@ -343,9 +480,13 @@ namespace carto {
         DirectorPtr<VectorTileEventListener> eventListener = _vectorTileEventListener;
 
         if (eventListener) {
+            // A shared renderer reports the hits of all layers drawn with it, the hits of other layers are silently skipped
+            int source = 0;
+            std::shared_ptr<TileRenderer> tileRenderer = getDrawTileRenderer(source);
+            bool sharedRenderer = (source > 0 || hasSharedRendererClients());
             for (int pass = 0; pass < 2; pass++) {
                 std::vector<std::tuple<vt::TileId, double, long long> > hitResults;
-                if (std::shared_ptr<TileRenderer> tileRenderer = getTileRenderer()) {
+                if (tileRenderer) {
                     if (pass == 0) {
                         tileRenderer->calculateRayIntersectedElements(ray, viewState, hitResults);
                     } else {
@@ -370,10 +511,10 @@ namespace carto {
                         if (std::shared_ptr<VectorTileFeature> tileFeature = _tileDecoder->decodeFeature(id, vtTileId, tileData, tileInfo.getTileBounds())) {
                             std::shared_ptr<Layer> thisLayer = std::const_pointer_cast<Layer>(shared_from_this());
                             results.push_back(RayIntersectedElement(tileFeature, thisLayer, ray(t), ray(t), pass > 0));
-                        } else {
+                        } else if (!sharedRenderer) {
                             Log::Warnf("VectorTileLayer::calculateRayIntersectedElements: Failed to decode feature %lld", id);
                         }
-                    } else {
+                    } else if (!sharedRenderer) {
                         Log::Warn("VectorTileLayer::calculateRayIntersectedElements: Failed to find tile data");
                     }
                 }
@@ -429,8 +570,23 @@ namespace carto {
     bool VectorTileLayer::onDrawFrame(float deltaSeconds, BillboardSorter& billboardSorter, StyleTextureCache& styleCache, const ViewState& viewState) {
         updateTileLoadListener();
 
+        // Layers sharing the renderer of another layer are drawn in the pass of that layer
+        if (getSharedRendererLayer()) {
+            return false;
+        }
+
         if (std::shared_ptr<MapRenderer> mapRenderer = _mapRenderer.lock()) {
             if (std::shared_ptr<TileRenderer> tileRenderer = getTileRenderer()) {
+                bool interactionMode = _vectorTileEventListener.get() ? true : false;
+                {
+                    std::lock_guard<std::recursive_mutex> lock(_mutex);
+                    for (const std::weak_ptr<VectorTileLayer>& clientWeak : _sharedRendererClients) {
+                        if (std::shared_ptr<VectorTileLayer> client = clientWeak.lock()) {
+                            interactionMode = interactionMode || client->_vectorTileEventListener.get();
+                        }
+                    }
+                }
+
                 float opacity = getOpacity();
 
                 if (opacity < 1.0f) {
@@ -439,7 +595,7 @@ namespace carto {
 
                 tileRenderer->setLabelOrder(static_cast<int>(getLabelRenderOrder()));
                 tileRenderer->setBuildingOrder(static_cast<int>(getBuildingRenderOrder()));
-                tileRenderer->setInteractionMode(_vectorTileEventListener.get() ? true : false);
+                tileRenderer->setInteractionMode(interactionMode);
                 tileRenderer->setSubTileBlending(false);
                 bool refresh = tileRenderer->onDrawFrame(deltaSeconds, viewState);
 
@@ -447,6 +603,19 @@ namespace carto {
                     mapRenderer->blendAndUnbindScreenFBO(opacity);
                 }
 
+                // Keep placing labels while the view changes continuously, instead of waiting for the delayed tile culling.
+                // The requests are rate limited and coalesced, so at most one label cull is running at any time
+                bool cull = false;
+                {
+                    std::lock_guard<std::recursive_mutex> lock(_mutex);
+                    if (viewState.getModelviewProjectionMat() != _labelCullModelviewProjectionMat) {
+                        cull = (std::chrono::steady_clock::now() - _labelCullTime >= std::chrono::milliseconds(LABEL_CULL_INTERVAL));
+                    }
+                }
+                if (cull) {
+                    requestLabelCull(tileRenderer, mapRenderer->getViewStateSnapshot());
+                }
+
                 return refresh;
             }
         }
@@ -454,6 +623,10 @@ namespace carto {
     }
         
     bool VectorTileLayer::onDrawFrame3D(float deltaSeconds, BillboardSorter& billboardSorter, StyleTextureCache& styleCache, const ViewState& viewState) {
+        if (getSharedRendererLayer()) {
+            return false;
+        }
+
         if (std::shared_ptr<TileRenderer> tileRenderer = getTileRenderer()) {
             return tileRenderer->onDrawFrame3D(deltaSeconds, viewState);
         }
@@ -553,78 +726,195 @@ namespace carto {
     {
     }
     
-    bool VectorTileLayer::FetchTask::loadTile(const std::shared_ptr<TileLayer>& tileLayer) {
+    bool VectorTileLayer::FetchTask::decodeTile(const std::shared_ptr<TileLayer>& tileLayer, const MapTile& dataSourceTile, const std::shared_ptr<TileData>& tileData) {
         auto layer = std::static_pointer_cast<VectorTileLayer>(tileLayer);
         
         bool refresh = false;
-        for (const MapTile& dataSourceTile : _dataSourceTiles) {
-            std::shared_ptr<TileData> tileData = layer->_dataSource->loadTile(dataSourceTile);
-            if (!tileData) {
-                break;
-            }
-            if (tileData->isReplaceWithParent()) {
-                continue;
+        vt::TileId vtTile(_tile.getZoom(), _tile.getX(), _tile.getY());
+        vt::TileId vtDataSourceTile(dataSourceTile.getZoom(), dataSourceTile.getX(), dataSourceTile.getY());
+        std::shared_ptr<vt::TileTransformer> tileTransformer = layer->getTileTransformer();
+        
+        // Try to reuse an earlier decoded tile, if the tile data and decoder state are the same
+        std::shared_ptr<VectorTileDecoder::TileMap> tileMap;
+        std::string decodedTileKey;
+        std::string stateKey = layer->_tileDecoder->getStateKey();
+        if (!stateKey.empty() && tileData->getData() && layer->getDecodedTileCacheCapacity() > 0) {
+            const std::shared_ptr<BinaryData>& data = tileData->getData();
+            uLong crc = crc32(0L, Z_NULL, 0);
+            if (!data->empty()) {
+                crc = crc32(crc, data->data(), static_cast<uInt>(data->size()));
             }
-            if (!tileData->getData()) {
-                break;
+            decodedTileKey = boost::lexical_cast<std::string>(_tile.getTileId()) + ":" + boost::lexical_cast<std::string>(dataSourceTile.getTileId()) + ":" + boost::lexical_cast<std::string>(data->size()) + ":" + boost::lexical_cast<std::string>(crc) + ":" + stateKey;
+
+            std::lock_guard<std::recursive_mutex> lock(layer->_mutex);
+            std::pair<std::shared_ptr<vt::TileTransformer>, std::shared_ptr<VectorTileDecoder::TileMap> > decodedTile;
+            if (layer->_decodedCache.read(decodedTileKey, decodedTile)) {
+                if (decodedTile.first == tileTransformer) {
+                    tileMap = decodedTile.second;
+                }
             }
-    
-            vt::TileId vtTile(_tile.getZoom(), _tile.getX(), _tile.getY());
-            vt::TileId vtDataSourceTile(dataSourceTile.getZoom(), dataSourceTile.getX(), dataSourceTile.getY());
-            std::shared_ptr<vt::TileTransformer> tileTransformer = layer->getTileTransformer();
-            std::shared_ptr<VectorTileDecoder::TileMap> tileMap = layer->_tileDecoder->decodeTile(vtDataSourceTile, vtTile, tileTransformer, tileData->getData());
-            if (tileMap) {
-                // Construct tile info - keep original data if interactivity is required
-                VectorTileLayer::TileInfo tileInfo(layer->calculateMapTileBounds(dataSourceTile.getFlipped()), layer->_vectorTileEventListener.get() ? tileData->getData() : std::shared_ptr<BinaryData>(), tileMap);
+        }
 
-                // Store tile to cache, unless invalidated
-                if (!isInvalidated()) {
-                    long long tileId = layer->getTileId(_tile);
+        // In progressive mode, decode only the base layers of visible tiles here. The rest of the layers are decoded later
+        bool progressive = false;
+        if (!tileMap) {
+            progressive = layer->isProgressiveRendering() && !isPreloading() && layer->_tileDecoder->isProgressiveDecodingSupported();
+            if (progressive) {
+                tileMap = layer->_tileDecoder->decodeTilePart(vtDataSourceTile, vtTile, tileTransformer, tileData->getData(), true);
+            } else {
+                tileMap = layer->_tileDecoder->decodeTile(vtDataSourceTile, vtTile, tileTransformer, tileData->getData());
+            
+                // Store the decoded tile, unless the decoder state changed while decoding
+                if (tileMap && !decodedTileKey.empty() && layer->_tileDecoder->getStateKey() == stateKey) {
+                    std::size_t size = EXTRA_TILE_FOOTPRINT;
+                    for (auto it = tileMap->begin(); it != tileMap->end(); it++) {
+                        size += it->second->getResidentSize();
+                    }
                     std::lock_guard<std::recursive_mutex> lock(layer->_mutex);
-                    if (layer->getTileTransformer() == tileTransformer) { // extra check that the tile is created with correct transformer. Otherwise simply drop it.
-                        if (isPreloading()) {
-                            layer->_preloadingCache.put(tileId, tileInfo, tileInfo.getSize());
-                            if (tileData->getMaxAge() >= 0) {
-                                layer->_preloadingCache.invalidate(tileId, std::chrono::steady_clock::now() + std::chrono::milliseconds(tileData->getMaxAge()));
-                            }
-                        } else {
-                            layer->_visibleCache.put(tileId, tileInfo, tileInfo.getSize());
-                            if (tileData->getMaxAge() >= 0) {
-                                layer->_visibleCache.invalidate(tileId, std::chrono::steady_clock::now() + std::chrono::milliseconds(tileData->getMaxAge()));
+                    layer->_decodedCache.put(decodedTileKey, std::make_pair(tileTransformer, tileMap), size);
+                }
+            }
+        }
+
+        if (tileMap) {
+            // Construct tile info - keep original data if interactivity is required
+            VectorTileLayer::TileInfo tileInfo(dataSourceTile.getTileId(), layer->calculateMapTileBounds(dataSourceTile.getFlipped()), layer->_vectorTileEventListener.get() ? tileData->getData() : std::shared_ptr<BinaryData>(), tileMap);
+
+            // Store tile to cache, unless invalidated
+            if (!isInvalidated()) {
+                long long tileId = layer->getTileId(_tile);
+                std::lock_guard<std::recursive_mutex> lock(layer->_mutex);
+                if (layer->getTileTransformer() == tileTransformer) { // extra check that the tile is created with correct transformer. Otherwise simply drop it.
+                    if (isPreloading()) {
+                        layer->_preloadingCache.put(tileId, tileInfo, tileInfo.getSize());
+                        if (tileData->getMaxAge() >= 0) {
+                            layer->_preloadingCache.invalidate(tileId, std::chrono::steady_clock::now() + std::chrono::milliseconds(tileData->getMaxAge()));
+                        }
+                    } else {
+                        layer->_visibleCache.put(tileId, tileInfo, tileInfo.getSize());
+                        if (tileData->getMaxAge() >= 0) {
+                            layer->_visibleCache.invalidate(tileId, std::chrono::steady_clock::now() + std::chrono::milliseconds(tileData->getMaxAge()));
+                        }
+
+                        // Complete the tile with a lower priority pass, so that base layers of other tiles are decoded first
+                        if (progressive) {
+                            std::shared_ptr<CancelableThreadPool> threadPool = (layer->_tileDecodeThreadPool ? layer->_tileDecodeThreadPool : layer->_tileThreadPool);
+                            if (threadPool) {
+                                auto task = std::make_shared<SecondaryDecodeTask>(layer, _tile, dataSourceTile, tileData, tileTransformer, stateKey, decodedTileKey, tileMap);
+                                threadPool->execute(task, layer->getUpdatePriority() + SECONDARY_DECODE_PRIORITY_OFFSET);
                             }
                         }
                     }
                 }
-                
-                // Debug tile performance issues
-                if (Log::IsShowDebug()) {
-                    int maxDrawCallCount = 0;
-                    for (auto it = tileMap->begin(); it != tileMap->end(); it++) {
-                        int drawCallCount = 0;
-                        for (const std::shared_ptr<vt::TileLayer>& vtLayer : it->second->getLayers()) {
-                            drawCallCount += static_cast<int>(vtLayer->getBitmaps().size() + vtLayer->getGeometries().size());
-                        }
-                        maxDrawCallCount = std::max(maxDrawCallCount, drawCallCount);
-                    }
-                    if (maxDrawCallCount >= 20) {
-                        Log::Debugf("VectorTileLayer::FetchTask: Tile requires %d draw calls", maxDrawCallCount);
+            }
+            
+            // Debug tile performance issues
+            if (Log::IsShowDebug()) {
+                int maxDrawCallCount = 0;
+                for (auto it = tileMap->begin(); it != tileMap->end(); it++) {
+                    int drawCallCount = 0;
+                    for (const std::shared_ptr<vt::TileLayer>& vtLayer : it->second->getLayers()) {
+                        drawCallCount += static_cast<int>(vtLayer->getBitmaps().size() + vtLayer->getGeometries().size());
                     }
+                    maxDrawCallCount = std::max(maxDrawCallCount, drawCallCount);
+                }
+                if (maxDrawCallCount >= 20) {
+                    Log::Debugf("VectorTileLayer::FetchTask: Tile requires %d draw calls", maxDrawCallCount);
                 }
-                
-                refresh = true; // NOTE: need to refresh even when invalidated
-            } else if (!tileData->getData()->empty()) {
-                Log::Error("VectorTileLayer::FetchTask: Failed to decode tile");
             }
-            break;
+            
+            refresh = true; // NOTE: need to refresh even when invalidated
+        } else if (!tileData->getData()->empty()) {
+            Log::Error("VectorTileLayer::FetchTask: Failed to decode tile");
         }
         
         return refresh;
     }
         
-    VectorTileLayer::LabelCullTask::LabelCullTask(const std::shared_ptr<VectorTileLayer>& layer, const std::shared_ptr<TileRenderer>& tileRenderer, const ViewState& viewState) :
+    VectorTileLayer::SecondaryDecodeTask::SecondaryDecodeTask(const std::shared_ptr<VectorTileLayer>& layer, const MapTile& tile, const MapTile& dataSourceTile, const std::shared_ptr<TileData>& tileData, const std::shared_ptr<vt::TileTransformer>& tileTransformer, const std::string& stateKey, const std::string& decodedTileKey, const std::shared_ptr<VectorTileDecoder::TileMap>& primaryTileMap) :
         _layer(layer),
-        _tileRenderer(tileRenderer),
-        _viewState(viewState)
+        _tile(tile),
+        _dataSourceTile(dataSourceTile),
+        _tileData(tileData),
+        _tileTransformer(tileTransformer),
+        _stateKey(stateKey),
+        _decodedTileKey(decodedTileKey),
+        _primaryTileMap(primaryTileMap),
+        _expirationTime(std::chrono::steady_clock::now() + std::chrono::milliseconds(std::max(0LL, tileData->getMaxAge())))
+    {
+    }
+
+    void VectorTileLayer::SecondaryDecodeTask::run() {
+        std::shared_ptr<VectorTileLayer> layer = _layer.lock();
+        if (!layer || isCanceled()) {
+            return;
+        }
+
+        // Skip the pass if the tile has been replaced or removed meanwhile or the decoder has changed
+        long long tileId = layer->getTileId(_tile);
+        auto isPrimaryTileCached = [&]() {
+            std::lock_guard<std::recursive_mutex> lock(layer->_mutex);
+            TileInfo tileInfo;
+            return layer->_visibleCache.peek(tileId, tileInfo) && tileInfo.getTileMap() == _primaryTileMap;
+        };
+        if (!isPrimaryTileCached() || layer->getTileTransformer() != _tileTransformer || layer->_tileDecoder->getStateKey() != _stateKey) {
+            return;
+        }
+
+        vt::TileId vtTile(_tile.getZoom(), _tile.getX(), _tile.getY());
+        vt::TileId vtDataSourceTile(_dataSourceTile.getZoom(), _dataSourceTile.getX(), _dataSourceTile.getY());
+        std::shared_ptr<VectorTileDecoder::TileMap> secondaryTileMap;
+        try {
+            secondaryTileMap = layer->_tileDecoder->decodeTilePart(vtDataSourceTile, vtTile, _tileTransformer, _tileData->getData(), false);
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("VectorTileLayer::SecondaryDecodeTask: Exception while decoding tile: %s", ex.what());
+        }
+        if (!secondaryTileMap) {
+            return;
+        }
+        std::shared_ptr<VectorTileDecoder::TileMap> tileMap = MergeTileMaps(*_primaryTileMap, *secondaryTileMap, vtTile);
+
+        {
+            std::lock_guard<std::recursive_mutex> lock(layer->_mutex);
+            if (layer->_tileDecoder->getStateKey() != _stateKey) {
+                return;
+            }
+
+            // Store the full tile for reuse
+            if (!_decodedTileKey.empty()) {
+                std::size_t size = EXTRA_TILE_FOOTPRINT;
+                for (auto it = tileMap->begin(); it != tileMap->end(); it++) {
+                    size += it->second->getResidentSize();
+                }
+                layer->_decodedCache.put(_decodedTileKey, std::make_pair(_tileTransformer, tileMap), size);
+            }
+
+            // Replace the primary tile, unless it was removed meanwhile
+            TileInfo tileInfo;
+            if (!layer->_visibleCache.peek(tileId, tileInfo) || tileInfo.getTileMap() != _primaryTileMap) {
+                return;
+            }
+            TileInfo fullTileInfo(tileInfo.getDataSourceTileId(), tileInfo.getTileBounds(), tileInfo.getTileData(), tileMap);
+            layer->_visibleCache.put(tileId, fullTileInfo, fullTileInfo.getSize());
+            if (_tileData->getMaxAge() >= 0) {
+                layer->_visibleCache.invalidate(tileId, _expirationTime);
+            }
+        }
+
+        std::shared_ptr<MapRenderer> mapRenderer;
+        {
+            std::lock_guard<std::recursive_mutex> lock(layer->_mutex);
+            mapRenderer = layer->_mapRenderer.lock();
+        }
+        if (mapRenderer) {
+            mapRenderer->layerChanged(layer->shared_from_this(), false);
+            mapRenderer->requestRedraw();
+        }
+    }
+        
+    VectorTileLayer::LabelCullTask::LabelCullTask(const std::shared_ptr<VectorTileLayer>& layer) :
+        _layer(layer)
     {
     }
         
@@ -637,11 +927,126 @@ namespace carto {
             return;
         }
     
-        if (std::shared_ptr<TileRenderer> tileRenderer = _tileRenderer.lock()) {
-            if (tileRenderer->cullLabels(_viewState)) {
-                layer->redraw();
+        // Process the requests until there are no new ones. Each finished cull is shown immediately,
+        // so the labels follow the view progressively while it changes
+        while (true) {
+            std::shared_ptr<TileRenderer> tileRenderer;
+            std::shared_ptr<const ViewState> viewState;
+            {
+                std::lock_guard<std::recursive_mutex> lock(layer->_mutex);
+                if (!layer->_labelCullViewState) {
+                    layer->_labelCullActive = false;
+                    return;
+                }
+                tileRenderer = layer->_labelCullRenderer.lock();
+                std::swap(viewState, layer->_labelCullViewState);
+            }
+
+            if (tileRenderer) {
+                if (tileRenderer->cullLabels(*viewState)) {
+                    layer->redraw();
+                }
+            }
+        }
+    }
+
+    void VectorTileLayer::requestLabelCull(const std::shared_ptr<TileRenderer>& tileRenderer, const std::shared_ptr<const ViewState>& viewState) {
+        // Labels of layers sharing a renderer are placed together in the pipeline of the renderer owner,
+        // so that they are culled against each other in a single pass instead of once per layer
+        if (std::shared_ptr<VectorTileLayer> rendererLayer = getSharedRendererLayer()) {
+            rendererLayer->requestLabelCull(tileRenderer, viewState);
+            return;
+        }
+
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+        // Replace the pending request, the running task picks up the latest one when it finishes
+        _labelCullRenderer = tileRenderer;
+        _labelCullViewState = viewState;
+        _labelCullModelviewProjectionMat = viewState->getModelviewProjectionMat();
+        _labelCullTime = std::chrono::steady_clock::now();
+        if (!_labelCullActive) {
+            _labelCullActive = true;
+            _labelCullThreadPool->execute(std::make_shared<LabelCullTask>(std::static_pointer_cast<VectorTileLayer>(shared_from_this())));
+        }
+    }
+
+    std::shared_ptr<TileRenderer> VectorTileLayer::getDrawTileRenderer(int& source) const {
+        source = 0;
+        if (std::shared_ptr<VectorTileLayer> rendererLayer = getSharedRendererLayer()) {
+            source = rendererLayer->getSharedRendererSource(this);
+            if (source < 0) {
+                return std::shared_ptr<TileRenderer>();
+            }
+            return rendererLayer->getTileRenderer();
+        }
+        return getTileRenderer();
+    }
+
+    int VectorTileLayer::getSharedRendererSource(const VectorTileLayer* layer) const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        for (std::size_t i = 0; i < _sharedRendererClients.size(); i++) {
+            if (_sharedRendererClients[i].lock().get() == layer) {
+                return static_cast<int>(i) + 1;
+            }
+        }
+        return -1;
+    }
+
+    bool VectorTileLayer::hasSharedRendererClients() const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        return !_sharedRendererClients.empty();
+    }
+
+    void VectorTileLayer::addSharedRendererClient(const std::shared_ptr<VectorTileLayer>& layer) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        _sharedRendererClients.push_back(layer);
+    }
+
+    void VectorTileLayer::removeSharedRendererClient(const VectorTileLayer* layer) {
+        std::vector<std::shared_ptr<VectorTileLayer> > clients;
+        {
+            // NOTE: the client may be called from its destructor, in that case its weak pointer has already expired
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            std::vector<std::weak_ptr<VectorTileLayer> > remainingClients;
+            for (const std::weak_ptr<VectorTileLayer>& clientWeak : _sharedRendererClients) {
+                if (std::shared_ptr<VectorTileLayer> client = clientWeak.lock()) {
+                    if (client.get() != layer) {
+                        remainingClients.push_back(client);
+                        clients.push_back(client);
+                    }
+                }
+            }
+            std::swap(_sharedRendererClients, remainingClients);
+        }
+
+        // The sources of the remaining clients are renumbered, drop all client tiles and let the clients republish them
+        if (std::shared_ptr<TileRenderer> tileRenderer = getTileRenderer()) {
+            tileRenderer->resetTileSources();
+        }
+        for (const std::shared_ptr<VectorTileLayer>& client : clients) {
+            client->refresh();
+        }
+        redraw();
+    }
+
+    std::shared_ptr<VectorTileDecoder::TileMap> VectorTileLayer::MergeTileMaps(const VectorTileDecoder::TileMap& primaryTileMap, const VectorTileDecoder::TileMap& secondaryTileMap, const vt::TileId& targetTile) {
+        auto tileMap = std::make_shared<VectorTileDecoder::TileMap>(primaryTileMap);
+        for (auto it = secondaryTileMap.begin(); it != secondaryTileMap.end(); it++) {
+            auto primaryIt = primaryTileMap.find(it->first);
+            if (primaryIt == primaryTileMap.end()) {
+                (*tileMap)[it->first] = it->second;
+                continue;
+            }
+
+            std::vector<std::shared_ptr<vt::TileLayer> > tileLayers = primaryIt->second->getLayers();
+            for (const std::shared_ptr<vt::TileLayer>& tileLayer : it->second->getLayers()) {
+                int layerIdx = SECONDARY_LAYER_INDEX_OFFSET + tileLayer->getLayerIndex();
+                tileLayers.push_back(std::make_shared<vt::TileLayer>(layerIdx, tileLayer->getCompOp(), tileLayer->getOpacityFunc(), tileLayer->getBitmaps(), tileLayer->getGeometries(), tileLayer->getLabels()));
             }
+            (*tileMap)[it->first] = std::make_shared<vt::Tile>(targetTile, primaryIt->second->getTileSize(), primaryIt->second->getBackground(), tileLayers);
         }
+        return tileMap;
     }
 
     std::size_t VectorTileLayer::TileInfo::getSize() const {
@@ -15,8 +15,11 @@
 #include "layers/TileLayer.h"
 #include "vectortiles/VectorTileDecoder.h"
 
+#include <chrono>
 #include <memory>
 #include <map>
+#include <string>
+#include <vector>
 
 #include <stdext/timed_lru_cache.h>
 
@@ -25,6 +28,7 @@ namespace carto {
     class VectorTileEventListener;
     namespace vt {
         class Tile;
+        class TileTransformer;
     }
         
     namespace VectorTileRenderOrder {
@@ -82,6 +86,20 @@ namespace carto {
          * @param capacityInBytes The new tile bitmap cache capacity in bytes.
          */
         void setTileCacheCapacity(std::size_t capacityInBytes);
+
+        /**
+         * Returns the decoded tile cache capacity.
+         * @return The decoded tile cache capacity in bytes.
+         */
+        std::size_t getDecodedTileCacheCapacity() const;
+        /**
+         * Sets the decoded tile cache capacity. Decoded tile cache keeps recently decoded tiles keyed by the tile data
+         * and the decoder state, so that tiles evicted from the tile cache can be reused without parsing and tessellating
+         * the tile data again when the same area is revisited. Zero disables the cache.
+         * The default is 32MB.
+         * @param capacityInBytes The new decoded tile cache capacity in bytes.
+         */
+        void setDecodedTileCacheCapacity(std::size_t capacityInBytes);
         
         /**
          * Returns the current display order of the labels.
@@ -105,6 +123,20 @@ namespace carto {
          */
         void setBuildingRenderOrder(VectorTileRenderOrder::VectorTileRenderOrder renderOrder);
     
+        /**
+         * Returns true if progressive rendering of the tiles is enabled.
+         * @return True if progressive rendering is enabled.
+         */
+        bool isProgressiveRendering() const;
+        /**
+         * Sets the progressive rendering mode. In progressive mode visible tiles are first shown with the base layers of the style
+         * and the remaining layers (usually labels and 3D content) are decoded later in a lower priority pass.
+         * This gives faster first display of the map, especially when many tiles are loaded at once. The mode has effect only
+         * if the tile decoder supports progressive decoding. Progressive rendering is disabled by default.
+         * @param enabled True if progressive rendering should be enabled.
+         */
+        void setProgressiveRendering(bool enabled);
+
         /**
          * Returns the vector tile event listener.
          * @return The vector tile event listener.
@@ -115,6 +147,23 @@ namespace carto {
          * @param eventListener The vector tile event listener.
          */
         void setVectorTileEventListener(const std::shared_ptr<VectorTileEventListener>& eventListener);
+
+        /**
+         * Returns the layer whose renderer draws the tiles of this layer.
+         * @return The layer whose renderer draws the tiles of this layer, or null if this layer is drawn with its own renderer.
+         */
+        std::shared_ptr<VectorTileLayer> getSharedRendererLayer() const;
+        /**
+         * Sets the layer whose renderer draws the tiles of this layer. The tiles of both layers are merged and
+         * drawn in a single pass of the given layer, the style layers of this layer are drawn after the style layers of the
+         * given layer, in the order the layers were attached. This reduces the per-frame tile setup and label processing when
+         * stacking layers like a base map, labels and 3D buildings. The labels of all layers sharing the renderer are placed in
+         * a single pass, so labels of different layers do not overlap. The layers must use the same tiling, the opacity and render order
+         * settings of this layer are ignored while the renderer is shared. The layer should be detached before it is removed from the map.
+         * @param layer The layer whose renderer should be used. Null resets this layer to use its own renderer.
+         * @throws std::invalid_argument If the given layer is this layer itself or is already drawn with a shared renderer, or if this layer is used as a shared renderer layer.
+         */
+        void setSharedRendererLayer(const std::shared_ptr<VectorTileLayer>& layer);
     
     protected:
         virtual bool tileExists(const MapTile& mapTile, bool preloadingCache) const;
@@ -122,6 +171,11 @@ namespace carto {
         virtual void fetchTile(const MapTile& mapTile, bool preloadingTile, bool invalidated);
         virtual void clearTiles(bool preloadingTiles);
         virtual void tilesChanged(bool removeTiles);
+        virtual void tilesChanged(const std::vector<MapTile>& dataSourceTiles, bool removeTiles);
+
+        virtual std::size_t getTileCacheSize(bool preloadingCache) const;
+        virtual std::size_t getTileCacheCapacity(bool preloadingCache) const;
+        virtual void trimTileCache(bool preloadingCache, std::size_t size);
 
         virtual long long getTileId(const MapTile& mapTile) const;
         virtual std::shared_ptr<VectorTileDecoder::TileMap> getTileMap(long long tileId) const;
@@ -169,27 +223,44 @@ namespace carto {
             FetchTask(const std::shared_ptr<VectorTileLayer>& layer, const MapTile& tile, bool preloadingTile);
             
         protected:
-            virtual bool loadTile(const std::shared_ptr<TileLayer>& tileLayer);
+            virtual bool decodeTile(const std::shared_ptr<TileLayer>& tileLayer, const MapTile& dataSourceTile, const std::shared_ptr<TileData>& tileData);
         };
         
+        class SecondaryDecodeTask : public CancelableTask {
+        public:
+            SecondaryDecodeTask(const std::shared_ptr<VectorTileLayer>& layer, const MapTile& tile, const MapTile& dataSourceTile, const std::shared_ptr<TileData>& tileData, const std::shared_ptr<vt::TileTransformer>& tileTransformer, const std::string& stateKey, const std::string& decodedTileKey, const std::shared_ptr<VectorTileDecoder::TileMap>& primaryTileMap);
+
+            virtual void run();
+
+        private:
+            std::weak_ptr<VectorTileLayer> _layer;
+            MapTile _tile;
+            MapTile _dataSourceTile;
+            std::shared_ptr<TileData> _tileData;
+            std::shared_ptr<vt::TileTransformer> _tileTransformer;
+            std::string _stateKey;
+            std::string _decodedTileKey;
+            std::shared_ptr<VectorTileDecoder::TileMap> _primaryTileMap;
+            std::chrono::steady_clock::time_point _expirationTime;
+        };
+
         class LabelCullTask : public CancelableTask {
         public:
-            LabelCullTask(const std::shared_ptr<VectorTileLayer>& layer, const std::shared_ptr<TileRenderer>& tileRenderer, const ViewState& viewState);
+            explicit LabelCullTask(const std::shared_ptr<VectorTileLayer>& layer);
             
             virtual void cancel();
             virtual void run();
     
         private:
             std::weak_ptr<VectorTileLayer> _layer;
-            std::weak_ptr<TileRenderer> _tileRenderer;
-            ViewState _viewState;
         };
 
         class TileInfo {
         public:
-            TileInfo() : _tileBounds(), _tileData(), _tileMap() { }
-            TileInfo(const MapBounds& tileBounds, const std::shared_ptr<BinaryData>& tileData, const std::shared_ptr<VectorTileDecoder::TileMap>& tileMap) : _tileBounds(tileBounds), _tileData(tileData), _tileMap(tileMap) { }
+            TileInfo() : _dataSourceTileId(-1), _tileBounds(), _tileData(), _tileMap() { }
+            TileInfo(long long dataSourceTileId, const MapBounds& tileBounds, const std::shared_ptr<BinaryData>& tileData, const std::shared_ptr<VectorTileDecoder::TileMap>& tileMap) : _dataSourceTileId(dataSourceTileId), _tileBounds(tileBounds), _tileData(tileData), _tileMap(tileMap) { }
 
+            long long getDataSourceTileId() const { return _dataSourceTileId; }
             const MapBounds& getTileBounds() const { return _tileBounds; }
             const std::shared_ptr<BinaryData>& getTileData() const { return _tileData; }
             const std::shared_ptr<VectorTileDecoder::TileMap>& getTileMap() const { return _tileMap; }
@@ -197,23 +268,41 @@ namespace carto {
             std::size_t getSize() const;
 
         private:
+            long long _dataSourceTileId; // id of the data source tile the tile was built from
             MapBounds _tileBounds;
             std::shared_ptr<BinaryData> _tileData;
             std::shared_ptr<VectorTileDecoder::TileMap> _tileMap;
         };
 
+        void requestLabelCull(const std::shared_ptr<TileRenderer>& tileRenderer, const std::shared_ptr<const ViewState>& viewState);
+
+        std::shared_ptr<TileRenderer> getDrawTileRenderer(int& source) const;
+        int getSharedRendererSource(const VectorTileLayer* layer) const;
+        bool hasSharedRendererClients() const;
+        void addSharedRendererClient(const std::shared_ptr<VectorTileLayer>& layer);
+        void removeSharedRendererClient(const VectorTileLayer* layer);
+
+        static std::shared_ptr<VectorTileDecoder::TileMap> MergeTileMaps(const VectorTileDecoder::TileMap& primaryTileMap, const VectorTileDecoder::TileMap& secondaryTileMap, const vt::TileId& targetTile);
+
         static const int BACKGROUND_BLOCK_SIZE = 16;
         static const int BACKGROUND_BLOCK_COUNT = 16;
         static const int DEFAULT_CULL_DELAY = 200;
-        static const int PRELOADING_PRIORITY_OFFSET = -2;
+        static const int LABEL_CULL_INTERVAL = 50; // in milliseconds
         static const int EXTRA_TILE_FOOTPRINT = 4096;
         static const int DEFAULT_VISIBLE_CACHE_SIZE = 512 * 1024 * 1024; // NOTE: the limit should never be reached in normal cases
         static const int DEFAULT_PRELOADING_CACHE_SIZE = 10 * 1024 * 1024;
+        static const int DEFAULT_DECODED_CACHE_SIZE = 32 * 1024 * 1024;
+        static const int SECONDARY_DECODE_PRIORITY_OFFSET = -1;
+        static const int SECONDARY_LAYER_INDEX_OFFSET = 1 << 20; // added to the layer indices of the secondary tile parts, must stay below TileRenderer source stride
         
         ThreadSafeDirectorPtr<VectorTileEventListener> _vectorTileEventListener;
 
         VectorTileRenderOrder::VectorTileRenderOrder _labelRenderOrder;
         VectorTileRenderOrder::VectorTileRenderOrder _buildingRenderOrder;
+        bool _progressiveRendering;
+
+        std::shared_ptr<VectorTileLayer> _sharedRendererLayer;
+        std::vector<std::weak_ptr<VectorTileLayer> > _sharedRendererClients; // in the source order of the shared renderer
     
         const std::shared_ptr<VectorTileDecoder> _tileDecoder;
         std::shared_ptr<TileDecoderListener> _tileDecoderListener;
@@ -226,12 +315,18 @@ namespace carto {
         mutable std::shared_ptr<vt::Tile> _poleTiles[2];
 
         std::shared_ptr<CancelableThreadPool> _labelCullThreadPool;
+        std::weak_ptr<TileRenderer> _labelCullRenderer;
+        std::shared_ptr<const ViewState> _labelCullViewState; // latest requested view, null if the pending request has been taken
+        bool _labelCullActive;
+        cglib::mat4x4<double> _labelCullModelviewProjectionMat;
+        std::chrono::steady_clock::time_point _labelCullTime;
 
         std::vector<long long> _visibleTileIds;
         std::vector<std::shared_ptr<TileDrawData> > _tempDrawDatas;
 
         cache::timed_lru_cache<long long, TileInfo> _visibleCache;
         cache::timed_lru_cache<long long, TileInfo> _preloadingCache;
+        cache::timed_lru_cache<std::string, std::pair<std::shared_ptr<vt::TileTransformer>, std::shared_ptr<VectorTileDecoder::TileMap> > > _decodedCache; // keyed by tile data hash, decoder state and tile ids
     };
     
 }
@@ -9,6 +9,10 @@
 
 #include <utf8.h>
 
+#include <algorithm>
+#include <iterator>
+#include <limits>
+
 namespace {
 
     carto::Variant rapidJSONToVariant(const rapidjson::Value& value) {
@@ -48,56 +52,124 @@ namespace {
 
 namespace carto {
 
+    UTFGridTile::UTFGridTile(const std::shared_ptr<BinaryData>& tileData) :
+        _tileData(tileData),
+        _gridDecoded(false),
+        _keys(),
+        _data(),
+        _keyIds(),
+        _xSize(0),
+        _ySize(0),
+        _mutex()
+    {
+    }
+
+    std::string UTFGridTile::getKey(int keyId) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!decodeGrid()) {
+            return std::string();
+        }
+        return keyId >= 0 && keyId < static_cast<int>(_keys.size()) ? _keys[keyId] : std::string();
+    }
+
+    Variant UTFGridTile::getData(const std::string& key) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _data.find(key);
+        if (it != _data.end()) {
+            return it->second;
+        }
+
+        // Parse the JSON again and convert only the element of the given key. Data queries happen only on clicks, so this is cheaper than keeping all the data decoded
+        Variant value;
+        std::string json(reinterpret_cast<const char*>(_tileData->data()), _tileData->size());
+        rapidjson::Document doc;
+        if (doc.Parse<rapidjson::kParseDefaultFlags>(json.c_str()).HasParseError()) {
+            Log::Error("UTFGridTile::getData: Failed to parse JSON");
+        } else {
+            rapidjson::Value::ConstMemberIterator dataIt = doc.FindMember("data");
+            if (dataIt != doc.MemberEnd() && dataIt->value.IsObject()) {
+                rapidjson::Value::ConstMemberIterator valueIt = dataIt->value.FindMember(key.c_str());
+                if (valueIt != dataIt->value.MemberEnd()) {
+                    value = rapidJSONToVariant(valueIt->value);
+                }
+            }
+        }
+        _data[key] = value;
+        return value;
+    }
+
+    int UTFGridTile::getXSize() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        decodeGrid();
+        return _xSize;
+    }
+
+    int UTFGridTile::getYSize() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        decodeGrid();
+        return _ySize;
+    }
+
+    int UTFGridTile::getKeyId(int x, int y) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!decodeGrid()) {
+            return 0;
+        }
+        return x >= 0 && y >= 0 && x < _xSize && y < _ySize ? _keyIds[y * _xSize + x] : 0;
+    }
+
     std::shared_ptr<UTFGridTile> UTFGridTile::DecodeUTFTile(const std::shared_ptr<BinaryData>& tileData) {
         if (!tileData) {
             Log::Error("UTFGridTile::DecodeUTFTile: Null tile data");
             return std::shared_ptr<UTFGridTile>();
         }
 
-        std::string json(reinterpret_cast<const char*>(tileData->data()), tileData->size());
+        // The actual decoding is deferred until the tile is queried
+        return std::make_shared<UTFGridTile>(tileData);
+    }
+
+    bool UTFGridTile::decodeGrid() const {
+        if (_gridDecoded) {
+            return !_keys.empty();
+        }
+        _gridDecoded = true;
+
+        std::string json(reinterpret_cast<const char*>(_tileData->data()), _tileData->size());
         rapidjson::Document doc;
         if (doc.Parse<rapidjson::kParseDefaultFlags>(json.c_str()).HasParseError()) {
-            Log::Error("UTFGridTile::DecodeUTFTile: Failed to parse JSON");
-            return std::shared_ptr<UTFGridTile>();
+            Log::Error("UTFGridTile::decodeGrid: Failed to parse JSON");
+            return false;
+        }
+        if (!doc.IsObject() || !doc.HasMember("keys") || !doc["keys"].IsArray() || !doc.HasMember("grid") || !doc["grid"].IsArray()) {
+            Log::Error("UTFGridTile::decodeGrid: Missing keys or grid");
+            return false;
         }
 
         std::vector<std::string> keys;
         for (unsigned int i = 0; i < doc["keys"].Size(); i++) {
-            keys.push_back(doc["keys"][i].GetString());
-        }
-
-        std::map<std::string, Variant> data;
-        if (doc.FindMember("data") != doc.MemberEnd()) {
-            for (rapidjson::Value::ConstMemberIterator it = doc["data"].MemberBegin(); it != doc["data"].MemberEnd(); ++it) {
-                if (!it->name.IsString()) {
-                    continue;
-                }
-
-                data[it->name.GetString()] = rapidJSONToVariant(it->value);
-            }
+            keys.push_back(doc["keys"][i].IsString() ? doc["keys"][i].GetString() : std::string());
         }
 
         unsigned int rows = doc["grid"].Size();
+        std::vector<std::vector<std::uint32_t> > columns(rows);
         unsigned int cols = 0;
         for (unsigned int i = 0; i < rows; i++) {
+            if (!doc["grid"][i].IsString()) {
+                continue;
+            }
             std::string columnUTF8 = doc["grid"][i].GetString();
-            std::vector<std::uint32_t> column;
-            column.reserve(columnUTF8.size());
-            utf8::utf8to32(columnUTF8.begin(), columnUTF8.end(), std::back_inserter(column));
+            columns[i].reserve(columnUTF8.size());
+            utf8::utf8to32(columnUTF8.begin(), columnUTF8.end(), std::back_inserter(columns[i]));
 
-            cols = std::max(cols, static_cast<unsigned int>(column.size()));
+            cols = std::max(cols, static_cast<unsigned int>(columns[i].size()));
         }
-        std::vector<int> keyIds;
+        std::vector<std::uint16_t> keyIds;
         keyIds.reserve(cols * rows);
         for (unsigned int i = 0; i < rows; i++) {
-            std::string columnUTF8 = doc["grid"][i].GetString();
-            std::vector<std::uint32_t> column;
-            column.reserve(columnUTF8.size());
-            utf8::utf8to32(columnUTF8.begin(), columnUTF8.end(), std::back_inserter(column));
-
+            std::vector<std::uint32_t>& column = columns[i];
             if (column.size() != cols) {
-                Log::Warnf("UTFGridTile::DecodeUTFTile: Mismatching rows/columns");
-                column.resize(cols - column.size(), ' ');
+                Log::Warnf("UTFGridTile::decodeGrid: Mismatching rows/columns");
+                column.resize(cols, ' ');
             }
 
             for (std::size_t j = 0; j < column.size(); j++) {
@@ -105,10 +177,15 @@ namespace carto {
                 if (code >= 93) code--;
                 if (code >= 35) code--;
                 code -= 32;
-                keyIds.push_back(code);
+                keyIds.push_back(code < keys.size() && code <= std::numeric_limits<std::uint16_t>::max() ? static_cast<std::uint16_t>(code) : 0);
             }
         }
-        return std::make_shared<UTFGridTile>(keys, data, keyIds, cols, rows);
+
+        std::swap(_keys, keys);
+        std::swap(_keyIds, keyIds);
+        _xSize = cols;
+        _ySize = rows;
+        return !_keys.empty();
     }
 
 }
@@ -9,47 +9,49 @@
 
 #include "core/Variant.h"
 
+#include <cstdint>
 #include <memory>
 #include <map>
+#include <mutex>
 #include <vector>
 #include <string>
 
 namespace carto {
     class BinaryData;
         
+    /**
+     * UTFGrid tile that keeps the original JSON data and decodes it lazily.
+     * The keys and the grid are decoded on the first query, data elements are decoded only for the keys queried.
+     */
     class UTFGridTile {
     public:
-        UTFGridTile(const std::vector<std::string>& keys, const std::map<std::string, Variant>& data, const std::vector<int>& keyIds, int xSize, int ySize) : _keys(keys), _data(data), _keyIds(keyIds), _xSize(xSize), _ySize(ySize) { }
+        explicit UTFGridTile(const std::shared_ptr<BinaryData>& tileData);
 
-        std::string getKey(int keyId) const {
-            return keyId >= 0 && keyId <= static_cast<int>(_keys.size()) ? _keys[keyId] : std::string();
-        }
+        std::string getKey(int keyId) const;
         
-        Variant getData(const std::string& key) const {
-            auto it = _data.find(key);
-            return it != _data.end() ? it->second : Variant();
-        }
-
-        int getXSize() const {
-            return _xSize;
-        }
+        Variant getData(const std::string& key) const;
+
+        int getXSize() const;
         
-        int getYSize() const {
-            return _ySize;
-        }
+        int getYSize() const;
         
-        int getKeyId(int x, int y) const {
-            return x >= 0 && y >= 0 && x < getXSize() && y < getYSize() ? _keyIds[y * getXSize() + x] : 0;
-        }
+        int getKeyId(int x, int y) const;
 
         static std::shared_ptr<UTFGridTile> DecodeUTFTile(const std::shared_ptr<BinaryData>& tileData);
 
     private:
-        std::vector<std::string> _keys;
-        std::map<std::string, Variant> _data;
-        std::vector<int> _keyIds;
-        int _xSize;
-        int _ySize;
+        bool decodeGrid() const;
+
+        std::shared_ptr<BinaryData> _tileData;
+
+        mutable bool _gridDecoded;
+        mutable std::vector<std::string> _keys;
+        mutable std::map<std::string, Variant> _data;
+        mutable std::vector<std::uint16_t> _keyIds;
+        mutable int _xSize;
+        mutable int _ySize;
+
+        mutable std::mutex _mutex;
     };
     
 }
@@ -0,0 +1,94 @@
+#include "FetchConcurrencyController.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace carto {
+
+    FetchConcurrencyController::~FetchConcurrencyController() {
+    }
+
+    bool FetchConcurrencyController::isEnabled() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _enabled;
+    }
+
+    void FetchConcurrencyController::setEnabled(bool enabled) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _enabled = enabled;
+        _condition.notify_all();
+    }
+
+    int FetchConcurrencyController::getMaxLimit() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _maxLimit;
+    }
+
+    void FetchConcurrencyController::setMaxLimit(int maxLimit) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _maxLimit = std::max(1, maxLimit);
+        _limit = std::min(_limit, static_cast<float>(_maxLimit));
+        _condition.notify_all();
+    }
+
+    int FetchConcurrencyController::getLimit() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return static_cast<int>(_limit);
+    }
+
+    void FetchConcurrencyController::acquire() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _condition.wait(lock, [this]() { return !_enabled || _inFlightCount < static_cast<int>(_limit); });
+        _inFlightCount++;
+    }
+
+    void FetchConcurrencyController::release(bool congested, float timeToFirstByte) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _inFlightCount--;
+
+        if (timeToFirstByte >= 0) {
+            // Track the lowest recent latency. Let the baseline drift up slowly, so that it follows the network when it becomes slower.
+            _baselineLatency = std::min(_baselineLatency * (1.0f + LATENCY_BASELINE_DRIFT), timeToFirstByte);
+            _smoothedLatency = (_smoothedLatency > 0 ? _smoothedLatency * 0.9f + timeToFirstByte * 0.1f : timeToFirstByte);
+            if (timeToFirstByte > _baselineLatency * LATENCY_TOLERANCE) {
+                congested = true;
+            }
+        }
+
+        if (congested) {
+            // Decrease at most once per round trip, requests that were started before the previous decrease see the same congestion
+            std::chrono::steady_clock::time_point currentTime = std::chrono::steady_clock::now();
+            if (currentTime - _decreaseTime > std::chrono::microseconds(static_cast<long long>(_smoothedLatency * 1000.0f))) {
+                _limit = std::max(1.0f, _limit * DECREASE_FACTOR);
+                _decreaseTime = currentTime;
+            }
+        } else {
+            // Additive increase, about one extra request per round trip of the full window
+            _limit = std::min(static_cast<float>(_maxLimit), _limit + 1.0f / _limit);
+        }
+        _condition.notify_all();
+    }
+
+    FetchConcurrencyController& FetchConcurrencyController::GetInstance() {
+        static FetchConcurrencyController instance;
+        return instance;
+    }
+
+    FetchConcurrencyController::FetchConcurrencyController() :
+        _enabled(false),
+        _maxLimit(DEFAULT_MAX_LIMIT),
+        _limit(static_cast<float>(INITIAL_LIMIT)),
+        _inFlightCount(0),
+        _baselineLatency(std::numeric_limits<float>::max()),
+        _smoothedLatency(0),
+        _decreaseTime(),
+        _mutex(),
+        _condition()
+    {
+    }
+
+    const float FetchConcurrencyController::LATENCY_TOLERANCE = 2.0f;
+    const float FetchConcurrencyController::LATENCY_BASELINE_DRIFT = 0.01f;
+    const float FetchConcurrencyController::DECREASE_FACTOR = 0.75f;
+
+}
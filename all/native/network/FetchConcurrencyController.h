@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_FETCHCONCURRENCYCONTROLLER_H_
+#define _CARTO_FETCHCONCURRENCYCONTROLLER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace carto {
+
+    /**
+     * An internal class for adapting the number of in-flight tile requests of the process to the network conditions.
+     * The limit is controlled similarly to TCP congestion control: it is increased additively while
+     * the time to first byte stays close to the lowest recently observed value, and decreased multiplicatively
+     * when requests queue up on the network (latency grows) or fail.
+     */
+    class FetchConcurrencyController {
+    public:
+        virtual ~FetchConcurrencyController();
+
+        /**
+         * Returns true if the in-flight requests are limited.
+         * @return True if the in-flight requests are limited. False if all requests are started immediately.
+         */
+        bool isEnabled() const;
+        /**
+         * Enables/disables limiting the in-flight requests.
+         * @param enabled True if the requests should be limited.
+         */
+        void setEnabled(bool enabled);
+
+        /**
+         * Returns the maximum value of the concurrency limit.
+         * @return The maximum number of concurrent requests.
+         */
+        int getMaxLimit() const;
+        /**
+         * Sets the maximum value of the concurrency limit.
+         * @param maxLimit The maximum number of concurrent requests. Must be at least 1.
+         */
+        void setMaxLimit(int maxLimit);
+
+        /**
+         * Returns the current concurrency limit.
+         * @return The current number of requests allowed to be in flight.
+         */
+        int getLimit() const;
+
+        /**
+         * Waits until a new request can be started. Each call must be followed by a call to release.
+         */
+        void acquire();
+        /**
+         * Marks a request as finished and updates the concurrency limit.
+         * @param congested True if the request failed or the server reported overload.
+         * @param timeToFirstByte The time to first byte of the request in milliseconds, or negative if not known.
+         */
+        void release(bool congested, float timeToFirstByte);
+
+        /**
+         * Returns the singleton instance of the class.
+         * @return The singleton instance of the class.
+         */
+        static FetchConcurrencyController& GetInstance();
+
+    private:
+        FetchConcurrencyController();
+
+        static const int DEFAULT_MAX_LIMIT = 16;
+        static const int INITIAL_LIMIT = 4;
+        static const float LATENCY_TOLERANCE;
+        static const float LATENCY_BASELINE_DRIFT;
+        static const float DECREASE_FACTOR;
+
+        bool _enabled;
+        int _maxLimit;
+        float _limit;
+        int _inFlightCount;
+        float _baselineLatency;
+        float _smoothedLatency;
+        std::chrono::steady_clock::time_point _decreaseTime;
+
+        mutable std::mutex _mutex;
+        std::condition_variable _condition;
+    };
+
+}
+
+#endif
@@ -1,8 +1,10 @@
 #include "HTTPClient.h"
 #include "core/BinaryData.h"
 #include "components/Exceptions.h"
+#include "network/FetchConcurrencyController.h"
 #include "utils/Log.h"
 
+#include <algorithm>
 #include <chrono>
 #include <limits>
 #include <regex>
@@ -10,6 +12,8 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
 
+#include <zlib.h>
+
 #if defined(_WIN32)
 #define CARTO_HTTP_SOCKET_IMPL WinSockImpl
 #include "network/HTTPClientWinSockImpl.h"
@@ -26,8 +30,95 @@
 
 namespace carto {
 
+    std::atomic<int> HTTPClient::_MaxConnectionsPerHost(DEFAULT_MAX_CONNECTIONS_PER_HOST);
+
+    class HTTPClient::ContentDecoder {
+    public:
+        typedef std::function<bool(const unsigned char*, std::size_t)> DataFunc;
+
+        ContentDecoder() : _stream(), _header(), _initialized(false), _passThrough(false), _finished(false), _failed(false) { }
+
+        ~ContentDecoder() {
+            if (_initialized) {
+                inflateEnd(&_stream);
+            }
+        }
+
+        bool isFailed() const {
+            return _failed;
+        }
+
+        bool decode(const unsigned char* data, std::size_t size, const DataFunc& dataFn) {
+            if (_passThrough) {
+                return dataFn(data, size);
+            }
+
+            if (!_initialized) {
+                // Collect enough bytes to detect the stream header
+                _header.insert(_header.end(), data, data + size);
+                if (_header.size() < 2) {
+                    return true;
+                }
+
+                // Some platform HTTP stacks decode the content themselves, pass such data through unchanged
+                bool gzipHeader = _header[0] == 0x1f && _header[1] == 0x8b;
+                bool zlibHeader = (_header[0] & 0x0f) == Z_DEFLATED && ((_header[0] << 8) | _header[1]) % 31 == 0;
+                std::vector<unsigned char> header;
+                std::swap(header, _header);
+                if (!gzipHeader && !zlibHeader) {
+                    _passThrough = true;
+                    return dataFn(header.data(), header.size());
+                }
+
+                if (inflateInit2(&_stream, 32 + MAX_WBITS) != Z_OK) { // automatic gzip/zlib header detection
+                    _failed = true;
+                    return false;
+                }
+                _initialized = true;
+                return inflate(header.data(), header.size(), dataFn);
+            }
+
+            return inflate(data, size, dataFn);
+        }
+
+    private:
+        bool inflate(const unsigned char* data, std::size_t size, const DataFunc& dataFn) {
+            _stream.next_in = const_cast<Bytef*>(data);
+            _stream.avail_in = static_cast<uInt>(size);
+            while (!_finished) {
+                unsigned char buf[16384];
+                _stream.next_out = buf;
+                _stream.avail_out = sizeof(buf);
+                int err = ::inflate(&_stream, Z_NO_FLUSH);
+                if (err != Z_OK && err != Z_STREAM_END && err != Z_BUF_ERROR) {
+                    _failed = true;
+                    return false;
+                }
+                std::size_t decodedSize = sizeof(buf) - _stream.avail_out;
+                if (decodedSize > 0) {
+                    if (!dataFn(buf, decodedSize)) {
+                        return false;
+                    }
+                }
+                if (err == Z_STREAM_END) {
+                    _finished = true;
+                } else if (_stream.avail_in == 0 && _stream.avail_out > 0) {
+                    break;
+                }
+            }
+            return true;
+        }
+
+        z_stream _stream;
+        std::vector<unsigned char> _header;
+        bool _initialized;
+        bool _passThrough;
+        bool _finished;
+        bool _failed;
+    };
+
     HTTPClient::HTTPClient(bool log) :
-        _log(log), _impl(new CARTO_HTTP_SOCKET_IMPL(log))
+        _log(log), _transferredBytes(0), _decodedBytes(0), _adaptiveConcurrency(false), _statisticsFn(), _impl(new CARTO_HTTP_SOCKET_IMPL(log))
     {
     }
 
@@ -35,6 +126,34 @@ namespace carto {
         _impl->setTimeout(milliseconds);
     }
 
+    bool HTTPClient::isAdaptiveConcurrency() const {
+        return _adaptiveConcurrency;
+    }
+
+    void HTTPClient::setAdaptiveConcurrency(bool enabled) {
+        _adaptiveConcurrency = enabled;
+    }
+
+    void HTTPClient::setStatisticsHandler(StatisticsFunc statisticsFn) {
+        _statisticsFn = statisticsFn;
+    }
+
+    std::uint64_t HTTPClient::getTransferredBytes() const {
+        return _transferredBytes.load();
+    }
+
+    std::uint64_t HTTPClient::getDecodedBytes() const {
+        return _decodedBytes.load();
+    }
+
+    int HTTPClient::GetMaxConnectionsPerHost() {
+        return _MaxConnectionsPerHost.load();
+    }
+
+    void HTTPClient::SetMaxConnectionsPerHost(int maxConnections) {
+        _MaxConnectionsPerHost.store(std::max(0, maxConnections));
+    }
+
     int HTTPClient::get(const std::string& url, const std::map<std::string, std::string>& requestHeaders, std::map<std::string, std::string>& responseHeaders, std::shared_ptr<BinaryData>& responseData, int* statusCode) const {
         Request request("GET", url);
         request.headers.insert(requestHeaders.begin(), requestHeaders.end());
@@ -48,6 +167,10 @@ namespace carto {
             if (content.size() != offset) {
                 content.resize(static_cast<std::size_t>(offset));
             }
+            // Reserve the full content at once if the length is known, instead of growing the buffer repeatedly
+            if (length <= MAX_PRERESERVED_CONTENT_SIZE && length > content.capacity()) {
+                content.reserve(static_cast<std::size_t>(length));
+            }
             content.insert(content.end(), buf, buf + size);
             return true;
         };
@@ -78,6 +201,10 @@ namespace carto {
             if (content.size() != offset) {
                 content.resize(static_cast<std::size_t>(offset));
             }
+            // Reserve the full content at once if the length is known, instead of growing the buffer repeatedly
+            if (length <= MAX_PRERESERVED_CONTENT_SIZE && length > content.capacity()) {
+                content.reserve(static_cast<std::size_t>(length));
+            }
             content.insert(content.end(), buf, buf + size);
             return true;
         };
@@ -95,7 +222,7 @@ namespace carto {
         if (request.headers.count("Accept") == 0) {
             request.headers["Accept"] = "*/*";
         }
-        if (offset > 0) {
+        if (offset > 0 && request.headers.count("Range") == 0) {
             request.headers["Range"] = "bytes=" + boost::lexical_cast<std::string>(offset) + "-";
         }
 
@@ -106,10 +233,21 @@ namespace carto {
     }
 
     int HTTPClient::makeRequest(Request request, Response& response, HandlerFunc handlerFn, std::uint64_t offset) const {
+        // Negotiate compressed transfer. Ranges of encoded content can not be mapped to decoded offsets, so require identity encoding when resuming.
+        if (request.headers.count("Accept-Encoding") == 0 && request.headers.count("Range") == 0 && offset == 0) {
+            request.headers["Accept-Encoding"] = "gzip, deflate";
+        }
+
         std::uint64_t contentOffset = 0;
         std::uint64_t contentLength = std::numeric_limits<std::uint64_t>::max();
+        std::shared_ptr<ContentDecoder> contentDecoder;
+
+        RequestStatistics statistics;
+        std::chrono::steady_clock::time_point requestTime = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point headersTime = requestTime;
 
         auto headersFn = [&](int statusCode, const std::map<std::string, std::string>& headers) {
+            headersTime = std::chrono::steady_clock::now();
             response.statusCode = statusCode;
             response.headers.insert(headers.begin(), headers.end());
 
@@ -128,6 +266,8 @@ namespace carto {
                     }
                     return false;
                 }
+            } else if (statusCode >= 200 && statusCode < 300) {
+                offset = 0; // range was ignored, full content is sent
             }
 
             // Read Content-Length
@@ -136,17 +276,75 @@ namespace carto {
                 contentLength = boost::lexical_cast<std::uint64_t>(it->second);
             }
 
+            // Check Content-Encoding. Content-Length refers to the encoded data, so the decoded length is not known
+            it = response.headers.find("Content-Encoding");
+            if (it != response.headers.end()) {
+                std::string encoding = boost::algorithm::to_lower_copy(boost::algorithm::trim_copy(it->second));
+                if (encoding == "gzip" || encoding == "x-gzip" || encoding == "deflate") {
+                    contentDecoder = std::make_shared<ContentDecoder>();
+                    contentLength = std::numeric_limits<std::uint64_t>::max();
+                } else if (encoding != "identity") {
+                    if (_log) {
+                        Log::Warnf("HTTPClient::makeRequest: Unsupported content encoding: %s, URL: %s", encoding.c_str(), request.url.c_str());
+                    }
+                }
+            }
+
             return true;
         };
 
         std::uint64_t originalOffset = offset;
-        auto dataFn = [&](const unsigned char* data, std::size_t size) {
+        auto decodedDataFn = [&](const unsigned char* data, std::size_t size) {
             bool result = handlerFn(offset, contentOffset + contentLength, data, size);
             offset += size;
+            _decodedBytes += size;
+            statistics.decodedBytes += size;
             return result;
         };
+        auto dataFn = [&](const unsigned char* data, std::size_t size) {
+            _transferredBytes += size;
+            statistics.transferredBytes += size;
+            if (contentDecoder) {
+                return contentDecoder->decode(data, size, decodedDataFn);
+            }
+            return decodedDataFn(data, size);
+        };
+
+        auto finishRequest = [&](bool failed) {
+            std::chrono::steady_clock::time_point endTime = std::chrono::steady_clock::now();
+            statistics.statusCode = failed ? -1 : response.statusCode;
+            if (response.statusCode != -1) {
+                statistics.timeToFirstByte = std::chrono::duration_cast<std::chrono::microseconds>(headersTime - requestTime).count() / 1000.0f;
+                statistics.transferTime = std::chrono::duration_cast<std::chrono::microseconds>(endTime - headersTime).count() / 1000.0f;
+            }
+            if (_adaptiveConcurrency) {
+                bool congested = failed || response.statusCode == 429 || response.statusCode == 503;
+                FetchConcurrencyController::GetInstance().release(congested, response.statusCode != -1 ? statistics.timeToFirstByte : -1.0f);
+            }
+            if (_statisticsFn) {
+                _statisticsFn(statistics);
+            }
+        };
 
-        if (!_impl->makeRequest(request, headersFn, dataFn)) {
+        if (_adaptiveConcurrency) {
+            FetchConcurrencyController::GetInstance().acquire();
+        }
+        requestTime = headersTime = std::chrono::steady_clock::now();
+
+        bool completed = false;
+        try {
+            completed = _impl->makeRequest(request, headersFn, dataFn);
+        }
+        catch (...) {
+            finishRequest(true);
+            throw;
+        }
+        finishRequest(false);
+
+        if (!completed) {
+            if (contentDecoder && contentDecoder->isFailed()) {
+                throw NetworkException("Failed to decode response content", request.url);
+            }
             return -1; // request was cancelled
         }
 
@@ -165,7 +363,7 @@ namespace carto {
         }
 
         if (response.statusCode < 200 || response.statusCode >= 300) {
-            if (_log) {
+            if (_log && response.statusCode != 304) { // 304 is the expected answer to conditional requests
                 Log::Errorf("HTTPClient::makeRequest: Bad status code: %d, URL: %s", response.statusCode, request.url.c_str());
             }
             return response.statusCode;
@@ -177,4 +375,6 @@ namespace carto {
     HTTPClient::Impl::~Impl() {
     }
 
+    const std::uint64_t HTTPClient::MAX_PRERESERVED_CONTENT_SIZE = 64 * 1024 * 1024;
+
 }
@@ -11,6 +11,7 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <atomic>
 #include <mutex>
 #include <cstdint>
 #include <functional>
@@ -22,14 +23,67 @@ namespace carto {
     public:
         typedef std::function<bool(std::uint64_t, std::uint64_t, const unsigned char*, std::size_t)> HandlerFunc;
 
+        struct RequestStatistics {
+            int statusCode = -1; // -1 if the request failed or was cancelled before receiving response headers
+            std::uint64_t transferredBytes = 0;
+            std::uint64_t decodedBytes = 0;
+            float timeToFirstByte = 0; // in milliseconds, includes name resolution and connection setup
+            float transferTime = 0; // in milliseconds, from response headers to the end of the response
+        };
+
+        typedef std::function<void(const RequestStatistics&)> StatisticsFunc;
+
         explicit HTTPClient(bool log);
 
         void setTimeout(int milliseconds);
 
+        /**
+         * Returns true if the number of in-flight requests of this client is limited by the shared FetchConcurrencyController.
+         * @return True if adaptive concurrency is used.
+         */
+        bool isAdaptiveConcurrency() const;
+        /**
+         * Enables/disables limiting the number of in-flight requests by the shared FetchConcurrencyController.
+         * This should be used only for requests that can be delayed, like tile requests. The default is disabled.
+         * @param enabled True if adaptive concurrency should be used.
+         */
+        void setAdaptiveConcurrency(bool enabled);
+
+        /**
+         * Sets the handler that is called with the statistics of each completed, failed or cancelled request.
+         * The handler may be called from multiple threads concurrently.
+         * @param statisticsFn The statistics handler. Can be null.
+         */
+        void setStatisticsHandler(StatisticsFunc statisticsFn);
+
         int get(const std::string& url, const std::map<std::string, std::string>& requestHeaders, std::map<std::string, std::string>& responseHeaders, std::shared_ptr<BinaryData>& responseData, int* statusCode = 0) const;
         int post(const std::string& url, const std::string& contentType, const std::shared_ptr<BinaryData>& requestData, const std::map<std::string, std::string>& requestHeaders, std::map<std::string, std::string>& responseHeaders, std::shared_ptr<BinaryData>& responseData);
         int streamResponse(const std::string& method, const std::string& url, const std::map<std::string, std::string>& requestHeaders, std::map<std::string, std::string>& responseHeaders, HandlerFunc handlerFn, std::uint64_t offset) const;
 
+        /**
+         * Returns the total number of response body bytes received by this client, before content decoding.
+         * @return The total number of transferred bytes.
+         */
+        std::uint64_t getTransferredBytes() const;
+        /**
+         * Returns the total number of response body bytes delivered by this client, after content decoding.
+         * @return The total number of decoded bytes.
+         */
+        std::uint64_t getDecodedBytes() const;
+
+        /**
+         * Returns the maximum number of idle keep-alive connections kept per host.
+         * The connection pool is shared by all client instances.
+         * @return The maximum number of idle connections per host.
+         */
+        static int GetMaxConnectionsPerHost();
+        /**
+         * Sets the maximum number of idle keep-alive connections kept per host.
+         * Has no effect on platforms where connections are managed by the system HTTP stack.
+         * @param maxConnections The maximum number of idle connections per host. Zero disables connection reuse.
+         */
+        static void SetMaxConnectionsPerHost(int maxConnections);
+
     private:
         struct HeaderLess {
             bool operator() (const std::string& header1, const std::string& header2) const {
@@ -74,6 +128,8 @@ namespace carto {
             virtual bool makeRequest(const HTTPClient::Request& request, HeadersFunc headersFn, DataFunc dataFn) const = 0;
         };
 
+        class ContentDecoder;
+
         class PionImpl;
         class AndroidImpl;
         class IOSImpl;
@@ -81,7 +137,16 @@ namespace carto {
 
         int makeRequest(Request request, Response& response, HandlerFunc handlerFn, std::uint64_t offset) const;
 
+        static const int DEFAULT_MAX_CONNECTIONS_PER_HOST = 6;
+        static const std::uint64_t MAX_PRERESERVED_CONTENT_SIZE;
+
+        static std::atomic<int> _MaxConnectionsPerHost;
+
         bool _log;
+        mutable std::atomic<std::uint64_t> _transferredBytes;
+        mutable std::atomic<std::uint64_t> _decodedBytes;
+        bool _adaptiveConcurrency;
+        StatisticsFunc _statisticsFn;
         std::unique_ptr<Impl> _impl;
     };
 
@@ -11,10 +11,11 @@
 
 namespace carto {
 
+    std::multimap<HTTPClient::PionImpl::ConnectionKey, std::shared_ptr<HTTPClient::PionImpl::Connection> > HTTPClient::PionImpl::_ConnectionMap;
+    std::mutex HTTPClient::PionImpl::_Mutex;
+
     HTTPClient::PionImpl::PionImpl(bool log) :
-        _log(log),
-        _connectionMap(),
-        _mutex()
+        _log(log)
     {
     }
 
@@ -28,33 +29,16 @@ namespace carto {
         if (proto == "https") {
             throw NetworkException("HTTPS protocol not supported", request.url);
         }
-        auto connectionKey = std::make_pair(host, port);
+        ConnectionKey connectionKey(host, port);
 
-        // Try to reuse existing connection from the pool for GET methods
+        // Try to reuse existing connection from the shared pool
         bool result = false;
-        while (true) {
-            std::shared_ptr<Connection> connection;
-            {
-                std::lock_guard<std::mutex> lock(_mutex);
-                auto it = _connectionMap.find(connectionKey);
-                if (it != _connectionMap.end()) {
-                    connection = it->second;
-                    _connectionMap.erase(it);
-                }
-            }
-            if (!connection) {
-                break;
-            }
-            if (!connection->isValid()) {
-                continue;
-            }
-
+        while (std::shared_ptr<Connection> connection = AcquireConnection(connectionKey)) {
             result = makeRequest(*connection, request, headersFn, dataFn);
 
             if (result) {
-                std::lock_guard<std::mutex> lock(_mutex);
                 if (request.method == "GET") {
-                    _connectionMap.insert(std::make_pair(connectionKey, connection));
+                    ReleaseConnection(connectionKey, connection);
                 }
                 return result;
             }
@@ -69,9 +53,8 @@ namespace carto {
         result = makeRequest(*connection, request, headersFn, dataFn);
 
         if (result) {
-            std::lock_guard<std::mutex> lock(_mutex);
             if (request.method == "GET") {
-                _connectionMap.insert(std::make_pair(connectionKey, connection));
+                ReleaseConnection(connectionKey, connection);
             }
         }
         return result;
@@ -141,7 +124,7 @@ namespace carto {
 
         // Check Keep-Alive directive
         connection.maxRequests--;
-        it = pionResponse.get_headers().find("Keep-Alive");
+        auto it = pionResponse.get_headers().find("Keep-Alive");
         if (it != pionResponse.get_headers().end()) {
             std::cmatch what;
             if (std::regex_match(it->second.c_str(), what, std::regex(".*[^a-zA-Z0-9]timeout=([0-9]*).*"))) {
@@ -158,7 +141,7 @@ namespace carto {
 
         // Read Content-Length
         std::uint64_t contentLength = std::numeric_limits<std::uint64_t>::max();
-        auto it = pionResponse.get_headers().find("Content-Length");
+        it = pionResponse.get_headers().find("Content-Length");
         if (it != pionResponse.get_headers().end()) {
             contentLength = boost::lexical_cast<std::uint64_t>(it->second);
         } else {
@@ -191,6 +174,33 @@ namespace carto {
         return !cancel;
     }
 
+    std::shared_ptr<HTTPClient::PionImpl::Connection> HTTPClient::PionImpl::AcquireConnection(const ConnectionKey& connectionKey) {
+        std::lock_guard<std::mutex> lock(_Mutex);
+        while (true) {
+            auto it = _ConnectionMap.find(connectionKey);
+            if (it == _ConnectionMap.end()) {
+                return std::shared_ptr<Connection>();
+            }
+            std::shared_ptr<Connection> connection = it->second;
+            _ConnectionMap.erase(it);
+            if (connection->isValid()) {
+                return connection;
+            }
+        }
+    }
+
+    void HTTPClient::PionImpl::ReleaseConnection(const ConnectionKey& connectionKey, const std::shared_ptr<Connection>& connection) {
+        if (!connection->isValid()) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(_Mutex);
+        if (static_cast<int>(_ConnectionMap.count(connectionKey)) >= HTTPClient::GetMaxConnectionsPerHost()) {
+            return;
+        }
+        _ConnectionMap.insert(std::make_pair(connectionKey, connection));
+    }
+
     HTTPClient::PionImpl::Connection::Connection(const std::string& host, std::uint16_t port) :
         maxRequests(std::numeric_limits<int>::max()), keepAliveTime(), ioService(), connection()
     {
@@ -34,11 +34,17 @@ namespace carto {
             bool isValid() const;
         };
 
+        typedef std::pair<std::string, int> ConnectionKey;
+
         bool makeRequest(Connection& connection, const HTTPClient::Request& request, HeadersFunc headersFn, DataFunc dataFn) const;
 
+        static std::shared_ptr<Connection> AcquireConnection(const ConnectionKey& connectionKey);
+        static void ReleaseConnection(const ConnectionKey& connectionKey, const std::shared_ptr<Connection>& connection);
+
         bool _log;
-        mutable std::multimap<std::pair<std::string, int>, std::shared_ptr<Connection> > _connectionMap;
-        mutable std::mutex _mutex;
+
+        static std::multimap<ConnectionKey, std::shared_ptr<Connection> > _ConnectionMap;
+        static std::mutex _Mutex;
     };
 
 }
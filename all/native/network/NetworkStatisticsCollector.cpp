@@ -0,0 +1,65 @@
+#include "NetworkStatisticsCollector.h"
+#include "datasources/components/NetworkStatistics.h"
+
+namespace carto {
+
+    NetworkStatisticsCollector::NetworkStatisticsCollector() :
+        _requestCount(0),
+        _failedRequestCount(0),
+        _transferredBytes(0),
+        _decodedBytes(0),
+        _statusCodeCounts(),
+        _timeToFirstByteSamples(),
+        _transferTimeSamples(),
+        _mutex()
+    {
+    }
+
+    NetworkStatisticsCollector::~NetworkStatisticsCollector() {
+    }
+
+    void NetworkStatisticsCollector::addRequest(const HTTPClient::RequestStatistics& statistics) {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        _requestCount++;
+        _transferredBytes += static_cast<long long>(statistics.transferredBytes);
+        _decodedBytes += static_cast<long long>(statistics.decodedBytes);
+        if (statistics.statusCode == -1) {
+            _failedRequestCount++;
+            return;
+        }
+        _statusCodeCounts[statistics.statusCode]++;
+
+        _timeToFirstByteSamples.push_back(statistics.timeToFirstByte);
+        _transferTimeSamples.push_back(statistics.transferTime);
+        while (_timeToFirstByteSamples.size() > MAX_TIMING_SAMPLES) {
+            _timeToFirstByteSamples.pop_front();
+            _transferTimeSamples.pop_front();
+        }
+    }
+
+    std::shared_ptr<NetworkStatistics> NetworkStatisticsCollector::getStatistics() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return std::make_shared<NetworkStatistics>(
+            _requestCount,
+            _failedRequestCount,
+            _transferredBytes,
+            _decodedBytes,
+            _statusCodeCounts,
+            std::vector<float>(_timeToFirstByteSamples.begin(), _timeToFirstByteSamples.end()),
+            std::vector<float>(_transferTimeSamples.begin(), _transferTimeSamples.end())
+        );
+    }
+
+    void NetworkStatisticsCollector::reset() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _requestCount = 0;
+        _failedRequestCount = 0;
+        _transferredBytes = 0;
+        _decodedBytes = 0;
+        _statusCodeCounts.clear();
+        _timeToFirstByteSamples.clear();
+        _transferTimeSamples.clear();
+    }
+
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_NETWORKSTATISTICSCOLLECTOR_H_
+#define _CARTO_NETWORKSTATISTICSCOLLECTOR_H_
+
+#include "network/HTTPClient.h"
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace carto {
+    class NetworkStatistics;
+
+    /**
+     * An internal thread-safe accumulator of HTTP request statistics.
+     * Keeps totals of all requests and timing samples of the most recent requests.
+     */
+    class NetworkStatisticsCollector {
+    public:
+        NetworkStatisticsCollector();
+        virtual ~NetworkStatisticsCollector();
+
+        /**
+         * Adds the statistics of a single request.
+         * @param statistics The request statistics.
+         */
+        void addRequest(const HTTPClient::RequestStatistics& statistics);
+
+        /**
+         * Returns a snapshot of the aggregated statistics.
+         * @return The aggregated statistics.
+         */
+        std::shared_ptr<NetworkStatistics> getStatistics() const;
+
+        /**
+         * Clears all collected statistics.
+         */
+        void reset();
+
+    private:
+        static const std::size_t MAX_TIMING_SAMPLES = 1024;
+
+        long long _requestCount;
+        long long _failedRequestCount;
+        long long _transferredBytes;
+        long long _decodedBytes;
+        std::map<int, long long> _statusCodeCounts;
+        std::deque<float> _timeToFirstByteSamples;
+        std::deque<float> _transferTimeSamples;
+
+        mutable std::mutex _mutex;
+    };
+
+}
+
+#endif
@@ -135,6 +135,18 @@ namespace carto {
         return NetworkUtils::BuildURLFromParameters(url, params);
     }
 
+    std::string CartoPackageManager::createPackageDeltaURL(const std::string& packageId, int baseVersion, int version, const std::string& baseURL) const {
+        std::string url = createPackageURL(packageId, version, baseURL, true);
+        if (url.empty()) {
+            return std::string();
+        }
+
+        // The server responds with an error if the delta against the base version is not available
+        std::map<std::string, std::string> params;
+        params["delta"] = boost::lexical_cast<std::string>(baseVersion);
+        return NetworkUtils::BuildURLFromParameters(url, params);
+    }
+
     std::shared_ptr<PackageInfo> CartoPackageManager::getCustomPackage(const std::string& packageId, int version) const {
         static std::regex re("^bbox\\(\\s*([0-9-.eE]*)\\s*,\\s*([0-9-.eE]*)\\s*,\\s*([0-9-.eE]*)\\s*,\\s*([0-9-.eE]*)\\s*\\)$");
         
@@ -55,6 +55,7 @@ namespace carto {
         static bool CalculateBBoxTiles(const MapBounds& bounds, const std::shared_ptr<Projection>& proj, const MapTile& tile, std::vector<MapTile>& tiles);
 
         virtual std::string createPackageURL(const std::string& packageId, int version, const std::string& baseURL, bool downloaded) const;
+        virtual std::string createPackageDeltaURL(const std::string& packageId, int baseVersion, int version, const std::string& baseURL) const;
 
         virtual std::shared_ptr<PackageInfo> getCustomPackage(const std::string& packageId, int version) const;
 
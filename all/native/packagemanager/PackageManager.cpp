@@ -6,10 +6,12 @@
 #include "projections/Projection.h"
 #include "projections/EPSG3857.h"
 #include "packagemanager/handlers/PackageHandler.h"
+#include "packagemanager/PackageTileIndex.h"
 #include "packagemanager/handlers/PackageHandlerFactory.h"
 #include "utils/URLFileLoader.h"
 #include "utils/GeneralUtils.h"
 #include "utils/Log.h"
+#include "utils/ThreadUtils.h"
 
 #include <cstdint>
 #include <memory>
@@ -23,6 +25,8 @@
 #include <stdext/utf8_filesystem.h>
 #include <stdext/zlib.h>
 
+#include <zlib.h>
+
 #include <sqlite3pp.h>
 #include <sqlite3ppext.h>
 
@@ -58,10 +62,15 @@ namespace carto {
         _serverEncKey(serverEncKey),
         _localEncKey(localEncKey),
         _localPackages(),
+        _localPackageTileIndex(),
         _localDb(),
         _taskQueue(),
         _taskQueueCondition(),
         _packageManagerThread(),
+        _importQueue(),
+        _importTaskIds(),
+        _importQueueCondition(),
+        _importThreads(),
         _onChangeListeners(),
         _stopped(true),
         _prevTaskId(-1),
@@ -69,6 +78,7 @@ namespace carto {
         _prevRoundedProgress(0),
         _packageManagerListener(),
         _serverPackageCache(),
+        _serverPackageTileIndex(),
         _packageHandlerCache(),
         _mutex()
     {
@@ -152,6 +162,9 @@ namespace carto {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
         _stopped = false;
         _packageManagerThread = std::make_shared<std::thread>(std::bind(&PackageManager::run, this));
+        for (int i = 0; i < IMPORT_THREADS; i++) {
+            _importThreads.push_back(std::make_shared<std::thread>(std::bind(&PackageManager::runImports, this)));
+        }
         Log::Info("PackageManager: Package manager started");
         return true;
     }
@@ -162,21 +175,31 @@ namespace carto {
         }
 
         std::shared_ptr<std::thread> packageManagerThread;
+        std::vector<std::shared_ptr<std::thread> > importThreads;
         {
             std::lock_guard<std::recursive_mutex> lock(_mutex);
             if (!_stopped) {
                 _stopped = true;
                 _taskQueueCondition.notify_all();
+                _importQueueCondition.notify_all();
                 Log::Info("PackageManager: Stopping package manager");
             }
             packageManagerThread = _packageManagerThread;
+            importThreads = _importThreads;
         }
 
         if (packageManagerThread && wait) {
             packageManagerThread->join();
+            for (const std::shared_ptr<std::thread>& importThread : importThreads) {
+                importThread->join();
+            }
 
+            // Imports that were not started stay in the task queue and are redone after restart
             std::lock_guard<std::recursive_mutex> lock(_mutex);
             _packageManagerThread.reset();
+            _importThreads.clear();
+            _importQueue.clear();
+            _importTaskIds.clear();
             Log::Info("PackageManager: Package manager stopped");
         }
     }
@@ -371,10 +394,16 @@ namespace carto {
             throw NullArgumentException("Null projection");
         }
 
+        // Use the spatial index of the server package tile masks instead of testing each package separately
+        std::vector<std::shared_ptr<PackageInfo> > serverPackages;
+        std::shared_ptr<PackageTileIndex> tileIndex = getServerPackageTileIndex(serverPackages);
+
         // Detect zoom level from tile masks
         int zoom = 0;
-        for (const std::shared_ptr<PackageInfo>& packageInfo : getServerPackages()) {
-            zoom = std::max(zoom, packageInfo->getTileMask()->getMaxZoomLevel());
+        for (const std::shared_ptr<PackageInfo>& packageInfo : serverPackages) {
+            if (packageInfo->getTileMask()) {
+                zoom = std::max(zoom, packageInfo->getTileMask()->getMaxZoomLevel());
+            }
         }
 
         // Calculate map tile from the map position
@@ -383,11 +412,8 @@ namespace carto {
         // Find tile statuses from all packages. Keep only packages where the tile exists
         std::vector<std::pair<std::shared_ptr<PackageInfo>, PackageTileStatus::PackageTileStatus> > packageTileStatuses;
         while (true) {
-            for (const std::shared_ptr<PackageInfo>& packageInfo : getServerPackages()) {
-                PackageTileStatus::PackageTileStatus status = packageInfo->getTileMask()->getTileStatus(mapTile);
-                if (status != PackageTileStatus::PACKAGE_TILE_STATUS_MISSING) {
-                    packageTileStatuses.emplace_back(packageInfo, packageInfo->getTileMask()->getTileStatus(mapTile));
-                }
+            for (int maskIndex : tileIndex->findTileMasks(mapTile)) {
+                packageTileStatuses.emplace_back(serverPackages[maskIndex], PackageTileStatus::PACKAGE_TILE_STATUS_FULL);
             }
             if (!packageTileStatuses.empty() || mapTile.getZoom() == 0) {
                 break;
@@ -421,28 +447,20 @@ namespace carto {
             throw NullArgumentException("Null projection");
         }
 
-        // Get local packages
-        std::vector<std::shared_ptr<PackageInfo> > localPackages = getLocalPackages();
+        // Use the union of the local package tile masks
+        std::shared_ptr<PackageTileIndex> tileIndex;
+        {
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            tileIndex = _localPackageTileIndex;
+        }
+        if (!tileIndex) {
+            return false;
+        }
 
-        // Calculate tile extents
+        // Calculate tile extents and check the whole range at once
         MapTile mapTile1 = CalculateMapTile(mapBounds.getMin(), zoom, projection);
         MapTile mapTile2 = CalculateMapTile(mapBounds.getMax(), zoom, projection);
-        for (int y = std::min(mapTile1.getY(), mapTile2.getY()); y <= std::max(mapTile1.getY(), mapTile2.getY()); y++) {
-            for (int x = std::min(mapTile1.getX(), mapTile2.getX()); x <= std::max(mapTile1.getX(), mapTile2.getX()); x++) {
-                bool found = false;
-                for (std::size_t i = 0; i < localPackages.size(); i++) {
-                    if (localPackages[i]->getTileMask()->getTileStatus(MapTile(x, y, zoom, 0)) == PackageTileStatus::PACKAGE_TILE_STATUS_FULL) {
-                        std::rotate(localPackages.begin(), localPackages.begin() + i, localPackages.begin() + i + 1);
-                        found = true;
-                        break;
-                    }
-                }
-                if (!found) {
-                    return false;
-                }
-            }
-        }
-        return true;
+        return tileIndex->isTileRangeCovered(zoom, std::min(mapTile1.getX(), mapTile2.getX()), std::min(mapTile1.getY(), mapTile2.getY()), std::max(mapTile1.getX(), mapTile2.getX()), std::max(mapTile1.getY(), mapTile2.getY()));
     }
 
     bool PackageManager::startPackageListDownload() {
@@ -636,6 +654,7 @@ namespace carto {
     }
 
     void PackageManager::run() {
+        ThreadUtils::SetThreadQoSClass(ThreadQoSClass::BACKGROUND);
         try {
             while (true) {
                 int taskId = -1;
@@ -644,14 +663,19 @@ namespace carto {
                     if (_stopped) {
                         break;
                     }
-                    taskId = _taskQueue->getActiveTaskId();
+                    if (static_cast<int>(_importQueue.size()) >= MAX_PENDING_IMPORTS) {
+                        _taskQueueCondition.wait(lock);
+                        continue;
+                    }
+                    taskId = _taskQueue->getActiveTaskId(-1, _importTaskIds);
                     if (taskId == -1) {
                         _taskQueueCondition.wait(lock);
                         continue;
                     }
                 }
-                try {
+                executeTask(taskId, [this, taskId]() {
                     Task::Command command = _taskQueue->getTask(taskId).command;
+                    std::function<void()> importJob;
                     bool success = false;
                     switch (command) {
                     case Task::NOP:
@@ -661,10 +685,10 @@ namespace carto {
                         success = downloadPackageList(taskId);
                         break;
                     case Task::DOWNLOAD_PACKAGE:
-                        success = downloadPackage(taskId);
+                        success = downloadPackage(taskId, importJob);
                         break;
                     case Task::IMPORT_PACKAGE:
-                        success = importPackage(taskId);
+                        success = importPackage(taskId, importJob);
                         break;
                     case Task::REMOVE_PACKAGE:
                         success = removePackage(taskId);
@@ -673,35 +697,89 @@ namespace carto {
                         success = downloadStyle(taskId);
                         break;
                     }
-                    if (success) {
-                        setTaskFinished(taskId);
+                    if (!success) {
+                        return false;
+                    }
+                    if (importJob) {
+                        scheduleImport(taskId, importJob); // the import worker finishes the task
                     } else {
-                        setTaskFailed(taskId, PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM);
+                        setTaskFinished(taskId);
                     }
+                    return true;
+                });
+            }
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("PackageManager: Unexpected exception while handling tasks, shutting down: %s", ex.what());
+        }
+    }
+
+    void PackageManager::runImports() {
+        ThreadUtils::SetThreadQoSClass(ThreadQoSClass::BACKGROUND);
+        try {
+            while (true) {
+                std::pair<int, std::function<void()> > import;
+                {
+                    std::unique_lock<std::recursive_mutex> lock(_mutex);
+                    if (_stopped) {
+                        break;
+                    }
+                    if (_importQueue.empty()) {
+                        _importQueueCondition.wait(lock);
+                        continue;
+                    }
+                    import = _importQueue.front();
+                    _importQueue.pop_front();
                 }
-                catch (const PauseException&) {
-                    setTaskPaused(taskId);
-                    Log::Info("PackageManager: Paused task");
-                }
-                catch (const CancelException&) {
-                    setTaskCancelled(taskId);
-                    Log::Info("PackageManager: Cancelled task");
-                }
-                catch (const PackageException& ex) {
-                    setTaskFailed(taskId, ex.getErrorType());
-                    Log::Errorf("PackageManager: Exception while executing task: %s", ex.what());
-                }
-                catch (const std::exception& ex) {
-                    setTaskFailed(taskId, PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM);
-                    Log::Errorf("PackageManager: Exception while executing task: %s", ex.what());
+                int taskId = import.first;
+                executeTask(taskId, [this, taskId, &import]() {
+                    import.second();
+                    setTaskFinished(taskId);
+                    return true;
+                });
+                {
+                    std::lock_guard<std::recursive_mutex> lock(_mutex);
+                    _importTaskIds.erase(taskId);
+                    _taskQueueCondition.notify_all();
                 }
             }
         }
         catch (const std::exception& ex) {
-            Log::Errorf("PackageManager: Unexpected exception while handling tasks, shutting down: %s", ex.what());
+            Log::Errorf("PackageManager: Unexpected exception while importing packages, shutting down: %s", ex.what());
         }
     }
 
+    void PackageManager::executeTask(int taskId, const std::function<bool()>& handler) {
+        try {
+            if (!handler()) {
+                setTaskFailed(taskId, PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM);
+            }
+        }
+        catch (const PauseException&) {
+            setTaskPaused(taskId);
+            Log::Info("PackageManager: Paused task");
+        }
+        catch (const CancelException&) {
+            setTaskCancelled(taskId);
+            Log::Info("PackageManager: Cancelled task");
+        }
+        catch (const PackageException& ex) {
+            setTaskFailed(taskId, ex.getErrorType());
+            Log::Errorf("PackageManager: Exception while executing task: %s", ex.what());
+        }
+        catch (const std::exception& ex) {
+            setTaskFailed(taskId, PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM);
+            Log::Errorf("PackageManager: Exception while executing task: %s", ex.what());
+        }
+    }
+
+    void PackageManager::scheduleImport(int taskId, const std::function<void()>& importJob) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        _importTaskIds.insert(taskId);
+        _importQueue.push_back(std::make_pair(taskId, importJob));
+        _importQueueCondition.notify_one();
+    }
+
     bool PackageManager::downloadPackageList(int taskId) {
         // Download package list data
         std::vector<unsigned char> packageListData;
@@ -780,7 +858,7 @@ namespace carto {
         return true;
     }
 
-    bool PackageManager::importPackage(int taskId) {
+    bool PackageManager::importPackage(int taskId, std::function<void()>& importJob) {
         Task task = _taskQueue->getTask(taskId);
 
         // Check if the package is already imported
@@ -796,9 +874,9 @@ namespace carto {
         }
 
         std::string packageFileName = createLocalFilePath(createPackageFileName(task.packageId, task.packageType, task.packageVersion));
+        std::uint64_t fileSize = 0;
         try {
             // Determine file size, copy file
-            std::uint64_t fileSize = 0;
             {
                 FILE* fpDestRaw = utf8_filesystem::fopen(packageFileName.c_str(), "wb");
                 if (!fpDestRaw) {
@@ -839,48 +917,61 @@ namespace carto {
                 }
                 updateTaskStatus(taskId, PackageAction::PACKAGE_ACTION_COPYING, 1.0f);
             }
-
-            // Find package tiles and calculate tile mask
-            std::string tileMaskValue;
-            if (auto handler = PackageHandlerFactory(_serverEncKey, _localEncKey).createPackageHandler(task.packageType, packageFileName)) {
-                tileMaskValue = EncodeTileMask(handler->calculateTileMask());
-            }
-
-            // Get package id
-            int id = -1;
-            {
-                std::lock_guard<std::recursive_mutex> lock(_mutex);
-                sqlite3pp::query query1(*_localDb, "SELECT id FROM packages WHERE package_id=:package_id AND version=:version");
-                query1.bind(":package_id", task.packageId.c_str());
-                query1.bind(":version", task.packageVersion);
-                for (auto qit = query1.begin(); qit != query1.end(); qit++) {
-                    id = qit->get<int>(0);
-                }
-                if (id == -1) {
-                    sqlite3pp::command command(*_localDb, "INSERT INTO packages(package_id, package_type, version, size, server_url, tile_mask, metainfo, valid) VALUES(:package_id, :package_type, :version, :size, '', :tile_mask, '', 0)");
-                    command.bind(":package_id", task.packageId.c_str());
-                    command.bind(":package_type", static_cast<int>(task.packageType));
-                    command.bind(":version", task.packageVersion);
-                    command.bind(":size", fileSize);
-                    command.bind(":tile_mask", tileMaskValue.c_str());
-                    command.execute();
-                    id = static_cast<int>(_localDb->last_insert_rowid());
-                }
-            }
-
-            // Import package
-            importLocalPackage(id, taskId, task.packageId, task.packageType, packageFileName);
         }
         catch (...) {
             utf8_filesystem::unlink(packageFileName.c_str());
             throw;
         }
 
-        Log::Infof("PackageManager: Package %s imported", task.packageId.c_str());
+        // Index and verify the package on an import worker, the next tasks can be processed meanwhile
+        importJob = [this, taskId, task, packageFileName, fileSize]() {
+            try {
+                if (isTaskCancelled(taskId)) {
+                    throw CancelException();
+                }
+
+                // Find package tiles and calculate tile mask
+                std::string tileMaskValue;
+                if (auto handler = PackageHandlerFactory(_serverEncKey, _localEncKey).createPackageHandler(task.packageType, packageFileName)) {
+                    tileMaskValue = EncodeTileMask(handler->calculateTileMask());
+                }
+
+                // Get package id
+                int id = -1;
+                {
+                    std::lock_guard<std::recursive_mutex> lock(_mutex);
+                    sqlite3pp::query query1(*_localDb, "SELECT id FROM packages WHERE package_id=:package_id AND version=:version");
+                    query1.bind(":package_id", task.packageId.c_str());
+                    query1.bind(":version", task.packageVersion);
+                    for (auto qit = query1.begin(); qit != query1.end(); qit++) {
+                        id = qit->get<int>(0);
+                    }
+                    if (id == -1) {
+                        sqlite3pp::command command(*_localDb, "INSERT INTO packages(package_id, package_type, version, size, server_url, tile_mask, metainfo, valid) VALUES(:package_id, :package_type, :version, :size, '', :tile_mask, '', 0)");
+                        command.bind(":package_id", task.packageId.c_str());
+                        command.bind(":package_type", static_cast<int>(task.packageType));
+                        command.bind(":version", task.packageVersion);
+                        command.bind(":size", fileSize);
+                        command.bind(":tile_mask", tileMaskValue.c_str());
+                        command.execute();
+                        id = static_cast<int>(_localDb->last_insert_rowid());
+                    }
+                }
+
+                // Import package
+                importLocalPackage(id, taskId, task.packageId, task.packageType, packageFileName);
+            }
+            catch (...) {
+                utf8_filesystem::unlink(packageFileName.c_str());
+                throw;
+            }
+
+            Log::Infof("PackageManager: Package %s imported", task.packageId.c_str());
+        };
         return true;
     }
 
-    bool PackageManager::downloadPackage(int taskId) {
+    bool PackageManager::downloadPackage(int taskId, std::function<void()>& importJob) {
         Task task = _taskQueue->getTask(taskId);
 
         // Find the package info
@@ -901,6 +992,7 @@ namespace carto {
 
         // Check if the package is already downloaded
         bool downloaded = false;
+        int baseVersion = -1;
         {
             std::lock_guard<std::recursive_mutex> lock(_mutex);
             sqlite3pp::query query(*_localDb, "SELECT version FROM packages WHERE package_id=:package_id AND valid=1");
@@ -911,72 +1003,105 @@ namespace carto {
                     return true;
                 }
                 downloaded = true;
+                baseVersion = qit->get<int>(0);
             }
         }
 
-        // Create new package file or reuse partly downloaded file
+        // When updating, try to apply a delta against the current version first. Full download is used as a fallback.
         bool packageSizeIndeterminate = package->getSize() == 0;
         std::string packageFileName = createLocalFilePath(createPackageFileName(task.packageId, task.packageType, task.packageVersion));
+        bool deltaApplied = false;
+        if (downloaded && baseVersion != -1 && task.packageVersion != -1 && baseVersion != task.packageVersion) {
+            deltaApplied = downloadPackageDelta(taskId, task, baseVersion, packageFileName);
+        }
+
+        // Create new package file or reuse partly downloaded file
         try {
             // Try to download the package
-            for (int retry = 0; true; retry++) {
-                if (retry > 0) {
-                    utf8_filesystem::unlink(packageFileName.c_str());
-                    Log::Infof("PackageManager: Retrying package %s download", task.packageId.c_str());
-                }
-                FILE* fpRaw = utf8_filesystem::fopen(packageFileName.c_str(), "ab");
-                if (!fpRaw) {
-                    throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM, std::string("Could not create download package file ") + packageFileName);
-                }
-                std::shared_ptr<FILE> fp(fpRaw, fclose);
-                utf8_filesystem::fseek64(fp.get(), 0, SEEK_END);
-                std::uint64_t fileOffset = utf8_filesystem::ftell64(fp.get());
+            bool rangeSupported = true;
+            for (int retry = 0; !deltaApplied; retry++) {
+                int errorCode = 0;
                 std::uint64_t fileSize = package->getSize();
-                if (!packageSizeIndeterminate && fileOffset == fileSize) {
-                    break;
-                }
-                if (fileSize > 0) {
-                    updateTaskStatus(taskId, PackageAction::PACKAGE_ACTION_DOWNLOADING, static_cast<float>(fileOffset) / static_cast<float>(fileSize));
-                }
+                if (!packageSizeIndeterminate && fileSize >= PARALLEL_DOWNLOAD_MIN_SIZE && rangeSupported) {
+                    // Download large packages as parallel chunks, when resuming only the missing chunks are downloaded
+                    if (retry > 0) {
+                        Log::Infof("PackageManager: Retrying package %s download", task.packageId.c_str());
+                    }
 
-                std::string packageURL = createPackageURL(task.packageId, task.packageVersion, task.packageLocation, downloaded);
-                if (packageURL.empty()) {
-                    throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_NO_OFFLINE_PLAN, "Offline packages not available");
-                }
-                int errorCode = DownloadFile(packageURL, [this, fp, taskId, packageFileName, &fileOffset, fileSize](std::uint64_t offset, std::uint64_t length, const unsigned char* buf, std::size_t size) {
-                    if (isTaskCancelled(taskId)) {
-                        return false;
+                    std::string packageURL = createPackageURL(task.packageId, task.packageVersion, task.packageLocation, downloaded);
+                    if (packageURL.empty()) {
+                        throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_NO_OFFLINE_PLAN, "Offline packages not available");
                     }
-                    if (isTaskPaused(taskId)) {
-                        return false;
+                    errorCode = downloadPackageChunks(taskId, packageURL, packageFileName, fileSize, rangeSupported);
+                    if (errorCode == 0) {
+                        updateTaskStatus(taskId, PackageAction::PACKAGE_ACTION_DOWNLOADING, 1.0f);
+                        break;
                     }
-
-                    if (offset != fileOffset) {
-                        Log::Infof("PackageManager: Truncating file");
-                        utf8_filesystem::fseek64(fp.get(), offset, SEEK_SET);
-                        utf8_filesystem::ftruncate64(fp.get(), offset);
+                    if (!rangeSupported) {
+                        Log::Infof("PackageManager: Range requests not supported for package %s, downloading sequentially", task.packageId.c_str());
+                        _taskQueue->deleteTaskChunks(taskId);
+                        utf8_filesystem::unlink(packageFileName.c_str());
+                        retry--;
+                        continue;
                     }
-                    if (fwrite(buf, sizeof(unsigned char), size, fp.get()) != size) {
-                        Log::Errorf("PackageManager: Storage full? Could not write to package file %s", packageFileName.c_str());
-                        return false;
+                } else {
+                    if (retry > 0) {
+                        utf8_filesystem::unlink(packageFileName.c_str());
+                        Log::Infof("PackageManager: Retrying package %s download", task.packageId.c_str());
                     }
-                    fileOffset = offset + size;
-                    std::uint64_t realSize = fileSize;
-                    if (fileSize == 0 && length != std::numeric_limits<std::uint64_t>::max()) {
-                        realSize = length;
+                    FILE* fpRaw = utf8_filesystem::fopen(packageFileName.c_str(), "ab");
+                    if (!fpRaw) {
+                        throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM, std::string("Could not create download package file ") + packageFileName);
                     }
-                    if (realSize > 0) {
-                        updateTaskStatus(taskId, PackageAction::PACKAGE_ACTION_DOWNLOADING, static_cast<float>(fileOffset) / static_cast<float>(realSize));
+                    std::shared_ptr<FILE> fp(fpRaw, fclose);
+                    utf8_filesystem::fseek64(fp.get(), 0, SEEK_END);
+                    std::uint64_t fileOffset = utf8_filesystem::ftell64(fp.get());
+                    if (!packageSizeIndeterminate && fileOffset == fileSize) {
+                        break;
+                    }
+                    if (fileSize > 0) {
+                        updateTaskStatus(taskId, PackageAction::PACKAGE_ACTION_DOWNLOADING, static_cast<float>(fileOffset) / static_cast<float>(fileSize));
                     }
-                    return true;
-                }, fileOffset);
 
-                if (errorCode == 0) {
-                    if (packageSizeIndeterminate || fileOffset == fileSize) {
-                        updateTaskStatus(taskId, PackageAction::PACKAGE_ACTION_DOWNLOADING, 1.0f);
-                        break;
+                    std::string packageURL = createPackageURL(task.packageId, task.packageVersion, task.packageLocation, downloaded);
+                    if (packageURL.empty()) {
+                        throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_NO_OFFLINE_PLAN, "Offline packages not available");
+                    }
+                    errorCode = DownloadFile(packageURL, [this, fp, taskId, packageFileName, &fileOffset, fileSize](std::uint64_t offset, std::uint64_t length, const unsigned char* buf, std::size_t size) {
+                        if (isTaskCancelled(taskId)) {
+                            return false;
+                        }
+                        if (isTaskPaused(taskId)) {
+                            return false;
+                        }
+
+                        if (offset != fileOffset) {
+                            Log::Infof("PackageManager: Truncating file");
+                            utf8_filesystem::fseek64(fp.get(), offset, SEEK_SET);
+                            utf8_filesystem::ftruncate64(fp.get(), offset);
+                        }
+                        if (fwrite(buf, sizeof(unsigned char), size, fp.get()) != size) {
+                            Log::Errorf("PackageManager: Storage full? Could not write to package file %s", packageFileName.c_str());
+                            return false;
+                        }
+                        fileOffset = offset + size;
+                        std::uint64_t realSize = fileSize;
+                        if (fileSize == 0 && length != std::numeric_limits<std::uint64_t>::max()) {
+                            realSize = length;
+                        }
+                        if (realSize > 0) {
+                            updateTaskStatus(taskId, PackageAction::PACKAGE_ACTION_DOWNLOADING, static_cast<float>(fileOffset) / static_cast<float>(realSize));
+                        }
+                        return true;
+                    }, fileOffset);
+
+                    if (errorCode == 0) {
+                        if (packageSizeIndeterminate || fileOffset == fileSize) {
+                            updateTaskStatus(taskId, PackageAction::PACKAGE_ACTION_DOWNLOADING, 1.0f);
+                            break;
+                        }
+                        Log::Errorf("PackageManager: File size mismatch for package %s (expected %lld, actual %lld)", task.packageId.c_str(), static_cast<long long>(fileSize), static_cast<long long>(fileOffset));
                     }
-                    Log::Errorf("PackageManager: File size mismatch for package %s (expected %lld, actual %lld)", task.packageId.c_str(), static_cast<long long>(fileSize), static_cast<long long>(fileOffset));
                 }
                 if (isTaskCancelled(taskId)) {
                     throw CancelException();
@@ -1000,68 +1125,308 @@ namespace carto {
                 }
             }
 
-            // Get package id, create package record
-            int id = -1;
-            {
-                std::lock_guard<std::recursive_mutex> lock(_mutex);
-                sqlite3pp::query query(*_localDb, "SELECT id FROM packages WHERE package_id=:package_id AND version=:version");
-                query.bind(":package_id", task.packageId.c_str());
-                query.bind(":version", task.packageVersion);
-                for (auto qit = query.begin(); qit != query.end(); qit++) {
-                    id = qit->get<int>(0);
+        }
+        catch (const PauseException&) {
+            throw;
+        }
+        catch (const CancelException&) {
+            utf8_filesystem::unlink(packageFileName.c_str());
+            throw;
+        }
+        catch (...) {
+            utf8_filesystem::unlink(packageFileName.c_str());
+            throw;
+        }
+
+        // Index and verify the package on an import worker, the next downloads can proceed meanwhile
+        importJob = [this, taskId, task, package, packageSizeIndeterminate, deltaApplied, packageFileName]() {
+            try {
+                if (isTaskCancelled(taskId)) {
+                    throw CancelException();
                 }
-                if (id == -1) {
-                    std::string metaInfo;
-                    if (package->getMetaInfo()) {
-                        metaInfo = package->getMetaInfo()->getVariant().toString();
-                    }
-                    std::string tileMaskValue;
-                    if (package->getTileMask()) {
-                        tileMaskValue = EncodeTileMask(package->getTileMask());
-                    } else if (auto handler = PackageHandlerFactory(_serverEncKey, _localEncKey).createPackageHandler(task.packageType, packageFileName)) {
-                        tileMaskValue = EncodeTileMask(handler->calculateTileMask());
+
+                // Calculate tile mask, if not provided. This does not need the lock.
+                std::string tileMaskValue;
+                if (package->getTileMask()) {
+                    tileMaskValue = EncodeTileMask(package->getTileMask());
+                } else if (auto handler = PackageHandlerFactory(_serverEncKey, _localEncKey).createPackageHandler(task.packageType, packageFileName)) {
+                    tileMaskValue = EncodeTileMask(handler->calculateTileMask());
+                }
+
+                // Get package id, create package record
+                int id = -1;
+                {
+                    std::lock_guard<std::recursive_mutex> lock(_mutex);
+                    sqlite3pp::query query(*_localDb, "SELECT id FROM packages WHERE package_id=:package_id AND version=:version");
+                    query.bind(":package_id", task.packageId.c_str());
+                    query.bind(":version", task.packageVersion);
+                    for (auto qit = query.begin(); qit != query.end(); qit++) {
+                        id = qit->get<int>(0);
                     }
-                    std::uint64_t fileSize = package->getSize();
-                    if (packageSizeIndeterminate) {
-                        FILE* fpRaw = utf8_filesystem::fopen(packageFileName.c_str(), "rb");
-                        if (fpRaw) {
-                            std::shared_ptr<FILE> fp(fpRaw, fclose);
-                            utf8_filesystem::fseek64(fp.get(), 0, SEEK_END);
-                            fileSize = utf8_filesystem::ftell64(fp.get());
+                    if (id == -1) {
+                        std::string metaInfo;
+                        if (package->getMetaInfo()) {
+                            metaInfo = package->getMetaInfo()->getVariant().toString();
                         }
+                        std::uint64_t fileSize = package->getSize();
+                        if (packageSizeIndeterminate || deltaApplied) {
+                            FILE* fpRaw = utf8_filesystem::fopen(packageFileName.c_str(), "rb");
+                            if (fpRaw) {
+                                std::shared_ptr<FILE> fp(fpRaw, fclose);
+                                utf8_filesystem::fseek64(fp.get(), 0, SEEK_END);
+                                fileSize = utf8_filesystem::ftell64(fp.get());
+                            }
+                        }
+                        sqlite3pp::command command(*_localDb, "INSERT INTO packages(package_id, package_type, version, size, server_url, tile_mask, metainfo, valid) VALUES(:package_id, :package_type, :version, :size, :server_url, :tile_mask, :metainfo, 0)");
+                        command.bind(":package_id", package->getPackageId().c_str());
+                        command.bind(":package_type", static_cast<int>(package->getPackageType()));
+                        command.bind(":version", package->getVersion());
+                        command.bind(":size", fileSize);
+                        command.bind(":server_url", package->getServerURL().c_str());
+                        command.bind(":tile_mask", tileMaskValue.c_str());
+                        command.bind(":metainfo", metaInfo.c_str());
+                        command.execute();
+                        id = static_cast<int>(_localDb->last_insert_rowid());
                     }
-                    sqlite3pp::command command(*_localDb, "INSERT INTO packages(package_id, package_type, version, size, server_url, tile_mask, metainfo, valid) VALUES(:package_id, :package_type, :version, :size, :server_url, :tile_mask, :metainfo, 0)");
-                    command.bind(":package_id", package->getPackageId().c_str());
-                    command.bind(":package_type", static_cast<int>(package->getPackageType()));
-                    command.bind(":version", package->getVersion());
-                    command.bind(":size", fileSize);
-                    command.bind(":server_url", package->getServerURL().c_str());
-                    command.bind(":tile_mask", tileMaskValue.c_str());
-                    command.bind(":metainfo", metaInfo.c_str());
-                    command.execute();
-                    id = static_cast<int>(_localDb->last_insert_rowid());
                 }
+
+                // Import download package
+                importLocalPackage(id, taskId, task.packageId, task.packageType, packageFileName);
+            }
+            catch (...) {
+                utf8_filesystem::unlink(packageFileName.c_str());
+                throw;
             }
 
-            // Import download package
-            importLocalPackage(id, taskId, task.packageId, task.packageType, packageFileName);
+            Log::Infof("PackageManager: Package %s downloaded", task.packageId.c_str());
+        };
+        return true;
+    }
+
+    bool PackageManager::downloadPackageDelta(int taskId, const Task& task, int baseVersion, const std::string& packageFileName) {
+        std::string deltaURL = createPackageDeltaURL(task.packageId, baseVersion, task.packageVersion, task.packageLocation);
+        if (deltaURL.empty()) {
+            return false;
         }
-        catch (const PauseException&) {
-            throw;
+        std::shared_ptr<PackageHandler> handler = PackageHandlerFactory(_serverEncKey, _localEncKey).createPackageHandler(task.packageType, packageFileName);
+        if (!handler) {
+            return false;
         }
-        catch (const CancelException&) {
-            utf8_filesystem::unlink(packageFileName.c_str());
-            throw;
+
+        // Do not interfere with a partly downloaded full package
+        if (FILE* fpRaw = utf8_filesystem::fopen(packageFileName.c_str(), "rb")) {
+            fclose(fpRaw);
+            return false;
+        }
+
+        std::string basePackageFileName = createLocalFilePath(createPackageFileName(task.packageId, task.packageType, baseVersion));
+        std::string deltaFileName = packageFileName + ".delta";
+        try {
+            // Download the delta. Deltas are small compared to packages, so interrupted downloads are simply restarted.
+            {
+                FILE* fpRaw = utf8_filesystem::fopen(deltaFileName.c_str(), "wb");
+                if (!fpRaw) {
+                    Log::Errorf("PackageManager: Could not create delta file %s", deltaFileName.c_str());
+                    return false;
+                }
+                std::shared_ptr<FILE> fp(fpRaw, fclose);
+                std::uint64_t fileOffset = 0;
+                int errorCode = DownloadFile(deltaURL, [this, fp, taskId, &deltaFileName, &fileOffset](std::uint64_t offset, std::uint64_t length, const unsigned char* buf, std::size_t size) {
+                    if (isTaskCancelled(taskId)) {
+                        return false;
+                    }
+                    if (isTaskPaused(taskId)) {
+                        return false;
+                    }
+
+                    if (offset != fileOffset) {
+                        utf8_filesystem::fseek64(fp.get(), offset, SEEK_SET);
+                        utf8_filesystem::ftruncate64(fp.get(), offset);
+                    }
+                    if (fwrite(buf, sizeof(unsigned char), size, fp.get()) != size) {
+                        Log::Errorf("PackageManager: Storage full? Could not write to delta file %s", deltaFileName.c_str());
+                        return false;
+                    }
+                    fileOffset = offset + size;
+                    if (length > 0 && length != std::numeric_limits<std::uint64_t>::max()) {
+                        updateTaskStatus(taskId, PackageAction::PACKAGE_ACTION_DOWNLOADING, static_cast<float>(fileOffset) / static_cast<float>(length));
+                    }
+                    return true;
+                });
+
+                if (isTaskCancelled(taskId)) {
+                    throw CancelException();
+                }
+                if (isTaskPaused(taskId)) {
+                    throw PauseException();
+                }
+                if (errorCode != 0) {
+                    Log::Infof("PackageManager: Delta for package %s not available (error %d), downloading full package", task.packageId.c_str(), errorCode);
+                    utf8_filesystem::unlink(deltaFileName.c_str());
+                    return false;
+                }
+            }
+
+            // Apply the delta to a copy of the current package, the current package stays in use until the import
+            if (!CopyLocalFile(basePackageFileName, packageFileName) || !handler->applyPackageDelta(deltaFileName, baseVersion)) {
+                Log::Infof("PackageManager: Failed to apply delta for package %s, downloading full package", task.packageId.c_str());
+                utf8_filesystem::unlink(deltaFileName.c_str());
+                utf8_filesystem::unlink(packageFileName.c_str());
+                return false;
+            }
         }
         catch (...) {
+            utf8_filesystem::unlink(deltaFileName.c_str());
             utf8_filesystem::unlink(packageFileName.c_str());
             throw;
         }
+        utf8_filesystem::unlink(deltaFileName.c_str());
 
-        Log::Infof("PackageManager: Package %s downloaded", task.packageId.c_str());
+        updateTaskStatus(taskId, PackageAction::PACKAGE_ACTION_DOWNLOADING, 1.0f);
+        Log::Infof("PackageManager: Package %s updated from version %d using delta", task.packageId.c_str(), baseVersion);
         return true;
     }
 
+    int PackageManager::downloadPackageChunks(int taskId, const std::string& packageURL, const std::string& packageFileName, std::uint64_t fileSize, bool& rangeSupported) {
+        // Reuse the chunk list of an interrupted download, if its layout matches. Otherwise start from scratch.
+        std::vector<TaskChunk> chunks = _taskQueue->getTaskChunks(taskId);
+        std::uint64_t chunksSize = 0;
+        for (const TaskChunk& chunk : chunks) {
+            chunksSize += chunk.size;
+        }
+        bool fileExists = false;
+        if (FILE* fpRaw = utf8_filesystem::fopen(packageFileName.c_str(), "rb")) {
+            fileExists = true;
+            fclose(fpRaw);
+        }
+        if (chunks.empty() || chunksSize != fileSize || !fileExists) {
+            chunks.clear();
+            for (std::uint64_t offset = 0; offset < fileSize; offset += PARALLEL_DOWNLOAD_CHUNK_SIZE) {
+                TaskChunk chunk;
+                chunk.offset = offset;
+                chunk.size = std::min(fileSize - offset, static_cast<std::uint64_t>(PARALLEL_DOWNLOAD_CHUNK_SIZE));
+                chunks.push_back(chunk);
+            }
+            _taskQueue->createTaskChunks(taskId, chunks);
+
+            FILE* fpRaw = utf8_filesystem::fopen(packageFileName.c_str(), "wb");
+            if (!fpRaw) {
+                throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM, std::string("Could not create download package file ") + packageFileName);
+            }
+            std::shared_ptr<FILE> fp(fpRaw, fclose);
+            utf8_filesystem::ftruncate64(fp.get(), fileSize);
+        }
+
+        // Verify the checksums of the downloaded chunks, the file may have been modified or only partially flushed
+        std::vector<TaskChunk> pendingChunks;
+        std::uint64_t downloadedSize = 0;
+        {
+            FILE* fpRaw = utf8_filesystem::fopen(packageFileName.c_str(), "rb");
+            if (!fpRaw) {
+                throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM, std::string("Could not open download package file ") + packageFileName);
+            }
+            std::shared_ptr<FILE> fp(fpRaw, fclose);
+            for (const TaskChunk& chunk : chunks) {
+                if (chunk.checksum != -1 && CalculateFileChecksum(fp.get(), chunk.offset, chunk.size) == chunk.checksum) {
+                    downloadedSize += chunk.size;
+                    continue;
+                }
+                if (chunk.checksum != -1) {
+                    Log::Warnf("PackageManager: Checksum mismatch for package file %s chunk at %lld, downloading again", packageFileName.c_str(), static_cast<long long>(chunk.offset));
+                    _taskQueue->setTaskChunkChecksum(taskId, chunk.offset, -1);
+                }
+                pendingChunks.push_back(chunk);
+            }
+        }
+        updateTaskStatus(taskId, PackageAction::PACKAGE_ACTION_DOWNLOADING, static_cast<float>(downloadedSize) / static_cast<float>(fileSize));
+
+        // Download the pending chunks using multiple connections, each worker writes directly to its chunk in the file
+        std::size_t nextChunkIndex = 0;
+        int errorCode = 0;
+        bool aborted = false;
+        std::mutex mutex;
+
+        auto downloadChunks = [&]() {
+            FILE* fpRaw = utf8_filesystem::fopen(packageFileName.c_str(), "r+b");
+            if (!fpRaw) {
+                std::lock_guard<std::mutex> lock(mutex);
+                Log::Errorf("PackageManager: Could not open package file %s for writing", packageFileName.c_str());
+                errorCode = (errorCode == 0 ? -1 : errorCode);
+                aborted = true;
+                return;
+            }
+            std::shared_ptr<FILE> fp(fpRaw, fclose);
+
+            while (true) {
+                TaskChunk chunk;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (aborted || nextChunkIndex >= pendingChunks.size()) {
+                        return;
+                    }
+                    chunk = pendingChunks[nextChunkIndex++];
+                }
+
+                utf8_filesystem::fseek64(fp.get(), chunk.offset, SEEK_SET);
+                std::uint64_t chunkOffset = chunk.offset;
+                uLong checksum = crc32(0L, Z_NULL, 0);
+                bool chunkRangeSupported = true;
+                int chunkErrorCode = DownloadFile(packageURL, [&](std::uint64_t offset, std::uint64_t length, const unsigned char* buf, std::size_t size) {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (aborted) {
+                            return false;
+                        }
+                    }
+                    if (isTaskCancelled(taskId) || isTaskPaused(taskId)) {
+                        return false;
+                    }
+
+                    if (offset != chunkOffset || offset + size > chunk.offset + chunk.size) {
+                        chunkRangeSupported = false; // the server ignored the requested range
+                        return false;
+                    }
+                    if (fwrite(buf, sizeof(unsigned char), size, fp.get()) != size) {
+                        Log::Errorf("PackageManager: Storage full? Could not write to package file %s", packageFileName.c_str());
+                        return false;
+                    }
+                    checksum = crc32(checksum, buf, static_cast<uInt>(size));
+                    chunkOffset += size;
+
+                    std::lock_guard<std::mutex> lock(mutex);
+                    downloadedSize += size;
+                    updateTaskStatus(taskId, PackageAction::PACKAGE_ACTION_DOWNLOADING, static_cast<float>(downloadedSize) / static_cast<float>(fileSize));
+                    return true;
+                }, chunk.offset, chunk.size);
+
+                if (chunkErrorCode == 0 && chunkOffset == chunk.offset + chunk.size && fflush(fp.get()) == 0) {
+                    _taskQueue->setTaskChunkChecksum(taskId, chunk.offset, static_cast<long long>(checksum));
+                    continue;
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                if (!chunkRangeSupported) {
+                    rangeSupported = false;
+                }
+                if (errorCode == 0) {
+                    errorCode = (chunkErrorCode != 0 ? chunkErrorCode : -1);
+                }
+                aborted = true;
+                return;
+            }
+        };
+
+        std::vector<std::shared_ptr<std::thread> > threads;
+        for (int i = 1; i < PARALLEL_DOWNLOAD_THREADS && i < static_cast<int>(pendingChunks.size()); i++) {
+            threads.push_back(std::make_shared<std::thread>(downloadChunks));
+        }
+        downloadChunks();
+        for (const std::shared_ptr<std::thread>& thread : threads) {
+            thread->join();
+        }
+        return errorCode;
+    }
+
     bool PackageManager::removePackage(int taskId) {
         Task task = _taskQueue->getTask(taskId);
 
@@ -1145,7 +1510,12 @@ namespace carto {
             }
 
             // Update packages, sync caches
+            std::vector<std::shared_ptr<PackageTileMask> > tileMasks;
+            for (const std::shared_ptr<PackageInfo>& packageInfo : packages) {
+                tileMasks.push_back(packageInfo->getTileMask());
+            }
             std::swap(_localPackages, packages);
+            _localPackageTileIndex = std::make_shared<PackageTileIndex>(tileMasks);
             _packageHandlerCache.clear();
         }
         catch (const std::exception& ex) {
@@ -1230,7 +1600,7 @@ namespace carto {
         if (_stopped) {
             return true;
         }
-        return _taskQueue->getActiveTaskId(taskId) != taskId;
+        return _taskQueue->getActiveTaskId(taskId, _importTaskIds) != taskId;
     }
 
     void PackageManager::updateTaskStatus(int taskId, PackageAction::PackageAction action, float progress) {
@@ -1377,6 +1747,10 @@ namespace carto {
         return baseURL;
     }
 
+    std::string PackageManager::createPackageDeltaURL(const std::string& packageId, int baseVersion, int version, const std::string& baseURL) const {
+        return std::string(); // deltas not supported
+    }
+
     std::shared_ptr<PackageInfo> PackageManager::getCustomPackage(const std::string& packageId, int version) const {
         return std::shared_ptr<PackageInfo>();
     }
@@ -1409,6 +1783,22 @@ namespace carto {
         }
     }
 
+    std::shared_ptr<PackageTileIndex> PackageManager::getServerPackageTileIndex(std::vector<std::shared_ptr<PackageInfo> >& packages) const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+        // The package list and the index are read under the same lock, so that the mask indices match the packages
+        packages = getServerPackages();
+        if (!_serverPackageTileIndex) {
+            std::vector<std::shared_ptr<PackageTileMask> > tileMasks;
+            tileMasks.reserve(packages.size());
+            for (const std::shared_ptr<PackageInfo>& packageInfo : packages) {
+                tileMasks.push_back(packageInfo->getTileMask());
+            }
+            _serverPackageTileIndex = std::make_shared<PackageTileIndex>(tileMasks);
+        }
+        return _serverPackageTileIndex;
+    }
+
     std::string PackageManager::loadPackageListJson(const std::string& jsonFileName) const {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
         std::string packageListFileName = createLocalFilePath(jsonFileName);
@@ -1447,6 +1837,7 @@ namespace carto {
             throw PackageException(PackageErrorType::PACKAGE_ERROR_TYPE_SYSTEM, std::string("Could not rename package list file ") + tempPackageListFileName);
         }
         _serverPackageCache.reset();
+        _serverPackageTileIndex.reset();
     }
 
     void PackageManager::InitializeDb(sqlite3pp::database& db, const std::string& encKey) {
@@ -1543,9 +1934,53 @@ namespace carto {
         return tileMask->getStringValue() + ":" + boost::lexical_cast<std::string>(tileMask->getMaxZoomLevel());
     }
 
-    int PackageManager::DownloadFile(const std::string& url, NetworkUtils::HandlerFunc handler, std::uint64_t offset) {
+    long long PackageManager::CalculateFileChecksum(FILE* fp, std::uint64_t offset, std::uint64_t size) {
+        if (utf8_filesystem::fseek64(fp, offset, SEEK_SET) != 0) {
+            return -1;
+        }
+        uLong checksum = crc32(0L, Z_NULL, 0);
+        std::vector<unsigned char> buf(65536);
+        while (size > 0) {
+            std::size_t readSize = static_cast<std::size_t>(std::min(size, static_cast<std::uint64_t>(buf.size())));
+            if (fread(buf.data(), sizeof(unsigned char), readSize, fp) != readSize) {
+                return -1;
+            }
+            checksum = crc32(checksum, buf.data(), static_cast<uInt>(readSize));
+            size -= readSize;
+        }
+        return static_cast<long long>(checksum);
+    }
+
+    bool PackageManager::CopyLocalFile(const std::string& srcFileName, const std::string& destFileName) {
+        FILE* fpSrcRaw = utf8_filesystem::fopen(srcFileName.c_str(), "rb");
+        if (!fpSrcRaw) {
+            return false;
+        }
+        std::shared_ptr<FILE> fpSrc(fpSrcRaw, fclose);
+        FILE* fpDestRaw = utf8_filesystem::fopen(destFileName.c_str(), "wb");
+        if (!fpDestRaw) {
+            return false;
+        }
+        std::shared_ptr<FILE> fpDest(fpDestRaw, fclose);
+        std::vector<unsigned char> buf(65536);
+        while (true) {
+            std::size_t readSize = fread(buf.data(), sizeof(unsigned char), buf.size(), fpSrc.get());
+            if (readSize == 0) {
+                return ferror(fpSrc.get()) == 0;
+            }
+            if (fwrite(buf.data(), sizeof(unsigned char), readSize, fpDest.get()) != readSize) {
+                Log::Errorf("PackageManager: Storage full? Could not write to package file %s", destFileName.c_str());
+                return false;
+            }
+        }
+    }
+
+    int PackageManager::DownloadFile(const std::string& url, NetworkUtils::HandlerFunc handler, std::uint64_t offset, std::uint64_t length) {
         Log::Debugf("PackageManager::DownloadFile: %s", url.c_str());
         std::map<std::string, std::string> requestHeaders = NetworkUtils::CreateAppRefererHeader();
+        if (length > 0) {
+            requestHeaders["Range"] = "bytes=" + boost::lexical_cast<std::string>(offset) + "-" + boost::lexical_cast<std::string>(offset + length - 1);
+        }
         std::map<std::string, std::string> responseHeaders;
         return NetworkUtils::StreamHTTPResponse("GET", url, requestHeaders, responseHeaders, handler, offset, Log::IsShowDebug());
     }
@@ -1568,25 +2003,41 @@ namespace carto {
                     package_location TEXT
                 ))SQL");
         _localDb->execute("CREATE INDEX IF NOT EXISTS manager_tasks_package_id ON manager_tasks(package_id)");
+
+        _localDb->execute(R"SQL(
+                CREATE TABLE IF NOT EXISTS manager_task_chunks (
+                    task_id INTEGER NOT NULL,
+                    chunk_offset INTEGER NOT NULL,
+                    chunk_size INTEGER NOT NULL,
+                    checksum INTEGER NOT NULL DEFAULT -1,
+                    PRIMARY KEY (task_id, chunk_offset)
+                ))SQL");
     }
 
-    int PackageManager::PersistentTaskQueue::getActiveTaskId(int currentActiveTaskId) const {
+    int PackageManager::PersistentTaskQueue::getActiveTaskId(int currentActiveTaskId, const std::set<int>& excludedTaskIds) const {
         // Find task with highest priority. Do not process paused tasks (priority < 0) unless they are cancelled. Cancelled tasks should be always processed.
         std::lock_guard<std::recursive_mutex> lock(_mutex);
-        sqlite3pp::query query(*_localDb, "SELECT id, package_id, (CASE WHEN id=:active_id THEN -1 ELSE id END) as ordering FROM manager_tasks WHERE priority>=0 OR cancelled=1 ORDER BY priority DESC, ordering ASC LIMIT 1");
+        sqlite3pp::query query(*_localDb, "SELECT id, package_id, (CASE WHEN id=:active_id THEN -1 ELSE id END) as ordering FROM manager_tasks WHERE priority>=0 OR cancelled=1 ORDER BY priority DESC, ordering ASC");
         query.bind(":active_id", currentActiveTaskId);
         for (auto qit = query.begin(); qit != query.end(); qit++) {
             int taskId = qit->get<int>(0);
             const char* packageId = qit->get<const char*>(1);
             if (!packageId) {
+                if (excludedTaskIds.find(taskId) != excludedTaskIds.end()) {
+                    continue;
+                }
                 return taskId;
             }
 
             // This is a package task - package tasks have to be processed in-order, so take the first task with the same package (even if it is paused).
+            // If the first task is excluded (being imported), the other tasks of the package must wait for it.
             sqlite3pp::query query2(*_localDb, "SELECT id FROM manager_tasks WHERE package_id=:package_id ORDER BY id ASC LIMIT 1");
             query2.bind(":package_id", packageId);
             for (auto qit2 = query2.begin(); qit2 != query2.end(); qit2++) {
-                return qit2->get<int>(0);
+                int firstTaskId = qit2->get<int>(0);
+                if (excludedTaskIds.find(firstTaskId) == excludedTaskIds.end()) {
+                    return firstTaskId;
+                }
             }
         }
         return -1;
@@ -1675,6 +2126,59 @@ namespace carto {
         sqlite3pp::command command(*_localDb, "DELETE FROM manager_tasks WHERE id=:task_id");
         command.bind(":task_id", taskId);
         command.execute();
+        deleteTaskChunks(taskId);
+    }
+
+    std::vector<PackageManager::TaskChunk> PackageManager::PersistentTaskQueue::getTaskChunks(int taskId) const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        sqlite3pp::query query(*_localDb, "SELECT chunk_offset, chunk_size, checksum FROM manager_task_chunks WHERE task_id=:task_id ORDER BY chunk_offset ASC");
+        query.bind(":task_id", taskId);
+        std::vector<TaskChunk> chunks;
+        for (auto qit = query.begin(); qit != query.end(); qit++) {
+            TaskChunk chunk;
+            chunk.offset = static_cast<std::uint64_t>(qit->get<long long>(0));
+            chunk.size = static_cast<std::uint64_t>(qit->get<long long>(1));
+            chunk.checksum = qit->get<long long>(2);
+            chunks.push_back(chunk);
+        }
+        return chunks;
+    }
+
+    void PackageManager::PersistentTaskQueue::createTaskChunks(int taskId, const std::vector<TaskChunk>& chunks) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        sqlite3pp::transaction xct(*_localDb);
+        {
+            sqlite3pp::command deleteCommand(*_localDb, "DELETE FROM manager_task_chunks WHERE task_id=:task_id");
+            deleteCommand.bind(":task_id", taskId);
+            deleteCommand.execute();
+
+            sqlite3pp::command command(*_localDb, "INSERT INTO manager_task_chunks(task_id, chunk_offset, chunk_size, checksum) VALUES(:task_id, :chunk_offset, :chunk_size, :checksum)");
+            for (const TaskChunk& chunk : chunks) {
+                command.bind(":task_id", taskId);
+                command.bind(":chunk_offset", static_cast<long long>(chunk.offset));
+                command.bind(":chunk_size", static_cast<long long>(chunk.size));
+                command.bind(":checksum", chunk.checksum);
+                command.execute();
+                command.reset();
+            }
+        }
+        xct.commit();
+    }
+
+    void PackageManager::PersistentTaskQueue::setTaskChunkChecksum(int taskId, std::uint64_t chunkOffset, long long checksum) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        sqlite3pp::command command(*_localDb, "UPDATE manager_task_chunks SET checksum=:checksum WHERE task_id=:task_id AND chunk_offset=:chunk_offset");
+        command.bind(":task_id", taskId);
+        command.bind(":chunk_offset", static_cast<long long>(chunkOffset));
+        command.bind(":checksum", checksum);
+        command.execute();
+    }
+
+    void PackageManager::PersistentTaskQueue::deleteTaskChunks(int taskId) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        sqlite3pp::command command(*_localDb, "DELETE FROM manager_task_chunks WHERE task_id=:task_id");
+        command.bind(":task_id", taskId);
+        command.execute();
     }
 
     const int PackageManager::DEFAULT_TILEMASK_ZOOMLEVEL = 14;
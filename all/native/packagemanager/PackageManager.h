@@ -22,8 +22,12 @@
 
 #include <string>
 #include <cstdint>
+#include <cstdio>
 #include <vector>
 #include <memory>
+#include <deque>
+#include <set>
+#include <functional>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
@@ -39,6 +43,7 @@ namespace carto {
     class BinaryData;
     class Projection;
     class PackageHandler;
+    class PackageTileIndex;
 
     /**
      * Base class for offline map package manager. Package manager supports downloading/removing packages.
@@ -242,6 +247,7 @@ namespace carto {
         virtual std::string createPackageFileName(const std::string& packageId, PackageType::PackageType packageType, int version) const;
         virtual std::string createPackageListURL(const std::string& baseURL) const;
         virtual std::string createPackageURL(const std::string& packageId, int version, const std::string& baseURL, bool downloaded) const;
+        virtual std::string createPackageDeltaURL(const std::string& packageId, int baseVersion, int version, const std::string& baseURL) const;
         
         virtual std::shared_ptr<PackageInfo> getCustomPackage(const std::string& packageId, int version) const;
 
@@ -271,11 +277,17 @@ namespace carto {
             std::string packageLocation;
         };
 
+        struct TaskChunk {
+            std::uint64_t offset = 0;
+            std::uint64_t size = 0;
+            long long checksum = -1; // -1 if the chunk is not downloaded yet
+        };
+
         class PersistentTaskQueue {
         public:
             PersistentTaskQueue(const std::string& dbFileName);
 
-            int getActiveTaskId(int currentActiveTaskId = -1) const;
+            int getActiveTaskId(int currentActiveTaskId = -1, const std::set<int>& excludedTaskIds = std::set<int>()) const;
             std::vector<int> getTaskIds() const;
             Task getTask(int taskId) const;
 
@@ -286,6 +298,11 @@ namespace carto {
             void updateTaskStatus(int taskId, PackageAction::PackageAction action, float progress);
             void deleteTask(int taskId);
 
+            std::vector<TaskChunk> getTaskChunks(int taskId) const;
+            void createTaskChunks(int taskId, const std::vector<TaskChunk>& chunks);
+            void setTaskChunkChecksum(int taskId, std::uint64_t chunkOffset, long long checksum);
+            void deleteTaskChunks(int taskId);
+
         private:
             std::shared_ptr<sqlite3pp::database> _localDb;
             mutable std::recursive_mutex _mutex;
@@ -308,10 +325,16 @@ namespace carto {
         };
 
         void run();
+        void runImports();
+
+        void executeTask(int taskId, const std::function<bool()>& handler);
+        void scheduleImport(int taskId, const std::function<void()>& importJob);
 
         bool downloadPackageList(int taskId);
-        bool importPackage(int taskId);
-        bool downloadPackage(int taskId);
+        bool importPackage(int taskId, std::function<void()>& importJob);
+        bool downloadPackage(int taskId, std::function<void()>& importJob);
+        bool downloadPackageDelta(int taskId, const Task& task, int baseVersion, const std::string& packageFileName);
+        int downloadPackageChunks(int taskId, const std::string& packageURL, const std::string& packageFileName, std::uint64_t fileSize, bool& rangeSupported);
         bool removePackage(int taskId);
         bool downloadStyle(int taskId);
         
@@ -327,6 +350,8 @@ namespace carto {
         void setTaskCancelled(int taskId);
         void setTaskFailed(int taskId, PackageErrorType::PackageErrorType errorType);
 
+        std::shared_ptr<PackageTileIndex> getServerPackageTileIndex(std::vector<std::shared_ptr<PackageInfo> >& packages) const;
+
         std::string loadPackageListJson(const std::string& jsonFileName) const;
         void savePackageListJson(const std::string& jsonFileName, const std::string& json) const;
 
@@ -339,9 +364,17 @@ namespace carto {
         static std::shared_ptr<PackageTileMask> DecodeTileMask(const std::string& tileMaskStr);
         static std::string EncodeTileMask(const std::shared_ptr<PackageTileMask>& tileMask);
 
-        static int DownloadFile(const std::string& url, NetworkUtils::HandlerFunc handler, std::uint64_t offset = 0);
+        static long long CalculateFileChecksum(FILE* fp, std::uint64_t offset, std::uint64_t size);
+        static bool CopyLocalFile(const std::string& srcFileName, const std::string& destFileName);
+
+        static int DownloadFile(const std::string& url, NetworkUtils::HandlerFunc handler, std::uint64_t offset = 0, std::uint64_t length = 0);
 
         static const int DEFAULT_TILEMASK_ZOOMLEVEL;
+        static const int PARALLEL_DOWNLOAD_THREADS = 4;
+        static const int PARALLEL_DOWNLOAD_CHUNK_SIZE = 4 * 1024 * 1024;
+        static const int PARALLEL_DOWNLOAD_MIN_SIZE = 16 * 1024 * 1024;
+        static const int IMPORT_THREADS = 2;
+        static const int MAX_PENDING_IMPORTS = 4;
 
         const std::string _packageListURL;
         const std::string _packageListFileName;
@@ -350,10 +383,15 @@ namespace carto {
         const std::string _localEncKey;
 
         std::vector<std::shared_ptr<PackageInfo> > _localPackages;
+        std::shared_ptr<PackageTileIndex> _localPackageTileIndex; // built from the tile masks of _localPackages
         std::shared_ptr<sqlite3pp::database> _localDb;
         std::shared_ptr<PersistentTaskQueue> _taskQueue;
         std::condition_variable_any _taskQueueCondition; // notified when new tasks are available
         std::shared_ptr<std::thread> _packageManagerThread;
+        std::deque<std::pair<int, std::function<void()> > > _importQueue;
+        std::set<int> _importTaskIds; // tasks queued for import or being imported, the main thread skips these
+        std::condition_variable_any _importQueueCondition; // notified when new imports are available
+        std::vector<std::shared_ptr<std::thread> > _importThreads;
         std::vector<std::shared_ptr<OnChangeListener> > _onChangeListeners;
         bool _stopped;
 
@@ -364,6 +402,7 @@ namespace carto {
         ThreadSafeDirectorPtr<PackageManagerListener> _packageManagerListener;
 
         mutable std::shared_ptr<std::vector<std::shared_ptr<PackageInfo> > > _serverPackageCache;
+        mutable std::shared_ptr<PackageTileIndex> _serverPackageTileIndex; // built from the tile masks of _serverPackageCache
         mutable std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<PackageHandler> > _packageHandlerCache;
 
         mutable std::recursive_mutex _mutex; // guards all state
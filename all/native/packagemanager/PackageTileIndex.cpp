@@ -0,0 +1,109 @@
+#ifdef _CARTO_PACKAGEMANAGER_SUPPORT
+
+#include "PackageTileIndex.h"
+
+#include <algorithm>
+
+namespace carto {
+
+    PackageTileIndex::PackageTileIndex(const std::vector<std::shared_ptr<PackageTileMask> >& tileMasks) :
+        _rootNode(std::make_shared<IndexNode>()),
+        _maxZoomLevels()
+    {
+        for (std::size_t i = 0; i < tileMasks.size(); i++) {
+            const std::shared_ptr<PackageTileMask>& tileMask = tileMasks[i];
+            _maxZoomLevels.push_back(tileMask ? tileMask->getMaxZoomLevel() : -1);
+            if (tileMask && tileMask->_nodeCount > 0) {
+                AddTileNode(*_rootNode, *tileMask, 0, static_cast<int>(i));
+            }
+        }
+    }
+
+    std::vector<int> PackageTileIndex::findTileMasks(const MapTile& tile) const {
+        std::vector<int> maskIndices;
+        const IndexNode* node = _rootNode.get();
+        for (int zoom = 0; node; zoom++) {
+            if (zoom == tile.getZoom()) {
+                maskIndices.insert(maskIndices.end(), node->insideMasks.begin(), node->insideMasks.end());
+                maskIndices.insert(maskIndices.end(), node->leafInsideMasks.begin(), node->leafInsideMasks.end());
+                break;
+            }
+            maskIndices.insert(maskIndices.end(), node->leafInsideMasks.begin(), node->leafInsideMasks.end());
+
+            int shift = tile.getZoom() - zoom - 1;
+            int dx = (tile.getX() >> shift) & 1;
+            int dy = (tile.getY() >> shift) & 1;
+            node = node->subNodes[dy * 2 + dx].get();
+        }
+
+        // Masks do not cover tiles above their maximum zoom level
+        maskIndices.erase(std::remove_if(maskIndices.begin(), maskIndices.end(), [this, &tile](int maskIndex) {
+            return tile.getZoom() > _maxZoomLevels[maskIndex];
+        }), maskIndices.end());
+        std::sort(maskIndices.begin(), maskIndices.end());
+        return maskIndices;
+    }
+
+    bool PackageTileIndex::isTileRangeCovered(int zoom, int minX, int minY, int maxX, int maxY) const {
+        if (minX > maxX || minY > maxY) {
+            return true;
+        }
+        return isNodeRangeCovered(*_rootNode, 0, 0, 0, zoom, minX, minY, maxX, maxY);
+    }
+
+    bool PackageTileIndex::isNodeRangeCovered(const IndexNode& indexNode, int nodeZoom, int nodeX, int nodeY, int zoom, int minX, int minY, int maxX, int maxY) const {
+        // Leaf nodes cover all their subtiles
+        if (hasCoveringMask(indexNode.leafInsideMasks, zoom)) {
+            return true;
+        }
+        if (nodeZoom == zoom) {
+            return hasCoveringMask(indexNode.insideMasks, zoom);
+        }
+
+        // Otherwise all subnodes intersecting the range must be covered
+        int shift = zoom - nodeZoom - 1;
+        for (int i = 0; i < 4; i++) {
+            int subX = nodeX * 2 + (i & 1);
+            int subY = nodeY * 2 + (i >> 1);
+            if ((subX << shift) > maxX || ((subX + 1) << shift) - 1 < minX || (subY << shift) > maxY || ((subY + 1) << shift) - 1 < minY) {
+                continue;
+            }
+            if (!indexNode.subNodes[i] || !isNodeRangeCovered(*indexNode.subNodes[i], nodeZoom + 1, subX, subY, zoom, minX, minY, maxX, maxY)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool PackageTileIndex::hasCoveringMask(const std::vector<int>& maskIndices, int zoom) const {
+        // Masks do not cover tiles above their maximum zoom level
+        return std::any_of(maskIndices.begin(), maskIndices.end(), [this, zoom](int maskIndex) {
+            return zoom <= _maxZoomLevels[maskIndex];
+        });
+    }
+
+    void PackageTileIndex::AddTileNode(IndexNode& indexNode, const PackageTileMask& tileMask, std::size_t tileNode, int maskIndex) {
+        bool leaf = true;
+        for (int i = 0; i < 4; i++) {
+            std::size_t subTileNode = tileMask.getSubNode(tileNode, i);
+            if (subTileNode != PackageTileMask::NO_NODE) {
+                if (!indexNode.subNodes[i]) {
+                    indexNode.subNodes[i] = std::make_shared<IndexNode>();
+                }
+                AddTileNode(*indexNode.subNodes[i], tileMask, subTileNode, maskIndex);
+                leaf = false;
+            }
+        }
+
+        if (tileMask.isNodeInside(tileNode)) {
+            if (leaf) {
+                indexNode.leafInsideMasks.push_back(maskIndex);
+            } else {
+                indexNode.insideMasks.push_back(maskIndex);
+            }
+        }
+    }
+
+}
+
+#endif
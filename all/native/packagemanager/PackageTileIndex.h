@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_PACKAGETILEINDEX_H_
+#define _CARTO_PACKAGETILEINDEX_H_
+
+#ifdef _CARTO_PACKAGEMANAGER_SUPPORT
+
+#include "core/MapTile.h"
+#include "packagemanager/PackageTileMask.h"
+
+#include <memory>
+#include <vector>
+
+namespace carto {
+
+    /**
+     * An internal spatial index merging the quadtrees of multiple package tile masks.
+     * Finding the packages covering a tile needs a single descent of the merged tree,
+     * instead of testing every tile mask separately.
+     */
+    class PackageTileIndex {
+    public:
+        /**
+         * Constructs a new index from a list of tile masks.
+         * @param tileMasks The list of tile masks to index. Null masks are ignored.
+         */
+        explicit PackageTileIndex(const std::vector<std::shared_ptr<PackageTileMask> >& tileMasks);
+
+        /**
+         * Finds the tile masks that fully cover the specified tile (masks whose status for the tile is PACKAGE_TILE_STATUS_FULL).
+         * @param tile The tile to check.
+         * @return The indices of the covering tile masks in the original list, in ascending order.
+         */
+        std::vector<int> findTileMasks(const MapTile& tile) const;
+
+        /**
+         * Checks whether all tiles of the specified tile range are fully covered by the union of the tile masks.
+         * The range is checked by walking the merged tree, without testing the tiles separately.
+         * @param zoom The zoom level of the tile range.
+         * @param minX The minimum x coordinate of the tile range.
+         * @param minY The minimum y coordinate of the tile range.
+         * @param maxX The maximum x coordinate of the tile range (inclusive).
+         * @param maxY The maximum y coordinate of the tile range (inclusive).
+         * @return True if every tile of the range is covered by at least one tile mask.
+         */
+        bool isTileRangeCovered(int zoom, int minX, int minY, int maxX, int maxY) const;
+
+    private:
+        struct IndexNode {
+            std::vector<int> insideMasks; // masks with an inner node for this tile that is inside
+            std::vector<int> leafInsideMasks; // masks with a leaf node for this tile that is inside, covering all subtiles
+            std::shared_ptr<IndexNode> subNodes[4];
+        };
+
+        bool isNodeRangeCovered(const IndexNode& indexNode, int nodeZoom, int nodeX, int nodeY, int zoom, int minX, int minY, int maxX, int maxY) const;
+        bool hasCoveringMask(const std::vector<int>& maskIndices, int zoom) const;
+
+        static void AddTileNode(IndexNode& indexNode, const PackageTileMask& tileMask, std::size_t tileNode, int maskIndex);
+
+        std::shared_ptr<IndexNode> _rootNode;
+        std::vector<int> _maxZoomLevels;
+    };
+
+}
+
+#endif
+
+#endif
@@ -7,6 +7,7 @@
 
 #include <vector>
 #include <algorithm>
+#include <bitset>
 
 namespace {
     enum { NP = 255 };
@@ -50,17 +51,22 @@ namespace {
         '8', '9', '+', '/'
     };
 
-    std::queue<bool> decodeBase64(const std::string& stringValue) {
-        std::queue<bool> data;
+    std::vector<bool> decodeBase64(const std::string& stringValue) {
+        std::vector<bool> data;
+        data.reserve(stringValue.size() * 6);
         for (char c : stringValue) {
             int val = base64DecodeTable[static_cast<unsigned char>(c)];
             for (int i = 5; i >= 0; i--) {
-                data.push(((val >> i) & 1) != 0);
+                data.push_back(((val >> i) & 1) != 0);
             }
         }
         return data;
     }
 
+    std::size_t countBits(std::uint64_t word) {
+        return std::bitset<64>(word).count();
+    }
+
     std::string encodeBase64(std::vector<bool> data) {
         while (data.size() % 24 != 0) {
             data.push_back(false);
@@ -152,24 +158,29 @@ namespace carto {
     
     PackageTileMask::PackageTileMask(const std::string& stringValue, int maxZoom) :
         _stringValue(stringValue),
-        _rootNode(),
+        _subNodeBits(),
+        _insideBits(),
+        _subNodeRanks(),
+        _nodeCount(0),
         _maxZoomLevel(maxZoom)
     {
-        std::queue<bool> data = decodeBase64(stringValue);
-        _rootNode = DecodeTileNode(data, MapTile(0, 0, 0, 0));
+        buildNodes(decodeBase64(stringValue));
     }
 
     PackageTileMask::PackageTileMask(const std::vector<MapTile>& tiles, int clipZoom) :
         _stringValue(),
-        _rootNode(),
+        _subNodeBits(),
+        _insideBits(),
+        _subNodeRanks(),
+        _nodeCount(0),
         _maxZoomLevel(0)
     {
         std::unordered_set<MapTile> tileSet(tiles.begin(), tiles.end());
-        _rootNode = BuildTileNode(tileSet, MapTile(0, 0, 0, 0), clipZoom);
+        std::vector<bool> data = BuildTileNodeData(tileSet, MapTile(0, 0, 0, 0), clipZoom);
         for (const MapTile& tile : tiles) {
             _maxZoomLevel = std::max(_maxZoomLevel, tile.getZoom());
         }
-        std::vector<bool> data = EncodeTileNode(_rootNode);
+        buildNodes(data);
         _stringValue = encodeBase64(std::move(data));
     }
 
@@ -193,7 +204,10 @@ namespace carto {
             throw NullArgumentException("Null projection");
         }
 
-        std::vector<std::vector<MapPos> > poly = CalculateTileNodeBoundingPolygon(_rootNode, projection);
+        std::vector<std::vector<MapPos> > poly;
+        if (_nodeCount > 0) {
+            poly = calculateTileNodeBoundingPolygon(0, MapTile(0, 0, 0, 0), projection);
+        }
 
         std::vector<std::vector<MapPos> > optimizedPoly;
         for (std::size_t i = 0; i < poly.size(); i++) {
@@ -206,109 +220,99 @@ namespace carto {
     }
 
     PackageTileStatus::PackageTileStatus PackageTileMask::getTileStatus(const MapTile& mapTile) const {
-        if (std::shared_ptr<TileNode> node = findTileNode(mapTile)) {
+        std::size_t node = findTileNode(mapTile);
+        if (node != NO_NODE) {
             if (mapTile.getZoom() <= _maxZoomLevel) {
-                return (node->inside ? PackageTileStatus::PACKAGE_TILE_STATUS_FULL : PackageTileStatus::PACKAGE_TILE_STATUS_MISSING);
+                return (isNodeInside(node) ? PackageTileStatus::PACKAGE_TILE_STATUS_FULL : PackageTileStatus::PACKAGE_TILE_STATUS_MISSING);
             }
         }
         return PackageTileStatus::PACKAGE_TILE_STATUS_MISSING;
     }
 
-    std::shared_ptr<PackageTileMask::TileNode> PackageTileMask::findTileNode(const MapTile& tile) const {
-        if (tile.getZoom() == 0) {
-            if (tile.getX() == 0 && tile.getY() == 0) {
-                return _rootNode;
-            }
-            return std::shared_ptr<TileNode>();
+    std::size_t PackageTileMask::findTileNode(const MapTile& tile) const {
+        if (_nodeCount == 0 || tile.getZoom() < 0 || tile.getX() < 0 || tile.getY() < 0) {
+            return NO_NODE;
+        }
+        if ((static_cast<long long>(tile.getX()) >> tile.getZoom()) != 0 || (static_cast<long long>(tile.getY()) >> tile.getZoom()) != 0) {
+            return NO_NODE;
         }
 
-        std::shared_ptr<TileNode> parentNode = findTileNode(MapTile(tile.getX() / 2, tile.getY() / 2, tile.getZoom() - 1, tile.getFrameNr()));
-        if (parentNode) {
-            for (int i = 0; i < 4; i++) {
-                const std::shared_ptr<TileNode>& node = parentNode->subNodes[i];
-                if (node) {
-                    if (node->tile == tile) {
-                        return node;
-                    }
-                }
-            }
-            if (parentNode->inside) {
-                return parentNode;
+        // Descend from the root. If a leaf is reached before the zoom level of the tile, the leaf covers all its subtiles
+        std::size_t node = 0;
+        for (int zoom = 0; zoom < tile.getZoom(); zoom++) {
+            int shift = tile.getZoom() - zoom - 1;
+            std::size_t subNode = getSubNode(node, ((tile.getY() >> shift) & 1) * 2 + ((tile.getX() >> shift) & 1));
+            if (subNode == NO_NODE) {
+                return isNodeInside(node) ? node : NO_NODE;
             }
+            node = subNode;
         }
-        return std::shared_ptr<TileNode>();
+        return node;
     }
 
-    std::shared_ptr<PackageTileMask::TileNode> PackageTileMask::BuildTileNode(const std::unordered_set<MapTile>& tileSet, const MapTile& tile, int clipZoom) {
-        auto node = std::make_shared<TileNode>(tile, tileSet.find(tile) != tileSet.end());
-        if (!node->inside || tile.getZoom() >= clipZoom) {
-            return node; // Note: we assume here that tile does not exist implies subtiles do not exist
+    bool PackageTileMask::isNodeInside(std::size_t node) const {
+        return ((_insideBits[node / 64] >> (node % 64)) & 1) != 0;
+    }
+
+    std::size_t PackageTileMask::getSubNode(std::size_t node, int index) const {
+        std::uint64_t word = _subNodeBits[node / 64];
+        std::size_t bit = node % 64;
+        if (((word >> bit) & 1) == 0) {
+            return NO_NODE;
         }
 
-        int idx = 0;
-        bool deep = false;
-        for (int dy = 0; dy < 2; dy++) {
-            for (int dx = 0; dx < 2; dx++) {
-                node->subNodes[idx] = BuildTileNode(tileSet, MapTile(tile.getX() * 2 + dx, tile.getY() * 2 + dy, tile.getZoom() + 1, tile.getFrameNr()), clipZoom);
-                for (int i = 0; i < 4; i++) {
-                    deep = deep || node->subNodes[idx]->subNodes[i];
-                }
-                idx++;
-            }
+        // The subnodes of the nodes with subnodes follow the root node in the same order, four per node
+        std::size_t rank = _subNodeRanks[node / 64] + countBits(word & ((static_cast<std::uint64_t>(1) << bit) - 1));
+        return 1 + rank * 4 + index;
+    }
+
+    void PackageTileMask::buildNodes(const std::vector<bool>& data) {
+        // Convert the depth-first encoding to level order. Nodes of the same level are visited from left to right.
+        std::vector<std::vector<std::pair<bool, bool> > > levelNodes;
+        if (data.size() >= 2) {
+            std::size_t pos = 0;
+            DecodeTileNodeData(data, pos, 0, levelNodes);
         }
-        if (!deep) {
-            if (node->subNodes[0]->inside && node->subNodes[1]->inside && node->subNodes[2]->inside && node->subNodes[3]->inside) {
-                node->subNodes[0] = node->subNodes[1] = node->subNodes[2] = node->subNodes[3] = std::shared_ptr<TileNode>();
-            }
+
+        _nodeCount = 0;
+        for (const std::vector<std::pair<bool, bool> >& nodes : levelNodes) {
+            _nodeCount += nodes.size();
         }
-        return node;
-    }
-    
-    std::shared_ptr<PackageTileMask::TileNode> PackageTileMask::DecodeTileNode(std::queue<bool>& data, const MapTile& tile) {
-        bool leaf = !data.front();
-        data.pop();
-        bool inside = data.front();
-        data.pop();
-        auto node = std::make_shared<TileNode>(tile, inside);
-        if (!leaf) {
-            int idx = 0;
-            for (int dy = 0; dy < 2; dy++) {
-                for (int dx = 0; dx < 2; dx++) {
-                    node->subNodes[idx] = DecodeTileNode(data, MapTile(tile.getX() * 2 + dx, tile.getY() * 2 + dy, tile.getZoom() + 1, tile.getFrameNr()));
-                    idx++;
+        std::size_t wordCount = (_nodeCount + 63) / 64;
+        _subNodeBits.assign(wordCount, 0);
+        _insideBits.assign(wordCount, 0);
+        _subNodeRanks.assign(wordCount, 0);
+
+        std::size_t node = 0;
+        for (const std::vector<std::pair<bool, bool> >& nodes : levelNodes) {
+            for (const std::pair<bool, bool>& nodeBits : nodes) {
+                if (nodeBits.first) {
+                    _subNodeBits[node / 64] |= static_cast<std::uint64_t>(1) << (node % 64);
+                }
+                if (nodeBits.second) {
+                    _insideBits[node / 64] |= static_cast<std::uint64_t>(1) << (node % 64);
                 }
+                node++;
             }
         }
-        return node;
-    }
 
-    std::vector<bool> PackageTileMask::EncodeTileNode(const std::shared_ptr<TileNode>& node) {
-        std::vector<bool> data;
-        if (!node) {
-            return data;
-        }
-        for (int idx = 0; idx < 4; idx++) {
-            std::vector<bool> subData = EncodeTileNode(node->subNodes[idx]);
-            data.insert(data.end(), subData.begin(), subData.end());
-        }
-        if (data.empty()) {
-            data.push_back(false);
-            data.push_back(node->inside);
-        } else {
-            data.insert(data.begin(), true);
-            data.insert(data.begin() + 1, node->inside);
+        std::size_t rank = 0;
+        for (std::size_t i = 0; i < wordCount; i++) {
+            _subNodeRanks[i] = rank;
+            rank += countBits(_subNodeBits[i]);
         }
-        return data;
     }
 
-    std::vector<std::vector<MapPos> > PackageTileMask::CalculateTileNodeBoundingPolygon(const std::shared_ptr<TileNode>& node, const std::shared_ptr<Projection>& proj) {
+    std::vector<std::vector<MapPos> > PackageTileMask::calculateTileNodeBoundingPolygon(std::size_t node, const MapTile& tile, const std::shared_ptr<Projection>& proj) const {
         std::vector<std::vector<MapPos> > poly;
-        if (!node) {
-            return poly;
-        }
-
         for (int i = 0; i < 4; i++) {
-            std::vector<std::vector<MapPos> > subPoly = CalculateTileNodeBoundingPolygon(node->subNodes[i], proj);
+            std::size_t subNode = getSubNode(node, i);
+            if (subNode == NO_NODE) {
+                continue;
+            }
+
+            MapTile subTile(tile.getX() * 2 + (i & 1), tile.getY() * 2 + (i >> 1), tile.getZoom() + 1, tile.getFrameNr());
+            std::vector<std::vector<MapPos> > subPoly = calculateTileNodeBoundingPolygon(subNode, subTile, proj);
             if (!poly.empty() && !subPoly.empty()) {
                 poly = unifyTilePolygons(poly, subPoly);
             } else if (!subPoly.empty()) {
@@ -316,11 +320,56 @@ namespace carto {
             }
         }
 
-        if (poly.empty() && node->inside) {
-            poly = createTilePolygon(node->tile, proj);
+        if (poly.empty() && isNodeInside(node)) {
+            poly = createTilePolygon(tile, proj);
         }
 
         return poly;
     }
 
+    std::vector<bool> PackageTileMask::BuildTileNodeData(const std::unordered_set<MapTile>& tileSet, const MapTile& tile, int clipZoom) {
+        bool inside = tileSet.find(tile) != tileSet.end();
+        if (!inside || tile.getZoom() >= clipZoom) {
+            return std::vector<bool> { false, inside }; // Note: we assume here that tile does not exist implies subtiles do not exist
+        }
+
+        // Encode the node depth-first: subnode flag, inside flag and then the subnodes
+        std::vector<bool> data { true, inside };
+        bool deep = false;
+        bool full = true;
+        for (int dy = 0; dy < 2; dy++) {
+            for (int dx = 0; dx < 2; dx++) {
+                std::vector<bool> subData = BuildTileNodeData(tileSet, MapTile(tile.getX() * 2 + dx, tile.getY() * 2 + dy, tile.getZoom() + 1, tile.getFrameNr()), clipZoom);
+                deep = deep || subData[0];
+                full = full && subData[1];
+                data.insert(data.end(), subData.begin(), subData.end());
+            }
+        }
+        if (!deep && full) {
+            return std::vector<bool> { false, true };
+        }
+        return data;
+    }
+    
+    void PackageTileMask::DecodeTileNodeData(const std::vector<bool>& data, std::size_t& pos, std::size_t level, std::vector<std::vector<std::pair<bool, bool> > >& levelNodes) {
+        // Truncated data is decoded as leaf nodes outside of the package
+        bool leaf = true;
+        bool inside = false;
+        if (pos + 2 <= data.size()) {
+            leaf = !data[pos];
+            inside = data[pos + 1];
+        }
+        pos += 2;
+
+        if (levelNodes.size() <= level) {
+            levelNodes.resize(level + 1);
+        }
+        levelNodes[level].emplace_back(!leaf, inside);
+        if (!leaf) {
+            for (int i = 0; i < 4; i++) {
+                DecodeTileNodeData(data, pos, level + 1, levelNodes);
+            }
+        }
+    }
+
 }
@@ -10,9 +10,10 @@
 #include "core/MapPos.h"
 #include "core/MapTile.h"
 
+#include <cstdint>
 #include <string>
 #include <memory>
-#include <queue>
+#include <utility>
 #include <vector>
 #include <unordered_set>
 
@@ -94,23 +95,28 @@ namespace carto {
         PackageTileStatus::PackageTileStatus getTileStatus(const MapTile& tile) const;
 
     private:
-        struct TileNode {
-            MapTile tile;
-            bool inside;
-            std::shared_ptr<TileNode> subNodes[4];
+        friend class PackageTileIndex;
 
-            TileNode(const MapTile& tile, bool inside) : tile(tile), inside(inside) { }
-        };
+        static const std::size_t NO_NODE = static_cast<std::size_t>(-1);
+
+        std::size_t findTileNode(const MapTile& tile) const;
+        bool isNodeInside(std::size_t node) const;
+        std::size_t getSubNode(std::size_t node, int index) const;
+
+        void buildNodes(const std::vector<bool>& data);
 
-        std::shared_ptr<TileNode> findTileNode(const MapTile& tile) const;
+        std::vector<std::vector<MapPos> > calculateTileNodeBoundingPolygon(std::size_t node, const MapTile& tile, const std::shared_ptr<Projection>& proj) const;
 
-        static std::shared_ptr<TileNode> BuildTileNode(const std::unordered_set<MapTile>& tileSet, const MapTile& tile, int clipZoom);
-        static std::shared_ptr<TileNode> DecodeTileNode(std::queue<bool>& data, const MapTile& tile);
-        static std::vector<bool> EncodeTileNode(const std::shared_ptr<TileNode>& node);
-        static std::vector<std::vector<MapPos> > CalculateTileNodeBoundingPolygon(const std::shared_ptr<TileNode>& node, const std::shared_ptr<Projection>& proj);
+        static std::vector<bool> BuildTileNodeData(const std::unordered_set<MapTile>& tileSet, const MapTile& tile, int clipZoom);
+        static void DecodeTileNodeData(const std::vector<bool>& data, std::size_t& pos, std::size_t level, std::vector<std::vector<std::pair<bool, bool> > >& levelNodes);
 
+        // The quadtree is stored in level order, two bits per node. The subnodes of a node are located
+        // using the rank of the node among the nodes with subnodes, so no pointers are needed.
         std::string _stringValue;
-        std::shared_ptr<TileNode> _rootNode;
+        std::vector<std::uint64_t> _subNodeBits; // bit is set if the node has subnodes
+        std::vector<std::uint64_t> _insideBits; // bit is set if the node is inside the package
+        std::vector<std::size_t> _subNodeRanks; // number of nodes with subnodes before each word of _subNodeBits
+        std::size_t _nodeCount;
         int _maxZoomLevel;
     };
 }
@@ -6,10 +6,9 @@
 #include "packagemanager/PackageTileMask.h"
 #include "utils/Log.h"
 
-#include <stdext/zlib.h>
+#include <zlib.h>
 
 #include <sqlite3pp.h>
-#include <sqlite3ppext.h>
 
 #include <rc5.h>
 #include <sha.h>
@@ -17,14 +16,82 @@
 #include <filters.h>
 #include <hex.h>
 
+#include <algorithm>
+
 namespace carto {
 
+    class MapPackageHandler::TileInflater {
+    public:
+        explicit TileInflater(const std::shared_ptr<BinaryData>& dictionary) :
+            _dictionary(dictionary),
+            _stream(),
+            _initialized(false),
+            _sizeRatio(4)
+        {
+        }
+
+        ~TileInflater() {
+            if (_initialized) {
+                inflateEnd(&_stream);
+            }
+        }
+
+        bool inflate(const unsigned char* data, std::size_t size, std::vector<unsigned char>& out) {
+            // Reuse the inflate state and its window, only the dictionary needs to be primed again
+            if (!_initialized) {
+                if (inflateInit2(&_stream, -MAX_WBITS) != Z_OK) {
+                    return false;
+                }
+                _initialized = true;
+            } else if (inflateReset(&_stream) != Z_OK) {
+                return false;
+            }
+            if (inflateSetDictionary(&_stream, _dictionary->data(), static_cast<uInt>(_dictionary->size())) != Z_OK) {
+                return false;
+            }
+
+            // Size the output buffer from the compression ratio of the previous tile, to avoid growing it in most cases
+            out.resize(std::max(size * _sizeRatio, static_cast<std::size_t>(1024)));
+            _stream.next_in = const_cast<Bytef*>(data);
+            _stream.avail_in = static_cast<uInt>(size);
+            while (true) {
+                _stream.next_out = out.data() + _stream.total_out;
+                _stream.avail_out = static_cast<uInt>(out.size() - _stream.total_out);
+                int result = ::inflate(&_stream, Z_NO_FLUSH);
+                if (result == Z_STREAM_END) {
+                    break;
+                }
+                if (result != Z_OK && result != Z_BUF_ERROR) {
+                    return false;
+                }
+                if (_stream.avail_out > 0) {
+                    return false; // truncated stream
+                }
+                out.resize(out.size() * 2);
+            }
+            out.resize(_stream.total_out);
+            if (size > 0) {
+                _sizeRatio = out.size() / size + 1;
+            }
+            return true;
+        }
+
+    private:
+        const std::shared_ptr<BinaryData> _dictionary;
+        z_stream _stream;
+        bool _initialized;
+        std::size_t _sizeRatio;
+    };
+
     MapPackageHandler::MapPackageHandler(const std::string& fileName, const std::string& serverEncKey, const std::string& localEncKey) :
         PackageHandler(fileName),
         _serverEncKey(serverEncKey),
         _localEncKey(localEncKey),
-        _packageDb(),
-        _decryptFunc(),
+        _databaseOpen(false),
+        _databaseGeneration(0),
+        _idleConnections(),
+        _idleInflaters(),
+        _encrypted(false),
         _sharedDictionary()
     {
     }
@@ -35,43 +102,34 @@ namespace carto {
     void MapPackageHandler::openDatabase() {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
 
-        if (_packageDb) {
+        if (_databaseOpen) {
             return;
         }
 
         try {
             // Open package database
-            _packageDb.reset(new sqlite3pp::database());
-            if (_packageDb->connect_v2(_fileName.c_str(), SQLITE_OPEN_READONLY) != SQLITE_OK) {
-                Log::Errorf("MapPackageHandler::openDatabase: Failed to open database %s", _fileName.c_str());
+            std::unique_ptr<sqlite3pp::database> packageDb = connectDatabase();
+            if (!packageDb) {
                 return;
             }
 
-            // Create new sqlite decryption function. First check if the database is crypted.
-            std::string encKey = _serverEncKey;
-            bool encrypted = CheckDbEncryption(*_packageDb, _serverEncKey + _localEncKey); // NOTE: this is a hack - though tiles are actually encrypted with server key only, with check that local key is included in the hash also
-            _decryptFunc.reset(new sqlite3pp::ext::function(*_packageDb));
-            _decryptFunc->create("tile_decrypt", [encrypted, encKey](sqlite3pp::ext::context& ctx) {
-                const unsigned char* encData = reinterpret_cast<const unsigned char*>(ctx.get<const void*>(0));
-                std::size_t encSize = ctx.args_bytes(0);
-                int zoom = ctx.get<int>(1);
-                int x = ctx.get<int>(2);
-                int y = ctx.get<int>(3);
-                std::vector<unsigned char> encVector(encData, encData + encSize);
-                if (encrypted) {
-                    DecryptTile(encVector, zoom, x, y, encKey);
-                }
-                ctx.result(encVector.empty() ? nullptr : &encVector[0], static_cast<int>(encVector.size()), false);
-            }, 4);
+            // Check if the database is crypted. Tiles are decrypted when loaded.
+            _encrypted = CheckDbEncryption(*packageDb, _serverEncKey + _localEncKey); // NOTE: this is a hack - though tiles are actually encrypted with server key only, with check that local key is included in the hash also
 
             // Try to load shared dictionary
             _sharedDictionary.reset();
-            sqlite3pp::query query(*_packageDb, "SELECT value FROM metadata WHERE name='shared_zlib_dict'");
-            for (auto qit = query.begin(); qit != query.end(); qit++) {
-                const unsigned char* dataPtr = reinterpret_cast<const unsigned char*>(qit->get<const void*>(0));
-                std::size_t dataSize = qit->column_bytes(0);
-                _sharedDictionary.reset(new BinaryData(dataPtr, dataSize));
+            {
+                sqlite3pp::query query(*packageDb, "SELECT value FROM metadata WHERE name='shared_zlib_dict'");
+                for (auto qit = query.begin(); qit != query.end(); qit++) {
+                    const unsigned char* dataPtr = reinterpret_cast<const unsigned char*>(qit->get<const void*>(0));
+                    std::size_t dataSize = qit->column_bytes(0);
+                    _sharedDictionary = std::make_shared<BinaryData>(dataPtr, dataSize);
+                }
             }
+
+            // Keep the connection for the first tile reader
+            _idleConnections.push_back(std::move(packageDb));
+            _databaseOpen = true;
         }
         catch (const std::exception& ex) {
             Log::Errorf("MapPackageHandler::openDatabase: Exception %s", ex.what());
@@ -81,41 +139,104 @@ namespace carto {
     void MapPackageHandler::closeDatabase() {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
 
-        _packageDb.reset();
-        _decryptFunc.reset();
+        // Connections currently used by readers are closed when they are released
+        _idleConnections.clear();
+        _idleInflaters.clear();
+        _databaseOpen = false;
+        _databaseGeneration++;
+        _encrypted = false;
         _sharedDictionary.reset();
     }
 
     std::shared_ptr<BinaryData> MapPackageHandler::loadTile(const MapTile& mapTile) {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        // Take a read connection and the package state, the lock is not held while reading, decrypting or decompressing the tile
+        std::unique_ptr<sqlite3pp::database> packageDb;
+        int databaseGeneration = 0;
+        bool encrypted = false;
+        std::shared_ptr<TileInflater> inflater;
+        {
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
 
-        try {
             openDatabase();
+            if (!_databaseOpen) {
+                return std::shared_ptr<BinaryData>();
+            }
+
+            if (!_idleConnections.empty()) {
+                packageDb = std::move(_idleConnections.back());
+                _idleConnections.pop_back();
+            }
+            databaseGeneration = _databaseGeneration;
+            encrypted = _encrypted;
+            if (_sharedDictionary) {
+                if (!_idleInflaters.empty()) {
+                    inflater = _idleInflaters.back();
+                    _idleInflaters.pop_back();
+                } else {
+                    inflater = std::make_shared<TileInflater>(_sharedDictionary);
+                }
+            }
+        }
+
+        std::shared_ptr<BinaryData> tileData;
+        try {
+            if (!packageDb) {
+                packageDb = connectDatabase();
+                if (!packageDb) {
+                    return std::shared_ptr<BinaryData>();
+                }
+            }
 
             // Try to load the tile (this could fail, as tile masks may not be complete to the last zoom level)
-            sqlite3pp::query query(*_packageDb, "SELECT tile_decrypt(tile_data, zoom_level, tile_column, tile_row) FROM tiles WHERE zoom_level=:zoom AND tile_column=:x AND tile_row=:y");
+            sqlite3pp::query query(*packageDb, "SELECT tile_data FROM tiles WHERE zoom_level=:zoom AND tile_column=:x AND tile_row=:y");
             query.bind(":zoom", mapTile.getZoom());
             query.bind(":x", mapTile.getX());
             query.bind(":y", mapTile.getY());
             for (auto qit = query.begin(); qit != query.end(); qit++) {
                 const unsigned char* dataPtr = reinterpret_cast<const unsigned char*>(qit->get<const void*>(0));
                 std::size_t dataSize = qit->column_bytes(0);
-                std::vector<unsigned char> data(dataPtr, dataPtr + dataSize);
-                if (_sharedDictionary) {
-                    std::vector<unsigned char> uncompressedData;
-                    if (!zlib::inflate_raw(data.data(), data.size(), _sharedDictionary->data(), _sharedDictionary->size(), uncompressedData)) {
+
+                // Decrypt in place in the copied blob, decompress directly from the blob if not encrypted
+                std::vector<unsigned char> decryptedData;
+                if (encrypted) {
+                    decryptedData.assign(dataPtr, dataPtr + dataSize);
+                    DecryptTile(decryptedData, mapTile.getZoom(), mapTile.getX(), mapTile.getY(), _serverEncKey);
+                    dataPtr = decryptedData.data();
+                    dataSize = decryptedData.size();
+                }
+
+                std::vector<unsigned char> data;
+                if (inflater) {
+                    if (!inflater->inflate(dataPtr, dataSize, data)) {
                         Log::Warnf("MapPackageHandler::loadTile: Failed to decompress tile with shared dictionary");
-                        return std::shared_ptr<BinaryData>();
+                        break;
                     }
-                    std::swap(data, uncompressedData);
+                } else if (encrypted) {
+                    std::swap(data, decryptedData);
+                } else {
+                    data.assign(dataPtr, dataPtr + dataSize);
                 }
-                return std::make_shared<BinaryData>(std::move(data));
+                tileData = std::make_shared<BinaryData>(std::move(data));
+                break;
             }
         }
         catch (const std::exception& ex) {
             Log::Errorf("MapPackageHandler::loadTile: Exception %s", ex.what());
         }
-        return std::shared_ptr<BinaryData>();
+
+        // Return the connection and the inflater to the pools, unless the database was closed meanwhile
+        {
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            if (_databaseOpen && _databaseGeneration == databaseGeneration) {
+                if (packageDb && static_cast<int>(_idleConnections.size()) < MAX_IDLE_CONNECTIONS) {
+                    _idleConnections.push_back(std::move(packageDb));
+                }
+                if (inflater && static_cast<int>(_idleInflaters.size()) < MAX_IDLE_INFLATERS) {
+                    _idleInflaters.push_back(inflater);
+                }
+            }
+        }
+        return tileData;
     }
 
     void MapPackageHandler::onImportPackage() {
@@ -135,6 +256,100 @@ namespace carto {
     void MapPackageHandler::onDeletePackage() {
     }
 
+    bool MapPackageHandler::applyPackageDelta(const std::string& deltaFileName, int baseVersion) {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+        try {
+            sqlite3pp::database packageDb;
+            if (packageDb.connect_v2(_fileName.c_str(), SQLITE_OPEN_READWRITE) != SQLITE_OK) {
+                Log::Errorf("MapPackageHandler::applyPackageDelta: Failed to open database %s", _fileName.c_str());
+                return false;
+            }
+
+            // Check that the delta is built against the package version and that the tiles use the same encryption
+            bool encrypted = CheckDbEncryption(packageDb, _serverEncKey + _localEncKey);
+            {
+                sqlite3pp::database deltaDb;
+                if (deltaDb.connect_v2(deltaFileName.c_str(), SQLITE_OPEN_READONLY) != SQLITE_OK) {
+                    Log::Errorf("MapPackageHandler::applyPackageDelta: Failed to open delta database %s", deltaFileName.c_str());
+                    return false;
+                }
+                bool baseVersionMatches = false;
+                sqlite3pp::query query(deltaDb, "SELECT value FROM metadata WHERE name='delta_base_version'");
+                for (auto qit = query.begin(); qit != query.end(); qit++) {
+                    baseVersionMatches = qit->get<int>(0) == baseVersion;
+                }
+                if (!baseVersionMatches) {
+                    Log::Errorf("MapPackageHandler::applyPackageDelta: Delta is not built against version %d", baseVersion);
+                    return false;
+                }
+                if (CheckDbEncryption(deltaDb, _serverEncKey) != encrypted) {
+                    Log::Errorf("MapPackageHandler::applyPackageDelta: Delta encryption does not match package encryption");
+                    return false;
+                }
+            }
+
+            sqlite3pp::command attachCommand(packageDb, "ATTACH DATABASE :file AS delta");
+            attachCommand.bind(":file", deltaFileName.c_str());
+            if (attachCommand.execute() != SQLITE_OK) {
+                Log::Errorf("MapPackageHandler::applyPackageDelta: Failed to attach delta database %s", deltaFileName.c_str());
+                return false;
+            }
+
+            // Tiles not in the delta stay valid only if they are decompressed with the same dictionary
+            {
+                sqlite3pp::query query(packageDb, "SELECT COUNT(*) FROM delta.metadata WHERE name='shared_zlib_dict' AND value IS NOT (SELECT value FROM main.metadata WHERE name='shared_zlib_dict')");
+                for (auto qit = query.begin(); qit != query.end(); qit++) {
+                    if (qit->get<int>(0) > 0) {
+                        Log::Errorf("MapPackageHandler::applyPackageDelta: Delta uses a different compression dictionary");
+                        return false;
+                    }
+                }
+            }
+            bool hasDeletedTiles = false;
+            {
+                sqlite3pp::query query(packageDb, "SELECT name FROM delta.sqlite_master WHERE type='table' AND name='deleted_tiles'");
+                for (auto qit = query.begin(); qit != query.end(); qit++) {
+                    hasDeletedTiles = true;
+                }
+            }
+
+            // Apply all changes in a single transaction, so that a failed update leaves the package intact
+            {
+                sqlite3pp::transaction xct(packageDb);
+
+                std::vector<std::string> statements;
+                if (hasDeletedTiles) {
+                    statements.push_back("DELETE FROM main.tiles WHERE EXISTS (SELECT 1 FROM delta.deleted_tiles d WHERE d.zoom_level=tiles.zoom_level AND d.tile_column=tiles.tile_column AND d.tile_row=tiles.tile_row)");
+                }
+                statements.push_back("DELETE FROM main.tiles WHERE EXISTS (SELECT 1 FROM delta.tiles d WHERE d.zoom_level=tiles.zoom_level AND d.tile_column=tiles.tile_column AND d.tile_row=tiles.tile_row)");
+                statements.push_back("INSERT INTO main.tiles(zoom_level, tile_column, tile_row, tile_data) SELECT zoom_level, tile_column, tile_row, tile_data FROM delta.tiles");
+                statements.push_back("DELETE FROM main.metadata WHERE name IN (SELECT name FROM delta.metadata WHERE name NOT IN ('delta_base_version', 'nutikeysha1', 'shared_zlib_dict'))");
+                statements.push_back("INSERT INTO main.metadata(name, value) SELECT name, value FROM delta.metadata WHERE name NOT IN ('delta_base_version', 'nutikeysha1', 'shared_zlib_dict')");
+                for (const std::string& statement : statements) {
+                    if (packageDb.execute(statement.c_str()) != SQLITE_OK) {
+                        Log::Errorf("MapPackageHandler::applyPackageDelta: Failed to update tiles: %s", packageDb.error_msg());
+                        return false;
+                    }
+                }
+
+                xct.commit();
+            }
+
+            packageDb.execute("DETACH DATABASE delta");
+
+            // Restore the server key hash of the copied package, import updates it the same way as for downloaded packages
+            if (encrypted) {
+                UpdateDbEncryption(packageDb, _serverEncKey);
+            }
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("MapPackageHandler::applyPackageDelta: Exception %s", ex.what());
+            return false;
+        }
+        return true;
+    }
+
     std::shared_ptr<PackageTileMask> MapPackageHandler::calculateTileMask() const {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
 
@@ -155,6 +370,16 @@ namespace carto {
         return std::make_shared<PackageTileMask>(tiles, maxZoomLevel);
     }
 
+    std::unique_ptr<sqlite3pp::database> MapPackageHandler::connectDatabase() const {
+        // Each connection is used by a single thread at a time, so SQLite internal locking is not needed
+        std::unique_ptr<sqlite3pp::database> packageDb(new sqlite3pp::database());
+        if (packageDb->connect_v2(_fileName.c_str(), SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX) != SQLITE_OK) {
+            Log::Errorf("MapPackageHandler::connectDatabase: Failed to open database %s", _fileName.c_str());
+            return std::unique_ptr<sqlite3pp::database>();
+        }
+        return packageDb;
+    }
+
     bool MapPackageHandler::CheckDbEncryption(sqlite3pp::database& db, const std::string& encKey) {
         sqlite3pp::query query(db, "SELECT value FROM metadata WHERE name='nutikeysha1'");
         for (auto qit = query.begin(); qit != query.end(); qit++) {
@@ -219,18 +444,24 @@ namespace carto {
         if (data.empty()) {
             return;
         }
+        if (data.size() % CryptoPP::RC5::BLOCKSIZE != 0) {
+            throw GenericException("Encrypted tile size is not a multiple of cipher block size");
+        }
         
         unsigned char iv[CryptoPP::RC5::BLOCKSIZE];
         unsigned char k[CryptoPP::RC5::DEFAULT_KEYLENGTH];
         SetCipherKeyIV(k, iv, zoom, x, y, encKey);
         CryptoPP::CBC_Mode<CryptoPP::RC5>::Decryption dec;
         dec.SetKeyWithIV(k, sizeof(k), iv);
-        std::string plainText;
-        plainText.reserve(data.size() + 1);
-        CryptoPP::StreamTransformationFilter stfEncryptor(dec, new CryptoPP::StringSink(plainText), CryptoPP::StreamTransformationFilter::PKCS_PADDING); // NOTE: stfEncryptor will delete sink itself
-        stfEncryptor.Put(&data[0], data.size());
-        stfEncryptor.MessageEnd();
-        data.assign(reinterpret_cast<const unsigned char*>(plainText.data()), reinterpret_cast<const unsigned char*>(plainText.data() + plainText.size()));
+        // Decrypt all blocks in place with a single call, bypassing the buffering of filter pipelines
+        dec.ProcessData(data.data(), data.data(), data.size());
+
+        // Strip PKCS padding
+        std::size_t padSize = data.back();
+        if (padSize == 0 || padSize > CryptoPP::RC5::BLOCKSIZE || std::find_if(data.end() - padSize, data.end(), [padSize](unsigned char c) { return c != padSize; }) != data.end()) {
+            throw GenericException("Invalid padding in encrypted tile");
+        }
+        data.resize(data.size() - padSize);
     }
 
     void MapPackageHandler::SetCipherKeyIV(unsigned char* k, unsigned char* iv, int zoom, int x, int y, const std::string& encKey) {
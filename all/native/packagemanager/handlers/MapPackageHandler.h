@@ -12,13 +12,11 @@
 #include "core/MapTile.h"
 #include "packagemanager/handlers/PackageHandler.h"
 
+#include <memory>
 #include <vector>
 
 namespace sqlite3pp {
     class database;
-    namespace ext {
-        class function;
-    }
 }
 
 namespace carto {
@@ -36,9 +34,27 @@ namespace carto {
         virtual void onImportPackage();
         virtual void onDeletePackage();
 
+        /**
+         * Updates the package in place from a delta package. The delta package is an mbtiles database
+         * containing the added and replaced tiles in the tiles table, the coordinates of the removed tiles in
+         * the deleted_tiles table and the version of the package it was built against as delta_base_version metadata.
+         * Tiles of the delta must be encrypted and compressed using the same key and dictionary as the base package.
+         * @param deltaFileName The file name of the delta package.
+         * @param baseVersion The version of the package the delta is applied to.
+         * @return True if the delta was applied, false if the delta does not match the package or applying it failed.
+         */
+        virtual bool applyPackageDelta(const std::string& deltaFileName, int baseVersion);
+
         virtual std::shared_ptr<PackageTileMask> calculateTileMask() const;
 
     private:
+        class TileInflater;
+
+        static const int MAX_IDLE_CONNECTIONS = 4;
+        static const int MAX_IDLE_INFLATERS = 4;
+
+        std::unique_ptr<sqlite3pp::database> connectDatabase() const;
+
         static bool CheckDbEncryption(sqlite3pp::database& db, const std::string& encKey);
         static void UpdateDbEncryption(sqlite3pp::database& db, const std::string& encKey);
 
@@ -50,9 +66,12 @@ namespace carto {
         const std::string _serverEncKey;
         const std::string _localEncKey;
 
-        std::unique_ptr<sqlite3pp::database> _packageDb;
-        std::unique_ptr<sqlite3pp::ext::function> _decryptFunc;
-        std::unique_ptr<BinaryData> _sharedDictionary;
+        bool _databaseOpen;
+        int _databaseGeneration;
+        std::vector<std::unique_ptr<sqlite3pp::database> > _idleConnections;
+        std::vector<std::shared_ptr<TileInflater> > _idleInflaters;
+        bool _encrypted;
+        std::shared_ptr<BinaryData> _sharedDictionary;
     };
     
 }
@@ -23,6 +23,8 @@ namespace carto {
         virtual void onImportPackage() = 0;
         virtual void onDeletePackage() = 0;
 
+        virtual bool applyPackageDelta(const std::string& deltaFileName, int baseVersion) { return false; }
+
         virtual std::shared_ptr<PackageTileMask> calculateTileMask() const = 0;
     
     protected:
@@ -22,6 +22,24 @@ namespace carto {
         return MapPos(mapPos.getX() * METERS_TO_INTERNAL_EQUATOR, mapPos.getY() * METERS_TO_INTERNAL_EQUATOR, mapPos.getZ() * METERS_TO_INTERNAL_EQUATOR);
     }
 
+    void EPSG3857::fromInternal(const MapPos* mapPosesInternal, MapPos* mapPoses, std::size_t count) const {
+        // Plain scaling without per-position virtual calls, simple enough for the compiler to vectorize.
+        // Uses the same expressions as the single position version, so that the results are identical.
+        const double scale = METERS_TO_INTERNAL_EQUATOR;
+        for (std::size_t i = 0; i < count; i++) {
+            const MapPos& mapPosInternal = mapPosesInternal[i];
+            mapPoses[i] = MapPos(mapPosInternal.getX() / scale, mapPosInternal.getY() / scale, mapPosInternal.getZ() / scale);
+        }
+    }
+
+    void EPSG3857::toInternal(const MapPos* mapPoses, MapPos* mapPosesInternal, std::size_t count) const {
+        const double scale = METERS_TO_INTERNAL_EQUATOR;
+        for (std::size_t i = 0; i < count; i++) {
+            const MapPos& mapPos = mapPoses[i];
+            mapPosesInternal[i] = MapPos(mapPos.getX() * scale, mapPos.getY() * scale, mapPos.getZ() * scale);
+        }
+    }
+
     MapPos EPSG3857::fromWgs84(const MapPos& wgs84Pos) const {
         double x = wgs84Pos.getX() * Const::DEG_TO_RAD * EARTH_RADIUS;
         double a = std::sin(wgs84Pos.getY() * Const::DEG_TO_RAD);
@@ -29,6 +29,29 @@ namespace carto {
         return MapPos(x, y, z);
     }
 
+    void EPSG4326::fromInternal(const MapPos* mapPosesInternal, MapPos* mapPoses, std::size_t count) const {
+        const double scale = UNITS_TO_INTERNAL;
+        for (std::size_t i = 0; i < count; i++) {
+            const MapPos& mapPosInternal = mapPosesInternal[i];
+            double x = mapPosInternal.getX() / scale * Const::RAD_TO_DEG;
+            double y = 90.0 - Const::RAD_TO_DEG * (2.0 * std::atan(std::exp(-mapPosInternal.getY() / scale)));
+            double z = mapPosInternal.getZ() / scale * EARTH_RADIUS;
+            mapPoses[i] = MapPos(x, y, z);
+        }
+    }
+
+    void EPSG4326::toInternal(const MapPos* mapPoses, MapPos* mapPosesInternal, std::size_t count) const {
+        const double scale = UNITS_TO_INTERNAL;
+        for (std::size_t i = 0; i < count; i++) {
+            const MapPos& mapPos = mapPoses[i];
+            double x = mapPos.getX() * scale * Const::DEG_TO_RAD;
+            double a = std::sin(mapPos.getY() * Const::DEG_TO_RAD);
+            double y = 0.5 * scale * std::log((1.0 + a) / (1.0 - a));
+            double z = mapPos.getZ() * scale / EARTH_RADIUS;
+            mapPosesInternal[i] = MapPos(x, y, z);
+        }
+    }
+
     MapPos EPSG4326::fromWgs84(const MapPos& wgs84Pos) const {
         return wgs84Pos;
     }
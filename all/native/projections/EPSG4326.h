@@ -22,6 +22,8 @@ namespace carto {
         
         virtual MapPos fromInternal(const MapPos& mapPosInternal) const;
         virtual MapPos toInternal(const MapPos& mapPos) const;
+        virtual void fromInternal(const MapPos* mapPosesInternal, MapPos* mapPoses, std::size_t count) const;
+        virtual void toInternal(const MapPos* mapPoses, MapPos* mapPosesInternal, std::size_t count) const;
 
         virtual MapPos fromWgs84(const MapPos& wgs84Pos) const;
         virtual MapPos toWgs84(const MapPos& mapPos) const;
@@ -15,6 +15,18 @@ namespace carto {
         return _bounds;
     }
         
+    void Projection::fromInternal(const MapPos* posesInternal, MapPos* poses, std::size_t count) const {
+        for (std::size_t i = 0; i < count; i++) {
+            poses[i] = fromInternal(posesInternal[i]);
+        }
+    }
+
+    void Projection::toInternal(const MapPos* poses, MapPos* posesInternal, std::size_t count) const {
+        for (std::size_t i = 0; i < count; i++) {
+            posesInternal[i] = toInternal(poses[i]);
+        }
+    }
+        
     MapPos Projection::fromLatLong(double lat, double lng) const {
         return fromWgs84(MapPos(lng, lat));
     }
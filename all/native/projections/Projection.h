@@ -10,6 +10,8 @@
 #include "core/MapPos.h"
 #include "core/MapBounds.h"
 
+#include <cstddef>
+
 namespace carto {
     
     /**
@@ -37,6 +39,22 @@ namespace carto {
          * @return The transformed position in the internal coordinate system.
          */
         virtual MapPos toInternal(const MapPos& pos) const = 0;
+        /**
+         * Transforms an array of positions from the internal coordinate system to the coordinate system of this projection.
+         * The default implementation transforms the positions one by one.
+         * @param posesInternal The positions in the internal coordinate system.
+         * @param poses The output array for the transformed positions. Must not overlap with the input array.
+         * @param count The number of positions to transform.
+         */
+        virtual void fromInternal(const MapPos* posesInternal, MapPos* poses, std::size_t count) const;
+        /**
+         * Transforms an array of positions from the coordinate system of this projection to the internal coordinate system.
+         * The default implementation transforms the positions one by one.
+         * @param poses The positions in the coordinate system of this projection.
+         * @param posesInternal The output array for the transformed positions. Must not overlap with the input array.
+         * @param count The number of positions to transform.
+         */
+        virtual void toInternal(const MapPos* poses, MapPos* posesInternal, std::size_t count) const;
         
         /**
          * Transforms a position from the WGS84 coordinate system to the coordinate system of this projection.
@@ -1,6 +1,8 @@
 #include "SphericalProjectionSurface.h"
 #include "utils/Const.h"
 
+#include <cmath>
+
 namespace carto {
     
     SphericalProjectionSurface::SphericalProjectionSurface() {
@@ -22,6 +24,12 @@ namespace carto {
         return InternalToSpherical(mapPos) * SPHERE_SIZE;
     }
 
+    void SphericalProjectionSurface::calculatePositions(const MapPos* mapPoses, cglib::vec3<double>* positions, std::size_t count) const {
+        for (std::size_t i = 0; i < count; i++) {
+            positions[i] = InternalToSpherical(mapPoses[i]) * SPHERE_SIZE;
+        }
+    }
+
     cglib::vec3<double> SphericalProjectionSurface::calculateNormal(const MapPos& mapPos) const {
         return InternalToSpherical(mapPos);
     }
@@ -142,6 +150,15 @@ namespace carto {
     }
 
     bool SphericalProjectionSurface::SplitSegment(const MapPos& mapPos0, const MapPos& mapPos1, MapPos& mapPosM) {
+        // Fast conservative test in internal coordinates. The great circle distance is never longer than the Mercator
+        // distance scaled at the equator, so short segments (all segments at high zoom levels) can skip the trigonometric test.
+        double dx = mapPos1.getX() - mapPos0.getX();
+        double dy = mapPos1.getY() - mapPos0.getY();
+        double maxAngle = std::sqrt(dx * dx + dy * dy) * (2 * Const::PI / Const::WORLD_SIZE);
+        if (maxAngle * Const::EARTH_RADIUS < SEGMENT_SPLIT_THRESHOLD) {
+            return false;
+        }
+
         cglib::vec3<double> pos0 = cglib::unit(InternalToSpherical(mapPos0));
         cglib::vec3<double> pos1 = cglib::unit(InternalToSpherical(mapPos1));
         double dot = cglib::dot_product(pos0, pos1);
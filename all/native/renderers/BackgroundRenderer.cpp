@@ -227,6 +227,7 @@ namespace carto {
             glVertexAttribPointer(_a_normal, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), _backgroundVertices.data() + 3);
             glVertexAttribPointer(_a_texCoord, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), _backgroundVertices.data() + 6);
             glDrawElements(GL_TRIANGLES, _backgroundIndices.size(), GL_UNSIGNED_SHORT, _backgroundIndices.data());
+            GLContext::CountDrawCall(_backgroundIndices.size());
             glDisableVertexAttribArray(_a_normal);
         } else if (_options.getRenderProjectionMode() == RenderProjectionMode::RENDER_PROJECTION_MODE_PLANAR) {
             // Calculate coordinate transformation parameters
@@ -255,6 +256,7 @@ namespace carto {
             glVertexAttribPointer(_a_coord, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), _backgroundVertices.data() + 0);
             glVertexAttribPointer(_a_texCoord, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), _backgroundVertices.data() + 3);
             glDrawArrays(GL_TRIANGLE_STRIP, 0, vertexCount);
+            GLContext::CountDrawCall(vertexCount);
         }
     }
     
@@ -299,6 +301,7 @@ namespace carto {
         glVertexAttribPointer(_a_coord, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), _skyVertices.data() + 0);
         glVertexAttribPointer(_a_texCoord, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), _skyVertices.data() + 3);
         glDrawArrays(GL_TRIANGLE_STRIP, 0, vertexCount);
+        GLContext::CountDrawCall(vertexCount);
     }
 
     void BackgroundRenderer::drawContour(const ViewState& viewState) {
@@ -312,6 +315,7 @@ namespace carto {
         std::size_t vertexCount = _contourCoords.size();
         glVertexAttribPointer(_a_coord, 3, GL_FLOAT, GL_FALSE, 0, _contourCoords.data());
         glDrawArrays(GL_TRIANGLE_STRIP, 0, vertexCount);
+        GLContext::CountDrawCall(vertexCount);
     }
 
     void BackgroundRenderer::BuildPlanarSky(std::vector<cglib::vec3<float> >& coords, std::vector<cglib::vec2<float> >& texCoords, const cglib::vec3<double>& cameraPos, const cglib::vec3<double>& focusPos, const cglib::vec3<double>& upVec, double height0, double height1, float coordScale) {
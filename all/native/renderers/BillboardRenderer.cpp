@@ -49,34 +49,32 @@ namespace carto {
             return false;
         }
         
+        float scale = drawData.isScaleWithDPI() ? viewState.getUnitToDPCoef() : viewState.getUnitToPXCoef();
+        scale *= sizeScale;
+
+        // Calculate scaling, same for all corners
+        float coef = 1.0f;
+        switch (drawData.getScalingMode()) {
+        case BillboardScaling::BILLBOARD_SCALING_WORLD_SIZE:
+            break;
+        case BillboardScaling::BILLBOARD_SCALING_SCREEN_SIZE:
+            coef = scale;
+            break;
+        case BillboardScaling::BILLBOARD_SCALING_CONST_SCREEN_SIZE:
+        default:
+            coef = static_cast<float>(scale * drawData.getCameraPlaneZoomDistance());
+            break;
+        }
+
+        // Calculate axis
+        cglib::vec3<float> xAxis, yAxis;
+        CalculateBillboardAxis(drawData, viewState, xAxis, yAxis);
+
         const std::array<cglib::vec2<float>, 4>& coords = drawData.getCoords();
         for (int i = 0; i < 4; i++) {
             std::size_t coordIndex = (drawDataIndex * 4 + i) * 3;
-            float x = coords[i](0);
-            float y = coords[i](1);
-            
-            float scale = drawData.isScaleWithDPI() ? viewState.getUnitToDPCoef() : viewState.getUnitToPXCoef();
-            scale *= sizeScale;
-
-            // Calculate scaling
-            switch (drawData.getScalingMode()) {
-            case BillboardScaling::BILLBOARD_SCALING_WORLD_SIZE:
-                break;
-            case BillboardScaling::BILLBOARD_SCALING_SCREEN_SIZE:
-                x *= scale;
-                y *= scale;
-                break;
-            case BillboardScaling::BILLBOARD_SCALING_CONST_SCREEN_SIZE:
-            default:
-                float coef = static_cast<float>(scale * drawData.getCameraPlaneZoomDistance());
-                x *= coef;
-                y *= coef;
-                break;
-            }
-            
-            // Calculate axis
-            cglib::vec3<float> xAxis, yAxis;
-            CalculateBillboardAxis(drawData, viewState, xAxis, yAxis);
+            float x = coords[i](0) * coef;
+            float y = coords[i](1) * coef;
         
             // Build coordinates
             coordBuf[coordIndex + 0] = x * xAxis(0) + y * yAxis(0) + translate(0);
@@ -90,10 +88,15 @@ namespace carto {
         _layer(),
         _elements(),
         _tempElements(),
+        _tempElementsChanged(false),
+        _drawDataBuffer(),
+        _texCoordRectBuffer(),
         _colorBuf(),
         _coordBuf(),
         _indexBuf(),
         _texCoordBuf(),
+        _instanceRenderer(),
+        _instanceBuf(),
         _shader(),
         _a_color(0),
         _a_coord(0),
@@ -129,6 +132,8 @@ namespace carto {
         _u_mvpMat = _shader->getUniformLoc("u_mvpMat");
         _u_tex = _shader->getUniformLoc("u_tex");
 
+        _instanceRenderer.onSurfaceCreated(shaderManager);
+
         // Drop elements
         std::vector<std::shared_ptr<Billboard>> elements;
         {
@@ -145,10 +150,18 @@ namespace carto {
     
         // Billboards can't be rendered in layer order, they have to be sorted globally and drawn from back to front
         bool refresh = false;
+        std::shared_ptr<ProjectionSurface> projectionSurface = viewState.getProjectionSurface();
+        auto time = std::chrono::steady_clock::now();
         for (auto it = _elements.begin(); it != _elements.end(); ) {
             std::shared_ptr<Billboard> element = *it++;
             std::shared_ptr<BillboardDrawData> drawData = element->getDrawData();
 
+            // Update the position of moving billboards
+            if (drawData->isMoving() && projectionSurface) {
+                drawData->updateMovingPos(*projectionSurface, time);
+                refresh = true;
+            }
+
             // Update animation state
             bool phaseOut = drawData->getRenderer().lock() != shared_from_this() || (drawData->isHideIfOverlapped() && drawData->isOverlapping());
             if (auto animStyle = drawData->getAnimationStyle()) {
@@ -194,44 +207,58 @@ namespace carto {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
 
         // Prepare for drawing
-        glUseProgram(_shader->getProgId());
-        // Coords, texCoords, colors
-        glEnableVertexAttribArray(_a_coord);
-        glEnableVertexAttribArray(_a_texCoord);
-        glEnableVertexAttribArray(_a_color);
-        //Matrix
-        const cglib::mat4x4<float>& mvpMat = viewState.getRTEModelviewProjectionMat();
-        glUniformMatrix4fv(_u_mvpMat, 1, GL_FALSE, mvpMat.data());
-        // Texture
-        glUniform1i(_u_tex, 0);
+        if (_instanceRenderer.isAvailable()) {
+            _instanceRenderer.bind(viewState);
+        } else {
+            glUseProgram(_shader->getProgId());
+            // Coords, texCoords, colors
+            glEnableVertexAttribArray(_a_coord);
+            glEnableVertexAttribArray(_a_texCoord);
+            glEnableVertexAttribArray(_a_color);
+            //Matrix
+            const cglib::mat4x4<float>& mvpMat = viewState.getRTEModelviewProjectionMat();
+            glUniformMatrix4fv(_u_mvpMat, 1, GL_FALSE, mvpMat.data());
+            // Texture
+            glUniform1i(_u_tex, 0);
+        }
         
-        // Draw billboards, batch by bitmap
+        // Draw billboards, batch by texture. Small bitmaps share atlas textures
         _drawDataBuffer.clear();
-        std::shared_ptr<Bitmap> prevBitmap;
+        _texCoordRectBuffer.clear();
+        std::shared_ptr<Texture> prevTexture;
         for (const std::shared_ptr<BillboardDrawData>& drawData : billboardDrawDatas) {
-            if (std::shared_ptr<Bitmap> bitmap = drawData->getBitmap()) {
-                if (prevBitmap && prevBitmap != bitmap) {
-                    drawBatch(opacity, styleCache, viewState);
+            if (const std::shared_ptr<Bitmap>& bitmap = drawData->getBitmap()) {
+                cglib::vec4<float> texCoordRect;
+                std::shared_ptr<Texture> texture = styleCache.getPacked(bitmap, drawData->isGenMipmaps(), texCoordRect);
+                if (prevTexture && prevTexture != texture) {
+                    drawBatch(*prevTexture, opacity, viewState);
                     _drawDataBuffer.clear();
+                    _texCoordRectBuffer.clear();
                 }
         
-                _drawDataBuffer.push_back(std::move(drawData));
-                prevBitmap = bitmap;
+                _drawDataBuffer.push_back(drawData);
+                _texCoordRectBuffer.push_back(texCoordRect);
+                prevTexture = texture;
             }
         }
     
-        if (prevBitmap) {
-            drawBatch(opacity, styleCache, viewState);
+        if (prevTexture) {
+            drawBatch(*prevTexture, opacity, viewState);
         }
     
-        glDisableVertexAttribArray(_a_coord);
-        glDisableVertexAttribArray(_a_texCoord);
-        glDisableVertexAttribArray(_a_color);
+        if (_instanceRenderer.isAvailable()) {
+            _instanceRenderer.unbind();
+        } else {
+            glDisableVertexAttribArray(_a_coord);
+            glDisableVertexAttribArray(_a_texCoord);
+            glDisableVertexAttribArray(_a_color);
+        }
     
         GLContext::CheckGLError("BillboardRenderer::onDrawFrameSorted");
     }
     
     void BillboardRenderer::onSurfaceDestroyed() {
+        _instanceRenderer.onSurfaceDestroyed();
         _shader.reset();
     }
     
@@ -242,15 +269,24 @@ namespace carto {
         
     void BillboardRenderer::addElement(const std::shared_ptr<Billboard>& element) {
         if (std::shared_ptr<BillboardDrawData> drawData = element->getDrawData()) {
+            // Draw datas not yet attached to this renderer were created after the last refresh
+            if (drawData->getRenderer().lock().get() != this) {
+                _tempElementsChanged = true;
+            }
             drawData->setRenderer(shared_from_this());
             _tempElements.push_back(element);
         }
     }
     
-    void BillboardRenderer::refreshElements() {
+    bool BillboardRenderer::refreshElements() {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
+        // Report a change only if billboards were added or removed or their draw datas were replaced,
+        // so that the placement is not recalculated when the same billboards stay visible
+        bool changed = _tempElementsChanged || _tempElements != _elements;
+        _tempElementsChanged = false;
         _elements.clear();
         _elements.swap(_tempElements);
+        return changed;
     }
     
     void BillboardRenderer::updateElement(const std::shared_ptr<Billboard>& element) {
@@ -347,9 +383,8 @@ namespace carto {
                                                 std::vector<unsigned short>& indexBuf,
                                                 std::vector<float>& texCoordBuf,
                                                 std::vector<std::shared_ptr<BillboardDrawData> >& drawDataBuffer,
-                                                const cglib::vec2<float>& texCoordScale,
+                                                const std::vector<cglib::vec4<float> >& texCoordRectBuffer,
                                                 float opacity,
-                                                StyleTextureCache& styleCache,
                                                 const ViewState& viewState)
     {
         // Resize the buffers, if necessary
@@ -375,6 +410,7 @@ namespace carto {
                 glVertexAttribPointer(a_texCoord, 2, GL_FLOAT, GL_FALSE, 0, texCoordBuf.data());
                 glVertexAttribPointer(a_color, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, colorBuf.data());
                 glDrawElements(GL_TRIANGLES, drawDataIndex * 6, GL_UNSIGNED_SHORT, indexBuf.data());
+                GLContext::CountDrawCall(drawDataIndex * 6);
                 // Start filling buffers from the beginning
                 drawDataIndex = 0;
             }
@@ -398,25 +434,28 @@ namespace carto {
             }
             
             // Calculate texture coordinates
+            const cglib::vec4<float>& texCoordRect = texCoordRectBuffer[i];
+            float u0 = texCoordRect(0), v0 = texCoordRect(1);
+            float u1 = texCoordRect(0) + texCoordRect(2), v1 = texCoordRect(1) + texCoordRect(3);
             std::size_t texCoordIndex = drawDataIndex * 4 * 2;
             if (!flip) {
-                texCoordBuf[texCoordIndex + 0] = 0.0f;
-                texCoordBuf[texCoordIndex + 1] = texCoordScale(1);
-                texCoordBuf[texCoordIndex + 2] = 0.0f;
-                texCoordBuf[texCoordIndex + 3] = 0.0f;
-                texCoordBuf[texCoordIndex + 4] = texCoordScale(0);
-                texCoordBuf[texCoordIndex + 5] = texCoordScale(1);
-                texCoordBuf[texCoordIndex + 6] = texCoordScale(0);
-                texCoordBuf[texCoordIndex + 7] = 0.0f;
+                texCoordBuf[texCoordIndex + 0] = u0;
+                texCoordBuf[texCoordIndex + 1] = v1;
+                texCoordBuf[texCoordIndex + 2] = u0;
+                texCoordBuf[texCoordIndex + 3] = v0;
+                texCoordBuf[texCoordIndex + 4] = u1;
+                texCoordBuf[texCoordIndex + 5] = v1;
+                texCoordBuf[texCoordIndex + 6] = u1;
+                texCoordBuf[texCoordIndex + 7] = v0;
             } else {
-                texCoordBuf[texCoordIndex + 0] = texCoordScale(0);
-                texCoordBuf[texCoordIndex + 1] = 0.0f;
-                texCoordBuf[texCoordIndex + 2] = texCoordScale(0);
-                texCoordBuf[texCoordIndex + 3] = texCoordScale(1);
-                texCoordBuf[texCoordIndex + 4] = 0.0f;
-                texCoordBuf[texCoordIndex + 5] = 0.0f;
-                texCoordBuf[texCoordIndex + 6] = 0.0f;
-                texCoordBuf[texCoordIndex + 7] = texCoordScale(1);
+                texCoordBuf[texCoordIndex + 0] = u1;
+                texCoordBuf[texCoordIndex + 1] = v0;
+                texCoordBuf[texCoordIndex + 2] = u1;
+                texCoordBuf[texCoordIndex + 3] = v1;
+                texCoordBuf[texCoordIndex + 4] = u0;
+                texCoordBuf[texCoordIndex + 5] = v0;
+                texCoordBuf[texCoordIndex + 6] = u0;
+                texCoordBuf[texCoordIndex + 7] = v1;
             }
             
             // Calculate colors
@@ -446,6 +485,77 @@ namespace carto {
         glVertexAttribPointer(a_texCoord, 2, GL_FLOAT, GL_FALSE, 0, texCoordBuf.data());
         glVertexAttribPointer(a_color, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, colorBuf.data());
         glDrawElements(GL_TRIANGLES, drawDataIndex * 6, GL_UNSIGNED_SHORT, indexBuf.data());
+        GLContext::CountDrawCall(drawDataIndex * 6);
+    }
+        
+    void BillboardRenderer::BuildAndDrawInstances(QuadInstanceRenderer& instanceRenderer,
+                                                  std::vector<QuadInstanceRenderer::Instance>& instanceBuf,
+                                                  std::vector<float>& coordBuf,
+                                                  std::vector<std::shared_ptr<BillboardDrawData> >& drawDataBuffer,
+                                                  const std::vector<cglib::vec4<float> >& texCoordRectBuffer,
+                                                  float opacity,
+                                                  const ViewState& viewState)
+    {
+        if (coordBuf.size() < 4 * 3) {
+            coordBuf.resize(4 * 3);
+        }
+
+        // Build a single instance per billboard, the corners are expanded in the vertex shader
+        instanceBuf.clear();
+        instanceBuf.reserve(drawDataBuffer.size());
+        for (std::size_t i = 0; i < drawDataBuffer.size(); i++) {
+            const std::shared_ptr<BillboardDrawData>& drawData = drawDataBuffer[i];
+
+            // If invisible, skip further steps
+            if (drawData->getTransition() == 0) {
+                continue;
+            }
+
+            // Alpha value
+            int alpha = std::min(256, static_cast<int>(256 * opacity * AnimationStyle::CalculateTransition(drawData->getAnimationStyle() ? drawData->getAnimationStyle()->getFadeAnimationType() : AnimationType::ANIMATION_TYPE_NONE, drawData->getTransition())));
+
+            // Calculate corner coordinates. The coordinates form a parallelogram (left-top, left-bottom, right-top, right-bottom)
+            float relativeSize = AnimationStyle::CalculateTransition(drawData->getAnimationStyle() ? drawData->getAnimationStyle()->getSizeAnimationType() : AnimationType::ANIMATION_TYPE_NONE, drawData->getTransition());
+            if (!CalculateBillboardCoords(*drawData, viewState, coordBuf, 0, relativeSize)) {
+                continue;
+            }
+
+            // Billboards with ground orientation (like some texts) have to be flipped to readable
+            bool flip = false;
+            if (drawData->isFlippable() && drawData->getOrientationMode() == BillboardOrientation::BILLBOARD_ORIENTATION_GROUND) {
+                float dAngle = std::fmod(viewState.getRotation() - drawData->getRotation() + 360.0f, 360.0f);
+                flip = dAngle > 90 && dAngle < 270;
+            }
+
+            instanceBuf.emplace_back();
+            QuadInstanceRenderer::Instance& instance = instanceBuf.back();
+            for (int j = 0; j < 3; j++) {
+                instance.origin[j] = coordBuf[j];
+                instance.xAxis[j] = coordBuf[6 + j] - coordBuf[j];
+                instance.yAxis[j] = coordBuf[3 + j] - coordBuf[j];
+            }
+
+            const cglib::vec4<float>& texCoordRect = texCoordRectBuffer[i];
+            if (!flip) {
+                instance.texCoordRect[0] = texCoordRect(0);
+                instance.texCoordRect[1] = texCoordRect(1) + texCoordRect(3);
+                instance.texCoordRect[2] = texCoordRect(2);
+                instance.texCoordRect[3] = -texCoordRect(3);
+            } else {
+                instance.texCoordRect[0] = texCoordRect(0) + texCoordRect(2);
+                instance.texCoordRect[1] = texCoordRect(1);
+                instance.texCoordRect[2] = -texCoordRect(2);
+                instance.texCoordRect[3] = texCoordRect(3);
+            }
+
+            const Color& color = drawData->getColor();
+            instance.color[0] = static_cast<unsigned char>((color.getR() * alpha) >> 8);
+            instance.color[1] = static_cast<unsigned char>((color.getG() * alpha) >> 8);
+            instance.color[2] = static_cast<unsigned char>((color.getB() * alpha) >> 8);
+            instance.color[3] = static_cast<unsigned char>((color.getA() * alpha) >> 8);
+        }
+
+        instanceRenderer.drawInstances(instanceBuf);
     }
         
     bool BillboardRenderer::calculateBaseBillboardDrawData(const std::shared_ptr<BillboardDrawData>& drawData, const ViewState& viewState) {
@@ -511,18 +621,17 @@ namespace carto {
         return true;
     }
         
-    void BillboardRenderer::drawBatch(float opacity, StyleTextureCache& styleCache, const ViewState& viewState) {
+    void BillboardRenderer::drawBatch(const Texture& texture, float opacity, const ViewState& viewState) {
         // Bind texture
-        const std::shared_ptr<Bitmap>& bitmap = _drawDataBuffer.front()->getBitmap();
-        std::shared_ptr<Texture> texture = styleCache.get(bitmap);
-        if (!texture) {
-            texture = styleCache.create(bitmap, _drawDataBuffer.front()->isGenMipmaps(), false);
-        }
-        glBindTexture(GL_TEXTURE_2D, texture->getTexId());
+        glBindTexture(GL_TEXTURE_2D, texture.getTexId());
         
-        // Draw the draw datas, multiple passes may be necessary
-        BuildAndDrawBuffers(_a_color, _a_coord, _a_texCoord, _colorBuf, _coordBuf, _indexBuf, _texCoordBuf, _drawDataBuffer,
-                            texture->getTexCoordScale(), opacity, styleCache, viewState);
+        // Draw the draw datas, using instancing if supported. Otherwise multiple passes may be necessary
+        if (_instanceRenderer.isAvailable()) {
+            BuildAndDrawInstances(_instanceRenderer, _instanceBuf, _coordBuf, _drawDataBuffer, _texCoordRectBuffer, opacity, viewState);
+        } else {
+            BuildAndDrawBuffers(_a_color, _a_coord, _a_texCoord, _colorBuf, _coordBuf, _indexBuf, _texCoordBuf, _drawDataBuffer,
+                                _texCoordRectBuffer, opacity, viewState);
+        }
     }
     
     const std::string BillboardRenderer::BILLBOARD_VERTEX_SHADER = R"GLSL(
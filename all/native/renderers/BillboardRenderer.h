@@ -9,6 +9,7 @@
 
 #include "core/MapPos.h"
 #include "graphics/utils/GLContext.h"
+#include "renderers/components/QuadInstanceRenderer.h"
 
 #include <deque>
 #include <memory>
@@ -26,6 +27,7 @@ namespace carto {
     class Bitmap;
     class Shader;
     class ShaderManager;
+    class Texture;
     class TextureManager;
     class RayIntersectedElement;
     class VectorLayer;
@@ -49,7 +51,7 @@ namespace carto {
     
         std::size_t getElementCount() const;
         void addElement(const std::shared_ptr<Billboard>& element);
-        void refreshElements();
+        bool refreshElements();
         void updateElement(const std::shared_ptr<Billboard>& element);
         void removeElement(const std::shared_ptr<Billboard>& element);
         
@@ -67,14 +69,21 @@ namespace carto {
                                         std::vector<unsigned short>& indexBuf,
                                         std::vector<float>& texCoordBuf,
                                         std::vector<std::shared_ptr<BillboardDrawData> >& drawDataBuffer,
-                                        const cglib::vec2<float>& texCoordScale,
+                                        const std::vector<cglib::vec4<float> >& texCoordRectBuffer,
                                         float opacity,
-                                        StyleTextureCache& styleCache,
                                         const ViewState& viewState);
+
+        static void BuildAndDrawInstances(QuadInstanceRenderer& instanceRenderer,
+                                          std::vector<QuadInstanceRenderer::Instance>& instanceBuf,
+                                          std::vector<float>& coordBuf,
+                                          std::vector<std::shared_ptr<BillboardDrawData> >& drawDataBuffer,
+                                          const std::vector<cglib::vec4<float> >& texCoordRectBuffer,
+                                          float opacity,
+                                          const ViewState& viewState);
         
         bool calculateBaseBillboardDrawData(const std::shared_ptr<BillboardDrawData>& drawData, const ViewState& viewState);
         
-        void drawBatch(float opacity, StyleTextureCache& styleCache, const ViewState& viewState);
+        void drawBatch(const Texture& texture, float opacity, const ViewState& viewState);
         
         static const std::string BILLBOARD_VERTEX_SHADER;
         static const std::string BILLBOARD_FRAGMENT_SHADER;
@@ -83,13 +92,18 @@ namespace carto {
     
         std::vector<std::shared_ptr<Billboard> > _elements;
         std::vector<std::shared_ptr<Billboard> > _tempElements;
+        bool _tempElementsChanged; // true if any of the added elements has a new draw data
         
         std::vector<std::shared_ptr<BillboardDrawData> > _drawDataBuffer;
+        std::vector<cglib::vec4<float> > _texCoordRectBuffer;
         
         std::vector<unsigned char> _colorBuf;
         std::vector<float> _coordBuf;
         std::vector<unsigned short> _indexBuf;
         std::vector<float> _texCoordBuf;
+
+        QuadInstanceRenderer _instanceRenderer;
+        std::vector<QuadInstanceRenderer::Instance> _instanceBuf;
     
         std::shared_ptr<Shader> _shader;
         GLuint _a_color;
@@ -0,0 +1,248 @@
+#include "BitmapOverlayRenderer.h"
+#include "graphics/Bitmap.h"
+#include "graphics/Shader.h"
+#include "graphics/ShaderManager.h"
+#include "graphics/TextureManager.h"
+#include "graphics/Texture.h"
+#include "graphics/ViewState.h"
+#include "graphics/utils/GLContext.h"
+#include "projections/Projection.h"
+#include "projections/ProjectionSurface.h"
+#include "utils/Log.h"
+
+#include <algorithm>
+
+namespace carto {
+
+    BitmapOverlayRenderer::BitmapOverlayRenderer() :
+        _bitmap(),
+        _projection(),
+        _corners(),
+        _origin(cglib::vec2<double>::zero()),
+        _uvTransform(cglib::mat3x3<float>::identity()),
+        _color(255, 255, 255, 255),
+        _horizontalOffset(0),
+        _gridProjectionSurface(),
+        _gridPositions(),
+        _gridMapCoords(),
+        _gridIndices(),
+        _coordBuf(),
+        _bitmapTex(),
+        _maxTextureSize(0),
+        _shader(),
+        _a_coord(0),
+        _a_mapCoord(0),
+        _u_mvpMat(0),
+        _u_uvMat(0),
+        _u_tex(0),
+        _u_texCoordScale(0),
+        _u_color(0),
+        _textureManager(),
+        _mutex()
+    {
+    }
+
+    BitmapOverlayRenderer::~BitmapOverlayRenderer() {
+    }
+
+    void BitmapOverlayRenderer::setOverlay(const std::shared_ptr<Bitmap>& bitmap, const std::shared_ptr<Projection>& projection, const std::vector<MapPos>& corners, const cglib::vec2<double>& origin, const cglib::mat3x3<double>& invTransform) {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        _bitmap = bitmap;
+        _projection = projection;
+        _corners = corners;
+        _origin = origin;
+
+        // Normalize the bitmap coordinates, so that the shader can work with texture coordinates directly
+        cglib::mat3x3<double> normalizeMat = cglib::scale3_matrix(cglib::vec3<double>(1.0 / bitmap->getWidth(), 1.0 / bitmap->getHeight(), 1));
+        _uvTransform = cglib::mat3x3<float>::convert(normalizeMat * invTransform);
+
+        _gridProjectionSurface.reset();
+        _bitmapTex.reset();
+    }
+
+    void BitmapOverlayRenderer::setColor(const Color& color) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _color = color;
+    }
+
+    void BitmapOverlayRenderer::offsetLayerHorizontally(double offset) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _horizontalOffset += offset;
+    }
+
+    void BitmapOverlayRenderer::onSurfaceCreated(const std::shared_ptr<ShaderManager>& shaderManager, const std::shared_ptr<TextureManager>& textureManager) {
+        static ShaderSource shaderSource("bitmapoverlay", &BITMAP_OVERLAY_VERTEX_SHADER, &BITMAP_OVERLAY_FRAGMENT_SHADER);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // Shader and textures must be reloaded
+        _shader = shaderManager->createShader(shaderSource);
+
+        // Get shader variables locations
+        glUseProgram(_shader->getProgId());
+        _u_mvpMat = _shader->getUniformLoc("u_mvpMat");
+        _u_uvMat = _shader->getUniformLoc("u_uvMat");
+        _u_tex = _shader->getUniformLoc("u_tex");
+        _u_texCoordScale = _shader->getUniformLoc("u_texCoordScale");
+        _u_color = _shader->getUniformLoc("u_color");
+        _a_coord = _shader->getAttribLoc("a_coord");
+        _a_mapCoord = _shader->getAttribLoc("a_mapCoord");
+
+        GLint maxTextureSize = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+        _maxTextureSize = maxTextureSize;
+
+        _textureManager = textureManager;
+
+        _bitmapTex.reset();
+        _horizontalOffset = 0;
+        _gridProjectionSurface.reset();
+    }
+
+    void BitmapOverlayRenderer::onDrawFrame(const ViewState& viewState) {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (!_bitmap || !_shader || !viewState.getProjectionSurface()) {
+            return;
+        }
+
+        // Upload the bitmap once, including the mipmap levels. Bitmaps exceeding the texture size limit are downscaled
+        if (!_bitmapTex) {
+            std::shared_ptr<Bitmap> bitmap = _bitmap;
+            int maxSize = std::max(bitmap->getWidth(), bitmap->getHeight());
+            if (_maxTextureSize > 0 && maxSize > _maxTextureSize) {
+                Log::Infof("BitmapOverlayRenderer::onDrawFrame: Downscaling bitmap to fit maximum texture size %d", _maxTextureSize);
+                float scale = static_cast<float>(_maxTextureSize) / maxSize;
+                unsigned int width  = std::max(1, static_cast<int>(bitmap->getWidth()  * scale));
+                unsigned int height = std::max(1, static_cast<int>(bitmap->getHeight() * scale));
+                bitmap = bitmap->getResizedBitmap(width, height);
+            }
+            _bitmapTex = _textureManager->createTexture(bitmap, true, false);
+        }
+
+        if (_gridProjectionSurface != viewState.getProjectionSurface()) {
+            buildGrid(*viewState.getProjectionSurface());
+            _gridProjectionSurface = viewState.getProjectionSurface();
+        }
+
+        // Calculate vertex coordinates relative to the camera, as the shaders use single precision
+        cglib::vec3<double> cameraPos = viewState.getCameraPos();
+        _coordBuf.resize(_gridPositions.size() * 3);
+        for (std::size_t i = 0; i < _gridPositions.size(); i++) {
+            const cglib::vec3<double>& pos = _gridPositions[i];
+            _coordBuf[i * 3 + 0] = static_cast<float>(pos(0) + _horizontalOffset - cameraPos(0));
+            _coordBuf[i * 3 + 1] = static_cast<float>(pos(1) - cameraPos(1));
+            _coordBuf[i * 3 + 2] = static_cast<float>(pos(2) - cameraPos(2));
+        }
+
+        glDisable(GL_CULL_FACE);
+
+        // Prepare for drawing
+        glUseProgram(_shader->getProgId());
+        // Texture, color
+        glUniform1i(_u_tex, 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, _bitmapTex->getTexId());
+        glUniform2fv(_u_texCoordScale, 1, _bitmapTex->getTexCoordScale().data());
+        float alpha = _color.getA() / 255.0f;
+        glUniform4f(_u_color, _color.getR() * alpha / 255.0f, _color.getG() * alpha / 255.0f, _color.getB() * alpha / 255.0f, alpha);
+        // Matrices
+        const cglib::mat4x4<float>& mvpMat = viewState.getRTEModelviewProjectionMat();
+        glUniformMatrix4fv(_u_mvpMat, 1, GL_FALSE, mvpMat.data());
+        glUniformMatrix3fv(_u_uvMat, 1, GL_FALSE, _uvTransform.data());
+        // Coords, map coords
+        glEnableVertexAttribArray(_a_coord);
+        glEnableVertexAttribArray(_a_mapCoord);
+        glVertexAttribPointer(_a_coord, 3, GL_FLOAT, GL_FALSE, 0, _coordBuf.data());
+        glVertexAttribPointer(_a_mapCoord, 2, GL_FLOAT, GL_FALSE, 0, _gridMapCoords.data());
+
+        // Draw
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(_gridIndices.size()), GL_UNSIGNED_SHORT, _gridIndices.data());
+        GLContext::CountDrawCall(_gridIndices.size());
+
+        // Disable bound arrays
+        glDisableVertexAttribArray(_a_coord);
+        glDisableVertexAttribArray(_a_mapCoord);
+
+        glEnable(GL_CULL_FACE);
+
+        GLContext::CheckGLError("BitmapOverlayRenderer::onDrawFrame");
+    }
+
+    void BitmapOverlayRenderer::onSurfaceDestroyed() {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        _bitmapTex.reset();
+        _gridProjectionSurface.reset();
+
+        _shader.reset();
+        _textureManager.reset();
+    }
+
+    void BitmapOverlayRenderer::buildGrid(const ProjectionSurface& projectionSurface) {
+        // The projective mapping keeps lines straight, so the bitmap covers the quadrilateral of its corners in map space.
+        // The grid only approximates the surface, the texture coordinates are calculated per fragment
+        _gridPositions.clear();
+        _gridMapCoords.clear();
+        for (int j = 0; j <= GRID_SIZE; j++) {
+            double t = static_cast<double>(j) / GRID_SIZE;
+            for (int i = 0; i <= GRID_SIZE; i++) {
+                double s = static_cast<double>(i) / GRID_SIZE;
+                MapPos top(_corners[0].getX() + (_corners[1].getX() - _corners[0].getX()) * s, _corners[0].getY() + (_corners[1].getY() - _corners[0].getY()) * s);
+                MapPos bottom(_corners[2].getX() + (_corners[3].getX() - _corners[2].getX()) * s, _corners[2].getY() + (_corners[3].getY() - _corners[2].getY()) * s);
+                MapPos mapPos(top.getX() + (bottom.getX() - top.getX()) * t, top.getY() + (bottom.getY() - top.getY()) * t);
+
+                _gridPositions.push_back(projectionSurface.calculatePosition(_projection->toInternal(mapPos)));
+                _gridMapCoords.push_back(static_cast<float>(mapPos.getX() - _origin(0)));
+                _gridMapCoords.push_back(static_cast<float>(mapPos.getY() - _origin(1)));
+            }
+        }
+
+        _gridIndices.clear();
+        for (int j = 0; j < GRID_SIZE; j++) {
+            for (int i = 0; i < GRID_SIZE; i++) {
+                unsigned short i0 = static_cast<unsigned short>(j * (GRID_SIZE + 1) + i);
+                unsigned short i1 = static_cast<unsigned short>(i0 + GRID_SIZE + 1);
+                _gridIndices.insert(_gridIndices.end(), { i0, i1, static_cast<unsigned short>(i0 + 1) });
+                _gridIndices.insert(_gridIndices.end(), { static_cast<unsigned short>(i0 + 1), i1, static_cast<unsigned short>(i1 + 1) });
+            }
+        }
+    }
+
+    const int BitmapOverlayRenderer::GRID_SIZE = 16;
+
+    const std::string BitmapOverlayRenderer::BITMAP_OVERLAY_VERTEX_SHADER = R"GLSL(
+        #version 100
+        attribute vec3 a_coord;
+        attribute vec2 a_mapCoord;
+        varying vec3 v_uvw;
+        uniform mat4 u_mvpMat;
+        uniform mat3 u_uvMat;
+        void main() {
+            v_uvw = u_uvMat * vec3(a_mapCoord, 1.0);
+            gl_Position = u_mvpMat * vec4(a_coord, 1.0);
+        }
+    )GLSL";
+
+    const std::string BitmapOverlayRenderer::BITMAP_OVERLAY_FRAGMENT_SHADER = R"GLSL(
+        #version 100
+        #ifdef GL_FRAGMENT_PRECISION_HIGH
+        precision highp float;
+        #else
+        precision mediump float;
+        #endif
+        varying vec3 v_uvw;
+        uniform sampler2D u_tex;
+        uniform vec2 u_texCoordScale;
+        uniform vec4 u_color;
+        void main() {
+            vec2 uv = v_uvw.xy / v_uvw.z;
+            if (uv.x < 0.0 || uv.y < 0.0 || uv.x > 1.0 || uv.y > 1.0) {
+                discard;
+            }
+            gl_FragColor = texture2D(u_tex, uv * u_texCoordScale) * u_color;
+        }
+    )GLSL";
+
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_BITMAPOVERLAYRENDERER_H_
+#define _CARTO_BITMAPOVERLAYRENDERER_H_
+
+#include "core/MapPos.h"
+#include "graphics/Color.h"
+#include "graphics/utils/GLContext.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <cglib/vec.h>
+#include <cglib/mat.h>
+
+namespace carto {
+    class Bitmap;
+    class Projection;
+    class ProjectionSurface;
+    class Shader;
+    class Texture;
+    class ViewState;
+    class ShaderManager;
+    class TextureManager;
+
+    class BitmapOverlayRenderer {
+    public:
+        BitmapOverlayRenderer();
+        virtual ~BitmapOverlayRenderer();
+
+        void setOverlay(const std::shared_ptr<Bitmap>& bitmap, const std::shared_ptr<Projection>& projection, const std::vector<MapPos>& corners, const cglib::vec2<double>& origin, const cglib::mat3x3<double>& invTransform);
+        void setColor(const Color& color);
+
+        void offsetLayerHorizontally(double offset);
+
+        void onSurfaceCreated(const std::shared_ptr<ShaderManager>& shaderManager, const std::shared_ptr<TextureManager>& textureManager);
+        void onDrawFrame(const ViewState& viewState);
+        void onSurfaceDestroyed();
+
+    private:
+        void buildGrid(const ProjectionSurface& projectionSurface);
+
+        static const int GRID_SIZE; // number of grid cells along each bitmap axis, the grid follows the curvature of the projection surface
+
+        static const std::string BITMAP_OVERLAY_VERTEX_SHADER;
+        static const std::string BITMAP_OVERLAY_FRAGMENT_SHADER;
+
+        std::shared_ptr<Bitmap> _bitmap;
+        std::shared_ptr<Projection> _projection;
+        std::vector<MapPos> _corners; // projected bitmap corners: top-left, top-right, bottom-left, bottom-right
+        cglib::vec2<double> _origin;
+        cglib::mat3x3<float> _uvTransform; // map coordinates relative to the origin -> normalized homogeneous bitmap coordinates
+        Color _color;
+        double _horizontalOffset;
+
+        std::shared_ptr<ProjectionSurface> _gridProjectionSurface;
+        std::vector<cglib::vec3<double> > _gridPositions;
+        std::vector<float> _gridMapCoords;
+        std::vector<unsigned short> _gridIndices;
+        std::vector<float> _coordBuf;
+
+        std::shared_ptr<Texture> _bitmapTex;
+        int _maxTextureSize;
+
+        std::shared_ptr<Shader> _shader;
+        GLuint _a_coord;
+        GLuint _a_mapCoord;
+        GLuint _u_mvpMat;
+        GLuint _u_uvMat;
+        GLuint _u_tex;
+        GLuint _u_texCoordScale;
+        GLuint _u_color;
+
+        std::shared_ptr<TextureManager> _textureManager;
+
+        mutable std::mutex _mutex;
+    };
+
+}
+
+#endif
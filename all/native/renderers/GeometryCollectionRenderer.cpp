@@ -52,7 +52,15 @@ namespace carto {
     void GeometryCollectionRenderer::onDrawFrame(float deltaSeconds, StyleTextureCache& styleCache, const ViewState& viewState) {
         std::lock_guard<std::mutex> lock(_mutex);
 
+        // Line and polygon buffers are matched in the drawing order, release the buffers that are not used in this frame
+        _lineRenderer._bufferCache.beginFrame();
+        _polygonRenderer._bufferCache.beginFrame();
+        _polygonRenderer._lineRenderer._bufferCache.beginFrame();
+
         if (_elements.empty()) {
+            _lineRenderer._bufferCache.endFrame();
+            _polygonRenderer._bufferCache.endFrame();
+            _polygonRenderer._lineRenderer._bufferCache.endFrame();
             // Early return, to avoid calling glUseProgram etc.
             return;
         }
@@ -113,6 +121,10 @@ namespace carto {
             _polygonRenderer.drawBatch(styleCache, viewState);
             _polygonRenderer.unbind();
         }
+
+        _lineRenderer._bufferCache.endFrame();
+        _polygonRenderer._bufferCache.endFrame();
+        _polygonRenderer._lineRenderer._bufferCache.endFrame();
         
         glEnable(GL_CULL_FACE);
     }
@@ -23,23 +23,29 @@ namespace carto {
         _elements(),
         _tempElements(),
         _drawDataBuffer(),
-        _lineDrawDataBuffer(),
         _prevBitmap(nullptr),
         _colorBuf(),
         _coordBuf(),
+        _coordLowBuf(),
         _normalBuf(),
         _texCoordBuf(),
         _indexBuf(),
         _shader(),
         _a_color(0),
         _a_coord(0),
+        _a_coordLow(0),
         _a_normal(0),
         _a_texCoord(0),
         _u_gamma(0),
         _u_dpToPX(0),
         _u_unitToDP(0),
+        _u_texCoordYScale(0),
+        _u_cameraPosHigh(0),
+        _u_cameraPosLow(0),
         _u_mvpMat(0),
         _u_tex(0),
+        _bufferCache(),
+        _pickIndex(),
         _mutex()
     {
     }
@@ -54,6 +60,10 @@ namespace carto {
         for (const std::shared_ptr<Line>& element : _elements) {
             element->getDrawData()->offsetHorizontally(offset);
         }
+
+        // Draw data coordinates were modified in place, buffers and the pick index must be rebuilt
+        _bufferCache.invalidate();
+        _pickIndex.invalidate();
     }
     
     void LineRenderer::onSurfaceCreated(const std::shared_ptr<ShaderManager>& shaderManager, const std::shared_ptr<TextureManager>& textureManager) {
@@ -65,19 +75,27 @@ namespace carto {
         glUseProgram(_shader->getProgId());
         _a_color = _shader->getAttribLoc("a_color");
         _a_coord = _shader->getAttribLoc("a_coord");
+        _a_coordLow = _shader->getAttribLoc("a_coordLow");
         _a_normal = _shader->getAttribLoc("a_normal");
         _a_texCoord = _shader->getAttribLoc("a_texCoord");
         _u_gamma = _shader->getUniformLoc("u_gamma");
         _u_dpToPX = _shader->getUniformLoc("u_dpToPX");
         _u_unitToDP = _shader->getUniformLoc("u_unitToDP");
+        _u_texCoordYScale = _shader->getUniformLoc("u_texCoordYScale");
+        _u_cameraPosHigh = _shader->getUniformLoc("u_cameraPosHigh");
+        _u_cameraPosLow = _shader->getUniformLoc("u_cameraPosLow");
         _u_mvpMat = _shader->getUniformLoc("u_mvpMat");
         _u_tex = _shader->getUniformLoc("u_tex");
 
+        // Buffers of the previous context are no longer valid
+        _bufferCache.reset();
+
         // Drop elements
         std::vector<std::shared_ptr<Line>> elements;
         {
             std::lock_guard<std::mutex> lock(_mutex);
             std::swap(elements, _elements);
+            _pickIndex.invalidate();
         }
         for (const std::shared_ptr<Line>& element : elements) {
             element->setDrawData(std::shared_ptr<LineDrawData>());
@@ -88,7 +106,9 @@ namespace carto {
         std::lock_guard<std::mutex> lock(_mutex);
         
         if (_elements.empty()) {
-            // Early return, to avoid calling glUseProgram etc.
+            // Release the buffers of the removed elements. Early return, to avoid calling glUseProgram etc.
+            _bufferCache.beginFrame();
+            _bufferCache.endFrame();
             return;
         }
         
@@ -97,13 +117,23 @@ namespace carto {
         bind(viewState);
     
         // Draw, batch by bitmap
+        _bufferCache.beginFrame();
         for (const std::shared_ptr<Line>& element : _elements) {
             addToBatch(element->getDrawData(), styleCache, viewState);
         }
         drawBatch(styleCache, viewState);
+        _bufferCache.endFrame();
         
         unbind();
 
+        // Rebuild the pick index for click handling if the view or the elements have changed
+        if (!_pickIndex.isValid(viewState)) {
+            _pickIndex.reset(viewState);
+            for (std::size_t i = 0; i < _elements.size(); i++) {
+                _pickIndex.add(i, CalculatePickBounds(*_elements[i]->getDrawData(), viewState));
+            }
+        }
+
         glEnable(GL_CULL_FACE);
     
         GLContext::CheckGLError("LineRenderer::onDrawFrame");
@@ -111,6 +141,7 @@ namespace carto {
     
     void LineRenderer::onSurfaceDestroyed() {
         _shader.reset();
+        _bufferCache.reset();
     }
     
     void LineRenderer::addElement(const std::shared_ptr<Line>& element) {
@@ -123,6 +154,7 @@ namespace carto {
         std::lock_guard<std::mutex> lock(_mutex);
         _elements.clear();
         _elements.swap(_tempElements);
+        _pickIndex.invalidate();
     }
         
     void LineRenderer::updateElement(const std::shared_ptr<Line>& element) {
@@ -132,17 +164,28 @@ namespace carto {
                 _elements.push_back(element);
             }
         }
+        _pickIndex.invalidate();
     }
         
     void LineRenderer::removeElement(const std::shared_ptr<Line>& element) {
         std::lock_guard<std::mutex> lock(_mutex);
         _elements.erase(std::remove(_elements.begin(), _elements.end(), element), _elements.end());
+        _pickIndex.invalidate();
     }
     
     void LineRenderer::calculateRayIntersectedElements(const std::shared_ptr<VectorLayer>& layer, const cglib::ray3<double>& ray, const ViewState& viewState, std::vector<RayIntersectedElement>& results) const {
         std::lock_guard<std::mutex> lock(_mutex);
+
+        // Test only the elements near the click position if the pick index of the last frame matches the view
+        std::vector<std::size_t> candidateIndices;
+        if (_pickIndex.query(ray, viewState, candidateIndices)) {
+            for (std::size_t index : candidateIndices) {
+                const std::shared_ptr<Line>& element = _elements[index];
+                FindElementRayIntersection(element, element->getDrawData(), layer, ray, viewState, results);
+            }
+            return;
+        }
     
-        std::vector<MapPos> worldCoords;
         for (const std::shared_ptr<Line>& element : _elements) {
             FindElementRayIntersection(element, element->getDrawData(), layer, ray, viewState, results);
         }
@@ -150,145 +193,204 @@ namespace carto {
         
     void LineRenderer::BuildAndDrawBuffers(GLuint a_color,
                                            GLuint a_coord,
+                                           GLuint a_coordLow,
                                            GLuint a_normal,
                                            GLuint a_texCoord,
+                                           GLuint u_texCoordYScale,
                                            std::vector<unsigned char>& colorBuf,
                                            std::vector<float>& coordBuf,
+                                           std::vector<float>& coordLowBuf,
                                            std::vector<float>& normalBuf,
                                            std::vector<float>& texCoordBuf,
-                                           std::vector<unsigned short>& indexBuf,
-                                           std::vector<const LineDrawData*>& drawDataBuffer,
+                                           std::vector<unsigned int>& indexBuf,
+                                           std::vector<std::shared_ptr<LineDrawData> >& drawDataBuffer,
+                                           VertexBufferCache& bufferCache,
                                            StyleTextureCache& styleCache,
                                            const ViewState& viewState)
     {
-        // Get bitmap
+        // Texture coordinates depend on the zoom level, scale them in the shader so that the buffers stay valid
         std::shared_ptr<Bitmap> bitmap = drawDataBuffer.front()->getBitmap();
-        
-        // Calculate buffer size
-        std::size_t totalCoordCount = 0;
-        std::size_t totalIndexCount = 0;
-        for (const LineDrawData* drawData : drawDataBuffer) {
-            for (std::size_t i = 0; i < drawData->getCoords().size(); i++) {
-                const std::vector<cglib::vec3<double>*>& coords = drawData->getCoords()[i];
-                const std::vector<unsigned int>& indices = drawData->getIndices()[i];
-                
-                totalCoordCount += coords.size();
-                totalIndexCount += indices.size();
+        glUniform1f(u_texCoordYScale, bitmap->getHeight() > 1 ? 1.0f / viewState.getUnitToDPCoef() : 1.0f);
+
+        // Split draw data vertex parts into chunks that fit into a single buffer
+        std::size_t maxBufferSize = GLContext::GetMaxVertexBufferSize();
+        std::size_t firstDrawData = 0;
+        std::size_t firstPart = 0;
+        std::size_t lastDrawData = 0;
+        std::size_t endPart = 0;
+        std::size_t chunkIndexCount = 0;
+        auto drawChunk = [&]() {
+            std::vector<std::shared_ptr<const void> > chunkDrawDatas(drawDataBuffer.begin() + firstDrawData, drawDataBuffer.begin() + lastDrawData + 1);
+            bool valid = false;
+            VertexBufferCache::Chunk& chunk = bufferCache.bindChunk(chunkDrawDatas, firstPart, endPart, valid);
+            if (!valid) {
+                BuildChunkBuffers(colorBuf, coordBuf, coordLowBuf, normalBuf, texCoordBuf, indexBuf, drawDataBuffer, firstDrawData, firstPart, lastDrawData, endPart, chunk);
+                bufferCache.uploadIndices(chunk, indexBuf);
+            }
+
+            // Buffer layout: coords, low parts of coords, normals, tex coords, colors
+            std::size_t vertexCount = chunk.vertexCount;
+            glVertexAttribPointer(a_coord, 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<const GLvoid*>(0));
+            glVertexAttribPointer(a_coordLow, 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<const GLvoid*>(vertexCount * 3 * sizeof(float)));
+            glVertexAttribPointer(a_normal, 4, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<const GLvoid*>(vertexCount * 6 * sizeof(float)));
+            glVertexAttribPointer(a_texCoord, 4, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<const GLvoid*>(vertexCount * 10 * sizeof(float)));
+            glVertexAttribPointer(a_color, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, reinterpret_cast<const GLvoid*>(vertexCount * 14 * sizeof(float)));
+            VertexBufferCache::DrawChunk(chunk);
+        };
+        for (std::size_t i = 0; i < drawDataBuffer.size(); i++) {
+            const LineDrawData* drawData = drawDataBuffer[i].get();
+            for (std::size_t j = 0; j < drawData->getIndices().size(); j++) {
+                std::size_t indexCount = drawData->getIndices()[j].size();
+                if (indexCount > maxBufferSize) {
+                    Log::Error("LineRenderer::BuildAndDrawBuffers: Maximum buffer size exceeded, line can't be drawn");
+                    continue;
+                }
+                if (chunkIndexCount > 0 && chunkIndexCount + indexCount > maxBufferSize) {
+                    // If it doesn't fit, draw the current chunk and start a new one
+                    drawChunk();
+                    chunkIndexCount = 0;
+                }
+                if (chunkIndexCount == 0) {
+                    firstDrawData = i;
+                    firstPart = j;
+                }
+                lastDrawData = i;
+                endPart = j + 1;
+                chunkIndexCount += indexCount;
             }
         }
         
-        // Resize the buffers, if necessary
-        if (coordBuf.size() < totalCoordCount * 3) {
-            colorBuf.resize(std::min(totalCoordCount * 4, GLContext::MAX_VERTEXBUFFER_SIZE * 4));
-            coordBuf.resize(std::min(totalCoordCount * 3, GLContext::MAX_VERTEXBUFFER_SIZE * 3));
-            normalBuf.resize(std::min(totalCoordCount * 4, GLContext::MAX_VERTEXBUFFER_SIZE * 4));
-            texCoordBuf.resize(std::min(totalCoordCount * 2, GLContext::MAX_VERTEXBUFFER_SIZE * 2));
-        }
-        
-        if (indexBuf.size() < totalIndexCount) {
-            indexBuf.resize(std::min(totalIndexCount, GLContext::MAX_VERTEXBUFFER_SIZE));
+        // Draw the final chunk
+        if (chunkIndexCount > 0) {
+            drawChunk();
         }
-        
-        // Calculate and draw buffers
-        cglib::vec3<double> cameraPos = viewState.getCameraPos();
-        std::size_t colorIndex = 0;
-        std::size_t coordIndex = 0;
-        std::size_t normalIndex = 0;
-        std::size_t texCoordIndex = 0;
-        std::size_t indexIndex = 0;
-        float texCoordYScale = (bitmap->getHeight() > 1 ? 1.0f / viewState.getUnitToDPCoef() : 1.0f);
-        for (const LineDrawData* drawData : drawDataBuffer) {
-            // Draw data vertex info may be split into multiple buffers, draw each one
-            for (std::size_t i = 0; i < drawData->getCoords().size(); i++) {
-                
-                // Check for possible overflow in the buffer
-                const std::vector<unsigned int>& indices = drawData->getIndices()[i];
-                if (indexIndex + indices.size() > GLContext::MAX_VERTEXBUFFER_SIZE) {
-                    // If it doesn't fit, stop and draw the buffers
-                    glVertexAttribPointer(a_color, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, colorBuf.data());
-                    glVertexAttribPointer(a_coord, 3, GL_FLOAT, GL_FALSE, 0, coordBuf.data());
-                    glVertexAttribPointer(a_normal, 4, GL_FLOAT, GL_FALSE, 0, normalBuf.data());
-                    glVertexAttribPointer(a_texCoord, 2, GL_FLOAT, GL_FALSE, 0, texCoordBuf.data());
-                    glDrawElements(GL_TRIANGLES, indexIndex, GL_UNSIGNED_SHORT, indexBuf.data());
-                    // Start filling buffers from the beginning
-                    colorIndex = 0;
-                    coordIndex = 0;
-                    normalIndex = 0;
-                    texCoordIndex = 0;
-                    indexIndex = 0;
+    }
+
+    void LineRenderer::BuildChunkBuffers(std::vector<unsigned char>& colorBuf,
+                                         std::vector<float>& coordBuf,
+                                         std::vector<float>& coordLowBuf,
+                                         std::vector<float>& normalBuf,
+                                         std::vector<float>& texCoordBuf,
+                                         std::vector<unsigned int>& indexBuf,
+                                         const std::vector<std::shared_ptr<LineDrawData> >& drawDataBuffer,
+                                         std::size_t firstDrawData,
+                                         std::size_t firstPart,
+                                         std::size_t lastDrawData,
+                                         std::size_t endPart,
+                                         VertexBufferCache::Chunk& chunk)
+    {
+        colorBuf.clear();
+        coordBuf.clear();
+        coordLowBuf.clear();
+        normalBuf.clear();
+        texCoordBuf.clear();
+        indexBuf.clear();
+
+        for (std::size_t i = firstDrawData; i <= lastDrawData; i++) {
+            const LineDrawData* drawData = drawDataBuffer[i].get();
+
+            // Color and normal scale. If subpixel width is requested, adjust normal scale and fade color
+            Color color = drawData->getColor();
+            float normalScale = drawData->getNormalScale();
+            if (normalScale < 0.5f) {
+                float c = normalScale / 0.5f;
+                color = Color(
+                    static_cast<unsigned char>(color.getR() * c),
+                    static_cast<unsigned char>(color.getG() * c),
+                    static_cast<unsigned char>(color.getB() * c),
+                    static_cast<unsigned char>(color.getA() * c)
+                );
+                normalScale = 0.5f;
+            }
+
+            std::size_t partBegin = (i == firstDrawData ? firstPart : 0);
+            std::size_t partEnd = (i == lastDrawData ? endPart : drawData->getCoords().size());
+            for (std::size_t j = partBegin; j < partEnd; j++) {
+                if (drawData->getIndices()[j].size() > GLContext::GetMaxVertexBufferSize()) {
+                    continue;
                 }
-                
+
                 // Indices
-                std::size_t indexOffset = coordIndex / 3;
-                std::vector<unsigned int>::const_iterator iit;
-                for (iit = indices.begin(); iit != indices.end(); ++iit) {
-                    indexBuf[indexIndex] = static_cast<unsigned short>(indexOffset + *iit);
-                    indexIndex++;
+                std::size_t indexOffset = coordBuf.size() / 3;
+                for (unsigned int index : drawData->getIndices()[j]) {
+                    indexBuf.push_back(static_cast<unsigned int>(indexOffset + index));
                 }
-                
-                // Coords, tex coords and colors
-                Color color = drawData->getColor();
-                float normalScale = drawData->getNormalScale();
 
-                // If subpixel width is requested, adjust normal scale and fade color
-                if (normalScale < 0.5f) {
-                    float c = normalScale / 0.5f;
-                    color = Color(
-                        static_cast<unsigned char>(color.getR() * c),
-                        static_cast<unsigned char>(color.getG() * c),
-                        static_cast<unsigned char>(color.getB() * c),
-                        static_cast<unsigned char>(color.getA() * c)
-                    );
-                    normalScale = 0.5f;
-                }
-                const std::vector<cglib::vec3<double>*>& coords = drawData->getCoords()[i];
-                const std::vector<cglib::vec4<float> >& normals = drawData->getNormals()[i];
-                const std::vector<cglib::vec2<float> >& texCoords = drawData->getTexCoords()[i];
+                const std::vector<cglib::vec3<double>*>& coords = drawData->getCoords()[j];
+                const std::vector<cglib::vec3<float> >& normals = drawData->getNormals()[j];
+                const std::vector<cglib::vec4<float> >& texCoords = drawData->getTexCoords()[j];
                 auto cit = coords.begin();
                 auto nit = normals.begin();
                 auto tit = texCoords.begin();
                 for ( ; cit != coords.end(); ++cit, ++nit, ++tit) {
                     // Colors
-                    colorBuf[colorIndex + 0] = color.getR();
-                    colorBuf[colorIndex + 1] = color.getG();
-                    colorBuf[colorIndex + 2] = color.getB();
-                    colorBuf[colorIndex + 3] = color.getA();
-                    colorIndex += 4;
+                    colorBuf.push_back(color.getR());
+                    colorBuf.push_back(color.getG());
+                    colorBuf.push_back(color.getB());
+                    colorBuf.push_back(color.getA());
 
-                    // Coords
+                    // Coords, split into high and low parts for relative-to-eye rendering in the shader
                     const cglib::vec3<double>& pos = **cit;
-                    coordBuf[coordIndex + 0] = static_cast<float>(pos(0) - cameraPos(0));
-                    coordBuf[coordIndex + 1] = static_cast<float>(pos(1) - cameraPos(1));
-                    coordBuf[coordIndex + 2] = static_cast<float>(pos(2) - cameraPos(2));
-                    coordIndex += 3;
+                    for (int k = 0; k < 3; k++) {
+                        float high = static_cast<float>(pos(k));
+                        coordBuf.push_back(high);
+                        coordLowBuf.push_back(static_cast<float>(pos(k) - high));
+                    }
 
-                    // Normals
-                    const cglib::vec4<float>& normal = *nit;
-                    normalBuf[normalIndex + 0] = normal(0) * normalScale;
-                    normalBuf[normalIndex + 1] = normal(1) * normalScale;
-                    normalBuf[normalIndex + 2] = normal(2) * normalScale;
-                    normalBuf[normalIndex + 3] = normal(3);
-                    normalIndex += 4;
+                    // Normals, the normal scale is also needed for vertices without offset
+                    const cglib::vec3<float>& normal = *nit;
+                    normalBuf.push_back(normal(0) * normalScale);
+                    normalBuf.push_back(normal(1) * normalScale);
+                    normalBuf.push_back(normal(2) * normalScale);
+                    normalBuf.push_back(normalScale);
                     
-                    // Tex coords
-                    const cglib::vec2<float>& texCoord = *tit;
-                    texCoordBuf[texCoordIndex + 0] = texCoord(0);
-                    texCoordBuf[texCoordIndex + 1] = texCoord(1) * texCoordYScale;
-                    texCoordIndex += 2;
+                    // Tex coords and distances
+                    const cglib::vec4<float>& texCoord = *tit;
+                    texCoordBuf.push_back(texCoord(0));
+                    texCoordBuf.push_back(texCoord(1));
+                    texCoordBuf.push_back(texCoord(2));
+                    texCoordBuf.push_back(texCoord(3));
                 }
             }
         }
-        
-        // Draw the final batch
-        if (indexIndex > 0) {
-            glVertexAttribPointer(a_color, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, colorBuf.data());
-            glVertexAttribPointer(a_coord, 3, GL_FLOAT, GL_FALSE, 0, coordBuf.data());
-            glVertexAttribPointer(a_normal, 4, GL_FLOAT, GL_FALSE, 0, normalBuf.data());
-            glVertexAttribPointer(a_texCoord, 2, GL_FLOAT, GL_FALSE, 0, texCoordBuf.data());
-            glDrawElements(GL_TRIANGLES, indexIndex, GL_UNSIGNED_SHORT, indexBuf.data());
-        }
+
+        // Upload the buffers, chunk buffers are already bound
+        std::size_t vertexCount = coordBuf.size() / 3;
+        glBufferData(GL_ARRAY_BUFFER, vertexCount * (14 * sizeof(float) + 4), nullptr, GL_STATIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, vertexCount * 3 * sizeof(float), coordBuf.data());
+        glBufferSubData(GL_ARRAY_BUFFER, vertexCount * 3 * sizeof(float), vertexCount * 3 * sizeof(float), coordLowBuf.data());
+        glBufferSubData(GL_ARRAY_BUFFER, vertexCount * 6 * sizeof(float), vertexCount * 4 * sizeof(float), normalBuf.data());
+        glBufferSubData(GL_ARRAY_BUFFER, vertexCount * 10 * sizeof(float), vertexCount * 4 * sizeof(float), texCoordBuf.data());
+        glBufferSubData(GL_ARRAY_BUFFER, vertexCount * 14 * sizeof(float), vertexCount * 4, colorBuf.data());
+
+        chunk.vertexCount = vertexCount;
     }
     
+    void LineRenderer::CalculateClickCoords(const LineDrawData& drawData, std::size_t part, const ViewState& viewState, std::vector<cglib::vec3<double> >& worldCoords) {
+        const std::vector<cglib::vec3<double>*>& coords = drawData.getCoords()[part];
+        const std::vector<cglib::vec3<float> >& normals = drawData.getNormals()[part];
+        worldCoords.clear();
+        worldCoords.reserve(coords.size());
+
+        // Offset the vertices by the click width instead of the line width
+        double scale = viewState.getUnitToDPCoef() * drawData.getClickScale();
+        auto cit = coords.begin();
+        auto nit = normals.begin();
+        for ( ; cit != coords.end() && nit != normals.end(); ++cit, ++nit) {
+            const cglib::vec3<double>& pos = **cit;
+            worldCoords.push_back(pos + cglib::vec3<double>::convert(*nit) * scale);
+        }
+    }
+
+    cglib::bbox3<double> LineRenderer::CalculatePickBounds(const LineDrawData& drawData, const ViewState& viewState) {
+        // Conservative bounds of the vertices used in click tests, see FindElementRayIntersection
+        cglib::bbox3<double> bounds = drawData.getBoundingBox();
+        double margin = drawData.getMaxNormalLength() * viewState.getUnitToDPCoef() * drawData.getClickScale();
+        bounds.min = bounds.min - cglib::vec3<double>(margin, margin, margin);
+        bounds.max = bounds.max + cglib::vec3<double>(margin, margin, margin);
+        return bounds;
+    }
+
     bool LineRenderer::FindElementRayIntersection(const std::shared_ptr<VectorElement>& element,
                                                   const std::shared_ptr<LineDrawData>& drawData,
                                                   const std::shared_ptr<VectorLayer>& layer,
@@ -299,22 +401,13 @@ namespace carto {
         std::vector<cglib::vec3<double> > worldCoords;
 
         for (std::size_t i = 0; i < drawData->getCoords().size(); i++) {
-            // Resize the buffer for calculated world coordinates
             const std::vector<cglib::vec3<double>*>& coords = drawData->getCoords()[i];
-            worldCoords.clear();
-            worldCoords.reserve(coords.size());
-            
+
             // Calculate world coordinates and bounding box
+            CalculateClickCoords(*drawData, i, viewState, worldCoords);
             cglib::bbox3<double> bounds = cglib::bbox3<double>::smallest();
-            const std::vector<cglib::vec4<float> >& normals = drawData->getNormals()[i];
-            auto cit = coords.begin();
-            auto nit = normals.begin();
-            for ( ; cit != coords.end() && nit != normals.end(); ++cit, ++nit) {
-                const cglib::vec3<double>& pos = **cit;
-                const cglib::vec4<float>& normal = *nit;
-                cglib::vec3<double> worldCoord = pos + cglib::vec3<double>(normal(0) * normal(3), normal(1) * normal(3), normal(2) * normal(3)) * static_cast<double>(viewState.getUnitToDPCoef() * drawData->getClickScale());
+            for (const cglib::vec3<double>& worldCoord : worldCoords) {
                 bounds.add(worldCoord);
-                worldCoords.push_back(worldCoord);
             }
             
             // Bounding box check
@@ -359,12 +452,19 @@ namespace carto {
         // Coords, texCoords, colors
         glEnableVertexAttribArray(_a_color);
         glEnableVertexAttribArray(_a_coord);
+        glEnableVertexAttribArray(_a_coordLow);
         glEnableVertexAttribArray(_a_normal);
         glEnableVertexAttribArray(_a_texCoord);
         // Scale, gamma
         glUniform1f(_u_gamma, 0.5f);
         glUniform1f(_u_dpToPX, viewState.getDPToPX());
         glUniform1f(_u_unitToDP, viewState.getUnitToDPCoef());
+        // Camera position, split into high and low parts
+        cglib::vec3<double> cameraPos = viewState.getCameraPos();
+        cglib::vec3<float> cameraPosHigh(static_cast<float>(cameraPos(0)), static_cast<float>(cameraPos(1)), static_cast<float>(cameraPos(2)));
+        cglib::vec3<float> cameraPosLow(static_cast<float>(cameraPos(0) - cameraPosHigh(0)), static_cast<float>(cameraPos(1) - cameraPosHigh(1)), static_cast<float>(cameraPos(2) - cameraPosHigh(2)));
+        glUniform3fv(_u_cameraPosHigh, 1, cameraPosHigh.data());
+        glUniform3fv(_u_cameraPosLow, 1, cameraPosLow.data());
         // Matrix
         const cglib::mat4x4<float>& mvpMat = viewState.getRTEModelviewProjectionMat();
         glUniformMatrix4fv(_u_mvpMat, 1, GL_FALSE, mvpMat.data());
@@ -376,6 +476,7 @@ namespace carto {
         // Disable bound arrays
         glDisableVertexAttribArray(_a_color);
         glDisableVertexAttribArray(_a_coord);
+        glDisableVertexAttribArray(_a_coordLow);
         glDisableVertexAttribArray(_a_normal);
         glDisableVertexAttribArray(_a_texCoord);
     }
@@ -391,27 +492,26 @@ namespace carto {
             drawBatch(styleCache, viewState);
         }
         
-        _lineDrawDataBuffer.push_back(drawData.get());
-        _drawDataBuffer.push_back(std::move(drawData));
+        _drawDataBuffer.push_back(drawData);
         _prevBitmap = bitmap;
     }
     
     void LineRenderer::drawBatch(StyleTextureCache& styleCache, const ViewState& viewState) {
-        if (_lineDrawDataBuffer.empty()) {
+        if (_drawDataBuffer.empty()) {
             return;
         }
 
         // Bind texture
-        const std::shared_ptr<Bitmap>& bitmap = _lineDrawDataBuffer.front()->getBitmap();
+        const std::shared_ptr<Bitmap>& bitmap = _drawDataBuffer.front()->getBitmap();
         std::shared_ptr<Texture> texture = styleCache.get(bitmap);
         if (!texture) {
             texture = styleCache.create(bitmap, true, true);
         }
         glBindTexture(GL_TEXTURE_2D, texture->getTexId());
         
-        BuildAndDrawBuffers(_a_color, _a_coord, _a_normal, _a_texCoord, _colorBuf, _coordBuf, _normalBuf,_texCoordBuf, _indexBuf, _lineDrawDataBuffer, styleCache, viewState);
+        BuildAndDrawBuffers(_a_color, _a_coord, _a_coordLow, _a_normal, _a_texCoord, _u_texCoordYScale, _colorBuf, _coordBuf, _coordLowBuf, _normalBuf, _texCoordBuf, _indexBuf, _drawDataBuffer, _bufferCache, styleCache, viewState);
+        VertexBufferCache::UnbindBuffers();
 
-        _lineDrawDataBuffer.clear();
         _drawDataBuffer.clear();
         _prevBitmap = nullptr;
     }
@@ -420,24 +520,29 @@ namespace carto {
     const std::string LineRenderer::LINE_VERTEX_SHADER = R"GLSL(
         #version 100
         attribute vec3 a_coord;
+        attribute vec3 a_coordLow;
         attribute vec4 a_normal;
-        attribute vec2 a_texCoord;
+        attribute vec4 a_texCoord;
         attribute vec4 a_color;
         uniform float u_gamma;
         uniform float u_dpToPX;
         uniform float u_unitToDP;
+        uniform float u_texCoordYScale;
+        uniform vec3 u_cameraPosHigh;
+        uniform vec3 u_cameraPosLow;
         uniform mat4 u_mvpMat;
         varying lowp vec4 v_color;
         varying vec2 v_texCoord;
-        varying float v_dist;
+        varying vec2 v_dist;
         varying float v_width;
         void main() {
-            float width = length(a_normal.xyz) * u_dpToPX;
+            float width = a_normal.w * u_dpToPX;
             float roundedWidth = width + 1.0;
-            vec3 pos = a_coord + u_unitToDP * roundedWidth / width * (a_normal.xyz * a_normal.w);
+            vec3 coord = (a_coord - u_cameraPosHigh) + (a_coordLow - u_cameraPosLow);
+            vec3 pos = coord + u_unitToDP * roundedWidth / width * a_normal.xyz;
             v_color = a_color;
-            v_texCoord = a_texCoord;
-            v_dist = a_normal.w * roundedWidth * u_gamma;
+            v_texCoord = vec2(a_texCoord.x, a_texCoord.y * u_texCoordYScale);
+            v_dist = a_texCoord.zw * roundedWidth * u_gamma;
             v_width = 1.0 + (width - 1.0) * u_gamma;
             gl_Position = u_mvpMat * vec4(pos, 1.0);
         }
@@ -450,15 +555,15 @@ namespace carto {
         varying lowp vec4 v_color;
         #ifdef GL_FRAGMENT_PRECISION_HIGH
         varying highp vec2 v_texCoord;
-        varying highp float v_dist;
+        varying highp vec2 v_dist;
         varying highp float v_width;
         #else
         varying mediump vec2 v_texCoord;
-        varying mediump float v_dist;
+        varying mediump vec2 v_dist;
         varying mediump float v_width;
         #endif
         void main() {
-            lowp float a = clamp(v_width - abs(v_dist), 0.0, 1.0);
+            lowp float a = clamp(v_width - length(v_dist), 0.0, 1.0);
             gl_FragColor = texture2D(u_tex, v_texCoord) * v_color * a;
         }
     )GLSL";
@@ -8,6 +8,8 @@
 #define _CARTO_LINERENDERER_H_
 
 #include "graphics/utils/GLContext.h"
+#include "renderers/components/ScreenPickIndex.h"
+#include "renderers/components/VertexBufferCache.h"
 
 #include <deque>
 #include <memory>
@@ -46,6 +48,8 @@ namespace carto {
         void removeElement(const std::shared_ptr<Line>& element);
     
         void calculateRayIntersectedElements(const std::shared_ptr<VectorLayer>& layer, const cglib::ray3<double>& ray, const ViewState& viewState, std::vector<RayIntersectedElement>& results) const;
+
+        static void CalculateClickCoords(const LineDrawData& drawData, std::size_t part, const ViewState& viewState, std::vector<cglib::vec3<double> >& worldCoords);
     
     protected:
         friend class PolygonRenderer;
@@ -54,17 +58,36 @@ namespace carto {
     private:
         static void BuildAndDrawBuffers(GLuint a_color,
                                         GLuint a_coord,
+                                        GLuint a_coordLow,
                                         GLuint a_normal,
                                         GLuint a_texCoord,
+                                        GLuint u_texCoordYScale,
                                         std::vector<unsigned char>& colorBuf,
                                         std::vector<float>& coordBuf,
+                                        std::vector<float>& coordLowBuf,
                                         std::vector<float>& normalBuf,
                                         std::vector<float>& texCoordBuf,
-                                        std::vector<unsigned short>& indexBuf,
-                                        std::vector<const LineDrawData*>& drawDataBuffer,
+                                        std::vector<unsigned int>& indexBuf,
+                                        std::vector<std::shared_ptr<LineDrawData> >& drawDataBuffer,
+                                        VertexBufferCache& bufferCache,
                                         StyleTextureCache& styleCache,
                                         const ViewState& viewState);
 
+        static void BuildChunkBuffers(std::vector<unsigned char>& colorBuf,
+                                      std::vector<float>& coordBuf,
+                                      std::vector<float>& coordLowBuf,
+                                      std::vector<float>& normalBuf,
+                                      std::vector<float>& texCoordBuf,
+                                      std::vector<unsigned int>& indexBuf,
+                                      const std::vector<std::shared_ptr<LineDrawData> >& drawDataBuffer,
+                                      std::size_t firstDrawData,
+                                      std::size_t firstPart,
+                                      std::size_t lastDrawData,
+                                      std::size_t endPart,
+                                      VertexBufferCache::Chunk& chunk);
+
+        static cglib::bbox3<double> CalculatePickBounds(const LineDrawData& drawData, const ViewState& viewState);
+
         static bool FindElementRayIntersection(const std::shared_ptr<VectorElement>& element,
                                                const std::shared_ptr<LineDrawData>& drawData,
                                                const std::shared_ptr<VectorLayer>& layer,
@@ -85,26 +108,34 @@ namespace carto {
         std::vector<std::shared_ptr<Line> > _elements;
         std::vector<std::shared_ptr<Line> > _tempElements;
         
-        std::vector<std::shared_ptr<LineDrawData> > _drawDataBuffer; // this buffer is used to keep objects alive
-        std::vector<const LineDrawData*> _lineDrawDataBuffer;
+        std::vector<std::shared_ptr<LineDrawData> > _drawDataBuffer;
         const Bitmap* _prevBitmap;
     
         std::vector<unsigned char> _colorBuf;
         std::vector<float> _coordBuf;
+        std::vector<float> _coordLowBuf;
         std::vector<float> _normalBuf;
         std::vector<float> _texCoordBuf;
-        std::vector<unsigned short> _indexBuf;
+        std::vector<unsigned int> _indexBuf;
     
         std::shared_ptr<Shader> _shader;
         GLuint _a_color;
         GLuint _a_coord;
+        GLuint _a_coordLow;
         GLuint _a_normal;
         GLuint _a_texCoord;
         GLuint _u_gamma;
         GLuint _u_dpToPX;
         GLuint _u_unitToDP;
+        GLuint _u_texCoordYScale;
+        GLuint _u_cameraPosHigh;
+        GLuint _u_cameraPosLow;
         GLuint _u_mvpMat;
         GLuint _u_tex;
+
+        VertexBufferCache _bufferCache;
+
+        ScreenPickIndex _pickIndex;
     
         mutable std::mutex _mutex;
     };
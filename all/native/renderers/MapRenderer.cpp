@@ -15,22 +15,36 @@
 #include "graphics/TextureManager.h"
 #include "graphics/utils/GLContext.h"
 #include "layers/Layer.h"
+#include "layers/RasterTileLayer.h"
+#include "layers/TorqueTileLayer.h"
+#include "layers/VectorTileLayer.h"
+#include "layers/VectorLayer.h"
 #include "projections/Projection.h"
 #include "projections/ProjectionSurface.h"
 #include "renderers/BillboardRenderer.h"
+#include "renderers/LineRenderer.h"
 #include "renderers/MapRendererListener.h"
 #include "renderers/RendererCaptureListener.h"
 #include "renderers/RedrawRequestListener.h"
+#include "renderers/components/FrameStatistics.h"
 #include "renderers/components/RayIntersectedElement.h"
+#include "renderers/drawdatas/LineDrawData.h"
+#include "renderers/drawdatas/PolygonDrawData.h"
+#include "renderers/drawdatas/Polygon3DDrawData.h"
 #include "renderers/cameraevents/CameraPanEvent.h"
 #include "renderers/cameraevents/CameraRotationEvent.h"
 #include "renderers/cameraevents/CameraTiltEvent.h"
 #include "renderers/cameraevents/CameraZoomEvent.h"
 #include "renderers/workers/BillboardPlacementWorker.h"
 #include "renderers/workers/CullWorker.h"
+#include "renderers/workers/RedrawWorker.h"
 #include "utils/Const.h"
 #include "utils/Log.h"
 #include "utils/ThreadUtils.h"
+#include "utils/Tracer.h"
+#include "vectorelements/Line.h"
+#include "vectorelements/Polygon.h"
+#include "vectorelements/Polygon3D.h"
 
 #include <algorithm>
 
@@ -39,6 +53,8 @@ namespace carto {
     MapRenderer::MapRenderer(const std::shared_ptr<Layers>& layers, const std::shared_ptr<Options>& options) :
         _lastFrameTime(),
         _viewState(),
+        _viewStateVersion(0),
+        _viewStateSnapshot(),
         _frameBufferManager(),
         _shaderManager(),
         _textureManager(),
@@ -49,12 +65,22 @@ namespace carto {
         _currentBoundFBOs(),
         _screenFrameBuffer(),
         _screenBlendShader(),
+        _layerCacheFrameBuffer(),
+        _layerCacheStamps(),
+        _lastFrameMVPMat(cglib::mat4x4<double>::identity()),
+        _layerCacheValid(false),
         _backgroundRenderer(*options, *layers),
         _watermarkRenderer(*options),
+        _pickBufferRenderer(),
+        _frameProfiler(),
+        _frameStatisticsEnabled(false),
+        _frameProfilerActive(false),
         _billboardSorter(),
         _billboardDrawDataBuffer(),
         _billboardPlacementWorker(std::make_shared<BillboardPlacementWorker>()),
         _billboardPlacementThread(),
+        _redrawWorker(std::make_shared<RedrawWorker>()),
+        _redrawThread(),
         _animationHandler(*this),
         _kineticEventHandler(*this, *options),
         _layers(layers),
@@ -62,8 +88,13 @@ namespace carto {
         _surfaceCreated(false),
         _surfaceChanged(false),
         _billboardsChanged(false),
+        _billboardViewChanged(false),
         _renderProjectionChanged(false),
         _redrawPending(false),
+        _layerCacheInvalidated(false),
+        _frameStartTime(0),
+        _creationTime(std::chrono::steady_clock::now()),
+        _timeToFirstFrame(-1.0f),
         _redrawRequestListener(),
         _mapRendererListener(),
         _rendererCaptureListeners(),
@@ -85,6 +116,9 @@ namespace carto {
 
         _billboardPlacementWorker->setComponents(shared_from_this(), _billboardPlacementWorker);
         _billboardPlacementThread = std::thread(std::ref(*_billboardPlacementWorker));
+
+        _redrawWorker->setComponents(shared_from_this(), _redrawWorker);
+        _redrawThread = std::thread(std::ref(*_redrawWorker));
         
         _optionsListener = std::make_shared<OptionsListener>(shared_from_this());
         _options->registerOnChangeListener(_optionsListener);
@@ -99,6 +133,9 @@ namespace carto {
         
         _billboardPlacementWorker->stop();
         _billboardPlacementThread.detach();
+
+        _redrawWorker->stop();
+        _redrawThread.detach();
     }
         
     std::shared_ptr<RedrawRequestListener> MapRenderer::getRedrawRequestListener() const {
@@ -137,7 +174,22 @@ namespace carto {
         DirectorPtr<RedrawRequestListener> redrawRequestListener = _redrawRequestListener;
 
         if (redrawRequestListener) {
-            _redrawPending = true;
+            // Merge the requests until the next frame is drawn, the listener needs to be called only once
+            if (_redrawPending.exchange(true)) {
+                return;
+            }
+
+            // If the frame rate is limited, delay the request until the frame interval has passed
+            int maxFPS = _options->getMaxFPS();
+            if (maxFPS > 0) {
+                long long currentTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+                long long delayTime = _frameStartTime.load() + 1000000LL / maxFPS - currentTime;
+                if (delayTime >= 1000) {
+                    _redrawWorker->init(static_cast<int>(delayTime / 1000));
+                    return;
+                }
+            }
+
             redrawRequestListener->onRedrawRequested();
         }
     }
@@ -154,6 +206,26 @@ namespace carto {
         requestRedraw();
     }
 
+    bool MapRenderer::isFrameStatisticsEnabled() const {
+        return _frameStatisticsEnabled;
+    }
+
+    void MapRenderer::setFrameStatisticsEnabled(bool enabled) {
+        _frameStatisticsEnabled = enabled;
+        requestRedraw();
+    }
+
+    std::shared_ptr<FrameStatistics> MapRenderer::getAverageFrameStatistics() const {
+        if (!_frameStatisticsEnabled) {
+            return std::shared_ptr<FrameStatistics>();
+        }
+        return _frameProfiler.getAverageStatistics();
+    }
+
+    float MapRenderer::getTimeToFirstFrame() const {
+        return _timeToFirstFrame;
+    }
+
     std::vector<std::shared_ptr<BillboardDrawData> > MapRenderer::getBillboardDrawDatas() const {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
         return _billboardSorter.getSortedBillboardDrawDatas();
@@ -312,6 +384,58 @@ namespace carto {
         }
     }
     
+    bool MapRenderer::calculatePredictedViewState(ViewState& viewState) const {
+        // The view state is copied first, the animation handlers must not be locked while holding the renderer lock
+        viewState = *getCurrentViewStateSnapshot();
+
+        MapPos panTarget;
+        bool pan = _animationHandler.getPanTarget(panTarget) || _kineticEventHandler.calculatePanTarget(viewState, panTarget);
+        float zoomTarget = viewState.getZoom();
+        MapPos zoomTargetPos;
+        bool useZoomTargetPos = false;
+        bool zoom = _animationHandler.getZoomTarget(zoomTarget, zoomTargetPos, useZoomTargetPos);
+        if (!zoom && _kineticEventHandler.calculateZoomTarget(viewState, zoomTarget, zoomTargetPos)) {
+            zoom = true;
+            useZoomTargetPos = true;
+        }
+        if (!pan && !zoom) {
+            return false;
+        }
+
+        if (pan) {
+            CameraPanEvent cameraEvent;
+            cameraEvent.setPos(panTarget);
+            cameraEvent.calculate(*_options, viewState);
+        }
+        if (zoom) {
+            CameraZoomEvent cameraEvent;
+            cameraEvent.setZoom(zoomTarget);
+            if (useZoomTargetPos) {
+                cameraEvent.setTargetPos(zoomTargetPos);
+            }
+            cameraEvent.calculate(*_options, viewState);
+        }
+        viewState.calculateViewState(*_options);
+        return true;
+    }
+
+    std::shared_ptr<const ViewState> MapRenderer::getViewStateSnapshot() const {
+        std::shared_ptr<const ViewStateSnapshot> snapshot = std::atomic_load(&_viewStateSnapshot);
+        if (!snapshot) {
+            return std::make_shared<ViewState>(getViewState());
+        }
+        return std::shared_ptr<const ViewState>(snapshot, &snapshot->viewState);
+    }
+
+    std::shared_ptr<const ViewState> MapRenderer::getCurrentViewStateSnapshot() const {
+        // The snapshot of the last frame can be used if the view has not changed since, otherwise the view state must be calculated
+        std::shared_ptr<const ViewStateSnapshot> snapshot = std::atomic_load(&_viewStateSnapshot);
+        if (!snapshot || snapshot->version != _viewStateVersion.load()) {
+            return std::make_shared<ViewState>(getViewState());
+        }
+        return std::shared_ptr<const ViewState>(snapshot, &snapshot->viewState);
+    }
+
     void MapRenderer::moveToFitBounds(const MapBounds& mapBounds, const ScreenBounds& screenBounds, bool integerZoom, bool resetTilt, bool resetRotation, float durationSeconds) {
         CameraPanEvent cameraPanEvent;
         CameraRotationEvent cameraRotationEvent;
@@ -458,6 +582,7 @@ namespace carto {
     
     void MapRenderer::onSurfaceCreated() {
         ThreadUtils::SetThreadPriority(ThreadPriority::MAXIMUM);
+        ThreadUtils::SetThreadQoSClass(ThreadQoSClass::USER_INTERACTIVE);
         
         GLContext::LoadExtensions();
     
@@ -479,6 +604,7 @@ namespace carto {
         }
         _shaderManager = std::make_shared<ShaderManager>();
         _shaderManager->setGLThreadId(std::this_thread::get_id());
+        _shaderManager->setProgramCachePath(_options->getShaderCachePath());
 
         // Reset texture manager
         if (_textureManager) {
@@ -494,6 +620,12 @@ namespace carto {
         _currentBoundFBOs.clear();
         _screenFrameBuffer.reset();
         _screenBlendShader.reset();
+        _layerCacheFrameBuffer.reset();
+        _layerCacheValid = false;
+
+        // Reset frame profiler, timer queries of the previous context are invalid
+        _frameProfiler.reset();
+        _frameProfilerActive = false;
 
         // Drop all thread callbacks, as context is invalidated
         {
@@ -504,6 +636,7 @@ namespace carto {
         // Notify renderers about the event
         _backgroundRenderer.onSurfaceCreated(_shaderManager, _textureManager);
         _watermarkRenderer.onSurfaceCreated(_shaderManager, _textureManager);
+        _pickBufferRenderer.onSurfaceCreated(_shaderManager, _frameBufferManager);
     
         for (const std::shared_ptr<Layer>& layer : _layers->getAll()) {
             layer->onSurfaceCreated(_shaderManager, _textureManager);
@@ -519,11 +652,16 @@ namespace carto {
         _viewState.clampZoom(*_options);
         _viewState.clampFocusPos(*_options);
         _screenFrameBuffer.reset(); // reset, as this depends on the surface dimensions
+        _layerCacheFrameBuffer.reset();
+        _layerCacheValid = false;
         _surfaceChanged = true;
     }
     
     void MapRenderer::onDrawFrame() {
+        Tracer::Span span("MapRenderer::onDrawFrame");
+
         _redrawPending = false;
+        _frameStartTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
 
         std::vector<std::shared_ptr<OnChangeListener> > onChangeListeners;
         {
@@ -542,6 +680,9 @@ namespace carto {
         _frameBufferManager->processFrameBuffers();
         _shaderManager->processShaders();
         _textureManager->processTextures();
+        if (_textureManager->hasPendingTextures()) {
+            requestRedraw(); // continue uploading the remaining textures in the next frame
+        }
 
         {
             std::lock_guard<std::recursive_mutex> lock(_mutex);
@@ -568,15 +709,23 @@ namespace carto {
         if (mapRendererListener) {
             mapRendererListener->onBeforeDrawFrame();
         }
+
+        // Apply coalesced input events, so that the camera is updated once per frame
+        for (const std::shared_ptr<OnChangeListener>& onChangeListener : onChangeListeners) {
+            onChangeListener->onBeforeDrawFrame();
+        }
         
         // Calculate camera params and make a synchronized copy of the view state
         ViewState viewState;
+        unsigned int viewStateVersion = 0;
         {
             std::lock_guard<std::recursive_mutex> lock(_mutex);
             _viewState.calculateViewState(*_options);
             viewState = _viewState;
+            viewStateVersion = _viewStateVersion.load();
             _viewState.setHorizontalLayerOffsetDir(0);
         }
+        publishViewStateSnapshot(viewState, viewStateVersion);
 
         // Don't delay calling the cull task, the view state was already updated
         if (_surfaceChanged.exchange(false)) {
@@ -588,23 +737,52 @@ namespace carto {
         _kineticEventHandler.calculate(viewState, deltaSeconds);
 
         initializeRenderState();
+
+        // Start collecting frame statistics, or release the profiler resources if statistics were disabled
+        bool frameStatisticsEnabled = _frameStatisticsEnabled;
+        if (frameStatisticsEnabled) {
+            _frameProfiler.beginFrame();
+        } else if (_frameProfilerActive) {
+            _frameProfiler.release();
+        }
+        _frameProfilerActive = frameStatisticsEnabled;
     
-        _backgroundRenderer.onDrawFrame(viewState);
         drawLayers(deltaSeconds, viewState);
         _watermarkRenderer.onDrawFrame(viewState);
+
+        if (frameStatisticsEnabled) {
+            _frameProfiler.endFrame();
+        }
     
         // Callback for synchronized rendering
         if (mapRendererListener) {
             mapRendererListener->onAfterDrawFrame();
+
+            for (const std::shared_ptr<FrameStatistics>& frameStatistics : _frameProfiler.takeCompletedFrames()) {
+                mapRendererListener->onFrameStatistics(frameStatistics);
+            }
+        } else {
+            _frameProfiler.takeCompletedFrames();
         }
 
         // Update billboard placements/visibility
-        if (_billboardsChanged.exchange(false)) {
-            _billboardPlacementWorker->init(BILLBOARD_PLACEMENT_TASK_DELAY);
+        bool contentChanged = _billboardsChanged.exchange(false);
+        if (_billboardViewChanged.exchange(false) || contentChanged) {
+            _billboardPlacementWorker->init(BILLBOARD_PLACEMENT_TASK_DELAY, contentChanged);
         }
         
         handleRenderThreadCallbacks();
         handleRendererCaptureCallbacks();
+
+        // Report the time to the first frame with all the layers loaded
+        if (_timeToFirstFrame < 0 && !isUpdateInProgress()) {
+            float timeToFirstFrame = std::chrono::duration_cast<std::chrono::duration<float> >(std::chrono::steady_clock::now() - _creationTime).count();
+            _timeToFirstFrame = timeToFirstFrame;
+            Log::Infof("MapRenderer::onDrawFrame: Time to first complete frame: %.3fs", timeToFirstFrame);
+            if (mapRendererListener) {
+                mapRendererListener->onFirstFrameCompleted(timeToFirstFrame);
+            }
+        }
         
         // Call listener to inform we are idle now, if no redraw request is pending
         if (!_redrawPending) {
@@ -645,6 +823,12 @@ namespace carto {
         _currentBoundFBOs.clear();
         _screenFrameBuffer.reset();
         _screenBlendShader.reset();
+        _layerCacheFrameBuffer.reset();
+        _layerCacheValid = false;
+
+        // Reset frame profiler
+        _frameProfiler.reset();
+        _frameProfilerActive = false;
 
         // Clean up all opengl resources
         for (const std::shared_ptr<Layer>& layer : _layers->getAll()) {
@@ -652,6 +836,7 @@ namespace carto {
         }
         
         _watermarkRenderer.onSurfaceDestroyed();
+        _pickBufferRenderer.onSurfaceDestroyed();
         _backgroundRenderer.onSurfaceDestroyed();
 
         // Drop all thread callbacks, as context is invalidated
@@ -740,6 +925,7 @@ namespace carto {
         glUniform2f(_screenBlendShader->getUniformLoc("u_invScreenSize"), 1.0f / _viewState.getWidth(), 1.0f / _viewState.getHeight());
         
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        GLContext::CountDrawCall(4);
         
         glBindTexture(GL_TEXTURE_2D, 0);
         
@@ -752,11 +938,7 @@ namespace carto {
         glDepthMask(enable ? GL_TRUE : GL_FALSE);
     }
 
-    void MapRenderer::calculateRayIntersectedElements(const MapPos& targetPos, ViewState& viewState, std::vector<RayIntersectedElement>& results) {
-        {
-            std::lock_guard<std::recursive_mutex> lock(_mutex);
-            viewState = _viewState;
-        }
+    void MapRenderer::calculateRayIntersectedElements(const MapPos& targetPos, const ViewState& viewState, std::vector<RayIntersectedElement>& results) {
         if (!viewState.getProjectionSurface()) {
             return;
         }
@@ -769,6 +951,11 @@ namespace carto {
         for (const std::shared_ptr<Layer>& layer : _layers->getAll()) {
             layer->calculateRayIntersectedElements(ray, viewState, results);
         }
+
+        // Resolve the occlusion of the hit lines and polygons using the pick buffer, if enabled
+        if (_options->isGPUPicking()) {
+            filterPickedElements(target, viewState, results);
+        }
     }
      
     void MapRenderer::billboardsChanged() {
@@ -790,12 +977,17 @@ namespace carto {
     }
     
     void MapRenderer::viewChanged(bool delay) {
+        // Mark the published view state snapshot as stale, the view state is always modified before this call
+        _viewStateVersion++;
+
         for (const std::shared_ptr<Layer>& layer : _layers->getAll()) {
             int delayTime = layer->getCullDelay();
             _cullWorker->init(layer, delay ? delayTime : 0);
         }
     
-        billboardsChanged();
+        // Only the view has changed, billboard placement can be reused if the billboards are just panned
+        _billboardViewChanged = true;
+        _layerCacheInvalidated = true;
     
         std::vector<std::shared_ptr<OnChangeListener> > onChangeListeners;
         {
@@ -823,7 +1015,35 @@ namespace carto {
         std::lock_guard<std::mutex> lock(_renderThreadCallbacksMutex);
         _renderThreadCallbacks.push_back(callback);
     }
+
+    void MapRenderer::notifyRedrawRequested() const {
+        DirectorPtr<RedrawRequestListener> redrawRequestListener = _redrawRequestListener;
+
+        // Skip the delayed request if a frame was drawn meanwhile
+        if (redrawRequestListener && _redrawPending) {
+            redrawRequestListener->onRedrawRequested();
+        }
+    }
+
+    void MapRenderer::clearStyleTextureCache() {
+        // The style cache is owned by the render thread, clear it from there
+        addRenderThreadCallback(std::make_shared<StyleTextureCacheCleaner>(shared_from_this()));
+        requestRedraw();
+    }
     
+    void MapRenderer::publishViewStateSnapshot(const ViewState& viewState, unsigned int version) {
+        // Publish a new immutable snapshot only when the view has changed, so that workers can share it without copying or locking
+        std::shared_ptr<const ViewStateSnapshot> prevSnapshot = std::atomic_load(&_viewStateSnapshot);
+        if (prevSnapshot && prevSnapshot->version == version && prevSnapshot->viewState.getHorizontalLayerOffsetDir() == viewState.getHorizontalLayerOffsetDir()) {
+            return;
+        }
+
+        auto snapshot = std::make_shared<ViewStateSnapshot>();
+        snapshot->viewState = viewState;
+        snapshot->version = version;
+        std::atomic_store(&_viewStateSnapshot, std::shared_ptr<const ViewStateSnapshot>(snapshot));
+    }
+
     void MapRenderer::initializeRenderState() const {
         // Enable backface culling
         glEnable(GL_CULL_FACE);
@@ -866,8 +1086,31 @@ namespace carto {
             // Clear billboard before sorting
             _billboardSorter.clear();
 
+            // Find the static bottom layers that can be drawn from the layer cache
+            std::size_t cachedLayerCount = calculateStaticLayerCount(layers);
+            if (_layerCacheInvalidated.exchange(false) || viewState.getHorizontalLayerOffsetDir() != 0 || resetSurfaces) {
+                _layerCacheValid = false;
+            }
+            bool useLayerCache = cachedLayerCount > 0 && isLayerCacheValid(layers, cachedLayerCount, viewState);
+            if (!useLayerCache) {
+                _layerCacheValid = false;
+            }
+            bool updateLayerCache = cachedLayerCount > 0 && !useLayerCache && viewState.getModelviewProjectionMat() == _lastFrameMVPMat;
+            _lastFrameMVPMat = viewState.getModelviewProjectionMat();
+            bool layerCacheNeedRedraw = false;
+            GLint prevBoundFBO = 0;
+            if (useLayerCache) {
+                drawLayerCache();
+            } else {
+                if (updateLayerCache) {
+                    bindLayerCacheFBO(prevBoundFBO);
+                }
+                _backgroundRenderer.onDrawFrame(viewState);
+            }
+
             // Do base drawing pass
-            for (const std::shared_ptr<Layer>& layer : layers) {
+            for (std::size_t i = 0; i < layers.size(); i++) {
+                const std::shared_ptr<Layer>& layer = layers[i];
                 if (viewState.getHorizontalLayerOffsetDir() != 0) {
                     layer->offsetLayerHorizontally(viewState.getHorizontalLayerOffsetDir() * Const::WORLD_SIZE);
                 }
@@ -880,13 +1123,50 @@ namespace carto {
                     layer->onSurfaceCreated(_shaderManager, _textureManager);
                     layerChanged(layer, false);
                 }
+
+                if (useLayerCache && i < cachedLayerCount) {
+                    continue;
+                }
     
-                needRedraw = layer->onDrawFrame(deltaSeconds, _billboardSorter, *_styleCache, viewState) || needRedraw;
+                if (_frameProfilerActive) {
+                    _frameProfiler.beginLayer(layer);
+                }
+                bool layerNeedRedraw = layer->onDrawFrame(deltaSeconds, _billboardSorter, *_styleCache, viewState);
+                needRedraw = layerNeedRedraw || needRedraw;
+                if (_frameProfilerActive) {
+                    _frameProfiler.endLayer();
+                }
+
+                // Store the cached layers and composite them to the screen once all of them are drawn
+                if (updateLayerCache && i < cachedLayerCount) {
+                    layerCacheNeedRedraw = layerNeedRedraw || layerCacheNeedRedraw;
+                    if (i + 1 == cachedLayerCount) {
+                        _layerCacheStamps.clear();
+                        for (std::size_t j = 0; j < cachedLayerCount; j++) {
+                            _layerCacheStamps.emplace_back(layers[j], layers[j]->getRedrawStamp());
+                        }
+                        _layerCacheValid = !layerCacheNeedRedraw;
+
+                        glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(prevBoundFBO));
+                        drawLayerCache();
+                    }
+                }
             }
             
-            // Do 3D drawing pass
-            for (const std::shared_ptr<Layer>& layer : layers) {
+            // Do 3D drawing pass. The cached layers finish their frames in this pass, so it is skipped together with the base pass
+            for (std::size_t i = 0; i < layers.size(); i++) {
+                const std::shared_ptr<Layer>& layer = layers[i];
+                if (useLayerCache && i < cachedLayerCount) {
+                    continue;
+                }
+
+                if (_frameProfilerActive) {
+                    _frameProfiler.beginLayer(layer);
+                }
                 needRedraw = layer->onDrawFrame3D(deltaSeconds, _billboardSorter, *_styleCache, viewState) || needRedraw;
+                if (_frameProfilerActive) {
+                    _frameProfiler.endLayer();
+                }
             }
             
             // Sort billboards, calculate rotation state
@@ -902,7 +1182,7 @@ namespace carto {
             for (const std::shared_ptr<BillboardDrawData>& drawData : _billboardSorter.getSortedBillboardDrawDatas()) {
                 if (std::shared_ptr<BillboardRenderer> renderer = drawData->getRenderer().lock()) {
                     if (prevRenderer && prevRenderer != renderer) {
-                        prevRenderer->onDrawFrameSorted(deltaSeconds, _billboardDrawDataBuffer, *_styleCache, viewState);
+                        drawBillboards(deltaSeconds, prevRenderer, viewState);
                         _billboardDrawDataBuffer.clear();
                     }
             
@@ -911,7 +1191,7 @@ namespace carto {
                 }
             }
             if (prevRenderer) {
-                prevRenderer->onDrawFrameSorted(deltaSeconds, _billboardDrawDataBuffer, *_styleCache, viewState);
+                drawBillboards(deltaSeconds, prevRenderer, viewState);
             }
 
             glEnable(GL_DEPTH_TEST);
@@ -923,6 +1203,193 @@ namespace carto {
         }
     }
     
+    void MapRenderer::drawBillboards(float deltaSeconds, const std::shared_ptr<BillboardRenderer>& renderer, const ViewState& viewState) {
+        std::shared_ptr<Layer> layer = renderer->getLayer();
+        if (_frameProfilerActive && layer) {
+            _frameProfiler.beginLayer(layer);
+        }
+        renderer->onDrawFrameSorted(deltaSeconds, _billboardDrawDataBuffer, *_styleCache, viewState);
+        if (_frameProfilerActive && layer) {
+            _frameProfiler.endLayer();
+        }
+    }
+
+    std::size_t MapRenderer::calculateStaticLayerCount(const std::vector<std::shared_ptr<Layer> >& layers) const {
+        if (!_options->isStaticLayerCaching()) {
+            return 0;
+        }
+
+        // Only the bottom tile layers drawing all their content in the base pass can be cached as a single image.
+        // Animated layers are excluded, as they would invalidate the cache in every frame
+        std::size_t layerCount = 0;
+        for (; layerCount < layers.size(); layerCount++) {
+            const std::shared_ptr<Layer>& layer = layers[layerCount];
+            if (std::dynamic_pointer_cast<RasterTileLayer>(layer)) {
+                continue;
+            }
+            if (auto vectorTileLayer = std::dynamic_pointer_cast<VectorTileLayer>(layer)) {
+                if (!std::dynamic_pointer_cast<TorqueTileLayer>(layer) && vectorTileLayer->getLabelRenderOrder() != VectorTileRenderOrder::VECTOR_TILE_RENDER_ORDER_LAST && vectorTileLayer->getBuildingRenderOrder() != VectorTileRenderOrder::VECTOR_TILE_RENDER_ORDER_LAST) {
+                    continue;
+                }
+            }
+            break;
+        }
+        return layerCount;
+    }
+
+    bool MapRenderer::isLayerCacheValid(const std::vector<std::shared_ptr<Layer> >& layers, std::size_t layerCount, const ViewState& viewState) const {
+        if (!_layerCacheValid || !_layerCacheFrameBuffer || _layerCacheStamps.size() != layerCount) {
+            return false;
+        }
+        if (viewState.getModelviewProjectionMat() != _lastFrameMVPMat) {
+            return false;
+        }
+        for (std::size_t i = 0; i < layerCount; i++) {
+            if (_layerCacheStamps[i].first.lock() != layers[i] || _layerCacheStamps[i].second != layers[i]->getRedrawStamp()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void MapRenderer::bindLayerCacheFBO(GLint& prevBoundFBO) {
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevBoundFBO);
+
+        if (!_layerCacheFrameBuffer) {
+            _layerCacheFrameBuffer = _frameBufferManager->createFrameBuffer(_viewState.getWidth(), _viewState.getHeight(), true, true, true);
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, _layerCacheFrameBuffer->getFBOId());
+
+        // Use the same initial state as the screen buffer
+        glDepthMask(GL_TRUE);
+        glStencilMask(255);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+        glDepthMask(GL_FALSE);
+        glStencilMask(0);
+
+        GLContext::CheckGLError("MapRenderer::bindLayerCacheFBO");
+    }
+
+    void MapRenderer::drawLayerCache() {
+        static const GLfloat screenVertices[8] = { -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+
+        if (!_layerCacheFrameBuffer) {
+            return;
+        }
+
+        if (!_screenBlendShader) {
+            static const ShaderSource shaderSource("blend", &BLEND_VERTEX_SHADER, &BLEND_FRAGMENT_SHADER);
+            
+            _screenBlendShader = _shaderManager->createShader(shaderSource);
+        }
+
+        // The cached image contains the background, so it replaces the screen contents
+        glDisable(GL_BLEND);
+
+        glUseProgram(_screenBlendShader->getProgId());
+
+        glVertexAttribPointer(_screenBlendShader->getAttribLoc("a_coord"), 2, GL_FLOAT, GL_FALSE, 0, screenVertices);
+        glEnableVertexAttribArray(_screenBlendShader->getAttribLoc("a_coord"));
+        
+        cglib::mat4x4<float> mvpMatrix = cglib::mat4x4<float>::identity();
+        glUniformMatrix4fv(_screenBlendShader->getUniformLoc("u_mvpMat"), 1, GL_FALSE, mvpMatrix.data());
+        
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, _layerCacheFrameBuffer->getColorTexId());
+        glUniform1i(_screenBlendShader->getUniformLoc("u_tex"), 0);
+        glUniform4f(_screenBlendShader->getUniformLoc("u_color"), 1.0f, 1.0f, 1.0f, 1.0f);
+        glUniform2f(_screenBlendShader->getUniformLoc("u_invScreenSize"), 1.0f / _viewState.getWidth(), 1.0f / _viewState.getHeight());
+        
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        GLContext::CountDrawCall(4);
+        
+        glBindTexture(GL_TEXTURE_2D, 0);
+        
+        glDisableVertexAttribArray(_screenBlendShader->getAttribLoc("a_coord"));
+
+        glEnable(GL_BLEND);
+
+        GLContext::CheckGLError("MapRenderer::drawLayerCache");
+    }
+    
+    void MapRenderer::filterPickedElements(const cglib::vec3<double>& targetPos, const ViewState& viewState, std::vector<RayIntersectedElement>& results) {
+        // The pick buffer is rendered in the rendering thread, the click thread waits for the result with a timeout
+        if (!_surfaceCreated) {
+            return;
+        }
+
+        std::vector<std::size_t> resultIndices;
+        std::vector<std::shared_ptr<VectorElement> > elements;
+        for (std::size_t i = 0; i < results.size(); i++) {
+            std::shared_ptr<VectorElement> element = results[i].getElement<VectorElement>();
+            if (std::dynamic_pointer_cast<Line>(element) || std::dynamic_pointer_cast<Polygon>(element) || std::dynamic_pointer_cast<Polygon3D>(element)) {
+                resultIndices.push_back(i);
+                elements.push_back(element);
+            }
+        }
+        if (elements.empty()) {
+            return;
+        }
+
+        auto task = std::make_shared<PickBufferTask>(shared_from_this(), viewState, targetPos, elements);
+        addRenderThreadCallback(task);
+        requestRedraw();
+        unsigned int pickedId = 0;
+        if (!task->waitForResult(PICK_BUFFER_TIMEOUT, pickedId)) {
+            Log::Warn("MapRenderer::filterPickedElements: Pick buffer not rendered, using ray intersection results");
+            return;
+        }
+
+        // Of the rendered elements, keep only the element visible at the click position. Other results are kept as is
+        std::vector<RayIntersectedElement> pickedResults;
+        pickedResults.reserve(results.size());
+        std::size_t elementIndex = 0;
+        for (std::size_t i = 0; i < results.size(); i++) {
+            if (elementIndex < resultIndices.size() && resultIndices[elementIndex] == i) {
+                elementIndex++;
+                if (pickedId != elementIndex) {
+                    continue;
+                }
+            }
+            pickedResults.push_back(results[i]);
+        }
+        std::swap(results, pickedResults);
+    }
+
+    bool MapRenderer::drawPickBuffer(const ViewState& viewState, const cglib::vec3<double>& targetPos, const std::vector<std::shared_ptr<VectorElement> >& elements, unsigned int& pickedId) {
+        if (!_pickBufferRenderer.begin(viewState, targetPos)) {
+            return false;
+        }
+
+        // Element IDs are their indices + 1, 0 is reserved for the background
+        std::vector<cglib::vec3<double> > worldCoords;
+        for (std::size_t i = 0; i < elements.size(); i++) {
+            unsigned int id = static_cast<unsigned int>(i + 1);
+            if (auto line = std::dynamic_pointer_cast<Line>(elements[i])) {
+                if (std::shared_ptr<LineDrawData> drawData = line->getDrawData()) {
+                    for (std::size_t j = 0; j < drawData->getCoords().size(); j++) {
+                        LineRenderer::CalculateClickCoords(*drawData, j, viewState, worldCoords);
+                        _pickBufferRenderer.drawTriangles(id, worldCoords, drawData->getIndices()[j]);
+                    }
+                }
+            } else if (auto polygon = std::dynamic_pointer_cast<Polygon>(elements[i])) {
+                if (std::shared_ptr<PolygonDrawData> drawData = polygon->getDrawData()) {
+                    for (std::size_t j = 0; j < drawData->getCoords().size(); j++) {
+                        _pickBufferRenderer.drawTriangles(id, drawData->getCoords()[j], drawData->getIndices()[j]);
+                    }
+                }
+            } else if (auto polygon3D = std::dynamic_pointer_cast<Polygon3D>(elements[i])) {
+                if (std::shared_ptr<Polygon3DDrawData> drawData = polygon3D->getDrawData()) {
+                    _pickBufferRenderer.drawTriangles(id, drawData->getCoords());
+                }
+            }
+        }
+
+        pickedId = _pickBufferRenderer.end();
+        return true;
+    }
+    
     void MapRenderer::handleRenderThreadCallbacks() {
         // Call all registered callbacks exacly once
         std::vector<std::shared_ptr<ThreadWorker> > renderThreadCallbacks;
@@ -935,6 +1402,18 @@ namespace carto {
         }
     }
     
+    bool MapRenderer::isUpdateInProgress() const {
+        if (_redrawPending || !_cullWorker->isIdle() || !_billboardPlacementWorker->isIdle()) {
+            return true;
+        }
+        for (const std::shared_ptr<Layer>& layer : _layers->getAll()) {
+            if (layer->isUpdateInProgress()) {
+                return true;
+            }
+        }
+        return false;
+    }
+    
     void MapRenderer::handleRendererCaptureCallbacks() {
         int width, height;
         {
@@ -955,14 +1434,7 @@ namespace carto {
             const DirectorPtr<RendererCaptureListener>& listener = rendererCaptureListeners[i].first;
             bool waitWhileUpdating = rendererCaptureListeners[i].second;
             if (waitWhileUpdating) {
-                bool layersUpdating = false;
-                for (const std::shared_ptr<Layer>& layer : _layers->getAll()) {
-                    if (layer->isUpdateInProgress()) {
-                        layersUpdating = true;
-                        break;
-                    }
-                }
-                if (_redrawPending || layersUpdating || !_cullWorker->isIdle() || !_billboardPlacementWorker->isIdle()) {
+                if (isUpdateInProgress()) {
                     std::lock_guard<std::mutex> lock(_rendererCaptureListenersMutex);
                     _rendererCaptureListeners.push_back(rendererCaptureListeners[i]);
                     callbacksPending = true;
@@ -991,6 +1463,9 @@ namespace carto {
         if (auto mapRenderer = _mapRenderer.lock()) {
             bool updateView = false;
 
+            // Any option may affect the rendering of the cached layers
+            mapRenderer->_layerCacheInvalidated = true;
+
             if (optionName == "AmbientLightColor" || optionName == "MainLightColor" || optionName == "MainLightDirection" || optionName == "ClearColor" || optionName == "SkyColor") {
                 updateView = true;
             }
@@ -1030,10 +1505,60 @@ namespace carto {
         }
     }
 
+    MapRenderer::StyleTextureCacheCleaner::StyleTextureCacheCleaner(const std::shared_ptr<MapRenderer>& mapRenderer) : _mapRenderer(mapRenderer)
+    {
+    }
+
+    void MapRenderer::StyleTextureCacheCleaner::operator ()() {
+        if (auto mapRenderer = _mapRenderer.lock()) {
+            if (mapRenderer->_styleCache) {
+                mapRenderer->_styleCache->clear();
+            }
+        }
+    }
+
+    MapRenderer::PickBufferTask::PickBufferTask(const std::shared_ptr<MapRenderer>& mapRenderer, const ViewState& viewState, const cglib::vec3<double>& targetPos, const std::vector<std::shared_ptr<VectorElement> >& elements) :
+        _mapRenderer(mapRenderer),
+        _viewState(viewState),
+        _targetPos(targetPos),
+        _elements(elements),
+        _finished(false),
+        _success(false),
+        _pickedId(0),
+        _mutex(),
+        _condition()
+    {
+    }
+
+    bool MapRenderer::PickBufferTask::waitForResult(int timeoutMs, unsigned int& pickedId) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (!_condition.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this]() { return _finished; })) {
+            return false;
+        }
+        pickedId = _pickedId;
+        return _success;
+    }
+
+    void MapRenderer::PickBufferTask::operator ()() {
+        bool success = false;
+        unsigned int pickedId = 0;
+        if (auto mapRenderer = _mapRenderer.lock()) {
+            success = mapRenderer->drawPickBuffer(_viewState, _targetPos, _elements, pickedId);
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _finished = true;
+        _success = success;
+        _pickedId = pickedId;
+        _condition.notify_all();
+    }
+
     const int MapRenderer::BILLBOARD_PLACEMENT_TASK_DELAY = 200;
 
     const int MapRenderer::STYLE_TEXTURE_CACHE_SIZE = 8 * 1024 * 1024;
 
+    const int MapRenderer::PICK_BUFFER_TIMEOUT = 500;
+
     const std::string MapRenderer::BLEND_VERTEX_SHADER = R"GLSL(
         #version 100
         attribute vec2 a_coord;
@@ -1054,4 +1579,5 @@ namespace carto {
             gl_FragColor = texColor * u_color;
         }
     )GLSL";
+
 }
@@ -8,17 +8,22 @@
 #define _CARTO_MAPRENDERER_H_
 
 #include "components/DirectorPtr.h"
+#include "components/ThreadWorker.h"
 #include "graphics/ViewState.h"
 #include "renderers/components/StyleTextureCache.h"
 #include "renderers/BackgroundRenderer.h"
 #include "renderers/components/AnimationHandler.h"
 #include "renderers/components/BillboardSorter.h"
+#include "renderers/components/FrameProfiler.h"
 #include "renderers/components/KineticEventHandler.h"
+#include "renderers/PickBufferRenderer.h"
 #include "renderers/WatermarkRenderer.h"
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 
@@ -29,6 +34,7 @@ namespace carto {
     class CameraZoomEvent;
     class Bitmap;
     class BillboardDrawData;
+    class BillboardRenderer;
     class Layer;
     class Layers;
     class MapPos;
@@ -40,15 +46,17 @@ namespace carto {
     class RedrawRequestListener;
     class RayIntersectedElement;
     class Options;
-    class ThreadWorker;
     class CullWorker;
     class BillboardPlacementWorker;
+    class RedrawWorker;
+    class FrameStatistics;
     class FrameBuffer;
     class Shader;
     class Texture;
     class FrameBufferManager;
     class ShaderManager;
     class TextureManager;
+    class VectorElement;
 
     /**
      * The map renderer component.
@@ -60,6 +68,7 @@ namespace carto {
             
             virtual void onMapChanged() = 0;
             virtual void onMapIdle() = 0;
+            virtual void onBeforeDrawFrame() = 0;
         };
 
         MapRenderer(const std::shared_ptr<Layers>& layers, const std::shared_ptr<Options>& options);
@@ -107,6 +116,30 @@ namespace carto {
          * @param waitWhileUpdating If true, delay the capture until all asynchronous processes are finished (for example, until all tiles are loaded).
          */
         void captureRendering(const std::shared_ptr<RendererCaptureListener>& listener, bool waitWhileUpdating);
+
+        /**
+         * Returns true if frame statistics are collected.
+         * @return True if frame statistics are collected.
+         */
+        bool isFrameStatisticsEnabled() const;
+        /**
+         * Enables or disables collecting frame statistics. When enabled, the statistics of each frame are
+         * reported via MapRendererListener::onFrameStatistics callback, usually a few frames after the frame was drawn.
+         * Note that collecting statistics adds a small overhead to rendering. Disabled by default.
+         * @param enabled True if frame statistics should be collected.
+         */
+        void setFrameStatisticsEnabled(bool enabled);
+        /**
+         * Returns the frame statistics averaged over the recently drawn frames.
+         * @return The averaged frame statistics, or null if statistics are not enabled or no frames have been drawn yet.
+         */
+        std::shared_ptr<FrameStatistics> getAverageFrameStatistics() const;
+        /**
+         * Returns the time from the creation of the renderer to the first complete frame, that is the first frame drawn
+         * after all layers have finished loading. The time is also reported via MapRendererListener::onFirstFrameCompleted callback.
+         * @return The time to the first complete frame in seconds, or -1 if no complete frame has been drawn yet.
+         */
+        float getTimeToFirstFrame() const;
         
         std::vector<std::shared_ptr<BillboardDrawData> > getBillboardDrawDatas() const;
     
@@ -117,6 +150,11 @@ namespace carto {
         void calculateCameraEvent(CameraRotationEvent& cameraEvent, float durationSeconds, bool updateKinetic);
         void calculateCameraEvent(CameraTiltEvent& cameraEvent, float durationSeconds, bool updateKinetic);
         void calculateCameraEvent(CameraZoomEvent& cameraEvent, float durationSeconds, bool updateKinetic);
+
+        bool calculatePredictedViewState(ViewState& viewState) const;
+
+        std::shared_ptr<const ViewState> getViewStateSnapshot() const;
+        std::shared_ptr<const ViewState> getCurrentViewStateSnapshot() const;
     
         void moveToFitBounds(const MapBounds& mapBounds, const ScreenBounds& screenBounds, bool integerZoom, bool resetTilt, bool resetRotation, float durationSeconds);
         
@@ -131,7 +169,7 @@ namespace carto {
         void blendAndUnbindScreenFBO(float opacity);
         void setZBuffering(bool enable);
     
-        void calculateRayIntersectedElements(const MapPos& targetPos, ViewState& viewState, std::vector<RayIntersectedElement>& results);
+        void calculateRayIntersectedElements(const MapPos& targetPos, const ViewState& viewState, std::vector<RayIntersectedElement>& results);
     
         void billboardsChanged();
         void layerChanged(const std::shared_ptr<Layer>& layer, bool delay);
@@ -141,6 +179,10 @@ namespace carto {
         void unregisterOnChangeListener(const std::shared_ptr<OnChangeListener>& listener);
         
         void addRenderThreadCallback(const std::shared_ptr<ThreadWorker>& callback);
+
+        void notifyRedrawRequested() const;
+
+        void clearStyleTextureCache();
         
     private:
         class OptionsListener : public Options::OnChangeListener {
@@ -153,23 +195,74 @@ namespace carto {
             std::weak_ptr<MapRenderer> _mapRenderer;
         };
 
+        class StyleTextureCacheCleaner : public ThreadWorker {
+        public:
+            explicit StyleTextureCacheCleaner(const std::shared_ptr<MapRenderer>& mapRenderer);
+
+            virtual void operator()();
+
+        private:
+            std::weak_ptr<MapRenderer> _mapRenderer;
+        };
+
+        class PickBufferTask : public ThreadWorker {
+        public:
+            PickBufferTask(const std::shared_ptr<MapRenderer>& mapRenderer, const ViewState& viewState, const cglib::vec3<double>& targetPos, const std::vector<std::shared_ptr<VectorElement> >& elements);
+
+            bool waitForResult(int timeoutMs, unsigned int& pickedId);
+
+            virtual void operator()();
+
+        private:
+            std::weak_ptr<MapRenderer> _mapRenderer;
+            ViewState _viewState;
+            cglib::vec3<double> _targetPos;
+            std::vector<std::shared_ptr<VectorElement> > _elements;
+            bool _finished;
+            bool _success;
+            unsigned int _pickedId;
+            std::mutex _mutex;
+            std::condition_variable _condition;
+        };
+
+        struct ViewStateSnapshot {
+            ViewState viewState;
+            unsigned int version;
+        };
+
+        void publishViewStateSnapshot(const ViewState& viewState, unsigned int version);
+
         void initializeRenderState() const;
 
         void drawLayers(float deltaSeconds, const ViewState& viewState);
+        void drawBillboards(float deltaSeconds, const std::shared_ptr<BillboardRenderer>& renderer, const ViewState& viewState);
+
+        std::size_t calculateStaticLayerCount(const std::vector<std::shared_ptr<Layer> >& layers) const;
+        bool isLayerCacheValid(const std::vector<std::shared_ptr<Layer> >& layers, std::size_t layerCount, const ViewState& viewState) const;
+        void bindLayerCacheFBO(GLint& prevBoundFBO);
+        void drawLayerCache();
+
+        void filterPickedElements(const cglib::vec3<double>& targetPos, const ViewState& viewState, std::vector<RayIntersectedElement>& results);
+        bool drawPickBuffer(const ViewState& viewState, const cglib::vec3<double>& targetPos, const std::vector<std::shared_ptr<VectorElement> >& elements, unsigned int& pickedId);
         
         void handleRenderThreadCallbacks();
+        bool isUpdateInProgress() const;
         void handleRendererCaptureCallbacks();
 
         static const int BILLBOARD_PLACEMENT_TASK_DELAY;
 
         static const int STYLE_TEXTURE_CACHE_SIZE; // Size limit (in bytes) for style texture cache
 
+        static const int PICK_BUFFER_TIMEOUT; // Maximum time (in milliseconds) to wait for the pick buffer rendering
+
         static const std::string BLEND_VERTEX_SHADER;
         static const std::string BLEND_FRAGMENT_SHADER;
         
         std::chrono::steady_clock::time_point _lastFrameTime;
     
         ViewState _viewState;
+        std::atomic<unsigned int> _viewStateVersion; // incremented after each view change, for detecting stale snapshots
+        std::shared_ptr<const ViewStateSnapshot> _viewStateSnapshot; // view state of the last drawn frame, accessed only with atomic_load/atomic_store
 
         std::shared_ptr<FrameBufferManager> _frameBufferManager;
         std::shared_ptr<ShaderManager> _shaderManager;
@@ -186,14 +279,27 @@ namespace carto {
 
         std::shared_ptr<FrameBuffer> _screenFrameBuffer;
         std::shared_ptr<Shader> _screenBlendShader;
+
+        std::shared_ptr<FrameBuffer> _layerCacheFrameBuffer;
+        std::vector<std::pair<std::weak_ptr<Layer>, unsigned int> > _layerCacheStamps; // cached layers with their redraw stamps
+        cglib::mat4x4<double> _lastFrameMVPMat; // for detecting the stationary view, the cache is updated only when the view has not changed since the last frame
+        bool _layerCacheValid;
         
         BackgroundRenderer _backgroundRenderer;
         WatermarkRenderer _watermarkRenderer;
+        PickBufferRenderer _pickBufferRenderer;
+
+        FrameProfiler _frameProfiler;
+        std::atomic<bool> _frameStatisticsEnabled;
+        bool _frameProfilerActive;
         
         BillboardSorter _billboardSorter;
         std::vector<std::shared_ptr<BillboardDrawData> > _billboardDrawDataBuffer;
         std::shared_ptr<BillboardPlacementWorker> _billboardPlacementWorker;
         std::thread _billboardPlacementThread;
+
+        std::shared_ptr<RedrawWorker> _redrawWorker;
+        std::thread _redrawThread;
     
         AnimationHandler _animationHandler;
         KineticEventHandler _kineticEventHandler;
@@ -204,8 +310,13 @@ namespace carto {
         mutable std::atomic<bool> _surfaceCreated;
         mutable std::atomic<bool> _surfaceChanged;
         mutable std::atomic<bool> _billboardsChanged;
+        mutable std::atomic<bool> _billboardViewChanged;
         mutable std::atomic<bool> _renderProjectionChanged;
         mutable std::atomic<bool> _redrawPending;
+        mutable std::atomic<bool> _layerCacheInvalidated;
+        std::atomic<long long> _frameStartTime; // steady clock time of the last frame start in microseconds, for limiting the frame rate
+        const std::chrono::steady_clock::time_point _creationTime;
+        std::atomic<float> _timeToFirstFrame; // negative until the first complete frame is drawn
 
         ThreadSafeDirectorPtr<RedrawRequestListener> _redrawRequestListener;
 
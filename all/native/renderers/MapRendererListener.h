@@ -7,7 +7,10 @@
 #ifndef _CARTO_MAPRENDERERLISTENER_H_
 #define _CARTO_MAPRENDERERLISTENER_H_
 
+#include <memory>
+
 namespace carto {
+    class FrameStatistics;
 
     /**
      * Listener for specific map renderer events.
@@ -29,6 +32,22 @@ namespace carto {
          * This method is called from GL renderer thread, not from main thread.
          */
         virtual void onAfterDrawFrame() { }
+
+        /**
+         * Listener method that gets called when the statistics of a rendered frame become available.
+         * Statistics are collected only if enabled via MapRenderer::setFrameStatisticsEnabled.
+         * Because GPU times are measured asynchronously, this is usually called a few frames after the frame was drawn.
+         * This method is called from GL renderer thread, not from main thread.
+         * @param statistics The statistics of the frame.
+         */
+        virtual void onFrameStatistics(const std::shared_ptr<FrameStatistics>& statistics) { }
+
+        /**
+         * Listener method that gets called once, when the first frame with all the layers loaded has been drawn.
+         * This method is called from GL renderer thread, not from main thread.
+         * @param timeToFirstFrame The time from the creation of the map view to the first complete frame in seconds.
+         */
+        virtual void onFirstFrameCompleted(float timeToFirstFrame) { }
     };
     
 }
@@ -11,6 +11,8 @@
 #include "renderers/components/RayIntersectedElement.h"
 #include "utils/Log.h"
 
+#include <algorithm>
+
 #include <nml/GLModel.h>
 #include <nml/GLTexture.h>
 #include <nml/GLResourceManager.h>
@@ -37,6 +39,7 @@ namespace carto {
         _glModelMap(),
         _elements(),
         _tempElements(),
+        _drawDatas(),
         _mapRenderer(),
         _options(),
         _mutex()
@@ -90,26 +93,51 @@ namespace carto {
         MapVec optionsMainLightDirection = options->getMainLightDirection();
         cglib::vec3<float> mainLightDir = cglib::vec3<float>::convert(cglib::unit(viewState.getProjectionSurface()->calculateVector(MapPos(0, 0), options->getMainLightDirection())));
 
+        // Group the elements by their source models, so that each model is looked up once per frame and the draw calls of the same model are consecutive
+        _drawDatas.clear();
+        for (const std::shared_ptr<NMLModel>& element : _elements) {
+            _drawDatas.push_back(element->getDrawData());
+        }
+        std::stable_sort(_drawDatas.begin(), _drawDatas.end(), [](const std::shared_ptr<NMLModelDrawData>& drawData1, const std::shared_ptr<NMLModelDrawData>& drawData2) {
+            return drawData1->getSourceModel() < drawData2->getSourceModel();
+        });
+
         // Draw models
         cglib::mat4x4<float> projMat = cglib::mat4x4<float>::convert(viewState.getProjectionMat());
-        for (const std::shared_ptr<NMLModel>& element : _elements) {
-            const NMLModelDrawData& drawData = *element->getDrawData();
+        std::shared_ptr<nml::Model> sourceModel;
+        std::shared_ptr<nml::GLModel> glModel;
+        cglib::bbox3<double> glModelBounds = cglib::bbox3<double>::smallest();
+        for (const std::shared_ptr<NMLModelDrawData>& drawData : _drawDatas) {
+            if (drawData->getSourceModel() != sourceModel) {
+                sourceModel = drawData->getSourceModel();
+                glModel = _glModelMap[sourceModel];
+                if (!glModel) {
+                    glModel = std::make_shared<nml::GLModel>(*sourceModel);
+                    glModel->create(*_glResourceManager);
+                    _glModelMap[sourceModel] = glModel;
+                }
+                glModelBounds = cglib::bbox3<double>::convert(glModel->getBounds());
+            }
 
-            Color drawDataColor = drawData.getColor();
-            cglib::vec4<float> modelColor = cglib::vec4<float>(drawDataColor.getR(), drawDataColor.getG(), drawDataColor.getB(), drawDataColor.getA()) * (1.0f / 255.0f);
-            std::shared_ptr<nml::Model> sourceModel = drawData.getSourceModel();
-            std::shared_ptr<nml::GLModel> glModel = _glModelMap[sourceModel];
-            if (!glModel) {
-                glModel = std::make_shared<nml::GLModel>(*sourceModel);
-                glModel->create(*_glResourceManager);
-                _glModelMap[sourceModel] = glModel;
+            // Skip the instances outside of the view frustum and the instances too small or too far away to be visible
+            cglib::bbox3<double> bounds = cglib::transform_bbox(glModelBounds, drawData->getLocalMat());
+            if (!viewState.getFrustum().inside(bounds)) {
+                continue;
+            }
+            double distance = cglib::length(bounds.center() - viewState.getCameraPos());
+            if (distance > 0 && cglib::length(bounds.size()) * viewState.getHalfHeight() < MIN_SCREEN_SIZE * distance * viewState.getTanHalfFOVY()) {
+                continue;
             }
+
+            Color drawDataColor = drawData->getColor();
+            cglib::vec4<float> modelColor = cglib::vec4<float>(drawDataColor.getR(), drawDataColor.getG(), drawDataColor.getB(), drawDataColor.getA()) * (1.0f / 255.0f);
     
-            cglib::mat4x4<float> mvMat = cglib::mat4x4<float>::convert(viewState.getModelviewMat() * drawData.getLocalMat());
+            cglib::mat4x4<float> mvMat = cglib::mat4x4<float>::convert(viewState.getModelviewMat() * drawData->getLocalMat());
             nml::RenderState renderState(projMat, mvMat, cglib::pointwise_product(ambientLightColor, modelColor), cglib::pointwise_product(mainLightColor, modelColor), -mainLightDir);
 
             glModel->draw(*_glResourceManager, renderState);
         }
+        _drawDatas.clear();
 
         // Remove stale models
         for (auto it = _glModelMap.begin(); it != _glModelMap.end(); ) {
@@ -199,5 +227,7 @@ namespace carto {
             }
         }
     }
+
+    const float NMLModelRenderer::MIN_SCREEN_SIZE = 1.0f;
     
 }
@@ -57,10 +57,13 @@ namespace carto {
         void calculateRayIntersectedElements(const std::shared_ptr<VectorLayer>& layer, const cglib::ray3<double>& ray, const ViewState& viewState, std::vector<RayIntersectedElement>& results) const;
     
     private:
+        static const float MIN_SCREEN_SIZE; // in pixels, instances with smaller projected size are not drawn
+
         std::shared_ptr<nml::GLResourceManager> _glResourceManager;
         std::map<std::weak_ptr<nml::Model>, std::shared_ptr<nml::GLModel>, std::owner_less<std::weak_ptr<nml::Model> > > _glModelMap;
         std::vector<std::shared_ptr<NMLModel> > _elements;
         std::vector<std::shared_ptr<NMLModel> > _tempElements;
+        std::vector<std::shared_ptr<NMLModelDrawData> > _drawDatas;
 
         std::weak_ptr<MapRenderer> _mapRenderer;
         std::weak_ptr<Options> _options;
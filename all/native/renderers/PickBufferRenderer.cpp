@@ -0,0 +1,194 @@
+#include "PickBufferRenderer.h"
+#include "graphics/FrameBuffer.h"
+#include "graphics/FrameBufferManager.h"
+#include "graphics/Shader.h"
+#include "graphics/ShaderManager.h"
+#include "graphics/ViewState.h"
+
+namespace carto {
+
+    PickBufferRenderer::PickBufferRenderer() :
+        _frameBuffer(),
+        _frameBufferManager(),
+        _shader(),
+        _a_coord(0),
+        _u_color(0),
+        _u_mvpMat(0),
+        _bound(false),
+        _prevBoundFBO(0),
+        _prevViewport(),
+        _cameraPos(0, 0, 0),
+        _coordBuf()
+    {
+    }
+
+    PickBufferRenderer::~PickBufferRenderer() {
+    }
+
+    void PickBufferRenderer::onSurfaceCreated(const std::shared_ptr<ShaderManager>& shaderManager, const std::shared_ptr<FrameBufferManager>& frameBufferManager) {
+        static ShaderSource shaderSource("pick", &PICK_VERTEX_SHADER, &PICK_FRAGMENT_SHADER);
+
+        _shader = shaderManager->createShader(shaderSource);
+
+        // Get shader variables locations
+        glUseProgram(_shader->getProgId());
+        _a_coord = _shader->getAttribLoc("a_coord");
+        _u_color = _shader->getUniformLoc("u_color");
+        _u_mvpMat = _shader->getUniformLoc("u_mvpMat");
+
+        // The frame buffer is created only when the first pick is done
+        _frameBufferManager = frameBufferManager;
+        _frameBuffer.reset();
+        _bound = false;
+    }
+
+    void PickBufferRenderer::onSurfaceDestroyed() {
+        _shader.reset();
+        _frameBuffer.reset();
+        _frameBufferManager.reset();
+        _bound = false;
+    }
+
+    bool PickBufferRenderer::begin(const ViewState& viewState, const cglib::vec3<double>& targetPos) {
+        if (!_shader || !_frameBufferManager || _bound) {
+            return false;
+        }
+
+        // Find the normalized screen position of the target
+        const cglib::mat4x4<double>& mvpMat = viewState.getModelviewProjectionMat();
+        cglib::vec4<double> projTarget = cglib::transform(cglib::vec4<double>(targetPos(0), targetPos(1), targetPos(2), 1), mvpMat);
+        if (!(projTarget(3) > 0)) {
+            return false;
+        }
+        float targetX = static_cast<float>(projTarget(0) / projTarget(3));
+        float targetY = static_cast<float>(projTarget(1) / projTarget(3));
+
+        if (!_frameBuffer) {
+            _frameBuffer = _frameBufferManager->createFrameBuffer(PICK_BUFFER_SIZE, PICK_BUFFER_SIZE, true, true, false);
+        }
+
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &_prevBoundFBO);
+        glGetIntegerv(GL_VIEWPORT, _prevViewport);
+        glBindFramebuffer(GL_FRAMEBUFFER, _frameBuffer->getFBOId());
+        glViewport(0, 0, PICK_BUFFER_SIZE, PICK_BUFFER_SIZE);
+
+        glClearColor(0, 0, 0, 0);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        glDepthMask(GL_TRUE);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // Triangles are drawn without blending and culling, IDs of the later triangles replace the earlier IDs at equal depth
+        glDisable(GL_BLEND);
+        glDisable(GL_CULL_FACE);
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LEQUAL);
+
+        // Scale the screen area of the pick buffer around the target to the full viewport
+        float scaleX = static_cast<float>(viewState.getWidth()) / PICK_BUFFER_SIZE;
+        float scaleY = static_cast<float>(viewState.getHeight()) / PICK_BUFFER_SIZE;
+        cglib::mat4x4<float> cropMat = cglib::mat4x4<float>::identity();
+        cropMat(0, 0) = scaleX;
+        cropMat(0, 3) = -targetX * scaleX;
+        cropMat(1, 1) = scaleY;
+        cropMat(1, 3) = -targetY * scaleY;
+        cglib::mat4x4<float> pickMat = cropMat * viewState.getRTEModelviewProjectionMat();
+
+        glUseProgram(_shader->getProgId());
+        glUniformMatrix4fv(_u_mvpMat, 1, GL_FALSE, pickMat.data());
+        glEnableVertexAttribArray(_a_coord);
+
+        _cameraPos = viewState.getCameraPos();
+        _bound = true;
+
+        GLContext::CheckGLError("PickBufferRenderer::begin");
+        return true;
+    }
+
+    void PickBufferRenderer::drawTriangles(unsigned int id, const std::vector<cglib::vec3<double> >& coords) {
+        if (!_bound) {
+            return;
+        }
+
+        _coordBuf.clear();
+        _coordBuf.reserve(coords.size() * 3);
+        for (const cglib::vec3<double>& coord : coords) {
+            for (int i = 0; i < 3; i++) {
+                _coordBuf.push_back(static_cast<float>(coord(i) - _cameraPos(i)));
+            }
+        }
+        drawCoordBuffer(id);
+    }
+
+    void PickBufferRenderer::drawTriangles(unsigned int id, const std::vector<cglib::vec3<double> >& coords, const std::vector<unsigned int>& indices) {
+        if (!_bound) {
+            return;
+        }
+
+        // Expand the indexed triangles, so that 32-bit indices are not needed
+        _coordBuf.clear();
+        _coordBuf.reserve(indices.size() * 3);
+        for (unsigned int index : indices) {
+            const cglib::vec3<double>& coord = coords[index];
+            for (int i = 0; i < 3; i++) {
+                _coordBuf.push_back(static_cast<float>(coord(i) - _cameraPos(i)));
+            }
+        }
+        drawCoordBuffer(id);
+    }
+
+    unsigned int PickBufferRenderer::end() {
+        if (!_bound) {
+            return 0;
+        }
+
+        unsigned char pixel[4] = { 0, 0, 0, 0 };
+        glReadPixels(PICK_BUFFER_SIZE / 2, PICK_BUFFER_SIZE / 2, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+
+        glDisableVertexAttribArray(_a_coord);
+
+        _frameBuffer->discard(false, true, false);
+
+        // Restore the render state of the map renderer
+        glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(_prevBoundFBO));
+        glViewport(_prevViewport[0], _prevViewport[1], _prevViewport[2], _prevViewport[3]);
+        glDepthMask(GL_FALSE);
+        glEnable(GL_CULL_FACE);
+        glEnable(GL_BLEND);
+        _bound = false;
+
+        GLContext::CheckGLError("PickBufferRenderer::end");
+
+        return (static_cast<unsigned int>(pixel[0]) << 16) | (static_cast<unsigned int>(pixel[1]) << 8) | static_cast<unsigned int>(pixel[2]);
+    }
+
+    void PickBufferRenderer::drawCoordBuffer(unsigned int id) {
+        if (_coordBuf.empty()) {
+            return;
+        }
+
+        glUniform4f(_u_color, ((id >> 16) & 255) / 255.0f, ((id >> 8) & 255) / 255.0f, (id & 255) / 255.0f, 1.0f);
+        glVertexAttribPointer(_a_coord, 3, GL_FLOAT, GL_FALSE, 0, _coordBuf.data());
+        GLsizei vertexCount = static_cast<GLsizei>(_coordBuf.size() / 3);
+        glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+        GLContext::CountDrawCall(vertexCount);
+    }
+
+    const std::string PickBufferRenderer::PICK_VERTEX_SHADER = R"GLSL(
+        #version 100
+        attribute vec4 a_coord;
+        uniform mat4 u_mvpMat;
+        void main() {
+            gl_Position = u_mvpMat * a_coord;
+        }
+    )GLSL";
+
+    const std::string PickBufferRenderer::PICK_FRAGMENT_SHADER = R"GLSL(
+        #version 100
+        precision mediump float;
+        uniform vec4 u_color;
+        void main() {
+            gl_FragColor = u_color;
+        }
+    )GLSL";
+
+}
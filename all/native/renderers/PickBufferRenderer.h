@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_PICKBUFFERRENDERER_H_
+#define _CARTO_PICKBUFFERRENDERER_H_
+
+#include "graphics/utils/GLContext.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <cglib/vec.h>
+#include <cglib/mat.h>
+
+namespace carto {
+    class FrameBuffer;
+    class FrameBufferManager;
+    class Shader;
+    class ShaderManager;
+    class ViewState;
+
+    /**
+     * Renderer for GPU picking. Triangles of the click candidates are rendered with their IDs into a small offscreen
+     * buffer covering a few pixels around the click position, using depth testing, and the ID of the center pixel is read back.
+     * Must be used only from the rendering thread.
+     */
+    class PickBufferRenderer {
+    public:
+        PickBufferRenderer();
+        virtual ~PickBufferRenderer();
+
+        void onSurfaceCreated(const std::shared_ptr<ShaderManager>& shaderManager, const std::shared_ptr<FrameBufferManager>& frameBufferManager);
+        void onSurfaceDestroyed();
+
+        /**
+         * Binds and clears the pick buffer.
+         * @param viewState The view state of the click.
+         * @param targetPos The world position under the click position.
+         * @return True if the buffer was bound and the triangles can be drawn.
+         */
+        bool begin(const ViewState& viewState, const cglib::vec3<double>& targetPos);
+        /**
+         * Draws a triangle list with the specified ID.
+         * @param id The ID of the triangles, must be in range 1..2^24-1.
+         * @param coords The world coordinates of the triangle vertices.
+         */
+        void drawTriangles(unsigned int id, const std::vector<cglib::vec3<double> >& coords);
+        /**
+         * Draws indexed triangles with the specified ID.
+         * @param id The ID of the triangles, must be in range 1..2^24-1.
+         * @param coords The world coordinates of the vertices.
+         * @param indices The vertex indices of the triangles.
+         */
+        void drawTriangles(unsigned int id, const std::vector<cglib::vec3<double> >& coords, const std::vector<unsigned int>& indices);
+        /**
+         * Reads back the ID at the click position and restores the previous frame buffer and render state.
+         * @return The ID of the front-most triangle at the click position, or 0 if nothing was drawn there.
+         */
+        unsigned int end();
+
+    private:
+        static const int PICK_BUFFER_SIZE = 3; // odd, so that the center pixel is centered at the click position
+
+        static const std::string PICK_VERTEX_SHADER;
+        static const std::string PICK_FRAGMENT_SHADER;
+
+        void drawCoordBuffer(unsigned int id);
+
+        std::shared_ptr<FrameBuffer> _frameBuffer;
+        std::shared_ptr<FrameBufferManager> _frameBufferManager;
+
+        std::shared_ptr<Shader> _shader;
+        GLuint _a_coord;
+        GLuint _u_color;
+        GLuint _u_mvpMat;
+
+        bool _bound;
+        GLint _prevBoundFBO;
+        GLint _prevViewport[4];
+        cglib::vec3<double> _cameraPos;
+
+        std::vector<float> _coordBuf;
+    };
+
+}
+
+#endif
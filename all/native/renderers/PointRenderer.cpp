@@ -27,6 +27,8 @@ namespace carto {
         _coordBuf(),
         _indexBuf(),
         _texCoordBuf(),
+        _instanceRenderer(),
+        _instanceBuf(),
         _shader(),
         _a_color(0),
         _a_coord(0),
@@ -62,6 +64,8 @@ namespace carto {
         _u_mvpMat = _shader->getUniformLoc("u_mvpMat");
         _u_tex = _shader->getUniformLoc("u_tex");
 
+        _instanceRenderer.onSurfaceCreated(shaderManager);
+
         // Drop elements
         std::vector<std::shared_ptr<Point>> elements;
         {
@@ -96,6 +100,7 @@ namespace carto {
     }
     
     void PointRenderer::onSurfaceDestroyed() {
+        _instanceRenderer.onSurfaceDestroyed();
         _shader.reset();
     }
     
@@ -171,6 +176,7 @@ namespace carto {
                 glVertexAttribPointer(a_coord, 3, GL_FLOAT, GL_FALSE, 0, coordBuf.data());
                 glVertexAttribPointer(a_texCoord, 2, GL_FLOAT, GL_FALSE, 0, texCoordBuf.data());
                 glDrawElements(GL_TRIANGLES, drawDataIndex * 6, GL_UNSIGNED_SHORT, indexBuf.data());
+                GLContext::CountDrawCall(drawDataIndex * 6);
                 // Start filling buffers from the beginning
                 drawDataIndex = 0;
             }
@@ -230,7 +236,48 @@ namespace carto {
             glVertexAttribPointer(a_coord, 3, GL_FLOAT, GL_FALSE, 0, coordBuf.data());
             glVertexAttribPointer(a_texCoord, 2, GL_FLOAT, GL_FALSE, 0, texCoordBuf.data());
             glDrawElements(GL_TRIANGLES, drawDataIndex * 6, GL_UNSIGNED_SHORT, indexBuf.data());
+            GLContext::CountDrawCall(drawDataIndex * 6);
+        }
+    }
+    
+    void PointRenderer::BuildAndDrawInstances(QuadInstanceRenderer& instanceRenderer,
+                                              std::vector<QuadInstanceRenderer::Instance>& instanceBuf,
+                                              std::vector<std::shared_ptr<PointDrawData> >& drawDataBuffer,
+                                              const cglib::vec2<float>& texCoordScale,
+                                              const ViewState& viewState)
+    {
+        // Build a single instance per point, the corners are expanded in the vertex shader
+        cglib::vec3<double> cameraPos = viewState.getCameraPos();
+        instanceBuf.resize(drawDataBuffer.size());
+        for (std::size_t i = 0; i < drawDataBuffer.size(); i++) {
+            const std::shared_ptr<PointDrawData>& drawData = drawDataBuffer[i];
+            QuadInstanceRenderer::Instance& instance = instanceBuf[i];
+
+            float coordScale = drawData->getSize() * viewState.getUnitToDPCoef() * 0.5f;
+            cglib::vec3<float> translate = cglib::vec3<float>::convert(drawData->getPos() - cameraPos);
+            cglib::vec3<float> dx = drawData->getXAxis() * coordScale;
+            cglib::vec3<float> dy = drawData->getYAxis() * coordScale;
+
+            // Origin is the top-left corner, axes point right and down
+            for (int j = 0; j < 3; j++) {
+                instance.origin[j] = translate(j) - dx(j) + dy(j);
+                instance.xAxis[j] = dx(j) * 2.0f;
+                instance.yAxis[j] = dy(j) * -2.0f;
+            }
+
+            instance.texCoordRect[0] = 0.0f;
+            instance.texCoordRect[1] = texCoordScale(1);
+            instance.texCoordRect[2] = texCoordScale(0);
+            instance.texCoordRect[3] = -texCoordScale(1);
+
+            const Color& color = drawData->getColor();
+            instance.color[0] = color.getR();
+            instance.color[1] = color.getG();
+            instance.color[2] = color.getB();
+            instance.color[3] = color.getA();
         }
+
+        instanceRenderer.drawInstances(instanceBuf);
     }
     
     bool PointRenderer::FindElementRayIntersection(const std::shared_ptr<VectorElement>& element,
@@ -278,6 +325,11 @@ namespace carto {
     }
     
     void PointRenderer::bind(const ViewState& viewState) {
+        if (_instanceRenderer.isAvailable()) {
+            _instanceRenderer.bind(viewState);
+            return;
+        }
+
         // Prepare for drawing
         glUseProgram(_shader->getProgId());
         // Texture
@@ -292,6 +344,11 @@ namespace carto {
     }
     
     void PointRenderer::unbind() {
+        if (_instanceRenderer.isAvailable()) {
+            _instanceRenderer.unbind();
+            return;
+        }
+
         // Disable bound arrays
         glDisableVertexAttribArray(_a_coord);
         glDisableVertexAttribArray(_a_texCoord);
@@ -326,9 +383,13 @@ namespace carto {
         }
         glBindTexture(GL_TEXTURE_2D, texture->getTexId());
         
-        // Draw the draw datas
-        BuildAndDrawBuffers(_a_color, _a_coord, _a_texCoord, _colorBuf, _coordBuf, _indexBuf, _texCoordBuf, _drawDataBuffer,
-                            texture->getTexCoordScale(), styleCache, viewState);
+        // Draw the draw datas, using instancing if supported
+        if (_instanceRenderer.isAvailable()) {
+            BuildAndDrawInstances(_instanceRenderer, _instanceBuf, _drawDataBuffer, texture->getTexCoordScale(), viewState);
+        } else {
+            BuildAndDrawBuffers(_a_color, _a_coord, _a_texCoord, _colorBuf, _coordBuf, _indexBuf, _texCoordBuf, _drawDataBuffer,
+                                texture->getTexCoordScale(), styleCache, viewState);
+        }
 
         _drawDataBuffer.clear();
         _prevBitmap = nullptr;
@@ -8,6 +8,7 @@
 #define _CARTO_POINTRENDERER_H_
 
 #include "graphics/utils/GLContext.h"
+#include "renderers/components/QuadInstanceRenderer.h"
 
 #include <deque>
 #include <memory>
@@ -63,6 +64,12 @@ namespace carto {
                                         const cglib::vec2<float>& texCoordScale,
                                         StyleTextureCache& styleCache,
                                         const ViewState& viewState);
+
+        static void BuildAndDrawInstances(QuadInstanceRenderer& instanceRenderer,
+                                          std::vector<QuadInstanceRenderer::Instance>& instanceBuf,
+                                          std::vector<std::shared_ptr<PointDrawData> >& drawDataBuffer,
+                                          const cglib::vec2<float>& texCoordScale,
+                                          const ViewState& viewState);
         
         static bool FindElementRayIntersection(const std::shared_ptr<VectorElement>& element,
                                                const std::shared_ptr<PointDrawData>& drawData,
@@ -91,6 +98,9 @@ namespace carto {
         std::vector<float> _coordBuf;
         std::vector<unsigned short> _indexBuf;
         std::vector<float> _texCoordBuf;
+
+        QuadInstanceRenderer _instanceRenderer;
+        std::vector<QuadInstanceRenderer::Instance> _instanceBuf;
     
         std::shared_ptr<Shader> _shader;
         GLuint _a_color;
@@ -27,16 +27,22 @@ namespace carto {
         _colorBuf(),
         _attribBuf(),
         _coordBuf(),
+        _coordLowBuf(),
         _normalBuf(),
+        _indexBuf(),
         _shader(),
         _a_color(0),
         _a_attrib(0),
         _a_coord(0),
+        _a_coordLow(0),
         _a_normal(0),
         _u_ambientColor(0),
         _u_lightColor(0),
         _u_lightDir(0),
+        _u_cameraPosHigh(0),
+        _u_cameraPosLow(0),
         _u_mvpMat(0),
+        _bufferCache(),
         _options(),
         _mutex()
     {
@@ -56,6 +62,9 @@ namespace carto {
         for (const std::shared_ptr<Polygon3D>& element : _elements) {
             element->getDrawData()->offsetHorizontally(offset);
         }
+
+        // Draw data coordinates were modified in place, buffers must be rebuilt
+        _bufferCache.invalidate();
     }
     
     void Polygon3DRenderer::onSurfaceCreated(const std::shared_ptr<ShaderManager>& shaderManager, const std::shared_ptr<TextureManager>& textureManager) {
@@ -68,12 +77,18 @@ namespace carto {
         _a_color = _shader->getAttribLoc("a_color");
         _a_attrib = _shader->getAttribLoc("a_attrib");
         _a_coord = _shader->getAttribLoc("a_coord");
+        _a_coordLow = _shader->getAttribLoc("a_coordLow");
         _a_normal = _shader->getAttribLoc("a_normal");
         _u_ambientColor = _shader->getUniformLoc("u_ambientColor");
         _u_lightColor = _shader->getUniformLoc("u_lightColor");
         _u_lightDir = _shader->getUniformLoc("u_lightDir");
+        _u_cameraPosHigh = _shader->getUniformLoc("u_cameraPosHigh");
+        _u_cameraPosLow = _shader->getUniformLoc("u_cameraPosLow");
         _u_mvpMat = _shader->getUniformLoc("u_mvpMat");
 
+        // Buffers of the previous context are no longer valid
+        _bufferCache.reset();
+
         // Drop elements
         std::vector<std::shared_ptr<Polygon3D>> elements;
         {
@@ -95,7 +110,9 @@ namespace carto {
         }
 
         if (_elements.empty()) {
-            // Early return, to avoid calling glUseProgram etc.
+            // Release the buffers of the removed elements. Early return, to avoid calling glUseProgram etc.
+            _bufferCache.beginFrame();
+            _bufferCache.endFrame();
             return;
         }
         
@@ -108,6 +125,7 @@ namespace carto {
         glEnableVertexAttribArray(_a_color);
         glEnableVertexAttribArray(_a_attrib);
         glEnableVertexAttribArray(_a_coord);
+        glEnableVertexAttribArray(_a_coordLow);
         glEnableVertexAttribArray(_a_normal);
         // Ambient light color
         const Color& ambientLightColor = options->getAmbientLightColor();
@@ -120,6 +138,12 @@ namespace carto {
         // Main light direction
         cglib::vec3<float> mainLightDir = cglib::vec3<float>::convert(cglib::unit(viewState.getProjectionSurface()->calculateVector(MapPos(0, 0), options->getMainLightDirection())));
         glUniform3fv(_u_lightDir, 1, mainLightDir.data());
+        // Camera position, split into high and low parts
+        cglib::vec3<double> cameraPos = viewState.getCameraPos();
+        cglib::vec3<float> cameraPosHigh(static_cast<float>(cameraPos(0)), static_cast<float>(cameraPos(1)), static_cast<float>(cameraPos(2)));
+        cglib::vec3<float> cameraPosLow(static_cast<float>(cameraPos(0) - cameraPosHigh(0)), static_cast<float>(cameraPos(1) - cameraPosHigh(1)), static_cast<float>(cameraPos(2) - cameraPosHigh(2)));
+        glUniform3fv(_u_cameraPosHigh, 1, cameraPosHigh.data());
+        glUniform3fv(_u_cameraPosLow, 1, cameraPosLow.data());
         // Matrix
         const cglib::mat4x4<float>& mvpMat = viewState.getRTEModelviewProjectionMat();
         glUniformMatrix4fv(_u_mvpMat, 1, GL_FALSE, mvpMat.data());
@@ -130,7 +154,9 @@ namespace carto {
             std::shared_ptr<Polygon3DDrawData> drawData = element->getDrawData();
             _drawDataBuffer.push_back(std::move(drawData));
         }
+        _bufferCache.beginFrame();
         drawBatch(viewState);
+        _bufferCache.endFrame();
         
         // Disable depth test
         glDepthMask(GL_FALSE);
@@ -139,6 +165,7 @@ namespace carto {
         glDisableVertexAttribArray(_a_color);
         glDisableVertexAttribArray(_a_attrib);
         glDisableVertexAttribArray(_a_coord);
+        glDisableVertexAttribArray(_a_coordLow);
         glDisableVertexAttribArray(_a_normal);
     
         GLContext::CheckGLError("Polygon3DRenderer::onDrawFrame");
@@ -146,6 +173,7 @@ namespace carto {
     
     void Polygon3DRenderer::onSurfaceDestroyed() {
         _shader.reset();
+        _bufferCache.reset();
     }
     
     void Polygon3DRenderer::addElement(const std::shared_ptr<Polygon3D>& element) {
@@ -203,120 +231,161 @@ namespace carto {
     void Polygon3DRenderer::BuildAndDrawBuffers(GLuint a_color,
                                                 GLuint a_attrib,
                                                 GLuint a_coord,
+                                                GLuint a_coordLow,
                                                 GLuint a_normal,
                                                 std::vector<unsigned char>& colorBuf,
                                                 std::vector<unsigned char>& attribBuf,
                                                 std::vector<float>& coordBuf,
+                                                std::vector<float>& coordLowBuf,
                                                 std::vector<float>& normalBuf,
+                                                std::vector<unsigned int>& indexBuf,
                                                 std::vector<std::shared_ptr<Polygon3DDrawData> >& drawDataBuffer,
+                                                VertexBufferCache& bufferCache,
                                                 const ViewState& viewState)
     {
-        // Calculate buffer size
-        std::size_t totalCoordCount = 0;
-        for (const std::shared_ptr<Polygon3DDrawData>& drawData : drawDataBuffer) {
-            totalCoordCount += drawData->getCoords().size();
-        }
-    
-        // Resize the buffers, if necessary
-        if (colorBuf.size() < totalCoordCount * 4) {
-            colorBuf.resize(std::min(totalCoordCount * 4, GLContext::MAX_VERTEXBUFFER_SIZE * 4));
-            attribBuf.resize(std::min(totalCoordCount * 1, GLContext::MAX_VERTEXBUFFER_SIZE * 1));
-            coordBuf.resize(std::min(totalCoordCount * 3, GLContext::MAX_VERTEXBUFFER_SIZE * 3));
-            normalBuf.resize(std::min(totalCoordCount * 3, GLContext::MAX_VERTEXBUFFER_SIZE * 3));
-        }
-    
-        // View state specific data
-        cglib::vec3<double> cameraPos = viewState.getCameraPos();
-        std::size_t coordIndex = 0;
+        // Split draw datas into chunks that fit into a single buffer
+        std::size_t maxBufferSize = GLContext::GetMaxVertexBufferSize();
+        std::size_t firstDrawData = 0;
+        std::size_t lastDrawData = 0;
+        std::size_t chunkVertexCount = 0;
+        cglib::bbox3<double> chunkBounds = cglib::bbox3<double>::smallest();
+        auto drawChunk = [&]() {
+            // Chunks are requested even when not visible, so that the cached chunks stay matched between frames
+            std::vector<std::shared_ptr<const void> > chunkDrawDatas(drawDataBuffer.begin() + firstDrawData, drawDataBuffer.begin() + lastDrawData + 1);
+            bool valid = false;
+            VertexBufferCache::Chunk& chunk = bufferCache.bindChunk(chunkDrawDatas, 0, 0, valid);
+            if (!valid) {
+                BuildChunkBuffers(colorBuf, attribBuf, coordBuf, coordLowBuf, normalBuf, indexBuf, drawDataBuffer, firstDrawData, lastDrawData, chunk);
+                bufferCache.uploadIndices(chunk, indexBuf);
+            }
+            if (!viewState.getFrustum().inside(chunkBounds)) {
+                return;
+            }
+
+            // Buffer layout: coords, low parts of coords, normals, colors, attribs
+            std::size_t vertexCount = chunk.vertexCount;
+            glVertexAttribPointer(a_coord, 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<const GLvoid*>(0));
+            glVertexAttribPointer(a_coordLow, 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<const GLvoid*>(vertexCount * 3 * sizeof(float)));
+            glVertexAttribPointer(a_normal, 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<const GLvoid*>(vertexCount * 6 * sizeof(float)));
+            glVertexAttribPointer(a_color, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, reinterpret_cast<const GLvoid*>(vertexCount * 9 * sizeof(float)));
+            glVertexAttribPointer(a_attrib, 1, GL_UNSIGNED_BYTE, GL_FALSE, 0, reinterpret_cast<const GLvoid*>(vertexCount * (9 * sizeof(float) + 4)));
+            VertexBufferCache::DrawChunk(chunk);
+        };
         for (std::size_t i = 0; i < drawDataBuffer.size(); i++) {
-            const std::shared_ptr<Polygon3DDrawData>& drawData = drawDataBuffer[i];
-            
-            const std::vector<cglib::vec3<double> >& coords = drawData->getCoords();
-            if (coords.size() > GLContext::MAX_VERTEXBUFFER_SIZE) {
+            const Polygon3DDrawData* drawData = drawDataBuffer[i].get();
+            std::size_t vertexCount = drawData->getCoords().size();
+            if (vertexCount > maxBufferSize) {
                 Log::Error("Polygon3DRenderer::BuildAndDrawBuffers: Maximum buffer size exceeded, 3d polygon can't be drawn");
                 continue;
             }
-    
-            // Check for possible overflow in the buffers
-            if (coordIndex + coords.size() > GLContext::MAX_VERTEXBUFFER_SIZE) {
-                // If it doesn't fit, stop and draw the buffers
-                glVertexAttribPointer(a_color, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, colorBuf.data());
-                glVertexAttribPointer(a_attrib, 1, GL_UNSIGNED_BYTE, GL_FALSE, 0, attribBuf.data());
-                glVertexAttribPointer(a_coord, 3, GL_FLOAT, GL_FALSE, 0, coordBuf.data());
-                glVertexAttribPointer(a_normal, 3, GL_FLOAT, GL_FALSE, 0, normalBuf.data());
-                glDrawArrays(GL_TRIANGLES, 0, coordIndex);
-                // Start filling buffers from the beginning
-                coordIndex = 0;
+            if (chunkVertexCount > 0 && chunkVertexCount + vertexCount > maxBufferSize) {
+                // If it doesn't fit, draw the current chunk and start a new one
+                drawChunk();
+                chunkVertexCount = 0;
+                chunkBounds = cglib::bbox3<double>::smallest();
             }
-    
-            // Coords and colors
+            if (chunkVertexCount == 0) {
+                firstDrawData = i;
+            }
+            lastDrawData = i;
+            chunkVertexCount += vertexCount;
+            chunkBounds.add(drawData->getBoundingBox());
+        }
+
+        // Draw the final chunk
+        if (chunkVertexCount > 0) {
+            drawChunk();
+        }
+    }
+
+    void Polygon3DRenderer::BuildChunkBuffers(std::vector<unsigned char>& colorBuf,
+                                              std::vector<unsigned char>& attribBuf,
+                                              std::vector<float>& coordBuf,
+                                              std::vector<float>& coordLowBuf,
+                                              std::vector<float>& normalBuf,
+                                              std::vector<unsigned int>& indexBuf,
+                                              const std::vector<std::shared_ptr<Polygon3DDrawData> >& drawDataBuffer,
+                                              std::size_t firstDrawData,
+                                              std::size_t lastDrawData,
+                                              VertexBufferCache::Chunk& chunk)
+    {
+        colorBuf.clear();
+        attribBuf.clear();
+        coordBuf.clear();
+        coordLowBuf.clear();
+        normalBuf.clear();
+        indexBuf.clear();
+
+        for (std::size_t i = firstDrawData; i <= lastDrawData; i++) {
+            const Polygon3DDrawData* drawData = drawDataBuffer[i].get();
+            const std::vector<cglib::vec3<double> >& coords = drawData->getCoords();
+            if (coords.size() > GLContext::GetMaxVertexBufferSize()) {
+                continue;
+            }
+
+            // Coords, normals and colors. Coords are split into high and low parts for relative-to-eye rendering in the shader
             const Color& color = drawData->getColor();
             const Color& sideColor = drawData->getSideColor();
             const std::vector<cglib::vec3<float> >& normals = drawData->getNormals();
             const std::vector<unsigned char>& attribs = drawData->getAttribs();
-            std::vector<cglib::vec3<double> >::const_iterator cit = coords.begin();
-            std::vector<cglib::vec3<float> >::const_iterator nit = normals.begin();
-            std::vector<unsigned char>::const_iterator ait = attribs.begin();
-            for (; cit != coords.end() && nit != normals.end(); ++cit, ++nit, ait++) {
-                if (*ait) {
-                    colorBuf[coordIndex * 4 + 0] = color.getR();
-                    colorBuf[coordIndex * 4 + 1] = color.getG();
-                    colorBuf[coordIndex * 4 + 2] = color.getB();
-                    colorBuf[coordIndex * 4 + 3] = color.getA();
-                    attribBuf[coordIndex] = 1;
-                } else {
-                    colorBuf[coordIndex * 4 + 0] = sideColor.getR();
-                    colorBuf[coordIndex * 4 + 1] = sideColor.getG();
-                    colorBuf[coordIndex * 4 + 2] = sideColor.getB();
-                    colorBuf[coordIndex * 4 + 3] = sideColor.getA();
-                    attribBuf[coordIndex] = 0;
-                }
+            for (std::size_t j = 0; j < coords.size() && j < normals.size(); j++) {
+                const Color& vertexColor = (attribs[j] ? color : sideColor);
+                colorBuf.push_back(vertexColor.getR());
+                colorBuf.push_back(vertexColor.getG());
+                colorBuf.push_back(vertexColor.getB());
+                colorBuf.push_back(vertexColor.getA());
+                attribBuf.push_back(attribs[j] ? 1 : 0);
 
-                const cglib::vec3<double>& coord = *cit;
-                coordBuf[coordIndex * 3 + 0] = static_cast<float>(coord(0) - cameraPos(0));
-                coordBuf[coordIndex * 3 + 1] = static_cast<float>(coord(1) - cameraPos(1));
-                coordBuf[coordIndex * 3 + 2] = static_cast<float>(coord(2) - cameraPos(2));
-                
-                const cglib::vec3<float>& normal = *nit;
-                normalBuf[coordIndex * 3 + 0] = normal(0);
-                normalBuf[coordIndex * 3 + 1] = normal(1);
-                normalBuf[coordIndex * 3 + 2] = normal(2);
+                for (int k = 0; k < 3; k++) {
+                    float high = static_cast<float>(coords[j](k));
+                    coordBuf.push_back(high);
+                    coordLowBuf.push_back(static_cast<float>(coords[j](k) - high));
+                    normalBuf.push_back(normals[j](k));
+                }
 
-                coordIndex++;
+                // Triangles are not indexed, use the vertex order
+                indexBuf.push_back(static_cast<unsigned int>(indexBuf.size()));
             }
         }
-    
-        // Draw the buffers
-        if (coordIndex > 0) {
-            glVertexAttribPointer(a_color, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, colorBuf.data());
-            glVertexAttribPointer(a_attrib, 1, GL_UNSIGNED_BYTE, GL_FALSE, 0, attribBuf.data());
-            glVertexAttribPointer(a_coord, 3, GL_FLOAT, GL_FALSE, 0, coordBuf.data());
-            glVertexAttribPointer(a_normal, 3, GL_FLOAT, GL_FALSE, 0, normalBuf.data());
-            glDrawArrays(GL_TRIANGLES, 0, coordIndex);
-        }
+
+        // Upload the buffers, chunk buffers are already bound
+        std::size_t vertexCount = coordBuf.size() / 3;
+        glBufferData(GL_ARRAY_BUFFER, vertexCount * (9 * sizeof(float) + 5), nullptr, GL_STATIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, vertexCount * 3 * sizeof(float), coordBuf.data());
+        glBufferSubData(GL_ARRAY_BUFFER, vertexCount * 3 * sizeof(float), vertexCount * 3 * sizeof(float), coordLowBuf.data());
+        glBufferSubData(GL_ARRAY_BUFFER, vertexCount * 6 * sizeof(float), vertexCount * 3 * sizeof(float), normalBuf.data());
+        glBufferSubData(GL_ARRAY_BUFFER, vertexCount * 9 * sizeof(float), vertexCount * 4, colorBuf.data());
+        glBufferSubData(GL_ARRAY_BUFFER, vertexCount * (9 * sizeof(float) + 4), vertexCount * 1, attribBuf.data());
+
+        chunk.vertexCount = vertexCount;
     }
         
     void Polygon3DRenderer::drawBatch(const ViewState& viewState) {
         // Draw the draw datas, multiple passes may be necessary
-        BuildAndDrawBuffers(_a_color, _a_attrib, _a_coord, _a_normal, _colorBuf, _attribBuf, _coordBuf, _normalBuf, _drawDataBuffer, viewState);
+        BuildAndDrawBuffers(_a_color, _a_attrib, _a_coord, _a_coordLow, _a_normal, _colorBuf, _attribBuf, _coordBuf, _coordLowBuf, _normalBuf, _indexBuf, _drawDataBuffer, _bufferCache, viewState);
+        VertexBufferCache::UnbindBuffers();
     }
 
     const std::string Polygon3DRenderer::POLYGON3D_VERTEX_SHADER = R"GLSL(
         #version 100
         attribute vec4 a_color;
-        attribute vec4 a_coord;
+        attribute vec3 a_coord;
+        attribute vec3 a_coordLow;
         attribute float a_attrib;
         attribute vec3 a_normal;
         uniform vec4 u_ambientColor;
         uniform vec4 u_lightColor;
         uniform vec3 u_lightDir;
+        uniform vec3 u_cameraPosHigh;
+        uniform vec3 u_cameraPosLow;
         uniform mat4 u_mvpMat;
         varying vec4 v_color;
         void main() {
             float dotProduct = max(0.0, dot(a_normal, u_lightDir));
             vec3 lighting = vec3(a_attrib, a_attrib, a_attrib) + (u_ambientColor.rgb + u_lightColor.rgb * dotProduct) * (1.0 - a_attrib);
             v_color = a_color * vec4(lighting, 1.0);
-            gl_Position = u_mvpMat * a_coord;
+            vec3 coord = (a_coord - u_cameraPosHigh) + (a_coordLow - u_cameraPosLow);
+            gl_Position = u_mvpMat * vec4(coord, 1.0);
         }
     )GLSL";
 
@@ -8,6 +8,7 @@
 #define _CARTO_POLYGON3DRENDERER_H_
 
 #include "graphics/utils/GLContext.h"
+#include "renderers/components/VertexBufferCache.h"
 
 #include <deque>
 #include <memory>
@@ -54,13 +55,28 @@ namespace carto {
         static void BuildAndDrawBuffers(GLuint a_color,
                                         GLuint a_attrib,
                                         GLuint a_coord,
+                                        GLuint a_coordLow,
                                         GLuint a_normal,
                                         std::vector<unsigned char>& colorBuf,
                                         std::vector<unsigned char>& attribBuf,
                                         std::vector<float>& coordBuf,
+                                        std::vector<float>& coordLowBuf,
                                         std::vector<float>& normalBuf,
+                                        std::vector<unsigned int>& indexBuf,
                                         std::vector<std::shared_ptr<Polygon3DDrawData> >& drawDataBuffer,
+                                        VertexBufferCache& bufferCache,
                                         const ViewState& viewState);
+
+        static void BuildChunkBuffers(std::vector<unsigned char>& colorBuf,
+                                      std::vector<unsigned char>& attribBuf,
+                                      std::vector<float>& coordBuf,
+                                      std::vector<float>& coordLowBuf,
+                                      std::vector<float>& normalBuf,
+                                      std::vector<unsigned int>& indexBuf,
+                                      const std::vector<std::shared_ptr<Polygon3DDrawData> >& drawDataBuffer,
+                                      std::size_t firstDrawData,
+                                      std::size_t lastDrawData,
+                                      VertexBufferCache::Chunk& chunk);
         
         void drawBatch(const ViewState& viewState);
         
@@ -75,17 +91,24 @@ namespace carto {
         std::vector<unsigned char> _colorBuf;
         std::vector<unsigned char> _attribBuf;
         std::vector<float> _coordBuf;
+        std::vector<float> _coordLowBuf;
         std::vector<float> _normalBuf;
+        std::vector<unsigned int> _indexBuf;
     
         std::shared_ptr<Shader> _shader;
         GLuint _a_color;
         GLuint _a_attrib;
         GLuint _a_coord;
+        GLuint _a_coordLow;
         GLuint _a_normal;
         GLuint _u_ambientColor;
         GLuint _u_lightColor;
         GLuint _u_lightDir;
+        GLuint _u_cameraPosHigh;
+        GLuint _u_cameraPosLow;
         GLuint _u_mvpMat;
+
+        VertexBufferCache _bufferCache;
     
         std::weak_ptr<Options> _options;
         
@@ -26,11 +26,18 @@ namespace carto {
         _prevBitmap(nullptr),
         _colorBuf(),
         _coordBuf(),
+        _coordLowBuf(),
         _indexBuf(),
         _shader(),
         _a_color(0),
         _a_coord(0),
+        _a_coordLow(0),
+        _u_cameraPosHigh(0),
+        _u_cameraPosLow(0),
         _u_mvpMat(0),
+        _bufferCache(),
+        _pickIndex(),
+        _lineRenderer(),
         _mutex()
     {
     }
@@ -46,6 +53,10 @@ namespace carto {
             element->getDrawData()->offsetHorizontally(offset);
         }
 
+        // Draw data coordinates were modified in place, buffers and the pick index must be rebuilt
+        _bufferCache.invalidate();
+        _pickIndex.invalidate();
+
         _lineRenderer.offsetLayerHorizontally(offset);
     }
     
@@ -58,13 +69,20 @@ namespace carto {
         glUseProgram(_shader->getProgId());
         _a_color = _shader->getAttribLoc("a_color");
         _a_coord = _shader->getAttribLoc("a_coord");
+        _a_coordLow = _shader->getAttribLoc("a_coordLow");
+        _u_cameraPosHigh = _shader->getUniformLoc("u_cameraPosHigh");
+        _u_cameraPosLow = _shader->getUniformLoc("u_cameraPosLow");
         _u_mvpMat = _shader->getUniformLoc("u_mvpMat");
 
+        // Buffers of the previous context are no longer valid
+        _bufferCache.reset();
+
         // Drop elements
         std::vector<std::shared_ptr<Polygon>> elements;
         {
             std::lock_guard<std::mutex> lock(_mutex);
             std::swap(elements, _elements);
+            _pickIndex.invalidate();
         }
         for (const std::shared_ptr<Polygon>& element : elements) {
             element->setDrawData(std::shared_ptr<PolygonDrawData>());
@@ -77,7 +95,11 @@ namespace carto {
         std::lock_guard<std::mutex> lock(_mutex);
         
         if (_elements.empty()) {
-            // Early return, to avoid calling glUseProgram etc.
+            // Release the buffers of the removed elements. Early return, to avoid calling glUseProgram etc.
+            _bufferCache.beginFrame();
+            _bufferCache.endFrame();
+            _lineRenderer._bufferCache.beginFrame();
+            _lineRenderer._bufferCache.endFrame();
             return;
         }
 
@@ -86,13 +108,25 @@ namespace carto {
         bind(viewState);
     
         // Draw, batch polygons with the same bitmap and no line style
+        _bufferCache.beginFrame();
+        _lineRenderer._bufferCache.beginFrame();
         for (const std::shared_ptr<Polygon>& element : _elements) {
             addToBatch(element->getDrawData(), styleCache, viewState);
         }
         drawBatch(styleCache, viewState);
+        _lineRenderer._bufferCache.endFrame();
+        _bufferCache.endFrame();
         
         unbind();
 
+        // Rebuild the pick index for click handling if the view or the elements have changed
+        if (!_pickIndex.isValid(viewState)) {
+            _pickIndex.reset(viewState);
+            for (std::size_t i = 0; i < _elements.size(); i++) {
+                _pickIndex.add(i, _elements[i]->getDrawData()->getBoundingBox());
+            }
+        }
+
         glEnable(GL_CULL_FACE);
     
         GLContext::CheckGLError("PolygonRenderer::onDrawFrame");
@@ -100,6 +134,7 @@ namespace carto {
     
     void PolygonRenderer::onSurfaceDestroyed() {
         _shader.reset();
+        _bufferCache.reset();
 
         _lineRenderer.onSurfaceDestroyed();
     }
@@ -114,6 +149,7 @@ namespace carto {
         std::lock_guard<std::mutex> lock(_mutex);
         _elements.clear();
         _elements.swap(_tempElements);
+        _pickIndex.invalidate();
     }
         
     void PolygonRenderer::updateElement(const std::shared_ptr<Polygon>& element) {
@@ -123,15 +159,27 @@ namespace carto {
                 _elements.push_back(element);
             }
         }
+        _pickIndex.invalidate();
     }
     
     void PolygonRenderer::removeElement(const std::shared_ptr<Polygon>& element) {
         std::lock_guard<std::mutex> lock(_mutex);
         _elements.erase(std::remove(_elements.begin(), _elements.end(), element), _elements.end());
+        _pickIndex.invalidate();
     }
     
     void PolygonRenderer::calculateRayIntersectedElements(const std::shared_ptr<VectorLayer>& layer, const cglib::ray3<double>& ray, const ViewState& viewState, std::vector<RayIntersectedElement>& results) const {
         std::lock_guard<std::mutex> lock(_mutex);
+
+        // Test only the elements near the click position if the pick index of the last frame matches the view
+        std::vector<std::size_t> candidateIndices;
+        if (_pickIndex.query(ray, viewState, candidateIndices)) {
+            for (std::size_t index : candidateIndices) {
+                const std::shared_ptr<Polygon>& element = _elements[index];
+                FindElementRayIntersection(element, element->getDrawData(), layer, ray, viewState, results);
+            }
+            return;
+        }
     
         for (const std::shared_ptr<Polygon>& element : _elements) {
             FindElementRayIntersection(element, element->getDrawData(), layer, ray, viewState, results);
@@ -140,92 +188,126 @@ namespace carto {
     
     void PolygonRenderer::BuildAndDrawBuffers(GLuint a_color,
                                               GLuint a_coord,
+                                              GLuint a_coordLow,
                                               std::vector<unsigned char>& colorBuf,
                                               std::vector<float>& coordBuf,
-                                              std::vector<unsigned short>& indexBuf,
+                                              std::vector<float>& coordLowBuf,
+                                              std::vector<unsigned int>& indexBuf,
                                               std::vector<std::shared_ptr<PolygonDrawData> >& drawDataBuffer,
+                                              VertexBufferCache& bufferCache,
                                               StyleTextureCache& styleCache,
                                               const ViewState& viewState)
     {
-        // Calculate buffer size
-        std::size_t totalCoordCount = 0;
-        std::size_t totalIndexCount = 0;
-        for (const std::shared_ptr<PolygonDrawData>& drawData : drawDataBuffer) {
-            for (std::size_t i = 0; i < drawData->getCoords().size(); i++) {
-                const std::vector<cglib::vec3<double> >& coords = drawData->getCoords()[i];
-                const std::vector<unsigned int>& indices = drawData->getIndices()[i];
-                totalCoordCount += coords.size();
-                totalIndexCount += indices.size();
+        // Split draw data vertex parts into chunks that fit into a single buffer
+        std::size_t maxBufferSize = GLContext::GetMaxVertexBufferSize();
+        std::size_t firstDrawData = 0;
+        std::size_t firstPart = 0;
+        std::size_t lastDrawData = 0;
+        std::size_t endPart = 0;
+        std::size_t chunkIndexCount = 0;
+        auto drawChunk = [&]() {
+            std::vector<std::shared_ptr<const void> > chunkDrawDatas(drawDataBuffer.begin() + firstDrawData, drawDataBuffer.begin() + lastDrawData + 1);
+            bool valid = false;
+            VertexBufferCache::Chunk& chunk = bufferCache.bindChunk(chunkDrawDatas, firstPart, endPart, valid);
+            if (!valid) {
+                BuildChunkBuffers(colorBuf, coordBuf, coordLowBuf, indexBuf, drawDataBuffer, firstDrawData, firstPart, lastDrawData, endPart, chunk);
+                bufferCache.uploadIndices(chunk, indexBuf);
             }
-        }
-    
-        // Resize the buffers, if necessary
-        if (coordBuf.size() < totalCoordCount * 3) {
-            colorBuf.resize(std::min(totalCoordCount * 4, GLContext::MAX_VERTEXBUFFER_SIZE * 4));
-            coordBuf.resize(std::min(totalCoordCount * 3, GLContext::MAX_VERTEXBUFFER_SIZE * 3));
-        }
-    
-        if (indexBuf.size() < totalIndexCount) {
-            indexBuf.resize(std::min(totalIndexCount, GLContext::MAX_VERTEXBUFFER_SIZE));
-        }
-    
-        // View state specific data
-        cglib::vec3<double> cameraPos = viewState.getCameraPos();
-        std::size_t colorIndex = 0;
-        std::size_t coordIndex = 0;
-        std::size_t indexIndex = 0;
-        for (const std::shared_ptr<PolygonDrawData>& drawData : drawDataBuffer) {
-            // Draw data vertex info may be split into multiple buffers, draw each one
-            for (std::size_t i = 0; i < drawData->getCoords().size(); i++) {
-                // Check for possible overflow in the buffers
-                const std::vector<cglib::vec3<double> >& coords = drawData->getCoords()[i];
-                const std::vector<unsigned int>& indices = drawData->getIndices()[i];
-                if (indices.size() > GLContext::MAX_VERTEXBUFFER_SIZE) {
+
+            // Buffer layout: coords, low parts of coords, colors
+            std::size_t vertexCount = chunk.vertexCount;
+            glVertexAttribPointer(a_coord, 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<const GLvoid*>(0));
+            glVertexAttribPointer(a_coordLow, 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<const GLvoid*>(vertexCount * 3 * sizeof(float)));
+            glVertexAttribPointer(a_color, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, reinterpret_cast<const GLvoid*>(vertexCount * 6 * sizeof(float)));
+            VertexBufferCache::DrawChunk(chunk);
+        };
+        for (std::size_t i = 0; i < drawDataBuffer.size(); i++) {
+            const PolygonDrawData* drawData = drawDataBuffer[i].get();
+            for (std::size_t j = 0; j < drawData->getIndices().size(); j++) {
+                std::size_t indexCount = drawData->getIndices()[j].size();
+                if (indexCount > maxBufferSize) {
                     Log::Error("PolygonRenderer::BuildAndDrawBuffers: Maximum buffer size exceeded, polygon can't be drawn");
                     continue;
                 }
-                if (indexIndex + indices.size() > GLContext::MAX_VERTEXBUFFER_SIZE) {
-                    // If it doesn't fit, stop and draw the buffers
-                    glVertexAttribPointer(a_coord, 3, GL_FLOAT, GL_FALSE, 0, coordBuf.data());
-                    glVertexAttribPointer(a_color, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, colorBuf.data());
-                    glDrawElements(GL_TRIANGLES, indexIndex, GL_UNSIGNED_SHORT, indexBuf.data());
+                if (chunkIndexCount > 0 && chunkIndexCount + indexCount > maxBufferSize) {
+                    // If it doesn't fit, draw the current chunk and start a new one
+                    drawChunk();
+                    chunkIndexCount = 0;
+                }
+                if (chunkIndexCount == 0) {
+                    firstDrawData = i;
+                    firstPart = j;
+                }
+                lastDrawData = i;
+                endPart = j + 1;
+                chunkIndexCount += indexCount;
+            }
+        }
+        
+        // Draw the final chunk
+        if (chunkIndexCount > 0) {
+            drawChunk();
+        }
+    }
+
+    void PolygonRenderer::BuildChunkBuffers(std::vector<unsigned char>& colorBuf,
+                                            std::vector<float>& coordBuf,
+                                            std::vector<float>& coordLowBuf,
+                                            std::vector<unsigned int>& indexBuf,
+                                            const std::vector<std::shared_ptr<PolygonDrawData> >& drawDataBuffer,
+                                            std::size_t firstDrawData,
+                                            std::size_t firstPart,
+                                            std::size_t lastDrawData,
+                                            std::size_t endPart,
+                                            VertexBufferCache::Chunk& chunk)
+    {
+        colorBuf.clear();
+        coordBuf.clear();
+        coordLowBuf.clear();
+        indexBuf.clear();
+
+        for (std::size_t i = firstDrawData; i <= lastDrawData; i++) {
+            const PolygonDrawData* drawData = drawDataBuffer[i].get();
+            const Color& color = drawData->getColor();
 
-                    // Start filling buffers from the beginning
-                    colorIndex = 0;
-                    coordIndex = 0;
-                    indexIndex = 0;
+            std::size_t partBegin = (i == firstDrawData ? firstPart : 0);
+            std::size_t partEnd = (i == lastDrawData ? endPart : drawData->getCoords().size());
+            for (std::size_t j = partBegin; j < partEnd; j++) {
+                const std::vector<unsigned int>& indices = drawData->getIndices()[j];
+                if (indices.size() > GLContext::GetMaxVertexBufferSize()) {
+                    continue;
                 }
-                
+
                 // Indices
-                unsigned short indexOffset = static_cast<unsigned short>(coordIndex / 3); // invariant: indexOffset <= indexIndex
-                for (unsigned short index : indices) {
-                    indexBuf[indexIndex] = indexOffset + index;
-                    indexIndex++;
+                std::size_t indexOffset = coordBuf.size() / 3;
+                for (unsigned int index : indices) {
+                    indexBuf.push_back(static_cast<unsigned int>(indexOffset + index));
                 }
                 
-                // Colors and coords
-                const Color& color = drawData->getColor();
-                for (const cglib::vec3<double>& pos : coords) {
-                    colorBuf[colorIndex + 0] = color.getR();
-                    colorBuf[colorIndex + 1] = color.getG();
-                    colorBuf[colorIndex + 2] = color.getB();
-                    colorBuf[colorIndex + 3] = color.getA();
-                    colorIndex += 4;
-                    
-                    coordBuf[coordIndex + 0] = static_cast<float>(pos(0) - cameraPos(0));
-                    coordBuf[coordIndex + 1] = static_cast<float>(pos(1) - cameraPos(1));
-                    coordBuf[coordIndex + 2] = static_cast<float>(pos(2) - cameraPos(2));
-                    coordIndex += 3;
+                // Colors and coords. Coords are split into high and low parts for relative-to-eye rendering in the shader
+                for (const cglib::vec3<double>& pos : drawData->getCoords()[j]) {
+                    colorBuf.push_back(color.getR());
+                    colorBuf.push_back(color.getG());
+                    colorBuf.push_back(color.getB());
+                    colorBuf.push_back(color.getA());
+
+                    for (int k = 0; k < 3; k++) {
+                        float high = static_cast<float>(pos(k));
+                        coordBuf.push_back(high);
+                        coordLowBuf.push_back(static_cast<float>(pos(k) - high));
+                    }
                 }
             }
         }
-        
-        // Draw buffers
-        if (indexIndex > 0) {
-            glVertexAttribPointer(a_color, 4, GL_UNSIGNED_BYTE, GL_TRUE, 0, colorBuf.data());
-            glVertexAttribPointer(a_coord, 3, GL_FLOAT, GL_FALSE, 0, coordBuf.data());
-            glDrawElements(GL_TRIANGLES, indexIndex, GL_UNSIGNED_SHORT, indexBuf.data());
-        }
+
+        // Upload the buffers, chunk buffers are already bound
+        std::size_t vertexCount = coordBuf.size() / 3;
+        glBufferData(GL_ARRAY_BUFFER, vertexCount * (6 * sizeof(float) + 4), nullptr, GL_STATIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, vertexCount * 3 * sizeof(float), coordBuf.data());
+        glBufferSubData(GL_ARRAY_BUFFER, vertexCount * 3 * sizeof(float), vertexCount * 3 * sizeof(float), coordLowBuf.data());
+        glBufferSubData(GL_ARRAY_BUFFER, vertexCount * 6 * sizeof(float), vertexCount * 4, colorBuf.data());
+
+        chunk.vertexCount = vertexCount;
     }
     
     bool PolygonRenderer::FindElementRayIntersection(const std::shared_ptr<VectorElement>& element,
@@ -262,6 +344,13 @@ namespace carto {
         // Colors, Coords
         glEnableVertexAttribArray(_a_color);
         glEnableVertexAttribArray(_a_coord);
+        glEnableVertexAttribArray(_a_coordLow);
+        // Camera position, split into high and low parts
+        cglib::vec3<double> cameraPos = viewState.getCameraPos();
+        cglib::vec3<float> cameraPosHigh(static_cast<float>(cameraPos(0)), static_cast<float>(cameraPos(1)), static_cast<float>(cameraPos(2)));
+        cglib::vec3<float> cameraPosLow(static_cast<float>(cameraPos(0) - cameraPosHigh(0)), static_cast<float>(cameraPos(1) - cameraPosHigh(1)), static_cast<float>(cameraPos(2) - cameraPosHigh(2)));
+        glUniform3fv(_u_cameraPosHigh, 1, cameraPosHigh.data());
+        glUniform3fv(_u_cameraPosLow, 1, cameraPosLow.data());
         // Matrix
         const cglib::mat4x4<float>& mvpMat = viewState.getRTEModelviewProjectionMat();
         glUniformMatrix4fv(_u_mvpMat, 1, GL_FALSE, mvpMat.data());
@@ -271,6 +360,7 @@ namespace carto {
         // Disable bound arrays
         glDisableVertexAttribArray(_a_color);
         glDisableVertexAttribArray(_a_coord);
+        glDisableVertexAttribArray(_a_coordLow);
     }
     
     bool PolygonRenderer::isEmptyBatch() const {
@@ -313,7 +403,8 @@ namespace carto {
         }
 
         // Build buffers and draw
-        BuildAndDrawBuffers(_a_color, _a_coord, _colorBuf, _coordBuf, _indexBuf, _drawDataBuffer, styleCache, viewState);
+        BuildAndDrawBuffers(_a_color, _a_coord, _a_coordLow, _colorBuf, _coordBuf, _coordLowBuf, _indexBuf, _drawDataBuffer, _bufferCache, styleCache, viewState);
+        VertexBufferCache::UnbindBuffers();
         
         _drawDataBuffer.clear();
         _prevBitmap = nullptr;
@@ -321,13 +412,17 @@ namespace carto {
     
     const std::string PolygonRenderer::POLYGON_VERTEX_SHADER = R"GLSL(
         #version 100
-        attribute vec4 a_coord;
+        attribute vec3 a_coord;
+        attribute vec3 a_coordLow;
         attribute vec4 a_color;
         varying vec4 v_color;
+        uniform vec3 u_cameraPosHigh;
+        uniform vec3 u_cameraPosLow;
         uniform mat4 u_mvpMat;
         void main() {
+            vec3 coord = (a_coord - u_cameraPosHigh) + (a_coordLow - u_cameraPosLow);
             v_color = a_color;
-            gl_Position = u_mvpMat * a_coord;
+            gl_Position = u_mvpMat * vec4(coord, 1.0);
         }
     )GLSL";
 
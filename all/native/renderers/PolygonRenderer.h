@@ -9,6 +9,8 @@
 
 #include "graphics/utils/GLContext.h"
 #include "renderers/LineRenderer.h"
+#include "renderers/components/ScreenPickIndex.h"
+#include "renderers/components/VertexBufferCache.h"
 
 #include <deque>
 #include <memory>
@@ -55,12 +57,26 @@ namespace carto {
     private:
         static void BuildAndDrawBuffers(GLuint a_color,
                                         GLuint a_coord,
+                                        GLuint a_coordLow,
                                         std::vector<unsigned char>& colorBuf,
                                         std::vector<float>& coordBuf,
-                                        std::vector<unsigned short>& indexBuf,
+                                        std::vector<float>& coordLowBuf,
+                                        std::vector<unsigned int>& indexBuf,
                                         std::vector<std::shared_ptr<PolygonDrawData> >& drawDataBuffer,
+                                        VertexBufferCache& bufferCache,
                                         StyleTextureCache& styleCache,
                                         const ViewState& viewState);
+
+        static void BuildChunkBuffers(std::vector<unsigned char>& colorBuf,
+                                      std::vector<float>& coordBuf,
+                                      std::vector<float>& coordLowBuf,
+                                      std::vector<unsigned int>& indexBuf,
+                                      const std::vector<std::shared_ptr<PolygonDrawData> >& drawDataBuffer,
+                                      std::size_t firstDrawData,
+                                      std::size_t firstPart,
+                                      std::size_t lastDrawData,
+                                      std::size_t endPart,
+                                      VertexBufferCache::Chunk& chunk);
         
         static bool FindElementRayIntersection(const std::shared_ptr<VectorElement>& element,
                                                const std::shared_ptr<PolygonDrawData>& drawData,
@@ -87,13 +103,21 @@ namespace carto {
     
         std::vector<unsigned char> _colorBuf;
         std::vector<float> _coordBuf;
-        std::vector<unsigned short> _indexBuf;
+        std::vector<float> _coordLowBuf;
+        std::vector<unsigned int> _indexBuf;
     
         std::shared_ptr<Shader> _shader;
         GLuint _a_color;
         GLuint _a_coord;
+        GLuint _a_coordLow;
+        GLuint _u_cameraPosHigh;
+        GLuint _u_cameraPosLow;
         GLuint _u_mvpMat;
 
+        VertexBufferCache _bufferCache;
+
+        ScreenPickIndex _pickIndex;
+
         LineRenderer _lineRenderer;
     
         mutable std::mutex _mutex;
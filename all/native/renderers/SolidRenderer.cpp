@@ -100,6 +100,7 @@ namespace carto {
         glVertexAttribPointer(_a_coord, 3, GL_FLOAT, GL_FALSE, 0, QUAD_COORDS);
         glVertexAttribPointer(_a_texCoord, 2, GL_FLOAT, GL_FALSE, 0, _quadTexCoords);
         glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        GLContext::CountDrawCall(4);
 
         // Disable bound arrays
         glDisableVertexAttribArray(_a_coord);
@@ -45,12 +45,19 @@ namespace carto {
         _subTileBlending(true),
         _labelOrder(0),
         _buildingOrder(1),
-        _horizontalLayerOffset(0),
         _viewDir(0, 0, 0),
         _mainLightDir(0, 0, 0),
+        _sourceTiles(),
+        _mergedTileCache(),
+        _horizontalLayerOffset(0),
         _tiles(),
+        _pendingTiles(),
+        _pendingTilesOffset(0),
+        _visibleTiles(),
         _options(),
-        _mutex()
+        _mutex(),
+        _sourceTilesMutex(),
+        _snapshotMutex()
     {
     }
     
@@ -83,7 +90,7 @@ namespace carto {
     }
 
     void TileRenderer::offsetLayerHorizontally(double offset) {
-        std::lock_guard<std::mutex> lock(_mutex);
+        std::lock_guard<std::mutex> lock(_snapshotMutex);
         _horizontalLayerOffset += offset;
     }
     
@@ -123,8 +130,18 @@ namespace carto {
         );
         _glRenderer->initializeRenderer();
         _firstDraw = true;
-        _horizontalLayerOffset = 0;
-        _tiles.clear();
+        {
+            std::lock_guard<std::mutex> sourceLock(_sourceTilesMutex);
+            _sourceTiles.clear();
+            _mergedTileCache.clear();
+
+            std::lock_guard<std::mutex> snapshotLock(_snapshotMutex);
+            _horizontalLayerOffset = 0;
+            _tiles.reset();
+            _pendingTiles.reset();
+            _pendingTilesOffset = 0;
+        }
+        _visibleTiles.reset();
         GLContext::CheckGLError("TileRenderer::onSurfaceCreated");
     }
     
@@ -135,13 +152,35 @@ namespace carto {
             return false;
         }
 
-        cglib::mat4x4<double> modelViewMat = viewState.getModelviewMat() * cglib::translate4_matrix(cglib::vec3<double>(_horizontalLayerOffset, 0, 0));
+        // Take the latest tile snapshot published by the cull and fetch threads. The snapshot is
+        // swapped under a separate mutex, so the render thread never waits for tile processing
+        std::shared_ptr<const TileMap> pendingTiles;
+        double pendingTilesOffset = 0;
+        double horizontalLayerOffset = 0;
+        {
+            std::lock_guard<std::mutex> snapshotLock(_snapshotMutex);
+            if (_pendingTiles) {
+                std::swap(pendingTiles, _pendingTiles);
+                pendingTilesOffset = _pendingTilesOffset;
+                _horizontalLayerOffset -= _pendingTilesOffset;
+                _pendingTilesOffset = 0;
+            }
+            horizontalLayerOffset = _horizontalLayerOffset;
+        }
+        if (pendingTiles) {
+            // The renderer resets the label and blending state of the tiles, so skip identical tile sets. When the layer is offset the tiles must be reset
+            if (pendingTiles != _visibleTiles || pendingTilesOffset != 0) {
+                _glRenderer->setVisibleTiles(*pendingTiles, pendingTilesOffset == 0);
+                _visibleTiles = pendingTiles;
+            }
+        }
+
+        cglib::mat4x4<double> modelViewMat = viewState.getModelviewMat() * cglib::translate4_matrix(cglib::vec3<double>(horizontalLayerOffset, 0, 0));
         _glRenderer->setViewState(vt::ViewState(viewState.getProjectionMat(), modelViewMat, viewState.getZoom(), viewState.getAspectRatio(), viewState.getNormalizedResolution()));
         _glRenderer->setInteractionMode(_interactionMode);
         _glRenderer->setSubTileBlending(_subTileBlending);
 
         if (_firstDraw) {
-            _glRenderer->setVisibleTiles(_tiles, _horizontalLayerOffset == 0);
             _glRenderer->cullLabels(vt::ViewState(viewState.getProjectionMat(), modelViewMat, viewState.getZoom(), viewState.getAspectRatio(), viewState.getNormalizedResolution()));
             _firstDraw = false;
         }
@@ -213,6 +252,7 @@ namespace carto {
         }
 
         Log::Debug("TileRenderer: Surface destroyed");
+        _visibleTiles.reset();
 
         _glRenderer->resetRenderer();
         _glRenderer.reset();
@@ -227,6 +267,9 @@ namespace carto {
             if (!_firstDraw) {
                 glRenderer = _glRenderer;
             }
+        }
+        {
+            std::lock_guard<std::mutex> snapshotLock(_snapshotMutex);
             modelViewMat = viewState.getModelviewMat() * cglib::translate4_matrix(cglib::vec3<double>(_horizontalLayerOffset, 0, 0));
         }
 
@@ -238,26 +281,143 @@ namespace carto {
     }
     
     bool TileRenderer::refreshTiles(const std::vector<std::shared_ptr<TileDrawData> >& drawDatas) {
-        std::lock_guard<std::mutex> lock(_mutex);
+        return refreshTiles(0, drawDatas);
+    }
 
-        if (!_glRenderer) {
-            return false;
+    bool TileRenderer::refreshTiles(int source, const std::vector<std::shared_ptr<TileDrawData> >& drawDatas) {
+        std::lock_guard<std::mutex> sourceLock(_sourceTilesMutex);
+
+        if (source >= static_cast<int>(_sourceTiles.size())) {
+            _sourceTiles.resize(source + 1);
         }
 
-        std::map<vt::TileId, std::shared_ptr<const vt::Tile> > tiles;
+        // Compare the draw datas against the current tiles of the source first, the tile map is rebuilt only if the tiles have changed
+        TileMap& sourceTiles = _sourceTiles[source];
+        bool changed = false;
+        std::size_t matchCount = 0;
         for (const std::shared_ptr<TileDrawData>& drawData : drawDatas) {
-            tiles[drawData->getVTTileId()] = drawData->getVTTile();
+            auto it = sourceTiles.find(drawData->getVTTileId());
+            if (it == sourceTiles.end() || it->second != drawData->getVTTile()) {
+                changed = true;
+                break;
+            }
+            matchCount++;
+        }
+        if (matchCount != sourceTiles.size()) {
+            changed = true;
         }
+        if (changed) {
+            TileMap tiles;
+            for (const std::shared_ptr<TileDrawData>& drawData : drawDatas) {
+                tiles[drawData->getVTTileId()] = drawData->getVTTile();
+            }
+            changed = (tiles != sourceTiles);
+            if (changed) {
+                sourceTiles = std::move(tiles);
+            }
+        }
+        return publishTiles(changed);
+    }
+
+    void TileRenderer::resetTileSources() {
+        std::lock_guard<std::mutex> sourceLock(_sourceTilesMutex);
 
-        bool changed = (tiles != _tiles) || (_horizontalLayerOffset != 0);
+        if (_sourceTiles.size() > 1) {
+            _sourceTiles.resize(1);
+            publishTiles(true);
+        }
+    }
+
+    bool TileRenderer::publishTiles(bool changed) {
+        std::shared_ptr<const TileMap> tiles;
         if (changed) {
-            if (!_firstDraw) {
-                _glRenderer->setVisibleTiles(tiles, _horizontalLayerOffset == 0);
+            tiles = mergeSourceTiles();
+
+            // A change in one source may leave the merged tiles intact. The tiles are only replaced while holding the source mutex, so they can be compared here
+            if (_tiles && *tiles == *_tiles) {
+                tiles.reset();
+                changed = false;
+            }
+        }
+
+        // Publish the tiles as an immutable snapshot, the render thread picks up the latest one on the next frame.
+        // The snapshot remembers the layer offset, as the tiles are in unshifted coordinates
+        std::lock_guard<std::mutex> snapshotLock(_snapshotMutex);
+
+        if (!changed && _horizontalLayerOffset == 0) {
+            return false;
+        }
+        if (tiles || !_tiles) {
+            _tiles = tiles ? tiles : std::make_shared<const TileMap>();
+        }
+        _pendingTiles = _tiles;
+        _pendingTilesOffset = _horizontalLayerOffset;
+        return true;
+    }
+
+    std::shared_ptr<const TileRenderer::TileMap> TileRenderer::mergeSourceTiles() {
+        if (_sourceTiles.size() <= 1) {
+            _mergedTileCache.clear();
+            return std::make_shared<const TileMap>(_sourceTiles.empty() ? TileMap() : _sourceTiles.front());
+        }
+
+        std::map<vt::TileId, std::vector<std::shared_ptr<const vt::Tile> > > tileSources;
+        for (std::size_t i = 0; i < _sourceTiles.size(); i++) {
+            for (auto it = _sourceTiles[i].begin(); it != _sourceTiles[i].end(); it++) {
+                std::vector<std::shared_ptr<const vt::Tile> >& sourceTiles = tileSources[it->first];
+                sourceTiles.resize(_sourceTiles.size());
+                sourceTiles[i] = it->second;
+            }
+        }
+
+        // Reuse the merged tiles whose source tiles have not changed, so that the renderer can keep their GL resources
+        auto tiles = std::make_shared<TileMap>();
+        std::map<vt::TileId, std::pair<std::vector<std::shared_ptr<const vt::Tile> >, std::shared_ptr<const vt::Tile> > > mergedTileCache;
+        for (auto it = tileSources.begin(); it != tileSources.end(); it++) {
+            std::shared_ptr<const vt::Tile> tile;
+            auto cacheIt = _mergedTileCache.find(it->first);
+            if (cacheIt != _mergedTileCache.end() && cacheIt->second.first == it->second) {
+                tile = cacheIt->second.second;
+            } else {
+                tile = MergeTiles(it->first, it->second);
+            }
+            mergedTileCache[it->first] = std::make_pair(it->second, tile);
+            (*tiles)[it->first] = tile;
+        }
+        std::swap(_mergedTileCache, mergedTileCache);
+        return tiles;
+    }
+
+    std::shared_ptr<const vt::Tile> TileRenderer::MergeTiles(const vt::TileId& tileId, const std::vector<std::shared_ptr<const vt::Tile> >& sourceTiles) {
+        std::shared_ptr<const vt::Tile> baseTile;
+        int tileCount = 0;
+        for (const std::shared_ptr<const vt::Tile>& tile : sourceTiles) {
+            if (tile) {
+                if (!baseTile) {
+                    baseTile = tile;
+                }
+                tileCount++;
+            }
+        }
+        if (tileCount == 1 && baseTile == sourceTiles.front()) {
+            return baseTile;
+        }
+
+        // Merge the layers, keeping the source order. The layers of the owner layer keep their original indices
+        std::vector<std::shared_ptr<vt::TileLayer> > tileLayers;
+        for (std::size_t i = 0; i < sourceTiles.size(); i++) {
+            if (const std::shared_ptr<const vt::Tile>& tile = sourceTiles[i]) {
+                for (const std::shared_ptr<vt::TileLayer>& tileLayer : tile->getLayers()) {
+                    if (i == 0) {
+                        tileLayers.push_back(tileLayer);
+                    } else {
+                        int layerIdx = static_cast<int>(i * SOURCE_LAYER_INDEX_STRIDE) + tileLayer->getLayerIndex();
+                        tileLayers.push_back(std::make_shared<vt::TileLayer>(layerIdx, tileLayer->getCompOp(), tileLayer->getOpacityFunc(), tileLayer->getBitmaps(), tileLayer->getGeometries(), tileLayer->getLabels()));
+                    }
+                }
             }
-            _tiles = std::move(tiles);
-            _horizontalLayerOffset = 0;
         }
-        return changed;
+        return std::make_shared<const vt::Tile>(tileId, baseTile->getTileSize(), baseTile->getBackground(), tileLayers);
     }
 
     void TileRenderer::calculateRayIntersectedElements(const cglib::ray3<double>& ray, const ViewState& viewState, std::vector<std::tuple<vt::TileId, double, long long> >& results) const {
@@ -57,13 +57,23 @@ namespace carto {
         bool cullLabels(const ViewState& viewState);
 
         bool refreshTiles(const std::vector<std::shared_ptr<TileDrawData> >& drawDatas);
+        bool refreshTiles(int source, const std::vector<std::shared_ptr<TileDrawData> >& drawDatas);
+        void resetTileSources();
 
         void calculateRayIntersectedElements(const cglib::ray3<double>& ray, const ViewState& viewState, std::vector<std::tuple<vt::TileId, double, long long> >& results) const;
         void calculateRayIntersectedElements3D(const cglib::ray3<double>& ray, const ViewState& viewState, std::vector<std::tuple<vt::TileId, double, long long> >& results) const;
         void calculateRayIntersectedBitmaps(const cglib::ray3<double>& ray, const ViewState& viewState, std::vector<std::tuple<vt::TileId, double, vt::TileBitmap, cglib::vec2<float> > >& results) const;
     
     private:
+        typedef std::map<vt::TileId, std::shared_ptr<const vt::Tile> > TileMap;
+
+        bool publishTiles(bool changed);
+        std::shared_ptr<const TileMap> mergeSourceTiles();
+
+        static std::shared_ptr<const vt::Tile> MergeTiles(const vt::TileId& tileId, const std::vector<std::shared_ptr<const vt::Tile> >& sourceTiles);
+
         static const int CLICK_RADIUS = 4;
+        static const int SOURCE_LAYER_INDEX_STRIDE = 1 << 24; // NOTE: decoders use multiples of 65536 for layer groups, so sources need a larger stride
 
         static const std::string LIGHTING_SHADER_2D;
         static const std::string LIGHTING_SHADER_3D;
@@ -76,14 +86,23 @@ namespace carto {
         bool _subTileBlending;
         int _labelOrder;
         int _buildingOrder;
-        double _horizontalLayerOffset;
         cglib::vec3<float> _viewDir;
         cglib::vec3<float> _mainLightDir;
-        std::map<vt::TileId, std::shared_ptr<const vt::Tile> > _tiles;
+
+        std::vector<TileMap> _sourceTiles; // source 0 is the owner layer, other sources are layers sharing the renderer
+        std::map<vt::TileId, std::pair<std::vector<std::shared_ptr<const vt::Tile> >, std::shared_ptr<const vt::Tile> > > _mergedTileCache;
+
+        double _horizontalLayerOffset;
+        std::shared_ptr<const TileMap> _tiles;
+        std::shared_ptr<const TileMap> _pendingTiles;
+        double _pendingTilesOffset;
+        std::shared_ptr<const TileMap> _visibleTiles; // the tiles last passed to the GL renderer, only accessed from the render thread
 
         std::weak_ptr<Options> _options;
         
         mutable std::mutex _mutex;
+        mutable std::mutex _sourceTilesMutex; // guards source tiles and merged tile cache, always locked before the snapshot mutex
+        mutable std::mutex _snapshotMutex; // guards tile snapshot handoff and layer offset, held only for constant time operations
     };
     
 }
@@ -177,6 +177,7 @@ namespace carto {
         glVertexAttribPointer(_a_coord, 3, GL_FLOAT, GL_FALSE, 0, _watermarkCoords);
         glVertexAttribPointer(_a_texCoord, 2, GL_FLOAT, GL_FALSE, 0, _watermarkTexCoords);
         glDrawArrays(GL_TRIANGLE_STRIP, 0, sizeof(_watermarkCoords) / sizeof(float) / 3);
+        GLContext::CountDrawCall(sizeof(_watermarkCoords) / sizeof(float) / 3);
         // Disable bound arrays
         glDisableVertexAttribArray(_a_coord);
         glDisableVertexAttribArray(_a_texCoord);
@@ -107,6 +107,28 @@ namespace carto {
         _zoomDurationSeconds = 0;
     }
     
+    bool AnimationHandler::getPanTarget(MapPos& panTarget) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_panDurationSeconds <= 0 || _panUseDelta) {
+            return false;
+        }
+        panTarget = _panTarget;
+        return true;
+    }
+
+    bool AnimationHandler::getZoomTarget(float& zoomTarget, MapPos& targetPos, bool& useTargetPos) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_zoomDurationSeconds <= 0) {
+            return false;
+        }
+        zoomTarget = _zoomTarget;
+        useTargetPos = static_cast<bool>(_zoomTargetPos);
+        if (_zoomTargetPos) {
+            targetPos = *_zoomTargetPos;
+        }
+        return true;
+    }
+
     void AnimationHandler::calculatePan(const ViewState& viewState, float deltaSeconds) {
         // Disregard the first calculation event, because the deltaSeconds parameter may be
         // very large. It's caused by on-demand rendering.
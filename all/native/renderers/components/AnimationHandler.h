@@ -35,6 +35,9 @@ namespace carto {
         
         void setZoomTarget(float zoomTarget, const MapPos* targetPos, float durationSeconds);
         void stopZoom();
+
+        bool getPanTarget(MapPos& panTarget) const;
+        bool getZoomTarget(float& zoomTarget, MapPos& targetPos, bool& useTargetPos) const;
     
     private:
         void calculatePan(const ViewState& viewState, float deltaSeconds);
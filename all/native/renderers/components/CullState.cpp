@@ -2,15 +2,40 @@
 #include "components/Exceptions.h"
 #include "projections/Projection.h"
 #include "projections/EPSG3857.h"
+#include "projections/EPSG4326.h"
 #include "utils/GeomUtils.h"
 
 namespace carto {
     
     CullState::CullState(const MapEnvelope& envelope, const ViewState& viewState) :
         _envelope(envelope),
-        _viewState(viewState)
+        _viewState(std::make_shared<ViewState>(viewState)),
+        _predictedViewState(),
+        _projectionEnvelopes(),
+        _projectionEnvelopesMutex()
     {
     }
+
+    CullState::CullState(const MapEnvelope& envelope, const ViewState& viewState, const std::shared_ptr<ViewState>& predictedViewState) :
+        _envelope(envelope),
+        _viewState(std::make_shared<ViewState>(viewState)),
+        _predictedViewState(predictedViewState),
+        _projectionEnvelopes(),
+        _projectionEnvelopesMutex()
+    {
+    }
+
+    CullState::CullState(const MapEnvelope& envelope, const std::shared_ptr<const ViewState>& viewState, const std::shared_ptr<ViewState>& predictedViewState) :
+        _envelope(envelope),
+        _viewState(viewState),
+        _predictedViewState(predictedViewState),
+        _projectionEnvelopes(),
+        _projectionEnvelopesMutex()
+    {
+        if (!viewState) {
+            throw NullArgumentException("Null viewState");
+        }
+    }
         
     CullState::~CullState() {
     }
@@ -20,15 +45,57 @@ namespace carto {
             throw NullArgumentException("Null projection");
         }
 
-        std::vector<MapPos> mapPoses;
-        if (std::dynamic_pointer_cast<EPSG3857>(projection)) {
-            mapPoses.reserve(_envelope.getConvexHull().size());
-            for (const MapPos& mapPosInternal : _envelope.getConvexHull()) {
-                mapPoses.push_back(projection->fromInternal(mapPosInternal));
+        return getCachedProjectionEnvelope(projection);
+    }
+
+    MapBounds CullState::getProjectionBounds(const std::shared_ptr<Projection>& projection) const {
+        if (!projection) {
+            throw NullArgumentException("Null projection");
+        }
+
+        return getCachedProjectionEnvelope(projection).getBounds();
+    }
+    
+    const MapEnvelope& CullState::getEnvelope() const {
+        return _envelope;
+    }
+         
+    const ViewState& CullState::getViewState() const {
+        return *_viewState;
+    }
+
+    const std::shared_ptr<const ViewState>& CullState::getViewStateSnapshot() const {
+        return _viewState;
+    }
+
+    const std::shared_ptr<ViewState>& CullState::getPredictedViewState() const {
+        return _predictedViewState;
+    }
+
+    const MapEnvelope& CullState::getCachedProjectionEnvelope(const std::shared_ptr<Projection>& projection) const {
+        std::lock_guard<std::mutex> lock(_projectionEnvelopesMutex);
+
+        // Usually there are only a few different projections, so linear search is sufficient
+        for (const std::pair<std::shared_ptr<Projection>, std::shared_ptr<MapEnvelope> >& projectionEnvelope : _projectionEnvelopes) {
+            if (IsSameProjection(projectionEnvelope.first, projection)) {
+                return *projectionEnvelope.second;
             }
+        }
+
+        auto envelope = std::make_shared<MapEnvelope>(calculateProjectionEnvelope(*projection));
+        _projectionEnvelopes.emplace_back(projection, envelope);
+        return *envelope;
+    }
+
+    MapEnvelope CullState::calculateProjectionEnvelope(const Projection& projection) const {
+        std::vector<MapPos> mapPoses;
+        if (dynamic_cast<const EPSG3857*>(&projection)) {
+            const std::vector<MapPos>& convexHull = _envelope.getConvexHull();
+            mapPoses.resize(convexHull.size());
+            projection.fromInternal(convexHull.data(), mapPoses.data(), convexHull.size());
         } else {
-            MapPos minPos = projection->fromInternal(_envelope.getBounds().getMin());
-            MapPos maxPos = projection->fromInternal(_envelope.getBounds().getMax());
+            MapPos minPos = projection.fromInternal(_envelope.getBounds().getMin());
+            MapPos maxPos = projection.fromInternal(_envelope.getBounds().getMax());
             mapPoses.reserve(4);
             mapPoses.emplace_back(minPos.getX(), minPos.getY());
             mapPoses.emplace_back(minPos.getX(), maxPos.getY());
@@ -37,13 +104,19 @@ namespace carto {
         }
         return MapEnvelope(GeomUtils::CalculateConvexHull(mapPoses));
     }
-    
-    const MapEnvelope& CullState::getEnvelope() const {
-        return _envelope;
-    }
-         
-    const ViewState& CullState::getViewState() const {
-        return _viewState;
+
+    bool CullState::IsSameProjection(const std::shared_ptr<Projection>& projection1, const std::shared_ptr<Projection>& projection2) {
+        if (projection1 == projection2) {
+            return true;
+        }
+        // Builtin projections have no parameters, so all their instances are equivalent
+        if (std::dynamic_pointer_cast<EPSG3857>(projection1) && std::dynamic_pointer_cast<EPSG3857>(projection2)) {
+            return true;
+        }
+        if (std::dynamic_pointer_cast<EPSG4326>(projection1) && std::dynamic_pointer_cast<EPSG4326>(projection2)) {
+            return true;
+        }
+        return false;
     }
     
 }
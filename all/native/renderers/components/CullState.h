@@ -11,6 +11,8 @@
 #include "graphics/ViewState.h"
 
 #include <memory>
+#include <mutex>
+#include <utility>
 #include <vector>
 
 namespace carto {
@@ -28,14 +30,35 @@ namespace carto {
          * @param viewState The view state.
          */
         CullState(const MapEnvelope& envelope, const ViewState& viewState);
+        /** 
+         * Constructs a CullState object from an envelope, a viewstate and a predicted viewstate.
+         * @param envelope The envelope.
+         * @param viewState The view state.
+         * @param predictedViewState The view state at the end of the current camera animation or kinetic movement. Can be null.
+         */
+        CullState(const MapEnvelope& envelope, const ViewState& viewState, const std::shared_ptr<ViewState>& predictedViewState);
+        /** 
+         * Constructs a CullState object from an envelope, a shared viewstate snapshot and a predicted viewstate.
+         * @param envelope The envelope.
+         * @param viewState The immutable view state snapshot, shared without copying.
+         * @param predictedViewState The view state at the end of the current camera animation or kinetic movement. Can be null.
+         */
+        CullState(const MapEnvelope& envelope, const std::shared_ptr<const ViewState>& viewState, const std::shared_ptr<ViewState>& predictedViewState);
         virtual ~CullState();
     
         /**
          * Returns an envelope for the visible area in given projection coordinates.
+         * The envelopes are calculated once per projection and shared by all the data sources using the same projection.
          * @param projection The projection for the envelope
          * @return The envelope for the visible area in the coordinate system of the given projection.
          */
         MapEnvelope getProjectionEnvelope(const std::shared_ptr<Projection>& projection) const;
+        /**
+         * Returns the bounds of the visible area in given projection coordinates.
+         * @param projection The projection for the bounds
+         * @return The bounds of the visible area in the coordinate system of the given projection.
+         */
+        MapBounds getProjectionBounds(const std::shared_ptr<Projection>& projection) const;
         /**
          * Returns an envelope for the visible area.
          * @return The envelope for the visible area in the internal coordinate system.
@@ -47,11 +70,30 @@ namespace carto {
          * @return The view state.
          */
         const ViewState& getViewState() const;
+        /**
+         * Returns the shared view state snapshot.
+         * @return The immutable view state snapshot.
+         */
+        const std::shared_ptr<const ViewState>& getViewStateSnapshot() const;
+        /**
+         * Returns the predicted view state at the end of the current camera animation or kinetic movement.
+         * @return The predicted view state. Null if the camera is not moving.
+         */
+        const std::shared_ptr<ViewState>& getPredictedViewState() const;
 
     private:
+        const MapEnvelope& getCachedProjectionEnvelope(const std::shared_ptr<Projection>& projection) const;
+        MapEnvelope calculateProjectionEnvelope(const Projection& projection) const;
+
+        static bool IsSameProjection(const std::shared_ptr<Projection>& projection1, const std::shared_ptr<Projection>& projection2);
+
         MapEnvelope _envelope;
         
-        ViewState _viewState;
+        std::shared_ptr<const ViewState> _viewState;
+        std::shared_ptr<ViewState> _predictedViewState;
+
+        mutable std::vector<std::pair<std::shared_ptr<Projection>, std::shared_ptr<MapEnvelope> > > _projectionEnvelopes;
+        mutable std::mutex _projectionEnvelopesMutex;
     };
     
 }
@@ -0,0 +1,239 @@
+#include "FrameProfiler.h"
+
+#include <algorithm>
+
+namespace carto {
+
+    FrameProfiler::FrameProfiler() :
+        _currentFrame(),
+        _currentLayerIndex(0),
+        _layerStartTime(),
+        _layerStartCounters(),
+        _layerQuery(0),
+        _pendingFrames(),
+        _freeQueries(),
+        _completedFrames(),
+        _recentFrames(),
+        _mutex()
+    {
+    }
+
+    FrameProfiler::~FrameProfiler() {
+    }
+
+    void FrameProfiler::beginFrame() {
+        _currentFrame = Frame();
+        _currentFrame.startTime = std::chrono::steady_clock::now();
+        _currentFrame.startCounters = GLContext::GetDrawCounters();
+    }
+
+    void FrameProfiler::endFrame() {
+        _currentFrame.cpuTime = std::chrono::duration_cast<std::chrono::duration<float, std::milli> >(std::chrono::steady_clock::now() - _currentFrame.startTime).count();
+        _currentFrame.endCounters = GLContext::GetDrawCounters();
+        _pendingFrames.push_back(std::move(_currentFrame));
+        _currentFrame = Frame();
+
+        bool gpuTimesValid = true;
+#ifdef GL_EXT_disjoint_timer_query
+        if (GLContext::TIMER_QUERY) {
+            // Timer results are meaningless if a disjoint operation (like frequency change) happened meanwhile
+            GLint disjoint = 0;
+            glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+            gpuTimesValid = disjoint == 0;
+        }
+#endif
+        completeFrames(gpuTimesValid);
+    }
+
+    void FrameProfiler::beginLayer(const std::shared_ptr<Layer>& layer) {
+        std::vector<FrameStatistics::LayerStatistics>& layerStatistics = _currentFrame.layerStatistics;
+        auto it = std::find_if(layerStatistics.begin(), layerStatistics.end(), [&layer](const FrameStatistics::LayerStatistics& stats) { return stats.layer == layer; });
+        if (it == layerStatistics.end()) {
+            it = layerStatistics.insert(layerStatistics.end(), FrameStatistics::LayerStatistics(layer));
+        }
+        _currentLayerIndex = it - layerStatistics.begin();
+
+        _layerStartTime = std::chrono::steady_clock::now();
+        _layerStartCounters = GLContext::GetDrawCounters();
+
+        _layerQuery = 0;
+#ifdef GL_EXT_disjoint_timer_query
+        if (GLContext::TIMER_QUERY) {
+            if (_freeQueries.empty()) {
+                GLuint query = 0;
+                GLContext::GenQueriesEXT(1, &query);
+                _freeQueries.push_back(query);
+            }
+            _layerQuery = _freeQueries.back();
+            _freeQueries.pop_back();
+            GLContext::BeginQueryEXT(GL_TIME_ELAPSED_EXT, _layerQuery);
+        }
+#endif
+    }
+
+    void FrameProfiler::endLayer() {
+        GLContext::DrawCounters counters = GLContext::GetDrawCounters();
+
+        FrameStatistics::LayerStatistics& stats = _currentFrame.layerStatistics.at(_currentLayerIndex);
+        stats.cpuTime += std::chrono::duration_cast<std::chrono::duration<float, std::milli> >(std::chrono::steady_clock::now() - _layerStartTime).count();
+        stats.drawCalls += counters.drawCalls - _layerStartCounters.drawCalls;
+        stats.vertices += counters.vertices - _layerStartCounters.vertices;
+        stats.textureUploads += counters.textureUploads - _layerStartCounters.textureUploads;
+
+#ifdef GL_EXT_disjoint_timer_query
+        if (_layerQuery != 0) {
+            GLContext::EndQueryEXT(GL_TIME_ELAPSED_EXT);
+            _currentFrame.layerQueries.emplace_back(_currentLayerIndex, _layerQuery);
+            _layerQuery = 0;
+        }
+#endif
+    }
+
+    std::vector<std::shared_ptr<FrameStatistics> > FrameProfiler::takeCompletedFrames() {
+        std::vector<std::shared_ptr<FrameStatistics> > completedFrames;
+        std::swap(completedFrames, _completedFrames);
+        return completedFrames;
+    }
+
+    std::shared_ptr<FrameStatistics> FrameProfiler::getAverageStatistics() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        if (_recentFrames.empty()) {
+            return std::shared_ptr<FrameStatistics>();
+        }
+
+        // Average frame totals and layers. Layers are averaged over the frames they were drawn in
+        float cpuTime = 0, gpuTime = 0;
+        std::size_t gpuFrames = 0, drawCalls = 0, vertices = 0, textureUploads = 0, textureUploadSize = 0;
+        std::vector<FrameStatistics::LayerStatistics> layerStatistics;
+        std::vector<std::size_t> layerFrames, layerGPUFrames;
+        for (const std::shared_ptr<FrameStatistics>& frame : _recentFrames) {
+            cpuTime += frame->getCPUTime();
+            if (frame->getGPUTime() >= 0) {
+                gpuTime += frame->getGPUTime();
+                gpuFrames++;
+            }
+            drawCalls += frame->getDrawCallCount();
+            vertices += frame->getVertexCount();
+            textureUploads += frame->getTextureUploadCount();
+            textureUploadSize += frame->getTextureUploadSize();
+
+            for (const FrameStatistics::LayerStatistics& stats : frame->getLayerStatistics()) {
+                auto it = std::find_if(layerStatistics.begin(), layerStatistics.end(), [&stats](const FrameStatistics::LayerStatistics& avgStats) { return avgStats.layer == stats.layer; });
+                if (it == layerStatistics.end()) {
+                    it = layerStatistics.insert(layerStatistics.end(), FrameStatistics::LayerStatistics(stats.layer));
+                    it->gpuTime = 0;
+                    layerFrames.push_back(0);
+                    layerGPUFrames.push_back(0);
+                }
+                std::size_t index = it - layerStatistics.begin();
+                it->cpuTime += stats.cpuTime;
+                if (stats.gpuTime >= 0) {
+                    it->gpuTime += stats.gpuTime;
+                    layerGPUFrames[index]++;
+                }
+                it->drawCalls += stats.drawCalls;
+                it->vertices += stats.vertices;
+                it->textureUploads += stats.textureUploads;
+                layerFrames[index]++;
+            }
+        }
+
+        for (std::size_t i = 0; i < layerStatistics.size(); i++) {
+            FrameStatistics::LayerStatistics& stats = layerStatistics[i];
+            stats.cpuTime /= layerFrames[i];
+            stats.gpuTime = (layerGPUFrames[i] > 0 ? stats.gpuTime / layerGPUFrames[i] : -1.0f);
+            stats.drawCalls /= layerFrames[i];
+            stats.vertices /= layerFrames[i];
+            stats.textureUploads /= layerFrames[i];
+        }
+
+        std::size_t frameCount = _recentFrames.size();
+        return std::make_shared<FrameStatistics>(cpuTime / frameCount, gpuFrames > 0 ? gpuTime / gpuFrames : -1.0f, drawCalls / frameCount, vertices / frameCount, textureUploads / frameCount, textureUploadSize / frameCount, layerStatistics);
+    }
+
+    void FrameProfiler::release() {
+        for (Frame& frame : _pendingFrames) {
+            for (const std::pair<std::size_t, GLuint>& layerQuery : frame.layerQueries) {
+                _freeQueries.push_back(layerQuery.second);
+            }
+        }
+        if (!_freeQueries.empty()) {
+            GLContext::DeleteQueriesEXT(static_cast<GLsizei>(_freeQueries.size()), _freeQueries.data());
+        }
+        reset();
+    }
+
+    void FrameProfiler::reset() {
+        _currentFrame = Frame();
+        _layerQuery = 0;
+        _pendingFrames.clear();
+        _freeQueries.clear();
+        _completedFrames.clear();
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _recentFrames.clear();
+    }
+
+    void FrameProfiler::completeFrames(bool gpuTimesValid) {
+        while (!_pendingFrames.empty()) {
+            Frame& frame = _pendingFrames.front();
+
+            // Queries complete in order, so the last query of the frame tells if the whole frame is available
+            bool available = true;
+#ifdef GL_EXT_disjoint_timer_query
+            if (gpuTimesValid && !frame.layerQueries.empty() && _pendingFrames.size() <= MAX_PENDING_FRAMES) {
+                GLuint result = 0;
+                GLContext::GetQueryObjectuivEXT(frame.layerQueries.back().second, GL_QUERY_RESULT_AVAILABLE_EXT, &result);
+                available = result != 0;
+            }
+#endif
+            if (!available) {
+                break;
+            }
+
+            completeFrame(frame, gpuTimesValid && _pendingFrames.size() <= MAX_PENDING_FRAMES);
+            _pendingFrames.pop_front();
+        }
+    }
+
+    void FrameProfiler::completeFrame(Frame& frame, bool gpuTimesValid) {
+        float gpuTime = -1.0f;
+#ifdef GL_EXT_disjoint_timer_query
+        if (!frame.layerQueries.empty()) {
+            if (gpuTimesValid) {
+                // Layer passes can not be nested, so the frame GPU time is the sum of the layer passes
+                gpuTime = 0;
+                for (const std::pair<std::size_t, GLuint>& layerQuery : frame.layerQueries) {
+                    std::uint64_t elapsedTime = 0;
+                    GLContext::GetQueryObjectui64vEXT(layerQuery.second, GL_QUERY_RESULT_EXT, &elapsedTime);
+                    FrameStatistics::LayerStatistics& stats = frame.layerStatistics[layerQuery.first];
+                    stats.gpuTime = std::max(stats.gpuTime, 0.0f) + elapsedTime * 1.0e-6f;
+                    gpuTime += elapsedTime * 1.0e-6f;
+                }
+            }
+            for (const std::pair<std::size_t, GLuint>& layerQuery : frame.layerQueries) {
+                _freeQueries.push_back(layerQuery.second);
+            }
+        }
+#endif
+
+        auto statistics = std::make_shared<FrameStatistics>(frame.cpuTime, gpuTime,
+            frame.endCounters.drawCalls - frame.startCounters.drawCalls,
+            frame.endCounters.vertices - frame.startCounters.vertices,
+            frame.endCounters.textureUploads - frame.startCounters.textureUploads,
+            frame.endCounters.textureUploadBytes - frame.startCounters.textureUploadBytes,
+            frame.layerStatistics);
+        _completedFrames.push_back(statistics);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _recentFrames.push_back(statistics);
+        while (_recentFrames.size() > AVERAGE_FRAME_COUNT) {
+            _recentFrames.pop_front();
+        }
+    }
+
+    const std::size_t FrameProfiler::MAX_PENDING_FRAMES = 8;
+    const std::size_t FrameProfiler::AVERAGE_FRAME_COUNT = 60;
+
+}
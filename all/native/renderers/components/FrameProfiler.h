@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_FRAMEPROFILER_H_
+#define _CARTO_FRAMEPROFILER_H_
+
+#include "graphics/utils/GLContext.h"
+#include "renderers/components/FrameStatistics.h"
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace carto {
+    class Layer;
+
+    /**
+     * Collects per-frame and per-layer rendering statistics. GPU times are measured using timer queries,
+     * so frames are completed asynchronously, usually a few frames later.
+     * All methods except getAverageStatistics must be called from the rendering thread.
+     */
+    class FrameProfiler {
+    public:
+        FrameProfiler();
+        virtual ~FrameProfiler();
+
+        void beginFrame();
+        void endFrame();
+
+        void beginLayer(const std::shared_ptr<Layer>& layer);
+        void endLayer();
+
+        /**
+         * Returns the frames that were completed since the last call, in rendering order.
+         */
+        std::vector<std::shared_ptr<FrameStatistics> > takeCompletedFrames();
+
+        /**
+         * Returns statistics averaged over the recently completed frames. Can be called from any thread.
+         * @return The averaged statistics, or null if no frames have been completed.
+         */
+        std::shared_ptr<FrameStatistics> getAverageStatistics() const;
+
+        /**
+         * Releases pending timer queries and drops all collected statistics. Must be called from the rendering thread.
+         */
+        void release();
+        /**
+         * Forgets timer queries without releasing them and drops all collected statistics. Used when the GL context is recreated or destroyed.
+         */
+        void reset();
+
+    private:
+        struct Frame {
+            std::chrono::steady_clock::time_point startTime;
+            float cpuTime;
+            GLContext::DrawCounters startCounters;
+            GLContext::DrawCounters endCounters;
+            std::vector<FrameStatistics::LayerStatistics> layerStatistics;
+            std::vector<std::pair<std::size_t, GLuint> > layerQueries;
+        };
+
+        void completeFrames(bool gpuTimesValid);
+        void completeFrame(Frame& frame, bool gpuTimesValid);
+
+        static const std::size_t MAX_PENDING_FRAMES;
+        static const std::size_t AVERAGE_FRAME_COUNT;
+
+        Frame _currentFrame;
+        std::size_t _currentLayerIndex;
+        std::chrono::steady_clock::time_point _layerStartTime;
+        GLContext::DrawCounters _layerStartCounters;
+        GLuint _layerQuery;
+
+        std::deque<Frame> _pendingFrames;
+        std::vector<GLuint> _freeQueries;
+
+        std::vector<std::shared_ptr<FrameStatistics> > _completedFrames;
+        std::deque<std::shared_ptr<FrameStatistics> > _recentFrames;
+        mutable std::mutex _mutex;
+    };
+
+}
+
+#endif
@@ -0,0 +1,84 @@
+#include "FrameStatistics.h"
+#include "components/Exceptions.h"
+#include "layers/Layer.h"
+
+namespace carto {
+
+    FrameStatistics::FrameStatistics(float cpuTime, float gpuTime, std::size_t drawCalls, std::size_t vertices, std::size_t textureUploads, std::size_t textureUploadSize, const std::vector<LayerStatistics>& layerStatistics) :
+        _cpuTime(cpuTime),
+        _gpuTime(gpuTime),
+        _drawCalls(drawCalls),
+        _vertices(vertices),
+        _textureUploads(textureUploads),
+        _textureUploadSize(textureUploadSize),
+        _layerStatistics(layerStatistics)
+    {
+    }
+
+    FrameStatistics::~FrameStatistics() {
+    }
+
+    float FrameStatistics::getCPUTime() const {
+        return _cpuTime;
+    }
+
+    float FrameStatistics::getGPUTime() const {
+        return _gpuTime;
+    }
+
+    std::size_t FrameStatistics::getDrawCallCount() const {
+        return _drawCalls;
+    }
+
+    std::size_t FrameStatistics::getVertexCount() const {
+        return _vertices;
+    }
+
+    std::size_t FrameStatistics::getTextureUploadCount() const {
+        return _textureUploads;
+    }
+
+    std::size_t FrameStatistics::getTextureUploadSize() const {
+        return _textureUploadSize;
+    }
+
+    int FrameStatistics::getLayerCount() const {
+        return static_cast<int>(_layerStatistics.size());
+    }
+
+    std::shared_ptr<Layer> FrameStatistics::getLayer(int index) const {
+        return getLayerStatisticsAt(index).layer;
+    }
+
+    float FrameStatistics::getLayerCPUTime(int index) const {
+        return getLayerStatisticsAt(index).cpuTime;
+    }
+
+    float FrameStatistics::getLayerGPUTime(int index) const {
+        return getLayerStatisticsAt(index).gpuTime;
+    }
+
+    std::size_t FrameStatistics::getLayerDrawCallCount(int index) const {
+        return getLayerStatisticsAt(index).drawCalls;
+    }
+
+    std::size_t FrameStatistics::getLayerVertexCount(int index) const {
+        return getLayerStatisticsAt(index).vertices;
+    }
+
+    std::size_t FrameStatistics::getLayerTextureUploadCount(int index) const {
+        return getLayerStatisticsAt(index).textureUploads;
+    }
+
+    const std::vector<FrameStatistics::LayerStatistics>& FrameStatistics::getLayerStatistics() const {
+        return _layerStatistics;
+    }
+
+    const FrameStatistics::LayerStatistics& FrameStatistics::getLayerStatisticsAt(int index) const {
+        if (index < 0 || index >= static_cast<int>(_layerStatistics.size())) {
+            throw OutOfRangeException("Layer index out of range");
+        }
+        return _layerStatistics[index];
+    }
+
+}
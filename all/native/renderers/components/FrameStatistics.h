@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_FRAMESTATISTICS_H_
+#define _CARTO_FRAMESTATISTICS_H_
+
+#include <memory>
+#include <vector>
+
+namespace carto {
+    class Layer;
+
+    /**
+     * Rendering statistics of a single frame, or an average over multiple frames.
+     * Times are given in milliseconds. GPU times are negative if GPU timer queries are not supported by the device.
+     * Draw calls and vertices are counted only for the SDK renderers, vector tile and 3D model rendering is included only in the times.
+     */
+    class FrameStatistics {
+    public:
+        /**
+         * Statistics of a single layer.
+         */
+        struct LayerStatistics {
+            std::shared_ptr<Layer> layer;
+            float cpuTime;
+            float gpuTime;
+            std::size_t drawCalls;
+            std::size_t vertices;
+            std::size_t textureUploads;
+
+            explicit LayerStatistics(const std::shared_ptr<Layer>& layer) : layer(layer), cpuTime(0), gpuTime(-1), drawCalls(0), vertices(0), textureUploads(0) { }
+        };
+
+        /**
+         * Constructs a new FrameStatistics instance.
+         * @param cpuTime The CPU time of the frame.
+         * @param gpuTime The GPU time of the frame, negative if not available.
+         * @param drawCalls The number of draw calls.
+         * @param vertices The number of drawn vertices.
+         * @param textureUploads The number of texture uploads.
+         * @param textureUploadSize The total size of texture uploads in bytes.
+         * @param layerStatistics The statistics of the layers.
+         */
+        FrameStatistics(float cpuTime, float gpuTime, std::size_t drawCalls, std::size_t vertices, std::size_t textureUploads, std::size_t textureUploadSize, const std::vector<LayerStatistics>& layerStatistics);
+        virtual ~FrameStatistics();
+
+        /**
+         * Returns the CPU time spent on the frame on the rendering thread.
+         * @return The CPU time in milliseconds.
+         */
+        float getCPUTime() const;
+        /**
+         * Returns the GPU time spent on the frame.
+         * @return The GPU time in milliseconds. Negative if not available.
+         */
+        float getGPUTime() const;
+        /**
+         * Returns the number of draw calls of the frame.
+         * @return The number of draw calls.
+         */
+        std::size_t getDrawCallCount() const;
+        /**
+         * Returns the number of vertices drawn in the frame.
+         * @return The number of vertices.
+         */
+        std::size_t getVertexCount() const;
+        /**
+         * Returns the number of texture uploads in the frame.
+         * @return The number of texture uploads.
+         */
+        std::size_t getTextureUploadCount() const;
+        /**
+         * Returns the total size of texture uploads in the frame.
+         * @return The size of texture uploads in bytes.
+         */
+        std::size_t getTextureUploadSize() const;
+
+        /**
+         * Returns the number of layers with statistics.
+         * @return The layer count.
+         */
+        int getLayerCount() const;
+        /**
+         * Returns the layer at the specified index.
+         * @param index The layer index. Must be between 0 and layer count (exclusive).
+         * @return The layer.
+         * @throws std::out_of_range If the index is out of range.
+         */
+        std::shared_ptr<Layer> getLayer(int index) const;
+        /**
+         * Returns the CPU time spent on the layer.
+         * @param index The layer index. Must be between 0 and layer count (exclusive).
+         * @return The CPU time in milliseconds.
+         * @throws std::out_of_range If the index is out of range.
+         */
+        float getLayerCPUTime(int index) const;
+        /**
+         * Returns the GPU time spent on the layer.
+         * @param index The layer index. Must be between 0 and layer count (exclusive).
+         * @return The GPU time in milliseconds. Negative if not available.
+         * @throws std::out_of_range If the index is out of range.
+         */
+        float getLayerGPUTime(int index) const;
+        /**
+         * Returns the number of draw calls of the layer.
+         * @param index The layer index. Must be between 0 and layer count (exclusive).
+         * @return The number of draw calls.
+         * @throws std::out_of_range If the index is out of range.
+         */
+        std::size_t getLayerDrawCallCount(int index) const;
+        /**
+         * Returns the number of vertices drawn for the layer.
+         * @param index The layer index. Must be between 0 and layer count (exclusive).
+         * @return The number of vertices.
+         * @throws std::out_of_range If the index is out of range.
+         */
+        std::size_t getLayerVertexCount(int index) const;
+        /**
+         * Returns the number of texture uploads of the layer.
+         * @param index The layer index. Must be between 0 and layer count (exclusive).
+         * @return The number of texture uploads.
+         * @throws std::out_of_range If the index is out of range.
+         */
+        std::size_t getLayerTextureUploadCount(int index) const;
+
+        const std::vector<LayerStatistics>& getLayerStatistics() const;
+
+    private:
+        const LayerStatistics& getLayerStatisticsAt(int index) const;
+
+        float _cpuTime;
+        float _gpuTime;
+        std::size_t _drawCalls;
+        std::size_t _vertices;
+        std::size_t _textureUploads;
+        std::size_t _textureUploadSize;
+        std::vector<LayerStatistics> _layerStatistics;
+    };
+
+}
+
+#endif
@@ -16,6 +16,7 @@
 namespace carto {
 
     KineticEventHandler::KineticEventHandler(MapRenderer& mapRenderer, Options& options) :
+        _deltaSeconds(0),
         _pan(false),
         _panDelta(0),
         _panPositions(),
@@ -38,6 +39,7 @@ namespace carto {
     
     void KineticEventHandler::calculate(const ViewState& viewState, float deltaSeconds) {
         std::lock_guard<std::mutex> lock(_mutex);
+        _deltaSeconds = deltaSeconds;
         handlePan(viewState, deltaSeconds);
         handleRotation(viewState, deltaSeconds);
         handleZoom(viewState, deltaSeconds);
@@ -160,6 +162,38 @@ namespace carto {
         _zoomDeltaSamples.clear();
     }
     
+    bool KineticEventHandler::calculatePanTarget(const ViewState& viewState, MapPos& targetPos) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_options.isKineticPan() || !_pan || _panDelta < KINETIC_PAN_STOP_TOLERANCE) {
+            return false;
+        }
+
+        // The delta is scaled by the slowdown factor on each frame, so the remaining movement is the sum of a geometric series.
+        // The frame time of the last frame is assumed for all the remaining frames
+        float deltaSeconds = _deltaSeconds > 0 ? _deltaSeconds : DEFAULT_FRAME_SECONDS;
+        float factor = std::pow(1.0f - KINETIC_PAN_SLOWDOWN, deltaSeconds);
+        float totalDelta = _panDelta * factor / (1.0f - factor);
+
+        std::shared_ptr<ProjectionSurface> projectionSurface = _mapRenderer.getProjectionSurface();
+        cglib::vec3<double> pos0 = projectionSurface->calculatePosition(_panPositions.first);
+        cglib::vec3<double> pos1 = projectionSurface->calculatePosition(_panPositions.second);
+        cglib::mat4x4<double> transform = projectionSurface->calculateTranslateMatrix(pos0, pos1, totalDelta);
+        targetPos = projectionSurface->calculateMapPos(cglib::transform_point(viewState.getFocusPos(), transform));
+        return true;
+    }
+
+    bool KineticEventHandler::calculateZoomTarget(const ViewState& viewState, float& targetZoom, MapPos& targetPos) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_options.isKineticZoom() || !_zoom || std::abs(_zoomDelta) < std::abs(KINETIC_ZOOM_STOP_TOLERANCE)) {
+            return false;
+        }
+
+        // Each frame applies the fraction of the delta that is removed from it, so the whole delta remains to be applied
+        targetZoom = viewState.getZoom() + _zoomDelta;
+        targetPos = _zoomTargetPos;
+        return true;
+    }
+    
     void KineticEventHandler::handlePan(const ViewState& viewState, float deltaSeconds) {
         if (_options.isKineticPan() && _pan) {
             if (_panDelta < KINETIC_PAN_STOP_TOLERANCE) {
@@ -222,6 +256,8 @@ namespace carto {
         }
     }
     
+    const float KineticEventHandler::DEFAULT_FRAME_SECONDS = 1.0f / 60.0f;
+
     const float KineticEventHandler::KINETIC_PAN_STOP_TOLERANCE = 0.007f;
     const float KineticEventHandler::KINETIC_PAN_START_TOLERANCE = 0.025f;
     const float KineticEventHandler::KINETIC_PAN_SLOWDOWN = 0.99f;
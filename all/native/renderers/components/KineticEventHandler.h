@@ -40,6 +40,9 @@ namespace carto {
         void startZoom();
         void stopZoom();
 
+        bool calculatePanTarget(const ViewState& viewState, MapPos& targetPos) const;
+        bool calculateZoomTarget(const ViewState& viewState, float& targetZoom, MapPos& targetPos) const;
+
     private:
         void handlePan(const ViewState& viewState, float deltaSeconds);
         void handleRotation(const ViewState& viewState, float deltaSeconds);
@@ -64,6 +67,10 @@ namespace carto {
         static const float KINETIC_ZOOM_DELTA_CLAMP;
         
         static const int AVERAGE_SAMPLE_COUNT = 7;
+
+        static const float DEFAULT_FRAME_SECONDS;
+
+        float _deltaSeconds;
     
         bool _pan;
         float _panDelta;
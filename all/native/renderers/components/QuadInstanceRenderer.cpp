@@ -0,0 +1,137 @@
+#include "QuadInstanceRenderer.h"
+#include "graphics/Shader.h"
+#include "graphics/ShaderManager.h"
+#include "graphics/ViewState.h"
+
+#include <initializer_list>
+
+#include <cglib/mat.h>
+
+namespace carto {
+
+    QuadInstanceRenderer::QuadInstanceRenderer() :
+        _shader(),
+        _a_corner(0),
+        _a_origin(0),
+        _a_xAxis(0),
+        _a_yAxis(0),
+        _a_texCoordRect(0),
+        _a_color(0),
+        _u_mvpMat(0),
+        _u_tex(0)
+    {
+    }
+
+    QuadInstanceRenderer::~QuadInstanceRenderer() {
+    }
+
+    bool QuadInstanceRenderer::isAvailable() const {
+        return _shader && GLContext::INSTANCED_ARRAYS;
+    }
+
+    void QuadInstanceRenderer::onSurfaceCreated(const std::shared_ptr<ShaderManager>& shaderManager) {
+        if (!GLContext::INSTANCED_ARRAYS) {
+            _shader.reset();
+            return;
+        }
+
+        static ShaderSource shaderSource("quad_instance", &QUAD_INSTANCE_VERTEX_SHADER, &QUAD_INSTANCE_FRAGMENT_SHADER);
+
+        _shader = shaderManager->createShader(shaderSource);
+
+        // Get shader variables locations
+        glUseProgram(_shader->getProgId());
+        _a_corner = _shader->getAttribLoc("a_corner");
+        _a_origin = _shader->getAttribLoc("a_origin");
+        _a_xAxis = _shader->getAttribLoc("a_xAxis");
+        _a_yAxis = _shader->getAttribLoc("a_yAxis");
+        _a_texCoordRect = _shader->getAttribLoc("a_texCoordRect");
+        _a_color = _shader->getAttribLoc("a_color");
+        _u_mvpMat = _shader->getUniformLoc("u_mvpMat");
+        _u_tex = _shader->getUniformLoc("u_tex");
+    }
+
+    void QuadInstanceRenderer::onSurfaceDestroyed() {
+        _shader.reset();
+    }
+
+    void QuadInstanceRenderer::bind(const ViewState& viewState) {
+        // Prepare for drawing
+        glUseProgram(_shader->getProgId());
+        // Texture
+        glUniform1i(_u_tex, 0);
+        // Matrix
+        const cglib::mat4x4<float>& mvpMat = viewState.getRTEModelviewProjectionMat();
+        glUniformMatrix4fv(_u_mvpMat, 1, GL_FALSE, mvpMat.data());
+        // Corners are per-vertex, everything else is per-instance
+        glEnableVertexAttribArray(_a_corner);
+        glVertexAttribPointer(_a_corner, 2, GL_FLOAT, GL_FALSE, 0, QUAD_CORNERS);
+        for (GLuint attrib : { _a_origin, _a_xAxis, _a_yAxis, _a_texCoordRect, _a_color }) {
+            glEnableVertexAttribArray(attrib);
+            GLContext::VertexAttribDivisor(attrib, 1);
+        }
+    }
+
+    void QuadInstanceRenderer::unbind() {
+        // Divisors are attribute state, reset them so that other shaders using the same attribute indices are not affected
+        glDisableVertexAttribArray(_a_corner);
+        for (GLuint attrib : { _a_origin, _a_xAxis, _a_yAxis, _a_texCoordRect, _a_color }) {
+            GLContext::VertexAttribDivisor(attrib, 0);
+            glDisableVertexAttribArray(attrib);
+        }
+    }
+
+    void QuadInstanceRenderer::drawInstances(const std::vector<Instance>& instances) {
+        if (instances.empty()) {
+            return;
+        }
+
+        const Instance* data = instances.data();
+        GLsizei stride = sizeof(Instance);
+        glVertexAttribPointer(_a_origin, 3, GL_FLOAT, GL_FALSE, stride, data->origin);
+        glVertexAttribPointer(_a_xAxis, 3, GL_FLOAT, GL_FALSE, stride, data->xAxis);
+        glVertexAttribPointer(_a_yAxis, 3, GL_FLOAT, GL_FALSE, stride, data->yAxis);
+        glVertexAttribPointer(_a_texCoordRect, 4, GL_FLOAT, GL_FALSE, stride, data->texCoordRect);
+        glVertexAttribPointer(_a_color, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, data->color);
+        GLContext::DrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, QUAD_INDICES, static_cast<GLsizei>(instances.size()));
+        GLContext::CountDrawCall(instances.size() * 6);
+    }
+
+    const std::string QuadInstanceRenderer::QUAD_INSTANCE_VERTEX_SHADER = R"GLSL(
+        #version 100
+        attribute vec2 a_corner;
+        attribute vec3 a_origin;
+        attribute vec3 a_xAxis;
+        attribute vec3 a_yAxis;
+        attribute vec4 a_texCoordRect;
+        attribute vec4 a_color;
+        varying vec2 v_texCoord;
+        varying vec4 v_color;
+        uniform mat4 u_mvpMat;
+        void main() {
+            v_texCoord = a_texCoordRect.xy + a_corner * a_texCoordRect.zw;
+            v_color = a_color;
+            gl_Position = u_mvpMat * vec4(a_origin + a_corner.x * a_xAxis + a_corner.y * a_yAxis, 1.0);
+        }
+    )GLSL";
+
+    const std::string QuadInstanceRenderer::QUAD_INSTANCE_FRAGMENT_SHADER = R"GLSL(
+        #version 100
+        precision mediump float;
+        varying mediump vec2 v_texCoord;
+        varying lowp vec4 v_color;
+        uniform sampler2D u_tex;
+        void main() {
+            vec4 color = texture2D(u_tex, v_texCoord) * v_color;
+            if (color.a == 0.0) {
+                discard;
+            }
+            gl_FragColor = color;
+        }
+    )GLSL";
+
+    const float QuadInstanceRenderer::QUAD_CORNERS[] = { 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f };
+
+    const unsigned short QuadInstanceRenderer::QUAD_INDICES[] = { 0, 1, 2, 1, 3, 2 };
+
+}
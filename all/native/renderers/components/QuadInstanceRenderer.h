@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_QUADINSTANCERENDERER_H_
+#define _CARTO_QUADINSTANCERENDERER_H_
+
+#include "graphics/utils/GLContext.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace carto {
+    class Shader;
+    class ShaderManager;
+    class ViewState;
+
+    /**
+     * Instanced renderer for textured quads, used by point and billboard renderers when instanced arrays are supported.
+     * Each quad is described by a single instance record, the corners are expanded in the vertex shader.
+     * Must be used only from the rendering thread.
+     */
+    class QuadInstanceRenderer {
+    public:
+        /**
+         * Instance record of a quad. The corner (s, t) of the quad, where s and t are 0 or 1, is placed at
+         * origin + s * xAxis + t * yAxis and uses texture coordinates texCoordRect.xy + (s, t) * texCoordRect.zw.
+         * The coordinates are relative to the camera position.
+         */
+        struct Instance {
+            float origin[3];
+            float xAxis[3];
+            float yAxis[3];
+            float texCoordRect[4];
+            unsigned char color[4];
+        };
+
+        QuadInstanceRenderer();
+        virtual ~QuadInstanceRenderer();
+
+        /**
+         * Returns true if instanced rendering is supported by the current context and the renderer is initialized.
+         */
+        bool isAvailable() const;
+
+        void onSurfaceCreated(const std::shared_ptr<ShaderManager>& shaderManager);
+        void onSurfaceDestroyed();
+
+        /**
+         * Binds the shader and the per-vertex corner attributes. The texture must be bound to unit 0.
+         * @param viewState The view state to use.
+         */
+        void bind(const ViewState& viewState);
+        /**
+         * Disables the vertex attributes and resets the attribute divisors.
+         */
+        void unbind();
+
+        /**
+         * Draws the given quads. The renderer must be bound.
+         * @param instances The instance records of the quads.
+         */
+        void drawInstances(const std::vector<Instance>& instances);
+
+    private:
+        static const std::string QUAD_INSTANCE_VERTEX_SHADER;
+        static const std::string QUAD_INSTANCE_FRAGMENT_SHADER;
+
+        static const float QUAD_CORNERS[];
+        static const unsigned short QUAD_INDICES[];
+
+        std::shared_ptr<Shader> _shader;
+        GLuint _a_corner;
+        GLuint _a_origin;
+        GLuint _a_xAxis;
+        GLuint _a_yAxis;
+        GLuint _a_texCoordRect;
+        GLuint _a_color;
+        GLuint _u_mvpMat;
+        GLuint _u_tex;
+    };
+
+}
+
+#endif
@@ -0,0 +1,113 @@
+#include "ScreenPickIndex.h"
+#include "graphics/ViewState.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace carto {
+
+    ScreenPickIndex::ScreenPickIndex() :
+        _valid(false),
+        _mvpMat(cglib::mat4x4<double>::identity()),
+        _unitToDPCoef(0),
+        _gridCells(GRID_SIZE * GRID_SIZE),
+        _unboundedIndices()
+    {
+    }
+
+    ScreenPickIndex::~ScreenPickIndex() {
+    }
+
+    void ScreenPickIndex::invalidate() {
+        _valid = false;
+    }
+
+    bool ScreenPickIndex::isValid(const ViewState& viewState) const {
+        return _valid && viewState.getModelviewProjectionMat() == _mvpMat && viewState.getUnitToDPCoef() == _unitToDPCoef;
+    }
+
+    void ScreenPickIndex::reset(const ViewState& viewState) {
+        for (std::vector<std::size_t>& cell : _gridCells) {
+            cell.clear();
+        }
+        _unboundedIndices.clear();
+        _mvpMat = viewState.getModelviewProjectionMat();
+        _unitToDPCoef = viewState.getUnitToDPCoef();
+        _valid = true;
+    }
+
+    void ScreenPickIndex::add(std::size_t index, const cglib::bbox3<double>& bounds) {
+        // Elements without geometry can not be hit
+        if (bounds.min(0) > bounds.max(0)) {
+            return;
+        }
+
+        // Project the corners of the bounding box to the screen. If any corner is behind the near plane, the screen bounds are unknown
+        cglib::vec2<double> screenMin(0, 0), screenMax(0, 0);
+        for (int i = 0; i < 8; i++) {
+            cglib::vec4<double> point(0, 0, 0, 1);
+            point(0) = ((i & 1) != 0 ? bounds.max(0) : bounds.min(0));
+            point(1) = ((i & 2) != 0 ? bounds.max(1) : bounds.min(1));
+            point(2) = ((i & 4) != 0 ? bounds.max(2) : bounds.min(2));
+
+            cglib::vec4<double> projPoint = cglib::transform(point, _mvpMat);
+            if (!(projPoint(3) >= MIN_CLIP_W)) {
+                _unboundedIndices.push_back(index);
+                return;
+            }
+
+            cglib::vec2<double> screenPoint(projPoint(0) / projPoint(3), projPoint(1) / projPoint(3));
+            if (i == 0) {
+                screenMin = screenMax = screenPoint;
+            } else {
+                screenMin = cglib::vec2<double>(std::min(screenMin(0), screenPoint(0)), std::min(screenMin(1), screenPoint(1)));
+                screenMax = cglib::vec2<double>(std::max(screenMax(0), screenPoint(0)), std::max(screenMax(1), screenPoint(1)));
+            }
+        }
+
+        int x0 = CalculateGridCell(screenMin(0)), x1 = CalculateGridCell(screenMax(0));
+        int y0 = CalculateGridCell(screenMin(1)), y1 = CalculateGridCell(screenMax(1));
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                _gridCells[y * GRID_SIZE + x].push_back(index);
+            }
+        }
+    }
+
+    bool ScreenPickIndex::query(const cglib::ray3<double>& ray, const ViewState& viewState, std::vector<std::size_t>& indices) const {
+        if (!isValid(viewState) || ray.origin != viewState.getCameraPos()) {
+            return false;
+        }
+
+        // A ray starting from the camera projects to a single screen point
+        cglib::vec3<double> target = ray.origin + ray.direction;
+        cglib::vec4<double> projTarget = cglib::transform(cglib::vec4<double>(target(0), target(1), target(2), 1), _mvpMat);
+        if (!(projTarget(3) >= MIN_CLIP_W)) {
+            return false;
+        }
+        int x = CalculateGridCell(projTarget(0) / projTarget(3));
+        int y = CalculateGridCell(projTarget(1) / projTarget(3));
+
+        // Both lists are in increasing index order, merge them to keep the element order
+        const std::vector<std::size_t>& cell = _gridCells[y * GRID_SIZE + x];
+        indices.clear();
+        indices.reserve(cell.size() + _unboundedIndices.size());
+        std::merge(cell.begin(), cell.end(), _unboundedIndices.begin(), _unboundedIndices.end(), std::back_inserter(indices));
+        return true;
+    }
+
+    int ScreenPickIndex::CalculateGridCell(double coord) {
+        // Screen coordinates are normalized to [-1, 1]. Offscreen coordinates are clamped to the border cells
+        if (!(coord >= -1.0)) {
+            return 0;
+        }
+        if (!(coord < 1.0)) {
+            return GRID_SIZE - 1;
+        }
+        return std::min(static_cast<int>((coord + 1.0) * 0.5 * GRID_SIZE), GRID_SIZE - 1);
+    }
+
+    const int ScreenPickIndex::GRID_SIZE = 16;
+    const double ScreenPickIndex::MIN_CLIP_W = 1.0e-9;
+
+}
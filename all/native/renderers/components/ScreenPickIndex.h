@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_SCREENPICKINDEX_H_
+#define _CARTO_SCREENPICKINDEX_H_
+
+#include <vector>
+
+#include <cglib/vec.h>
+#include <cglib/mat.h>
+#include <cglib/bbox.h>
+#include <cglib/ray.h>
+
+namespace carto {
+    class ViewState;
+
+    /**
+     * Screen space grid of element bounds, used by the renderers to find click candidates without testing all elements.
+     * The index is built for a single view state while rendering and can be queried only with rays starting from the camera of the same view.
+     * Elements are identified by their index in the renderer element list. Not thread safe, the renderers guard it with their own mutex.
+     */
+    class ScreenPickIndex {
+    public:
+        ScreenPickIndex();
+        virtual ~ScreenPickIndex();
+
+        /**
+         * Marks the index as invalid. Must be called when the element list or element bounds change.
+         */
+        void invalidate();
+
+        /**
+         * Returns true if the index is valid and was built for the specified view state.
+         * @param viewState The view state to check.
+         * @return True if the index can be used for the view.
+         */
+        bool isValid(const ViewState& viewState) const;
+
+        /**
+         * Clears the index and starts building it for the specified view state.
+         * @param viewState The view state to use.
+         */
+        void reset(const ViewState& viewState);
+
+        /**
+         * Adds an element to the index. The elements must be added in increasing index order.
+         * @param index The index of the element.
+         * @param bounds The world space bounds of the element.
+         */
+        void add(std::size_t index, const cglib::bbox3<double>& bounds);
+
+        /**
+         * Finds the candidate elements possibly intersecting the ray.
+         * @param ray The ray to test, must start from the camera position.
+         * @param viewState The view state of the ray.
+         * @param indices The buffer for the candidate element indices, in increasing order.
+         * @return True if the index could be used. If false is returned, all elements must be tested.
+         */
+        bool query(const cglib::ray3<double>& ray, const ViewState& viewState, std::vector<std::size_t>& indices) const;
+
+    private:
+        static int CalculateGridCell(double coord);
+
+        static const int GRID_SIZE; // number of grid cells along each screen axis
+        static const double MIN_CLIP_W;
+
+        bool _valid;
+        cglib::mat4x4<double> _mvpMat;
+        float _unitToDPCoef;
+        std::vector<std::vector<std::size_t> > _gridCells;
+        std::vector<std::size_t> _unboundedIndices; // elements crossing the near plane, tested for all rays
+    };
+
+}
+
+#endif
@@ -3,11 +3,14 @@
 #include "graphics/Texture.h"
 #include "graphics/TextureManager.h"
 
+#include <algorithm>
+
 namespace carto {
     
     StyleTextureCache::StyleTextureCache(const std::shared_ptr<TextureManager>& textureManager, unsigned int capacityInBytes) :
         _textureManager(textureManager),
         _cache(capacityInBytes),
+        _atlasPages(),
         _mutex()
     {
     }
@@ -36,17 +39,118 @@ namespace carto {
     std::shared_ptr<Texture> StyleTextureCache::get(const std::shared_ptr<Bitmap>& bitmap) {
         std::lock_guard<std::mutex> lock(_mutex);
 
-        std::shared_ptr<Texture> texture;
-        _cache.read(bitmap, texture);
-        return texture;
+        // Packed bitmaps share their texture with other bitmaps, so they can not be returned here
+        std::shared_ptr<Entry> entry;
+        if (_cache.read(bitmap, entry) && !entry->page) {
+            return entry->texture;
+        }
+        return std::shared_ptr<Texture>();
     }
     
     std::shared_ptr<Texture> StyleTextureCache::create(const std::shared_ptr<Bitmap>& bitmap, bool genMipmaps, bool repeat) {
         std::lock_guard<std::mutex> lock(_mutex);
 
         std::shared_ptr<Texture> texture = _textureManager->createTexture(bitmap, genMipmaps, repeat);
-        _cache.put(bitmap, texture, texture->getSize());
+        const cglib::vec2<float>& texCoordScale = texture->getTexCoordScale();
+        auto entry = std::make_shared<Entry>(Entry { texture, std::shared_ptr<AtlasPage>(), cglib::vec4<float>(0.0f, 0.0f, texCoordScale(0), texCoordScale(1)) });
+        _cache.put(bitmap, entry, texture->getSize());
         return texture;
     }
+
+    std::shared_ptr<Texture> StyleTextureCache::getPacked(const std::shared_ptr<Bitmap>& bitmap, bool genMipmaps, cglib::vec4<float>& texCoordRect) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+
+            std::shared_ptr<Entry> entry;
+            if (_cache.read(bitmap, entry)) {
+                texCoordRect = entry->texCoordRect;
+                return entry->texture;
+            }
+        }
+
+        int width = static_cast<int>(bitmap->getWidth());
+        int height = static_cast<int>(bitmap->getHeight());
+        if (genMipmaps || width > ATLAS_MAX_BITMAP_SIZE || height > ATLAS_MAX_BITMAP_SIZE) {
+            std::shared_ptr<Texture> texture = create(bitmap, genMipmaps, false);
+            const cglib::vec2<float>& texCoordScale = texture->getTexCoordScale();
+            texCoordRect = cglib::vec4<float>(0.0f, 0.0f, texCoordScale(0), texCoordScale(1));
+            return texture;
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // Find a page with enough free space, pages are released once all of their bitmaps are evicted
+        _atlasPages.erase(std::remove_if(_atlasPages.begin(), _atlasPages.end(), [](const std::weak_ptr<AtlasPage>& page) { return page.expired(); }), _atlasPages.end());
+        int paddedWidth = width + 2 * ATLAS_PADDING;
+        int paddedHeight = height + 2 * ATLAS_PADDING;
+        std::shared_ptr<AtlasPage> page;
+        int x = 0, y = 0;
+        for (const std::weak_ptr<AtlasPage>& pageWeak : _atlasPages) {
+            std::shared_ptr<AtlasPage> candidatePage = pageWeak.lock();
+            if (candidatePage && AllocateAtlasRegion(*candidatePage, paddedWidth, paddedHeight, x, y)) {
+                page = candidatePage;
+                break;
+            }
+        }
+        if (!page) {
+            std::vector<unsigned char> pixelData(ATLAS_PAGE_SIZE * ATLAS_PAGE_SIZE * 4, 0);
+            auto pageBitmap = std::make_shared<Bitmap>(pixelData.data(), ATLAS_PAGE_SIZE, ATLAS_PAGE_SIZE, ColorFormat::COLOR_FORMAT_RGBA, ATLAS_PAGE_SIZE * 4);
+            page = std::make_shared<AtlasPage>(AtlasPage { _textureManager->createTexture(pageBitmap, false, false), std::vector<AtlasShelf>(), 0 });
+            AllocateAtlasRegion(*page, paddedWidth, paddedHeight, x, y);
+            _atlasPages.push_back(page);
+        }
+
+        // Upload the bitmap with transparent padding, so that linear filtering does not bleed from the neighbours
+        std::shared_ptr<Bitmap> rgbaBitmap = bitmap->getColorFormat() == ColorFormat::COLOR_FORMAT_RGBA ? bitmap : bitmap->getRGBABitmap();
+        std::shared_ptr<Bitmap> paddedBitmap = rgbaBitmap->getPaddedBitmap(ATLAS_PADDING, ATLAS_PADDING)->getPaddedBitmap(-ATLAS_PADDING, -ATLAS_PADDING);
+        page->texture->updateSubBitmap(x, y, *paddedBitmap);
+
+        float pageSize = static_cast<float>(ATLAS_PAGE_SIZE);
+        texCoordRect = cglib::vec4<float>((x + ATLAS_PADDING) / pageSize, (y + ATLAS_PADDING) / pageSize, width / pageSize, height / pageSize);
+        auto entry = std::make_shared<Entry>(Entry { page->texture, page, texCoordRect });
+        _cache.put(bitmap, entry, static_cast<std::size_t>(paddedWidth) * paddedHeight * 4);
+        return page->texture;
+    }
+
+    void StyleTextureCache::clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        _cache.clear();
+        _atlasPages.clear();
+    }
+
+    bool StyleTextureCache::AllocateAtlasRegion(AtlasPage& page, int width, int height, int& x, int& y) {
+        if (width > ATLAS_PAGE_SIZE || height > ATLAS_PAGE_SIZE) {
+            return false;
+        }
+
+        // Shelf packing: use the lowest existing shelf that fits, unless it would waste too much space
+        AtlasShelf* bestShelf = nullptr;
+        for (AtlasShelf& shelf : page.shelves) {
+            if (shelf.height >= height && shelf.width + width <= ATLAS_PAGE_SIZE) {
+                if (!bestShelf || shelf.height < bestShelf->height) {
+                    bestShelf = &shelf;
+                }
+            }
+        }
+        bool canAddShelf = page.height + height <= ATLAS_PAGE_SIZE;
+        if (!bestShelf || (canAddShelf && bestShelf->height > height * 3 / 2)) {
+            if (!canAddShelf) {
+                return false;
+            }
+            page.shelves.push_back(AtlasShelf { page.height, height, 0 });
+            page.height += height;
+            bestShelf = &page.shelves.back();
+        }
+
+        x = bestShelf->width;
+        y = bestShelf->y;
+        bestShelf->width += width;
+        return true;
+    }
+
+    const int StyleTextureCache::ATLAS_PAGE_SIZE = 1024;
+    const int StyleTextureCache::ATLAS_MAX_BITMAP_SIZE = 256;
+    const int StyleTextureCache::ATLAS_PADDING = 1;
         
 }
@@ -9,6 +9,9 @@
 
 #include <memory>
 #include <mutex>
+#include <vector>
+
+#include <cglib/vec.h>
 
 #include <stdext/timed_lru_cache.h>
 
@@ -31,10 +34,49 @@ namespace carto {
     
         std::shared_ptr<Texture> get(const std::shared_ptr<Bitmap>& bitmap);
 
+        /**
+         * Returns the texture containing the given bitmap, creating it if needed. Small bitmaps without mipmaps
+         * are packed into shared atlas pages, so that elements with different bitmaps can be drawn using a single texture.
+         * Must be called from the GL thread.
+         * @param bitmap The bitmap to use.
+         * @param genMipmaps True if mipmaps are required. Mipmapped bitmaps always use a dedicated texture.
+         * @param texCoordRect The texture coordinate rectangle (u0, v0, du, dv) of the bitmap within the texture.
+         * @return The texture containing the bitmap.
+         */
+        std::shared_ptr<Texture> getPacked(const std::shared_ptr<Bitmap>& bitmap, bool genMipmaps, cglib::vec4<float>& texCoordRect);
+
+        void clear();
+
     private:
+        struct AtlasShelf {
+            int y;
+            int height;
+            int width;
+        };
+
+        struct AtlasPage {
+            std::shared_ptr<Texture> texture;
+            std::vector<AtlasShelf> shelves;
+            int height;
+        };
+
+        struct Entry {
+            std::shared_ptr<Texture> texture;
+            std::shared_ptr<AtlasPage> page;
+            cglib::vec4<float> texCoordRect;
+        };
+
+        static bool AllocateAtlasRegion(AtlasPage& page, int width, int height, int& x, int& y);
+
+        static const int ATLAS_PAGE_SIZE;
+        static const int ATLAS_MAX_BITMAP_SIZE;
+        static const int ATLAS_PADDING;
+
         std::shared_ptr<TextureManager> _textureManager;
 
-        cache::timed_lru_cache<std::shared_ptr<Bitmap>, std::shared_ptr<Texture> > _cache;
+        cache::timed_lru_cache<std::shared_ptr<Bitmap>, std::shared_ptr<Entry> > _cache;
+
+        std::vector<std::weak_ptr<AtlasPage> > _atlasPages;
         
         mutable std::mutex _mutex;
     };
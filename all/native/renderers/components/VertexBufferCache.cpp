@@ -0,0 +1,98 @@
+#include "VertexBufferCache.h"
+
+namespace carto {
+
+    VertexBufferCache::VertexBufferCache() :
+        _chunks(),
+        _chunkIndex(0),
+        _shortIndexBuf()
+    {
+    }
+
+    VertexBufferCache::~VertexBufferCache() {
+    }
+
+    void VertexBufferCache::beginFrame() {
+        _chunkIndex = 0;
+    }
+
+    void VertexBufferCache::endFrame() {
+        for (std::size_t i = _chunkIndex; i < _chunks.size(); i++) {
+            DeleteChunkBuffers(_chunks[i]);
+        }
+        _chunks.resize(_chunkIndex);
+        UnbindBuffers();
+    }
+
+    VertexBufferCache::Chunk& VertexBufferCache::bindChunk(const std::vector<std::shared_ptr<const void> >& drawDatas, std::size_t firstPart, std::size_t endPart, bool& valid) {
+        if (_chunkIndex >= _chunks.size()) {
+            _chunks.emplace_back();
+        }
+        Chunk& chunk = _chunks[_chunkIndex++];
+
+        valid = !chunk.dirty && chunk.firstPart == firstPart && chunk.endPart == endPart && chunk.drawDatas == drawDatas;
+        if (!valid) {
+            chunk.drawDatas = drawDatas;
+            chunk.firstPart = firstPart;
+            chunk.endPart = endPart;
+            chunk.dirty = false;
+            chunk.vertexCount = 0;
+            chunk.indexCount = 0;
+            if (chunk.vertexBufferId == 0) {
+                glGenBuffers(1, &chunk.vertexBufferId);
+            }
+            if (chunk.indexBufferId == 0) {
+                glGenBuffers(1, &chunk.indexBufferId);
+            }
+        }
+
+        glBindBuffer(GL_ARRAY_BUFFER, chunk.vertexBufferId);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunk.indexBufferId);
+        return chunk;
+    }
+
+    void VertexBufferCache::uploadIndices(Chunk& chunk, const std::vector<unsigned int>& indices) {
+        if (GLContext::ELEMENT_INDEX_UINT) {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+            chunk.indexType = GL_UNSIGNED_INT;
+        } else {
+            _shortIndexBuf.assign(indices.begin(), indices.end());
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, _shortIndexBuf.size() * sizeof(unsigned short), _shortIndexBuf.data(), GL_STATIC_DRAW);
+            chunk.indexType = GL_UNSIGNED_SHORT;
+        }
+        chunk.indexCount = indices.size();
+    }
+
+    void VertexBufferCache::invalidate() {
+        for (Chunk& chunk : _chunks) {
+            chunk.dirty = true;
+        }
+    }
+
+    void VertexBufferCache::reset() {
+        _chunks.clear();
+        _chunkIndex = 0;
+    }
+
+    void VertexBufferCache::UnbindBuffers() {
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+
+    void VertexBufferCache::DrawChunk(const Chunk& chunk) {
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(chunk.indexCount), chunk.indexType, nullptr);
+        GLContext::CountDrawCall(chunk.indexCount);
+    }
+
+    void VertexBufferCache::DeleteChunkBuffers(Chunk& chunk) {
+        if (chunk.vertexBufferId != 0) {
+            glDeleteBuffers(1, &chunk.vertexBufferId);
+            chunk.vertexBufferId = 0;
+        }
+        if (chunk.indexBufferId != 0) {
+            glDeleteBuffers(1, &chunk.indexBufferId);
+            chunk.indexBufferId = 0;
+        }
+    }
+
+}
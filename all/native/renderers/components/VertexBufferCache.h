@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_VERTEXBUFFERCACHE_H_
+#define _CARTO_VERTEXBUFFERCACHE_H_
+
+#include "graphics/utils/GLContext.h"
+
+#include <memory>
+#include <vector>
+
+namespace carto {
+
+    /**
+     * Cache of GPU vertex and index buffers for batched vector element geometry.
+     * Buffers are identified by their order within the frame and by the draw datas they were built from,
+     * so unchanged geometry is uploaded only once. Must be used only from the rendering thread.
+     */
+    class VertexBufferCache {
+    public:
+        struct Chunk {
+            std::vector<std::shared_ptr<const void> > drawDatas;
+            std::size_t firstPart;
+            std::size_t endPart;
+            bool dirty;
+            GLuint vertexBufferId;
+            GLuint indexBufferId;
+            std::size_t vertexCount;
+            std::size_t indexCount;
+            GLenum indexType;
+
+            Chunk() : drawDatas(), firstPart(0), endPart(0), dirty(true), vertexBufferId(0), indexBufferId(0), vertexCount(0), indexCount(0), indexType(GL_UNSIGNED_SHORT) { }
+        };
+
+        VertexBufferCache();
+        virtual ~VertexBufferCache();
+
+        /**
+         * Starts a new frame. Chunks are matched in the same order as they were requested in the previous frame.
+         */
+        void beginFrame();
+        /**
+         * Ends the frame, releasing the buffers of the chunks that were not requested during the frame.
+         */
+        void endFrame();
+
+        /**
+         * Returns the next chunk of the frame and binds its buffers.
+         * @param drawDatas The draw datas of the chunk. The chunk keeps references to them.
+         * @param firstPart The index of the first vertex part used from the first draw data.
+         * @param endPart The index after the last vertex part used from the last draw data.
+         * @param valid Set to true if the buffers contain the geometry of the given draw datas. Otherwise the caller must upload the geometry.
+         * @return The chunk, with its buffers bound.
+         */
+        Chunk& bindChunk(const std::vector<std::shared_ptr<const void> >& drawDatas, std::size_t firstPart, std::size_t endPart, bool& valid);
+
+        /**
+         * Uploads the indices of the chunk, using 32-bit indices if supported. The chunk buffers must be bound.
+         * @param chunk The chunk to update.
+         * @param indices The indices of the chunk. Must fit into 16 bits if 32-bit indices are not supported.
+         */
+        void uploadIndices(Chunk& chunk, const std::vector<unsigned int>& indices);
+
+        /**
+         * Marks all chunks as dirty, for example when the geometry of the draw datas is modified in place.
+         */
+        void invalidate();
+        /**
+         * Forgets all buffers without releasing them. Used when the GL context is recreated or destroyed.
+         */
+        void reset();
+
+        /**
+         * Unbinds vertex and index buffers, so that client side arrays can be used again.
+         */
+        static void UnbindBuffers();
+
+        /**
+         * Draws the triangles of the chunk. The chunk buffers and vertex attributes must be bound.
+         * @param chunk The chunk to draw.
+         */
+        static void DrawChunk(const Chunk& chunk);
+
+    private:
+        static void DeleteChunkBuffers(Chunk& chunk);
+
+        std::vector<Chunk> _chunks;
+        std::size_t _chunkIndex;
+
+        std::vector<unsigned short> _shortIndexBuf;
+    };
+
+}
+
+#endif
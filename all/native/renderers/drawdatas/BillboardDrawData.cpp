@@ -127,6 +127,28 @@ namespace carto {
         return _zAxis;
     }
 
+    bool BillboardDrawData::isMoving() const {
+        return _moving;
+    }
+
+    void BillboardDrawData::updateMovingPos(const ProjectionSurface& projectionSurface, std::chrono::steady_clock::time_point time) {
+        if (!_moving) {
+            return;
+        }
+
+        // Interpolate linearly between the end points. The movements are short, so the difference from the surface is negligible
+        cglib::vec3<double> pos = _moveEndPos;
+        if (time < _moveStartTime) {
+            pos = _moveStartPos;
+        } else if (time < _moveEndTime) {
+            double t = std::chrono::duration<double>(time - _moveStartTime).count() / std::chrono::duration<double>(_moveEndTime - _moveStartTime).count();
+            pos = _moveStartPos + (_moveEndPos - _moveStartPos) * t;
+        } else {
+            _moving = false;
+        }
+        setPos(pos, projectionSurface);
+    }
+
     float BillboardDrawData::getRotation() const {
         return _rotation;
     }
@@ -195,6 +217,8 @@ namespace carto {
     
     void BillboardDrawData::offsetHorizontally(double offset) {
         _pos(0) += offset;
+        _moveStartPos(0) += offset;
+        _moveEndPos(0) += offset;
         setIsOffset(true);
     }
     
@@ -235,6 +259,11 @@ namespace carto {
         _xAxis(1, 0, 0),
         _yAxis(0, 1, 0),
         _zAxis(0, 0, 1),
+        _moving(false),
+        _moveStartPos(0, 0, 0),
+        _moveEndPos(0, 0, 0),
+        _moveStartTime(),
+        _moveEndTime(),
         _rotation(billboard.getRotation()),
         _scaleWithDPI(style.isScaleWithDPI()),
         _scalingMode(scalingMode),
@@ -243,14 +272,6 @@ namespace carto {
         _screenBottomDistance(0),
         _renderer()
     {
-        if (billboard.getGeometry()) {
-            MapPos internalPos = projection.toInternal(billboard.getGeometry()->getCenterPos());
-            _pos = projectionSurface.calculatePosition(internalPos);
-            _xAxis = cglib::vec3<float>::convert(cglib::unit(projectionSurface.calculateVector(internalPos, MapVec(1, 0, 0))));
-            _yAxis = cglib::vec3<float>::convert(cglib::unit(projectionSurface.calculateVector(internalPos, MapVec(0, 1, 0))));
-            _zAxis = cglib::vec3<float>::convert(cglib::unit(projectionSurface.calculateVector(internalPos, MapVec(0, 0, 1))));
-        }
-
         if (auto drawData = billboard.getDrawData()) {
             _transition = drawData->_transition.load();
         }
@@ -260,7 +281,76 @@ namespace carto {
             // Don't account for the projection distortion, calculate size at the equator
             _size = static_cast<float>(_size * Const::WORLD_SIZE / Const::EARTH_CIRCUMFERENCE);
         }
-        
+
+        calculateTransform(billboard, projection, projectionSurface);
+    }
+
+    BillboardDrawData::BillboardDrawData(const BillboardDrawData& drawData,
+                                         const Billboard& billboard,
+                                         const Projection& projection,
+                                         const ProjectionSurface& projectionSurface) :
+        VectorElementDrawData(drawData),
+        _anchorPointX(drawData._anchorPointX),
+        _anchorPointY(drawData._anchorPointY),
+        _aspect(drawData._aspect),
+        _attachAnchorPointX(drawData._attachAnchorPointX),
+        _attachAnchorPointY(drawData._attachAnchorPointY),
+        _billboard(std::static_pointer_cast<Billboard>(const_cast<Billboard&>(billboard).shared_from_this())),
+        _baseBillboard(billboard.getBaseBillboard()),
+        _bitmap(drawData._bitmap),
+        _animationStyle(drawData._animationStyle),
+        _coords(),
+        _flippable(drawData._flippable),
+        _horizontalOffset(drawData._horizontalOffset),
+        _verticalOffset(drawData._verticalOffset),
+        _genMipmaps(drawData._genMipmaps),
+        _orientationMode(drawData._orientationMode),
+        _causesOverlap(drawData._causesOverlap),
+        _hideIfOverlapped(drawData._hideIfOverlapped),
+        _overlapping(drawData._overlapping.load()),
+        _transition(drawData._transition.load()),
+        _placementPriority(drawData._placementPriority),
+        _pos(0, 0, 0),
+        _xAxis(1, 0, 0),
+        _yAxis(0, 1, 0),
+        _zAxis(0, 0, 1),
+        _moving(false),
+        _moveStartPos(0, 0, 0),
+        _moveEndPos(0, 0, 0),
+        _moveStartTime(),
+        _moveEndTime(),
+        _rotation(billboard.getRotation()),
+        _scaleWithDPI(drawData._scaleWithDPI),
+        _scalingMode(drawData._scalingMode),
+        _size(drawData._size),
+        _cameraPlaneZoomDistance(drawData._cameraPlaneZoomDistance),
+        _screenBottomDistance(drawData._screenBottomDistance),
+        _renderer()
+    {
+        // The position is recalculated, so it is not offset anymore
+        setIsOffset(false);
+
+        calculateTransform(billboard, projection, projectionSurface);
+    }
+
+    void BillboardDrawData::calculateTransform(const Billboard& billboard, const Projection& projection, const ProjectionSurface& projectionSurface) {
+        if (billboard.getGeometry()) {
+            MapPos internalPos = projection.toInternal(billboard.getGeometry()->getCenterPos());
+            _pos = projectionSurface.calculatePosition(internalPos);
+            _xAxis = cglib::vec3<float>::convert(cglib::unit(projectionSurface.calculateVector(internalPos, MapVec(1, 0, 0))));
+            _yAxis = cglib::vec3<float>::convert(cglib::unit(projectionSurface.calculateVector(internalPos, MapVec(0, 1, 0))));
+            _zAxis = cglib::vec3<float>::convert(cglib::unit(projectionSurface.calculateVector(internalPos, MapVec(0, 0, 1))));
+
+            if (std::shared_ptr<Billboard::Trajectory> trajectory = billboard.getTrajectory()) {
+                _moving = true;
+                _moveStartPos = projectionSurface.calculatePosition(projection.toInternal(trajectory->startPos));
+                _moveEndPos = _pos;
+                _moveStartTime = trajectory->startTime;
+                _moveEndTime = trajectory->endTime;
+                updateMovingPos(projectionSurface, std::chrono::steady_clock::now());
+            }
+        }
+
         float left = ((-_anchorPointX - 1.0f) * 0.5f * _size + _horizontalOffset);
         float right = left + _size;
         float bottom = ((-_anchorPointY - 1.0f) * 0.5f / _aspect * _size + _verticalOffset);
@@ -13,6 +13,7 @@
 #include <atomic>
 #include <memory>
 #include <array>
+#include <chrono>
 
 #include <cglib/vec.h>
 
@@ -73,6 +74,10 @@ namespace carto {
         const cglib::vec3<float>& getYAxis() const;
         const cglib::vec3<float>& getZAxis() const;
 
+        // Moving billboards are updated by the renderer, these two methods are called only from the render thread
+        bool isMoving() const;
+        void updateMovingPos(const ProjectionSurface& projectionSurface, std::chrono::steady_clock::time_point time);
+
         float getRotation() const;
         
         bool isScaleWithDPI() const;
@@ -109,6 +114,12 @@ namespace carto {
                           BillboardScaling::BillboardScaling _scalingMode,
                           float renderScale,
                           float size);
+        BillboardDrawData(const BillboardDrawData& drawData,
+                          const Billboard& billboard,
+                          const Projection& projection,
+                          const ProjectionSurface& projectionSurface);
+
+        void calculateTransform(const Billboard& billboard, const Projection& projection, const ProjectionSurface& projectionSurface);
     
         float _anchorPointX;
         float _anchorPointY;
@@ -148,6 +159,12 @@ namespace carto {
         cglib::vec3<float> _yAxis;
         cglib::vec3<float> _zAxis;
 
+        bool _moving;
+        cglib::vec3<double> _moveStartPos;
+        cglib::vec3<double> _moveEndPos;
+        std::chrono::steady_clock::time_point _moveStartTime;
+        std::chrono::steady_clock::time_point _moveEndTime;
+
         float _rotation;
         
         bool _scaleWithDPI;
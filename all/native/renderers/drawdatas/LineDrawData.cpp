@@ -1,6 +1,7 @@
 #include "LineDrawData.h"
 #include "core/MapPos.h"
 #include "geometry/LineGeometry.h"
+#include "geometry/utils/CompactMapPosList.h"
 #include "graphics/Bitmap.h"
 #include "graphics/utils/GLContext.h"
 #include "projections/Projection.h"
@@ -13,6 +14,7 @@
 
 #include <cmath>
 #include <unordered_map>
+#include <utility>
 
 namespace carto {
 
@@ -21,13 +23,21 @@ namespace carto {
         _bitmap(style.getBitmap()),
         _normalScale(style.getWidth() / 2),
         _clickScale(style.getClickWidth() == -1 ? std::max(1.0f, 1 + (IDEAL_CLICK_WIDTH - style.getWidth()) * CLICK_WIDTH_COEF / style.getWidth()) : style.getClickWidth()),
+        _boundingBox(cglib::bbox3<double>::smallest()),
+        _maxNormalLength(0),
+        _clipBounds(),
         _poses(),
         _coords(),
         _normals(),
         _texCoords(),
         _indices()
     {
-        init(geometry.getPoses(), projection, projectionSurface, style);
+        // Compact geometries are decoded only temporarily, the draw data keeps its own internal coordinates
+        if (std::shared_ptr<const CompactMapPosList> compactPoses = geometry.getCompactPoses()) {
+            init(compactPoses->getPoses(), projection, projectionSurface, style, GetInfiniteClipBounds());
+        } else {
+            init(geometry.getPoses(), projection, projectionSurface, style, GetInfiniteClipBounds());
+        }
     }
     
     LineDrawData::LineDrawData(const std::vector<MapPos>& poses, const LineStyle& style, const Projection& projection, const ProjectionSurface& projectionSurface) :
@@ -35,13 +45,54 @@ namespace carto {
         _bitmap(style.getBitmap()),
         _normalScale(style.getWidth() / 2),
         _clickScale(std::max(1.0f, 1 + (IDEAL_CLICK_WIDTH - style.getWidth()) * CLICK_WIDTH_COEF / style.getWidth())),
+        _boundingBox(cglib::bbox3<double>::smallest()),
+        _maxNormalLength(0),
+        _clipBounds(),
         _poses(),
         _coords(),
         _normals(),
         _texCoords(),
         _indices()
     {
-        init(poses, projection, projectionSurface, style);
+        init(poses, projection, projectionSurface, style, GetInfiniteClipBounds());
+    }
+
+    LineDrawData::LineDrawData(const LineGeometry& geometry, const LineStyle& style, const Projection& projection, const ProjectionSurface& projectionSurface, const MapBounds& clipBounds) :
+        VectorElementDrawData(style.getColor()),
+        _bitmap(style.getBitmap()),
+        _normalScale(style.getWidth() / 2),
+        _clickScale(style.getClickWidth() == -1 ? std::max(1.0f, 1 + (IDEAL_CLICK_WIDTH - style.getWidth()) * CLICK_WIDTH_COEF / style.getWidth()) : style.getClickWidth()),
+        _boundingBox(cglib::bbox3<double>::smallest()),
+        _maxNormalLength(0),
+        _clipBounds(),
+        _poses(),
+        _coords(),
+        _normals(),
+        _texCoords(),
+        _indices()
+    {
+        if (std::shared_ptr<const CompactMapPosList> compactPoses = geometry.getCompactPoses()) {
+            init(compactPoses->getPoses(), projection, projectionSurface, style, clipBounds);
+        } else {
+            init(geometry.getPoses(), projection, projectionSurface, style, clipBounds);
+        }
+    }
+
+    LineDrawData::LineDrawData(const std::vector<MapPos>& poses, const LineStyle& style, const Projection& projection, const ProjectionSurface& projectionSurface, const MapBounds& clipBounds) :
+        VectorElementDrawData(style.getColor()),
+        _bitmap(style.getBitmap()),
+        _normalScale(style.getWidth() / 2),
+        _clickScale(std::max(1.0f, 1 + (IDEAL_CLICK_WIDTH - style.getWidth()) * CLICK_WIDTH_COEF / style.getWidth())),
+        _boundingBox(cglib::bbox3<double>::smallest()),
+        _maxNormalLength(0),
+        _clipBounds(),
+        _poses(),
+        _coords(),
+        _normals(),
+        _texCoords(),
+        _indices()
+    {
+        init(poses, projection, projectionSurface, style, clipBounds);
     }
         
     LineDrawData::~LineDrawData() {
@@ -58,16 +109,28 @@ namespace carto {
     float LineDrawData::getClickScale() const {
         return _clickScale;
     }
+
+    const cglib::bbox3<double>& LineDrawData::getBoundingBox() const {
+        return _boundingBox;
+    }
+
+    float LineDrawData::getMaxNormalLength() const {
+        return _maxNormalLength;
+    }
+
+    const MapBounds& LineDrawData::getClipBounds() const {
+        return _clipBounds;
+    }
     
     const std::vector<std::vector<cglib::vec3<double>*> >& LineDrawData::getCoords() const {
         return _coords;
     }
     
-    const std::vector<std::vector<cglib::vec4<float> > >& LineDrawData::getNormals() const {
+    const std::vector<std::vector<cglib::vec3<float> > >& LineDrawData::getNormals() const {
         return _normals;
     }
     
-    const std::vector<std::vector<cglib::vec2<float> > >& LineDrawData::getTexCoords() const {
+    const std::vector<std::vector<cglib::vec4<float> > >& LineDrawData::getTexCoords() const {
         return _texCoords;
     }
     
@@ -79,54 +142,189 @@ namespace carto {
         for (cglib::vec3<double>& pos : _poses) {
             pos(0) += offset;
         }
+        if (!_poses.empty()) {
+            _boundingBox.min(0) += offset;
+            _boundingBox.max(0) += offset;
+        }
         setIsOffset(true);
     }
     
-    void LineDrawData::init(const std::vector<MapPos>& poses, const Projection& projection, const ProjectionSurface& projectionSurface, const LineStyle& style) {
-        // Calculate real coordinates and tesselate the line
+    void LineDrawData::init(const std::vector<MapPos>& poses, const Projection& projection, const ProjectionSurface& projectionSurface, const LineStyle& style, const MapBounds& clipBounds) {
+        // Find the ranges of consecutive line segments touching the clip bounds. Other segments are not tesselated
+        std::vector<MapPos> internalPoses(poses.size());
+        projection.toInternal(poses.data(), internalPoses.data(), poses.size());
+        std::vector<std::pair<std::size_t, std::size_t> > segmentRanges;
+        for (std::size_t i = 1; i < internalPoses.size(); i++) {
+            MapBounds segmentBounds;
+            segmentBounds.expandToContain(internalPoses[i - 1]);
+            segmentBounds.expandToContain(internalPoses[i]);
+            if (!clipBounds.intersects(segmentBounds)) {
+                continue;
+            }
+            if (!segmentRanges.empty() && segmentRanges.back().second == i - 1) {
+                segmentRanges.back().second = i;
+            } else {
+                segmentRanges.emplace_back(i - 1, i);
+            }
+        }
+        bool clipped = !(segmentRanges.size() == 1 && segmentRanges.front().first == 0 && segmentRanges.front().second + 1 == internalPoses.size());
+        _clipBounds = (clipped ? clipBounds : GetInfiniteClipBounds());
+
+        // Calculate real coordinates for each range. Also keep track of the line length before each range, so that texture coordinates are continuous
         std::vector<cglib::vec3<float> > posNormals;
-        _poses.reserve(poses.size());
-        posNormals.reserve(poses.size());
-        std::vector<MapPos> internalPoses;
-        for (std::size_t i = 1; i < poses.size(); i++) {
-            internalPoses.clear();
-            projectionSurface.tesselateSegment(projection.toInternal(poses[i - 1]), projection.toInternal(poses[i]), internalPoses);
-            for (const MapPos& internalPos : internalPoses) {
-                cglib::vec3<double> pos = projectionSurface.calculatePosition(internalPos);
-                if (_poses.empty() || pos != _poses.back()) {
-                    _poses.push_back(pos);
-                    posNormals.push_back(cglib::vec3<float>::convert(projectionSurface.calculateNormal(internalPos)));
+        _poses.reserve(internalPoses.size());
+        posNormals.reserve(internalPoses.size());
+        std::vector<std::pair<std::size_t, std::size_t> > poseRanges;
+        std::vector<double> rangeLengths;
+        double lineLength = 0;
+        std::size_t lastPoseIndex = 0;
+        std::vector<MapPos> segmentPoses;
+        std::vector<cglib::vec3<double> > segmentPositions;
+        for (const std::pair<std::size_t, std::size_t>& segmentRange : segmentRanges) {
+            for (std::size_t i = lastPoseIndex; i < segmentRange.first; i++) {
+                lineLength += cglib::length(projectionSurface.calculatePosition(internalPoses[i + 1]) - projectionSurface.calculatePosition(internalPoses[i]));
+            }
+            lastPoseIndex = segmentRange.second;
+
+            std::size_t poseBegin = _poses.size();
+            rangeLengths.push_back(lineLength);
+            for (std::size_t i = segmentRange.first + 1; i <= segmentRange.second; i++) {
+                segmentPoses.clear();
+                projectionSurface.tesselateSegment(internalPoses[i - 1], internalPoses[i], segmentPoses);
+                segmentPositions.resize(segmentPoses.size());
+                projectionSurface.calculatePositions(segmentPoses.data(), segmentPositions.data(), segmentPoses.size());
+                for (std::size_t j = 0; j < segmentPoses.size(); j++) {
+                    const cglib::vec3<double>& pos = segmentPositions[j];
+                    if (_poses.size() == poseBegin || pos != _poses.back()) {
+                        if (_poses.size() > poseBegin) {
+                            lineLength += cglib::length(pos - _poses.back());
+                        }
+                        _poses.push_back(pos);
+                        posNormals.push_back(cglib::vec3<float>::convert(projectionSurface.calculateNormal(segmentPoses[j])));
+                    }
                 }
             }
+            poseRanges.emplace_back(poseBegin, _poses.size());
+        }
+
+        // Tesselate each range separately. Ranges are stored as different polylines in the same buffers
+        std::vector<cglib::vec3<double>*> coords;
+        std::vector<cglib::vec3<float> > normals;
+        std::vector<cglib::vec4<float> > texCoords;
+        std::vector<unsigned int> indices;
+        float texCoordYScale = _bitmap->getWidth() / (style.getStretchFactor() * _bitmap->getHeight() * style.getWidth());
+        for (std::size_t i = 0; i < poseRanges.size(); i++) {
+            if (poseRanges[i].second - poseRanges[i].first < 2) {
+                continue;
+            }
+            float texCoordYStart = static_cast<float>(std::fmod(rangeLengths[i] * texCoordYScale, 1.0));
+            tesselateLine(poseRanges[i].first, poseRanges[i].second, posNormals, style, texCoordYStart, coords, normals, texCoords, indices);
         }
 
-        if (_poses.size() < 2) {
+        // Calculate the bounds used to quickly reject lines in click tests
+        for (const cglib::vec3<double>& pos : _poses) {
+            _boundingBox.add(pos);
+        }
+        for (const cglib::vec3<float>& normal : normals) {
+            _maxNormalLength = std::max(_maxNormalLength, cglib::length(normal));
+        }
+
+        if (indices.empty()) {
             _coords.clear();
             _normals.clear();
             _texCoords.clear();
             _indices.clear();
             return;
         }
+
+        std::size_t maxBufferSize = GLContext::GetMaxVertexBufferSize();
+        _coords.push_back(std::vector<cglib::vec3<double>*>());
+        _normals.push_back(std::vector<cglib::vec3<float> >());
+        _texCoords.push_back(std::vector<cglib::vec4<float> >());
+        _indices.push_back(std::vector<unsigned int>());
+        if (indices.size() <= maxBufferSize) {
+            _coords.back().swap(coords);
+            _normals.back().swap(normals);
+            _texCoords.back().swap(texCoords);
+            _indices.back().swap(indices);
+        } else {
+            // Buffers too big, split into multiple buffers
+            _coords.back().reserve(std::min(coords.size(), maxBufferSize));
+            _normals.back().reserve(std::min(normals.size(), maxBufferSize));
+            _texCoords.back().reserve(std::min(texCoords.size(), maxBufferSize));
+            _indices.back().reserve(std::min(indices.size(), maxBufferSize));
+            std::unordered_map<unsigned int, unsigned int> indexMap;
+            indexMap.reserve(indices.size() * 2);
+            for (std::size_t i = 0; i < indices.size(); i += 3) {
+                
+                // Check for possible GL buffer overflow
+                if (_indices.back().size() + 3 > maxBufferSize) {
+                    // The buffer is full, create a new one
+                    _coords.back().shrink_to_fit();
+                    _coords.push_back(std::vector<cglib::vec3<double>*>());
+                    _coords.back().reserve(std::min(coords.size(), GLContext::MAX_VERTEXBUFFER_SIZE));
+                    _normals.back().shrink_to_fit();
+                    _normals.push_back(std::vector<cglib::vec3<float> >());
+                    _normals.back().reserve(std::min(normals.size(), GLContext::MAX_VERTEXBUFFER_SIZE));
+                    _texCoords.back().shrink_to_fit();
+                    _texCoords.push_back(std::vector<cglib::vec4<float> >());
+                    _texCoords.back().reserve(std::min(texCoords.size(), GLContext::MAX_VERTEXBUFFER_SIZE));
+                    _indices.back().shrink_to_fit();
+                    _indices.push_back(std::vector<unsigned int>());
+                    _indices.back().reserve(std::min(indices.size(), GLContext::MAX_VERTEXBUFFER_SIZE));
+                    indexMap.clear();
+                }
+                
+                for (int j = 0; j < 3; j++) {
+                    unsigned int index = static_cast<unsigned int>(indices[i + j]);
+                    auto it = indexMap.find(index);
+                    if (it == indexMap.end()) {
+                        unsigned int newIndex = static_cast<unsigned int>(_coords.back().size());
+                        _coords.back().push_back(coords[index]);
+                        _normals.back().push_back(normals[index]);
+                        _texCoords.back().push_back(texCoords[index]);
+                        _indices.back().push_back(newIndex);
+                        indexMap[index] = newIndex;
+                    } else {
+                        _indices.back().push_back(it->second);
+                    }
+                }
+            }
+        }
+        
+        _coords.back().shrink_to_fit();
+        _normals.back().shrink_to_fit();
+        _texCoords.back().shrink_to_fit();
+        _indices.back().shrink_to_fit();
+    }
     
+    void LineDrawData::tesselateLine(std::size_t begin, std::size_t end, const std::vector<cglib::vec3<float> >& posNormals, const LineStyle& style, float texCoordYStart,
+                                     std::vector<cglib::vec3<double>*>& coords, std::vector<cglib::vec3<float> >& normals, std::vector<cglib::vec4<float> >& texCoords, std::vector<unsigned int>& indices)
+    {
+        cglib::vec3<double>* poses = &_poses[begin];
+        const cglib::vec3<float>* poseNormals = &posNormals[begin];
+        std::size_t poseCount = end - begin;
+
         // Detect looped line
-        bool loopedLine = (_poses.front() == _poses.back()) && (_poses.size() > 2);
+        bool loopedLine = (poses[0] == poses[poseCount - 1]) && (poseCount > 2);
 
         // Detect if we must tesselate line joins
         bool tesselateLineJoin = (style.getLineJoinType() == LineJoinType::LINE_JOIN_TYPE_BEVEL || style.getLineJoinType() == LineJoinType::LINE_JOIN_TYPE_ROUND);
-    
-        // Calculate angles between lines and buffers sizes
-        std::size_t coordCount = (_poses.size() - 1) * 4;
-        std::size_t indexCount = (_poses.size() - 1) * 6;
-        std::vector<float> deltaAngles(_poses.size() - 1);
+
+        // Calculate angles between lines and buffers sizes. Round joins and end points are not tesselated,
+        // they are covered by a few quads that the fragment shader clips to circles, so the sizes do not depend on the line width
+        std::size_t coordCount = (poseCount - 1) * 4;
+        std::size_t indexCount = (poseCount - 1) * 6;
+        std::vector<float> deltaAngles(poseCount - 1);
         cglib::vec3<float> prevLineVec(0, 0, 0);
         if (tesselateLineJoin) {
-            for (std::size_t i = 0; i < _poses.size(); i++) {
-                if (!loopedLine && i + 1 >= _poses.size()) {
+            for (std::size_t i = 0; i < poseCount; i++) {
+                if (!loopedLine && i + 1 >= poseCount) {
                     break;
                 }
-    
-                const cglib::vec3<double>& pos = _poses[i];
-                const cglib::vec3<double>& nextPos = (i + 1 < _poses.size()) ? _poses[i + 1] : _poses[1];
+
+                const cglib::vec3<double>& pos = poses[i];
+                const cglib::vec3<double>& nextPos = (i + 1 < poseCount) ? poses[i + 1] : poses[1];
                 if (nextPos == pos) {
                     continue;
                 }
@@ -135,60 +333,60 @@ namespace carto {
                 double dot = cglib::dot_product(prevLineVec, nextLineVec);
                 if (cglib::norm(prevLineVec) > 0) {
                     float deltaAngle = static_cast<float>(std::acos(std::max(-1.0, std::min(1.0, dot))) * Const::RAD_TO_DEG);
-                    if (cglib::dot_product(posNormals[i], cglib::vector_product(prevLineVec, nextLineVec)) < 0) {
+                    if (cglib::dot_product(poseNormals[i], cglib::vector_product(prevLineVec, nextLineVec)) < 0) {
                         deltaAngle = -deltaAngle;
                     }
                     deltaAngles[i - 1] = deltaAngle;
-    
-                    int segments = 0;
-                    if (style.getLineJoinType() == LineJoinType::LINE_JOIN_TYPE_BEVEL) {
-                        segments = deltaAngle != 0 ? 1 : 0;
-                    } else { //style.getLineJoinType() == LineJoinType::ROUND
-                        segments = static_cast<int>(std::ceil(std::abs(deltaAngle) * style.getWidth() * LINE_ENDPOINT_TESSELATION_FACTOR));
+
+                    if (deltaAngle != 0) {
+                        if (style.getLineJoinType() == LineJoinType::LINE_JOIN_TYPE_BEVEL) {
+                            coordCount += 1;
+                            indexCount += 3;
+                        } else { //style.getLineJoinType() == LineJoinType::ROUND
+                            int wedges = (std::abs(deltaAngle) > LINE_JOIN_MAX_WEDGE_ANGLE ? 2 : 1);
+                            coordCount += wedges * 2 + 2;
+                            indexCount += wedges * 2 * 3;
+                        }
                     }
-    
-                    coordCount += segments;
-                    indexCount += segments * 3;
                 }
-    
+
                 prevLineVec = nextLineVec;
             }
         }
-    
-        // Endpoints need a bigger buffer
-        if (!loopedLine && style.getLineEndType() == LineEndType::LINE_END_TYPE_ROUND) {
-            int segments = static_cast<int>(180 * style.getWidth() * LINE_ENDPOINT_TESSELATION_FACTOR);
-            coordCount += segments * 2;
-            indexCount += segments * 3 * 2;
+
+        // Both end points are covered by a single quad
+        if (!loopedLine && style.getLineEndType() != LineEndType::LINE_END_TYPE_NONE) {
+            coordCount += 2 * 2;
+            indexCount += 6 * 2;
         }
-    
+
         // Texture bounds
         float texCoordX = 1.0f;
-        float texCoordY = 0.0f;
+        float texCoordY = texCoordYStart;
         float texCoordYScale = _bitmap->getWidth() / (style.getStretchFactor() * _bitmap->getHeight() * style.getWidth());
         bool useTexCoordY = _bitmap->getHeight() > 1;
 
         // Instead of calculating actual vertex positions calculate vertex origins and normals
         // Actual vertex positions are view dependent and will be calculated in the renderer
-        std::vector<cglib::vec3<double>*> coords;
-        std::vector<cglib::vec4<float> > normals;
-        std::vector<cglib::vec2<float> > texCoords;
-        std::vector<unsigned int> indices;
-        coords.reserve(coordCount);
-        normals.reserve(coordCount);
-        texCoords.reserve(coordCount);
-        indices.reserve(indexCount);
+        if (coords.capacity() < coords.size() + coordCount) {
+            coords.reserve(std::max(coords.size() + coordCount, coords.capacity() * 2));
+            normals.reserve(std::max(normals.size() + coordCount, normals.capacity() * 2));
+            texCoords.reserve(std::max(texCoords.size() + coordCount, texCoords.capacity() * 2));
+        }
+        if (indices.capacity() < indices.size() + indexCount) {
+            indices.reserve(std::max(indices.size() + indexCount, indices.capacity() * 2));
+        }
 
         // Calculate initial state for line string
-        cglib::vec3<float> nextLine = cglib::vec3<float>::convert(_poses[1] - _poses[0]);
-        cglib::vec3<float> nextPerpVec = cglib::unit(cglib::vector_product(posNormals[1], nextLine));
+        cglib::vec3<float> nextLine = cglib::vec3<float>::convert(poses[1] - poses[0]);
+        cglib::vec3<float> nextPerpVec = cglib::unit(cglib::vector_product(poseNormals[1], nextLine));
 
         cglib::vec3<float> nextNormalVec = nextPerpVec;
         bool resetNormalVec = true;
         if (style.getLineJoinType() == LineJoinType::LINE_JOIN_TYPE_MITER) {
             if (loopedLine) {
-                cglib::vec3<float> prevLine = cglib::vec3<float>::convert(_poses[0] - _poses[_poses.size() - 2]);
-                cglib::vec3<float> prevPerpVec = cglib::unit(cglib::vector_product(posNormals[0], prevLine));
+                cglib::vec3<float> prevLine = cglib::vec3<float>::convert(poses[0] - poses[poseCount - 2]);
+                cglib::vec3<float> prevPerpVec = cglib::unit(cglib::vector_product(poseNormals[0], prevLine));
 
                 float dot = cglib::dot_product(prevPerpVec, nextPerpVec);
                 if (dot >= LINE_JOIN_MIN_MITER_DOT) {
@@ -201,20 +399,21 @@ namespace carto {
         // Loop over line segments
         cglib::vec3<float> firstPerpVec;
         cglib::vec3<float> lastPerpVec;
-        unsigned int vertexIndex = 0;
-        for (std::size_t i = 1; i < _poses.size(); i++) {
-            std::size_t i1 = i + 1 < _poses.size() ? i + 1 : 1;
-            
-            cglib::vec3<double>& pos = _poses[i];
-            cglib::vec3<double>& prevPos = _poses[i - 1];
-            cglib::vec3<double>& nextPos = _poses[i1];
+        unsigned int baseIndex = static_cast<unsigned int>(coords.size());
+        unsigned int vertexIndex = baseIndex;
+        for (std::size_t i = 1; i < poseCount; i++) {
+            std::size_t i1 = i + 1 < poseCount ? i + 1 : 1;
+
+            cglib::vec3<double>& pos = poses[i];
+            cglib::vec3<double>& prevPos = poses[i - 1];
+            cglib::vec3<double>& nextPos = poses[i1];
 
             // Calculate line body
             cglib::vec3<float> prevLine = cglib::vec3<float>::convert(pos - prevPos);
-            cglib::vec3<float> prevPerpVec = cglib::unit(cglib::vector_product(posNormals[i], prevLine));
+            cglib::vec3<float> prevPerpVec = cglib::unit(cglib::vector_product(poseNormals[i], prevLine));
 
             // Trick to reuse already generated vertex data (only for mitered lines)
-            if (!resetNormalVec && vertexIndex >= 2) {
+            if (!resetNormalVec && vertexIndex >= baseIndex + 2) {
                 vertexIndex -= 2;
                 coords.pop_back();
                 coords.pop_back();
@@ -229,9 +428,9 @@ namespace carto {
             resetNormalVec = true;
 
             if (style.getLineJoinType() == LineJoinType::LINE_JOIN_TYPE_MITER) {
-                if (i + 1 < _poses.size() || loopedLine) {
+                if (i + 1 < poseCount || loopedLine) {
                     cglib::vec3<float> nextLine = cglib::vec3<float>::convert(nextPos - pos);
-                    cglib::vec3<float> nextPerpVec = cglib::unit(cglib::vector_product(posNormals[i1], nextLine));
+                    cglib::vec3<float> nextPerpVec = cglib::unit(cglib::vector_product(poseNormals[i1], nextLine));
 
                     float dot = cglib::dot_product(prevPerpVec, nextPerpVec);
                     if (dot >= LINE_JOIN_MIN_MITER_DOT) {
@@ -244,7 +443,7 @@ namespace carto {
             if (i == 1) {
                 firstPerpVec = prevPerpVec;
             }
-            if (i == _poses.size() - 1) {
+            if (i == poseCount - 1) {
                 lastPerpVec = prevPerpVec;
             }
 
@@ -253,25 +452,25 @@ namespace carto {
             coords.push_back(&prevPos);
             coords.push_back(&pos);
             coords.push_back(&pos);
-            
+
             if (useTexCoordY) {
                 float texCoordYOffset = cglib::length(prevLine) * texCoordYScale;
-                texCoords.push_back(cglib::vec2<float>(0, texCoordY));
-                texCoords.push_back(cglib::vec2<float>(texCoordX, texCoordY));
-                texCoords.push_back(cglib::vec2<float>(0, texCoordY + texCoordYOffset));
-                texCoords.push_back(cglib::vec2<float>(texCoordX, texCoordY + texCoordYOffset));
+                texCoords.push_back(cglib::vec4<float>(0, texCoordY, 1, 0));
+                texCoords.push_back(cglib::vec4<float>(texCoordX, texCoordY, -1, 0));
+                texCoords.push_back(cglib::vec4<float>(0, texCoordY + texCoordYOffset, 1, 0));
+                texCoords.push_back(cglib::vec4<float>(texCoordX, texCoordY + texCoordYOffset, -1, 0));
                 texCoordY += texCoordYOffset;
             } else {
-                texCoords.push_back(cglib::vec2<float>(0, 0.5f));
-                texCoords.push_back(cglib::vec2<float>(texCoordX, 0.5f));
-                texCoords.push_back(cglib::vec2<float>(0, 0.5f));
-                texCoords.push_back(cglib::vec2<float>(texCoordX, 0.5f));
+                texCoords.push_back(cglib::vec4<float>(0, 0.5f, 1, 0));
+                texCoords.push_back(cglib::vec4<float>(texCoordX, 0.5f, -1, 0));
+                texCoords.push_back(cglib::vec4<float>(0, 0.5f, 1, 0));
+                texCoords.push_back(cglib::vec4<float>(texCoordX, 0.5f, -1, 0));
             }
 
-            normals.push_back(cglib::expand(prevNormalVec, 1.0f));
-            normals.push_back(cglib::expand(prevNormalVec, -1.0f));
-            normals.push_back(cglib::expand(nextNormalVec, 1.0f));
-            normals.push_back(cglib::expand(nextNormalVec, -1.0f));
+            normals.push_back(prevNormalVec);
+            normals.push_back(prevNormalVec * -1.0f);
+            normals.push_back(nextNormalVec);
+            normals.push_back(nextNormalVec * -1.0f);
 
             indices.push_back(vertexIndex + 0);
             indices.push_back(vertexIndex + 1);
@@ -279,221 +478,106 @@ namespace carto {
             indices.push_back(vertexIndex + 1);
             indices.push_back(vertexIndex + 3);
             indices.push_back(vertexIndex + 2);
-            
+
             vertexIndex += 4;
-            
+
             // Calculate line joins, if necessary
-            if (tesselateLineJoin && (i + 1 <  _poses.size() || loopedLine)) {
+            if (tesselateLineJoin && (i + 1 <  poseCount || loopedLine) && deltaAngles[i - 1] != 0) {
                 float deltaAngle = deltaAngles[i - 1];
-                
-                int segments = 0;
+                bool leftTurn = (deltaAngle < 0);
                 if (style.getLineJoinType() == LineJoinType::LINE_JOIN_TYPE_BEVEL) {
-                    segments = deltaAngle != 0 ? 1 : 0;
+                    // Add the t vertex, the triangle uses the last vertex of this line and the first vertex of the next line on the outer side
+                    coords.push_back(&pos);
+                    normals.push_back(cglib::vec3<float>(0, 0, 0));
+                    texCoords.push_back(cglib::vec4<float>(0.5f, texCoordY, 0, 0));
+
+                    indices.push_back(vertexIndex);
+                    if (leftTurn) {
+                        indices.push_back((i == poseCount - 1) ? baseIndex : (vertexIndex + 1));
+                        indices.push_back(vertexIndex - 2);
+                    } else {
+                        indices.push_back(vertexIndex - 1);
+                        indices.push_back((i == poseCount - 1) ? baseIndex + 1 : (vertexIndex + 2));
+                    }
+
+                    vertexIndex += 1;
                 } else { // style.getLineJoinType() == LineJoinType::ROUND
-                    segments = static_cast<int>(std::ceil(std::abs(deltaAngle) * style.getWidth() * LINE_JOIN_TESSELATION_FACTOR));
-                }
-                if (segments > 0) {
-                    float segmentDeltaAngle = deltaAngle / segments;
-                    cglib::mat2x2<float> rot2DMat = cglib::rotate2_matrix(static_cast<float>(segmentDeltaAngle * Const::DEG_TO_RAD));
-                    cglib::mat3x3<float> rot3DMat = cglib::rotate3_matrix(posNormals[i], static_cast<float>(segmentDeltaAngle * Const::DEG_TO_RAD));
-                    bool leftTurn = (deltaAngle <= 0);
-                    cglib::vec3<float> rotVec = prevNormalVec;
-                    
+                    // Cover the outer wedge between the lines with a fan of quads reaching the miter points of the sub-wedges.
+                    // The join vertices have their own distance coordinates in the frame of this line, as the fragment shader clips the fan to a circle
+                    int wedges = (std::abs(deltaAngle) > LINE_JOIN_MAX_WEDGE_ANGLE ? 2 : 1);
+                    float halfWedgeAngle = static_cast<float>(deltaAngle / (wedges * 2) * Const::DEG_TO_RAD);
+                    cglib::mat3x3<float> rot3DMat = cglib::rotate3_matrix(poseNormals[i], halfWedgeAngle);
+                    float miterScale = 1 / std::cos(halfWedgeAngle);
+                    float side = (leftTurn ? 1.0f : -1.0f);
+                    cglib::vec3<float> lineDir = cglib::unit(prevLine);
+                    cglib::vec3<float> rotVec = prevPerpVec;
+
                     // Add the t vertex
                     coords.push_back(&pos);
-                    normals.push_back(cglib::expand(rotVec, 0.0f));
-                    texCoords.push_back(cglib::vec2<float>(0.5f, texCoordY));
-                    
-                    // Add vertices and normals, do not create double vertices anywhere
-                    for (int j = 0; j < segments - 1; j++) {
-                        rotVec = cglib::transform(rotVec, rot3DMat);
+                    normals.push_back(cglib::vec3<float>(0, 0, 0));
+                    texCoords.push_back(cglib::vec4<float>(0.5f, texCoordY, 0, 0));
+
+                    // Add the outer vertices, alternating between the points on the circle and the miter points
+                    for (int j = 0; j <= wedges * 2; j++) {
+                        cglib::vec3<float> normalVec = rotVec * (j % 2 == 1 ? miterScale * side : side);
                         coords.push_back(&pos);
-                        normals.push_back(cglib::expand(rotVec, leftTurn ? 1.0f : -1.0f));
-                        texCoords.push_back(cglib::vec2<float>(leftTurn ? 0.0f : 1.0f, texCoordY));
+                        normals.push_back(normalVec);
+                        texCoords.push_back(cglib::vec4<float>(leftTurn ? 0.0f : 1.0f, texCoordY, cglib::dot_product(normalVec, prevPerpVec), cglib::dot_product(normalVec, lineDir)));
+                        rotVec = cglib::transform(rotVec, rot3DMat);
                     }
-                    
-                    // Add indices, make use of existing and future line's vertices
-                    if (deltaAngle <= 0) {
-                        for (int j = 0; j < segments; j++) {
-                            indices.push_back(vertexIndex);
-                            if (j == segments - 1) {
-                                indices.push_back((i == _poses.size() - 1) ? 0 : (vertexIndex + j + 1));
-                            } else {
-                                indices.push_back(vertexIndex + j + 1);
-                            }
-                            indices.push_back((j == 0) ? vertexIndex - 2 : (vertexIndex + j));
-                        }
-                    } else {
-                        for (int j = 0; j < segments; j++) {
-                            indices.push_back(vertexIndex);
-                            indices.push_back((j == 0) ? vertexIndex - 1 : (vertexIndex + j));
-                            if (j == segments - 1) {
-                                indices.push_back((i == _poses.size() - 1) ? 1 : (vertexIndex + j + 2));
-                            } else {
-                                indices.push_back(vertexIndex + j + 1);
-                            }
-                        }
+
+                    for (int j = 0; j < wedges * 2; j++) {
+                        indices.push_back(vertexIndex);
+                        indices.push_back(vertexIndex + j + 1);
+                        indices.push_back(vertexIndex + j + 2);
                     }
-                    
-                    vertexIndex += segments;
+
+                    vertexIndex += wedges * 2 + 2;
                 }
             }
         }
-        
-        // Calculate line end points
+
+        // Calculate line end points. Both end point types use a quad extending the line by half of its width,
+        // round end points are clipped to a circle by the fragment shader
         if (!loopedLine && style.getLineEndType() != LineEndType::LINE_END_TYPE_NONE) {
-            int segments = 0;
-            float segmentDeltaAngle = 0.0f;
-            if (style.getLineEndType() == LineEndType::LINE_END_TYPE_SQUARE) {
-                segments = 3;
-                segmentDeltaAngle = 45.0f;
-            } else { // style.getLineEndType() == LineEndType::SQUARE
-                segments = static_cast<int>(180 * style.getWidth() * LINE_ENDPOINT_TESSELATION_FACTOR);
-                segmentDeltaAngle = 180.0f / (segments - 1);
-            }
-            if (segments > 1) {
-                cglib::mat2x2<float> rot2DMat = cglib::rotate2_matrix(static_cast<float>(segmentDeltaAngle * Const::DEG_TO_RAD));
-                
-                // Add the t vertex
-                coords.push_back(&_poses[_poses.size() - 1]);
-                normals.push_back(cglib::expand(lastPerpVec, 0.0f));
-                texCoords.push_back(cglib::vec2<float>(0.5f, texCoordY));
-                
-                if (style.getLineEndType() == LineEndType::LINE_END_TYPE_ROUND) {
-                    // Last end point, lastLine contains the last valid line segment
-                    cglib::mat3x3<float> rot3DMat = cglib::rotate3_matrix(posNormals[_poses.size() - 1], static_cast<float>(segmentDeltaAngle * Const::DEG_TO_RAD));
-                    cglib::vec3<float> rotVec = lastPerpVec;
-                    cglib::vec2<float> uvRotVec(-1, 0);
-                
-                    // Vertices
-                    for (int i = 0; i < segments - 1; i++) {
-                        rotVec = cglib::transform(rotVec, rot3DMat);
-                        uvRotVec = cglib::transform(uvRotVec, rot2DMat);
-                        coords.push_back(&_poses[_poses.size() - 1]);
-                        normals.push_back(cglib::expand(rotVec, -1.0f));
-                        texCoords.push_back(cglib::vec2<float>(uvRotVec(0) * 0.5f + 0.5f, texCoordY));
-                    }
-                } else {
-                    // Vertices
-                    for (int s = -1; s <= 1; s += 2) {
-                        cglib::mat3x3<float> rot3DMat = cglib::rotate3_matrix(posNormals[_poses.size() - 1], static_cast<float>(-s * segmentDeltaAngle * Const::DEG_TO_RAD));
-                        cglib::vec3<float> normalVec = cglib::transform(lastPerpVec, rot3DMat) * std::sqrt(2.0f);
-                        coords.push_back(&_poses[_poses.size() - 1]);
-                        normals.push_back(cglib::expand(normalVec, static_cast<float>(s)));
-                        texCoords.push_back(cglib::vec2<float>(s * 0.5f + 0.5f, texCoordY));
-                    }
-                }
-                
-                // Indices
-                for (int j = 0; j < segments; j++) {
-                    indices.push_back(vertexIndex);
-                    indices.push_back((j == 0) ? vertexIndex - 1 : (vertexIndex + j));
-                    indices.push_back((j == segments - 1) ? vertexIndex - 2 : (vertexIndex + j + 1));
-                }
-                vertexIndex += segments;
-                
-                // Add the t vertex for the other end point
-                coords.push_back(&_poses[0]);
-                normals.push_back(cglib::expand(firstPerpVec, 0.0f));
-                texCoords.push_back(cglib::vec2<float>(0.5f, 0));
-                
-                if (style.getLineEndType() == LineEndType::LINE_END_TYPE_ROUND) {
-                    // First end point, firstLine contains the first valid line segment
-                    cglib::mat3x3<float> rot3DMat = cglib::rotate3_matrix(posNormals[0], static_cast<float>(segmentDeltaAngle * Const::DEG_TO_RAD));
-                    cglib::vec3<float> rotVec = firstPerpVec;
-                    cglib::vec2<float> uvRotVec(1, 0);
-                
-                    // Vertices
-                    for (int i = 0; i < segments - 1; i++) {
-                        rotVec = cglib::transform(rotVec, rot3DMat);
-                        uvRotVec = cglib::transform(uvRotVec, rot2DMat);
-                        coords.push_back(&_poses[0]);
-                        normals.push_back(cglib::expand(rotVec, 1.0f));
-                        texCoords.push_back(cglib::vec2<float>(uvRotVec(0) * 0.5f + 0.5f, 0));
-                    }
-                } else {
-                    // Vertices
-                    for (int s = 1; s >= -1; s -= 2) {
-                        cglib::mat3x3<float> rot3DMat = cglib::rotate3_matrix(posNormals[0], static_cast<float>(s * segmentDeltaAngle * Const::DEG_TO_RAD));
-                        cglib::vec3<float> normalVec = cglib::transform(firstPerpVec, rot3DMat) * std::sqrt(2.0f);
-                        coords.push_back(&_poses[0]);
-                        normals.push_back(cglib::expand(normalVec, static_cast<float>(s)));
-                        texCoords.push_back(cglib::vec2<float>(s * 0.5f + 0.5f, 0));
-                    }
-                }
-                
-                // Indices
-                for (int j = 0; j < segments; j++) {
-                    indices.push_back(vertexIndex);
-                    indices.push_back((j == 0) ? 0 : (vertexIndex + j));
-                    indices.push_back((j == segments - 1) ? 1 : (vertexIndex + j + 1));
-                }
-                vertexIndex += segments;
+            float endDist = (style.getLineEndType() == LineEndType::LINE_END_TYPE_ROUND ? 1.0f : 0.0f);
+
+            // Last end point, the quad continues from the last two vertices of the last line segment
+            cglib::vec3<float> lastLineDir = cglib::unit(cglib::vec3<float>::convert(poses[poseCount - 1] - poses[poseCount - 2]));
+            for (int s = 1; s >= -1; s -= 2) {
+                coords.push_back(&poses[poseCount - 1]);
+                normals.push_back(lastPerpVec * static_cast<float>(s) + lastLineDir);
+                texCoords.push_back(cglib::vec4<float>(s > 0 ? 0.0f : texCoordX, texCoordY, static_cast<float>(s), endDist));
             }
-        }
-        
-        _coords.push_back(std::vector<cglib::vec3<double>*>());
-        _normals.push_back(std::vector<cglib::vec4<float> >());
-        _texCoords.push_back(std::vector<cglib::vec2<float> >());
-        _indices.push_back(std::vector<unsigned int>());
-        if (indices.size() <= GLContext::MAX_VERTEXBUFFER_SIZE) {
-            _coords.back().swap(coords);
-            _normals.back().swap(normals);
-            _texCoords.back().swap(texCoords);
-            _indices.back().swap(indices);
-        } else {
-            // Buffers too big, split into multiple buffers
-            _coords.back().reserve(std::min(coords.size(), GLContext::MAX_VERTEXBUFFER_SIZE));
-            _normals.back().reserve(std::min(normals.size(), GLContext::MAX_VERTEXBUFFER_SIZE));
-            _texCoords.back().reserve(std::min(texCoords.size(), GLContext::MAX_VERTEXBUFFER_SIZE));
-            _indices.back().reserve(std::min(indices.size(), GLContext::MAX_VERTEXBUFFER_SIZE));
-            std::unordered_map<unsigned int, unsigned int> indexMap;
-            indexMap.reserve(indices.size() * 2);
-            for (std::size_t i = 0; i < indices.size(); i += 3) {
-                
-                // Check for possible GL buffer overflow
-                if (_indices.back().size() + 3 > GLContext::MAX_VERTEXBUFFER_SIZE) {
-                    // The buffer is full, create a new one
-                    _coords.back().shrink_to_fit();
-                    _coords.push_back(std::vector<cglib::vec3<double>*>());
-                    _coords.back().reserve(std::min(coords.size(), GLContext::MAX_VERTEXBUFFER_SIZE));
-                    _normals.back().shrink_to_fit();
-                    _normals.push_back(std::vector<cglib::vec4<float> >());
-                    _normals.back().reserve(std::min(normals.size(), GLContext::MAX_VERTEXBUFFER_SIZE));
-                    _texCoords.back().shrink_to_fit();
-                    _texCoords.push_back(std::vector<cglib::vec2<float> >());
-                    _texCoords.back().reserve(std::min(texCoords.size(), GLContext::MAX_VERTEXBUFFER_SIZE));
-                    _indices.back().shrink_to_fit();
-                    _indices.push_back(std::vector<unsigned int>());
-                    _indices.back().reserve(std::min(indices.size(), GLContext::MAX_VERTEXBUFFER_SIZE));
-                    indexMap.clear();
-                }
-                
-                for (int j = 0; j < 3; j++) {
-                    unsigned int index = static_cast<unsigned int>(indices[i + j]);
-                    auto it = indexMap.find(index);
-                    if (it == indexMap.end()) {
-                        unsigned int newIndex = static_cast<unsigned int>(_coords.back().size());
-                        _coords.back().push_back(coords[index]);
-                        _normals.back().push_back(normals[index]);
-                        _texCoords.back().push_back(texCoords[index]);
-                        _indices.back().push_back(newIndex);
-                        indexMap[index] = newIndex;
-                    } else {
-                        _indices.back().push_back(it->second);
-                    }
-                }
+
+            indices.push_back(vertexIndex - 2);
+            indices.push_back(vertexIndex - 1);
+            indices.push_back(vertexIndex);
+            indices.push_back(vertexIndex - 1);
+            indices.push_back(vertexIndex + 1);
+            indices.push_back(vertexIndex);
+            vertexIndex += 2;
+
+            // First end point, the quad continues from the first two vertices of the first line segment
+            cglib::vec3<float> firstLineDir = cglib::unit(cglib::vec3<float>::convert(poses[0] - poses[1]));
+            for (int s = 1; s >= -1; s -= 2) {
+                coords.push_back(&poses[0]);
+                normals.push_back(firstPerpVec * static_cast<float>(s) + firstLineDir);
+                texCoords.push_back(cglib::vec4<float>(s > 0 ? 0.0f : texCoordX, texCoordYStart, static_cast<float>(s), endDist));
             }
+
+            indices.push_back(baseIndex);
+            indices.push_back(baseIndex + 1);
+            indices.push_back(vertexIndex);
+            indices.push_back(baseIndex + 1);
+            indices.push_back(vertexIndex + 1);
+            indices.push_back(vertexIndex);
+            vertexIndex += 2;
         }
-        
-        _coords.back().shrink_to_fit();
-        _normals.back().shrink_to_fit();
-        _texCoords.back().shrink_to_fit();
-        _indices.back().shrink_to_fit();
+
     }
-    
-    const float LineDrawData::LINE_ENDPOINT_TESSELATION_FACTOR = 0.004f;
-    const float LineDrawData::LINE_JOIN_TESSELATION_FACTOR = 0.0018f;
+
+    const float LineDrawData::LINE_JOIN_MAX_WEDGE_ANGLE = 90.0f;
     const float LineDrawData::LINE_JOIN_MIN_MITER_DOT = -0.8f;
     
     const float LineDrawData::CLICK_WIDTH_COEF = 0.5f;
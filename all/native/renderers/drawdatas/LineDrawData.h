@@ -7,12 +7,14 @@
 #ifndef _CARTO_LINEDRAWDATA_H_
 #define _CARTO_LINEDRAWDATA_H_
 
+#include "core/MapBounds.h"
 #include "renderers/drawdatas/VectorElementDrawData.h"
 
 #include <memory>
 #include <vector>
 
 #include <cglib/vec.h>
+#include <cglib/bbox.h>
 
 namespace carto {
     class Bitmap;
@@ -27,6 +29,8 @@ namespace carto {
     public:
         LineDrawData(const LineGeometry& geometry, const LineStyle& style, const Projection& projection, const ProjectionSurface& projectionSurface);
         LineDrawData(const std::vector<MapPos>& poses, const LineStyle& style, const Projection& projection, const ProjectionSurface& projectionSurface);
+        LineDrawData(const LineGeometry& geometry, const LineStyle& style, const Projection& projection, const ProjectionSurface& projectionSurface, const MapBounds& clipBounds);
+        LineDrawData(const std::vector<MapPos>& poses, const LineStyle& style, const Projection& projection, const ProjectionSurface& projectionSurface, const MapBounds& clipBounds);
         virtual ~LineDrawData();
     
         const std::shared_ptr<Bitmap> getBitmap() const;
@@ -34,41 +38,58 @@ namespace carto {
         float getNormalScale() const;
     
         float getClickScale() const;
+
+        // Bounding box of the line origin points. The vertices are offset from the origin points by at most getMaxNormalLength() units per DP
+        const cglib::bbox3<double>& getBoundingBox() const;
+
+        float getMaxNormalLength() const;
+
+        // Bounds in internal coordinates where the tesselation is complete, infinite if the line was not clipped
+        const MapBounds& getClipBounds() const;
     
         const std::vector<std::vector<cglib::vec3<double>*> >& getCoords() const;
     
-        const std::vector<std::vector<cglib::vec4<float> > >& getNormals() const;
+        const std::vector<std::vector<cglib::vec3<float> > >& getNormals() const;
     
-        const std::vector<std::vector<cglib::vec2<float> > >& getTexCoords() const;
+        const std::vector<std::vector<cglib::vec4<float> > >& getTexCoords() const;
     
         const std::vector<std::vector<unsigned int> >& getIndices() const;
     
         virtual void offsetHorizontally(double offset);
     
     private:
-        static const float LINE_ENDPOINT_TESSELATION_FACTOR;
-        static const float LINE_JOIN_TESSELATION_FACTOR;
+        static const float LINE_JOIN_MAX_WEDGE_ANGLE;
         static const float LINE_JOIN_MIN_MITER_DOT;
     
         static const int IDEAL_CLICK_WIDTH = 64;
     
         static const float CLICK_WIDTH_COEF;
         
-        void init(const std::vector<MapPos>& poses, const Projection& projection, const ProjectionSurface& projectionSurface, const LineStyle& style);
+        void init(const std::vector<MapPos>& poses, const Projection& projection, const ProjectionSurface& projectionSurface, const LineStyle& style, const MapBounds& clipBounds);
+        void tesselateLine(std::size_t begin, std::size_t end, const std::vector<cglib::vec3<float> >& posNormals, const LineStyle& style, float texCoordYStart,
+                           std::vector<cglib::vec3<double>*>& coords, std::vector<cglib::vec3<float> >& normals, std::vector<cglib::vec4<float> >& texCoords, std::vector<unsigned int>& indices);
     
         std::shared_ptr<Bitmap> _bitmap;
     
         float _normalScale;
 
         float _clickScale;
+
+        cglib::bbox3<double> _boundingBox;
+
+        float _maxNormalLength;
+
+        MapBounds _clipBounds;
     
         // Actual line coordinates
         std::vector<cglib::vec3<double> > _poses;
     
-        // Origin point and normal for each vertex
+        // Origin point and offset from the origin in half line widths for each vertex. The offsets are scaled by the line width in the shader
         std::vector<std::vector<cglib::vec3<double>*> > _coords;
-        std::vector<std::vector<cglib::vec4<float> > > _normals;
-        std::vector<std::vector<cglib::vec2<float> > > _texCoords;
+        std::vector<std::vector<cglib::vec3<float> > > _normals;
+        // Texture coordinates (xy) and position relative to the line center, join or end point in half line widths (zw).
+        // The fragment shader fades out the line by the length of zw, which also shapes the round joins and end points
+        std::vector<std::vector<cglib::vec4<float> > > _texCoords;
     
         std::vector<std::vector<unsigned int> > _indices;
     };
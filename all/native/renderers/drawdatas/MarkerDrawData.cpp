@@ -18,8 +18,12 @@ namespace carto {
                           style.getScalingMode(),
                           1.0f,
                           style.getSize()),
+        _style(marker.getStyle()),
         _clickScale(1.0f)
     {
+        if (_style.get() != &style) {
+            _style.reset(); // the style of the marker was changed concurrently, the draw data can not be reused
+        }
         if (style.getClickSize() != -1) {
             float size = style.getSize();
             if (size < 0) {
@@ -29,9 +33,20 @@ namespace carto {
         }
     }
     
+    MarkerDrawData::MarkerDrawData(const MarkerDrawData& drawData, const Marker& marker, const Projection& projection, const ProjectionSurface& projectionSurface) :
+        BillboardDrawData(drawData, marker, projection, projectionSurface),
+        _style(drawData._style),
+        _clickScale(drawData._clickScale)
+    {
+    }
+    
     MarkerDrawData::~MarkerDrawData() {
     }
 
+    std::shared_ptr<MarkerStyle> MarkerDrawData::getStyle() const {
+        return _style;
+    }
+
     float MarkerDrawData::getClickScale() const {
         return _clickScale;
     }
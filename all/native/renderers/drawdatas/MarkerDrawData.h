@@ -16,11 +16,16 @@ namespace carto {
     class MarkerDrawData : public BillboardDrawData {
     public:
         MarkerDrawData(const Marker& marker, const MarkerStyle& style, const Projection& projection, const ProjectionSurface& projectionSurface);
+        // Reuses the style dependent data of an existing draw data and recalculates only the position and rotation
+        MarkerDrawData(const MarkerDrawData& drawData, const Marker& marker, const Projection& projection, const ProjectionSurface& projectionSurface);
         virtual ~MarkerDrawData();
 
+        std::shared_ptr<MarkerStyle> getStyle() const;
+
         virtual float getClickScale() const;
 
     private:
+        std::shared_ptr<MarkerStyle> _style;
         float _clickScale;
     };
     
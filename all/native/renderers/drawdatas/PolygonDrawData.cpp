@@ -1,6 +1,8 @@
 #include "PolygonDrawData.h"
 #include "core/MapPos.h"
 #include "geometry/PolygonGeometry.h"
+#include "geometry/utils/CompactMapPosList.h"
+#include "geometry/utils/PolygonTriangulator.h"
 #include "graphics/utils/GLContext.h"
 #include "projections/Projection.h"
 #include "projections/ProjectionSurface.h"
@@ -11,9 +13,11 @@
 #include "utils/Const.h"
 #include "utils/Log.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <unordered_map>
+#include <utility>
 
 #include <tesselator.h>
 
@@ -23,107 +27,189 @@ namespace carto {
         VectorElementDrawData(style.getColor()),
         _bitmap(style.getBitmap()),
         _boundingBox(cglib::bbox3<double>::smallest()),
+        _clipBounds(),
         _coords(),
         _indices(),
         _lineDrawDatas()
     {
-        const std::vector<MapPos>& poses = geometry.getPoses();
-        const std::vector<std::vector<MapPos> >& holes = geometry.getHoles();
-        
-        // Create tesselator
-        TESSalloc ma;
-        ma.memalloc = [](void* userData, unsigned int size) { return malloc(size); };
-        ma.memfree = [](void* userData, void* ptr) { free(ptr); };
-        ma.extraVertices = 256;
-        TESStesselator* tessPtr = tessNewTess(&ma);
-        if (!tessPtr) {
-            Log::Error("PolygonDrawData::PolygonDrawData: Failed to create tesselator!");
-            return;
-        }
-        std::shared_ptr<TESStesselator> tess(tessPtr, tessDeleteTess);
+        init(geometry, style, projection, projectionSurface, GetInfiniteClipBounds());
+    }
 
-        // Add polygon exterior, calculate bounding box
-        std::vector<double> posesArray(poses.size() * 3);
-        std::vector<MapPos> ringPoses;
-        ringPoses.reserve(poses.size() + 1);
-        for (std::size_t i = 0; i < poses.size(); i++) {
-            MapPos internalPos = projection.toInternal(poses[i]);
-            posesArray[i * 3 + 0] = internalPos.getX();
-            posesArray[i * 3 + 1] = internalPos.getY();
-            posesArray[i * 3 + 2] = internalPos.getZ();
-            ringPoses.push_back(poses[i]);
-        }
-        tessAddContour(tess.get(), 3, posesArray.data(), sizeof(double) * 3, static_cast<unsigned int>(poses.size()));
+    PolygonDrawData::PolygonDrawData(const PolygonGeometry& geometry, const PolygonStyle& style, const Projection& projection, const ProjectionSurface& projectionSurface, const MapBounds& clipBounds) :
+        VectorElementDrawData(style.getColor()),
+        _bitmap(style.getBitmap()),
+        _boundingBox(cglib::bbox3<double>::smallest()),
+        _clipBounds(),
+        _coords(),
+        _indices(),
+        _lineDrawDatas()
+    {
+        init(geometry, style, projection, projectionSurface, clipBounds);
+    }
     
-        if (style.getLineStyle() && !poses.empty()) {
-            ringPoses.push_back(poses.front());
-            _lineDrawDatas.push_back(std::make_shared<LineDrawData>(ringPoses, *style.getLineStyle(), projection, projectionSurface));
-        }
+    PolygonDrawData::~PolygonDrawData() {
+    }
+    
+    const std::shared_ptr<Bitmap> PolygonDrawData::getBitmap() const {
+        return _bitmap;
+    }
     
-        // Add polygon holes
-        for (const std::vector<MapPos>& hole : holes) {
-            ringPoses.clear();
-            ringPoses.reserve(hole.size() + 1);
-            std::vector<double> holeArray(hole.size() * 3);
-            for (std::size_t i = 0; i < hole.size(); i++) {
-                MapPos internalPos = projection.toInternal(hole[i]);
-                holeArray[i * 3 + 0] = internalPos.getX();
-                holeArray[i * 3 + 1] = internalPos.getY();
-                holeArray[i * 3 + 2] = internalPos.getZ();
-                ringPoses.push_back(hole[i]);
-            }
-            tessAddContour(tess.get(), 3, holeArray.data(), sizeof(double) * 3, static_cast<unsigned int>(hole.size()));
+    const cglib::bbox3<double>& PolygonDrawData::getBoundingBox() const {
+        return _boundingBox;
+    }
+
+    const MapBounds& PolygonDrawData::getClipBounds() const {
+        return _clipBounds;
+    }
     
-            if (style.getLineStyle() && !hole.empty()) {
-                ringPoses.push_back(hole.front());
-                _lineDrawDatas.push_back(std::make_shared<LineDrawData>(ringPoses, *style.getLineStyle(), projection, projectionSurface));
+    const std::vector<std::vector<cglib::vec3<double> > >& PolygonDrawData::getCoords() const {
+        return _coords;
+    }
+    
+    const std::vector<std::vector<unsigned int> >& PolygonDrawData::getIndices() const {
+        return _indices;
+    }
+    
+    const std::vector<std::shared_ptr<LineDrawData> >& PolygonDrawData::getLineDrawDatas() const {
+        return _lineDrawDatas;
+    }
+    
+    void PolygonDrawData::offsetHorizontally(double offset) {
+        for (std::vector<cglib::vec3<double> >& coords : _coords) {
+            for (cglib::vec3<double>& coord : coords) {
+                coord(0) += offset;
             }
         }
+        if (!_coords.empty()) {
+            _boundingBox.min(0) += offset;
+            _boundingBox.max(0) += offset;
+        }
     
-        // Triangulate
-        if (!tessTesselate(tess.get(), TESS_WINDING_ODD, TESS_POLYGONS, 3, 3, NULL)) {
-            Log::Error("PolygonDrawData::PolygonDrawData: Failed to triangulate polygon!");
+        for (const std::shared_ptr<LineDrawData>& drawData : _lineDrawDatas) {
+            drawData->offsetHorizontally(offset);
+        }
+        
+        setIsOffset(true);
+    }
+
+    void PolygonDrawData::init(const PolygonGeometry& geometry, const PolygonStyle& style, const Projection& projection, const ProjectionSurface& projectionSurface, const MapBounds& clipBounds) {
+        // Convert the rings to internal coordinates. Compact rings are decoded directly into the internal coordinate buffers
+        const std::vector<std::shared_ptr<const CompactMapPosList> >& compactRings = geometry.getCompactRings();
+        std::vector<std::vector<MapPos> > internalRings;
+        if (!compactRings.empty()) {
+            internalRings.reserve(compactRings.size());
+            for (const std::shared_ptr<const CompactMapPosList>& compactRing : compactRings) {
+                internalRings.push_back(compactRing->getPoses());
+                projection.toInternal(internalRings.back().data(), internalRings.back().data(), internalRings.back().size());
+            }
+        } else {
+            const std::vector<std::vector<MapPos> >& rings = geometry.getRings();
+            internalRings.reserve(rings.size());
+            for (const std::vector<MapPos>& ring : rings) {
+                internalRings.emplace_back(ring.size());
+                projection.toInternal(ring.data(), internalRings.back().data(), ring.size());
+            }
+        }
+        if (internalRings.empty()) {
             return;
         }
-        const double* coords = tessGetVertices(tess.get());
-        const int* elements = tessGetElements(tess.get());
-        std::size_t vertexCount = tessGetVertexCount(tess.get());
-        std::size_t elementCount = tessGetElementCount(tess.get());
 
-        // Do projection-surface based tesselation
+        // Outlines use the original rings, line draw datas do their own clipping
+        if (style.getLineStyle()) {
+            std::vector<MapPos> ringPoses;
+            for (std::size_t i = 0; i < internalRings.size(); i++) {
+                ringPoses = (compactRings.empty() ? geometry.getRings()[i] : compactRings[i]->getPoses());
+                if (!ringPoses.empty()) {
+                    ringPoses.push_back(ringPoses.front());
+                    _lineDrawDatas.push_back(std::make_shared<LineDrawData>(ringPoses, *style.getLineStyle(), projection, projectionSurface, clipBounds));
+                }
+            }
+        }
+
+        // If the polygon is not fully inside the clip bounds, clip all rings.
+        // Holes are clipped separately, the result is still correct as odd winding rule is used.
+        MapBounds internalBounds;
+        for (const MapPos& internalPos : internalRings.front()) {
+            internalBounds.expandToContain(internalPos);
+        }
+        bool clipped = !clipBounds.contains(internalBounds);
+        if (clipped) {
+            for (std::vector<MapPos>& internalRing : internalRings) {
+                ClipRing(internalRing, clipBounds);
+            }
+        }
+        _clipBounds = (clipped ? clipBounds : GetInfiniteClipBounds());
+        if (internalRings.front().size() < 3) {
+            return;
+        }
+        internalRings.erase(std::remove_if(internalRings.begin() + 1, internalRings.end(), [](const std::vector<MapPos>& ring) { return ring.size() < 3; }), internalRings.end());
+
+        // Triangulate. The triangulation of unclipped polygons does not depend on the view, it is cached in the geometry
+        std::shared_ptr<const PolygonGeometry::Triangulation> triangulation;
+        if (!clipped) {
+            triangulation = std::atomic_load(&geometry._triangulation);
+            if (triangulation && triangulation->projectionName != projection.getName()) {
+                triangulation.reset();
+            }
+        }
+        if (!triangulation) {
+            auto newTriangulation = std::make_shared<PolygonGeometry::Triangulation>();
+            newTriangulation->projectionName = projection.getName();
+            if (!PolygonTriangulator::Triangulate(internalRings, newTriangulation->indices)) {
+                // Fall back to the robust tesselator for self-intersecting polygons, overlapping holes, etc
+                if (!TesselateRings(internalRings, newTriangulation->poses, newTriangulation->indices)) {
+                    return;
+                }
+            }
+            triangulation = newTriangulation;
+            if (!clipped) {
+                std::atomic_store(&geometry._triangulation, triangulation);
+            }
+        }
+
         std::vector<MapPos> internalPoses;
-        internalPoses.reserve(vertexCount);
-        for (std::size_t i = 0; i < vertexCount; i++) {
-            internalPoses.emplace_back(coords[i * 3 + 0], coords[i * 3 + 1], coords[i * 3 + 2]);
+        if (triangulation->poses.empty()) {
+            std::size_t vertexCount = 0;
+            for (const std::vector<MapPos>& internalRing : internalRings) {
+                vertexCount += internalRing.size();
+            }
+            internalPoses.reserve(vertexCount);
+            for (const std::vector<MapPos>& internalRing : internalRings) {
+                internalPoses.insert(internalPoses.end(), internalRing.begin(), internalRing.end());
+            }
+        } else {
+            internalPoses = triangulation->poses;
         }
+
+        // Do projection-surface based tesselation
+        const std::vector<unsigned int>& triangleIndices = triangulation->indices;
         std::vector<unsigned int> indices;
-        indices.reserve(elementCount * 3);
-        for (std::size_t i = 0; i < elementCount * 3; i += 3) {
-            unsigned int i0 = elements[i + 0];
-            unsigned int i1 = elements[i + 1];
-            unsigned int i2 = elements[i + 2];
-            if (i0 != TESS_UNDEF && i1 != TESS_UNDEF && i2 != TESS_UNDEF) {
-                projectionSurface.tesselateTriangle(i0, i1, i2, indices, internalPoses);
-            }
+        indices.reserve(triangleIndices.size());
+        for (std::size_t i = 0; i + 2 < triangleIndices.size(); i += 3) {
+            projectionSurface.tesselateTriangle(triangleIndices[i + 0], triangleIndices[i + 1], triangleIndices[i + 2], indices, internalPoses);
         }
     
+        std::vector<cglib::vec3<double> > positions(internalPoses.size());
+        projectionSurface.calculatePositions(internalPoses.data(), positions.data(), internalPoses.size());
+
         // Convert tesselation results to drawable format, split if into multiple buffers, if the polyong is too big
+        std::size_t maxBufferSize = GLContext::GetMaxVertexBufferSize();
         _coords.push_back(std::vector<cglib::vec3<double> >());
-        _coords.back().reserve(std::min(internalPoses.size(), GLContext::MAX_VERTEXBUFFER_SIZE));
+        _coords.back().reserve(std::min(internalPoses.size(), maxBufferSize));
         _indices.push_back(std::vector<unsigned int>());
-        _indices.back().reserve(std::min(indices.size(), GLContext::MAX_VERTEXBUFFER_SIZE));
+        _indices.back().reserve(std::min(indices.size(), maxBufferSize));
         std::unordered_map<unsigned int, unsigned int> indexMap;
-        indexMap.reserve(std::min(indices.size(), GLContext::MAX_VERTEXBUFFER_SIZE));
+        indexMap.reserve(std::min(indices.size(), maxBufferSize));
         for (std::size_t i = 0; i < indices.size(); i += 3) {
             // Check for possible GL buffer overflow
-            if (_indices.back().size() + 3 > GLContext::MAX_VERTEXBUFFER_SIZE) {
+            if (_indices.back().size() + 3 > maxBufferSize) {
                 // The buffer is full, create a new one
                 _coords.back().shrink_to_fit();
                 _coords.push_back(std::vector<cglib::vec3<double> >());
-                _coords.back().reserve(std::min(internalPoses.size(), GLContext::MAX_VERTEXBUFFER_SIZE));
+                _coords.back().reserve(std::min(internalPoses.size(), maxBufferSize));
                 _indices.back().shrink_to_fit();
                 _indices.push_back(std::vector<unsigned int>());
-                _indices.back().reserve(std::min(indices.size(), GLContext::MAX_VERTEXBUFFER_SIZE));
+                _indices.back().reserve(std::min(indices.size(), maxBufferSize));
                 indexMap.clear();
             }
             
@@ -132,7 +218,7 @@ namespace carto {
                 auto it = indexMap.find(index);
                 if (it == indexMap.end()) {
                     unsigned int newIndex = static_cast<unsigned int>(_coords.back().size());
-                    _coords.back().push_back(projectionSurface.calculatePosition(internalPoses[index]));
+                    _coords.back().push_back(positions[index]);
                     _boundingBox.add(_coords.back().back());
                     _indices.back().push_back(newIndex);
                     indexMap[index] = newIndex;
@@ -145,42 +231,89 @@ namespace carto {
         _coords.back().shrink_to_fit();
         _indices.back().shrink_to_fit();
     }
-    
-    PolygonDrawData::~PolygonDrawData() {
-    }
-    
-    const std::shared_ptr<Bitmap> PolygonDrawData::getBitmap() const {
-        return _bitmap;
-    }
-    
-    const cglib::bbox3<double>& PolygonDrawData::getBoundingBox() const {
-        return _boundingBox;
-    }
-    
-    const std::vector<std::vector<cglib::vec3<double> > >& PolygonDrawData::getCoords() const {
-        return _coords;
-    }
-    
-    const std::vector<std::vector<unsigned int> >& PolygonDrawData::getIndices() const {
-        return _indices;
-    }
-    
-    const std::vector<std::shared_ptr<LineDrawData> >& PolygonDrawData::getLineDrawDatas() const {
-        return _lineDrawDatas;
-    }
-    
-    void PolygonDrawData::offsetHorizontally(double offset) {
-        for (std::vector<cglib::vec3<double> >& coords : _coords) {
-            for (cglib::vec3<double>& coord : coords) {
-                coord(0) += offset;
+
+    bool PolygonDrawData::TesselateRings(const std::vector<std::vector<MapPos> >& rings, std::vector<MapPos>& poses, std::vector<unsigned int>& indices) {
+        // Create tesselator
+        TESSalloc ma;
+        ma.memalloc = [](void* userData, unsigned int size) { return malloc(size); };
+        ma.memfree = [](void* userData, void* ptr) { free(ptr); };
+        ma.extraVertices = 256;
+        TESStesselator* tessPtr = tessNewTess(&ma);
+        if (!tessPtr) {
+            Log::Error("PolygonDrawData::TesselateRings: Failed to create tesselator!");
+            return false;
+        }
+        std::shared_ptr<TESStesselator> tess(tessPtr, tessDeleteTess);
+
+        // Add polygon exterior and holes
+        std::vector<double> posesArray;
+        for (const std::vector<MapPos>& ring : rings) {
+            posesArray.resize(ring.size() * 3);
+            for (std::size_t i = 0; i < ring.size(); i++) {
+                posesArray[i * 3 + 0] = ring[i].getX();
+                posesArray[i * 3 + 1] = ring[i].getY();
+                posesArray[i * 3 + 2] = ring[i].getZ();
             }
+            tessAddContour(tess.get(), 3, posesArray.data(), sizeof(double) * 3, static_cast<unsigned int>(ring.size()));
         }
-    
-        for (const std::shared_ptr<LineDrawData>& drawData : _lineDrawDatas) {
-            drawData->offsetHorizontally(offset);
+
+        // Triangulate
+        if (!tessTesselate(tess.get(), TESS_WINDING_ODD, TESS_POLYGONS, 3, 3, NULL)) {
+            Log::Error("PolygonDrawData::TesselateRings: Failed to triangulate polygon!");
+            return false;
+        }
+        const double* coords = tessGetVertices(tess.get());
+        const int* elements = tessGetElements(tess.get());
+        std::size_t vertexCount = tessGetVertexCount(tess.get());
+        std::size_t elementCount = tessGetElementCount(tess.get());
+
+        poses.reserve(vertexCount);
+        for (std::size_t i = 0; i < vertexCount; i++) {
+            poses.emplace_back(coords[i * 3 + 0], coords[i * 3 + 1], coords[i * 3 + 2]);
+        }
+        indices.reserve(elementCount * 3);
+        for (std::size_t i = 0; i < elementCount * 3; i += 3) {
+            unsigned int i0 = elements[i + 0];
+            unsigned int i1 = elements[i + 1];
+            unsigned int i2 = elements[i + 2];
+            if (i0 != TESS_UNDEF && i1 != TESS_UNDEF && i2 != TESS_UNDEF) {
+                indices.push_back(i0);
+                indices.push_back(i1);
+                indices.push_back(i2);
+            }
+        }
+        return true;
+    }
+
+    void PolygonDrawData::ClipRing(std::vector<MapPos>& ring, const MapBounds& clipBounds) {
+        // Sutherland-Hodgman clipping against each side of the clip bounds
+        std::vector<MapPos> inputRing;
+        for (int side = 0; side < 4; side++) {
+            if (ring.empty()) {
+                break;
+            }
+            int axis = side / 2;
+            auto coord = [axis](const MapPos& pos) { return axis == 0 ? pos.getX() : pos.getY(); };
+            double limit = (side % 2 == 0 ? coord(clipBounds.getMin()) : coord(clipBounds.getMax()));
+            double sign = (side % 2 == 0 ? 1.0 : -1.0);
+
+            std::swap(inputRing, ring);
+            ring.clear();
+            const MapPos* prevPos = &inputRing.back();
+            bool prevInside = (coord(*prevPos) - limit) * sign >= 0;
+            for (const MapPos& pos : inputRing) {
+                bool inside = (coord(pos) - limit) * sign >= 0;
+                if (inside != prevInside) {
+                    double t = (limit - coord(*prevPos)) / (coord(pos) - coord(*prevPos));
+                    ring.push_back(*prevPos + (pos - *prevPos) * t);
+                }
+                if (inside) {
+                    ring.push_back(pos);
+                }
+                prevPos = &pos;
+                prevInside = inside;
+            }
         }
-        
-        setIsOffset(true);
     }
     
 }
@@ -27,11 +27,15 @@ namespace carto {
     class PolygonDrawData : public VectorElementDrawData {
     public:
         PolygonDrawData(const PolygonGeometry& geometry, const PolygonStyle& style, const Projection& projection, const ProjectionSurface& projectionSurface);
+        PolygonDrawData(const PolygonGeometry& geometry, const PolygonStyle& style, const Projection& projection, const ProjectionSurface& projectionSurface, const MapBounds& clipBounds);
         virtual ~PolygonDrawData();
     
         const std::shared_ptr<Bitmap> getBitmap() const;
     
         const cglib::bbox3<double>& getBoundingBox() const;
+
+        // Bounds in internal coordinates where the tesselation is complete, infinite if the polygon was not clipped
+        const MapBounds& getClipBounds() const;
     
         const std::vector<std::vector<cglib::vec3<double> > >& getCoords() const;
     
@@ -42,9 +46,17 @@ namespace carto {
         virtual void offsetHorizontally(double offset);
     
     private:
+        void init(const PolygonGeometry& geometry, const PolygonStyle& style, const Projection& projection, const ProjectionSurface& projectionSurface, const MapBounds& clipBounds);
+
+        static bool TesselateRings(const std::vector<std::vector<MapPos> >& rings, std::vector<MapPos>& poses, std::vector<unsigned int>& indices);
+
+        static void ClipRing(std::vector<MapPos>& ring, const MapBounds& clipBounds);
+
         std::shared_ptr<Bitmap> _bitmap;
     
         cglib::bbox3<double> _boundingBox;
+
+        MapBounds _clipBounds;
     
         std::vector<std::vector<cglib::vec3<double> > > _coords;
 
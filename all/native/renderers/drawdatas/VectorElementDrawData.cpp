@@ -1,5 +1,7 @@
 #include "VectorElementDrawData.h"
 
+#include <limits>
+
 namespace carto {
 
     VectorElementDrawData::~VectorElementDrawData() {
@@ -13,6 +15,11 @@ namespace carto {
         return _isOffset;
     }
 
+    MapBounds VectorElementDrawData::GetInfiniteClipBounds() {
+        double inf = std::numeric_limits<double>::infinity();
+        return MapBounds(MapPos(-inf, -inf, -inf), MapPos(inf, inf, inf));
+    }
+
     Color VectorElementDrawData::GetPremultipliedColor(const Color& color) {
         return Color(static_cast<unsigned char>(static_cast<unsigned int>(color.getR()) * color.getA() / 255),
                      static_cast<unsigned char>(static_cast<unsigned int>(color.getG()) * color.getA() / 255),
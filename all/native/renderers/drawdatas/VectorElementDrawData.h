@@ -7,6 +7,7 @@
 #ifndef _CARTO_VECTORELEMENTDRAWDATA_H_
 #define _CARTO_VECTORELEMENTDRAWDATA_H_
 
+#include "core/MapBounds.h"
 #include "graphics/Color.h"
 
 #include <memory>
@@ -22,6 +23,9 @@ namespace carto {
         
         virtual bool isOffset() const;
         virtual void offsetHorizontally(double offset) = 0;
+
+        // Clip bounds for draw datas that contain the whole geometry
+        static MapBounds GetInfiniteClipBounds();
     
     protected:
         static Color GetPremultipliedColor(const Color& color);
@@ -4,16 +4,28 @@
 #include "renderers/drawdatas/BillboardDrawData.h"
 #include "utils/Log.h"
 #include "utils/ThreadUtils.h"
+#include "utils/Tracer.h"
 #include "vectorelements/Billboard.h"
 
 #include <algorithm>
+#include <cmath>
+#include <unordered_set>
 
 namespace carto {
 
     BillboardPlacementWorker::BillboardPlacementWorker() :
         _stop(false),
         _idle(false),
-        _kdTree(),
+        _gridCells(GRID_SIZE * GRID_SIZE),
+        _gridQuads(),
+        _gridQuadStamps(),
+        _gridStamp(0),
+        _lastDrawDatas(),
+        _lastQuads(),
+        _lastRotation(0),
+        _lastTilt(0),
+        _quadBuf(),
+        _fullPlacementPending(true),
         _pendingWakeup(false),
         _wakeupTime(std::chrono::steady_clock::now() + std::chrono::hours(24)),
         _mapRenderer(),
@@ -33,8 +45,9 @@ namespace carto {
         _worker = worker;
     }
         
-    void BillboardPlacementWorker::init(int delayTime) {
+    void BillboardPlacementWorker::init(int delayTime, bool fullPlacement) {
         std::lock_guard<std::mutex> lock(_mutex);
+        _fullPlacementPending = _fullPlacementPending || fullPlacement;
         _idle = false;
         _pendingWakeup = true;
         _wakeupTime = std::min(_wakeupTime, std::chrono::steady_clock::now() + std::chrono::milliseconds(delayTime));
@@ -59,6 +72,7 @@ namespace carto {
     
     void BillboardPlacementWorker::run() {
         ThreadUtils::SetThreadPriority(ThreadPriority::LOW);
+        ThreadUtils::SetThreadQoSClass(ThreadQoSClass::USER_INTERACTIVE);
     
         while (true) {
             bool run = false;
@@ -84,6 +98,7 @@ namespace carto {
             }
 
             if (run) {
+                Tracer::Span span("BillboardPlacementWorker::placement");
                 calculateBillboardPlacement();
             }
         }
@@ -95,6 +110,12 @@ namespace carto {
             return false;
         }
 
+        bool fullPlacement = false;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            std::swap(fullPlacement, _fullPlacementPending);
+        }
+
         std::vector<std::shared_ptr<BillboardDrawData> > billboardDrawDatas = mapRenderer->getBillboardDrawDatas();
 
         bool calculate = false;
@@ -109,10 +130,34 @@ namespace carto {
             return false;
         }
 
-        ViewState viewState = mapRenderer->getViewState();
+        // Use the shared snapshot of the last drawn frame, the billboard draw datas were also calculated for it
+        std::shared_ptr<const ViewState> viewStateSnapshot = mapRenderer->getViewStateSnapshot();
+        const ViewState& viewState = *viewStateSnapshot;
         const cglib::mat4x4<float>& rteMVPMat = viewState.getRTEModelviewProjectionMat();
 
-        // Sort draw datas
+        // Start from the order of the last placement. Billboards still present keep their order, new billboards are appended
+        std::unordered_set<const BillboardDrawData*> drawDataSet;
+        for (const std::shared_ptr<BillboardDrawData>& drawData : billboardDrawDatas) {
+            drawDataSet.insert(drawData.get());
+        }
+        bool sameDrawDatas = billboardDrawDatas.size() == _lastDrawDatas.size();
+        std::vector<std::shared_ptr<BillboardDrawData> > sortedDrawDatas;
+        sortedDrawDatas.reserve(billboardDrawDatas.size());
+        for (const std::weak_ptr<BillboardDrawData>& drawDataWeak : _lastDrawDatas) {
+            std::shared_ptr<BillboardDrawData> drawData = drawDataWeak.lock();
+            if (drawData && drawDataSet.erase(drawData.get()) > 0) {
+                sortedDrawDatas.push_back(drawData);
+            } else {
+                sameDrawDatas = false;
+            }
+        }
+        for (const std::shared_ptr<BillboardDrawData>& drawData : billboardDrawDatas) {
+            if (drawDataSet.find(drawData.get()) != drawDataSet.end()) {
+                sortedDrawDatas.push_back(drawData);
+            }
+        }
+
+        // Sort draw datas, lowest priority first. The previous order is usually still valid, in that case sorting is skipped
         auto distanceComparator = [](const std::shared_ptr<BillboardDrawData>& drawData1, const std::shared_ptr<BillboardDrawData>& drawData2) {
             // Sort by overlappability
             if (drawData1->isHideIfOverlapped() != drawData2->isHideIfOverlapped()) {
@@ -122,79 +167,210 @@ namespace carto {
             // Sort using DrawData ordering
             return drawData1->isBefore(*drawData2);
         };
-        std::stable_sort(billboardDrawDatas.begin(), billboardDrawDatas.end(), distanceComparator);
-        std::reverse(billboardDrawDatas.begin(), billboardDrawDatas.end());
-
-        // Calculate billboard screen coordinates, add envelopes to the tree
-        {
-            std::lock_guard<std::mutex> lock(_mutex);
-            _kdTree.clear();
+        if (!std::is_sorted(sortedDrawDatas.begin(), sortedDrawDatas.end(), distanceComparator)) {
+            std::stable_sort(sortedDrawDatas.begin(), sortedDrawDatas.end(), distanceComparator);
+            sameDrawDatas = false;
         }
 
+        // Calculate billboard screen coordinates
         std::vector<float> coordBuf(12);
-        std::vector<MapPos> convexHull;
+        _quadBuf.resize(sortedDrawDatas.size());
+        for (std::size_t i = 0; i < sortedDrawDatas.size(); i++) {
+            ScreenQuad& quad = _quadBuf[i];
+            quad.valid = BillboardRenderer::CalculateBillboardCoords(*sortedDrawDatas[i], viewState, coordBuf, 0);
+            if (!quad.valid) {
+                continue;
+            }
+
+            // Transform the world coordinates to screen coordinates. Note the order: top-left, bottom-left, bottom-right, top-right
+            for (int j = 0; j < 4; j++) {
+                int k = (j < 2 ? j : 5 - j);
+                cglib::vec3<float> screenPos = cglib::transform_point(cglib::vec3<float>(coordBuf[k * 3 + 0], coordBuf[k * 3 + 1], coordBuf[k * 3 + 2]), rteMVPMat);
+                quad.points[j] = cglib::vec2<float>(screenPos(0), screenPos(1));
+            }
+            quad.min = quad.max = quad.points[0];
+            for (int j = 1; j < 4; j++) {
+                for (int c = 0; c < 2; c++) {
+                    quad.min(c) = std::min(quad.min(c), quad.points[j](c));
+                    quad.max(c) = std::max(quad.max(c), quad.points[j](c));
+                }
+            }
+        }
+
+        // If the billboards are the same as during the last placement and they have moved together on the screen (camera pan),
+        // the overlaps are the same and the last placement can be kept. Rotation and tilt changes must stay below the thresholds
+        if (!fullPlacement && sameDrawDatas) {
+            float tolerance = 2.0f * PLACEMENT_TOLERANCE / std::max(1, std::max(viewState.getWidth(), viewState.getHeight()));
+            float rotationDelta = std::fmod(std::abs(viewState.getRotation() - _lastRotation), 360.0f);
+            bool rotationChanged = std::min(rotationDelta, 360.0f - rotationDelta) > ROTATION_THRESHOLD;
+            bool tiltChanged = std::abs(viewState.getTilt() - _lastTilt) > TILT_THRESHOLD;
+            if (!rotationChanged && !tiltChanged && IsTranslatedPlacement(_quadBuf, _lastQuads, tolerance)) {
+                return true;
+            }
+        }
+
+        // Place the billboards in priority order, hide the ones overlapping already placed billboards
+        clearGrid();
         bool changed = false;
-        for (const std::shared_ptr<BillboardDrawData>& drawData : billboardDrawDatas) {
-            std::lock_guard<std::mutex> lock(_mutex);
-            if (_stop) {
-                return false;
+        for (std::size_t n = 0; n < sortedDrawDatas.size(); n++) {
+            if (n % STOP_CHECK_INTERVAL == 0) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (_stop) {
+                    return false;
+                }
             }
 
-            // Calculate billboard world coordinates
-            if (!BillboardRenderer::CalculateBillboardCoords(*drawData, viewState, coordBuf, 0)) {
+            std::size_t i = sortedDrawDatas.size() - 1 - n;
+            const std::shared_ptr<BillboardDrawData>& drawData = sortedDrawDatas[i];
+            const ScreenQuad& quad = _quadBuf[i];
+            if (!quad.valid) {
                 continue;
             }
 
-            // Transform the world coordinates to screen coordinates
-            cglib::vec3<float> topLeft(cglib::transform_point(cglib::vec3<float>(coordBuf[0], coordBuf[1], coordBuf[2]), rteMVPMat));
-            cglib::vec3<float> bottomLeft(cglib::transform_point(cglib::vec3<float>(coordBuf[3], coordBuf[4], coordBuf[5]), rteMVPMat));
-            cglib::vec3<float> topRight(cglib::transform_point(cglib::vec3<float>(coordBuf[6], coordBuf[7], coordBuf[8]), rteMVPMat));
-            cglib::vec3<float> bottomRight(cglib::transform_point(cglib::vec3<float>(coordBuf[9], coordBuf[10], coordBuf[11]), rteMVPMat));
+            bool overlapped = drawData->isHideIfOverlapped() && testGridQuad(quad);
+            if (drawData->isOverlapping() != overlapped) {
+                drawData->setOverlapping(overlapped);
+                changed = true;
+            }
 
-            cglib::bbox3<double> bounds = cglib::bbox3<double>::smallest();
-            bounds.add(cglib::vec3<double>(topLeft(0), topLeft(1), 0));
-            bounds.add(cglib::vec3<double>(bottomLeft(0), bottomLeft(1), 0));
-            bounds.add(cglib::vec3<double>(topRight(0), topRight(1), 0));
-            bounds.add(cglib::vec3<double>(bottomRight(0), bottomRight(1), 0));
+            if (!overlapped && drawData->isCausesOverlap()) {
+                _gridQuads.push_back(quad);
+                insertGridQuad(_gridQuads.size() - 1);
+            }
+        }
 
-            // Construct convex polygons from the screen coordinatees
-            convexHull.clear();
-            convexHull.emplace_back(topLeft(0), topLeft(1), 0);
-            convexHull.emplace_back(bottomLeft(0), bottomLeft(1), 0);
-            convexHull.emplace_back(topRight(0), topRight(1), 0);
-            convexHull.emplace_back(bottomRight(0), bottomRight(1), 0);
+        // Remember the placement input, so that the following placements can reuse it
+        _lastDrawDatas.assign(sortedDrawDatas.begin(), sortedDrawDatas.end());
+        _lastQuads = _quadBuf;
+        _lastRotation = viewState.getRotation();
+        _lastTilt = viewState.getTilt();
 
-            MapEnvelope envelope(convexHull);
+        if (changed) {
+            mapRenderer->requestRedraw();
+        }
 
-            bool overlapped = false;
-            if (drawData->isHideIfOverlapped()) {
-                // Check that there are higher priority billboards overlapping with this one
-                const std::vector<MapEnvelope>& overlappedEnvelopes = _kdTree.query(bounds);
-                for (const MapEnvelope& overlappedEnvelope : overlappedEnvelopes) {
-                    if (overlappedEnvelope.intersects(envelope)) {
-                        // Overlapping detected, hide this billboard
-                        drawData->setOverlapping(true);
-                        changed = true;
-                        overlapped = true;
-                        break;
+        return true;
+    }
+
+    void BillboardPlacementWorker::clearGrid() {
+        for (std::vector<std::size_t>& cell : _gridCells) {
+            cell.clear();
+        }
+        _gridQuads.clear();
+        _gridQuadStamps.clear();
+    }
+
+    void BillboardPlacementWorker::insertGridQuad(std::size_t quadIndex) {
+        const ScreenQuad& quad = _gridQuads[quadIndex];
+        int x0 = CalculateGridCell(quad.min(0)), x1 = CalculateGridCell(quad.max(0));
+        int y0 = CalculateGridCell(quad.min(1)), y1 = CalculateGridCell(quad.max(1));
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                _gridCells[y * GRID_SIZE + x].push_back(quadIndex);
+            }
+        }
+        _gridQuadStamps.push_back(0);
+    }
+
+    bool BillboardPlacementWorker::testGridQuad(const ScreenQuad& quad) {
+        // Quads spanning multiple cells are tested only once, using per-query stamps
+        _gridStamp++;
+        int x0 = CalculateGridCell(quad.min(0)), x1 = CalculateGridCell(quad.max(0));
+        int y0 = CalculateGridCell(quad.min(1)), y1 = CalculateGridCell(quad.max(1));
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                for (std::size_t quadIndex : _gridCells[y * GRID_SIZE + x]) {
+                    if (_gridQuadStamps[quadIndex] == _gridStamp) {
+                        continue;
+                    }
+                    _gridQuadStamps[quadIndex] = _gridStamp;
+                    if (IntersectQuads(quad, _gridQuads[quadIndex])) {
+                        return true;
                     }
                 }
             }
-            
-            if (!overlapped) {
-                drawData->setOverlapping(false);
-                changed = true;
-                if (drawData->isCausesOverlap()) {
-                    _kdTree.insert(bounds, envelope);
+        }
+        return false;
+    }
+
+    bool BillboardPlacementWorker::IsTranslatedPlacement(const std::vector<ScreenQuad>& quads, const std::vector<ScreenQuad>& lastQuads, float tolerance) {
+        if (quads.size() != lastQuads.size()) {
+            return false;
+        }
+
+        // All quads must be moved by the same offset as the first valid quad, within the tolerance
+        bool offsetValid = false;
+        cglib::vec2<float> offset(0, 0);
+        for (std::size_t i = 0; i < quads.size(); i++) {
+            if (quads[i].valid != lastQuads[i].valid) {
+                return false;
+            }
+            if (!quads[i].valid) {
+                continue;
+            }
+            if (!offsetValid) {
+                offset = quads[i].points[0] - lastQuads[i].points[0];
+                offsetValid = true;
+            }
+            for (int j = 0; j < 4; j++) {
+                cglib::vec2<float> delta = quads[i].points[j] - lastQuads[i].points[j] - offset;
+                if (!(std::abs(delta(0)) <= tolerance && std::abs(delta(1)) <= tolerance)) {
+                    return false;
                 }
             }
         }
+        return true;
+    }
 
-        if (changed) {
-            mapRenderer->requestRedraw();
+    bool BillboardPlacementWorker::IntersectQuads(const ScreenQuad& quad1, const ScreenQuad& quad2) {
+        // Quick rejection using bounding boxes
+        for (int c = 0; c < 2; c++) {
+            if (quad1.max(c) < quad2.min(c) || quad2.max(c) < quad1.min(c)) {
+                return false;
+            }
         }
 
+        // Separating axis test, using the edge normals of both quads
+        for (const ScreenQuad* quad : { &quad1, &quad2 }) {
+            for (int i = 0; i < 4; i++) {
+                cglib::vec2<float> edge = quad->points[(i + 1) % 4] - quad->points[i];
+                if (SeparatedAlongAxis(quad1, quad2, cglib::vec2<float>(-edge(1), edge(0)))) {
+                    return false;
+                }
+            }
+        }
         return true;
     }
 
+    bool BillboardPlacementWorker::SeparatedAlongAxis(const ScreenQuad& quad1, const ScreenQuad& quad2, const cglib::vec2<float>& axis) {
+        float min1 = cglib::dot_product(quad1.points[0], axis), max1 = min1;
+        float min2 = cglib::dot_product(quad2.points[0], axis), max2 = min2;
+        for (int i = 1; i < 4; i++) {
+            float proj1 = cglib::dot_product(quad1.points[i], axis);
+            min1 = std::min(min1, proj1);
+            max1 = std::max(max1, proj1);
+            float proj2 = cglib::dot_product(quad2.points[i], axis);
+            min2 = std::min(min2, proj2);
+            max2 = std::max(max2, proj2);
+        }
+        return max1 < min2 || max2 < min1;
+    }
+
+    int BillboardPlacementWorker::CalculateGridCell(float coord) {
+        // Screen coordinates are normalized to [-1, 1]. Offscreen coordinates are clamped to the border cells
+        if (!(coord >= -1.0f)) {
+            return 0;
+        }
+        if (!(coord < 1.0f)) {
+            return GRID_SIZE - 1;
+        }
+        return std::min(static_cast<int>((coord + 1.0f) * 0.5f * GRID_SIZE), GRID_SIZE - 1);
+    }
+
+    const int BillboardPlacementWorker::GRID_SIZE = 32;
+    const int BillboardPlacementWorker::STOP_CHECK_INTERVAL = 64;
+    const float BillboardPlacementWorker::PLACEMENT_TOLERANCE = 1.0f;
+    const float BillboardPlacementWorker::ROTATION_THRESHOLD = 0.5f;
+    const float BillboardPlacementWorker::TILT_THRESHOLD = 0.5f;
+
 }
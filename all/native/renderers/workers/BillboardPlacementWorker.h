@@ -8,12 +8,14 @@
 #define _CARTO_BILLBOARDPLACEMENTWORKER_H_
 
 #include "components/ThreadWorker.h"
-#include "core/MapEnvelope.h"
-#include "geometry/utils/KDTreeSpatialIndex.h"
 
+#include <array>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <vector>
+
+#include <cglib/vec.h>
 
 namespace carto {
     class Billboard;
@@ -27,7 +29,13 @@ namespace carto {
         
         void setComponents(const std::weak_ptr<MapRenderer>& mapRenderer, const std::shared_ptr<BillboardPlacementWorker>& worker);
         
-        void init(int delayTime);
+        /**
+         * Schedules a new placement calculation.
+         * @param delayTime The delay in milliseconds before the calculation.
+         * @param fullPlacement True if the billboards themselves have changed. Otherwise only the view has changed
+         *                      and the previous placement can be kept if the billboards moved together on the screen.
+         */
+        void init(int delayTime, bool fullPlacement);
         
         void stop();
         
@@ -38,13 +46,45 @@ namespace carto {
     private:
         void run();
         
+        struct ScreenQuad {
+            bool valid;
+            std::array<cglib::vec2<float>, 4> points; // corners in cyclic order
+            cglib::vec2<float> min;
+            cglib::vec2<float> max;
+        };
+
         bool calculateBillboardPlacement();
+
+        void clearGrid();
+        void insertGridQuad(std::size_t quadIndex);
+        bool testGridQuad(const ScreenQuad& quad);
+
+        static bool IsTranslatedPlacement(const std::vector<ScreenQuad>& quads, const std::vector<ScreenQuad>& lastQuads, float tolerance);
+        static bool IntersectQuads(const ScreenQuad& quad1, const ScreenQuad& quad2);
+        static bool SeparatedAlongAxis(const ScreenQuad& quad1, const ScreenQuad& quad2, const cglib::vec2<float>& axis);
+        static int CalculateGridCell(float coord);
+
+        static const int GRID_SIZE; // number of collision grid cells along each screen axis
+        static const int STOP_CHECK_INTERVAL; // number of billboards processed between checking the stop flag
+        static const float PLACEMENT_TOLERANCE; // maximum relative movement of billboards in pixels, for keeping the previous placement
+        static const float ROTATION_THRESHOLD; // maximum rotation change in degrees, for keeping the previous placement
+        static const float TILT_THRESHOLD; // maximum tilt change in degrees, for keeping the previous placement
         
         bool _stop;
         bool _idle;
+
+        std::vector<std::vector<std::size_t> > _gridCells;
+        std::vector<ScreenQuad> _gridQuads;
+        std::vector<unsigned int> _gridQuadStamps;
+        unsigned int _gridStamp;
+
+        std::vector<std::weak_ptr<BillboardDrawData> > _lastDrawDatas;
+        std::vector<ScreenQuad> _lastQuads;
+        float _lastRotation;
+        float _lastTilt;
+        std::vector<ScreenQuad> _quadBuf;
         
-        KDTreeSpatialIndex<MapEnvelope> _kdTree;
-        
+        bool _fullPlacementPending;
         bool _pendingWakeup;
         std::chrono::steady_clock::time_point _wakeupTime;
         
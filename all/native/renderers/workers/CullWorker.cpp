@@ -7,6 +7,7 @@
 #include "utils/GeomUtils.h"
 #include "utils/Log.h"
 #include "utils/ThreadUtils.h"
+#include "utils/Tracer.h"
 
 namespace carto {
 
@@ -15,6 +16,7 @@ namespace carto {
         _firstCull(true),
         _envelope(),
         _viewState(),
+        _predictedViewState(),
         _mapRenderer(),
         _stop(false),
         _idle(false),
@@ -65,6 +67,7 @@ namespace carto {
         
     void CullWorker::run() {
         ThreadUtils::SetThreadPriority(ThreadPriority::LOW);
+        ThreadUtils::SetThreadQoSClass(ThreadQoSClass::USER_INTERACTIVE);
         while (true) {
             std::vector<std::shared_ptr<Layer> > layers;
             {
@@ -99,19 +102,22 @@ namespace carto {
                     return;
                 }
                 
-                // Get view state
-                const ViewState& viewState = mapRenderer->getViewState();
-                if (viewState.getWidth() <= 0 || viewState.getHeight() <= 0) {
+                // Get view state. The snapshot published by the renderer is shared with the layers without copying
+                std::shared_ptr<const ViewState> viewState = mapRenderer->getCurrentViewStateSnapshot();
+                if (viewState->getWidth() <= 0 || viewState->getHeight() <= 0) {
                     continue;
                 }
+
+                Tracer::Span span("CullWorker::cull");
+                span.setArg("layers", "%d", static_cast<int>(layers.size()));
                 
                 // Check if view state has changed
-                if (_firstCull || viewState.getModelviewProjectionMat() != _viewState.getModelviewProjectionMat() || viewState.getProjectionSurface() != _viewState.getProjectionSurface()) {
+                if (_firstCull || viewState->getModelviewProjectionMat() != _viewState->getModelviewProjectionMat() || viewState->getProjectionSurface() != _viewState->getProjectionSurface()) {
                     _firstCull = false;
                     _viewState = viewState;
                     
                     // Calculate state
-                    calculateCullState();
+                    calculateCullState(*mapRenderer);
                 }
                 
                 // Update layers
@@ -120,21 +126,30 @@ namespace carto {
         }
     }
     
-    void CullWorker::calculateCullState() {
+    void CullWorker::calculateCullState(const MapRenderer& mapRenderer) {
         // Calculate envelope for the visible frustum
         calculateEnvelope();
+
+        // Predict the view at the end of the camera movement, so that layers can preload the data
+        auto predictedViewState = std::make_shared<ViewState>();
+        if (mapRenderer.calculatePredictedViewState(*predictedViewState)) {
+            _predictedViewState = predictedViewState;
+        } else {
+            _predictedViewState.reset();
+        }
     }
     
     void CullWorker::calculateEnvelope() {
-        std::shared_ptr<ProjectionSurface> projectionSurface = _viewState.getProjectionSurface();
+        const ViewState& viewState = *_viewState;
+        std::shared_ptr<ProjectionSurface> projectionSurface = viewState.getProjectionSurface();
         if (!projectionSurface) {
             return;
         }
 
-        cglib::mat4x4<double> invMVPMat = cglib::inverse(_viewState.getModelviewProjectionMat());
+        cglib::mat4x4<double> invMVPMat = cglib::inverse(viewState.getModelviewProjectionMat());
 
-        bool addPole1 = _viewState.getFrustum().inside(projectionSurface->calculatePosition(MapPos(0, -std::numeric_limits<double>::infinity())));
-        bool addPole2 = _viewState.getFrustum().inside(projectionSurface->calculatePosition(MapPos(0,  std::numeric_limits<double>::infinity())));
+        bool addPole1 = viewState.getFrustum().inside(projectionSurface->calculatePosition(MapPos(0, -std::numeric_limits<double>::infinity())));
+        bool addPole2 = viewState.getFrustum().inside(projectionSurface->calculatePosition(MapPos(0,  std::numeric_limits<double>::infinity())));
 
         // Calculate tesselation level. Planar projection does not need tesselation. Poles on spherical surface must be tesselated to a high degree.
         int tesselationLevel = 1;
@@ -142,7 +157,7 @@ namespace carto {
             if (addPole1 || addPole2) {
                 tesselationLevel = MAX_VIEWPORT_TESSELATION_LEVEL;
             } else {
-                tesselationLevel = std::max(1, MAX_VIEWPORT_TESSELATION_LEVEL >> static_cast<int>(_viewState.getZoom()));
+                tesselationLevel = std::max(1, MAX_VIEWPORT_TESSELATION_LEVEL >> static_cast<int>(viewState.getZoom()));
             }
         }
 
@@ -164,10 +179,10 @@ namespace carto {
 
                 double t = -1;
                 if (projectionSurface->calculateHitPoint(ray, 0, t)) {
-                    t = std::min(t, static_cast<double>(_viewState.getFar()));
+                    t = std::min(t, static_cast<double>(viewState.getFar()));
                 }
 
-                MapPos mapPos = projectionSurface->calculateMapPos(ray(t > 0 ? t : _viewState.getFar()));
+                MapPos mapPos = projectionSurface->calculateMapPos(ray(t > 0 ? t : viewState.getFar()));
                 mapPoses.emplace_back(mapPos.getX(), mapPos.getY());
             }
         }
@@ -218,7 +233,7 @@ namespace carto {
     
     void CullWorker::updateLayers(const std::vector<std::shared_ptr<Layer> >& layers) {
         for (const std::shared_ptr<Layer>& layer : layers) {
-            layer->update(std::make_shared<CullState>(_envelope, _viewState));
+            layer->update(std::make_shared<CullState>(_envelope, _viewState, _predictedViewState));
         }
     }
     
@@ -42,7 +42,7 @@ namespace carto {
     private:
         void run();
     
-        void calculateCullState();
+        void calculateCullState(const MapRenderer& mapRenderer);
         void calculateEnvelope();
         void updateLayers(const std::vector<std::shared_ptr<Layer> >& layers);
     
@@ -58,7 +58,8 @@ namespace carto {
         
         MapEnvelope _envelope;
         
-        ViewState _viewState;
+        std::shared_ptr<const ViewState> _viewState;
+        std::shared_ptr<ViewState> _predictedViewState;
     
         std::weak_ptr<MapRenderer> _mapRenderer;
         std::shared_ptr<CullWorker> _worker;
@@ -0,0 +1,81 @@
+#include "RedrawWorker.h"
+#include "renderers/MapRenderer.h"
+#include "utils/ThreadUtils.h"
+
+#include <algorithm>
+
+namespace carto {
+
+    RedrawWorker::RedrawWorker() :
+        _stop(false),
+        _pendingWakeup(false),
+        _wakeupTime(std::chrono::steady_clock::now() + std::chrono::hours(24)),
+        _mapRenderer(),
+        _worker(),
+        _condition(),
+        _mutex()
+    {
+    }
+    
+    RedrawWorker::~RedrawWorker() {
+    }
+        
+    void RedrawWorker::setComponents(const std::weak_ptr<MapRenderer>& mapRenderer, const std::shared_ptr<RedrawWorker>& worker) {
+        _mapRenderer = mapRenderer;
+        // When the map component gets destroyed all threads get detatched. Detatched threads need their worker objects to be alive,
+        // so worker objects need to keep references to themselves, until the loop finishes.
+        _worker = worker;
+    }
+        
+    void RedrawWorker::init(int delayTime) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _pendingWakeup = true;
+        _wakeupTime = std::min(_wakeupTime, std::chrono::steady_clock::now() + std::chrono::milliseconds(delayTime));
+        _condition.notify_one();
+    }
+    
+    void RedrawWorker::stop() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+        _condition.notify_all();
+    }
+        
+    void RedrawWorker::operator ()() {
+        run();
+        _worker.reset();
+    }
+    
+    void RedrawWorker::run() {
+        ThreadUtils::SetThreadPriority(ThreadPriority::HIGH);
+        ThreadUtils::SetThreadQoSClass(ThreadQoSClass::USER_INTERACTIVE);
+    
+        while (true) {
+            bool run = false;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+
+                if (_stop) {
+                    return;
+                }
+
+                std::chrono::steady_clock::time_point currentTime = std::chrono::steady_clock::now();
+                if (_pendingWakeup && _wakeupTime - currentTime < std::chrono::milliseconds(1)) {
+                    run = true;
+                    _pendingWakeup = false;
+                    _wakeupTime = currentTime + std::chrono::hours(24);
+                }
+
+                if (!run) {
+                    _condition.wait_for(lock, _wakeupTime - currentTime);
+                }
+            }
+
+            if (run) {
+                if (std::shared_ptr<MapRenderer> mapRenderer = _mapRenderer.lock()) {
+                    mapRenderer->notifyRedrawRequested();
+                }
+            }
+        }
+    }
+    
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_REDRAWWORKER_H_
+#define _CARTO_REDRAWWORKER_H_
+
+#include "components/ThreadWorker.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+namespace carto {
+    class MapRenderer;
+    
+    /**
+     * Worker for delivering the delayed redraw requests, when the frame rate of the map renderer is limited.
+     */
+    class RedrawWorker : public ThreadWorker {
+    public:
+        RedrawWorker();
+        virtual ~RedrawWorker();
+        
+        void setComponents(const std::weak_ptr<MapRenderer>& mapRenderer, const std::shared_ptr<RedrawWorker>& worker);
+        
+        /**
+         * Schedules a redraw request. If a request is already scheduled, the earlier of the two times is used.
+         * @param delayTime The delay in milliseconds before the request is delivered.
+         */
+        void init(int delayTime);
+        
+        void stop();
+    
+        void operator()();
+    
+    private:
+        void run();
+
+        bool _stop;
+
+        bool _pendingWakeup;
+        std::chrono::steady_clock::time_point _wakeupTime;
+        
+        std::weak_ptr<MapRenderer> _mapRenderer;
+        std::shared_ptr<RedrawWorker> _worker;
+    
+        std::condition_variable _condition;
+        mutable std::mutex _mutex;
+    };
+    
+}
+
+#endif
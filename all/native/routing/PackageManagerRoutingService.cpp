@@ -20,21 +20,16 @@ namespace carto {
     PackageManagerRoutingService::PackageManagerRoutingService(const std::shared_ptr<PackageManager>& packageManager) :
         RoutingService(),
         _packageManager(packageManager),
-        _cachedPackageFileMap(),
-        _cachedRouteFinder(),
+        _cachedPackageVersionMap(),
+        _cachedRouteFinderPool(),
         _mutex()
     {
         if (!packageManager) {
             throw NullArgumentException("Null packageManager");
         }
-
-        _packageManagerListener = std::make_shared<PackageManagerListener>(*this);
-        _packageManager->registerOnChangeListener(_packageManagerListener);
     }
 
     PackageManagerRoutingService::~PackageManagerRoutingService() {
-        _packageManager->unregisterOnChangeListener(_packageManagerListener);
-        _packageManagerListener.reset();
     }
 
     std::shared_ptr<RoutingResult> PackageManagerRoutingService::calculateRoute(const std::shared_ptr<RoutingRequest>& request) const {
@@ -45,26 +40,30 @@ namespace carto {
         // Do routing via package manager, so that all packages are locked during routing
         std::shared_ptr<RoutingResult> result;
         _packageManager->accessLocalPackages([this, &result, &request](const std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<PackageHandler> >& packageHandlerMap) {
-            // Build map of routing packages and graph files
-            std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<std::ifstream> > packageFileMap;
+            // Build map of routing packages and their versions. Package handlers are recreated after any package change, so graph files are not compared directly
+            std::map<std::string, int> packageVersionMap;
+            std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<RoutingPackageHandler> > routingHandlerMap;
             for (auto it = packageHandlerMap.begin(); it != packageHandlerMap.end(); it++) {
                 if (auto routingHandler = std::dynamic_pointer_cast<RoutingPackageHandler>(it->second)) {
-                    if (std::shared_ptr<std::ifstream> graphFile = routingHandler->getGraphFile()) {
-                        packageFileMap[it->first] = graphFile;
-                    }
+                    packageVersionMap[it->first->getPackageId()] = it->first->getVersion();
+                    routingHandlerMap[it->first] = routingHandler;
                 }
             }
 
-            // Now check if we have already a cached route finder for the files. If not, create new instance.
-            std::shared_ptr<osrm::RouteFinder> routeFinder;
+            // Now check if we have already a cached graph for the packages. If not, open the graph files and create new instance.
+            std::shared_ptr<RouteFinderPool<osrm::RouteFinder> > routeFinderPool;
             {
                 std::lock_guard<std::mutex> lock(_mutex);
-                if (!_cachedRouteFinder || packageFileMap != _cachedPackageFileMap) {
+                if (!_cachedRouteFinderPool || packageVersionMap != _cachedPackageVersionMap) {
                     osrm::Graph::Settings graphSettings;
                     auto graph = std::make_shared<osrm::Graph>(graphSettings);
-                    for (auto it = packageFileMap.begin(); it != packageFileMap.end(); it++) {
+                    for (auto it = routingHandlerMap.begin(); it != routingHandlerMap.end(); it++) {
+                        std::shared_ptr<std::ifstream> graphFile = it->second->getGraphFile();
+                        if (!graphFile) {
+                            continue;
+                        }
                         try {
-                            if (!graph->import(it->second)) {
+                            if (!graph->import(graphFile)) {
                                 throw FileException("Failed to import graph " + it->first->getPackageId(), "");
                             }
                         }
@@ -72,32 +71,20 @@ namespace carto {
                             throw GenericException("Exception while importing graph " + it->first->getPackageId(), ex.what());
                         }
                     }
-                    _cachedPackageFileMap = packageFileMap;
-                    _cachedRouteFinder = std::make_shared<osrm::RouteFinder>(graph);
+                    _cachedPackageVersionMap = packageVersionMap;
+                    _cachedRouteFinderPool = std::make_shared<RouteFinderPool<osrm::RouteFinder> >([graph]() {
+                        return std::make_shared<osrm::RouteFinder>(graph);
+                    });
                 }
-                routeFinder = _cachedRouteFinder;
+                routeFinderPool = _cachedRouteFinderPool;
             }
 
-            result = OSRMRoutingProxy::CalculateRoute(routeFinder, request);
+            // Use a separate route finder per concurrent request, the graph itself is shared and not modified during routing
+            result = OSRMRoutingProxy::CalculateRoute(routeFinderPool->acquire(), request);
         });
 
         return result;
     }
-            
-    PackageManagerRoutingService::PackageManagerListener::PackageManagerListener(PackageManagerRoutingService& service) :
-        _service(service)
-    {
-    }
-        
-    void PackageManagerRoutingService::PackageManagerListener::onPackagesChanged() {
-        std::lock_guard<std::mutex> lock(_service._mutex);
-        _service._cachedPackageFileMap.clear();
-        _service._cachedRouteFinder.reset();
-    }
-
-    void PackageManagerRoutingService::PackageManagerListener::onStylesChanged() {
-        // Impossible
-    }
 
 }
 
@@ -11,6 +11,7 @@
 
 #include "packagemanager/PackageManager.h"
 #include "routing/RoutingService.h"
+#include "routing/RouteFinderPool.h"
 
 #include <memory>
 #include <string>
@@ -24,6 +25,8 @@ namespace carto {
 
     /**
      * A routing service that uses routing packages from package manager.
+     * The service is thread-safe: concurrent requests share the same routing graph but use separate search workspaces.
+     * The routing graph is rebuilt only when the set of routing packages (or their versions) changes.
      */
     class PackageManagerRoutingService : public RoutingService {
     public:
@@ -37,26 +40,12 @@ namespace carto {
         virtual std::shared_ptr<RoutingResult> calculateRoute(const std::shared_ptr<RoutingRequest>& request) const;
 
     protected:
-        class PackageManagerListener : public PackageManager::OnChangeListener {
-        public:
-            explicit PackageManagerListener(PackageManagerRoutingService& service);
-                
-            virtual void onPackagesChanged();
-            virtual void onStylesChanged();
-                
-        private:
-            PackageManagerRoutingService& _service;
-        };
-
         const std::shared_ptr<PackageManager> _packageManager;
 
-        mutable std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<std::ifstream> > _cachedPackageFileMap;
-        mutable std::shared_ptr<osrm::RouteFinder> _cachedRouteFinder;
+        mutable std::map<std::string, int> _cachedPackageVersionMap;
+        mutable std::shared_ptr<RouteFinderPool<osrm::RouteFinder> > _cachedRouteFinderPool;
 
         mutable std::mutex _mutex;
-
-    private:
-        std::shared_ptr<PackageManagerListener> _packageManagerListener;
     };
     
 }
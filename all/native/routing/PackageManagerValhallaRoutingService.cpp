@@ -7,6 +7,8 @@
 #include "projections/Projection.h"
 #include "routing/RouteMatchingRequest.h"
 #include "routing/RouteMatchingResult.h"
+#include "routing/RoutingMatrixRequest.h"
+#include "routing/RoutingMatrixResult.h"
 #include "routing/ValhallaRoutingProxy.h"
 #include "utils/Const.h"
 #include "utils/Log.h"
@@ -17,7 +19,9 @@ namespace carto {
         RoutingService(),
         _packageManager(packageManager),
         _profile("pedestrian"),
+        _tileCacheCapacity(ValhallaRoutingProxy::DEFAULT_TILE_CACHE_CAPACITY),
         _cachedPackageDatabases(),
+        _cachedGraph(),
         _mutex()
     {
         if (!packageManager) {
@@ -43,6 +47,19 @@ namespace carto {
         _profile = profile;
     }
 
+    std::size_t PackageManagerValhallaRoutingService::getTileCacheCapacity() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _tileCacheCapacity;
+    }
+
+    void PackageManagerValhallaRoutingService::setTileCacheCapacity(std::size_t capacityInBytes) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (capacityInBytes != _tileCacheCapacity) {
+            _tileCacheCapacity = capacityInBytes;
+            _cachedGraph.reset();
+        }
+    }
+
     std::shared_ptr<RouteMatchingResult> PackageManagerValhallaRoutingService::matchRoute(const std::shared_ptr<RouteMatchingRequest>& request) const {
         if (!request) {
             throw NullArgumentException("Null request");
@@ -61,13 +78,14 @@ namespace carto {
                 }
             }
 
-            // Now check if we have already a cached route finder for the files. If not, create new instance.
+            // Now check if we have already a cached graph for the files. If not, create new instance.
             std::lock_guard<std::mutex> lock(_mutex);
-            if (packageDatabases != _cachedPackageDatabases) {
+            if (!_cachedGraph || packageDatabases != _cachedPackageDatabases) {
                 _cachedPackageDatabases = packageDatabases;
+                _cachedGraph = ValhallaRoutingProxy::CreateGraph(_cachedPackageDatabases, _tileCacheCapacity);
             }
 
-            result = ValhallaRoutingProxy::MatchRoute(_cachedPackageDatabases, _profile, request);
+            result = ValhallaRoutingProxy::MatchRoute(_cachedGraph, _profile, request);
         });
 
         return result;
@@ -91,13 +109,45 @@ namespace carto {
                 }
             }
 
-            // Now check if we have already a cached route finder for the files. If not, create new instance.
+            // Now check if we have already a cached graph for the files. If not, create new instance.
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_cachedGraph || packageDatabases != _cachedPackageDatabases) {
+                _cachedPackageDatabases = packageDatabases;
+                _cachedGraph = ValhallaRoutingProxy::CreateGraph(_cachedPackageDatabases, _tileCacheCapacity);
+            }
+
+            result = ValhallaRoutingProxy::CalculateRoute(_cachedGraph, _profile, request);
+        });
+
+        return result;
+    }
+
+    std::shared_ptr<RoutingMatrixResult> PackageManagerValhallaRoutingService::calculateMatrix(const std::shared_ptr<RoutingMatrixRequest>& request) const {
+        if (!request) {
+            throw NullArgumentException("Null request");
+        }
+
+        // Do routing via package manager, so that all packages are locked during routing
+        std::shared_ptr<RoutingMatrixResult> result;
+        _packageManager->accessLocalPackages([this, &result, &request](const std::map<std::shared_ptr<PackageInfo>, std::shared_ptr<PackageHandler> >& packageHandlerMap) {
+            // Build map of routing packages and graph files
+            std::vector<std::shared_ptr<sqlite3pp::database> > packageDatabases;
+            for (auto it = packageHandlerMap.begin(); it != packageHandlerMap.end(); it++) {
+                if (auto valhallaRoutingHandler = std::dynamic_pointer_cast<ValhallaRoutingPackageHandler>(it->second)) {
+                    if (std::shared_ptr<sqlite3pp::database> database = valhallaRoutingHandler->getDatabase()) {
+                        packageDatabases.push_back(database);
+                    }
+                }
+            }
+
+            // Now check if we have already a cached graph for the files. If not, create new instance.
             std::lock_guard<std::mutex> lock(_mutex);
-            if (packageDatabases != _cachedPackageDatabases) {
+            if (!_cachedGraph || packageDatabases != _cachedPackageDatabases) {
                 _cachedPackageDatabases = packageDatabases;
+                _cachedGraph = ValhallaRoutingProxy::CreateGraph(_cachedPackageDatabases, _tileCacheCapacity);
             }
 
-            result = ValhallaRoutingProxy::CalculateRoute(_cachedPackageDatabases, _profile, request);
+            result = ValhallaRoutingProxy::CalculateMatrix(_cachedGraph, _profile, request);
         });
 
         return result;
@@ -111,6 +161,7 @@ namespace carto {
     void PackageManagerValhallaRoutingService::PackageManagerListener::onPackagesChanged() {
         std::lock_guard<std::mutex> lock(_service._mutex);
         _service._cachedPackageDatabases.clear();
+        _service._cachedGraph.reset();
     }
 
     void PackageManagerValhallaRoutingService::PackageManagerListener::onStylesChanged() {
@@ -11,6 +11,7 @@
 
 #include "packagemanager/PackageManager.h"
 #include "routing/RoutingService.h"
+#include "routing/ValhallaRoutingProxy.h"
 
 #include <memory>
 #include <string>
@@ -24,6 +25,8 @@ namespace sqlite3pp {
 namespace carto {
     class RouteMatchingRequest;
     class RouteMatchingResult;
+    class RoutingMatrixRequest;
+    class RoutingMatrixResult;
 
     /**
      * A routing service that uses routing packages from package manager.
@@ -48,6 +51,17 @@ namespace carto {
          */
         void setProfile(const std::string& profile);
 
+        /**
+         * Returns the capacity of the routing graph tile cache.
+         * @return The capacity of the tile cache in bytes. The default is 16MB.
+         */
+        std::size_t getTileCacheCapacity() const;
+        /**
+         * Sets the capacity of the routing graph tile cache. The cache is kept between routing requests.
+         * @param capacityInBytes The new capacity of the tile cache in bytes.
+         */
+        void setTileCacheCapacity(std::size_t capacityInBytes);
+
         /**
          * Matches specified points to the points on road network.
          * @param request The matching request.
@@ -58,6 +72,15 @@ namespace carto {
 
         virtual std::shared_ptr<RoutingResult> calculateRoute(const std::shared_ptr<RoutingRequest>& request) const;
 
+        /**
+         * Calculates travel times and distances between all sources and targets of the request.
+         * The result does not contain route geometry or instructions, making this much faster than calculating individual routes.
+         * @param request The matrix request.
+         * @return The matrix result.
+         * @throws std::runtime_error If IO error occured during the calculation.
+         */
+        std::shared_ptr<RoutingMatrixResult> calculateMatrix(const std::shared_ptr<RoutingMatrixRequest>& request) const;
+
     protected:
         class PackageManagerListener : public PackageManager::OnChangeListener {
         public:
@@ -72,8 +95,10 @@ namespace carto {
 
         const std::shared_ptr<PackageManager> _packageManager;
         std::string _profile;
+        std::size_t _tileCacheCapacity;
 
         mutable std::vector<std::shared_ptr<sqlite3pp::database> > _cachedPackageDatabases;
+        mutable std::shared_ptr<ValhallaRoutingProxy::Graph> _cachedGraph;
 
         mutable std::mutex _mutex;
 
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_ROUTEFINDERPOOL_H_
+#define _CARTO_ROUTEFINDERPOOL_H_
+
+#ifdef _CARTO_ROUTING_SUPPORT
+
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <vector>
+
+namespace carto {
+
+    /**
+     * A thread-safe pool of route finders, created from the same immutable routing graph.
+     * Each route finder keeps its own search workspace and is used by a single thread at a time,
+     * so concurrent routing requests can run in parallel without sharing mutable search state.
+     * The pool must be created using std::make_shared.
+     */
+    template <typename RouteFinder>
+    class RouteFinderPool : public std::enable_shared_from_this<RouteFinderPool<RouteFinder> > {
+    public:
+        typedef std::function<std::shared_ptr<RouteFinder>()> Factory;
+
+        explicit RouteFinderPool(const Factory& factory);
+        virtual ~RouteFinderPool() { }
+
+        /**
+         * Returns a route finder for exclusive use by the calling thread.
+         * The route finder is returned to the pool once the returned pointer (and all its copies) are released.
+         * @return The route finder.
+         */
+        std::shared_ptr<RouteFinder> acquire();
+
+    private:
+        void release(const std::shared_ptr<RouteFinder>& routeFinder);
+
+        static const std::size_t MAX_IDLE_ROUTE_FINDERS = 8;
+
+        const Factory _factory;
+        std::vector<std::shared_ptr<RouteFinder> > _idleRouteFinders;
+        mutable std::mutex _mutex;
+    };
+
+    template <typename RouteFinder>
+    RouteFinderPool<RouteFinder>::RouteFinderPool(const Factory& factory) :
+        _factory(factory),
+        _idleRouteFinders(),
+        _mutex()
+    {
+    }
+
+    template <typename RouteFinder>
+    std::shared_ptr<RouteFinder> RouteFinderPool<RouteFinder>::acquire() {
+        std::shared_ptr<RouteFinder> routeFinder;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_idleRouteFinders.empty()) {
+                routeFinder = _idleRouteFinders.back();
+                _idleRouteFinders.pop_back();
+            }
+        }
+        if (!routeFinder) {
+            // Create the workspace outside the lock, other threads may keep using the idle route finders meanwhile
+            routeFinder = _factory();
+        }
+
+        // Wrap the route finder, so that it is returned to the pool when the caller is done with it
+        std::weak_ptr<RouteFinderPool<RouteFinder> > poolWeak = this->shared_from_this();
+        return std::shared_ptr<RouteFinder>(routeFinder.get(), [poolWeak, routeFinder](RouteFinder*) {
+            if (std::shared_ptr<RouteFinderPool<RouteFinder> > pool = poolWeak.lock()) {
+                pool->release(routeFinder);
+            }
+        });
+    }
+
+    template <typename RouteFinder>
+    void RouteFinderPool<RouteFinder>::release(const std::shared_ptr<RouteFinder>& routeFinder) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_idleRouteFinders.size() < MAX_IDLE_ROUTE_FINDERS) {
+            _idleRouteFinders.push_back(routeFinder);
+        }
+    }
+
+}
+
+#endif
+
+#endif
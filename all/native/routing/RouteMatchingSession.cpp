@@ -0,0 +1,66 @@
+#if defined(_CARTO_ROUTING_SUPPORT) && defined(_CARTO_VALHALLA_ROUTING_SUPPORT)
+
+#include "RouteMatchingSession.h"
+#include "components/Exceptions.h"
+#include "routing/RouteMatchingRequest.h"
+#include "routing/RouteMatchingResult.h"
+
+#include <vector>
+
+namespace carto {
+
+    RouteMatchingSession::RouteMatchingSession(const std::shared_ptr<ValhallaRoutingProxy::Graph>& graph, const std::string& profile, const std::shared_ptr<Projection>& projection, float accuracy) :
+        _graph(graph),
+        _profile(profile),
+        _projection(projection),
+        _accuracy(accuracy),
+        _points(),
+        _mutex()
+    {
+        if (!graph) {
+            throw NullArgumentException("Null graph");
+        }
+        if (!projection) {
+            throw NullArgumentException("Null projection");
+        }
+    }
+
+    RouteMatchingSession::~RouteMatchingSession() {
+    }
+
+    const std::shared_ptr<Projection>& RouteMatchingSession::getProjection() const {
+        return _projection;
+    }
+
+    float RouteMatchingSession::getAccuracy() const {
+        return _accuracy;
+    }
+
+    MapPos RouteMatchingSession::addPoint(const MapPos& pos) {
+        std::vector<MapPos> points;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _points.push_back(pos);
+            if (_points.size() > MAX_MATCHED_POINTS) {
+                _points.pop_front();
+            }
+            points.assign(_points.begin(), _points.end());
+        }
+
+        // Match only the latest points, the preceding points are needed to resolve the transitions to the last point
+        auto request = std::make_shared<RouteMatchingRequest>(_projection, points, _accuracy);
+        std::shared_ptr<RouteMatchingResult> result = ValhallaRoutingProxy::MatchRoute(_graph, _profile, request);
+        if (!result || result->getPoints().size() != points.size()) {
+            return pos;
+        }
+        return result->getPoints().back();
+    }
+
+    void RouteMatchingSession::reset() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _points.clear();
+    }
+
+}
+
+#endif
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_ROUTEMATCHINGSESSION_H_
+#define _CARTO_ROUTEMATCHINGSESSION_H_
+
+#if defined(_CARTO_ROUTING_SUPPORT) && defined(_CARTO_VALHALLA_ROUTING_SUPPORT)
+
+#include "core/MapPos.h"
+#include "routing/ValhallaRoutingProxy.h"
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace carto {
+    class Projection;
+
+    /**
+     * An incremental route matching session for live location updates.
+     * Points are added one at a time and each new point is matched together with a bounded number of preceding points,
+     * so the cost of each update does not depend on the total length of the trace.
+     */
+    class RouteMatchingSession {
+    public:
+        /**
+         * Constructs a new RouteMatchingSession instance. Sessions should be created using routing services.
+         * @param graph The routing graph to use.
+         * @param profile The costing profile to use.
+         * @param projection The projection of the points.
+         * @param accuracy Accuracy of the points in meters.
+         */
+        RouteMatchingSession(const std::shared_ptr<ValhallaRoutingProxy::Graph>& graph, const std::string& profile, const std::shared_ptr<Projection>& projection, float accuracy);
+        virtual ~RouteMatchingSession();
+
+        /**
+         * Returns the projection of the points in the session.
+         * @return The projection of the session.
+         */
+        const std::shared_ptr<Projection>& getProjection() const;
+        /**
+         * Returns the accuracy of the points in the session.
+         * @return The accuracy of the points in the session.
+         */
+        float getAccuracy() const;
+
+        /**
+         * Adds a new measured point to the session and matches it to the road network.
+         * @param pos The measured point.
+         * @return The matched position of the point. If the point could not be matched, the original point is returned.
+         * @throws std::runtime_error If IO error occured during the route matching.
+         */
+        MapPos addPoint(const MapPos& pos);
+        /**
+         * Removes all previously added points from the session, for example after a long gap in location updates.
+         */
+        void reset();
+
+    private:
+        static const std::size_t MAX_MATCHED_POINTS = 16;
+
+        const std::shared_ptr<ValhallaRoutingProxy::Graph> _graph;
+        const std::string _profile;
+        const std::shared_ptr<Projection> _projection;
+        const float _accuracy;
+
+        std::deque<MapPos> _points;
+
+        mutable std::mutex _mutex;
+    };
+    
+}
+
+#endif
+
+#endif
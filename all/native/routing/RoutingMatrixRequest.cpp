@@ -0,0 +1,55 @@
+#ifdef _CARTO_ROUTING_SUPPORT
+
+#include "RoutingMatrixRequest.h"
+#include "components/Exceptions.h"
+
+#include <iomanip>
+#include <sstream>
+
+namespace carto {
+
+    RoutingMatrixRequest::RoutingMatrixRequest(const std::shared_ptr<Projection>& projection, const std::vector<MapPos>& sources, const std::vector<MapPos>& targets) :
+        _projection(projection),
+        _sources(sources),
+        _targets(targets)
+    {
+        if (!projection) {
+            throw NullArgumentException("Null projection");
+        }
+    }
+
+    RoutingMatrixRequest::~RoutingMatrixRequest() {
+    }
+
+    const std::shared_ptr<Projection>& RoutingMatrixRequest::getProjection() const {
+        return _projection;
+    }
+
+    const std::vector<MapPos>& RoutingMatrixRequest::getSources() const {
+        return _sources;
+    }
+
+    const std::vector<MapPos>& RoutingMatrixRequest::getTargets() const {
+        return _targets;
+    }
+
+    std::string RoutingMatrixRequest::toString() const {
+        std::stringstream ss;
+        ss << std::setiosflags(std::ios::fixed);
+        ss << "RoutingMatrixRequest [sources=";
+        for (auto it = _sources.begin(); it != _sources.end(); ++it) {
+            const MapPos& pos = *it;
+            ss << (it == _sources.begin() ? "" : ", ") << pos.toString();
+        }
+        ss << ", targets=";
+        for (auto it = _targets.begin(); it != _targets.end(); ++it) {
+            const MapPos& pos = *it;
+            ss << (it == _targets.begin() ? "" : ", ") << pos.toString();
+        }
+        ss << "]";
+        return ss.str();
+    }
+
+}
+
+#endif
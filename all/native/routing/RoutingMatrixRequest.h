@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_ROUTINGMATRIXREQUEST_H_
+#define _CARTO_ROUTINGMATRIXREQUEST_H_
+
+#ifdef _CARTO_ROUTING_SUPPORT
+
+#include "core/MapPos.h"
+
+#include <memory>
+#include <vector>
+
+namespace carto {
+    class Projection;
+
+    /**
+     * A class that defines required attributes for calculating travel times and distances between multiple sources and targets.
+     */
+    class RoutingMatrixRequest {
+    public:
+        /**
+         * Constructs a new RoutingMatrixRequest instance from projection, source points and target points.
+         * @param projection The projection of the points.
+         * @param sources The list of source points. Must contain at least 1 element.
+         * @param targets The list of target points. Must contain at least 1 element.
+         */
+        RoutingMatrixRequest(const std::shared_ptr<Projection>& projection, const std::vector<MapPos>& sources, const std::vector<MapPos>& targets);
+        virtual ~RoutingMatrixRequest();
+
+        /**
+         * Returns the projection of the points in the request.
+         * @return The projection of the request.
+         */
+        const std::shared_ptr<Projection>& getProjection() const;
+        /**
+         * Returns the source points of the request.
+         * @return The source points of the request.
+         */
+        const std::vector<MapPos>& getSources() const;
+        /**
+         * Returns the target points of the request.
+         * @return The target points of the request.
+         */
+        const std::vector<MapPos>& getTargets() const;
+
+        /**
+         * Creates a string representation of this request object, useful for logging.
+         * @return The string representation of this request object.
+         */
+        std::string toString() const;
+        
+    private:
+        std::shared_ptr<Projection> _projection;
+        std::vector<MapPos> _sources;
+        std::vector<MapPos> _targets;
+    };
+    
+}
+
+#endif
+
+#endif
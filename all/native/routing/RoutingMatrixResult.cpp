@@ -0,0 +1,68 @@
+#ifdef _CARTO_ROUTING_SUPPORT
+
+#include "RoutingMatrixResult.h"
+#include "components/Exceptions.h"
+
+#include <iomanip>
+#include <sstream>
+
+namespace carto {
+
+    RoutingMatrixResult::RoutingMatrixResult(int sourceCount, int targetCount, const std::vector<double>& durations, const std::vector<double>& distances) :
+        _sourceCount(sourceCount),
+        _targetCount(targetCount),
+        _durations(durations),
+        _distances(distances)
+    {
+        if (sourceCount < 0 || targetCount < 0) {
+            throw InvalidArgumentException("Negative matrix size");
+        }
+        if (durations.size() != static_cast<std::size_t>(sourceCount) * targetCount || distances.size() != static_cast<std::size_t>(sourceCount) * targetCount) {
+            throw InvalidArgumentException("Matrix size mismatch");
+        }
+    }
+
+    RoutingMatrixResult::~RoutingMatrixResult() {
+    }
+
+    int RoutingMatrixResult::getSourceCount() const {
+        return _sourceCount;
+    }
+
+    int RoutingMatrixResult::getTargetCount() const {
+        return _targetCount;
+    }
+
+    double RoutingMatrixResult::getDuration(int sourceIndex, int targetIndex) const {
+        if (sourceIndex < 0 || sourceIndex >= _sourceCount || targetIndex < 0 || targetIndex >= _targetCount) {
+            throw OutOfRangeException("Matrix index out of range");
+        }
+        return _durations[static_cast<std::size_t>(sourceIndex) * _targetCount + targetIndex];
+    }
+
+    double RoutingMatrixResult::getDistance(int sourceIndex, int targetIndex) const {
+        if (sourceIndex < 0 || sourceIndex >= _sourceCount || targetIndex < 0 || targetIndex >= _targetCount) {
+            throw OutOfRangeException("Matrix index out of range");
+        }
+        return _distances[static_cast<std::size_t>(sourceIndex) * _targetCount + targetIndex];
+    }
+
+    std::string RoutingMatrixResult::toString() const {
+        std::stringstream ss;
+        ss << std::setiosflags(std::ios::fixed);
+        ss << "RoutingMatrixResult [sources=" << _sourceCount << ", targets=" << _targetCount;
+        ss << ", durations=";
+        for (std::size_t i = 0; i < _durations.size(); i++) {
+            ss << (i == 0 ? "" : ", ") << _durations[i];
+        }
+        ss << ", distances=";
+        for (std::size_t i = 0; i < _distances.size(); i++) {
+            ss << (i == 0 ? "" : ", ") << _distances[i];
+        }
+        ss << "]";
+        return ss.str();
+    }
+
+}
+
+#endif
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_ROUTINGMATRIXRESULT_H_
+#define _CARTO_ROUTINGMATRIXRESULT_H_
+
+#ifdef _CARTO_ROUTING_SUPPORT
+
+#include <string>
+#include <vector>
+
+namespace carto {
+
+    /**
+     * A class that contains travel times and distances between all sources and targets of a matrix request.
+     * The result does not contain route geometry or instructions.
+     */
+    class RoutingMatrixResult {
+    public:
+        /**
+         * Constructs a new RoutingMatrixResult instance from the matrix dimensions, durations and distances.
+         * @param sourceCount The number of sources.
+         * @param targetCount The number of targets.
+         * @param durations The travel times in seconds, in source-major order. Negative values denote unreachable targets.
+         * @param distances The travel distances in meters, in source-major order. Negative values denote unreachable targets.
+         */
+        RoutingMatrixResult(int sourceCount, int targetCount, const std::vector<double>& durations, const std::vector<double>& distances);
+        virtual ~RoutingMatrixResult();
+
+        /**
+         * Returns the number of sources in the result.
+         * @return The number of sources.
+         */
+        int getSourceCount() const;
+        /**
+         * Returns the number of targets in the result.
+         * @return The number of targets.
+         */
+        int getTargetCount() const;
+
+        /**
+         * Returns the travel time from the given source to the given target.
+         * @param sourceIndex The index of the source.
+         * @param targetIndex The index of the target.
+         * @return The travel time in seconds. Negative if the target is not reachable from the source.
+         * @throws std::out_of_range If the index is out of range.
+         */
+        double getDuration(int sourceIndex, int targetIndex) const;
+        /**
+         * Returns the travel distance from the given source to the given target.
+         * @param sourceIndex The index of the source.
+         * @param targetIndex The index of the target.
+         * @return The travel distance in meters. Negative if the target is not reachable from the source.
+         * @throws std::out_of_range If the index is out of range.
+         */
+        double getDistance(int sourceIndex, int targetIndex) const;
+
+        /**
+         * Creates a string representation of this result object, useful for logging.
+         * @return The string representation of this result object.
+         */
+        std::string toString() const;
+        
+    private:
+        int _sourceCount;
+        int _targetCount;
+        std::vector<double> _durations;
+        std::vector<double> _distances;
+    };
+    
+}
+
+#endif
+
+#endif
@@ -26,7 +26,7 @@ namespace carto {
         _featureData(geoJSON.toPicoJSON()),
         _config(config.toPicoJSON()),
         _profile(),
-        _cachedRouteFinder(),
+        _cachedRouteFinderPools(),
         _mutex()
     {
     }
@@ -36,7 +36,7 @@ namespace carto {
         _featureData(),
         _config(config.toPicoJSON()),
         _profile(),
-        _cachedRouteFinder(),
+        _cachedRouteFinderPools(),
         _mutex()
     {
         if (!featureCollection) {
@@ -62,10 +62,11 @@ namespace carto {
 
     void SGREOfflineRoutingService::setProfile(const std::string& profile) {
         std::lock_guard<std::mutex> lock(_mutex);
-        if (profile != _profile) {
-            _profile = profile;
-            _cachedRouteFinder.reset();
-        }
+        _profile = profile;
+    }
+
+    void SGREOfflineRoutingService::prepare() const {
+        getRouteFinderPool();
     }
 
     std::shared_ptr<RoutingResult> SGREOfflineRoutingService::calculateRoute(const std::shared_ptr<RoutingRequest>& request) const {
@@ -73,25 +74,15 @@ namespace carto {
             throw NullArgumentException("Null request");
         }
 
+        std::shared_ptr<RouteFinderPool<sgre::RouteFinder> > routeFinderPool = getRouteFinderPool();
+
+        // Use a separate route finder per concurrent request, the graph itself is shared and not modified during routing
         std::shared_ptr<sgre::RouteFinder> routeFinder;
-        {
-            std::lock_guard<std::mutex> lock(_mutex);
-            if (!_cachedRouteFinder) {
-                try {
-                    sgre::RuleList ruleList;
-                    if (_config.contains("rules")) {
-                        ruleList = sgre::RuleList::parse(_config.get("rules"));
-                    }
-                    ruleList.filter(_profile);
-                    sgre::GraphBuilder graphBuilder(std::move(ruleList));
-                    graphBuilder.importGeoJSON(_featureData);
-                    _cachedRouteFinder = sgre::RouteFinder::create(graphBuilder.build(), _config);
-                }
-                catch (const std::exception& ex) {
-                    throw GenericException("Failed to create routing graph", ex.what());
-                }
-            }
-            routeFinder = _cachedRouteFinder;
+        try {
+            routeFinder = routeFinderPool->acquire();
+        }
+        catch (const std::exception& ex) {
+            throw GenericException("Failed to create route finder", ex.what());
         }
 
         std::shared_ptr<Projection> proj = request->getProjection();
@@ -177,6 +168,37 @@ namespace carto {
         return std::make_shared<RoutingResult>(proj, points, instructions);
     }
 
+    std::shared_ptr<RouteFinderPool<sgre::RouteFinder> > SGREOfflineRoutingService::getRouteFinderPool() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // Graphs are cached per profile, so that switching between profiles does not trigger rebuilding
+        auto it = _cachedRouteFinderPools.find(_profile);
+        if (it != _cachedRouteFinderPools.end()) {
+            return it->second;
+        }
+
+        std::shared_ptr<RouteFinderPool<sgre::RouteFinder> > routeFinderPool;
+        try {
+            sgre::RuleList ruleList;
+            if (_config.contains("rules")) {
+                ruleList = sgre::RuleList::parse(_config.get("rules"));
+            }
+            ruleList.filter(_profile);
+            sgre::GraphBuilder graphBuilder(std::move(ruleList));
+            graphBuilder.importGeoJSON(_featureData);
+            auto graph = graphBuilder.build();
+            picojson::value config = _config;
+            routeFinderPool = std::make_shared<RouteFinderPool<sgre::RouteFinder> >([graph, config]() {
+                return sgre::RouteFinder::create(graph, config);
+            });
+        }
+        catch (const std::exception& ex) {
+            throw GenericException("Failed to create routing graph", ex.what());
+        }
+        _cachedRouteFinderPools[_profile] = routeFinderPool;
+        return routeFinderPool;
+    }
+
     float SGREOfflineRoutingService::CalculateTurnAngle(const std::vector<MapPos>& epsg3857Points, int pointIndex) {
         int pointIndex0 = pointIndex;
         while (--pointIndex0 >= 0) {
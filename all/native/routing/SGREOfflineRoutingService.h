@@ -11,8 +11,10 @@
 
 #include "core/Variant.h"
 #include "routing/RoutingService.h"
+#include "routing/RouteFinderPool.h"
 
 #include <memory>
+#include <map>
 #include <mutex>
 #include <string>
 
@@ -29,6 +31,7 @@ namespace carto {
 
     /**
      * An offline routing service that uses SGRE routing engine.
+     * The service is thread-safe: concurrent requests share the same routing graph but use separate search workspaces.
      * Note: this class is experimental and may change or even be removed in future SDK versions.
      */
     class SGREOfflineRoutingService : public RoutingService {
@@ -61,9 +64,19 @@ namespace carto {
          */
         void setProfile(const std::string& profile);
 
+        /**
+         * Builds the routing graph for the current profile, if it is not already built.
+         * Building the graph may take considerable time for large feature collections, so this method can be called
+         * from a background thread to avoid the delay when calculating the first route.
+         * @throws std::runtime_error If an error occured while building the graph.
+         */
+        void prepare() const;
+
         virtual std::shared_ptr<RoutingResult> calculateRoute(const std::shared_ptr<RoutingRequest>& request) const;
 
     protected:
+        std::shared_ptr<RouteFinderPool<sgre::RouteFinder> > getRouteFinderPool() const;
+
         static float CalculateTurnAngle(const std::vector<MapPos>& epsg3857Points, int pointIndex);
         
         static float CalculateAzimuth(const std::vector<MapPos>& epsg3857Points, int pointIndex);
@@ -74,7 +87,7 @@ namespace carto {
         picojson::value _config;
         std::string _profile;
 
-        mutable std::shared_ptr<sgre::RouteFinder> _cachedRouteFinder;
+        mutable std::map<std::string, std::shared_ptr<RouteFinderPool<sgre::RouteFinder> > > _cachedRouteFinderPools;
 
         mutable std::mutex _mutex;
     };
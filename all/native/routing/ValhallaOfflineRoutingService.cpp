@@ -4,6 +4,9 @@
 #include "components/Exceptions.h"
 #include "routing/RouteMatchingRequest.h"
 #include "routing/RouteMatchingResult.h"
+#include "routing/RouteMatchingSession.h"
+#include "routing/RoutingMatrixRequest.h"
+#include "routing/RoutingMatrixResult.h"
 #include "routing/ValhallaRoutingProxy.h"
 #include "utils/Const.h"
 #include "utils/Log.h"
@@ -15,6 +18,8 @@ namespace carto {
     ValhallaOfflineRoutingService::ValhallaOfflineRoutingService(const std::string& path) :
         _database(),
         _profile("pedestrian"),
+        _tileCacheCapacity(ValhallaRoutingProxy::DEFAULT_TILE_CACHE_CAPACITY),
+        _cachedGraph(),
         _mutex()
     {
         _database.reset(new sqlite3pp::database());
@@ -36,12 +41,47 @@ namespace carto {
         _profile = profile;
     }
 
+    std::size_t ValhallaOfflineRoutingService::getTileCacheCapacity() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _tileCacheCapacity;
+    }
+
+    void ValhallaOfflineRoutingService::setTileCacheCapacity(std::size_t capacityInBytes) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (capacityInBytes != _tileCacheCapacity) {
+            _tileCacheCapacity = capacityInBytes;
+            _cachedGraph.reset();
+        }
+    }
+
     std::shared_ptr<RouteMatchingResult> ValhallaOfflineRoutingService::matchRoute(const std::shared_ptr<RouteMatchingRequest>& request) const {
         if (!request) {
             throw NullArgumentException("Null request");
         }
 
-        return ValhallaRoutingProxy::MatchRoute(std::vector<std::shared_ptr<sqlite3pp::database> > { _database }, getProfile(), request);
+        std::shared_ptr<ValhallaRoutingProxy::Graph> graph;
+        std::string profile;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_cachedGraph) {
+                _cachedGraph = ValhallaRoutingProxy::CreateGraph(std::vector<std::shared_ptr<sqlite3pp::database> > { _database }, _tileCacheCapacity);
+            }
+            graph = _cachedGraph;
+            profile = _profile;
+        }
+        return ValhallaRoutingProxy::MatchRoute(graph, profile, request);
+    }
+
+    std::shared_ptr<RouteMatchingSession> ValhallaOfflineRoutingService::createMatchingSession(const std::shared_ptr<Projection>& projection, float accuracy) const {
+        if (!projection) {
+            throw NullArgumentException("Null projection");
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_cachedGraph) {
+            _cachedGraph = ValhallaRoutingProxy::CreateGraph(std::vector<std::shared_ptr<sqlite3pp::database> > { _database }, _tileCacheCapacity);
+        }
+        return std::make_shared<RouteMatchingSession>(_cachedGraph, _profile, projection, accuracy);
     }
 
     std::shared_ptr<RoutingResult> ValhallaOfflineRoutingService::calculateRoute(const std::shared_ptr<RoutingRequest>& request) const {
@@ -49,7 +89,35 @@ namespace carto {
             throw NullArgumentException("Null request");
         }
 
-        return ValhallaRoutingProxy::CalculateRoute(std::vector<std::shared_ptr<sqlite3pp::database> > { _database }, getProfile(), request);
+        std::shared_ptr<ValhallaRoutingProxy::Graph> graph;
+        std::string profile;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_cachedGraph) {
+                _cachedGraph = ValhallaRoutingProxy::CreateGraph(std::vector<std::shared_ptr<sqlite3pp::database> > { _database }, _tileCacheCapacity);
+            }
+            graph = _cachedGraph;
+            profile = _profile;
+        }
+        return ValhallaRoutingProxy::CalculateRoute(graph, profile, request);
+    }
+
+    std::shared_ptr<RoutingMatrixResult> ValhallaOfflineRoutingService::calculateMatrix(const std::shared_ptr<RoutingMatrixRequest>& request) const {
+        if (!request) {
+            throw NullArgumentException("Null request");
+        }
+
+        std::shared_ptr<ValhallaRoutingProxy::Graph> graph;
+        std::string profile;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_cachedGraph) {
+                _cachedGraph = ValhallaRoutingProxy::CreateGraph(std::vector<std::shared_ptr<sqlite3pp::database> > { _database }, _tileCacheCapacity);
+            }
+            graph = _cachedGraph;
+            profile = _profile;
+        }
+        return ValhallaRoutingProxy::CalculateMatrix(graph, profile, request);
     }
 
 }
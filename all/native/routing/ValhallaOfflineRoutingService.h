@@ -10,6 +10,7 @@
 #if defined(_CARTO_ROUTING_SUPPORT) && defined(_CARTO_VALHALLA_ROUTING_SUPPORT) && defined(_CARTO_OFFLINE_SUPPORT)
 
 #include "routing/RoutingService.h"
+#include "routing/ValhallaRoutingProxy.h"
 
 #include <memory>
 #include <mutex>
@@ -20,8 +21,12 @@ namespace sqlite3pp {
 }
 
 namespace carto {
+    class Projection;
     class RouteMatchingRequest;
     class RouteMatchingResult;
+    class RouteMatchingSession;
+    class RoutingMatrixRequest;
+    class RoutingMatrixResult;
 
     /**
      * An offline routing service that uses Valhalla routing tiles.
@@ -47,6 +52,17 @@ namespace carto {
          */
         void setProfile(const std::string& profile);
 
+        /**
+         * Returns the capacity of the routing graph tile cache.
+         * @return The capacity of the tile cache in bytes. The default is 16MB.
+         */
+        std::size_t getTileCacheCapacity() const;
+        /**
+         * Sets the capacity of the routing graph tile cache. The cache is kept between routing requests.
+         * @param capacityInBytes The new capacity of the tile cache in bytes.
+         */
+        void setTileCacheCapacity(std::size_t capacityInBytes);
+
         /**
          * Matches specified points to the points on road network.
          * @param request The matching request.
@@ -54,12 +70,30 @@ namespace carto {
          * @throws std::runtime_error If IO error occured during the route matching.
          */
         std::shared_ptr<RouteMatchingResult> matchRoute(const std::shared_ptr<RouteMatchingRequest>& request) const;
+        /**
+         * Creates a new incremental route matching session for live location updates, using the current profile.
+         * @param projection The projection of the points.
+         * @param accuracy Accuracy of the points in meters.
+         * @return The new matching session.
+         */
+        std::shared_ptr<RouteMatchingSession> createMatchingSession(const std::shared_ptr<Projection>& projection, float accuracy) const;
 
         virtual std::shared_ptr<RoutingResult> calculateRoute(const std::shared_ptr<RoutingRequest>& request) const;
 
+        /**
+         * Calculates travel times and distances between all sources and targets of the request.
+         * The result does not contain route geometry or instructions, making this much faster than calculating individual routes.
+         * @param request The matrix request.
+         * @return The matrix result.
+         * @throws std::runtime_error If IO error occured during the calculation.
+         */
+        std::shared_ptr<RoutingMatrixResult> calculateMatrix(const std::shared_ptr<RoutingMatrixRequest>& request) const;
+
     private:
         std::shared_ptr<sqlite3pp::database> _database;
         std::string _profile;
+        std::size_t _tileCacheCapacity;
+        mutable std::shared_ptr<ValhallaRoutingProxy::Graph> _cachedGraph;
         mutable std::mutex _mutex;
     };
     
@@ -7,12 +7,15 @@
 #include "projections/EPSG3857.h"
 #include "routing/RouteMatchingRequest.h"
 #include "routing/RouteMatchingResult.h"
+#include "routing/RoutingMatrixRequest.h"
+#include "routing/RoutingMatrixResult.h"
 #include "network/HTTPClient.h"
 #include "utils/NetworkUtils.h"
 #include "utils/Const.h"
 #include "utils/Log.h"
 
 #include <ctime>
+#include <mutex>
 #include <vector>
 #include <functional>
 #include <string>
@@ -65,11 +68,15 @@
 #include <valhalla/thor/multimodal.h>
 #include <valhalla/thor/trippathbuilder.h>
 #include <valhalla/thor/isochrone.h>
+#include <valhalla/thor/costmatrix.h>
+#include <valhalla/thor/timedistancematrix.h>
 #include <valhalla/odin/util.h>
 #include <valhalla/odin/directionsbuilder.h>
 #include <valhalla/proto/trippath.pb.h>
 #include <valhalla/proto/tripdirections.pb.h>
 
+#include <sqlite3pp.h>
+
 namespace valhalla { namespace sif {
 
     cost_ptr_t CreateWheelchairCost(const boost::property_tree::ptree& config) {
@@ -90,7 +97,7 @@ namespace valhalla { namespace meili {
 
     class map_matcher_factory_t {
     public:
-        map_matcher_factory_t(const std::vector<std::shared_ptr<sqlite3pp::database>>& databases, const std::string& costing);
+        map_matcher_factory_t(baldr::GraphReader& graphreader, const std::string& costing);
         ~map_matcher_factory_t();
 
         baldr::GraphReader& graphreader()
@@ -118,12 +125,11 @@ namespace valhalla { namespace meili {
     private:
         typedef sif::cost_ptr_t (*factory_function_t)(const boost::property_tree::ptree&);
 
-        static boost::property_tree::ptree make_reader_config();
         static boost::property_tree::ptree make_meili_config(const std::string& costing);
 
         boost::property_tree::ptree config_;
 
-        baldr::GraphReader graphreader_;
+        baldr::GraphReader& graphreader_;
 
         valhalla::sif::cost_ptr_t mode_costing_[kModeCostingCount];
 
@@ -137,9 +143,9 @@ namespace valhalla { namespace meili {
                                                 const std::string& costing);
     };
 
-    map_matcher_factory_t::map_matcher_factory_t(const std::vector<std::shared_ptr<sqlite3pp::database>>& databases, const std::string& costing)
+    map_matcher_factory_t::map_matcher_factory_t(baldr::GraphReader& graphreader, const std::string& costing)
         : config_(make_meili_config(costing)),
-          graphreader_(std::make_shared<baldr::GraphTileMBTStorage>(databases), make_reader_config()),
+          graphreader_(graphreader),
           candidatequery_(graphreader_,
                           local_tile_size(graphreader_)/500,
                           local_tile_size(graphreader_)/500),
@@ -155,13 +161,6 @@ namespace valhalla { namespace meili {
     map_matcher_factory_t::~map_matcher_factory_t() {
     }
 
-    boost::property_tree::ptree map_matcher_factory_t::make_reader_config() {
-        boost::property_tree::ptree config;
-        config.put("max_cache_size", 16 * 1024 * 1024);
-        config.put("tile_dir", "");
-        return config;
-    }
-
     boost::property_tree::ptree map_matcher_factory_t::make_meili_config(const std::string& costing) {
         boost::property_tree::ptree defaultProfile;
         defaultProfile.put("sigma_z", 4.07f);
@@ -283,19 +282,22 @@ namespace valhalla { namespace thor {
 
     class thor_worker_t {
     public:
-        thor_worker_t(const std::vector<std::shared_ptr<sqlite3pp::database>>& databases, const std::string& costing);
+        thor_worker_t(baldr::GraphReader& reader, sif::CostFactory<sif::DynamicCost>& factory, const std::string& costing);
         virtual ~thor_worker_t();
 
         std::list<valhalla::odin::TripPath> path_depart_at(const std::vector<valhalla::midgard::PointLL>& points, const boost::optional<int>& date_time_type);
 
+        std::vector<TimeDistance> source_to_target(const std::vector<valhalla::midgard::PointLL>& source_points, const std::vector<valhalla::midgard::PointLL>& target_points);
+
+        static void register_costings(sif::CostFactory<sif::DynamicCost>& factory);
+
     protected:
-        static boost::property_tree::ptree make_reader_config();
 
         void update_origin(baldr::PathLocation& origin, bool prior_is_node, const baldr::GraphId& through_edge);
         void get_path(PathAlgorithm* path_algorithm, baldr::PathLocation& origin, baldr::PathLocation& destination, std::vector<thor::PathInfo>& path_edges);
         thor::PathAlgorithm* get_path_algorithm(const std::string& routetype, const baldr::PathLocation& origin, const baldr::PathLocation& destination);
 
-        valhalla::baldr::GraphReader reader;
+        valhalla::baldr::GraphReader& reader;
         std::string costing;
         valhalla::sif::TravelMode mode;
         boost::optional<std::string> jsonp;
@@ -305,7 +307,7 @@ namespace valhalla { namespace thor {
         std::vector<baldr::PathLocation> correlated;
         std::vector<baldr::PathLocation> correlated_s;
         std::vector<baldr::PathLocation> correlated_t;
-        sif::CostFactory<sif::DynamicCost> factory;
+        sif::CostFactory<sif::DynamicCost>& factory;
         sif::CostFactory<sif::DynamicCost>::cost_ptr_t cost;
         valhalla::sif::cost_ptr_t mode_costing[16];
 
@@ -318,16 +320,7 @@ namespace valhalla { namespace thor {
         boost::optional<int> date_time_type;
     };
 
-    thor_worker_t::thor_worker_t(const std::vector<std::shared_ptr<sqlite3pp::database> >& databases, const std::string& costing) : reader(std::make_shared<baldr::GraphTileMBTStorage>(databases), make_reader_config()), costing(costing) {
-        factory.Register("auto", sif::CreateAutoCost);
-        factory.Register("auto_shorter", sif::CreateAutoShorterCost);
-        factory.Register("bus", sif::CreateBusCost);
-        factory.Register("bicycle", sif::CreateBicycleCost);
-        factory.Register("pedestrian", sif::CreatePedestrianCost);
-        factory.Register("wheelchair", sif::CreateWheelchairCost);
-        factory.Register("truck", sif::CreateTruckCost);
-        factory.Register("transit", sif::CreateTransitCost);
-
+    thor_worker_t::thor_worker_t(baldr::GraphReader& reader, sif::CostFactory<sif::DynamicCost>& factory, const std::string& costing) : reader(reader), costing(costing), factory(factory) {
         boost::property_tree::ptree config_costing;
         if (costing == "multimodal" || costing == "transit") {
             mode_costing[0] = factory.Create("auto", config_costing);
@@ -346,11 +339,15 @@ namespace valhalla { namespace thor {
     thor_worker_t::~thor_worker_t() {
     }
 
-    boost::property_tree::ptree thor_worker_t::make_reader_config() {
-        boost::property_tree::ptree config;
-        config.put("max_cache_size", 16 * 1024 * 1024);
-        config.put("tile_dir", "");
-        return config;
+    void thor_worker_t::register_costings(sif::CostFactory<sif::DynamicCost>& factory) {
+        factory.Register("auto", sif::CreateAutoCost);
+        factory.Register("auto_shorter", sif::CreateAutoShorterCost);
+        factory.Register("bus", sif::CreateBusCost);
+        factory.Register("bicycle", sif::CreateBicycleCost);
+        factory.Register("pedestrian", sif::CreatePedestrianCost);
+        factory.Register("wheelchair", sif::CreateWheelchairCost);
+        factory.Register("truck", sif::CreateTruckCost);
+        factory.Register("transit", sif::CreateTransitCost);
     }
 
     thor::PathAlgorithm* thor_worker_t::get_path_algorithm(const std::string& routetype,
@@ -447,6 +444,39 @@ namespace valhalla { namespace thor {
         }
     }
 
+    std::vector<TimeDistance> thor_worker_t::source_to_target(const std::vector<valhalla::midgard::PointLL>& source_points, const std::vector<valhalla::midgard::PointLL>& target_points) {
+        if (costing == "multimodal" || costing == "transit") {
+            throw std::runtime_error("Matrix calculation not supported for multimodal costing");
+        }
+
+        // Correlate all locations with a single search
+        std::vector<baldr::Location> locations;
+        locations.reserve(source_points.size() + target_points.size());
+        locations.insert(locations.end(), source_points.begin(), source_points.end());
+        locations.insert(locations.end(), target_points.begin(), target_points.end());
+        auto projections = valhalla::loki::Search(locations, reader, cost->GetEdgeFilter(), cost->GetNodeFilter());
+
+        std::vector<baldr::PathLocation> correlated_sources;
+        std::vector<baldr::PathLocation> correlated_targets;
+        correlated_sources.reserve(source_points.size());
+        correlated_targets.reserve(target_points.size());
+        for (std::size_t i = 0; i < locations.size(); i++) {
+            auto it = projections.find(locations[i]);
+            if (it == projections.end()) {
+                throw std::runtime_error("Failed to locate matrix point in routing graph");
+            }
+            (i < source_points.size() ? correlated_sources : correlated_targets).push_back(it->second);
+        }
+
+        // Use bidirectional cost matrix for auto, as recommended by Valhalla. Other modes use one-to-many expansions
+        if (costing == "auto") {
+            CostMatrix matrix;
+            return matrix.SourceToTarget(correlated_sources, correlated_targets, reader, mode_costing, mode, 400000.0f);
+        }
+        TimeDistanceMatrix matrix;
+        return matrix.SourceToTarget(correlated_sources, correlated_targets, reader, mode_costing, mode, 200000.0f);
+    }
+
     std::list<valhalla::odin::TripPath> thor_worker_t::path_depart_at(const std::vector<valhalla::midgard::PointLL>& points, const boost::optional<int>& date_time_type) {
         // Build correlated path locations
         std::vector<baldr::PathLocation> correlated;
@@ -859,12 +889,126 @@ namespace carto {
     }
 
 #ifdef _CARTO_VALHALLA_ROUTING_SUPPORT
+    struct ValhallaRoutingProxy::Graph {
+        std::vector<std::shared_ptr<sqlite3pp::database> > databases;
+        valhalla::baldr::GraphReader reader;
+        valhalla::sif::CostFactory<valhalla::sif::DynamicCost> costFactory;
+        std::unique_ptr<valhalla::meili::map_matcher_factory_t> matcherFactory;
+        std::mutex mutex;
+
+        Graph(const std::vector<std::shared_ptr<sqlite3pp::database> >& databases, std::size_t tileCacheCapacity) :
+            databases(databases),
+            reader(std::make_shared<valhalla::baldr::GraphTileMBTStorage>(databases), MakeReaderConfig(tileCacheCapacity)),
+            costFactory(),
+            matcherFactory(),
+            mutex()
+        {
+            for (const std::shared_ptr<sqlite3pp::database>& database : databases) {
+                ConfigureDatabase(*database);
+            }
+            valhalla::thor::thor_worker_t::register_costings(costFactory);
+        }
+
+    private:
+        static void ConfigureDatabase(sqlite3pp::database& database) {
+            // Graph tiles are read as large blobs from read-only databases, memory mapping avoids copying the pages through the page cache.
+            // The decompressed tiles are cached by the graph reader, so the page cache itself can be kept small
+            std::size_t mmapSize = DATABASE_MMAP_SIZE_32;
+            if (sizeof(void*) >= 8) {
+                mmapSize = DATABASE_MMAP_SIZE_64;
+            }
+            std::string mmapSizeCommand = "PRAGMA mmap_size=" + boost::lexical_cast<std::string>(mmapSize);
+            if (database.execute(mmapSizeCommand.c_str()) != SQLITE_OK) {
+                Log::Warn("ValhallaRoutingProxy::Graph: Failed to enable memory mapped IO for routing database");
+            }
+            std::string cacheSizeCommand = "PRAGMA cache_size=-" + boost::lexical_cast<std::string>(DATABASE_PAGE_CACHE_SIZE / 1024);
+            if (database.execute(cacheSizeCommand.c_str()) != SQLITE_OK) {
+                Log::Warn("ValhallaRoutingProxy::Graph: Failed to set page cache size for routing database");
+            }
+        }
+
+        static const std::size_t DATABASE_MMAP_SIZE_32 = 32 * 1024 * 1024;
+        static const std::size_t DATABASE_MMAP_SIZE_64 = 256 * 1024 * 1024;
+        static const std::size_t DATABASE_PAGE_CACHE_SIZE = 1024 * 1024;
+
+        static boost::property_tree::ptree MakeReaderConfig(std::size_t tileCacheCapacity) {
+            boost::property_tree::ptree config;
+            config.put("max_cache_size", tileCacheCapacity);
+            config.put("tile_dir", "");
+            return config;
+        }
+    };
+
+    std::shared_ptr<ValhallaRoutingProxy::Graph> ValhallaRoutingProxy::CreateGraph(const std::vector<std::shared_ptr<sqlite3pp::database> >& databases, std::size_t tileCacheCapacity) {
+        return std::make_shared<Graph>(databases, tileCacheCapacity);
+    }
+
     std::shared_ptr<RouteMatchingResult> ValhallaRoutingProxy::MatchRoute(const std::vector<std::shared_ptr<sqlite3pp::database> >& databases, const std::string& profile, const std::shared_ptr<RouteMatchingRequest>& request) {
+        return MatchRoute(CreateGraph(databases, DEFAULT_TILE_CACHE_CAPACITY), profile, request);
+    }
+
+    std::shared_ptr<RoutingResult> ValhallaRoutingProxy::CalculateRoute(const std::vector<std::shared_ptr<sqlite3pp::database> >& databases, const std::string& profile, const std::shared_ptr<RoutingRequest>& request) {
+        return CalculateRoute(CreateGraph(databases, DEFAULT_TILE_CACHE_CAPACITY), profile, request);
+    }
+
+    std::shared_ptr<RoutingMatrixResult> ValhallaRoutingProxy::CalculateMatrix(const std::shared_ptr<Graph>& graph, const std::string& profile, const std::shared_ptr<RoutingMatrixRequest>& request) {
+        if (!graph) {
+            throw NullArgumentException("Null graph");
+        }
+
+        std::shared_ptr<Projection> proj = request->getProjection();
+
+        std::vector<valhalla::thor::TimeDistance> timeDistances;
+        try {
+            std::vector<valhalla::midgard::PointLL> sources;
+            sources.reserve(request->getSources().size());
+            for (const MapPos& pos : request->getSources()) {
+                MapPos posWgs84 = proj->toWgs84(pos);
+                sources.emplace_back(static_cast<float>(posWgs84.getX()), static_cast<float>(posWgs84.getY()));
+            }
+            std::vector<valhalla::midgard::PointLL> targets;
+            targets.reserve(request->getTargets().size());
+            for (const MapPos& pos : request->getTargets()) {
+                MapPos posWgs84 = proj->toWgs84(pos);
+                targets.emplace_back(static_cast<float>(posWgs84.getX()), static_cast<float>(posWgs84.getY()));
+            }
+
+            if (!sources.empty() && !targets.empty()) {
+                std::lock_guard<std::mutex> lock(graph->mutex);
+                valhalla::thor::thor_worker_t worker(graph->reader, graph->costFactory, profile);
+                timeDistances = worker.source_to_target(sources, targets);
+            }
+        }
+        catch (const std::exception& ex) {
+            throw GenericException("Exception while calculating routing matrix", ex.what());
+        }
+
+        std::size_t count = request->getSources().size() * request->getTargets().size();
+        if (timeDistances.size() != count) {
+            throw GenericException("Unexpected routing matrix size");
+        }
+        std::vector<double> durations(count, -1.0);
+        std::vector<double> distances(count, -1.0);
+        for (std::size_t i = 0; i < count; i++) {
+            if (timeDistances[i].time < valhalla::thor::kMaxCost) {
+                durations[i] = timeDistances[i].time;
+                distances[i] = timeDistances[i].dist;
+            }
+        }
+        return std::make_shared<RoutingMatrixResult>(static_cast<int>(request->getSources().size()), static_cast<int>(request->getTargets().size()), durations, distances);
+    }
+
+    std::shared_ptr<RouteMatchingResult> ValhallaRoutingProxy::MatchRoute(const std::shared_ptr<Graph>& graph, const std::string& profile, const std::shared_ptr<RouteMatchingRequest>& request) {
+        if (!graph) {
+            throw NullArgumentException("Null graph");
+        }
+
         EPSG3857 epsg3857;
         std::shared_ptr<Projection> proj = request->getProjection();
 
         const float searchRadius = 50.0f;
         std::vector<valhalla::meili::Measurement> measurements;
+        measurements.reserve(request->getPoints().size());
         try {
             for (const MapPos& pos : request->getPoints()) {
                 MapPos posWgs84 = proj->toWgs84(pos);
@@ -872,15 +1016,22 @@ namespace carto {
                 measurements.emplace_back(lnglat, request->getAccuracy(), searchRadius);
             }
 
-            valhalla::meili::map_matcher_factory_t factory(databases, profile);
-            std::shared_ptr<valhalla::meili::MapMatcher> matcher(factory.Create(profile));
-            if (!matcher) {
-                throw std::runtime_error("Failed to create matcher instance");
-            }
+            std::vector<valhalla::meili::MatchResult> matchResults;
+            {
+                std::lock_guard<std::mutex> lock(graph->mutex);
+                if (!graph->matcherFactory) {
+                    graph->matcherFactory.reset(new valhalla::meili::map_matcher_factory_t(graph->reader, profile));
+                }
+                std::shared_ptr<valhalla::meili::MapMatcher> matcher(graph->matcherFactory->Create(profile));
+                if (!matcher) {
+                    throw std::runtime_error("Failed to create matcher instance");
+                }
 
-            std::vector<valhalla::meili::MatchResult> matchResults = matcher->OfflineMatch(measurements);
+                matchResults = matcher->OfflineMatch(measurements);
+            }
 
             std::vector<MapPos> poses;
+            poses.reserve(matchResults.size());
             for (const valhalla::meili::MatchResult& matchResult : matchResults) {
                 MapPos pos = proj->fromLatLong(matchResult.lnglat().lat(), matchResult.lnglat().lng());
                 poses.push_back(pos);
@@ -892,19 +1043,25 @@ namespace carto {
         }
     }
 
-    std::shared_ptr<RoutingResult> ValhallaRoutingProxy::CalculateRoute(const std::vector<std::shared_ptr<sqlite3pp::database> >& databases, const std::string& profile, const std::shared_ptr<RoutingRequest>& request) {
+    std::shared_ptr<RoutingResult> ValhallaRoutingProxy::CalculateRoute(const std::shared_ptr<Graph>& graph, const std::string& profile, const std::shared_ptr<RoutingRequest>& request) {
+        if (!graph) {
+            throw NullArgumentException("Null graph");
+        }
+
         EPSG3857 epsg3857;
         std::shared_ptr<Projection> proj = request->getProjection();
         
         std::list<valhalla::odin::TripPath> tripPaths;
         try {
             std::vector<valhalla::midgard::PointLL> points;
+            points.reserve(request->getPoints().size());
             for (const MapPos& pos : request->getPoints()) {
                 MapPos posWgs84 = proj->toWgs84(pos);
                 points.emplace_back(static_cast<float>(posWgs84.getX()), static_cast<float>(posWgs84.getY()));
             }
             
-            valhalla::thor::thor_worker_t worker(databases, profile);
+            std::lock_guard<std::mutex> lock(graph->mutex);
+            valhalla::thor::thor_worker_t worker(graph->reader, graph->costFactory, profile);
             tripPaths = worker.path_depart_at(points, profile == "multimodal" ? boost::optional<int>(0) : boost::optional<int>());
         }
         catch (const std::exception& ex) {
@@ -22,15 +22,30 @@ namespace sqlite3pp {
 namespace carto {
     class RouteMatchingRequest;
     class RouteMatchingResult;
+    class RoutingMatrixRequest;
+    class RoutingMatrixResult;
     
     class ValhallaRoutingProxy {
     public:
+#ifdef _CARTO_VALHALLA_ROUTING_SUPPORT
+        // Routing graph reader, tile cache and cost factories that can be reused between requests. Requests using the same graph are serialized.
+        struct Graph;
+
+        static std::shared_ptr<Graph> CreateGraph(const std::vector<std::shared_ptr<sqlite3pp::database> >& databases, std::size_t tileCacheCapacity);
+#endif
+
         static std::shared_ptr<RouteMatchingResult> MatchRoute(const std::string& baseURL, const std::string& profile, const std::shared_ptr<RouteMatchingRequest>& request);
         static std::shared_ptr<RoutingResult> CalculateRoute(const std::string& baseURL, const std::string& profile, const std::shared_ptr<RoutingRequest>& request);
 
 #ifdef _CARTO_VALHALLA_ROUTING_SUPPORT
         static std::shared_ptr<RouteMatchingResult> MatchRoute(const std::vector<std::shared_ptr<sqlite3pp::database> >& databases, const std::string& profile, const std::shared_ptr<RouteMatchingRequest>& request);
         static std::shared_ptr<RoutingResult> CalculateRoute(const std::vector<std::shared_ptr<sqlite3pp::database> >& databases, const std::string& profile, const std::shared_ptr<RoutingRequest>& request);
+
+        static std::shared_ptr<RouteMatchingResult> MatchRoute(const std::shared_ptr<Graph>& graph, const std::string& profile, const std::shared_ptr<RouteMatchingRequest>& request);
+        static std::shared_ptr<RoutingResult> CalculateRoute(const std::shared_ptr<Graph>& graph, const std::string& profile, const std::shared_ptr<RoutingRequest>& request);
+        static std::shared_ptr<RoutingMatrixResult> CalculateMatrix(const std::shared_ptr<Graph>& graph, const std::string& profile, const std::shared_ptr<RoutingMatrixRequest>& request);
+
+        static const std::size_t DEFAULT_TILE_CACHE_CAPACITY = 16 * 1024 * 1024;
 #endif
         
     private:
@@ -5,16 +5,22 @@
 #include "geometry/Geometry.h"
 #include "geometry/Feature.h"
 #include "geometry/FeatureCollection.h"
+#include "geometry/utils/RTreeSpatialIndex.h"
 #include "search/SearchProxy.h"
 #include "projections/Projection.h"
 #include "projections/EPSG3857.h"
 #include "utils/Log.h"
 
+#include <algorithm>
+
 namespace carto {
 
     FeatureCollectionSearchService::FeatureCollectionSearchService(const std::shared_ptr<Projection>& projection, const std::shared_ptr<FeatureCollection>& featureCollection) :
         _projection(projection),
-        _featureCollection(featureCollection)
+        _featureCollection(featureCollection),
+        _spatialIndexEnabled(false),
+        _spatialIndex(),
+        _mutex()
     {
         if (!projection) {
             throw NullArgumentException("Null projection");
@@ -35,6 +41,19 @@ namespace carto {
         return _featureCollection;
     }
 
+    bool FeatureCollectionSearchService::isSpatialIndexEnabled() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _spatialIndexEnabled;
+    }
+
+    void FeatureCollectionSearchService::setSpatialIndexEnabled(bool enabled) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _spatialIndexEnabled = enabled;
+        if (!enabled) {
+            _spatialIndex.reset();
+        }
+    }
+
     std::shared_ptr<FeatureCollection> FeatureCollectionSearchService::findFeatures(const std::shared_ptr<SearchRequest>& request) const {
         if (!request) {
             throw NullArgumentException("Null request");
@@ -43,16 +62,65 @@ namespace carto {
         SearchProxy proxy(request, _projection->getBounds(), _projection);
 
         std::vector<std::shared_ptr<Feature> > features;
-        for (int i = 0; i < _featureCollection->getFeatureCount(); i++) {
-            const std::shared_ptr<Feature>& feature = _featureCollection->getFeature(i);
+        std::shared_ptr<RTreeSpatialIndex<int> > spatialIndex;
+        if (request->getGeometry()) {
+            spatialIndex = getSpatialIndex();
+        }
+        if (spatialIndex) {
+            // Test only the features with bounds overlapping the search bounds, keep the original feature order
+            const MapBounds& searchBounds = proxy.getSearchBounds();
+            std::vector<int> featureIndices = spatialIndex->query(cglib::bbox3<double>(cglib::vec3<double>(searchBounds.getMin().getX(), searchBounds.getMin().getY(), 0), cglib::vec3<double>(searchBounds.getMax().getX(), searchBounds.getMax().getY(), 0)));
+            std::sort(featureIndices.begin(), featureIndices.end());
+            for (int index : featureIndices) {
+                const std::shared_ptr<Feature>& feature = _featureCollection->getFeature(index);
+
+                if (proxy.testElement(feature->getGeometry(), nullptr, feature->getProperties())) {
+                    features.push_back(feature);
+                }
+            }
+        } else {
+            for (int i = 0; i < _featureCollection->getFeatureCount(); i++) {
+                const std::shared_ptr<Feature>& feature = _featureCollection->getFeature(i);
 
-            if (proxy.testElement(feature->getGeometry(), nullptr, feature->getProperties())) {
-                features.push_back(feature);
+                if (proxy.testElement(feature->getGeometry(), nullptr, feature->getProperties())) {
+                    features.push_back(feature);
+                }
             }
         }
         return std::make_shared<FeatureCollection>(features);
     }
 
+    std::shared_ptr<RTreeSpatialIndex<int> > FeatureCollectionSearchService::getSpatialIndex() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_spatialIndexEnabled) {
+            return std::shared_ptr<RTreeSpatialIndex<int> >();
+        }
+
+        if (!_spatialIndex) {
+            // The search bounds are in EPSG3857 coordinates, so the feature bounds are converted to the same coordinate system
+            std::vector<cglib::bbox3<double> > featureBounds;
+            std::vector<int> featureIndices;
+            featureBounds.reserve(_featureCollection->getFeatureCount());
+            featureIndices.reserve(_featureCollection->getFeatureCount());
+            for (int i = 0; i < _featureCollection->getFeatureCount(); i++) {
+                const std::shared_ptr<Feature>& feature = _featureCollection->getFeature(i);
+                if (!feature->getGeometry()) {
+                    continue;
+                }
+
+                MapBounds bounds = SearchProxy::CalculateEPSG3857Bounds(feature->getGeometry()->getBounds(), _projection);
+                featureBounds.emplace_back(cglib::vec3<double>(bounds.getMin().getX(), bounds.getMin().getY(), 0), cglib::vec3<double>(bounds.getMax().getX(), bounds.getMax().getY(), 0));
+                featureIndices.push_back(i);
+            }
+
+            auto spatialIndex = std::make_shared<RTreeSpatialIndex<int> >();
+            spatialIndex->reserve(featureIndices.size());
+            spatialIndex->insertAll(featureBounds, featureIndices);
+            _spatialIndex = spatialIndex;
+        }
+        return _spatialIndex;
+    }
+
 }
 
 #endif
@@ -12,11 +12,13 @@
 #include "search/SearchRequest.h"
 
 #include <memory>
+#include <mutex>
 #include <vector>
 
 namespace carto {
     class FeatureCollection;
     class Projection;
+    template <typename T> class RTreeSpatialIndex;
 
     /**
      * A search service for finding features from a specified feature collection.
@@ -43,6 +45,20 @@ namespace carto {
          */
         const std::shared_ptr<FeatureCollection>& getFeatureCollection() const;
 
+        /**
+         * Returns the state of the spatial index flag.
+         * @return True if the spatial index is used for geometry-restricted searches. The default is false.
+         */
+        bool isSpatialIndexEnabled() const;
+        /**
+         * Sets the state of the spatial index flag.
+         * If enabled, an R-tree over feature bounds is built on the first geometry-restricted search
+         * and only the features with overlapping bounds are tested. This is useful for repeated
+         * searches on large collections.
+         * @param enabled True if the spatial index should be used.
+         */
+        void setSpatialIndexEnabled(bool enabled);
+
         /**
          * Searches for the features specified by search request from the feature collection bound to the service.
          * @param request The search request containing search filters.
@@ -51,8 +67,16 @@ namespace carto {
         virtual std::shared_ptr<FeatureCollection> findFeatures(const std::shared_ptr<SearchRequest>& request) const;
 
     protected:
+        std::shared_ptr<RTreeSpatialIndex<int> > getSpatialIndex() const;
+
         const std::shared_ptr<Projection> _projection;
         const std::shared_ptr<FeatureCollection> _featureCollection;
+
+    private:
+        bool _spatialIndexEnabled;
+        mutable std::shared_ptr<RTreeSpatialIndex<int> > _spatialIndex;
+
+        mutable std::mutex _mutex;
     };
     
 }
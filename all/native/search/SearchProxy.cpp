@@ -244,6 +244,35 @@ namespace {
         const carto::Variant& _variant;
     };
 
+    class AttributeQueryContext : public carto::QueryContext {
+    public:
+        explicit AttributeQueryContext(const std::string& layerName, const carto::QueryContext& attributeContext) : _layerName(layerName), _attributeContext(attributeContext), _geometryUsed(false) { }
+        virtual ~AttributeQueryContext() { }
+
+        bool isGeometryUsed() const {
+            return _geometryUsed;
+        }
+
+        virtual bool getVariable(const std::string& name, carto::Variant& value) const {
+            if (name == "layer::name") {
+                value = carto::Variant(_layerName);
+                return true;
+            }
+
+            if (name == "geometry::type" || name == "geometry::vertices") {
+                _geometryUsed = true;
+                return false;
+            }
+
+            return _attributeContext.getVariable(name, value);
+        }
+
+    private:
+        const std::string& _layerName;
+        const carto::QueryContext& _attributeContext;
+        mutable bool _geometryUsed;
+    };
+
 }
 
 namespace carto {
@@ -321,6 +350,18 @@ namespace carto {
         return true;
     }
 
+    bool SearchProxy::testAttributes(const std::string& layerName, const QueryContext& attributeContext) const {
+        if (_expr) {
+            // If the expression depends on the geometry, the result is not conclusive and the feature must be tested with testElement
+            AttributeQueryContext context(layerName, attributeContext);
+            if (!_expr->evaluate(context) && !context.isGeometryUsed()) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
     bool SearchProxy::testElement(const std::shared_ptr<Geometry>& geometry, const std::string* layerName, const Variant& var) const {
         if (_re) {
             if (!matchRegexFilter(var, *_re)) {
@@ -344,6 +385,10 @@ namespace carto {
         return true;
     }
 
+    MapBounds SearchProxy::CalculateEPSG3857Bounds(const MapBounds& bounds, const std::shared_ptr<Projection>& proj) {
+        return convertToEPSG3857(bounds, proj);
+    }
+
 }
 
 #endif
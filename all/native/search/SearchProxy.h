@@ -21,6 +21,7 @@
 namespace carto {
     class Geometry;
     class Projection;
+    class QueryContext;
     class QueryExpression;
     class Variant;
 
@@ -32,8 +33,12 @@ namespace carto {
 
         bool testBounds(const MapBounds& bounds) const;
 
+        bool testAttributes(const std::string& layerName, const QueryContext& attributeContext) const;
+
         bool testElement(const std::shared_ptr<Geometry>& geometry, const std::string* layerName, const Variant& var) const;
 
+        static MapBounds CalculateEPSG3857Bounds(const MapBounds& bounds, const std::shared_ptr<Projection>& proj);
+
     protected:
         std::shared_ptr<SearchRequest> _request;
         std::shared_ptr<Geometry> _geometry;
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_VECTORTILESEARCHLISTENER_H_
+#define _CARTO_VECTORTILESEARCHLISTENER_H_
+
+#ifdef _CARTO_SEARCH_SUPPORT
+
+#include <memory>
+
+namespace carto {
+    class VectorTileFeature;
+
+    /**
+     * Listener for features found by vector tile search service.
+     */
+    class VectorTileSearchListener {
+    public:
+        virtual ~VectorTileSearchListener() { }
+
+        /**
+         * Listener method that gets called for each feature matching the search request, as soon as the feature is found.
+         * This method is called from search worker threads, but never concurrently.
+         * @param feature The matching feature.
+         * @return True if the search should continue, false if the search should be canceled.
+         */
+        virtual bool onFeatureFound(const std::shared_ptr<VectorTileFeature>& feature) = 0;
+    };
+    
+}
+
+#endif
+
+#endif
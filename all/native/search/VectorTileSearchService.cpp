@@ -7,11 +7,20 @@
 #include "geometry/VectorTileFeature.h"
 #include "geometry/VectorTileFeatureCollection.h"
 #include "search/SearchProxy.h"
+#include "search/VectorTileSearchListener.h"
+#include "search/query/QueryContext.h"
 #include "vectortiles/VectorTileDecoder.h"
 #include "projections/Projection.h"
 #include "utils/TileUtils.h"
 #include "utils/Log.h"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <thread>
+#include <unordered_set>
+
 #include <vt/TileId.h>
 
 namespace carto {
@@ -21,6 +30,8 @@ namespace carto {
         _tileDecoder(tileDecoder),
         _minZoom(),
         _maxZoom(),
+        _maxResults(std::numeric_limits<int>::max()),
+        _mostDetailedZoomOnly(false),
         _mutex()
     {
         if (!dataSource) {
@@ -65,7 +76,31 @@ namespace carto {
         _maxZoom = maxZoom;
     }
 
+    int VectorTileSearchService::getMaxResults() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _maxResults;
+    }
+
+    void VectorTileSearchService::setMaxResults(int maxResults) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _maxResults = maxResults;
+    }
+
+    bool VectorTileSearchService::isMostDetailedZoomOnly() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _mostDetailedZoomOnly;
+    }
+
+    void VectorTileSearchService::setMostDetailedZoomOnly(bool mostDetailedZoomOnly) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _mostDetailedZoomOnly = mostDetailedZoomOnly;
+    }
+
     std::shared_ptr<VectorTileFeatureCollection> VectorTileSearchService::findFeatures(const std::shared_ptr<SearchRequest>& request) const {
+        return findFeatures(request, std::shared_ptr<VectorTileSearchListener>());
+    }
+
+    std::shared_ptr<VectorTileFeatureCollection> VectorTileSearchService::findFeatures(const std::shared_ptr<SearchRequest>& request, const std::shared_ptr<VectorTileSearchListener>& listener) const {
         if (!request) {
             throw NullArgumentException("Null request");
         }
@@ -74,14 +109,19 @@ namespace carto {
         MapBounds searchBounds = proxy.getSearchBounds();
         int minZoom = _dataSource->getMinZoom();
         int maxZoom = _dataSource->getMaxZoom();
+        std::size_t maxResults = 0;
+        bool mostDetailedZoomOnly = false;
         {
             std::lock_guard<std::mutex> lock(_mutex);
             minZoom = std::max(minZoom, _minZoom);
             maxZoom = std::min(maxZoom, _maxZoom);
+            maxResults = static_cast<std::size_t>(std::max(0, _maxResults));
+            mostDetailedZoomOnly = _mostDetailedZoomOnly;
         }
 
+        // Find the tiles to scan. If only the most detailed zoom is used, start from the max zoom and fall back to parent tiles later
         std::vector<MapTile> mapTiles;
-        for (int zoom = minZoom; zoom <= maxZoom; zoom++) {
+        for (int zoom = (mostDetailedZoomOnly ? maxZoom : minZoom); zoom <= maxZoom; zoom++) {
             MapTile mapTile1 = TileUtils::CalculateMapTile(searchBounds.getMin(), zoom, _dataSource->getProjection());
             MapTile mapTile2 = TileUtils::CalculateMapTile(searchBounds.getMax(), zoom, _dataSource->getProjection());
             for (int y = std::min(mapTile1.getY(), mapTile2.getY()); y <= std::max(mapTile1.getY(), mapTile2.getY()); y++) {
@@ -95,18 +135,102 @@ namespace carto {
         }
 
         std::vector<std::shared_ptr<VectorTileFeature> > features;
-        for (const MapTile& mapTile : mapTiles) {
-            if (std::shared_ptr<TileData> tileData = _dataSource->loadTile(mapTile.getFlipped())) {
-                MapBounds tileBounds = TileUtils::CalculateMapTileBounds(mapTile, _dataSource->getProjection());
-                if (std::shared_ptr<VectorTileFeatureCollection> featureCollection = _tileDecoder->decodeFeatures(vt::TileId(mapTile.getZoom(), mapTile.getX(), mapTile.getY()), tileData->getData(), tileBounds)) {
-                    for (int i = 0; i < featureCollection->getFeatureCount(); i++) {
-                        const std::shared_ptr<VectorTileFeature>& feature = featureCollection->getFeature(i);
-                        if (proxy.testElement(feature->getGeometry(), &feature->getLayerName(), feature->getProperties())) {
-                            features.push_back(feature);
+        std::unordered_set<long long> featureIds;
+        std::atomic<bool> finished(maxResults == 0);
+        std::size_t resultCount = 0;
+        std::exception_ptr workerException;
+        std::mutex resultMutex;
+
+        while (!mapTiles.empty() && !finished) {
+            // Scan the tiles in parallel. Each worker takes the next unprocessed tile, results are collected in the original tile order
+            std::vector<std::vector<std::shared_ptr<VectorTileFeature> > > tileFeatures(mapTiles.size());
+            std::vector<char> tilesMissing(mapTiles.size(), 0);
+            std::atomic<std::size_t> nextTileIndex(0);
+
+            auto scanTiles = [&, this]() {
+                try {
+                    for (std::size_t index = nextTileIndex++; index < mapTiles.size() && !finished; index = nextTileIndex++) {
+                        const MapTile& mapTile = mapTiles[index];
+                        std::shared_ptr<TileData> tileData = _dataSource->loadTileCoalesced(mapTile.getFlipped());
+                        if (!tileData || (mostDetailedZoomOnly && tileData->isReplaceWithParent())) {
+                            tilesMissing[index] = 1;
+                            continue;
+                        }
+                        if (finished) {
+                            break;
+                        }
+                        MapBounds tileBounds = TileUtils::CalculateMapTileBounds(mapTile, _dataSource->getProjection());
+                        // Filter the features by attributes before the geometry is decoded, the remaining tests are done on the decoded features
+                        auto filter = [&proxy](const std::string& layerName, const QueryContext& attributeContext) {
+                            return proxy.testAttributes(layerName, attributeContext);
+                        };
+                        std::shared_ptr<VectorTileFeatureCollection> featureCollection = _tileDecoder->decodeFeatures(vt::TileId(mapTile.getZoom(), mapTile.getX(), mapTile.getY()), tileData->getData(), tileBounds, filter);
+                        if (!featureCollection) {
+                            continue;
+                        }
+                        for (int i = 0; i < featureCollection->getFeatureCount() && !finished; i++) {
+                            const std::shared_ptr<VectorTileFeature>& feature = featureCollection->getFeature(i);
+                            if (!proxy.testElement(feature->getGeometry(), &feature->getLayerName(), feature->getProperties())) {
+                                continue;
+                            }
+
+                            std::lock_guard<std::mutex> lock(resultMutex);
+                            if (finished) {
+                                break;
+                            }
+                            // Features crossing tile borders or found from both parent and child tiles are reported only once
+                            if (mostDetailedZoomOnly && feature->getId() != 0 && !featureIds.insert(feature->getId()).second) {
+                                continue;
+                            }
+                            tileFeatures[index].push_back(feature);
+                            if (++resultCount >= maxResults) {
+                                finished = true;
+                            }
+                            if (listener && !listener->onFeatureFound(feature)) {
+                                finished = true;
+                            }
+                        }
+                    }
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(resultMutex);
+                    if (!workerException) {
+                        workerException = std::current_exception();
+                    }
+                    finished = true;
+                }
+            };
+
+            std::size_t workerCount = std::min(mapTiles.size(), static_cast<std::size_t>(std::max(1, std::min(static_cast<int>(std::thread::hardware_concurrency()), MAX_WORKER_THREADS))));
+            std::vector<std::thread> workers;
+            for (std::size_t i = 1; i < workerCount; i++) {
+                workers.emplace_back(scanTiles);
+            }
+            scanTiles();
+            for (std::thread& worker : workers) {
+                worker.join();
+            }
+            if (workerException) {
+                std::rethrow_exception(workerException);
+            }
+
+            for (const std::vector<std::shared_ptr<VectorTileFeature> >& features1 : tileFeatures) {
+                features.insert(features.end(), features1.begin(), features1.end());
+            }
+
+            // Continue with parent tiles of the missing tiles, if needed
+            std::vector<MapTile> parentTiles;
+            if (mostDetailedZoomOnly) {
+                for (std::size_t i = 0; i < mapTiles.size(); i++) {
+                    if (tilesMissing[i] && mapTiles[i].getZoom() > minZoom) {
+                        MapTile parentTile = mapTiles[i].getParent();
+                        if (std::find(parentTiles.begin(), parentTiles.end(), parentTile) == parentTiles.end()) {
+                            parentTiles.push_back(parentTile);
                         }
                     }
                 }
             }
+            std::swap(mapTiles, parentTiles);
         }
         return std::make_shared<VectorTileFeatureCollection>(features);
     }
@@ -20,6 +20,7 @@ namespace carto {
     class TileDataSource;
     class VectorTileDecoder;
     class VectorTileFeatureCollection;
+    class VectorTileSearchListener;
 
     /**
      * A search service for finding features from the specified vector tile data source.
@@ -70,6 +71,33 @@ namespace carto {
          */
         void setMaxZoom(int maxZoom);
 
+        /**
+         * Returns the maximum number of features returned by a single search.
+         * @return The maximum number of features returned by a single search.
+         */
+        int getMaxResults() const;
+        /**
+         * Sets the maximum number of features returned by a single search. The search is stopped once the limit is reached.
+         * Note that if the limit is reached, the set of returned features may vary between searches.
+         * By default the number of results is not limited.
+         * @param maxResults The new maximum number of features.
+         */
+        void setMaxResults(int maxResults);
+
+        /**
+         * Returns the state of the most detailed zoom only flag.
+         * @return True if only the most detailed available zoom level is searched at each location.
+         */
+        bool isMostDetailedZoomOnly() const;
+        /**
+         * Sets the state of the most detailed zoom only flag. If set, the search starts from the maximum zoom level
+         * and uses parent tiles only for the areas where more detailed tiles are not available. Features are deduplicated by their ids.
+         * Otherwise all zoom levels between minimum and maximum zoom are searched.
+         * By default this flag is false.
+         * @param mostDetailedZoomOnly The new state of the flag.
+         */
+        void setMostDetailedZoomOnly(bool mostDetailedZoomOnly);
+
         /**
          * Searches for the features specified by search request from the vector tiles bound to the service.
          * The zoom level range used for searching is specified using minZoom/maxZoom attributes of the search service.
@@ -77,13 +105,25 @@ namespace carto {
          * @return The resulting feature collection containing features matching the request.
          */
         virtual std::shared_ptr<VectorTileFeatureCollection> findFeatures(const std::shared_ptr<SearchRequest>& request) const;
+        /**
+         * Searches for the features specified by search request from the vector tiles bound to the service.
+         * Found features are reported to the listener as soon as they are found, the listener can also cancel the search.
+         * @param request The search request containing search filters.
+         * @param listener The listener to call for each found feature. Can be null.
+         * @return The resulting feature collection containing features found before the search was finished or canceled.
+         */
+        virtual std::shared_ptr<VectorTileFeatureCollection> findFeatures(const std::shared_ptr<SearchRequest>& request, const std::shared_ptr<VectorTileSearchListener>& listener) const;
 
     protected:
+        static const int MAX_WORKER_THREADS = 4;
+
         const std::shared_ptr<TileDataSource> _dataSource;
         const std::shared_ptr<VectorTileDecoder> _tileDecoder;
 
         int _minZoom;
         int _maxZoom;
+        int _maxResults;
+        bool _mostDetailedZoomOnly;
 
         mutable std::mutex _mutex;
     };
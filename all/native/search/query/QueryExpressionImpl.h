@@ -9,6 +9,8 @@
 
 #include "search/query/QueryContext.h"
 #include "search/query/QueryExpression.h"
+#include "search/query/QueryProgram.h"
+#include "components/Exceptions.h"
 
 #include <limits>
 #include <regex>
@@ -26,6 +28,11 @@ namespace carto {
 
         using Context = QueryContext;
 
+        inline std::string CollateNoCase(const std::string& str) {
+            unistring::unistring unistr = unistring::to_unistring(str);
+            return unistring::to_utf8string(unistring::to_upper(unistr));
+        }
+
         struct IsNullPredicate {
             bool operator() (const Value& val) const { return val.getType() == VariantType::VARIANT_TYPE_NULL; }
         };
@@ -36,18 +43,29 @@ namespace carto {
 
         struct RegexpLikePredicate {
             bool operator() (const Value& val1, const Value& val2) const {
-                switch (val1.getType()) {
+                std::shared_ptr<std::wregex> re = CreateRegex(val2);
+                if (!re) {
+                    return false;
+                }
+                return Match(val1, *re);
+            }
+
+            static std::shared_ptr<std::wregex> CreateRegex(const Value& val) {
+                switch (val.getType()) {
                 case VariantType::VARIANT_TYPE_NULL:
                 case VariantType::VARIANT_TYPE_ARRAY:
                 case VariantType::VARIANT_TYPE_OBJECT:
-                    return false;
+                    return std::shared_ptr<std::wregex>();
                 default:
                     break;
                 }
-                std::string str = val1.getString();
-                unistring::unistring unistr = unistring::to_unistring(str);
+                std::string re = val.getString();
+                unistring::unistring unire = unistring::to_unistring(re);
+                return std::make_shared<std::wregex>(unistring::to_wstring(unire));
+            }
 
-                switch (val2.getType()) {
+            static bool Match(const Value& val, const std::wregex& re) {
+                switch (val.getType()) {
                 case VariantType::VARIANT_TYPE_NULL:
                 case VariantType::VARIANT_TYPE_ARRAY:
                 case VariantType::VARIANT_TYPE_OBJECT:
@@ -55,10 +73,9 @@ namespace carto {
                 default:
                     break;
                 }
-                std::string re = val2.getString();
-                unistring::unistring unire = unistring::to_unistring(re);
-
-                return std::regex_match(unistring::to_wstring(unistr), std::wregex(unistring::to_wstring(unire)));
+                std::string str = val.getString();
+                unistring::unistring unistr = unistring::to_unistring(str);
+                return std::regex_match(unistring::to_wstring(unistr), re);
             }
         };
 
@@ -67,7 +84,7 @@ namespace carto {
                 if (val1.getType() == VariantType::VARIANT_TYPE_NULL || val2.getType() == VariantType::VARIANT_TYPE_NULL) {
                     return false;
                 }
-                return val1.toPicoJSON() == val2.toPicoJSON();
+                return val1 == val2;
             }
         };
 
@@ -76,7 +93,7 @@ namespace carto {
                 if (val1.getType() == VariantType::VARIANT_TYPE_NULL || val2.getType() == VariantType::VARIANT_TYPE_NULL) {
                     return false;
                 }
-                return val1.toPicoJSON() != val2.toPicoJSON();
+                return val1 != val2;
             }
         };
 
@@ -101,21 +118,23 @@ namespace carto {
                     break;
                 }
 
-                const picojson::value& v1 = val1.toPicoJSON();
-                const picojson::value& v2 = val2.toPicoJSON();
-                if (v1.is<bool>() && v2.is<bool>()) {
-                    return Op<bool>()(v1.get<bool>(), v2.get<bool>());
+                VariantType::VariantType type1 = val1.getType();
+                VariantType::VariantType type2 = val2.getType();
+                if (type1 == VariantType::VARIANT_TYPE_BOOL && type2 == VariantType::VARIANT_TYPE_BOOL) {
+                    return Op<bool>()(val1.getBool(), val2.getBool());
                 }
-                if (v1.is<double>() && v2.is<double>()) { // NOTE: works for integers also
-                    if (v1.is<std::int64_t>() && v2.is<std::int64_t>()) {
-                        return Op<std::int64_t>()(v1.get<std::int64_t>(), v2.get<std::int64_t>());
+                bool numeric1 = type1 == VariantType::VARIANT_TYPE_INTEGER || type1 == VariantType::VARIANT_TYPE_DOUBLE;
+                bool numeric2 = type2 == VariantType::VARIANT_TYPE_INTEGER || type2 == VariantType::VARIANT_TYPE_DOUBLE;
+                if (numeric1 && numeric2) {
+                    if (type1 == VariantType::VARIANT_TYPE_INTEGER && type2 == VariantType::VARIANT_TYPE_INTEGER) {
+                        return Op<long long>()(val1.getLong(), val2.getLong());
                     }
-                    return Op<double>()(v1.get<double>(), v2.get<double>());
+                    return Op<double>()(val1.getDouble(), val2.getDouble());
                 }
-                if (v1.is<std::string>() && v2.is<std::string>()) {
-                    std::string str1 = v1.get<std::string>();
+                if (type1 == VariantType::VARIANT_TYPE_STRING && type2 == VariantType::VARIANT_TYPE_STRING) {
+                    std::string str1 = val1.getString();
                     unistring::unistring unistr1 = unistring::to_unistring(str1);
-                    std::string str2 = v2.get<std::string>();
+                    std::string str2 = val2.getString();
                     unistring::unistring unistr2 = unistring::to_unistring(str2);
                     return Op<unistring::unistring>()(unistr1, unistr2);
                 }
@@ -139,14 +158,41 @@ namespace carto {
             }
         };
 
+        template <typename Pred>
+        struct PredicateOpCode;
+
+        template <> struct PredicateOpCode<IsNullPredicate> { static const QueryProgram::OpCode value = QueryProgram::OP_IS_NULL; };
+        template <> struct PredicateOpCode<IsNotNullPredicate> { static const QueryProgram::OpCode value = QueryProgram::OP_IS_NOT_NULL; };
+        template <> struct PredicateOpCode<EqPredicate> { static const QueryProgram::OpCode value = QueryProgram::OP_EQ; };
+        template <> struct PredicateOpCode<NeqPredicate> { static const QueryProgram::OpCode value = QueryProgram::OP_NEQ; };
+        template <> struct PredicateOpCode<LtPredicate> { static const QueryProgram::OpCode value = QueryProgram::OP_LT; };
+        template <> struct PredicateOpCode<LtePredicate> { static const QueryProgram::OpCode value = QueryProgram::OP_LTE; };
+        template <> struct PredicateOpCode<GtPredicate> { static const QueryProgram::OpCode value = QueryProgram::OP_GT; };
+        template <> struct PredicateOpCode<GtePredicate> { static const QueryProgram::OpCode value = QueryProgram::OP_GTE; };
+        template <> struct PredicateOpCode<RegexpLikePredicate> { static const QueryProgram::OpCode value = QueryProgram::OP_REGEXP_LIKE; };
+
         struct Operand {
             virtual ~Operand() = default;
             virtual Value evaluate(const Context& context) const = 0;
+            virtual QueryProgram::Operand compile(QueryProgram& program) const = 0;
+        };
+
+        struct CompilableExpression : public Expression {
+            virtual void compile(QueryProgram& program) const = 0;
+
+            static void Compile(const std::shared_ptr<Expression>& expr, QueryProgram& program) {
+                auto compilableExpr = std::dynamic_pointer_cast<CompilableExpression>(expr);
+                if (!compilableExpr) {
+                    throw GenericException("Query expression can not be compiled");
+                }
+                compilableExpr->compile(program);
+            }
         };
 
         struct ConstOperand : public Operand {
             explicit ConstOperand(const Value& value) : _value(value) { }
             virtual Value evaluate(const Context& context) const { return _value; }
+            virtual QueryProgram::Operand compile(QueryProgram& program) const { return program.addConstant(_value); }
             static std::shared_ptr<ConstOperand> create(const Value& value) { return std::make_shared<ConstOperand>(value); }
         private:
             Value _value;
@@ -166,47 +212,61 @@ namespace carto {
                 return value;
             }
 
+            virtual QueryProgram::Operand compile(QueryProgram& program) const { return program.addVariable(_name, _nocase); }
+
             static std::shared_ptr<VariableOperand> create(const std::string& name) { return std::make_shared<VariableOperand>(name, false); }
             static std::shared_ptr<VariableOperand> createEx(const std::string& name, const std::string& collateSeq) { return std::make_shared<VariableOperand>(name, CollateNoCase(collateSeq) == CollateNoCase("nocase")); }
 
         private:
-            static std::string CollateNoCase(const std::string& str) {
-                unistring::unistring unistr = unistring::to_unistring(str);
-                return unistring::to_utf8string(unistring::to_upper(unistr));
-            }
-
             std::string _name;
             bool _nocase;
         };
 
-        struct NotExpression : public Expression {
+        struct NotExpression : public CompilableExpression {
             explicit NotExpression(const std::shared_ptr<Expression>& expr) : _expr(expr) { }
             virtual bool evaluate(const Context& context) const { return !_expr->evaluate(context); }
+            virtual void compile(QueryProgram& program) const {
+                Compile(_expr, program);
+                program.emit(QueryProgram::OP_NOT);
+            }
             static std::shared_ptr<NotExpression> create(const std::shared_ptr<Expression>& expr) { return std::make_shared<NotExpression>(expr); }
         private:
             std::shared_ptr<Expression> _expr;
         };
 
-        struct OrExpression : public Expression {
+        struct OrExpression : public CompilableExpression {
             OrExpression(const std::shared_ptr<Expression>& expr1, const std::shared_ptr<Expression>& expr2) : _expr1(expr1), _expr2(expr2) { }
             virtual bool evaluate(const Context& context) const { return _expr1->evaluate(context) || _expr2->evaluate(context); }
+            virtual void compile(QueryProgram& program) const {
+                Compile(_expr1, program);
+                std::size_t jump = program.emit(QueryProgram::OP_JUMP_IF_TRUE);
+                Compile(_expr2, program);
+                program.patchJump(jump);
+            }
             static std::shared_ptr<OrExpression> create(const std::shared_ptr<Expression>& expr1, const std::shared_ptr<Expression>& expr2) { return std::make_shared<OrExpression>(expr1, expr2); }
         private:
             std::shared_ptr<Expression> _expr1, _expr2;
         };
 
-        struct AndExpression : public Expression {
+        struct AndExpression : public CompilableExpression {
             AndExpression(const std::shared_ptr<Expression>& expr1, const std::shared_ptr<Expression>& expr2) : _expr1(expr1), _expr2(expr2) { }
             virtual bool evaluate(const Context& context) const { return _expr1->evaluate(context) && _expr2->evaluate(context); }
+            virtual void compile(QueryProgram& program) const {
+                Compile(_expr1, program);
+                std::size_t jump = program.emit(QueryProgram::OP_JUMP_IF_FALSE);
+                Compile(_expr2, program);
+                program.patchJump(jump);
+            }
             static std::shared_ptr<AndExpression> create(const std::shared_ptr<Expression>& expr1, const std::shared_ptr<Expression>& expr2) { return std::make_shared<AndExpression>(expr1, expr2); }
         private:
             std::shared_ptr<Expression> _expr1, _expr2;
         };
 
         template <typename Pred>
-        struct UnaryPredicateExpression : public Expression {
+        struct UnaryPredicateExpression : public CompilableExpression {
             UnaryPredicateExpression(const std::shared_ptr<Pred>& pred, const std::shared_ptr<Operand>& op) : _pred(pred), _op(op) { }
             virtual bool evaluate(const Context& context) const { return (*_pred)(_op->evaluate(context)); }
+            virtual void compile(QueryProgram& program) const { program.emit(PredicateOpCode<Pred>::value, _op->compile(program)); }
             static std::shared_ptr<UnaryPredicateExpression> create(const std::shared_ptr<Operand>& op) { return std::make_shared<UnaryPredicateExpression>(std::make_shared<Pred>(), op); }
         private:
             std::shared_ptr<Pred> _pred;
@@ -214,9 +274,14 @@ namespace carto {
         };
 
         template <typename Pred>
-        struct BinaryPredicateExpression : public Expression {
+        struct BinaryPredicateExpression : public CompilableExpression {
             BinaryPredicateExpression(const std::shared_ptr<Pred>& pred, const std::shared_ptr<Operand>& op1, const std::shared_ptr<Operand>& op2) : _pred(pred), _op1(op1), _op2(op2) { }
             virtual bool evaluate(const Context& context) const { return (*_pred)(_op1->evaluate(context), _op2->evaluate(context)); }
+            virtual void compile(QueryProgram& program) const {
+                QueryProgram::Operand op1 = _op1->compile(program);
+                QueryProgram::Operand op2 = _op2->compile(program);
+                program.emit(PredicateOpCode<Pred>::value, op1, op2);
+            }
             static std::shared_ptr<BinaryPredicateExpression> create(const std::shared_ptr<Operand>& op1, const std::shared_ptr<Operand>& op2) { return std::make_shared<BinaryPredicateExpression>(std::make_shared<Pred>(), op1, op2); }
         private:
             std::shared_ptr<Pred> _pred;
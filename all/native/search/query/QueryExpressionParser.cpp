@@ -2,6 +2,7 @@
 #include "components/Exceptions.h"
 #include "search/query/QueryExpression.h"
 #include "search/query/QueryExpressionImpl.h"
+#include "search/query/QueryProgram.h"
 #include "utils/Log.h"
 
 #include <memory>
@@ -116,7 +117,7 @@ namespace carto {
         } else if (it != expr.end()) {
             throw ParseException("Could not parse to the end of query expression", expr, static_cast<int>(expr.end() - it));
         }
-        return queryExpr;
+        return QueryProgram::Compile(queryExpr);
     }
 
     QueryExpressionParser::QueryExpressionParser() {
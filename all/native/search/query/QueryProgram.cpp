@@ -0,0 +1,139 @@
+#include "QueryProgram.h"
+#include "components/Exceptions.h"
+#include "search/query/QueryContext.h"
+#include "search/query/QueryExpressionImpl.h"
+
+#include <algorithm>
+
+namespace carto {
+
+    QueryProgram::QueryProgram() :
+        _constants(),
+        _variables(),
+        _instructions()
+    {
+    }
+
+    QueryProgram::~QueryProgram() {
+    }
+
+    QueryProgram::Operand QueryProgram::addConstant(const Variant& value) {
+        _constants.push_back(value);
+        return Operand(false, static_cast<int>(_constants.size()) - 1);
+    }
+
+    QueryProgram::Operand QueryProgram::addVariable(const std::string& name, bool nocase) {
+        auto it = std::find(_variables.begin(), _variables.end(), std::make_pair(name, nocase));
+        if (it != _variables.end()) {
+            return Operand(true, static_cast<int>(it - _variables.begin()));
+        }
+        _variables.emplace_back(name, nocase);
+        return Operand(true, static_cast<int>(_variables.size()) - 1);
+    }
+
+    std::size_t QueryProgram::emit(OpCode opCode, const Operand& op1, const Operand& op2) {
+        Instruction instr(opCode, op1, op2);
+        if (opCode == OP_REGEXP_LIKE && !op2.variable) {
+            // Constant patterns are compiled only once. Invalid patterns are left to the evaluation, to keep the error behavior of the expression tree
+            try {
+                instr.regex = queryexpressionimpl::RegexpLikePredicate::CreateRegex(_constants.at(op2.index));
+            }
+            catch (const std::regex_error&) {
+            }
+        }
+        _instructions.push_back(instr);
+        return _instructions.size() - 1;
+    }
+
+    void QueryProgram::patchJump(std::size_t index) {
+        _instructions.at(index).target = _instructions.size();
+    }
+
+    bool QueryProgram::evaluate(const QueryContext& context) const {
+        using namespace queryexpressionimpl;
+
+        std::vector<Variant> variableValues(_variables.size());
+        std::vector<bool> variablesLoaded(_variables.size(), false);
+        auto fetch = [&](const Operand& op) -> const Variant& {
+            if (!op.variable) {
+                return _constants[op.index];
+            }
+            if (!variablesLoaded[op.index]) {
+                Variant& value = variableValues[op.index];
+                if (context.getVariable(_variables[op.index].first, value)) {
+                    if (_variables[op.index].second && value.getType() == VariantType::VARIANT_TYPE_STRING) {
+                        value = Variant(CollateNoCase(value.getString()));
+                    }
+                } else {
+                    value = Variant();
+                }
+                variablesLoaded[op.index] = true;
+            }
+            return variableValues[op.index];
+        };
+
+        bool result = false;
+        std::size_t pc = 0;
+        while (pc < _instructions.size()) {
+            const Instruction& instr = _instructions[pc++];
+            switch (instr.opCode) {
+            case OP_IS_NULL:
+                result = IsNullPredicate()(fetch(instr.op1));
+                break;
+            case OP_IS_NOT_NULL:
+                result = IsNotNullPredicate()(fetch(instr.op1));
+                break;
+            case OP_EQ:
+                result = EqPredicate()(fetch(instr.op1), fetch(instr.op2));
+                break;
+            case OP_NEQ:
+                result = NeqPredicate()(fetch(instr.op1), fetch(instr.op2));
+                break;
+            case OP_LT:
+                result = LtPredicate()(fetch(instr.op1), fetch(instr.op2));
+                break;
+            case OP_LTE:
+                result = LtePredicate()(fetch(instr.op1), fetch(instr.op2));
+                break;
+            case OP_GT:
+                result = GtPredicate()(fetch(instr.op1), fetch(instr.op2));
+                break;
+            case OP_GTE:
+                result = GtePredicate()(fetch(instr.op1), fetch(instr.op2));
+                break;
+            case OP_REGEXP_LIKE:
+                if (instr.regex) {
+                    result = RegexpLikePredicate::Match(fetch(instr.op1), *instr.regex);
+                } else {
+                    result = RegexpLikePredicate()(fetch(instr.op1), fetch(instr.op2));
+                }
+                break;
+            case OP_NOT:
+                result = !result;
+                break;
+            case OP_JUMP_IF_FALSE:
+                if (!result) {
+                    pc = instr.target;
+                }
+                break;
+            case OP_JUMP_IF_TRUE:
+                if (result) {
+                    pc = instr.target;
+                }
+                break;
+            }
+        }
+        return result;
+    }
+
+    std::shared_ptr<QueryProgram> QueryProgram::Compile(const std::shared_ptr<QueryExpression>& expr) {
+        if (!expr) {
+            throw NullArgumentException("Null expr");
+        }
+
+        auto program = std::make_shared<QueryProgram>();
+        queryexpressionimpl::CompilableExpression::Compile(expr, *program);
+        return program;
+    }
+
+}
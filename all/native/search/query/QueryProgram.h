@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_QUERYPROGRAM_H_
+#define _CARTO_QUERYPROGRAM_H_
+
+#include "core/Variant.h"
+#include "search/query/QueryExpression.h"
+
+#include <memory>
+#include <string>
+#include <regex>
+#include <utility>
+#include <vector>
+
+namespace carto {
+
+    /**
+     * Query expression compiled into a linear program.
+     * Instead of walking the expression tree, the program is executed as a flat list of instructions.
+     * Constants are stored in a table, each distinct variable is fetched from the context only once
+     * per evaluation and constant regular expressions are compiled ahead of time.
+     */
+    class QueryProgram : public QueryExpression {
+    public:
+        enum OpCode {
+            OP_IS_NULL,
+            OP_IS_NOT_NULL,
+            OP_EQ,
+            OP_NEQ,
+            OP_LT,
+            OP_LTE,
+            OP_GT,
+            OP_GTE,
+            OP_REGEXP_LIKE,
+            OP_NOT,
+            OP_JUMP_IF_FALSE,
+            OP_JUMP_IF_TRUE
+        };
+
+        struct Operand {
+            bool variable;
+            int index;
+
+            Operand() : variable(false), index(-1) { }
+            Operand(bool variable, int index) : variable(variable), index(index) { }
+        };
+
+        QueryProgram();
+        virtual ~QueryProgram();
+
+        /**
+         * Adds a constant to the constant table.
+         * @param value The constant value.
+         * @return The operand referring to the constant.
+         */
+        Operand addConstant(const Variant& value);
+        /**
+         * Adds a variable to the variable table. Identical variables share the same slot.
+         * @param name The name of the variable.
+         * @param nocase True if string values should be converted to upper case for case-insensitive comparison.
+         * @return The operand referring to the variable.
+         */
+        Operand addVariable(const std::string& name, bool nocase);
+
+        /**
+         * Appends an instruction to the program.
+         * @param opCode The instruction opcode.
+         * @param op1 The first operand of the predicate instructions.
+         * @param op2 The second operand of the binary predicate instructions.
+         * @return The index of the instruction.
+         */
+        std::size_t emit(OpCode opCode, const Operand& op1 = Operand(), const Operand& op2 = Operand());
+        /**
+         * Sets the target of the specified jump instruction to the end of the program.
+         * @param index The index of the jump instruction.
+         */
+        void patchJump(std::size_t index);
+
+        virtual bool evaluate(const QueryContext& context) const;
+
+        /**
+         * Compiles the expression tree created by the query parser into a program.
+         * @param expr The expression to compile.
+         * @return The compiled program.
+         */
+        static std::shared_ptr<QueryProgram> Compile(const std::shared_ptr<QueryExpression>& expr);
+
+    private:
+        struct Instruction {
+            OpCode opCode;
+            Operand op1;
+            Operand op2;
+            std::size_t target;
+            std::shared_ptr<std::wregex> regex;
+
+            Instruction(OpCode opCode, const Operand& op1, const Operand& op2) : opCode(opCode), op1(op1), op2(op2), target(0), regex() { }
+        };
+
+        std::vector<Variant> _constants;
+        std::vector<std::pair<std::string, bool> > _variables;
+        std::vector<Instruction> _instructions;
+    };
+    
+}
+
+#endif
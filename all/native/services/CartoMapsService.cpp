@@ -19,7 +19,10 @@
 #include "utils/Log.h"
 
 #include <algorithm>
+#include <atomic>
+#include <exception>
 #include <regex>
+#include <thread>
 
 #include <boost/lexical_cast.hpp>
 
@@ -202,20 +205,8 @@ namespace carto {
         urlParams["callback"] = "callback";
         std::string url = NetworkUtils::BuildURLFromParameters(getServiceURL("/api/v1/map"), urlParams);
 
-        // Do HTTP request
-        HTTPClient client(Log::IsShowDebug());
-        std::shared_ptr<BinaryData> responseData;
-        std::map<std::string, std::string> responseHeaders;
-        if (client.get(url, std::map<std::string, std::string>(), responseHeaders, responseData) != 0) {
-            std::string result;
-            if (responseData) {
-                result = std::string(reinterpret_cast<const char*>(responseData->data()), responseData->size());
-            }
-            throw GenericException("Failed to read map configuration", result);
-        }
-
-        // Parse result
-        picojson::value mapInfo = parseJSONP(responseData);
+        // Instantiate the map or reuse the cached instance
+        picojson::value mapInfo = loadMapInfo(url);
 
         // Check for errors and log them
         if (mapInfo.get("errors").is<picojson::array>()) {
@@ -249,6 +240,45 @@ namespace carto {
         urlParams["callback"] = "callback";
         std::string url = NetworkUtils::BuildURLFromParameters(getServiceURL("/api/v1/map/named/" + NetworkUtils::URLEncode(templateId) + "/jsonp"), urlParams);
 
+        // Instantiate the map or reuse the cached instance
+        picojson::value mapInfo = loadMapInfo(url);
+
+        // Check for errors and log them
+        if (mapInfo.get("errors").is<picojson::array>()) {
+            const picojson::array& errorsInfo = mapInfo.get("errors").get<picojson::array>();
+            for (auto it = errorsInfo.begin(); it != errorsInfo.end(); it++) {
+                std::string error = it->get<std::string>();
+                Log::Errorf("CartoMapsService::buildNamedMap: %s", error.c_str());
+            }
+            if (!errorsInfo.empty()) {
+                std::string firstError = errorsInfo.front().get<std::string>();
+                throw GenericException("Errors when trying to instantiate named map", firstError);
+            }
+        }
+
+        // Create layers
+        return createLayers(mapInfo);
+    }
+
+    picojson::value CartoMapsService::loadMapInfo(const std::string& url) const {
+        // The URL contains the full configuration and the credentials, so it identifies the instance
+        {
+            std::lock_guard<std::mutex> lock(_MapInfoCacheMutex);
+            auto now = std::chrono::steady_clock::now();
+            for (auto it = _MapInfoCache.begin(); it != _MapInfoCache.end(); ) {
+                if (now - it->time > std::chrono::seconds(MAP_INFO_CACHE_TIMEOUT)) {
+                    it = _MapInfoCache.erase(it);
+                    continue;
+                }
+                if (it->url == url) {
+                    picojson::value mapInfo = it->mapInfo;
+                    _MapInfoCache.splice(_MapInfoCache.begin(), _MapInfoCache, it);
+                    return mapInfo;
+                }
+                it++;
+            }
+        }
+
         // Perform HTTP request
         HTTPClient client(Log::IsShowDebug());
         std::shared_ptr<BinaryData> responseData;
@@ -260,25 +290,31 @@ namespace carto {
             }
             throw GenericException("Failed to read map configuration", result);
         }
-        
+
         // Parse result
         picojson::value mapInfo = parseJSONP(responseData);
 
-        // Check for errors and log them
-        if (mapInfo.get("errors").is<picojson::array>()) {
-            const picojson::array& errorsInfo = mapInfo.get("errors").get<picojson::array>();
-            for (auto it = errorsInfo.begin(); it != errorsInfo.end(); it++) {
-                std::string error = it->get<std::string>();
-                Log::Errorf("CartoMapsService::buildNamedMap: %s", error.c_str());
+        // Cache successfully instantiated maps only. Layergroup id changes when the map is updated (last_updated), so the cached instance is valid until it expires.
+        if (mapInfo.get("layergroupid").is<std::string>() && !mapInfo.get("errors").is<picojson::array>()) {
+            std::lock_guard<std::mutex> lock(_MapInfoCacheMutex);
+            for (auto it = _MapInfoCache.begin(); it != _MapInfoCache.end(); it++) {
+                if (it->url == url) {
+                    _MapInfoCache.erase(it);
+                    break;
+                }
             }
-            if (!errorsInfo.empty()) {
-                std::string firstError = errorsInfo.front().get<std::string>();
-                throw GenericException("Errors when trying to instantiate named map", firstError);
+
+            MapInfoCacheEntry entry;
+            entry.url = url;
+            entry.time = std::chrono::steady_clock::now();
+            entry.mapInfo = mapInfo;
+            _MapInfoCache.push_front(std::move(entry));
+
+            while (_MapInfoCache.size() > MAX_CACHED_MAP_INFOS) {
+                _MapInfoCache.pop_back();
             }
         }
-
-        // Create layers
-        return createLayers(mapInfo);
+        return mapInfo;
     }
 
     std::string CartoMapsService::getServiceURL(const std::string& path) const {
@@ -333,7 +369,7 @@ namespace carto {
         return url;
     }
 
-    std::shared_ptr<Layer> CartoMapsService::createLayerGroup(const std::string& layerGroupId, const std::string& type, const std::vector<LayerInfo>& layerInfos, const std::map<std::string, std::string>& cdnURLs) const {
+    std::shared_ptr<Layer> CartoMapsService::createLayerGroup(const std::string& layerGroupId, const std::string& type, const std::vector<LayerInfo>& layerInfos, const std::string& tilerURL) const {
         if (layerInfos.empty()) {
             return std::shared_ptr<Layer>();
         }
@@ -343,7 +379,7 @@ namespace carto {
             int minZoom = 0;
             int maxZoom = Const::MAX_SUPPORTED_ZOOM_LEVEL;
 
-            std::string urlTemplateBase = getTilerURL(cdnURLs);
+            std::string urlTemplateBase = tilerURL;
             urlTemplateBase += "/api/v1/map/" + layerGroupId;
             for (std::size_t i = 0; i < layerInfos.size(); i++) {
                 urlTemplateBase += (i == 0 ? "/" : ",") + boost::lexical_cast<std::string>(layerInfos[i].index);
@@ -383,12 +419,6 @@ namespace carto {
                     }
                     auto vectorTileDecoder = std::make_shared<CartoVectorTileDecoder>(layerIds, layerStyleSets);
                     auto baseDataSource = std::make_shared<HTTPTileDataSource>(minZoom, maxZoom, urlTemplateBase + "/{z}/{x}/{y}.mvt" + urlTemplateSuffix);
-#if defined(__APPLE__)
-                    // Force using gzipped vector tiles on iOS, our decoder supports this
-                    std::map<std::string, std::string> headers;
-                    headers["Accept-Encoding"] = "gzip";
-                    baseDataSource->setHTTPHeaders(headers);
-#endif
                     auto dataSource = std::make_shared<MemoryCacheTileDataSource>(baseDataSource); // in memory cache allows to change style quickly
                     tileLayer = std::make_shared<VectorTileLayer>(dataSource, vectorTileDecoder);
                 } else {
@@ -451,7 +481,8 @@ namespace carto {
             }
         }
         
-        // Create layers. For similar layer types, group as many as possible
+        // Gather layer groups. For similar layer types, group as many as possible
+        std::vector<std::pair<std::string, std::vector<LayerInfo> > > layerGroups;
         std::string layerType;
         std::vector<LayerInfo> layerInfos;
         for (auto it = layersInfo.begin(); it != layersInfo.end(); it++) {
@@ -474,10 +505,10 @@ namespace carto {
                 }
             }
             
-            // Create previously gathered layers if type has changed (or Torque layer) or in interactive mode (as grid.json can be queried from a single layer)
+            // Close previously gathered group if type has changed (or Torque layer) or in interactive mode (as grid.json can be queried from a single layer)
             if (type != layerType || type == "torque" || _interactive) {
-                if (std::shared_ptr<Layer> layer = createLayerGroup(layerGroupId, layerType, layerInfos, cdnURLs)) {
-                    layers.push_back(layer);
+                if (!layerInfos.empty()) {
+                    layerGroups.emplace_back(layerType, layerInfos);
                 }
                 layerType = type;
                 layerInfos.clear();
@@ -500,12 +531,43 @@ namespace carto {
             // Add layer info
             layerInfos.emplace_back(index, id, cartoCSS);
         }
-        
-        // Create remaining grouped layers
-        if (std::shared_ptr<Layer> layer = createLayerGroup(layerGroupId, layerType, layerInfos, cdnURLs)) {
-            layers.push_back(layer);
+        if (!layerInfos.empty()) {
+            layerGroups.emplace_back(layerType, layerInfos);
         }
 
+        // Create the layers in parallel, parsing CartoCSS styles is the most expensive part. The order of the layers is kept.
+        std::string tilerURL = getTilerURL(cdnURLs);
+        std::vector<std::shared_ptr<Layer> > groupLayers(layerGroups.size());
+        std::vector<std::exception_ptr> groupExceptions(layerGroups.size());
+        std::atomic<std::size_t> nextGroupIndex(0);
+        auto createLayerGroups = [&]() {
+            for (std::size_t i = nextGroupIndex++; i < layerGroups.size(); i = nextGroupIndex++) {
+                try {
+                    groupLayers[i] = createLayerGroup(layerGroupId, layerGroups[i].first, layerGroups[i].second, tilerURL);
+                }
+                catch (...) {
+                    groupExceptions[i] = std::current_exception();
+                }
+            }
+        };
+
+        std::vector<std::shared_ptr<std::thread> > threads;
+        for (std::size_t i = 1; i < std::min(layerGroups.size(), static_cast<std::size_t>(LAYER_BUILD_THREADS)); i++) {
+            threads.push_back(std::make_shared<std::thread>(createLayerGroups));
+        }
+        createLayerGroups();
+        for (const std::shared_ptr<std::thread>& thread : threads) {
+            thread->join();
+        }
+
+        for (std::size_t i = 0; i < layerGroups.size(); i++) {
+            if (groupExceptions[i]) {
+                std::rethrow_exception(groupExceptions[i]);
+            }
+            if (groupLayers[i]) {
+                layers.push_back(groupLayers[i]);
+            }
+        }
         return layers;
     }
 
@@ -535,6 +597,11 @@ namespace carto {
 
     const std::string CartoMapsService::DEFAULT_API_TEMPLATE = "https://{user}.carto.com";
 
+    const std::size_t CartoMapsService::MAX_CACHED_MAP_INFOS = 8;
+
+    std::list<CartoMapsService::MapInfoCacheEntry> CartoMapsService::_MapInfoCache;
+    std::mutex CartoMapsService::_MapInfoCacheMutex;
+
 }
 
 #endif
@@ -11,6 +11,8 @@
 
 #include "core/Variant.h"
 
+#include <chrono>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -235,17 +237,31 @@ namespace carto {
             LayerInfo(int index, const std::string& id, const std::string& cartoCSS) : index(index), id(id), cartoCSS(cartoCSS) { }
         };
 
+        struct MapInfoCacheEntry {
+            std::string url;
+            std::chrono::steady_clock::time_point time;
+            picojson::value mapInfo;
+        };
+
+        picojson::value loadMapInfo(const std::string& url) const;
+
         std::string getServiceURL(const std::string& path) const;
 
         std::string getTilerURL(const std::map<std::string, std::string>& cdnURLs) const;
 
-        std::shared_ptr<Layer> createLayerGroup(const std::string& layerGroupId, const std::string& type, const std::vector<LayerInfo>& layerInfos, const std::map<std::string, std::string>& cdnURLs) const;
+        std::shared_ptr<Layer> createLayerGroup(const std::string& layerGroupId, const std::string& type, const std::vector<LayerInfo>& layerInfos, const std::string& tilerURL) const;
 
         std::vector<std::shared_ptr<Layer> > createLayers(const picojson::value& mapInfo) const;
 
         static picojson::value parseJSONP(const std::shared_ptr<BinaryData>& data);
 
         static const std::string DEFAULT_API_TEMPLATE;
+        static const int MAP_INFO_CACHE_TIMEOUT = 300; // in seconds
+        static const int LAYER_BUILD_THREADS = 4;
+        static const std::size_t MAX_CACHED_MAP_INFOS;
+
+        static std::list<MapInfoCacheEntry> _MapInfoCache; // most recently used first
+        static std::mutex _MapInfoCacheMutex;
         
         std::string _username;
         std::string _apiKey;
@@ -2,16 +2,72 @@
 
 #include "CartoSQLService.h"
 #include "core/BinaryData.h"
+#include "core/MapBounds.h"
+#include "datasources/LocalVectorDataSource.h"
+#include "geometry/Feature.h"
 #include "geometry/FeatureCollection.h"
+#include "geometry/GeoJSONFeatureReaderListener.h"
 #include "geometry/GeoJSONGeometryReader.h"
 #include "components/Exceptions.h"
 #include "projections/Projection.h"
+#include "projections/EPSG3857.h"
 #include "network/HTTPClient.h"
+#include "styles/Style.h"
+#include "vectortiles/utils/GeometryConverter.h"
+#include "vectortiles/utils/ValueConverter.h"
+#include "vectortiles/utils/MapnikVTLogger.h"
 #include "utils/GeneralUtils.h"
 #include "utils/NetworkUtils.h"
 #include "utils/Const.h"
 #include "utils/Log.h"
 
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <thread>
+
+#include <mapnikvt/Value.h>
+#include <mapnikvt/MBVTFeatureDecoder.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include <stdext/base64.h>
+
+namespace {
+
+    class DataSourceFeatureListener : public carto::GeoJSONFeatureReaderListener {
+    public:
+        DataSourceFeatureListener(const std::shared_ptr<carto::LocalVectorDataSource>& dataSource, const std::shared_ptr<carto::Style>& style) :
+            _dataSource(dataSource), _style(style), _features()
+        {
+        }
+
+        virtual bool onFeatureRead(const std::shared_ptr<carto::Feature>& feature) {
+            _features.push_back(feature);
+            if (_features.size() >= BATCH_SIZE) {
+                flush();
+            }
+            return true;
+        }
+
+        void flush() {
+            if (!_features.empty()) {
+                _dataSource->addFeatureCollection(std::make_shared<carto::FeatureCollection>(std::move(_features)), _style);
+                _features.clear();
+            }
+        }
+
+    private:
+        static const std::size_t BATCH_SIZE = 1000;
+
+        std::shared_ptr<carto::LocalVectorDataSource> _dataSource;
+        std::shared_ptr<carto::Style> _style;
+        std::vector<std::shared_ptr<carto::Feature> > _features;
+    };
+
+}
+
 namespace carto {
 
     CartoSQLService::CartoSQLService() :
@@ -88,16 +144,127 @@ namespace carto {
         return reader.readFeatureCollection(result);
     }
 
-    std::string CartoSQLService::executeQuery(const std::map<std::string, std::string>& urlParams) const {
+    void CartoSQLService::queryFeatures(const std::string& sql, const std::shared_ptr<Projection>& proj, const std::shared_ptr<GeoJSONFeatureReaderListener>& listener) const {
+        if (!listener) {
+            throw NullArgumentException("Null listener");
+        }
+
+        std::map<std::string, std::string> urlParams;
+        urlParams["q"] = sql;
+        urlParams["format"] = "GeoJSON";
+        {
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            if (!_apiKey.empty()) {
+                urlParams["api_key"] = _apiKey;
+            }
+        }
+        streamFeatures(urlParams, proj, listener);
+    }
+
+    void CartoSQLService::queryFeatures(const std::string& sql, const std::shared_ptr<LocalVectorDataSource>& dataSource, const std::shared_ptr<Style>& style) const {
+        if (!dataSource) {
+            throw NullArgumentException("Null dataSource");
+        }
+        if (!style) {
+            throw NullArgumentException("Null style");
+        }
+
+        auto listener = std::make_shared<DataSourceFeatureListener>(dataSource, style);
+        queryFeatures(sql, dataSource->getProjection(), listener);
+        listener->flush();
+    }
+
+    std::shared_ptr<FeatureCollection> CartoSQLService::queryFeaturesMBVT(const std::string& sql, const std::shared_ptr<Projection>& proj) const {
+        // Let the server encode the features as a single tile covering their extent. The extent is expanded to keep it valid for a single point.
+        std::string tileExtent = boost::lexical_cast<std::string>(MBVT_TILE_EXTENT);
+        std::string mbvtSQL =
+            "WITH q AS (" + sql + "), b AS (SELECT ST_Expand(ST_Extent(the_geom_webmercator), 1.0) AS ext FROM q) "
+            "SELECT (SELECT ST_XMin(ext) FROM b) AS xmin, (SELECT ST_YMin(ext) FROM b) AS ymin, (SELECT ST_XMax(ext) FROM b) AS xmax, (SELECT ST_YMax(ext) FROM b) AS ymax, "
+            "encode(ST_AsMVT(t, 'features', " + tileExtent + ", 'mvt_geom'), 'base64') AS mvt "
+            "FROM (SELECT to_jsonb(q) - 'the_geom' - 'the_geom_webmercator' AS properties, ST_AsMVTGeom(q.the_geom_webmercator, (SELECT ext FROM b), " + tileExtent + ", 0, false) AS mvt_geom FROM q) AS t";
+
+        std::map<std::string, std::string> urlParams;
+        urlParams["q"] = mbvtSQL;
+        {
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            if (!_apiKey.empty()) {
+                urlParams["api_key"] = _apiKey;
+            }
+        }
+        std::string result = executeQuery(urlParams);
+
+        // Parse result
+        picojson::value resultValue;
+        std::string err = picojson::parse(resultValue, result);
+        if (!err.empty()) {
+            throw ParseException(err, result);
+        }
+        const picojson::value& rowsValue = resultValue.get("rows");
+        if (!rowsValue.is<picojson::array>() || rowsValue.get<picojson::array>().empty()) {
+            throw ParseException("Missing rows in the query result");
+        }
+        const picojson::value& rowValue = rowsValue.get<picojson::array>().front();
+
+        std::vector<std::shared_ptr<Feature> > features;
+        if (!rowValue.get("mvt").is<std::string>() || !rowValue.get("xmin").is<double>()) {
+            return std::make_shared<FeatureCollection>(std::move(features)); // empty result
+        }
+        const std::string& mvtBase64 = rowValue.get("mvt").get<std::string>();
+        std::vector<unsigned char> mvtData = base64::decode_base64<unsigned char>(mvtBase64.data(), mvtBase64.size());
+        MapBounds tileBounds(MapPos(rowValue.get("xmin").get<double>(), rowValue.get("ymin").get<double>()), MapPos(rowValue.get("xmax").get<double>(), rowValue.get("ymax").get<double>()));
+
+        // Decode the tile, positions are relative to the tile bounds in EPSG:3857
+        EPSG3857 epsg3857;
+        auto convertFn = [&tileBounds, &epsg3857, &proj](const cglib::vec2<float>& pos) {
+            MapPos wgs84Pos = epsg3857.toWgs84(MapPos(tileBounds.getMin().getX() + pos(0) * tileBounds.getDelta().getX(), tileBounds.getMax().getY() - pos(1) * tileBounds.getDelta().getY(), 0));
+            return proj ? proj->fromWgs84(wgs84Pos) : wgs84Pos;
+        };
+        try {
+            mvt::MBVTFeatureDecoder decoder(mvtData, std::make_shared<MapnikVTLogger>("CartoSQLService"));
+            for (const std::string& mvtLayerName : decoder.getLayerNames()) {
+                for (std::shared_ptr<mvt::FeatureDecoder::FeatureIterator> mvtIt = decoder.createLayerFeatureIterator(mvtLayerName); mvtIt->valid(); mvtIt->advance()) {
+                    std::shared_ptr<const mvt::Geometry> mvtGeometry = mvtIt->getGeometry();
+                    if (!mvtGeometry) {
+                        continue;
+                    }
+
+                    std::map<std::string, Variant> featureData;
+                    if (std::shared_ptr<const mvt::FeatureData> mvtFeatureData = mvtIt->getFeatureData()) {
+                        for (const std::string& varName : mvtFeatureData->getVariableNames()) {
+                            mvt::Value mvtValue;
+                            if (mvtFeatureData->getVariable(varName, mvtValue)) {
+                                featureData[varName] = boost::apply_visitor(ValueConverter(), mvtValue);
+                            }
+                        }
+                    }
+
+                    features.push_back(std::make_shared<Feature>(convertGeometry(convertFn, mvtGeometry), Variant(featureData)));
+                }
+            }
+        }
+        catch (const std::exception& ex) {
+            throw ParseException(std::string("Failed to decode vector tile: ") + ex.what());
+        }
+        return std::make_shared<FeatureCollection>(std::move(features));
+    }
+
+    std::string CartoSQLService::buildQueryURL(const std::map<std::string, std::string>& urlParams) const {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
 
-        // Build URL
         std::map<std::string, std::string> tagValues = { { "user", _username },{ "username", _username } };
         std::string baseURL = GeneralUtils::ReplaceTags(_apiTemplate, tagValues, "{", "}", false) + "/api/v2/sql";
         std::string url = NetworkUtils::BuildURLFromParameters(baseURL, urlParams);
         if (urlParams.find("api_key") != urlParams.end()) {
             url = NetworkUtils::SetURLProtocol(url, "https");
         }
+        return url;
+    }
+
+    std::string CartoSQLService::executeQuery(const std::map<std::string, std::string>& urlParams) const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+
+        // Build URL
+        std::string url = buildQueryURL(urlParams);
 
         // Perform HTTP request
         HTTPClient client(Log::IsShowDebug());
@@ -106,18 +273,7 @@ namespace carto {
         if (client.get(url, std::map<std::string, std::string>(), responseHeaders, responseData) != 0) {
             std::string error = "Invalid HTTP response code";
             if (responseData) {
-                std::string result = std::string(reinterpret_cast<const char*>(responseData->data()), responseData->size());
-                picojson::value resultInfo;
-                picojson::parse(resultInfo, result);
-                if (resultInfo.get("error").is<picojson::array>()) {
-                    const picojson::array& errorInfo = resultInfo.get("error").get<picojson::array>();
-                    for (auto it = errorInfo.begin(); it != errorInfo.end(); it++) {
-                        Log::Errorf("CartoSQLService::executeQuery: %s", it->get<std::string>().c_str());
-                    }
-                    if (!errorInfo.empty()) {
-                        error = errorInfo.front().get<std::string>();
-                    }
-                }
+                error = ReadErrorMessage(std::string(reinterpret_cast<const char*>(responseData->data()), responseData->size()));
             }
             throw GenericException("Failed to execute query", error);
         }
@@ -127,6 +283,131 @@ namespace carto {
         return result;
     }
 
+    void CartoSQLService::streamFeatures(const std::map<std::string, std::string>& urlParams, const std::shared_ptr<Projection>& proj, const std::shared_ptr<GeoJSONFeatureReaderListener>& listener) const {
+        std::string url = buildQueryURL(urlParams);
+
+        // The response is downloaded on a separate thread and parsed on this thread. The queue between them is bounded,
+        // so a slow consumer blocks the download instead of buffering the whole response.
+        std::mutex queueMutex;
+        std::condition_variable queueCondition;
+        std::deque<std::string> queue;
+        std::size_t queueSize = 0;
+        bool finished = false;
+        bool stopped = false;
+        int responseCode = -1;
+        std::string responsePrefix;
+        std::exception_ptr downloadException;
+
+        std::thread downloadThread([&]() {
+            std::uint64_t receivedSize = 0;
+            HTTPClient::HandlerFunc handlerFn = [&](std::uint64_t offset, std::uint64_t length, const unsigned char* buf, std::size_t size) {
+                // Skip the data that was already received, in case the request was restarted
+                if (offset + size <= receivedSize) {
+                    return true;
+                }
+                std::size_t skipSize = static_cast<std::size_t>(receivedSize > offset ? receivedSize - offset : 0);
+                std::string chunk(reinterpret_cast<const char*>(buf) + skipSize, size - skipSize);
+                receivedSize = offset + size;
+
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueCondition.wait(lock, [&]() { return stopped || queueSize < MAX_BUFFERED_RESPONSE_SIZE; });
+                if (stopped) {
+                    return false;
+                }
+                if (responsePrefix.size() < MAX_ERROR_RESPONSE_SIZE) {
+                    responsePrefix.append(chunk, 0, MAX_ERROR_RESPONSE_SIZE - responsePrefix.size());
+                }
+                queueSize += chunk.size();
+                queue.push_back(std::move(chunk));
+                queueCondition.notify_all();
+                return true;
+            };
+
+            int code = -1;
+            std::exception_ptr exception;
+            try {
+                HTTPClient client(Log::IsShowDebug());
+                std::map<std::string, std::string> responseHeaders;
+                code = client.streamResponse("GET", url, std::map<std::string, std::string>(), responseHeaders, handlerFn, 0);
+            }
+            catch (...) {
+                exception = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(queueMutex);
+            finished = true;
+            responseCode = code;
+            downloadException = exception;
+            queueCondition.notify_all();
+        });
+
+        std::string chunk;
+        std::size_t chunkOffset = 0;
+        auto readFn = [&](char* buf, std::size_t size) -> std::size_t {
+            if (chunkOffset >= chunk.size()) {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueCondition.wait(lock, [&]() { return finished || !queue.empty(); });
+                if (queue.empty()) {
+                    return 0;
+                }
+                chunk = std::move(queue.front());
+                chunkOffset = 0;
+                queue.pop_front();
+                queueSize -= chunk.size();
+                queueCondition.notify_all();
+            }
+            std::size_t readSize = std::min(size, chunk.size() - chunkOffset);
+            std::memcpy(buf, chunk.data() + chunkOffset, readSize);
+            chunkOffset += readSize;
+            return readSize;
+        };
+
+        std::exception_ptr parseException;
+        try {
+            GeoJSONGeometryReader reader;
+            reader.setTargetProjection(proj);
+            reader.readFeatureCollectionBlocks(readFn, listener);
+        }
+        catch (...) {
+            parseException = std::current_exception();
+        }
+
+        // Stop the download, if parsing finished early or the listener stopped reading
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopped = true;
+            queueCondition.notify_all();
+        }
+        downloadThread.join();
+
+        if (downloadException) {
+            std::rethrow_exception(downloadException);
+        }
+        if (parseException) {
+            // An error response is not a feature collection, report the error of the service instead of the parsing error
+            if (responseCode > 0) {
+                throw GenericException("Failed to execute query", ReadErrorMessage(responsePrefix));
+            }
+            std::rethrow_exception(parseException);
+        }
+    }
+
+    std::string CartoSQLService::ReadErrorMessage(const std::string& response) {
+        std::string error = "Invalid HTTP response code";
+        picojson::value resultInfo;
+        picojson::parse(resultInfo, response);
+        if (resultInfo.get("error").is<picojson::array>()) {
+            const picojson::array& errorInfo = resultInfo.get("error").get<picojson::array>();
+            for (auto it = errorInfo.begin(); it != errorInfo.end(); it++) {
+                Log::Errorf("CartoSQLService::executeQuery: %s", it->get<std::string>().c_str());
+            }
+            if (!errorInfo.empty()) {
+                error = errorInfo.front().get<std::string>();
+            }
+        }
+        return error;
+    }
+
     const std::string CartoSQLService::DEFAULT_API_TEMPLATE = "https://{user}.carto.com";
 
 }
@@ -11,13 +11,17 @@
 
 #include "core/Variant.h"
 
+#include <map>
 #include <memory>
 #include <mutex>
 #include <string>
 
 namespace carto {
     class FeatureCollection;
+    class GeoJSONFeatureReaderListener;
+    class LocalVectorDataSource;
     class Projection;
+    class Style;
 
     /**
      * A high-level interface for Carto SQL Service.
@@ -85,9 +89,50 @@ namespace carto {
          * @throws std::runtime_error If IO error occured during the operation.
          */
         std::shared_ptr<FeatureCollection> queryFeatures(const std::string& sql, const std::shared_ptr<Projection>& proj) const;
+        /**
+         * Connects to the online service and performs the specified query in streaming mode.
+         * The resulting GeoJSON is parsed while it is downloaded and the features are passed to the listener one at a time,
+         * so the whole response is never kept in memory.
+         * @param sql The SQL query to use.
+         * @param proj The projection to use for transforming feature coordinates. Can be null for WGS84 coordinates.
+         * @param listener The listener to receive the features. Returning false from the listener cancels the query.
+         * @throws std::runtime_error If IO error occured during the operation.
+         */
+        void queryFeatures(const std::string& sql, const std::shared_ptr<Projection>& proj, const std::shared_ptr<GeoJSONFeatureReaderListener>& listener) const;
+        /**
+         * Connects to the online service and performs the specified query in streaming mode.
+         * The features are added to the data source in batches while the response is downloaded,
+         * using the projection of the data source.
+         * @param sql The SQL query to use.
+         * @param dataSource The data source to add the features to.
+         * @param style The style to use for the created vector elements.
+         * @throws std::runtime_error If IO error occured during the operation.
+         */
+        void queryFeatures(const std::string& sql, const std::shared_ptr<LocalVectorDataSource>& dataSource, const std::shared_ptr<Style>& style) const;
+
+        /**
+         * Connects to the online service and performs the specified query, transferring the result in compact Mapbox vector tile format.
+         * The server encodes the result as a single vector tile covering the extent of the features, which is much smaller
+         * than GeoJSON and faster to decode. The query must return the geometry in 'the_geom_webmercator' column,
+         * all non-geometry columns are returned as feature properties.
+         * Coordinates are quantized relative to the extent of the result, so this is best suited for regional queries.
+         * @param sql The SQL query to use.
+         * @param proj The projection to use for transforming feature coordinates. Can be null for WGS84 coordinates.
+         * @return The query result as feature collection.
+         * @throws std::runtime_error If IO error occured during the operation.
+         */
+        std::shared_ptr<FeatureCollection> queryFeaturesMBVT(const std::string& sql, const std::shared_ptr<Projection>& proj) const;
 
     private:
+        std::string buildQueryURL(const std::map<std::string, std::string>& urlParams) const;
         std::string executeQuery(const std::map<std::string, std::string>& urlParams) const;
+        void streamFeatures(const std::map<std::string, std::string>& urlParams, const std::shared_ptr<Projection>& proj, const std::shared_ptr<GeoJSONFeatureReaderListener>& listener) const;
+
+        static std::string ReadErrorMessage(const std::string& response);
+
+        static const std::size_t MAX_BUFFERED_RESPONSE_SIZE = 1024 * 1024;
+        static const std::size_t MAX_ERROR_RESPONSE_SIZE = 64 * 1024;
+        static const int MBVT_TILE_EXTENT = 1 << 20;
 
         static const std::string DEFAULT_API_TEMPLATE;
 
@@ -1,11 +1,15 @@
 #include "BaseMapView.h"
 #include "components/CancelableThreadPool.h"
+#include "components/Exceptions.h"
+#include "components/MapEngine.h"
 #include "components/LicenseManager.h"
+#include "components/TileCacheManager.h"
 #include "components/Layers.h"
 #include "core/MapPos.h"
 #include "core/MapBounds.h"
 #include "core/ScreenPos.h"
 #include "core/ScreenBounds.h"
+#include "network/FetchConcurrencyController.h"
 #include "layers/Layer.h"
 #include "layers/TileLayer.h"
 #include "projections/Projection.h"
@@ -39,16 +43,45 @@ namespace carto {
         ss << ", device OS: " << PlatformUtils::GetDeviceOS();
         return ss.str();
     }
+
+    std::size_t BaseMapView::GetGlobalTileCacheCapacity() {
+        return TileCacheManager::GetInstance().getCapacity();
+    }
+
+    void BaseMapView::SetGlobalTileCacheCapacity(std::size_t capacityInBytes) {
+        TileCacheManager::GetInstance().setCapacity(capacityInBytes);
+    }
+
+    bool BaseMapView::IsAdaptiveTileFetchConcurrency() {
+        return FetchConcurrencyController::GetInstance().isEnabled();
+    }
+
+    void BaseMapView::SetAdaptiveTileFetchConcurrency(bool enabled) {
+        FetchConcurrencyController::GetInstance().setEnabled(enabled);
+    }
     
     BaseMapView::BaseMapView() :
-        _envelopeThreadPool(std::make_shared<CancelableThreadPool>()),
-        _tileThreadPool(std::make_shared<CancelableThreadPool>()),
-        _options(std::make_shared<Options>(_envelopeThreadPool, _tileThreadPool)),
-        _layers(std::make_shared<Layers>(_envelopeThreadPool, _tileThreadPool, _options)),
-        _mapRenderer(std::make_shared<MapRenderer>(_layers, _options)),
-        _touchHandler(std::make_shared<TouchHandler>(_mapRenderer, _options)),
+        BaseMapView(std::make_shared<MapEngine>())
+    {
+    }
+
+    BaseMapView::BaseMapView(const std::shared_ptr<MapEngine>& engine) :
+        _engine(engine),
+        _options(),
+        _layers(),
+        _mapRenderer(),
+        _touchHandler(),
         _mutex()
     {
+        if (!engine) {
+            throw NullArgumentException("Null engine");
+        }
+
+        _options = std::make_shared<Options>(engine->getEnvelopeThreadPool(), engine->getTileThreadPool(), engine->getTileDecodeThreadPool());
+        _layers = std::make_shared<Layers>(engine->getEnvelopeThreadPool(), engine->getTileThreadPool(), engine->getTileDecodeThreadPool(), _options);
+        _mapRenderer = std::make_shared<MapRenderer>(_layers, _options);
+        _touchHandler = std::make_shared<TouchHandler>(_mapRenderer, _options);
+
         _mapRenderer->init();
         _touchHandler->init();
         _layers->setComponents(_mapRenderer, _touchHandler);
@@ -62,10 +95,7 @@ namespace carto {
     }
     
     BaseMapView::~BaseMapView() {
-        // Set stop flag and detach every thread, once the thread quits
-        // all objects they hold will be released
-        _envelopeThreadPool->deinit();
-        _tileThreadPool->deinit();
+        // The worker pools are stopped by the engine, once it is not used by any other view
         _mapRenderer->deinit();
         _touchHandler->deinit();
     }
@@ -281,8 +311,9 @@ namespace carto {
     }
     
     void BaseMapView::cancelAllTasks() {
-        _envelopeThreadPool->cancelAll();
-        _tileThreadPool->cancelAll();
+        _engine->getEnvelopeThreadPool()->cancelAll();
+        _engine->getTileThreadPool()->cancelAll();
+        _engine->getTileDecodeThreadPool()->cancelAll();
     }
     
     void BaseMapView::clearPreloadingCaches() {
@@ -301,6 +332,15 @@ namespace carto {
         }
     }
     
+    void BaseMapView::releaseMemory(MemoryPressureLevel::MemoryPressureLevel level) {
+        for (const std::shared_ptr<Layer>& layer : _layers->getAll()) {
+            layer->releaseMemory(level);
+        }
+        if (level >= MemoryPressureLevel::MEMORY_PRESSURE_LEVEL_MODERATE) {
+            _mapRenderer->clearStyleTextureCache();
+        }
+    }
+    
     const std::shared_ptr<Layers>& BaseMapView::getLayers() const {
         return _layers;
     }
@@ -7,14 +7,16 @@
 #ifndef _CARTO_BASEMAPVIEW_H_
 #define _CARTO_BASEMAPVIEW_H_
 
+#include "components/MemoryPressureLevel.h"
+
 #include <memory>
 #include <mutex>
 #include <thread>
 
 namespace carto {
-    class CancelableThreadPool;
     class Layers;
     class MapBounds;
+    class MapEngine;
     class MapPos;
     class MapVec;
     class MapRenderer;
@@ -46,8 +48,44 @@ namespace carto {
          * @return The SDK version and build info.
          */
         static std::string GetSDKVersion();
+
+        /**
+         * Returns the total capacity of the tile caches of all tile layers in the process.
+         * @return The total tile cache capacity in bytes. Zero means that the total size is not limited. Default is 0.
+         */
+        static std::size_t GetGlobalTileCacheCapacity();
+        /**
+         * Sets the total capacity of the tile caches of all tile layers in the process.
+         * When the capacity is exceeded, preloading tiles are released first and visible tiles only after that.
+         * The capacity is applied in addition to the cache capacities of single layers.
+         * @param capacityInBytes The new total tile cache capacity in bytes. Zero means that the total size is not limited.
+         */
+        static void SetGlobalTileCacheCapacity(std::size_t capacityInBytes);
+
+        /**
+         * Returns true if the number of in-flight online tile requests is adapted to the network conditions.
+         * @return True if adaptive tile fetch concurrency is enabled. Default is false.
+         */
+        static bool IsAdaptiveTileFetchConcurrency();
+        /**
+         * Enables/disables adaptive tile fetch concurrency. When enabled, the number of concurrent online tile requests
+         * of all layers is grown while the network latency stays low and reduced when latency increases or requests fail.
+         * The limit never exceeds the tile thread pool size, decoding threads are not affected.
+         * @param enabled True if adaptive tile fetch concurrency should be enabled.
+         */
+        static void SetAdaptiveTileFetchConcurrency(bool enabled);
         
+        /**
+         * Constructs a new map view with its own engine.
+         */
         BaseMapView();
+        /**
+         * Constructs a new map view attached to the specified engine.
+         * The worker pools of the engine are shared with the other views attached to the same engine.
+         * @param engine The engine to attach to.
+         * @throws std::invalid_argument If the engine is null.
+         */
+        explicit BaseMapView(const std::shared_ptr<MapEngine>& engine);
         virtual ~BaseMapView();
     
         /**
@@ -340,6 +378,7 @@ namespace carto {
         /**
          * Cancels all qued tasks such as tile and vector data fetches. Tasks that have already started
          * may continue until they finish. Tasks that are added after this method call are not affected.
+         * Note: the worker pools are shared by all views attached to the same engine, so their tasks are canceled too.
          */
         void cancelAllTasks();
     
@@ -355,10 +394,18 @@ namespace carto {
          * including the visible area.
          */
         void clearAllCaches();
+
+        /**
+         * Releases memory in stages according to the given memory pressure level. Higher levels release
+         * everything that lower levels release. Unlike clearAllCaches, the visible tiles are kept
+         * at all levels except MEMORY_PRESSURE_LEVEL_CRITICAL, so the map stays on screen.
+         * This method should be called from the platform low memory notifications.
+         * @param level The memory pressure level.
+         */
+        void releaseMemory(MemoryPressureLevel::MemoryPressureLevel level);
     
     private:
-        std::shared_ptr<CancelableThreadPool> _envelopeThreadPool;
-        std::shared_ptr<CancelableThreadPool> _tileThreadPool;
+        std::shared_ptr<MapEngine> _engine;
         std::shared_ptr<Options> _options;
         std::shared_ptr<Layers> _layers;
         std::shared_ptr<MapRenderer> _mapRenderer;
@@ -0,0 +1,147 @@
+#include "CameraPathBenchmark.h"
+#include "components/Exceptions.h"
+#include "graphics/utils/GLContext.h"
+#include "ui/BaseMapView.h"
+#include "ui/OffscreenMapRenderer.h"
+#include "utils/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace carto {
+
+    CameraPathBenchmark::CameraPathBenchmark(const std::shared_ptr<OffscreenMapRenderer>& renderer) :
+        _renderer(renderer),
+        _keyframes(),
+        _frameTimes(),
+        _viewCompleteTimes(),
+        _totalTime(0),
+        _mutex()
+    {
+        if (!renderer) {
+            throw NullArgumentException("Null renderer");
+        }
+    }
+
+    CameraPathBenchmark::~CameraPathBenchmark() {
+    }
+
+    void CameraPathBenchmark::addKeyframe(const MapPos& focusPos, float zoom, float rotation, float tilt, int transitionFrames) {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        Keyframe keyframe;
+        keyframe.focusPos = focusPos;
+        keyframe.zoom = zoom;
+        keyframe.rotation = rotation;
+        keyframe.tilt = tilt;
+        keyframe.transitionFrames = std::max(0, transitionFrames);
+        _keyframes.push_back(keyframe);
+    }
+
+    void CameraPathBenchmark::clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        _keyframes.clear();
+        _frameTimes.clear();
+        _viewCompleteTimes.clear();
+        _totalTime = 0;
+    }
+
+    void CameraPathBenchmark::run(float viewTimeoutSeconds) {
+        std::vector<Keyframe> keyframes;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            keyframes = _keyframes;
+        }
+
+        std::vector<float> frameTimes;
+        std::vector<float> viewCompleteTimes;
+        auto runStartTime = std::chrono::steady_clock::now();
+
+        _renderer->initGraphicsResources();
+        const std::shared_ptr<BaseMapView>& mapView = _renderer->_mapView;
+        for (std::size_t i = 0; i < keyframes.size(); i++) {
+            const Keyframe& keyframe = keyframes[i];
+
+            // Transition from the previous keyframe. The view is not waited for, tiles are loaded while moving
+            if (i > 0) {
+                const Keyframe& prevKeyframe = keyframes[i - 1];
+                float deltaRotation = std::fmod(keyframe.rotation - prevKeyframe.rotation + 540.0f, 360.0f) - 180.0f;
+                for (int frame = 1; frame < keyframe.transitionFrames; frame++) {
+                    float t = static_cast<float>(frame) / keyframe.transitionFrames;
+                    MapPos focusPos(prevKeyframe.focusPos.getX() + (keyframe.focusPos.getX() - prevKeyframe.focusPos.getX()) * t, prevKeyframe.focusPos.getY() + (keyframe.focusPos.getY() - prevKeyframe.focusPos.getY()) * t);
+                    mapView->setFocusPos(focusPos, 0);
+                    mapView->setZoom(prevKeyframe.zoom + (keyframe.zoom - prevKeyframe.zoom) * t, 0);
+                    mapView->setRotation(prevKeyframe.rotation + deltaRotation * t, 0);
+                    mapView->setTilt(prevKeyframe.tilt + (keyframe.tilt - prevKeyframe.tilt) * t, 0);
+
+                    // Wait for the GPU, so that the frame time includes the rendering and not just the command submission
+                    auto frameStartTime = std::chrono::steady_clock::now();
+                    _renderer->drawFrame();
+                    glFinish();
+                    frameTimes.push_back(std::chrono::duration_cast<std::chrono::duration<float> >(std::chrono::steady_clock::now() - frameStartTime).count());
+                }
+            }
+
+            // Wait for the view to complete at the keyframe
+            auto viewStartTime = std::chrono::steady_clock::now();
+            _renderer->renderBitmap(keyframe.focusPos, keyframe.zoom, keyframe.rotation, keyframe.tilt, true, viewTimeoutSeconds);
+            viewCompleteTimes.push_back(std::chrono::duration_cast<std::chrono::duration<float> >(std::chrono::steady_clock::now() - viewStartTime).count());
+        }
+
+        float totalTime = std::chrono::duration_cast<std::chrono::duration<float> >(std::chrono::steady_clock::now() - runStartTime).count();
+        std::sort(frameTimes.begin(), frameTimes.end());
+
+        Log::Infof("CameraPathBenchmark::run: %d frames, %d keyframes, %.3f seconds", static_cast<int>(frameTimes.size()), static_cast<int>(viewCompleteTimes.size()), totalTime);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::swap(_frameTimes, frameTimes);
+        std::swap(_viewCompleteTimes, viewCompleteTimes);
+        _totalTime = totalTime;
+    }
+
+    int CameraPathBenchmark::getFrameCount() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return static_cast<int>(_frameTimes.size());
+    }
+
+    float CameraPathBenchmark::getFrameTimePercentile(float percentile) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_frameTimes.empty()) {
+            return 0;
+        }
+
+        // Nearest-rank percentile of the sorted frame times
+        float rank = std::ceil(std::min(100.0f, std::max(0.0f, percentile)) / 100.0f * _frameTimes.size());
+        std::size_t index = static_cast<std::size_t>(std::max(1.0f, rank)) - 1;
+        return _frameTimes[std::min(index, _frameTimes.size() - 1)];
+    }
+
+    float CameraPathBenchmark::getAverageViewCompleteTime() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_viewCompleteTimes.empty()) {
+            return 0;
+        }
+
+        float sum = 0;
+        for (float time : _viewCompleteTimes) {
+            sum += time;
+        }
+        return sum / _viewCompleteTimes.size();
+    }
+
+    float CameraPathBenchmark::getMaxViewCompleteTime() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_viewCompleteTimes.empty()) {
+            return 0;
+        }
+        return *std::max_element(_viewCompleteTimes.begin(), _viewCompleteTimes.end());
+    }
+
+    float CameraPathBenchmark::getTotalTime() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _totalTime;
+    }
+
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_CAMERAPATHBENCHMARK_H_
+#define _CARTO_CAMERAPATHBENCHMARK_H_
+
+#include "core/MapPos.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace carto {
+    class OffscreenMapRenderer;
+
+    /**
+     * Repeatable rendering benchmark that drives an offscreen renderer through a scripted camera path.
+     * The path consists of keyframes. At each keyframe the benchmark waits until the view is complete
+     * (all tiles are loaded), the transitions between the keyframes are drawn with a fixed number of frames,
+     * so the same path produces the same sequence of camera positions on every run.
+     * The benchmark must be run from the thread of the renderer, with the same graphics context.
+     */
+    class CameraPathBenchmark {
+    public:
+        /**
+         * Constructs a new benchmark for the given renderer.
+         * @param renderer The offscreen renderer with the layers to benchmark.
+         * @throws std::invalid_argument If the renderer is null.
+         */
+        explicit CameraPathBenchmark(const std::shared_ptr<OffscreenMapRenderer>& renderer);
+        virtual ~CameraPathBenchmark();
+
+        /**
+         * Adds a keyframe to the end of the camera path.
+         * @param focusPos The focus position in the coordinate system of the base projection.
+         * @param zoom The zoom level.
+         * @param rotation The map rotation in degrees.
+         * @param tilt The tilt angle in degrees.
+         * @param transitionFrames The number of frames used for the transition from the previous keyframe. Ignored for the first keyframe.
+         */
+        void addKeyframe(const MapPos& focusPos, float zoom, float rotation, float tilt, int transitionFrames);
+        /**
+         * Removes all keyframes and the results of the previous run.
+         */
+        void clear();
+
+        /**
+         * Runs the benchmark. The results of the previous run are discarded.
+         * @param viewTimeoutSeconds The maximum time to wait for the view to complete at each keyframe, in seconds.
+         */
+        void run(float viewTimeoutSeconds);
+
+        /**
+         * Returns the number of transition frames drawn during the last run.
+         * @return The number of transition frames.
+         */
+        int getFrameCount() const;
+        /**
+         * Returns the frame time of the transition frames at the given percentile. The frame times include the GPU time.
+         * @param percentile The percentile, between 0 and 100.
+         * @return The frame time in seconds, or 0 if no frames were drawn.
+         */
+        float getFrameTimePercentile(float percentile) const;
+        /**
+         * Returns the average time it took the view to complete at the keyframes.
+         * @return The average time in seconds, or 0 if there were no keyframes.
+         */
+        float getAverageViewCompleteTime() const;
+        /**
+         * Returns the maximum time it took the view to complete at the keyframes.
+         * @return The maximum time in seconds, or 0 if there were no keyframes.
+         */
+        float getMaxViewCompleteTime() const;
+        /**
+         * Returns the total time of the last run.
+         * @return The total time in seconds.
+         */
+        float getTotalTime() const;
+
+    private:
+        struct Keyframe {
+            MapPos focusPos;
+            float zoom;
+            float rotation;
+            float tilt;
+            int transitionFrames;
+        };
+
+        std::shared_ptr<OffscreenMapRenderer> _renderer;
+
+        std::vector<Keyframe> _keyframes;
+
+        std::vector<float> _frameTimes; // sorted after the run
+        std::vector<float> _viewCompleteTimes;
+        float _totalTime;
+
+        mutable std::mutex _mutex;
+    };
+
+}
+
+#endif
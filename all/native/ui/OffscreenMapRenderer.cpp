@@ -0,0 +1,167 @@
+#include "OffscreenMapRenderer.h"
+#include "components/Exceptions.h"
+#include "graphics/Bitmap.h"
+#include "graphics/FrameBuffer.h"
+#include "graphics/FrameBufferManager.h"
+#include "graphics/utils/GLContext.h"
+#include "renderers/MapRenderer.h"
+#include "ui/BaseMapView.h"
+#include "utils/Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace carto {
+
+    OffscreenMapRenderer::OffscreenMapRenderer(int width, int height) :
+        _width(width),
+        _height(height),
+        _mapView(),
+        _redrawListener(),
+        _frameBufferManager(),
+        _frameBuffer(),
+        _surfaceCreated(false),
+        _redrawRequested(false),
+        _redrawCondition(),
+        _mutex()
+    {
+        if (width <= 0 || height <= 0) {
+            throw InvalidArgumentException("Invalid image size");
+        }
+
+        _mapView = std::make_shared<BaseMapView>();
+        _redrawListener = std::make_shared<RedrawListener>(*this);
+        _mapView->setRedrawRequestListener(_redrawListener);
+    }
+
+    OffscreenMapRenderer::~OffscreenMapRenderer() {
+        _mapView->setRedrawRequestListener(std::shared_ptr<RedrawRequestListener>());
+    }
+
+    int OffscreenMapRenderer::getWidth() const {
+        return _width;
+    }
+
+    int OffscreenMapRenderer::getHeight() const {
+        return _height;
+    }
+
+    const std::shared_ptr<Layers>& OffscreenMapRenderer::getLayers() const {
+        return _mapView->getLayers();
+    }
+
+    const std::shared_ptr<Options>& OffscreenMapRenderer::getOptions() const {
+        return _mapView->getOptions();
+    }
+
+    std::shared_ptr<Bitmap> OffscreenMapRenderer::renderBitmap(const MapPos& focusPos, float zoom, float rotation, float tilt, bool waitWhileUpdating, float timeoutSeconds) {
+        initGraphicsResources();
+
+        _mapView->setFocusPos(focusPos, 0);
+        _mapView->setZoom(zoom, 0);
+        _mapView->setRotation(rotation, 0);
+        _mapView->setTilt(tilt, 0);
+
+        auto captureListener = std::make_shared<CaptureListener>();
+        _mapView->getMapRenderer()->captureRendering(captureListener, waitWhileUpdating);
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(static_cast<int>(std::max(0.0f, timeoutSeconds) * 1000));
+        auto frameInterval = std::chrono::milliseconds(static_cast<int>(MIN_FRAME_INTERVAL * 1000));
+        while (true) {
+            auto frameTime = std::chrono::steady_clock::now();
+            drawFrame();
+            if (captureListener->getBitmap()) {
+                break;
+            }
+
+            if (std::chrono::steady_clock::now() >= deadline) {
+                // Capture the current state of the map without waiting for the remaining updates
+                Log::Warn("OffscreenMapRenderer::renderBitmap: Timeout while waiting for the map to update");
+                captureListener = std::make_shared<CaptureListener>();
+                _mapView->getMapRenderer()->captureRendering(captureListener, false);
+                drawFrame();
+                break;
+            }
+
+            // Pending captures request redraws on every frame, limit the frame rate while the tiles are loaded
+            std::this_thread::sleep_until(std::min(deadline, frameTime + frameInterval));
+
+            std::unique_lock<std::mutex> lock(_mutex);
+            _redrawCondition.wait_until(lock, deadline, [this]() { return _redrawRequested; });
+        }
+
+        return captureListener->getBitmap();
+    }
+
+    void OffscreenMapRenderer::releaseGraphicsResources() {
+        if (!_surfaceCreated) {
+            return;
+        }
+
+        _mapView->onSurfaceDestroyed();
+        _frameBuffer.reset();
+        _frameBufferManager->processFrameBuffers();
+        _frameBufferManager.reset();
+        _surfaceCreated = false;
+    }
+
+    void OffscreenMapRenderer::initGraphicsResources() {
+        if (_surfaceCreated) {
+            return;
+        }
+
+        _frameBufferManager = std::make_shared<FrameBufferManager>();
+        _frameBufferManager->setGLThreadId(std::this_thread::get_id());
+        _frameBuffer = _frameBufferManager->createFrameBuffer(_width, _height, true, true, true);
+        _frameBufferManager->processFrameBuffers();
+
+        _mapView->onSurfaceCreated();
+        _mapView->onSurfaceChanged(_width, _height);
+        _surfaceCreated = true;
+    }
+
+    void OffscreenMapRenderer::drawFrame() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _redrawRequested = false;
+        }
+
+        GLint prevBoundFBO = 0;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &prevBoundFBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, _frameBuffer->getFBOId());
+
+        _mapView->onDrawFrame();
+
+        glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(prevBoundFBO));
+
+        GLContext::CheckGLError("OffscreenMapRenderer::drawFrame");
+    }
+
+    OffscreenMapRenderer::RedrawListener::RedrawListener(OffscreenMapRenderer& renderer) :
+        _renderer(renderer)
+    {
+    }
+
+    void OffscreenMapRenderer::RedrawListener::onRedrawRequested() const {
+        std::lock_guard<std::mutex> lock(_renderer._mutex);
+        _renderer._redrawRequested = true;
+        _renderer._redrawCondition.notify_all();
+    }
+
+    OffscreenMapRenderer::CaptureListener::CaptureListener() :
+        _bitmap()
+    {
+    }
+
+    std::shared_ptr<Bitmap> OffscreenMapRenderer::CaptureListener::getBitmap() const {
+        return _bitmap;
+    }
+
+    void OffscreenMapRenderer::CaptureListener::onMapRendered(const std::shared_ptr<Bitmap>& bitmap) {
+        _bitmap = bitmap;
+    }
+
+    const float OffscreenMapRenderer::MIN_FRAME_INTERVAL = 1.0f / 30.0f;
+
+}
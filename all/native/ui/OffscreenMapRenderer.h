@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_OFFSCREENMAPRENDERER_H_
+#define _CARTO_OFFSCREENMAPRENDERER_H_
+
+#include "core/MapPos.h"
+#include "renderers/RedrawRequestListener.h"
+#include "renderers/RendererCaptureListener.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+namespace carto {
+    class BaseMapView;
+    class Bitmap;
+    class FrameBuffer;
+    class FrameBufferManager;
+    class Layers;
+    class Options;
+
+    /**
+     * A map renderer for generating map images without a visible map view, for example for thumbnails.
+     * The map is rendered into an offscreen frame buffer of the graphics context that is current in the
+     * calling thread. The context can be a pbuffer context (for example, created with EGL), it is never
+     * presented. The layers, the loaded tiles and the textures are kept between the renderings,
+     * so consecutive camera positions that share tiles are rendered without loading them again.
+     * All rendering methods must be called from the same thread and with the same graphics context.
+     */
+    class OffscreenMapRenderer {
+    public:
+        /**
+         * Constructs a new offscreen renderer.
+         * @param width The width of the rendered images in pixels.
+         * @param height The height of the rendered images in pixels.
+         * @throws std::invalid_argument If the size is not positive.
+         */
+        OffscreenMapRenderer(int width, int height);
+        virtual ~OffscreenMapRenderer();
+
+        /**
+         * Returns the width of the rendered images.
+         * @return The width of the rendered images in pixels.
+         */
+        int getWidth() const;
+        /**
+         * Returns the height of the rendered images.
+         * @return The height of the rendered images in pixels.
+         */
+        int getHeight() const;
+
+        /**
+         * Returns the Layers object, that can be used for adding and removing map layers.
+         * @return The Layer object.
+         */
+        const std::shared_ptr<Layers>& getLayers() const;
+        /**
+         * Returns the Options object, that can be used for modifying various map options.
+         * @return the Option object.
+         */
+        const std::shared_ptr<Options>& getOptions() const;
+
+        /**
+         * Renders the map with the specified camera parameters into a bitmap.
+         * When waitWhileUpdating is true, frames are drawn until all asynchronous processes are finished
+         * (for example, until all tiles are loaded), but at most for the given timeout.
+         * If the timeout expires, the last state of the map is captured.
+         * @param focusPos The focus position in the coordinate system of the base projection.
+         * @param zoom The zoom level.
+         * @param rotation The map rotation in degrees.
+         * @param tilt The tilt angle in degrees.
+         * @param waitWhileUpdating If true, delay the capture until all asynchronous processes are finished.
+         * @param timeoutSeconds The maximum time to wait for the updates to finish in seconds.
+         * @return The rendered map as a bitmap.
+         */
+        std::shared_ptr<Bitmap> renderBitmap(const MapPos& focusPos, float zoom, float rotation, float tilt, bool waitWhileUpdating, float timeoutSeconds);
+
+        /**
+         * Releases the graphics resources of the renderer. Must be called with the same graphics context
+         * before the context is destroyed. The next rendering call initializes the resources again.
+         */
+        void releaseGraphicsResources();
+
+    private:
+        friend class CameraPathBenchmark;
+
+        class RedrawListener : public RedrawRequestListener {
+        public:
+            explicit RedrawListener(OffscreenMapRenderer& renderer);
+
+            virtual void onRedrawRequested() const;
+
+        private:
+            OffscreenMapRenderer& _renderer;
+        };
+
+        class CaptureListener : public RendererCaptureListener {
+        public:
+            CaptureListener();
+
+            std::shared_ptr<Bitmap> getBitmap() const;
+
+            virtual void onMapRendered(const std::shared_ptr<Bitmap>& bitmap);
+
+        private:
+            std::shared_ptr<Bitmap> _bitmap;
+        };
+
+        void initGraphicsResources();
+        void drawFrame();
+
+        static const float MIN_FRAME_INTERVAL;
+
+        int _width;
+        int _height;
+
+        std::shared_ptr<BaseMapView> _mapView;
+        std::shared_ptr<RedrawListener> _redrawListener;
+
+        std::shared_ptr<FrameBufferManager> _frameBufferManager;
+        std::shared_ptr<FrameBuffer> _frameBuffer;
+        bool _surfaceCreated;
+
+        bool _redrawRequested;
+        mutable std::condition_variable _redrawCondition;
+        mutable std::mutex _mutex;
+    };
+
+}
+
+#endif
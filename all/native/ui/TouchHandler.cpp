@@ -31,6 +31,13 @@ namespace carto {
         _mapMoving(false),
         _noDualPointerYet(true),
         _dualPointerReleaseTime(),
+        _movePending(false),
+        _movePredicted(false),
+        _moveScreenPos1(0, 0),
+        _moveScreenPos2(0, 0),
+        _moveVelocity1(0, 0),
+        _moveVelocity2(0, 0),
+        _moveTime(),
         _mapEventListener(),
         _clickHandlerWorker(std::make_shared<ClickHandlerWorker>(options)),
         _clickHandlerThread(),
@@ -38,6 +45,7 @@ namespace carto {
         _mapRenderer(mapRenderer),
         _mapRendererListener(),
         _mutex(),
+        _eventMutex(),
         _onTouchListeners(),
         _onTouchListenersMutex()
     {
@@ -82,6 +90,34 @@ namespace carto {
             }
         }
 
+        std::lock_guard<std::mutex> eventLock(_eventMutex);
+        if (action == ACTION_MOVE) {
+            // Track pointer velocities for touch prediction
+            std::chrono::steady_clock::time_point moveTime = std::chrono::steady_clock::now();
+            float deltaSeconds = std::chrono::duration_cast<std::chrono::duration<float> >(moveTime - _moveTime).count();
+            if (_moveTime != std::chrono::steady_clock::time_point() && moveTime - _moveTime < TOUCH_PREDICTION_MAX_EVENT_INTERVAL && deltaSeconds > 0) {
+                _moveVelocity1 = cglib::vec2<float>(screenPos1.getX() - _moveScreenPos1.getX(), screenPos1.getY() - _moveScreenPos1.getY()) * (1.0f / deltaSeconds);
+                _moveVelocity2 = cglib::vec2<float>(screenPos2.getX() - _moveScreenPos2.getX(), screenPos2.getY() - _moveScreenPos2.getY()) * (1.0f / deltaSeconds);
+            } else {
+                _moveVelocity1 = cglib::vec2<float>(0, 0);
+                _moveVelocity2 = cglib::vec2<float>(0, 0);
+            }
+            _moveScreenPos1 = screenPos1;
+            _moveScreenPos2 = screenPos2;
+            _moveTime = moveTime;
+
+            // Camera updating gestures are applied right before the next frame is drawn, only the last move event per frame is used
+            if (_gestureMode != SINGLE_POINTER_CLICK_GUESS && _gestureMode != DUAL_POINTER_CLICK_GUESS) {
+                _movePending = true;
+                _mapRenderer->requestRedraw();
+                return;
+            }
+        } else {
+            // Apply the pending move first, so that the events are handled in the original order
+            applyPendingMove(false);
+            _moveTime = std::chrono::steady_clock::time_point();
+        }
+
         ViewState viewState = _mapRenderer->getViewState();
         switch (action) {
         case ACTION_POINTER_1_DOWN:
@@ -115,47 +151,7 @@ namespace carto {
             break;
     
         case ACTION_MOVE:
-            switch (_gestureMode) {
-            case SINGLE_POINTER_CLICK_GUESS:
-                _clickHandlerWorker->pointer1Moved(screenPos1);
-                break;
-            case DUAL_POINTER_CLICK_GUESS:
-                _clickHandlerWorker->pointer1Moved(screenPos1);
-                _clickHandlerWorker->pointer2Moved(screenPos2);
-                break;
-            case SINGLE_POINTER_PAN:
-                {
-                    auto deltaTime = std::chrono::steady_clock::now() - _dualPointerReleaseTime;
-                    if (deltaTime >= DUAL_STOP_HOLD_DURATION) {
-                        singlePointerPan(screenPos1, viewState);
-                    }
-                }
-                break;
-            case SINGLE_POINTER_ZOOM:
-                singlePointerZoom(screenPos1, viewState);
-                break;
-            case DUAL_POINTER_GUESS:
-                dualPointerGuess(screenPos1, screenPos2, viewState);
-                break;
-            case DUAL_POINTER_TILT:
-                dualPointerTilt(screenPos1, viewState);
-                break;
-            case DUAL_POINTER_ROTATE:
-            case DUAL_POINTER_SCALE:
-                if (_options->getPanningMode() == PanningMode::PANNING_MODE_STICKY) {
-                    float factor = calculateRotatingScalingFactor(screenPos1, screenPos2);
-                    if (factor > ROTATION_SCALING_FACTOR_THRESHOLD_STICKY) {
-                        _gestureMode = DUAL_POINTER_ROTATE;
-                    } else if (factor < -ROTATION_SCALING_FACTOR_THRESHOLD_STICKY) {
-                        _gestureMode = DUAL_POINTER_SCALE;
-                    }
-                }
-                dualPointerPan(screenPos1, screenPos2, _gestureMode == DUAL_POINTER_ROTATE, _gestureMode == DUAL_POINTER_SCALE, viewState);
-                break;
-            case DUAL_POINTER_FREE:
-                dualPointerPan(screenPos1, screenPos2, true, true, viewState);
-                break;
-            }
+            pointerMoved(screenPos1, screenPos2, viewState);
             break;
     
         case ACTION_CANCEL: {
@@ -267,6 +263,88 @@ namespace carto {
         }
     }
 
+    void TouchHandler::pointerMoved(const ScreenPos& screenPos1, const ScreenPos& screenPos2, const ViewState& viewState) {
+        switch (_gestureMode) {
+        case SINGLE_POINTER_CLICK_GUESS:
+            _clickHandlerWorker->pointer1Moved(screenPos1);
+            break;
+        case DUAL_POINTER_CLICK_GUESS:
+            _clickHandlerWorker->pointer1Moved(screenPos1);
+            _clickHandlerWorker->pointer2Moved(screenPos2);
+            break;
+        case SINGLE_POINTER_PAN:
+            {
+                auto deltaTime = std::chrono::steady_clock::now() - _dualPointerReleaseTime;
+                if (deltaTime >= DUAL_STOP_HOLD_DURATION) {
+                    singlePointerPan(screenPos1, viewState);
+                }
+            }
+            break;
+        case SINGLE_POINTER_ZOOM:
+            singlePointerZoom(screenPos1, viewState);
+            break;
+        case DUAL_POINTER_GUESS:
+            dualPointerGuess(screenPos1, screenPos2, viewState);
+            break;
+        case DUAL_POINTER_TILT:
+            dualPointerTilt(screenPos1, viewState);
+            break;
+        case DUAL_POINTER_ROTATE:
+        case DUAL_POINTER_SCALE:
+            if (_options->getPanningMode() == PanningMode::PANNING_MODE_STICKY) {
+                float factor = calculateRotatingScalingFactor(screenPos1, screenPos2);
+                if (factor > ROTATION_SCALING_FACTOR_THRESHOLD_STICKY) {
+                    _gestureMode = DUAL_POINTER_ROTATE;
+                } else if (factor < -ROTATION_SCALING_FACTOR_THRESHOLD_STICKY) {
+                    _gestureMode = DUAL_POINTER_SCALE;
+                }
+            }
+            dualPointerPan(screenPos1, screenPos2, _gestureMode == DUAL_POINTER_ROTATE, _gestureMode == DUAL_POINTER_SCALE, viewState);
+            break;
+        case DUAL_POINTER_FREE:
+            dualPointerPan(screenPos1, screenPos2, true, true, viewState);
+            break;
+        }
+    }
+
+    void TouchHandler::applyPendingMove(bool correctPrediction) {
+        if (!_movePending) {
+            // If the last applied positions were predicted and no new events have arrived, move the map back to the actual positions.
+            // This is skipped when other events follow, as the kinetic panning would otherwise use the reversed delta
+            bool correct = _movePredicted && correctPrediction;
+            _movePredicted = false;
+            if (correct) {
+                pointerMoved(_moveScreenPos1, _moveScreenPos2, _mapRenderer->getViewState());
+            }
+            return;
+        }
+
+        ScreenPos screenPos1 = _moveScreenPos1;
+        ScreenPos screenPos2 = _moveScreenPos2;
+        bool predicted = false;
+        if (_options->isTouchPrediction()) {
+            switch (_gestureMode) {
+            case SINGLE_POINTER_PAN:
+            case DUAL_POINTER_ROTATE:
+            case DUAL_POINTER_SCALE:
+            case DUAL_POINTER_FREE:
+                if (cglib::length(_moveVelocity1) > 0 || cglib::length(_moveVelocity2) > 0) {
+                    float predictionSeconds = std::chrono::duration_cast<std::chrono::duration<float> >(TOUCH_PREDICTION_DURATION).count();
+                    screenPos1 = ScreenPos(screenPos1.getX() + _moveVelocity1(0) * predictionSeconds, screenPos1.getY() + _moveVelocity1(1) * predictionSeconds);
+                    screenPos2 = ScreenPos(screenPos2.getX() + _moveVelocity2(0) * predictionSeconds, screenPos2.getY() + _moveVelocity2(1) * predictionSeconds);
+                    predicted = true;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+
+        _movePending = false;
+        _movePredicted = predicted;
+        pointerMoved(screenPos1, screenPos2, _mapRenderer->getViewState());
+    }
+
     void TouchHandler::onWheelEvent(int delta, const ScreenPos& screenPos) {
         if (_options->isUserInput()) {
             _mapRenderer->getAnimationHandler().stopPan();
@@ -598,7 +676,8 @@ namespace carto {
     }
 
     void TouchHandler::handleClick(ClickType::ClickType clickType, const ScreenPos& screenPos) {
-        ViewState viewState = _mapRenderer->getViewState();
+        std::shared_ptr<const ViewState> viewStateSnapshot = _mapRenderer->getCurrentViewStateSnapshot();
+        const ViewState& viewState = *viewStateSnapshot;
         if (!isValidScreenPosition(screenPos, viewState)) {
             return;
         }
@@ -674,6 +753,13 @@ namespace carto {
         }
     }
     
+    void TouchHandler::MapRendererListener::onBeforeDrawFrame() {
+        if (auto touchHandler = _touchHandler.lock()) {
+            std::lock_guard<std::mutex> lock(touchHandler->_eventMutex);
+            touchHandler->applyPendingMove(true);
+        }
+    }
+
     void TouchHandler::MapRendererListener::onMapIdle() {
         if (auto touchHandler = _touchHandler.lock()) {
             {
@@ -714,4 +800,8 @@ namespace carto {
 
     const std::chrono::milliseconds TouchHandler::ZOOM_GESTURE_ANIMATION_DURATION = std::chrono::milliseconds(250);
 
+    const std::chrono::milliseconds TouchHandler::TOUCH_PREDICTION_DURATION = std::chrono::milliseconds(16);
+
+    const std::chrono::milliseconds TouchHandler::TOUCH_PREDICTION_MAX_EVENT_INTERVAL = std::chrono::milliseconds(50);
+
 }
@@ -14,6 +14,7 @@
 
 #include <chrono>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 
@@ -76,6 +77,7 @@ namespace carto {
             
             virtual void onMapChanged();
             virtual void onMapIdle();
+            virtual void onBeforeDrawFrame();
             
         private:
             std::weak_ptr<TouchHandler> _touchHandler;
@@ -83,6 +85,9 @@ namespace carto {
         
         void checkMapStable();
 
+        void pointerMoved(const ScreenPos& screenPos1, const ScreenPos& screenPos2, const ViewState& viewState);
+        void applyPendingMove(bool correctPrediction);
+
         float calculateRotatingScalingFactor(const ScreenPos& screenPos1, const ScreenPos& screenPos2) const;
 
         void singlePointerPan(const ScreenPos& screenPos, const ViewState& viewState);
@@ -133,6 +138,12 @@ namespace carto {
         // Map panning type, 0 = fast, accurate (finger stays exactly in the same
         // place), 1 = slow, inaccurate
         static const float PANNING_FACTOR;
+
+        // Determines how far ahead the pointer positions are extrapolated when touch prediction is enabled
+        static const std::chrono::milliseconds TOUCH_PREDICTION_DURATION;
+
+        // Pointer velocity is not used for prediction if the move events are further apart than this
+        static const std::chrono::milliseconds TOUCH_PREDICTION_MAX_EVENT_INTERVAL;
     
         GestureMode _gestureMode;
         
@@ -146,6 +157,15 @@ namespace carto {
         bool _mapMoving;
         bool _noDualPointerYet;
         std::chrono::steady_clock::time_point _dualPointerReleaseTime;
+
+        // Move events are coalesced and applied once per frame
+        bool _movePending;
+        bool _movePredicted;
+        ScreenPos _moveScreenPos1;
+        ScreenPos _moveScreenPos2;
+        cglib::vec2<float> _moveVelocity1;
+        cglib::vec2<float> _moveVelocity2;
+        std::chrono::steady_clock::time_point _moveTime;
     
         ThreadSafeDirectorPtr<MapEventListener> _mapEventListener;
         
@@ -157,6 +177,7 @@ namespace carto {
         std::shared_ptr<MapRendererListener> _mapRendererListener;
     
         mutable std::mutex _mutex;
+        mutable std::mutex _eventMutex;
 
         std::vector<std::shared_ptr<OnTouchListener> > _onTouchListeners;
         mutable std::mutex _onTouchListenersMutex;
@@ -202,6 +202,7 @@ namespace carto {
 
     void ClickHandlerWorker::run() {
         ThreadUtils::SetThreadPriority(ThreadPriority::LOW);
+        ThreadUtils::SetThreadQoSClass(ThreadQoSClass::USER_INITIATED);
 
         while (true) {
             // If not running, wait until notified or exit thread if interrupted
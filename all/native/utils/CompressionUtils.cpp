@@ -0,0 +1,48 @@
+#include "CompressionUtils.h"
+
+#include <zlib.h>
+
+namespace carto {
+
+    bool CompressionUtils::IsCompressedData(const unsigned char* data, std::size_t size) {
+        if (size >= 2 && data[0] == 0x1f && data[1] == 0x8b) {
+            return true; // gzip
+        }
+        if (size >= 2 && (data[0] & 0x0f) == Z_DEFLATED && ((data[0] << 8) | data[1]) % 31 == 0) {
+            return true; // zlib
+        }
+        if (size >= 4 && data[0] == 0x89 && data[1] == 'P' && data[2] == 'N' && data[3] == 'G') {
+            return true;
+        }
+        if (size >= 3 && data[0] == 0xff && data[1] == 0xd8 && data[2] == 0xff) {
+            return true; // JPEG
+        }
+        if (size >= 12 && data[0] == 'R' && data[1] == 'I' && data[2] == 'F' && data[3] == 'F' && data[8] == 'W' && data[9] == 'E' && data[10] == 'B' && data[11] == 'P') {
+            return true;
+        }
+        return false;
+    }
+
+    bool CompressionUtils::DeflateData(const unsigned char* data, std::size_t size, std::vector<unsigned char>& compressedData) {
+        // Use the fastest compression level, as the data is typically decompressed much more often
+        uLongf compressedSize = compressBound(static_cast<uLong>(size));
+        compressedData.resize(compressedSize);
+        if (compress2(compressedData.data(), &compressedSize, data, static_cast<uLong>(size), Z_BEST_SPEED) != Z_OK) {
+            compressedData.clear();
+            return false;
+        }
+        compressedData.resize(compressedSize);
+        return true;
+    }
+
+    bool CompressionUtils::InflateData(const unsigned char* compressedData, std::size_t compressedSize, std::size_t size, std::vector<unsigned char>& data) {
+        uLongf uncompressedSize = static_cast<uLongf>(size);
+        data.resize(size);
+        if (uncompress(data.data(), &uncompressedSize, compressedData, static_cast<uLong>(compressedSize)) != Z_OK || uncompressedSize != size) {
+            data.clear();
+            return false;
+        }
+        return true;
+    }
+
+}
@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_COMPRESSIONUTILS_H_
+#define _CARTO_COMPRESSIONUTILS_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace carto {
+
+    class CompressionUtils {
+    public:
+        static bool IsCompressedData(const unsigned char* data, std::size_t size);
+
+        static bool DeflateData(const unsigned char* data, std::size_t size, std::vector<unsigned char>& compressedData);
+
+        static bool InflateData(const unsigned char* compressedData, std::size_t compressedSize, std::size_t size, std::vector<unsigned char>& data);
+
+    private:
+        CompressionUtils();
+    };
+    
+}
+
+#endif
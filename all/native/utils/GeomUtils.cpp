@@ -205,6 +205,77 @@ namespace carto {
         return h;
     }
     
+    bool GeomUtils::CalculateControlPointTransform(const std::vector<cglib::vec2<double> >& xys, const std::vector<cglib::vec2<double> >& uvs, cglib::vec2<double>& origin, cglib::mat3x3<double>& invTransform) {
+        std::size_t count = std::min(xys.size(), uvs.size());
+        if (count < 2 || count > 4) {
+            return false;
+        }
+
+        cglib::vec<double, 8> uvCoords = cglib::vec<double, 8>::zero();
+        origin = cglib::vec2<double>::zero();
+        for (std::size_t i = 0; i < count; i++) {
+            uvCoords(i * 2 + 0) = uvs[i](0);
+            uvCoords(i * 2 + 1) = uvs[i](1);
+            origin += xys[i] * (1.0 / count);
+        }
+
+        cglib::mat<double, 8> posTransform = cglib::mat<double, 8>::zero();
+        if (count == 4) {
+            // General case, perspective mapping. Must find 8 unknowns
+            for (int i = 0; i < 8; i++) {
+                int j = (i % 2) * 3;
+                cglib::vec2<double> xy = xys[i / 2] - origin;
+                posTransform(i, j + 0) = xy(0);
+                posTransform(i, j + 1) = xy(1);
+                posTransform(i, j + 2) = 1;
+                posTransform(i, 6) = -uvCoords(i) * xy(0);
+                posTransform(i, 7) = -uvCoords(i) * xy(1);
+            }
+        } else if (count == 3) {
+            // Affine mapping. Must find 6 unknowns
+            for (int i = 0; i < 6; i++) {
+                int j = (i % 2) * 3;
+                cglib::vec2<double> xy = xys[i / 2] - origin;
+                posTransform(i, j + 0) = xy(0);
+                posTransform(i, j + 1) = xy(1);
+                posTransform(i, j + 2) = 1;
+            }
+            posTransform(6, 6) = posTransform(7, 7) = 1;
+        } else {
+            // Conformal mapping. Must find 4 unknowns (rot + scale + transform)
+            for (int n = 0; n < 2; n++) {
+                int i = n * 2;
+                cglib::vec2<double> xy = xys[n] - origin;
+                posTransform(i + 0, 0) = xy(0);
+                posTransform(i + 0, 1) = -xy(1);
+                posTransform(i + 0, 2) = 1;
+                posTransform(i + 1, 0) = xy(1);
+                posTransform(i + 1, 1) = xy(0);
+                posTransform(i + 1, 3) = 1;
+            }
+            posTransform(4, 4) = posTransform(5, 5) = posTransform(6, 6) = posTransform(7, 7) = 1;
+        }
+        if (cglib::determinant(posTransform) == 0) {
+            return false;
+        }
+
+        cglib::vec<double, 8> coeffs = cglib::transform(uvCoords, cglib::inverse(posTransform));
+        invTransform = cglib::mat3x3<double>::identity();
+        if (count == 2) {
+            invTransform(0, 0) = coeffs(0);
+            invTransform(0, 1) = -coeffs(1);
+            invTransform(1, 0) = coeffs(1);
+            invTransform(1, 1) = coeffs(0);
+            invTransform(0, 2) = coeffs(2);
+            invTransform(1, 2) = coeffs(3);
+        } else {
+            for (int i = 0; i < 8; i++) {
+                invTransform(i / 3, i % 3) = coeffs(i);
+            }
+        }
+        return true;
+    }
+
     bool GeomUtils::PointsInsidePolygonEdges(const std::vector<MapPos>& polygon, const std::vector<MapPos>& points) {
         float c = IsConvexPolygonClockwise(polygon) ? -1.0f : 1.0f;
         for (std::size_t i = 0; i < polygon.size(); i++) {
@@ -9,6 +9,9 @@
 
 #include <vector>
 
+#include <cglib/vec.h>
+#include <cglib/mat.h>
+
 namespace carto {
     class MapBounds;
     class MapPos;
@@ -38,6 +41,10 @@ namespace carto {
     
         static std::vector<MapPos> CalculateConvexHull(std::vector<MapPos> points);
 
+        // Calculates the transformation from map coordinates (relative to the centroid of the control points) to pixel coordinates.
+        // With 2 control points the transformation is conformal, with 3 points affine and with 4 points perspective.
+        static bool CalculateControlPointTransform(const std::vector<cglib::vec2<double> >& xys, const std::vector<cglib::vec2<double> >& uvs, cglib::vec2<double>& origin, cglib::mat3x3<double>& invTransform);
+
     private:
         GeomUtils();
 
@@ -41,43 +41,35 @@ namespace carto {
 #endif
 
     bool Log::IsShowError() {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        return _ShowError;
+        return _ShowError.load();
     }
 
     void Log::SetShowError(bool showError) {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        _ShowError = showError;
+        _ShowError.store(showError);
     }
 
     bool Log::IsShowWarn() {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        return _ShowWarn;
+        return _ShowWarn.load();
     }
 
     void Log::SetShowWarn(bool showWarn) {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        _ShowWarn = showWarn;
+        _ShowWarn.store(showWarn);
     }
 
     bool Log::IsShowInfo() {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        return _ShowInfo;
+        return _ShowInfo.load();
     }
 
     void Log::SetShowInfo(bool showInfo) {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        _ShowInfo = showInfo;
+        _ShowInfo.store(showInfo);
     }
 
     bool Log::IsShowDebug() {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        return _ShowDebug;
+        return _ShowDebug.load();
     }
 
     void Log::SetShowDebug(bool showDebug) {
-        std::lock_guard<std::mutex> lock(_Mutex);
-        _ShowDebug = showDebug;
+        _ShowDebug.store(showDebug);
     }
 
     std::string Log::GetTag() {
@@ -96,6 +88,7 @@ namespace carto {
     
     void Log::SetLogEventListener(const std::shared_ptr<LogEventListener>& listener) {
         _LogEventListener.set(listener);
+        _HasLogEventListener.store(static_cast<bool>(listener));
     }
 
     void Log::Fatal(const char* message) {
@@ -111,6 +104,10 @@ namespace carto {
     }
 
     void Log::Error(const char* message) {
+        if (!IsEnabled(_ShowError)) {
+            return;
+        }
+
         DirectorPtr<LogEventListener> logEventListener = _LogEventListener;
         if (logEventListener) {
             if (!logEventListener->onErrorEvent(message)) {
@@ -118,13 +115,17 @@ namespace carto {
             }
         }
 
-        std::lock_guard<std::mutex> lock(_Mutex);
-        if (_ShowError) {
+        if (_ShowError.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(_Mutex);
             OutputLog(LOG_TYPE_ERROR, _Tag, message);
         }
     }
 
     void Log::Warn(const char* message) {
+        if (!IsEnabled(_ShowWarn)) {
+            return;
+        }
+
         DirectorPtr<LogEventListener> logEventListener = _LogEventListener;
         if (logEventListener) {
             if (!logEventListener->onWarnEvent(message)) {
@@ -132,13 +133,17 @@ namespace carto {
             }
         }
 
-        std::lock_guard<std::mutex> lock(_Mutex);
-        if (_ShowWarn) {
+        if (_ShowWarn.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(_Mutex);
             OutputLog(LOG_TYPE_WARNING, _Tag, message);
         }
     }
 
     void Log::Info(const char* message) {
+        if (!IsEnabled(_ShowInfo)) {
+            return;
+        }
+
         DirectorPtr<LogEventListener> logEventListener = _LogEventListener;
         if (logEventListener) {
             if (!logEventListener->onInfoEvent(message)) {
@@ -146,13 +151,17 @@ namespace carto {
             }
         }
 
-        std::lock_guard<std::mutex> lock(_Mutex);
-        if (_ShowInfo) {
+        if (_ShowInfo.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(_Mutex);
             OutputLog(LOG_TYPE_INFO, _Tag, message);
         }
     }
 
     void Log::Debug(const char* message) {
+        if (!IsEnabled(_ShowDebug)) {
+            return;
+        }
+
         DirectorPtr<LogEventListener> logEventListener = _LogEventListener;
         if (logEventListener) {
             if (!logEventListener->onDebugEvent(message)) {
@@ -160,8 +169,8 @@ namespace carto {
             }
         }
 
-        std::lock_guard<std::mutex> lock(_Mutex);
-        if (_ShowDebug) {
+        if (_ShowDebug.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(_Mutex);
             OutputLog(LOG_TYPE_DEBUG, _Tag, message);
         }
     }
@@ -169,14 +178,15 @@ namespace carto {
     Log::Log() {
     }
 
-    bool Log::_ShowError = true;
-    bool Log::_ShowWarn = true;
-    bool Log::_ShowInfo = true;
-    bool Log::_ShowDebug = false;
+    std::atomic<bool> Log::_ShowError(true);
+    std::atomic<bool> Log::_ShowWarn(true);
+    std::atomic<bool> Log::_ShowInfo(true);
+    std::atomic<bool> Log::_ShowDebug(false);
 
     std::string Log::_Tag = "carto-mobile-sdk";
 
     DirectorPtr<LogEventListener> Log::_LogEventListener;
+    std::atomic<bool> Log::_HasLogEventListener(false);
 
     std::mutex Log::_Mutex;
 
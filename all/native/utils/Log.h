@@ -9,6 +9,7 @@
 
 #include "components/DirectorPtr.h"
 
+#include <atomic>
 #include <mutex>
 #include <string>
 #include <memory>
@@ -121,24 +122,36 @@ namespace carto {
 
         template <typename... Args>
         static void Errorf(const char* formatString, const Args&... args) {
+            if (!IsEnabled(_ShowError)) {
+                return;
+            }
             std::string msg = tfm::format(formatString, args...);
             Error(msg.c_str());
         }
 
         template <typename... Args>
         static void Warnf(const char* formatString, const Args&... args) {
+            if (!IsEnabled(_ShowWarn)) {
+                return;
+            }
             std::string msg = tfm::format(formatString, args...);
             Warn(msg.c_str());
         }
 
         template <typename... Args>
         static void Infof(const char* formatString, const Args&... args) {
+            if (!IsEnabled(_ShowInfo)) {
+                return;
+            }
             std::string msg = tfm::format(formatString, args...);
             Info(msg.c_str());
         }
 
         template <typename... Args>
         static void Debugf(const char* formatString, const Args&... args) {
+            if (!IsEnabled(_ShowDebug)) {
+                return;
+            }
             std::string msg = tfm::format(formatString, args...);
             Debug(msg.c_str());
         }
@@ -147,14 +160,20 @@ namespace carto {
     private:
         Log();
 
-        static bool _ShowError;
-        static bool _ShowWarn;
-        static bool _ShowInfo;
-        static bool _ShowDebug;
+        static bool IsEnabled(const std::atomic<bool>& show) {
+            // Messages are formatted only if they are shown or passed to the listener
+            return show.load(std::memory_order_relaxed) || _HasLogEventListener.load(std::memory_order_relaxed);
+        }
+
+        static std::atomic<bool> _ShowError;
+        static std::atomic<bool> _ShowWarn;
+        static std::atomic<bool> _ShowInfo;
+        static std::atomic<bool> _ShowDebug;
 
         static std::string _Tag;
 
         static DirectorPtr<LogEventListener> _LogEventListener;
+        static std::atomic<bool> _HasLogEventListener;
 
         static std::mutex _Mutex;
     };
@@ -29,6 +29,8 @@ namespace carto {
 
         static int GetMaxAgeHTTPHeader(const std::map<std::string, std::string>& headers);
 
+        static std::string GetHTTPHeader(const std::map<std::string, std::string>& headers, const std::string& name);
+
         static std::string URLEncode(const std::string& value);
 
         static std::string URLEncodeMap(const std::multimap<std::string, std::string>& valueMap);
@@ -15,10 +15,37 @@ namespace carto {
         enum ThreadPriority {MINIMUM = 20, LOW = 10, NORMAL = 0, HIGH = -10, MAXIMUM = -20};
     }
 
+    namespace ThreadQoSClass {
+        /**
+         * Quality of service classes of threads, from the least important to the most important.
+         * On heterogeneous (big.LITTLE) CPUs the class also determines the cores the thread is allowed to run on.
+         */
+        enum ThreadQoSClass {
+            /**
+             * Work not visible to the user, like prefetching and package imports. Prefers efficiency cores.
+             */
+            BACKGROUND,
+            /**
+             * Long running work the user is aware of, like tile loading. May run on any core.
+             */
+            UTILITY,
+            /**
+             * Work the user is waiting for, like tile decoding. May run on any core.
+             */
+            USER_INITIATED,
+            /**
+             * Work needed for rendering the next frames, like culling and billboard placement. Prefers performance cores.
+             */
+            USER_INTERACTIVE
+        };
+    }
+
     class ThreadUtils {
     public:
         static void SetThreadPriority(ThreadPriority::ThreadPriority priority);
 
+        static void SetThreadQoSClass(ThreadQoSClass::ThreadQoSClass qosClass);
+
     private:
         ThreadUtils();
     };
@@ -0,0 +1,125 @@
+#include "Tracer.h"
+#include "components/Exceptions.h"
+#include "utils/Log.h"
+
+#include <functional>
+#include <thread>
+
+#include <rapidjson/rapidjson.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
+#include <stdext/utf8_filesystem.h>
+
+namespace carto {
+
+    void Tracer::Start(const std::string& fileName) {
+        Stop();
+
+        std::lock_guard<std::mutex> lock(_Mutex);
+
+        FILE* fpRaw = utf8_filesystem::fopen(fileName.c_str(), "wb");
+        if (!fpRaw) {
+            throw FileException("Failed to create file", fileName);
+        }
+        _File = std::shared_ptr<FILE>(fpRaw, fclose);
+        fputs("[\n", _File.get());
+        _WrittenEventCount = 0;
+        _Events.clear();
+
+        _Enabled.store(true);
+    }
+
+    void Tracer::Stop() {
+        std::lock_guard<std::mutex> lock(_Mutex);
+
+        if (!_File) {
+            return;
+        }
+
+        _Enabled.store(false);
+
+        WriteEvents();
+        fputs("\n]\n", _File.get());
+        if (ferror(_File.get())) {
+            Log::Error("Tracer::Stop: Failed to write trace file");
+        }
+        _File.reset();
+    }
+
+    bool Tracer::IsEnabled() {
+        return _Enabled.load(std::memory_order_relaxed);
+    }
+
+    void Tracer::RecordSpan(const char* name, std::chrono::steady_clock::time_point startTime, std::chrono::steady_clock::time_point endTime, std::vector<std::pair<const char*, std::string> >& args) {
+        Event event;
+        event.name = name;
+        event.startTime = std::chrono::duration_cast<std::chrono::microseconds>(startTime.time_since_epoch()).count();
+        event.duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime).count();
+        event.threadId = std::hash<std::thread::id>()(std::this_thread::get_id());
+        std::swap(event.args, args);
+
+        std::lock_guard<std::mutex> lock(_Mutex);
+
+        // The recording may have been stopped while the span was active
+        if (!_File) {
+            return;
+        }
+
+        _Events.push_back(std::move(event));
+        if (_Events.size() >= MAX_BUFFERED_EVENTS) {
+            WriteEvents();
+        }
+    }
+
+    void Tracer::WriteEvents() {
+        for (const Event& event : _Events) {
+            // Complete events ('X') of a single process, thread ids are truncated to keep them readable in the viewers
+            rapidjson::StringBuffer buffer;
+            rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+            writer.StartObject();
+            writer.Key("name");
+            writer.String(event.name);
+            writer.Key("ph");
+            writer.String("X");
+            writer.Key("ts");
+            writer.Int64(event.startTime);
+            writer.Key("dur");
+            writer.Int64(event.duration);
+            writer.Key("pid");
+            writer.Int(1);
+            writer.Key("tid");
+            writer.Uint(static_cast<unsigned int>(event.threadId & 0xffffff));
+            if (!event.args.empty()) {
+                writer.Key("args");
+                writer.StartObject();
+                for (const std::pair<const char*, std::string>& arg : event.args) {
+                    writer.Key(arg.first);
+                    writer.String(arg.second.c_str(), static_cast<rapidjson::SizeType>(arg.second.size()));
+                }
+                writer.EndObject();
+            }
+            writer.EndObject();
+
+            if (_WrittenEventCount > 0) {
+                fputs(",\n", _File.get());
+            }
+            fwrite(buffer.GetString(), 1, buffer.GetSize(), _File.get());
+            _WrittenEventCount++;
+        }
+        _Events.clear();
+        fflush(_File.get());
+    }
+
+    Tracer::Tracer() {
+    }
+
+    const std::size_t Tracer::MAX_BUFFERED_EVENTS = 1024;
+
+    std::atomic<bool> Tracer::_Enabled(false);
+    std::shared_ptr<FILE> Tracer::_File;
+    std::size_t Tracer::_WrittenEventCount = 0;
+    std::vector<Tracer::Event> Tracer::_Events;
+    std::mutex Tracer::_Mutex;
+
+}
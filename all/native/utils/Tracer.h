@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_TRACER_H_
+#define _CARTO_TRACER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <tinyformat.h>
+
+namespace carto {
+
+    /**
+     * Opt-in recorder of timed events of the SDK threads, for diagnosing performance issues.
+     * The events are written to a file in Chrome trace event JSON format,
+     * that can be opened with chrome://tracing or with the Perfetto UI.
+     */
+    class Tracer {
+    public:
+        /**
+         * Starts recording events into the specified file. If the recording is already active,
+         * the previous recording is stopped first.
+         * @param fileName The name of the trace file to create.
+         * @throws std::ios_base::failure If the file can not be created.
+         */
+        static void Start(const std::string& fileName);
+        /**
+         * Stops recording events and closes the trace file.
+         */
+        static void Stop();
+
+        /**
+         * Returns true if events are currently recorded.
+         * @return True if events are currently recorded.
+         */
+        static bool IsEnabled();
+
+#ifndef SWIG
+        /**
+         * Scoped span of the current thread. The span is recorded when it is destroyed.
+         * The span name and argument keys must be string literals.
+         */
+        class Span {
+        public:
+            explicit Span(const char* name) : _name(name), _active(IsEnabled()), _startTime(), _args() {
+                if (_active) {
+                    _startTime = std::chrono::steady_clock::now();
+                }
+            }
+
+            ~Span() {
+                if (_active) {
+                    RecordSpan(_name, _startTime, std::chrono::steady_clock::now(), _args);
+                }
+            }
+
+            template <typename... Args>
+            void setArg(const char* key, const char* formatString, const Args&... args) {
+                if (_active) {
+                    _args.emplace_back(key, tfm::format(formatString, args...));
+                }
+            }
+
+        private:
+            Span(const Span&);
+            Span& operator = (const Span&);
+
+            const char* _name;
+            bool _active;
+            std::chrono::steady_clock::time_point _startTime;
+            std::vector<std::pair<const char*, std::string> > _args;
+        };
+#endif
+
+    private:
+        struct Event {
+            const char* name;
+            long long startTime;
+            long long duration;
+            std::size_t threadId;
+            std::vector<std::pair<const char*, std::string> > args;
+        };
+
+        Tracer();
+
+        static void RecordSpan(const char* name, std::chrono::steady_clock::time_point startTime, std::chrono::steady_clock::time_point endTime, std::vector<std::pair<const char*, std::string> >& args);
+        static void WriteEvents();
+
+        static const std::size_t MAX_BUFFERED_EVENTS;
+
+        static std::atomic<bool> _Enabled;
+        static std::shared_ptr<FILE> _File;
+        static std::size_t _WrittenEventCount;
+        static std::vector<Event> _Events;
+        static std::mutex _Mutex;
+    };
+
+}
+
+#endif
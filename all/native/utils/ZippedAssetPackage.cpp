@@ -17,7 +17,8 @@ namespace carto {
         _zipData(zipData),
         _baseAssetPackage(),
         _handle(),
-        _assetIndexMap()
+        _assetIndexMap(),
+        _assetCache(ASSET_CACHE_SIZE)
     {
         initialize();
     }
@@ -26,7 +27,8 @@ namespace carto {
         _zipData(zipData),
         _baseAssetPackage(baseAssetPackage),
         _handle(),
-        _assetIndexMap()
+        _assetIndexMap(),
+        _assetCache(ASSET_CACHE_SIZE)
     {
         initialize();
     }
@@ -75,18 +77,31 @@ namespace carto {
             return std::shared_ptr<BinaryData>();
         }
 
+        std::shared_ptr<BinaryData> asset;
+        if (_assetCache.read(it->second, asset)) {
+            return asset;
+        }
+
         mz_zip_archive* zip = static_cast<mz_zip_archive*>(_handle.get());
         if (!zip) {
             return std::shared_ptr<BinaryData>();
         }
-    
-        std::size_t elementSize = 0;
-        std::shared_ptr<unsigned char> elementData(static_cast<unsigned char*>(mz_zip_reader_extract_to_heap(zip, it->second, &elementSize, 0)), mz_free);
-        if (!elementData) {
+
+        // Extract directly into the buffer of the asset, instead of extracting to heap and copying the data
+        mz_zip_archive_file_stat stat;
+        if (!mz_zip_reader_file_stat(zip, it->second, &stat)) {
+            Log::Error("ZippedAssetPackage::loadAsset: Could not read archive asset stats");
+            return std::shared_ptr<BinaryData>();
+        }
+        std::vector<unsigned char> assetData(static_cast<std::size_t>(stat.m_uncomp_size));
+        if (!assetData.empty() && !mz_zip_reader_extract_to_mem(zip, it->second, assetData.data(), assetData.size(), 0)) {
             Log::Error("ZippedAssetPackage::loadAsset: Could not load archive asset");
             return std::shared_ptr<BinaryData>();
         }
-        return std::make_shared<BinaryData>(elementData.get(), elementSize);
+        std::size_t assetSize = assetData.size();
+        asset = std::make_shared<BinaryData>(std::move(assetData));
+        _assetCache.put(it->second, asset, assetSize);
+        return asset;
     }
 
     void ZippedAssetPackage::initialize() {
@@ -119,5 +134,7 @@ namespace carto {
         }
         _handle.reset();
     }
+
+    const std::size_t ZippedAssetPackage::ASSET_CACHE_SIZE = 4 * 1024 * 1024;
     
 }
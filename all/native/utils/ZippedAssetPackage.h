@@ -11,11 +11,14 @@
 
 #include <mutex>
 
+#include <stdext/timed_lru_cache.h>
+
 namespace carto {
 
     /**
      * An asset package based on ZIP archived.
      * Only deflate-based ZIP archives are supported.
+     * Recently loaded assets are cached in their extracted form, so repeated loads of the same asset do not inflate it again.
      */
     class ZippedAssetPackage : public AssetPackage {
     public:
@@ -42,10 +45,13 @@ namespace carto {
         void initialize();
         void deinitialize();
 
+        static const std::size_t ASSET_CACHE_SIZE;
+
         const std::shared_ptr<BinaryData> _zipData;
         const std::shared_ptr<AssetPackage> _baseAssetPackage;
         std::shared_ptr<void> _handle;
         std::map<std::string, unsigned int> _assetIndexMap;
+        mutable cache::timed_lru_cache<unsigned int, std::shared_ptr<BinaryData> > _assetCache;
 
         mutable std::mutex _mutex;
     };
@@ -6,6 +6,7 @@
 #include "graphics/Color.h"
 #include "graphics/Bitmap.h"
 #include "graphics/BitmapCanvas.h"
+#include "graphics/utils/CanvasBitmapCache.h"
 #include "styles/BalloonPopupStyle.h"
 #include "styles/BalloonPopupButtonStyle.h"
 #include "ui/BalloonPopupButtonClickInfo.h"
@@ -16,6 +17,7 @@
 
 #include <cmath>
 #include <algorithm>
+#include <sstream>
 
 namespace carto {
     
@@ -198,10 +200,40 @@ namespace carto {
     std::shared_ptr<Bitmap> BalloonPopup::drawBitmap(const ScreenPos& anchorScreenPos,
                                                      float screenWidth, float screenHeight, float dpToPX) {
         try {
-            std::unique_lock<std::recursive_mutex> lock(_mutex);
+            // Copy the state of the element, the bitmap is rendered without holding the lock
+            std::shared_ptr<BalloonPopupStyle> style;
+            std::string title;
+            std::string desc;
+            std::vector<std::shared_ptr<BalloonPopupButton> > buttons;
+            {
+                std::lock_guard<std::recursive_mutex> lock(_mutex);
+                style = _style;
+                buttons = _buttons;
+
+                // Use actual texts or text fields
+                title = _title;
+                if (title.empty() && !style->getTitleField().empty()) {
+                    Variant value = getMetaDataElement(style->getTitleField());
+                    if (value.getType() == VariantType::VARIANT_TYPE_STRING) {
+                        title = value.getString();
+                    } else {
+                        title = value.toString();
+                    }
+                }
+
+                desc = _desc;
+                if (desc.empty() && !style->getDescriptionField().empty()) {
+                    Variant value = getMetaDataElement(style->getDescriptionField());
+                    if (value.getType() == VariantType::VARIANT_TYPE_STRING) {
+                        desc = value.getString();
+                    } else {
+                        desc = value.toString();
+                    }
+                }
+            }
 
             float pxToDP = 1 / dpToPX;
-            if (_style->isScaleWithDPI()) {
+            if (style->isScaleWithDPI()) {
                 dpToPX = 1;
             } else {
                 pxToDP = 1;
@@ -211,70 +243,49 @@ namespace carto {
             screenWidth *= pxToDP;
             screenHeight *= pxToDP;
         
-            int titleFontSize = _style->getTitleFontSize() * dpToPX;
-            int descFontSize = _style->getDescriptionFontSize() * dpToPX;
-            BalloonPopupMargins titleMargins(_style->getTitleMargins().getLeft() * dpToPX, _style->getTitleMargins().getTop() * dpToPX,
-                                             _style->getTitleMargins().getRight() * dpToPX, _style->getTitleMargins().getBottom() * dpToPX);
-            BalloonPopupMargins descMargins(_style->getDescriptionMargins().getLeft() * dpToPX, _style->getDescriptionMargins().getTop() * dpToPX,
-                                            _style->getDescriptionMargins().getRight() * dpToPX, _style->getDescriptionMargins().getBottom() * dpToPX);
-            BalloonPopupMargins buttonMargins(_style->getButtonMargins().getLeft() * dpToPX, _style->getButtonMargins().getTop() * dpToPX,
-                                              _style->getButtonMargins().getRight() * dpToPX, _style->getButtonMargins().getBottom() * dpToPX);
+            int titleFontSize = style->getTitleFontSize() * dpToPX;
+            int descFontSize = style->getDescriptionFontSize() * dpToPX;
+            BalloonPopupMargins titleMargins(style->getTitleMargins().getLeft() * dpToPX, style->getTitleMargins().getTop() * dpToPX,
+                                             style->getTitleMargins().getRight() * dpToPX, style->getTitleMargins().getBottom() * dpToPX);
+            BalloonPopupMargins descMargins(style->getDescriptionMargins().getLeft() * dpToPX, style->getDescriptionMargins().getTop() * dpToPX,
+                                            style->getDescriptionMargins().getRight() * dpToPX, style->getDescriptionMargins().getBottom() * dpToPX);
+            BalloonPopupMargins buttonMargins(style->getButtonMargins().getLeft() * dpToPX, style->getButtonMargins().getTop() * dpToPX,
+                                              style->getButtonMargins().getRight() * dpToPX, style->getButtonMargins().getBottom() * dpToPX);
         
-            const std::shared_ptr<Bitmap>& leftImage = _style->getLeftImage();
+            const std::shared_ptr<Bitmap>& leftImage = style->getLeftImage();
             int leftImageWidth = 0, leftImageHeight = 0;
             if (leftImage) {
                 leftImageWidth = leftImage->getWidth();
                 leftImageHeight = leftImage->getHeight();
             }
         
-            BalloonPopupMargins leftMargins(_style->getLeftMargins().getLeft() * dpToPX, _style->getLeftMargins().getTop() * dpToPX,
-                                            _style->getLeftMargins().getRight() * dpToPX, _style->getLeftMargins().getBottom() * dpToPX);
+            BalloonPopupMargins leftMargins(style->getLeftMargins().getLeft() * dpToPX, style->getLeftMargins().getTop() * dpToPX,
+                                            style->getLeftMargins().getRight() * dpToPX, style->getLeftMargins().getBottom() * dpToPX);
         
-            const std::shared_ptr<Bitmap>& rightImage = _style->getRightImage();
+            const std::shared_ptr<Bitmap>& rightImage = style->getRightImage();
             int rightImageWidth = 0, rightImageHeight = 0;
             if (rightImage) {
                 rightImageWidth = rightImage->getWidth();
                 rightImageHeight = rightImage->getHeight();
             }
-            BalloonPopupMargins rightMargins(_style->getRightMargins().getLeft() * dpToPX, _style->getRightMargins().getTop() * dpToPX,
-                                             _style->getRightMargins().getRight() * dpToPX, _style->getRightMargins().getBottom() * dpToPX);
+            BalloonPopupMargins rightMargins(style->getRightMargins().getLeft() * dpToPX, style->getRightMargins().getTop() * dpToPX,
+                                             style->getRightMargins().getRight() * dpToPX, style->getRightMargins().getBottom() * dpToPX);
         
-            int triangleWidth = _style->getTriangleWidth() * dpToPX;
-            int triangleHeight = _style->getTriangleHeight() * dpToPX;
+            int triangleWidth = style->getTriangleWidth() * dpToPX;
+            int triangleHeight = style->getTriangleHeight() * dpToPX;
         
-            int strokeWidth = _style->getStrokeWidth() * dpToPX;
+            int strokeWidth = style->getStrokeWidth() * dpToPX;
         
             int screenPadding = SCREEN_PADDING * dpToPX;
 
-            // Clear button bounds
-            _buttonRects.clear();
-        
-            // Use actual texts or text fields
-            std::string title = _title;
-            if (title.empty() && !_style->getTitleField().empty()) {
-                Variant value = getMetaDataElement(_style->getTitleField());
-                if (value.getType() == VariantType::VARIANT_TYPE_STRING) {
-                    title = value.getString();
-                } else {
-                    title = value.toString();
-                }
-            }
-
-            std::string desc = _desc;
-            if (desc.empty() && !_style->getDescriptionField().empty()) {
-                Variant value = getMetaDataElement(_style->getDescriptionField());
-                if (value.getType() == VariantType::VARIANT_TYPE_STRING) {
-                    desc = value.getString();
-                } else {
-                    desc = value.toString();
-                }
-            }
+            // Button bounds are stored once the bitmap is ready
+            std::map<std::shared_ptr<BalloonPopupButton>, ScreenBounds> buttonRects;
 
             // Get colors
-            const Color& backgroundColor = _style->getBackgroundColor();
-            const Color& leftColor = _style->getLeftColor();
-            const Color& rightColor = _style->getRightColor();
-            const Color& strokeColor = _style->getStrokeColor();
+            const Color& backgroundColor = style->getBackgroundColor();
+            const Color& leftColor = style->getLeftColor();
+            const Color& rightColor = style->getRightColor();
+            const Color& strokeColor = style->getStrokeColor();
         
             // Calculate the maximum popup size, adjust with dpi
             int maxPopupWidth = std::min(screenWidth, screenHeight);
@@ -307,15 +318,15 @@ namespace carto {
             ScreenBounds titleSize(ScreenPos(0, 0), ScreenPos(0, 0));
             if (!title.empty()) {
                 BitmapCanvas measureCanvas(0, 0);
-                measureCanvas.setFont(_style->getTitleFontName(), titleFontSize);
-                titleSize = measureCanvas.measureTextSize(title, maxTitleWidth, _style->isTitleWrap());
+                measureCanvas.setFont(style->getTitleFontName(), titleFontSize);
+                titleSize = measureCanvas.measureTextSize(title, maxTitleWidth, style->isTitleWrap());
             }
         
             ScreenBounds descSize(ScreenPos(0, 0), ScreenPos(0, 0));
             if (!desc.empty()) {
                 BitmapCanvas measureCanvas(0, 0);
-                measureCanvas.setFont(_style->getDescriptionFontName(), descFontSize);
-                descSize = measureCanvas.measureTextSize(desc, maxDescWidth, _style->isDescriptionWrap());
+                measureCanvas.setFont(style->getDescriptionFontName(), descFontSize);
+                descSize = measureCanvas.measureTextSize(desc, maxDescWidth, style->isDescriptionWrap());
             }
 
             // Measure button sizes, generate button positions
@@ -324,9 +335,9 @@ namespace carto {
             int buttonMarginWidth = 0;
             int buttonMarginHeight = 0;
             ScreenBounds buttonsSize(ScreenPos(0, 0), ScreenPos(0, 0));
-            if (!_buttons.empty()) {
+            if (!buttons.empty()) {
                 int buttonY = 0;
-                for (const std::shared_ptr<BalloonPopupButton>& button : _buttons) {
+                for (const std::shared_ptr<BalloonPopupButton>& button : buttons) {
                     ScreenBounds buttonSize = measureButtonSize(button, dpToPX);
                     buttonSize.setMin(ScreenPos(buttonSize.getMin().getX() + buttonMargins.getLeft(), buttonSize.getMin().getY() + buttonMargins.getTop() + buttonY));
                     buttonSize.setMax(ScreenPos(buttonSize.getMax().getX() + buttonMargins.getLeft(), buttonSize.getMax().getY() + buttonMargins.getTop() + buttonY));
@@ -356,8 +367,6 @@ namespace carto {
                 return std::shared_ptr<Bitmap>();
             }
         
-            BitmapCanvas canvas(canvasWidth, canvasHeight);
-        
             // Prepare background path
             ScreenBounds backgroundRect(ScreenPos(halfStrokeWidth, halfStrokeWidth),
                                         ScreenPos(popupWidth - halfStrokeWidth, popupHeight - triangleStrokeOffset));
@@ -370,8 +379,36 @@ namespace carto {
                 triangleOffsetX = screenPos.getX() - halfPopupWidth - screenPadding;
             }
         
-            int maxHalfOffsetX = static_cast<int>(halfPopupWidth - halfTriangleWidth - _style->getCornerRadius() - halfStrokeWidth);
+            int maxHalfOffsetX = static_cast<int>(halfPopupWidth - halfTriangleWidth - style->getCornerRadius() - halfStrokeWidth);
             triangleOffsetX = std::min(maxHalfOffsetX, std::max(-maxHalfOffsetX, triangleOffsetX));
+
+            // Popups without buttons are shared by content, style and triangle position. Buttons have per-element state
+            std::string cacheKey;
+            if (buttons.empty()) {
+                std::stringstream keyStream;
+                keyStream << "balloon|" << dpToPX << "|" << canvasWidth << "|" << canvasHeight << "|" << triangleOffsetX;
+                keyStream << "|" << backgroundColor.getARGB() << "|" << leftColor.getARGB() << "|" << rightColor.getARGB() << "|" << strokeColor.getARGB() << "|" << strokeWidth;
+                keyStream << "|" << style->getCornerRadius() << "|" << triangleWidth << "|" << triangleHeight;
+                keyStream << "|" << leftImage.get() << "|" << rightImage.get();
+                for (const BalloonPopupMargins* margins : { &leftMargins, &rightMargins, &titleMargins, &descMargins }) {
+                    keyStream << "|" << margins->getLeft() << "," << margins->getTop() << "," << margins->getRight() << "," << margins->getBottom();
+                }
+                keyStream << "|" << style->getTitleColor().getARGB() << "|" << style->getTitleFontName() << "|" << titleFontSize << "|" << style->isTitleWrap() << "|" << titleSize.getWidth();
+                keyStream << "|" << style->getDescriptionColor().getARGB() << "|" << style->getDescriptionFontName() << "|" << descFontSize << "|" << style->isDescriptionWrap() << "|" << descSize.getWidth();
+                keyStream << "|" << title.size() << "|" << title << "|" << desc;
+                cacheKey = keyStream.str();
+
+                if (std::shared_ptr<Bitmap> bitmap = CanvasBitmapCache::Get(cacheKey)) {
+                    {
+                        std::lock_guard<std::recursive_mutex> lock(_mutex);
+                        _buttonRects.clear();
+                    }
+                    setAnchorPoint(triangleOffsetX / halfPopupWidth, -1);
+                    return bitmap;
+                }
+            }
+
+            BitmapCanvas canvas(canvasWidth, canvasHeight);
         
             // Prepare triangle path
             float triangleOriginX = triangleOffsetX + halfPopupWidth - halfTriangleWidth;
@@ -385,13 +422,13 @@ namespace carto {
             canvas.setDrawMode(BitmapCanvas::STROKE);
             canvas.setColor(strokeColor);
             canvas.setStrokeWidth(strokeWidth);
-            canvas.drawRoundRect(backgroundRect, _style->getCornerRadius());
+            canvas.drawRoundRect(backgroundRect, style->getCornerRadius());
             canvas.drawPolygon(trianglePoints);
         
             // Fill background/2 and triangle
             canvas.setDrawMode(BitmapCanvas::FILL);
             canvas.setColor(backgroundColor);
-            canvas.drawRoundRect(backgroundRect, _style->getCornerRadius());
+            canvas.drawRoundRect(backgroundRect, style->getCornerRadius());
             canvas.drawPolygon(trianglePoints);
         
             if (leftMarginWidth > 0 && leftColor != backgroundColor) {
@@ -400,7 +437,7 @@ namespace carto {
                                       ScreenPos(leftMarginWidth + halfStrokeWidth, popupHeight));
                 canvas.pushClipRect(leftRect);
                 canvas.setColor(leftColor);
-                canvas.drawRoundRect(backgroundRect, _style->getCornerRadius());
+                canvas.drawRoundRect(backgroundRect, style->getCornerRadius());
                 canvas.drawPolygon(trianglePoints);
                 canvas.popClipRect();
             }
@@ -412,7 +449,7 @@ namespace carto {
                                        ScreenPos(popupWidth, popupHeight));
                 canvas.pushClipRect(rightRect);
                 canvas.setColor(rightColor);
-                canvas.drawRoundRect(backgroundRect, _style->getCornerRadius());
+                canvas.drawRoundRect(backgroundRect, style->getCornerRadius());
                 canvas.drawPolygon(trianglePoints);
                 canvas.popClipRect();
             }
@@ -437,36 +474,50 @@ namespace carto {
             if (!title.empty()) {
                 ScreenPos titlePos(halfStrokeWidth + leftMarginWidth + titleMargins.getLeft(),
                                    halfStrokeWidth + titleMargins.getTop());
-                canvas.setColor(_style->getTitleColor());
-                canvas.setFont(_style->getTitleFontName(), titleFontSize);
-                canvas.drawText(title, titlePos, titleSize.getWidth(), _style->isTitleWrap());
+                canvas.setColor(style->getTitleColor());
+                canvas.setFont(style->getTitleFontName(), titleFontSize);
+                canvas.drawText(title, titlePos, titleSize.getWidth(), style->isTitleWrap());
             }
         
             // Draw description
             if (!desc.empty()) {
                 ScreenPos descPos(halfStrokeWidth + leftMarginWidth + descMargins.getLeft(),
                                   halfStrokeWidth + titleSize.getHeight() + titleMarginHeight + descMargins.getTop());
-                canvas.setColor(_style->getDescriptionColor());
-                canvas.setFont(_style->getDescriptionFontName(), descFontSize);
-                canvas.drawText(desc, descPos, descSize.getWidth(), _style->isDescriptionWrap());
+                canvas.setColor(style->getDescriptionColor());
+                canvas.setFont(style->getDescriptionFontName(), descFontSize);
+                canvas.drawText(desc, descPos, descSize.getWidth(), style->isDescriptionWrap());
             }
 
             // Draw buttons, finalize button positions
             float buttonsOriginX = halfStrokeWidth + leftMarginWidth + popupInnerWidth * 0.5f;
             float buttonsOriginY = halfStrokeWidth + titleSize.getHeight() + titleMarginHeight + descSize.getHeight() + descMarginHeight;
-            for (const std::shared_ptr<BalloonPopupButton>& button : _buttons) {
+            for (const std::shared_ptr<BalloonPopupButton>& button : buttons) {
                 const ScreenBounds& buttonSize = buttonSizes[button];
                 ScreenBounds buttonRect(ScreenPos(buttonsOriginX + buttonSize.getMin().getX() - buttonSize.getWidth() * 0.5f, buttonsOriginY + buttonSize.getMin().getY()),
                                         ScreenPos(buttonsOriginX + buttonSize.getMax().getX() - buttonSize.getWidth() * 0.5f, buttonsOriginY + buttonSize.getMax().getY()));
                 drawButtonOnCanvas(button, canvas, buttonRect, dpToPX);
-                _buttonRects[button] = buttonRect;
+                buttonRects[button] = buttonRect;
             }
 
-            // Done with internal state, update anchor point and build bitmap
-            lock.unlock();
+            // Update button bounds and anchor point, build bitmap
+            {
+                std::lock_guard<std::recursive_mutex> lock(_mutex);
+                std::swap(_buttonRects, buttonRects);
+            }
             setAnchorPoint(triangleOffsetX / halfPopupWidth, -1);
 
-            return canvas.buildBitmap();
+            std::shared_ptr<Bitmap> bitmap = canvas.buildBitmap();
+            if (!cacheKey.empty()) {
+                std::vector<std::shared_ptr<Bitmap> > sourceBitmaps;
+                if (leftImage) {
+                    sourceBitmaps.push_back(leftImage);
+                }
+                if (rightImage) {
+                    sourceBitmaps.push_back(rightImage);
+                }
+                CanvasBitmapCache::Put(cacheKey, bitmap, sourceBitmaps);
+            }
+            return bitmap;
         }
         catch (const std::exception& ex) {
             Log::Errorf("BalloonPopup::drawBitmap: Failed to render bitmap: %s", ex.what());
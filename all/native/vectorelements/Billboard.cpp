@@ -29,6 +29,7 @@ namespace carto {
     
             _baseBillboard = baseBillboard;
             _geometry.reset();
+            _trajectory.reset();
         }
         notifyElementChanged();
     }
@@ -73,6 +74,7 @@ namespace carto {
             std::lock_guard<std::recursive_mutex> lock(_mutex);
             _geometry = geometry;
             _baseBillboard.reset();
+            _trajectory.reset();
         }
         notifyElementChanged();
     }
@@ -82,6 +84,26 @@ namespace carto {
             std::lock_guard<std::recursive_mutex> lock(_mutex);
             _geometry = std::make_shared<PointGeometry>(pos);
             _baseBillboard.reset();
+            _trajectory.reset();
+        }
+        notifyElementChanged();
+    }
+
+    void Billboard::setTrajectory(const MapPos& startPos, float startTime, const MapPos& endPos, float endTime) {
+        if (!(endTime >= startTime)) {
+            throw InvalidArgumentException("End time before start time");
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        auto trajectory = std::make_shared<Trajectory>();
+        trajectory->startPos = startPos;
+        trajectory->startTime = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(startTime));
+        trajectory->endTime = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(endTime));
+        {
+            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            _geometry = std::make_shared<PointGeometry>(endPos);
+            _baseBillboard.reset();
+            _trajectory = trajectory;
         }
         notifyElementChanged();
     }
@@ -102,7 +124,8 @@ namespace carto {
     Billboard::Billboard(const std::shared_ptr<Billboard>& baseBillboard) :
         VectorElement(std::shared_ptr<Geometry>()),
         _baseBillboard(baseBillboard),
-        _rotation(0)
+        _rotation(0),
+        _trajectory()
     {
         if (!baseBillboard) {
             throw NullArgumentException("Null baseBillboard");
@@ -112,7 +135,8 @@ namespace carto {
     Billboard::Billboard(const std::shared_ptr<Geometry>& geometry) :
         VectorElement(geometry),
         _baseBillboard(),
-        _rotation(0)
+        _rotation(0),
+        _trajectory()
     {
         if (!geometry) {
             throw NullArgumentException("Null geometry");
@@ -122,10 +146,16 @@ namespace carto {
     Billboard::Billboard(const MapPos& pos) :
         VectorElement(std::make_shared<PointGeometry>(pos)),
         _baseBillboard(),
-        _rotation(0)
+        _rotation(0),
+        _trajectory()
     {
     }
         
+    std::shared_ptr<Billboard::Trajectory> Billboard::getTrajectory() const {
+        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        return _trajectory;
+    }
+        
     std::shared_ptr<BillboardDrawData> Billboard::getDrawData() const {
         std::lock_guard<std::recursive_mutex> lock(_mutex);
         return _drawData;
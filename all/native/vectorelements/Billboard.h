@@ -7,12 +7,14 @@
 #ifndef _CARTO_BILLBOARD_H_
 #define _CARTO_BILLBOARD_H_
 
+#include "core/MapPos.h"
 #include "vectorelements/VectorElement.h"
 
+#include <chrono>
+
 namespace carto {
     class BillboardDrawData;
     class BillboardStyle;
-    class MapPos;
     class VectorLayer;
     
     /**
@@ -67,6 +69,19 @@ namespace carto {
          * @param pos The new map position that defines the location of this billboard.
          */
         void setPos(const MapPos& pos);
+        /**
+         * Moves this billboard along a straight line from the start position to the end position.
+         * The position is interpolated by the renderer on each frame, so the billboard moves smoothly
+         * without further updates. Before the start time the billboard is drawn at the start position
+         * and after the end time at the end position. The location of the billboard is set to the end position.
+         * Setting a new location stops the movement. If this billboard is attached to another billboard, it will first be detached.
+         * @param startPos The map position at the start time.
+         * @param startTime The start time of the movement in seconds, relative to the current time. Can be negative if the movement has already started.
+         * @param endPos The map position at the end time.
+         * @param endTime The end time of the movement in seconds, relative to the current time.
+         * @throws std::invalid_argument If the end time is before the start time.
+         */
+        void setTrajectory(const MapPos& startPos, float startTime, const MapPos& endPos, float endTime);
     
         /**
          * Returns the rotation angle of this billboard.
@@ -87,6 +102,7 @@ namespace carto {
         void setDrawData(const std::shared_ptr<BillboardDrawData>& drawData);
 
     protected:
+        friend class BillboardDrawData;
         friend class BillboardPlacementWorker;
         friend class BillboardRenderer;
         friend class BillboardSorter;
@@ -98,11 +114,21 @@ namespace carto {
         Billboard(const MapPos& pos);
         
     private:
+        struct Trajectory {
+            MapPos startPos;
+            std::chrono::steady_clock::time_point startTime;
+            std::chrono::steady_clock::time_point endTime;
+        };
+
+        std::shared_ptr<Trajectory> getTrajectory() const;
+
         std::shared_ptr<Billboard> _baseBillboard;
         
         std::shared_ptr<BillboardDrawData> _drawData;
     
         float _rotation;
+
+        std::shared_ptr<Trajectory> _trajectory;
     };
     
 }
@@ -2,12 +2,14 @@
 #include "components/Exceptions.h"
 #include "graphics/Bitmap.h"
 #include "graphics/BitmapCanvas.h"
+#include "graphics/utils/CanvasBitmapCache.h"
 #include "styles/TextStyle.h"
 #include "utils/Const.h"
 #include "utils/Log.h"
 
 #include <cstdlib>
 #include <cmath>
+#include <sstream>
 
 namespace carto {
     
@@ -37,39 +39,58 @@ namespace carto {
         
     std::shared_ptr<Bitmap> Text::drawBitmap(float dpToPX) const {
         try {
-            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            // Copy the state of the element, the bitmap is rendered without holding the lock
+            std::shared_ptr<TextStyle> style;
+            std::string text;
+            {
+                std::lock_guard<std::recursive_mutex> lock(_mutex);
+                style = _style;
+
+                // Use actual text or text field
+                text = _text;
+                if (text.empty() && !style->getTextField().empty()) {
+                    Variant value = getMetaDataElement(style->getTextField());
+                    if (value.getType() == VariantType::VARIANT_TYPE_STRING) {
+                        text = value.getString();
+                    } else {
+                        text = value.toString();
+                    }
+                }
+            }
 
             // Scale with DPI, if necessary
-            if (_style->isScaleWithDPI()) {
+            if (style->isScaleWithDPI()) {
                 dpToPX = 1;
             }
 
             // Multiply with rendering scale
-            dpToPX *= _style->getRenderScale();
-        
-            // Use actual text or text field
-            std::string text = _text;
-            if (text.empty() && !_style->getTextField().empty()) {
-                Variant value = getMetaDataElement(_style->getTextField());
-                if (value.getType() == VariantType::VARIANT_TYPE_STRING) {
-                    text = value.getString();
-                } else {
-                    text = value.toString();
-                }
+            dpToPX *= style->getRenderScale();
+
+            // Labels with the same text and style share the bitmap
+            std::stringstream keyStream;
+            keyStream << "text|" << dpToPX << "|" << style->getFontName() << "|" << style->getFontSize() << "|" << style->isBreakLines();
+            keyStream << "|" << style->getFontColor().getARGB() << "|" << style->getStrokeColor().getARGB() << "|" << style->getStrokeWidth();
+            keyStream << "|" << style->getBorderColor().getARGB() << "|" << style->getBorderWidth() << "|" << style->getBackgroundColor().getARGB();
+            const TextMargins& textMargins = style->getTextMargins();
+            keyStream << "|" << textMargins.getLeft() << "|" << textMargins.getTop() << "|" << textMargins.getRight() << "|" << textMargins.getBottom();
+            keyStream << "|" << text;
+            std::string cacheKey = keyStream.str();
+            if (std::shared_ptr<Bitmap> bitmap = CanvasBitmapCache::Get(cacheKey)) {
+                return bitmap;
             }
 
-            float fontSize = _style->getFontSize() * dpToPX;
-            float strokeWidth = _style->getStrokeWidth() * dpToPX;
-            float borderWidth = _style->getBorderWidth() * dpToPX;
-            float leftPadding = _style->getTextMargins().getLeft() * dpToPX;
-            float rightPadding = _style->getTextMargins().getRight() * dpToPX;
-            float topPadding = _style->getTextMargins().getTop() * dpToPX;
-            float bottomPadding = _style->getTextMargins().getBottom() * dpToPX;
+            float fontSize = style->getFontSize() * dpToPX;
+            float strokeWidth = style->getStrokeWidth() * dpToPX;
+            float borderWidth = style->getBorderWidth() * dpToPX;
+            float leftPadding = style->getTextMargins().getLeft() * dpToPX;
+            float rightPadding = style->getTextMargins().getRight() * dpToPX;
+            float topPadding = style->getTextMargins().getTop() * dpToPX;
+            float bottomPadding = style->getTextMargins().getBottom() * dpToPX;
             float borderPadding = (borderWidth > 0 ? 1 : 0);
 
             BitmapCanvas measureCanvas(0, 0);
-            measureCanvas.setFont(_style->getFontName(), fontSize);
-            ScreenBounds textBounds = measureCanvas.measureTextSize(text, -1, _style->isBreakLines());
+            measureCanvas.setFont(style->getFontName(), fontSize);
+            ScreenBounds textBounds = measureCanvas.measureTextSize(text, -1, style->isBreakLines());
 
             int canvasWidth = static_cast<int>(std::ceil(textBounds.getWidth() + strokeWidth + leftPadding + rightPadding + 2 * borderWidth + 2 * borderPadding));
             int canvasHeight = static_cast<int>(std::ceil(textBounds.getHeight() + strokeWidth + topPadding + bottomPadding + 2 * borderWidth + 2 * borderPadding));
@@ -79,33 +100,35 @@ namespace carto {
             }
 
             BitmapCanvas canvas(canvasWidth, canvasHeight);
-            canvas.setFont(_style->getFontName(), fontSize);
+            canvas.setFont(style->getFontName(), fontSize);
 
-            if (_style->getBackgroundColor() != Color()) {
-                canvas.setColor(_style->getBackgroundColor());
+            if (style->getBackgroundColor() != Color()) {
+                canvas.setColor(style->getBackgroundColor());
                 canvas.setDrawMode(BitmapCanvas::FILL);
                 canvas.drawRoundRect(ScreenBounds(ScreenPos(borderPadding, borderPadding), ScreenPos(canvasWidth - borderPadding, canvasHeight - borderPadding)), 0);
             }
 
-            if (borderWidth > 0 && _style->getBorderColor() != Color()) {
-                canvas.setColor(_style->getBorderColor());
+            if (borderWidth > 0 && style->getBorderColor() != Color()) {
+                canvas.setColor(style->getBorderColor());
                 canvas.setDrawMode(BitmapCanvas::STROKE);
                 canvas.setStrokeWidth(borderWidth);
                 canvas.drawRoundRect(ScreenBounds(ScreenPos(0.5f * borderWidth + borderPadding, 0.5f * borderWidth + borderPadding), ScreenPos(canvasWidth - borderPadding - 0.5f * borderWidth, canvasHeight - borderPadding - 0.5f * borderWidth)), 0);
             }
 
             if (strokeWidth > 0) {
-                canvas.setColor(_style->getStrokeColor());
+                canvas.setColor(style->getStrokeColor());
                 canvas.setDrawMode(BitmapCanvas::STROKE);
                 canvas.setStrokeWidth(strokeWidth);
-                canvas.drawText(text, ScreenPos(borderPadding + borderWidth + leftPadding + strokeWidth * 0.5f, borderPadding + borderWidth + topPadding + strokeWidth * 0.5f), textBounds.getWidth(), _style->isBreakLines());
+                canvas.drawText(text, ScreenPos(borderPadding + borderWidth + leftPadding + strokeWidth * 0.5f, borderPadding + borderWidth + topPadding + strokeWidth * 0.5f), textBounds.getWidth(), style->isBreakLines());
             }
 
-            canvas.setColor(_style->getFontColor());
+            canvas.setColor(style->getFontColor());
             canvas.setDrawMode(BitmapCanvas::FILL);
-            canvas.drawText(text, ScreenPos(borderPadding + borderWidth + leftPadding + strokeWidth * 0.5f, borderPadding + borderWidth + topPadding + strokeWidth * 0.5f), textBounds.getWidth(), _style->isBreakLines());
+            canvas.drawText(text, ScreenPos(borderPadding + borderWidth + leftPadding + strokeWidth * 0.5f, borderPadding + borderWidth + topPadding + strokeWidth * 0.5f), textBounds.getWidth(), style->isBreakLines());
 
-            return canvas.buildBitmap();
+            std::shared_ptr<Bitmap> bitmap = canvas.buildBitmap();
+            CanvasBitmapCache::Put(cacheKey, bitmap, std::vector<std::shared_ptr<Bitmap> >());
+            return bitmap;
         }
         catch (const std::exception& ex) {
             Log::Errorf("Text::drawBitmap: Failed to render bitmap: %s", ex.what());
@@ -19,8 +19,11 @@
 #include "vectortiles/utils/MapnikVTLogger.h"
 #include "vectortiles/utils/GeometryConverter.h"
 #include "vectortiles/utils/ValueConverter.h"
+#include "vectortiles/utils/FeatureDataQueryContext.h"
 #include "vectortiles/utils/VTBitmapLoader.h"
 #include "vectortiles/utils/CartoCSSAssetLoader.h"
+#include "vectortiles/utils/StyleMapCache.h"
+#include "vectortiles/utils/SymbolizerContextCache.h"
 #include "utils/AssetPackage.h"
 #include "utils/FileUtils.h"
 #include "utils/Const.h"
@@ -148,18 +151,7 @@ namespace carto {
         }
 
         try {
-            std::shared_ptr<mvt::MBVTFeatureDecoder> decoder;
-            {
-                std::unique_lock<std::mutex> lock(_mutex);
-                if (_cachedFeatureDecoder.first != tileData) {
-                    lock.unlock();
-                    decoder = std::make_shared<mvt::MBVTFeatureDecoder>(*tileData->getDataPtr(), _logger);
-                    lock.lock();
-                    _cachedFeatureDecoder = std::make_pair(tileData, decoder);
-                } else {
-                    decoder = _cachedFeatureDecoder.second;
-                }
-            }
+            std::shared_ptr<mvt::MBVTFeatureDecoder> decoder = getFeatureDecoder(tileData);
 
             std::string mvtLayerName;
             mvt::Feature mvtFeature;
@@ -195,6 +187,10 @@ namespace carto {
     }
 
     std::shared_ptr<VectorTileFeatureCollection> CartoVectorTileDecoder::decodeFeatures(const vt::TileId& tile, const std::shared_ptr<BinaryData>& tileData, const MapBounds& tileBounds) const {
+        return decodeFeatures(tile, tileData, tileBounds, FeatureFilter());
+    }
+
+    std::shared_ptr<VectorTileFeatureCollection> CartoVectorTileDecoder::decodeFeatures(const vt::TileId& tile, const std::shared_ptr<BinaryData>& tileData, const MapBounds& tileBounds, const FeatureFilter& filter) const {
         if (!tileData) {
             Log::Warn("CartoVectorTileDecoder::decodeFeatures: Null tile data");
             return std::shared_ptr<VectorTileFeatureCollection>();
@@ -202,28 +198,23 @@ namespace carto {
 
         std::vector<std::shared_ptr<VectorTileFeature> > tileFeatures;
         try {
-            std::shared_ptr<mvt::MBVTFeatureDecoder> decoder;
-            {
-                std::unique_lock<std::mutex> lock(_mutex);
-                if (_cachedFeatureDecoder.first != tileData) {
-                    lock.unlock();
-                    decoder = std::make_shared<mvt::MBVTFeatureDecoder>(*tileData->getDataPtr(), _logger);
-                    lock.lock();
-                    _cachedFeatureDecoder = std::make_pair(tileData, decoder);
-                } else {
-                    decoder = _cachedFeatureDecoder.second;
-                }
-            }
+            std::shared_ptr<mvt::MBVTFeatureDecoder> decoder = getFeatureDecoder(tileData);
 
             for (const std::string& mvtLayerName : decoder->getLayerNames()) {
                 for (std::shared_ptr<mvt::FeatureDecoder::FeatureIterator> mvtIt = decoder->createLayerFeatureIterator(mvtLayerName); mvtIt->valid(); mvtIt->advance()) {
+                    // Test the raw feature attributes first, geometry and the attribute map are decoded only for the accepted features
+                    std::shared_ptr<const mvt::FeatureData> mvtFeatureData = mvtIt->getFeatureData();
+                    if (filter && !filter(mvtLayerName, FeatureDataQueryContext(mvtFeatureData))) {
+                        continue;
+                    }
+
                     std::shared_ptr<const mvt::Geometry> mvtGeometry = mvtIt->getGeometry();
                     if (!mvtGeometry) {
                         continue;
                     }
 
                     std::map<std::string, Variant> featureData;
-                    if (std::shared_ptr<const mvt::FeatureData> mvtFeatureData = mvtIt->getFeatureData()) {
+                    if (mvtFeatureData) {
                         for (const std::string& varName : mvtFeatureData->getVariableNames()) {
                             mvt::Value mvtValue;
                             if (mvtFeatureData->getVariable(varName, mvtValue)) {
@@ -311,6 +302,27 @@ namespace carto {
         return std::shared_ptr<TileMap>();
     }
 
+    std::shared_ptr<mvt::MBVTFeatureDecoder> CartoVectorTileDecoder::getFeatureDecoder(const std::shared_ptr<BinaryData>& tileData) const {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (auto it = _cachedFeatureDecoders.begin(); it != _cachedFeatureDecoders.end(); it++) {
+                if (it->first == tileData) {
+                    _cachedFeatureDecoders.splice(_cachedFeatureDecoders.begin(), _cachedFeatureDecoders, it);
+                    return it->second;
+                }
+            }
+        }
+
+        auto decoder = std::make_shared<mvt::MBVTFeatureDecoder>(*tileData->getDataPtr(), _logger);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _cachedFeatureDecoders.emplace_front(tileData, decoder);
+        while (_cachedFeatureDecoders.size() > MAX_CACHED_FEATURE_DECODERS) {
+            _cachedFeatureDecoders.pop_back();
+        }
+        return decoder;
+    }
+
     void CartoVectorTileDecoder::updateLayerStyleSet(const std::string& layerId, const std::shared_ptr<CartoCSSStyleSet>& styleSet) {
         if (!styleSet) {
             throw NullArgumentException("Null styleset");
@@ -323,43 +335,53 @@ namespace carto {
         }
         std::shared_ptr<mvt::SymbolizerContext>& symbolizerContext = _assetPackageSymbolizerContexts[assetPackage];
         if (!symbolizerContext) {
-            auto fontManager = std::make_shared<vt::FontManager>(GLYPHMAP_SIZE, GLYPHMAP_SIZE);
-            auto bitmapLoader = std::make_shared<VTBitmapLoader>("", assetPackage);
-            auto bitmapManager = std::make_shared<vt::BitmapManager>(bitmapLoader);
-            auto strokeMap = std::make_shared<vt::StrokeMap>(STROKEMAP_SIZE, STROKEMAP_SIZE);
-            auto glyphMap = std::make_shared<vt::GlyphMap>(GLYPHMAP_SIZE, GLYPHMAP_SIZE);
-
-            std::shared_ptr<vt::Font> fallbackFont;
-            for (auto it = _fallbackFonts.rbegin(); it != _fallbackFonts.rend(); it++) {
-                std::shared_ptr<BinaryData> fontData = *it;
-                std::string fontName = fontManager->loadFontData(*fontData->getDataPtr());
-                fallbackFont = fontManager->getFont(fontName, fallbackFont);
-            }
-            mvt::SymbolizerContext::Settings settings(DEFAULT_TILE_SIZE, std::map<std::string, mvt::Value>(), fallbackFont);
-            symbolizerContext = std::make_shared<mvt::SymbolizerContext>(bitmapManager, fontManager, strokeMap, glyphMap, settings);
-
-            if (assetPackage) {
-                std::string fontPrefix = FileUtils::NormalizePath("fonts/");
-
-                for (const std::string& assetName : assetPackage->getAssetNames()) {
-                    if (assetName.size() > fontPrefix.size() && assetName.substr(0, fontPrefix.size()) == fontPrefix) {
-                        if (std::shared_ptr<BinaryData> fontData = assetPackage->loadAsset(assetName)) {
-                            fontManager->loadFontData(*fontData->getDataPtr());
+            // Share the loaded fonts and rasterized glyphs with the other decoders using the same assets
+            std::string fontPrefix = FileUtils::NormalizePath("fonts/");
+            std::string contextKey = "|" + fontPrefix;
+            symbolizerContext = SymbolizerContextCache::Get(contextKey, assetPackage, _fallbackFonts);
+            if (!symbolizerContext) {
+                auto fontManager = std::make_shared<vt::FontManager>(GLYPHMAP_SIZE, GLYPHMAP_SIZE);
+                auto bitmapLoader = std::make_shared<VTBitmapLoader>("", assetPackage);
+                auto bitmapManager = std::make_shared<vt::BitmapManager>(bitmapLoader);
+                auto strokeMap = std::make_shared<vt::StrokeMap>(STROKEMAP_SIZE, STROKEMAP_SIZE);
+                auto glyphMap = std::make_shared<vt::GlyphMap>(GLYPHMAP_SIZE, GLYPHMAP_SIZE);
+
+                std::shared_ptr<vt::Font> fallbackFont;
+                for (auto it = _fallbackFonts.rbegin(); it != _fallbackFonts.rend(); it++) {
+                    std::shared_ptr<BinaryData> fontData = *it;
+                    std::string fontName = fontManager->loadFontData(*fontData->getDataPtr());
+                    fallbackFont = fontManager->getFont(fontName, fallbackFont);
+                }
+                mvt::SymbolizerContext::Settings settings(DEFAULT_TILE_SIZE, std::map<std::string, mvt::Value>(), fallbackFont);
+                symbolizerContext = std::make_shared<mvt::SymbolizerContext>(bitmapManager, fontManager, strokeMap, glyphMap, settings);
+
+                if (assetPackage) {
+                    for (const std::string& assetName : assetPackage->getAssetNames()) {
+                        if (assetName.size() > fontPrefix.size() && assetName.substr(0, fontPrefix.size()) == fontPrefix) {
+                            if (std::shared_ptr<BinaryData> fontData = assetPackage->loadAsset(assetName)) {
+                                fontManager->loadFontData(*fontData->getDataPtr());
+                            }
                         }
                     }
                 }
+
+                SymbolizerContextCache::Put(contextKey, assetPackage, _fallbackFonts, symbolizerContext);
             }
         }
 
-        std::shared_ptr<mvt::Map> map;
-        try {
-            auto assetLoader = std::make_shared<CartoCSSAssetLoader>("", assetPackage);
-            css::CartoCSSMapLoader mapLoader(assetLoader, _logger);
-            mapLoader.setIgnoreLayerPredicates(true);
-            map = mapLoader.loadMap(styleSet->getCartoCSS());
-        }
-        catch (const std::exception& ex) {
-            throw ParseException(std::string("CartoCSS style parsing failed: ") + ex.what(), styleSet->getCartoCSS());
+        std::string styleKey = "cartocss:1:" + styleSet->getCartoCSS();
+        std::shared_ptr<mvt::Map> map = StyleMapCache::Get(styleKey, assetPackage);
+        if (!map) {
+            try {
+                auto assetLoader = std::make_shared<CartoCSSAssetLoader>("", assetPackage);
+                css::CartoCSSMapLoader mapLoader(assetLoader, _logger);
+                mapLoader.setIgnoreLayerPredicates(true);
+                map = mapLoader.loadMap(styleSet->getCartoCSS());
+            }
+            catch (const std::exception& ex) {
+                throw ParseException(std::string("CartoCSS style parsing failed: ") + ex.what(), styleSet->getCartoCSS());
+            }
+            StyleMapCache::Put(styleKey, assetPackage, map);
         }
 
         if (!_layerIds.empty() && _layerIds.front() == layerId) {
@@ -375,4 +397,6 @@ namespace carto {
     const int CartoVectorTileDecoder::STROKEMAP_SIZE = 512;
     const int CartoVectorTileDecoder::GLYPHMAP_SIZE = 2048;
     const std::size_t CartoVectorTileDecoder::MAX_ASSETPACKAGE_SYMBOLIZER_CONTEXTS = 4;
+
+    const std::size_t CartoVectorTileDecoder::MAX_CACHED_FEATURE_DECODERS = 8;
 }
@@ -10,6 +10,7 @@
 #include "vectortiles/VectorTileDecoder.h"
 
 #include <memory>
+#include <list>
 #include <mutex>
 #include <set>
 #include <map>
@@ -89,16 +90,20 @@ namespace carto {
         virtual std::shared_ptr<VectorTileFeature> decodeFeature(long long id, const vt::TileId& tile, const std::shared_ptr<BinaryData>& tileData, const MapBounds& tileBounds) const;
 
         virtual std::shared_ptr<VectorTileFeatureCollection> decodeFeatures(const vt::TileId& tile, const std::shared_ptr<BinaryData>& tileData, const MapBounds& tileBounds) const;
+        virtual std::shared_ptr<VectorTileFeatureCollection> decodeFeatures(const vt::TileId& tile, const std::shared_ptr<BinaryData>& tileData, const MapBounds& tileBounds, const FeatureFilter& filter) const;
 
         virtual std::shared_ptr<TileMap> decodeTile(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<vt::TileTransformer>& tileTransformer, const std::shared_ptr<BinaryData>& tileData) const;
     
     protected:
         void updateLayerStyleSet(const std::string& layerId, const std::shared_ptr<CartoCSSStyleSet>& styleSet);
 
+        std::shared_ptr<mvt::MBVTFeatureDecoder> getFeatureDecoder(const std::shared_ptr<BinaryData>& tileData) const;
+
         static const int DEFAULT_TILE_SIZE;
         static const int STROKEMAP_SIZE;
         static const int GLYPHMAP_SIZE;
         static const std::size_t MAX_ASSETPACKAGE_SYMBOLIZER_CONTEXTS;
+        static const std::size_t MAX_CACHED_FEATURE_DECODERS;
         
         const std::shared_ptr<mvt::Logger> _logger;
         const std::vector<std::string> _layerIds;
@@ -110,7 +115,7 @@ namespace carto {
         std::map<std::shared_ptr<AssetPackage>, std::shared_ptr<mvt::SymbolizerContext> > _assetPackageSymbolizerContexts;
         std::shared_ptr<mvt::Map::Settings> _mapSettings;
 
-        mutable std::pair<std::shared_ptr<BinaryData>, std::shared_ptr<mvt::MBVTFeatureDecoder> > _cachedFeatureDecoder;
+        mutable std::list<std::pair<std::shared_ptr<BinaryData>, std::shared_ptr<mvt::MBVTFeatureDecoder> > > _cachedFeatureDecoders; // for decodeFeature(s), most recently used first
     
         mutable std::mutex _mutex;
     };
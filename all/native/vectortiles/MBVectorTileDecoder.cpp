@@ -19,9 +19,12 @@
 #include "styles/CartoCSSStyleSet.h"
 #include "vectortiles/utils/GeometryConverter.h"
 #include "vectortiles/utils/ValueConverter.h"
+#include "vectortiles/utils/FeatureDataQueryContext.h"
 #include "vectortiles/utils/MapnikVTLogger.h"
 #include "vectortiles/utils/VTBitmapLoader.h"
 #include "vectortiles/utils/CartoCSSAssetLoader.h"
+#include "vectortiles/utils/StyleMapCache.h"
+#include "vectortiles/utils/SymbolizerContextCache.h"
 #include "utils/AssetPackage.h"
 #include "utils/FileUtils.h"
 #include "utils/Const.h"
@@ -36,7 +39,9 @@
 #include <mapnikvt/MapParser.h>
 #include <cartocss/CartoCSSMapLoader.h>
 
+#include <algorithm>
 #include <functional>
+#include <thread>
 
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string/predicate.hpp>
@@ -48,10 +53,15 @@ namespace carto {
         _featureIdOverride(false),
         _cartoCSSLayerNamesIgnored(false),
         _layerNameOverride(),
+        _decoderThreadCount(1),
         _parameterValueMap(),
+        _styleRevision(0),
         _fallbackFonts(),
         _styleSet(),
         _map(),
+        _layerGroupMaps(),
+        _primaryPartMap(),
+        _secondaryPartMap(),
         _mapSettings(),
         _symbolizerContext(),
         _assetPackageSymbolizerContexts()
@@ -68,10 +78,15 @@ namespace carto {
         _featureIdOverride(false),
         _cartoCSSLayerNamesIgnored(false),
         _layerNameOverride(),
+        _decoderThreadCount(1),
         _parameterValueMap(),
+        _styleRevision(0),
         _fallbackFonts(),
         _styleSet(),
         _map(),
+        _layerGroupMaps(),
+        _primaryPartMap(),
+        _secondaryPartMap(),
         _symbolizerContext()
     {
         if (!cartoCSSStyleSet) {
@@ -268,6 +283,21 @@ namespace carto {
         notifyDecoderChanged();
     }
 
+    int MBVectorTileDecoder::getDecoderThreadCount() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _decoderThreadCount;
+    }
+
+    void MBVectorTileDecoder::setDecoderThreadCount(int threadCount) {
+        if (threadCount < 1) {
+            throw InvalidArgumentException("Decoder thread count must be at least 1");
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _decoderThreadCount = threadCount;
+        updateLayerGroupMaps();
+    }
+
     std::shared_ptr<mvt::Map::Settings> MBVectorTileDecoder::getMapSettings() const {
         std::lock_guard<std::mutex> lock(_mutex);
         return _mapSettings;
@@ -300,18 +330,7 @@ namespace carto {
         }
 
         try {
-            std::shared_ptr<mvt::MBVTFeatureDecoder> decoder;
-            {
-                std::unique_lock<std::mutex> lock(_mutex);
-                if (_cachedFeatureDecoder.first != tileData) {
-                    lock.unlock();
-                    decoder = std::make_shared<mvt::MBVTFeatureDecoder>(*tileData->getDataPtr(), _logger);
-                    lock.lock();
-                    _cachedFeatureDecoder = std::make_pair(tileData, decoder);
-                } else {
-                    decoder = _cachedFeatureDecoder.second;
-                }
-            }
+            std::shared_ptr<mvt::MBVTFeatureDecoder> decoder = getFeatureDecoder(tileData);
 
             std::string mvtLayerName;
             mvt::Feature mvtFeature;
@@ -347,6 +366,10 @@ namespace carto {
     }
 
     std::shared_ptr<VectorTileFeatureCollection> MBVectorTileDecoder::decodeFeatures(const vt::TileId& tile, const std::shared_ptr<BinaryData>& tileData, const MapBounds& tileBounds) const {
+        return decodeFeatures(tile, tileData, tileBounds, FeatureFilter());
+    }
+
+    std::shared_ptr<VectorTileFeatureCollection> MBVectorTileDecoder::decodeFeatures(const vt::TileId& tile, const std::shared_ptr<BinaryData>& tileData, const MapBounds& tileBounds, const FeatureFilter& filter) const {
         if (!tileData) {
             Log::Warn("MBVectorTileDecoder::decodeFeatures: Null tile data");
             return std::shared_ptr<VectorTileFeatureCollection>();
@@ -354,28 +377,23 @@ namespace carto {
 
         std::vector<std::shared_ptr<VectorTileFeature> > tileFeatures;
         try {
-            std::shared_ptr<mvt::MBVTFeatureDecoder> decoder;
-            {
-                std::unique_lock<std::mutex> lock(_mutex);
-                if (_cachedFeatureDecoder.first != tileData) {
-                    lock.unlock();
-                    decoder = std::make_shared<mvt::MBVTFeatureDecoder>(*tileData->getDataPtr(), _logger);
-                    lock.lock();
-                    _cachedFeatureDecoder = std::make_pair(tileData, decoder);
-                } else {
-                    decoder = _cachedFeatureDecoder.second;
-                }
-            }
+            std::shared_ptr<mvt::MBVTFeatureDecoder> decoder = getFeatureDecoder(tileData);
 
             for (const std::string& mvtLayerName : decoder->getLayerNames()) {
                 for (std::shared_ptr<mvt::FeatureDecoder::FeatureIterator> mvtIt = decoder->createLayerFeatureIterator(mvtLayerName); mvtIt->valid(); mvtIt->advance()) {
+                    // Test the raw feature attributes first, geometry and the attribute map are decoded only for the accepted features
+                    std::shared_ptr<const mvt::FeatureData> mvtFeatureData = mvtIt->getFeatureData();
+                    if (filter && !filter(mvtLayerName, FeatureDataQueryContext(mvtFeatureData))) {
+                        continue;
+                    }
+
                     std::shared_ptr<const mvt::Geometry> mvtGeometry = mvtIt->getGeometry();
                     if (!mvtGeometry) {
                         continue;
                     }
 
                     std::map<std::string, Variant> featureData;
-                    if (std::shared_ptr<const mvt::FeatureData> mvtFeatureData = mvtIt->getFeatureData()) {
+                    if (mvtFeatureData) {
                         for (const std::string& varName : mvtFeatureData->getVariableNames()) {
                             mvt::Value mvtValue;
                             if (mvtFeatureData->getVariable(varName, mvtValue)) {
@@ -407,28 +425,63 @@ namespace carto {
         }
 
         std::shared_ptr<mvt::Map> map;
+        std::vector<std::shared_ptr<mvt::Map> > layerGroupMaps;
         std::shared_ptr<mvt::SymbolizerContext> symbolizerContext;
         bool featureIdOverride;
         std::string layerNameOverride;
         {
             std::lock_guard<std::mutex> lock(_mutex);
             map = _map;
+            layerGroupMaps = _layerGroupMaps;
             symbolizerContext = _symbolizerContext;
             featureIdOverride = _featureIdOverride;
             layerNameOverride = _layerNameOverride;
         }
+
+        if (layerGroupMaps.size() > 1) {
+            // Decode layer groups in parallel, each thread needs its own feature decoder
+            std::vector<std::shared_ptr<vt::Tile> > tiles(layerGroupMaps.size());
+            std::vector<int> failed(layerGroupMaps.size(), 0);
+            auto decodeLayerGroup = [&](std::size_t index) {
+                try {
+                    tiles[index] = readTile(layerGroupMaps[index], tile, targetTile, tileTransformer, tileData, *symbolizerContext, featureIdOverride, layerNameOverride);
+                }
+                catch (const std::exception& ex) {
+                    Log::Errorf("MBVectorTileDecoder::decodeTile: Exception while decoding: %s", ex.what());
+                }
+                failed[index] = (tiles[index] ? 0 : 1);
+            };
+
+            std::vector<std::thread> threads;
+            for (std::size_t i = 1; i < layerGroupMaps.size(); i++) {
+                threads.emplace_back(decodeLayerGroup, i);
+            }
+            decodeLayerGroup(0);
+            for (std::thread& thread : threads) {
+                thread.join();
+            }
+            if (std::find(failed.begin(), failed.end(), 1) != failed.end()) {
+                return std::shared_ptr<TileMap>();
+            }
+
+            // Merge the layers, keeping the original layer order
+            std::vector<std::shared_ptr<vt::TileLayer> > tileLayers;
+            for (std::size_t i = 0; i < tiles.size(); i++) {
+                for (const std::shared_ptr<vt::TileLayer>& tileLayer : tiles[i]->getLayers()) {
+                    int layerIdx = static_cast<int>(i * 65536) + tileLayer->getLayerIndex();
+                    tileLayers.push_back(std::make_shared<vt::TileLayer>(layerIdx, tileLayer->getCompOp(), tileLayer->getOpacityFunc(), tileLayer->getBitmaps(), tileLayer->getGeometries(), tileLayer->getLabels()));
+                }
+            }
+
+            auto tileMap = std::make_shared<TileMap>();
+            (*tileMap)[0] = std::make_shared<vt::Tile>(targetTile, tiles[0]->getTileSize(), tiles[0]->getBackground(), tileLayers);
+            return tileMap;
+        }
     
         try {
-            mvt::MBVTFeatureDecoder decoder(*tileData->getDataPtr(), _logger);
-            decoder.setTransform(calculateTileTransform(tile, targetTile));
-            decoder.setGlobalIdOverride(featureIdOverride, MapTile(tile.x, tile.y, tile.zoom, 0).getTileId());
-            
-            mvt::MBVTTileReader reader(map, tileTransformer, *symbolizerContext, decoder);
-            reader.setLayerNameOverride(layerNameOverride);
-
-            if (std::shared_ptr<vt::Tile> tile = reader.readTile(targetTile)) {
+            if (std::shared_ptr<vt::Tile> vtTile = readTile(map, tile, targetTile, tileTransformer, tileData, *symbolizerContext, featureIdOverride, layerNameOverride)) {
                 auto tileMap = std::make_shared<TileMap>();
-                (*tileMap)[0] = tile;
+                (*tileMap)[0] = vtTile;
                 return tileMap;
             }
         }
@@ -438,6 +491,126 @@ namespace carto {
         return std::shared_ptr<TileMap>();
     }
 
+    bool MBVectorTileDecoder::isProgressiveDecodingSupported() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _secondaryPartMap.get() != nullptr;
+    }
+
+    std::shared_ptr<MBVectorTileDecoder::TileMap> MBVectorTileDecoder::decodeTilePart(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<vt::TileTransformer>& tileTransformer, const std::shared_ptr<BinaryData>& tileData, bool primary) const {
+        if (!tileData) {
+            Log::Warn("MBVectorTileDecoder::decodeTilePart: Null tile data");
+            return std::shared_ptr<TileMap>();
+        }
+
+        std::shared_ptr<mvt::Map> partMap;
+        std::shared_ptr<mvt::SymbolizerContext> symbolizerContext;
+        bool featureIdOverride;
+        std::string layerNameOverride;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            partMap = (primary ? _primaryPartMap : _secondaryPartMap);
+            symbolizerContext = _symbolizerContext;
+            featureIdOverride = _featureIdOverride;
+            layerNameOverride = _layerNameOverride;
+        }
+
+        if (!partMap) {
+            return primary ? decodeTile(tile, targetTile, tileTransformer, tileData) : std::shared_ptr<TileMap>();
+        }
+
+        try {
+            if (std::shared_ptr<vt::Tile> vtTile = readTile(partMap, tile, targetTile, tileTransformer, tileData, *symbolizerContext, featureIdOverride, layerNameOverride)) {
+                auto tileMap = std::make_shared<TileMap>();
+                (*tileMap)[0] = vtTile;
+                return tileMap;
+            }
+        }
+        catch (const std::exception& ex) {
+            Log::Errorf("MBVectorTileDecoder::decodeTilePart: Exception while decoding: %s", ex.what());
+        }
+        return std::shared_ptr<TileMap>();
+    }
+
+    std::string MBVectorTileDecoder::getStateKey() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // Style parameters are serialized by value, so that restoring a parameter gives the same key
+        std::string key = boost::lexical_cast<std::string>(_styleRevision);
+        key += _featureIdOverride ? ":1:" : ":0:";
+        key += _layerNameOverride;
+        for (auto it = _parameterValueMap.begin(); it != _parameterValueMap.end(); it++) {
+            key += "|" + it->first + "=" + boost::lexical_cast<std::string>(it->second.which()) + ":";
+            if (auto val = boost::get<bool>(&it->second)) {
+                key += boost::lexical_cast<std::string>(*val);
+            } else if (auto val = boost::get<long long>(&it->second)) {
+                key += boost::lexical_cast<std::string>(*val);
+            } else if (auto val = boost::get<double>(&it->second)) {
+                key += boost::lexical_cast<std::string>(*val);
+            } else if (auto val = boost::get<std::string>(&it->second)) {
+                key += *val;
+            }
+        }
+        return key;
+    }
+
+    std::shared_ptr<vt::Tile> MBVectorTileDecoder::readTile(const std::shared_ptr<mvt::Map>& map, const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<vt::TileTransformer>& tileTransformer, const std::shared_ptr<BinaryData>& tileData, const mvt::SymbolizerContext& symbolizerContext, bool featureIdOverride, const std::string& layerNameOverride) const {
+        std::shared_ptr<mvt::MBVTFeatureDecoder> decoder = acquireFeatureDecoder(tileData);
+        decoder->setTransform(calculateTileTransform(tile, targetTile));
+        decoder->setGlobalIdOverride(featureIdOverride, MapTile(tile.x, tile.y, tile.zoom, 0).getTileId());
+
+        mvt::MBVTTileReader reader(map, tileTransformer, symbolizerContext, *decoder);
+        reader.setLayerNameOverride(layerNameOverride);
+
+        std::shared_ptr<vt::Tile> vtTile = reader.readTile(targetTile);
+        releaseFeatureDecoder(tileData, decoder);
+        return vtTile;
+    }
+
+    std::shared_ptr<mvt::MBVTFeatureDecoder> MBVectorTileDecoder::getFeatureDecoder(const std::shared_ptr<BinaryData>& tileData) const {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (auto it = _cachedFeatureDecoders.begin(); it != _cachedFeatureDecoders.end(); it++) {
+                if (it->first == tileData) {
+                    _cachedFeatureDecoders.splice(_cachedFeatureDecoders.begin(), _cachedFeatureDecoders, it);
+                    return it->second;
+                }
+            }
+        }
+
+        auto decoder = std::make_shared<mvt::MBVTFeatureDecoder>(*tileData->getDataPtr(), _logger);
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _cachedFeatureDecoders.emplace_front(tileData, decoder);
+        while (_cachedFeatureDecoders.size() > MAX_CACHED_FEATURE_DECODERS) {
+            _cachedFeatureDecoders.pop_back();
+        }
+        return decoder;
+    }
+
+    std::shared_ptr<mvt::MBVTFeatureDecoder> MBVectorTileDecoder::acquireFeatureDecoder(const std::shared_ptr<BinaryData>& tileData) const {
+        // Parsed tiles do not depend on the style, so restyling can reuse them.
+        // Tile data is compared by content, as refetched tiles may be new instances.
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (auto it = _idleFeatureDecoders.begin(); it != _idleFeatureDecoders.end(); it++) {
+                if (it->first == tileData || (it->first->size() == tileData->size() && *it->first->getDataPtr() == *tileData->getDataPtr())) {
+                    std::shared_ptr<mvt::MBVTFeatureDecoder> decoder = it->second;
+                    _idleFeatureDecoders.erase(it);
+                    return decoder;
+                }
+            }
+        }
+        return std::make_shared<mvt::MBVTFeatureDecoder>(*tileData->getDataPtr(), _logger);
+    }
+
+    void MBVectorTileDecoder::releaseFeatureDecoder(const std::shared_ptr<BinaryData>& tileData, const std::shared_ptr<mvt::MBVTFeatureDecoder>& decoder) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _idleFeatureDecoders.emplace_front(tileData, decoder);
+        while (_idleFeatureDecoders.size() > MAX_IDLE_FEATURE_DECODERS) {
+            _idleFeatureDecoders.pop_back();
+        }
+    }
+
     void MBVectorTileDecoder::updateCurrentStyleSet(const boost::variant<std::shared_ptr<CompiledStyleSet>, std::shared_ptr<CartoCSSStyleSet> >& styleSet) {
         std::string styleAssetName;
         std::shared_ptr<AssetPackage> assetPackage;
@@ -447,14 +620,19 @@ namespace carto {
             styleAssetName = "";
             assetPackage = (*cartoCSSStyleSet)->getAssetPackage();
 
-            try {
-                auto assetLoader = std::make_shared<CartoCSSAssetLoader>("", (*cartoCSSStyleSet)->getAssetPackage());
-                css::CartoCSSMapLoader mapLoader(assetLoader, _logger);
-                mapLoader.setIgnoreLayerPredicates(_cartoCSSLayerNamesIgnored);
-                map = mapLoader.loadMap((*cartoCSSStyleSet)->getCartoCSS());
-            }
-            catch (const std::exception& ex) {
-                throw ParseException(std::string("CartoCSS style parsing failed: ") + ex.what(), (*cartoCSSStyleSet)->getCartoCSS());
+            std::string styleKey = std::string("cartocss:") + (_cartoCSSLayerNamesIgnored ? "1:" : "0:") + (*cartoCSSStyleSet)->getCartoCSS();
+            map = StyleMapCache::Get(styleKey, assetPackage);
+            if (!map) {
+                try {
+                    auto assetLoader = std::make_shared<CartoCSSAssetLoader>("", (*cartoCSSStyleSet)->getAssetPackage());
+                    css::CartoCSSMapLoader mapLoader(assetLoader, _logger);
+                    mapLoader.setIgnoreLayerPredicates(_cartoCSSLayerNamesIgnored);
+                    map = mapLoader.loadMap((*cartoCSSStyleSet)->getCartoCSS());
+                }
+                catch (const std::exception& ex) {
+                    throw ParseException(std::string("CartoCSS style parsing failed: ") + ex.what(), (*cartoCSSStyleSet)->getCartoCSS());
+                }
+                StyleMapCache::Put(styleKey, assetPackage, map);
             }
         } else if (auto compiledStyleSet = boost::get<std::shared_ptr<CompiledStyleSet> >(&styleSet)) {
             styleAssetName = (*compiledStyleSet)->getStyleAssetName();
@@ -463,39 +641,44 @@ namespace carto {
             }
             assetPackage = (*compiledStyleSet)->getAssetPackage();
 
-            std::shared_ptr<BinaryData> styleData;
-            if (assetPackage) {
-                styleData = assetPackage->loadAsset(styleAssetName);
-            }
-            if (!styleData) {
-                throw GenericException("Failed to load style description asset");
-            }
-
-            if (boost::algorithm::ends_with(styleAssetName, ".xml")) {
-                pugi::xml_document doc;
-                if (!doc.load_buffer(styleData->data(), styleData->size())) {
-                    throw ParseException("Style element XML parsing failed");
+            std::string styleKey = std::string("compiled:") + (_cartoCSSLayerNamesIgnored ? "1:" : "0:") + styleAssetName;
+            map = StyleMapCache::Get(styleKey, assetPackage);
+            if (!map) {
+                std::shared_ptr<BinaryData> styleData;
+                if (assetPackage) {
+                    styleData = assetPackage->loadAsset(styleAssetName);
                 }
-                try {
-                    auto symbolizerParser = std::make_shared<mvt::SymbolizerParser>(_logger);
-                    mvt::MapParser mapParser(symbolizerParser, _logger);
-                    map = mapParser.parseMap(doc);
-                }
-                catch (const std::exception& ex) {
-                    throw ParseException(std::string("XML style processing failed: ") + ex.what());
-                }
-            } else if (boost::algorithm::ends_with(styleAssetName, ".json")) {
-                try {
-                    auto assetLoader = std::make_shared<CartoCSSAssetLoader>(FileUtils::GetFilePath(styleAssetName), assetPackage);
-                    css::CartoCSSMapLoader mapLoader(assetLoader, _logger);
-                    mapLoader.setIgnoreLayerPredicates(_cartoCSSLayerNamesIgnored);
-                    map = mapLoader.loadMapProject(styleAssetName);
+                if (!styleData) {
+                    throw GenericException("Failed to load style description asset");
                 }
-                catch (const std::exception& ex) {
-                    throw GenericException(std::string("CartoCSS style loading failed: ") + ex.what());
+
+                if (boost::algorithm::ends_with(styleAssetName, ".xml")) {
+                    pugi::xml_document doc;
+                    if (!doc.load_buffer(styleData->data(), styleData->size())) {
+                        throw ParseException("Style element XML parsing failed");
+                    }
+                    try {
+                        auto symbolizerParser = std::make_shared<mvt::SymbolizerParser>(_logger);
+                        mvt::MapParser mapParser(symbolizerParser, _logger);
+                        map = mapParser.parseMap(doc);
+                    }
+                    catch (const std::exception& ex) {
+                        throw ParseException(std::string("XML style processing failed: ") + ex.what());
+                    }
+                } else if (boost::algorithm::ends_with(styleAssetName, ".json")) {
+                    try {
+                        auto assetLoader = std::make_shared<CartoCSSAssetLoader>(FileUtils::GetFilePath(styleAssetName), assetPackage);
+                        css::CartoCSSMapLoader mapLoader(assetLoader, _logger);
+                        mapLoader.setIgnoreLayerPredicates(_cartoCSSLayerNamesIgnored);
+                        map = mapLoader.loadMapProject(styleAssetName);
+                    }
+                    catch (const std::exception& ex) {
+                        throw GenericException(std::string("CartoCSS style loading failed: ") + ex.what());
+                    }
+                } else {
+                    throw GenericException("Failed to detect style asset type");
                 }
-            } else {
-                throw GenericException("Failed to detect style asset type");
+                StyleMapCache::Put(styleKey, assetPackage, map);
             }
         } else {
             throw InvalidArgumentException("Invalid style set");
@@ -506,32 +689,37 @@ namespace carto {
         }
         std::shared_ptr<mvt::SymbolizerContext>& symbolizerContext = _assetPackageSymbolizerContexts[std::make_pair(styleAssetName, assetPackage)];
         if (!symbolizerContext) {
-            auto fontManager = std::make_shared<vt::FontManager>(GLYPHMAP_SIZE, GLYPHMAP_SIZE);
-            auto bitmapLoader = std::make_shared<VTBitmapLoader>(FileUtils::GetFilePath(styleAssetName), assetPackage);
-            auto bitmapManager = std::make_shared<vt::BitmapManager>(bitmapLoader);
-            auto strokeMap = std::make_shared<vt::StrokeMap>(STROKEMAP_SIZE, STROKEMAP_SIZE);
-            auto glyphMap = std::make_shared<vt::GlyphMap>(GLYPHMAP_SIZE, GLYPHMAP_SIZE);
-
-            std::shared_ptr<vt::Font> fallbackFont;
-            for (auto it = _fallbackFonts.rbegin(); it != _fallbackFonts.rend(); it++) {
-                std::shared_ptr<BinaryData> fontData = *it;
-                std::string fontName = fontManager->loadFontData(*fontData->getDataPtr());
-                fallbackFont = fontManager->getFont(fontName, fallbackFont);
-            }
-            mvt::SymbolizerContext::Settings settings(DEFAULT_TILE_SIZE, std::map<std::string, mvt::Value>(), fallbackFont);
-            symbolizerContext = std::make_shared<mvt::SymbolizerContext>(bitmapManager, fontManager, strokeMap, glyphMap, settings);
-
-            if (assetPackage) {
-                std::string fontPrefix = map->getSettings().fontDirectory;
-                fontPrefix = FileUtils::NormalizePath(FileUtils::GetFilePath(styleAssetName) + fontPrefix + "/");
-
-                for (const std::string& assetName : assetPackage->getAssetNames()) {
-                    if (assetName.size() > fontPrefix.size() && assetName.substr(0, fontPrefix.size()) == fontPrefix) {
-                        if (std::shared_ptr<BinaryData> fontData = assetPackage->loadAsset(assetName)) {
-                            fontManager->loadFontData(*fontData->getDataPtr());
+            // Share the loaded fonts and rasterized glyphs with the other decoders using the same assets
+            std::string fontPrefix = FileUtils::NormalizePath(FileUtils::GetFilePath(styleAssetName) + map->getSettings().fontDirectory + "/");
+            std::string contextKey = FileUtils::GetFilePath(styleAssetName) + "|" + fontPrefix;
+            symbolizerContext = SymbolizerContextCache::Get(contextKey, assetPackage, _fallbackFonts);
+            if (!symbolizerContext) {
+                auto fontManager = std::make_shared<vt::FontManager>(GLYPHMAP_SIZE, GLYPHMAP_SIZE);
+                auto bitmapLoader = std::make_shared<VTBitmapLoader>(FileUtils::GetFilePath(styleAssetName), assetPackage);
+                auto bitmapManager = std::make_shared<vt::BitmapManager>(bitmapLoader);
+                auto strokeMap = std::make_shared<vt::StrokeMap>(STROKEMAP_SIZE, STROKEMAP_SIZE);
+                auto glyphMap = std::make_shared<vt::GlyphMap>(GLYPHMAP_SIZE, GLYPHMAP_SIZE);
+
+                std::shared_ptr<vt::Font> fallbackFont;
+                for (auto it = _fallbackFonts.rbegin(); it != _fallbackFonts.rend(); it++) {
+                    std::shared_ptr<BinaryData> fontData = *it;
+                    std::string fontName = fontManager->loadFontData(*fontData->getDataPtr());
+                    fallbackFont = fontManager->getFont(fontName, fallbackFont);
+                }
+                mvt::SymbolizerContext::Settings settings(DEFAULT_TILE_SIZE, std::map<std::string, mvt::Value>(), fallbackFont);
+                symbolizerContext = std::make_shared<mvt::SymbolizerContext>(bitmapManager, fontManager, strokeMap, glyphMap, settings);
+
+                if (assetPackage) {
+                    for (const std::string& assetName : assetPackage->getAssetNames()) {
+                        if (assetName.size() > fontPrefix.size() && assetName.substr(0, fontPrefix.size()) == fontPrefix) {
+                            if (std::shared_ptr<BinaryData> fontData = assetPackage->loadAsset(assetName)) {
+                                fontManager->loadFontData(*fontData->getDataPtr());
+                            }
                         }
                     }
                 }
+
+                SymbolizerContextCache::Put(contextKey, assetPackage, _fallbackFonts, symbolizerContext);
             }
         }
 
@@ -571,12 +759,54 @@ namespace carto {
         _map = map;
         _mapSettings = std::make_shared<mvt::Map::Settings>(_map->getSettings());
         _styleSet = styleSet;
-        _cachedFeatureDecoder.first.reset();
-        _cachedFeatureDecoder.second.reset();
+        _styleRevision++;
+        _cachedFeatureDecoders.clear();
+        updateLayerGroupMaps();
+    }
+
+    void MBVectorTileDecoder::updateLayerGroupMaps() {
+        _layerGroupMaps.clear();
+        _primaryPartMap.reset();
+        _secondaryPartMap.reset();
+        if (!_map) {
+            return;
+        }
+
+        // For progressive decoding, split the layers in two halves. Labels and 3D content are usually styled in the last layers, as these are drawn on top.
+        const auto& layers = _map->getLayers();
+        if (layers.size() >= 2) {
+            std::size_t splitIndex = layers.size() / 2;
+            _primaryPartMap = std::make_shared<mvt::Map>(*_map);
+            _primaryPartMap->clearLayers();
+            _secondaryPartMap = std::make_shared<mvt::Map>(*_map);
+            _secondaryPartMap->clearLayers();
+            for (std::size_t i = 0; i < layers.size(); i++) {
+                (i < splitIndex ? _primaryPartMap : _secondaryPartMap)->addLayer(layers[i]);
+            }
+        }
+
+        // Split the layers into contiguous groups of roughly equal size, each group is a copy of the map with a subset of layers
+        int groupCount = std::min(_decoderThreadCount, static_cast<int>(layers.size()) / MIN_LAYERS_PER_THREAD);
+        if (groupCount <= 1) {
+            return;
+        }
+        for (int i = 0; i < groupCount; i++) {
+            auto layerGroupMap = std::make_shared<mvt::Map>(*_map);
+            layerGroupMap->clearLayers();
+            for (std::size_t j = layers.size() * i / groupCount; j < layers.size() * (i + 1) / groupCount; j++) {
+                layerGroupMap->addLayer(layers[j]);
+            }
+            _layerGroupMaps.push_back(layerGroupMap);
+        }
     }
 
     const int MBVectorTileDecoder::DEFAULT_TILE_SIZE = 256;
+    const int MBVectorTileDecoder::MIN_LAYERS_PER_THREAD = 4;
     const int MBVectorTileDecoder::STROKEMAP_SIZE = 512;
     const int MBVectorTileDecoder::GLYPHMAP_SIZE = 2048;
     const std::size_t MBVectorTileDecoder::MAX_ASSETPACKAGE_SYMBOLIZER_CONTEXTS = 2;
+
+    const std::size_t MBVectorTileDecoder::MAX_CACHED_FEATURE_DECODERS = 8;
+
+    const std::size_t MBVectorTileDecoder::MAX_IDLE_FEATURE_DECODERS = 16;
 }
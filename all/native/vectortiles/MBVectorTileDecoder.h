@@ -11,6 +11,7 @@
 
 #include <memory>
 #include <mutex>
+#include <list>
 #include <map>
 #include <vector>
 #include <string>
@@ -133,6 +134,20 @@ namespace carto {
          */
         void setLayerNameOverride(const std::string& name);
 
+        /**
+         * Returns the number of threads used for decoding a single tile.
+         * @return The number of threads used for decoding a single tile. Default is 1.
+         */
+        int getDecoderThreadCount() const;
+        /**
+         * Sets the number of threads used for decoding a single tile. If larger than 1, the layers of the style
+         * are split into groups that are decoded in parallel and the results are merged. This reduces the latency
+         * of decoding dense tiles with many layers, at the expense of some extra work per tile.
+         * Styles with only a few layers are always decoded on a single thread.
+         * @param threadCount The number of threads to use. Must be at least 1.
+         */
+        void setDecoderThreadCount(int threadCount);
+
         virtual std::shared_ptr<mvt::Map::Settings> getMapSettings() const;
     
         virtual void addFallbackFont(const std::shared_ptr<BinaryData>& fontData);
@@ -144,30 +159,52 @@ namespace carto {
         virtual std::shared_ptr<VectorTileFeature> decodeFeature(long long id, const vt::TileId& tile, const std::shared_ptr<BinaryData>& tileData, const MapBounds& tileBounds) const;
 
         virtual std::shared_ptr<VectorTileFeatureCollection> decodeFeatures(const vt::TileId& tile, const std::shared_ptr<BinaryData>& tileData, const MapBounds& tileBounds) const;
+        virtual std::shared_ptr<VectorTileFeatureCollection> decodeFeatures(const vt::TileId& tile, const std::shared_ptr<BinaryData>& tileData, const MapBounds& tileBounds, const FeatureFilter& filter) const;
 
         virtual std::shared_ptr<TileMap> decodeTile(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<vt::TileTransformer>& tileTransformer, const std::shared_ptr<BinaryData>& tileData) const;
+
+        virtual bool isProgressiveDecodingSupported() const;
+        virtual std::shared_ptr<TileMap> decodeTilePart(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<vt::TileTransformer>& tileTransformer, const std::shared_ptr<BinaryData>& tileData, bool primary) const;
+
+        virtual std::string getStateKey() const;
     
     protected:
         void updateCurrentStyleSet(const boost::variant<std::shared_ptr<CompiledStyleSet>, std::shared_ptr<CartoCSSStyleSet> >& styleSet);
+        void updateLayerGroupMaps();
+
+        std::shared_ptr<vt::Tile> readTile(const std::shared_ptr<mvt::Map>& map, const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<vt::TileTransformer>& tileTransformer, const std::shared_ptr<BinaryData>& tileData, const mvt::SymbolizerContext& symbolizerContext, bool featureIdOverride, const std::string& layerNameOverride) const;
+
+        std::shared_ptr<mvt::MBVTFeatureDecoder> getFeatureDecoder(const std::shared_ptr<BinaryData>& tileData) const;
+        std::shared_ptr<mvt::MBVTFeatureDecoder> acquireFeatureDecoder(const std::shared_ptr<BinaryData>& tileData) const;
+        void releaseFeatureDecoder(const std::shared_ptr<BinaryData>& tileData, const std::shared_ptr<mvt::MBVTFeatureDecoder>& decoder) const;
 
         static const int DEFAULT_TILE_SIZE;
+        static const int MIN_LAYERS_PER_THREAD;
         static const int STROKEMAP_SIZE;
         static const int GLYPHMAP_SIZE;
         static const std::size_t MAX_ASSETPACKAGE_SYMBOLIZER_CONTEXTS;
+        static const std::size_t MAX_CACHED_FEATURE_DECODERS;
+        static const std::size_t MAX_IDLE_FEATURE_DECODERS;
         
         const std::shared_ptr<mvt::Logger> _logger;
         bool _featureIdOverride;
         bool _cartoCSSLayerNamesIgnored;
         std::string _layerNameOverride;
+        int _decoderThreadCount;
         std::map<std::string, mvt::Value> _parameterValueMap;
+        int _styleRevision; // incremented each time the style map is rebuilt
         std::vector<std::shared_ptr<BinaryData> > _fallbackFonts;
         boost::variant<std::shared_ptr<CompiledStyleSet>, std::shared_ptr<CartoCSSStyleSet> > _styleSet;
         std::shared_ptr<mvt::Map> _map;
+        std::vector<std::shared_ptr<mvt::Map> > _layerGroupMaps; // subsets of the map layers for parallel decoding, empty if not used
+        std::shared_ptr<mvt::Map> _primaryPartMap; // base layers of the map for progressive decoding, null if not used
+        std::shared_ptr<mvt::Map> _secondaryPartMap; // remaining layers of the map for progressive decoding, null if not used
         std::shared_ptr<mvt::Map::Settings> _mapSettings;
         std::shared_ptr<mvt::SymbolizerContext> _symbolizerContext;
         std::map<std::pair<std::string, std::shared_ptr<AssetPackage> >, std::shared_ptr<mvt::SymbolizerContext> > _assetPackageSymbolizerContexts;
 
-        mutable std::pair<std::shared_ptr<BinaryData>, std::shared_ptr<mvt::MBVTFeatureDecoder> > _cachedFeatureDecoder;
+        mutable std::list<std::pair<std::shared_ptr<BinaryData>, std::shared_ptr<mvt::MBVTFeatureDecoder> > > _cachedFeatureDecoders; // for decodeFeature(s), most recently used first
+        mutable std::list<std::pair<std::shared_ptr<BinaryData>, std::shared_ptr<mvt::MBVTFeatureDecoder> > > _idleFeatureDecoders; // parsed tiles for decodeTile, most recently used first
     
         mutable std::mutex _mutex;
     };
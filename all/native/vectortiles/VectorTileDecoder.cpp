@@ -1,15 +1,71 @@
 #include "VectorTileDecoder.h"
+#include "core/Variant.h"
+#include "geometry/VectorTileFeature.h"
+#include "geometry/VectorTileFeatureCollection.h"
+#include "search/query/QueryContext.h"
 
 #include <vt/TileId.h>
 
 #include <algorithm>
 
+namespace {
+
+    class VariantQueryContext : public carto::QueryContext {
+    public:
+        explicit VariantQueryContext(const carto::Variant& var) : _variant(var) { }
+        virtual ~VariantQueryContext() { }
+
+        virtual bool getVariable(const std::string& name, carto::Variant& value) const {
+            if (_variant.getType() != carto::VariantType::VARIANT_TYPE_OBJECT || !_variant.containsObjectKey(name)) {
+                return false;
+            }
+            value = _variant.getObjectElement(name);
+            return true;
+        }
+
+    private:
+        const carto::Variant& _variant;
+    };
+
+}
+
 namespace carto {
 
     VectorTileDecoder::~VectorTileDecoder()
     {
     }
 
+    std::shared_ptr<VectorTileFeatureCollection> VectorTileDecoder::decodeFeatures(const vt::TileId& tile, const std::shared_ptr<BinaryData>& tileData, const MapBounds& tileBounds, const FeatureFilter& filter) const {
+        std::shared_ptr<VectorTileFeatureCollection> featureCollection = decodeFeatures(tile, tileData, tileBounds);
+        if (!featureCollection || !filter) {
+            return featureCollection;
+        }
+
+        std::vector<std::shared_ptr<VectorTileFeature> > tileFeatures;
+        for (int i = 0; i < featureCollection->getFeatureCount(); i++) {
+            const std::shared_ptr<VectorTileFeature>& feature = featureCollection->getFeature(i);
+            if (filter(feature->getLayerName(), VariantQueryContext(feature->getProperties()))) {
+                tileFeatures.push_back(feature);
+            }
+        }
+        return std::make_shared<VectorTileFeatureCollection>(tileFeatures);
+    }
+
+    bool VectorTileDecoder::isProgressiveDecodingSupported() const {
+        return false;
+    }
+
+    std::shared_ptr<VectorTileDecoder::TileMap> VectorTileDecoder::decodeTilePart(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<vt::TileTransformer>& tileTransformer, const std::shared_ptr<BinaryData>& tileData, bool primary) const {
+        if (!primary) {
+            return std::shared_ptr<TileMap>();
+        }
+        return decodeTile(tile, targetTile, tileTransformer, tileData);
+    }
+
+    std::string VectorTileDecoder::getStateKey() const {
+        return std::string();
+    }
+
     void VectorTileDecoder::notifyDecoderChanged() {
         std::vector<std::shared_ptr<OnChangeListener> > onChangeListeners;
         {
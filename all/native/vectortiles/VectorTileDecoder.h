@@ -11,6 +11,7 @@
 
 #include <memory>
 #include <string>
+#include <functional>
 #include <mutex>
 #include <map>
 #include <vector>
@@ -30,6 +31,7 @@ namespace carto {
     class VectorTileFeature;
     class VectorTileFeatureCollection;
     class MapBounds;
+    class QueryContext;
 
     /**
      * Abstract base class for vector tile decoders.
@@ -38,6 +40,12 @@ namespace carto {
     public:
         typedef std::map<int, std::shared_ptr<const vt::Tile> > TileMap;
 
+        /**
+         * Feature filter, called with the layer name and the feature attributes before the feature geometry is decoded.
+         * Features rejected by the filter are skipped.
+         */
+        typedef std::function<bool(const std::string& layerName, const QueryContext& attributeContext)> FeatureFilter;
+
         /**
          * Interface for monitoring decoder parameter change events.
          */
@@ -95,6 +103,18 @@ namespace carto {
          */
         virtual std::shared_ptr<VectorTileFeatureCollection> decodeFeatures(const vt::TileId& tile, const std::shared_ptr<BinaryData>& tileData, const MapBounds& tileBounds) const = 0;
 
+        /**
+         * Decodes the features from the tile accepted by the specified filter.
+         * The default implementation decodes all the features and filters them afterwards,
+         * decoders should override this if the attributes can be tested without decoding the geometry.
+         * @param tile The tile coordinates.
+         * @param tileData The tile data to use.
+         * @param tileBounds The bounds for the tile (used for coordinate transformation).
+         * @param filter The feature filter to use. If empty, all features are decoded.
+         * @return The list of tile features.
+         */
+        virtual std::shared_ptr<VectorTileFeatureCollection> decodeFeatures(const vt::TileId& tile, const std::shared_ptr<BinaryData>& tileData, const MapBounds& tileBounds, const FeatureFilter& filter) const;
+
         /**
          * Loads the specified vector tile.
          * @param tile The id of the tile to load.
@@ -103,6 +123,32 @@ namespace carto {
          * @return The vector tile data, for each frame. If the tile is not available, null is returned.
          */
         virtual std::shared_ptr<TileMap> decodeTile(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<vt::TileTransformer>& tileTransformer, const std::shared_ptr<BinaryData>& tileData) const = 0;
+
+        /**
+         * Returns true if the decoder can decode tiles in two parts for progressive rendering.
+         * @return True if progressive decoding is supported.
+         */
+        virtual bool isProgressiveDecodingSupported() const;
+
+        /**
+         * Loads a part of the specified vector tile for progressive rendering. The primary part contains the base layers
+         * of the style, the secondary part contains the rest of the layers (usually labels and 3D content, as these are drawn on top).
+         * The layers of the secondary part are drawn after the layers of the primary part. If progressive decoding is not supported,
+         * the primary part is the full tile.
+         * @param tile The id of the tile to load.
+         * @param targetTile The target tile id that will be created from the data.
+         * @param tileData The tile data to decode.
+         * @param primary True to load the primary part, false to load the secondary part.
+         * @return The vector tile data of the part, for each frame. If the part is not available, null is returned.
+         */
+        virtual std::shared_ptr<TileMap> decodeTilePart(const vt::TileId& tile, const vt::TileId& targetTile, const std::shared_ptr<vt::TileTransformer>& tileTransformer, const std::shared_ptr<BinaryData>& tileData, bool primary) const;
+
+        /**
+         * Returns a key describing the current decoder state (style, style parameters, etc).
+         * Identical tile data decoded with the same state key gives identical tiles, so decoded tiles can be reused.
+         * @return The current state key. Empty key means that decoded tiles can not be reused.
+         */
+        virtual std::string getStateKey() const;
     
         /**
          * Notifies listeners that the decoder parameters have changed. Action taken depends on the implementation of the
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_FEATUREDATAQUERYCONTEXT_H_
+#define _CARTO_FEATUREDATAQUERYCONTEXT_H_
+
+#include "core/Variant.h"
+#include "search/query/QueryContext.h"
+#include "vectortiles/utils/ValueConverter.h"
+
+#include <memory>
+
+#include <mapnikvt/FeatureData.h>
+#include <mapnikvt/Value.h>
+
+namespace carto {
+
+    class FeatureDataQueryContext : public QueryContext {
+    public:
+        explicit FeatureDataQueryContext(const std::shared_ptr<const mvt::FeatureData>& featureData) : _featureData(featureData) { }
+        virtual ~FeatureDataQueryContext() { }
+
+        virtual bool getVariable(const std::string& name, Variant& value) const {
+            if (!_featureData) {
+                return false;
+            }
+            mvt::Value mvtValue;
+            if (!_featureData->getVariable(name, mvtValue)) {
+                return false;
+            }
+            value = boost::apply_visitor(ValueConverter(), mvtValue);
+            return true;
+        }
+
+    private:
+        const std::shared_ptr<const mvt::FeatureData>& _featureData;
+    };
+
+}
+
+#endif
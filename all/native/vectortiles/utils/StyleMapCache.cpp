@@ -0,0 +1,58 @@
+#include "StyleMapCache.h"
+#include "utils/AssetPackage.h"
+
+#include <mapnikvt/Map.h>
+
+namespace carto {
+
+    std::shared_ptr<mvt::Map> StyleMapCache::Get(const std::string& styleKey, const std::shared_ptr<AssetPackage>& assetPackage) {
+        std::lock_guard<std::mutex> lock(_Mutex);
+
+        for (auto it = _Entries.begin(); it != _Entries.end(); ) {
+            // Drop maps of released asset packages, a new package may reuse the address
+            if (it->assetPackagePtr && it->assetPackage.expired()) {
+                it = _Entries.erase(it);
+                continue;
+            }
+            if (it->styleKey == styleKey && it->assetPackagePtr == assetPackage.get()) {
+                std::shared_ptr<mvt::Map> map = it->map;
+                _Entries.splice(_Entries.begin(), _Entries, it);
+                return map;
+            }
+            it++;
+        }
+        return std::shared_ptr<mvt::Map>();
+    }
+
+    void StyleMapCache::Put(const std::string& styleKey, const std::shared_ptr<AssetPackage>& assetPackage, const std::shared_ptr<mvt::Map>& map) {
+        if (!map) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(_Mutex);
+
+        for (auto it = _Entries.begin(); it != _Entries.end(); it++) {
+            if (it->styleKey == styleKey && it->assetPackagePtr == assetPackage.get()) {
+                _Entries.erase(it);
+                break;
+            }
+        }
+
+        Entry entry;
+        entry.styleKey = styleKey;
+        entry.assetPackagePtr = assetPackage.get();
+        entry.assetPackage = assetPackage;
+        entry.map = map;
+        _Entries.push_front(std::move(entry));
+
+        while (_Entries.size() > MAX_CACHED_MAPS) {
+            _Entries.pop_back();
+        }
+    }
+
+    const std::size_t StyleMapCache::MAX_CACHED_MAPS = 4;
+
+    std::list<StyleMapCache::Entry> StyleMapCache::_Entries;
+    std::mutex StyleMapCache::_Mutex;
+
+}
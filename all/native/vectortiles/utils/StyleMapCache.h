@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_STYLEMAPCACHE_H_
+#define _CARTO_STYLEMAPCACHE_H_
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace carto {
+    class AssetPackage;
+
+    namespace mvt {
+        class Map;
+    }
+
+    /**
+     * Process-wide cache of parsed and resolved style maps, shared by the vector tile decoders.
+     * The maps are keyed by the style source and the asset package the style was loaded from, so that
+     * decoders created for the same style reuse the map instead of parsing the style again.
+     * The cached maps must not be modified after they are stored.
+     */
+    class StyleMapCache {
+    public:
+        /**
+         * Returns the cached map for the style.
+         * @param styleKey The key describing the style source and the loader options.
+         * @param assetPackage The asset package of the style. May be null.
+         * @return The cached map or null if the style is not cached.
+         */
+        static std::shared_ptr<mvt::Map> Get(const std::string& styleKey, const std::shared_ptr<AssetPackage>& assetPackage);
+
+        /**
+         * Stores the map of the style in the cache. The least recently used maps are released if the cache is full.
+         * @param styleKey The key describing the style source and the loader options.
+         * @param assetPackage The asset package of the style. May be null.
+         * @param map The map to store.
+         */
+        static void Put(const std::string& styleKey, const std::shared_ptr<AssetPackage>& assetPackage, const std::shared_ptr<mvt::Map>& map);
+
+    private:
+        struct Entry {
+            std::string styleKey;
+            const AssetPackage* assetPackagePtr;
+            std::weak_ptr<AssetPackage> assetPackage;
+            std::shared_ptr<mvt::Map> map;
+        };
+
+        StyleMapCache();
+
+        static const std::size_t MAX_CACHED_MAPS;
+
+        static std::list<Entry> _Entries; // most recently used first
+        static std::mutex _Mutex;
+    };
+
+}
+
+#endif
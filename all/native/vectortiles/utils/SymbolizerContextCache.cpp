@@ -0,0 +1,60 @@
+#include "SymbolizerContextCache.h"
+#include "core/BinaryData.h"
+#include "utils/AssetPackage.h"
+
+#include <mapnikvt/SymbolizerContext.h>
+
+namespace carto {
+
+    std::shared_ptr<mvt::SymbolizerContext> SymbolizerContextCache::Get(const std::string& contextKey, const std::shared_ptr<AssetPackage>& assetPackage, const std::vector<std::shared_ptr<BinaryData> >& fallbackFonts) {
+        std::lock_guard<std::mutex> lock(_Mutex);
+
+        for (auto it = _Entries.begin(); it != _Entries.end(); ) {
+            // Drop contexts of released asset packages, a new package may reuse the address
+            if (it->assetPackagePtr && it->assetPackage.expired()) {
+                it = _Entries.erase(it);
+                continue;
+            }
+            if (it->contextKey == contextKey && it->assetPackagePtr == assetPackage.get() && it->fallbackFonts == fallbackFonts) {
+                std::shared_ptr<mvt::SymbolizerContext> context = it->context;
+                _Entries.splice(_Entries.begin(), _Entries, it);
+                return context;
+            }
+            it++;
+        }
+        return std::shared_ptr<mvt::SymbolizerContext>();
+    }
+
+    void SymbolizerContextCache::Put(const std::string& contextKey, const std::shared_ptr<AssetPackage>& assetPackage, const std::vector<std::shared_ptr<BinaryData> >& fallbackFonts, const std::shared_ptr<mvt::SymbolizerContext>& context) {
+        if (!context) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(_Mutex);
+
+        for (auto it = _Entries.begin(); it != _Entries.end(); it++) {
+            if (it->contextKey == contextKey && it->assetPackagePtr == assetPackage.get() && it->fallbackFonts == fallbackFonts) {
+                _Entries.erase(it);
+                break;
+            }
+        }
+
+        Entry entry;
+        entry.contextKey = contextKey;
+        entry.assetPackagePtr = assetPackage.get();
+        entry.assetPackage = assetPackage;
+        entry.fallbackFonts = fallbackFonts;
+        entry.context = context;
+        _Entries.push_front(std::move(entry));
+
+        while (_Entries.size() > MAX_CACHED_CONTEXTS) {
+            _Entries.pop_back();
+        }
+    }
+
+    const std::size_t SymbolizerContextCache::MAX_CACHED_CONTEXTS = 4;
+
+    std::list<SymbolizerContextCache::Entry> SymbolizerContextCache::_Entries;
+    std::mutex SymbolizerContextCache::_Mutex;
+
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2016 CartoDB. All rights reserved.
+ * Copying and using this code is allowed only according
+ * to license terms, as given in https://cartodb.com/terms/
+ */
+
+#ifndef _CARTO_SYMBOLIZERCONTEXTCACHE_H_
+#define _CARTO_SYMBOLIZERCONTEXTCACHE_H_
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace carto {
+    class AssetPackage;
+    class BinaryData;
+
+    namespace mvt {
+        class SymbolizerContext;
+    }
+
+    /**
+     * Process-wide cache of symbolizer contexts, shared by the vector tile decoders.
+     * The cached contexts own the font managers, bitmap managers, stroke maps and glyph maps of the styles,
+     * so decoders using the same asset package and fonts share the loaded fonts and the rasterized glyphs,
+     * also across style changes. The number of cached contexts is limited, as each context keeps its own glyph atlas.
+     */
+    class SymbolizerContextCache {
+    public:
+        /**
+         * Returns the cached context.
+         * @param contextKey The key describing the asset locations used by the context.
+         * @param assetPackage The asset package of the context. May be null.
+         * @param fallbackFonts The fallback fonts loaded into the context.
+         * @return The cached context or null if the context is not cached.
+         */
+        static std::shared_ptr<mvt::SymbolizerContext> Get(const std::string& contextKey, const std::shared_ptr<AssetPackage>& assetPackage, const std::vector<std::shared_ptr<BinaryData> >& fallbackFonts);
+
+        /**
+         * Stores the context in the cache. The least recently used contexts are released if the cache is full.
+         * @param contextKey The key describing the asset locations used by the context.
+         * @param assetPackage The asset package of the context. May be null.
+         * @param fallbackFonts The fallback fonts loaded into the context.
+         * @param context The context to store.
+         */
+        static void Put(const std::string& contextKey, const std::shared_ptr<AssetPackage>& assetPackage, const std::vector<std::shared_ptr<BinaryData> >& fallbackFonts, const std::shared_ptr<mvt::SymbolizerContext>& context);
+
+    private:
+        struct Entry {
+            std::string contextKey;
+            const AssetPackage* assetPackagePtr;
+            std::weak_ptr<AssetPackage> assetPackage;
+            std::vector<std::shared_ptr<BinaryData> > fallbackFonts;
+            std::shared_ptr<mvt::SymbolizerContext> context;
+        };
+
+        SymbolizerContextCache();
+
+        static const std::size_t MAX_CACHED_CONTEXTS;
+
+        static std::list<Entry> _Entries; // most recently used first
+        static std::mutex _Mutex;
+    };
+
+}
+
+#endif
@@ -6,6 +6,8 @@
 #include "utils/Const.h"
 #include "utils/Log.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 
 #define NANOSVG_IMPLEMENTATION
@@ -27,6 +29,18 @@ namespace carto {
     }
     
     std::shared_ptr<const vt::Bitmap> VTBitmapLoader::load(const std::string& url, float& resolution) const {
+        std::string::size_type extEndPos = url.rfind('?');
+        std::string::size_type extBegPos = url.rfind('.', extEndPos);
+        std::string ext = (extBegPos != std::string::npos ? url.substr(extBegPos, extEndPos - extBegPos) : std::string());
+
+        // Use the bitmaps prerendered into the asset package instead of rasterizing the vector icons at runtime
+        if (ext == ".svg" && !_urlFileLoader.isSupported(url) && _assetPackage) {
+            std::string fileName = FileUtils::NormalizePath(_basePath + url.substr(0, extBegPos));
+            if (std::shared_ptr<BinaryData> fileData = loadPrerenderedAsset(fileName, resolution)) {
+                return loadBitmap(fileData, url);
+            }
+        }
+
         std::shared_ptr<BinaryData> fileData;
         if (_urlFileLoader.isSupported(url)) {
             if (!_urlFileLoader.load(url, fileData)) {
@@ -46,15 +60,30 @@ namespace carto {
             return std::shared_ptr<vt::Bitmap>();
         }
 
-        std::string::size_type extEndPos = url.rfind('?');
-        std::string::size_type extBegPos = url.rfind('.', extEndPos);
-        if (extBegPos != std::string::npos) {
-            std::string ext = url.substr(extBegPos, extEndPos - extBegPos);
-            if (ext == ".svg") {
-                return loadSVG(*fileData->getDataPtr(), resolution);
+        if (ext == ".svg") {
+            return loadSVG(*fileData->getDataPtr(), resolution);
+        }
+
+        std::shared_ptr<const vt::Bitmap> bitmap = loadBitmap(fileData, url);
+        if (bitmap) {
+            resolution = 1.0f; // reset resolution
+        }
+        return bitmap;
+    }
+
+    std::shared_ptr<BinaryData> VTBitmapLoader::loadPrerenderedAsset(const std::string& fileName, float& resolution) const {
+        // Prerendered bitmaps use the '@<scale>x.png' suffix. Prefer the smallest scale not below the requested resolution
+        int minScale = std::max(1, static_cast<int>(std::ceil(resolution)));
+        for (int scale = minScale; scale <= MAX_PRERENDERED_SCALE; scale++) {
+            if (std::shared_ptr<BinaryData> fileData = _assetPackage->loadAsset(fileName + "@" + std::to_string(scale) + "x.png")) {
+                resolution = static_cast<float>(scale);
+                return fileData;
             }
         }
-        
+        return std::shared_ptr<BinaryData>();
+    }
+
+    std::shared_ptr<const vt::Bitmap> VTBitmapLoader::loadBitmap(const std::shared_ptr<BinaryData>& fileData, const std::string& url) const {
         std::shared_ptr<Bitmap> sourceBitmap = Bitmap::CreateFromCompressed(fileData->data(), fileData->size());
         if (!sourceBitmap) {
             Log::Errorf("VTBitmapLoader: Failed to decode bitmap: %s", url.c_str());
@@ -72,7 +101,6 @@ namespace carto {
             }
         }
 
-        resolution = 1.0f; // reset resolution
         return std::make_shared<vt::Bitmap>(sourceBitmap->getWidth(), sourceBitmap->getHeight(), std::move(data));
     }
     
@@ -97,4 +125,6 @@ namespace carto {
         return std::make_shared<vt::Bitmap>(width, height, std::move(data));
     }
 
+    const int VTBitmapLoader::MAX_PRERENDERED_SCALE = 4;
+
 }
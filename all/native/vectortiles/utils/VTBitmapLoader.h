@@ -27,6 +27,10 @@ namespace carto {
         virtual std::shared_ptr<const vt::Bitmap> load(const std::string& url, float& resolution) const;
     
     private:
+        static const int MAX_PRERENDERED_SCALE;
+
+        std::shared_ptr<BinaryData> loadPrerenderedAsset(const std::string& fileName, float& resolution) const;
+        std::shared_ptr<const vt::Bitmap> loadBitmap(const std::shared_ptr<BinaryData>& fileData, const std::string& url) const;
         std::shared_ptr<const vt::Bitmap> loadSVG(const std::vector<unsigned char>& fileData, float& resolution) const;
 
         std::string _basePath;
@@ -14,9 +14,11 @@ import android.opengl.GLSurfaceView.Renderer;
 import android.util.AttributeSet;
 import android.view.MotionEvent;
 
+import com.carto.components.MapEngine;
 import com.carto.components.Options;
 import com.carto.components.Layers;
 import com.carto.components.LicenseManagerListener;
+import com.carto.components.MemoryPressureLevel;
 import com.carto.core.MapBounds;
 import com.carto.core.MapPos;
 import com.carto.core.ScreenPos;
@@ -112,6 +114,20 @@ public class MapView extends GLSurfaceView implements Renderer {
      * @param attrs The attributes.
      */
     public MapView(Context context, AttributeSet attrs) {
+        this(context, attrs, null);
+    }
+
+    /**
+     * Creates a new MapView object attached to the specified engine.
+     * The worker pools of the engine are shared with the other views attached to the same engine.
+     * @param context The context object.
+     * @param engine The engine to attach to.
+     */
+    public MapView(Context context, MapEngine engine) {
+        this(context, null, engine);
+    }
+
+    private MapView(Context context, AttributeSet attrs, MapEngine engine) {
         super(context, attrs);
 
         // Unless explictly not clickable, make clickable by default
@@ -142,7 +158,7 @@ public class MapView extends GLSurfaceView implements Renderer {
             assetManager = context.getApplicationContext().getAssets();
             AssetUtils.setAssetManagerPointer(assetManager);
         
-            baseMapView = new BaseMapView();
+            baseMapView = (engine != null ? new BaseMapView(engine) : new BaseMapView());
             baseMapView.getOptions().setDPI(getResources().getDisplayMetrics().densityDpi);
             baseMapView.setRedrawRequestListener(new MapRedrawRequestListener(this));
         
@@ -618,5 +634,15 @@ public class MapView extends GLSurfaceView implements Renderer {
     public void clearAllCaches() {
         baseMapView.clearAllCaches();	
     }
+
+    /**
+     * Releases memory in stages according to the given memory pressure level. Higher levels release
+     * everything that lower levels release. Unlike clearAllCaches, the visible tiles are kept
+     * at all levels except MEMORY_PRESSURE_LEVEL_CRITICAL, so the map stays on screen.
+     * @param level The memory pressure level.
+     */
+    public void releaseMemory(MemoryPressureLevel level) {
+        baseMapView.releaseMemory(level);
+    }
     
 }
@@ -26,6 +26,10 @@
 %typemap(imtype) jobject androidAssetManager "System.IntPtr"
 %typemap(cstype) jobject androidAssetManager "Android.Content.Res.AssetManager"
 
+%ignore carto::AssetUtils::AssetFile;
+%ignore carto::AssetUtils::OpenAsset;
+%ignore carto::AssetUtils::ReadAsset;
+
 %include "utils/AssetUtils.h"
 
 #endif
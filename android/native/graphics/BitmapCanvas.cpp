@@ -7,6 +7,9 @@
 #include "utils/Log.h"
 
 #include <cmath>
+#include <map>
+#include <mutex>
+#include <string>
 
 #include <jni.h>
 
@@ -119,24 +122,47 @@ namespace {
         }
     };
 
-    void ellipsizeText(JNIEnv* jenv, jobject paintObject, std::string& text, int maxWidth, bool breakLines) {
+    struct PathClass {
+        JNIUniqueGlobalRef<jclass> clazz;
+        jmethodID constructor;
+        jmethodID moveTo;
+        jmethodID lineTo;
+        jmethodID close;
+
+        explicit PathClass(JNIEnv* jenv) {
+            clazz = JNIUniqueGlobalRef<jclass>(jenv->NewGlobalRef(jenv->FindClass("android/graphics/Path")));
+            constructor = jenv->GetMethodID(clazz, "<init>", "()V");
+            moveTo = jenv->GetMethodID(clazz, "moveTo", "(FF)V");
+            lineTo = jenv->GetMethodID(clazz, "lineTo", "(FF)V");
+            close = jenv->GetMethodID(clazz, "close", "()V");
+        }
+    };
+
+    struct TextUtilsClass {
+        JNIUniqueGlobalRef<jclass> clazz;
+        jmethodID ellipsize;
+        jmethodID toString;
+        JNIUniqueGlobalRef<jobject> endTruncateAt;
+
+        explicit TextUtilsClass(JNIEnv* jenv) {
+            clazz = JNIUniqueGlobalRef<jclass>(jenv->NewGlobalRef(jenv->FindClass("android/text/TextUtils")));
+            ellipsize = jenv->GetStaticMethodID(clazz, "ellipsize", "(Ljava/lang/CharSequence;Landroid/text/TextPaint;FLandroid/text/TextUtils$TruncateAt;)Ljava/lang/CharSequence;");
+            jclass charSeqClass = jenv->FindClass("java/lang/CharSequence");
+            toString = jenv->GetMethodID(charSeqClass, "toString", "()Ljava/lang/String;");
+            jstring truncateAtName = jenv->NewStringUTF("END");
+            jclass truncateAtClass = jenv->FindClass("android/text/TextUtils$TruncateAt");
+            endTruncateAt = JNIUniqueGlobalRef<jobject>(jenv->NewGlobalRef(jenv->CallStaticObjectMethod(truncateAtClass, jenv->GetStaticMethodID(truncateAtClass, "valueOf", "(Ljava/lang/String;)Landroid/text/TextUtils$TruncateAt;"), truncateAtName)));
+        }
+    };
+
+    void ellipsizeText(JNIEnv* jenv, const TextUtilsClass& textUtilsClass, jobject paintObject, std::string& text, int maxWidth, bool breakLines) {
         if (maxWidth < 0 || breakLines) {
             return;
         }
 
-        jstring truncateAtName = jenv->NewStringUTF("END");
-        jclass truncateAtClass = jenv->FindClass("android/text/TextUtils$TruncateAt");
-        jobject truncateAtObject = jenv->CallStaticObjectMethod(truncateAtClass, jenv->GetStaticMethodID(truncateAtClass, "valueOf", "(Ljava/lang/String;)Landroid/text/TextUtils$TruncateAt;"), truncateAtName);
-
         jstring textObject = jenv->NewStringUTF(text.c_str());
-
-        jclass textUtilsClass = jenv->FindClass("android/text/TextUtils");
-        jmethodID ellipsize = jenv->GetStaticMethodID(textUtilsClass, "ellipsize", "(Ljava/lang/CharSequence;Landroid/text/TextPaint;FLandroid/text/TextUtils$TruncateAt;)Ljava/lang/CharSequence;");
-        jobject charSeqObject = jenv->CallStaticObjectMethod(textUtilsClass, ellipsize, textObject, paintObject, (jfloat)maxWidth, truncateAtObject);
-
-        jclass charSeqClass = jenv->FindClass("java/lang/CharSequence");
-        jmethodID toString = jenv->GetMethodID(charSeqClass, "toString", "()Ljava/lang/String;");
-        textObject = (jstring)jenv->CallObjectMethod(charSeqObject, toString);
+        jobject charSeqObject = jenv->CallStaticObjectMethod(textUtilsClass.clazz, textUtilsClass.ellipsize, textObject, paintObject, (jfloat)maxWidth, textUtilsClass.endTruncateAt.get());
+        textObject = (jstring)jenv->CallObjectMethod(charSeqObject, textUtilsClass.toString);
 
         const char* textStr = jenv->GetStringUTFChars(textObject, NULL);
         text = textStr;
@@ -158,6 +184,9 @@ namespace carto {
         static std::unique_ptr<PaintClass> _PaintClass;
         static std::unique_ptr<TypefaceClass> _TypefaceClass;
         static std::unique_ptr<StaticLayoutClass> _StaticLayoutClass;
+        static std::unique_ptr<PathClass> _PathClass;
+        static std::unique_ptr<TextUtilsClass> _TextUtilsClass;
+        static std::map<std::string, JNIUniqueGlobalRef<jobject> > _Typefaces;
         static std::mutex _Mutex;
 
         State() { }
@@ -169,6 +198,9 @@ namespace carto {
     std::unique_ptr<PaintClass> BitmapCanvas::State::_PaintClass;
     std::unique_ptr<TypefaceClass> BitmapCanvas::State::_TypefaceClass;
     std::unique_ptr<StaticLayoutClass> BitmapCanvas::State::_StaticLayoutClass;
+    std::unique_ptr<PathClass> BitmapCanvas::State::_PathClass;
+    std::unique_ptr<TextUtilsClass> BitmapCanvas::State::_TextUtilsClass;
+    std::map<std::string, JNIUniqueGlobalRef<jobject> > BitmapCanvas::State::_Typefaces;
     std::mutex BitmapCanvas::State::_Mutex;
 
     BitmapCanvas::BitmapCanvas(int width, int height) :
@@ -200,6 +232,12 @@ namespace carto {
             if (!State::_StaticLayoutClass) {
                 State::_StaticLayoutClass = std::unique_ptr<StaticLayoutClass>(new StaticLayoutClass(jenv));
             }
+            if (!State::_PathClass) {
+                State::_PathClass = std::unique_ptr<PathClass>(new PathClass(jenv));
+            }
+            if (!State::_TextUtilsClass) {
+                State::_TextUtilsClass = std::unique_ptr<TextUtilsClass>(new TextUtilsClass(jenv));
+            }
         }
 
         if (width > 0 && height > 0) {
@@ -278,8 +316,18 @@ namespace carto {
             return;
         }
 
-        jstring fontName = jenv->NewStringUTF(name.c_str());
-        jobject typefaceObject = jenv->CallStaticObjectMethod(_state->_TypefaceClass->clazz, _state->_TypefaceClass->create, fontName, (jint)0); // 0 = NORMAL
+        // Typefaces are immutable, create each of them only once
+        jobject typefaceObject = NULL;
+        {
+            std::lock_guard<std::mutex> lock(State::_Mutex);
+            auto it = State::_Typefaces.find(name);
+            if (it == State::_Typefaces.end()) {
+                jstring fontName = jenv->NewStringUTF(name.c_str());
+                jobject newTypefaceObject = jenv->CallStaticObjectMethod(_state->_TypefaceClass->clazz, _state->_TypefaceClass->create, fontName, (jint)0); // 0 = NORMAL
+                it = State::_Typefaces.emplace(name, JNIUniqueGlobalRef<jobject>(jenv->NewGlobalRef(newTypefaceObject))).first;
+            }
+            typefaceObject = it->second.get();
+        }
         jenv->CallObjectMethod(_state->_paintObject, _state->_PaintClass->setTypeface, typefaceObject);
         jenv->CallVoidMethod(_state->_paintObject, _state->_PaintClass->setTextSize, (jfloat)size);
     }
@@ -328,7 +376,7 @@ namespace carto {
             return;
         }
 
-        ellipsizeText(jenv, _state->_paintObject, text, maxWidth, breakLines);
+        ellipsizeText(jenv, *_state->_TextUtilsClass, _state->_paintObject, text, maxWidth, breakLines);
 
         jstring textObject = jenv->NewStringUTF(text.c_str());
         if (maxWidth < 0) {
@@ -373,20 +421,12 @@ namespace carto {
             return;
         }
 
-        jclass pathClass = jenv->FindClass("android/graphics/Path");
-        jmethodID pathConstructor = jenv->GetMethodID(pathClass, "<init>", "()V");
-        jobject pathObject = jenv->NewObject(pathClass, pathConstructor);
-
-        jmethodID moveTo = jenv->GetMethodID(pathClass, "moveTo", "(FF)V");
-        jenv->CallVoidMethod(pathObject, moveTo, (jfloat)poses[0].getX(), (jfloat)poses[0].getY());
-
-        jmethodID lineTo = jenv->GetMethodID(pathClass, "lineTo", "(FF)V");
+        jobject pathObject = jenv->NewObject(_state->_PathClass->clazz, _state->_PathClass->constructor);
+        jenv->CallVoidMethod(pathObject, _state->_PathClass->moveTo, (jfloat)poses[0].getX(), (jfloat)poses[0].getY());
         for (size_t i = 1; i < poses.size(); i++) {
-            jenv->CallVoidMethod(pathObject, lineTo, (jfloat)poses[i].getX(), (jfloat)poses[i].getY());
+            jenv->CallVoidMethod(pathObject, _state->_PathClass->lineTo, (jfloat)poses[i].getX(), (jfloat)poses[i].getY());
         }
-
-        jmethodID close = jenv->GetMethodID(pathClass, "close", "()V");
-        jenv->CallVoidMethod(pathObject, close);
+        jenv->CallVoidMethod(pathObject, _state->_PathClass->close);
 
         jenv->CallVoidMethod(_state->_canvasObject, _state->_CanvasClass->drawPath, pathObject, _state->_paintObject.get());
     }
@@ -422,7 +462,7 @@ namespace carto {
             return ScreenBounds(ScreenPos(0, 0), ScreenPos(0, 0));
         }
 
-        ellipsizeText(jenv, _state->_paintObject, text, maxWidth, breakLines);
+        ellipsizeText(jenv, *_state->_TextUtilsClass, _state->_paintObject, text, maxWidth, breakLines);
 
         jstring textObject = jenv->NewStringUTF(text.c_str());
         if (maxWidth < 0) {
@@ -8,6 +8,7 @@
 #include <chrono>
 #include <limits>
 #include <regex>
+#include <vector>
 
 #include <boost/lexical_cast.hpp>
 
@@ -226,8 +227,9 @@ namespace carto {
         }
         
         try {
-            jbyte buf[4096];
-            jbyteArray jbuf = jenv->NewByteArray(sizeof(buf));
+            // Use a large buffer, each read is a JNI call and an array copy
+            std::vector<jbyte> buf(READ_BUFFER_SIZE);
+            jbyteArray jbuf = jenv->NewByteArray(static_cast<jsize>(buf.size()));
 
             std::uint64_t readOffset = 0;
             while (!cancel) {
@@ -240,9 +242,9 @@ namespace carto {
                 if (numBytesRead < 0) {
                     break;
                 }
-                jenv->GetByteArrayRegion(jbuf, 0, numBytesRead, buf);
+                jenv->GetByteArrayRegion(jbuf, 0, numBytesRead, buf.data());
             
-                if (!dataFn(reinterpret_cast<const unsigned char*>(&buf[0]), numBytesRead)) {
+                if (!dataFn(reinterpret_cast<const unsigned char*>(buf.data()), numBytesRead)) {
                     cancel = true;
                 }
 
@@ -273,6 +275,8 @@ namespace carto {
         return true;
     }
     
+    const std::size_t HTTPClient::AndroidImpl::READ_BUFFER_SIZE = 65536;
+
     std::unique_ptr<HTTPClient::AndroidImpl::URLClass> HTTPClient::AndroidImpl::_URLClass;
     std::unique_ptr<HTTPClient::AndroidImpl::HttpURLConnectionClass> HTTPClient::AndroidImpl::_HttpURLConnectionClass;
     std::unique_ptr<HTTPClient::AndroidImpl::InputStreamClass> HTTPClient::AndroidImpl::_InputStreamClass;
@@ -19,6 +19,8 @@ namespace carto {
         virtual bool makeRequest(const HTTPClient::Request& request, HeadersFunc headersFn, DataFunc dataFn) const;
 
     private:
+        static const std::size_t READ_BUFFER_SIZE;
+
         struct URLClass;
         struct HttpURLConnectionClass;
         struct InputStreamClass;
@@ -7,6 +7,37 @@
 
 namespace carto {
 
+    class AssetUtils::AssetFile {
+    public:
+        explicit AssetFile(AAsset* asset) : _asset(asset), _mutex() { }
+
+        ~AssetFile() {
+            AAsset_close(_asset);
+        }
+
+        std::shared_ptr<BinaryData> read(std::uint64_t offset, std::size_t size) {
+            std::lock_guard<std::mutex> lock(_mutex); // asset position is shared by all readers
+
+            if (AAsset_seek64(_asset, static_cast<off64_t>(offset), SEEK_SET) != static_cast<off64_t>(offset)) {
+                return std::shared_ptr<BinaryData>();
+            }
+            std::vector<unsigned char> data(size);
+            std::size_t readSize = 0;
+            while (readSize < size) {
+                int result = AAsset_read(_asset, data.data() + readSize, size - readSize);
+                if (result <= 0) {
+                    return std::shared_ptr<BinaryData>();
+                }
+                readSize += result;
+            }
+            return std::make_shared<BinaryData>(std::move(data));
+        }
+
+    private:
+        AAsset* _asset;
+        std::mutex _mutex;
+    };
+
     void AssetUtils::SetAssetManagerPointer(jobject androidAssetManager) {
         std::lock_guard<std::mutex> lock(_Mutex);
         _AssetManagerPtr = AAssetManager_fromJava(AndroidUtils::GetCurrentThreadJNIEnv(), androidAssetManager);
@@ -41,6 +72,28 @@ namespace carto {
         return std::make_shared<BinaryData>(std::move(data));
     }
 
+    std::shared_ptr<AssetUtils::AssetFile> AssetUtils::OpenAsset(const std::string& path) {
+        std::lock_guard<std::mutex> lock(_Mutex);
+        if (!_AssetManagerPtr) {
+            Log::Error("AssetManager::OpenAsset: Asset manager pointer not set yet");
+            return std::shared_ptr<AssetFile>();
+        }
+
+        AAsset* assetRaw = AAssetManager_open(_AssetManagerPtr, path.c_str(), AASSET_MODE_RANDOM);
+        if (!assetRaw) {
+            Log::Errorf("AssetManager::OpenAsset: Asset not found: %s", path.c_str());
+            return std::shared_ptr<AssetFile>();
+        }
+        return std::make_shared<AssetFile>(assetRaw);
+    }
+
+    std::shared_ptr<BinaryData> AssetUtils::ReadAsset(const std::shared_ptr<AssetFile>& assetFile, std::uint64_t offset, std::size_t size) {
+        if (!assetFile) {
+            return std::shared_ptr<BinaryData>();
+        }
+        return assetFile->read(offset, size);
+    }
+
     AssetUtils::AssetUtils() {
     }
 
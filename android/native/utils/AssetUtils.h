@@ -7,6 +7,7 @@
 #ifndef _CARTO_ASSETUTILS_H_
 #define _CARTO_ASSETUTILS_H_
 
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -36,6 +37,27 @@ namespace carto {
          */
         static std::shared_ptr<BinaryData> LoadAsset(const std::string& path);
 
+        /**
+         * An opened bundled asset, allowing to read parts of the asset without loading all of it.
+         */
+        class AssetFile;
+
+        /**
+         * Opens the specified bundled asset for reading parts of it.
+         * @param path The path of the asset to open. The path is relative to application root folder.
+         * @return The opened asset or null if the asset was not found.
+         */
+        static std::shared_ptr<AssetFile> OpenAsset(const std::string& path);
+
+        /**
+         * Reads a range of the opened asset. The same asset can be read from multiple threads.
+         * @param assetFile The opened asset.
+         * @param offset The offset of the range in bytes.
+         * @param size The size of the range in bytes.
+         * @return The data of the range or null if the range could not be read.
+         */
+        static std::shared_ptr<BinaryData> ReadAsset(const std::shared_ptr<AssetFile>& assetFile, std::uint64_t offset, std::size_t size);
+
     private:
         AssetUtils();
 
@@ -2,10 +2,59 @@
 #include "components/ThreadWorker.h"
 #include "utils/Log.h"
 
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <sched.h>
 #include <sys/resource.h>
 #include <string.h>
 #include <unistd.h>
 
+namespace {
+
+    struct CPUCoreSets {
+        bool heterogeneous;
+        cpu_set_t performanceCores; // all cores except the slowest cluster
+        cpu_set_t efficiencyCores; // the slowest cluster
+        cpu_set_t allCores;
+
+        CPUCoreSets() : heterogeneous(false) {
+            CPU_ZERO(&performanceCores);
+            CPU_ZERO(&efficiencyCores);
+            CPU_ZERO(&allCores);
+
+            // Classify the cores by their maximum frequencies, this is the only portable hint about the core types
+            long coreCount = sysconf(_SC_NPROCESSORS_CONF);
+            std::vector<long> maxFreqs;
+            for (long i = 0; i < coreCount && i < CPU_SETSIZE; i++) {
+                long maxFreq = 0;
+                std::ifstream stream("/sys/devices/system/cpu/cpu" + std::to_string(i) + "/cpufreq/cpuinfo_max_freq");
+                if (!(stream >> maxFreq)) {
+                    return;
+                }
+                maxFreqs.push_back(maxFreq);
+            }
+            if (maxFreqs.empty()) {
+                return;
+            }
+
+            long minFreq = *std::min_element(maxFreqs.begin(), maxFreqs.end());
+            for (std::size_t i = 0; i < maxFreqs.size(); i++) {
+                CPU_SET(i, &allCores);
+                if (maxFreqs[i] > minFreq) {
+                    CPU_SET(i, &performanceCores);
+                    heterogeneous = true;
+                } else {
+                    CPU_SET(i, &efficiencyCores);
+                }
+            }
+        }
+    };
+
+}
+
 namespace carto {
 
     void ThreadUtils::SetThreadPriority(ThreadPriority::ThreadPriority priority) {
@@ -18,6 +67,31 @@ namespace carto {
         }
     }
 
+    void ThreadUtils::SetThreadQoSClass(ThreadQoSClass::ThreadQoSClass qosClass) {
+        // There are no QoS classes for native threads, so restrict the thread affinity on big.LITTLE CPUs instead
+        static const CPUCoreSets coreSets;
+        if (!coreSets.heterogeneous) {
+            return;
+        }
+
+        const cpu_set_t* cores = &coreSets.allCores;
+        switch (qosClass) {
+        case ThreadQoSClass::BACKGROUND:
+            cores = &coreSets.efficiencyCores;
+            break;
+        case ThreadQoSClass::UTILITY:
+        case ThreadQoSClass::USER_INITIATED:
+            cores = &coreSets.allCores;
+            break;
+        case ThreadQoSClass::USER_INTERACTIVE:
+            cores = &coreSets.performanceCores;
+            break;
+        }
+        if (sched_setaffinity(gettid(), sizeof(cpu_set_t), cores) != 0) {
+            Log::Errorf("ThreadUtils::SetThreadQoSClass: Failed to set thread affinity: %d, error: %s", qosClass, strerror(errno));
+        }
+    }
+
     ThreadUtils::ThreadUtils() {
     }
 
@@ -13,6 +13,10 @@
 
 %import "core/BinaryData.i"
 
+%ignore carto::AssetUtils::AssetFile;
+%ignore carto::AssetUtils::OpenAsset;
+%ignore carto::AssetUtils::ReadAsset;
+
 %include "utils/AssetUtils.h"
 
 #endif
@@ -2,11 +2,14 @@
 #include "components/Exceptions.h"
 #include "utils/Log.h"
 
+#include <algorithm>
+
 #import <Foundation/Foundation.h>
 
 @interface URLConnection : NSObject <NSURLSessionDelegate, NSURLSessionTaskDelegate, NSURLSessionDataDelegate>
 
 -(id)init;
++(URLConnection*)sharedConnection;
 -(NSError*)sendSynchronousRequest:(NSURLRequest*)request didReceiveResponse:(BOOL(^)(NSURLResponse*))responseHandler didReceiveData:(BOOL(^)(NSData*))dataHandler;
 
 @end
@@ -26,6 +29,7 @@
     self = [super init];
 
     NSURLSessionConfiguration* defaultConfigObject = [NSURLSessionConfiguration defaultSessionConfiguration];
+    defaultConfigObject.HTTPMaximumConnectionsPerHost = std::max(1, carto::HTTPClient::GetMaxConnectionsPerHost());
 
     self.session = [NSURLSession sessionWithConfiguration: defaultConfigObject delegate:self delegateQueue:nil];
     self.condition = [[NSCondition alloc] init];
@@ -34,6 +38,16 @@
     return self;
 }
 
++(URLConnection*)sharedConnection {
+    // Single session for all clients, so that requests to the same host are multiplexed over a shared HTTP/2 connection
+    static URLConnection* connection = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        connection = [[URLConnection alloc] init];
+    });
+    return connection;
+}
+
 -(NSError*)sendSynchronousRequest:(NSURLRequest*)request didReceiveResponse:(BOOL(^)(NSURLResponse*))responseHandler didReceiveData:(BOOL(^)(NSData*))dataHandler {
     NSURLSessionDataTask* dataTask = [self.session dataTaskWithRequest:request];
 
@@ -98,7 +112,7 @@
     [self.condition lock];
     [self.responseHandlers removeObjectForKey:dataTask];
     [self.dataHandlers removeObjectForKey:dataTask];
-    [self.condition signal];
+    [self.condition broadcast];
     [self.condition unlock];
 }
 
@@ -111,12 +125,10 @@ namespace carto {
         _timeout(-1),
         _connection(nullptr)
     {
-        URLConnection* connection = [[URLConnection alloc] init];
-        _connection = (__bridge_retained void*)connection;
+        _connection = (__bridge void*)[URLConnection sharedConnection];
     }
     
     HTTPClient::IOSImpl::~IOSImpl() {
-        URLConnection* connection = (__bridge_transfer URLConnection*)_connection;
         _connection = nullptr;
     }
 
@@ -169,9 +181,13 @@ namespace carto {
             return cancel;
         };
         BOOL(^handleData)(NSData*) = ^BOOL(NSData* data) {
-            if (!dataFn(reinterpret_cast<const unsigned char*>([data bytes]), [data length])) {
-                cancel = YES;
-            }
+            // The received data may be non-contiguous, pass the regions directly instead of flattening them with [data bytes]
+            [data enumerateByteRangesUsingBlock:^(const void* bytes, NSRange byteRange, BOOL* stop) {
+                if (!dataFn(reinterpret_cast<const unsigned char*>(bytes), byteRange.length)) {
+                    cancel = YES;
+                    *stop = YES;
+                }
+            }];
             return cancel;
         };
 
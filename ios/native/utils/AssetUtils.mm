@@ -2,10 +2,39 @@
 #include "core/BinaryData.h"
 #include "utils/Log.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #import <Foundation/Foundation.h>
 
 namespace carto {
 
+    class AssetUtils::AssetFile {
+    public:
+        explicit AssetFile(int fd) : _fd(fd) { }
+
+        ~AssetFile() {
+            close(_fd);
+        }
+
+        std::shared_ptr<BinaryData> read(std::uint64_t offset, std::size_t size) const {
+            // Positioned reads do not use the file position, so no locking is needed
+            std::vector<unsigned char> data(size);
+            std::size_t readSize = 0;
+            while (readSize < size) {
+                ssize_t result = pread(_fd, data.data() + readSize, size - readSize, static_cast<off_t>(offset + readSize));
+                if (result <= 0) {
+                    return std::shared_ptr<BinaryData>();
+                }
+                readSize += result;
+            }
+            return std::make_shared<BinaryData>(std::move(data));
+        }
+
+    private:
+        int _fd;
+    };
+
     std::shared_ptr<BinaryData> AssetUtils::LoadAsset(const std::string& path) {
         // Convert std::string to NSString
         NSString* nsPath = [NSString stringWithUTF8String:path.c_str()];
@@ -31,6 +60,27 @@ namespace carto {
         return std::make_shared<BinaryData>(std::move(data));
     }
 
+    std::shared_ptr<AssetUtils::AssetFile> AssetUtils::OpenAsset(const std::string& path) {
+        std::string fullPath = CalculateResourcePath(path);
+        if (fullPath.empty()) {
+            return std::shared_ptr<AssetFile>();
+        }
+
+        int fd = open(fullPath.c_str(), O_RDONLY);
+        if (fd < 0) {
+            Log::Errorf("AssetUtils::OpenAsset: Failed to open asset: %s", path.c_str());
+            return std::shared_ptr<AssetFile>();
+        }
+        return std::make_shared<AssetFile>(fd);
+    }
+
+    std::shared_ptr<BinaryData> AssetUtils::ReadAsset(const std::shared_ptr<AssetFile>& assetFile, std::uint64_t offset, std::size_t size) {
+        if (!assetFile) {
+            return std::shared_ptr<BinaryData>();
+        }
+        return assetFile->read(offset, size);
+    }
+
     std::string AssetUtils::CalculateResourcePath(const std::string& resourceName) {
         NSString* nsResourceName = [NSString stringWithUTF8String:resourceName.c_str()];
         NSString* fileName = [nsResourceName stringByDeletingPathExtension];
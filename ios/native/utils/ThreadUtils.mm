@@ -3,6 +3,8 @@
 #include "utils/Log.h"
 
 #include <sys/syscall.h>
+#include <pthread.h>
+#include <pthread/qos.h>
 
 #import <Foundation/NSThread.h>
 
@@ -13,6 +15,29 @@ namespace carto {
         float nsPriority = 1 - (priority + 20) / 40.0;
         [nsThread setThreadPriority:nsPriority];
     }
+
+    void ThreadUtils::SetThreadQoSClass(ThreadQoSClass::ThreadQoSClass qosClass) {
+        // The scheduler uses the QoS class for selecting between performance and efficiency cores
+        qos_class_t qos = QOS_CLASS_DEFAULT;
+        switch (qosClass) {
+        case ThreadQoSClass::BACKGROUND:
+            qos = QOS_CLASS_BACKGROUND;
+            break;
+        case ThreadQoSClass::UTILITY:
+            qos = QOS_CLASS_UTILITY;
+            break;
+        case ThreadQoSClass::USER_INITIATED:
+            qos = QOS_CLASS_USER_INITIATED;
+            break;
+        case ThreadQoSClass::USER_INTERACTIVE:
+            qos = QOS_CLASS_USER_INTERACTIVE;
+            break;
+        }
+        int error = pthread_set_qos_class_self_np(qos, 0);
+        if (error != 0) {
+            Log::Errorf("ThreadUtils::SetThreadQoSClass: Failed to set thread QoS class: %d, error: %d", qosClass, error);
+        }
+    }
     
     ThreadUtils::ThreadUtils() {
     }
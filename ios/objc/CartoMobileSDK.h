@@ -40,6 +40,7 @@
 
 #import "NTFeature.h"
 #import "NTFeatureCollection.h"
+#import "NTColumnarFeatureCollection.h"
 #import "NTLineGeometry.h"
 #import "NTPointGeometry.h"
 #import "NTPolygonGeometry.h"
@@ -49,13 +50,16 @@
 #import "NTMultiPolygonGeometry.h"
 #import "NTGeometrySimplifier.h"
 #import "NTDouglasPeuckerGeometrySimplifier.h"
+#import "NTVisvalingamGeometrySimplifier.h"
 #import "NTGeoJSONGeometryReader.h"
 #import "NTGeoJSONGeometryWriter.h"
+#import "NTGeoJSONFeatureReaderListener.h"
 
 #import "NTBitmap.h"
 #import "NTColor.h"
 #import "NTViewState.h"
 
+#import "NTBitmapOverlayLayer.h"
 #import "NTSolidLayer.h"
 #import "NTRasterTileEventListener.h"
 #import "NTRasterTileLayer.h"
@@ -75,6 +79,7 @@
 #import "NTEPSG4326.h"
 
 #import "NTCullState.h"
+#import "NTFrameStatistics.h"
 
 #import "NTAnimationStyleBuilder.h"
 #import "NTAnimationStyle.h"
@@ -207,11 +212,14 @@
 #import "NTRoutingService.h"
 #import "NTRouteMatchingRequest.h"
 #import "NTRouteMatchingResult.h"
+#import "NTRoutingMatrixRequest.h"
+#import "NTRoutingMatrixResult.h"
 #import "NTOSRMOfflineRoutingService.h"
 #import "NTSGREOfflineRoutingService.h"
 #import "NTCartoOnlineRoutingService.h"
 #import "NTValhallaOnlineRoutingService.h"
 #ifdef _CARTO_VALHALLA_ROUTING_SUPPORT
+#import "NTRouteMatchingSession.h"
 #import "NTValhallaOfflineRoutingService.h"
 #endif
 #endif
@@ -6,8 +6,11 @@
 
 #import <GLKit/GLKit.h>
 
+#import "NTMemoryPressureLevel.h"
+
 @class NTLayers;
 @class NTMapBounds;
+@class NTMapEngine;
 @class NTMapPos;
 @class NTMapVec;
 @class NTScreenPos;
@@ -26,6 +29,13 @@ __attribute__ ((visibility("default"))) @interface NTMapView : GLKView
 -(id)init;
 -(id)initWithCoder:(NSCoder *)aDecoder;
 -(id)initWithFrame:(CGRect)frame;
+/**
+ * Creates a new map view attached to the specified engine.
+ * The worker pools of the engine are shared with the other views attached to the same engine.
+ * @param frame The frame of the view.
+ * @param engine The engine to attach to.
+ */
+-(id)initWithFrame:(CGRect)frame engine:(NTMapEngine*)engine;
 
 /**
  * Registers the SDK license. This is class method and must be called before <br>
@@ -278,4 +288,12 @@ __attribute__ ((visibility("default"))) @interface NTMapView : GLKView
  */
 -(void)clearAllCaches;
 
+/**
+ * Releases memory in stages according to the given memory pressure level. Higher levels release
+ * everything that lower levels release. Unlike clearAllCaches, the visible tiles are kept
+ * at all levels except NT_MEMORY_PRESSURE_LEVEL_CRITICAL, so the map stays on screen.
+ * @param level The memory pressure level.
+ */
+-(void)releaseMemory:(enum NTMemoryPressureLevel)level;
+
 @end
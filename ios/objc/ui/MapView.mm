@@ -1,5 +1,6 @@
 #import  "MapView.h"
 #import  "NTBaseMapView.h"
+#import  "NTMapEngine.h"
 #import  "NTPolymorphicClasses.h"
 #import  "ui/MapRedrawRequestListener.h"
 #import  "ui/BaseMapView.h"
@@ -45,23 +46,29 @@ static const int NATIVE_NO_COORDINATE = -1;
 
 -(id)init {
     self = [super init];
-    [self initBase];
+    [self initBaseWithEngine:nil];
     return self;
 }
 
 -(id)initWithCoder:(NSCoder*)aDecoder {
     self = [super initWithCoder:aDecoder];
-    [self initBase];
+    [self initBaseWithEngine:nil];
     return self;
 }
 
 -(id)initWithFrame:(CGRect)frame {
     self = [super initWithFrame:frame];
-    [self initBase];
+    [self initBaseWithEngine:nil];
     return self;
 }
 
--(void)initBase {
+-(id)initWithFrame:(CGRect)frame engine:(NTMapEngine*)engine {
+    self = [super initWithFrame:frame];
+    [self initBaseWithEngine:engine];
+    return self;
+}
+
+-(void)initBaseWithEngine:(NTMapEngine*)engine {
     self.delegate = self;
 
     [[NSNotificationCenter defaultCenter] addObserver:self selector:@selector(appDidEnterBackground) name:UIApplicationDidEnterBackgroundNotification object:nil];
@@ -74,7 +81,7 @@ static const int NATIVE_NO_COORDINATE = -1;
         _scale = [[UIScreen mainScreen] scale];
     }
 
-    _baseMapView = [[NTBaseMapView alloc] init];
+    _baseMapView = (engine ? [[NTBaseMapView alloc] initWithEngine:engine] : [[NTBaseMapView alloc] init]);
     _nativeMapView = [_baseMapView getCptr];
 
     NTMapRedrawRequestListener* redrawRequestListener = [[NTMapRedrawRequestListener alloc] initWithView:self];
@@ -395,4 +402,8 @@ static const int NATIVE_NO_COORDINATE = -1;
     [_baseMapView clearAllCaches];
 }
 
+-(void)releaseMemory:(enum NTMemoryPressureLevel)level {
+    [_baseMapView releaseMemory:level];
+}
+
 @end
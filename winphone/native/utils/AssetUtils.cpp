@@ -4,10 +4,38 @@
 
 #include <utf8.h>
 
+#include <mutex>
+
 #include <stdio.h>
 
 namespace carto {
 
+    class AssetUtils::AssetFile {
+    public:
+        explicit AssetFile(FILE* fp) : _fp(fp), _mutex() { }
+
+        ~AssetFile() {
+            fclose(_fp);
+        }
+
+        std::shared_ptr<BinaryData> read(std::uint64_t offset, std::size_t size) {
+            std::lock_guard<std::mutex> lock(_mutex); // file position is shared by all readers
+
+            if (_fseeki64(_fp, static_cast<__int64>(offset), SEEK_SET) != 0) {
+                return std::shared_ptr<BinaryData>();
+            }
+            std::vector<unsigned char> data(size);
+            if (fread(data.data(), 1, size, _fp) != size) {
+                return std::shared_ptr<BinaryData>();
+            }
+            return std::make_shared<BinaryData>(std::move(data));
+        }
+
+    private:
+        FILE* _fp;
+        std::mutex _mutex;
+    };
+
     std::shared_ptr<BinaryData> AssetUtils::LoadAsset(const std::string& path) {
         std::wstring wpath;
         utf8::utf8to16(path.begin(), path.end(), std::back_inserter(wpath));
@@ -38,6 +66,32 @@ namespace carto {
         }
     }
 
+    std::shared_ptr<AssetUtils::AssetFile> AssetUtils::OpenAsset(const std::string& path) {
+        std::wstring wpath;
+        utf8::utf8to16(path.begin(), path.end(), std::back_inserter(wpath));
+        Platform::String^ appPath = Windows::ApplicationModel::Package::Current->InstalledLocation->Path;
+        Platform::String^ fullPath = appPath + L"\\" + ref new Platform::String(wpath.c_str());
+        std::wstring wfullPath = fullPath->Data();
+        FILE* fpRaw = _wfopen(wfullPath.c_str(), L"rb");
+        if (!fpRaw) {
+            fullPath = appPath + L"\\Assets\\" + ref new Platform::String(wpath.c_str());
+            wfullPath = fullPath->Data();
+            fpRaw = _wfopen(wfullPath.c_str(), L"rb");
+        }
+        if (!fpRaw) {
+            Log::Errorf("AssetUtils::OpenAsset: Asset not found: %s", path.c_str());
+            return std::shared_ptr<AssetFile>();
+        }
+        return std::make_shared<AssetFile>(fpRaw);
+    }
+
+    std::shared_ptr<BinaryData> AssetUtils::ReadAsset(const std::shared_ptr<AssetFile>& assetFile, std::uint64_t offset, std::size_t size) {
+        if (!assetFile) {
+            return std::shared_ptr<BinaryData>();
+        }
+        return assetFile->read(offset, size);
+    }
+
     AssetUtils::AssetUtils() {
     }
 
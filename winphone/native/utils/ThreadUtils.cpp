@@ -11,6 +11,28 @@ namespace carto {
         ::SetThreadPriority(::GetCurrentThread(), static_cast<int>(priority) * THREAD_PRIORITY_HIGHEST / static_cast<int>(ThreadPriority::MAXIMUM));
     }
 
+    void ThreadUtils::SetThreadQoSClass(ThreadQoSClass::ThreadQoSClass qosClass) {
+        // There are no QoS classes for threads, use the thread priorities instead
+        int priority = THREAD_PRIORITY_NORMAL;
+        switch (qosClass) {
+        case ThreadQoSClass::BACKGROUND:
+            priority = THREAD_PRIORITY_LOWEST;
+            break;
+        case ThreadQoSClass::UTILITY:
+            priority = THREAD_PRIORITY_BELOW_NORMAL;
+            break;
+        case ThreadQoSClass::USER_INITIATED:
+            priority = THREAD_PRIORITY_NORMAL;
+            break;
+        case ThreadQoSClass::USER_INTERACTIVE:
+            priority = THREAD_PRIORITY_ABOVE_NORMAL;
+            break;
+        }
+        if (!::SetThreadPriority(::GetCurrentThread(), priority)) {
+            Log::Errorf("ThreadUtils::SetThreadQoSClass: Failed to set thread priority: %d, error: %d", priority, static_cast<int>(::GetLastError()));
+        }
+    }
+
     ThreadUtils::ThreadUtils() {
     }
 